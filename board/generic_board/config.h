@@ -42,6 +42,14 @@
 #define IMU_SC7I22          15
 #define IMU_MAX_TYPE        16
 
+// v0.6.3: IMU mounting - output axis = +/- chip axis (1=X 2=Y 3=Z, negative flips)
+// Applied as compile-time constants while the driver decodes raw samples
+#ifndef IMU_AXIS_X
+#define IMU_AXIS_X          1
+#define IMU_AXIS_Y          2
+#define IMU_AXIS_Z          3
+#endif
+
 /*============================================================================
  * Sensor Fusion Algorithm Selection
  *============================================================================*/
@@ -203,7 +211,7 @@
 /*============================================================================
  * Tracker Configuration
  *============================================================================*/
-#define MAX_TRACKERS            10
+// MAX_TRACKERS 在 include/config.h 中统一定义 (v0.6.3: 随 USE_MULTI_SUPERFRAME)
 
 /*============================================================================
  * USB Configuration
@@ -79,7 +79,7 @@
 /*============================================================================
  * Tracker Configuration
  *============================================================================*/
-#define MAX_TRACKERS            10
+// MAX_TRACKERS 在 include/config.h 中统一定义 (v0.6.3: 随 USE_MULTI_SUPERFRAME)
 
 /*============================================================================
  * USB Configuration
@@ -40,6 +40,14 @@
 #define IMU_SC7I22          15
 #define IMU_MAX_TYPE        16
 
+// v0.6.3: IMU 安装方向 / IMU mounting
+// 输出轴 = ±芯片轴 (1=X 2=Y 3=Z, 负值反向), 驱动解码原始数据时按编译期常量换轴
+#ifndef IMU_AXIS_X
+#define IMU_AXIS_X          1
+#define IMU_AXIS_Y          2
+#define IMU_AXIS_Z          3
+#endif
+
 /*============================================================================
  * 传感器融合算法选择 / Sensor Fusion Algorithm Selection
  *============================================================================*/
@@ -161,7 +169,7 @@
 /*============================================================================
  * 追踪器配置 / Tracker Configuration
  *============================================================================*/
-#define MAX_TRACKERS            10
+// MAX_TRACKERS 在 include/config.h 中统一定义 (v0.6.3: 随 USE_MULTI_SUPERFRAME)
 
 /*============================================================================
  * USB 配置 / USB Configuration
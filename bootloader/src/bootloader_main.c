@@ -3,6 +3,7 @@
  * @brief Minimal USB Bootloader for CH592
  * 
  * 功能:
+ * - v0.6.3: 软件/看门狗复位且应用留有热启动令牌时直接跳转 (boot_token.h)
  * - 检查 BOOT 按键 (PB4)
  * - 检查 Flash 应用有效性
  * - 跳转到应用程序 (0x1000)
@@ -13,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "boot_token.h"
 
 /*============================================================================
  * CH592 寄存器定义 (最小化)
@@ -27,6 +29,12 @@
 #define R32_PB_PU           (*((volatile uint32_t *)0x400010C8))
 #define R32_PB_PIN          (*((volatile uint32_t *)0x400010D0))
 
+/* 复位状态 */
+#define R8_RESET_STATUS     (*((volatile uint8_t *)0x40001044))
+#define RB_RESET_FLAG       0x07
+#define RST_STATUS_SW       0x00        /* 软件复位 */
+#define RST_STATUS_WTR      0x02        /* 看门狗复位 */
+
 /* PFIC 寄存器 */
 #define PFIC_BASE           0xE000E000
 #define PFIC_CFGR           (*((volatile uint32_t *)(PFIC_BASE + 0x048)))
@@ -104,6 +112,24 @@ static bool check_app_valid(void)
     return true;
 }
 
+/*============================================================================
+ * v0.6.3: 热启动快速路径
+ *============================================================================*/
+
+static bool check_warm_boot(void)
+{
+    volatile boot_token_t *tok = (volatile boot_token_t *)BOOT_TOKEN_ADDR;
+    uint8_t rst = R8_RESET_STATUS & RB_RESET_FLAG;
+    
+    /* 上电/RST 引脚复位时 RAM 内容无意义, 令牌只在软件/看门狗复位后采用 */
+    bool warm = (rst == RST_STATUS_SW || rst == RST_STATUS_WTR) &&
+                boot_token_valid(tok, *(uint32_t *)APP_START_ADDR);
+    
+    /* 一次性: 应用需重新运行一段时间后才再写入 */
+    tok->magic = 0;
+    return warm;
+}
+
 /*============================================================================
  * 跳转到应用程序
  *============================================================================*/
@@ -171,6 +197,11 @@ static void enter_dfu_mode(void)
 
 void bootloader_main(void)
 {
+    /* 0. v0.6.3: 热启动 (崩溃/看门狗恢复) 跳过按键延时和应用检查 */
+    if (check_warm_boot()) {
+        jump_to_app();
+    }
+    
     /* 1. 检查 BOOT 按键 */
     bool button_pressed = check_boot_button();
     
@@ -30,11 +30,24 @@ void auto_calib_init(void);
 
 /**
  * @brief 更新校准 (每次IMU读取后调用)
+ * @note v0.6.3: 静止判定取 motion_state, 需先调用 motion_state_update
  * @param gyro 陀螺仪数据 [rad/s]
- * @param accel 加速度计数据 [m/s²]
+ * @param accel 加速度计数据 [g] (v0.6.3: 原地应用椭球校准)
  */
 void auto_calib_update(float gyro[3], float accel[3]);
 
+/**
+ * @brief v0.6.3: 加速度计椭球校准分步求解 (主循环空闲时调用, 每次一小步)
+ * @note 静止姿态在 auto_calib_update 中采集; 解被接受后立即生效并后台保存
+ */
+void auto_calib_process(void);
+
+/**
+ * @brief v0.6.3: 获取加速度计校准 a_cal = (a - bias) ∘ scale
+ * @return true 已有有效解
+ */
+bool auto_calib_get_accel_calib(float bias[3], float scale[3]);
+
 /**
  * @brief 更新磁力计校准
  * @param imu_heading IMU估计的航向 [rad]
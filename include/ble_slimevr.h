@@ -49,6 +49,21 @@ typedef struct __attribute__((packed)) {
     uint8_t reserved;
 } ble_sensor_data_t;
 
+// v0.6.3: Batched sensor notification (BLE_CMD_SET_BATCH mode)
+// One header followed by `count` samples, as many as the negotiated ATT MTU allows
+typedef struct __attribute__((packed)) {
+    uint8_t count;          // Samples in this notification
+    uint8_t seq;            // Notification sequence (wrapping, gap = lost notification)
+    uint16_t timestamp;     // Timestamp of the first sample (ms, wrapping)
+} ble_sensor_batch_header_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t quat[4];        // Quaternion [w, x, y, z] * 32767
+    int16_t accel[3];       // Accel [x, y, z] (mg)
+    uint8_t dt_ms;          // Offset from header timestamp (ms)
+    uint8_t flags;          // Status flags
+} ble_sensor_batch_sample_t;
+
 // Battery data packet (4 bytes)
 typedef struct __attribute__((packed)) {
     uint8_t level;          // Battery percentage (0-100)
@@ -87,6 +102,7 @@ typedef enum {
     BLE_CMD_CALIBRATE_MAG   = 0x04,
     BLE_CMD_TARE            = 0x05,
     BLE_CMD_SET_MOUNTING    = 0x06,
+    BLE_CMD_SET_BATCH       = 0x07,     // v0.6.3: data[0] = 1 batched / 0 single-sample notifications
     BLE_CMD_ENTER_DFU       = 0x10,
     BLE_CMD_FACTORY_RESET   = 0xFF,
 } ble_command_t;
@@ -147,13 +163,25 @@ ble_conn_status_t ble_slimevr_get_status(void);
 bool ble_slimevr_can_notify(void);
 
 /**
- * @brief Send sensor data notification
+ * @brief Send sensor data notification (queued in batch mode)
  * @param quat Quaternion [w, x, y, z]
  * @param accel Linear acceleration [x, y, z] in g
  * @return 0 on success, negative on error
  */
 int ble_slimevr_send_sensor_data(const float quat[4], const float accel[3]);
 
+/**
+ * @brief v0.6.3: Select batched sensor notifications
+ *
+ * When enabled, ble_slimevr_send_sensor_data() queues samples and one
+ * notification per connection interval carries all of them (up to the
+ * negotiated MTU). Enabling also requests a short connection interval
+ * and 2M PHY. Hosts opt in with BLE_CMD_SET_BATCH; the mode is reset on
+ * disconnect.
+ * @param enable true for batched notifications
+ */
+void ble_slimevr_set_batch_mode(bool enable);
+
 /**
  * @brief Send magnetometer data notification
  * @param mag Magnetometer reading [x, y, z] in uT
@@ -209,9 +237,20 @@ void ble_slimevr_set_tx_power(int8_t dbm);
 
 /**
  * @brief Process BLE events (call from main loop)
+ *
+ * With USE_RADIO_ARBITER this only runs inside a BLE window granted by
+ * rf_arbiter (between the tracker's TDMA slot and the next beacon).
  */
 void ble_slimevr_process(void);
 
+/**
+ * @brief v0.6.3: BLE part of the shared radio interrupt (USE_RADIO_ARBITER)
+ *
+ * Called from BLE_IRQHandler in rf_hw.c while the arbiter has granted the
+ * radio to BLE.
+ */
+void ble_slimevr_irq_handler(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,7 @@
 #define __BMI270_H__
 
 #include <stdint.h>
+#include "imu_fifo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,6 +66,20 @@ int bmi270_suspend(void);
  */
 int bmi270_resume(void);
 
+/**
+ * @brief v0.6.3: Enable header-mode FIFO (gyro + accel, each at its own ODR) with watermark on INT1
+ * @param watermark Watermark in gyro frames (1..IMU_FIFO_MAX_BATCH)
+ * @return 0 on success, negative on error
+ */
+int bmi270_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: Burst-read up to n FIFO frames, see imu_fifo.h
+ * @param ts Unused: frames carry no per-frame sensortime
+ * @return Frames read, negative on error
+ */
+int bmi270_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #ifdef __cplusplus
 }
 #endif
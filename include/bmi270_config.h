@@ -0,0 +1,22 @@
+/**
+ * @file bmi270_config.h
+ * @brief BMI270 配置文件 (Bosch 特性引擎固件, 初始化时写入 INIT_DATA)
+ *
+ * v0.6.3: 从 bmi270.c 移出, imu_interface.c (tracker 主驱动) 与 bmi270.c 共用;
+ * 只在各自的编译单元内 static, 未引用的副本由 --gc-sections 去掉.
+ */
+
+#ifndef __BMI270_CONFIG_H__
+#define __BMI270_CONFIG_H__
+
+#include <stdint.h>
+
+// Note: Full firmware is ~8KB
+// This is just a placeholder - use the actual firmware from the nRF project
+static const uint8_t bmi270_config_file[] = {
+    // ... BMI270 firmware data goes here ...
+    // Copy from: SlimeVR-Tracker-nRF/src/sensor/imu/BMI270_firmware.h
+    0x00  // Placeholder
+};
+
+#endif /* __BMI270_CONFIG_H__ */
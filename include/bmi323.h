@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 // WHO_AM_I 值
 #define BMI323_DEVICE_ID        0x0043
@@ -107,4 +108,17 @@ void bmi323_power_down(void);
  */
 void bmi323_power_up(void);
 
+/**
+ * @brief v0.6.3: 使能 FIFO (加速度+陀螺+sensortime), 水位中断到 INT1
+ * @param watermark 水位 (帧数, 1..IMU_FIFO_MAX_BATCH)
+ */
+int bmi323_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: 一次突发读取最多 n 帧, 见 imu_fifo.h
+ * @param ts 每帧 sensortime (39.0625us/计数, 扩展为 32 位), 可为 NULL
+ * @return 帧数, 负值失败
+ */
+int bmi323_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #endif /* __BMI323_H__ */
@@ -0,0 +1,34 @@
+/**
+ * @file boot_token.h
+ * @brief v0.6.3 Bootloader 热启动令牌 (应用与 bootloader/ 共用)
+ *
+ * 应用正常运行 BOOT_TOKEN_ARM_MS 后在保持 RAM 起点写入令牌 (wdog_feed 中).
+ * 软件复位/看门狗复位后 bootloader 见到有效令牌即跳过按键消抖和应用检查直接跳转;
+ * 令牌一次性, bootloader 每次启动都先清除, 新镜像在重新写入前只走完整检查路径.
+ * 固件更新 (OTA 写入 / UF2 模式) 前应用主动清除令牌.
+ */
+
+#ifndef __BOOT_TOKEN_H__
+#define __BOOT_TOKEN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_TOKEN_ADDR         0x20006000  // RAM_RET 起点 (.boot_token 段, sdk/Ld/Link.ld)
+#define BOOT_TOKEN_MAGIC        0x4B4F5442  // "BTOK"
+#define BOOT_TOKEN_ARM_MS       3000        // 应用运行多久后视为镜像可用
+#define BOOT_TOKEN_APP_ADDR     0x00001000  // 应用起点 (复位向量所在)
+
+typedef struct {
+    uint32_t magic;             // BOOT_TOKEN_MAGIC
+    uint32_t app_entry;         // 写入时的应用复位向量
+    uint32_t check;             // ~(magic ^ app_entry)
+} boot_token_t;
+
+static inline bool boot_token_valid(const volatile boot_token_t *tok, uint32_t app_entry)
+{
+    return tok->magic == BOOT_TOKEN_MAGIC && tok->app_entry == app_entry &&
+           tok->check == ~(BOOT_TOKEN_MAGIC ^ app_entry);
+}
+
+#endif /* __BOOT_TOKEN_H__ */
@@ -0,0 +1,79 @@
+/**
+ * @file bus_sched.h
+ * @brief v0.6.3 I2C 总线调度 / Prioritized shared-bus scheduler (USE_BUS_SCHED)
+ *
+ * 主/辅助 IMU (I2C 接法) 和磁力计共用一条 I2C 总线. 之前磁力计的异步读取在途时
+ * IMU 的同步读取直接返回 -2 (数据作废), 磁力计读取也要轮询 hal_i2c_busy 找空档.
+ * 本模块统一仲裁:
+ * - 每个客户端一个异步读取队列 (BUS_SCHED_QUEUE_DEPTH 项), 总线空闲时按优先级
+ *   (bus_client_t 数值越小越高) 取下一项, 完成回调在 I2C 中断中调用
+ * - 同步访问 (IMU FIFO/突发读取, 寄存器配置) 等待在途的一次传输结束后立即占用总线,
+ *   排队中的低优先级读取在其后进行, 即在传输边界抢占
+ * - 同步访问只应在主循环上下文调用 (等待依赖 I2C 中断), 最长等待 BUS_SCHED_WAIT_US
+ * - 软件 I2C (USE_HW_I2C=0) 下异步读取在发起时同步完成, 调度退化为按序执行
+ * SPI 接法的 IMU 不经过本模块: SPI0 的访问全部在主循环顺序进行 (DMA 环只服务主 IMU)
+ */
+
+#ifndef __BUS_SCHED_H__
+#define __BUS_SCHED_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BUS_CLIENT_IMU = 0,             // 主 IMU (最高优先级)
+    BUS_CLIENT_IMU_AUX,             // 辅助 IMU (USE_AUX_IMU)
+    BUS_CLIENT_MAG,                 // 磁力计
+    BUS_CLIENT_COUNT
+} bus_client_t;
+
+typedef struct {
+    uint32_t async_done;            // 完成的异步读取 (含失败)
+    uint32_t async_errors;          // 其中 NACK/总线错误
+    uint32_t queue_full;            // 队列满被拒绝
+    uint32_t sync_waits;            // 同步访问遇到在途传输的次数
+    uint32_t wait_timeouts;         // 等待超过 BUS_SCHED_WAIT_US, 访问放弃
+    uint16_t max_wait_us[BUS_CLIENT_COUNT];     // 各客户端同步访问最长等待
+} bus_sched_stats_t;
+
+/**
+ * @brief 排队一次异步寄存器读取
+ * @param buf 在回调之前保持有效
+ * @param callback 完成回调 (I2C 中断上下文, 可为 NULL)
+ * @return 0=已排队, -1=参数错误, -2=该客户端队列已满
+ */
+int bus_sched_read_async(uint8_t client, uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len,
+                         hal_i2c_async_cb_t callback, void *ctx);
+
+/**
+ * @brief 同步读取: 等在途传输结束后占用总线, 完成后派发排队的读取
+ * @return hal_i2c_read_reg 的返回值, -2=等待超时
+ */
+int bus_sched_read(uint8_t client, uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief 同步写入, 同 bus_sched_read
+ */
+int bus_sched_write(uint8_t client, uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t len);
+
+static inline int bus_sched_write_byte(uint8_t client, uint8_t addr, uint8_t reg, uint8_t data) {
+    return bus_sched_write(client, addr, reg, &data, 1);
+}
+
+/**
+ * @brief 客户端尚未完成的异步读取数 (排队 + 在途)
+ */
+uint8_t bus_sched_pending(uint8_t client);
+
+void bus_sched_get_stats(bus_sched_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BUS_SCHED_H__ */
@@ -6,6 +6,10 @@
  * - 信道质量监控 (丢包率/RSSI)
  * - 动态黑名单 (自动禁用差信道)
  * - 自适应跳频序列
+ *
+ * v0.6.3: 统一的信道统计引擎 - rf_protocol_enhanced (rf_channel_*) 与
+ * rf_ultra_v2 (rf_v2_*_channel_*) 不再各自维护信道表, 均读写同一个 ch_manager;
+ * 黑名单 / 跳频序列 / 发射功率判断使用同一份数据
  */
 
 #ifndef CHANNEL_MANAGER_H
@@ -14,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "rf_protocol.h"
+#include "config.h"
 
 /*============================================================================
  * 配置
@@ -24,27 +29,33 @@
 #define CH_RECOVERY_THRESHOLD   10      // 丢包率<10%时恢复
 #define CH_MIN_ACTIVE_CHANNELS  3       // 最少保留3个活跃信道
 #define CH_QUALITY_UPDATE_MS    1000    // 质量更新周期
+#define CH_BLACKLIST_RECOVERY_SEC 30    // 黑名单持续时间 (秒), 到期后重新评估
+#define CH_RSSI_UNKNOWN         (-128)  // 无 RSSI 样本 / 本次结果不带 RSSI
+#define CH_CCA_BUSY_DBM         (-65)   // 空闲 RSSI 扫描: 高于此值视为信道忙
+#define CH_CCA_BUSY_PCT         25      // 扫描忙比例>25%时黑名单 (丢包前主动避让)
+#define CH_CCA_MIN_SAMPLES      4       // 忙比例判定的最少扫描样本数
 
 /*============================================================================
  * 信道质量结构
  *============================================================================*/
 
+// v0.6.3: 位压缩, 每信道 8 字节
 typedef struct {
-    // 10秒窗口统计
-    uint16_t tx_count;          // 发送次数
-    uint16_t ack_count;         // ACK成功次数
-    uint16_t crc_errors;        // CRC错误次数
-    int16_t rssi_sum;           // RSSI累积
-    uint16_t rssi_samples;      // RSSI采样数
+    // 窗口统计 (每个更新周期减半衰减)
+    uint8_t tx_count;               // 发送次数 (饱和时与 ack_count 一起减半)
+    uint8_t ack_count;              // ACK成功次数
+    int8_t avg_rssi;                // RSSI 指数平均, CH_RSSI_UNKNOWN = 无样本
     
-    // 计算值
-    uint8_t loss_rate_pct;      // 丢包率百分比
-    int8_t avg_rssi;            // 平均RSSI
+    // 计算值 / 状态
+    uint8_t loss_rate_pct : 7;      // 丢包率百分比
+    uint8_t blacklisted : 1;        // 是否黑名单
+    uint8_t crc_errors : 4;         // CRC错误次数 (饱和 15)
+    uint8_t recovery_count : 4;     // 恢复尝试次数 (饱和 15)
+    uint8_t blacklist_sec;          // 黑名单剩余时间 (秒)
     
-    // 状态
-    bool blacklisted;           // 是否黑名单
-    uint32_t blacklist_time;    // 黑名单时间
-    uint8_t recovery_count;     // 恢复尝试次数
+    // 空闲时隙 RSSI 扫描 (每个更新周期减半衰减)
+    uint8_t cca_samples;            // 扫描次数
+    uint8_t cca_busy;               // 其中信道忙的次数
 } channel_quality_t;
 
 /*============================================================================
@@ -59,6 +70,9 @@ typedef struct {
     uint32_t last_update_ms;                     // 上次更新时间
 } channel_manager_t;
 
+// v0.6.3: 全局唯一实例 (tracker 与 receiver 共用)
+extern channel_manager_t ch_manager;
+
 /*============================================================================
  * API
  *============================================================================*/
@@ -74,7 +88,7 @@ void ch_mgr_init(channel_manager_t *mgr);
  * @param mgr 管理器指针
  * @param channel 信道号
  * @param ack_received 是否收到ACK
- * @param rssi 信号强度
+ * @param rssi 信号强度, CH_RSSI_UNKNOWN = 不更新 RSSI
  */
 void ch_mgr_record_tx(channel_manager_t *mgr, uint8_t channel, bool ack_received, int8_t rssi);
 
@@ -83,11 +97,23 @@ void ch_mgr_record_tx(channel_manager_t *mgr, uint8_t channel, bool ack_received
  */
 void ch_mgr_record_crc_error(channel_manager_t *mgr, uint8_t channel);
 
+/**
+ * @brief v0.6.3: 记录一次空闲 RSSI 扫描结果 (可在中断中调用)
+ * @param rssi 实时 RSSI, >= CH_CCA_BUSY_DBM 计为信道忙
+ */
+void ch_mgr_record_rssi_scan(channel_manager_t *mgr, uint8_t channel, int8_t rssi);
+
 /**
  * @brief 周期性更新 (每秒调用)
  * @param mgr 管理器指针
+ * @return v0.6.3: true = 本次更新中黑名单有变化
+ */
+bool ch_mgr_periodic_update(channel_manager_t *mgr);
+
+/**
+ * @brief v0.6.3: 导出黑名单位图 (bit = 信道号, 与 rf_receiver_ctx_t::channel_blacklist 相同格式)
  */
-void ch_mgr_periodic_update(channel_manager_t *mgr);
+void ch_mgr_export_blacklist(channel_manager_t *mgr, uint8_t *bitmap, uint8_t len);
 
 /**
  * @brief 获取下一个跳频信道
@@ -108,9 +134,17 @@ bool ch_mgr_is_blacklisted(channel_manager_t *mgr, uint8_t channel);
 
 /**
  * @brief 获取信道质量
+ * @return 0-100 (成功率与 RSSI 综合, 黑名单为 0, 无样本为 50;
+ *         v0.6.3: 没有发送样本但有足够空闲扫描时按空闲比例 0-60)
  */
 uint8_t ch_mgr_get_channel_quality(channel_manager_t *mgr, uint8_t channel);
 
+/**
+ * @brief v0.6.3: 链路 RSSI (各信道平均按发送次数加权), 用于发射功率调整
+ * @return dBm, 无样本时 CH_RSSI_UNKNOWN
+ */
+int8_t ch_mgr_get_link_rssi(channel_manager_t *mgr);
+
 /**
  * @brief 获取活跃信道数
  */
@@ -159,4 +193,18 @@ bool ch_mgr_is_channel_clear(uint8_t channel, int8_t threshold_dbm);
  */
 uint8_t ch_mgr_get_clear_channel(channel_manager_t *mgr, uint8_t max_retries);
 
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY
+/**
+ * @brief v0.6.3: 启动能量普查
+ *
+ * 在 RF_BOOT_SURVEY_MS 内对全部信道做 RF_BOOT_SURVEY_ROUNDS 轮实时 RSSI 采样,
+ * 计入空闲扫描统计, 忙比例超过 CH_CCA_BUSY_PCT 的信道立即拉黑 (最忙的优先,
+ * 保留 CH_MIN_ACTIVE_CHANNELS). 阻塞执行, 须在 rf_hw 初始化之后、接收器开始
+ * 发信标之前调用; 结束后恢复原信道
+ *
+ * @return 拉黑的信道数 (> 0 时调用者导出黑名单并重建跳频表)
+ */
+uint8_t ch_mgr_boot_survey(channel_manager_t *mgr);
+#endif
+
 #endif // CHANNEL_MANAGER_H
@@ -0,0 +1,100 @@
+/**
+ * @file codec_bench.h
+ * @brief Packet codec microbenchmark
+ *
+ * v0.6.3: 对全部四元数编解码路径测量:
+ * - 编码 / 解码周期数 (每样本平均, 按 CODEC_BENCH_BLOCK 个样本一批关中断测量,
+ *   含调用开销; 主机上为 ns)
+ * - 线上字节数 / 样本 (整包格式按包长 ÷ 包内样本数)
+ * - 相对 float 参考姿态的角度误差分布 (RMS / P50 / P99 / max)
+ *
+ * 编解码:
+ *   ultra_f    quat_compress            float → 4x int16           (rf_ultra.c)
+ *   ultra_q15  quat_compress_q15        Q15 符号归一               (rf_ultra.c)
+ *   ultra_pkt  rf_ultra 12 字节数据包                               (rf_ultra.c)
+ *   st48       smallest-three 3x Q14 + 2 位索引                    (rf_ultra_v2.c)
+ *   st40       40-bit smallest-three (USB bundle)                  (rf_ultra_v2.c)
+ *   simple32   compress_quat_simple 32-bit smallest-three          (slime_packet.c)
+ *   rf_pkt     rf_tracker_packet_t + CRC16 → slime_tracker_data_t  (标准数据包)
+ *   multi      多样本聚合包 (USE_RF_MULTI_SAMPLE)
+ *   delta      增量流, 每包立即 ACK (USE_RF_DELTA_STREAM)
+ *
+ * 输入: 无状态编解码用均匀分布的随机姿态 (覆盖最坏情况),
+ * multi/delta 用连续轨迹 (三轴合成运动, 峰值约 540°/s), 均为固定种子
+ *
+ * 片上: make TARGET=bench, 结果以 "CB ..." 行经 usb_debug 输出 (见 main_bench.c)
+ * 主机: make codec-bench
+ */
+
+#ifndef __CODEC_BENCH_H__
+#define __CODEC_BENCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef CODEC_BENCH_SAMPLES
+#define CODEC_BENCH_SAMPLES         1024    // 每个编解码的样本数 (误差表 2 字节/样本)
+#endif
+
+#ifndef CODEC_BENCH_BLOCK
+#define CODEC_BENCH_BLOCK           32      // 一次计时窗口的样本数
+#endif
+
+#ifndef CODEC_BENCH_TRAJ_HZ
+#define CODEC_BENCH_TRAJ_HZ         800     // 连续轨迹采样率
+#endif
+
+/*============================================================================
+ * Results
+ *============================================================================*/
+
+typedef struct {
+    const char *codec;
+    bool trajectory;            // true = 连续轨迹, false = 随机姿态
+    uint32_t enc_cycles;        // 每样本平均
+    uint32_t dec_cycles;
+    float bytes_per_sample;
+    float err_rms_deg;
+    float err_p50_deg;
+    float err_p99_deg;
+    float err_max_deg;
+    uint32_t samples;
+    uint32_t failures;          // 解码失败 (CRC/格式/缺参考) 的样本数, 不计入误差
+} codec_bench_result_t;
+
+typedef void (*codec_bench_report_cb_t)(const codec_bench_result_t *result);
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * @brief 编解码数量 (随 config.h 开关变化)
+ */
+uint8_t codec_bench_count(void);
+
+/**
+ * @brief 跑单个编解码
+ * @return 0=成功, -1=参数错误
+ */
+int codec_bench_run(uint8_t codec, codec_bench_result_t *result);
+
+/**
+ * @brief 依次跑全部编解码, 每个完成后回调
+ * @return 完成的编解码数
+ */
+int codec_bench_run_all(codec_bench_report_cb_t cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CODEC_BENCH_H__ */
@@ -59,12 +59,26 @@
 #define FUSION_VQF_OPT          2   // 平衡精度与性能，120B RAM
 #define FUSION_VQF_SIMPLE       3   // 基础实现，80B RAM
 #define FUSION_EKF              4   // 扩展卡尔曼滤波，200B RAM
+#define FUSION_VQF_FIXED        5   // v0.6.3: Q30定点VQF Advanced，支持磁力计，120B RAM
+#define FUSION_EKF_FIXED        6   // v0.6.3: Q30定点误差状态EKF (6轴, 上三角协方差)，156B RAM
 
 // v0.6.2: 默认使用 VQF Advanced (完整功能，支持磁力计)
 #ifndef FUSION_TYPE
 #define FUSION_TYPE             FUSION_VQF_ADVANCED
 #endif
 
+// v0.6.3: vqf_ultra 四元数以 Q30 累加 (其余仍为 Q15, +8B RAM), 慢速旋转不再因
+// Q15 舍入漂移; 每样本多约 30 次 32x32->64 乘法
+#define VQF_ULTRA_QUAT_Q30      0
+
+// v0.6.3: 运行时切换融合引擎 (启用时替代 FUSION_TYPE) - 同时编译 vqf_ultra 与
+// FUSION_SWITCH_ACCURATE (FUSION_VQF_ADVANCED 或 FUSION_EKF_FIXED), 共用状态存储,
+// 经融合检查点交接姿态/偏差; 低电量或持续静止时降到 ultra, 运动时升回精确引擎
+#define USE_FUSION_SWITCH       0
+#ifndef FUSION_SWITCH_ACCURATE
+#define FUSION_SWITCH_ACCURATE  FUSION_VQF_ADVANCED
+#endif
+
 // 兼容旧配置: 取消注释以使用 EKF
 // #define USE_EKF_INSTEAD_OF_VQF
 
@@ -192,13 +206,75 @@
 // 自动休眠 (0 = 禁用, 单位毫秒)
 #define AUTO_SLEEP_TIMEOUT_MS   300000  // 5分钟静止后进入深睡眠（v0.6.2更新）
 
+// v0.6.3: 唤醒分段计时 (复位 → 首次同步, 及进入 Shutdown 耗时), usb_debug 0x1A 读出
+#define USE_WAKE_PROFILE        1
+// v0.6.3: 快速唤醒 - 深睡眠复位跳过启动闪烁, IMU 型号/总线从保持 RAM 直接验证 (不逐条探测);
+// 轻度睡眠唤醒只重新配置 IMU (不重新检测) 并恢复融合器检查点 (不重新收敛)
+#define USE_FAST_WAKE           1
+
+// v0.6.3: 即开即用 - 上电直接用存储的陀螺偏置 (+ 温度补偿) 开始追踪, 不再等待校准;
+// 首个加速度计判定的静止窗口检查存储偏置, 残差超过 GYRO_BIAS_CHECK_DPS 才执行显式校准.
+// 之后每段 REST 累积 GYRO_REFINE_SAMPLES 个样本按 GYRO_REFINE_ALPHA 并入偏置,
+// 变化超过 GYRO_REFINE_SAVE_DPS 且距上次写入超过 GYRO_REFINE_SAVE_MS 时后台写回
+#define USE_GYRO_BIAS_REFINE    1
+#define GYRO_BIAS_CHECK_SAMPLES 100     // 检查窗口 (0.5s @ 200Hz)
+#define GYRO_BIAS_CHECK_DPS     1.0f    // 须低于 motion_state 静止门限 (1.5 dps), 否则判不出 REST
+#define GYRO_BIAS_STILL_G       0.02f   // 检查窗口内加速度每轴变化上限
+#define GYRO_REFINE_SAMPLES     400     // 2s @ 200Hz
+#define GYRO_REFINE_ALPHA       0.25f
+#define GYRO_REFINE_SAVE_DPS    0.05f
+#define GYRO_REFINE_SAVE_MS     300000  // Flash 磨损: 最多 5 分钟写一次
+
+// v0.6.3: IMU 片上运动引擎 (ICM-42688/45686 SMD + APEX 倾斜) - 睡眠只在显著运动/倾斜时唤醒,
+// 单次磕碰不再唤醒后空等静止超时; 静止计时期间读 IMU WOM 状态复核. 其它 IMU 退回阈值 WOM
+#define USE_IMU_MOTION_ENGINE   1
+#define IMU_MOTION_WAKE_MG      WOM_THRESHOLD_MG
+#define IMU_MOTION_STILL_MG     60      // 相对静止开始时的姿态, 约 3.5° 倾斜
+#define IMU_MOTION_POLL_MS      250     // 静止计时期间读取 IMU 状态的间隔
+
+// v0.6.3: 唤醒 FIFO 回放 (依赖 USE_FAST_WAKE) - 轻度睡眠期间陀螺 + 加速度计以 50Hz 写入 IMU FIFO
+// (满后覆盖最旧帧, 约 2.5s, 覆盖显著运动判定和唤醒延迟), 唤醒后先把 FIFO 中的帧只做陀螺积分
+// 回放进融合器检查点, 第一帧即为当前姿态 (不再从睡前姿态重新收敛). 只支持 ICM-42688/45686,
+// 睡眠电流增加陀螺低噪声模式一项 (约 0.5mA); 深睡眠复位时 IMU 已重新初始化, 不回放
+#define USE_WAKE_FIFO_CATCHUP   1
+
+// v0.6.3: IMU 功耗档随共享运动状态和电量切换 (依赖 USE_IMU_FIFO_TIMESTAMP) - 运动: 全速 SENSOR_ODR_HZ;
+// 微静: 1/2; 静止 (REST): 1/4 + 加速度计低功耗; 低电量时运动也只用 1/2.
+// 融合按实际样本间隔积分, RF 发送分频不低于 IMU 分频
+#define USE_IMU_POWER_PROFILE   1
+#define IMU_PROFILE_HOLD_MS     1000    // 降档前在当前档的最短停留时间 (升档立即)
+
 // 长按进入休眠时间
 #define LONG_PRESS_SLEEP_MS     3000    // 3 秒
 
+// v0.6.3: 按键改为边沿中断 + 节拍单次计时 (去抖 / 长按 / 双击窗口), 主循环不再轮询引脚,
+// 识别结果经 EVQ_BUTTON 投递给事件循环
+#define USE_BUTTON_IRQ          1
+
 // 低电量阈值
 #define BATTERY_LOW_PERCENT     10      // 10%
 #define BATTERY_CRITICAL_PERCENT 5      // 5% (强制休眠)
 
+// v0.6.3: 整数电量计 - LiPo 放电曲线查表 + 内阻负载补偿 + IIR 滤波, 估算剩余时间;
+// 只在 RF 空闲窗口采样 (避开发射电流尖峰), usb_debug 0x13 读出
+#define USE_FUEL_GAUGE          1
+#define FG_CAPACITY_MAH         300     // 电池容量
+#define FG_RINT_MOHM            150     // 电芯内阻 + 保护板 + 走线
+#define FG_IDLE_MIN_US          1000    // 采样需要的最短 RF 空闲时间
+#define FG_IDLE_WAIT_MS         2000    // 等不到空闲窗口时照常采样
+
+// v0.6.3: LED 图案由 TMR0 1ms 节拍中断驱动 (图案表), 主循环只在状态切换时选图案;
+// 亮期内按 LED_PWM_ON_MS / LED_PWM_PERIOD_MS 占空比调光, 降低 LED 电流
+#define USE_LED_PATTERN         1
+#define LED_PWM_PERIOD_MS       4       // 250Hz, 不可见闪烁
+#define LED_PWM_ON_MS           1       // 25% 占空比
+
+// v0.6.3: 接收器快速启动 - 上电闪烁不再阻塞 (主循环/LED 节拍驱动, 持续 RX_BOOT_BLINK_MS);
+// 先使能 USB 上拉, 主机枚举 (中断驱动) 与 RF 初始化并行; RF 就绪即发信标,
+// 首次上电的配置写入推迟到信标启动之后. tracker 等首个信标, 接收器启动时间直接计入套件启动时间
+#define USE_RX_FAST_BOOT        1
+#define RX_BOOT_BLINK_MS        600
+
 /*============================================================================
  * v0.5.1 WOM唤醒引脚配置 (板级配置化)
  * 注意: WOM引脚不可与SPI-CS复用！
@@ -231,8 +307,36 @@
 
 #define SENSOR_ODR_HZ           200     // 传感器采样率
 #define FUSION_RATE_HZ          200     // 融合算法运行频率
+// v0.6.3: FUSION_RATE_HZ < SENSOR_ODR_HZ 时 (如 800/100), 支持分步接口的引擎
+// (vqf_advanced / vqf_fixed / ekf_fixed) 在 ODR 下只做陀螺仪捷联积分,
+// 加速度/磁力计校正每 FUSION_CORRECT_DIV 个样本一次; 校正步占更新的大部分开销,
+// 约 100Hz 以上不再提高精度. IMU 驱动的 ODR 寄存器需与 SENSOR_ODR_HZ 一致
+#define FUSION_CORRECT_DIV      (SENSOR_ODR_HZ / FUSION_RATE_HZ)
+// v0.6.3: 降频校正时, 区间内的陀螺仪样本先预积分 (二阶锥运动补偿) 再一次性应用,
+// 每样本只剩两次叉乘; 代价是姿态输出降到 FUSION_RATE_HZ. FUSION_CORRECT_DIV = 1 时无效
+#define USE_GYRO_PREINT         0
+// v0.6.3: 惰性四元数归一化 (浮点引擎 vqf_advanced/vqf_opt/vqf_simple/ekf_ahrs) -
+// 模长误差低于阈值时跳过, 小误差用一阶修正代替 inv-sqrt (fast_math.h fm_quat_renorm).
+// 0 = 每次更新完整归一化
+#define USE_LAZY_QUAT_NORM      1
 #define RF_REPORT_RATE_HZ       200     // RF 数据上报频率
 
+// v0.6.3: 陀螺仪中值滤波窗口 (奇数, 3-31), 增量排序窗口, 每样本代价与窗口基本无关
+// 廉价 IMU 尖峰噪声较多时可加大到 9-15
+#define GYRO_MEDIAN_WINDOW      5
+
+// v0.6.3: 陀螺仪滤波级编译期选择, 未编译的级运行时开关无效, 也不占 RAM
+// GYRO_FILTER_DETECT_ONLY=1 时只做静止检测 (每轴增量均值/方差), 不运行任何滤波级,
+// 不产生滤波输出 - 主循环只用 gyro_filter_is_stationary()
+#define GYRO_FILTER_DETECT_ONLY 1
+#define GYRO_FILTER_MEDIAN      1   // 以下三项仅 GYRO_FILTER_DETECT_ONLY=0 时有效
+#define GYRO_FILTER_MOVING_AVG  1
+#define GYRO_FILTER_KALMAN      0
+
+// v0.6.3: VQF Advanced 的静止状态取共享 motion_state (与自动校准/功耗/RF 分频一致),
+// 不再在融合内部重复检测
+#define VQF_EXTERNAL_REST       1
+
 /*============================================================================
  * 追踪器配置 / Tracker Configuration
  *============================================================================*/
@@ -242,7 +346,23 @@
  * 固定为10，以保证200Hz(5ms)超帧的稳定性
  * 时隙预算: SYNC(250us) + GUARD(250us) + 10*SLOT(400us) + TAIL(500us) = 5000us
  *============================================================================*/
+// v0.6.3: 多超帧调度 (需 USE_ADAPTIVE_SUPERFRAME)
+// 时隙按实际包空口时间缩短, 每个tracker可按 200/100/50Hz 交错分布在连续
+// 超帧中 (rf_receiver_set_tracker_rate / USB 命令 0x13), 单个接收器支持 16-24 个
+#define USE_MULTI_SUPERFRAME    0
+
+// v0.6.3: 运动自适应速率 (需 USE_MULTI_SUPERFRAME) - tracker 静止 (包标志
+// RF_FLAG_STATIONARY) 持续 RF_MOTION_RATE_HOLD_MS 后接收器把它排到 50Hz,
+// 腾出的主时隙变为其他 tracker 的备用时隙; 标志清除的首个包即恢复主机设定速率
+#define USE_RF_MOTION_RATE      0
+#define RF_MOTION_RATE_HOLD_MS  500     // 静止保持时间
+#define RF_MOTION_RATE_DIV      4       // 静止时分频 (1/2/4, 4 = 50Hz)
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+#define MAX_TRACKERS            24
+#else
 #define MAX_TRACKERS            10      // 固定10个tracker，保证200Hz稳定性
+#endif
 
 // 旧配置（保留参考）
 // #ifdef CH591
@@ -302,6 +422,13 @@
 // #define DEBUG_UART               // 使用 UART 调试
 // #define DEBUG_USB                // 使用 USB CDC 调试
 
+// v0.6.3: 令牌化日志 - LOG_ERR/WARN/INFO/DBG 不在设备上格式化: 格式串放进不下载的 .logstr 段
+// (Link.ld, 令牌 = 段内 16 位地址), 设备只把令牌和整数参数 (zigzag varint) 写入事件环,
+// tools/event_dump.py --elf 从同一 ELF 取出格式串还原. 仅 CH59X 目标, 主机构建仍按
+// DEBUG_ENABLE 走 printf. LOG_TOKEN_LEVEL: 0 = ERR, 1 = WARN, 2 = INFO, 3 = DBG
+#define USE_LOG_TOKENS          1
+#define LOG_TOKEN_LEVEL         2
+
 /*============================================================================
  * 功耗分析 / Power Consumption Analysis
  * 
@@ -379,17 +506,192 @@
 // 注意: USE_SENSOR_OPTIMIZED 和 USE_SENSOR_DMA 不能同时启用!
 
 #define USE_SENSOR_OPTIMIZED    1   // 推荐：FIFO+中断驱动
+
+// v0.6.3: IMU FIFO 水位批量模式 (依赖 USE_SENSOR_OPTIMIZED)
+// 水位中断触发一次突发读取 N 帧, 融合按批处理, 每帧带时间戳
+#define USE_SENSOR_FIFO_BATCH   1
+#define SENSOR_FIFO_WATERMARK   2   // 帧数 (1-8), 越大唤醒越少、延迟越高
+// v0.6.3: 解析 IMU FIFO 时间戳, 融合按每帧实际 dt 积分 (依赖 USE_SENSOR_FIFO_BATCH)
+// ICM-42688/45686/LSM6DSV/LSM6DSR 支持; IMU 时钟由水位中断时刻按 MCU 晶振标定
+#define USE_IMU_FIFO_TIMESTAMP  1
+
+// v0.6.3: IMU 采样相位锁定到 RF 超帧 (MCU PA6 输出 32kHz 到 IMU CLKIN 并闭环微调)
+// 需要硬件连线, 仅 ICM-42688/45686; 占用 TMR1 (与 hal_hr_timer 互斥)
+#define USE_IMU_CLOCK_SYNC      0
+
+// v0.6.3: 硬件时间戳 - RF 接收时刻在 RF 中断入口锁存 (信标处理/校验不再计入同步时刻);
+// HW_TS_IMU_CAPTURE = 1 时 IMU INT1 同时接到 TMR1 捕获输入 PA10, 数据就绪/水位沿由定时器
+// 按系统时钟锁存, 中断里换算到 hal_micros 时基 (不含中断响应延迟), 沿间隔给出 MCU 晶振下的
+// 实际采样周期. 捕获需要硬件连线 (mingyue 板 PA10 为 CHRG 检测, 需改板), 占用 TMR1
+#define USE_HW_TIMESTAMP        0
+#define HW_TS_IMU_CAPTURE       1
+
+// v0.6.3: 即时采样 - 在本 tracker 发射时隙前 JIT_SAMPLE_LEAD_US 突发读取 FIFO
+// 并完成融合, 发送的姿态不再是上一次水位中断时的旧数据 (依赖 USE_SENSOR_FIFO_BATCH)
+#define USE_JIT_SAMPLING        1
+#define JIT_SAMPLE_LEAD_US      500     // 读取 + 融合 + 打包预算, 需小于 IMU_CLKSYNC_LEAD_US
+
+// v0.6.3: 发送帧预组 - 主时隙的数据帧 (当前格式, 含校验) 在时隙等待之前组好,
+// 样本年龄按预计发送时刻计算; 时隙到达后只切信道/发送, 不再做浮点转换、压缩和 CRC.
+// 配合 USE_JIT_SAMPLING 时组包紧接在时隙前的采样/融合之后
+#define USE_RF_TX_PRESTAGE      1
+
+// v0.6.3: BMI270 冷启动 - SPI 下配置文件 (~8KB) 由 DMA 按 BMI270_CFG_BURST 字节突发上传,
+// 在 RF/存储初始化期间后台进行 (imu_init_start / imu_init_finish);
+// MCU 热复位后 IMU 仍报告配置已加载时跳过上传. 0 = 同步 PIO 上传
+#define USE_BMI270_DMA_UPLOAD   1
+#define BMI270_CFG_BURST        256     // 每次突发字节数 (RAM 双缓冲, DMA 不能读 Flash)
+
+// v0.6.3: LSM6DSV 片上 SFLP 融合 (依赖 USE_SENSOR_FIFO_BATCH) - 游戏旋转向量随 FIFO 读出,
+// 检测到 LSM6DSV 时 MCU 不再运行 FUSION_UPDATE, 只在静止时锁定航向抵消残余偏置漂移;
+// 其它 IMU 仍由 MCU 融合. 无磁力计航向校正, 精度低于 VQF
+#define USE_IMU_SFLP            0
+#define SFLP_ODR_HZ             120     // 15/30/60/120/240/480, 不高于 FIFO 的 240Hz
+
+// v0.6.3: 陀螺/加速度计分开 ODR (依赖 USE_SENSOR_FIFO_BATCH) - 姿态校正只需 50-100Hz 加速度,
+// 陀螺积分保持 SENSOR_ODR_HZ; FIFO 使能时加速度计 ODR 比陀螺低 IMU_ACCEL_ODR_SHIFT 档 (每档减半),
+// 批量读取按帧标记是否带新加速度 (imu_fifo_accel_mask), 不带的帧沿用上一次的加速度.
+// LSM6DSV/DSR、BMI270 (改为带帧头 FIFO) 的 FIFO 字节随之减少, ICM 包长固定只省加速度计功耗;
+// SFLP 打开时 LSM6DSV 保持同 ODR
+#define USE_IMU_MIXED_ODR       1
+#define IMU_ACCEL_ODR_SHIFT     2       // 200/240Hz 陀螺 → 50/60Hz 加速度, 1..3
+
+// v0.6.3: 辅助 IMU (扩展板, 与主 IMU 共用 SPI/I2C 总线, 依赖 USE_SENSOR_FIFO_BATCH)
+// SPI 下用独立片选 IMU_AUX_SPI_CS_PIN, I2C 下用主 IMU 未占用的另一个地址; 不接中断,
+// 每次主 IMU 水位突发后紧接着读取其 FIFO, 总线访问全部在主循环中顺序进行.
+// 辅助 IMU 独立融合, 两个姿态合在一个双姿态包 (RF_DUAL_HEADER) 中发送, 接收器经
+// USB 报告 0x05 上报; 未检测到辅助 IMU 时行为与关闭时相同
+#define USE_AUX_IMU             0
+#define IMU_AUX_SPI_CS_PIN      GPIO_Pin_5      // GPIOA
+
+// v0.6.3: 陀螺量程自动切换 (imu_interface 的 ICM-42688/45686, BMI270, LSM6DSV/DSR)
+// 解码时检测饱和, 主循环在两次读取之间切换: 饱和立即放宽一档, 静止/慢速时收窄一档换取分辨率.
+// 切换时 FIFO 中已有的旧量程样本在解码时换到新量程计数, 融合输入的换算连续
+#define USE_GYRO_AUTO_RANGE     0
+#define GYRO_RANGE_MIN_DPS      500     // 500/1000/2000
+#define GYRO_RANGE_MAX_DPS      4000    // 2000/4000, 型号不支持 4000 时停在 2000
+#define GYRO_RANGE_SAT_RAW      32000   // |原始计数| 达到此值视为饱和
+#define GYRO_RANGE_NARROW_PCT   40      // 峰值低于下一档满量程的百分比才收窄
+#define GYRO_RANGE_HOLD_MS      2000    // 收窄前需持续的时间 (放宽后也按此保持)
+#define GYRO_RANGE_SETTLE_SAMPLES 1     // 写量程时正在转换、仍为旧量程的样本数
+
+// v0.6.3: 每设备 SPI 时钟档 (hal_spi_profile_*). 每个 SPI 设备 (主/辅助 IMU) 记录自己的
+// 最高 SCK, 换片选时切换分频, power_set_clock_mode 切换系统时钟后按新时钟重新派生分频
+// (SCK = Fsys / div, div >= 2). 启动检测到 IMU 后、配置传感器之前, 从型号手册上限
+// 逐档降低, 选出连续 SPI_QUALIFY_REPEAT 次 WHO_AM_I 和数据寄存器块都与保守时钟下
+// 读出一致的最高一档, 再退一档留余量. 0 = 固定 60MHz / 8 (7.5MHz)
+#define USE_SPI_PROFILES        1
+#define SPI_IMU_DEFAULT_HZ      7500000 // 保守档 (未验证 / 验证失败时)
+#define SPI_QUALIFY_REPEAT      16      // 每档重复读取次数
 // #define USE_SENSOR_DMA       0   // 备选：DMA异步读取 (与OPTIMIZED互斥)
 
+// v0.6.3: 事件驱动主循环 (仅 tracker)
+// IMU 数据就绪 / RF 帧定时 / 按键中断投递事件, 队列为空时 WFI 休眠
+// 0 = 旧的 100us 轮询主循环
+#define USE_EVENT_LOOP          1
+
+// v0.6.3: 分级时间轮 (include/timer_wheel.h) - 模块装载单次/周期定时器, 主循环每次迭代
+// tw_process() 调用到期回调, 替代各处 hal_get_tick_ms() 的比较 (电池采样间隔, 接收器配对超时).
+// 槽表约 270B RAM
+#define USE_TIMER_WHEEL         1
+
+// v0.6.3: 硬件 I2C 外设 (PB12/PB13) + 中断驱动异步读取
+// 0 = 使用 GPIO 软件模拟 I2C (兼容旧板)
+#define USE_HW_I2C              1
+
+// v0.6.3: I2C 总线调度 (bus_sched). I2C 接法的 IMU 和磁力计按优先级共用总线:
+// 磁力计读取排队异步进行, IMU 同步读取只等在途的一次传输结束 (传输边界抢占),
+// 不再因磁力计占用总线而读取失败. 0 = 各驱动直接调用 hal_i2c
+#define USE_BUS_SCHED           1
+#define BUS_SCHED_QUEUE_DEPTH   2       // 每客户端异步读取队列深度
+#define BUS_SCHED_WAIT_US       2000    // 同步访问最长等待 (400kHz 下约 80 字节)
+
 // USB调试输出 (通过USB CDC输出调试信息)
 #define USE_USB_DEBUG           1
 
+// v0.6.3: 有线数据流 (Tracker, 需 USE_USB_DEBUG). 应用以 HID 枚举 (之前只枚举 MSC,
+// usb_debug 在 tracker 上无法使用), 主机发 usb_debug 0x32 后每个 IMU 样本发送一个
+// 0xFD 报告 (1ms 轮询), 期间 RF 休眠, 接收器上该时隙超时后降为静止速率.
+// UF2 拖放仍可用: 0x22 命令断开 HID 后以 MSC 重新枚举. 0 = 应用启动即枚举 MSC
+#define USE_USB_WIRED_STREAM    1
+#define USB_REENUM_DETACH_MS    50      // HID → MSC 切换时断开上拉的时间
+
+// v0.6.3: 原始 IMU 全速率采集 (调试用, 默认关闭, 需 USE_USB_DEBUG)
+// 记录驱动解码后的 int16 样本和换算参数, 经 usb_debug 数据流 (stream_mask bit5)
+// 输出, tools/imu_capture.py 保存后可离线复现融合输入; 约 450B RAM
+#define USE_IMU_CAPTURE         0
+
+// v0.6.3: 器件特性测量 (调试用, 默认关闭, 需 USE_USB_DEBUG) - usb_debug 0x1B 启动, tracker 静置:
+// 陀螺 Allan 偏差 (噪声密度/零偏不稳定性), 实际 ODR, IMU 读取/融合/RF 往返耗时;
+// 测量期间推迟自动睡眠并固定 IMU 功耗档. tools/selftest.py 读出并计算; 约 1.2KB RAM
+#define USE_SELFTEST            0
+#define SELFTEST_DEFAULT_S      600     // 默认测量时长
+#define SELFTEST_MAX_S          3600
+#define SELFTEST_ADEV_LEVELS    20      // τ = τ0 .. τ0·2^19 (240Hz 下最长约 36 分钟)
+
 // BLE蓝牙功能 (暂未完整实现)
 // #define USE_BLE_SLIMEVR      0
 
+// v0.6.3: BLE 传感器通知批量打包 (ble_slimevr.c, 主机发 BLE_CMD_SET_BATCH 开启)
+// 每个连接间隔一个通知, 按协商 MTU 装入多个带时间戳样本, 并请求 7.5-15ms 间隔 + 2M PHY
+#define USE_BLE_NOTIFY_BATCH    1
+
+// v0.6.3: 射频时分仲裁 (tracker, 需 USE_BLE_SLIMEVR 和 WCH BLE 协议栈库)
+// 私有 TDMA 链路用完本帧时隙后把射频交给 BLE, 下一信标前 RF_ARB_GUARD_US 收回;
+// BLE 以 50ms 连接间隔作低速率配置通道 (手机 App), 不打断数据流
+#define USE_RADIO_ARBITER       0
+#define RF_ARB_GUARD_US         400     // 窗口结束到下一信标 (> EVQ_RF_WAKE_ADVANCE_US)
+#define RF_ARB_MIN_WINDOW_US    1500    // 短于此不交给 BLE (一个连接事件 + 射频切换)
+
 // 诊断模块 (用于性能分析和故障排查)
 #define USE_DIAGNOSTICS         1
 
+// v0.6.3: mcycle 周期计数探针 (调试用, 默认关闭; 关闭时探针宏展开为空)
+// 主循环/融合/RF/USB/各中断入口的次数、最小/最大/累计周期数,
+// 经 usb_debug 0x16 命令读出 (tools/profile_dump.py)
+#define USE_PROFILE             0
+
+// v0.6.3: 按负载调节 MCU 时钟 (依赖 USE_PROFILE) - 每超帧用探针统计忙周期, 选能在
+// CLOCK_GOV_TARGET_PCT 占空内完成峰值负载的最低档 (60/32/8MHz), 取代按运动状态升到全速;
+// 换频时 TMR0/TMR2/TMR3 按新时钟重新装载, hal_micros 保持连续
+#define USE_CLOCK_GOVERNOR      0
+#define CLOCK_GOV_TARGET_PCT    60      // 所选时钟下忙时间占超帧的上限
+#define CLOCK_GOV_DOWN_FRAMES   50      // 连续满足该帧数才降一档 (升档立即)
+
+// v0.6.3: RAM 热代码分层 (optimize.h RAM_CODE_ISR / RAM_CODE_FUSION) - 60MHz 下 Flash 取指
+// 有等待周期, 直接拉长时隙定时中断的延迟. ISR 层: RF 时隙定时/收包中断, 接收器 USB 中断,
+// 1ms 节拍子任务 (CRC 与 RF/GPIO/TMR 中断入口已是 __HIGH_CODE); 融合层: 每样本的
+// VQF 传播/加速度校正. 总量受 Makefile HIGHCODE_BUDGET 限制, 超出时链接报错
+#define USE_RAM_HOTCODE         1
+#define RAM_HOTCODE_FUSION      1       // 融合层 (约 2-3KB, RAM 紧张时关闭)
+
+// v0.6.3: RAM 集中区 (optimize.h RAM_ARENA) - 事件环、IMU/DMA 缓冲、每 tracker 表等
+// 放入一块连续区域, 总量受 Makefile RAM_ARENA_BUDGET 限制; make ram-report 按模块列出
+// 全部 RAM (data/bss/集中区/堆栈) 占用
+#define USE_RAM_ARENA           1
+
+// v0.6.3: 主循环任务耗时预算 (tracker; 预算见 watchdog.h, usb_debug 0x19 读出)
+// 超预算按任务计数并记入事件环; TASK_BUDGET_SHED=1 时迭代迟到跳过 LED/电池读取
+#define USE_TASK_BUDGET         1
+#define TASK_BUDGET_SHED        0       // 卸载模式默认值, 运行时可经 0x19 切换
+
+// v0.6.3: 崩溃时序快照 (依赖 USE_TASK_BUDGET) - 最近 4 次主循环迭代的各任务耗时记在保持 RAM 中,
+// HardFault/死锁/硬件看门狗复位后与崩溃快照一起读出 (usb_debug 0x1D, tools/crash_dump.py);
+// 启用 USE_PROFILE 时另存探针表. 约 270 字节 RAM2K 保持区
+#define USE_CRASH_TIMING        1
+
+// v0.6.3: 跨重启的每会话遥测汇总 (丢包率/RSSI 直方图/漏信标/睡眠唤醒/主循环耗时)
+// 周期快照经 KV 后台写入, 保留最近几次上电的汇总, usb_debug 0x18 读出 (tools/telemetry_dump.py)
+#define USE_TELEMETRY_HISTORY   1
+#define TELEM_SAVE_INTERVAL_S   600     // 周期快照间隔 (每次约 50 字节 Flash)
+
+// v0.6.3: 设备端窗口统计 (长稳测试) - 每 SOAK_WINDOW_MS 一个窗口, 记录主循环间隔/丢包/RSSI/
+// 漏信标/电量/中断耗时 (中断项需 USE_PROFILE) 的最小/最大/平均值, 存入 RAM 环,
+// usb_debug 0x1C 按序号批量读出 (tools/longrun_logger.py); 每窗口 28 字节
+#define USE_SOAK_STATS          1
+#define SOAK_WINDOW_MS          1000
+#define SOAK_RING_DEPTH         32      // 窗口数 (2 的幂, <= 128), 主机两次读取间隔须小于此
+
 /*============================================================================
  * v0.6.2 高级功能开关
  *============================================================================*/
@@ -415,12 +717,310 @@
 // RF Ultra模式 (极限性能) - 已初始化，待深度集成
 #define USE_RF_ULTRA            1
 
+// v0.6.3: 自适应超帧 - 只为活跃tracker紧凑分配时隙, 剩余空口时间
+// 作为备用时隙 (重传/第二样本), 布局随同步信标下发 (两端需同时启用)
+#define USE_ADAPTIVE_SUPERFRAME 1
+
+// v0.6.3: 自适应时隙保护时间 (依赖 USE_ADAPTIVE_SUPERFRAME, 两端需同时启用) -
+// 接收器统计每个 tracker 的包到达偏移 (均值 + 平均绝对偏差), 按最差 tracker
+// 收窄时隙两侧保护时间, 连续漏收时立即放宽; 宽度随信标下发
+// 收窄后同一超帧可容纳更多时隙 (备用时隙 / 多超帧调度的主时隙)
+#define USE_RF_ADAPTIVE_GUARD   1
+#define RF_GUARD_MIN_US         10      // 保护时间下限 (每侧)
+#define RF_GUARD_MARGIN_US      8       // 统计值之上的固定余量
+
+// v0.6.3: 可变超帧速率 (依赖 USE_ADAPTIVE_SUPERFRAME, 两端需同时启用) - 接收器按活跃
+// tracker 数 (1Mbps 回退的算两个时隙) + 备用时隙选择能容纳全部主时隙的最快一档
+// 200/250/333/400Hz, 信标提前 RF_FRAME_RATE_ANNOUNCE 帧通告切换帧, tracker 跟随信标.
+// RF_SUPERFRAME_US 仍是最长超帧 (决定数组容量), 运行时周期为 RF_FRAME_US.
+// 加速需条件持续 RF_FRAME_RATE_HOLD_MS, 减速 (tracker 加入/回退) 立即通告; 配对期间 200Hz
+#define USE_RF_FRAME_RATE       1
+#define RF_FRAME_RATE_MAX       3       // 允许的最高档 (0-3 = 200/250/333/400Hz)
+#define RF_FRAME_RATE_SPARE     1       // 至少保留的备用时隙数
+#define RF_FRAME_RATE_HOLD_MS   3000    // 加速前条件需持续的时间
+#define RF_FRAME_RATE_ANNOUNCE  12      // 切换通告提前量 (帧, 1-15)
+
+// v0.6.3: 多样本聚合上行 (依赖 USE_RF_ULTRA) - 每个时隙上传 1-4 个
+// 增量压缩 + 子帧时间戳的姿态样本; >200Hz 需要 SENSOR_ODR_HZ 同步提高
+#define USE_RF_MULTI_SAMPLE     1
+#define RF_MULTI_SAMPLE_HZ      800     // 样本缓存速率上限
+
+// v0.6.3: 样本时间基准 (两端需同时启用) - 标准数据包带样本年龄 (距发送时刻),
+// 接收器把样本时刻换算为 超帧号 + 帧内偏移; USB 命令 0x23 返回接收器时钟与
+// 帧起点, 主机据此把帧报告的样本时刻映射到主机时钟 (多样本/增量/原始包已带年龄)
+#define USE_RF_SAMPLE_TIME      1
+
+// v0.6.3: 融合卸载 (依赖 USE_RF_ULTRA, 两端需同时启用) - tracker 不运行 FUSION_UPDATE,
+// 每个时隙上传最近 2 个已校准的原始陀螺/加速度样本 (基准 + int8 增量),
+// 接收器为每个 tracker 运行一个 Q30 定点 VQF 实例, 主循环按预算轮转调度
+// tracker 省去融合运算; 接收器每 tracker 增加约 170B RAM
+#define USE_FUSION_OFFLOAD      0
+#define RX_FUSION_BUDGET        8       // 每次主循环最多执行的融合更新次数
+
+// v0.6.3: 选择性重传 (依赖 USE_RF_MULTI_SAMPLE + USE_ADAPTIVE_SUPERFRAME) -
+// 未收到 ACK 的聚合包在本帧或下一帧的备用时隙中重发 (样本年龄重新计算),
+// 超过 RF_RETX_DEADLINE_US 的包已错过接收器播放时刻, 直接放弃
+#define USE_RF_SELECTIVE_REPEAT 1
+#define RF_RETX_DEADLINE_US     ((USB_JITTER_FRAMES + 1) * RF_FRAME_US)
+
+// v0.6.3: 接收器帧对齐 USB 报告 (Report 0x02) - 每个 RF 超帧结束后
+// 播放延迟 USB_JITTER_FRAMES 帧的样本, 带帧号和帧内时间戳
+// 0 = 旧模式, 每个超帧结束时取当前状态 (无抖动缓冲, 不带帧号/时间戳)
+#define USE_USB_FRAME_REPORTS   1
+#define USB_JITTER_FRAMES       1
+
+// v0.6.3: 逐时隙 USB 报告 - 样本解码后立即以 Report 0x02 发出, 只含新到的 tracker,
+// 不经抖动缓冲; 利用 1ms bInterval, 后段时隙的 tracker 不必等到超帧结束
+// (需 USE_USB_FRAME_REPORTS, 与 USE_USB_BUNDLE_REPORTS 互斥)
+#define USE_USB_SLOT_REPORTS    0
+
+// v0.6.3: Bundle 报告 (Report 0x03) - 40-bit smallest-three 四元数,
+// 每 tracker 5 字节, 12 个 tracker 一次 64 字节中断传输, 剩余空间轮转
+// 携带电量/RSSI 状态, 不再单独发送 packet3 状态包 (需 USE_USB_FRAME_REPORTS)
+#define USE_USB_BUNDLE_REPORTS  1
+
+// v0.6.3: EP1 IN 发送队列 - 上一个报告仍在端点缓冲等待主机 IN 令牌时,
+// 新报告暂存到队列, IN 完成中断里直接装入下一个, 主机轮询偶尔延迟时不再丢报告
+// usb_hid_busy() 只在队列也满时为 true
+#define USE_USB_TX_QUEUE        1
+#define USB_TX_QUEUE_DEPTH      2       // 暂存报告数 (不含端点缓冲中的一个)
+
+// v0.6.3: 接收器 Vendor 批量数据流 - 配置描述符增加接口 1 (class 0xFF, EP3 IN bulk),
+// 分帧输出全精度 tracker 样本、超帧时序记录和链路统计, HID 报告保持不变;
+// 主机经 libusb/WinUSB 读取 (tools/usb_bulk_stream.py), USB 命令 0x32 选择内容
+#define USE_USB_BULK_STREAM     0
+#define USB_BULK_FIFO_SIZE      1024    // 发送 FIFO 字节数 (2 的幂)
+
+// v0.6.3: HID Feature 报告诊断通道 - 报告描述符增加 64 字节 Feature 报告, 接收器命令
+// 经 SET_REPORT(Feature) 在 EP0 下发, 应答留在 Feature 缓冲由 GET_REPORT(Feature) 读回,
+// 不占用 EP1 中断 IN 的数据报告; 诊断报告 (0x2C)、事件环 (0x2D)、packet3/packet0 (0x2A)
+// 也可在此通道读取, 0x2B 可停止在 IN 上推送 packet3/packet0 (SlimeVR 兼容默认仍推送)
+#define USE_USB_FEATURE_DIAG    1
+
+// v0.6.3: 接收端姿态外推 (需 USE_USB_FRAME_REPORTS) - 由连续四元数估计角速度,
+// 把播放样本外推到 USB 报告时刻 + RX_PREDICT_HORIZON_US; USB 命令 0x14 可在线调整
+#define USE_RX_PREDICTION       0
+#define RX_PREDICT_HORIZON_US   0
+
+// v0.6.3: 接收端自适应平滑 (需 USE_USB_FRAME_REPORTS) - 每 tracker 一个 One-Euro 低通,
+// 在播放缓冲入口对四元数 slerp, 截止频率 = MIN_CUTOFF + BETA × 角速度 (rad/s):
+// 静止姿态的抖动被压住, 快速运动几乎不滤波, tracker 端滤波可相应调轻.
+// 参数单位 0.01 Hz; USB 命令 0x29 按 tracker 在线调整 (不保存). 批量数据流仍输出原始样本
+#define USE_RX_SMOOTHING        0
+#define RX_SMOOTH_MIN_CUTOFF_CHZ 100    // 1 Hz
+#define RX_SMOOTH_BETA_CHZ      1000    // +10 Hz / (rad/s)
+#define RX_SMOOTH_D_CUTOFF_CHZ  100     // 1 Hz
+
+// v0.6.3: 端到端延迟测量 (需 USE_USB_FRAME_REPORTS + USE_RF_SAMPLE_TIME + USE_DIAGNOSTICS) -
+// 样本时刻 (接收器时钟, 见 USE_RF_SAMPLE_TIME) 到含该样本的 USB 报告提交给端点的时间,
+// 每 tracker 保留最近 DIAG_LAT_WINDOW 个 (100us 单位), 百分位随 0x22 链路统计和诊断报告输出;
+// USB 命令 0x24 清空窗口开始新一轮测量. 每 tracker 约 DIAG_LAT_WINDOW 字节 RAM
+#define USE_LATENCY_PROBE       1
+#define DIAG_LAT_WINDOW         32
+
+// v0.6.3: 接收器帧末空闲 RSSI 扫描 (需 USE_CHANNEL_MANAGER) - 最后一个时隙之后,
+// 在下一个信标前的空闲时间里对后续跳频信道做能量检测, 持续有 WiFi 突发的信道
+// 在丢包之前被拉黑, 并从跳频表中剔除
+#define USE_RF_IDLE_SCAN        1
+#define RF_IDLE_SCAN_CHANNELS   2       // 每帧最多扫描信道数
+#define RF_IDLE_SCAN_DWELL_US   40      // 每信道驻留 (切换信道 + RSSI 稳定)
+#define RF_IDLE_SCAN_LOOKAHEAD  6       // 从 frame+6 开始扫描 (信标 channel_map 之后)
+
+// v0.6.3: 接收器启动能量普查 (需 USE_CHANNEL_MANAGER) - 启动 RF 之前 (USE_RX_FAST_BOOT 下
+// 与 USB 枚举重叠) 对全部 RF_CHANNEL_COUNT 个信道轮流做 RSSI 采样, 写入 ch_manager 的
+// 空闲扫描统计; 持续忙的信道不进入首个跳频表. 之前信道管理器从零开始,
+// 开机第一分钟要靠丢包才学到坏信道
+#define USE_RF_BOOT_SURVEY      1
+#define RF_BOOT_SURVEY_MS       200     // 普查时长 (阻塞启动)
+#define RF_BOOT_SURVEY_ROUNDS   16      // 轮数, 每轮扫一遍全部信道, 在普查时长内均匀分布
+
+// v0.6.3: 每 tracker 信道映射 (两端需同时启用) - 接收器按序列号缺口统计每个 tracker 在各跳频信道上的
+// 丢包率, 只对该 tracker 把坏信道映射到替代信道 (rf_hop_remap), 其他 tracker 照常使用;
+// 全局黑名单只由接收器本地的空闲扫描决定. 映射 16 位 (跳频信道集下标), 经 ACK / 组确认的
+// 空闲命令字段分低/高字节下发 (RF_CMD_SET_HOP_LO/HI), 变化时优先下发, 之后定期重发.
+// 副接收器 (USE_RX_DIVERSITY) 只听帧信道, 收不到被映射的时隙. 每 tracker 约 56 字节 RAM
+#define USE_RF_TRACKER_HOP_MAP  1
+#define RF_HOP_MAP_LOSS_PCT     30      // 丢包率高于此值映射走
+#define RF_HOP_MAP_MIN_SAMPLES  8       // 判定所需的最少发送数 (窗口每秒减半)
+#define RF_HOP_MAP_HOLD_S       30      // 映射持续时间, 到期后回到该信道重新评估
+#define RF_HOP_MAP_MIN_GOOD     3       // 每 tracker 至少保留的可用信道数
+#define RF_HOP_MAP_REFRESH      16      // 无变化时每 16 帧重发一次 (2的幂)
+
+// v0.6.3: 接收器驱动的每 tracker 发射功率闭环 (需 USE_DIAGNOSTICS) - 按 diagnostics
+// 统计的近期 RSSI/丢包率调整功率等级, 经 ACK 命令字段 (RF_CMD_SET_POWER) 下发,
+// 使每个 tracker 的接收 RSSI 保持在目标附近, 近处 tracker 不再满功率发射
+#define USE_RF_POWER_CTRL       1
+#define RF_PWR_CTRL_PERIOD_MS   500     // 评估周期
+#define RF_PWR_TARGET_RSSI_DBM  (-70)   // 目标接收 RSSI (约 25dB 链路余量)
+#define RF_PWR_HYST_DB          6       // 目标 ± 滞后 (大于最大单级步进的一半)
+#define RF_PWR_LOSS_UP_PCT      5       // 丢包率高于此值立即升两级
+#define RF_PWR_LOSS_DOWN_PCT    1       // 丢包率不高于此值才允许降功率
+#define RF_PWR_MIN_LEVEL        RF_TX_POWER_N20DBM
+
+// v0.6.3: 每 tracker PHY 速率回退 (需 USE_RF_POWER_CTRL + USE_ADAPTIVE_SUPERFRAME, 两端需同时启用) -
+// 默认 2Mbps; 已在最大功率仍持续丢包的 tracker 改用 1Mbps (灵敏度约高 3dB), 信号恢复后回到 2Mbps.
+// 信标 phy_mask 逐帧下发, 1Mbps tracker 的主时隙占两个连续时隙 (空口时间加倍), 不分配备用时隙;
+// 信标/ACK 之外的广播始终是 2Mbps
+#define USE_RF_PHY_FALLBACK     1
+#define RF_PHY_1M_LOSS_PCT      10      // 最大功率下丢包率高于此值计一次
+#define RF_PHY_1M_PERIODS       2       // 连续计数达到后回退到 1Mbps
+#define RF_PHY_2M_RSSI_DBM      (-75)   // 1Mbps 下 RSSI 不低于此值且几乎无丢包计一次
+#define RF_PHY_2M_PERIODS       10      // 连续计数达到后回到 2Mbps (5s)
+
+// v0.6.3: tracker 信标跳听 (需 USE_RF_TIMING_OPT, 不支持 USE_MULTI_SUPERFRAME) -
+// 漂移估计收敛后每 N 帧才打开接收机听一次信标, 中间帧按漂移补偿自由运行;
+// N 由漂移残差决定, 信标丢失或连续无 ACK 时退回每帧监听.
+// 上限 5: 信标 channel_map 只覆盖 5 帧, 之后 tracker 的跳频表不含接收器黑名单
+#define USE_RF_BEACON_SKIP      1
+#define RF_BEACON_SKIP_MAX      5       // 最多每 5 帧听一次
+#define RF_BEACON_SKIP_GUARD_US 20      // 跳听期间允许的累积时序误差
+
+// v0.6.3: 睡眠唤醒快速重连 - 睡眠前保存帧号/跳频种子/漂移/RTC 时间戳,
+// 唤醒后按 RTC 计时预测当前帧, 在必然尚未到来的目标帧信道上等它的信标,
+// 不再逐信道盲扫; 预测窗口过大或等待超时退回常规搜索
+#define USE_RF_FAST_REJOIN      1
+#define RF_REJOIN_RTC_PPM       1000    // RTC (LSI) 频率误差上限
+#define RF_REJOIN_MAX_FRAMES    40      // 预测不确定度超过此帧数不尝试
+
+// v0.6.3: 确定性同步捕获 - 失步后固定监听跳频表中最大访问间隔最小的信道,
+// 任意帧相位下最多 max_gap 帧 (当前跳频集约 35 帧, 最坏约 60 帧) 必然收到信标;
+// 超时未收到 (该信道被接收器拉黑) 依次换下一个信道
+#define USE_RF_FAST_ACQUIRE     1
+
+// v0.6.3: 按实测代价选择失步恢复动作 (需 USE_RF_RECOVERY) - 记录每种动作的成功率和
+// 恢复耗时 (EWMA), 连续丢信标时按 "成功率 / 预期耗时" 选下一个动作, 当前动作超出
+// 自身耗时预算才升级; 漂移估计稳定时先按预测帧时序和跳频表继续接收 (跳频预测),
+// 不急于离开运行态重新搜索
+#define USE_RF_RECOVERY_COST    1
+
+// v0.6.3: 接收器协调的组休眠 - 主机 USB 挂起持续 GROUP_SLEEP_DELAY_MS 后, 接收器在信标中
+// 通知所有 tracker 休眠: 先以正常速率发 GROUP_SLEEP_ANNOUNCE_FRAMES 帧休眠信标, 之后只在
+// frame % GROUP_SLEEP_INTERVAL == 0 的帧发信标, 不再开数据时隙; tracker 停止发送,
+// 只在这些帧打开接收机, IMU 降到最低功耗档. 主机恢复后信标回到每帧, tracker 随即恢复
+#define USE_GROUP_SLEEP         1
+#define GROUP_SLEEP_DELAY_MS    3000    // USB 挂起持续多久才让整套设备休眠
+#define GROUP_SLEEP_INTERVAL    32      // 休眠期间信标间隔 (帧, 2 的幂, 160ms)
+#define GROUP_SLEEP_ANNOUNCE_FRAMES 40  // 进入休眠时以正常速率广播的帧数 (覆盖跳听间隔)
+
+// v0.6.3: 增量姿态流 - 关键帧 (多样本聚合包) 之间只发相对 "已 ACK 参考包" 的
+// int8 增量, 1 样本包 16 → 13 字节; 参考未确认/过旧/增量溢出时立即发关键帧
+#define USE_RF_DELTA_STREAM     1
+#define RF_DELTA_KEYFRAME_INTERVAL  20  // 每 N 个增量包强制一个关键帧 (带电池/标志)
+
+// v0.6.3: 状态旁路 (需 USE_RF_MULTI_SAMPLE) - 电池电压/温度/固件版本/IMU 型号拆成 2 位,
+// 随每个多样本/增量包标志字节的空闲位轮流发送, 接收器按序号拼回 (16 包一个字段, 含 CRC8),
+// 填入 USB packet0; 不占用数据时隙, 空口长度不变
+#define USE_RF_SIDEBAND         1
+
+// v0.6.3: 自动 FEC - 接收端按时隙归属统计每个 tracker 的 CRC 错误, 持续误码时
+// 经 ACK 命令让该 tracker 改发汉明码保护的 RF Ultra 包 (单比特错误可纠正)
+#define USE_RF_FEC              1
+#define RF_FEC_PERIOD_MS        1000    // 评估周期
+#define RF_FEC_ON_ERRORS        10      // 周期内 CRC 错误 >= 此值开启 (约 5% @ 200Hz)
+#define RF_FEC_OFF_ERRORS       2       // FEC 模式下纠错+失败 <= 此值关闭
+
+// v0.6.3: 双接收器空间分集 - 两个接收器共用网络密钥, 副接收器只旁听;
+// 两者都把解码出的包 (RSSI + 帧号 + 序列号) 经 HID Report 0x04 上报,
+// 由 tools/slimevr_bridge.py --diversity 按序列号去重合并, tracker 无需改动
+#define USE_RX_DIVERSITY        1
+#define RF_LISTEN_LEAD_US       200     // 副接收器提前切换到下一帧信道
+#define RF_LISTEN_LOST_FRAMES   40      // 连续未收到信标帧数, 超过后回到必经信道重新捕获
+
+// v0.6.3: 双接收器漫游 (依赖 USE_RX_DIVERSITY, 两端需同时启用) - 漫游组内的接收器共用网络密钥
+// 和配对表 (tools/slimevr_bridge.py --roaming 经 USB 0x26-0x28 复制), 各自独立发信标,
+// 按小区号错开跳频序列 (小区 0 与单接收器相同), 信标带小区号. tracker 统计本小区信标 RSSI,
+// 低于 RF_ROAM_PROBE_RSSI 时在帧末空闲时间停在本帧信道收另一小区的信标; 对方平均 RSSI
+// 高出 RF_ROAM_MARGIN_DB 时直接以该信标同步, 时隙随之迁移. 失步后搜索时接受任一小区的信标.
+// 两个接收器都开启转发报告, 主机按 (tracker, 序列号) 合并
+#define USE_RF_ROAMING          1
+#define RF_ROAM_CELLS           2       // 漫游组小区数
+#define RF_ROAM_PROBE_RSSI      (-75)   // 本小区信标平均 RSSI 低于此值时监听另一小区
+#define RF_ROAM_MARGIN_DB       8       // 迁移所需的 RSSI 余量
+#define RF_ROAM_MIN_SAMPLES     4       // 另一小区至少收到的信标数
+#define RF_ROAM_HOLD_MS         2000    // 两次迁移的最小间隔
+#define RF_ROAM_PEER_TIMEOUT_MS 1000    // 超过此时间未收到的小区统计作废
+#define RF_ROAM_MISS_RSSI       (-100)  // 丢失本小区信标按此 RSSI 计入平均
+
+// v0.6.3: 多套接收器共存 (两端需同时启用) - 各套件共用同步字, 信标带网络标签 (密钥折叠)
+// 和跳频车道; 跳频改为公共序列 + 每套件信道偏移 (车道), 帧号对齐时不同车道永不同信道.
+// 接收器在时隙接收中听到其他套件的信标后: 标签较大的一方让出冲突车道,
+// 并把帧栅格对齐到所听到的最小标签套件 (主导者) 之后 RF_COEX_PHASE_US, 每 RF_COEX_TRACK_FRAMES
+// 帧在帧末空闲时间转到主导者的信道收一次信标修正时钟漂移. tracker 只接受本网络标签的信标
+#define USE_RF_COEXIST          0
+#define RF_COEX_PHASE_US        300     // 相对主导者帧起点的偏移 (其信标落在本帧帧末空闲时间)
+#define RF_COEX_TRACK_FRAMES    40      // 跟随时监听主导者信标的间隔 (帧)
+#define RF_COEX_LOCK_US         20      // 帧起点误差超过此值时重新对齐
+#define RF_COEX_SWITCH_FRAMES   8       // 换车道提前量 (帧, 信标 channel_map 先按新车道下发)
+#define RF_COEX_PEER_TIMEOUT_MS 5000    // 超过此时间未听到的套件从邻居表移除
+
+// v0.6.3: 链路认证加密 (两端需同时启用) - 时隙数据包 AES-128 计数器模式加密 + 2 字节 MIC,
+// 信标只带 MIC (防伪造, 纪元 + 帧号防重放); 密钥经 USB 调试命令 0x25 写入两端 (tools/link_key.py),
+// 未写入密钥时链路保持明文. 密钥流只由 (纪元, 帧号, tracker, 时隙) 决定, 在时隙开始前算好,
+// 时隙内只做异或和 MIC; 聚合包最多 3 个样本以容纳 MIC
+#define USE_RF_LINK_AUTH        0
+
+// v0.6.3: 多 tracker 同时配对 - 配对信标后接收器总是发一个批量应答 (每包最多
+// RF_PAIR_BATCH_MAX 个 MAC→ID 分配), 其后是 RF_PAIR_SLOTS 个请求时隙 (slotted ALOHA):
+// 前几个时隙留给被分配的 tracker 发确认, 其余时隙随机选一个发请求, 未被分配时指数退避
+#define USE_RF_SLOTTED_PAIRING  1
+
+// v0.6.3: 信标组确认 (两端需同时启用, 不能与 USE_RF_BEACON_SKIP 同用) - 接收器关闭自动应答,
+// 下一帧信标带上一帧主时隙/备用时隙的接收位图, 外加一条轮转下发给某个 tracker 的命令;
+// tracker 发送后直接待机, 不再开接收机等 ACK. 每时隙省去 ACK 空口时间和一次收发切换,
+// 代价是差分参考/选择性重传/信道统计晚一帧得到结果, tracker 须每帧监听信标
+#define USE_RF_GROUP_ACK        0
+
+// v0.6.3: 接收器时隙按绝对时刻排程 - 每帧以信标时刻为基准算出各时隙起点和下一帧起点,
+// 定时器按 slot_base + k × 时隙宽度 装载 (rf_hw_timer_at), 而不是每个时隙重新装载一个相对周期;
+// 回调进入延迟不再逐时隙累积, 帧末不会漂移, 超帧严格按 RF_FRAME_US 栅格推进
+#define USE_RF_ABS_SLOT_TIMER   1
+
+// v0.6.3: 信标预构建 - 下一帧的时隙布局和同步信标 (含组确认、MIC 和 CRC) 在上一帧结束时构建好,
+// 帧起点中断只切信道、切发送并启动发送; 信标发出时刻是全网 tracker 的同步基准,
+// 起点前的可变耗时会直接变成全网抖动. 帧末之后主循环的改动 (激活位图、换车道等) 晚一帧生效,
+// 工作状态或组休眠状态在帧末之后变化时回退为起点现场构建
+#define USE_RF_BEACON_PREBUILD  1
+
+// v0.6.3: 接收器超帧时序追踪 (调试用, 默认关闭)
+// 逐帧记录信标/时隙定时器唤醒、包到达偏移、中断耗时和 CRC 结果,
+// 经 usb_debug 数据流 (0x30 命令 stream_mask bit4) 输出, tools/rf_trace.py 解码
+#define USE_RF_AIRTIME_TRACE    0
+
+// v0.6.3: OTA 压缩 / 增量镜像 (需 make OTA=1) - tools/ota_pack.py 生成, ota_apply 时
+// 解码到 OTA 分区空闲区域再写入应用区; 增量补丁引用当前应用区, 解码期间旧固件保持完整
+#define USE_OTA_PACK            1
+
+// v0.6.3: RF 固件广播升级 (需 make OTA=1) - 接收器经 USB 把 tracker 固件暂存到
+// 自身 OTA 分区, 在每帧时隙之后的空闲时间组播 24 字节块, 按 tracker 上报的
+// 缺失位图补发; 所有 tracker 同时接收. Tracker 侧约 1.6KB RAM (块位图 + 写入队列)
+#define USE_RF_OTA              0
+#define RF_OTA_CHUNKS_PER_FRAME 8       // 每帧最多广播块数
+#define RF_OTA_REPORT_FRAMES    20      // tracker 每 N 个发送帧用一个状态包代替数据包
+
+// v0.6.3: Bootloader 热启动令牌 - 应用运行 3 秒后在保持 RAM 写入一次性令牌,
+// 软件/看门狗复位时 bootloader 跳过按键延时和应用检查直接跳转 (include/boot_token.h)
+#define USE_BOOT_WARM_TOKEN     1
+
 // USB大容量存储 (UF2拖放升级)
 #define USE_USB_MSC             1
 
+// v0.6.3: MSC 流式写入: WRITE_10 数据按 512 字节扇区拼装进两个扇区缓冲,
+// 满一个扇区 (一个 UF2 块 = 一页) 就交主循环编程, 编程期间中断继续接收下一扇区;
+// 两个缓冲都在等编程时 EP2 OUT 回 NAK 让主机重试. 约 1KB RAM
+#define USE_MSC_STREAM_WRITE    1
+
+// v0.6.3: MSC 盘上的只读日志文件 (Tracker) - EVENTS.BIN (事件环), TELEM.BIN (遥测会话),
+// CRASH.BIN (崩溃快照 + 时序), DIAG.BIN (窗口统计), 读取时现场生成; 文件大小在主机
+// 读引导扇区 (挂载) 时锁定. READ_10 改为每扇区生成一次再分 8 包连续发送
+#define USE_MSC_LOG_FILES       1
+
 // 磁力计支持 (航向校正) - 自动检测，未检测到则禁用
 #define USE_MAGNETOMETER        1
 
+// v0.6.3: 磁力计在线椭球拟合 (硬铁偏移 + 软铁矩阵), 每个样本 O(1) 累加法方程,
+// 主循环空闲时分步求解; 软铁矩阵在 mag_read 中以定点 (Q14) 应用. 约 500B RAM
+#define USE_MAG_ELLIPSOID       0
+
 /*============================================================================
  * 编译时冲突检查
  *============================================================================*/
@@ -430,4 +1030,331 @@
 #error "USE_SENSOR_OPTIMIZED and USE_SENSOR_DMA cannot be enabled simultaneously!"
 #endif
 
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE && \
+    !(defined(USE_USB_MSC) && USE_USB_MSC)
+#error "USE_MSC_STREAM_WRITE requires USE_USB_MSC!"
+#endif
+
+#if defined(USE_MSC_LOG_FILES) && USE_MSC_LOG_FILES && \
+    !(defined(USE_USB_MSC) && USE_USB_MSC)
+#error "USE_MSC_LOG_FILES requires USE_USB_MSC!"
+#endif
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME && \
+    !(defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME)
+#error "USE_MULTI_SUPERFRAME requires USE_ADAPTIVE_SUPERFRAME!"
+#endif
+
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE && \
+    !(defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME)
+#error "USE_RF_MOTION_RATE requires USE_MULTI_SUPERFRAME!"
+#endif
+
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS && \
+    !(defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS)
+#error "USE_USB_BUNDLE_REPORTS requires USE_USB_FRAME_REPORTS!"
+#endif
+
+#if defined(USE_USB_SLOT_REPORTS) && USE_USB_SLOT_REPORTS && \
+    (!(defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS) || \
+     (defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS))
+#error "USE_USB_SLOT_REPORTS requires USE_USB_FRAME_REPORTS without USE_USB_BUNDLE_REPORTS!"
+#endif
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT && \
+    !((defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE) && \
+      (defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME))
+#error "USE_RF_SELECTIVE_REPEAT requires USE_RF_MULTI_SAMPLE and USE_ADAPTIVE_SUPERFRAME!"
+#endif
+
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION && \
+    !(defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS)
+#error "USE_RX_PREDICTION requires USE_USB_FRAME_REPORTS!"
+#endif
+
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING && \
+    !(defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS)
+#error "USE_RX_SMOOTHING requires USE_USB_FRAME_REPORTS!"
+#endif
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE && \
+    (!(defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS) || \
+     !(defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME) || \
+     !(defined(USE_DIAGNOSTICS) && USE_DIAGNOSTICS))
+#error "USE_LATENCY_PROBE requires USE_USB_FRAME_REPORTS, USE_RF_SAMPLE_TIME and USE_DIAGNOSTICS!"
+#endif
+
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN && \
+    !(defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER)
+#error "USE_RF_IDLE_SCAN requires USE_CHANNEL_MANAGER!"
+#endif
+
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL && \
+    !(defined(USE_DIAGNOSTICS) && USE_DIAGNOSTICS)
+#error "USE_RF_POWER_CTRL requires USE_DIAGNOSTICS!"
+#endif
+
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK && \
+    !((defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL) && \
+      (defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME))
+#error "USE_RF_PHY_FALLBACK requires USE_RF_POWER_CTRL and USE_ADAPTIVE_SUPERFRAME!"
+#endif
+
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK && \
+    defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK && \
+    defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME && MAX_TRACKERS > 16
+#error "USE_RF_PHY_FALLBACK + USE_RF_GROUP_ACK + USE_MULTI_SUPERFRAME with MAX_TRACKERS > 16 overflows the 32-byte beacon!"
+#endif
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST && \
+    defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK && \
+    defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK && \
+    defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+#error "USE_RF_COEXIST + USE_RF_PHY_FALLBACK + USE_RF_GROUP_ACK + USE_MULTI_SUPERFRAME overflows the 32-byte beacon!"
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH && \
+    ((defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK) || \
+     (defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME))
+#error "USE_RF_LINK_AUTH cannot be used with USE_RF_GROUP_ACK or USE_MULTI_SUPERFRAME (beacon MIC overflows 32 bytes)!"
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH && \
+    defined(USE_RF_COEXIST) && USE_RF_COEXIST && \
+    defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK && MAX_TRACKERS > 16
+#error "USE_RF_LINK_AUTH + USE_RF_COEXIST + USE_RF_PHY_FALLBACK with MAX_TRACKERS > 16 overflows the 32-byte beacon!"
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH && \
+    defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+#error "USE_RF_LINK_AUTH cannot be used with USE_RX_DIVERSITY (the listener does not know slot owners)!"
+#endif
+
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP && \
+    !(defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT)
+#error "USE_RF_BEACON_SKIP requires USE_RF_TIMING_OPT!"
+#endif
+
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP && \
+    defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+#error "USE_RF_BEACON_SKIP cannot be used with USE_MULTI_SUPERFRAME (per-frame slot schedule)!"
+#endif
+
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK && \
+    defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+#error "USE_RF_GROUP_ACK cannot be used with USE_RF_BEACON_SKIP (ACKs arrive in every beacon)!"
+#endif
+
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP && \
+    (GROUP_SLEEP_INTERVAL < 2 || GROUP_SLEEP_INTERVAL > 128 || \
+     (GROUP_SLEEP_INTERVAL & (GROUP_SLEEP_INTERVAL - 1)) != 0)
+#error "GROUP_SLEEP_INTERVAL must be a power of two in 2..128 (uint16 frame counter wrap)!"
+#endif
+
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM && \
+    !(defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE)
+#error "USE_RF_DELTA_STREAM requires USE_RF_MULTI_SAMPLE!"
+#endif
+
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND && \
+    !(defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE)
+#error "USE_RF_SIDEBAND requires USE_RF_MULTI_SAMPLE!"
+#endif
+
+#if defined(USE_RF_FEC) && USE_RF_FEC && \
+    !(defined(USE_RF_ULTRA) && USE_RF_ULTRA)
+#error "USE_RF_FEC requires USE_RF_ULTRA!"
+#endif
+
+#if (SENSOR_ODR_HZ % FUSION_RATE_HZ) != 0 || FUSION_RATE_HZ > SENSOR_ODR_HZ
+#error "FUSION_RATE_HZ must divide SENSOR_ODR_HZ!"
+#endif
+
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD && \
+    !(defined(USE_RF_ULTRA) && USE_RF_ULTRA)
+#error "USE_FUSION_OFFLOAD requires USE_RF_ULTRA!"
+#endif
+
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD && \
+    !(defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME)
+#error "USE_RF_ADAPTIVE_GUARD requires USE_ADAPTIVE_SUPERFRAME!"
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING && \
+    !(defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY)
+#error "USE_RF_ROAMING requires USE_RX_DIVERSITY (forward reports for host merging)!"
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING && \
+    defined(USE_RF_COEXIST) && USE_RF_COEXIST
+#error "USE_RF_ROAMING cannot be used with USE_RF_COEXIST (both rebuild the hop sequence per receiver)!"
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING && (RF_ROAM_CELLS < 2 || RF_ROAM_CELLS > 4)
+#error "RF_ROAM_CELLS must be 2..4!"
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE && \
+    !(defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME)
+#error "USE_RF_FRAME_RATE requires USE_ADAPTIVE_SUPERFRAME!"
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE && \
+    ((defined(USE_RF_COEXIST) && USE_RF_COEXIST) || \
+     (defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC))
+#error "USE_RF_FRAME_RATE cannot be used with USE_RF_COEXIST or USE_IMU_CLOCK_SYNC (fixed 5ms frame grid)!"
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE && \
+    (RF_FRAME_RATE_MAX > 3 || RF_FRAME_RATE_ANNOUNCE < 1 || RF_FRAME_RATE_ANNOUNCE > 15)
+#error "RF_FRAME_RATE_MAX must be 0..3 and RF_FRAME_RATE_ANNOUNCE 1..15 (4-bit beacon countdown)!"
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE && \
+    defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP && \
+    RF_FRAME_RATE_ANNOUNCE <= 2 * RF_BEACON_SKIP_MAX
+#error "RF_FRAME_RATE_ANNOUNCE must exceed 2 * RF_BEACON_SKIP_MAX (skipping trackers must hear the announce)!"
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE && \
+    defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK && MAX_TRACKERS > 16 && \
+    ((defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK) || \
+     (defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME))
+#error "USE_RF_FRAME_RATE + USE_RF_GROUP_ACK + USE_RF_PHY_FALLBACK/USE_MULTI_SUPERFRAME with MAX_TRACKERS > 16 overflows the 32-byte beacon!"
+#endif
+
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP && \
+    !(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH)
+#error "USE_IMU_FIFO_TIMESTAMP requires USE_SENSOR_FIFO_BATCH!"
+#endif
+
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC && \
+    !(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH)
+#error "USE_IMU_CLOCK_SYNC requires USE_SENSOR_FIFO_BATCH!"
+#endif
+
+#if defined(USE_HW_TIMESTAMP) && USE_HW_TIMESTAMP && HW_TS_IMU_CAPTURE && \
+    defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+#error "HW_TS_IMU_CAPTURE cannot be used with USE_IMU_CLOCK_SYNC (both use TMR1)!"
+#endif
+
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP && \
+    !(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH)
+#error "USE_IMU_SFLP requires USE_SENSOR_FIFO_BATCH!"
+#endif
+
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP && \
+    defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+#error "USE_IMU_SFLP and USE_FUSION_OFFLOAD cannot be enabled simultaneously!"
+#endif
+
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR && \
+    !(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH)
+#error "USE_IMU_MIXED_ODR requires USE_SENSOR_FIFO_BATCH!"
+#endif
+
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR && \
+    (IMU_ACCEL_ODR_SHIFT < 1 || IMU_ACCEL_ODR_SHIFT > 3)
+#error "IMU_ACCEL_ODR_SHIFT must be 1..3!"
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU && \
+    (!(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH) || !(defined(USE_RF_ULTRA) && USE_RF_ULTRA))
+#error "USE_AUX_IMU requires USE_SENSOR_FIFO_BATCH and USE_RF_ULTRA!"
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU && \
+    defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+#error "USE_AUX_IMU and USE_FUSION_OFFLOAD cannot be enabled simultaneously!"
+#endif
+
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS && \
+    (!(defined(USE_USB_DEBUG) && USE_USB_DEBUG) || \
+     (SOAK_RING_DEPTH & (SOAK_RING_DEPTH - 1)) != 0 || SOAK_RING_DEPTH > 128)
+#error "USE_SOAK_STATS requires USE_USB_DEBUG and SOAK_RING_DEPTH a power of 2 <= 128!"
+#endif
+
+#if defined(USE_SELFTEST) && USE_SELFTEST && \
+    (!(defined(USE_USB_DEBUG) && USE_USB_DEBUG) || SELFTEST_ADEV_LEVELS > 32)
+#error "USE_SELFTEST requires USE_USB_DEBUG and SELFTEST_ADEV_LEVELS <= 32!"
+#endif
+
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM && \
+    (!(defined(USE_USB_DEBUG) && USE_USB_DEBUG) || (defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD))
+#error "USE_USB_WIRED_STREAM requires USE_USB_DEBUG and on-tracker fusion (no USE_FUSION_OFFLOAD)!"
+#endif
+
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE && \
+    ((GYRO_RANGE_MIN_DPS != 500 && GYRO_RANGE_MIN_DPS != 1000 && GYRO_RANGE_MIN_DPS != 2000) || \
+     (GYRO_RANGE_MAX_DPS != 2000 && GYRO_RANGE_MAX_DPS != 4000))
+#error "GYRO_RANGE_MIN_DPS must be 500/1000/2000 and GYRO_RANGE_MAX_DPS 2000/4000!"
+#endif
+
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE && \
+    !(defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP)
+#error "USE_IMU_POWER_PROFILE requires USE_IMU_FIFO_TIMESTAMP (fusion dt must follow the ODR)!"
+#endif
+
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE && \
+    ((defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD) || (defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC))
+#error "USE_IMU_POWER_PROFILE cannot be used with USE_FUSION_OFFLOAD or USE_IMU_CLOCK_SYNC (fixed sample period)!"
+#endif
+
+#if defined(USE_CRASH_TIMING) && USE_CRASH_TIMING && !(defined(USE_TASK_BUDGET) && USE_TASK_BUDGET)
+#error "USE_CRASH_TIMING requires USE_TASK_BUDGET (the timeline is recorded by TASK_BEGIN/TASK_END)!"
+#endif
+
+#if defined(USE_WAKE_FIFO_CATCHUP) && USE_WAKE_FIFO_CATCHUP && \
+    (!(defined(USE_FAST_WAKE) && USE_FAST_WAKE) || (defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD))
+#error "USE_WAKE_FIFO_CATCHUP requires USE_FAST_WAKE and on-tracker fusion (no USE_FUSION_OFFLOAD)!"
+#endif
+
+#if defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR && \
+    !(defined(USE_PROFILE) && USE_PROFILE)
+#error "USE_CLOCK_GOVERNOR requires USE_PROFILE!"
+#endif
+
+#if defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR && \
+    defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+#error "USE_CLOCK_GOVERNOR cannot be used with USE_IMU_CLOCK_SYNC (CLKOUT is divided from the system clock)!"
+#endif
+
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN && \
+    (LED_PWM_ON_MS < 1 || LED_PWM_ON_MS > LED_PWM_PERIOD_MS)
+#error "LED_PWM_ON_MS must be within 1..LED_PWM_PERIOD_MS!"
+#endif
+
+#if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING && \
+    !(defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH)
+#error "USE_JIT_SAMPLING requires USE_SENSOR_FIFO_BATCH!"
+#endif
+
+#if defined(USE_RF_OTA) && USE_RF_OTA && !defined(OTA_ENABLED)
+#error "USE_RF_OTA requires the OTA partition driver (make OTA=1)!"
+#endif
+
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER && \
+    !(defined(USE_BLE_SLIMEVR) && USE_BLE_SLIMEVR)
+#error "USE_RADIO_ARBITER requires USE_BLE_SLIMEVR!"
+#endif
+
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER && defined(BUILD_RECEIVER)
+#error "USE_RADIO_ARBITER is tracker-only (the receiver listens in every slot)!"
+#endif
+
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST && \
+    !(defined(USE_RF_RECOVERY) && USE_RF_RECOVERY)
+#error "USE_RF_RECOVERY_COST requires USE_RF_RECOVERY!"
+#endif
+
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY && \
+    !(defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER)
+#error "USE_RF_BOOT_SURVEY requires USE_CHANNEL_MANAGER!"
+#endif
+
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY && \
+    (RF_BOOT_SURVEY_ROUNDS < 4 || RF_BOOT_SURVEY_ROUNDS > 255)
+#error "RF_BOOT_SURVEY_ROUNDS must be within 4..255 (CH_CCA_MIN_SAMPLES..cca_samples range)!"
+#endif
+
 #endif /* __CONFIG_H__ */
@@ -6,6 +6,8 @@
  * - 丢包统计 (per-tracker)
  * - 重传次数
  * - RSSI分布
+ * - v0.6.3: 每 tracker 固定分桶直方图 (到达间隔 / 连续丢包长度 / RSSI), 收包时 O(1) 更新
+ * - v0.6.3: 样本到 USB 提交的延迟百分位 (USE_LATENCY_PROBE)
  * - 帧率统计
  * - 功耗估算
  */
@@ -18,6 +20,39 @@
 #include "config.h"
 #include "rf_protocol.h"  // 包含RF_CHANNEL_COUNT定义
 
+/*============================================================================
+ * v0.6.3: 直方图分桶
+ * 平均值掩盖突发丢包; 重传/FEC 调参看分布. 桶计数 uint16, 任一桶满时该直方图整体减半
+ *============================================================================*/
+
+#define DIAG_HIST_BINS          8
+
+// 到达间隔: 以 4.096ms (us >> 12) 为单位按 2 的幂分桶
+// 桶 0: <4.1ms, 1: 4.1-8.2, 2: 8.2-16.4, ..., 6: 131-262, 7: >=262ms
+#define DIAG_GAP_UNIT_SHIFT     12
+
+// 连续丢包长度 (每个序列号缺口一次): 1, 2, 3, 4, 5-8, 9-16, 17-32, >32
+// RSSI: 10dB 一格, 桶 0: <-90, 1: -90..-81, ..., 6: -40..-31, 7: >=-30
+#define DIAG_RSSI_BIN_BASE      (-100)
+
+typedef struct {
+    uint16_t gap[DIAG_HIST_BINS];
+    uint16_t loss_run[DIAG_HIST_BINS];
+    uint16_t rssi[DIAG_HIST_BINS];
+} diag_hist_t;
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+// v0.6.3: 延迟单位 100us, 饱和到 255 (25.5ms); 百分位按最近 DIAG_LAT_WINDOW 个样本取最近秩
+#define DIAG_LAT_UNIT_US        100
+
+typedef struct {
+    uint8_t p50;
+    uint8_t p90;
+    uint8_t p99;
+    uint8_t count;                  // 窗口内样本数 (0 = 无数据, 其余字段为 0)
+} diag_latency_t;
+#endif
+
 /*============================================================================
  * 统计结构
  *============================================================================*/
@@ -48,6 +83,22 @@ typedef struct {
     uint32_t connect_time_ms;       // 连接时间
     uint32_t disconnect_count;      // 断连次数
     uint32_t last_seen_ms;          // 最后活跃时间
+    
+    // v0.6.3: 近期链路窗口 (接收器功率控制, diag_take_link_window 读取后清零)
+    int32_t win_rssi_sum;
+    uint16_t win_packets;           // 窗口内收到的包 (每个带一次 RSSI)
+    uint16_t win_lost;              // 窗口内序列号缺口
+    
+    // v0.6.3: 分布 (diag_generate_report 导出)
+    uint32_t last_rx_us;            // 上一包到达时间 (0 = 尚无)
+    diag_hist_t hist;
+    
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+    // v0.6.3: 最近的样本 → USB 提交延迟 (DIAG_LAT_UNIT_US 单位, 环形)
+    uint8_t lat_win[DIAG_LAT_WINDOW];
+    uint8_t lat_pos;
+    uint8_t lat_count;
+#endif
 } tracker_stats_t;
 
 /**
@@ -157,8 +208,53 @@ uint16_t diag_get_loss_rate(uint8_t tracker_id);
  */
 int8_t diag_get_avg_rssi(uint8_t tracker_id);
 
+/**
+ * @brief v0.6.3: 读取并清空近期链路窗口 (接收器功率控制)
+ * @param avg_rssi 窗口平均 RSSI (dBm)
+ * @param loss_pct 窗口丢包率 (%)
+ * @return false 窗口内没有收到包
+ */
+bool diag_take_link_window(uint8_t tracker_id, int8_t *avg_rssi, uint8_t *loss_pct);
+
+/**
+ * @brief v0.6.3: 读取 tracker 的直方图
+ * @return false tracker_id 无效
+ */
+bool diag_get_hist(uint8_t tracker_id, diag_hist_t *out);
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+/**
+ * @brief v0.6.3: 记录一个样本从采样到 USB 提交的延迟
+ */
+void diag_record_latency(uint8_t tracker_id, uint32_t latency_us);
+
+/**
+ * @brief v0.6.3: 读取延迟百分位
+ * @return false tracker_id 无效
+ */
+bool diag_get_latency(uint8_t tracker_id, diag_latency_t *out);
+
+/**
+ * @brief v0.6.3: 清空所有 tracker 的延迟窗口 (开始新一轮测量)
+ */
+void diag_reset_latency(void);
+#endif
+
+// v0.6.3: 诊断报告布局 (16 字节头 + 每个有统计的 tracker 一个条目)
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+#define DIAG_REPORT_VERSION     0x03
+#define DIAG_REPORT_TRACKER_LEN (8 + 3 * DIAG_HIST_BINS * 2 + 4)
+#else
+#define DIAG_REPORT_VERSION     0x02
+#define DIAG_REPORT_TRACKER_LEN (8 + 3 * DIAG_HIST_BINS * 2)
+#endif
+#define DIAG_REPORT_HDR_LEN     16
+#define DIAG_REPORT_MAX_LEN     (DIAG_REPORT_HDR_LEN + MAX_TRACKERS * DIAG_REPORT_TRACKER_LEN)
+
 /**
  * @brief 生成诊断报告到缓冲区
+ * @note v0.6.3 报告版本 2: 每个 tracker 8 字节摘要后附 3 x DIAG_HIST_BINS 个 uint16 (LE),
+ *       顺序为 gap / loss_run / rssi; 版本 3 (USE_LATENCY_PROBE) 再附延迟 p50/p90/p99/样本数
  * @param buf 输出缓冲区
  * @param buf_size 缓冲区大小
  * @return 实际写入字节数
@@ -37,6 +37,7 @@
 #define __EKF_AHRS_H__
 
 #include "optimize.h"
+#include "fusion_checkpoint.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -122,6 +123,17 @@ void ekf_ahrs_get_euler(const ekf_ahrs_state_t *ekf,
  */
 void ekf_ahrs_get_bias(const ekf_ahrs_state_t *ekf, float bias[3]);
 
+/**
+ * @brief v0.6.3: 导出检查点 (四元数/偏差/偏差协方差)
+ */
+void ekf_ahrs_save_checkpoint(const ekf_ahrs_state_t *ekf, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 从检查点恢复 (dt 保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int ekf_ahrs_load_checkpoint(ekf_ahrs_state_t *ekf, const fusion_checkpoint_t *ckpt);
+
 /*============================================================================
  * 算法选择宏 / Algorithm Selection Macros
  * 
@@ -0,0 +1,192 @@
+/**
+ * @file ekf_fixed.h
+ * @brief Fixed-Point Error-State EKF AHRS for CH592/CH591
+ *
+ * v0.6.3: ekf_ahrs 的整数版本 (6 轴, 无磁力计)
+ * - 误差状态: 机体系姿态误差 δθ[3] + 陀螺仪偏差误差 δb[3], 每次更新后注入并清零
+ * - 协方差 6x6 对称, 只存上三角 21 个 Q30 元素
+ * - 加速度观测 H = [[g×], 0] 每行只有 2 个非零元素, 按行顺序标量更新,
+ *   不需要矩阵求逆 (每行一次 64 位除法)
+ * - 预测中省略 dt² 量级的 c²·P_bb 项
+ *
+ * Fixed-point formats:
+ * - Quaternion / covariance / gains: Q30 (int32)
+ * - Gyro bias: Q30 rad/s; 协方差中偏差误差按 2^EKF_FIXED_BIAS_SHIFT 放大, 避免下溢
+ * - Gyro input: Q24 rad/s, Accel input: Q16 g (与 vqf_fixed 相同)
+ *
+ * Usage:
+ *   ekf_fixed_state_t state;
+ *   ekf_fixed_init(&state, 0.005f);
+ *   ekf_fixed_update(&state, gyro, accel);         // float wrapper
+ *   ekf_fixed_update_q(&state, g_q24, a_q16);      // integer path
+ */
+
+#ifndef __EKF_FIXED_H__
+#define __EKF_FIXED_H__
+
+#include "optimize.h"
+#include "fusion_checkpoint.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef EKF_FIXED_GYRO_NOISE
+#define EKF_FIXED_GYRO_NOISE    0.005f  // 陀螺仪噪声密度 rad/s/√Hz
+#endif
+#ifndef EKF_FIXED_BIAS_NOISE
+#define EKF_FIXED_BIAS_NOISE    0.0001f // 偏差随机游走 rad/s/√s
+#endif
+#ifndef EKF_FIXED_ACC_NOISE
+#define EKF_FIXED_ACC_NOISE     0.15f   // 单位加速度向量噪声 (1σ)
+#endif
+#define EKF_FIXED_ATT_SIGMA_INIT    0.3f    // 初始姿态误差 rad
+#define EKF_FIXED_BIAS_SIGMA_INIT   0.01f   // 初始偏差误差 rad/s
+
+// 协方差中偏差误差的放大位数: δb' = δb · 2^6
+#define EKF_FIXED_BIAS_SHIFT    6
+
+// 输入定点格式 (小数位数)
+#define EKF_FIXED_GYRO_FRAC     24      // rad/s
+#define EKF_FIXED_ACC_FRAC      16      // g
+
+/*============================================================================
+ * EKF Fixed State Structure (~156 bytes)
+ *============================================================================*/
+
+typedef struct {
+    // Orientation quaternion [w, x, y, z] in Q30 (16 bytes)
+    int32_t quat[4];
+
+    // Gyroscope bias in Q30 rad/s (12 bytes)
+    int32_t gyro_bias[3];
+
+    // Covariance upper triangle, Q30 (84 bytes)
+    // 顺序: (0,0) (0,1) .. (0,5) (1,1) .. (5,5); 下标 3..5 为放大后的偏差误差
+    int32_t P[21];
+
+    // 上次协方差预测以来的累计旋转 θ, Q30 rad (12 bytes)
+    int32_t th_acc[3];
+
+    // Precomputed coefficients in Q30 (20 bytes)
+    int32_t dt;                 // 积分/协方差预测周期 (s)
+    int32_t c_ab;               // dt / 2^BIAS_SHIFT, 偏差误差到姿态误差的耦合
+    int32_t q_att;              // 姿态过程噪声 / 步
+    int32_t q_bias;             // 偏差过程噪声 / 步 (放大单位)
+    int32_t r_acc;              // 加速度观测噪声方差
+
+    // Configuration, only used by init/reset (4 bytes)
+    float dt_f;
+
+    // Status (5 bytes)
+    u32 sample_count;
+    u8 flags;
+} ekf_fixed_state_t;
+
+#define EKF_FIXED_FLAG_ACC_USED     BIT(0)  // 上一步使用了加速度观测
+#define EKF_FIXED_FLAG_INITIALIZED  BIT(7)
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * @brief Initialize fixed-point EKF
+ * @param dt Sample period in seconds (e.g., 0.005 for 200Hz)
+ */
+void ekf_fixed_init(ekf_fixed_state_t *state, float dt);
+
+/**
+ * @brief Update filter with 6-axis data (integer path)
+ * @param gyro Gyroscope in Q24 rad/s
+ * @param accel Accelerometer in Q16 g
+ */
+void ekf_fixed_update_q(ekf_fixed_state_t *state, const int32_t gyro[3], const int32_t accel[3]);
+
+/**
+ * @brief Update filter with 6-axis data (float wrapper)
+ * @param gyro Gyroscope reading in rad/s
+ * @param accel Accelerometer reading in g
+ */
+void ekf_fixed_update(ekf_fixed_state_t *state, const float gyro[3], const float accel[3]);
+
+/**
+ * @brief v0.6.3: 只传播名义姿态 (IMU ODR), 协方差预测推迟到下一次 correct
+ * @param gyro Gyroscope in Q24 rad/s
+ * @param dt 本样本积分周期, Q30 s
+ * @note 与 ekf_fixed_correct_q 配合时, init 的 dt 应为校正周期 (过程噪声按它计算)
+ */
+void ekf_fixed_propagate_q(ekf_fixed_state_t *state, const int32_t gyro[3], int32_t dt);
+
+/**
+ * @brief v0.6.3: 应用预积分旋转增量 (gyro_preint), 协方差预测同样推迟到 correct
+ * @param dtheta 机体系旋转向量增量 (rad), 未扣除本引擎的偏差估计
+ * @param dt 增量覆盖的时长 (s)
+ */
+void ekf_fixed_propagate_delta(ekf_fixed_state_t *state, const float dtheta[3], float dt);
+
+/**
+ * @brief v0.6.3: 协方差预测 (覆盖累计旋转) + 加速度观测更新, 不积分陀螺仪
+ * @param accel Accelerometer in Q16 g
+ */
+void ekf_fixed_correct_q(ekf_fixed_state_t *state, const int32_t accel[3]);
+
+/**
+ * @brief v0.6.3: float wrappers of propagate/correct
+ * @param dt 本样本积分周期 (s)
+ */
+void ekf_fixed_propagate(ekf_fixed_state_t *state, const float gyro[3], float dt);
+void ekf_fixed_correct(ekf_fixed_state_t *state, const float accel[3]);
+
+/**
+ * @brief Get current orientation quaternion [w, x, y, z]
+ */
+void ekf_fixed_get_quat(const ekf_fixed_state_t *state, float quat[4]);
+
+/**
+ * @brief Set orientation quaternion (for wake restore), normalized internally
+ */
+void ekf_fixed_set_quat(ekf_fixed_state_t *state, const float quat[4]);
+
+/**
+ * @brief Get current gyroscope bias estimate in rad/s
+ */
+void ekf_fixed_get_bias(const ekf_fixed_state_t *state, float bias[3]);
+
+/**
+ * @brief 导出检查点 (姿态/偏差/偏差协方差)
+ */
+void ekf_fixed_save_checkpoint(const ekf_fixed_state_t *state, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief 从检查点恢复估计量 (dt/噪声参数保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int ekf_fixed_load_checkpoint(ekf_fixed_state_t *state, const fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief Reset filter to initial state (keeps dt)
+ */
+void ekf_fixed_reset(ekf_fixed_state_t *state);
+
+/**
+ * @brief Set integration period for the next update (IMU timestamp dt)
+ * @note Only the propagation step follows dt; process noise stays at init values
+ */
+static FORCE_INLINE void ekf_fixed_set_dt(ekf_fixed_state_t *state, float dt)
+{
+    state->dt_f = dt;
+    state->dt = (int32_t)(dt * 1073741824.0f);
+    state->c_ab = state->dt >> EKF_FIXED_BIAS_SHIFT;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EKF_FIXED_H__ */
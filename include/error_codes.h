@@ -9,6 +9,7 @@
 #define __ERROR_CODES_H__
 
 #include <stdint.h>
+#include "config.h"
 
 /*============================================================================
  * 错误码定义 / Error Code Definitions
@@ -195,7 +196,55 @@ static inline const char* err_to_str(err_t err)
  *   LOG_INFO("IMU initialized: %s", imu_name);
  *============================================================================*/
 
-#ifdef DEBUG_ENABLE
+#if defined(USE_LOG_TOKENS) && USE_LOG_TOKENS && defined(CH59X)
+    /*
+     * v0.6.3: 令牌化日志 (USE_LOG_TOKENS)
+     * 每个调用点一个 .logstr 字符串 "文件:行|格式", 记录为 EVT_LOG_ERR + 级别:
+     *   [令牌 LE16] [参数 zigzag varint ...] (超出 EVENT_MAX_DATA_LEN 的参数截断)
+     * 参数一律按 32 位整数记录; %s 记录指针, 只有指向 Flash 常量串时主机能还原
+     */
+    #include "event_logger.h"
+    
+    #define LOGT_STR_(x)        #x
+    #define LOGT_STR(x)         LOGT_STR_(x)
+    #define LOGT_CAT_(a, b)     a##b
+    #define LOGT_CAT(a, b)      LOGT_CAT_(a, b)
+    #define LOGT_ARG(x)         ((uint32_t)(uintptr_t)(x))
+    #define LOGT_N_(z, a, b, c, d, e, f, n, ...) n
+    #define LOGT_N(...)         LOGT_N_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+    #define LOGT_A0()
+    #define LOGT_A1(a)                  LOGT_ARG(a)
+    #define LOGT_A2(a, b)               LOGT_A1(a), LOGT_ARG(b)
+    #define LOGT_A3(a, b, c)            LOGT_A2(a, b), LOGT_ARG(c)
+    #define LOGT_A4(a, b, c, d)         LOGT_A3(a, b, c), LOGT_ARG(d)
+    #define LOGT_A5(a, b, c, d, e)      LOGT_A4(a, b, c, d), LOGT_ARG(e)
+    #define LOGT_A6(a, b, c, d, e, f)   LOGT_A5(a, b, c, d, e), LOGT_ARG(f)
+    
+    #define LOG_TOKEN(level, fmt, ...) do { \
+        static const char logt_fmt_[] __attribute__((section(".logstr"), used)) = \
+            __FILE__ ":" LOGT_STR(__LINE__) "|" fmt; \
+        const uint32_t logt_args_[] = { 0, LOGT_CAT(LOGT_A, LOGT_N(__VA_ARGS__))(__VA_ARGS__) }; \
+        event_log_token((level), (uint16_t)(uintptr_t)logt_fmt_, &logt_args_[1], \
+                        (uint8_t)(sizeof(logt_args_) / sizeof(logt_args_[0]) - 1)); \
+    } while (0)
+    
+    #define LOG_ERR(fmt, ...)   LOG_TOKEN(0, fmt, ##__VA_ARGS__)
+    #if LOG_TOKEN_LEVEL >= 1
+    #define LOG_WARN(fmt, ...)  LOG_TOKEN(1, fmt, ##__VA_ARGS__)
+    #else
+    #define LOG_WARN(fmt, ...)  ((void)0)
+    #endif
+    #if LOG_TOKEN_LEVEL >= 2
+    #define LOG_INFO(fmt, ...)  LOG_TOKEN(2, fmt, ##__VA_ARGS__)
+    #else
+    #define LOG_INFO(fmt, ...)  ((void)0)
+    #endif
+    #if LOG_TOKEN_LEVEL >= 3
+    #define LOG_DBG(fmt, ...)   LOG_TOKEN(3, fmt, ##__VA_ARGS__)
+    #else
+    #define LOG_DBG(fmt, ...)   ((void)0)
+    #endif
+#elif defined(DEBUG_ENABLE)
     #include <stdio.h>
     #define LOG_ERR(fmt, ...)   printf("[ERR] " fmt "\n", ##__VA_ARGS__)
     #define LOG_WARN(fmt, ...)  printf("[WARN] " fmt "\n", ##__VA_ARGS__)
@@ -3,9 +3,10 @@
  * @brief v0.6.0 事件环形缓冲区与崩溃快照
  * 
  * 功能:
- * - 环形缓冲区记录最近50条事件
+ * - 环形缓冲区记录最近事件
  * - 崩溃快照保存到Flash
- * - 导出JSON格式诊断报告
+ * - v0.6.3: 变长记录 + 时间戳增量编码, 中断安全的无锁追加,
+ *   经 usb_debug 0x17 直接读出环内字节, JSON 由主机生成 (tools/event_dump.py)
  */
 
 #ifndef EVENT_LOGGER_H
@@ -13,14 +14,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "watchdog.h"     // v0.6.3: 崩溃时序快照
 
 /*============================================================================
  * 配置
  *============================================================================*/
 
-#define EVENT_RING_SIZE         50      // 最近50条事件
+#define EVENT_RING_BYTES        512     // 环大小 (2 的幂, <= 32768), 常见事件 3~7 字节
 #define EVENT_FLASH_OFFSET      0x0600  // Flash存储偏移
-#define EVENT_MAX_DATA_LEN      8       // 每条事件最大附加数据
+#define EVENT_MAX_DATA_LEN      16      // 每条事件最大附加数据 (v0.6.3: 日志令牌 + 参数)
 
 /*============================================================================
  * 事件类型
@@ -33,6 +35,11 @@ typedef enum {
     EVT_CRASH               = 0x03,     // 崩溃/异常复位
     EVT_WATCHDOG            = 0x04,     // 看门狗复位
     EVT_LOW_BATTERY         = 0x05,     // 低电量
+    EVT_TASK_OVERRUN        = 0x06,     // v0.6.3: 主循环任务超预算 [id][us LE16]
+    EVT_LOG_ERR             = 0x08,     // v0.6.3: 令牌化日志 [令牌 LE16][参数 varint...] (USE_LOG_TOKENS)
+    EVT_LOG_WARN            = 0x09,
+    EVT_LOG_INFO            = 0x0A,
+    EVT_LOG_DBG             = 0x0B,
     
     // RF事件 (0x10-0x1F)
     EVT_RF_SYNC_LOST        = 0x10,     // 同步丢失
@@ -53,6 +60,7 @@ typedef enum {
     EVT_SLEEP_EXIT          = 0x31,     // 退出睡眠
     EVT_WOM_TRIGGER         = 0x32,     // WOM触发
     EVT_BTN_WAKE            = 0x33,     // 按键唤醒
+    EVT_WAKE_FIFO_REPLAY    = 0x34,     // v0.6.3: 唤醒 FIFO 回放 [帧数 (饱和到 255)]
     
     // IMU事件 (0x40-0x4F)
     EVT_IMU_ERROR           = 0x40,     // IMU错误
@@ -67,15 +75,24 @@ typedef enum {
 } event_type_t;
 
 /*============================================================================
- * 事件结构
+ * 记录格式 (v0.6.3)
+ *
+ *   [type] [dt varint 1~5B] [data 0~8B] [len]
+ *
+ * dt = 距上一条记录的毫秒数 (LEB128, 首条距启动); 末字节 len 为整条记录
+ * 字节数 (3~23), 最后写入作为提交标记. 读出时从写指针往回按 len 逐条回溯,
+ * 最新一条的绝对时间见 event_log_info_t.last_ms.
  *============================================================================*/
 
+#define EVENT_REC_MAX_LEN       (1 + 5 + EVENT_MAX_DATA_LEN + 1)
+
 typedef struct {
-    uint32_t timestamp_ms;              // 时间戳
-    uint8_t type;                       // 事件类型
-    uint8_t data_len;                   // 附加数据长度
-    uint8_t data[EVENT_MAX_DATA_LEN];   // 附加数据
-} __attribute__((packed)) event_entry_t;
+    uint16_t head;                      // 已写入字节数 (模 65536), 记录结束于 head
+    uint16_t size;                      // EVENT_RING_BYTES
+    uint32_t last_ms;                   // 最新一条记录的时间 (启动后 ms)
+    uint32_t now_ms;                    // 读取时刻 (启动后 ms)
+    uint32_t count;                     // 累计记录数 (含已被覆盖的)
+} event_log_info_t;
 
 /*============================================================================
  * 崩溃快照结构
@@ -99,40 +116,13 @@ typedef struct {
     uint32_t sleep_count;
     uint32_t wake_count;
     
+#if CRASH_TIMING
+    crash_timing_t timing;              // v0.6.3: 最近迭代的任务耗时 + 探针表
+#endif
+    
     uint16_t crc;                       // CRC校验
 } __attribute__((packed)) event_crash_snapshot_t;
 
-/*============================================================================
- * 诊断报告结构 (JSON导出用)
- *============================================================================*/
-
-typedef struct {
-    // 版本信息
-    uint8_t fw_major;
-    uint8_t fw_minor;
-    uint8_t fw_patch;
-    uint8_t board_id;
-    uint8_t imu_type;
-    uint8_t mag_type;
-    
-    // 配置信息
-    uint16_t superframe_us;
-    uint16_t slot_us;
-    uint8_t max_trackers;
-    uint8_t sleep_mode;
-    
-    // 计数器
-    uint32_t rf_timeout_count;
-    uint32_t miss_sync_count;
-    uint32_t crc_fail_count;
-    uint32_t sleep_count;
-    uint32_t wake_count;
-    uint32_t uptime_sec;
-    
-    // 最近事件数
-    uint8_t event_count;
-} diag_report_header_t;
-
 /*============================================================================
  * API
  *============================================================================*/
@@ -143,7 +133,7 @@ typedef struct {
 void event_logger_init(void);
 
 /**
- * @brief 记录事件
+ * @brief 记录事件 (可在中断中调用)
  * @param type 事件类型
  * @param data 附加数据 (可为NULL)
  * @param data_len 数据长度
@@ -166,12 +156,32 @@ void event_log_u8(event_type_t type, uint8_t value);
 void event_log_u32(event_type_t type, uint32_t value);
 
 /**
- * @brief 获取最近的事件
- * @param events 输出缓冲区
- * @param max_count 最大数量
- * @return 实际返回的事件数
+ * @brief v0.6.3: 记录令牌化日志 (LOG_* 宏展开到这里, 可在中断中调用)
+ * @param level 0 = ERR .. 3 = DBG
+ * @param token 格式串在 .logstr 段内的地址
+ * @param args 32 位参数, 按 zigzag varint 写入
  */
-uint8_t event_get_recent(event_entry_t *events, uint8_t max_count);
+void event_log_token(uint8_t level, uint16_t token, const uint32_t *args, uint8_t nargs);
+
+/**
+ * @brief v0.6.3: 读取环状态 (写指针与最新记录时间同一次快照)
+ */
+void event_log_get_info(event_log_info_t *info);
+
+/**
+ * @brief v0.6.3: 零拷贝读取环内字节
+ * @param pos 绝对位置 (模 65536), 应在 [head - size, head) 内
+ * @param max 最多字节数
+ * @param len 输出连续可读字节数 (不跨环尾)
+ * @return 指向环缓冲区的指针, pos 不在有效范围内返回 NULL;
+ *         读完后数据可能已被中断中的新记录覆盖, 调用方应重新取 head 判断
+ */
+const uint8_t *event_log_peek(uint16_t pos, uint8_t max, uint8_t *len);
+
+/**
+ * @brief v0.6.3: 当前写指针 (用于判断已读字节是否被覆盖)
+ */
+uint16_t event_log_head(void);
 
 /**
  * @brief 保存崩溃快照到Flash
@@ -200,20 +210,4 @@ int event_crash_snapshot_read(event_crash_snapshot_t *snapshot);
  */
 void event_crash_snapshot_clear(void);
 
-/**
- * @brief 生成JSON格式诊断报告
- * @param buf 输出缓冲区
- * @param buf_size 缓冲区大小
- * @return 实际写入字节数
- */
-uint16_t diag_report_generate_json(char *buf, uint16_t buf_size);
-
-/**
- * @brief 生成二进制格式诊断报告 (紧凑)
- * @param buf 输出缓冲区
- * @param buf_size 缓冲区大小
- * @return 实际写入字节数
- */
-uint16_t diag_report_generate_bin(uint8_t *buf, uint16_t buf_size);
-
 #endif // EVENT_LOGGER_H
@@ -0,0 +1,73 @@
+/**
+ * @file event_queue.h
+ * @brief 主循环事件队列 / Main-loop event queue
+ *
+ * v0.6.3: 中断 (IMU 数据就绪 / RF 帧定时 / 按键) 投递事件, 主循环取事件处理,
+ * 队列为空时执行 WFI 休眠, 替代固定 100us 轮询
+ *
+ * - 单生产者为 ISR、单消费者为主循环; 投递与取出都在关中断临界区内完成
+ * - 同一事件未被取走前重复投递会被合并 (pending 位图), 队列不会被刷满
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * 事件类型
+ *============================================================================*/
+
+typedef enum {
+    EVQ_NONE = 0,
+    EVQ_IMU_DATA,       // IMU INT1 数据就绪 / FIFO 水位
+    EVQ_RF_FRAME,       // 下一个超帧同步窗口即将开始
+    EVQ_BUTTON,         // 按键边沿
+    EVQ_MAX             // 不超过 8 (pending 位图为 uint8_t)
+} evq_event_t;
+
+#define EVQ_SIZE        16  // 必须是 2 的幂
+
+#define EVQ_BIT(evt)    ((uint8_t)(1u << (evt)))
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+/**
+ * @brief 清空队列
+ */
+void evq_init(void);
+
+/**
+ * @brief 投递事件 (可在中断中调用)
+ * @return true 已入队或与未处理的同类事件合并; false 队列满
+ */
+bool evq_post(evq_event_t evt);
+
+/**
+ * @brief 取出下一个事件
+ * @return 事件类型, 队列为空时返回 EVQ_NONE
+ */
+evq_event_t evq_get(void);
+
+/**
+ * @brief 队列中是否有未处理事件
+ */
+bool evq_pending(void);
+
+/**
+ * @brief 队列为空时 WFI 休眠, 任一中断唤醒后返回
+ *
+ * 在关中断状态下检查队列再执行 WFI, 避免检查与休眠之间到达的事件
+ * 被错过 (RISC-V 的 WFI 在 MIE=0 时仍会被挂起的中断唤醒)
+ */
+void evq_wait(void);
+
+/**
+ * @brief 统计: 因队列满而丢弃的事件数
+ */
+uint32_t evq_get_dropped(void);
+
+#endif /* EVENT_QUEUE_H */
@@ -0,0 +1,160 @@
+/**
+ * @file fast_math.h
+ * @brief 融合算法共用的快速数学函数 / Shared fast-math kernels for fusion
+ *
+ * v0.6.3: CH592 无 FPU, libm 的 atan2f/sinf/cosf/sqrtf 走软浮点库, 每次数千周期;
+ * 这里的近似只用乘加 (atan2 一次除法), 误差上限均在主机上对 double 参考全范围扫描得到
+ *
+ * - fm_inv_sqrt:  Quake 初值 + 2 次牛顿迭代, 相对误差 < 5e-6
+ * - fm_sqrt:      x · fm_inv_sqrt(x), 相对误差 < 5e-6
+ * - fm_atan2:     9 阶奇多项式 (|a| <= 1 区间) + 象限折叠, 绝对误差 < 1.2e-5 rad
+ * - fm_asin:      fm_atan2(x, sqrt(1-x²)), 绝对误差 < 2e-5 rad
+ * - fm_sincos_small: 小角度泰勒展开 (sin 到 5 阶, cos 到 6 阶),
+ *                 |a| <= FM_SMALL_ANGLE_MAX 时绝对误差 < 1.6e-6, 超出范围退回 libm
+ * - fm_rotvec_to_quat: 旋转向量 → 单位四元数 (预积分增量, 半角用 fm_sincos_small)
+ * - fm_quat_renorm: 四元数归一化 (USE_LAZY_QUAT_NORM 时按模长误差惰性修正)
+ *
+ * 姿态更新中的半角 (陀螺积分/加速度/磁力计修正) 通常 < 0.1 rad, 误差 < 1e-10
+ */
+
+#ifndef __FAST_MATH_H__
+#define __FAST_MATH_H__
+
+#include <stdint.h>
+#include <math.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FM_PI               3.14159265f
+#define FM_PI_2             1.57079633f
+#define FM_SMALL_ANGLE_MAX  0.5f        // rad, fm_sincos_small 多项式的有效范围
+
+// v0.6.3: 惰性归一化阈值 (|q|² - 1 的绝对值)
+#ifndef FM_QNORM_TOL
+#define FM_QNORM_TOL        2e-6f       // 以内不修正 (|q| 偏差 < 1e-6, 低于 Q15 输出 1 LSB)
+#endif
+#ifndef FM_QNORM_FIRST_ORDER
+#define FM_QNORM_FIRST_ORDER 1e-2f      // 以内一阶修正, 修正后残差 ≈ 0.75·e² < 7.5e-5
+#endif
+
+/**
+ * @brief 1/sqrt(x)
+ * @note x < 1e-10 时返回 1000 (归一化零向量时不产生 INF)
+ */
+static inline float fm_inv_sqrt(float x)
+{
+    if (x < 1e-10f) return 1000.0f;
+
+    union { float f; uint32_t i; } u = { x };
+    float xhalf = 0.5f * x;
+    u.i = 0x5f3759df - (u.i >> 1);
+    u.f *= 1.5f - xhalf * u.f * u.f;    // 相对误差 1.8e-3
+    u.f *= 1.5f - xhalf * u.f * u.f;    // 4.7e-6
+    return u.f;
+}
+
+/**
+ * @brief sqrt(x), x <= 0 时返回 0
+ */
+static inline float fm_sqrt(float x)
+{
+    if (x <= 0.0f) return 0.0f;
+    return x * fm_inv_sqrt(x);
+}
+
+/**
+ * @brief atan2(y, x), 结果 [-π, π]; (0, 0) 返回 0
+ */
+static inline float fm_atan2(float y, float x)
+{
+    float abs_y = fabsf(y);
+    float abs_x = fabsf(x);
+    float hi = abs_x > abs_y ? abs_x : abs_y;
+    if (hi == 0.0f) return 0.0f;
+
+    float a = (abs_x > abs_y ? abs_y : abs_x) / hi;
+    float s = a * a;
+    float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s
+               - 0.3302995f) * s + 0.9998660f) * a;
+
+    if (abs_y > abs_x) r = FM_PI_2 - r;
+    if (x < 0.0f) r = FM_PI - r;
+    return (y < 0.0f) ? -r : r;
+}
+
+/**
+ * @brief asin(x), x 限制在 [-1, 1]
+ */
+static inline float fm_asin(float x)
+{
+    if (x >= 1.0f) return FM_PI_2;
+    if (x <= -1.0f) return -FM_PI_2;
+    return fm_atan2(x, fm_sqrt(1.0f - x * x));
+}
+
+/**
+ * @brief 小角度 sin/cos (半角修正用)
+ */
+static inline void fm_sincos_small(float a, float *s, float *c)
+{
+    if (fabsf(a) > FM_SMALL_ANGLE_MAX) {
+        *s = sinf(a);
+        *c = cosf(a);
+        return;
+    }
+
+    float a2 = a * a;
+    *s = a * (1.0f - a2 * (1.0f / 6.0f) * (1.0f - a2 * (1.0f / 20.0f)));
+    *c = 1.0f - a2 * 0.5f * (1.0f - a2 * (1.0f / 12.0f) * (1.0f - a2 * (1.0f / 30.0f)));
+}
+
+/**
+ * @brief 旋转向量 φ (rad) → 四元数 [cos(|φ|/2), sin(|φ|/2)·φ/|φ|]
+ */
+static inline void fm_rotvec_to_quat(const float phi[3], float dq[4])
+{
+    float n2 = phi[0] * phi[0] + phi[1] * phi[1] + phi[2] * phi[2];
+    float angle = fm_sqrt(n2);
+    float s, c;
+    fm_sincos_small(0.5f * angle, &s, &c);
+
+    float k = (angle > 1e-9f) ? (s / angle) : 0.5f;
+    dq[0] = c;
+    dq[1] = phi[0] * k;
+    dq[2] = phi[1] * k;
+    dq[3] = phi[2] * k;
+}
+
+/**
+ * @brief 四元数归一化 (融合引擎每次更新的尾部)
+ *
+ * v0.6.3: USE_LAZY_QUAT_NORM 时用 e = |q|² - 1 (只需 4 次乘法) 决定修正方式:
+ * |e| < FM_QNORM_TOL 不修正; |e| < FM_QNORM_FIRST_ORDER 乘一阶系数 1.5 - 0.5·|q|²
+ * (1/sqrt 在 1 处的一阶展开, 残差 O(e²), 下次更新继续收敛); 否则完整 fm_inv_sqrt.
+ * 静止/慢速时大多数更新不修正, 快速转动时只做一阶修正
+ */
+static inline void fm_quat_renorm(float q[4])
+{
+    float n2 = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+#if defined(USE_LAZY_QUAT_NORM) && USE_LAZY_QUAT_NORM
+    float e = n2 - 1.0f;
+    if (e < FM_QNORM_TOL && e > -FM_QNORM_TOL) return;
+    float s = (e < FM_QNORM_FIRST_ORDER && e > -FM_QNORM_FIRST_ORDER) ?
+              (1.5f - 0.5f * n2) : fm_inv_sqrt(n2);
+#else
+    float s = fm_inv_sqrt(n2);
+#endif
+    q[0] *= s;
+    q[1] *= s;
+    q[2] *= s;
+    q[3] *= s;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FAST_MATH_H__ */
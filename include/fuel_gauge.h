@@ -0,0 +1,62 @@
+/**
+ * @file fuel_gauge.h
+ * @brief v0.6.3 整数电量计 / Integer battery fuel gauge (USE_FUEL_GAUGE)
+ *
+ * 替代 3.0-4.2V 线性估算:
+ * - ADC 原始值按分压比换算成 mV (整数), 加上 负载电流 × 电池内阻 还原开路电压
+ * - 调用方只在 RF 空闲窗口采样 (不在发射电流尖峰上), 负载取功耗估算值
+ * - 开路电压做一阶 IIR (Q4 mV, 移位实现), 查 LiPo 放电曲线表 (分段线性) 得到百分比
+ * - 剩余时间 = 剩余容量 / 平均负载电流
+ * 每次更新只有整数加减与一次除法, 不用浮点
+ */
+
+#ifndef __FUEL_GAUGE_H__
+#define __FUEL_GAUGE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FG_TTE_UNKNOWN          0xFFFF  // 充电中或尚无数据
+
+/**
+ * @brief LiPo 开路电压 → 电量百分比 (放电曲线表, 不依赖 USE_FUEL_GAUGE)
+ */
+uint8_t fuel_gauge_mv_to_percent(uint16_t ocv_mv);
+
+void fuel_gauge_init(void);
+
+/**
+ * @brief 输入一次电池 ADC 采样 (约每秒一次)
+ * @param adc_raw 12 位 ADC 原始值
+ * @param load_ma 采样时刻的估计负载电流 (mA)
+ * @param charging 充电中 (充电电压不代表电量, 只跟踪不补偿)
+ */
+void fuel_gauge_update(uint16_t adc_raw, uint16_t load_ma, bool charging);
+
+uint8_t fuel_gauge_get_percent(void);
+
+/**
+ * @brief 补偿并滤波后的开路电压 (mV)
+ */
+uint16_t fuel_gauge_get_ocv_mv(void);
+
+/**
+ * @brief 最近一次采样的端电压 (mV, 未补偿)
+ */
+uint16_t fuel_gauge_get_raw_mv(void);
+
+/**
+ * @brief 按平均负载估算的剩余时间 (分钟), FG_TTE_UNKNOWN = 充电中/无数据
+ */
+uint16_t fuel_gauge_get_tte_min(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FUEL_GAUGE_H__ */
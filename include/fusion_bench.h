@@ -0,0 +1,187 @@
+/**
+ * @file fusion_bench.h
+ * @brief On-target fusion engine benchmark
+ *
+ * v0.6.3: 在目标板上回放同一段 gyro/accel/mag 轨迹, 依次喂给全部融合引擎:
+ *   vqf_ultra, vqf_advanced, vqf_fixed, vqf_opt, vqf_simple, ekf_ahrs
+ *
+ * 每个引擎报告:
+ * - mcycles / update (min / avg / max, 关中断测量)
+ * - 栈高水位 (每次 update 前涂色, 之后扫描)
+ * - 相对参考姿态的误差 (总角度 RMS/最大, 倾角 RMS)
+ * - 误差是否在该引擎的限值内 (fusion_bench_engine_limits), 超限报告 FAIL
+ *
+ * 轨迹来源:
+ * - 默认: 片上合成轨迹 (解析角速度积分, 参考姿态精确)
+ * - 录制: make TARGET=bench BENCH_TRACE=trace.csv
+ *   由 tools/fusion_bench.py 转换为 C 数组
+ *
+ * 结果通过 usb_debug 日志输出, 主机端用 tools/fusion_bench.py read 读取
+ */
+
+#ifndef __FUSION_BENCH_H__
+#define __FUSION_BENCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef FUSION_BENCH_WARMUP_S
+#define FUSION_BENCH_WARMUP_S       2       // 前 N 秒不计入误差 (收敛)
+#endif
+
+#ifndef FUSION_BENCH_STACK_PAINT
+#define FUSION_BENCH_STACK_PAINT    768     // 涂色字节数, 小于链接脚本最小栈
+#endif
+
+#define FUSION_BENCH_SYNTH_SECONDS  20      // 合成轨迹长度
+
+/*============================================================================
+ * Trace Format
+ *============================================================================*/
+
+// 录制样本 (26 bytes), 缩放见 fusion_bench_trace_t
+typedef struct {
+    int16_t gyro[3];            // gyro_lsb_dps
+    int16_t accel[3];           // accel_lsb_g
+    int16_t mag[3];             // mag_lsb_ut
+    int16_t ref[4];             // 参考四元数 [w, x, y, z], Q14
+} fusion_bench_sample_t;
+
+typedef struct {
+    const char *name;
+    const fusion_bench_sample_t *samples;   // NULL = 合成轨迹
+    uint32_t count;
+    uint16_t odr_hz;
+    bool has_mag;
+    float gyro_lsb_dps;
+    float accel_lsb_g;
+    float mag_lsb_ut;
+} fusion_bench_trace_t;
+
+/*============================================================================
+ * Results
+ *============================================================================*/
+
+// 相对参考姿态的误差上限 (deg), 6 轴/9 轴共用
+typedef struct {
+    float err_rms_deg;
+    float err_max_deg;
+} fusion_bench_limits_t;
+
+typedef struct {
+    const char *engine;
+    uint32_t cycles_min;
+    uint32_t cycles_avg;
+    uint32_t cycles_max;
+    uint16_t stack_bytes;       // 高水位 (含引擎调用帧)
+    uint16_t state_bytes;       // sizeof(state)
+    float err_rms_deg;          // 总角度误差
+    float err_max_deg;
+    float tilt_rms_deg;         // 仅倾角 (6 轴引擎无法观测航向)
+    uint32_t samples;
+    bool pass;                  // err_rms/err_max 均在限值内
+} fusion_bench_result_t;
+
+typedef void (*fusion_bench_report_cb_t)(const fusion_bench_result_t *result);
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * @brief 内置合成轨迹 (或 BENCH_TRACE 录制轨迹)
+ */
+const fusion_bench_trace_t *fusion_bench_default_trace(void);
+
+/**
+ * @brief 引擎数量
+ */
+uint8_t fusion_bench_engine_count(void);
+
+/**
+ * @brief 用轨迹跑单个引擎
+ * @param engine 引擎索引 (0 .. count-1)
+ * @param trace 轨迹
+ * @param result 输出结果
+ * @param use_mag 轨迹含磁力计时是否走 9 轴接口 (仅支持的引擎)
+ * @return 0=成功, -1=参数错误
+ */
+int fusion_bench_run(uint8_t engine, const fusion_bench_trace_t *trace,
+                     fusion_bench_result_t *result, bool use_mag);
+
+/**
+ * @brief 依次跑全部引擎, 每个引擎完成后回调
+ * @return 完成的引擎数 (含超限的; 超限看 result->pass)
+ */
+int fusion_bench_run_all(const fusion_bench_trace_t *trace, bool use_mag,
+                         fusion_bench_report_cb_t cb);
+
+/*============================================================================
+ * 逐样本接口 / Per-sample engine access
+ *
+ * v0.6.3: 主机回放 (src/main_replay.c) 按 main_tracker 的流水线逐样本调用,
+ * 与 fusion_bench_run 共用引擎表和状态缓冲区 (同一时刻只有一个引擎)
+ *============================================================================*/
+
+/**
+ * @brief 引擎名称, 索引越界返回 NULL
+ */
+const char *fusion_bench_engine_name(uint8_t engine);
+
+/**
+ * @brief 引擎误差限值, 索引越界返回 NULL
+ */
+const fusion_bench_limits_t *fusion_bench_engine_limits(uint8_t engine);
+
+/**
+ * @brief 误差是否在引擎限值内
+ */
+bool fusion_bench_within_limits(uint8_t engine, float err_rms_deg, float err_max_deg);
+
+/**
+ * @brief 按名称查找引擎
+ * @return 引擎索引, -1=不存在
+ */
+int fusion_bench_engine_find(const char *name);
+
+/**
+ * @brief 选择并初始化引擎
+ * @return 0=成功, -1=参数错误
+ */
+int fusion_bench_engine_init(uint8_t engine, float dt);
+
+void fusion_bench_engine_set_quat(const float q[4]);
+
+/**
+ * @brief 一个样本 (rad/s, g, uT; mag 为 NULL 时走 6 轴)
+ */
+void fusion_bench_engine_update(const float g[3], const float a[3], const float *m);
+
+void fusion_bench_engine_get_quat(float q[4]);
+
+/**
+ * @brief 两个姿态的总旋转角 (deg)
+ * @param tilt_deg 仅倾角差 (deg), 可为 NULL
+ */
+float fusion_bench_angle_deg(const float a[4], const float b[4], float *tilt_deg);
+
+/**
+ * @brief 取轨迹第 i 个样本 (rad/s, g, uT, 参考四元数)
+ * @note 合成轨迹逐样本积分参考姿态, i 必须从 0 开始连续递增
+ */
+void fusion_bench_trace_sample(const fusion_bench_trace_t *trace, uint32_t i,
+                               float g[3], float a[3], float m[3], float ref[4]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FUSION_BENCH_H__ */
@@ -0,0 +1,95 @@
+/**
+ * @file fusion_checkpoint.h
+ * @brief 融合引擎状态检查点 / Engine-independent fusion checkpoint
+ *
+ * v0.6.3: 睡眠前保存、唤醒后恢复融合状态, 替代按原始结构体保存的不透明数据块
+ * - 固定布局, 全部使用物理单位 (float), 与各引擎内部定点格式/结构体布局无关;
+ *   固件升级改变引擎结构体或切换 FUSION_TYPE 后仍可安全恢复
+ * - 内容: 姿态、陀螺仪偏差及其不确定度、加速度 LP、静止状态、磁参考
+ * - 磁参考的含义与引擎相关, 只在 engine 与写入方相同时恢复
+ * - 布局变化时递增 FUSION_CKPT_VERSION, 旧检查点被拒绝 (退回只恢复姿态)
+ *
+ * 每个引擎提供 xxx_save_checkpoint() / xxx_load_checkpoint():
+ *   load 只覆盖估计量, dt/增益等配置保持 init 时的值;
+ *   偏差协方差按 bias_sigma 设置, 静止检测计数直接置为已静止,
+ *   唤醒后第一个样本即从收敛状态继续, 不需要重新估计偏差
+ */
+
+#ifndef __FUSION_CHECKPOINT_H__
+#define __FUSION_CHECKPOINT_H__
+
+#include "optimize.h"
+#include "config.h"
+#include "fast_math.h"
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FUSION_CKPT_VERSION     1
+
+// flags
+#define FUSION_CKPT_F_REST      BIT(0)  // 保存时处于静止
+#define FUSION_CKPT_F_ACC_LP    BIT(1)  // acc_lp 有效
+#define FUSION_CKPT_F_MAG       BIT(2)  // mag_ref 有效 (引擎相关)
+
+#define FUSION_CKPT_BIAS_MAX    0.5f    // rad/s, 超出视为损坏
+#define FUSION_CKPT_SIGMA_MIN   1e-4f   // rad/s, 已收敛协方差保存的下限 (0 表示未知)
+
+// 头部 4 字节后全部为 float, 自然对齐, 不需要 PACKED
+typedef struct {
+    uint8_t version;            // FUSION_CKPT_VERSION
+    uint8_t engine;             // 写入方 FUSION_xxx 编号
+    uint8_t flags;
+    uint8_t reserved;
+    float quat[4];              // [w, x, y, z]
+    float gyro_bias[3];         // rad/s
+    float bias_sigma;           // 偏差估计 1σ (rad/s), 0 = 未知
+    float acc_lp[3];            // 机体系加速度 LP (g)
+    float mag_ref[3];           // 磁参考 (引擎内部表示)
+} fusion_checkpoint_t;          // 60 bytes
+
+/**
+ * @brief 检查点基本校验: 版本、四元数范数、偏差范围
+ */
+static inline bool fusion_ckpt_valid(const fusion_checkpoint_t *ckpt)
+{
+    if (ckpt->version != FUSION_CKPT_VERSION) return false;
+
+    float n2 = ckpt->quat[0] * ckpt->quat[0] + ckpt->quat[1] * ckpt->quat[1] +
+               ckpt->quat[2] * ckpt->quat[2] + ckpt->quat[3] * ckpt->quat[3];
+    if (!(n2 > 0.81f && n2 < 1.21f)) return false;     // 同时拒绝 NaN
+
+    for (int i = 0; i < 3; i++) {
+        if (!(fabsf(ckpt->gyro_bias[i]) < FUSION_CKPT_BIAS_MAX)) return false;
+    }
+    return ckpt->bias_sigma >= 0.0f;
+}
+
+/**
+ * @brief 偏差方差 → bias_sigma; 静止时协方差可衰减到 0, 保存为下限而不是 "未知"
+ */
+static inline float fusion_ckpt_sigma(float var)
+{
+    float s = fm_sqrt(var);
+    return (s < FUSION_CKPT_SIGMA_MIN) ? FUSION_CKPT_SIGMA_MIN : s;
+}
+
+/**
+ * @brief 写入方填充头部
+ */
+static inline void fusion_ckpt_header(fusion_checkpoint_t *ckpt, uint8_t engine)
+{
+    ckpt->version = FUSION_CKPT_VERSION;
+    ckpt->engine = engine;
+    ckpt->flags = 0;
+    ckpt->reserved = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FUSION_CHECKPOINT_H__ */
@@ -0,0 +1,156 @@
+/**
+ * @file fusion_switch.h
+ * @brief 运行时切换融合引擎 / Runtime-switchable fusion engine with hot handoff
+ *
+ * v0.6.3: FUSION_TYPE 只能在编译时选一个引擎; USE_FUSION_SWITCH 同时编译
+ * vqf_ultra (Q15, 最省电) 和一个精确引擎 (FUSION_SWITCH_ACCURATE), 运行时切换
+ * - 两个引擎状态共用一个 union, RAM 只按较大者计算
+ * - 切换经 fusion_checkpoint_t 交接姿态/偏差/偏差不确定度/静止状态:
+ *   先导出当前引擎, 再初始化目标引擎并载入, 下一个样本即从交接状态继续
+ * - 策略: 低电量或持续静止时降到 ultra, 运动时升到精确引擎 (均带迟滞)
+ *
+ * vqf_ultra 输入为 0.01 deg/s / mg 整数, 这里统一接收 rad/s / g 浮点并转换;
+ * ultra 不支持逐样本 dt 和磁力计, 运行 ultra 时 set_dt 忽略, 9 轴更新退回 6 轴
+ *
+ * Usage:
+ *   fusion_switch_t fs;
+ *   fusion_switch_init(&fs, 200);
+ *   fusion_switch_policy(&fs, motion_state_still_ms(), battery_percent);
+ *   fusion_switch_update(&fs, gyro, accel);
+ *   fusion_switch_get_quat(&fs, quat);
+ */
+
+#ifndef __FUSION_SWITCH_H__
+#define __FUSION_SWITCH_H__
+
+#include "optimize.h"
+#include "config.h"
+#include "fusion_checkpoint.h"
+#include "vqf_ultra.h"
+#include <stdbool.h>
+
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+#include "vqf_advanced.h"
+#elif FUSION_SWITCH_ACCURATE == FUSION_EKF_FIXED
+#include "ekf_fixed.h"
+#else
+#error "FUSION_SWITCH_ACCURATE must be FUSION_VQF_ADVANCED or FUSION_EKF_FIXED!"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef FUSION_SWITCH_STILL_MS
+#define FUSION_SWITCH_STILL_MS      2000    // 持续安静多久后降到 ultra
+#endif
+#ifndef FUSION_SWITCH_LOW_BATT_PCT
+#define FUSION_SWITCH_LOW_BATT_PCT  15      // 低于此电量固定使用 ultra
+#endif
+#define FUSION_SWITCH_BATT_HYST_PCT 5       // 电量回升超过 LOW + HYST 才恢复
+
+// 切换最短间隔 (样本数), 避免运动/静止边界来回交接
+#define FUSION_SWITCH_MIN_SAMPLES   50
+
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED && VQF_USE_MAGNETOMETER
+#define FUSION_SWITCH_HAS_MAG       1
+#else
+#define FUSION_SWITCH_HAS_MAG       0
+#endif
+
+/*============================================================================
+ * State
+ *============================================================================*/
+
+typedef struct {
+    union {
+        vqf_ultra_state_t ultra;
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+        vqf_state_t accurate;
+#else
+        ekf_fixed_state_t accurate;
+#endif
+    } u;
+    float dt;                   // 标称采样周期, 精确引擎初始化用
+    uint16_t odr_hz;            // ultra 初始化用
+    uint16_t hold;              // 距上次切换的样本数 (饱和)
+    uint8_t engine;             // 当前引擎 FUSION_VQF_ULTRA / FUSION_SWITCH_ACCURATE
+    uint8_t low_batt;           // 低电量锁定 (带迟滞)
+    uint16_t switches;          // 切换次数统计
+} fusion_switch_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * @brief 初始化, 从精确引擎开始
+ * @param odr_hz 标称采样率
+ */
+void fusion_switch_init(fusion_switch_t *fs, uint16_t odr_hz);
+
+/**
+ * @brief 6 轴更新
+ * @param gyro rad/s
+ * @param accel g
+ */
+void fusion_switch_update(fusion_switch_t *fs, const float gyro[3], const float accel[3]);
+
+#if FUSION_SWITCH_HAS_MAG
+/**
+ * @brief 9 轴更新, 运行 ultra 时忽略磁力计
+ */
+void fusion_switch_update_mag(fusion_switch_t *fs, const float gyro[3],
+                              const float accel[3], const float mag[3]);
+#endif
+
+/**
+ * @brief 设置下一次积分周期 (仅精确引擎, ultra 固定 dt)
+ */
+void fusion_switch_set_dt(fusion_switch_t *fs, float dt);
+
+/**
+ * @brief 外部静止状态 (仅 vqf_advanced + VQF_EXTERNAL_REST 时生效)
+ */
+void fusion_switch_set_rest(fusion_switch_t *fs, bool rest);
+
+void fusion_switch_get_quat(const fusion_switch_t *fs, float quat[4]);
+void fusion_switch_set_quat(fusion_switch_t *fs, const float quat[4]);
+void fusion_switch_reset(fusion_switch_t *fs);
+
+/**
+ * @brief 导出/载入当前引擎检查点 (睡眠保持)
+ * @return load: 0 成功, -1 检查点无效
+ */
+void fusion_switch_save_checkpoint(const fusion_switch_t *fs, fusion_checkpoint_t *ckpt);
+int fusion_switch_load_checkpoint(fusion_switch_t *fs, const fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief 切换到指定引擎, 经检查点交接状态
+ * @param engine FUSION_VQF_ULTRA 或 FUSION_SWITCH_ACCURATE
+ * @return 0 成功 (含已是该引擎), -1 引擎不支持
+ */
+int fusion_switch_select(fusion_switch_t *fs, uint8_t engine);
+
+/**
+ * @brief 功耗策略, 每个样本在 update 前调用一次
+ * @param still_ms 连续安静时长 (motion_state_still_ms(), 0 = 运动)
+ * @param battery_pct 电量百分比
+ * @return 当前引擎
+ */
+uint8_t fusion_switch_policy(fusion_switch_t *fs, uint32_t still_ms, uint8_t battery_pct);
+
+static FORCE_INLINE uint8_t fusion_switch_engine(const fusion_switch_t *fs)
+{
+    return fs->engine;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FUSION_SWITCH_H__ */
@@ -0,0 +1,104 @@
+/**
+ * @file fx_math.h
+ * @brief Q30 定点数学函数 / Shared Q30 fixed-point helpers
+ *
+ * v0.6.3: 从 vqf_fixed.c 提出, 供 vqf_fixed 和 ekf_fixed 共用
+ * - 单位四元数/单位向量/增益: Q30 (int32), 乘法经 64 位中间值
+ * - 范数用 64 位逐位整数平方根, 归一化只做一次 64 位除法
+ */
+
+#ifndef __FX_MATH_H__
+#define __FX_MATH_H__
+
+#include "optimize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FX_FRAC         30
+#define FX_ONE          (1L << FX_FRAC)
+#define FX(x)           ((int32_t)((x) * 1073741824.0 + (((x) >= 0) ? 0.5 : -0.5)))
+
+static FORCE_INLINE int32_t fx_mul(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> FX_FRAC);
+}
+
+static FORCE_INLINE int32_t fx_abs(int32_t x)
+{
+    return (x < 0) ? -x : x;
+}
+
+// 64 位整数平方根 (逐位法)
+static inline uint32_t fx_isqrt64(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > x) bit >>= 2;
+
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+// Q16 向量按 Q16 范数缩放为 Q30 单位向量 (一次除法)
+static inline void fx_vec3_unit_q16(const int32_t v[3], uint32_t norm_q16, int32_t out[3])
+{
+    int64_t inv = ((int64_t)1 << 46) / norm_q16;    // 1/norm in Q30
+
+    out[0] = (int32_t)(((int64_t)v[0] * inv) >> 16);
+    out[1] = (int32_t)(((int64_t)v[1] * inv) >> 16);
+    out[2] = (int32_t)(((int64_t)v[2] * inv) >> 16);
+}
+
+// 四元数乘法 out = a ⊗ b (Q30)
+static inline void fx_quat_mul(const int32_t a[4], const int32_t b[4], int32_t out[4])
+{
+    out[0] = fx_mul(a[0], b[0]) - fx_mul(a[1], b[1]) - fx_mul(a[2], b[2]) - fx_mul(a[3], b[3]);
+    out[1] = fx_mul(a[0], b[1]) + fx_mul(a[1], b[0]) + fx_mul(a[2], b[3]) - fx_mul(a[3], b[2]);
+    out[2] = fx_mul(a[0], b[2]) - fx_mul(a[1], b[3]) + fx_mul(a[2], b[0]) + fx_mul(a[3], b[1]);
+    out[3] = fx_mul(a[0], b[3]) + fx_mul(a[1], b[2]) - fx_mul(a[2], b[1]) + fx_mul(a[3], b[0]);
+}
+
+// 四元数归一化: 近单位时一阶牛顿 q *= (3 - |q|²) / 2
+static inline void fx_quat_normalize(int32_t q[4])
+{
+    int64_t n2 = ((int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] +
+                  (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> FX_FRAC;
+    int64_t err = n2 - FX_ONE;
+
+    if (err > -(FX_ONE >> 6) && err < (FX_ONE >> 6)) {
+        int32_t s = (int32_t)((3 * (int64_t)FX_ONE - n2) >> 1);
+        q[0] = fx_mul(q[0], s);
+        q[1] = fx_mul(q[1], s);
+        q[2] = fx_mul(q[2], s);
+        q[3] = fx_mul(q[3], s);
+        return;
+    }
+
+    // 偏离较大 (set_quat 或数值异常): 完整归一化
+    uint32_t n = fx_isqrt64((uint64_t)n2 << FX_FRAC);
+    if (n == 0) {
+        q[0] = FX_ONE;
+        q[1] = q[2] = q[3] = 0;
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        q[i] = (int32_t)(((int64_t)q[i] << FX_FRAC) / n);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FX_MATH_H__ */
@@ -20,6 +20,7 @@ extern "C" {
  *============================================================================*/
 
 typedef struct {
+    // v0.6.3: 以下滤波级开关仅对编译进来的级有效 (GYRO_FILTER_* in config.h)
     bool enable_median;         // 启用中值滤波
     bool enable_moving_avg;     // 启用移动平均
     bool enable_kalman;         // 启用卡尔曼滤波
@@ -68,7 +69,9 @@ int gyro_filter_calibrate(float gyro_samples[][3], int count, float temperature)
 /**
  * @brief 处理陀螺仪数据
  * @param gyro_in 输入陀螺仪数据 [rad/s]
- * @param gyro_out 输出滤波后数据 [rad/s]
+ * @param gyro_out 输出滤波后数据 [rad/s]; GYRO_FILTER_DETECT_ONLY 时只做静止检测,
+ *                 输出为偏差校正后的未滤波值, 可为 NULL
+ * @note GYRO_FILTER_DETECT_ONLY 时静止判定取 motion_state, 需先调用 motion_state_update
  * @param accel 加速度计数据 (用于静止检测, 可为 NULL)
  * @param temperature 当前温度 (°C)
  */
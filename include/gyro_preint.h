@@ -0,0 +1,51 @@
+/**
+ * @file gyro_preint.h
+ * @brief 陀螺仪多样本预积分 / Multi-sample gyro preintegration with coning correction
+ *
+ * v0.6.3: FIFO 批量/降频校正时, 把两次校正之间的 N 个陀螺仪样本压缩为一个
+ * 旋转向量增量, 融合引擎每次校正只做一次四元数乘法 + 归一化
+ * - 增量角 Δα_k = ω_k·dt_k 累加, 二阶锥运动补偿 (Bortz 递推):
+ *     β += ½·α × Δα + (1/12)·Δα_prev × Δα,   α += Δα,   φ = α + β
+ *   每样本只有两次叉乘, 没有三角函数和归一化
+ * - 同时累加加速度, 校正步使用区间平均值 (抗混叠, 降低单样本噪声);
+ *   AHRS 不积分速度, 不需要划船 (sculling) 补偿
+ * - 输入为已减去外部校准偏移的角速度, 引擎自身偏差估计在应用增量时按 b·T 扣除
+ */
+
+#ifndef __GYRO_PREINT_H__
+#define __GYRO_PREINT_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gyro_preint_reset(void);
+
+/**
+ * @brief 累加一个样本
+ * @param gyro rad/s
+ * @param accel g
+ * @param dt 本样本周期 (s)
+ */
+void gyro_preint_add(const float gyro[3], const float accel[3], float dt);
+
+/**
+ * @brief 已累加的样本数
+ */
+uint8_t gyro_preint_count(void);
+
+/**
+ * @brief 取出预积分结果 (不清零, 取出后调用 gyro_preint_reset)
+ * @param dtheta 旋转向量增量 φ (rad, 机体系)
+ * @param accel_mean 区间平均加速度 (g), 可为 NULL
+ * @return 区间总时长 T (s), 无样本时返回 0
+ */
+float gyro_preint_get(float dtheta[3], float accel_mean[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GYRO_PREINT_H__ */
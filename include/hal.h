@@ -52,6 +52,33 @@ int hal_i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len);
  */
 int hal_i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t len);
 
+/**
+ * @brief I2C async completion callback (called from I2C IRQ)
+ * @param status 0 on success, negative on bus error / NACK
+ * @param ctx User context passed to hal_i2c_read_reg_async
+ */
+typedef void (*hal_i2c_async_cb_t)(int status, void *ctx);
+
+/**
+ * @brief Start an interrupt-driven register read (non-blocking)
+ * @param addr 7-bit device address
+ * @param reg Register address
+ * @param data Destination buffer, must stay valid until callback
+ * @param len Number of bytes to read
+ * @param callback Completion callback (may be NULL, poll hal_i2c_busy)
+ * @param ctx User context for callback
+ * @return 0 if started, -1 bad args, -2 bus busy
+ * @note Requires USE_HW_I2C; with software I2C the read completes
+ *       synchronously and the callback runs before return
+ */
+int hal_i2c_read_reg_async(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len,
+                           hal_i2c_async_cb_t callback, void *ctx);
+
+/**
+ * @brief Check if an async I2C transfer is in progress
+ */
+bool hal_i2c_busy(void);
+
 /**
  * @brief Read single byte from I2C device
  */
@@ -109,6 +136,44 @@ uint8_t hal_spi_xfer(uint8_t data);
  */
 void hal_spi_cs(uint8_t state);
 
+/*
+ * v0.6.3: 每设备 SPI 时钟档 (USE_SPI_PROFILES)
+ * 共用 SPI0 的设备各自记录最高 SCK, hal_spi_select 换设备时写入对应分频;
+ * 分频由当前系统时钟派生 (SCK = Fsys / div, div = 2..255, 向上取整不超过上限)
+ */
+typedef enum {
+    HAL_SPI_DEV_IMU = 0,        // 主 IMU
+    HAL_SPI_DEV_IMU_AUX,        // 辅助 IMU (USE_AUX_IMU)
+    HAL_SPI_DEV_COUNT
+} hal_spi_dev_t;
+
+/**
+ * @brief 设置设备的最高 SCK 并重新派生分频 (不切换当前设备)
+ * @return 0=成功, -1=参数错误
+ */
+int hal_spi_profile_set(uint8_t dev, uint32_t max_hz);
+
+/**
+ * @brief 设备在当前系统时钟下的实际 SCK (Hz), 未设置时为 0
+ */
+uint32_t hal_spi_profile_hz(uint8_t dev);
+
+/**
+ * @brief 当前系统时钟下比 hz 低一档的 SCK (分频 +1), 已是最低档时返回 0
+ */
+uint32_t hal_spi_step_down(uint32_t hz);
+
+/**
+ * @brief 切换到设备的时钟档 (写分频寄存器); 在拉低片选之前调用
+ */
+void hal_spi_select(uint8_t dev);
+
+/**
+ * @brief 系统时钟已切换, 按新时钟重新派生各设备分频并重写当前设备的分频
+ * @note 在 hal_timer_set_sysclk 之后调用; SPI 突发 (含 DMA) 不应跨越时钟切换
+ */
+void hal_spi_set_sysclk(uint32_t hz);
+
 /*============================================================================
  * DMA Interface
  *============================================================================*/
@@ -118,6 +183,103 @@ void hal_spi_cs(uint8_t state);
  */
 void hal_dma_init(void);
 
+/**
+ * @brief v0.6.3: Start a one-shot SPI DMA read
+ * @param cs_pin Chip select pin
+ * @param cmd Command byte sent before the burst (e.g. reg | 0x80)
+ * @param len Bytes to receive (<= 64)
+ * @param callback Called from IRQ with the received data (may be NULL);
+ *                 the buffer stays valid until the transfer after next
+ * @return 0 started, -1 busy, bad length or DMA ring active
+ */
+int hal_spi_dma_start(uint8_t cs_pin, uint8_t cmd, uint16_t len,
+                      void (*callback)(uint8_t *data, uint16_t len, void *ctx), void *ctx);
+
+/**
+ * @brief Check if a one-shot SPI DMA transfer is in flight
+ */
+bool hal_dma_spi_busy(void);
+
+/**
+ * @brief v0.6.3: Start a one-shot SPI DMA write (command byte by PIO, then payload)
+ * @param data Payload in RAM (SPI0 DMA addresses RAM only); must stay valid until done
+ * @param len 1 - 4095 bytes
+ * @param done Called from IRQ after CS is released (may be NULL); may start the next write
+ * @return 0 started, -1 busy, bad length or DMA ring active
+ */
+int hal_spi_dma_write(uint8_t cs_pin, uint8_t cmd, const uint8_t *data, uint16_t len,
+                      void (*done)(void));
+
+/*
+ * v0.6.3: SPI DMA ping-pong ring (zero-copy)
+ *
+ * Drivers decode directly from frame->data and call release() when
+ * fusion is done with the sample; only then may DMA reuse the slot.
+ */
+
+#define HAL_DMA_RING_SLOTS  2
+#define HAL_DMA_FRAME_MAX   64
+
+typedef struct {
+    const uint8_t *data;        // Payload (command byte not included)
+    uint16_t len;
+    uint32_t timestamp_us;      // Trigger time passed to kick()
+    uint8_t slot;
+} hal_dma_frame_t;
+
+/**
+ * @brief Set up the ring for a fixed burst read
+ * @param cs_pin Chip select pin
+ * @param cmd Command byte sent before the burst (e.g. reg | 0x80)
+ * @param len Payload length per frame (<= HAL_DMA_FRAME_MAX)
+ * @param notify Called from IRQ when a frame becomes ready (may be NULL)
+ * @return 0 on success, -1 bad length
+ */
+int hal_spi_dma_ring_init(uint8_t cs_pin, uint8_t cmd, uint16_t len, void (*notify)(void));
+
+/**
+ * @brief Start a DMA burst into a free slot (safe from IRQ)
+ * @return 0 started, -1 no free slot (overrun counted), -2 transfer in flight,
+ *         -3 deferred until hal_spi_sync_end() (synchronous transaction active)
+ */
+int hal_spi_dma_ring_kick(uint32_t timestamp_us);
+
+/**
+ * @brief DMA completion handler (called from SPI0 IRQ)
+ */
+void hal_spi_dma_ring_complete(void);
+
+/**
+ * @brief Take ownership of the oldest ready frame
+ * @return Frame owned by CPU, or NULL if none ready
+ */
+const hal_dma_frame_t *hal_spi_dma_ring_acquire(void);
+
+/**
+ * @brief Return a frame to DMA after decoding
+ */
+void hal_spi_dma_ring_release(const hal_dma_frame_t *frame);
+
+/**
+ * @brief Check if a ready frame is waiting
+ */
+bool hal_spi_dma_ring_pending(void);
+
+/**
+ * @brief Number of samples dropped because both slots were held by CPU
+ */
+uint32_t hal_spi_dma_ring_overruns(void);
+
+/**
+ * @brief v0.6.3: Bracket a synchronous (PIO) transaction on the ring's SPI bus
+ *
+ * begin() waits for an in-flight burst to release CS; until the matching
+ * end(), kick() defers instead of starting DMA, and end() starts the deferred
+ * burst. Nestable, callable whether or not the ring is active.
+ */
+void hal_spi_sync_begin(void);
+void hal_spi_sync_end(void);
+
 /*============================================================================
  * GPIO Interface
  *============================================================================*/
@@ -155,6 +317,12 @@ bool hal_gpio_read(uint8_t pin);
  */
 int hal_gpio_set_interrupt(uint8_t pin, hal_gpio_int_t type, void (*callback)(void));
 
+/**
+ * @brief v0.6.3: Change the trigger edge of an already configured interrupt
+ *        (CH59X has no both-edges mode; callers toggle RISING/FALLING)
+ */
+int hal_gpio_set_int_edge(uint8_t pin, hal_gpio_int_t type);
+
 /*============================================================================
  * Timer Interface
  *============================================================================*/
@@ -171,9 +339,32 @@ uint32_t hal_millis(void);
 
 /**
  * @brief Get microseconds since boot
+ * @note v0.6.3: hal_micros64 的低 32 位, 约 71 分钟回绕; 间隔一律用 (now - last)
+ *       的无符号差值计算, 超过回绕周期的间隔、日志和时间同步用 hal_micros64
  */
 uint32_t hal_micros(void);
 
+/**
+ * @brief v0.6.3: 64 位单调微秒时基 (全固件唯一时基, RF/传感器/电源/日志共用)
+ *
+ * TMR0 计数 + 1ms 节拍中断扩展; 中断屏蔽期间调用也不会倒退.
+ * hal_millis / hal_get_tick_us / rf_hw_get_time_us 均由同一计数派生
+ */
+uint64_t hal_micros64(void);
+
+/**
+ * @brief v0.6.3: 系统时钟已切换, 重新派生 TMR0 (hal_micros/hal_millis), TMR3 (睡眠唤醒),
+ *        hal_delay_us 和 TMR1 换算 (在写时钟分频寄存器之后立即调用)
+ * @param hz 新的系统时钟
+ * @note hal_micros 跨切换保持连续; 已有的 TMR1 计数按新频率换算
+ */
+void hal_timer_set_sysclk(uint32_t hz);
+
+/**
+ * @brief v0.6.3: 当前系统时钟 (Hz)
+ */
+uint32_t hal_get_sysclk_hz(void);
+
 /**
  * @brief Delay in milliseconds
  */
@@ -184,6 +375,64 @@ void hal_delay_ms(uint32_t ms);
  */
 void hal_delay_us(uint32_t us);
 
+/**
+ * @brief v0.6.3: 低功耗等待到指定时刻 (hal_micros 时基, 回绕安全)
+ *
+ * TMR3 单次定时唤醒 + WFI 睡眠, 按学习到的唤醒延迟提前醒来, 最后一段忙等.
+ * 需在中断开启的上下文中调用; TMR3 供此函数独占
+ *
+ * @return 实际到达时刻相对目标的误差 (us, 正值 = 晚到)
+ */
+int32_t hal_sleep_until_us(uint32_t target_us);
+
+/**
+ * @brief v0.6.3: 当前学习到的唤醒延迟 (us)
+ */
+uint16_t hal_sleep_get_latency_us(void);
+
+/**
+ * @brief v0.6.3: 低功耗等待事件标志 (由中断置位) 或到达 deadline, 先到者返回
+ *
+ * 与 hal_sleep_until_us 共用 TMR3, 只在 deadline 唤醒, 没有提前量 (超时判定用,
+ * 不保证准时); 标志由调用方在等待前清除. 需在中断开启的上下文中调用
+ *
+ * @return 标志是否已置位
+ */
+bool hal_wait_flag_until_us(volatile bool *flag, uint32_t target_us);
+
+/**
+ * @brief v0.6.3: RTC 32.768kHz 计数 (Halt/Shutdown 期间继续计数, 每天回绕)
+ *
+ * 用于跨睡眠计时: hal_micros 的 TMR0 在低功耗模式下停止
+ */
+#define HAL_RTC_HZ              32768UL
+#define HAL_RTC_DAY_CYCLES      (86400UL * HAL_RTC_HZ)
+
+uint32_t hal_rtc_get_cycles(void);
+
+/**
+ * @brief v0.6.3: 自 since (hal_rtc_get_cycles 返回值) 起经过的时间
+ * @return us, 处理一次日回绕, 超过 32 位时饱和
+ */
+uint32_t hal_rtc_elapsed_us(uint32_t since);
+
+/**
+ * @brief v0.6.3: 启动 TMR1 捕获 PA10 上升沿 (USE_HW_TIMESTAMP, HW_TS_IMU_CAPTURE)
+ * @note 与 hal_hr_timer / hal_clkout 互斥
+ */
+int hal_ts_capture_init(void);
+
+void hal_ts_capture_stop(void);
+
+/**
+ * @brief v0.6.3: 最近一个捕获沿的时刻 (hal_micros 时基), 在该沿的中断中调用
+ *
+ * 由定时器计数回推, 不含中断响应延迟; 未检测到沿时返回当前时刻
+ *
+ * @param period_ns 输出与上一沿的间隔 (系统时钟精度, 0 = 尚无), 可为 NULL
+ */
+uint32_t hal_ts_capture_edge_us(uint32_t *period_ns);
+
 /*============================================================================
  * Power Management
  *============================================================================*/
@@ -222,6 +471,102 @@ int hal_storage_write(uint32_t addr, const void *data, uint16_t len);
  */
 int hal_storage_erase(uint32_t addr, uint16_t len);
 
+/*============================================================================
+ * v0.6.3: Key-Value Storage (追加写日志, 磨损均衡, 掉电安全)
+ *
+ * 记录追加到活跃段, 新值覆盖旧值; 段满时整理到另一段.
+ * 记录头在值之后写入, 掉电只会丢失最后一次未完成的写入.
+ *============================================================================*/
+
+#define HAL_KV_MAX_KEYS         16
+#define HAL_KV_MAX_VALUE        240
+
+// 键分配
+#define HAL_KV_CONFIG           1   // hal_storage_save_config
+#define HAL_KV_CALIB            2   // hal_storage_save_calibration
+#define HAL_KV_PAIRING          3   // hal_storage_save_pairing
+#define HAL_KV_NETWORK_KEY      4   // 接收器网络密钥
+#define HAL_KV_TEMP_COMP        5   // 陀螺温度补偿系数
+#define HAL_KV_TRACKER_PAIRING  6   // tracker 配对数据 (main_tracker.c)
+#define HAL_KV_RX_CONFIG        7   // 接收器配置 (main_receiver.c)
+#define HAL_KV_ACCEL_CALIB      8   // 加速度计椭球校准 (auto_calibration.c)
+#define HAL_KV_MAG_CALIB        9   // 磁力计椭球校准 (mag_interface.c)
+#define HAL_KV_TELEM_CUR        10  // 当前会话遥测快照 (telemetry_history.c)
+#define HAL_KV_TELEM_HIST       11  // 历史会话遥测 (telemetry_history.c)
+#define HAL_KV_LINK_KEY         12  // 链路认证密钥 (rf_auth.c)
+#define HAL_KV_AUTH_EPOCH       13  // 接收器认证纪元预留上限 (rf_auth.c)
+#define HAL_KV_ROAM_CELL        14  // 接收器漫游小区号 (main_receiver.c)
+
+// 错误码
+#define HAL_KV_ERR_PARAM        (-1)
+#define HAL_KV_ERR_NOT_FOUND    (-2)
+#define HAL_KV_ERR_CRC          (-3)
+#define HAL_KV_ERR_FULL         (-4)
+#define HAL_KV_ERR_IO           (-5)
+#define HAL_KV_ERR_DELETED      (-6)    // 已删除 (NOT_FOUND 表示从未写入)
+
+/**
+ * @brief 读取键值
+ * @param len 缓冲区长度, 超出部分截断
+ * @return 存储的值长度, 负数为 HAL_KV_ERR_*
+ */
+int hal_kv_get(uint8_t key, void *data, uint16_t len);
+
+/**
+ * @brief 写入键值 (值未变化时不写 Flash)
+ * @param len 1 - HAL_KV_MAX_VALUE
+ * @return 0 成功, 负数为 HAL_KV_ERR_*
+ */
+int hal_kv_set(uint8_t key, const void *data, uint16_t len);
+
+/**
+ * @brief 删除键 (写入删除标记)
+ */
+int hal_kv_delete(uint8_t key);
+
+/**
+ * @brief 立即把有效记录整理到另一段
+ * @return 0 成功, HAL_KV_ERR_FULL 有效记录放不下一段 (活动段不变), HAL_KV_ERR_IO Flash 故障
+ */
+int hal_kv_compact(void);
+
+/**
+ * @brief 活跃段剩余字节数
+ */
+uint16_t hal_kv_free_bytes(void);
+
+/**
+ * @brief 空闲窗口回调: 返回距下一次 RF 活动的微秒数 (0 = 现在不可擦写)
+ */
+typedef uint32_t (*hal_storage_window_cb_t)(void);
+
+/**
+ * @brief 后台写入键值: 只拷贝到 RAM, 由 hal_storage_process 在空闲窗口写入
+ * @note 同键覆盖; hal_kv_get 立即返回新值
+ * @return 0 成功, 负数为 HAL_KV_ERR_*
+ */
+int hal_kv_set_deferred(uint8_t key, const void *data, uint16_t len);
+
+/**
+ * @brief 设置空闲窗口回调, NULL = 不限制 (下一次 process 即写入)
+ */
+void hal_storage_set_window_cb(hal_storage_window_cb_t cb);
+
+/**
+ * @brief 执行一步后台写入 (主循环, RF 任务之后)
+ */
+void hal_storage_process(void);
+
+/**
+ * @brief 是否有待写数据
+ */
+bool hal_storage_pending(void);
+
+/**
+ * @brief 立即写完全部待写数据 (睡眠/关机前)
+ */
+int hal_storage_flush(void);
+
 /*============================================================================
  * Network Key Storage (用于 RF 配对安全)
  *============================================================================*/
@@ -270,9 +615,11 @@ uint32_t hal_get_tick_ms(void);
 uint32_t hal_get_tick_us(void);
 
 /*============================================================================
- * CRC Calculation (v0.6.2 统一实现)
+ * CRC Calculation (v0.6.2 统一实现, v0.6.3 半字节查表, hal_crc.c)
  *============================================================================*/
 
+#define HAL_CRC16_INIT          0xFFFF
+
 /**
  * @brief 计算CRC16 (Modbus多项式0xA001)
  * @param data 数据指针
@@ -281,6 +628,32 @@ uint32_t hal_get_tick_us(void);
  */
 uint16_t hal_crc16(const void *data, uint16_t len);
 
+/**
+ * @brief v0.6.3: 分块累积 CRC16, 首块传入 HAL_CRC16_INIT
+ */
+uint16_t hal_crc16_update(uint16_t crc, const void *data, uint16_t len);
+
+/**
+ * @brief v0.6.3: 计算CRC8 (多项式0x07, 初值0xFF)
+ */
+uint8_t hal_crc8(const void *data, uint16_t len);
+
+#if defined(BUILD_HOST)
+/*============================================================================
+ * v0.6.3: 主机回放/仿真 HAL 桩 (hal_host.c)
+ *============================================================================*/
+
+/**
+ * @brief 设置回放时钟 (hal_millis/hal_micros/hal_get_tick_xx 均由此派生)
+ */
+void hal_host_set_time_us(uint64_t us);
+
+/**
+ * @brief 重设 hal_get_random_u32 的种子 (仿真可复现)
+ */
+void hal_host_seed_random(uint32_t seed);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,59 @@
+/**
+ * @file hal_button.h
+ * @brief v0.6.3 中断驱动按键 / Edge-interrupt button with timer debounce (USE_BUTTON_IRQ)
+ *
+ * 替代主循环每次读引脚的轮询状态机:
+ * - 引脚边沿中断只重置去抖计时; CH59x 只支持单边沿, 每次稳定后切换到相反边沿
+ * - 去抖和手势 (长按 / 双击窗口) 用单次倒计时, 挂在 TMR0 1ms 节拍里, 空闲时不计时
+ * - 识别出的单击/双击/长按记入事件位图并调用 notify (事件循环里投递 EVQ_BUTTON)
+ * 主循环只在收到通知后取一次事件, 按键空闲时不需要任何轮询
+ */
+
+#ifndef __HAL_BUTTON_H__
+#define __HAL_BUTTON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAL_BTN_SINGLE          0x01
+#define HAL_BTN_DOUBLE          0x02
+#define HAL_BTN_LONG            0x04
+
+typedef struct {
+    uint8_t debounce_ms;        // 最后一个边沿之后保持稳定的时间
+    uint16_t long_press_ms;
+    uint16_t double_click_ms;   // 松开后等待第二次按下的窗口
+} hal_button_config_t;
+
+/**
+ * @brief 配置按键 (低电平有效, 内部上拉) 并开启边沿中断
+ * @param notify 产生新事件时在中断上下文调用, 可为 NULL
+ * @return 0 成功, -1 GPIO 回调已满
+ */
+int hal_button_init(uint8_t pin, const hal_button_config_t *cfg, void (*notify)(void));
+
+/**
+ * @brief 取出并清除已识别的事件 (HAL_BTN_* 位图)
+ */
+uint8_t hal_button_take_events(void);
+
+/**
+ * @brief 睡眠唤醒后重新同步电平和边沿 (唤醒用的那次按下不计为点击)
+ */
+void hal_button_resume(void);
+
+/**
+ * @brief 1ms 节拍 (TMR0 中断中调用)
+ */
+void hal_button_tick_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HAL_BUTTON_H__ */
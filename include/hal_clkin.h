@@ -0,0 +1,66 @@
+/**
+ * @file hal_clkin.h
+ * @brief 外部时钟输入/输出 for IMU
+ *
+ * MCU 通过 TMR1 PWM (PA6) 给 IMU CLKIN 提供参考时钟
+ * v0.6.3: 支持以 ppb 为单位微调输出频率, 用于把 IMU ODR 锁到 RF 超帧
+ *
+ * 注意: TMR1 与 hal_hr_timer 共用, 两者不能同时启用
+ */
+
+#ifndef __HAL_CLKIN_H__
+#define __HAL_CLKIN_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化外部时钟输出 (MCU -> IMU CLKIN)
+ * @return 0 成功, -1 平台不支持
+ */
+int hal_clkout_init(void);
+
+/**
+ * @brief 停止外部时钟输出
+ */
+void hal_clkout_stop(void);
+
+/**
+ * @brief v0.6.3: 调整时钟输出频率
+ *
+ * 周期按 Q16 计算, 小数部分用 sigma-delta 在相邻两个整数周期间抖动;
+ * 每次调用推进一步, 按固定节拍 (每个超帧) 调用时平均频率即为目标值
+ *
+ * @param trim_ppb 相对标称频率的偏差 (ppb, 正值更快)
+ */
+void hal_clkout_set_trim_ppb(int32_t trim_ppb);
+
+/**
+ * @brief 初始化外部时钟输入 (可选, 用于同步)
+ * @return 0 成功
+ */
+int hal_clkin_init(void);
+
+/**
+ * @brief 获取外部时钟计数
+ */
+uint32_t hal_clkin_get_count(void);
+
+/**
+ * @brief 配置 ICM-45686 使用外部时钟
+ */
+void icm45686_use_external_clock(void);
+
+/**
+ * @brief 配置 BMI270 使用外部时钟
+ */
+void bmi270_use_external_clock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HAL_CLKIN_H__ */
@@ -0,0 +1,54 @@
+/**
+ * @file hal_led.h
+ * @brief v0.6.3 LED 图案驱动 / Timer-driven LED patterns (USE_LED_PATTERN)
+ *
+ * 主循环不再比较 hal_get_tick_ms() 翻转 LED:
+ * - 图案 (亮/灭时长) 放在常量表里, 由 TMR0 1ms 系统节拍中断推进, 只在电平变化时写 GPIO
+ * - 亮期内按 LED_PWM_ON_MS / LED_PWM_PERIOD_MS 做软件 PWM 调光, 降低 LED 平均电流
+ * - 主循环只在状态变化时调用 hal_led_set_pattern(), 相同图案重复设置无副作用
+ * PA9 不是 PWMx 输出脚, 其复用的 TMR0 又是系统节拍, 所以复用节拍中断而不另占定时器
+ */
+
+#ifndef __HAL_LED_H__
+#define __HAL_LED_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LED_PATTERN_OFF = 0,
+    LED_PATTERN_ON,             // 常亮 (调光)
+    LED_PATTERN_BLINK_SLOW,     // 500ms 亮 / 500ms 灭
+    LED_PATTERN_BLINK_PAIR,     // 200ms / 200ms
+    LED_PATTERN_BLINK_FAST,     // 100ms / 100ms
+    LED_PATTERN_BLINK_RAPID,    // 50ms / 50ms
+    LED_PATTERN_COUNT
+} led_pattern_t;
+
+/**
+ * @brief 绑定 LED 引脚 (调用方已配置为输出), 图案复位为 OFF
+ */
+void hal_led_init(uint8_t pin);
+
+/**
+ * @brief 切换图案, 下一个节拍生效并从亮期开始; OFF 立即熄灭 (休眠前调用)
+ */
+void hal_led_set_pattern(led_pattern_t pattern);
+
+led_pattern_t hal_led_get_pattern(void);
+
+/**
+ * @brief 1ms 节拍 (TMR0 中断中调用)
+ */
+void hal_led_tick_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HAL_LED_H__ */
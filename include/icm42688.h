@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,6 +87,20 @@ int icm42688_self_test(void);
  */
 bool icm42688_data_ready(void);
 
+/**
+ * @brief v0.6.3: Enable FIFO (packet 3) with watermark interrupt on INT1
+ * @param watermark Watermark in frames (1..IMU_FIFO_MAX_BATCH)
+ * @return 0 on success, negative on error
+ */
+int icm42688_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: Burst-read up to n FIFO frames, see imu_fifo.h
+ * @param ts Per-frame TMST in 1us ticks (extended to 32 bit), may be NULL
+ * @return Frames read, negative on error
+ */
+int icm42688_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -312,6 +313,26 @@ int icm45686_read_data(icm45686_data_t *data);
  */
 int icm45686_read_raw(icm45686_raw_data_t *data);
 
+// Burst layout used by read_raw and the SPI DMA ring: TEMP(2) + ACCEL(6) + GYRO(6)
+#define ICM45686_BURST_REG      ICM45686_REG_TEMP_DATA1
+#define ICM45686_BURST_LEN      14
+
+/**
+ * @brief Decode a raw burst buffer (ICM45686_BURST_LEN bytes, big-endian)
+ * @param buf Burst payload, e.g. hal_dma_frame_t::data
+ * @param data Output raw counts
+ */
+void icm45686_decode_raw(const uint8_t *buf, icm45686_raw_data_t *data);
+
+/**
+ * @brief Decode a burst buffer in place into physical units
+ * @param buf Burst payload (not copied)
+ * @param gyro_dps Output gyro [dps]
+ * @param accel_g Output accel [g]
+ * @param temp Output temperature [degC] (may be NULL)
+ */
+void icm45686_decode_burst(const uint8_t *buf, float gyro_dps[3], float accel_g[3], float *temp);
+
 /**
  * @brief Check if data is ready
  * @return true if data ready
@@ -356,6 +377,20 @@ float icm45686_get_gyro_sensitivity(void);
  */
 float icm45686_get_accel_sensitivity(void);
 
+/**
+ * @brief v0.6.3: Enable FIFO with watermark interrupt on INT1
+ * @param watermark Watermark in frames (1..IMU_FIFO_MAX_BATCH)
+ * @return 0 on success, negative on error
+ */
+int icm45686_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: Read up to n FIFO frames, see imu_fifo.h
+ * @param ts Per-frame TMST in 1us ticks (extended to 32 bit), may be NULL
+ * @return Frames read, negative on error
+ */
+int icm45686_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #ifdef __cplusplus
 }
 #endif
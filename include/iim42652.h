@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 /*============================================================================
  * 寄存器定义
@@ -100,6 +101,12 @@ int iim42652_read(float gyro[3], float accel[3]);
 int iim42652_read_raw(int16_t gyro[3], int16_t accel[3]);
 float iim42652_read_temp(void);
 
+// v0.6.3: FIFO 批量读取 (见 imu_fifo.h), ts 为 TMST (1us, 扩展为 32 位)
+int iim42652_fifo_enable(uint8_t watermark);
+int iim42652_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+int iim42652_fifo_disable(void);
+int iim42652_fifo_flush(void);
+
 // 电源管理
 int iim42652_suspend(void);
 int iim42652_resume(void);
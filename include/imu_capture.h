@@ -0,0 +1,85 @@
+/**
+ * @file imu_capture.h
+ * @brief 原始 IMU 全速率采集 / Raw IMU capture at full ODR for offline replay
+ *
+ * v0.6.3: 在 imu_interface 的换算入口 (sample_convert) 记录驱动解码后的 int16
+ * 原始值 (已按板级安装方向换轴), 经 usb_debug 数据流 (stream_mask bit5) 输出,
+ * 主机端 tools/imu_capture.py 保存; 配合参数报告可离线逐位复现送入融合的浮点样本
+ *
+ * - 样本路径 (可能在 DMA 中断内) 只写环形缓冲, 写满时丢弃新样本, 序号照常递增
+ * - 每个样本带 16 位序号, 主机按序号间隔统计丢失
+ * - 参数报告在采集开始和每次换算参数变化 (偏置/温度补偿) 时发送,
+ *   标明从哪个序号起生效: float = raw × gain - off (float32)
+ *
+ * 样本报告 (64 字节以内):
+ *   [0]     IMU_CAPTURE_REPORT_ID
+ *   [1]     样本数 (1..IMU_CAPTURE_PER_REPORT)
+ *   [2-3]   首个样本序号 LE (报告内序号连续)
+ *   [4..]   每样本 12 字节: gx gy gz ax ay az (int16 LE)
+ *
+ * 参数报告:
+ *   [0]     IMU_CAPTURE_PARAM_ID
+ *   [1]     IMU 类型 (imu_get_type)
+ *   [2-3]   标称 ODR (Hz) LE
+ *   [4-5]   生效序号 LE
+ *   [6..53] float32 LE: gyro_gain[3] gyro_off[3] (rad/s), accel_gain[3] accel_off[3] (g)
+ */
+
+#ifndef __IMU_CAPTURE_H__
+#define __IMU_CAPTURE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMU_CAPTURE_REPORT_ID   0xFC
+#define IMU_CAPTURE_PARAM_ID    0xFB
+#define IMU_CAPTURE_DEPTH       32      // 环形缓冲样本数 (2 的幂), 1600Hz 下约 20ms
+#define IMU_CAPTURE_PER_REPORT  5
+#define IMU_CAPTURE_HEADER_SIZE 4
+#define IMU_CAPTURE_SAMPLE_SIZE 12
+#define IMU_CAPTURE_PARAM_SIZE  54
+
+/**
+ * @brief 开始/停止采集 (开始时清空缓冲, 序号归零, 先发送参数报告)
+ */
+void imu_capture_enable(bool enable);
+
+bool imu_capture_enabled(void);
+
+/**
+ * @brief 记录一个原始样本 (样本路径, 未启用时直接返回)
+ */
+void imu_capture_push(const int16_t gyro[3], const int16_t accel[3]);
+
+/**
+ * @brief 更新换算参数 (imu_interface 重算预处理时调用)
+ */
+void imu_capture_set_params(uint8_t imu_type, const float gyro_gain[3], const float gyro_off[3],
+                            const float accel_gain[3], const float accel_off[3]);
+
+/**
+ * @brief 生成下一个报告但不移出 (主循环), 发送成功后调用 imu_capture_ack
+ * @param buf 至少 64 字节
+ * @return 报告长度, 0 = 暂无
+ */
+uint8_t imu_capture_build(uint8_t *buf);
+
+/**
+ * @brief 确认上一次 imu_capture_build 的报告已发出
+ */
+void imu_capture_ack(void);
+
+/**
+ * @brief 因缓冲满丢弃的样本数
+ */
+uint32_t imu_capture_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_CAPTURE_H__ */
@@ -0,0 +1,73 @@
+/**
+ * @file imu_clock_sync.h
+ * @brief IMU 采样与 RF 超帧相位锁定 / IMU ODR phase lock to RF superframe
+ *
+ * v0.6.3: MCU 经 PA6 (TMR1 PWM) 给 IMU CLKIN 提供参考时钟, 用 PI 环微调其频率,
+ * 使每个 IMU 样本的时间戳落在本 tracker 发射时隙之前固定提前量处:
+ * - 样本在时隙开始时刚好新鲜, 省掉最多一个采样周期的等待
+ * - ODR 与 200Hz 帧同频同相, 不再产生拍频/混叠
+ *
+ * 前馈: rf_timing_opt 估计的本地时钟相对接收器的漂移
+ * 反馈: 样本时间戳相对目标相位的误差 (按采样周期取模)
+ */
+
+#ifndef __IMU_CLOCK_SYNC_H__
+#define __IMU_CLOCK_SYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 样本相对时隙开始的提前量 (突发读取 + 融合 + 打包)
+#ifndef IMU_CLKSYNC_LEAD_US
+#define IMU_CLKSYNC_LEAD_US     600
+#endif
+
+// 频率调整范围 (ICM-42688/45686 CLKIN 允许 31-50kHz, 这里远小于此)
+#define IMU_CLKSYNC_MAX_PPB     2000000     // ±2000 ppm
+
+/**
+ * @brief 启动时钟输出并把 IMU 切换到 CLKIN
+ * @return 0 成功, 负值: IMU 不支持 CLKIN (已恢复内部时钟)
+ */
+int imu_clock_sync_init(void);
+
+/**
+ * @brief 停止相位锁定, IMU 回到内部振荡器
+ */
+void imu_clock_sync_stop(void);
+
+/**
+ * @brief 闭环更新 (每批样本处理后调用一次)
+ * @param sample_ts_us 最新样本时间戳 (MCU 时钟)
+ * @param sync_time_us 当前超帧同步信标时刻 (MCU 时钟)
+ * @param slot_offset_us 本 tracker 主时隙相对信标的偏移
+ */
+void imu_clock_sync_update(uint32_t sample_ts_us, uint32_t sync_time_us,
+                           uint32_t slot_offset_us);
+
+/**
+ * @brief 失步时调用: 保持当前频率 (前馈 + 积分), 清除锁定状态
+ */
+void imu_clock_sync_hold(void);
+
+/**
+ * @brief 是否已锁定 (相位误差连续处于窗口内)
+ */
+bool imu_clock_sync_locked(void);
+
+/**
+ * @brief 获取状态
+ * @param phase_err_us 最近一次相位误差 [us] (可为 NULL)
+ * @param trim_ppb 当前频率调整量 [ppb] (可为 NULL)
+ */
+void imu_clock_sync_get_state(int32_t *phase_err_us, int32_t *trim_ppb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_CLOCK_SYNC_H__ */
@@ -0,0 +1,41 @@
+/**
+ * @file imu_fifo.h
+ * @brief v0.6.3 IMU 驱动统一 FIFO 批量读取接口 / Common driver FIFO batch API
+ *
+ * src/sensor/imu/ 下每个驱动提供同一组入口 (按芯片前缀命名, 无函数表):
+ * - int <drv>_fifo_enable(uint8_t watermark)
+ *   陀螺+加速度写入硬件 FIFO, 水位 (帧数, 1..IMU_FIFO_MAX_BATCH) 中断路由到 INT1;
+ *   两路按各自当前 ODR 批量, 帧以陀螺样本计
+ * - int <drv>_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+ *   按芯片原生 FIFO 包格式突发读取最多 n 帧 (最旧在前), 解码为原始计数
+ *   (芯片坐标系, 未换轴/缩放); 返回帧数, -1 未初始化或 FIFO 未使能, 其他负值为总线错误
+ * - 加速度计 ODR 低于陀螺时 (ICM/IIM、LSM6DSV/DSO/DSR、BMI270/323 支持), 只含陀螺的帧
+ *   accel_valid = 0, accel 内容无意义; SC7I22 两路同 ODR, 恒为 1
+ * - ts 可为 NULL; 原生包带传感器时间的驱动 (ICM/IIM TMST, LSM 时间戳标签, BMI323 sensortime)
+ *   按帧写入扩展为 32 位的芯片计数, 不带时间的驱动 (BMI270 无帧头, SC7I22) 不写
+ * 运行时路径 (imu_interface 的 imu_fifo_read_raw) 按 IMU 类型切换, 与此处包格式一致
+ */
+
+#ifndef __IMU_FIFO_H__
+#define __IMU_FIFO_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单次突发读取的最大帧数 (受各驱动 8 位读取长度限制)
+#define IMU_FIFO_MAX_BATCH  8
+
+typedef struct {
+    int16_t gyro[3];
+    int16_t accel[3];
+    uint8_t accel_valid;    // 0 = 本帧不带新加速度样本
+} imu_raw_sample_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_FIFO_H__ */
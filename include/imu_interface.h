@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +34,11 @@ extern "C" {
  * 这里不再定义宏，以避免与.c文件中的枚举冲突
  *============================================================================*/
 
+// v0.6.3: 编译期固定总线 (make IMU=<型号> IMU_BUS=SPI|I2C → -DIMU_FIXED_BUS=...)
+// 取值与 imu_get_interface() 的返回值一致
+#define IMU_BUS_SPI         1
+#define IMU_BUS_I2C         2
+
 /*============================================================================
  * API 函数
  *============================================================================*/
@@ -40,9 +46,19 @@ extern "C" {
 /**
  * @brief 初始化 IMU (自动检测 SPI/I2C)
  * @return 0 成功, -1 未检测到 IMU
+ * @note 定义 IMU_FIXED_BUS 时只初始化编译期指定的总线和型号, 并校验 WHO_AM_I
  */
 int imu_init(void);
 
+/**
+ * @brief v0.6.3: 分两步初始化, 中间可做其他初始化 (imu_init = start + finish)
+ * @note start 检测 IMU 并开始加载配置 (BMI270 + SPI 时经 DMA 在后台上传配置文件),
+ *       finish 等待加载完成后配置 ODR/量程; 两者之间不得访问 IMU 总线
+ * @return 0 成功, -1 未检测到 IMU, -2 配置加载失败 (finish)
+ */
+int imu_init_start(void);
+int imu_init_finish(void);
+
 /**
  * @brief 读取陀螺仪和加速度计数据
  * @param gyro 输出陀螺仪 [rad/s]
@@ -55,6 +71,41 @@ int imu_read_all(float gyro[3], float accel[3]);
  */
 int imu_read_raw(int16_t gyro[3], int16_t accel[3]);
 
+/**
+ * @brief v0.6.3: 当前型号的 SPI 突发读取描述 (与 imu_read_all 相同的寄存器)
+ *
+ * sensor_dma / sensor_optimized 据此配置 hal_dma 乒乓环, 并在 DMA 缓冲区上原地解码
+ */
+typedef struct {
+    uint8_t cmd;            // 命令字节 (起始寄存器 | 0x80)
+    uint8_t len;            // 突发长度 [字节]
+    int (*decode)(const uint8_t *data, uint16_t len, float gyro[3], float accel[3]);
+} imu_dma_burst_t;
+
+/**
+ * @brief v0.6.3: 取当前型号的突发读取描述
+ * @return 0 成功, -1 I2C 总线/未初始化/型号不支持, 调用方改用 imu_read_all
+ */
+int imu_dma_burst_get(imu_dma_burst_t *burst);
+
+/**
+ * @brief v0.6.3: 解码一帧突发读取数据, 即 imu_dma_burst_t.decode (可在中断中调用)
+ * @param gyro 输出陀螺仪 [rad/s]
+ * @param accel 输出加速度计 [g]
+ * @return 0 成功, -1 长度与当前型号不符
+ * @note ICM/LSM 顺带更新芯片温度; BMI270 的温度寄存器不在突发内, 异步路径不更新
+ */
+int imu_decode_dma(const uint8_t *data, uint16_t len, float gyro[3], float accel[3]);
+
+/**
+ * @brief v0.6.3: 最近一次读到的 IMU 芯片温度
+ * @param temp_c 输出温度 [°C]
+ * @return false 尚未读到温度
+ * @note 由 imu_read_all/imu_read_raw/imu_fifo_read 顺带更新: ICM/LSM 与数据同一次突发
+ *       (FIFO 模式取包格式3 温度字节/温度标签字), BMI270 按约 1/24 的频率单独读取
+ */
+bool imu_get_temperature(float *temp_c);
+
 /**
  * @brief 检查数据是否就绪
  */
@@ -80,6 +131,23 @@ uint8_t imu_get_interface(void);
  */
 void imu_set_gyro_bias(const float bias[3]);
 
+/**
+ * @brief v0.6.3: 融合预处理配置 (输出坐标系)
+ */
+typedef struct {
+    float gyro_offset[3];   // rad/s, 上层偏置 + 温度补偿
+    float accel_offset[3];  // g
+} imu_preproc_t;
+
+/**
+ * @brief v0.6.3: 设置融合预处理 (校准或温度补偿变化时调用, 不在每样本路径上)
+ * @note 量程、偏置和温度补偿合并为每轴一个增益和偏移, imu_read_all/imu_fifo_read
+ *       每样本一次乘减完成换算; imu_init 后偏移为 0
+ * @note 安装方向 (板级 IMU_AXIS_X/Y/Z) 在原始数据解码时按编译期常量换轴,
+ *       imu_read_raw 和本接口的偏移都已是输出坐标系
+ */
+void imu_set_preproc(const imu_preproc_t *cfg);
+
 /**
  * @brief 进入低功耗模式
  */
@@ -97,12 +165,194 @@ void imu_resume(void);
  */
 int imu_enable_wom(uint16_t threshold_mg);
 
+/*
+ * v0.6.3: 片上运动事件 (ICM-42688/45686 SMD/APEX 倾斜/WOM 状态)
+ * 睡眠时只在显著运动或倾斜时拉高 INT1 唤醒 MCU; 运行时可只读状态, 复核 MCU 的静止判断
+ */
+#define IMU_MOTION_WOM      0x01    // 任一轴超过阈值
+#define IMU_MOTION_SMD      0x02    // 显著运动 (~1s 内持续 WOM, 过滤单次磕碰)
+#define IMU_MOTION_TILT     0x04    // 倾斜 (APEX)
+
+/**
+ * @brief v0.6.3: 使能片上运动检测
+ * @param events IMU_MOTION_* 组合, WOM 总是使能 (SMD 的输入)
+ * @param threshold_mg WOM 阈值
+ * @param wake true = 睡眠唤醒: 加速度计低功耗 50Hz、陀螺关闭、事件路由到 INT1 (取代 FIFO 水位);
+ *             false = 保持当前工作模式, 只置状态位, WOM 与使能时的姿态比较 (静止复核)
+ * @return 实际使能的事件位 (其它 IMU 唤醒时退回 imu_enable_wom, 返回 IMU_MOTION_WOM;
+ *         只读状态不支持时返回 0), -1 未初始化
+ */
+int imu_motion_arm(uint8_t events, uint16_t threshold_mg, bool wake);
+
+/**
+ * @brief v0.6.3: 读取并清除已触发的运动事件
+ * @return IMU_MOTION_* 组合, 未使能时为 0
+ */
+uint8_t imu_motion_get_events(void);
+
+/*
+ * v0.6.3: 功耗档 - 每降一档 ODR 减半; LOW 另把加速度计切到低功耗/片内平均 (ICM, BMI270)
+ * imu_resume/imu_disable_wom 重新初始化后回到 IMU_PROFILE_HIGH
+ */
+typedef enum {
+    IMU_PROFILE_HIGH = 0,       // SENSOR_ODR_HZ, 低噪声
+    IMU_PROFILE_NORMAL,         // SENSOR_ODR_HZ / 2
+    IMU_PROFILE_LOW             // SENSOR_ODR_HZ / 4, 加速度计低功耗
+} imu_power_profile_t;
+
+/**
+ * @brief v0.6.3: 切换功耗档
+ * @return 0 成功, -1 未初始化, -2 当前 IMU/模式不支持 (如 SFLP 运行中), -3 参数错误
+ */
+int imu_set_power_profile(imu_power_profile_t profile);
+
+imu_power_profile_t imu_get_power_profile(void);
+
+/**
+ * @brief v0.6.3: 当前样本间隔相对 SENSOR_ODR_HZ 的倍数 (1/2/4)
+ */
+uint8_t imu_get_rate_div(void);
+
+/**
+ * @brief v0.6.3: 当前 ODR (Hz), SENSOR_ODR_HZ / imu_get_rate_div()
+ */
+uint16_t imu_get_odr_hz(void);
+
+/**
+ * @brief v0.6.3: 陀螺量程自动切换 (USE_GYRO_AUTO_RANGE, 主循环, 两次读取之间调用)
+ * @note 解码路径统计饱和/峰值; 饱和时放宽一档, 持续低于下一档满量程的
+ *       GYRO_RANGE_NARROW_PCT% 达 GYRO_RANGE_HOLD_MS 时收窄一档. 切换前已产生的样本
+ *       由驱动换到新量程计数, 调用方不必关心切换点; 但调用时不应持有未换算的原始样本
+ * @return 1 已切换, 0 未切换, -1 未初始化, -2 未启用/型号不支持
+ */
+int imu_gyro_range_update(void);
+
+/**
+ * @brief v0.6.3: 当前陀螺满量程 (dps)
+ */
+uint16_t imu_get_gyro_range_dps(void);
+
 /**
  * @brief v0.4.24: 禁用WOM中断，恢复正常模式
  * @return 0 成功, 负值失败
  */
 int imu_disable_wom(void);
 
+/*============================================================================
+ * v0.6.3: FIFO 批量读取 / FIFO Batch Read
+ *============================================================================*/
+
+// 单次突发读取的最大帧数 IMU_FIFO_MAX_BATCH 见 imu_fifo.h
+
+/**
+ * @brief v0.6.3: 使能 IMU 硬件 FIFO 并把水位中断路由到 INT1
+ * @param watermark 水位 (帧数, 1..IMU_FIFO_MAX_BATCH)
+ * @return 0 成功, -1 未初始化, -2 不支持的IMU类型
+ * @note 使能后 INT1 由数据就绪改为 FIFO 水位触发
+ */
+int imu_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: 一次突发读取 FIFO 中已有的帧 (最旧在前)
+ * @param gyro 输出陀螺仪 [rad/s], 每帧一行
+ * @param accel 输出加速度计 [g], 每帧一行
+ * @param ts 输出每帧 IMU 时间戳 [imu_fifo_ts_tick_ns() 计数], 可为 NULL;
+ *           USE_IMU_FIFO_TIMESTAMP 且 IMU 支持时才写入
+ * @param max_frames 输出缓冲区容量 (帧)
+ * @return 读取的帧数, 负值失败
+ */
+int imu_fifo_read(float gyro[][3], float accel[][3], uint32_t ts[], uint8_t max_frames);
+
+/**
+ * @brief v0.6.3: 同 imu_fifo_read, 但输出原始计数 (已换到输出坐标系, 未做增益/偏移)
+ * @note 需要物理单位时逐样本调用 imu_raw_to_si; 只存不用的样本省去换算
+ */
+int imu_fifo_read_raw(int16_t gyro[][3], int16_t accel[][3], uint32_t ts[], uint8_t max_frames);
+
+/**
+ * @brief v0.6.3: 原始计数 → 陀螺 [rad/s] / 加速度 [g] (imu_set_preproc 的增益与偏移)
+ */
+void imu_raw_to_si(const int16_t g[3], const int16_t a[3], float gyro[3], float accel[3]);
+
+/**
+ * @brief v0.6.3: 获取当前 FIFO 水位 (0 表示未使能)
+ */
+uint8_t imu_fifo_get_watermark(void);
+
+/**
+ * @brief v0.6.3: 最近一次 imu_fifo_read/imu_fifo_read_raw 各帧是否带新加速度 (bit i = 第 i 帧)
+ * @note USE_IMU_MIXED_ODR 时加速度计 ODR 低于陀螺, 不带新加速度的帧输出的是上一次的加速度;
+ *       关闭时恒为 0xFF
+ */
+uint8_t imu_fifo_accel_mask(void);
+
+/**
+ * @brief v0.6.3: LSM6DSV 片上融合 (SFLP 游戏旋转向量) 是否随 FIFO 输出
+ * @note USE_IMU_SFLP 且检测到 LSM6DSV 时由 imu_fifo_enable 打开; IMU 复位后恢复为 false
+ */
+bool imu_sflp_active(void);
+
+/**
+ * @brief v0.6.3: 读取 imu_fifo_read 解出的最新 SFLP 姿态 [w, x, y, z]
+ * @return true 自上次读取后有新值 (已换到板级安装方向, 航向为任意起点、无磁力计校正)
+ */
+bool imu_sflp_get_quat(float q[4]);
+
+/*
+ * v0.6.3: 睡眠 FIFO (USE_WAKE_FIFO_CATCHUP) - 轻度睡眠期间陀螺 + 加速度计以 IMU_SLEEP_FIFO_HZ
+ * 写入 FIFO (满后覆盖最旧帧, 不产生水位中断), 唤醒后在 imu_resume 之前用 imu_fifo_read 取出
+ */
+#define IMU_SLEEP_FIFO_HZ       50      // 与运动引擎唤醒时的加速度计 ODR 相同
+#define IMU_SLEEP_FIFO_FRAMES   128     // 2KB FIFO / 16 字节包
+
+/**
+ * @brief v0.6.3: 开始睡眠 FIFO, 在 imu_motion_arm(..., true) 之后调用 (保留其 INT1 路由)
+ * @return 0 成功, -1 未初始化, -2 当前 IMU 不支持 (只有 ICM-42688/45686)
+ */
+int imu_sleep_fifo_start(void);
+
+/**
+ * @brief v0.6.3: 结束睡眠 FIFO, 恢复开始前的 FIFO 水位记录 (寄存器由随后的 imu_resume 重新配置)
+ */
+void imu_sleep_fifo_stop(void);
+
+/**
+ * @brief v0.6.3: FIFO 时间戳的标称分辨率
+ * @return 每计数的纳秒数 (IMU 内部时钟, 有 ±2-5% 误差); 0 表示不提供时间戳
+ * @note ICM-42688/45686 为 1us (16 位回绕, 驱动展开为 32 位), LSM6DSV/DSR 为 32 位计数
+ */
+uint32_t imu_fifo_ts_tick_ns(void);
+
+/**
+ * @brief v0.6.3: 切换 IMU 到外部参考时钟 (CLKIN 引脚, RTC 模式)
+ * @param enable true = ODR 由 CLKIN 分频, false = 内部振荡器
+ * @return 0 成功, -1 未初始化, -2 当前 IMU 不支持 CLKIN
+ * @note 需先由 hal_clkout_init() 输出时钟
+ */
+int imu_set_external_clock(bool enable);
+
+/*============================================================================
+ * v0.6.3: 辅助 IMU / Auxiliary IMU (USE_AUX_IMU)
+ *============================================================================*/
+
+#define IMU_SENSOR_PRIMARY  0
+#define IMU_SENSOR_AUX      1
+
+/**
+ * @brief v0.6.3: 在主 IMU 的总线上检测并初始化辅助 IMU (SPI 用 IMU_AUX_SPI_CS_PIN,
+ *        I2C 用主 IMU 未占用的地址), 成功后同样使能 FIFO
+ * @return 0 成功, -1 主 IMU 未初始化或未检测到, -2 配置失败
+ * @note 返回时已重新选中主 IMU
+ */
+int imu_aux_init(void);
+
+/**
+ * @brief v0.6.3: 选择后续 imu_* 调用作用的 IMU (IMU_SENSOR_PRIMARY / IMU_SENSOR_AUX)
+ * @return 0 成功, -1 未启用 USE_AUX_IMU 或该 IMU 未初始化
+ * @note 主 IMU 的运动引擎、SFLP 和时钟同步不随之切换; 用完后须切回主 IMU
+ */
+int imu_select(uint8_t sensor);
+
 #ifdef __cplusplus
 }
 #endif
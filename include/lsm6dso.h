@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 // WHO_AM_I 值
 #define LSM6DSO_DEVICE_ID       0x6C
@@ -104,4 +105,17 @@ void lsm6dso_power_down(void);
  */
 void lsm6dso_power_up(void);
 
+/**
+ * @brief v0.6.3: 使能 FIFO (陀螺+加速度+时间戳, 批量速率跟随 ODR), 水位中断到 INT1
+ * @param watermark 水位 (帧数, 1..IMU_FIFO_MAX_BATCH)
+ */
+int lsm6dso_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: 一次突发读取最多 n 帧, 见 imu_fifo.h
+ * @param ts 每帧时间戳 (25us/计数), 可为 NULL
+ * @return 帧数, 负值失败
+ */
+int lsm6dso_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #endif /* __LSM6DSO_H__ */
@@ -8,6 +8,7 @@
 
 #include "optimize.h"
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -64,6 +65,19 @@ void lsm6dsv_suspend(void);
  */
 void lsm6dsv_resume(void);
 
+/**
+ * @brief v0.6.3: 使能 FIFO (陀螺+加速度+时间戳, 批量速率跟随 ODR), 水位中断到 INT1
+ * @param watermark 水位 (帧数, 1..IMU_FIFO_MAX_BATCH)
+ */
+int lsm6dsv_fifo_enable(uint8_t watermark);
+
+/**
+ * @brief v0.6.3: 一次突发读取最多 n 帧, 见 imu_fifo.h
+ * @param ts 每帧时间戳 (21.75us/计数), 可为 NULL
+ * @return 帧数, 负值失败
+ */
+int lsm6dsv_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,12 +46,17 @@ bool mag_is_enabled(void);
 mag_state_t mag_get_state(void);
 
 // 数据
-int mag_read(mag_data_t *data);
+int mag_read(mag_data_t *data);     // 0=新数据, 1=暂无新数据 (未到输出周期/异步读取未完成), <0=错误
 float mag_get_heading(void);
 
 // 校准
+// v0.6.3: USE_MAG_ELLIPSOID 时 start 清空椭球统计量, stop 优先使用椭球解 (失败时退回 min/max)
 int mag_calibrate_start(void);
 int mag_calibrate_stop(void);
 bool mag_is_calibrated(void);
 
+// v0.6.3: 椭球拟合分步求解, 主循环空闲时调用 (每次一列分解); 统计量在 mag_read 中累加,
+// 解被接受后立即生效并后台保存. 未启用 USE_MAG_ELLIPSOID 时为空操作
+void mag_calib_process(void);
+
 #endif
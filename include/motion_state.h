@@ -0,0 +1,75 @@
+/**
+ * @file motion_state.h
+ * @brief 共享运动状态估计 / Shared motion-state estimator
+ *
+ * v0.6.3: 每样本一次增量更新 (每轴指数加权均值/方差 + 加速度幅值), 发布
+ * 运动/微静/静止三级状态, 融合、自动校准、功耗和 RF 发送分频共用同一结果,
+ * 不再各自计算一遍幅值和计时
+ *
+ * - STILL: 当前样本安静 (均值、方差、加速度都在阈值内, 离开时阈值放宽 1.5 倍)
+ * - REST:  安静累计 MOTION_REST_MS; 不安静时计时以 2 倍速度回退, 回退到 0 才离开,
+ *          呼吸等微动不会频繁切换 (与原 VQF 静止检测一致)
+ */
+
+#ifndef __MOTION_STATE_H__
+#define __MOTION_STATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTION_GYRO_TH          0.026f  // rad/s (1.5 dps), 均值幅值
+#define MOTION_GYRO_VAR_TH      (MOTION_GYRO_TH * MOTION_GYRO_TH)   // 三轴方差和
+#define MOTION_ACCEL_TH         0.03f   // g, 幅值偏离 1g
+#define MOTION_EWMA_ALPHA       0.125f  // 均值/方差更新率 (约 8 样本)
+#define MOTION_REST_MS          500     // 进入 REST 需要的安静时间
+
+typedef enum {
+    MOTION_LEVEL_MOTION = 0,
+    MOTION_LEVEL_STILL,
+    MOTION_LEVEL_REST
+} motion_level_t;
+
+void motion_state_init(void);
+
+/**
+ * @brief 设置样本间隔 (SENSOR_ODR_HZ 的分频, IMU 降 ODR 时由功耗策略设置)
+ *
+ * 计时仍以 SENSOR_ODR_HZ 周期为单位, still_ms 和 REST 判定时间不随 ODR 变化
+ */
+void motion_state_set_rate_div(uint8_t div);
+
+/**
+ * @brief 每个 IMU 样本调用一次 (偏置校正后)
+ * @param gyro rad/s
+ * @param accel g
+ */
+void motion_state_update(const float gyro[3], const float accel[3]);
+
+motion_level_t motion_state_level(void);
+
+/**
+ * @brief 当前样本安静 (STILL 或 REST)
+ */
+bool motion_state_is_still(void);
+
+bool motion_state_is_rest(void);
+
+/**
+ * @brief 连续安静时长 (ms, 按样本数和 SENSOR_ODR_HZ 换算)
+ */
+uint32_t motion_state_still_ms(void);
+
+/**
+ * @brief 陀螺仪指数加权均值 (rad/s), 静止时即残余偏置估计
+ */
+void motion_state_get_gyro_mean(float mean[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MOTION_STATE_H__ */
@@ -17,6 +17,7 @@
 #define __OPTIMIZE_H__
 
 #include <stdint.h>
+#include "config.h"
 
 /*============================================================================
  * Compiler Attributes
@@ -58,6 +59,40 @@
 // Const function (only depends on arguments)
 #define CONST_FUNC          __attribute__((const))
 
+/*============================================================================
+ * v0.6.3: RAM Hot Code Tiers (USE_RAM_HOTCODE)
+ * 放入 .highcode.<tier>, 启动时从 Flash 拷入 RAM; Link.ld 按层放置并检查预算.
+ * noinline: 被内联进 Flash 中的调用者就失去意义
+ *============================================================================*/
+
+#if defined(USE_RAM_HOTCODE) && USE_RAM_HOTCODE && !defined(BUILD_HOST)
+#define RAM_CODE_ISR        __attribute__((section(".highcode.isr"), noinline))
+#if defined(RAM_HOTCODE_FUSION) && RAM_HOTCODE_FUSION
+#define RAM_CODE_FUSION     __attribute__((section(".highcode.fusion"), noinline))
+#endif
+#endif
+
+#ifndef RAM_CODE_ISR
+#define RAM_CODE_ISR
+#endif
+#ifndef RAM_CODE_FUSION
+#define RAM_CODE_FUSION
+#endif
+
+/*============================================================================
+ * v0.6.3: RAM Arena (USE_RAM_ARENA)
+ * 环形缓冲区和每 tracker 表放入 .bss.arena.<module>, Link.ld 集中成一块连续区域
+ * (_arena_start/_arena_end) 并检查 RAM_ARENA_BUDGET. 大小仍由 config.h 的
+ * MAX_TRACKERS / 各深度参数决定; 未启用的功能不定义缓冲区, 不占空间.
+ * 只用于零初始化的变量 (区域在 .bss 内, 启动时清零)
+ *============================================================================*/
+
+#if defined(USE_RAM_ARENA) && USE_RAM_ARENA && !defined(BUILD_HOST)
+#define RAM_ARENA(module)   __attribute__((section(".bss.arena." #module)))
+#else
+#define RAM_ARENA(module)
+#endif
+
 /*============================================================================
  * Size-Optimized Types
  *============================================================================*/
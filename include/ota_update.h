@@ -0,0 +1,122 @@
+/**
+ * @file ota_update.h
+ * @brief OTA 分区固件更新 (可选功能)
+ *
+ * 编译开关: OTA_ENABLED (make OTA=1), 未启用时为空实现
+ *
+ * 镜像先写入 OTA 分区, CRC32 校验通过后由 ota_apply() 复制到应用分区.
+ * v0.6.3: 接收器用 OTA 分区暂存 RF 广播的 tracker 固件 (USE_RF_OTA)
+ * v0.6.3: 压缩 / 增量镜像 (USE_OTA_PACK, tools/ota_pack.py 生成), 格式见下
+ */
+
+#ifndef __OTA_UPDATE_H__
+#define __OTA_UPDATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_BLOCK_SIZE      256
+#define OTA_MAX_SIZE        0x38000     // 224KB
+#define OTA_PARTITION_ADDR  0x38000     // OTA 分区
+#define APP_PARTITION_ADDR  0x1000      // 应用分区
+
+/*============================================================================
+ * v0.6.3: 打包镜像 (USE_OTA_PACK)
+ *
+ * 传输和 ota_verify 的 CRC32 针对打包后的字节流, 接收器原样转发不解码.
+ * ota_apply 把它解码到 OTA 分区中其后的空闲区域, 校验 out_crc 后再写入应用区.
+ *
+ * 头部之后为操作序列, 操作字节 = 类型 (高 2 位) | 长度 L (低 6 位),
+ * L = 63 时后跟 varint (LEB128) 累加到长度上:
+ *   LITERAL  长度 L+1,  后跟原始字节
+ *   MATCH    长度 L+3,  后跟 varint 距离-1, 复制已输出的数据
+ *   BASE     长度 L+1,  后跟 varint 偏移, 复制当前应用区 (增量补丁)
+ *   FILL     长度 L+3,  后跟 1 字节填充值
+ *============================================================================*/
+
+#define OTA_PACK_MAGIC      0x5A41544F  // "OTAZ"
+
+#define OTA_PACK_LITERAL    0
+#define OTA_PACK_MATCH      1
+#define OTA_PACK_BASE       2
+#define OTA_PACK_FILL       3
+
+typedef struct {
+    uint32_t magic;             // OTA_PACK_MAGIC
+    uint32_t out_size;          // 解码后镜像大小
+    uint32_t out_crc;           // 解码后镜像 CRC32
+    uint32_t base_size;         // 增量补丁的基准固件大小, 0 = 只压缩
+    uint32_t base_crc;          // 基准固件 CRC32 (与当前应用区比对)
+} ota_pack_header_t;
+
+typedef enum {
+    OTA_IDLE = 0,
+    OTA_RECEIVING,
+    OTA_VERIFYING,
+    OTA_COMPLETE,
+    OTA_ERROR
+} ota_state_t;
+
+void ota_init(void);
+
+/**
+ * @brief 开始接收镜像 (v0.6.3: 不擦除, 分区在写入时按扇区延迟擦除)
+ * @return 0 成功, -1 镜像过大, -2 正在接收
+ */
+int ota_start(uint32_t size, uint32_t crc);
+
+/**
+ * @brief 写入第 block_num 个 OTA_BLOCK_SIZE 块
+ */
+int ota_write_block(uint16_t block_num, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief v0.6.3: 写入任意偏移的数据 (每个字节只能写一次, 调用方保证不重叠)
+ * @return 0 成功, -1 未在接收, -2 越界, -3 写入失败
+ */
+int ota_write_chunk(uint32_t offset, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief v0.6.3: 读取 OTA 分区 (CodeFlash 直接映射, 可在中断中调用)
+ * @return 0 成功, -1 越界
+ */
+int ota_read(uint32_t offset, uint8_t *out, uint16_t len);
+
+/**
+ * @brief 全部数据写入后校验 CRC32
+ * @return 0 通过 (状态变为 OTA_COMPLETE)
+ */
+int ota_verify(void);
+
+/**
+ * @brief 把已校验的镜像复制到应用分区 (打包镜像先解码)
+ * @return 0 成功, -1 未校验, -2 解码失败或输出 CRC 不符, -3 基准固件不符
+ */
+int ota_apply(void);
+
+void ota_abort(void);
+
+/**
+ * @brief 接收超时检查 (主循环调用)
+ */
+void ota_process(void);
+
+ota_state_t ota_get_state(void);
+uint8_t ota_get_progress(void);
+uint8_t ota_get_error(void);
+
+/**
+ * @brief v0.6.3: 当前镜像大小和 CRC32 (ota_start 参数)
+ */
+uint32_t ota_get_size(void);
+uint32_t ota_get_crc(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OTA_UPDATE_H__ */
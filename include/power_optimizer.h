@@ -95,10 +95,21 @@ void power_set_rf_profile(uint8_t profile);
 
 /**
  * @brief 更新功耗估算 (主循环中调用)
- * @param gyro_mag 陀螺仪幅度 (用于运动检测)
- * @param accel_mag 加速度计幅度
+ * @param moving 运动状态 (v0.6.3: 来自 motion_state, 非 MOTION_LEVEL_MOTION 即空闲)
  */
-void power_update(float gyro_mag, float accel_mag);
+void power_update(bool moving);
+
+/**
+ * @brief v0.6.3: 按每超帧实测忙周期选择时钟 (USE_CLOCK_GOVERNOR, 主循环每次迭代末尾调用)
+ * @note 启用时 power_update 不再按运动状态/电量切换时钟
+ */
+void power_governor_update(void);
+
+/**
+ * @brief v0.6.3: IMU 片上运动事件 (imu_motion_get_events) 视同运动, 重新开始空闲计时
+ * @param events IMU_MOTION_* 组合, 0 忽略
+ */
+void power_motion_event(uint8_t events);
 
 /**
  * @brief 进入空闲模式 (快速唤醒)
@@ -140,6 +151,11 @@ void power_disable_led(void);
  */
 uint8_t power_optimizer_get_duty_cycle(void);
 
+/**
+ * @brief 当前估计功耗 (mA, 按时钟档和已开启的外设累加)
+ */
+float power_optimizer_get_current(void);
+
 #ifdef __cplusplus
 }
 #endif
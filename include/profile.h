@@ -0,0 +1,123 @@
+/**
+ * @file profile.h
+ * @brief 周期计数探针 / Cycle-counter profiling probes
+ *
+ * v0.6.3: 读 RISC-V mcycle (低 32 位, 60MHz 下 71s 回绕, 单次区间远小于此),
+ * 每个探针记录次数 / 最小 / 最大 / 累计周期数, 固定表, 无动态分配
+ * - USE_PROFILE=0 时所有宏展开为空, 不占代码和 RAM
+ * - PROF_SCOPE: 到作用域结束 (含提前 return/continue) 自动记录, 用于中断入口
+ * - PROF_BEGIN/PROF_END: 同一作用域内的区间, 未执行到 END 时不记录
+ * - 每个探针只应在一个上下文 (某个中断或主循环) 中记录;
+ *   主循环探针包含期间被抢占的中断时间
+ * - 结果经 usb_debug 0x16 命令读出 (tools/profile_dump.py)
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdint.h>
+#include "config.h"
+#include "optimize.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PROF_MAIN_LOOP = 0,     // 主循环一次迭代 (不含末尾 WFI/延时)
+    PROF_SENSOR_SAMPLE,     // Tracker: 单样本校准 + 融合 (sensor_process_sample)
+    PROF_FUSION,            // Tracker: 融合引擎更新
+    PROF_RF_TASK,           // rf_transmitter_process / rf_receiver_process
+    PROF_USB_TASK,          // usb_hid_task / usb_debug_process
+    PROF_RF_ISR,            // RF_IRQHandler
+    PROF_RF_TIMER_ISR,      // TMR2_IRQHandler (RF 帧定时)
+    PROF_USB_ISR,           // USB_IRQHandler
+    PROF_SPI_DMA_ISR,       // SPI0_IRQHandler (IMU DMA)
+    PROF_I2C_ISR,           // I2C_IRQHandler (磁力计异步读取)
+    PROF_GPIO_ISR,          // GPIOA/GPIOB_IRQHandler (IMU 数据就绪/按键)
+    PROF_COUNT
+} prof_id_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t win_max;       // v0.6.3: 上次 prof_take_window_max 之后的最大值 (soak_stats 窗口)
+} prof_stat_t;
+
+#if defined(USE_PROFILE) && USE_PROFILE
+
+extern prof_stat_t prof_table[PROF_COUNT];
+
+static FORCE_INLINE uint32_t prof_cycles(void)
+{
+#ifdef CH59X
+    uint32_t c;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(c));
+    return c;
+#else
+    return 0;
+#endif
+}
+
+static FORCE_INLINE void prof_record(uint8_t id, uint32_t cycles)
+{
+    prof_stat_t *p = &prof_table[id];
+
+    p->count++;
+    p->total += cycles;
+    if (cycles < p->min || p->count == 1) p->min = cycles;
+    if (cycles > p->max) p->max = cycles;
+    if (cycles > p->win_max) p->win_max = cycles;
+}
+
+typedef struct {
+    uint8_t id;
+    uint32_t t0;
+} prof_scope_t;
+
+static FORCE_INLINE void prof_scope_end(prof_scope_t *s)
+{
+    prof_record(s->id, prof_cycles() - s->t0);
+}
+
+#define PROF_SCOPE(id) \
+    prof_scope_t prof_scope_ __attribute__((cleanup(prof_scope_end))) = { (id), prof_cycles() }
+#define PROF_BEGIN(id)  uint32_t prof_t0_##id = prof_cycles()
+#define PROF_END(id)    prof_record((id), prof_cycles() - prof_t0_##id)
+
+#else
+
+#define PROF_SCOPE(id)  do { } while (0)
+#define PROF_BEGIN(id)  do { } while (0)
+#define PROF_END(id)    do { } while (0)
+
+#endif /* USE_PROFILE */
+
+/**
+ * @brief 探针名称 (越界返回 NULL)
+ */
+const char *prof_name(uint8_t id);
+
+/**
+ * @brief 读取一个探针的快照 (关中断拷贝, 与中断内记录互斥)
+ * @return 0=成功, -1=越界或未启用
+ */
+int prof_get(uint8_t id, prof_stat_t *out);
+
+/**
+ * @brief 清零全部探针
+ */
+void prof_reset(void);
+
+/**
+ * @brief v0.6.3: 读取并清零一个探针的窗口最大值 (关中断, 越界或未启用返回 0)
+ */
+uint32_t prof_take_window_max(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILE_H__ */
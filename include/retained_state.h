@@ -6,11 +6,15 @@
  * 
  * 保存内容:
  * - Gyro bias (零偏)
- * - 融合器状态 (VQF internal state)
+ * - 融合器状态 (v0.6.3: fusion_checkpoint_t, 与引擎结构体布局无关)
  * - 校准参数
  * - 最后已知姿态
+ * - v0.6.3: RF 链路快照 (帧号/跳频种子/漂移/RTC 时间戳), 唤醒后快速重连
  * 
  * 存储位置: Flash或SRAM (根据配置)
+ * v0.6.3: SRAM 后端 - 状态放在 Shutdown 保持的 RAM2K 区 (.retained), magic/CRC 校验;
+ *         睡眠/唤醒不写 Flash, 只在低电量 (保持电压可能跌落) 时 retained_commit 落盘,
+ *         RAM 内容无效 (上电复位) 时回退读取 Flash
  */
 
 #ifndef RETAINED_STATE_H
@@ -18,6 +22,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "rf_protocol.h"
+#include "fusion_checkpoint.h"
 
 /*============================================================================
  * 配置
@@ -25,7 +31,19 @@
 
 // 存储位置选择
 #define RETAINED_USE_FLASH      1   // 使用Flash存储 (掉电保持)
-#define RETAINED_USE_SRAM       0   // 使用SRAM存储 (更快但掉电丢失)
+#define RETAINED_USE_SRAM       1   // v0.6.3: 保持 RAM 为主, Flash 只作掉电备份
+
+#if RETAINED_USE_SRAM
+#ifndef RB_PWR_RAM2K
+#define RB_PWR_RAM2K            0x01    // CH59x_pwr.h: Shutdown 保持 2KB RAM
+#endif
+#define RETAINED_SHUTDOWN_RM    RB_PWR_RAM2K    // LowPower_Shutdown 参数
+#else
+#define RETAINED_SHUTDOWN_RM    0
+#endif
+
+// 电量低于此值时进入 Shutdown 前把保持 RAM 写入 Flash
+#define RETAINED_COMMIT_BATT_PCT    10
 
 // 存储偏移地址 (Flash模式)
 #define RETAINED_FLASH_OFFSET   0x0400  // 在hal_storage中的偏移
@@ -52,10 +70,11 @@ typedef struct {
     // Gyro偏置
     float gyro_bias[3];
     
-    // 融合器状态 (VQF核心状态)
-    float quat[4];              // 最后已知姿态
-    float gyro_bias_est[3];     // 融合器估计的偏置
-    float accel_ref[3];         // 加速度参考
+    // 最后已知姿态
+    float quat[4];
+    
+    // v0.6.3: 融合器检查点 (version = 0 表示无效)
+    fusion_checkpoint_t fusion;
     
     // 校准状态
     bool calibration_valid;
@@ -67,6 +86,9 @@ typedef struct {
     uint32_t sleep_count;       // 进入睡眠次数
     uint32_t wake_count;        // 唤醒次数
     
+    // v0.6.3: RF 链路快照
+    rf_link_snapshot_t rf_link;
+    
     // CRC校验
     uint16_t crc;
 } __attribute__((packed)) retained_state_t;
@@ -109,20 +131,38 @@ bool retained_is_valid(void);
 void retained_clear(void);
 
 /**
- * @brief 保存完整融合器状态
- * @param state 融合器状态指针
- * @param state_size 状态大小
+ * @brief v0.6.3: 保存融合器检查点
+ * @note 需在 retained_save() 之前调用: Flash 后端随 retained_save()/retained_commit()
+ *       一起落盘, SRAM 后端立即写入保持 RAM
+ * @return 0成功，负值失败
+ */
+int retained_save_fusion(const fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 取出融合器检查点
+ * @return 0成功且状态有效，1成功但状态过期，负值无检查点/版本不符
+ */
+int retained_restore_fusion(fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 保存 RF 链路快照并立即写入 Flash (不受写入频率限制)
+ * @note 需在 retained_save() 之后调用, 进入 Shutdown 前使用;
+ *       SRAM 后端只写保持 RAM
  * @return 0成功，负值失败
  */
-int retained_save_fusion_state(const void *state, uint16_t state_size);
+int retained_save_link(const rf_link_snapshot_t *link);
+
+/**
+ * @brief v0.6.3: 取出 RF 链路快照 (一次性, 取出后缓存中标记为无效)
+ * @return 0成功，负值无快照
+ */
+int retained_restore_link(rf_link_snapshot_t *link);
 
 /**
- * @brief 恢复完整融合器状态
- * @param state 融合器状态指针
- * @param state_size 状态大小
+ * @brief v0.6.3: 把当前状态写入 Flash (SRAM 后端下保持 RAM 可能失效前调用)
  * @return 0成功，负值失败
  */
-int retained_restore_fusion_state(void *state, uint16_t state_size);
+int retained_commit(void);
 
 /**
  * @brief 增加睡眠计数
@@ -0,0 +1,108 @@
+/**
+ * @file rf_airtime_trace.h
+ * @brief 接收器超帧时序追踪 / Receiver superframe airtime trace
+ *
+ * v0.6.3: 逐帧记录信标发送、各时隙开始、包到达偏移、中断耗时和解码 CRC 结果,
+ * 经 usb_debug 数据流 (stream_mask bit4) 输出, 主机端 tools/rf_trace.py 解码,
+ * 用于调整保护时间和时隙宽度
+ *
+ * - 定时器/RF 中断只写当前帧记录, 帧结束时发布; 主循环读取已完成的记录
+ * - CRC 结果在主循环解码时补记, 所以落后当前帧至少一帧才输出
+ * - 记录环写满时丢弃新帧并计数, 不阻塞中断
+ *
+ * 报告格式 (每帧 1-2 个, 64 字节以内):
+ *   [0]     RF_TRACE_REPORT_ID
+ *   [1-2]   帧号 LE
+ *   [3]     本报告首个时隙序号
+ *   [4]     本报告时隙数
+ *   [5]     标志 RF_TRACE_F_*
+ *   [6-7]   信标定时器唤醒相对名义帧起点 (int16 us)
+ *   [8]     信标回调耗时 (us)
+ *   [9-10]  帧结束定时器唤醒偏移 (us)
+ *   [11]    此前丢弃的帧数 (饱和)
+ *   [12..]  每时隙 6 字节: 开始偏移 uint16 us, 包到达 (相对时隙开始, 2us 单位,
+ *           0xFF=无), RF 中断耗时 us, 时隙回调耗时 us, 标志 (bit0-4 归属, RF_TRACE_S_*)
+ */
+
+#ifndef __RF_AIRTIME_TRACE_H__
+#define __RF_AIRTIME_TRACE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RF_TRACE_REPORT_ID      0xFD
+#define RF_TRACE_FRAMES         8       // 记录环深度 (2 的幂)
+#define RF_TRACE_MAX_SLOTS      16      // 每帧记录的时隙数上限
+#define RF_TRACE_REPORT_SLOTS   8       // 每个报告的时隙数
+#define RF_TRACE_HEADER_SIZE    12
+#define RF_TRACE_SLOT_SIZE      6
+
+// 报告标志
+#define RF_TRACE_F_LAST         0x01    // 本帧最后一个报告
+#define RF_TRACE_F_TRUNCATED    0x02    // 时隙数超过 RF_TRACE_MAX_SLOTS
+
+// 时隙标志 (低 5 位为归属 tracker, RF_TRACE_OWNER_NONE = 空闲)
+#define RF_TRACE_OWNER_NONE     0x1F
+#define RF_TRACE_S_RX           0x20    // 收到包 (取首个)
+#define RF_TRACE_S_CRC_OK       0x40
+#define RF_TRACE_S_CRC_BAD      0x80
+
+#define RF_TRACE_NO_ARRIVAL     0xFF
+
+/**
+ * @brief 开始/停止追踪 (开始时清空记录环)
+ */
+void rf_trace_enable(bool enable);
+
+bool rf_trace_enabled(void);
+
+/**
+ * @brief 信标已发出 (定时器中断, 帧起点)
+ * @param frame_start_us 名义帧起点
+ * @param wake_us 定时器回调进入时刻
+ * @param done_us 回调处理完成时刻
+ */
+void rf_trace_frame_begin(uint16_t frame, uint32_t frame_start_us,
+                          uint32_t wake_us, uint32_t done_us);
+
+/**
+ * @brief 时隙开始 (定时器中断)
+ * @param owner 归属 tracker, 未激活的时隙传 RF_TRACE_OWNER_NONE
+ */
+void rf_trace_slot_begin(uint8_t slot, uint8_t owner, uint32_t wake_us, uint32_t done_us);
+
+/**
+ * @brief 时隙内收到包 (RF 中断)
+ * @param rx_us 中断进入时刻
+ * @param done_us 中断处理完成时刻
+ */
+void rf_trace_rx(uint8_t slot, uint32_t rx_us, uint32_t done_us);
+
+/**
+ * @brief 帧结束定时器唤醒, 发布本帧记录 (定时器中断)
+ */
+void rf_trace_frame_end(uint32_t wake_us);
+
+/**
+ * @brief 补记解码结果 (主循环)
+ * @param frame 包所在帧号
+ * @param rx_us 包到达时刻 (与 rf_trace_rx 相同)
+ */
+void rf_trace_crc(uint16_t frame, uint32_t rx_us, bool ok);
+
+/**
+ * @brief 取下一个追踪报告 (主循环)
+ * @param buf 至少 64 字节
+ * @return 报告长度, 0 = 暂无
+ */
+uint8_t rf_trace_read(uint8_t *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RF_AIRTIME_TRACE_H__ */
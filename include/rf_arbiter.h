@@ -0,0 +1,60 @@
+/**
+ * @file rf_arbiter.h
+ * @brief v0.6.3 射频时分仲裁: 私有 TDMA 链路 + BLE 配置通道 (tracker, USE_RADIO_ARBITER)
+ *
+ * 每个超帧内 tracker 只在同步信标窗口和自己的时隙 (含备用时隙 / OTA 监听) 使用射频.
+ * rf_transmitter 进入待机后把射频交给 BLE, 窗口到下一帧信标前 RF_ARB_GUARD_US 结束;
+ * 下一帧 rf_transmitter_process 开始时收回射频并恢复私有模式寄存器.
+ * BLE 协议栈只在窗口内处理, 共享中断向量 (BLE_IRQHandler) 按当前所有者分发.
+ */
+
+#ifndef __RF_ARBITER_H__
+#define __RF_ARBITER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    RADIO_OWNER_RF = 0,             // 私有 TDMA 链路 (rf_hw)
+    RADIO_OWNER_BLE,                // BLE 协议栈
+} radio_owner_t;
+
+typedef struct {
+    uint32_t windows;               // 交给 BLE 的窗口数
+    uint32_t short_windows;         // 剩余时间不足 RF_ARB_MIN_WINDOW_US 未交出
+    uint32_t preempts;              // 收回时 BLE 已超出窗口 (应为 0)
+    uint32_t ble_us;                // 累计 BLE 窗口时长
+} rf_arbiter_stats_t;
+
+void rf_arbiter_init(void);
+
+/**
+ * @brief TDMA 本帧用完射频, 交给 BLE 直到下一帧信标前
+ * @param next_frame_us 下一帧信标时刻 (rf_hw_get_time_us 时基)
+ */
+void rf_arbiter_release(uint32_t next_frame_us);
+
+/**
+ * @brief TDMA 需要射频 (每次 rf_transmitter_process 开始时调用)
+ */
+void rf_arbiter_acquire(void);
+
+/**
+ * @brief 当前 BLE 窗口剩余时间
+ * @return 微秒, 0 = 射频归 TDMA
+ */
+uint32_t rf_arbiter_ble_budget(void);
+
+radio_owner_t rf_arbiter_owner(void);
+
+void rf_arbiter_get_stats(rf_arbiter_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RF_ARBITER_H__ */
@@ -0,0 +1,111 @@
+/**
+ * @file rf_auth.h
+ * @brief v0.6.3 链路认证加密 (USE_RF_LINK_AUTH, 两端需同时启用)
+ *
+ * 密钥: 128 位链路密钥经 USB 调试命令 0x25 分别写入接收器和每个 tracker,
+ * 不经空口分发 (配对应答里的 network_key 是明文, 只用于跳频); 未写入密钥时链路保持明文.
+ *
+ * 密钥流: AES-128 计数器模式, 计数器块只由包的位置决定
+ *   [0-3] 纪元 (接收器每次启动预留一段, 帧号回绕时递增)  [4-5] 帧号
+ *   [6] tracker ID (信标为 RF_AUTH_ID_BEACON)  [7] 时隙序号 (0 = 主时隙, 1+k = 第 k 个备用时隙)
+ *   [8] 块序号  [9-15] 0
+ * 因此 tracker 收到信标后、时隙开始前就能算好本帧密钥流, 时隙内只做异或和 MIC 的几次乘法.
+ *
+ * MIC (2 字节): Carter-Wegman - 以 16 位字在 GF(65537) 上做多项式哈希 (初值为长度),
+ * 哈希密钥 r 和掩码 s 取自密钥流前 4 字节; 数据包先加密后对密文求 MIC (密钥流第 4 字节起加密),
+ * 信标只认证不加密 (帧号/信道表不保密, 防的是伪造).
+ *
+ * 硬件: 启用 WCH BLE 协议栈库 (USE_BLE_SLIMEVR) 时分组加密走 LL_Encrypt (芯片 AES 引擎),
+ * 初始化时用 FIPS-197 向量自检字节序, 不一致或未链接协议栈时用软件实现
+ */
+
+#ifndef __RF_AUTH_H__
+#define __RF_AUTH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+
+#define RF_AUTH_KEY_SIZE        16
+#define RF_AUTH_ID_BEACON       0xFF
+#define RF_AUTH_MAC_KEY_SIZE    4       // 密钥流前 4 字节: r, s
+#define RF_AUTH_STREAM_MAX      48      // 3 个分组, 覆盖 RF_AUTH_MAC_KEY_SIZE + 32 字节包
+#define RF_AUTH_EPOCH_RESERVE   256     // 每次启动预留的纪元数 (约 23 小时连续运行)
+
+typedef struct {
+    uint32_t epoch;
+    uint16_t frame;
+    uint8_t tracker_id;
+    uint8_t attempt;
+} rf_auth_nonce_t;
+
+/**
+ * @brief 加载链路密钥并选择分组加密实现 (启动时调用一次)
+ */
+void rf_auth_init(void);
+
+/**
+ * @brief 是否已设置链路密钥 (未设置时链路为明文)
+ */
+bool rf_auth_active(void);
+
+/**
+ * @brief 设置并保存链路密钥
+ * @param key 16 字节, NULL 或全 0 = 清除 (恢复明文)
+ * @return 0 成功, 负数为 HAL_KV_ERR_*
+ */
+int rf_auth_set_key(const uint8_t *key);
+
+/**
+ * @brief 预先计算 nonce 对应的密钥流 (主循环, 长度按 len 字节的包)
+ *
+ * 信标 (tracker_id = RF_AUTH_ID_BEACON) 与数据包各缓存一组;
+ * 之后 seal/open/sign/verify 命中缓存时不再做分组加密, 中断中读取缓存是安全的
+ */
+void rf_auth_prepare(const rf_auth_nonce_t *nonce, uint8_t len);
+
+/**
+ * @brief 加密并附加 MIC
+ * @param out 输出缓冲区, 至少 len + RF_LINK_MIC_SIZE 字节 (可与 in 相同)
+ * @return 输出长度
+ */
+uint8_t rf_auth_seal(uint8_t *out, const uint8_t *in, uint8_t len, const rf_auth_nonce_t *nonce);
+
+/**
+ * @brief 校验 MIC 并解密
+ * @param len 空口长度 (含 MIC)
+ * @return 明文长度, -1 = 校验失败
+ */
+int rf_auth_open(uint8_t *out, const uint8_t *in, uint8_t len, const rf_auth_nonce_t *nonce);
+
+/**
+ * @brief 只认证不加密 (信标): 对 data[0..len) 计算 MIC 写入 mic
+ */
+void rf_auth_sign(uint8_t *mic, const uint8_t *data, uint8_t len, const rf_auth_nonce_t *nonce);
+
+bool rf_auth_verify(const uint8_t *mic, const uint8_t *data, uint8_t len,
+                    const rf_auth_nonce_t *nonce);
+
+/**
+ * @brief 接收器本次启动的起始纪元: 从存储的预留上限开始, 并立即保存新的上限
+ */
+uint32_t rf_auth_epoch_start(void);
+
+/**
+ * @brief 纪元接近预留上限时顺延预留 (主循环, 后台写入)
+ */
+void rf_auth_epoch_check(uint32_t epoch);
+
+#endif /* USE_RF_LINK_AUTH */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RF_AUTH_H__ */
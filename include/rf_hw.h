@@ -51,6 +51,25 @@ extern "C" {
 #define RF_CRC_8BIT             1
 #define RF_CRC_16BIT            2
 
+// v0.6.3: rf_hw_timer_at 的最短装载量 (时刻已过或太近时)
+#define RF_HW_TIMER_MIN_US      20
+
+// v0.6.3: 接收缓冲池 - 中断把 FIFO 直接读进空闲缓冲, 按句柄交给上层, 用完归还;
+// 接收器与 ISR 包队列深度 (RX_RING_SIZE) 一致, tracker 只需覆盖同步读取
+#ifndef RF_HW_RX_POOL_SIZE
+#ifdef BUILD_RECEIVER
+#define RF_HW_RX_POOL_SIZE      32
+#else
+#define RF_HW_RX_POOL_SIZE      4
+#endif
+#endif
+#define RF_HW_RX_BUF_SIZE       32      // 超长部分读出丢弃 (= RF_MAX_PAYLOAD_SIZE)
+#define RF_HW_RX_NONE           0xFF    // 无效句柄
+
+#if RF_HW_RX_POOL_SIZE > 32
+#error "RF_HW_RX_POOL_SIZE must fit the 32-bit free mask"
+#endif
+
 /*============================================================================
  * RF Configuration Structure
  *============================================================================*/
@@ -74,6 +93,20 @@ typedef struct {
 typedef void (*rf_hw_rx_callback_t)(const uint8_t *data, uint8_t len, int8_t rssi);
 typedef void (*rf_hw_tx_callback_t)(bool success);
 
+// v0.6.3: 接收缓冲池中的一个包
+typedef struct {
+    uint8_t data[RF_HW_RX_BUF_SIZE];
+    uint8_t len;
+    int8_t rssi;
+} rf_hw_rx_buf_t;
+
+/**
+ * @brief v0.6.3: 缓冲池接收回调 (中断中调用)
+ * @return true = 上层保留该缓冲, 之后用 rf_hw_rx_release 归还;
+ *         false = 不保留, 作为 rf_hw_receive 的最新包
+ */
+typedef bool (*rf_hw_rx_pool_callback_t)(uint8_t handle, const rf_hw_rx_buf_t *buf);
+
 /*============================================================================
  * API Functions
  *============================================================================*/
@@ -115,6 +148,17 @@ uint8_t rf_hw_get_channel(void);
  */
 void rf_hw_set_tx_power(uint8_t power);
 
+/**
+ * @brief v0.6.3: 切换 PHY 速率 (RF_MODE_1MBPS / RF_MODE_2MBPS), 与当前相同时无操作
+ * @note 只改包格式寄存器的速率位, 可在时隙中断中调用
+ */
+void rf_hw_set_rate(uint8_t rate);
+
+/**
+ * @brief v0.6.3: 当前 PHY 速率
+ */
+uint8_t rf_hw_get_rate(void);
+
 /**
  * @brief Set sync word (address)
  * @param sync_word 4-byte sync word
@@ -141,6 +185,14 @@ void rf_hw_standby(void);
  */
 void rf_hw_sleep(void);
 
+/**
+ * @brief v0.6.3: Re-apply private-mode registers after the BLE stack used the radio
+ *
+ * Same settings as the last rf_hw_init() plus later channel / power / sync
+ * word changes, without the reset delay. Leaves the radio in standby.
+ */
+void rf_hw_reclaim(void);
+
 /**
  * @brief Transmit packet
  * @param data Packet data
@@ -158,6 +210,13 @@ int rf_hw_transmit(const uint8_t *data, uint8_t len);
  */
 int rf_hw_transmit_async(const uint8_t *data, uint8_t len);
 
+/**
+ * @brief v0.6.3: 发送并低功耗等待 TX_DONE 中断 (不在中断上下文中调用)
+ * @return 0=发送完成, -2=超时, 其余同 rf_hw_transmit
+ * @note FIFO 未空时退回 rf_hw_transmit 的等待/清空流程
+ */
+int rf_hw_transmit_wait(const uint8_t *data, uint8_t len);
+
 /**
  * @brief Transmit packet with ACK request
  * @param data Packet data
@@ -181,6 +240,14 @@ bool rf_hw_rx_available(void);
  */
 #define rf_hw_data_ready() rf_hw_rx_available()
 
+/**
+ * @brief v0.6.3: 低功耗等待接收 - 睡眠到射频中断或 deadline, 有包可读时立即返回
+ * @param deadline_us hal_micros 时基, 回绕安全
+ * @return true = rf_hw_rx_available(), false = 到达 deadline 仍无包
+ * @note 不在中断上下文中调用
+ */
+bool rf_hw_wait_rx(uint32_t deadline_us);
+
 /**
  * @brief Set RF mode using mode constant
  * @param mode RF_MODE_xxx constant
@@ -203,6 +270,12 @@ int rf_hw_receive(uint8_t *data, uint8_t max_len, int8_t *rssi);
  */
 void rf_hw_set_ack_payload(const uint8_t *data, uint8_t len);
 
+/**
+ * @brief v0.6.3: Enable/disable hardware auto-ACK
+ * @note 旁听接收器 (分集副接收器) 必须关闭, 否则会与主接收器的 ACK 冲突
+ */
+void rf_hw_set_auto_ack(bool enable);
+
 /**
  * @brief Flush TX FIFO
  */
@@ -219,6 +292,12 @@ void rf_hw_flush_rx(void);
  */
 int8_t rf_hw_get_rssi(void);
 
+/**
+ * @brief v0.6.3: 读取当前信道的实时 RSSI (能量检测, 需处于 RX 模式)
+ * @return RSSI in dBm
+ */
+int8_t rf_hw_sample_rssi(void);
+
 /**
  * @brief Check if carrier detected (channel busy)
  * @return true if carrier detected
@@ -230,6 +309,26 @@ bool rf_hw_carrier_detect(void);
  */
 void rf_hw_set_rx_callback(rf_hw_rx_callback_t callback);
 
+/**
+ * @brief v0.6.3: 设置缓冲池接收回调 (零拷贝, 在 rx_callback 之后调用)
+ */
+void rf_hw_set_rx_pool_callback(rf_hw_rx_pool_callback_t callback);
+
+/**
+ * @brief v0.6.3: 句柄对应的接收缓冲 (保留期间内容不变)
+ */
+const rf_hw_rx_buf_t *rf_hw_rx_buf(uint8_t handle);
+
+/**
+ * @brief v0.6.3: 归还保留的接收缓冲 (主循环调用)
+ */
+void rf_hw_rx_release(uint8_t handle);
+
+/**
+ * @brief v0.6.3: 缓冲池耗尽而丢弃的包数
+ */
+uint32_t rf_hw_rx_pool_overruns(void);
+
 /**
  * @brief Set TX complete callback (called from IRQ)
  */
@@ -260,6 +359,12 @@ void rf_hw_irq_handler(void);
  */
 uint32_t rf_hw_get_time_us(void);
 
+/**
+ * @brief v0.6.3: 最近一次接收完成中断的入口时刻 (rf_hw_get_time_us 时基)
+ * @note 未启用 USE_HW_TIMESTAMP 时返回当前时刻; 在接收回调中调用即为本包的接收时刻
+ */
+uint32_t rf_hw_get_rx_time_us(void);
+
 /**
  * @brief Delay for specified microseconds
  */
@@ -272,11 +377,64 @@ void rf_hw_delay_us(uint32_t us);
  */
 void rf_hw_start_timer(uint32_t period_us, void (*callback)(void));
 
+/**
+ * @brief v0.6.3: 在绝对时刻 (rf_hw_get_time_us 时基) 回调一次
+ *
+ * 剩余时间在装载时由自由运行时基算出, 回调中按同一时间线装载下一个时刻,
+ * 中断进入延迟不会逐次累积. 时刻已过时 RF_HW_TIMER_MIN_US 后回调;
+ * 回调中没有重新装载时定时器停止
+ */
+void rf_hw_timer_at(uint32_t deadline_us, void (*callback)(void));
+
 /**
  * @brief Stop slot timer
  */
 void rf_hw_stop_timer(void);
 
+/**
+ * @brief v0.6.3: 系统时钟切换后重新装载 TMR2 (当前周期的剩余时间按新时钟换算, 之后恢复原周期)
+ * @note 在 hal_timer_set_sysclk 之后调用; 定时器未运行时无操作
+ */
+void rf_hw_timer_retime(void);
+
+#if defined(BUILD_HOST)
+/*============================================================================
+ * v0.6.3: 主机网络仿真射频 (rf_hw_host.c, make netsim)
+ *============================================================================*/
+
+// 射频发出一个包 (信标/配对响应), 在发送调用的仿真时刻回调
+typedef void (*rf_hw_host_tx_hook_t)(const uint8_t *data, uint8_t len, uint8_t channel, uint8_t rate);
+// 信道能量检测模型 (rf_hw_sample_rssi)
+typedef int8_t (*rf_hw_host_noise_t)(uint8_t channel);
+
+void rf_hw_host_set_tx_hook(rf_hw_host_tx_hook_t hook);
+void rf_hw_host_set_noise(rf_hw_host_noise_t model);
+
+/**
+ * @brief 定时器到期时刻 (hal_micros64 时基)
+ * @return false = 定时器未运行
+ */
+bool rf_hw_host_next_timer(uint64_t *deadline_us);
+
+/**
+ * @brief 仿真时钟到达到期时刻后调用, 执行定时器回调
+ */
+void rf_hw_host_run_timer(void);
+
+/**
+ * @brief 射频状态版本号 (信道/速率/收发模式变化时递增), 包开始时记录
+ */
+uint32_t rf_hw_host_radio_gen(void);
+
+/**
+ * @brief 包结束时刻交给接收端
+ * @param rate 发送端速率 (RF_MODE_1MBPS / RF_MODE_2MBPS)
+ * @param gen 包开始时的 rf_hw_host_radio_gen() (期间射频状态变化则收不到)
+ * @return -1 = 射频未在该信道/速率上接收, 0 = 已接收, 1 = 已接收并自动回 ACK
+ */
+int rf_hw_host_deliver(const uint8_t *data, uint8_t len, int8_t rssi, uint8_t rate, uint32_t gen);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
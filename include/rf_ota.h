@@ -0,0 +1,117 @@
+/**
+ * @file rf_ota.h
+ * @brief v0.6.3 RF 固件广播升级 (USE_RF_OTA, 需 make OTA=1)
+ *
+ * 接收器: 经 USB 把 tracker 固件暂存到自身 OTA 分区, 之后在每帧最后一个时隙
+ * 之后的空闲时间组播 RF_PKT_OTA_DATA 块 (每帧最多 RF_OTA_CHUNKS_PER_FRAME 个),
+ * 第一轮按顺序发送, 之后按 tracker 状态包中的缺失位图选择性补发.
+ *
+ * Tracker: 收到 RF_CMD_OTA_LISTEN 后在每帧自己的时隙之后停留接收到帧末,
+ * 块写入自身 OTA 分区; 每 RF_OTA_REPORT_FRAMES 个发送帧用一个状态包代替数据包.
+ * 收齐并校验通过后等待 RF_CMD_OTA_APPLY.
+ */
+
+#ifndef __RF_OTA_H__
+#define __RF_OTA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rf_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RF_OTA_PACKET_US        (RF_AIRTIME_US(sizeof(rf_ota_data_packet_t)) + RF_TURNAROUND_US)
+
+#ifdef BUILD_RECEIVER
+
+/**
+ * @brief 每个 tracker 的接收进度 (最近一次状态包)
+ */
+typedef struct {
+    bool seen;                      // 本会话收到过状态包
+    uint8_t flags;                  // RF_OTA_FLAG_*
+    uint16_t base;                  // 首个缺失块
+    uint32_t last_ms;               // 状态包接收时刻
+} rf_ota_progress_t;
+
+/**
+ * @brief 开始广播 OTA 分区中已校验的镜像 (ota_verify 已通过)
+ * @return 会话号, 负值 = 没有可用镜像
+ */
+int rf_ota_broadcast_start(void);
+
+/**
+ * @brief 停止广播并通知 tracker 停止接收
+ */
+void rf_ota_broadcast_stop(rf_receiver_ctx_t *ctx);
+
+bool rf_ota_broadcast_active(void);
+
+/**
+ * @brief 生成下一个广播包 (slot 定时器中断上下文)
+ * @return 包长度, 0 = 本帧没有要发的包
+ */
+uint8_t rf_ota_next_packet(uint8_t *buf);
+
+/**
+ * @brief 处理已通过 CRC 校验的 tracker 状态包 (rf_receiver_process 解码上下文)
+ */
+void rf_ota_on_status(const rf_ota_status_packet_t *pkt);
+
+/**
+ * @brief 主循环任务: 补发 LISTEN 命令, 一轮结束后从最小缺失块重新开始
+ */
+void rf_ota_receiver_task(rf_receiver_ctx_t *ctx);
+
+/**
+ * @brief 读取广播状态
+ * @param cursor 输出本轮下一个顺序块 (可为 NULL)
+ * @param chunks 输出镜像总块数 (可为 NULL)
+ * @return 会话号, 0 = 未广播
+ */
+uint8_t rf_ota_broadcast_status(uint16_t *cursor, uint16_t *chunks);
+
+bool rf_ota_get_progress(uint8_t tracker_id, rf_ota_progress_t *out);
+
+#else
+
+/**
+ * @brief RF_CMD_OTA_LISTEN (ACK 命令字段)
+ */
+void rf_ota_listen(uint8_t session);
+
+/**
+ * @brief 是否需要在时隙后停留接收广播块
+ */
+bool rf_ota_listening(void);
+
+/**
+ * @brief 处理 RF_PKT_OTA_INFO / RF_PKT_OTA_DATA (rf_transmitter 接收上下文)
+ */
+void rf_ota_on_packet(const uint8_t *data, uint8_t len);
+
+/**
+ * @brief 本帧需要上报时生成状态包
+ * @return 包长度, 0 = 本帧发送数据包
+ */
+uint8_t rf_ota_build_status(uint8_t tracker_id, uint8_t *buf);
+
+/**
+ * @brief RF_CMD_OTA_APPLY: 镜像已校验时写入应用区并重启
+ */
+void rf_ota_apply(uint8_t session);
+
+/**
+ * @brief 主循环任务: 开始接收、写入已收到的块、收齐后校验
+ */
+void rf_ota_task(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RF_OTA_H__ */
@@ -26,10 +26,18 @@ extern "C" {
 #define RF_MAX_TRACKERS             MAX_TRACKERS
 #define RF_MIN_TRACKERS             6
 #define RF_CHANNEL_COUNT            40
+#define RF_HOP_TABLE_SIZE           256     // v0.6.3: 预计算跳频表长度 (2的幂)
+#define RF_HOP_MAX_SKIP             10      // 跳过黑名单信道的最大尝试次数
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+#define RF_COEX_LANES               16      // 车道数 = 跳频信道集大小
+#define RF_COEX_LANE_AUTO           0xFF    // 未指定车道: 由网络密钥导出
+#define RF_COEX_HOP_KEY             0x9E3779B9  // 共存模式公共跳频序列种子
+#define RF_COEX_MAX_PEERS           4       // 接收器记录的邻近套件数
+#endif
 #define RF_SYNC_WORD                0x534C5652  // "SLVR"
 
 // Timing (in microseconds)
-#define RF_SUPERFRAME_US            5000    // 5ms superframe = 200Hz
+#define RF_SUPERFRAME_US            5000    // 5ms superframe = 200Hz (v0.6.3: 可变速率时为最长一档)
 #define RF_SYNC_SLOT_US             250     // Sync beacon duration
 #define RF_DATA_SLOT_US             400     // Per-tracker slot
 #define RF_GUARD_TIME_US            200     // Guard interval
@@ -37,12 +45,117 @@ extern "C" {
 #define RF_TX_TIME_US               300     // Data transmission
 #define RF_ACK_TIME_US              50      // ACK response
 
+// v0.6.3: 空口时间 (2Mbps), 时隙按实际最大数据包计算
+#define RF_PHY_US_PER_BYTE          4       // 2Mbps
+#define RF_TURNAROUND_US            40      // TX/RX 切换
+#if defined(USE_RF_ULTRA) && USE_RF_ULTRA && defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE && \
+    defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#define RF_SLOT_PAYLOAD_MAX         26      // RF_MULTI_PACKET_SIZE(3), 留出 MIC
+#elif defined(USE_RF_ULTRA) && USE_RF_ULTRA && defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+#define RF_SLOT_PAYLOAD_MAX         31      // RF_MULTI_PACKET_SIZE(4)
+#elif defined(USE_RF_ULTRA) && USE_RF_ULTRA && defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+#define RF_SLOT_PAYLOAD_MAX         27      // RF_RAW_PACKET_SIZE(2)
+#elif defined(USE_RF_ULTRA) && USE_RF_ULTRA && defined(USE_AUX_IMU) && USE_AUX_IMU
+#define RF_SLOT_PAYLOAD_MAX         20      // RF_DUAL_PACKET_SIZE
+#elif defined(USE_RF_ULTRA) && USE_RF_ULTRA
+#define RF_SLOT_PAYLOAD_MAX         12      // RF_ULTRA_PACKET_SIZE
+#elif defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+#define RF_SLOT_PAYLOAD_MAX         23      // sizeof(rf_tracker_packet_t) (含 sample_age)
+#else
+#define RF_SLOT_PAYLOAD_MAX         22      // sizeof(rf_tracker_packet_t)
+#endif
+// v0.6.3: 链路认证 MIC (USE_RF_LINK_AUTH), 附加在时隙数据包和信标之后
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#define RF_LINK_MIC_SIZE            2
+#else
+#define RF_LINK_MIC_SIZE            0
+#endif
+#define RF_AIRTIME_US(len)          ((RF_PREAMBLE_SIZE + RF_SYNCWORD_SIZE + (len) + RF_CRC_SIZE) * RF_PHY_US_PER_BYTE)
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+#define RF_SLOT_ACK_US              0       // v0.6.3: 确认随下一帧信标下发, 时隙内无 ACK
+#else
+#define RF_SLOT_ACK_US              (RF_AIRTIME_US(8) + RF_TURNAROUND_US)  // ACK + 收发切换
+#endif
+#define RF_SLOT_AIR_US              (RF_AIRTIME_US(RF_SLOT_PAYLOAD_MAX + RF_LINK_MIC_SIZE) + RF_TURNAROUND_US + \
+                                     RF_SLOT_ACK_US)
+// v0.6.3: 1Mbps 空口时间为 2 倍, 收发切换不变; 两个连续时隙 (2 × RF_SLOT_AIR_US) 总能容纳
+#define RF_PHY_1M_FACTOR            2
+
+// v0.6.3: 多超帧调度 - 时隙长度按实际最大数据包空口时间计算
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+#define RF_SLOT_GUARD_US            30      // 时钟漂移余量
+#define RF_SLOT_US                  (RF_SLOT_AIR_US + RF_SLOT_GUARD_US)
+#define RF_SCHED_CYCLE              4       // 调度周期 (帧), 速率分频 1/2/4 = 200/100/50Hz
+#define RF_DEFAULT_RATE_DIV         1
+#else
+#define RF_SLOT_US                  RF_DATA_SLOT_US
+#endif
+
+// v0.6.3: 自适应超帧布局
+// 主时隙按 active_mask 中的排名紧凑排列, 之后是备用时隙
+#define RF_FRAME_SLOT_CAPACITY      ((RF_SUPERFRAME_US - RF_SYNC_SLOT_US - RF_GUARD_TIME_US) / RF_SLOT_US)
+
+// v0.6.3: 自适应时隙保护时间 - 时隙宽度 = RF_SLOT_AIR_US + 2 × 保护时间;
+// RF_SLOT_US 对应最大保护时间, 接收器按实测到达偏移收窄, 随信标下发
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+#define RF_GUARD_MAX_US             ((RF_SLOT_US - RF_SLOT_AIR_US) / 2)
+#define RF_GUARD_UNIT_US            2       // 信标 slot_guard 字段单位
+#define RF_SLOT_WIDTH_US(guard)     (RF_SLOT_AIR_US + 2 * (guard))
+#define RF_SLOTS_PER_FRAME(width)   ((RF_SUPERFRAME_US - RF_SYNC_SLOT_US - RF_GUARD_TIME_US) / (width))
+#define RF_FRAME_SLOT_MAX           RF_SLOTS_PER_FRAME(RF_SLOT_WIDTH_US(RF_GUARD_MIN_US))
+#if RF_GUARD_MIN_US > RF_GUARD_MAX_US
+#error "RF_GUARD_MIN_US exceeds the guard time left in RF_SLOT_US"
+#endif
+#else
+#define RF_FRAME_SLOT_MAX           RF_FRAME_SLOT_CAPACITY
+#endif
+#define RF_SPARE_SLOT_MAX           4       // 信标中最多描述的备用时隙数
+#define RF_SPARE_SLOT_FREE          0xFF    // 备用时隙未分配
+
+// v0.6.3: 可变超帧速率 - 运行时超帧周期 RF_FRAME_US 随信标 frame_rate 字段切换;
+// 编译期容量 (RF_FRAME_SLOT_MAX 等) 仍按最长的 RF_SUPERFRAME_US 计算
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+#define RF_FRAME_RATE_COUNT         4
+#define RF_FRAME_RATE_PERIODS       { RF_SUPERFRAME_US, 4000, 3000, 2500 }  // 200/250/333/400Hz
+// frame_rate 字段: bit0-1 本帧速率档, bit2-3 待切换的速率档, bit4-7 距切换的帧边界数 (0 = 无切换)
+#define RF_RATE_PACK(cur, next, left) ((uint8_t)((cur) | ((next) << 2) | ((left) << 4)))
+#define RF_RATE_CUR(f)              ((f) & 0x03)
+#define RF_RATE_NEXT(f)             (((f) >> 2) & 0x03)
+#define RF_RATE_LEFT(f)             (((f) >> 4) & 0x0F)
+extern volatile uint16_t rf_frame_us;
+#define RF_FRAME_US                 rf_frame_us
+#else
+#define RF_FRAME_US                 RF_SUPERFRAME_US
+#endif
+// 当前超帧能容纳的时隙数 (RF_SLOTS_PER_FRAME 为最长超帧)
+#define RF_SLOTS_IN_FRAME(width)    ((RF_FRAME_US - RF_SYNC_SLOT_US - RF_GUARD_TIME_US) / (width))
+
+// v0.6.3: tracker 位图宽度 (信标 active_mask / 接收器内部位图)
+#if RF_MAX_TRACKERS > 24
+#error "RF_MAX_TRACKERS > 24 not supported"
+#elif RF_MAX_TRACKERS > 16
+#define RF_TRACKER_MASK_BYTES       3
+typedef uint32_t rf_tracker_mask_t;
+#else
+#define RF_TRACKER_MASK_BYTES       2
+typedef uint16_t rf_tracker_mask_t;
+#endif
+
+#if (RF_MAX_TRACKERS > RF_FRAME_SLOT_CAPACITY) && \
+    !(defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME)
+#error "MAX_TRACKERS exceeds one superframe, enable USE_MULTI_SUPERFRAME"
+#endif
+
 // Packet sizes
 #define RF_PREAMBLE_SIZE            1
 #define RF_SYNCWORD_SIZE            4
 #define RF_CRC_SIZE                 2
 #define RF_MAX_PAYLOAD_SIZE         32
 
+#if RF_SLOT_PAYLOAD_MAX + RF_LINK_MIC_SIZE > RF_MAX_PAYLOAD_SIZE
+#error "RF_SLOT_PAYLOAD_MAX + RF_LINK_MIC_SIZE exceeds RF_MAX_PAYLOAD_SIZE"
+#endif
+
 // Channels
 #define RF_PAIRING_CHANNEL          37      // Fixed pairing channel
 #define RF_BASE_FREQ_MHZ            2402    // Base frequency
@@ -65,8 +178,12 @@ typedef enum {
     RF_PKT_PAIR_REQUEST     = 0x20,     // Tracker pairing request
     RF_PKT_PAIR_RESPONSE    = 0x21,     // Receiver pairing response
     RF_PKT_PAIR_CONFIRM     = 0x22,     // Tracker pairing confirm
+    RF_PKT_PAIR_BATCH       = 0x23,     // v0.6.3: Receiver batched pairing response
     RF_PKT_ACK              = 0x30,     // Acknowledgment
     RF_PKT_COMMAND          = 0x40,     // Command to tracker
+    RF_PKT_OTA_INFO         = 0x50,     // v0.6.3: Receiver → All, firmware image announce
+    RF_PKT_OTA_DATA         = 0x51,     // v0.6.3: Receiver → All, firmware chunk
+    RF_PKT_OTA_STATUS       = 0x52,     // v0.6.3: Tracker → Receiver, missing-chunk report
 } rf_packet_type_t;
 
 /*============================================================================
@@ -83,12 +200,56 @@ typedef struct __attribute__((packed)) {
 typedef struct __attribute__((packed)) {
     rf_header_t header;
     uint16_t frame_number;          // Frame counter for sync
-    uint8_t active_mask[2];         // Bitmask of active trackers
+    uint8_t active_mask[RF_TRACKER_MASK_BYTES]; // Bitmask of active trackers
     uint8_t channel_map[5];         // Next 5 channels for hopping
     uint8_t tx_power;               // Current TX power level
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    uint8_t slot_count;             // 本帧数据时隙总数 (主 + 备用)
+    uint8_t spare_owner[RF_SPARE_SLOT_MAX]; // 备用时隙归属 tracker_id
+#endif
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    uint8_t sched_mask[RF_TRACKER_MASK_BYTES]; // 本帧分到主时隙的tracker (按排名排列)
+#endif
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    uint8_t slot_guard;             // 本帧时隙保护时间 (RF_GUARD_UNIT_US 单位)
+#endif
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    uint8_t frame_rate;             // 超帧速率 (RF_RATE_PACK: 本帧档 / 下一档 / 剩余帧数)
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    uint8_t roam_cell;              // 漫游组小区号 (跳频序列由网络密钥和小区号导出)
+#endif
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    uint8_t doze_interval;          // 组休眠信标间隔 (帧), 0 = 正常运行;
+                                    // 非 0 时 channel_map[0] = 下一个休眠信标的信道
+#endif
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    uint8_t phy_mask[RF_TRACKER_MASK_BYTES]; // 本帧用 1Mbps 的 tracker (主时隙占两个连续时隙)
+#endif
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    uint8_t ack_mask[RF_TRACKER_MASK_BYTES]; // 上一帧主时隙收到包的 tracker
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    uint8_t ack_spare;              // bit k = 上一帧第 k 个备用时隙收到包
+#endif
+    uint8_t cmd_tracker;            // 捎带命令的目标 tracker, RF_GROUP_CMD_NONE = 无
+    uint8_t command;
+    uint8_t command_data;
+#endif
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    uint16_t net_tag;               // 网络标签 (rf_coex_net_tag), 区分同一房间的多套件
+    uint8_t hop_lane;               // 跳频车道 (换车道期间为新车道)
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    uint32_t auth_epoch;            // 认证纪元 (接收器每次启动/帧号回绕递增), 与帧号一起防重放
+    uint8_t mic[RF_LINK_MIC_SIZE];  // 覆盖 mic 之前的全部字节 (未设置链路密钥时为 0)
+#endif
     uint16_t crc;
 } rf_sync_packet_t;
 
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+#define RF_GROUP_CMD_NONE           0xFF
+#endif
+
 // Tracker data packet (Tracker → Receiver)
 typedef struct __attribute__((packed)) {
     rf_header_t header;
@@ -103,9 +264,16 @@ typedef struct __attribute__((packed)) {
     int16_t accel_z;                // Accel Z in mg
     uint8_t battery;                // Battery level 0-100
     uint8_t flags;                  // Status flags
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    uint8_t sample_age;             // 姿态样本距发送时刻 (RF_SAMPLE_AGE_TICK_US 单位, 饱和)
+#endif
     uint16_t crc;
 } rf_tracker_packet_t;
 
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+#define RF_SAMPLE_AGE_TICK_US       20      // 与 RF_MULTI_TICK_US 相同, 最大 5.1ms
+#endif
+
 // ACK packet (Receiver → Tracker)
 typedef struct __attribute__((packed)) {
     rf_header_t header;
@@ -144,6 +312,79 @@ typedef struct __attribute__((packed)) {
     uint16_t crc;
 } rf_pair_confirm_t;
 
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+/*============================================================================
+ * v0.6.3: Slotted pairing window (USE_RF_SLOTTED_PAIRING)
+ * 配对信标 → 批量应答 → RF_PAIR_SLOTS 个时隙 (时隙从 tracker 收到批量应答起算);
+ * 时隙 0..count-1 留给本包第 k 个分配的确认, 其余时隙用于新的配对请求
+ *============================================================================*/
+
+#define RF_PAIR_SLOTS           16      // 每个配对周期的时隙数
+#define RF_PAIR_SLOT_US         2000    // 时隙宽度 (请求空中时间约 0.2ms)
+#define RF_PAIR_GUARD_US        500     // 批量应答到首个时隙 (收发切换)
+#define RF_PAIR_BATCH_MAX       3       // 每个批量应答最多分配的 ID (整包 30 字节)
+#define RF_PAIR_ANNOUNCE        3       // 未收到确认的分配重复公告的周期数
+#define RF_PAIR_BACKOFF_MAX     3       // 退避指数上限 (最多跳过 7 个周期)
+
+typedef struct __attribute__((packed)) {
+    uint8_t mac_tail[4];            // Tracker MAC 后 4 字节 (确认包带完整 MAC)
+    uint8_t tracker_id;
+} rf_pair_assign_t;
+
+// Batched pairing response (Receiver → All, once per pairing beacon)
+typedef struct __attribute__((packed)) {
+    rf_header_t header;
+    uint8_t receiver_mac[6];
+    uint32_t network_key;
+    uint8_t count;                  // 有效分配数, 同时是保留的确认时隙数
+    rf_pair_assign_t assign[RF_PAIR_BATCH_MAX];
+    uint16_t crc;
+} rf_pair_batch_t;
+#endif
+
+/*============================================================================
+ * v0.6.3: RF Firmware Broadcast (USE_RF_OTA)
+ * 接收器在帧末空闲时间组播固件块, tracker 在时隙后停留接收;
+ * tracker 定期用状态包代替一个数据包, 上报首个缺失块和其后的缺失位图
+ *============================================================================*/
+
+#define RF_OTA_CHUNK_SIZE           24      // 块数据长度 (整包 31 字节)
+#define RF_OTA_REPORT_BITS          32      // 状态包缺失位图覆盖的块数
+#define RF_OTA_CHUNK_NONE           0xFFFF  // 状态包 base: 已全部收齐
+
+// Image announce (Receiver → All)
+typedef struct __attribute__((packed)) {
+    rf_header_t header;
+    uint8_t session;                // 会话号 (1-255, 每次广播递增)
+    uint32_t image_size;            // 镜像字节数
+    uint32_t image_crc;             // CRC32 (同 ota_verify)
+    uint16_t crc;
+} rf_ota_info_packet_t;
+
+// Firmware chunk (Receiver → All)
+typedef struct __attribute__((packed)) {
+    rf_header_t header;
+    uint8_t session;
+    uint16_t chunk;                 // 块序号, 镜像偏移 = chunk × RF_OTA_CHUNK_SIZE
+    uint8_t data[RF_OTA_CHUNK_SIZE];
+    uint16_t crc;
+} rf_ota_data_packet_t;
+
+// Missing-chunk report (Tracker → Receiver, in the tracker's own slot)
+typedef struct __attribute__((packed)) {
+    rf_header_t header;
+    uint8_t tracker_id;
+    uint8_t session;
+    uint8_t flags;                  // RF_OTA_FLAG_*
+    uint16_t base;                  // 首个缺失块 (RF_OTA_CHUNK_NONE = 收齐)
+    uint32_t missing;               // bit k = 块 base + k 缺失
+    uint16_t crc;
+} rf_ota_status_packet_t;
+
+#define RF_OTA_FLAG_READY       (1 << 0)  // 已收到镜像信息, 正在接收
+#define RF_OTA_FLAG_VERIFIED    (1 << 1)  // 已收齐且 CRC32 通过
+#define RF_OTA_FLAG_ERROR       (1 << 2)  // 擦除/写入失败或 CRC32 不符
+
 /*============================================================================
  * Status Flags
  * v0.4.22: 扩展flags以对齐nRF Smol Slime packet3语义
@@ -181,6 +422,11 @@ typedef enum {
     RF_CMD_SLEEP            = 0x06,
     RF_CMD_WAKE             = 0x07,
     RF_CMD_SET_POWER        = 0x10,
+    RF_CMD_SET_FEC          = 0x11,     // v0.6.3: param 1 = 开启 FEC 包
+    RF_CMD_OTA_LISTEN       = 0x12,     // v0.6.3: param = OTA 会话号, 0 = 停止接收
+    RF_CMD_OTA_APPLY        = 0x13,     // v0.6.3: param = 会话号, 已校验的镜像写入应用区并重启
+    RF_CMD_SET_HOP_LO       = 0x14,     // v0.6.3: param = 本 tracker 信道映射低字节
+    RF_CMD_SET_HOP_HI       = 0x15,     // v0.6.3: param = 本 tracker 信道映射高字节
     RF_CMD_UNPAIR           = 0xFF,
 } rf_command_t;
 
@@ -194,6 +440,7 @@ typedef enum {
     RX_STATE_IDLE,
     RX_STATE_PAIRING,
     RX_STATE_RUNNING,
+    RX_STATE_LISTEN,                // v0.6.3: 分集副接收器, 跟随主接收器信标只收不发
     RX_STATE_ERROR,
 } rx_state_t;
 
@@ -225,8 +472,9 @@ typedef struct {
     uint8_t flags;                  // Status flags
     
     // Latest sensor data
-    float quaternion[4];
-    float acceleration[3];
+    // v0.6.3: 与空中包格式一致保持整数, 接收端不做浮点往返
+    int16_t quat[4];                // Quaternion [w,x,y,z] Q15
+    int16_t accel_mg[3];            // Acceleration (mg)
     
     // v0.4.23: 详细统计信息 (丢包/重传/超时)
     uint32_t total_packets;         // 总接收包数
@@ -235,8 +483,76 @@ typedef struct {
     uint32_t timeout_count;         // 超时次数
     uint32_t crc_error_count;       // CRC错误次数
     uint8_t loss_rate_pct;          // 丢包率百分比 (滑动平均)
+    
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    // v0.6.3: 多超帧调度
+    uint8_t rate_div;               // 每 N 帧一个主时隙 (1/2/4, 0 = 默认)
+    uint8_t rate_phase;             // 在 N 帧中的相位 (调度器分配)
+#endif
+    
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+    // v0.6.3: 状态旁路拼回的慢变化状态
+    uint8_t sideband_valid;         // 已收到的字段 (1 << RF_SB_FIELD_*)
+    uint8_t imu_type;
+    uint16_t battery_mv;
+    int16_t temp_cc;                // 0.01°C
+    uint16_t fw_version;            // major << 8 | minor
+#endif
 } tracker_info_t;
 
+/*============================================================================
+ * v0.6.3: Per-Tracker Link Statistics
+ * 在包解码处累计 (ISR 队列中每个包恰好处理一次), 与主循环/USB 报告节拍无关;
+ * 窗口比率每个窗口桶结束时更新一次, 读取为 O(1)
+ *============================================================================*/
+
+#define RF_LINK_BUCKET_MS           1000    // 窗口桶长度
+#define RF_LINK_BUCKETS             8       // 窗口 = 8 桶 (8 s)
+
+typedef struct {
+    uint32_t received;              // 新包 (含迟到补回的包)
+    uint32_t lost;                  // 序列号缺口, 迟到包补回后扣除
+    uint32_t duplicate;             // 重复包 (仅 ACK 丢失后的重传)
+    uint32_t late;                  // 迟到包 (比最新包序列号小, 选择性重传补回)
+    uint32_t ring_dropped;          // ISR 队列满丢弃 (按时隙归属, 同时计入 lost)
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    uint32_t auth_rejected;         // MIC 校验失败丢弃 (按时隙归属)
+#endif
+    uint8_t window_loss_pct;        // 窗口丢包率 (丢失 / 应收)
+    uint8_t window_dup_pct;         // 窗口重复率 (重复 / 新包)
+    uint8_t window_late_pct;        // 窗口迟到率 (迟到 / 新包)
+} rf_link_stats_t;
+
+/*============================================================================
+ * v0.6.3: Per-Tracker Orientation Timeline
+ * 接收端按样本时刻 (接收器 hal_micros) 缓存每个tracker的姿态,
+ * 多样本聚合包解包后最旧样本在前
+ *============================================================================*/
+
+#define RF_TIMELINE_DEPTH           8       // 每tracker样本数 (2的幂)
+#define RF_SEQ_LATE_FRAMES_MAX      4       // 重传样本最多回溯的超帧数
+
+typedef struct {
+    uint32_t t_us;                  // 样本时刻 (接收器时钟)
+    int16_t quat[4];                // Quaternion [w,x,y,z] * 32767
+    uint16_t frame;                 // 收到该样本时的超帧号
+    int16_t frame_offset_us;        // 相对该超帧起点 (多样本包中较早样本可为负)
+} rf_timeline_sample_t;
+
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+/*
+ * v0.6.3: 公共时间基准
+ * 样本时刻 = 接收时刻 - 包内样本年龄, 报告中表示为 (超帧号, 帧内偏移);
+ * 接收器时钟下超帧 f 的起点 = frame_start_us + (f - frame) * RF_FRAME_US
+ * (以最近一次读取的时间基准为参照, 帧栅格重新对齐后需重新读取)
+ */
+typedef struct {
+    uint32_t now_us;                // 读取时刻 (接收器时钟)
+    uint32_t frame_start_us;        // 当前超帧起点
+    uint16_t frame;                 // 当前超帧号
+} rf_time_base_t;
+#endif
+
 /*============================================================================
  * Receiver Context
  *============================================================================*/
@@ -287,11 +603,34 @@ typedef struct {
     
     // Sensor data
     float quaternion[4];
-    float acceleration[3];
+    float acceleration[3];      // v0.6.3: 机体系原始加速度 (g), 线性加速度在组包时计算
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    uint32_t sample_us;         // v0.6.3: quaternion 对应的 IMU 样本时刻 (rf_hw 时钟)
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    float aux_quaternion[4];    // v0.6.3: 辅助 IMU 姿态
+    uint32_t aux_sample_us;
+    bool aux_valid;             // 有辅助 IMU 时改发双姿态包
+#endif
     uint8_t battery;
     uint8_t flags;
 } rf_transmitter_ctx_t;
 
+/**
+ * v0.6.3: 睡眠前保存的链路状态, 唤醒后用于预测当前帧号和信道
+ */
+typedef struct {
+    uint8_t valid;
+    uint8_t hop_lane;           // 跳频车道 (USE_RF_COEXIST), 否则为 0
+    uint16_t frame_number;      // 最近一次收到信标的帧号
+    uint32_t network_key;       // 跳频表种子
+    uint32_t beacon_age_us;     // 保存时距该信标的时间
+    uint32_t rtc_cycles;        // 保存时刻 (hal_rtc_get_cycles)
+    int32_t drift_ppb;          // 时钟漂移估计
+    uint8_t frame_rate;         // 超帧速率档 (USE_RF_FRAME_RATE), 否则为 0
+    uint8_t roam_cell;          // 漫游小区号 (USE_RF_ROAMING), 否则为 0
+} __attribute__((packed)) rf_link_snapshot_t;
+
 /*============================================================================
  * Callback Types
  *============================================================================*/
@@ -300,6 +639,19 @@ typedef void (*rf_rx_data_callback_t)(uint8_t tracker_id, const rf_tracker_packe
 typedef void (*rf_rx_connect_callback_t)(uint8_t tracker_id, bool connected);
 typedef void (*rf_tx_sync_callback_t)(uint16_t frame_number);
 typedef void (*rf_tx_ack_callback_t)(uint8_t sequence, bool success);
+typedef void (*rf_tx_pre_tx_callback_t)(void);
+
+// v0.6.3: 分集转发 - 每个解码出的数据包一条, 主机按 (tracker, 序列号) 合并多个接收器
+typedef struct {
+    uint8_t tracker_id;
+    uint8_t sequence;
+    bool has_sequence;              // RF Ultra 单样本包无序列号, 主机改按帧号去重
+    int8_t rssi;
+    uint16_t frame;                 // 接收时的 RF 帧号 (主/副接收器一致)
+    int16_t quat[4];                // 包内最新样本 Q15
+} rf_forward_info_t;
+
+typedef void (*rf_rx_forward_callback_t)(const rf_forward_info_t *info);
 
 /*============================================================================
  * API Functions - Common
@@ -320,6 +672,161 @@ uint32_t rf_get_channel_freq(uint8_t channel);
  */
 uint8_t rf_get_hop_channel(uint16_t frame_number, uint32_t network_key);
 
+/**
+ * @brief v0.6.3: 重建预计算跳频表
+ *
+ * 表项 i = 从 rf_get_hop_channel(i) 开始第一个不在黑名单中的信道 (最多尝试
+ * RF_HOP_MAX_SKIP 次); 跳频序列周期为 RF_HOP_TABLE_SIZE 帧.
+ * 仅在网络密钥或黑名单变化时调用 (主循环上下文), 定时器中断只查表
+ *
+ * @param blacklist 信道位图 (bit = 信道号), 可为 NULL
+ * @param blacklist_len 位图字节数
+ */
+void rf_hop_table_build(uint32_t network_key, const uint8_t *blacklist,
+                        uint8_t blacklist_len);
+
+/**
+ * @brief v0.6.3: 查表获取帧对应信道, O(1), 可在中断中调用
+ */
+uint8_t rf_hop_table_get(uint16_t frame_number);
+
+/**
+ * @brief v0.6.3: 选择同步捕获的监听信道
+ *
+ * 在跳频表出现过的信道中, 选相邻两次出现间隔 (循环) 最大值最小的一个:
+ * 固定监听该信道时, 无论接收器处于哪一帧, 最多 max_gap 帧内必然收到信标
+ *
+ * @param exclude 排除信道位图 (已尝试过), 可为 NULL
+ * @param exclude_len 位图字节数
+ * @param max_gap 输出该信道的最大间隔 (帧), 可为 NULL
+ * @return 信道号, 0xFF = 没有可选信道
+ */
+uint8_t rf_hop_table_pick_listen(const uint8_t *exclude, uint8_t exclude_len,
+                                 uint16_t *max_gap);
+
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+#define RF_HOP_MAP_BITS             16      // 映射位数 = 跳频信道集大小
+
+/**
+ * @brief v0.6.3: 信道在跳频信道集中的下标 (每 tracker 映射的位号), 不在集内返回 -1
+ */
+int8_t rf_hop_channel_index(uint8_t channel);
+
+/**
+ * @brief v0.6.3: 跳频信道集第 index 个信道
+ */
+uint8_t rf_hop_channel_at(uint8_t index);
+
+/**
+ * @brief v0.6.3: tracker 本帧时隙使用的信道
+ *
+ * 帧信道不在 bad_mask 中时不变; 否则从随帧号和 tracker_id 错开的起点开始,
+ * 取信道集中第一个 rf_hw 可调谐且不在 bad_mask 中的信道 (两端计算结果相同).
+ * 没有可用信道时返回帧信道. 可在中断中调用
+ *
+ * @param bad_mask bit i = rf_hop_channel_at(i) 对该 tracker 不可用
+ */
+uint8_t rf_hop_remap(uint8_t channel, uint16_t frame_number, uint8_t tracker_id,
+                     uint16_t bad_mask);
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+#define RF_ROAM_CELL_SALT           0x85EBCA6B  // 小区跳频种子偏移
+
+/**
+ * @brief v0.6.3: 设置之后 rf_hop_table_build 使用的漫游小区 (0 = 与单接收器相同的序列)
+ */
+void rf_hop_table_set_cell(uint8_t cell);
+
+/**
+ * @brief v0.6.3: 当前设置的漫游小区
+ */
+uint8_t rf_hop_table_get_cell(void);
+
+/**
+ * @brief v0.6.3: 小区的跳频种子
+ */
+static inline uint32_t rf_roam_cell_key(uint32_t network_key, uint8_t cell)
+{
+    return network_key ^ ((uint32_t)cell * RF_ROAM_CELL_SALT);
+}
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+/**
+ * @brief v0.6.3: 速率档对应的超帧周期 (us)
+ */
+uint16_t rf_frame_rate_period(uint8_t rate);
+
+/**
+ * @brief v0.6.3: 本帧速率档
+ */
+uint8_t rf_frame_rate_get(void);
+
+/**
+ * @brief v0.6.3: 已通告切换, 尚未生效
+ */
+bool rf_frame_rate_pending(void);
+
+/**
+ * @brief v0.6.3: 通告切换 (接收器), frames 个帧边界之后的超帧按 rate 运行
+ */
+void rf_frame_rate_schedule(uint8_t rate, uint8_t frames);
+
+/**
+ * @brief v0.6.3: 帧边界推进 (接收器帧末 / tracker 预测下一帧), 可在中断中调用
+ *
+ * 调用前 RF_FRAME_US 为刚结束的超帧周期, 调用后为下一帧周期
+ *
+ * @return 周期发生变化
+ */
+bool rf_frame_rate_advance(void);
+
+/**
+ * @brief v0.6.3: 按收到的信标 frame_rate 字段同步 (tracker / 分集监听)
+ */
+void rf_frame_rate_sync(uint8_t field);
+
+/**
+ * @brief v0.6.3: 本帧信标的 frame_rate 字段
+ */
+uint8_t rf_frame_rate_field(void);
+#endif
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+/**
+ * @brief v0.6.3: 共存模式公共序列上车道 lane 的帧信道 (不含黑名单)
+ *
+ * 所有套件使用同一序列, 车道为信道集内的循环偏移: 帧号相同而车道不同时信道必然不同
+ */
+uint8_t rf_get_lane_channel(uint16_t frame_number, uint8_t lane);
+
+/**
+ * @brief v0.6.3: 设置之后 rf_hop_table_build 使用的车道 (RF_COEX_LANE_AUTO = 由密钥导出)
+ */
+void rf_hop_table_set_lane(uint8_t lane);
+
+/**
+ * @brief v0.6.3: 当前跳频表实际使用的车道
+ */
+uint8_t rf_hop_table_get_lane(void);
+
+/**
+ * @brief v0.6.3: 按车道 lane 单独计算一个表项 (与 rf_hop_table_build 的黑名单跳过一致),
+ *        用于换车道时跳频表重建前的过渡帧, 可在中断中调用
+ */
+uint8_t rf_hop_lane_entry(uint16_t frame_number, uint8_t lane,
+                          const uint8_t *blacklist, uint8_t blacklist_len);
+
+/**
+ * @brief v0.6.3: 信标中的网络标签 (密钥折叠为 16 位)
+ */
+static inline uint16_t rf_coex_net_tag(uint32_t network_key)
+{
+    return (uint16_t)(network_key ^ (network_key >> 16));
+}
+#endif
+
 /*============================================================================
  * API Functions - Receiver
  *============================================================================*/
@@ -334,6 +841,11 @@ int rf_receiver_init(rf_receiver_ctx_t *ctx);
  */
 int rf_receiver_start(rf_receiver_ctx_t *ctx);
 
+/**
+ * @brief v0.6.3: 黑名单 (channel_blacklist) 修改后调用, 重建跳频表
+ */
+void rf_receiver_update_hop_table(rf_receiver_ctx_t *ctx);
+
 /**
  * @brief Enter pairing mode
  */
@@ -345,16 +857,34 @@ int rf_receiver_start_pairing(rf_receiver_ctx_t *ctx);
 void rf_receiver_stop_pairing(rf_receiver_ctx_t *ctx);
 
 /**
- * @brief Process receiver (call from main loop or timer ISR)
+ * @brief Process receiver (call from main loop; decodes packets queued by the RX ISR)
  */
 void rf_receiver_process(rf_receiver_ctx_t *ctx);
 
 /**
- * @brief Send command to tracker
+ * @brief Queue command for tracker (delivered in the ACK of its next slot)
+ * @return 0 queued, -1 invalid, -2 tracker not connected, -3 queue full
  */
 int rf_receiver_send_command(rf_receiver_ctx_t *ctx, uint8_t tracker_id, 
                               rf_command_t cmd, uint8_t param);
 
+/**
+ * @brief Queue command ahead of the tracker's pending commands
+ */
+int rf_receiver_send_command_first(rf_receiver_ctx_t *ctx, uint8_t tracker_id,
+                                    rf_command_t cmd, uint8_t param);
+
+/**
+ * @brief Queue command for all connected trackers (delivered within one superframe)
+ * @return number of trackers queued
+ */
+int rf_receiver_broadcast_command(rf_receiver_ctx_t *ctx, rf_command_t cmd, uint8_t param);
+
+/**
+ * @brief Number of commands still waiting for delivery to a tracker
+ */
+uint8_t rf_receiver_command_pending(uint8_t tracker_id);
+
 /**
  * @brief Unpair specific tracker
  */
@@ -365,6 +895,64 @@ int rf_receiver_unpair(rf_receiver_ctx_t *ctx, uint8_t tracker_id);
  */
 void rf_receiver_unpair_all(rf_receiver_ctx_t *ctx);
 
+/**
+ * @brief v0.6.3: 恢复上电前保存的配对 (rf_receiver_init 之后, rf_receiver_start 之前调用)
+ * @note ctx->trackers[] 是接收器唯一的每 tracker 记录, 主程序的报告与诊断直接读取
+ */
+int rf_receiver_restore_pairing(rf_receiver_ctx_t *ctx, uint8_t tracker_id, const uint8_t mac[6]);
+
+/**
+ * @brief v0.6.3: 取出tracker时间线中的样本 (最旧在前, 取出后移除)
+ * @param out 输出缓冲
+ * @param max 最多取出数量
+ * @return 取出的样本数
+ */
+uint8_t rf_receiver_timeline_read(uint8_t tracker_id, rf_timeline_sample_t *out, uint8_t max);
+
+/**
+ * @brief v0.6.3: 中断 → 主循环包队列因满而丢弃的包数
+ * @note 包在中断中只入队, 由 rf_receiver_process() 解码; 主循环需及时调用
+ */
+uint32_t rf_receiver_get_rx_dropped(void);
+
+/**
+ * @brief v0.6.3: 取帧结束事件 (超帧最后一个时隙结束时在定时器中断中产生)
+ * @param frame 输出最近完成的帧号 (无新事件时也会写入)
+ * @return 自上次调用以来完成的帧数, 0 = 无新事件
+ * @note 最后一个时隙的包可能刚入队, 组装报告前应先调用 rf_receiver_process()
+ */
+uint8_t rf_receiver_frame_event(uint16_t *frame);
+
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+/**
+ * @brief v0.6.3: 读取当前超帧号/起点与接收器时钟 (同一临界区内读取, 三者一致)
+ */
+void rf_receiver_get_time_base(rf_time_base_t *out);
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/**
+ * @brief v0.6.3: 取双姿态包中最新的辅助 IMU 姿态 (Q15 w,x,y,z)
+ * @return false 自上次读取后无新值
+ */
+bool rf_receiver_take_aux_quat(uint8_t tracker_id, int16_t quat[4]);
+#endif
+
+/**
+ * @brief v0.6.3: 读取 tracker 链路统计
+ * @return false ID 无效
+ */
+bool rf_receiver_get_link_stats(uint8_t tracker_id, rf_link_stats_t *out);
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+/**
+ * @brief v0.6.3: 设置tracker主时隙速率
+ * @param rate_div 1 = 200Hz, 2 = 100Hz, 4 = 50Hz
+ * @return 0 = ok, -1 = 参数错误
+ */
+int rf_receiver_set_tracker_rate(rf_receiver_ctx_t *ctx, uint8_t tracker_id, uint8_t rate_div);
+#endif
+
 /**
  * @brief Set data callback
  */
@@ -375,6 +963,46 @@ void rf_receiver_set_data_callback(rf_rx_data_callback_t cb);
  */
 void rf_receiver_set_connect_callback(rf_rx_connect_callback_t cb);
 
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+/**
+ * @brief v0.6.3: 让所有 tracker 进入/退出组休眠 (主循环调用)
+ *
+ * 进入: 先以正常速率广播休眠信标, 之后每 GROUP_SLEEP_INTERVAL 帧一个信标, 不开数据时隙.
+ * 退出: 下一帧起恢复每帧信标, tracker 在下一个休眠信标帧收到后恢复发送
+ */
+void rf_receiver_set_group_sleep(rf_receiver_ctx_t *ctx, bool sleep);
+
+bool rf_receiver_group_sleeping(void);
+#endif
+
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+/**
+ * @brief v0.6.3: 作为分集副接收器启动 (与主接收器共用 network_key)
+ *
+ * 关闭自动 ACK, 不发信标; 停在必经信道上等主接收器信标, 之后按信标
+ * channel_map / 跳频表逐帧跟随并收下所有时隙的包. 活跃 tracker 取自信标
+ */
+int rf_receiver_start_listener(rf_receiver_ctx_t *ctx);
+
+/**
+ * @brief 副接收器是否已跟上主接收器帧时序
+ */
+bool rf_receiver_listener_locked(void);
+
+/**
+ * @brief 设置转发回调 (主循环解码上下文中调用, NULL = 关闭)
+ */
+void rf_receiver_set_forward_callback(rf_rx_forward_callback_t cb);
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+/**
+ * @brief v0.6.3: 设置本接收器在漫游组中的小区号, 下次 rf_receiver_start 起生效
+ * @return 0 = ok, -1 = 参数错误
+ */
+int rf_receiver_set_roam_cell(rf_receiver_ctx_t *ctx, uint8_t cell);
+#endif
+
 /*============================================================================
  * API Functions - Transmitter
  *============================================================================*/
@@ -396,6 +1024,8 @@ int rf_transmitter_request_pairing(rf_transmitter_ctx_t *ctx);
 
 /**
  * @brief Update sensor data
+ * @param accel v0.6.3: 机体系原始加速度 (g, 含重力); 重力在组包时由四元数去除,
+ *              只对实际发送的样本计算
  */
 void rf_transmitter_set_data(rf_transmitter_ctx_t *ctx,
                               const float quat[4],
@@ -403,6 +1033,21 @@ void rf_transmitter_set_data(rf_transmitter_ctx_t *ctx,
                               uint8_t battery,
                               uint8_t flags);
 
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+/**
+ * @brief v0.6.3: 设置当前姿态对应的 IMU 样本时刻, 组包时换算为样本年龄
+ */
+void rf_transmitter_set_sample_time(rf_transmitter_ctx_t *ctx, uint32_t sample_us);
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/**
+ * @brief v0.6.3: 设置辅助 IMU 姿态 (quat 为 NULL 时清除, 恢复单姿态包)
+ * @param sample_us 对应的 IMU 样本时刻 (rf_hw 时钟)
+ */
+void rf_transmitter_set_aux(rf_transmitter_ctx_t *ctx, const float quat[4], uint32_t sample_us);
+#endif
+
 /**
  * @brief Process transmitter (call from main loop or timer ISR)
  */
@@ -418,6 +1063,31 @@ void rf_transmitter_sleep(rf_transmitter_ctx_t *ctx);
  */
 void rf_transmitter_wake(rf_transmitter_ctx_t *ctx);
 
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+/**
+ * @brief v0.6.3: Receiver has put the kit into group sleep (no data TX,
+ *        listening only on doze beacon frames)
+ */
+bool rf_transmitter_group_dozing(void);
+#endif
+
+/**
+ * @brief v0.6.3: Snapshot link state before sleep (USE_RF_FAST_REJOIN)
+ * @return false if no beacon has been received since pairing
+ */
+bool rf_transmitter_get_link(const rf_transmitter_ctx_t *ctx, rf_link_snapshot_t *link);
+
+/**
+ * @brief v0.6.3: Rejoin from a snapshot after sleep (call after start/wake)
+ *
+ * Predicts the current frame from the RTC time slept and parks the receiver
+ * on the hop channel of a frame whose beacon cannot have passed yet;
+ * falls back to normal searching when the prediction window expires.
+ *
+ * @return 0 on success, negative if the snapshot is unusable (normal search)
+ */
+int rf_transmitter_resume_link(rf_transmitter_ctx_t *ctx, const rf_link_snapshot_t *link);
+
 /**
  * @brief Set sync callback
  */
@@ -428,6 +1098,28 @@ void rf_transmitter_set_sync_callback(rf_tx_sync_callback_t cb);
  */
 void rf_transmitter_set_ack_callback(rf_tx_ack_callback_t cb);
 
+/**
+ * @brief v0.6.3: Offset of this tracker's primary slot from the sync beacon (us)
+ * @note Valid after the first slot calculation in TX_STATE_RUNNING
+ */
+uint32_t rf_transmitter_get_slot_offset_us(void);
+
+/**
+ * @brief v0.6.3: Selective-repeat statistics (USE_RF_SELECTIVE_REPEAT)
+ * @param recovered Packets acknowledged after a spare-slot retransmission (may be NULL)
+ * @param expired Packets dropped past RF_RETX_DEADLINE_US (may be NULL)
+ */
+void rf_transmitter_get_retx_stats(uint32_t *recovered, uint32_t *expired);
+
+/**
+ * @brief v0.6.3: Set pre-TX callback (USE_JIT_SAMPLING)
+ *
+ * Called JIT_SAMPLE_LEAD_US before this tracker's slot, from inside
+ * rf_transmitter_process(). The callback should read the IMU, run fusion and
+ * call rf_transmitter_set_data(). Skipped when less than half the lead remains.
+ */
+void rf_transmitter_set_pre_tx_callback(rf_tx_pre_tx_callback_t cb);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,16 @@
  * - miss_sync分级恢复
  * - slot越界检测与abort
  * - 超时分级处理
+ *
+ * v0.6.3 (USE_RF_RECOVERY_COST): 固定门限改为按实测代价选择动作
+ * - 每种动作记录尝试/成功次数, 成功率和成功时的恢复耗时按 EWMA 更新
+ *   (初值使没有历史时的升级顺序与原固定门限相同)
+ * - 连续丢失达到某动作的最小门限后该动作才可选; 可选动作按 成功率 / 预期耗时 排序,
+ *   预期耗时 = 成功率 x 平均恢复耗时 + (1 - 成功率) x 耗时预算
+ * - 当前动作在耗时预算 (平均恢复耗时的 2 倍, 有上下限) 内不升级; 超出预算或出现
+ *   排序更靠前的可选动作时记一次失败, 换下一个; 一次失步中每种动作只试一次
+ * - RECOVERY_HOP_PREDICT: 按预测帧时序和跳频表继续接收, 只在调用者报告漂移估计
+ *   可信 (rf_recovery_set_drift_known) 时可选, 第一次丢失即可进入
  */
 
 #ifndef RF_RECOVERY_H
@@ -13,6 +23,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "config.h"
 
 /*============================================================================
  * 配置
@@ -34,6 +45,10 @@
 #define TIMEOUT_LEVEL3_MS           100     // 100ms: 硬超时，复位RF
 #define TIMEOUT_LEVEL4_MS           500     // 500ms: 严重超时，重新配对
 
+// v0.6.3: 跳频预测最多持续的连续丢失数 (须小于 tracker 的 SYNC_LOST_THRESHOLD,
+// 让放弃预测的决定留在本模块, 失败能被记录)
+#define RECOVERY_PREDICT_MAX_MISS   8
+
 /*============================================================================
  * 恢复状态
  *============================================================================*/
@@ -45,8 +60,20 @@ typedef enum {
     RECOVERY_FULL_SCAN,         // 全信道扫描
     RECOVERY_DEEP_SEARCH,       // 深度搜索
     RECOVERY_ABORT,             // 中止当前操作
+    RECOVERY_HOP_PREDICT,       // v0.6.3: 按预测时序/跳频表继续接收
+    RECOVERY_ACTION_COUNT
 } recovery_action_t;
 
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+// v0.6.3: 单个动作的历史
+typedef struct {
+    uint16_t attempts;
+    uint16_t successes;
+    uint16_t p_q8;              // 成功率 EWMA (Q8, 256 = 100%)
+    uint16_t avg_ms;            // 成功时的恢复耗时 EWMA
+} recovery_action_stats_t;
+#endif
+
 typedef struct {
     // 计数器
     uint32_t miss_sync_count;
@@ -69,6 +96,13 @@ typedef struct {
     // slot监控
     uint32_t slot_start_us;
     uint8_t slot_overrun_consecutive;
+    
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+    // v0.6.3: 按代价选择
+    recovery_action_stats_t action_stats[RECOVERY_ACTION_COUNT];
+    uint8_t tried_mask;         // 本次失步已试过的动作 (按 recovery_action_t 位)
+    bool drift_known;
+#endif
 } rf_recovery_state_t;
 
 /*============================================================================
@@ -88,9 +122,24 @@ recovery_action_t rf_recovery_report_miss_sync(rf_recovery_state_t *state);
 
 /**
  * @brief 报告sync成功
+ * @note v0.6.3: USE_RF_RECOVERY_COST 下把恢复耗时计入当前动作
  */
 void rf_recovery_report_sync_ok(rf_recovery_state_t *state);
 
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+/**
+ * @brief v0.6.3: 漂移估计是否可信 (决定 RECOVERY_HOP_PREDICT 是否可选)
+ */
+void rf_recovery_set_drift_known(rf_recovery_state_t *state, bool known);
+
+/**
+ * @brief v0.6.3: 读取某个动作的历史
+ * @return 0成功, -1参数错误
+ */
+int rf_recovery_get_action_stats(const rf_recovery_state_t *state, recovery_action_t action,
+                                 recovery_action_stats_t *out);
+#endif
+
 /**
  * @brief 检查slot是否越界
  * @param slot_id slot编号
@@ -48,6 +48,14 @@ typedef struct {
     uint8_t len;
 } batch_item_t;
 
+/**
+ * v0.6.3: 命令下发通道 (接收器注册, 接到 rf_receiver 的每 tracker 命令队列)
+ * @param first true = 插到该 tracker 待发命令之前
+ * @return 0 成功
+ */
+typedef int (*slot_optimizer_cmd_sink_t)(uint8_t tracker_id, uint8_t cmd,
+                                         uint8_t param, bool first);
+
 /*============================================================================
  * API 函数
  *============================================================================*/
@@ -102,13 +110,25 @@ bool slot_optimizer_frame_time_available(void);
  */
 void slot_optimizer_get_stats(slot_optimizer_stats_t *stats);
 
+/**
+ * @brief 注册命令下发通道 (NULL = 直接发射 data)
+ */
+void slot_optimizer_set_command_sink(slot_optimizer_cmd_sink_t sink);
+
 /**
  * @brief 快速传输 (跳过队列)
+ *
+ * 注册了命令通道时 data = [命令, 参数], 插到该 tracker 待发命令之前
  */
 int slot_optimizer_fast_transmit(uint8_t tracker_id, const uint8_t *data, uint8_t len);
 
 /**
  * @brief 批量传输
+ *
+ * 注册了命令通道时每项 data = [命令, 参数] (len 1 时参数为 0), 按优先级入各 tracker
+ * 的命令队列, 每个 tracker 在下一超帧自己的时隙 ACK 中收到; 同一 tracker 的
+ * 多项按顺序在后续超帧送达
+ * @return 成功入队/发射的项数, -1 参数错误
  */
 int slot_optimizer_batch_transmit(batch_item_t *items, uint8_t count);
 
@@ -36,6 +36,12 @@ void rf_timing_init(void);
  */
 void rf_timing_on_sync(uint32_t rx_time_us, uint16_t frame_num, uint8_t channel);
 
+/**
+ * @brief v0.6.3: 未收到信标的帧发生超帧速率切换 - 时隙预测改以预测的帧起点为基准
+ * @note 只移动基准, 不计入同步次数, 不影响漂移基线
+ */
+void rf_timing_rebase(uint32_t frame_start_us);
+
 /**
  * @brief 时隙反馈
  * @param success 是否成功
@@ -50,11 +56,27 @@ void rf_timing_slot_feedback(bool success, int32_t offset_us);
  */
 void rf_timing_set_slot(uint8_t slot, uint8_t total);
 
+/**
+ * @brief v0.6.3: 设置时隙宽度 (默认 RF_SLOT_US, 自适应保护时间时取自信标)
+ */
+void rf_timing_set_slot_width(uint16_t width_us);
+
+/**
+ * @brief 计算补偿后的时隙开始时刻 (已过则顺延到下一帧)
+ */
+uint32_t rf_timing_get_slot_time(void);
+
 /**
  * @brief 等待时隙开始
  */
 void rf_timing_wait_slot(void);
 
+/**
+ * @brief v0.6.3: 等待到指定时刻 (回绕安全)
+ * @param target_us 目标时刻, 通常为 rf_timing_get_slot_time() 的返回值
+ */
+void rf_timing_wait_until(uint32_t target_us);
+
 /**
  * @brief 预备信道切换
  * @param channel 目标信道
@@ -65,7 +87,39 @@ void rf_timing_prepare_channel(uint8_t channel);
  * @brief 获取统计信息
  */
 void rf_timing_get_stats(uint32_t *sync, uint32_t *miss, 
-                         uint32_t *avg_latency, uint32_t *max_latency);
+                         uint32_t *avg_latency, uint32_t *max_latency,
+                         int32_t *drift_ppb);
+
+/**
+ * @brief v0.6.3: 本地时钟相对接收器的漂移估计
+ * @return ppb, 正值表示本地时钟偏快; 同步后约 1s 才有第一次估计
+ */
+int32_t rf_timing_get_drift_ppb(void);
+
+/**
+ * @brief v0.6.3: 信标监听间隔
+ *
+ * 漂移估计连续几个基线稳定、且时隙 ACK 正常时返回 >1,
+ * tracker 每 N 帧只监听一次信标, 其余帧按漂移估计自由运行
+ *
+ * @return 1..RF_BEACON_SKIP_MAX (1 = 每帧监听)
+ */
+uint8_t rf_timing_get_beacon_interval(void);
+
+/**
+ * @brief v0.6.3: 睡眠唤醒后恢复漂移估计 (重新同步前即可补偿)
+ * @note 恢复的估计不计入稳定基线, 需新的基线确认后才允许跳听信标
+ */
+void rf_timing_set_drift_ppb(int32_t drift_ppb);
+
+/**
+ * @brief v0.6.3: 距下一次 RF 活动 (本 tracker 时隙或信标) 的空闲时间
+ *
+ * 用作 hal_storage 后台写入的窗口回调, Flash 擦写只安排在时隙之间
+ *
+ * @return 微秒, 0 = 时隙进行中; 未同步时返回 UINT32_MAX
+ */
+uint32_t rf_timing_get_idle_us(void);
 
 /**
  * @brief 检查是否已同步
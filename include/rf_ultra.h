@@ -172,6 +172,384 @@ uint8_t rf_ultra_rx_get_active_count(void);
  */
 void rf_ultra_to_slimevr_packet(const rf_ultra_parsed_t *in, uint8_t *out);
 
+/*============================================================================
+ * v0.6.3: Multi-Sample Aggregate Packets (rf_ultra_v2.c)
+ * 
+ * 一个时隙内上传 1-4 个带子帧时间戳的姿态样本, 服务器端可获得
+ * 高于 200Hz 超帧的姿态率而不增加射频唤醒次数
+ * 
+ * 包格式 (11 + 5*N 字节, N=4 时 31 字节 <= RF_MAX_PAYLOAD_SIZE):
+ * [0]      RF_MULTI_HEADER | N
+ * [1]      tracker_id
+ * [2]      sequence
+ * [3]      bit0-2: delta 移位, bit3: 重传 (年龄单位 RF_MULTI_RETX_TICK_US),
+ *          bit4-5: 状态旁路 (USE_RF_SIDEBAND), bit6-7: 基准样本被丢弃分量
+ * [4]      battery
+ * [5]      flags
+ * [6-7]    accel_z_mg (LE)
+ * [8-13]   基准样本 (最旧) smallest-three, 3x int16 Q14 (LE)
+ * [14..]   N 字节样本年龄 (距发送时刻, RF_MULTI_TICK_US 单位)
+ * [..]     (N-1) x 4 字节 int8 增量 [w,x,y,z] << 移位 (相对上一样本, 闭环量化)
+ * [last]   CRC8
+ *============================================================================*/
+
+#define RF_MULTI_HEADER         0xE0
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#define RF_MULTI_MAX_SAMPLES    3       // 26 字节 + MIC
+#else
+#define RF_MULTI_MAX_SAMPLES    4
+#endif
+#define RF_MULTI_TICK_US        20      // 年龄分辨率, 最大 255*20 = 5.1ms
+#define RF_MULTI_RETX_TICK_US   80      // 重传包年龄分辨率, 最大 20.4ms
+#define RF_MULTI_PACKET_SIZE(n) (11 + 5 * (n))
+
+typedef struct {
+    uint8_t  tracker_id;
+    uint8_t  sequence;
+    uint8_t  count;                             // 样本数 (1-4), 最旧在前
+    uint8_t  battery_pct;
+    uint8_t  flags;
+    int16_t  accel_z_mg;
+    bool     delta;                             // 增量包 (无电池/标志)
+    uint8_t  ref_sequence;                      // 增量包参考序号
+    uint8_t  sideband;                          // v0.6.3: 状态旁路 2 位 (USE_RF_SIDEBAND)
+    q15_t    quat[RF_MULTI_MAX_SAMPLES][4];     // [w,x,y,z]
+    uint16_t age_us[RF_MULTI_MAX_SAMPLES];      // 距发送时刻
+} rf_multi_parsed_t;
+
+/**
+ * @brief 缓存一个待发送的姿态样本 (满时丢弃最旧样本)
+ * @param quat Quaternion in Q15 format
+ * @param t_us 样本时刻 (hal_micros)
+ */
+void rf_multi_push_sample(const q15_t quat[4], uint32_t t_us);
+
+/**
+ * @brief 已缓存的样本数
+ */
+uint8_t rf_multi_pending(void);
+
+/**
+ * @brief 丢弃缓存样本 (改发其他格式时, 避免之后发出过期样本)
+ */
+void rf_multi_clear(void);
+
+/**
+ * @brief 构建多样本聚合包并清空缓存
+ * @param now_us 发送时刻 (hal_micros), 用于计算样本年龄
+ * @return 包长度, 0 = 无缓存样本
+ */
+int rf_multi_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                          int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                          uint32_t now_us);
+
+/**
+ * @brief v0.6.3: 重传前更新样本年龄 (年龄加上 delay_us, 改用重传分辨率)
+ * @param delay_us 距上次构建/发送该包经过的时间
+ * @return 0 成功, -1 非多样本包, -2 最旧样本年龄超出可表示范围 (应放弃重传)
+ */
+int rf_multi_restamp_packet(uint8_t *pkt, uint8_t len, uint32_t delay_us);
+
+/**
+ * @brief 判断是否为多样本聚合包 (仅检查头和长度)
+ */
+bool rf_multi_is_packet(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 解析多样本聚合包
+ * @return true if valid, false if length/CRC error
+ */
+bool rf_multi_parse_packet(const uint8_t *pkt, uint8_t len, rf_multi_parsed_t *out);
+
+/*============================================================================
+ * v0.6.3: Delta Stream (rf_ultra_v2.c, USE_RF_DELTA_STREAM)
+ * 
+ * 关键帧为多样本聚合包, 之间的包只带相对参考包的增量:
+ * 参考 = 序号最新且已被硬件 ACK 的包, 取其最后一个样本的重建值
+ * 
+ * 包格式 (8 + 5*N 字节):
+ * [0]      RF_DELTA_HEADER | N
+ * [1]      tracker_id
+ * [2]      sequence
+ * [3]      参考包 sequence
+ * [4]      bit0-2: delta 移位, bit3: 重传, bit4-5: 状态旁路
+ * [5-6]    accel_z_mg (LE)
+ * [7..]    N 字节样本年龄
+ * [..]     N x 4 字节 int8 增量 (第一个相对参考, 之后相对上一样本)
+ * [last]   CRC8
+ * 
+ * 接收端按 sequence 保存最近 RF_DELTA_HISTORY 个包的最后样本;
+ * 参考不在历史中 (接收端重启/丢失关键帧) 时丢弃, 等下一个关键帧
+ *============================================================================*/
+
+#define RF_DELTA_HEADER         0xD0
+#define RF_DELTA_HISTORY        4       // 参考深度 (2 的幂), 两端一致
+#define RF_DELTA_PACKET_SIZE(n) (8 + 5 * (n))
+
+/**
+ * @brief 清除参考和历史, 下一个包为关键帧 (重新同步/配对后调用)
+ */
+void rf_delta_reset(void);
+
+/**
+ * @brief 构建关键帧或增量包并清空缓存
+ * @return 包长度, 0 = 无缓存样本
+ */
+int rf_delta_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                          int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                          uint32_t now_us);
+
+/**
+ * @brief 收到 ACK: 该包成为新的参考 (仅当序号更新)
+ * @param pkt 被确认的包 (关键帧或增量包)
+ */
+void rf_delta_on_ack(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 判断是否为增量包 (仅检查头和长度)
+ */
+bool rf_delta_is_packet(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 读出 tracker_id / 序号 / 参考序号, 用于查找参考样本
+ */
+bool rf_delta_peek(const uint8_t *pkt, uint8_t len, uint8_t *tracker_id,
+                   uint8_t *sequence, uint8_t *ref_sequence);
+
+/**
+ * @brief 解析增量包
+ * @param ref 参考包最后一个样本的重建值
+ * @return true if valid, false if length/CRC error
+ */
+bool rf_delta_parse_packet(const uint8_t *pkt, uint8_t len, const q15_t ref[4],
+                           rf_multi_parsed_t *out);
+
+/*============================================================================
+ * v0.6.3: Status Sideband (rf_ultra_v2.c, USE_RF_SIDEBAND)
+ * 
+ * 慢变化的状态 (电池电压/温度/固件版本/IMU 型号) 不占单独的数据时隙,
+ * 由每个多样本/增量包标志字节的 bit4-5 轮流携带, 按 sequence 归位:
+ *   窗口 = sequence >> 4 (16 个包, 32 位), 包内位置 = sequence & 15
+ *   每窗口一个字: [字段 ID] [值 LE16] [CRC8(前 3 字节)], 字段按窗口号轮转
+ * 接收端窗口内 16 个包都收到且 CRC 通过时得到一个字段; 丢包只损失该窗口,
+ * 一轮后重发. 200Hz 下一个字段 80ms, 全部字段一轮约 0.3s
+ *============================================================================*/
+
+#define RF_SB_FIELD_BATTERY_MV  0       // 电池电压 mV
+#define RF_SB_FIELD_TEMP        1       // IMU 温度 0.01°C (int16)
+#define RF_SB_FIELD_FW_VERSION  2       // 固件版本 major << 8 | minor
+#define RF_SB_FIELD_IMU_TYPE    3       // IMU 型号 (imu_interface.h IMU_*)
+#define RF_SB_FIELD_COUNT       4
+
+typedef struct {
+    uint32_t word;                      // 已归位的位
+    uint16_t mask;                      // 已收到的包位置
+    uint8_t  window;
+} rf_sideband_rx_t;
+
+/**
+ * @brief 设置要发送的字段值 (tracker, 新值从下一个窗口开始生效)
+ */
+void rf_sideband_set(uint8_t field, uint16_t value);
+
+/**
+ * @brief 接收端送入一个包的旁路位 (重复/重传包可重复送入)
+ * @param rx 该 tracker 的拼装状态
+ * @return true 拼出一个完整字段, 写入 field / value
+ */
+bool rf_sideband_feed(rf_sideband_rx_t *rx, uint8_t sequence, uint8_t bits,
+                      uint8_t *field, uint16_t *value);
+
+/*============================================================================
+ * v0.6.3: FEC Packets (rf_ultra_v2.c, USE_RF_FEC)
+ * 
+ * 把一个内层包 (RF Ultra 12 字节) 的每个半字节编码成扩展汉明码 (8,4),
+ * 接收端可纠正每个码字内的 1 位错误, 再由内层 CRC8 校验:
+ * 
+ * [0]      RF_FEC_HEADER | 内层长度 (由包长唯一确定, 允许 1 位错误)
+ * [1..]    2 x 内层长度 字节码字 (先低半字节)
+ * 
+ * 空口长度约翻倍, 只在接收端统计到持续误码时由 ACK 命令开启
+ *============================================================================*/
+
+#define RF_FEC_HEADER           0xC0
+#define RF_FEC_MAX_INNER        15
+#define RF_FEC_PACKET_SIZE(n)   (1 + 2 * (n))
+
+/**
+ * @brief 编码
+ * @return 包长度, -1 = 内层长度超出 RF_FEC_MAX_INNER
+ */
+int rf_fec_encode(uint8_t *out, const uint8_t *in, uint8_t len);
+
+/**
+ * @brief 判断是否为 FEC 包 (仅检查头和长度)
+ */
+bool rf_fec_is_packet(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 解码内层包
+ * @param corrected 可为 NULL, 返回纠正的比特数
+ * @return 内层长度, -1 非 FEC 包, -2 存在不可纠正的码字
+ */
+int rf_fec_decode(const uint8_t *pkt, uint8_t len, uint8_t *out, uint8_t *corrected);
+
+/*============================================================================
+ * v0.6.3: Raw IMU Packets (rf_ultra_v2.c, USE_FUSION_OFFLOAD)
+ * 
+ * 融合卸载: tracker 上传已校准 (温补 + 去偏置) 的原始陀螺/加速度样本,
+ * 由接收器运行融合; 样本按 RF_RAW_ODR_HZ 等间隔, 用 8 位样本序号代替逐样本年龄
+ * 
+ * 包格式 (15 + 6*N 字节, N=2 时 27 字节):
+ * [0]      RF_RAW_HEADER | N
+ * [1]      tracker_id
+ * [2]      sequence
+ * [3]      最新样本序号 (样本 i 的序号 = [3] - (N-1-i))
+ * [4]      最新样本年龄 (距发送时刻, RF_MULTI_TICK_US 单位)
+ * [5]      battery
+ * [6]      flags
+ * [7]      bit0-3: 陀螺增量移位, bit4-7: 加速度增量移位
+ * [8-19]   基准样本 (最旧) gyro[3] mrad/s, accel[3] mg, int16 (LE)
+ * [20..]   (N-1) x 6 字节 int8 增量 (相对上一样本, 闭环量化)
+ * [last]   CRC8
+ * 
+ * 每个包都带最近 N 个样本, 单个丢包由下一个包补齐; 接收端按样本序号去重
+ *============================================================================*/
+
+#define RF_RAW_HEADER           0xB0
+#define RF_RAW_MAX_SAMPLES      2
+#define RF_RAW_ODR_HZ           200     // 样本率, 与 tracker SENSOR_ODR_HZ 一致
+#define RF_RAW_PERIOD_US        (1000000 / RF_RAW_ODR_HZ)
+#define RF_RAW_PACKET_SIZE(n)   (15 + 6 * (n))
+
+typedef struct {
+    uint8_t  tracker_id;
+    uint8_t  sequence;
+    uint8_t  count;                             // 样本数 (1-2), 最旧在前
+    uint8_t  index;                             // 最新样本序号
+    uint16_t age_us;                            // 最新样本距发送时刻
+    uint8_t  battery_pct;
+    uint8_t  flags;
+    int16_t  gyro[RF_RAW_MAX_SAMPLES][3];       // mrad/s
+    int16_t  accel[RF_RAW_MAX_SAMPLES][3];      // mg
+} rf_raw_parsed_t;
+
+/**
+ * @brief 缓存一个已校准样本 (只保留最近 RF_RAW_MAX_SAMPLES 个)
+ * @param gyro rad/s
+ * @param accel g
+ * @param t_us 样本时刻 (hal_micros)
+ */
+void rf_raw_push_sample(const float gyro[3], const float accel[3], uint32_t t_us);
+
+/**
+ * @brief 已缓存的样本数 (发送后不清空, 下一个包仍带上最近样本)
+ */
+uint8_t rf_raw_pending(void);
+
+/**
+ * @brief 清空缓存并重新从序号 0 开始 (重新配对后调用)
+ */
+void rf_raw_reset(void);
+
+/**
+ * @brief 构建原始样本包
+ * @param now_us 发送时刻, 用于计算最新样本年龄
+ * @return 包长度, 0 = 无缓存样本
+ */
+int rf_raw_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                        uint8_t battery_pct, uint8_t flags, uint32_t now_us);
+
+/**
+ * @brief 判断是否为原始样本包 (仅检查头和长度)
+ */
+bool rf_raw_is_packet(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 解析原始样本包
+ * @return true if valid, false if length/CRC error
+ */
+bool rf_raw_parse_packet(const uint8_t *pkt, uint8_t len, rf_raw_parsed_t *out);
+
+/*============================================================================
+ * v0.6.3: Dual IMU Packets (rf_ultra_v2.c, USE_AUX_IMU)
+ * 
+ * 主 IMU 和辅助 IMU 的姿态合在一个包里, 共用头/电池/标志:
+ * 
+ * 包格式 (20 字节):
+ * [0]      RF_DUAL_HEADER
+ * [1]      tracker_id
+ * [2]      sequence
+ * [3]      battery
+ * [4]      flags
+ * [5-6]    accel_z_mg (主 IMU, LE)
+ * [7]      主 IMU 样本年龄 (距发送时刻, RF_MULTI_TICK_US 单位)
+ * [8-12]   主 IMU 四元数 (40-bit smallest-three)
+ * [13]     辅助 IMU 样本年龄
+ * [14-18]  辅助 IMU 四元数
+ * [19]     CRC8
+ *============================================================================*/
+
+#define RF_DUAL_HEADER          0xA0
+#define RF_DUAL_PACKET_SIZE     20
+
+typedef struct {
+    uint8_t  tracker_id;
+    uint8_t  sequence;
+    uint8_t  battery_pct;
+    uint8_t  flags;
+    int16_t  accel_z_mg;
+    q15_t    quat[2][4];                        // [主, 辅助][w,x,y,z]
+    uint16_t age_us[2];                         // 距发送时刻
+} rf_dual_parsed_t;
+
+/**
+ * @brief 构建双姿态包
+ * @param sample_us 两个姿态对应的样本时刻 (hal_micros), [0] 主 IMU, [1] 辅助 IMU
+ * @param now_us 发送时刻, 用于计算样本年龄
+ * @return 包长度
+ */
+int rf_dual_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                         const q15_t quat[4], const q15_t aux_quat[4],
+                         int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                         const uint32_t sample_us[2], uint32_t now_us);
+
+/**
+ * @brief 判断是否为双姿态包 (仅检查头和长度)
+ */
+bool rf_dual_is_packet(const uint8_t *pkt, uint8_t len);
+
+/**
+ * @brief 解析双姿态包
+ * @return true if valid, false if length/CRC error
+ */
+bool rf_dual_parse_packet(const uint8_t *pkt, uint8_t len, rf_dual_parsed_t *out);
+
+/*============================================================================
+ * v0.6.3: 40-bit smallest-three 四元数 (USB bundle 报告)
+ * 
+ * 3 个 12-bit 分量 + 2-bit 丢弃索引, 最坏误差约 0.08°
+ * out[4] 的 bit6-7 保留给调用方作标志位
+ *============================================================================*/
+
+#define RF_QUAT40_SIZE          5
+
+void rf_v2_quat_pack40(const q15_t q[4], uint8_t out[RF_QUAT40_SIZE]);
+void rf_v2_quat_unpack40(const uint8_t in[RF_QUAT40_SIZE], q15_t q[4]);
+
+#if defined(BUILD_BENCH) || defined(BUILD_HOST)
+/*============================================================================
+ * v0.6.3: 编解码基准入口 (codec_bench.c), 直接调用内部压缩函数
+ *============================================================================*/
+
+void rf_ultra_bench_compress(const float q[4], int16_t out[4]);
+void rf_ultra_bench_compress_q15(const q15_t q[4], int16_t out[4]);
+
+// abc: 3 个保留分量 Q14, dropped: 被丢弃分量索引
+void rf_v2_bench_st_compress(const q15_t q[4], int16_t abc[3], uint8_t *dropped);
+void rf_v2_bench_st_decompress(const int16_t abc[3], uint8_t dropped, q15_t q[4]);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,74 @@
+/**
+ * @file rx_fusion.h
+ * @brief 接收端传感器融合 / Receiver-side sensor fusion (USE_FUSION_OFFLOAD)
+ *
+ * v0.6.3: 融合卸载模式下 tracker 只上传已校准的原始陀螺/加速度样本,
+ * 接收器为每个 tracker 运行一个 Q30 定点 VQF 实例 (vqf_fixed, 纯整数更新)
+ *
+ * - 解码时样本按序号去重后进入每 tracker 的小 FIFO, 不在解码路径上融合
+ * - rx_fusion_process 在主循环中轮转各 tracker, 每次最多执行 budget 次更新,
+ *   单个 tracker 的积压不会拖住其他 tracker 和 USB
+ * - 序号跳变 (连续丢包超过包内冗余) 时用新样本补足缺失的步数 (零阶保持),
+ *   最多 RX_FUSION_MAX_HOLD 步
+ */
+
+#ifndef __RX_FUSION_H__
+#define __RX_FUSION_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RX_FUSION_FIFO          4       // 每 tracker 待融合样本 (2 的幂)
+#define RX_FUSION_MAX_HOLD      8       // 序号跳变时最多补足的步数
+#define RX_FUSION_TAU_ACC       3.0f    // 加速度时间常数 (s), 与 tracker 端一致
+
+/**
+ * @brief 融合输出回调 (主循环上下文)
+ * @param quat 四元数 [w,x,y,z] Q15
+ * @param t_us 样本时刻 (接收器时钟)
+ */
+typedef void (*rx_fusion_output_cb_t)(uint8_t id, const int16_t quat[4], uint32_t t_us);
+
+typedef struct {
+    uint32_t updates;       // 融合更新次数 (含补足步数)
+    uint32_t held;          // 序号跳变补足的步数
+    uint32_t duplicate;     // 重复样本 (包内冗余)
+    uint32_t overflow;      // FIFO 满丢弃的样本
+} rx_fusion_stats_t;
+
+void rx_fusion_init(void);
+
+/**
+ * @brief 清除单个 tracker 的融合状态 (解除配对), 下一个样本重新初始化
+ */
+void rx_fusion_reset(uint8_t id);
+
+/**
+ * @brief 输入一个样本 (解码路径)
+ * @param index 8 位样本序号
+ * @param gyro mrad/s
+ * @param accel mg
+ * @param t_us 样本时刻 (接收器时钟)
+ * @return 0 已入队, 1 重复样本, -1 FIFO 满, -2 参数错误
+ */
+int rx_fusion_push(uint8_t id, uint8_t index, const int16_t gyro[3],
+                   const int16_t accel[3], uint32_t t_us);
+
+/**
+ * @brief 轮转执行待融合样本 (主循环)
+ * @param budget 本次最多执行的更新次数 (补足步数计入)
+ * @return 实际执行的更新次数
+ */
+uint16_t rx_fusion_process(rx_fusion_output_cb_t cb, uint16_t budget);
+
+bool rx_fusion_get_stats(uint8_t id, rx_fusion_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_FUSION_H__ */
@@ -0,0 +1,69 @@
+/**
+ * @file rx_predict.h
+ * @brief 接收端姿态预测 / Receiver-side orientation extrapolation
+ *
+ * v0.6.3: 用连续两个样本的四元数差估计每个 tracker 的机体角速度,
+ * 在生成 USB 报告时把最近样本外推到 "报告时刻 + 预测时长",
+ * 抵消抖动缓冲和 tracker → USB 链路的延迟, tracker 固件无需改动
+ *
+ * - 角速度一阶低通, 样本间隔超过 RX_PREDICT_MAX_GAP_US 时重新开始估计
+ * - 外推跨度限制在 RX_PREDICT_MAX_SPAN_US, 超出后保持最近样本
+ */
+
+#ifndef __RX_PREDICT_H__
+#define __RX_PREDICT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RX_PREDICT_MAX_GAP_US       50000   // 两样本间隔超过此值不估计角速度
+#define RX_PREDICT_MAX_SPAN_US      30000   // 最大外推跨度 (样本时刻 → 目标时刻)
+#define RX_PREDICT_MAX_HORIZON_US   20000   // 可配置预测时长上限
+
+/**
+ * @brief 清除所有 tracker 的预测状态
+ */
+void rx_predict_init(void);
+
+/**
+ * @brief 清除单个 tracker 的预测状态 (重新配对 / 离线)
+ */
+void rx_predict_reset(uint8_t id);
+
+/**
+ * @brief 输入一个新样本 (按时间顺序)
+ * @param quat 四元数 [w,x,y,z] Q15
+ * @param t_us 样本时刻 (接收器时钟)
+ */
+void rx_predict_feed(uint8_t id, const int16_t quat[4], uint32_t t_us);
+
+/**
+ * @brief 把最近样本外推到 now_us + 预测时长
+ * @param out 预测四元数 Q15; 无角速度估计时为最近样本
+ * @param dt_us 可为 NULL, 返回实际外推跨度 (us, 0 = 未外推)
+ * @return false 该 tracker 尚无样本
+ */
+bool rx_predict_get(uint8_t id, uint32_t now_us, int16_t out[4], int32_t *dt_us);
+
+/**
+ * @brief 设置预测时长 (报告时刻之后再向前预测的时间)
+ * @param horizon_us 0 = 只外推到报告时刻, 上限 RX_PREDICT_MAX_HORIZON_US
+ */
+void rx_predict_set_horizon_us(uint16_t horizon_us);
+
+/**
+ * @brief 启用/禁用外推 (禁用时 rx_predict_get 返回最近样本)
+ */
+void rx_predict_enable(bool enable);
+
+uint16_t rx_predict_get_horizon_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_PREDICT_H__ */
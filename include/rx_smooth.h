@@ -0,0 +1,73 @@
+/**
+ * @file rx_smooth.h
+ * @brief 接收端自适应姿态平滑 / Receiver-side One-Euro orientation smoothing
+ *
+ * v0.6.3: 每个 tracker 一个 One-Euro 低通, 在播放缓冲入口对 Q15 四元数做 slerp:
+ *   ω̂      = 低通(当前样本与上次输出的夹角 / Δt, 截止 d_cutoff)
+ *   截止   = min_cutoff + beta · ω̂                    [Hz, ω̂ 单位 rad/s]
+ *   α      = 1 / (1 + 1 / (2π · 截止 · Δt))
+ *   q̂      = slerp(q̂, q, α)
+ * 静止时截止频率低, 抖动被压住; 快速转动时截止频率随角速度升高, 几乎不滞后.
+ * tracker 端滤波因此可以调轻, 降低运动时的延迟
+ *
+ * - 样本间隔超过 RX_SMOOTH_MAX_GAP_US (离线/丢包) 时从当前样本重新开始
+ * - 参数按 tracker 设置 (USB 命令 0x29), 不保存, 重启后恢复 config.h 默认值
+ */
+
+#ifndef __RX_SMOOTH_H__
+#define __RX_SMOOTH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RX_SMOOTH_MAX_GAP_US        100000  // 间隔超过此值不平滑, 直接采用新样本
+#define RX_SMOOTH_ALL               0xFF    // rx_smooth_set 的 id: 全部 tracker
+
+/**
+ * @brief One-Euro 参数, 单位与 USB 命令一致 (0.01)
+ */
+typedef struct {
+    bool     enabled;
+    uint16_t min_cutoff_cHz;    // 静止时截止频率 [0.01 Hz]
+    uint16_t beta_cHz;          // 每 rad/s 角速度增加的截止频率 [0.01 Hz]
+    uint16_t d_cutoff_cHz;      // 角速度估计的低通截止 [0.01 Hz]
+} rx_smooth_params_t;
+
+/**
+ * @brief 恢复默认参数并清除所有 tracker 的滤波状态
+ */
+void rx_smooth_init(void);
+
+/**
+ * @brief 清除单个 tracker 的滤波状态 (重新配对 / 离线)
+ */
+void rx_smooth_reset(uint8_t id);
+
+/**
+ * @brief 平滑一个新样本 (按时间顺序, 原地替换)
+ * @param quat 四元数 [w,x,y,z] Q15, 返回平滑后的值; 未启用时不变
+ * @param t_us 样本时刻 (接收器时钟)
+ */
+void rx_smooth_apply(uint8_t id, int16_t quat[4], uint32_t t_us);
+
+/**
+ * @brief 设置参数 (同时清除该 tracker 的滤波状态)
+ * @param id tracker ID, RX_SMOOTH_ALL = 全部
+ * @return 0 成功, -1 ID 无效
+ */
+int rx_smooth_set(uint8_t id, const rx_smooth_params_t *params);
+
+/**
+ * @return false ID 无效
+ */
+bool rx_smooth_get(uint8_t id, rx_smooth_params_t *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RX_SMOOTH_H__ */
@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "imu_fifo.h"
 
 /*============================================================================
  * 寄存器定义
@@ -87,6 +88,12 @@ int sc7i22_read(float gyro[3], float accel[3]);
 int sc7i22_read_raw(int16_t gyro[3], int16_t accel[3]);
 float sc7i22_read_temp(void);
 
+// v0.6.3: FIFO 批量读取 (见 imu_fifo.h), 帧内无时间戳, ts 不写
+int sc7i22_fifo_enable(uint8_t watermark);
+int sc7i22_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts);
+int sc7i22_fifo_disable(void);
+int sc7i22_fifo_flush(void);
+
 // 电源管理
 int sc7i22_suspend(void);
 int sc7i22_resume(void);
@@ -0,0 +1,131 @@
+/**
+ * @file selftest.h
+ * @brief v0.6.3 Tracker 器件特性测量 / On-device characterization suite (USE_SELFTEST)
+ *
+ * 滤波参数和 ODR 的选择需要实测的噪声与耗时, 而不是数据手册的典型值. 主机经 usb_debug
+ * 0x1B 启动一次测量 (tracker 静置), 测量期间追踪和 RF 照常运行, 自动睡眠推迟,
+ * IMU 功耗档固定在启动时指定的一档. 测量项:
+ * - 陀螺 Allan 偏差: τ 从样本周期 τ0 起按 2 的幂递增 (非重叠簇, 流式计算, 每档每轴
+ *   一组累加量); 输入为送入融合的陀螺 (已含驱动的偏置/温度补偿)
+ * - 实际 ODR: 样本数 / MCU 时钟经过时间, 与标称 odr_hz 对比
+ * - 耗时: IMU 读取 (每次突发, 含帧数), 融合更新 (每样本), RF 发送到收到 ACK (每次确认)
+ *
+ * 噪声密度 ≈ ADEV(τ0)·sqrt(2/ODR), 角度随机游走 = ADEV(τ)·sqrt(τ) (白噪声段),
+ * 零偏不稳定性 = 曲线最小值 / 0.664 - 由主机 tools/selftest.py 计算和输出
+ *
+ * 报告 (命令 0x1B, [1] = 子命令):
+ *   0x00 状态     [2..] selftest_status_t
+ *   0x01 开始     [2-3] 时长 s (0 = SELFTEST_DEFAULT_S) [4] 功耗档 (0xFF = 不固定)
+ *   0x02 停止     同状态
+ *   0x10 + i      [2..] selftest_timing_t (i = selftest_timer_t)
+ *   0x20 + k      [2..] selftest_adev_t (τ = τ0 << k)
+ *   超出范围时 [1] = 0xFF
+ */
+
+#ifndef __SELFTEST_H__
+#define __SELFTEST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SELFTEST_SUB_STATUS     0x00
+#define SELFTEST_SUB_START      0x01
+#define SELFTEST_SUB_STOP       0x02
+#define SELFTEST_SUB_TIMING     0x10
+#define SELFTEST_SUB_ADEV       0x20
+#define SELFTEST_PROFILE_ANY    0xFF
+
+typedef enum {
+    SELFTEST_IDLE = 0,
+    SELFTEST_RUNNING,
+    SELFTEST_DONE
+} selftest_state_t;
+
+typedef enum {
+    SELFTEST_T_IMU_READ = 0,    // imu_fifo_read / imu_read_all (items = 帧数)
+    SELFTEST_T_FUSION,          // 融合引擎更新 (每样本)
+    SELFTEST_T_RF_RTT,          // 发送开始 → 收到 ACK (组确认模式下无记录)
+    SELFTEST_T_COUNT
+} selftest_timer_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  state;             // selftest_state_t
+    uint8_t  imu_type;          // imu_get_type
+    uint16_t odr_hz;            // 首个样本时的标称 ODR
+    uint16_t gyro_range_dps;
+    uint16_t duration_s;
+    uint32_t samples;
+    uint32_t elapsed_us;        // 首个 → 最后一个样本
+    float    max_rate_dps;      // 期间最大角速度模长 (判断是否真正静置)
+    float    temp_start_c;      // 芯片温度, 无读数时为 0
+    float    temp_end_c;
+    uint8_t  adev_levels;       // 已有结果的 τ 档数
+} selftest_status_t;            // 29 字节
+
+typedef struct __attribute__((packed)) {
+    uint32_t count;
+    uint32_t items;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t total_us;
+} selftest_timing_t;            // 20 字节
+
+typedef struct __attribute__((packed)) {
+    uint32_t clusters;          // 参与的相邻簇差分数
+    float    tau_s;
+    float    adev_dps[3];
+} selftest_adev_t;              // 20 字节
+
+/**
+ * @brief 开始测量 (清空上次结果)
+ * @param duration_s 0 = SELFTEST_DEFAULT_S
+ * @param profile 测量期间固定的功耗档 (imu_power_profile_t), SELFTEST_PROFILE_ANY = 不固定
+ */
+void selftest_start(uint16_t duration_s, uint8_t profile);
+
+void selftest_stop(void);
+
+bool selftest_running(void);
+
+/**
+ * @brief 测量期间固定的功耗档, 未运行或不固定时返回 -1
+ */
+int selftest_pinned_profile(void);
+
+/**
+ * @brief 送入一个陀螺样本 [rad/s] (主循环, 每样本)
+ */
+void selftest_feed(const float gyro[3]);
+
+/**
+ * @brief 记录一次耗时 (未运行时直接返回)
+ */
+void selftest_time(selftest_timer_t id, uint32_t us, uint16_t items);
+
+/**
+ * @brief 生成 0x1B 响应 (不含命令字节)
+ * @param buf 至少 40 字节
+ * @return 长度
+ */
+uint8_t selftest_command(const uint8_t *data, uint8_t len, uint8_t *buf);
+
+#if defined(USE_SELFTEST) && USE_SELFTEST
+#define SELFTEST_FEED(g)            selftest_feed(g)
+#define SELFTEST_BEGIN(id)          uint32_t st_t0_##id = hal_micros()
+#define SELFTEST_END(id, n)         selftest_time((id), hal_micros() - st_t0_##id, (n))
+#else
+#define SELFTEST_FEED(g)            ((void)0)
+#define SELFTEST_BEGIN(id)          do { } while (0)
+#define SELFTEST_END(id, n)         do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SELFTEST_H__ */
@@ -25,15 +25,27 @@ extern "C" {
 
 typedef struct {
     float gyro[3];      // 陀螺仪 [rad/s]
-    float accel[3];     // 加速度计 [m/s²]
+    float accel[3];     // 加速度计 [g]
     float temp;         // 温度 [°C]
     uint32_t timestamp; // 时间戳 [us]
 } sensor_data_t;
 
+// v0.6.3: 批量数据保存原始计数 (每样本 12 字节, 原浮点 32 字节), 用到时再换算;
+// 样本等间隔, 只存批次时间和间隔
+#ifndef SENSOR_BATCH_DEPTH
+#define SENSOR_BATCH_DEPTH  16
+#endif
+
+typedef struct {
+    int16_t gyro[3];    // 原始计数 (输出坐标系), sensor_batch_get 或 imu_raw_to_si 换算
+    int16_t accel[3];
+} sensor_raw_t;
+
 typedef struct {
-    sensor_data_t data[16];  // 批量数据缓冲
+    sensor_raw_t data[SENSOR_BATCH_DEPTH];  // 批量数据缓冲 (最旧在前)
+    uint32_t start_time;     // 读取时刻 = 最新样本时间 [us]
+    uint16_t period_us;      // 样本间隔
     uint8_t count;           // 有效数据数量
-    uint32_t start_time;     // 批次开始时间
 } sensor_batch_t;
 
 /*============================================================================
@@ -72,6 +84,14 @@ void sensor_dma_prefetch_next(void);
  */
 int sensor_dma_read_batch(sensor_batch_t *batch);
 
+/**
+ * @brief v0.6.3: 取批次中第 i 个样本并换算为物理单位
+ * @param gyro 输出陀螺仪 [rad/s]
+ * @param accel 输出加速度计 [g]
+ * @return 样本时间戳 [us]
+ */
+uint32_t sensor_batch_get(const sensor_batch_t *batch, uint8_t i, float gyro[3], float accel[3]);
+
 /**
  * @brief 检查是否有数据就绪
  * @return true 如果有数据可读
@@ -33,12 +33,56 @@ int sensor_optimized_init(void);
 /**
  * @brief 获取传感器样本
  * @param gyro 陀螺仪输出 [rad/s]
- * @param accel 加速度计输出 [m/s²]
+ * @param accel 加速度计输出 [g]
  * @param timestamp_us 时间戳输出 [us]
  * @return true 如果有新数据
  */
 bool sensor_optimized_get_sample(float gyro[3], float accel[3], uint32_t *timestamp_us);
 
+/**
+ * @brief 获取 FIFO 中待处理的样本数
+ */
+uint8_t sensor_optimized_available(void);
+
+/**
+ * @brief v0.6.3: 批量模式服务函数 (主循环调用)
+ *
+ * 水位中断置位后一次突发读取 IMU FIFO 中的全部帧, 按 ODR 周期
+ * 回推出每帧时间戳后写入样本 FIFO; 中断沿丢失时按两个水位周期兜底轮询
+ *
+ * @return 本次读取的帧数 (0 = 无新数据或未启用批量模式)
+ */
+uint8_t sensor_optimized_poll(void);
+
+/**
+ * @brief v0.6.3: 立即突发读取 IMU FIFO, 不等待水位中断 (即时采样用)
+ * @return 本次读取的帧数
+ */
+uint8_t sensor_optimized_flush(void);
+
+/**
+ * @brief v0.6.3: 批量模式是否生效 (IMU 不支持 FIFO 时为 false)
+ */
+bool sensor_optimized_batch_active(void);
+
+/**
+ * @brief v0.6.3: 最近一次 sensor_optimized_get_sample() 取出样本的实际 dt
+ *
+ * USE_IMU_FIFO_TIMESTAMP 时由 IMU FIFO 时间戳换算 (按 MCU 晶振标定过的
+ * IMU 时钟), 用于逐样本融合步长
+ *
+ * @return dt [s]; 0 表示未知 (IMU 不带时间戳或跨越了间断), 调用方应使用标称 dt
+ */
+float sensor_optimized_get_last_dt(void);
+
+/**
+ * @brief v0.6.3: 最近一次 sensor_optimized_get_sample 的加速度是否为新样本
+ *
+ * USE_IMU_MIXED_ODR 时加速度计 ODR 低于陀螺, 批量读取中不带加速度的帧
+ * 输出上一次的加速度并返回 false; 其它模式恒为 true
+ */
+bool sensor_optimized_get_last_accel_fresh(void);
+
 /**
  * @brief 获取统计信息
  * @param total 总样本数
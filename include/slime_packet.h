@@ -133,6 +133,28 @@ void slime_make_packet3(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data
  */
 void slime_make_packet0(uint8_t out[SLIME_PACKET_SIZE], const slime_device_info_t *info);
 
+/*============================================================================
+ * v0.6.3: 报告模板 - 固定字段只写一次, 之后只改写变化的字段
+ *============================================================================*/
+
+/**
+ * @brief 初始化模板: 清零并写入类型和 tracker ID
+ */
+void slime_packet_template(uint8_t out[SLIME_PACKET_SIZE], uint8_t type, uint8_t tracker_id);
+
+/**
+ * @brief 在 packet1/2/3 模板上改写姿态/加速度/状态字段 (不清零, 不写类型和 ID)
+ */
+void slime_update_packet1(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data);
+void slime_update_packet2(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data);
+void slime_update_packet3(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data);
+
+/**
+ * @brief 在 packet0 模板上只改写电量和温度 (版本/板型/传感器字段配对后不变)
+ */
+void slime_update_packet0_power(uint8_t out[SLIME_PACKET_SIZE], uint8_t battery_pct,
+                                uint16_t battery_mv, int8_t imu_temp);
+
 /*============================================================================
  * 转换辅助函数
  *============================================================================*/
@@ -148,11 +170,18 @@ void slime_convert_from_rf_packet(slime_tracker_data_t *out,
                                    int8_t rssi);
 
 /**
- * @brief 简化四元数压缩
+ * @brief 简化四元数压缩 (整数, 无分支; 2-bit 最大分量索引 + 3x 10-bit 分量)
+ * @param qw,qx,qy,qz Q15 四元数
  * @return 32位压缩四元数
  */
 uint32_t compress_quat_simple(int16_t qw, int16_t qx, int16_t qy, int16_t qz);
 
+/**
+ * @brief v0.6.3: 解压 compress_quat_simple 的结果
+ * @param q 输出四元数 [w,x,y,z] Q15, 最大分量总为正
+ */
+void decompress_quat_simple(uint32_t packed, int16_t q[4]);
+
 /*============================================================================
  * 发送节奏控制
  *============================================================================*/
@@ -0,0 +1,78 @@
+/**
+ * @file soak_stats.h
+ * @brief v0.6.3 设备端窗口统计 / On-device windowed statistics (USE_SOAK_STATS)
+ *
+ * 长稳测试工具按 10s 间隔轮询累计计数, 两次轮询之间的短时突发 (一秒的丢包、
+ * 一次很长的主循环迭代) 被平均掉. 本模块在设备上按 SOAK_WINDOW_MS 分窗口统计
+ * 最小/最大/平均值, 每个窗口结束时写入 RAM 环 (SOAK_RING_DEPTH 个), 主机按序号批量取回:
+ * - 主循环: 迭代间隔 (同 telemetry_history 的计时方式)
+ * - 链路: 包数/丢包数, RSSI; tracker 另计漏收信标
+ * - 电量: tracker 为自身电量, 接收器为各已连接 tracker 的电量 (每窗口开始时各取一次)
+ * - 中断: 各中断探针的次数/平均/最大周期数 (需 USE_PROFILE, 否则为 0)
+ * - 记录接口只做整数累加, 只应在主循环上下文调用; 读出可在 USB 中断中进行
+ * - 经 usb_debug 0x1C 命令读出 (tools/longrun_logger.py)
+ */
+
+#ifndef __SOAK_STATS_H__
+#define __SOAK_STATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct __attribute__((packed)) {
+    uint16_t seq;                       // 窗口序号 (启动后从 0 递增, 回绕)
+    uint16_t dur_ms;                    // 窗口实际长度
+    uint16_t loop_min_us;               // 主循环迭代间隔 (饱和到 0xFFFF)
+    uint16_t loop_max_us;
+    uint16_t loop_avg_us;
+    uint16_t packets;                   // tracker: 发送数; 接收器: 收到数
+    uint16_t lost;                      // tracker: 未收到 ACK; 接收器: 序号缺口
+    int8_t   rssi_min;                  // 无样本时三项均为 0
+    int8_t   rssi_max;
+    int8_t   rssi_avg;
+    uint8_t  sync_miss;                 // 漏收信标 (tracker, 饱和到 255)
+    uint8_t  batt_min;                  // 电量 % (无样本时 0xFF)
+    uint8_t  batt_max;
+    uint16_t isr_count;                 // 中断次数 (饱和)
+    uint16_t isr_avg_cyc;               // 每次中断平均周期数 (饱和)
+    uint32_t isr_max_cyc;               // 窗口内单次中断最大周期数
+} soak_window_t;                        // 28 字节
+
+/**
+ * @brief 清空环并开始第一个窗口
+ */
+void soak_init(void);
+
+void soak_record_packets(uint16_t packets, uint16_t lost);
+void soak_record_rssi(int8_t rssi);
+void soak_record_sync_miss(void);
+void soak_record_battery(uint8_t percent);
+
+/**
+ * @brief 主循环每次迭代开始时调用: 统计迭代间隔, 到期结束当前窗口
+ * @return true 刚开始一个新窗口 (接收器此时记录各 tracker 电量)
+ */
+bool soak_process(void);
+
+/**
+ * @brief 读出窗口记录
+ * @param from 起始序号; 早于环中最旧记录时从最旧记录开始 (主机据序号差计丢失窗口数)
+ * @param out 输出缓冲
+ * @param max 最多读出条数
+ * @param first 实际第一条记录的序号
+ * @param next 下一个将写入的窗口序号
+ * @return 读出的条数
+ */
+uint8_t soak_read(uint16_t from, soak_window_t *out, uint8_t max,
+                  uint16_t *first, uint16_t *next);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SOAK_STATS_H__ */
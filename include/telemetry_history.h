@@ -0,0 +1,82 @@
+/**
+ * @file telemetry_history.h
+ * @brief v0.6.3 跨重启的每会话遥测汇总 / Flash-backed per-session telemetry (USE_TELEMETRY_HISTORY)
+ *
+ * 事件环和 diagnostics 统计都只在 RAM 中, 断电即丢. 本模块把每次上电 (会话) 的汇总
+ * 计数写入 KV 存储, 现场复现不了的问题在用户重新上电后仍可读出:
+ * - 当前会话每 TELEM_SAVE_INTERVAL_S 经 hal_kv_set_deferred 写入 HAL_KV_TELEM_CUR,
+ *   由 hal_storage_process 在 RF 空闲窗口写出; 睡眠前 telem_flush 补写一次
+ * - 启动时上一会话的最后快照移入 HAL_KV_TELEM_HIST (最新在前, 保留 TELEM_HISTORY_DEPTH 个);
+ *   tracker 深睡眠唤醒 (Shutdown 复位) 接着上一会话计数, 不算新会话
+ * - 记录接口只做整数累加, 只应在主循环上下文调用
+ * - 经 usb_debug 0x18 命令读出 (tools/telemetry_dump.py)
+ */
+
+#ifndef __TELEMETRY_HISTORY_H__
+#define __TELEMETRY_HISTORY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEM_HISTORY_DEPTH     4       // 保留的历史会话数 (不含当前)
+#define TELEM_RSSI_BINS         8       // 10dB 一格: <-90, -90..-81, ..., -40..-31, >=-30
+#define TELEM_RSSI_BIN_BASE     (-100)
+
+// telem_session_t.flags
+#define TELEM_FLAG_TRACKER      0x01    // tracker 会话 (packets/lost 为发送/未 ACK)
+#define TELEM_FLAG_CLEAN        0x02    // 最后快照写于睡眠/关机前 (否则为周期快照, 尾部最多丢一个周期)
+
+typedef struct __attribute__((packed)) {
+    uint16_t session;                   // 会话序号 (每次启动 +1)
+    uint8_t  reset_reason;              // 本会话的启动原因 (reset_reason_t)
+    uint8_t  flags;                     // TELEM_FLAG_*
+    uint32_t duration_s;                // 快照时的累计唤醒时间 (不含睡眠)
+    uint32_t packets;                   // tracker: 发送数; 接收器: 收到数
+    uint32_t lost;                      // tracker: 未收到 ACK; 接收器: 序号缺口
+    uint16_t sync_miss;                 // 漏收信标 (tracker)
+    uint16_t sleep_count;
+    uint16_t wake_count;
+    uint16_t loop_min_us;               // 主循环一次迭代 (饱和到 0xFFFF)
+    uint16_t loop_max_us;
+    uint16_t rssi_hist[TELEM_RSSI_BINS];
+} telem_session_t;                      // 42 字节
+
+/**
+ * @brief 加载/轮换会话 (hal_storage_init 之后)
+ * @param resume true = 从深睡眠唤醒, 继续上一会话
+ */
+void telem_init(bool resume);
+
+void telem_record_rssi(int8_t rssi);
+void telem_record_packets(uint16_t packets, uint16_t lost);
+void telem_record_sync_miss(void);
+void telem_record_sleep(void);
+void telem_record_wake(void);
+
+/**
+ * @brief 主循环每次迭代开始时调用: 统计迭代时间, 到期做周期快照
+ */
+void telem_process(void);
+
+/**
+ * @brief 写入当前会话快照并标记 TELEM_FLAG_CLEAN (睡眠/关机前, hal_storage_flush 之前)
+ */
+void telem_flush(void);
+
+/**
+ * @brief 读取会话汇总
+ * @param index 0 = 当前会话, 1..TELEM_HISTORY_DEPTH = 之前的会话 (1 为上一次)
+ * @return true 有数据
+ */
+bool telem_get_session(uint8_t index, telem_session_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEMETRY_HISTORY_H__ */
@@ -3,7 +3,7 @@
  * @brief 陀螺仪温度漂移补偿模块
  * 
  * 原理: 陀螺仪偏移随温度变化 (约 0.03 dps/°C)
- * 模型: offset = a + b*(T-Tref) + c*(T-Tref)^2
+ * 模型: v0.6.3 分段线性 (10°C 一段), 默认节点取典型二次曲线
  */
 
 #ifndef __TEMP_COMPENSATION_H__
@@ -26,19 +26,19 @@ extern "C" {
 void temp_comp_init(void);
 
 /**
- * @brief 更新当前温度
+ * @brief 更新当前温度 (变化超过 0.25°C 时重算补偿值)
  * @param temp_c 温度 (°C)
  */
 void temp_comp_update_temp(float temp_c);
 
 /**
- * @brief 应用温度补偿到陀螺仪数据
+ * @brief 应用温度补偿到陀螺仪数据 (缓存的补偿值, 只做减法)
  * @param gyro 陀螺仪数据 [rad/s] (会被修改)
  */
 void temp_comp_apply(float gyro[3]);
 
 /**
- * @brief 学习温度补偿系数
+ * @brief 学习当前温度所在段的节点 (温度稳定时)
  * @param observed_offset 观测到的陀螺仪偏移
  */
 void temp_comp_learn(const float observed_offset[3]);
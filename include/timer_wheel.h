@@ -0,0 +1,89 @@
+/**
+ * @file timer_wheel.h
+ * @brief v0.6.3 分级时间轮 / Hierarchical timer wheel (USE_TIMER_WHEEL)
+ *
+ * 各模块的超时 (配对超时、电池采样间隔等) 之前各自在主循环每次迭代调用
+ * hal_get_tick_ms() 比较. 本模块统一管理毫秒级的单次/周期定时器:
+ * - 4 级 x 16 槽, 1ms 分辨率, 第 0 级覆盖 16ms, 第 1 级 256ms, 第 2 级 4.1s, 第 3 级 65.5s;
+ *   更长的延时留在第 3 级, 每次下移时重新判断. 装载/停止 O(1), 每个节拍只看当前槽,
+ *   16 个节拍把上一级的一个槽下移一次. 槽表共 256 字节
+ * - 定时器结构由调用方静态分配 (链表挂在槽上)
+ * - 回调在 tw_process() 中 (主循环上下文, 开中断) 调用, 回调内可重新装载或停止任意定时器;
+ *   周期定时器按到期时刻累加周期, 主循环迟到不累计漂移
+ * - tw_start / tw_stop 在关中断临界区内修改槽表, 也可在中断中调用 (如 USB 命令回调切换状态)
+ * - tw_next_ms() 给出到下一个到期的时间, 供调度器决定能睡多久
+ */
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TW_SLOT_BITS        4
+#define TW_SLOTS            (1u << TW_SLOT_BITS)
+#define TW_LEVELS           4
+#define TW_MAX_DELAY_MS     0x7FFFFFFFUL    // 到期时刻按有符号差比较
+
+#define TW_NONE             0xFFFFFFFFUL    // tw_next_ms: 没有装载的定时器
+
+typedef void (*tw_callback_t)(void *ctx);
+
+typedef struct tw_timer {
+    struct tw_timer *next;
+    struct tw_timer **pprev;        // 指向前一项的 next (或槽头); NULL = 未装载
+    uint32_t expires_ms;
+    uint32_t period_ms;             // 0 = 单次
+    tw_callback_t callback;
+    void *ctx;
+    uint8_t slot;                   // 级 * TW_SLOTS + 槽, 到期处理中为 0xFF
+} tw_timer_t;
+
+/**
+ * @brief 清空时间轮, 从当前 hal_get_tick_ms() 开始计
+ */
+void tw_init(void);
+
+/**
+ * @brief 设置定时器回调 (未装载状态)
+ */
+void tw_timer_init(tw_timer_t *t, tw_callback_t callback, void *ctx);
+
+/**
+ * @brief 装载定时器; 已装载的先停止再按新参数装载
+ * @param delay_ms 首次到期延时 (0 = 下一次 tw_process, 最大 TW_MAX_DELAY_MS)
+ * @param period_ms 之后的周期, 0 = 单次
+ */
+void tw_start(tw_timer_t *t, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * @brief 停止定时器 (未装载时无操作)
+ */
+void tw_stop(tw_timer_t *t);
+
+static inline bool tw_active(const tw_timer_t *t) {
+    return t->pprev != 0;
+}
+
+/**
+ * @brief 推进到当前时刻并调用到期定时器的回调 (主循环每次迭代调用)
+ */
+void tw_process(void);
+
+/**
+ * @brief 到下一个可能到期时刻的毫秒数
+ * @return 0 = 已有到期未处理的; TW_NONE = 没有装载的定时器;
+ *         最近的定时器还在上级轮时返回下一次下移的时刻 (不晚于实际到期)
+ */
+uint32_t tw_next_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMER_WHEEL_H__ */
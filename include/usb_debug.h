@@ -43,9 +43,11 @@ typedef enum {
     DBG_CMD_RESET           = 0x21,
     DBG_CMD_ENTER_BOOT      = 0x22,
     DBG_CMD_SAVE_CONFIG     = 0x23,
+    DBG_CMD_SET_LINK_KEY    = 0x25,     // v0.6.3: USE_RF_LINK_AUTH
     
     DBG_CMD_STREAM_START    = 0x30,
     DBG_CMD_STREAM_STOP     = 0x31,
+    DBG_CMD_WIRED_STREAM    = 0x32,     // v0.6.3: USE_USB_WIRED_STREAM
     
     DBG_CMD_MAG_ENABLE      = 0x40,
     DBG_CMD_MAG_DISABLE     = 0x41,
@@ -66,6 +68,11 @@ void usb_debug_init(void);
  */
 void usb_debug_process(void);
 
+/**
+ * @brief v0.6.3: 处理一条调试命令 (Receiver 的 USB 回调自行分发, 不调用 usb_debug_init)
+ */
+void usb_debug_command(const uint8_t *data, uint8_t len);
+
 /**
  * @brief 启用/禁用调试
  * @param enable true 启用
@@ -78,6 +85,21 @@ void usb_debug_enable(bool enable);
  */
 bool usb_debug_is_streaming(void);
 
+/**
+ * @brief v0.6.3: 有线数据流是否进行中 (主机已请求且 USB 就绪, USE_USB_WIRED_STREAM)
+ */
+bool usb_debug_wired_active(void);
+
+/**
+ * @brief v0.6.3: 发送一个有线数据流样本 (每个 IMU 样本调用一次)
+ * 
+ * Report 0xFD (22 字节):
+ * [0] 0xFD, [1] 序号, [2-5] 样本时刻 us, [6-13] 四元数 w,x,y,z int16 Q15,
+ * [14-19] 加速度 x,y,z int16 (0.01 m/s²), [20] 电量 %, [21] 充电中
+ * 端点忙时丢弃 (计入 0x32 应答的丢弃数)
+ */
+void usb_debug_wired_sample(const float quat[4], const float acc[3], uint32_t sample_us);
+
 /**
  * @brief 发送调试日志
  * @param fmt 格式字符串
@@ -11,6 +11,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "config.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +32,14 @@ extern "C" {
 #define USB_HID_EP_SIZE     64          // Endpoint size
 #define USB_HID_INTERVAL    1           // 1ms polling interval
 
+// v0.6.3: 由本模块处理 USB 中断 (Receiver; Tracker 为 USE_USB_WIRED_STREAM,
+// 中断入口仍在 usb_msc.c, MSC 接管之前转交 usb_hid_irq)
+#if defined(BUILD_RECEIVER) || (defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM)
+#define USB_HID_IRQ_ENABLED 1
+#else
+#define USB_HID_IRQ_ENABLED 0
+#endif
+
 /*============================================================================
  * Callback Types
  *============================================================================*/
@@ -94,6 +103,16 @@ int usb_hid_write(const uint8_t *data, uint8_t len);
  */
 int usb_hid_write_blocking(const uint8_t *data, uint8_t len, uint32_t timeout_ms);
 
+/**
+ * @brief v0.6.3: 发送命令应答
+ * 
+ * USE_USB_FEATURE_DIAG: 最近一条命令经 SET_REPORT(Feature) 下发时, 应答写入 Feature
+ * 缓冲 (覆盖上一条, 补零到 64 字节), 由主机 GET_REPORT(Feature) 读回, 不占用 EP1 IN;
+ * 否则同 usb_hid_write
+ * @return 写入的字节数, <0: 错误
+ */
+int usb_hid_reply(const uint8_t *data, uint8_t len);
+
 /**
  * @brief 设置接收回调
  * @param callback 回调函数
@@ -105,6 +124,13 @@ void usb_hid_set_rx_callback(usb_hid_rx_callback_t callback);
  */
 void usb_hid_task(void);
 
+#if USB_HID_IRQ_ENABLED && !defined(BUILD_RECEIVER)
+/**
+ * @brief v0.6.3: HID 中断处理 (Tracker, 由 usb_msc.c 的 USB_IRQHandler 调用)
+ */
+void usb_hid_irq(void);
+#endif
+
 /*============================================================================
  * Tracker Data API (SlimeVR 兼容)
  *============================================================================*/
@@ -123,9 +149,83 @@ int usb_hid_send_tracker_data(uint8_t id, const int16_t quat[4],
 
 /**
  * @brief 发送所有追踪器数据包
+ * 
+ * v0.6.3: Bundle 报告 (Report 0x03, 64 字节), 一次中断传输携带最多
+ * USB_BUNDLE_BLOCK 个 tracker:
+ * [0]      0x03
+ * [1]      帧号低 8 位
+ * [2-3]    bit0-11 = 本块 tracker 存在位图, bit12-15 = 块号 (ID = 块号*12 + bit)
+ * [4..]    每个存在的 tracker 5 字节 40-bit smallest-three 四元数,
+ *          [4] bit6 = 本帧无新样本, bit7 保留
+ * [..]     状态旁路, 每条 4 字节直到剩余不足 (轮转覆盖所有 tracker):
+ *          [0] 0x80 | ID, [1] 状态, [2] 电量 %, [3] RSSI + 100
+ *          首字节 bit7 为 0 表示结束
+ * 
+ * @return >0: 还有块待发送 (同一帧再次调用), 0: 本帧发送完成, <0: 错误 (-2 = 端点忙)
  */
 int usb_hid_send_bundle(void);
 
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+#define USB_BUNDLE_REPORT_ID    0x03
+#define USB_BUNDLE_BLOCK        12
+
+/**
+ * @brief 移除追踪器缓存 (离线/解绑)
+ */
+void usb_hid_remove_tracker(uint8_t id);
+
+/**
+ * @brief 设置追踪器状态字节 (随状态旁路发送)
+ */
+void usb_hid_set_tracker_status(uint8_t id, uint8_t status);
+
+/**
+ * @brief 开始新的一帧 bundle (设置帧号, 从第一块开始发送)
+ */
+void usb_hid_bundle_begin(uint16_t frame);
+#endif
+
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+/*============================================================================
+ * v0.6.3: Vendor 批量数据流 (接口 1, EP3 IN bulk, 仅 Receiver)
+ * 
+ * 字节流由帧组成, 跨 64 字节包边界拼接:
+ * [0]      USB_BULK_SYNC
+ * [1]      帧类型 USB_BULK_T_*
+ * [2]      负载长度
+ * [3]      帧序号 (每帧递增, FIFO 满丢帧时主机据此计数)
+ * [4..]    负载
+ * 
+ * USB_BULK_T_SAMPLE (20 字节): [0] tracker ID, [1-2] 帧号, [3-4] 帧内偏移 int16 us,
+ *   [5-8] 样本时刻 us, [9-16] 四元数 w,x,y,z int16 Q15, [17-18] 保留, [19] RSSI
+ * USB_BULK_T_TRACE: rf_trace_read() 报告原样 (格式见 rf_airtime_trace.h)
+ * USB_BULK_T_LINK (28 字节): 同 USB 命令 0x22 响应 [1..28]
+ *============================================================================*/
+
+#define USB_BULK_EP_IN          0x83
+#define USB_BULK_SYNC           0xA5
+#define USB_BULK_HDR_SIZE       4
+#define USB_BULK_T_SAMPLE       0x01
+#define USB_BULK_T_TRACE        0x02
+#define USB_BULK_T_LINK         0x03
+
+/**
+ * @brief 写入一帧 (主循环); FIFO 空间不足时整帧丢弃, 不会留下半帧
+ * @return 0: 成功, -1: 未配置, -2: FIFO 满
+ */
+int usb_bulk_send(uint8_t type, const void *payload, uint8_t len);
+
+/**
+ * @brief FIFO 剩余字节数
+ */
+uint16_t usb_bulk_free(void);
+
+/**
+ * @brief 因 FIFO 满丢弃的帧数
+ */
+uint32_t usb_bulk_dropped(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
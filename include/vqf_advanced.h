@@ -23,6 +23,8 @@
 #define __VQF_ADVANCED_H__
 
 #include "optimize.h"
+#include "fast_math.h"
+#include "fusion_checkpoint.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -43,8 +45,19 @@ extern "C" {
 #endif
 
 #define VQF_USE_REST_DETECTION  1   // Enable rest detection for better bias
+// v0.6.3: 静止状态由外部 (共享 motion_state) 经 vqf_advanced_set_rest 提供, 内部检测不编译
+#ifndef VQF_EXTERNAL_REST
+#define VQF_EXTERNAL_REST       0
+#endif
 #define VQF_USE_MOTION_BIAS     1   // Gyro bias estimation during motion
 
+// v0.6.3: 偏差估计降频 - 每个校正步只累加陀螺仪 (静止) 或加速度误差 (运动),
+// 每 VQF_BIAS_DECIM 步按区间累计量更新一次偏差, 衰减/增益按样本数折算;
+// 静止/运动切换时提前结算. 1 = 每步更新 (与之前逐样本更新一致), 最大 255
+#ifndef VQF_BIAS_DECIM
+#define VQF_BIAS_DECIM          8
+#endif
+
 // Filter parameters (tunable)
 #define VQF_TAU_ACC_DEFAULT     3.0f    // Accelerometer time constant (s)
 #define VQF_TAU_MAG_DEFAULT     9.0f    // Magnetometer time constant (s)
@@ -57,6 +70,7 @@ extern "C" {
 #define VQF_REST_GYRO_TH        1.5f    // Rest threshold gyro (deg/s) - 降低以更容易进入Rest
 #define VQF_REST_ACCEL_TH       0.3f    // Rest threshold accel (m/s²) - 降低阈值
 #define VQF_REST_TIME_TH        0.5f    // v0.6.2: 从1.5s降到0.5s，快速进入Rest模式
+#define VQF_REST_TAU            0.2f    // v0.6.3: 内部静止检测的陀螺仪均值/方差时间常数 (s)
 
 // v0.6.2: 新增Motion Bias控制参数 (解决信噪比陷阱)
 #define VQF_MOTION_BIAS_ALPHA_XY    0.0001f   // 水平轴偏差更新速率 (可观测)
@@ -82,8 +96,16 @@ typedef struct PACKED {
     float bias_motion[3];       // Motion-based bias update accumulator
     
     // Rest detection state (16 bytes)
-    float rest_last_gyro[3];
+    float rest_last_gyro[3];    // v0.6.3: 内部检测时为陀螺仪 EMA 均值
     float rest_time;            // Time spent at rest
+#if VQF_USE_REST_DETECTION && !VQF_EXTERNAL_REST
+    float rest_var;             // v0.6.3: 陀螺仪增量方差 (三轴之和, (rad/s)²)
+    float k_rest;               // 均值/方差递推增益
+#endif
+    
+    // v0.6.3: 降频偏差估计的区间累计 (13 bytes)
+    float bias_acc[3];          // 静止: 陀螺仪之和; 运动: 加速度误差之和
+    u8 bias_n;                  // 区间内的校正步数
     
     // Filter coefficients (16 bytes)
     float tau_acc;
@@ -108,27 +130,22 @@ typedef struct PACKED {
 // Flags
 #define VQF_FLAG_REST           BIT(0)
 #define VQF_FLAG_MAG_DISTURBED  BIT(1)
+#define VQF_FLAG_BIAS_REST      BIT(2)  // v0.6.3: 当前偏差累计区间为静止
 #define VQF_FLAG_INITIALIZED    BIT(7)
 
 /*============================================================================
  * Optimized Math Functions
  *============================================================================*/
 
-// Fast inverse square root (Quake III algorithm, refined)
+// v0.6.3: shared kernels from fast_math.h (relative error < 5e-6)
 static FORCE_INLINE float vqf_invsqrt(float x)
 {
-    float xhalf = 0.5f * x;
-    union { float f; u32 i; } u = {x};
-    u.i = 0x5f375a86 - (u.i >> 1);  // Better constant
-    u.f *= (1.5f - xhalf * u.f * u.f);
-    u.f *= (1.5f - xhalf * u.f * u.f);  // Second iteration for accuracy
-    return u.f;
+    return fm_inv_sqrt(x);
 }
 
-// Fast square root
 static FORCE_INLINE float vqf_sqrt(float x)
 {
-    return x * vqf_invsqrt(x);
+    return fm_sqrt(x);
 }
 
 // Fast exp approximation (for filter coefficients)
@@ -252,6 +269,32 @@ void vqf_advanced_update(vqf_state_t *state, const float gyro[3], const float ac
 void vqf_advanced_update_mag(vqf_state_t *state, const float gyro[3], 
                               const float accel[3], const float mag[3]);
 
+/**
+ * @brief v0.6.3: 只做陀螺仪捷联积分 (减偏差后积分 dt), 用于 IMU ODR 下的高速传播
+ * @param dt 本样本积分周期 (s)
+ * @note 与 vqf_advanced_correct 配合时, init 的 dt 应为校正周期 (增益/静止计时按它计算)
+ */
+void vqf_advanced_propagate(vqf_state_t *state, const float gyro[3], float dt);
+
+/**
+ * @brief v0.6.3: 应用预积分旋转增量 (gyro_preint), 一次四元数乘法 + 归一化
+ * @param dtheta 机体系旋转向量增量 (rad), 未扣除本引擎的偏差估计
+ * @param dt 增量覆盖的时长 (s), 用于扣除 bias·dt
+ */
+void vqf_advanced_propagate_delta(vqf_state_t *state, const float dtheta[3], float dt);
+
+/**
+ * @brief v0.6.3: 只做校正步 (静止检测、加速度修正、偏差估计), 不积分陀螺仪
+ * @param gyro 当前样本角速度 (静止检测/静止偏差估计用)
+ */
+void vqf_advanced_correct(vqf_state_t *state, const float gyro[3], const float accel[3]);
+
+/**
+ * @brief v0.6.3: 校正步 + 磁力计修正
+ */
+void vqf_advanced_correct_mag(vqf_state_t *state, const float gyro[3],
+                              const float accel[3], const float mag[3]);
+
 /**
  * @brief Get current orientation quaternion
  * @param state Filter state
@@ -287,6 +330,15 @@ static FORCE_INLINE bool vqf_advanced_is_rest(const vqf_state_t *state)
     return (state->flags & VQF_FLAG_REST) != 0;
 }
 
+/**
+ * @brief v0.6.3: 设置外部静止状态 (VQF_EXTERNAL_REST, 每次 update 前调用)
+ */
+static FORCE_INLINE void vqf_advanced_set_rest(vqf_state_t *state, bool rest)
+{
+    if (rest) state->flags |= VQF_FLAG_REST;
+    else state->flags &= ~VQF_FLAG_REST;
+}
+
 /**
  * @brief Reset filter to initial state
  * @param state Filter state
@@ -300,6 +352,17 @@ void vqf_advanced_reset(vqf_state_t *state);
  */
 void vqf_advanced_set_bias(vqf_state_t *state, const float bias[3]);
 
+/**
+ * @brief v0.6.3: 导出检查点 (姿态/偏差/偏差协方差/acc LP/静止/磁参考)
+ */
+void vqf_advanced_save_checkpoint(const vqf_state_t *state, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 从检查点恢复估计量 (dt/增益保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int vqf_advanced_load_checkpoint(vqf_state_t *state, const fusion_checkpoint_t *ckpt);
+
 /**
  * @brief Get filter coefficients for tuning
  * @param state Filter state
@@ -0,0 +1,252 @@
+/**
+ * @file vqf_fixed.h
+ * @brief Fixed-Point VQF with Magnetometer for CH592
+ *
+ * v0.6.3: vqf_advanced 的整数版本 (CH592 无 FPU, 软浮点开销大)
+ * - 与 vqf_advanced.c 相同的静止检测 (滞后 + 2 倍退出速度)
+ * - 相同的静止/运动陀螺仪偏差估计 (XY/Z 分轴速率)
+ * - 相同的自适应加速度计增益
+ * - 相同的 apply_mag_correction() 行为: LP、地磁倾角干扰检测、偏航修正
+ *
+ * Fixed-point formats:
+ * - Quaternion / unit vectors / gains: Q30 (int32)
+ * - Gyro input: Q24 rad/s (±128 rad/s)
+ * - Accel input: Q16 g, Mag input: Q16 (any unit, normalized internally)
+ *
+ * 更新路径只使用 32/64 位整数运算; 浮点只出现在 init 计算增益
+ * 以及 float 包装接口的输入/输出转换中。
+ *
+ * Usage:
+ *   vqf_fixed_state_t state;
+ *   vqf_fixed_init(&state, 0.005f, 3.0f, 9.0f);
+ *   vqf_fixed_update_mag(&state, gyro, accel, mag);   // float wrapper
+ *   vqf_fixed_update_mag_q(&state, g_q24, a_q16, m_q16);  // integer path
+ */
+
+#ifndef __VQF_FIXED_H__
+#define __VQF_FIXED_H__
+
+#include "optimize.h"
+#include <stdbool.h>
+
+// 共享 vqf_advanced 的调参宏 (阈值/时间常数/运动偏差速率), 保证两者行为一致
+#include "vqf_advanced.h"
+#include "fusion_checkpoint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define VQF_FIXED_USE_MAGNETOMETER  VQF_USE_MAGNETOMETER
+
+// 输入定点格式 (小数位数)
+#define VQF_FIXED_GYRO_FRAC     24      // rad/s
+#define VQF_FIXED_ACC_FRAC      16      // g
+#define VQF_FIXED_MAG_FRAC      16      // arbitrary units
+
+/*============================================================================
+ * VQF Fixed State Structure (~124 bytes with magnetometer, ~88 without)
+ * 全部 32 位字段在前, 自然对齐, 不需要 PACKED
+ *============================================================================*/
+
+typedef struct {
+    // Orientation quaternion [w, x, y, z] in Q30 (16 bytes)
+    int32_t quat[4];
+
+    // Gyroscope bias in Q30 rad/s (12 bytes)
+    int32_t gyro_bias[3];
+
+    // Normalized accelerometer low-pass in Q30 (12 bytes)
+    int32_t acc_lp[3];
+
+    // Bias estimation state in Q30 (24 bytes)
+    int32_t bias_p[3];
+    int32_t bias_motion[3];
+
+    // Precomputed coefficients in Q30 (8 bytes)
+    int32_t half_dt;            // dt / 2 (s)
+    int32_t k_acc;              // Accelerometer gain
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    // Magnetometer state (36 bytes)
+    int32_t k_mag;              // Heading correction gain, Q30
+    int32_t k_mag_lp;           // Measurement LP gain (tau_mag * 0.1), Q30
+    int32_t mag_ref[3];         // Reference [hx, hy, dip], Q30
+    int32_t mag_lp[3];          // Low-pass filtered unit measurement, Q30
+    uint16_t mag_settle;        // Samples since last disturbance
+    uint16_t mag_settle_th;     // 2 s in samples
+#endif
+
+    // Rest detection in samples (4 bytes)
+    uint16_t rest_count;
+    uint16_t rest_count_th;     // VQF_REST_TIME_TH in samples
+
+    // Configuration, only used by init/reset (12 bytes)
+    float dt;
+    float tau_acc;
+    float tau_mag;
+
+    // Status (5 bytes)
+    u32 sample_count;
+    u8 flags;
+} vqf_fixed_state_t;
+
+// Flags (same bits as vqf_advanced)
+#define VQF_FIXED_FLAG_REST             BIT(0)
+#define VQF_FIXED_FLAG_MAG_DISTURBED    BIT(1)
+#define VQF_FIXED_FLAG_INITIALIZED      BIT(7)
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * @brief Initialize fixed-point VQF filter
+ * @param state State structure to initialize
+ * @param dt Sample period in seconds (e.g., 0.005 for 200Hz)
+ * @param tau_acc Accelerometer time constant (typical: 3.0)
+ * @param tau_mag Magnetometer time constant (typical: 9.0, 0 to disable)
+ */
+void vqf_fixed_init(vqf_fixed_state_t *state, float dt, float tau_acc, float tau_mag);
+
+/**
+ * @brief Update filter with 6-axis data (integer path)
+ * @param state Filter state
+ * @param gyro Gyroscope in Q24 rad/s
+ * @param accel Accelerometer in Q16 g
+ */
+void vqf_fixed_update_q(vqf_fixed_state_t *state, const int32_t gyro[3], const int32_t accel[3]);
+
+/**
+ * @brief v0.6.3: 批量 6 轴更新 (接收端多实例融合)
+ *
+ * 所有实例必须以相同 dt/tau_acc 初始化: 增益只从 states[0] 读取一次,
+ * 单次更新内联展开, 省去逐实例的函数调用和增益加载
+ * @param states n 个实例
+ * @param gyro n x Q24 rad/s
+ * @param accel n x Q16 g
+ */
+void vqf_fixed_update_batch_q(vqf_fixed_state_t *const states[], const int32_t gyro[][3],
+                              const int32_t accel[][3], uint8_t n);
+
+/**
+ * @brief Update filter with 9-axis data (integer path)
+ * @param state Filter state
+ * @param gyro Gyroscope in Q24 rad/s
+ * @param accel Accelerometer in Q16 g
+ * @param mag Magnetometer in Q16 (NULL = 6-axis only)
+ */
+void vqf_fixed_update_mag_q(vqf_fixed_state_t *state, const int32_t gyro[3],
+                            const int32_t accel[3], const int32_t mag[3]);
+
+/**
+ * @brief Update filter with 6-axis data (float wrapper)
+ * @param gyro Gyroscope reading in rad/s
+ * @param accel Accelerometer reading in g
+ */
+void vqf_fixed_update(vqf_fixed_state_t *state, const float gyro[3], const float accel[3]);
+
+/**
+ * @brief Update filter with 9-axis data (float wrapper)
+ * @param gyro Gyroscope reading in rad/s
+ * @param accel Accelerometer reading in g
+ * @param mag Magnetometer reading (arbitrary units, |mag| < 32768)
+ */
+void vqf_fixed_update_mag(vqf_fixed_state_t *state, const float gyro[3],
+                          const float accel[3], const float mag[3]);
+
+/**
+ * @brief v0.6.3: 只做陀螺仪捷联积分 (integer path), 用于 IMU ODR 下的高速传播
+ * @param gyro Gyroscope in Q24 rad/s
+ * @param half_dt 本样本 dt/2, Q30 s
+ * @note 与 vqf_fixed_correct_q 配合时, init 的 dt 应为校正周期 (增益/静止计数按它计算)
+ */
+void vqf_fixed_propagate_q(vqf_fixed_state_t *state, const int32_t gyro[3], int32_t half_dt);
+
+/**
+ * @brief v0.6.3: 应用预积分旋转增量 (gyro_preint), 一次四元数乘法 + 归一化
+ * @param dtheta 机体系旋转向量增量 (rad), 未扣除本引擎的偏差估计
+ * @param dt 增量覆盖的时长 (s)
+ */
+void vqf_fixed_propagate_delta(vqf_fixed_state_t *state, const float dtheta[3], float dt);
+
+/**
+ * @brief v0.6.3: 只做校正步 (静止检测、加速度/磁力计修正、偏差估计), 不积分陀螺仪
+ * @param gyro 当前样本 Q24 rad/s (静止检测/静止偏差估计用)
+ * @param mag Magnetometer in Q16 (NULL = 6-axis only)
+ */
+void vqf_fixed_correct_q(vqf_fixed_state_t *state, const int32_t gyro[3],
+                         const int32_t accel[3], const int32_t mag[3]);
+
+/**
+ * @brief v0.6.3: float wrappers of propagate/correct
+ * @param dt 本样本积分周期 (s)
+ */
+void vqf_fixed_propagate(vqf_fixed_state_t *state, const float gyro[3], float dt);
+void vqf_fixed_correct(vqf_fixed_state_t *state, const float gyro[3], const float accel[3]);
+void vqf_fixed_correct_mag(vqf_fixed_state_t *state, const float gyro[3],
+                           const float accel[3], const float mag[3]);
+
+/**
+ * @brief Get current orientation quaternion [w, x, y, z]
+ */
+void vqf_fixed_get_quat(const vqf_fixed_state_t *state, float quat[4]);
+
+/**
+ * @brief Set orientation quaternion (for wake restore), normalized internally
+ */
+void vqf_fixed_set_quat(vqf_fixed_state_t *state, const float quat[4]);
+
+/**
+ * @brief Get current gyroscope bias estimate in rad/s
+ */
+void vqf_fixed_get_bias(const vqf_fixed_state_t *state, float bias[3]);
+
+/**
+ * @brief Set gyroscope bias manually (rad/s)
+ */
+void vqf_fixed_set_bias(vqf_fixed_state_t *state, const float bias[3]);
+
+/**
+ * @brief v0.6.3: 导出检查点 (姿态/偏差/偏差协方差/acc LP/静止/磁参考)
+ */
+void vqf_fixed_save_checkpoint(const vqf_fixed_state_t *state, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 从检查点恢复估计量 (dt/增益保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int vqf_fixed_load_checkpoint(vqf_fixed_state_t *state, const fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief Reset filter to initial state (keeps dt / tau)
+ */
+void vqf_fixed_reset(vqf_fixed_state_t *state);
+
+/**
+ * @brief v0.6.3: Set integration period for the next update (IMU timestamp dt)
+ * @note Only the gyro integration step follows dt; filter gains stay at init values
+ */
+static FORCE_INLINE void vqf_fixed_set_dt(vqf_fixed_state_t *state, float dt)
+{
+    state->dt = dt;
+    state->half_dt = (int32_t)(dt * 0.5f * 1073741824.0f);
+}
+
+/**
+ * @brief Check if device is at rest
+ */
+static FORCE_INLINE bool vqf_fixed_is_rest(const vqf_fixed_state_t *state)
+{
+    return (state->flags & VQF_FIXED_FLAG_REST) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VQF_FIXED_H__ */
@@ -13,6 +13,8 @@
 #define __VQF_OPT_H__
 
 #include "optimize.h"
+#include "fast_math.h"     // v0.6.3: fm_inv_sqrt/fm_sqrt/fm_atan2
+#include "fusion_checkpoint.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,46 +49,12 @@ typedef struct PACKED {
     u32 sample_count;
 } vqf_opt_state_t;
 
-/*============================================================================
- * Fast Math (Optimized for RISC-V)
- *============================================================================*/
-
-// Fast inverse square root (Quake algorithm)
-// 输入必须 > 0，否则返回安全值
-static FORCE_INLINE float fast_invsqrt(float x) {
-    if (x < 1e-10f) return 1000.0f;  // 防止除零
-    float xhalf = 0.5f * x;
-    union { float f; u32 i; } u = {x};
-    u.i = 0x5f3759df - (u.i >> 1);
-    u.f *= (1.5f - xhalf * u.f * u.f);
-    return u.f;
-}
-
-// Fast square root
-static FORCE_INLINE float fast_sqrt(float x) {
-    if (x <= 0.0f) return 0.0f;  // 防止负数
-    return x * fast_invsqrt(x);
-}
-
-// Fast atan2 approximation (max error ~0.01 rad)
-static inline float fast_atan2(float y, float x) {
-    float abs_y = y < 0 ? -y : y;
-    float abs_x = x < 0 ? -x : x;
-    float a = abs_x < abs_y ? abs_x / abs_y : abs_y / abs_x;
-    float s = a * a;
-    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
-    if (abs_y > abs_x) r = 1.57079637f - r;
-    if (x < 0) r = 3.14159274f - r;
-    if (y < 0) r = -r;
-    return r;
-}
-
 /*============================================================================
  * Quaternion Operations (Inline)
  *============================================================================*/
 
 static FORCE_INLINE void quat_normalize(float q[4]) {
-    float inv_norm = fast_invsqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    float inv_norm = fm_inv_sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
     q[0] *= inv_norm;
     q[1] *= inv_norm;
     q[2] *= inv_norm;
@@ -156,6 +124,17 @@ static FORCE_INLINE void vqf_opt_get_quat(const vqf_opt_state_t *state, float qu
  */
 void vqf_opt_reset(vqf_opt_state_t *state);
 
+/**
+ * @brief v0.6.3: 导出检查点 (姿态/偏差/acc LP)
+ */
+void vqf_opt_save_checkpoint(const vqf_opt_state_t *state, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 从检查点恢复估计量 (dt/增益保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int vqf_opt_load_checkpoint(vqf_opt_state_t *state, const fusion_checkpoint_t *ckpt);
+
 /**
  * @brief Get gyro bias estimate
  * @param state State structure
@@ -7,6 +7,7 @@
  * - Lookup tables for trig functions
  * - ~50% faster than float version
  * - 32 bytes RAM (vs 180 bytes for float)
+ * - v0.6.3: VQF_ULTRA_QUAT_Q30 以 Q30 保存四元数 (+8 字节), 消除 Q15 舍入累积的漂移
  * 
  * Usage:
  *   vqf_ultra_state_t state;
@@ -26,6 +27,7 @@
 #define __VQF_ULTRA_H__
 
 #include "optimize.h"
+#include "fusion_checkpoint.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -39,13 +41,24 @@ extern "C" {
 typedef int16_t q15_t;   // Q1.15 format: -1.0 to +0.99997
 typedef int32_t q31_t;   // Q1.31 format for intermediate calculations
 
+// v0.6.3: 四元数累加精度 (编译期选择)
+// 0: Q15, 200Hz 慢速旋转时每步增量只有几个 LSB, 舍入误差累积为可见的漂移
+// 1: Q30 (int32, 共用 fx_math.h 内核), 其余状态仍为 Q15, 结构体 39 字节
+#ifndef VQF_ULTRA_QUAT_Q30
+#define VQF_ULTRA_QUAT_Q30      0
+#endif
+
 /*============================================================================
  * VQF Ultra State Structure (32 bytes)
  *============================================================================*/
 
 typedef struct PACKED {
-    // Orientation quaternion [w, x, y, z] in Q15
+    // Orientation quaternion [w, x, y, z] in Q15 (VQF_ULTRA_QUAT_Q30: Q30)
+#if VQF_ULTRA_QUAT_Q30
+    int32_t quat[4];        // 16 bytes
+#else
     q15_t quat[4];          // 8 bytes
+#endif
     
     // Gyroscope bias estimate in Q15 rad/s
     q15_t gyro_bias[3];     // 6 bytes
@@ -62,15 +75,18 @@ typedef struct PACKED {
     uint16_t sample_count;  // 2 bytes - total samples (wraps)
     
     // Configuration
-    uint8_t dt_shift;       // 1 byte - dt = 1/(2^dt_shift) seconds
+    uint16_t k_gyro;        // 2 bytes - v0.6.3: 角速度 -> 半角增量 (按采样率)
     uint8_t flags;          // 1 byte - status flags
-} vqf_ultra_state_t;        // Total: 32 bytes
+} vqf_ultra_state_t;        // Total: 31 bytes (VQF_ULTRA_QUAT_Q30: 39)
 
 // Status flags
 #define VQF_ULTRA_INITIALIZED   0x80
 #define VQF_ULTRA_AT_REST       0x01
 #define VQF_ULTRA_MAG_OK        0x02
 
+// v0.6.3: 积分定点范围按此下限设计 (更低的采样率按 50Hz 的 dt 积分)
+#define VQF_ULTRA_MIN_RATE_HZ   50
+
 /*============================================================================
  * API Functions
  *============================================================================*/
@@ -78,7 +94,7 @@ typedef struct PACKED {
 /**
  * @brief Initialize VQF ultra filter
  * @param state Filter state
- * @param sample_rate_hz Sample rate in Hz (100, 200, 400, etc.)
+ * @param sample_rate_hz Sample rate in Hz (>= VQF_ULTRA_MIN_RATE_HZ, any value)
  */
 void vqf_ultra_init(vqf_ultra_state_t *state, uint16_t sample_rate_hz);
 
@@ -137,6 +153,17 @@ void vqf_ultra_reset(vqf_ultra_state_t *state);
  */
 void vqf_ultra_set_bias(vqf_ultra_state_t *state, const int16_t bias[3]);
 
+/**
+ * @brief v0.6.3: 导出检查点 (姿态/偏差/acc LP/静止)
+ */
+void vqf_ultra_save_checkpoint(const vqf_ultra_state_t *state, fusion_checkpoint_t *ckpt);
+
+/**
+ * @brief v0.6.3: 从检查点恢复估计量 (dt/增益保持不变)
+ * @return 0 成功, -1 检查点无效 (状态未修改)
+ */
+int vqf_ultra_load_checkpoint(vqf_ultra_state_t *state, const fusion_checkpoint_t *ckpt);
+
 /**
  * @brief Check if device is at rest
  * @param state Filter state
@@ -0,0 +1,72 @@
+/**
+ * @file wake_profile.h
+ * @brief v0.6.3 唤醒耗时分段测量 / Wake-to-first-packet phase timing (USE_WAKE_PROFILE)
+ *
+ * 从 hal_timer_init (深睡眠唤醒即复位) 起按阶段记录耗时, 直到第一次进入 STATE_RUNNING
+ * (同步完成, 本帧开始发送数据). 进入 Shutdown 的耗时存放在保持 RAM, 复位后读出.
+ * Halt 轻度睡眠唤醒同样从重新初始化 TMR0 起计时. usb_debug 0x1A 读出, 见 tools/wake_dump.py
+ */
+
+#ifndef __WAKE_PROFILE_H__
+#define __WAKE_PROFILE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    WAKE_PH_HAL = 0,        // 定时器/存储/日志/看门狗/保持状态
+    WAKE_PH_MODULES,        // 滤波/功耗/调试/RF 辅助模块
+    WAKE_PH_GPIO,           // GPIO/按键/LED (冷启动含启动闪烁)
+    WAKE_PH_RF,             // IMU 检测开始 + RF 初始化
+    WAKE_PH_RESTORE,        // 融合器恢复 + 配对数据
+    WAKE_PH_IMU,            // 等待 IMU 初始化完成
+    WAKE_PH_SYNC,           // 进入主循环 → 首次同步
+    WAKE_PH_COUNT
+} wake_phase_t;
+
+#define WAKE_FROM_COLD          0   // 上电/其他复位
+#define WAKE_FROM_DEEP          1   // Shutdown 复位, 保持状态有效
+#define WAKE_FROM_LIGHT         2   // Halt
+
+typedef struct {
+    uint8_t source;                     // WAKE_FROM_*
+    uint8_t complete;                   // 已到达 WAKE_PH_SYNC
+    uint16_t entry_us;                  // 上次进入 Shutdown 的耗时, 0 = 未知
+    uint32_t phase_us[WAKE_PH_COUNT];   // 未经过的阶段为 0
+    uint32_t total_us;
+} wake_profile_t;
+
+/**
+ * @brief 开始计时 (起点为 hal_timer_init), 读出并清除上次的睡眠进入耗时
+ */
+void wake_prof_start(uint8_t source);
+
+/**
+ * @brief 记录从上一个标记到现在的耗时; WAKE_PH_SYNC 之后的标记被忽略
+ */
+void wake_prof_mark(wake_phase_t phase);
+
+/**
+ * @brief 进入 Shutdown 流程开始 / 即将执行 LowPower_Shutdown
+ */
+void wake_prof_sleep_begin(void);
+void wake_prof_sleep_commit(void);
+
+void wake_prof_get(wake_profile_t *out);
+
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+#define WAKE_MARK(ph)           wake_prof_mark(ph)
+#else
+#define WAKE_MARK(ph)           ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WAKE_PROFILE_H__ */
@@ -7,6 +7,8 @@
  * 2. HardFault处理 - 崩溃时保存现场
  * 3. 复位原因检测 - 区分上电/看门狗/软复位
  * 4. 任务监控 - 检测主循环卡死
+ * 5. v0.6.3: 主循环各任务耗时预算 (USE_TASK_BUDGET) - 定位偶发拖慢主循环、错过 RF 时隙的任务
+ * 6. v0.6.3: 崩溃时序快照 (USE_CRASH_TIMING) - 崩溃/看门狗复位时保存最近几次迭代的任务耗时和探针表
  * 
  * 使用方法:
  *   // 初始化
@@ -24,6 +26,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "config.h"
+#include "profile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -148,6 +152,11 @@ void wdog_print_crash_snapshot(void);
  */
 void wdog_software_reset(void);
 
+/**
+ * @brief v0.6.3: 清除 bootloader 热启动令牌 (固件更新前调用, 下次启动走完整检查)
+ */
+void wdog_boot_token_clear(void);
+
 /**
  * @brief 任务监控初始化
  * @note 用于检测主循环是否卡死
@@ -172,6 +181,137 @@ void task_monitor_alive(void);
  */
 void task_monitor_get_stats(uint32_t *timeout_count, uint32_t *feed_count);
 
+/*============================================================================
+ * v0.6.3: 任务耗时预算 (USE_TASK_BUDGET)
+ *
+ * 主循环内每个任务用 TASK_BEGIN/TASK_END 包围, hal_micros 计时:
+ * - 超出预算计入 overruns; 刷新该任务最大值时记一条 EVT_TASK_OVERRUN [id][us LE16]
+ * - 卸载模式 (task_budget_set_shed): 本次迭代已超过 TASK_LOOP_LATE_US 时
+ *   TASK_SHOULD_RUN 对低优先级任务 (LED/电池) 返回 false, 连续跳过
+ *   TASK_SHED_MAX_SKIP 次后强制执行一次
+ * - 统计经 usb_debug 0x19 命令读出 (tools/task_budget_dump.py)
+ *============================================================================*/
+
+typedef enum {
+    TASK_SENSOR = 0,            // sensor_task + update_rf_data
+    TASK_RF,                    // rf_transmitter_process
+    TASK_USB,                   // usb_debug_process
+    TASK_LED,                   // update_led (低优先级)
+    TASK_STORAGE,               // hal_storage_process
+    TASK_BATTERY,               // read_battery (低优先级)
+    TASK_COUNT
+} task_id_t;
+
+#define TASK_BUDGET_SENSOR_US   1000
+#define TASK_BUDGET_RF_US       2500    // 含 ACK 等待
+#define TASK_BUDGET_USB_US      500
+#define TASK_BUDGET_LED_US      100
+#define TASK_BUDGET_STORAGE_US  1500    // 一步后台写入 (页擦除最长)
+#define TASK_BUDGET_BATTERY_US  200
+#define TASK_LOOP_LATE_US       3000    // 迭代已用时间超过此值视为迟到
+#define TASK_SHED_MAX_SKIP      100
+
+typedef struct {
+    uint32_t count;
+    uint32_t overruns;
+    uint32_t shed;              // 被卸载跳过的次数
+    uint16_t budget_us;
+    uint16_t max_us;            // 饱和到 0xFFFF
+} task_budget_stat_t;
+
+/**
+ * @brief 主循环每次迭代开始
+ */
+void task_budget_loop_start(void);
+
+void task_budget_begin(task_id_t id);
+void task_budget_end(task_id_t id);
+
+/**
+ * @brief 低优先级任务本次是否执行 (卸载模式关闭或非低优先级时总是 true)
+ */
+bool task_budget_should_run(task_id_t id);
+
+void task_budget_set_shed(bool enable);
+bool task_budget_shed_enabled(void);
+
+/**
+ * @return 0=成功, -1=越界
+ */
+int task_budget_get(uint8_t id, task_budget_stat_t *out);
+
+/**
+ * @brief 清零统计 (预算和卸载模式不变)
+ */
+void task_budget_reset(void);
+
+#if defined(USE_TASK_BUDGET) && USE_TASK_BUDGET
+#define TASK_LOOP_START()       task_budget_loop_start()
+#define TASK_BEGIN(id)          task_budget_begin(id)
+#define TASK_END(id)            task_budget_end(id)
+#define TASK_SHOULD_RUN(id)     task_budget_should_run(id)
+#else
+#define TASK_LOOP_START()       do { } while (0)
+#define TASK_BEGIN(id)          do { } while (0)
+#define TASK_END(id)            do { } while (0)
+#define TASK_SHOULD_RUN(id)     (true)
+#endif
+
+/*============================================================================
+ * v0.6.3: 崩溃时序快照 (USE_CRASH_TIMING, 依赖 USE_TASK_BUDGET)
+ *
+ * 现场的看门狗复位几乎都是某条路径超时, 只有寄存器和检查点看不出是谁. TASK_BEGIN/TASK_END
+ * 顺带把最近 CRASH_TIMELINE_DEPTH 次主循环迭代的各任务耗时写入保持 RAM 中的环:
+ * - HardFault/异常、任务监控判定死锁: 保存崩溃快照时拷贝环和探针表 (USE_PROFILE),
+ *   最后一帧为进行中的迭代, 记下正在执行的任务及其已用时间
+ * - 硬件看门狗复位: 复位前无法运行代码, 下次 wdog_init 从环中补记一份
+ *   (fault_type = CRASH_FAULT_WATCHDOG, 探针表随 .bss 清零, probes = 0)
+ * - 经 wdog_get_crash_timing 或 usb_debug 0x1D 读出 (tools/crash_dump.py)
+ *============================================================================*/
+
+#if defined(USE_CRASH_TIMING) && USE_CRASH_TIMING && !defined(BUILD_HOST)
+#define CRASH_TIMING            1       // 主机构建不链接 hal_watchdog.c
+#else
+#define CRASH_TIMING            0
+#endif
+
+#define CRASH_TIMELINE_DEPTH    4       // 保存的最近迭代数
+#define CRASH_TASK_NONE         0xFF
+#define CRASH_FAULT_DEADLOCK    0xDD    // 任务监控判定主循环卡死
+#define CRASH_FAULT_WATCHDOG    0xD0    // 硬件看门狗复位 (复位后补记)
+
+typedef struct __attribute__((packed)) {
+    uint32_t start_us;                  // 迭代开始 (hal_micros)
+    uint16_t task_us[TASK_COUNT];       // 本次迭代各任务耗时, 0 = 未执行 (饱和到 0xFFFF)
+} crash_frame_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t count;
+    uint32_t max;                       // 周期数
+    uint32_t avg;
+} crash_probe_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  frames;                    // 有效帧数 (0..CRASH_TIMELINE_DEPTH)
+    uint8_t  probes;                    // 有效探针数 (未启用 USE_PROFILE 时为 0)
+    uint8_t  cur_task;                  // 保存时正在执行的任务 (CRASH_TASK_NONE = 任务之间)
+    uint8_t  reserved;
+    uint32_t cur_elapsed_us;            // 该任务已用时间
+    crash_frame_t frame[CRASH_TIMELINE_DEPTH];  // 最旧在前, 最后一帧为保存时的迭代
+    crash_probe_t probe[PROF_COUNT];
+} crash_timing_t;
+
+/**
+ * @brief 拷贝最近的迭代时序和探针表 (异常上下文可调用, 不开关中断)
+ */
+void wdog_crash_timing_capture(crash_timing_t *out);
+
+/**
+ * @brief 读取与崩溃快照一起保存的时序 (wdog_has_crash_snapshot 为 true 时有效)
+ * @return false 无快照或未启用
+ */
+bool wdog_get_crash_timing(crash_timing_t *out);
+
 /*============================================================================
  * v0.6.2: 检查点追踪 (用于定位死锁位置)
  * 
@@ -26,6 +26,14 @@ typedef struct {
 #define TMR2    ((TMR_TypeDef *)TMR2_BASE)
 #define TMR3    ((TMR_TypeDef *)TMR3_BASE)
 
+// CTRL bits
+#define TMR_CTRL_COUNT_EN       0x01    // Counter enable
+#define TMR_CTRL_MODE_IN        0x02    // Capture (input) mode
+#define TMR_CTRL_OUT_EN         0x08    // PWM output enable
+#define TMR_CTRL_OUT_POLAR      0x10    // PWM output polarity (1 = active low)
+#define TMR_CTRL_SEL_SHIFT      6       // PWM repeat count / capture edge
+#define TMR_CTRL_SEL_MASK       0xC0
+
 /*============================================================================
  * TMR0 Implementation
  *============================================================================*/
@@ -75,6 +83,18 @@ void TMR0_Enable(uint8_t state)
     }
 }
 
+void TMR0_CapInit(CapModeTypeDef cap)
+{
+    TMR0->CNT = 0;
+    TMR0->CTRL = TMR_CTRL_COUNT_EN | TMR_CTRL_MODE_IN |
+                 (((uint32_t)cap << TMR_CTRL_SEL_SHIFT) & TMR_CTRL_SEL_MASK);
+}
+
+void TMR0_CAPTimeoutCfg(uint32_t cyc)
+{
+    TMR0->END = cyc;
+}
+
 /*============================================================================
  * TMR1 Implementation
  *============================================================================*/
@@ -124,6 +144,34 @@ void TMR1_Enable(uint8_t state)
     }
 }
 
+void TMR1_PWMInit(PWMX_PolarTypeDef pr, PWM_RepeatTsTypeDef ts)
+{
+    TMR1->CNT = 0;
+    TMR1->CTRL = TMR_CTRL_COUNT_EN |
+                 (pr == Low_Level ? TMR_CTRL_OUT_POLAR : 0) |
+                 (((uint32_t)ts << TMR_CTRL_SEL_SHIFT) & TMR_CTRL_SEL_MASK);
+}
+
+void TMR1_PWMCycleCfg(uint32_t cyc)
+{
+    TMR1->END = cyc;
+}
+
+void TMR1_PWMActDataWidth(uint32_t d)
+{
+    TMR1->FIFO = d;
+}
+
+void TMR1_PWMEnable(void)
+{
+    TMR1->CTRL |= TMR_CTRL_OUT_EN;
+}
+
+void TMR1_PWMDisable(void)
+{
+    TMR1->CTRL &= ~TMR_CTRL_OUT_EN;
+}
+
 /*============================================================================
  * TMR2/TMR3 Implementation (Similar)
  *============================================================================*/
@@ -43,6 +43,28 @@ typedef enum {
     TMR_Mode_Cap,           // Capture mode
 } TMR_ModeTypeDef;
 
+// PWM output polarity
+typedef enum {
+    High_Level = 0,         // Idle low, active high
+    Low_Level,              // Idle high, active low
+} PWMX_PolarTypeDef;
+
+// PWM data repeat count (each FIFO value drives N cycles)
+typedef enum {
+    PWM_Times_1 = 0,
+    PWM_Times_4,
+    PWM_Times_8,
+    PWM_Times_16,
+} PWM_RepeatTsTypeDef;
+
+// Capture edge mode
+typedef enum {
+    CAP_NULL = 0,           // Capture disabled
+    Edge_To_Edge,           // Any edge to any edge
+    FallEdge_To_FallEdge,   // Falling edge to falling edge
+    RiseEdge_To_RiseEdge,   // Rising edge to rising edge
+} CapModeTypeDef;
+
 /*============================================================================
  * TMR0 Functions
  *============================================================================*/
@@ -91,6 +113,17 @@ void TMR0_SetPeriod(uint32_t period);
  */
 void TMR0_Enable(uint8_t state);
 
+/**
+ * @brief Initialize TMR0 in capture mode (timer stays enabled)
+ * @param cap Capture edge mode
+ */
+void TMR0_CapInit(CapModeTypeDef cap);
+
+/**
+ * @brief Set TMR0 capture timeout (count end)
+ */
+void TMR0_CAPTimeoutCfg(uint32_t cyc);
+
 /*============================================================================
  * TMR1 Functions
  *============================================================================*/
@@ -103,6 +136,26 @@ uint32_t TMR1_GetCurrentCount(void);
 void TMR1_SetPeriod(uint32_t period);
 void TMR1_Enable(uint8_t state);
 
+/**
+ * @brief Initialize TMR1 in PWM mode (output stays off until TMR1_PWMEnable)
+ * @param pr Output polarity
+ * @param ts Data repeat count
+ */
+void TMR1_PWMInit(PWMX_PolarTypeDef pr, PWM_RepeatTsTypeDef ts);
+
+/**
+ * @brief Set TMR1 PWM cycle (count end, in system clocks)
+ */
+void TMR1_PWMCycleCfg(uint32_t cyc);
+
+/**
+ * @brief Set TMR1 PWM active width (in system clocks)
+ */
+void TMR1_PWMActDataWidth(uint32_t d);
+
+void TMR1_PWMEnable(void);
+void TMR1_PWMDisable(void);
+
 /*============================================================================
  * TMR2 Functions
  *============================================================================*/
@@ -9,11 +9,16 @@
  * the original nRF implementation with standard BLE.
  */
 
+#include "config.h"
 #include "ble_slimevr.h"
 #include "hal.h"
 #include <string.h>
 #include <stdio.h>
 
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+#include "rf_arbiter.h"
+#endif
+
 #ifdef CH59X
 #include "CH59x_common.h"
 #include "CONFIG.h"
@@ -36,14 +41,32 @@
 #define ADV_TIMEOUT                 0       // Forever
 
 // Connection parameters
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+// v0.6.3: Low-rate config channel beside the TDMA link. 50ms is 10 superframes,
+// so events keep their position in the frame; events that land on a TDMA slot
+// are lost and covered by slave latency + a long supervision timeout
+#define CONN_INTERVAL_MIN           40      // 50ms
+#define CONN_INTERVAL_MAX           40
+#define CONN_LATENCY                4
+#define CONN_TIMEOUT                600     // 6s
+#else
 #define CONN_INTERVAL_MIN           12      // 15ms (12 * 1.25ms)
 #define CONN_INTERVAL_MAX           24      // 30ms
 #define CONN_LATENCY                0
 #define CONN_TIMEOUT                200     // 2s
+#endif
 
 // Notification rate limiting
 #define MIN_NOTIFY_INTERVAL_MS      5       // Max ~200Hz notification rate
 
+// v0.6.3: Batch mode (several samples per notification, one notification per event)
+#define BATCH_CONN_INTERVAL_MIN     6       // 7.5ms
+#define BATCH_CONN_INTERVAL_MAX     12      // 15ms
+#define BATCH_MAX_PAYLOAD           244     // ATT_MTU 247 - 3
+#define BATCH_DEFAULT_PAYLOAD       20      // ATT_MTU 23 before exchange
+#define BATCH_MAX_SAMPLES           ((BATCH_MAX_PAYLOAD - sizeof(ble_sensor_batch_header_t)) / \
+                                     sizeof(ble_sensor_batch_sample_t))
+
 /*============================================================================
  * Static Variables
  *============================================================================*/
@@ -68,6 +91,19 @@ static ble_battery_data_t battery_data = {.level = 100, .charging = 0, .voltage_
 static ble_status_data_t status_data = {0};
 static ble_config_data_t config_data = {0};
 
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+// v0.6.3: Pending batch
+static struct {
+    bool enabled;
+    uint8_t count;
+    uint8_t seq;
+    uint16_t interval_ms;           // Negotiated connection interval
+    uint32_t first_ms;              // Timestamp of samples[0]
+    uint32_t last_flush_ms;
+    ble_sensor_batch_sample_t samples[BATCH_MAX_SAMPLES];
+} batch;
+#endif
+
 /*============================================================================
  * Characteristic Attribute Table
  *============================================================================*/
@@ -310,7 +346,9 @@ static bStatus_t slimevr_write_attr_cb(uint16_t connHandle, gattAttribute_t *pAt
         case SLIMEVR_CHAR_COMMAND_UUID:
             if (len >= 1) {
                 uint8_t cmd = pValue[0];
-                if (command_callback) {
+                if (cmd == BLE_CMD_SET_BATCH) {
+                    ble_slimevr_set_batch_mode(len >= 2 && pValue[1]);
+                } else if (command_callback) {
                     command_callback(cmd, pValue + 1, len - 1);
                 }
             }
@@ -344,6 +382,9 @@ static void slimevr_gap_event_handler(uint32_t event, uint8_t *pMsg)
         case GAP_LINK_ESTABLISHED_EVENT:
             conn_status = BLE_STATUS_CONNECTED;
             conn_handle = ((gapLinkUpdateEvent_t*)pMsg)->connectionHandle;
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+            batch.interval_ms = ((gapEstLinkReqEvent_t*)pMsg)->connInterval * 5 / 4;
+#endif
             if (connect_callback) {
                 connect_callback();
             }
@@ -356,6 +397,10 @@ static void slimevr_gap_event_handler(uint32_t event, uint8_t *pMsg)
             sensor_data_cccd = 0;
             battery_cccd = 0;
             status_cccd = 0;
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+            batch.enabled = false;
+            batch.count = 0;
+#endif
             if (disconnect_callback) {
                 disconnect_callback();
             }
@@ -365,6 +410,9 @@ static void slimevr_gap_event_handler(uint32_t event, uint8_t *pMsg)
             
         case GAP_LINK_PARAM_UPDATE_EVENT:
             // Connection parameters updated
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+            batch.interval_ms = ((gapLinkUpdateEvent_t*)pMsg)->connInterval * 5 / 4;
+#endif
             break;
             
         default:
@@ -374,6 +422,142 @@ static void slimevr_gap_event_handler(uint32_t event, uint8_t *pMsg)
 
 #endif // CH59X
 
+/*============================================================================
+ * Sensor Sample Encoding
+ *============================================================================*/
+
+static void scale_sample(const float quat[4], const float accel[3],
+                         int16_t q[4], int16_t a[3])
+{
+    // Scale quaternion to int16 (-32767 to 32767)
+    // 添加范围钳位防止溢出
+    for (int i = 0; i < 4; i++) {
+        float v = quat[i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        q[i] = (int16_t)(v * 32767.0f);
+    }
+    
+    // Scale acceleration to mg (milli-g)
+    // 添加范围钳位防止int16_t溢出 (±32.767g范围)
+    for (int i = 0; i < 3; i++) {
+        float v = accel[i];
+        if (v > 32.767f) v = 32.767f; else if (v < -32.768f) v = -32.768f;
+        a[i] = (int16_t)(v * 1000.0f);
+    }
+}
+
+/*============================================================================
+ * v0.6.3: Batched Notifications
+ *============================================================================*/
+
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+
+static uint8_t batch_capacity(void)
+{
+    uint16_t payload = BATCH_DEFAULT_PAYLOAD;
+#ifdef CH59X
+    uint16_t mtu = ATT_GetMTU(conn_handle);
+    if (mtu > 3) {
+        payload = mtu - 3;
+    }
+#endif
+    if (payload > BATCH_MAX_PAYLOAD) {
+        payload = BATCH_MAX_PAYLOAD;
+    }
+    uint16_t n = (payload - sizeof(ble_sensor_batch_header_t)) / sizeof(ble_sensor_batch_sample_t);
+    return n ? (uint8_t)n : 1;
+}
+
+static int batch_flush(uint32_t now)
+{
+    if (batch.count == 0) {
+        return 0;
+    }
+    
+    ble_sensor_batch_header_t hdr = {
+        .count = batch.count,
+        .seq = batch.seq,
+        .timestamp = (uint16_t)(batch.first_ms & 0xFFFF),
+    };
+    uint16_t len = sizeof(hdr) + batch.count * sizeof(ble_sensor_batch_sample_t);
+    
+#ifdef CH59X
+    attHandleValueNoti_t noti;
+    noti.pValue = GATT_bm_alloc(conn_handle, ATT_HANDLE_VALUE_NOTI, len, NULL);
+    if (!noti.pValue) {
+        return -4;      // Stack buffers busy, retry next call
+    }
+    noti.handle = slimevr_attr_table[SENSOR_DATA_VALUE_HANDLE].handle;
+    noti.len = len;
+    memcpy(noti.pValue, &hdr, sizeof(hdr));
+    memcpy(noti.pValue + sizeof(hdr), batch.samples, len - sizeof(hdr));
+    
+    bStatus_t status = GATT_Notification(conn_handle, &noti, FALSE);
+    if (status != SUCCESS) {
+        GATT_bm_free((gattMsg_t*)&noti, ATT_HANDLE_VALUE_NOTI);
+        return -3;
+    }
+#else
+    (void)hdr;
+    (void)len;
+#endif
+    
+    batch.seq++;
+    batch.count = 0;
+    batch.last_flush_ms = now;
+    return 0;
+}
+
+/**
+ * @brief Send the pending batch once per connection interval
+ *
+ * The CH59X library has no connection-event callback, so the batch is
+ * handed to the stack at the negotiated interval cadence; it then goes
+ * out in the next connection event as a single notification.
+ */
+static void batch_poll(uint32_t now)
+{
+    if (batch.count && now - batch.last_flush_ms >= batch.interval_ms) {
+        batch_flush(now);
+    }
+}
+
+static int batch_add(const float quat[4], const float accel[3], uint32_t now)
+{
+    // dt_ms is 8 bits: close the batch before the offset overflows
+    if (batch.count && now - batch.first_ms > 0xFF) {
+        batch_flush(now);
+    }
+    
+    uint8_t cap = batch_capacity();
+    if (batch.count >= cap) {
+        if (batch_flush(now) != 0) {
+            // Stack still busy: drop the stale batch, the seq gap tells the host
+            batch.count = 0;
+            batch.seq++;
+        }
+    }
+    
+    if (batch.count == 0) {
+        batch.first_ms = now;
+    }
+    ble_sensor_batch_sample_t *s = &batch.samples[batch.count++];
+    int16_t q[4], a[3];
+    scale_sample(quat, accel, q, a);
+    memcpy(s->quat, q, sizeof(q));
+    memcpy(s->accel, a, sizeof(a));
+    s->dt_ms = (uint8_t)(now - batch.first_ms);
+    s->flags = 0;
+    
+    if (batch.count >= cap) {
+        return batch_flush(now) == 0 ? 0 : -3;
+    }
+    batch_poll(now);
+    return 0;
+}
+
+#endif // USE_BLE_NOTIFY_BATCH
+
 /*============================================================================
  * Public API Implementation
  *============================================================================*/
@@ -479,35 +663,30 @@ int ble_slimevr_send_sensor_data(const float quat[4], const float accel[3])
         return -1;
     }
     
-    // Rate limiting
     uint32_t now = hal_millis();
+    
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+    if (batch.enabled) {
+        return batch_add(quat, accel, now);
+    }
+#endif
+    
+    // Rate limiting
     if (now - last_notify_time < MIN_NOTIFY_INTERVAL_MS) {
         return -2;
     }
     last_notify_time = now;
     
     // Pack data into notification packet
-    // Scale quaternion to int16 (-32767 to 32767)
-    // 添加范围钳位防止溢出
-    float q0 = quat[0], q1 = quat[1], q2 = quat[2], q3 = quat[3];
-    if (q0 > 1.0f) q0 = 1.0f; else if (q0 < -1.0f) q0 = -1.0f;
-    if (q1 > 1.0f) q1 = 1.0f; else if (q1 < -1.0f) q1 = -1.0f;
-    if (q2 > 1.0f) q2 = 1.0f; else if (q2 < -1.0f) q2 = -1.0f;
-    if (q3 > 1.0f) q3 = 1.0f; else if (q3 < -1.0f) q3 = -1.0f;
-    sensor_data.quat_w = (int16_t)(q0 * 32767.0f);
-    sensor_data.quat_x = (int16_t)(q1 * 32767.0f);
-    sensor_data.quat_y = (int16_t)(q2 * 32767.0f);
-    sensor_data.quat_z = (int16_t)(q3 * 32767.0f);
-    
-    // Scale acceleration to mg (milli-g)
-    // 添加范围钳位防止int16_t溢出 (±32.767g范围)
-    float ax = accel[0], ay = accel[1], az = accel[2];
-    if (ax > 32.767f) ax = 32.767f; else if (ax < -32.768f) ax = -32.768f;
-    if (ay > 32.767f) ay = 32.767f; else if (ay < -32.768f) ay = -32.768f;
-    if (az > 32.767f) az = 32.767f; else if (az < -32.768f) az = -32.768f;
-    sensor_data.accel_x = (int16_t)(ax * 1000.0f);
-    sensor_data.accel_y = (int16_t)(ay * 1000.0f);
-    sensor_data.accel_z = (int16_t)(az * 1000.0f);
+    int16_t q[4], a[3];
+    scale_sample(quat, accel, q, a);
+    sensor_data.quat_w = q[0];
+    sensor_data.quat_x = q[1];
+    sensor_data.quat_y = q[2];
+    sensor_data.quat_z = q[3];
+    sensor_data.accel_x = a[0];
+    sensor_data.accel_y = a[1];
+    sensor_data.accel_z = a[2];
     
     sensor_data.timestamp = (uint16_t)(now & 0xFFFF);
     sensor_data.flags = 0;
@@ -535,6 +714,30 @@ int ble_slimevr_send_sensor_data(const float quat[4], const float accel[3])
     return 0;
 }
 
+void ble_slimevr_set_batch_mode(bool enable)
+{
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+    if (enable == batch.enabled) {
+        return;
+    }
+    batch.enabled = enable;
+    batch.count = 0;
+    batch.last_flush_ms = hal_millis();
+    
+#if defined(CH59X) && !(defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER)
+    if (enable && conn_handle != 0xFFFF) {
+        // Short interval + 2M PHY: more samples per second at the same duty cycle
+        GAPRole_PeripheralConnParamUpdateReq(conn_handle, BATCH_CONN_INTERVAL_MIN,
+                                             BATCH_CONN_INTERVAL_MAX, CONN_LATENCY,
+                                             CONN_TIMEOUT, INVALID_TASK_ID);
+        HCI_LE_SetPhyCmd(conn_handle, 0, GAP_PHY_BIT_LE_2M, GAP_PHY_BIT_LE_2M, 0);
+    }
+#endif
+#else
+    (void)enable;
+#endif
+}
+
 int ble_slimevr_send_mag_data(const float mag[3])
 {
     if (!ble_slimevr_can_notify()) {
@@ -661,9 +864,30 @@ void ble_slimevr_set_tx_power(int8_t dbm)
 
 void ble_slimevr_process(void)
 {
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+    // v0.6.3: Radio belongs to the TDMA link outside the granted window
+    if (rf_arbiter_ble_budget() == 0) {
+        return;
+    }
+#endif
+    
 #ifdef CH59X
     // Process BLE stack events
     // This is typically called from the main loop or TMOS task
     TMOS_SystemProcess();
 #endif
+    
+#if defined(USE_BLE_NOTIFY_BATCH) && USE_BLE_NOTIFY_BATCH
+    if (batch.enabled && ble_slimevr_can_notify()) {
+        batch_poll(hal_millis());
+    }
+#endif
+}
+
+void ble_slimevr_irq_handler(void)
+{
+#ifdef CH59X
+    // Radio interrupt entry of the CH59X BLE library
+    LLE_LibIRQHandler();
+#endif
 }
@@ -0,0 +1,218 @@
+/**
+ * @file bus_sched.c
+ * @brief I2C 总线调度 / Prioritized shared-bus scheduler
+ *
+ * v0.6.3: 见 bus_sched.h
+ */
+
+#include "bus_sched.h"
+#include "config.h"
+#include <stddef.h>
+
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+typedef struct {
+    uint8_t addr;
+    uint8_t reg;
+    uint16_t len;
+    uint8_t *buf;
+    hal_i2c_async_cb_t callback;
+    void *ctx;
+} bus_req_t;
+
+typedef struct {
+    bus_req_t req[BUS_SCHED_QUEUE_DEPTH];
+    uint8_t head;
+    volatile uint8_t count;
+} bus_queue_t;
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+// 队列和占用标志由主循环 (关中断) 和 I2C 中断 (完成回调) 共同修改
+static bus_queue_t queues[BUS_CLIENT_COUNT];
+static volatile bool bus_busy = false;          // 异步传输在途或同步访问占用
+static volatile bool bus_hold = false;          // 同步访问等待中: 完成回调不派发
+static volatile uint8_t bus_owner = 0;          // bus_busy 时的客户端
+static bus_req_t bus_cur;                       // 在途的异步读取
+static bus_sched_stats_t stats;
+
+/*============================================================================
+ * 派发
+ *============================================================================*/
+
+static void bus_async_done(int status, void *ctx);
+
+// 取最高优先级队列的队首并占用总线; 调用者保证不与 I2C 中断并发
+static bool bus_claim_next(void)
+{
+    if (bus_busy || bus_hold) return false;
+
+    for (uint8_t c = 0; c < BUS_CLIENT_COUNT; c++) {
+        bus_queue_t *q = &queues[c];
+        if (q->count == 0) continue;
+
+        bus_cur = q->req[q->head];
+        q->head = (uint8_t)((q->head + 1) % BUS_SCHED_QUEUE_DEPTH);
+        q->count--;
+        bus_owner = c;
+        bus_busy = true;
+        return true;
+    }
+    return false;
+}
+
+static void bus_start(void)
+{
+    if (hal_i2c_read_reg_async(bus_cur.addr, bus_cur.reg, bus_cur.buf, bus_cur.len,
+                               bus_async_done, NULL) != 0) {
+        bus_async_done(-1, NULL);
+    }
+}
+
+// 主循环上下文: 总线空闲时发起下一项
+static void bus_kick(void)
+{
+    __disable_irq();
+    bool go = bus_claim_next();
+    __enable_irq();
+    if (go) bus_start();
+}
+
+// I2C 中断上下文 (软件 I2C 下为发起者上下文): 回调客户端, 接着派发下一项
+static void bus_async_done(int status, void *ctx)
+{
+    (void)ctx;
+    hal_i2c_async_cb_t callback = bus_cur.callback;
+    void *cb_ctx = bus_cur.ctx;
+
+    stats.async_done++;
+    if (status != 0) stats.async_errors++;
+    bus_busy = false;
+
+    if (callback) callback(status, cb_ctx);
+    if (bus_claim_next()) bus_start();
+}
+
+/*============================================================================
+ * 同步访问
+ *============================================================================*/
+
+// 等在途传输结束后占用总线 (排队的读取留在队列中)
+static int bus_acquire(uint8_t client)
+{
+    uint32_t start_us = hal_micros();
+    bool waited = false;
+
+    for (;;) {
+        __disable_irq();
+        if (!bus_busy) {
+            bus_busy = true;
+            bus_owner = client;
+            bus_hold = false;
+            __enable_irq();
+            break;
+        }
+        bus_hold = true;
+        __enable_irq();
+
+        if (!waited) {
+            waited = true;
+            stats.sync_waits++;
+        }
+        if ((hal_micros() - start_us) > BUS_SCHED_WAIT_US) {
+            bus_hold = false;
+            stats.wait_timeouts++;
+            return -2;
+        }
+    }
+
+    if (waited) {
+        uint32_t wait_us = hal_micros() - start_us;
+        if (wait_us > 0xFFFF) wait_us = 0xFFFF;
+        if (wait_us > stats.max_wait_us[client]) stats.max_wait_us[client] = (uint16_t)wait_us;
+    }
+    return 0;
+}
+
+static void bus_release(void)
+{
+    bus_busy = false;
+    bus_kick();
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+int bus_sched_read_async(uint8_t client, uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len,
+                         hal_i2c_async_cb_t callback, void *ctx)
+{
+    if (client >= BUS_CLIENT_COUNT || !buf || len == 0) return -1;
+
+    bus_queue_t *q = &queues[client];
+    __disable_irq();
+    if (q->count >= BUS_SCHED_QUEUE_DEPTH) {
+        __enable_irq();
+        stats.queue_full++;
+        return -2;
+    }
+    bus_req_t *r = &q->req[(q->head + q->count) % BUS_SCHED_QUEUE_DEPTH];
+    r->addr = addr;
+    r->reg = reg;
+    r->len = len;
+    r->buf = buf;
+    r->callback = callback;
+    r->ctx = ctx;
+    q->count++;
+    __enable_irq();
+
+    bus_kick();
+    return 0;
+}
+
+int bus_sched_read(uint8_t client, uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    if (client >= BUS_CLIENT_COUNT) return -1;
+    if (bus_acquire(client) != 0) return -2;
+    int ret = hal_i2c_read_reg(addr, reg, buf, len);
+    bus_release();
+    return ret;
+}
+
+int bus_sched_write(uint8_t client, uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t len)
+{
+    if (client >= BUS_CLIENT_COUNT) return -1;
+    if (bus_acquire(client) != 0) return -2;
+    int ret = hal_i2c_write_reg(addr, reg, data, len);
+    bus_release();
+    return ret;
+}
+
+uint8_t bus_sched_pending(uint8_t client)
+{
+    if (client >= BUS_CLIENT_COUNT) return 0;
+    __disable_irq();
+    uint8_t n = queues[client].count;
+    if (bus_busy && bus_owner == client && hal_i2c_busy()) n++;
+    __enable_irq();
+    return n;
+}
+
+void bus_sched_get_stats(bus_sched_stats_t *out)
+{
+    if (!out) return;
+    __disable_irq();
+    *out = stats;
+    __enable_irq();
+}
+
+#endif /* USE_BUS_SCHED */
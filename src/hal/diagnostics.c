@@ -5,6 +5,9 @@
 
 #include "diagnostics.h"
 #include "hal.h"
+#include "telemetry_history.h"   // v0.6.3: 跨重启汇总
+#include "soak_stats.h"          // v0.6.3: 窗口统计
+#include "optimize.h"           // v0.6.3: RAM_ARENA
 #include <string.h>
 #include <stdio.h>
 
@@ -12,7 +15,7 @@
  * 全局实例
  *============================================================================*/
 
-tracker_stats_t g_tracker_stats[MAX_TRACKERS];
+tracker_stats_t g_tracker_stats[MAX_TRACKERS] RAM_ARENA(diag);
 receiver_stats_t g_receiver_stats;
 tracker_tx_stats_t g_tx_stats;
 
@@ -43,6 +46,46 @@ void diag_reset(void)
     diag_init();
 }
 
+/*============================================================================
+ * v0.6.3: 直方图
+ *============================================================================*/
+
+static void hist_add(uint16_t *h, uint8_t bin)
+{
+    if (h[bin] == 0xFFFF) {
+        // 保持形状, 偏向近期
+        for (uint8_t i = 0; i < DIAG_HIST_BINS; i++) {
+            h[i] >>= 1;
+        }
+    }
+    h[bin]++;
+}
+
+// 0 -> 0, 1 -> 1, 2-3 -> 2, 4-7 -> 3, ..., 饱和到最后一桶
+static uint8_t log2_bin(uint32_t v)
+{
+    uint8_t b = 0;
+    while (v && b < DIAG_HIST_BINS - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static uint8_t loss_run_bin(uint8_t lost)
+{
+    if (lost <= 4) return lost - 1;
+    uint8_t b = log2_bin(lost - 1) + 1;     // 5-8 -> 4, 9-16 -> 5, 17-32 -> 6
+    return (b < DIAG_HIST_BINS) ? b : DIAG_HIST_BINS - 1;
+}
+
+static uint8_t rssi_bin(int8_t rssi)
+{
+    int bin = ((int)rssi - DIAG_RSSI_BIN_BASE) / 10;
+    if (bin < 0) return 0;
+    return (bin < DIAG_HIST_BINS) ? (uint8_t)bin : DIAG_HIST_BINS - 1;
+}
+
 /*============================================================================
  * Tracker统计更新
  *============================================================================*/
@@ -54,12 +97,28 @@ void diag_update_packet_loss(uint8_t tracker_id, uint8_t expected_seq, uint8_t a
     tracker_stats_t *stats = &g_tracker_stats[tracker_id];
     stats->total_packets++;
     
+    uint8_t lost = 0;
     if (actual_seq != expected_seq) {
         // 计算丢失的包数 (处理序列号回绕)
-        uint8_t lost = (uint8_t)(actual_seq - expected_seq);
+        lost = (uint8_t)(actual_seq - expected_seq);
         if (lost > 128) lost = 1;  // 回绕情况
         stats->lost_packets += lost;
+        if (stats->win_lost < 0xFFFF - lost) stats->win_lost += lost;
+        hist_add(stats->hist.loss_run, loss_run_bin(lost));
+    }
+    
+    uint32_t now_us = hal_micros();
+    if (stats->last_rx_us) {
+        hist_add(stats->hist.gap, log2_bin((now_us - stats->last_rx_us) >> DIAG_GAP_UNIT_SHIFT));
     }
+    stats->last_rx_us = now_us ? now_us : 1;
+    
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_record_packets(1, lost);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_record_packets(1, lost);
+#endif
     
     stats->last_seen_ms = hal_get_tick_ms();
 }
@@ -75,6 +134,20 @@ void diag_record_rssi(uint8_t tracker_id, int8_t rssi)
     
     stats->rssi_sum += rssi;
     stats->rssi_samples++;
+    
+    if (stats->win_packets < 0xFFFF) {
+        stats->win_rssi_sum += rssi;
+        stats->win_packets++;
+    }
+    
+    hist_add(stats->hist.rssi, rssi_bin(rssi));
+    
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_record_rssi(rssi);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_record_rssi(rssi);
+#endif
 }
 
 void diag_record_crc_error(uint8_t tracker_id)
@@ -120,6 +193,87 @@ int8_t diag_get_avg_rssi(uint8_t tracker_id)
     return (int8_t)(stats->rssi_sum / (int32_t)stats->rssi_samples);
 }
 
+bool diag_get_hist(uint8_t tracker_id, diag_hist_t *out)
+{
+    if (tracker_id >= MAX_TRACKERS || !out) return false;
+    memcpy(out, &g_tracker_stats[tracker_id].hist, sizeof(*out));
+    return true;
+}
+
+bool diag_take_link_window(uint8_t tracker_id, int8_t *avg_rssi, uint8_t *loss_pct)
+{
+    if (tracker_id >= MAX_TRACKERS) return false;
+    
+    tracker_stats_t *stats = &g_tracker_stats[tracker_id];
+    uint16_t rx = stats->win_packets;
+    uint16_t lost = stats->win_lost;
+    int32_t sum = stats->win_rssi_sum;
+    
+    stats->win_packets = 0;
+    stats->win_lost = 0;
+    stats->win_rssi_sum = 0;
+    
+    if (rx == 0) return false;
+    
+    if (avg_rssi) *avg_rssi = (int8_t)(sum / (int32_t)rx);
+    if (loss_pct) *loss_pct = (uint8_t)(((uint32_t)lost * 100) / ((uint32_t)rx + lost));
+    return true;
+}
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+/*============================================================================
+ * v0.6.3: 延迟窗口
+ *============================================================================*/
+
+void diag_record_latency(uint8_t tracker_id, uint32_t latency_us)
+{
+    if (tracker_id >= MAX_TRACKERS) return;
+    
+    tracker_stats_t *stats = &g_tracker_stats[tracker_id];
+    uint32_t units = (latency_us + DIAG_LAT_UNIT_US / 2) / DIAG_LAT_UNIT_US;
+    stats->lat_win[stats->lat_pos] = (units > 0xFF) ? 0xFF : (uint8_t)units;
+    stats->lat_pos = (stats->lat_pos + 1) % DIAG_LAT_WINDOW;
+    if (stats->lat_count < DIAG_LAT_WINDOW) stats->lat_count++;
+}
+
+bool diag_get_latency(uint8_t tracker_id, diag_latency_t *out)
+{
+    if (tracker_id >= MAX_TRACKERS || !out) return false;
+    
+    const tracker_stats_t *stats = &g_tracker_stats[tracker_id];
+    uint8_t n = stats->lat_count;
+    memset(out, 0, sizeof(*out));
+    out->count = n;
+    if (n == 0) return true;
+    
+    // 报告时才排序 (插入排序, 最多 DIAG_LAT_WINDOW 个)
+    uint8_t v[DIAG_LAT_WINDOW];
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t x = stats->lat_win[i];
+        uint8_t j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+    
+    // 最近秩: 第 ceil(p·n) 个
+    out->p50 = v[(n * 50 + 99) / 100 - 1];
+    out->p90 = v[(n * 90 + 99) / 100 - 1];
+    out->p99 = v[(n * 99 + 99) / 100 - 1];
+    return true;
+}
+
+void diag_reset_latency(void)
+{
+    for (int i = 0; i < MAX_TRACKERS; i++) {
+        g_tracker_stats[i].lat_pos = 0;
+        g_tracker_stats[i].lat_count = 0;
+    }
+}
+#endif
+
 /*============================================================================
  * 诊断报告生成
  *============================================================================*/
@@ -133,7 +287,7 @@ uint16_t diag_generate_report(uint8_t *buf, uint16_t buf_size)
     // 报告头
     buf[pos++] = 0xD1;  // 诊断报告标识
     buf[pos++] = 0xA0;  // 修复: 0xAG不是有效的十六进制
-    buf[pos++] = 0x01;  // 版本
+    buf[pos++] = DIAG_REPORT_VERSION;  // 版本 (v0.6.3: 2 = 每 tracker 附直方图, 3 = 另附延迟)
     buf[pos++] = 0x00;
     
     // 运行时间 (秒)
@@ -154,9 +308,9 @@ uint16_t diag_generate_report(uint8_t *buf, uint16_t buf_size)
     buf[pos++] = (g_receiver_stats.data_received >> 16) & 0xFF;
     buf[pos++] = (g_receiver_stats.data_received >> 24) & 0xFF;
     
-    // Tracker统计 (每个tracker 8字节)
+    // Tracker统计 (每个tracker 8字节摘要 + 直方图)
     uint8_t tracker_count = 0;
-    for (int i = 0; i < MAX_TRACKERS && pos + 10 < buf_size; i++) {
+    for (int i = 0; i < MAX_TRACKERS && pos + DIAG_REPORT_TRACKER_LEN <= buf_size; i++) {
         tracker_stats_t *stats = &g_tracker_stats[i];
         if (stats->total_packets == 0) continue;
         
@@ -169,6 +323,24 @@ uint16_t diag_generate_report(uint8_t *buf, uint16_t buf_size)
         buf[pos++] = (stats->crc_errors >> 0) & 0xFF;
         buf[pos++] = (stats->retransmit_count >> 0) & 0xFF;
         
+        // v0.6.3: gap / loss_run / rssi, 各 DIAG_HIST_BINS 个 uint16 LE
+        const uint16_t *h[3] = { stats->hist.gap, stats->hist.loss_run, stats->hist.rssi };
+        for (int k = 0; k < 3; k++) {
+            for (int b = 0; b < DIAG_HIST_BINS; b++) {
+                buf[pos++] = h[k][b] & 0xFF;
+                buf[pos++] = (h[k][b] >> 8) & 0xFF;
+            }
+        }
+        
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+        diag_latency_t lat;
+        diag_get_latency(i, &lat);
+        buf[pos++] = lat.p50;
+        buf[pos++] = lat.p90;
+        buf[pos++] = lat.p99;
+        buf[pos++] = lat.count;
+#endif
+        
         tracker_count++;
     }
     
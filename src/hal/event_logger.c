@@ -5,11 +5,9 @@
 
 #include "event_logger.h"
 #include "hal.h"
-#include "version.h"
-#include "board.h"
 #include "diagnostics.h"
+#include "optimize.h"         // v0.6.3: RAM_ARENA
 #include <string.h>
-#include <stdio.h>
 
 /*============================================================================
  * 常量
@@ -17,14 +15,25 @@
 
 #define CRASH_MAGIC     0x43525348  // "CRSH"
 
+#define RING_MASK       (EVENT_RING_BYTES - 1)
+#define LONG_GAP_MS     0xFFFF      // 超出状态字中 16 位时间戳的间隔, dt 按完整时间计算
+
+#if (EVENT_RING_BYTES & RING_MASK) || EVENT_RING_BYTES > 32768
+#error "EVENT_RING_BYTES must be a power of two <= 32768"
+#endif
+
 /*============================================================================
  * 静态变量
  *============================================================================*/
 
-// 环形缓冲区
-static event_entry_t event_ring[EVENT_RING_SIZE];
-static uint8_t event_head = 0;      // 下一个写入位置
-static uint8_t event_count = 0;     // 当前事件数
+// 环形缓冲区 (变长记录, 格式见 event_logger.h)
+static uint8_t event_ring[EVENT_RING_BYTES] RAM_ARENA(event);
+
+// v0.6.3: 追加状态 = 写指针 (低 16 位) | 上一条记录时间低 16 位 (高 16 位)
+// 一次 CAS 同时预留空间并确定 dt 的基准, 中断嵌套时先成功者在前
+static volatile uint32_t log_state = 0;
+static volatile uint32_t log_last_ms = 0;   // 最新记录的完整时间 (CAS 之后更新)
+static volatile uint32_t log_count = 0;
 
 // 启动时间
 static uint32_t boot_time_ms = 0;
@@ -33,22 +42,15 @@ static uint32_t boot_time_ms = 0;
  * 内部函数
  *============================================================================*/
 
-static uint16_t calc_crc16(const void *data, uint16_t len)
+static uint8_t varint_put(uint8_t *out, uint32_t v)
 {
-    const uint8_t *p = (const uint8_t *)data;
-    uint16_t crc = 0xFFFF;
-    
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= p[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
+    uint8_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
     }
-    return crc;
+    out[n++] = (uint8_t)v;
+    return n;
 }
 
 /*============================================================================
@@ -58,8 +60,9 @@ static uint16_t calc_crc16(const void *data, uint16_t len)
 void event_logger_init(void)
 {
     memset(event_ring, 0, sizeof(event_ring));
-    event_head = 0;
-    event_count = 0;
+    log_state = 0;
+    log_last_ms = 0;
+    log_count = 0;
     boot_time_ms = hal_get_tick_ms();
     
     // 记录启动事件
@@ -68,23 +71,47 @@ void event_logger_init(void)
 
 void event_log(event_type_t type, const uint8_t *data, uint8_t data_len)
 {
-    event_entry_t *entry = &event_ring[event_head];
-    
-    entry->timestamp_ms = hal_get_tick_ms() - boot_time_ms;
-    entry->type = type;
-    entry->data_len = (data_len > EVENT_MAX_DATA_LEN) ? EVENT_MAX_DATA_LEN : data_len;
-    
-    if (data && entry->data_len > 0) {
-        memcpy(entry->data, data, entry->data_len);
-    } else {
-        memset(entry->data, 0, EVENT_MAX_DATA_LEN);
+    uint8_t rec[EVENT_REC_MAX_LEN];
+    uint32_t old, next, now;
+    uint8_t len;
+    
+    if (!data) data_len = 0;
+    if (data_len > EVENT_MAX_DATA_LEN) data_len = EVENT_MAX_DATA_LEN;
+    
+    rec[0] = (uint8_t)type;
+    
+    // 无锁预留: 期间有中断写入时 CAS 失败, 重新取时间, 保证记录时间单调
+    do {
+        old = log_state;
+        now = hal_get_tick_ms() - boot_time_ms;
+        
+        uint32_t dt = now - log_last_ms;
+        if (dt < LONG_GAP_MS) {
+            dt = (uint16_t)((uint16_t)now - (uint16_t)(old >> 16));
+        }
+        len = 1 + varint_put(&rec[1], dt);
+        len += data_len + 1;
+        
+        next = ((now & 0xFFFF) << 16) | (uint16_t)(old + len);
+    } while (!__atomic_compare_exchange_n(&log_state, &old, next, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    
+    // 预留区 [old, old + len) 只属于本次调用
+    uint16_t pos = (uint16_t)old;
+    uint8_t hdr = len - data_len - 1;
+    for (uint8_t i = 0; i < hdr; i++) {
+        event_ring[(pos + i) & RING_MASK] = rec[i];
+    }
+    for (uint8_t i = 0; i < data_len; i++) {
+        event_ring[(pos + hdr + i) & RING_MASK] = data[i];
     }
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+    event_ring[(pos + len - 1) & RING_MASK] = len;      // 提交
     
-    // 移动写指针
-    event_head = (event_head + 1) % EVENT_RING_SIZE;
-    if (event_count < EVENT_RING_SIZE) {
-        event_count++;
+    if ((int32_t)(now - log_last_ms) > 0) {
+        log_last_ms = now;
     }
+    __atomic_fetch_add(&log_count, 1, __ATOMIC_RELAXED);
 }
 
 void event_log_simple(event_type_t type)
@@ -102,21 +129,59 @@ void event_log_u32(event_type_t type, uint32_t value)
     event_log(type, (uint8_t *)&value, 4);
 }
 
-uint8_t event_get_recent(event_entry_t *events, uint8_t max_count)
+void event_log_token(uint8_t level, uint16_t token, const uint32_t *args, uint8_t nargs)
 {
-    if (!events || max_count == 0) return 0;
-    
-    uint8_t copy_count = (event_count < max_count) ? event_count : max_count;
-    
-    // 从最新开始往回复制
-    uint8_t read_pos = (event_head + EVENT_RING_SIZE - 1) % EVENT_RING_SIZE;
+    uint8_t data[EVENT_MAX_DATA_LEN + 5];
+    uint8_t len = 2;
+    
+    data[0] = (uint8_t)token;
+    data[1] = (uint8_t)(token >> 8);
+    for (uint8_t i = 0; i < nargs && len <= EVENT_MAX_DATA_LEN; i++) {
+        int32_t v = (int32_t)args[i];
+        uint8_t n = varint_put(&data[len], ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+        if (len + n > EVENT_MAX_DATA_LEN) break;    // 放不下的参数整体丢弃
+        len += n;
+    }
+    event_log((event_type_t)(EVT_LOG_ERR + (level & 0x03)), data, len);
+}
+
+uint16_t event_log_head(void)
+{
+    return (uint16_t)log_state;
+}
+
+void event_log_get_info(event_log_info_t *info)
+{
+    if (!info) return;
+    
+    uint32_t state;
+    do {
+        state = log_state;
+        info->last_ms = log_last_ms;
+        info->count = log_count;
+    } while (state != log_state);
+    
+    info->head = (uint16_t)state;
+    info->size = EVENT_RING_BYTES;
+    info->now_ms = hal_get_tick_ms() - boot_time_ms;
+}
+
+const uint8_t *event_log_peek(uint16_t pos, uint8_t max, uint8_t *len)
+{
+    uint16_t head = (uint16_t)log_state;
+    uint16_t avail = (uint16_t)(head - pos);
     
-    for (uint8_t i = 0; i < copy_count; i++) {
-        memcpy(&events[i], &event_ring[read_pos], sizeof(event_entry_t));
-        read_pos = (read_pos + EVENT_RING_SIZE - 1) % EVENT_RING_SIZE;
+    if (!len || avail == 0 || avail > EVENT_RING_BYTES) {
+        return NULL;
     }
     
-    return copy_count;
+    uint16_t idx = pos & RING_MASK;
+    uint16_t n = EVENT_RING_BYTES - idx;     // 不跨环尾
+    if (n > avail) n = avail;
+    if (n > max) n = max;
+    
+    *len = (uint8_t)n;
+    return &event_ring[idx];
 }
 
 /*============================================================================
@@ -140,8 +205,12 @@ void event_crash_snapshot_save(uint32_t pc, uint32_t sp, uint32_t ra, uint8_t cr
     snapshot.miss_sync_count = 0;  // 需要从rf_ctx获取
     snapshot.crc_fail_count = 0;
     
+#if CRASH_TIMING
+    wdog_crash_timing_capture(&snapshot.timing);
+#endif
+    
     // 计算CRC
-    snapshot.crc = calc_crc16(&snapshot, sizeof(snapshot) - 2);
+    snapshot.crc = hal_crc16(&snapshot, sizeof(snapshot) - 2);
     
     // 写入Flash
     hal_storage_erase(EVENT_FLASH_OFFSET, sizeof(event_crash_snapshot_t));
@@ -165,7 +234,7 @@ int event_crash_snapshot_read(event_crash_snapshot_t *snapshot)
         return -2;  // 无效
     }
     
-    uint16_t crc = calc_crc16(snapshot, sizeof(event_crash_snapshot_t) - 2);
+    uint16_t crc = hal_crc16(snapshot, sizeof(event_crash_snapshot_t) - 2);
     if (crc != snapshot->crc) {
         return -3;  // CRC错误
     }
@@ -179,120 +248,3 @@ void event_crash_snapshot_clear(void)
     uint32_t zero = 0;
     hal_storage_write(EVENT_FLASH_OFFSET, &zero, 4);
 }
-
-/*============================================================================
- * 诊断报告生成
- *============================================================================*/
-
-uint16_t diag_report_generate_json(char *buf, uint16_t buf_size)
-{
-    if (!buf || buf_size < 256) return 0;
-    
-    uint16_t pos = 0;
-    
-    // 开始JSON
-    pos += snprintf(buf + pos, buf_size - pos, "{\n");
-    
-    // 版本信息
-    pos += snprintf(buf + pos, buf_size - pos, 
-        "  \"fw_version\": \"%d.%d.%d\",\n",
-        FIRMWARE_VERSION_MAJOR, FIRMWARE_VERSION_MINOR, FIRMWARE_VERSION_PATCH);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  \"build_time\": \"%s %s\",\n", BUILD_DATE, BUILD_TIME);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  \"chip\": \"%s\",\n", CHIP_NAME);
-    
-    // 配置信息
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  \"config\": {\n");
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"superframe_us\": %d,\n", RF_SUPERFRAME_US);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"slot_us\": %d,\n", RF_DATA_SLOT_US);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"max_trackers\": %d,\n", MAX_TRACKERS);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"auto_sleep_ms\": %d\n", AUTO_SLEEP_TIMEOUT_MS);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  },\n");
-    
-    // 计数器
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  \"counters\": {\n");
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"uptime_sec\": %lu,\n", g_receiver_stats.uptime_sec);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"superframe_count\": %lu,\n", g_receiver_stats.superframe_count);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"frame_overrun\": %lu,\n", g_receiver_stats.frame_overrun);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"usb_tx_count\": %lu,\n", g_receiver_stats.usb_tx_count);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "    \"usb_errors\": %lu\n", g_receiver_stats.usb_errors);
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  },\n");
-    
-    // 最近事件
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  \"recent_events\": [\n");
-    
-    event_entry_t events[10];
-    uint8_t evt_count = event_get_recent(events, 10);
-    
-    for (uint8_t i = 0; i < evt_count; i++) {
-        pos += snprintf(buf + pos, buf_size - pos,
-            "    {\"ts\": %lu, \"type\": %d}%s\n",
-            events[i].timestamp_ms, events[i].type,
-            (i < evt_count - 1) ? "," : "");
-    }
-    
-    pos += snprintf(buf + pos, buf_size - pos,
-        "  ]\n");
-    
-    // 结束JSON
-    pos += snprintf(buf + pos, buf_size - pos, "}\n");
-    
-    return pos;
-}
-
-uint16_t diag_report_generate_bin(uint8_t *buf, uint16_t buf_size)
-{
-    if (!buf || buf_size < sizeof(diag_report_header_t) + 10 * sizeof(event_entry_t)) {
-        return 0;
-    }
-    
-    uint16_t pos = 0;
-    
-    // 头部
-    diag_report_header_t header;
-    header.fw_major = FIRMWARE_VERSION_MAJOR;
-    header.fw_minor = FIRMWARE_VERSION_MINOR;
-    header.fw_patch = FIRMWARE_VERSION_PATCH;
-    header.board_id = 0x59;  // CH59X
-    header.imu_type = 0;     // 需要从imu_interface获取
-    header.mag_type = 0;
-    header.superframe_us = RF_SUPERFRAME_US;
-    header.slot_us = RF_DATA_SLOT_US;
-    header.max_trackers = MAX_TRACKERS;
-    header.sleep_mode = 1;   // WOM enabled
-    header.rf_timeout_count = g_receiver_stats.frame_overrun;
-    header.miss_sync_count = 0;
-    header.crc_fail_count = 0;
-    header.sleep_count = 0;
-    header.wake_count = 0;
-    header.uptime_sec = g_receiver_stats.uptime_sec;
-    header.event_count = event_count;
-    
-    memcpy(buf + pos, &header, sizeof(header));
-    pos += sizeof(header);
-    
-    // 事件
-    uint8_t evt_count = (event_count > 10) ? 10 : event_count;
-    event_entry_t events[10];
-    event_get_recent(events, evt_count);
-    
-    memcpy(buf + pos, events, evt_count * sizeof(event_entry_t));
-    pos += evt_count * sizeof(event_entry_t);
-    
-    return pos;
-}
@@ -0,0 +1,105 @@
+/**
+ * @file event_queue.c
+ * @brief 主循环事件队列 / Main-loop event queue
+ *
+ * v0.6.3: ISR 投递, 主循环消费, 空闲时 WFI
+ */
+
+#include "event_queue.h"
+
+#ifdef CH59X
+#include "CH59x_common.h"
+#endif
+
+// 中断控制宏 (避免与其他头文件冲突)
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+#if (EVQ_SIZE & (EVQ_SIZE - 1)) != 0
+#error "EVQ_SIZE must be a power of 2"
+#endif
+
+/*============================================================================
+ * 内部状态
+ *============================================================================*/
+
+static volatile uint8_t evq_buf[EVQ_SIZE];
+static volatile uint8_t evq_head = 0;       // 写入位置 (ISR)
+static volatile uint8_t evq_tail = 0;       // 读取位置 (主循环)
+static volatile uint8_t evq_pending_mask = 0;
+static volatile uint32_t evq_dropped = 0;
+
+/*============================================================================
+ * API 实现
+ *============================================================================*/
+
+void evq_init(void)
+{
+    __disable_irq();
+    evq_head = 0;
+    evq_tail = 0;
+    evq_pending_mask = 0;
+    evq_dropped = 0;
+    __enable_irq();
+}
+
+bool evq_post(evq_event_t evt)
+{
+    if (evt == EVQ_NONE || evt >= EVQ_MAX) return false;
+
+    uint8_t bit = (uint8_t)(1u << evt);
+    bool ok = true;
+
+    __disable_irq();
+    if (evq_pending_mask & bit) {
+        // 同类事件尚未处理, 合并
+    } else if ((uint8_t)(evq_head - evq_tail) >= EVQ_SIZE) {
+        evq_dropped++;
+        ok = false;
+    } else {
+        evq_buf[evq_head & (EVQ_SIZE - 1)] = (uint8_t)evt;
+        evq_head++;
+        evq_pending_mask |= bit;
+    }
+    __enable_irq();
+
+    return ok;
+}
+
+evq_event_t evq_get(void)
+{
+    evq_event_t evt = EVQ_NONE;
+
+    __disable_irq();
+    if (evq_head != evq_tail) {
+        evt = (evq_event_t)evq_buf[evq_tail & (EVQ_SIZE - 1)];
+        evq_tail++;
+        evq_pending_mask &= (uint8_t)~(1u << evt);
+    }
+    __enable_irq();
+
+    return evt;
+}
+
+bool evq_pending(void)
+{
+    return evq_head != evq_tail;
+}
+
+void evq_wait(void)
+{
+    __disable_irq();
+    if (evq_head == evq_tail) {
+        __asm volatile ("wfi");
+    }
+    __enable_irq();
+}
+
+uint32_t evq_get_dropped(void)
+{
+    return evq_dropped;
+}
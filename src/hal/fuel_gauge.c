@@ -0,0 +1,110 @@
+/**
+ * @file fuel_gauge.c
+ * @brief 整数电量计 / Integer battery fuel gauge
+ *
+ * v0.6.3: 见 fuel_gauge.h
+ */
+
+#include "fuel_gauge.h"
+
+/*============================================================================
+ * 放电曲线 (LiPo 开路电压, 0%..100% 每 10%)
+ *============================================================================*/
+
+static const uint16_t ocv_lut_mv[11] = {
+    3300, 3610, 3700, 3750, 3790, 3820, 3870, 3940, 4020, 4110, 4200
+};
+
+uint8_t fuel_gauge_mv_to_percent(uint16_t ocv_mv)
+{
+    if (ocv_mv <= ocv_lut_mv[0]) return 0;
+    if (ocv_mv >= ocv_lut_mv[10]) return 100;
+
+    uint8_t i = 1;
+    while (ocv_mv > ocv_lut_mv[i]) i++;
+    uint16_t lo = ocv_lut_mv[i - 1];
+    uint16_t span = ocv_lut_mv[i] - lo;
+    return (uint8_t)((i - 1) * 10 + ((uint32_t)(ocv_mv - lo) * 10 + span / 2) / span);
+}
+
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE
+
+/*============================================================================
+ * 配置
+ *============================================================================*/
+
+// ADC 满量程 (4096) 对应的电池电压 (mV), 编译期由分压比和参考电压算出
+#define FG_FULL_SCALE_MV    ((uint32_t)(ADC_REF_VOLTAGE * 1000.0f * \
+                              (VBAT_DIVIDER_R1_OHMS + VBAT_DIVIDER_R2_OHMS) / VBAT_DIVIDER_R2_OHMS + 0.5f))
+#define FG_OCV_SHIFT        3       // 开路电压 IIR, 约 8 次采样时间常数
+#define FG_LOAD_SHIFT       5       // 平均负载 IIR, 约 32 次采样
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static struct {
+    uint32_t ocv_q4;        // 滤波后开路电压 (mV × 16), 0 = 尚无采样
+    uint32_t load_q4;       // 平均负载 (mA × 16)
+    uint16_t raw_mv;
+    uint8_t percent;
+    bool charging;
+} fg;
+
+void fuel_gauge_init(void)
+{
+    fg.ocv_q4 = 0;
+    fg.load_q4 = 0;
+    fg.raw_mv = 0;
+    fg.percent = 100;
+    fg.charging = false;
+}
+
+void fuel_gauge_update(uint16_t adc_raw, uint16_t load_ma, bool charging)
+{
+    uint32_t mv = ((uint32_t)adc_raw * FG_FULL_SCALE_MV) >> 12;
+    fg.raw_mv = (uint16_t)mv;
+
+    // 端电压 = 开路电压 - I × R; 充电时电流方向相反且未知, 不补偿
+    uint32_t ocv = mv;
+    if (!charging) {
+        ocv += ((uint32_t)load_ma * FG_RINT_MOHM + 500) / 1000;
+    }
+
+    // 首个采样, 或充电状态切换 (电压阶跃) 时直接重置滤波器
+    if (fg.ocv_q4 == 0 || charging != fg.charging) {
+        fg.ocv_q4 = ocv << 4;
+        fg.load_q4 = (uint32_t)load_ma << 4;
+    } else {
+        fg.ocv_q4 = fg.ocv_q4 - (fg.ocv_q4 >> FG_OCV_SHIFT) + ((ocv << 4) >> FG_OCV_SHIFT);
+        fg.load_q4 = fg.load_q4 - (fg.load_q4 >> FG_LOAD_SHIFT) + (((uint32_t)load_ma << 4) >> FG_LOAD_SHIFT);
+    }
+    fg.charging = charging;
+    fg.percent = fuel_gauge_mv_to_percent((uint16_t)(fg.ocv_q4 >> 4));
+}
+
+uint8_t fuel_gauge_get_percent(void)
+{
+    return fg.percent;
+}
+
+uint16_t fuel_gauge_get_ocv_mv(void)
+{
+    return (uint16_t)(fg.ocv_q4 >> 4);
+}
+
+uint16_t fuel_gauge_get_raw_mv(void)
+{
+    return fg.raw_mv;
+}
+
+uint16_t fuel_gauge_get_tte_min(void)
+{
+    if (fg.charging || fg.ocv_q4 == 0 || fg.load_q4 < 16) return FG_TTE_UNKNOWN;
+
+    // 剩余 mAh × 60 / mA (负载为 Q4, 分子同乘 16)
+    uint32_t tte = (uint32_t)FG_CAPACITY_MAH * fg.percent * 60 * 16 / 100 / fg.load_q4;
+    return (tte >= FG_TTE_UNKNOWN) ? (FG_TTE_UNKNOWN - 1) : (uint16_t)tte;
+}
+
+#endif /* USE_FUEL_GAUGE */
@@ -0,0 +1,190 @@
+/**
+ * @file hal_button.c
+ * @brief 中断驱动按键 / Edge-interrupt button with timer debounce
+ *
+ * v0.6.3: 见 hal_button.h
+ */
+
+#include "hal_button.h"
+#include "hal.h"
+#include "optimize.h"
+
+#if defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef enum {
+    BTN_IDLE = 0,
+    BTN_PRESSED,            // 按下中, 计时长按
+    BTN_WAIT_DOUBLE,        // 已松开, 计时双击窗口
+    BTN_LONG_HOLD           // 长按已触发, 等待松开
+} btn_state_t;
+
+static struct {
+    uint8_t pin;
+    hal_button_config_t cfg;
+    void (*notify)(void);
+    volatile uint8_t debounce_ms;   // 边沿中断重置, 节拍倒数, 到 0 时采样
+    uint16_t gesture_ms;            // 长按 / 双击窗口倒计时
+    uint8_t state;
+    uint8_t clicks;
+    bool pressed;                   // 去抖后的电平
+    volatile uint8_t events;
+} btn;
+
+/*============================================================================
+ * 内部函数 (均在中断上下文)
+ *============================================================================*/
+
+static inline bool pin_pressed(void)
+{
+    return hal_gpio_read(btn.pin) == 0;
+}
+
+static void arm_edge(bool pressed)
+{
+    // 按下 (低电平) 后等上升沿, 松开后等下降沿
+    hal_gpio_set_int_edge(btn.pin, pressed ? HAL_GPIO_INT_RISING : HAL_GPIO_INT_FALLING);
+}
+
+static void post_event(uint8_t evt)
+{
+    btn.events |= evt;
+    if (btn.notify) btn.notify();
+}
+
+RAM_CODE_ISR
+static void on_edge(void)
+{
+    btn.debounce_ms = btn.cfg.debounce_ms;
+}
+
+static void on_transition(bool pressed)
+{
+    switch (btn.state) {
+        case BTN_IDLE:
+            if (pressed) {
+                btn.state = BTN_PRESSED;
+                btn.clicks = 1;
+                btn.gesture_ms = btn.cfg.long_press_ms;
+            }
+            break;
+
+        case BTN_PRESSED:
+            if (!pressed) {
+                if (btn.clicks == 2) {
+                    post_event(HAL_BTN_DOUBLE);
+                    btn.state = BTN_IDLE;
+                    btn.gesture_ms = 0;
+                } else {
+                    btn.state = BTN_WAIT_DOUBLE;
+                    btn.gesture_ms = btn.cfg.double_click_ms;
+                }
+            }
+            break;
+
+        case BTN_WAIT_DOUBLE:
+            if (pressed) {
+                btn.state = BTN_PRESSED;
+                btn.clicks = 2;
+                btn.gesture_ms = btn.cfg.long_press_ms;
+            }
+            break;
+
+        case BTN_LONG_HOLD:
+            if (!pressed) {
+                btn.state = BTN_IDLE;
+            }
+            break;
+    }
+}
+
+static void on_timeout(void)
+{
+    if (btn.state == BTN_PRESSED) {
+        post_event(HAL_BTN_LONG);
+        btn.state = BTN_LONG_HOLD;
+    } else if (btn.state == BTN_WAIT_DOUBLE) {
+        post_event(HAL_BTN_SINGLE);
+        btn.state = BTN_IDLE;
+    }
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+int hal_button_init(uint8_t pin, const hal_button_config_t *cfg, void (*notify)(void))
+{
+    btn.pin = pin;
+    btn.cfg = *cfg;
+    btn.notify = notify;
+    btn.debounce_ms = 0;
+    btn.gesture_ms = 0;
+    btn.state = BTN_IDLE;
+    btn.clicks = 0;
+    btn.events = 0;
+
+    hal_gpio_config(pin, HAL_GPIO_INPUT_PULLUP);
+    btn.pressed = pin_pressed();
+    if (hal_gpio_set_interrupt(pin, HAL_GPIO_INT_FALLING, on_edge) != 0) {
+        return -1;
+    }
+    arm_edge(btn.pressed);
+    return 0;
+}
+
+uint8_t hal_button_take_events(void)
+{
+    if (!btn.events) return 0;
+
+    __disable_irq();
+    uint8_t e = btn.events;
+    btn.events = 0;
+    __enable_irq();
+    return e;
+}
+
+void hal_button_resume(void)
+{
+    __disable_irq();
+    btn.debounce_ms = 0;
+    btn.gesture_ms = 0;
+    btn.state = BTN_IDLE;
+    btn.events = 0;
+    btn.pressed = pin_pressed();
+    arm_edge(btn.pressed);
+    __enable_irq();
+}
+
+RAM_CODE_ISR
+void hal_button_tick_isr(void)
+{
+    if (btn.debounce_ms && --btn.debounce_ms == 0) {
+        bool pressed = pin_pressed();
+        arm_edge(pressed);
+        if (pressed != btn.pressed) {
+            btn.pressed = pressed;
+            on_transition(pressed);
+        }
+        // 切换边沿期间电平又变了, 不会再有边沿中断, 直接重新去抖
+        if (pin_pressed() != pressed) {
+            btn.debounce_ms = btn.cfg.debounce_ms;
+        }
+    }
+
+    if (btn.gesture_ms && --btn.gesture_ms == 0) {
+        on_timeout();
+    }
+}
+
+#endif /* USE_BUTTON_IRQ */
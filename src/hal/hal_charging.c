@@ -16,6 +16,7 @@
 
 #include "hal.h"
 #include "board.h"
+#include "fuel_gauge.h"
 
 #ifdef CH59X
 #include "CH59x_common.h"
@@ -145,19 +146,12 @@ uint32_t hal_charging_get_duration(void)
 }
 
 /**
- * @brief 估算电池百分比 (简单线性)
+ * @brief 估算电池百分比
  * @param voltage_mv 电池电压 (mV)
  * @return 0-100%
+ * @note v0.6.3: 与电量计共用放电曲线表
  */
 uint8_t hal_battery_percent(uint16_t voltage_mv)
 {
-    // 锂电池电压范围: 3.3V (0%) - 4.2V (100%)
-    // 使用分段线性更精确
-    if (voltage_mv >= 4200) return 100;
-    if (voltage_mv >= 4100) return 90 + (voltage_mv - 4100) / 10;
-    if (voltage_mv >= 4000) return 75 + (voltage_mv - 4000) / 7;
-    if (voltage_mv >= 3800) return 40 + (voltage_mv - 3800) / 6;
-    if (voltage_mv >= 3600) return 15 + (voltage_mv - 3600) / 8;
-    if (voltage_mv >= 3300) return (voltage_mv - 3300) / 20;
-    return 0;
+    return fuel_gauge_mv_to_percent(voltage_mv);
 }
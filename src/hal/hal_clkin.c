@@ -13,9 +13,16 @@
  * IMU 时钟规格 / IMU Clock Specifications:
  *   - ICM-42688/45686: 32.768kHz 外部时钟输入
  *   - BMI270: 32.768kHz 外部时钟输入
+ * 
+ * v0.6.3: hal_clkout_set_trim_ppb() 微调输出频率, 由 imu_clock_sync 闭环
  */
 
+#include "config.h"
 #include "hal.h"
+#include "hal_clkin.h"
+#include "imu_interface.h"
+
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
 
 #ifdef CH59X
 #include "CH59x_common.h"
@@ -39,6 +46,17 @@
 // 时钟频率 / Clock frequency
 #define CLKIN_FREQ_HZ       32768           // 32.768kHz
 
+// v0.6.3: 输出频率. ICM-42688/45686 RTC 模式下 ODR 按 CLKIN/32kHz 缩放,
+// 32.000kHz 时 ODR 与标称值一致 (200Hz 对齐 5ms 超帧), 且 60MHz/32kHz 为整数分频
+#ifndef CLKOUT_FREQ_HZ
+#define CLKOUT_FREQ_HZ      32000
+#endif
+#define CLKOUT_SYS_HZ       60000000UL
+// 标称周期 (Q16 系统时钟计数)
+#define CLKOUT_PERIOD_Q16   ((int64_t)CLKOUT_SYS_HZ * 65536 / CLKOUT_FREQ_HZ)
+
+static uint32_t clkout_dither_acc = 0;     // sigma-delta 小数累加 (Q16)
+
 /*============================================================================
  * 引脚映射 / Pin Mapping
  *============================================================================*/
@@ -97,22 +115,16 @@ int hal_clkout_init(void)
     // 60MHz / 32.768kHz = 1831
     // 周期 = 1831, 占空比 50% = 915
     
-    uint16_t period = 60000000 / CLKIN_FREQ_HZ;  // ~1831
-    uint16_t compare = period / 2;               // 50% duty cycle
+    uint16_t period = CLKOUT_SYS_HZ / CLKOUT_FREQ_HZ;   // 1875 @ 32kHz
+    uint16_t compare = period / 2;                      // 50% duty cycle
     
-    // 配置 Timer1 PWM 模式
+    // 配置 Timer1 PWM 模式: 周期和占空比都以系统时钟计数
     TMR1_PWMInit(High_Level, PWM_Times_1);
     TMR1_PWMCycleCfg(period);
-    TMR1_Disable();
-    
-    // 配置占空比
-    // 注意: CH592 Timer PWM 需要特殊配置
-    R16_TMR1_CNT_END = period - 1;
-    R16_TMR1_FIFO = compare;
-    
     TMR1_PWMActDataWidth(compare);
     TMR1_PWMEnable();
     
+    clkout_dither_acc = 0;
     return 0;
 #else
     return -1;
@@ -130,6 +142,31 @@ void hal_clkout_stop(void)
 #endif
 }
 
+/**
+ * @brief v0.6.3: 微调时钟输出频率
+ * 
+ * 周期 = 标称 / (1 + ppb), 一阶近似为 标称 - 标称 * ppb;
+ * 60MHz 下一个计数约 533 ppm, 小数部分逐次抖动
+ */
+void hal_clkout_set_trim_ppb(int32_t trim_ppb)
+{
+    int64_t period_q16 = CLKOUT_PERIOD_Q16 - CLKOUT_PERIOD_Q16 * trim_ppb / 1000000000LL;
+    uint32_t period = (uint32_t)(period_q16 >> 16);
+    
+    clkout_dither_acc += (uint32_t)(period_q16 & 0xFFFF);
+    if (clkout_dither_acc >= 0x10000) {
+        clkout_dither_acc -= 0x10000;
+        period++;
+    }
+    
+#ifdef CH59X
+    TMR1_PWMCycleCfg(period);
+    TMR1_PWMActDataWidth(period / 2);
+#else
+    (void)period;
+#endif
+}
+
 /**
  * @brief 初始化外部时钟输入 (可选, 用于同步)
  * 
@@ -180,9 +217,8 @@ uint32_t hal_clkin_get_count(void)
  */
 void icm45686_use_external_clock(void)
 {
-    // 这个函数应该在 icm45686.c 中实现
-    // 示例寄存器配置:
-    // hal_spi_write_reg(0x4D, 0x91);  // INTF_CONFIG1
+    // v0.6.3: 寄存器配置在 imu_interface.c (当前实际使用的驱动)
+    imu_set_external_clock(true);
 }
 
 /**
@@ -225,3 +261,5 @@ void bmi270_use_external_clock(void)
  * 
  * 使用共同时钟可使多个追踪器数据同步采样
  */
+
+#endif /* USE_IMU_CLOCK_SYNC */
@@ -0,0 +1,69 @@
+/**
+ * @file hal_crc.c
+ * @brief CRC Calculation (shared by RF, storage and logging)
+ * 
+ * v0.6.3: 统一 CRC 实现, 替代各模块的逐位循环
+ * 
+ * 半字节查表: 每字节两次查表 (16 项表, CRC16 32 字节 / CRC8 16 字节),
+ * 比逐位循环快约 4 倍, 表小到可以常驻 cache/RAM.
+ * CH59x 没有通用 CRC 外设 (RF 基带 CRC 只作用于空口帧), 因此用软件实现;
+ * 计算函数放在 RAM (__HIGH_CODE), 避免 RF 中断中取指的 Flash 等待周期
+ */
+
+#include "hal.h"
+
+#ifdef CH59X
+#include "CH59x_common.h"
+#endif
+
+/*============================================================================
+ * CRC-16/MODBUS (反射多项式 0xA001, 初值 0xFFFF)
+ *============================================================================*/
+
+// crc16_nibble[i] = 低 4 位为 i 时右移 4 次的余式
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+    0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+__HIGH_CODE
+uint16_t hal_crc16_update(uint16_t crc, const void *data, uint16_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc16_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc16_nibble[crc & 0x0F];
+    }
+    return crc;
+}
+
+uint16_t hal_crc16(const void *data, uint16_t len)
+{
+    return hal_crc16_update(HAL_CRC16_INIT, data, len);
+}
+
+/*============================================================================
+ * CRC-8 (多项式 0x07, 初值 0xFF, 不反射)
+ *============================================================================*/
+
+// crc8_nibble[i] = 高 4 位为 i 时左移 4 次的余式
+static const uint8_t crc8_nibble[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+__HIGH_CODE
+uint8_t hal_crc8(const void *data, uint16_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint8_t crc = 0xFF;
+    
+    while (len--) {
+        crc ^= *p++;
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+    }
+    return crc;
+}
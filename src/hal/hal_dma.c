@@ -12,6 +12,7 @@
  */
 
 #include "hal.h"
+#include "profile.h"
 #include <string.h>
 
 #ifdef CH59X
@@ -29,8 +30,8 @@
  * DMA 缓冲区 (双缓冲)
  *============================================================================*/
 
-static uint8_t __attribute__((aligned(4))) dma_buf_a[DMA_BUFFER_SIZE];
-static uint8_t __attribute__((aligned(4))) dma_buf_b[DMA_BUFFER_SIZE];
+static uint8_t __attribute__((aligned(4))) dma_buf_a[DMA_BUFFER_SIZE] RAM_ARENA(dma);
+static uint8_t __attribute__((aligned(4))) dma_buf_b[DMA_BUFFER_SIZE] RAM_ARENA(dma);
 static uint8_t *dma_active_buf = dma_buf_a;
 static uint8_t *dma_ready_buf = dma_buf_b;
 
@@ -46,6 +47,7 @@ typedef struct {
     void (*callback)(uint8_t *data, uint16_t len, void *ctx);
     void *callback_ctx;
     uint16_t transfer_len;
+    uint8_t cs_pin;
     
     // 统计
     uint32_t total_transfers;
@@ -56,6 +58,89 @@ typedef struct {
 static dma_state_t dma_spi = {0};
 static dma_state_t dma_i2c = {0};
 
+// v0.6.3: 单次 DMA 发送 (BMI270 配置上传)
+static struct {
+    volatile bool busy;
+    uint8_t cs_pin;
+    void (*done)(void);
+} dma_tx;
+
+/*============================================================================
+ * v0.6.3: SPI DMA 乒乓环 (零拷贝)
+ *
+ * dma_buf_a/dma_buf_b 作为两个槽位, 每个槽位有明确的所有者:
+ *   FREE  → DMA  (kick: DMA 写入中)
+ *   DMA   → READY (传输完成中断)
+ *   READY → CPU  (acquire: 驱动直接在缓冲区上解码)
+ *   CPU   → FREE (release: 融合读完后归还给 DMA)
+ * 驱动拿到的是 DMA 缓冲区本身, 中间不再 memcpy
+ *============================================================================*/
+
+typedef enum {
+    DMA_SLOT_FREE = 0,
+    DMA_SLOT_DMA,
+    DMA_SLOT_READY,
+    DMA_SLOT_CPU,
+} dma_slot_owner_t;
+
+static struct {
+    bool active;
+    uint8_t cs_pin;
+    uint8_t cmd;
+    uint16_t len;
+    volatile dma_slot_owner_t owner[HAL_DMA_RING_SLOTS];
+    volatile uint8_t seq[HAL_DMA_RING_SLOTS];   // 完成顺序, 保证先进先出
+    volatile uint8_t next_seq;
+    volatile int8_t inflight;                   // 正在传输的槽位, -1=空闲
+    hal_dma_frame_t frame[HAL_DMA_RING_SLOTS];
+    void (*notify)(void);
+    uint32_t overruns;
+} dma_ring;
+
+static uint8_t * const dma_ring_buf[HAL_DMA_RING_SLOTS] = { dma_buf_a, dma_buf_b };
+
+// v0.6.3: 主循环同步 SPI 事务与中断中启动的乒乓环 DMA 互斥 (见 hal_spi_sync_begin)
+static struct {
+    volatile uint8_t depth;             // 嵌套深度, 非 0 时 kick 推迟
+    volatile bool kick_deferred;
+    volatile uint32_t kick_ts;
+} spi_sync;
+
+#define SPI_SYNC_WAIT_US    500         // 等待在途帧完成的上限 (64 字节约 50 us)
+
+#ifdef CH59X
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+#define SPI_SYNC_IRQ_OFF()  __disable_irq()
+#define SPI_SYNC_IRQ_ON()   __enable_irq()
+#else
+#define SPI_SYNC_IRQ_OFF()
+#define SPI_SYNC_IRQ_ON()
+#endif
+
+#ifdef CH59X
+// SPI0 DMA 寄存器 (CH592 手册, SDK 头文件未提供)
+#define R8_SPI0_CTRL_MOD    (*((volatile uint8_t  *)0x40004000))
+#define R8_SPI0_CTRL_CFG    (*((volatile uint8_t  *)0x40004001))
+#define R8_SPI0_INTER_EN    (*((volatile uint8_t  *)0x40004002))
+#define R8_SPI0_INT_FLAG    (*((volatile uint8_t  *)0x40004006))
+#define R16_SPI0_TOTAL_CNT  (*((volatile uint16_t *)0x4000400C))
+#define R16_SPI0_DMA_BEG    (*((volatile uint16_t *)0x40004018))
+#define R16_SPI0_DMA_END    (*((volatile uint16_t *)0x4000401C))
+
+#define RB_SPI_FIFO_DIR     0x10    // CTRL_MOD: 1=输入 (DMA 接收)
+#define RB_SPI_DMA_ENABLE   0x01    // CTRL_CFG
+#define RB_SPI_IE_CNT_END   0x01    // INTER_EN
+#define RB_SPI_IF_CNT_END   0x01    // INT_FLAG
+#define RB_SPI_FREE         0x40    // INT_FLAG: 移位寄存器空闲
+#endif
+
+#define SPI_DMA_CNT_MAX     4095    // R16_SPI0_TOTAL_CNT 12 位
+
 /*============================================================================
  * 初始化
  *============================================================================*/
@@ -79,10 +164,44 @@ void hal_dma_init(void)
  * SPI DMA 传输
  *============================================================================*/
 
-int hal_spi_dma_start(uint8_t cs_pin, const uint8_t *tx_data, uint16_t len,
+// v0.6.3: 传输完成 (SPI0 中断或无硬件时直接调用), 交换缓冲区后回调
+static void spi_dma_complete(void)
+{
+    if (!dma_spi.busy) {
+        return;
+    }
+    
+#ifdef CH59X
+    R8_SPI0_CTRL_CFG &= ~RB_SPI_DMA_ENABLE;
+    R8_SPI0_CTRL_MOD &= ~RB_SPI_FIFO_DIR;       // 恢复 PIO 发送方向
+    hal_gpio_write(dma_spi.cs_pin, 1);
+#endif
+    
+    dma_spi.latency_us = hal_micros() - dma_spi.start_time_us;
+    dma_spi.total_transfers++;
+    if (dma_spi.latency_us > dma_spi.max_latency_us) {
+        dma_spi.max_latency_us = dma_spi.latency_us;
+    }
+    dma_spi.avg_latency_us = dma_spi.avg_latency_us * 0.95f + dma_spi.latency_us * 0.05f;
+    
+    // 回调读 ready 缓冲区时即可从回调中启动下一次传输
+    uint8_t *tmp = dma_active_buf;
+    dma_active_buf = dma_ready_buf;
+    dma_ready_buf = tmp;
+    
+    dma_spi.complete = true;
+    dma_spi.busy = false;
+    
+    if (dma_spi.callback) {
+        dma_spi.callback(dma_ready_buf, dma_spi.transfer_len, dma_spi.callback_ctx);
+    }
+}
+
+int hal_spi_dma_start(uint8_t cs_pin, uint8_t cmd, uint16_t len,
                        void (*callback)(uint8_t*, uint16_t, void*), void *ctx)
 {
-    if (dma_spi.busy || len > DMA_BUFFER_SIZE) {
+    // v0.6.3: 乒乓环启用后缓冲区归环所有
+    if (dma_spi.busy || dma_tx.busy || len == 0 || len > DMA_BUFFER_SIZE || dma_ring.active) {
         return -1;
     }
     
@@ -91,40 +210,79 @@ int hal_spi_dma_start(uint8_t cs_pin, const uint8_t *tx_data, uint16_t len,
     dma_spi.callback = callback;
     dma_spi.callback_ctx = ctx;
     dma_spi.transfer_len = len;
+    dma_spi.cs_pin = cs_pin;
     dma_spi.start_time_us = hal_micros();
     
-    // 复制发送数据到 DMA 缓冲区
-    if (tx_data) {
-        memcpy(dma_active_buf, tx_data, len);
-    } else {
-        memset(dma_active_buf, 0xFF, len);
-    }
-    
 #ifdef CH59X
-    // 拉低 CS
+    // v0.6.3: 与乒乓环相同的方式 - 命令字节用 PIO 发出, 数据 DMA 接收,
+    // 计数结束中断 (SPI0_IRQHandler) 中完成
+    R8_SPI0_INT_FLAG = RB_SPI_IF_CNT_END;
+    R8_SPI0_INTER_EN |= RB_SPI_IE_CNT_END;
+    PFIC_EnableIRQ(SPI0_IRQn);
+    
     hal_gpio_write(cs_pin, 0);
+    hal_spi_xfer(cmd);
     
-    // TODO: 实现SPI DMA配置
-    // 需要正确的寄存器定义
-    // R32_SPI0_DMA_BEG = (uint32_t)dma_active_buf;
-    // R32_SPI0_DMA_END = (uint32_t)(dma_active_buf + len);
-    // R8_SPI0_INTER_EN |= RB_SPI_IE_DMA_END;
-    // PFIC_EnableIRQ(SPI0_IRQn);
-    // R8_SPI0_CTRL_CFG |= RB_SPI_DMA_ENABLE;
+    R8_SPI0_CTRL_MOD |= RB_SPI_FIFO_DIR;
+    R16_SPI0_DMA_BEG = (uint16_t)(uintptr_t)dma_active_buf;
+    R16_SPI0_DMA_END = (uint16_t)(uintptr_t)(dma_active_buf + len);
+    R16_SPI0_TOTAL_CNT = len;
+    R8_SPI0_CTRL_CFG |= RB_SPI_DMA_ENABLE;
+#else
+    // 无硬件: 立即完成
+    (void)cmd;
+    memset(dma_active_buf, 0xFF, len);
+    spi_dma_complete();
+#endif
     
-    // 暂时模拟完成
-    dma_spi.complete = true;
-    dma_spi.busy = false;
-    if (callback) {
-        callback(dma_active_buf, len, ctx);
+    return 0;
+}
+
+// v0.6.3: 发送计数结束时最后一个字节可能仍在移位, 等空闲后再释放 CS
+static void spi_dma_tx_complete(void)
+{
+#ifdef CH59X
+    while (!(R8_SPI0_INT_FLAG & RB_SPI_FREE)) { }
+    R8_SPI0_CTRL_CFG &= ~RB_SPI_DMA_ENABLE;
+    hal_gpio_write(dma_tx.cs_pin, 1);
+#endif
+    
+    dma_tx.busy = false;
+    dma_spi.total_transfers++;
+    
+    if (dma_tx.done) {
+        dma_tx.done();
     }
-#else
-    // 模拟完成
-    dma_spi.complete = true;
-    dma_spi.busy = false;
-    if (callback) {
-        callback(dma_active_buf, len, ctx);
+}
+
+int hal_spi_dma_write(uint8_t cs_pin, uint8_t cmd, const uint8_t *data, uint16_t len,
+                      void (*done)(void))
+{
+    if (dma_tx.busy || dma_spi.busy || dma_ring.active ||
+        data == NULL || len == 0 || len > SPI_DMA_CNT_MAX) {
+        return -1;
     }
+    
+    dma_tx.busy = true;
+    dma_tx.cs_pin = cs_pin;
+    dma_tx.done = done;
+    
+#ifdef CH59X
+    R8_SPI0_INT_FLAG = RB_SPI_IF_CNT_END;
+    R8_SPI0_INTER_EN |= RB_SPI_IE_CNT_END;
+    PFIC_EnableIRQ(SPI0_IRQn);
+    
+    hal_gpio_write(cs_pin, 0);
+    hal_spi_xfer(cmd);
+    
+    // FIFO_DIR 保持输出方向
+    R16_SPI0_DMA_BEG = (uint16_t)(uintptr_t)data;
+    R16_SPI0_DMA_END = (uint16_t)(uintptr_t)(data + len);
+    R16_SPI0_TOTAL_CNT = len;
+    R8_SPI0_CTRL_CFG |= RB_SPI_DMA_ENABLE;
+#else
+    (void)cmd;
+    spi_dma_tx_complete();
 #endif
     
     return 0;
@@ -137,7 +295,7 @@ int hal_spi_dma_start(uint8_t cs_pin, const uint8_t *tx_data, uint16_t len,
 int hal_i2c_dma_read(uint8_t addr, uint8_t reg, uint16_t len,
                       void (*callback)(uint8_t*, uint16_t, void*), void *ctx)
 {
-    if (dma_i2c.busy || len > DMA_BUFFER_SIZE) {
+    if (dma_i2c.busy || len > DMA_BUFFER_SIZE || dma_ring.active) {
         return -1;
     }
     
@@ -183,6 +341,194 @@ int hal_i2c_dma_read(uint8_t addr, uint8_t reg, uint16_t len,
     return 0;
 }
 
+/*============================================================================
+ * v0.6.3: SPI DMA 乒乓环
+ *============================================================================*/
+
+int hal_spi_dma_ring_init(uint8_t cs_pin, uint8_t cmd, uint16_t len, void (*notify)(void))
+{
+    if (len == 0 || len > HAL_DMA_FRAME_MAX) {
+        return -1;
+    }
+    
+    memset(&dma_ring, 0, sizeof(dma_ring));
+    spi_sync.kick_deferred = false;
+    dma_ring.cs_pin = cs_pin;
+    dma_ring.cmd = cmd;
+    dma_ring.len = len;
+    dma_ring.notify = notify;
+    dma_ring.inflight = -1;
+    
+    for (uint8_t i = 0; i < HAL_DMA_RING_SLOTS; i++) {
+        dma_ring.owner[i] = DMA_SLOT_FREE;
+        dma_ring.frame[i].data = dma_ring_buf[i];
+        dma_ring.frame[i].len = len;
+        dma_ring.frame[i].slot = i;
+    }
+    
+#ifdef CH59X
+    R8_SPI0_INT_FLAG = RB_SPI_IF_CNT_END;
+    R8_SPI0_INTER_EN |= RB_SPI_IE_CNT_END;
+    PFIC_EnableIRQ(SPI0_IRQn);
+#endif
+    
+    dma_ring.active = true;
+    return 0;
+}
+
+int hal_spi_dma_ring_kick(uint32_t timestamp_us)
+{
+    if (!dma_ring.active || dma_ring.inflight >= 0) {
+        return -2;   // 上一帧仍在传输
+    }
+    
+    // 同步事务占用总线 (CS 已拉低或即将拉低): 记下触发时刻, 由 hal_spi_sync_end 启动
+    SPI_SYNC_IRQ_OFF();
+    if (spi_sync.depth != 0) {
+        spi_sync.kick_deferred = true;
+        spi_sync.kick_ts = timestamp_us;
+        SPI_SYNC_IRQ_ON();
+        return -3;
+    }
+    SPI_SYNC_IRQ_ON();
+    
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < HAL_DMA_RING_SLOTS; i++) {
+        if (dma_ring.owner[i] == DMA_SLOT_FREE) {
+            slot = (int8_t)i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        // 两个槽位都在等 CPU: 丢弃本次采样而不是覆盖未读数据
+        dma_ring.overruns++;
+        return -1;
+    }
+    
+    dma_ring.owner[slot] = DMA_SLOT_DMA;
+    dma_ring.inflight = slot;
+    dma_ring.frame[slot].timestamp_us = timestamp_us;
+    dma_spi.start_time_us = hal_micros();
+    dma_spi.busy = true;
+    
+#ifdef CH59X
+    hal_gpio_write(dma_ring.cs_pin, 0);
+    hal_spi_xfer(dma_ring.cmd);                 // 命令字节用 PIO 发出
+    
+    // 切换为 DMA 接收, 数据直接落入槽位缓冲区
+    R8_SPI0_CTRL_MOD |= RB_SPI_FIFO_DIR;
+    R16_SPI0_DMA_BEG = (uint16_t)(uintptr_t)dma_ring_buf[slot];
+    R16_SPI0_DMA_END = (uint16_t)(uintptr_t)(dma_ring_buf[slot] + dma_ring.len);
+    R16_SPI0_TOTAL_CNT = dma_ring.len;
+    R8_SPI0_CTRL_CFG |= RB_SPI_DMA_ENABLE;
+#else
+    hal_spi_dma_ring_complete();
+#endif
+    
+    return 0;
+}
+
+void hal_spi_dma_ring_complete(void)
+{
+    int8_t slot = dma_ring.inflight;
+    if (slot < 0) {
+        return;
+    }
+    
+#ifdef CH59X
+    R8_SPI0_CTRL_CFG &= ~RB_SPI_DMA_ENABLE;
+    R8_SPI0_CTRL_MOD &= ~RB_SPI_FIFO_DIR;       // 恢复 PIO 发送方向
+    hal_gpio_write(dma_ring.cs_pin, 1);
+#endif
+    
+    dma_spi.latency_us = hal_micros() - dma_spi.start_time_us;
+    dma_spi.total_transfers++;
+    if (dma_spi.latency_us > dma_spi.max_latency_us) {
+        dma_spi.max_latency_us = dma_spi.latency_us;
+    }
+    dma_spi.busy = false;
+    
+    dma_ring.seq[slot] = dma_ring.next_seq++;
+    dma_ring.owner[slot] = DMA_SLOT_READY;
+    dma_ring.inflight = -1;
+    
+    if (dma_ring.notify) {
+        dma_ring.notify();
+    }
+}
+
+const hal_dma_frame_t *hal_spi_dma_ring_acquire(void)
+{
+    int8_t best = -1;
+    
+    // 取最早完成的 READY 槽位 (两个槽位时比较序号差)
+    for (uint8_t i = 0; i < HAL_DMA_RING_SLOTS; i++) {
+        if (dma_ring.owner[i] != DMA_SLOT_READY) continue;
+        if (best < 0 || (int8_t)(dma_ring.seq[i] - dma_ring.seq[best]) < 0) {
+            best = (int8_t)i;
+        }
+    }
+    
+    if (best < 0) {
+        return NULL;
+    }
+    
+    dma_ring.owner[best] = DMA_SLOT_CPU;
+    return &dma_ring.frame[best];
+}
+
+void hal_spi_dma_ring_release(const hal_dma_frame_t *frame)
+{
+    if (frame && frame->slot < HAL_DMA_RING_SLOTS &&
+        dma_ring.owner[frame->slot] == DMA_SLOT_CPU) {
+        dma_ring.owner[frame->slot] = DMA_SLOT_FREE;
+    }
+}
+
+bool hal_spi_dma_ring_pending(void)
+{
+    for (uint8_t i = 0; i < HAL_DMA_RING_SLOTS; i++) {
+        if (dma_ring.owner[i] == DMA_SLOT_READY) return true;
+    }
+    return false;
+}
+
+uint32_t hal_spi_dma_ring_overruns(void)
+{
+    return dma_ring.overruns;
+}
+
+void hal_spi_sync_begin(void)
+{
+    SPI_SYNC_IRQ_OFF();
+    spi_sync.depth++;
+    SPI_SYNC_IRQ_ON();
+    
+    // 此后中断不再启动新帧; 等已在途的帧在 SPI0 中断中结束 (CS 释放)
+    uint32_t start = hal_micros();
+    while (dma_ring.inflight >= 0 && (hal_micros() - start) < SPI_SYNC_WAIT_US) {
+    }
+}
+
+void hal_spi_sync_end(void)
+{
+    bool kick = false;
+    uint32_t ts = 0;
+    
+    SPI_SYNC_IRQ_OFF();
+    if (spi_sync.depth > 0 && --spi_sync.depth == 0 && spi_sync.kick_deferred) {
+        spi_sync.kick_deferred = false;
+        ts = spi_sync.kick_ts;
+        kick = true;
+    }
+    SPI_SYNC_IRQ_ON();
+    
+    // 推迟的帧补发; 无空闲槽位时照常通知, 让上层结束本次读取状态
+    if (kick && hal_spi_dma_ring_kick(ts) == -1 && dma_ring.notify) {
+        dma_ring.notify();
+    }
+}
+
 /*============================================================================
  * 状态查询
  *============================================================================*/
@@ -212,35 +558,17 @@ uint8_t* hal_dma_get_buffer(void)
 void SPI0_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void SPI0_IRQHandler(void)
 {
-    // TODO: 实现SPI DMA中断处理
-    // if (R8_SPI0_INT_FLAG & RB_SPI_IF_DMA_END) {
-    // TODO: 实现SPI DMA中断处理
-    // if (R8_SPI0_INT_FLAG & RB_SPI_IF_DMA_END) {
-    if (0) {  // 暂时禁用
-        // R8_SPI0_INT_FLAG = RB_SPI_IF_DMA_END;
-        
-        // 计算延迟
-        dma_spi.latency_us = hal_micros() - dma_spi.start_time_us;
-        dma_spi.total_transfers++;
-        
-        if (dma_spi.latency_us > dma_spi.max_latency_us) {
-            dma_spi.max_latency_us = dma_spi.latency_us;
-        }
-        dma_spi.avg_latency_us = dma_spi.avg_latency_us * 0.95f + dma_spi.latency_us * 0.05f;
-        
-        dma_spi.complete = true;
-        dma_spi.busy = false;
-        
-        // 拉高 CS
-        // hal_gpio_write(cs_pin, 1);  // 需要保存 cs_pin
-        
-        // 交换缓冲区
-        uint8_t *tmp = dma_active_buf;
-        dma_active_buf = dma_ready_buf;
-        dma_ready_buf = tmp;
-        
-        if (dma_spi.callback) {
-            dma_spi.callback(dma_ready_buf, dma_spi.transfer_len, dma_spi.callback_ctx);
+    PROF_SCOPE(PROF_SPI_DMA_ISR);
+    
+    // v0.6.3: DMA 接收计数结束 → 槽位转 READY, 或单次传输完成回调
+    if (R8_SPI0_INT_FLAG & RB_SPI_IF_CNT_END) {
+        R8_SPI0_INT_FLAG = RB_SPI_IF_CNT_END;
+        if (dma_ring.inflight >= 0) {
+            hal_spi_dma_ring_complete();
+        } else if (dma_tx.busy) {
+            spi_dma_tx_complete();
+        } else {
+            spi_dma_complete();
         }
     }
 }
@@ -6,6 +6,9 @@
  */
 
 #include "hal.h"
+#include "config.h"
+#include "optimize.h"
+#include "profile.h"
 
 #ifdef CH59X
 #include "CH59x_common.h"
@@ -28,14 +31,31 @@
  *============================================================================*/
 
 #define MAX_GPIO_CALLBACKS  8
+#define GPIO_FLAG_BITS      16      // GPIOx_ReadITFlagPort 为 16 位, PB16+ 无中断标志
 
+// v0.6.3: 按端口、按引脚号索引的回调链, 中断里用 CTZ 直接定位挂起位,
+// 不再扫描全部已注册回调. 同一引脚可挂多个回调 (INT1 由 sensor 与事件队列共用)
 typedef struct {
-    uint8_t pin;
     void (*callback)(void);
+    uint8_t next;                   // 同引脚下一个回调 (节点号 + 1, 0 = 结束)
 } gpio_callback_t;
 
 static gpio_callback_t gpio_callbacks[MAX_GPIO_CALLBACKS] = {0};
 static uint8_t callback_count = 0;
+static uint8_t gpioa_head[GPIO_FLAG_BITS] = {0};    // 节点号 + 1, 0 = 无回调
+static uint8_t gpiob_head[GPIO_FLAG_BITS] = {0};
+
+// IMU 数据就绪引脚在中断入口最先检查, 入口到回调的延迟即样本时间戳抖动
+#if defined(PIN_IMU_INT1) && (PIN_IMU_INT1 >= 0) && (PIN_IMU_INT1 < 16)
+#define GPIOA_IMU_FAST      1
+#define GPIOB_IMU_FAST      0
+#elif defined(PIN_IMU_INT1) && (PIN_IMU_INT1 >= 16) && (PIN_IMU_INT1 < 16 + GPIO_FLAG_BITS)
+#define GPIOA_IMU_FAST      0
+#define GPIOB_IMU_FAST      1
+#else
+#define GPIOA_IMU_FAST      0
+#define GPIOB_IMU_FAST      0
+#endif
 
 /*============================================================================
  * Public API
@@ -141,14 +161,28 @@ void hal_gpio_toggle(uint8_t pin)
 int hal_gpio_set_interrupt(uint8_t pin, hal_gpio_int_t type, void (*callback)(void))
 {
 #ifdef CH59X
-    if (callback_count >= MAX_GPIO_CALLBACKS) {
+    uint8_t bit = IS_PORT_A(pin) ? (pin & 0x0F) : GET_PB_PIN(pin);
+    
+    if (bit >= GPIO_FLAG_BITS) {
         return -1;
     }
     
-    // Store callback
-    gpio_callbacks[callback_count].pin = pin;
-    gpio_callbacks[callback_count].callback = callback;
-    callback_count++;
+    // Append callback to the pin's chain (NULL = wake source only, same callback once)
+    if (callback) {
+        uint8_t *link = IS_PORT_A(pin) ? &gpioa_head[bit] : &gpiob_head[bit];
+        while (*link && gpio_callbacks[*link - 1].callback != callback) {
+            link = &gpio_callbacks[*link - 1].next;
+        }
+        if (*link == 0) {
+            if (callback_count >= MAX_GPIO_CALLBACKS) {
+                return -1;
+            }
+            gpio_callbacks[callback_count].callback = callback;
+            gpio_callbacks[callback_count].next = 0;
+            callback_count++;
+            *link = callback_count;     // 节点填好后再挂入, 中断中看到的链始终完整
+        }
+    }
     
     uint32_t pin_mask;
     GPIOITModeTpDef it_mode;
@@ -188,30 +222,76 @@ int hal_gpio_set_interrupt(uint8_t pin, hal_gpio_int_t type, void (*callback)(vo
 #endif
 }
 
+int hal_gpio_set_int_edge(uint8_t pin, hal_gpio_int_t type)
+{
+#ifdef CH59X
+    GPIOITModeTpDef it_mode;
+    
+    if (type == HAL_GPIO_INT_RISING) {
+        it_mode = GPIO_ITMode_RiseEdge;
+    } else if (type == HAL_GPIO_INT_FALLING) {
+        it_mode = GPIO_ITMode_FallEdge;
+    } else {
+        return -1;
+    }
+    
+    if (IS_PORT_A(pin)) {
+        GPIOA_ITModeCfg(GET_PIN_MASK(pin), it_mode);
+        PFIC_EnableIRQ(GPIO_A_IRQn);
+    } else {
+        GPIOB_ITModeCfg(1UL << GET_PB_PIN(pin), it_mode);
+        PFIC_EnableIRQ(GPIO_B_IRQn);
+    }
+    
+    return 0;
+#else
+    (void)pin; (void)type;
+    return 0;
+#endif
+}
+
 /*============================================================================
  * Interrupt Handlers
  *============================================================================*/
 
 #ifdef CH59X
 
+__HIGH_CODE
+static inline __attribute__((always_inline)) void gpio_run_chain(uint8_t n)
+{
+    while (n) {
+        const gpio_callback_t *cb = &gpio_callbacks[n - 1];
+        cb->callback();
+        n = cb->next;
+    }
+}
+
+__HIGH_CODE
+static inline __attribute__((always_inline)) void gpio_dispatch(const uint8_t *head, uint32_t pending)
+{
+    while (pending) {
+        uint8_t n = head[CTZ(pending)];
+        pending &= pending - 1;
+        gpio_run_chain(n);
+    }
+}
+
 __INTERRUPT
 __HIGH_CODE
 __attribute__((weak))
 void GPIOA_IRQHandler(void)
 {
+    PROF_SCOPE(PROF_GPIO_ISR);
     uint16_t flag = GPIOA_ReadITFlagPort();
     GPIOA_ClearITFlagBit(flag);
     
-    for (uint8_t i = 0; i < callback_count; i++) {
-        if (IS_PORT_A(gpio_callbacks[i].pin)) {
-            uint16_t pin_mask = GET_PIN_MASK(gpio_callbacks[i].pin);
-            if (flag & pin_mask) {
-                if (gpio_callbacks[i].callback) {
-                    gpio_callbacks[i].callback();
-                }
-            }
-        }
+#if GPIOA_IMU_FAST
+    if (flag & GET_PIN_MASK(PIN_IMU_INT1)) {
+        gpio_run_chain(gpioa_head[PIN_IMU_INT1 & 0x0F]);
+        flag &= ~GET_PIN_MASK(PIN_IMU_INT1);
     }
+#endif
+    gpio_dispatch(gpioa_head, flag);
 }
 
 __INTERRUPT
@@ -219,19 +299,17 @@ __HIGH_CODE
 __attribute__((weak))
 void GPIOB_IRQHandler(void)
 {
+    PROF_SCOPE(PROF_GPIO_ISR);
     uint16_t flag = GPIOB_ReadITFlagPort();
     GPIOB_ClearITFlagBit(flag);
     
-    for (uint8_t i = 0; i < callback_count; i++) {
-        if (!IS_PORT_A(gpio_callbacks[i].pin)) {
-            uint32_t pin_mask = 1UL << GET_PB_PIN(gpio_callbacks[i].pin);
-            if (flag & pin_mask) {
-                if (gpio_callbacks[i].callback) {
-                    gpio_callbacks[i].callback();
-                }
-            }
-        }
+#if GPIOB_IMU_FAST
+    if (flag & (1UL << GET_PB_PIN(PIN_IMU_INT1))) {
+        gpio_run_chain(gpiob_head[GET_PB_PIN(PIN_IMU_INT1)]);
+        flag &= ~(1UL << GET_PB_PIN(PIN_IMU_INT1));
     }
+#endif
+    gpio_dispatch(gpiob_head, flag);
 }
 
 #endif
@@ -0,0 +1,129 @@
+/**
+ * @file hal_host.c
+ * @brief 主机回放 HAL 桩 / Stub HAL for the host-side replay build
+ *
+ * v0.6.3: 只实现传感器/融合模块和接收端射频栈用到的接口 (make replay / make netsim)
+ * - 时间由回放/仿真程序推进, 与主机时钟无关, 同一输入结果可复现
+ * - KV/Flash 总是为空: 各模块从默认参数开始, 写入被丢弃
+ * - 随机数为固定种子的 xorshift32, 仿真程序可重设种子
+ */
+
+#include "hal.h"
+#include "watchdog.h"
+#include <string.h>
+
+static uint64_t host_time_us = 0;
+static uint32_t host_random = 0x6D2B79F5u;
+
+void hal_host_set_time_us(uint64_t us)
+{
+    host_time_us = us;
+}
+
+void hal_host_seed_random(uint32_t seed)
+{
+    host_random = seed ? seed : 0x6D2B79F5u;
+}
+
+uint32_t hal_get_random_u32(void)
+{
+    host_random ^= host_random << 13;
+    host_random ^= host_random >> 17;
+    host_random ^= host_random << 5;
+    return host_random;
+}
+
+uint32_t hal_millis(void)
+{
+    return (uint32_t)(host_time_us / 1000);
+}
+
+uint32_t hal_micros(void)
+{
+    return (uint32_t)host_time_us;
+}
+
+uint64_t hal_micros64(void)
+{
+    return host_time_us;
+}
+
+uint32_t hal_get_tick_ms(void)
+{
+    return hal_millis();
+}
+
+uint32_t hal_get_tick_us(void)
+{
+    return hal_micros();
+}
+
+void hal_delay_ms(uint32_t ms)
+{
+    host_time_us += (uint64_t)ms * 1000;
+}
+
+void hal_delay_us(uint32_t us)
+{
+    host_time_us += us;
+}
+
+int hal_storage_read(uint32_t addr, void *data, uint16_t len)
+{
+    (void)addr;
+    if (data) memset(data, 0xFF, len);      // 擦除状态
+    return -1;
+}
+
+int hal_storage_write(uint32_t addr, const void *data, uint16_t len)
+{
+    (void)addr;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+int hal_storage_erase(uint32_t addr, uint16_t len)
+{
+    (void)addr;
+    (void)len;
+    return 0;
+}
+
+bool hal_storage_load_network_key(uint32_t *key)
+{
+    (void)key;
+    return false;
+}
+
+int hal_storage_save_network_key(uint32_t key)
+{
+    (void)key;
+    return 0;
+}
+
+int hal_kv_get(uint8_t key, void *data, uint16_t len)
+{
+    (void)key;
+    (void)data;
+    (void)len;
+    return HAL_KV_ERR_NOT_FOUND;
+}
+
+int hal_kv_set(uint8_t key, const void *data, uint16_t len)
+{
+    (void)key;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+int hal_kv_set_deferred(uint8_t key, const void *data, uint16_t len)
+{
+    return hal_kv_set(key, data, len);
+}
+
+reset_reason_t wdog_get_reset_reason(void)
+{
+    return RESET_REASON_POWER_ON;
+}
@@ -4,9 +4,14 @@
  * 
  * This implementation uses CH59X's I2C peripheral to provide
  * a unified interface compatible with the SlimeVR sensor drivers.
+ * 
+ * v0.6.3: USE_HW_I2C=1 时使用片上 I2C 外设 (PB12=SDA, PB13=SCL),
+ * 并提供中断驱动的 hal_i2c_read_reg_async(); 否则保留软件模拟 I2C
  */
 
 #include "hal.h"
+#include "config.h"
+#include "profile.h"
 
 #ifdef CH59X  // Only compile for CH59X target
 #include "CH59x_common.h"
@@ -19,6 +24,265 @@
 
 static uint8_t current_addr = 0;
 
+#if defined(USE_HW_I2C) && USE_HW_I2C && defined(CH59X)
+
+/*============================================================================
+ * v0.6.3: 硬件 I2C 外设后端
+ *============================================================================*/
+
+typedef struct {
+    volatile uint32_t CTRL1;
+    volatile uint32_t CTRL2;
+    volatile uint32_t STAR1;
+    volatile uint32_t STAR2;
+    volatile uint32_t DATAR;
+    volatile uint32_t CKCFGR;
+} hw_i2c_regs_t;
+
+#define HW_I2C              ((hw_i2c_regs_t *)I2C_BASE)
+
+// CTRL1
+#define I2C_CTRL1_PE        0x0001
+#define I2C_CTRL1_START     0x0100
+#define I2C_CTRL1_STOP      0x0200
+#define I2C_CTRL1_ACK       0x0400
+// CTRL2
+#define I2C_CTRL2_ITERREN   0x0100
+#define I2C_CTRL2_ITEVTEN   0x0200
+#define I2C_CTRL2_ITBUFEN   0x0400
+// STAR1
+#define I2C_STAR1_SB        0x0001
+#define I2C_STAR1_ADDR      0x0002
+#define I2C_STAR1_BTF       0x0004
+#define I2C_STAR1_RXNE      0x0040
+#define I2C_STAR1_TXE       0x0080
+#define I2C_STAR1_BERR      0x0100
+#define I2C_STAR1_ARLO      0x0200
+#define I2C_STAR1_AF        0x0400
+#define I2C_STAR1_ERR_MASK  (I2C_STAR1_BERR | I2C_STAR1_ARLO | I2C_STAR1_AF)
+
+#define HW_I2C_TIMEOUT      20000   // 轮询次数 (~1ms @ 60MHz)
+
+// 异步读取状态机
+typedef enum {
+    I2C_ASYNC_IDLE = 0,
+    I2C_ASYNC_START_W,      // 等待 START 发出, 发送 SLA+W
+    I2C_ASYNC_ADDR_W,       // 等待地址应答, 发送寄存器地址
+    I2C_ASYNC_REG,          // 寄存器地址发完, 重复 START
+    I2C_ASYNC_START_R,      // 发送 SLA+R
+    I2C_ASYNC_ADDR_R,       // 地址应答, 配置 ACK/STOP
+    I2C_ASYNC_RECV,         // 逐字节接收
+} i2c_async_phase_t;
+
+static struct {
+    volatile i2c_async_phase_t phase;
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t *buf;
+    uint16_t len;
+    volatile uint16_t idx;
+    hal_i2c_async_cb_t callback;
+    void *ctx;
+} i2c_async;
+
+static int hw_wait_flag(uint32_t flag)
+{
+    uint32_t timeout = HW_I2C_TIMEOUT;
+    uint32_t st;
+    while (!((st = HW_I2C->STAR1) & flag)) {
+        if ((st & I2C_STAR1_ERR_MASK) || --timeout == 0) {
+            HW_I2C->STAR1 = 0;                  // 清错误标志
+            HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int hw_send_addr(uint8_t sla)
+{
+    HW_I2C->CTRL1 |= I2C_CTRL1_START;
+    if (hw_wait_flag(I2C_STAR1_SB) != 0) return -1;
+    HW_I2C->DATAR = sla;
+    if (hw_wait_flag(I2C_STAR1_ADDR) != 0) return -1;
+    (void)HW_I2C->STAR2;                        // 读 STAR2 清 ADDR
+    return 0;
+}
+
+int hal_i2c_init(const hal_i2c_config_t *config)
+{
+    // 外设复用: 开漏上拉由外部电阻提供
+    GPIOB_ModeCfg(I2C_SDA_PIN | I2C_SCL_PIN, GPIO_ModeIN_PU);
+    
+    I2C_Init();
+    I2C_SetClock(config->speed_hz ? config->speed_hz : 400000);
+    HW_I2C->CTRL1 |= I2C_CTRL1_PE;
+    
+    i2c_async.phase = I2C_ASYNC_IDLE;
+    PFIC_EnableIRQ(I2C_IRQn);
+    
+    current_addr = config->addr;
+    return 0;
+}
+
+int hal_i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len)
+{
+    if (len == 0) return 0;
+    if (i2c_async.phase != I2C_ASYNC_IDLE) return -2;   // 异步传输占用总线
+    
+    if (hw_send_addr(addr << 1) != 0) return -1;
+    HW_I2C->DATAR = reg;
+    if (hw_wait_flag(I2C_STAR1_BTF) != 0) return -1;
+    
+    if (hw_send_addr((addr << 1) | 1) != 0) return -1;
+    
+    for (uint16_t i = 0; i < len; i++) {
+        if (i == len - 1) {
+            // 最后一字节: NACK + STOP
+            HW_I2C->CTRL1 &= ~I2C_CTRL1_ACK;
+            HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+        } else {
+            HW_I2C->CTRL1 |= I2C_CTRL1_ACK;
+        }
+        if (hw_wait_flag(I2C_STAR1_RXNE) != 0) return -1;
+        data[i] = (uint8_t)HW_I2C->DATAR;
+    }
+    
+    return 0;
+}
+
+int hal_i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t len)
+{
+    if (i2c_async.phase != I2C_ASYNC_IDLE) return -2;
+    
+    if (hw_send_addr(addr << 1) != 0) return -1;
+    HW_I2C->DATAR = reg;
+    if (hw_wait_flag(I2C_STAR1_TXE) != 0) return -1;
+    
+    for (uint16_t i = 0; i < len; i++) {
+        HW_I2C->DATAR = data[i];
+        if (hw_wait_flag(I2C_STAR1_TXE) != 0) return -1;
+    }
+    if (hw_wait_flag(I2C_STAR1_BTF) != 0) return -1;
+    
+    HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+    return 0;
+}
+
+int hal_i2c_read_reg_async(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len,
+                           hal_i2c_async_cb_t callback, void *ctx)
+{
+    if (!data || len == 0) return -1;
+    if (i2c_async.phase != I2C_ASYNC_IDLE) return -2;
+    
+    i2c_async.addr = addr;
+    i2c_async.reg = reg;
+    i2c_async.buf = data;
+    i2c_async.len = len;
+    i2c_async.idx = 0;
+    i2c_async.callback = callback;
+    i2c_async.ctx = ctx;
+    i2c_async.phase = I2C_ASYNC_START_W;
+    
+    HW_I2C->CTRL1 |= I2C_CTRL1_ACK;
+    HW_I2C->CTRL2 |= I2C_CTRL2_ITEVTEN | I2C_CTRL2_ITBUFEN | I2C_CTRL2_ITERREN;
+    HW_I2C->CTRL1 |= I2C_CTRL1_START;
+    return 0;
+}
+
+bool hal_i2c_busy(void)
+{
+    return i2c_async.phase != I2C_ASYNC_IDLE;
+}
+
+static void i2c_async_finish(int status)
+{
+    HW_I2C->CTRL2 &= ~(I2C_CTRL2_ITEVTEN | I2C_CTRL2_ITBUFEN | I2C_CTRL2_ITERREN);
+    i2c_async.phase = I2C_ASYNC_IDLE;
+    if (i2c_async.callback) {
+        i2c_async.callback(status, i2c_async.ctx);
+    }
+}
+
+void I2C_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void I2C_IRQHandler(void)
+{
+    PROF_SCOPE(PROF_I2C_ISR);
+    uint32_t st = HW_I2C->STAR1;
+    
+    if (st & I2C_STAR1_ERR_MASK) {
+        HW_I2C->STAR1 = 0;
+        HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+        i2c_async_finish(-1);
+        return;
+    }
+    
+    switch (i2c_async.phase) {
+        case I2C_ASYNC_START_W:
+            if (st & I2C_STAR1_SB) {
+                HW_I2C->DATAR = i2c_async.addr << 1;
+                i2c_async.phase = I2C_ASYNC_ADDR_W;
+            }
+            break;
+            
+        case I2C_ASYNC_ADDR_W:
+            if (st & I2C_STAR1_ADDR) {
+                (void)HW_I2C->STAR2;
+                HW_I2C->DATAR = i2c_async.reg;
+                i2c_async.phase = I2C_ASYNC_REG;
+            }
+            break;
+            
+        case I2C_ASYNC_REG:
+            if (st & I2C_STAR1_BTF) {
+                HW_I2C->CTRL1 |= I2C_CTRL1_START;   // 重复 START
+                i2c_async.phase = I2C_ASYNC_START_R;
+            }
+            break;
+            
+        case I2C_ASYNC_START_R:
+            if (st & I2C_STAR1_SB) {
+                HW_I2C->DATAR = (i2c_async.addr << 1) | 1;
+                i2c_async.phase = I2C_ASYNC_ADDR_R;
+            }
+            break;
+            
+        case I2C_ASYNC_ADDR_R:
+            if (st & I2C_STAR1_ADDR) {
+                if (i2c_async.len == 1) {
+                    HW_I2C->CTRL1 &= ~I2C_CTRL1_ACK;
+                    (void)HW_I2C->STAR2;
+                    HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+                } else {
+                    (void)HW_I2C->STAR2;
+                }
+                i2c_async.phase = I2C_ASYNC_RECV;
+            }
+            break;
+            
+        case I2C_ASYNC_RECV:
+            if (st & I2C_STAR1_RXNE) {
+                i2c_async.buf[i2c_async.idx++] = (uint8_t)HW_I2C->DATAR;
+                uint16_t remaining = i2c_async.len - i2c_async.idx;
+                if (remaining == 1) {
+                    // 下一字节为最后一字节
+                    HW_I2C->CTRL1 &= ~I2C_CTRL1_ACK;
+                    HW_I2C->CTRL1 |= I2C_CTRL1_STOP;
+                } else if (remaining == 0) {
+                    i2c_async_finish(0);
+                }
+            }
+            break;
+            
+        default:
+            // 非预期中断: 关闭中断源
+            HW_I2C->CTRL2 &= ~(I2C_CTRL2_ITEVTEN | I2C_CTRL2_ITBUFEN | I2C_CTRL2_ITERREN);
+            break;
+    }
+}
+
+#else /* 软件模拟 I2C */
+
 int hal_i2c_init(const hal_i2c_config_t *config)
 {
 #ifdef CH59X
@@ -26,9 +290,6 @@ int hal_i2c_init(const hal_i2c_config_t *config)
     GPIOB_SetBits(I2C_SDA_PIN | I2C_SCL_PIN);
     GPIOB_ModeCfg(I2C_SDA_PIN | I2C_SCL_PIN, GPIO_ModeOut_PP_5mA);
     
-    // Note: CH59X uses software I2C by default
-    // For hardware I2C, additional configuration is needed
-    
     current_addr = config->addr;
 #endif
     return 0;
@@ -197,3 +458,23 @@ int hal_i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t *data, uint16_t l
     return -1;
 #endif
 }
+
+/**
+ * 软件 I2C 下没有后台传输: 同步完成后立即回调
+ */
+int hal_i2c_read_reg_async(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len,
+                           hal_i2c_async_cb_t callback, void *ctx)
+{
+    int ret = hal_i2c_read_reg(addr, reg, data, len);
+    if (callback) {
+        callback(ret, ctx);
+    }
+    return 0;
+}
+
+bool hal_i2c_busy(void)
+{
+    return false;
+}
+
+#endif /* USE_HW_I2C */
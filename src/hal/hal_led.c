@@ -0,0 +1,99 @@
+/**
+ * @file hal_led.c
+ * @brief LED 图案驱动 / Timer-driven LED patterns
+ *
+ * v0.6.3: 见 hal_led.h
+ */
+
+#include "hal_led.h"
+#include "hal.h"
+#include "optimize.h"
+
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+
+/*============================================================================
+ * 图案表
+ *============================================================================*/
+
+typedef struct {
+    uint16_t on_ms;         // 0 = 常灭
+    uint16_t off_ms;        // 0 = 常亮
+} led_pattern_def_t;
+
+static const led_pattern_def_t pattern_table[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_OFF]         = { 0,   0 },
+    [LED_PATTERN_ON]          = { 1,   0 },
+    [LED_PATTERN_BLINK_SLOW]  = { 500, 500 },
+    [LED_PATTERN_BLINK_PAIR]  = { 200, 200 },
+    [LED_PATTERN_BLINK_FAST]  = { 100, 100 },
+    [LED_PATTERN_BLINK_RAPID] = { 50,  50 },
+};
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static struct {
+    uint8_t pin;
+    volatile uint8_t request;   // 主循环写, 中断读
+    uint8_t active;             // 以下只在中断中访问
+    bool lit;
+    uint16_t phase_ms;
+    uint8_t pwm_ms;
+} led;
+
+void hal_led_init(uint8_t pin)
+{
+    led.pin = pin;
+    led.request = LED_PATTERN_OFF;
+    led.active = LED_PATTERN_OFF;
+    led.lit = false;
+    led.phase_ms = 0;
+    led.pwm_ms = 0;
+    hal_gpio_write(pin, false);
+}
+
+void hal_led_set_pattern(led_pattern_t pattern)
+{
+    if (pattern >= LED_PATTERN_COUNT) return;
+    led.request = (uint8_t)pattern;
+
+    // 休眠可能在下一个节拍之前停掉 TMR0; 中断看到 OFF 时只会再写一次低电平
+    if (pattern == LED_PATTERN_OFF) {
+        hal_gpio_write(led.pin, false);
+    }
+}
+
+led_pattern_t hal_led_get_pattern(void)
+{
+    return (led_pattern_t)led.request;
+}
+
+RAM_CODE_ISR
+void hal_led_tick_isr(void)
+{
+    if (led.request != led.active) {
+        led.active = led.request;
+        led.phase_ms = 0;
+        led.pwm_ms = 0;
+    }
+
+    const led_pattern_def_t *p = &pattern_table[led.active];
+    bool on = false;
+
+    if (p->on_ms) {
+        on = (p->off_ms == 0) || (led.phase_ms < p->on_ms);
+        if (++led.phase_ms >= p->on_ms + p->off_ms) led.phase_ms = 0;
+
+        // 亮期内软件 PWM 调光
+        if (on) on = (led.pwm_ms < LED_PWM_ON_MS);
+        if (++led.pwm_ms >= LED_PWM_PERIOD_MS) led.pwm_ms = 0;
+    }
+
+    if (on != led.lit) {
+        led.lit = on;
+        hal_gpio_write(led.pin, on);
+    }
+}
+
+#endif /* USE_LED_PATTERN */
@@ -7,6 +7,7 @@
  */
 
 #include "hal.h"
+#include "config.h"
 
 #ifdef CH59X
 #include "CH59x_common.h"
@@ -35,6 +36,29 @@
 static uint8_t current_cs_pin = 0;
 static bool spi_initialized = false;
 
+// v0.6.3: SCK = Fsys / div (div = 2..255)
+#define SPI_DIV_MIN     2
+#define SPI_DIV_MAX     255
+
+// 不超过 max_hz 的最小分频
+static uint8_t spi_div_for(uint32_t sys_hz, uint32_t max_hz)
+{
+    if (max_hz == 0) return SPI_DIV_MAX;
+    uint32_t div = (sys_hz + max_hz - 1) / max_hz;
+    if (div < SPI_DIV_MIN) div = SPI_DIV_MIN;
+    if (div > SPI_DIV_MAX) div = SPI_DIV_MAX;
+    return (uint8_t)div;
+}
+
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+static struct {
+    uint32_t max_hz;        // 0 = 未设置
+    uint8_t div;            // 当前系统时钟下派生的分频
+} spi_profiles[HAL_SPI_DEV_COUNT];
+
+static uint8_t spi_cur_dev = HAL_SPI_DEV_COUNT;
+#endif
+
 /*============================================================================
  * Public API
  *============================================================================*/
@@ -57,25 +81,8 @@ int hal_spi_init(const hal_spi_config_t *config)
     GPIOA_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeOut_PP_5mA);  // SCK, MOSI
     GPIOA_ModeCfg(GPIO_Pin_14, GPIO_ModeIN_PU);  // MISO
     
-    // Calculate clock divider
-    // SPI clock = SYS_CLK / (div * 2), where div = 1-255
-    // For 60MHz system clock:
-    //   div=1  -> 30MHz
-    //   div=3  -> 10MHz
-    //   div=6  -> 5MHz
-    //   div=30 -> 1MHz
-    uint8_t div;
-    if (config->speed_hz >= 30000000) {
-        div = 1;
-    } else if (config->speed_hz >= 10000000) {
-        div = 3;
-    } else if (config->speed_hz >= 5000000) {
-        div = 6;
-    } else if (config->speed_hz >= 1000000) {
-        div = 30;
-    } else {
-        div = 60;  // 500kHz
-    }
+    // v0.6.3: 按当前系统时钟取不超过 speed_hz 的最小分频
+    uint8_t div = spi_div_for(hal_get_sysclk_hz(), config->speed_hz);
     
     // Initialize SPI0 as master
     SPI0_MasterDefInit();
@@ -127,6 +134,7 @@ int hal_spi_transfer(const uint8_t *tx, uint8_t *rx, uint16_t len)
         return -1;
     }
     
+    hal_spi_sync_begin();   // v0.6.3: 与乒乓环 DMA 互斥
     spi_cs_low();
     
     for (uint16_t i = 0; i < len; i++) {
@@ -138,6 +146,7 @@ int hal_spi_transfer(const uint8_t *tx, uint8_t *rx, uint16_t len)
     }
     
     spi_cs_high();
+    hal_spi_sync_end();
     return 0;
 #else
     (void)tx; (void)rx; (void)len;
@@ -152,6 +161,7 @@ int hal_spi_read_reg(uint8_t reg, uint8_t *data, uint16_t len)
         return -1;
     }
     
+    hal_spi_sync_begin();   // v0.6.3: 与乒乓环 DMA 互斥
     spi_cs_low();
     
     // Send register address with read bit (0x80)
@@ -163,6 +173,7 @@ int hal_spi_read_reg(uint8_t reg, uint8_t *data, uint16_t len)
     }
     
     spi_cs_high();
+    hal_spi_sync_end();
     return 0;
 #else
     (void)reg; (void)data; (void)len;
@@ -177,6 +188,7 @@ int hal_spi_write_reg(uint8_t reg, const uint8_t *data, uint16_t len)
         return -1;
     }
     
+    hal_spi_sync_begin();   // v0.6.3: 与乒乓环 DMA 互斥
     spi_cs_low();
     
     // Send register address (write bit is 0)
@@ -188,6 +200,7 @@ int hal_spi_write_reg(uint8_t reg, const uint8_t *data, uint16_t len)
     }
     
     spi_cs_high();
+    hal_spi_sync_end();
     return 0;
 #else
     (void)reg; (void)data; (void)len;
@@ -226,3 +239,68 @@ void hal_spi_cs(uint8_t state)
     (void)state;
 #endif
 }
+
+/*============================================================================
+ * v0.6.3: 每设备时钟档 / Per-device clock profiles
+ *============================================================================*/
+
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+
+// 每次都写寄存器: SPI0_MasterDefInit 会把分频复位
+static void spi_write_div(uint8_t div)
+{
+#ifdef CH59X
+    SPI0_CLKCfg(div);
+#else
+    (void)div;
+#endif
+}
+
+int hal_spi_profile_set(uint8_t dev, uint32_t max_hz)
+{
+    if (dev >= HAL_SPI_DEV_COUNT || max_hz == 0) return -1;
+    
+    spi_profiles[dev].max_hz = max_hz;
+    spi_profiles[dev].div = spi_div_for(hal_get_sysclk_hz(), max_hz);
+    if (dev == spi_cur_dev) {
+        spi_write_div(spi_profiles[dev].div);
+    }
+    return 0;
+}
+
+uint32_t hal_spi_profile_hz(uint8_t dev)
+{
+    if (dev >= HAL_SPI_DEV_COUNT || spi_profiles[dev].max_hz == 0) return 0;
+    // 向上取整: 以此值再调用 hal_spi_profile_set 得到同一分频
+    uint8_t div = spi_profiles[dev].div;
+    return (hal_get_sysclk_hz() + div - 1) / div;
+}
+
+uint32_t hal_spi_step_down(uint32_t hz)
+{
+    uint32_t sys_hz = hal_get_sysclk_hz();
+    uint8_t div = spi_div_for(sys_hz, hz);
+    if (div >= SPI_DIV_MAX) return 0;
+    return (sys_hz + div) / (div + 1);  // 向上取整, 同上
+}
+
+void hal_spi_select(uint8_t dev)
+{
+    if (dev >= HAL_SPI_DEV_COUNT || spi_profiles[dev].max_hz == 0) return;
+    spi_cur_dev = dev;
+    spi_write_div(spi_profiles[dev].div);
+}
+
+void hal_spi_set_sysclk(uint32_t hz)
+{
+    for (uint8_t i = 0; i < HAL_SPI_DEV_COUNT; i++) {
+        if (spi_profiles[i].max_hz != 0) {
+            spi_profiles[i].div = spi_div_for(hz, spi_profiles[i].max_hz);
+        }
+    }
+    if (spi_cur_dev < HAL_SPI_DEV_COUNT) {
+        spi_write_div(spi_profiles[spi_cur_dev].div);
+    }
+}
+
+#endif /* USE_SPI_PROFILES */
@@ -6,9 +6,11 @@
  * and pairing information. Uses CH59X DataFlash area.
  * 
  * v0.6.2: 添加双备份原子写入机制 (CRC + dual backup)
+ * v0.6.3: 双备份 Bank 改为追加写键值日志 (原 Bank B 区域), 见 hal_kv_*
  */
 
 #include "hal.h"
+#include <stddef.h>
 #include <string.h>
 
 #ifdef CH59X
@@ -26,14 +28,7 @@
 #define STORAGE_SIZE            4096
 #define STORAGE_PAGE_SIZE       256
 
-// v0.6.2: 双备份存储布局
-// Bank A: 0x0000 - 0x07FF (2KB)
-// Bank B: 0x0800 - 0x0FFF (2KB)
-#define STORAGE_BANK_SIZE       2048
-#define STORAGE_BANK_A          0x0000
-#define STORAGE_BANK_B          0x0800
-
-// Storage layout (每个Bank内)
+// Storage layout (旧版固定偏移, 0x0000 - 0x07FF)
 #define STORAGE_MAGIC_ADDR      0x0000
 #define STORAGE_MAGIC_VALUE     0x534C564D  // "SLVM"
 #define STORAGE_VERSION         0x0002      // v0.6.2升级版本号
@@ -42,7 +37,7 @@
 #define CALIB_STORAGE_ADDR      0x0100  // Calibration data
 #define PAIR_STORAGE_ADDR       0x0200  // Pairing data
 
-// v0.6.2: 双备份块头
+// v0.6.2: 块头 (v0.6.3: 用作键值日志段头)
 typedef struct {
     uint32_t magic;         // STORAGE_MAGIC_VALUE
     uint16_t version;       // 存储版本
@@ -51,29 +46,6 @@ typedef struct {
     uint16_t crc16;         // CRC16校验
 } storage_block_header_t;
 
-// 当前活跃Bank
-static uint8_t active_bank = 0;  // 0=BankA, 1=BankB
-
-/*============================================================================
- * CRC16计算 (用于数据完整性)
- *============================================================================*/
-
-static uint16_t calc_crc16(const uint8_t *data, uint16_t len)
-{
-    uint16_t crc = 0xFFFF;
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    return crc;
-}
-
 /*============================================================================
  * Internal Functions
  *============================================================================*/
@@ -89,83 +61,6 @@ static bool storage_check_magic(void)
 #endif
 }
 
-// v0.6.2: 验证Bank数据完整性
-static bool storage_verify_bank(uint32_t bank_offset, storage_block_header_t *header)
-{
-#ifdef CH59X
-    // 读取头部
-    EEPROM_READ(STORAGE_BASE_ADDR + bank_offset, header, sizeof(*header));
-    
-    // 检查magic
-    if (header->magic != STORAGE_MAGIC_VALUE) {
-        return false;
-    }
-    
-    // 检查数据长度合理性
-    if (header->data_len > STORAGE_BANK_SIZE - sizeof(storage_block_header_t)) {
-        return false;
-    }
-    
-    // 读取数据并验证CRC
-    if (header->data_len > 0) {
-        uint8_t buf[256];  // 分块验证
-        uint16_t calc_crc = 0xFFFF;
-        uint16_t remaining = header->data_len;
-        uint32_t offset = bank_offset + sizeof(storage_block_header_t);
-        
-        while (remaining > 0) {
-            uint16_t chunk = (remaining > 256) ? 256 : remaining;
-            EEPROM_READ(STORAGE_BASE_ADDR + offset, buf, chunk);
-            
-            // 累积CRC
-            for (uint16_t i = 0; i < chunk; i++) {
-                calc_crc ^= buf[i];
-                for (uint8_t j = 0; j < 8; j++) {
-                    if (calc_crc & 1) calc_crc = (calc_crc >> 1) ^ 0xA001;
-                    else calc_crc >>= 1;
-                }
-            }
-            
-            offset += chunk;
-            remaining -= chunk;
-        }
-        
-        if (calc_crc != header->crc16) {
-            return false;
-        }
-    }
-    
-    return true;
-#else
-    (void)bank_offset; (void)header;
-    return true;
-#endif
-}
-
-// v0.6.2: 确定活跃Bank (序列号更大且有效的)
-static void storage_determine_active_bank(void)
-{
-#ifdef CH59X
-    storage_block_header_t header_a, header_b;
-    bool valid_a = storage_verify_bank(STORAGE_BANK_A, &header_a);
-    bool valid_b = storage_verify_bank(STORAGE_BANK_B, &header_b);
-    
-    if (valid_a && valid_b) {
-        // 两个都有效，选序列号更大的
-        // 处理序列号回绕: 如果差值很大，说明回绕了
-        int16_t diff = (int16_t)(header_a.sequence - header_b.sequence);
-        active_bank = (diff > 0) ? 0 : 1;
-    } else if (valid_a) {
-        active_bank = 0;
-    } else if (valid_b) {
-        active_bank = 1;
-    } else {
-        // 都无效，使用Bank A
-        active_bank = 0;
-    }
-#endif
-}
-
 static void storage_write_magic(void)
 {
 #ifdef CH59X
@@ -178,12 +73,11 @@ static void storage_write_magic(void)
  * Public API
  *============================================================================*/
 
+static int kv_init(void);
+
 int hal_storage_init(void)
 {
 #ifdef CH59X
-    // v0.6.2: 确定活跃Bank
-    storage_determine_active_bank();
-    
     // Check if storage has been initialized
     if (!storage_check_magic()) {
         // First time use - erase and initialize both banks
@@ -194,7 +88,7 @@ int hal_storage_init(void)
         uint16_t version = STORAGE_VERSION;
         EEPROM_WRITE(STORAGE_BASE_ADDR + 4, &version, sizeof(version));
     }
-    return 0;
+    return kv_init();
 #else
     return 0;
 #endif
@@ -262,6 +156,473 @@ int hal_storage_erase(uint32_t addr, uint16_t len)
 #endif
 }
 
+/*============================================================================
+ * v0.6.3: 追加写键值日志 (原 Bank B 区域 0x0800 - 0x0FFF)
+ *
+ * 两个 1KB 段轮流使用, 段头 storage_block_header_t:
+ *   magic = KV_SEG_MAGIC, sequence = 代数 (大者为活跃段), data_len = 整理后
+ *   的记录字节数, crc16 覆盖前 10 字节; 段头在整理完成后最后写入
+ * 记录 4 字节对齐: kv_record_t + 值, 先写值再写记录头 (提交标记)
+ * 同一键的新记录覆盖旧记录, len = 0 为删除标记; 段满时把每个键的最新记录
+ * (含删除标记, 区分"已删除"与"从未写入") 整理到另一段, 擦写分摊到两段的 8 页上
+ *============================================================================*/
+
+#define KV_BASE_ADDR            0x0800
+#define KV_SEG_SIZE             0x0400
+#define KV_SEG_COUNT            2
+#define KV_SEG_PAGES            (KV_SEG_SIZE / STORAGE_PAGE_SIZE)
+#define KV_SEG_MAGIC            0x564B4C53  // "SLKV"
+#define KV_SEG_VERSION          0x0001
+#define KV_REC_MAGIC            0x4B52
+#define KV_ALIGN(n)             (((n) + 3u) & ~3u)
+
+typedef struct {
+    uint16_t magic;         // KV_REC_MAGIC, 0xFFFF = 日志末尾
+    uint8_t key;
+    uint8_t len;            // 值长度, 0 = 删除
+    uint16_t crc16;         // 覆盖 key/len/值
+} __attribute__((packed)) kv_record_t;
+
+#define KV_DATA_START           KV_ALIGN(sizeof(storage_block_header_t))
+#define KV_REC_SIZE(len)        KV_ALIGN(sizeof(kv_record_t) + (len))
+
+typedef struct {
+    uint16_t off;           // 记录在段内的偏移, 0 = 从未写入
+    uint8_t len;            // 0 = 已删除
+} kv_entry_t;
+
+static kv_entry_t kv_index[HAL_KV_MAX_KEYS];
+static uint8_t kv_seg = 0;          // 活跃段
+static uint16_t kv_seq = 0;         // 活跃段代数
+static uint16_t kv_end = 0;         // 下一条记录的段内偏移
+static bool kv_ready = false;
+static uint8_t kv_standby_blank = 0;    // 备用段已预擦除的页 (bit), 见后台写入
+static uint8_t kv_buf[HAL_KV_MAX_VALUE];
+
+static uint32_t kv_seg_addr(uint8_t seg)
+{
+    return KV_BASE_ADDR + (uint32_t)seg * KV_SEG_SIZE;
+}
+
+static uint16_t kv_record_crc(uint8_t key, uint8_t len, const void *value)
+{
+    uint8_t kl[2] = { key, len };
+    uint16_t crc = hal_crc16_update(HAL_CRC16_INIT, kl, sizeof(kl));
+    return hal_crc16_update(crc, value, len);
+}
+
+static bool kv_read_header(uint8_t seg, storage_block_header_t *hdr)
+{
+    if (hal_storage_read(kv_seg_addr(seg), hdr, sizeof(*hdr)) != 0) return false;
+    if (hdr->magic != KV_SEG_MAGIC || hdr->version != KV_SEG_VERSION) return false;
+    return hdr->crc16 == hal_crc16(hdr, offsetof(storage_block_header_t, crc16));
+}
+
+// 写入并回读校验, 0 成功
+static int kv_program(uint32_t addr, const void *data, uint16_t len)
+{
+    if (hal_storage_write(addr, data, len) != 0) return -1;
+
+    uint8_t chk[16];
+    const uint8_t *p = (const uint8_t *)data;
+    for (uint16_t done = 0; done < len; done += sizeof(chk)) {
+        uint16_t left = len - done;
+        uint16_t n = (left > sizeof(chk)) ? sizeof(chk) : left;
+        if (hal_storage_read(addr + done, chk, n) != 0) return -1;
+        if (memcmp(chk, p + done, n) != 0) return -1;
+    }
+    return 0;
+}
+
+// 扫描活跃段, 重建索引并定位日志末尾
+static void kv_scan(void)
+{
+    uint32_t base = kv_seg_addr(kv_seg);
+    uint16_t off = KV_DATA_START;
+
+    memset(kv_index, 0, sizeof(kv_index));
+    while (off + sizeof(kv_record_t) <= KV_SEG_SIZE) {
+        kv_record_t rec;
+        if (hal_storage_read(base + off, &rec, sizeof(rec)) != 0) break;
+        if (rec.magic != KV_REC_MAGIC || rec.key >= HAL_KV_MAX_KEYS ||
+            rec.len > HAL_KV_MAX_VALUE || off + KV_REC_SIZE(rec.len) > KV_SEG_SIZE) {
+            break;
+        }
+
+        // 写坏的记录跳过, 保留该键之前的值
+        if (hal_storage_read(base + off + sizeof(rec), kv_buf, rec.len) == 0 &&
+            kv_record_crc(rec.key, rec.len, kv_buf) == rec.crc16) {
+            kv_index[rec.key].off = off;
+            kv_index[rec.key].len = rec.len;
+        }
+        off += KV_REC_SIZE(rec.len);
+    }
+    kv_end = off;
+}
+
+// 记录写入位置 off (段内), 先值后头
+static int kv_write_record(uint8_t seg, uint16_t off, uint8_t key,
+                           const void *value, uint8_t len)
+{
+    uint32_t addr = kv_seg_addr(seg) + off;
+    kv_record_t rec = {
+        .magic = KV_REC_MAGIC,
+        .key = key,
+        .len = len,
+        .crc16 = kv_record_crc(key, len, value),
+    };
+
+    if (len && kv_program(addr + sizeof(rec), value, len) != 0) return -1;
+    return kv_program(addr, &rec, sizeof(rec));
+}
+
+// 把有效记录整理到另一段, 段头最后写入
+static int kv_compact_to_other(void)
+{
+    uint8_t dst = (uint8_t)((kv_seg + 1) % KV_SEG_COUNT);
+    uint32_t src_base = kv_seg_addr(kv_seg);
+    uint16_t off = KV_DATA_START;
+    kv_record_t rec;
+
+    for (uint8_t page = 0; page < KV_SEG_PAGES; page++) {
+        if (kv_standby_blank & (1u << page)) continue;
+        if (hal_storage_erase(kv_seg_addr(dst) + (uint32_t)page * STORAGE_PAGE_SIZE,
+                              STORAGE_PAGE_SIZE) != 0) {
+            return -1;
+        }
+    }
+    kv_standby_blank = 0;
+
+    for (uint8_t key = 0; key < HAL_KV_MAX_KEYS; key++) {
+        kv_entry_t *e = &kv_index[key];
+        if (!e->off) continue;
+        if (hal_storage_read(src_base + e->off, &rec, sizeof(rec)) != 0 ||
+            hal_storage_read(src_base + e->off + sizeof(rec), kv_buf, e->len) != 0 ||
+            kv_record_crc(key, e->len, kv_buf) != rec.crc16) {
+            continue;   // 源记录已损坏, 丢弃该键
+        }
+        // 目标段放不下: 放弃整理, 尚未切段, 活动段保持原样
+        if (off + KV_REC_SIZE(e->len) > KV_SEG_SIZE) return HAL_KV_ERR_FULL;
+        if (kv_write_record(dst, off, key, kv_buf, e->len) != 0) return -1;
+        off += KV_REC_SIZE(e->len);
+    }
+
+    storage_block_header_t hdr = {
+        .magic = KV_SEG_MAGIC,
+        .version = KV_SEG_VERSION,
+        .sequence = (uint16_t)(kv_seq + 1),
+        .data_len = (uint16_t)(off - KV_DATA_START),
+    };
+    hdr.crc16 = hal_crc16(&hdr, offsetof(storage_block_header_t, crc16));
+    if (kv_program(kv_seg_addr(dst), &hdr, sizeof(hdr)) != 0) return -1;
+
+    kv_seg = dst;
+    kv_seq = hdr.sequence;
+    kv_scan();
+    return 0;
+}
+
+static int kv_init(void)
+{
+    storage_block_header_t hdr[KV_SEG_COUNT];
+    bool valid[KV_SEG_COUNT];
+
+    for (uint8_t s = 0; s < KV_SEG_COUNT; s++) {
+        valid[s] = kv_read_header(s, &hdr[s]);
+    }
+
+    if (valid[0] && valid[1]) {
+        kv_seg = ((int16_t)(hdr[1].sequence - hdr[0].sequence) > 0) ? 1 : 0;
+    } else if (valid[0] || valid[1]) {
+        kv_seg = valid[1] ? 1 : 0;
+    } else {
+        // 首次使用: 格式化段 0
+        storage_block_header_t h = {
+            .magic = KV_SEG_MAGIC,
+            .version = KV_SEG_VERSION,
+            .sequence = 0,
+            .data_len = 0,
+        };
+        h.crc16 = hal_crc16(&h, offsetof(storage_block_header_t, crc16));
+        if (hal_storage_erase(kv_seg_addr(0), KV_SEG_SIZE) != 0 ||
+            kv_program(kv_seg_addr(0), &h, sizeof(h)) != 0) {
+            return -1;
+        }
+        kv_seg = 0;
+        hdr[0] = h;
+    }
+
+    kv_seq = hdr[kv_seg].sequence;
+    kv_scan();
+    kv_ready = true;
+    return 0;
+}
+
+// 追加一条记录, 段满或回读失败时整理后重试一次
+static int kv_append(uint8_t key, const void *data, uint8_t len)
+{
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        if (kv_end + KV_REC_SIZE(len) > KV_SEG_SIZE) {
+            int ret = kv_compact_to_other();
+            if (ret != 0) return (ret == HAL_KV_ERR_FULL) ? ret : HAL_KV_ERR_IO;
+            if (kv_end + KV_REC_SIZE(len) > KV_SEG_SIZE) return HAL_KV_ERR_FULL;
+        }
+
+        uint16_t off = kv_end;
+        kv_end += KV_REC_SIZE(len);
+        if (kv_write_record(kv_seg, off, key, data, len) == 0) {
+            kv_index[key].off = off;
+            kv_index[key].len = len;
+            return 0;
+        }
+
+        // 回读不符 (如上次掉电留下的半条记录): 跳过该区域, 整理到另一段
+        int ret = kv_compact_to_other();
+        if (ret != 0) return (ret == HAL_KV_ERR_FULL) ? ret : HAL_KV_ERR_IO;
+    }
+    return HAL_KV_ERR_IO;
+}
+
+/*
+ * v0.6.3: 后台写入 (只在 RF 空闲窗口内擦写)
+ *
+ * CH59x 擦写 DataFlash 期间 CPU 取指停顿, 中断也得不到响应, 跨过时隙就会丢帧.
+ * hal_kv_set_deferred 只把值缓存在 RAM; hal_storage_process 每次最多执行一步
+ * (预擦除备用段一页 / 整理 / 追加一条记录), 且只在窗口回调给出的空闲时间
+ * 不小于该步的估计耗时时执行. 耗时按实测学习, 等待超过 STORAGE_DEFER_MAX_MS
+ * 后不再等窗口.
+ */
+
+#define STORAGE_DEFER_SLOTS     2
+#define STORAGE_DEFER_MAX_MS    2000
+#define STORAGE_ERASE_US_INIT   3000    // 初始估计偏保守, 首次实测后收敛
+#define STORAGE_APPEND_US_INIT  1000
+#define STORAGE_COMPACT_US_INIT 4000
+
+typedef struct {
+    bool used;
+    uint8_t key;
+    uint8_t len;
+    uint32_t queued_ms;     // 首次入队时刻 (同键更新不刷新, 保证最终写入)
+    uint8_t data[HAL_KV_MAX_VALUE];
+} kv_defer_t;
+
+static kv_defer_t kv_defer[STORAGE_DEFER_SLOTS];
+static hal_storage_window_cb_t window_cb = NULL;
+static uint32_t cost_erase_us = STORAGE_ERASE_US_INIT;
+static uint32_t cost_append_us = STORAGE_APPEND_US_INIT;
+static uint32_t cost_compact_us = STORAGE_COMPACT_US_INIT;
+
+static kv_defer_t *defer_find(uint8_t key)
+{
+    for (uint8_t i = 0; i < STORAGE_DEFER_SLOTS; i++) {
+        if (kv_defer[i].used && kv_defer[i].key == key) return &kv_defer[i];
+    }
+    return NULL;
+}
+
+static kv_defer_t *defer_oldest(void)
+{
+    kv_defer_t *oldest = NULL;
+    for (uint8_t i = 0; i < STORAGE_DEFER_SLOTS; i++) {
+        kv_defer_t *d = &kv_defer[i];
+        if (d->used && (!oldest || (int32_t)(d->queued_ms - oldest->queued_ms) < 0)) {
+            oldest = d;
+        }
+    }
+    return oldest;
+}
+
+// 取较大值, 缓慢衰减 (偶发的长耗时不会马上被忘掉)
+static void cost_learn(uint32_t *est, uint32_t measured)
+{
+    if (measured > *est) {
+        *est = measured;
+    } else {
+        *est -= (*est - measured) / 8;
+    }
+}
+
+int hal_kv_get(uint8_t key, void *data, uint16_t len)
+{
+    if (key >= HAL_KV_MAX_KEYS || !data) return HAL_KV_ERR_PARAM;
+
+    // 待写的值比 Flash 中的新
+    const kv_defer_t *d = defer_find(key);
+    if (d) {
+        memcpy(data, d->data, (len < d->len) ? len : d->len);
+        return d->len;
+    }
+    if (!kv_ready) return HAL_KV_ERR_IO;
+
+    const kv_entry_t *e = &kv_index[key];
+    if (!e->off) return HAL_KV_ERR_NOT_FOUND;
+    if (!e->len) return HAL_KV_ERR_DELETED;
+
+    uint32_t addr = kv_seg_addr(kv_seg) + e->off;
+    kv_record_t rec;
+    if (hal_storage_read(addr, &rec, sizeof(rec)) != 0 ||
+        hal_storage_read(addr + sizeof(rec), kv_buf, e->len) != 0) {
+        return HAL_KV_ERR_IO;
+    }
+    if (kv_record_crc(key, e->len, kv_buf) != rec.crc16) return HAL_KV_ERR_CRC;
+
+    memcpy(data, kv_buf, (len < e->len) ? len : e->len);
+    return e->len;
+}
+
+static int kv_set_now(uint8_t key, const void *data, uint16_t len)
+{
+    if (!kv_ready) return HAL_KV_ERR_IO;
+
+    // 值未变化时不写 Flash
+    const kv_entry_t *e = &kv_index[key];
+    if (e->off && e->len == len) {
+        kv_record_t rec;
+        uint32_t addr = kv_seg_addr(kv_seg) + e->off;
+        if (hal_storage_read(addr, &rec, sizeof(rec)) == 0 &&
+            hal_storage_read(addr + sizeof(rec), kv_buf, len) == 0 &&
+            rec.crc16 == kv_record_crc(key, (uint8_t)len, kv_buf) &&
+            memcmp(kv_buf, data, len) == 0) {
+            return 0;
+        }
+    }
+
+    return kv_append(key, data, (uint8_t)len);
+}
+
+int hal_kv_set(uint8_t key, const void *data, uint16_t len)
+{
+    if (key >= HAL_KV_MAX_KEYS || !data || len == 0 || len > HAL_KV_MAX_VALUE) {
+        return HAL_KV_ERR_PARAM;
+    }
+
+    // 同步写入取代尚未执行的后台写入
+    kv_defer_t *d = defer_find(key);
+    if (d) d->used = false;
+    return kv_set_now(key, data, len);
+}
+
+int hal_kv_delete(uint8_t key)
+{
+    if (key >= HAL_KV_MAX_KEYS) return HAL_KV_ERR_PARAM;
+
+    kv_defer_t *d = defer_find(key);
+    if (d) d->used = false;
+    if (!kv_ready) return HAL_KV_ERR_IO;
+
+    // 从未写入的键也写删除标记, 让调用方不再回退旧数据
+    if (kv_index[key].off && !kv_index[key].len) return 0;
+    return kv_append(key, NULL, 0);
+}
+
+int hal_kv_compact(void)
+{
+    if (!kv_ready) return HAL_KV_ERR_IO;
+    int ret = kv_compact_to_other();
+    return (ret == 0 || ret == HAL_KV_ERR_FULL) ? ret : HAL_KV_ERR_IO;
+}
+
+uint16_t hal_kv_free_bytes(void)
+{
+    if (!kv_ready) return 0;
+    return (uint16_t)(KV_SEG_SIZE - kv_end);
+}
+
+int hal_kv_set_deferred(uint8_t key, const void *data, uint16_t len)
+{
+    if (key >= HAL_KV_MAX_KEYS || !data || len == 0 || len > HAL_KV_MAX_VALUE) {
+        return HAL_KV_ERR_PARAM;
+    }
+
+    kv_defer_t *d = defer_find(key);
+    if (!d) {
+        for (uint8_t i = 0; i < STORAGE_DEFER_SLOTS && !d; i++) {
+            if (!kv_defer[i].used) d = &kv_defer[i];
+        }
+        if (!d) {
+            // 队列满: 同步写入最旧的一项腾出位置
+            d = defer_oldest();
+            d->used = false;
+            kv_set_now(d->key, d->data, d->len);
+        }
+        d->key = key;
+        d->queued_ms = hal_get_tick_ms();
+    }
+
+    memcpy(d->data, data, len);
+    d->len = (uint8_t)len;
+    d->used = true;
+    return 0;
+}
+
+void hal_storage_set_window_cb(hal_storage_window_cb_t cb)
+{
+    window_cb = cb;
+}
+
+void hal_storage_process(void)
+{
+    kv_defer_t *d = defer_oldest();
+    if (!d || !kv_ready) return;
+
+    uint32_t idle_us = window_cb ? window_cb() : UINT32_MAX;
+    bool overdue = (hal_get_tick_ms() - d->queued_ms) >= STORAGE_DEFER_MAX_MS;
+    uint32_t t0;
+
+    if (kv_end + KV_REC_SIZE(d->len) > KV_SEG_SIZE) {
+        // 段满: 先逐页预擦除备用段, 整理时只剩编程
+        uint8_t page = 0;
+        while (page < KV_SEG_PAGES && (kv_standby_blank & (1u << page))) page++;
+
+        if (page < KV_SEG_PAGES) {
+            if (idle_us < cost_erase_us && !overdue) return;
+            uint8_t dst = (uint8_t)((kv_seg + 1) % KV_SEG_COUNT);
+            t0 = hal_micros();
+            int ret = hal_storage_erase(kv_seg_addr(dst) + (uint32_t)page * STORAGE_PAGE_SIZE,
+                                        STORAGE_PAGE_SIZE);
+            cost_learn(&cost_erase_us, hal_micros() - t0);
+            if (ret == 0) {
+                kv_standby_blank |= (uint8_t)(1u << page);
+            } else {
+                d->used = false;    // Flash 故障, 放弃本次写入
+            }
+            return;
+        }
+
+        if (idle_us < cost_compact_us && !overdue) return;
+        t0 = hal_micros();
+        int ret = kv_compact_to_other();
+        cost_learn(&cost_compact_us, hal_micros() - t0);
+        if (ret != 0) d->used = false;
+        return;
+    }
+
+    if (idle_us < cost_append_us && !overdue) return;
+    uint16_t end = kv_end;
+    t0 = hal_micros();
+    d->used = false;
+    kv_set_now(d->key, d->data, d->len);
+    if (kv_end != end) cost_learn(&cost_append_us, hal_micros() - t0);
+}
+
+bool hal_storage_pending(void)
+{
+    return defer_oldest() != NULL;
+}
+
+int hal_storage_flush(void)
+{
+    int ret = 0;
+    kv_defer_t *d;
+    while ((d = defer_oldest()) != NULL) {
+        d->used = false;
+        int r = kv_set_now(d->key, d->data, d->len);
+        if (r != 0) ret = r;
+    }
+    return ret;
+}
+
 /*============================================================================
  * High-Level Storage Functions
  *============================================================================*/
@@ -306,27 +667,15 @@ typedef struct {
 #define CALIB_MAGIC     0xCA01
 #define PAIR_MAGIC      0x5A01  // 修复: 0xPA01不是有效的十六进制
 
-// 注意: calc_crc16已在第61行定义，此处复用那个定义
-// 如果需要不同的签名，可以在此处定义一个内部版本
-#ifndef STORAGE_CRC16_DEFINED
-#define STORAGE_CRC16_DEFINED
-static uint16_t storage_calc_crc16(const void *data, uint16_t len)
-{
-    const uint8_t *p = (const uint8_t*)data;
-    uint16_t crc = 0xFFFF;
-    
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= p[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1)
-                crc = (crc >> 1) ^ 0xA001;
-            else
-                crc >>= 1;
-        }
-    }
-    return crc;
+// v0.6.3: 优先读键值日志, 未写入过时回退旧固定偏移 (升级前的数据)
+static int legacy_or_kv_read(uint8_t key, uint32_t legacy_addr, void *data, uint16_t len)
+{
+    int n = hal_kv_get(key, data, len);
+    if (n == len) return 0;
+    if (n != HAL_KV_ERR_NOT_FOUND) return -2;  // 已删除或长度不符, 视为未初始化
+    return hal_storage_read(legacy_addr, data, len);
 }
-#endif
+
 
 int hal_storage_load_config(void *config, uint16_t size)
 {
@@ -336,7 +685,7 @@ int hal_storage_load_config(void *config, uint16_t size)
         return -1;
     }
     
-    int err = hal_storage_read(CONFIG_STORAGE_ADDR, &data, sizeof(data));
+    int err = legacy_or_kv_read(HAL_KV_CONFIG, CONFIG_STORAGE_ADDR, &data, sizeof(data));
     if (err) return err;
     
     // Validate magic and CRC
@@ -344,7 +693,7 @@ int hal_storage_load_config(void *config, uint16_t size)
         return -2;  // Not initialized
     }
     
-    uint16_t expected_crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    uint16_t expected_crc = hal_crc16(&data, sizeof(data) - 2);
     if (data.crc != expected_crc) {
         return -3;  // CRC error
     }
@@ -363,9 +712,9 @@ int hal_storage_save_config(const void *config, uint16_t size)
     memcpy(&data, config, sizeof(data));
     
     data.magic = CONFIG_MAGIC;
-    data.crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    data.crc = hal_crc16(&data, sizeof(data) - 2);
     
-    return hal_storage_write(CONFIG_STORAGE_ADDR, &data, sizeof(data));
+    return hal_kv_set(HAL_KV_CONFIG, &data, sizeof(data));
 }
 
 int hal_storage_load_calibration(void *calib, uint16_t size)
@@ -376,14 +725,14 @@ int hal_storage_load_calibration(void *calib, uint16_t size)
         return -1;
     }
     
-    int err = hal_storage_read(CALIB_STORAGE_ADDR, &data, sizeof(data));
+    int err = legacy_or_kv_read(HAL_KV_CALIB, CALIB_STORAGE_ADDR, &data, sizeof(data));
     if (err) return err;
     
     if (data.magic != CALIB_MAGIC) {
         return -2;
     }
     
-    uint16_t expected_crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    uint16_t expected_crc = hal_crc16(&data, sizeof(data) - 2);
     if (data.crc != expected_crc) {
         return -3;
     }
@@ -402,9 +751,9 @@ int hal_storage_save_calibration(const void *calib, uint16_t size)
     memcpy(&data, calib, sizeof(data));
     
     data.magic = CALIB_MAGIC;
-    data.crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    data.crc = hal_crc16(&data, sizeof(data) - 2);
     
-    return hal_storage_write(CALIB_STORAGE_ADDR, &data, sizeof(data));
+    return hal_kv_set(HAL_KV_CALIB, &data, sizeof(data));
 }
 
 int hal_storage_load_pairing(void *pair, uint16_t size)
@@ -415,14 +764,14 @@ int hal_storage_load_pairing(void *pair, uint16_t size)
         return -1;
     }
     
-    int err = hal_storage_read(PAIR_STORAGE_ADDR, &data, sizeof(data));
+    int err = legacy_or_kv_read(HAL_KV_PAIRING, PAIR_STORAGE_ADDR, &data, sizeof(data));
     if (err) return err;
     
     if (data.magic != PAIR_MAGIC) {
         return -2;
     }
     
-    uint16_t expected_crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    uint16_t expected_crc = hal_crc16(&data, sizeof(data) - 2);
     if (data.crc != expected_crc) {
         return -3;
     }
@@ -441,15 +790,14 @@ int hal_storage_save_pairing(const void *pair, uint16_t size)
     memcpy(&data, pair, sizeof(data));
     
     data.magic = PAIR_MAGIC;
-    data.crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    data.crc = hal_crc16(&data, sizeof(data) - 2);
     
-    return hal_storage_write(PAIR_STORAGE_ADDR, &data, sizeof(data));
+    return hal_kv_set(HAL_KV_PAIRING, &data, sizeof(data));
 }
 
 int hal_storage_clear_pairing(void)
 {
-    pair_data_t data = {0};
-    return hal_storage_write(PAIR_STORAGE_ADDR, &data, sizeof(data));
+    return hal_kv_delete(HAL_KV_PAIRING);
 }
 
 /*============================================================================
@@ -471,13 +819,15 @@ bool hal_storage_load_network_key(uint32_t *key)
     
 #ifdef CH59X
     network_key_data_t data;
-    EEPROM_READ(STORAGE_BASE_ADDR + NETWORK_KEY_ADDR, &data, sizeof(data));
+    if (legacy_or_kv_read(HAL_KV_NETWORK_KEY, NETWORK_KEY_ADDR, &data, sizeof(data)) != 0) {
+        return false;
+    }
     
     if (data.magic != NETWORK_KEY_MAGIC) {
         return false;
     }
     
-    uint16_t expected_crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    uint16_t expected_crc = hal_crc16(&data, sizeof(data) - 2);
     if (data.crc != expected_crc) {
         return false;
     }
@@ -495,9 +845,9 @@ int hal_storage_save_network_key(uint32_t key)
     network_key_data_t data;
     data.magic = NETWORK_KEY_MAGIC;
     data.key = key;
-    data.crc = storage_calc_crc16(&data, sizeof(data) - 2);
+    data.crc = hal_crc16(&data, sizeof(data) - 2);
     
-    return hal_storage_write(NETWORK_KEY_ADDR, &data, sizeof(data));
+    return hal_kv_set(HAL_KV_NETWORK_KEY, &data, sizeof(data));
 #else
     return 0;
 #endif
@@ -563,11 +913,6 @@ uint32_t hal_get_tick_ms(void)
 
 uint32_t hal_get_tick_us(void)
 {
-#ifdef CH59X
-    // 使用hal_timer提供的微秒计时
-    extern uint32_t hal_micros(void);
+    // v0.6.3: 与 hal_millis 同一时基 (hal_timer.c), 非 CH59X 构建不再恒为 0
     return hal_micros();
-#else
-    return 0;
-#endif
 }
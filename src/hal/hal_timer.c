@@ -4,9 +4,19 @@
  * 
  * Provides system tick, millisecond/microsecond timing, and delays.
  * Uses TMR0 as the system tick timer.
+ * v0.6.3: TMR3 one-shot wakeup for hal_sleep_until_us().
+ * v0.6.3: RTC 32k counter for timing across sleep.
+ * v0.6.3: hal_timer_set_sysclk() re-derives timer periods after a system
+ *         clock change so hal_micros()/hal_millis() keep their rate.
+ * v0.6.3: the 1ms tick also advances the LED pattern (hal_led.c) and the
+ *         button debounce/gesture timers (hal_button.c).
+ * v0.6.3: hal_micros64() - 64-bit monotonic time base (TMR0 count extended
+ *         by the tick ISR); hal_micros() is its low 32 bits.
  */
 
 #include "hal.h"
+#include "hal_led.h"
+#include "hal_button.h"
 
 #ifdef CH59X
 #include "CH59x_common.h"
@@ -18,16 +28,27 @@
  * Configuration
  *============================================================================*/
 
-#define SYSTEM_CLOCK_HZ     60000000UL  // 60MHz system clock
+#define SYSTEM_CLOCK_HZ     60000000UL  // 60MHz system clock (boot default)
 #define TICK_RATE_HZ        1000        // 1ms tick rate
-#define TICK_PERIOD         (SYSTEM_CLOCK_HZ / TICK_RATE_HZ)
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
 
 /*============================================================================
  * Static Variables
  *============================================================================*/
 
 static volatile uint32_t sys_tick_ms = 0;
-static volatile uint32_t sys_tick_us_offset = 0;
+static volatile uint32_t sys_tick_ms_hi = 0;        // v0.6.3: sys_tick_ms 回绕次数 (约 49.7 天一次)
+static volatile uint32_t sys_tick_us_offset = 0;    // v0.6.3: 换频时未走完的 1ms 部分 (< 1000)
+
+// v0.6.3: 当前系统时钟和由其派生的 TMR0 周期 (hal_timer_set_sysclk 更新)
+static uint32_t sysclk_hz = SYSTEM_CLOCK_HZ;
+static uint32_t tick_period = SYSTEM_CLOCK_HZ / TICK_RATE_HZ;
 
 /*============================================================================
  * Interrupt Handler
@@ -40,7 +61,9 @@ void TMR0_IRQHandler(void)
 {
     if (TMR0_GetITFlag(TMR0_IT_CYC_END)) {
         TMR0_ClearITFlag(TMR0_IT_CYC_END);
-        sys_tick_ms++;
+        if (++sys_tick_ms == 0) {
+            sys_tick_ms_hi++;
+        }
         
         // v0.6.2: 每100ms检查一次任务监控 (检测软件死锁)
         // 这是在中断上下文中运行，即使主循环卡死也能执行
@@ -48,6 +71,15 @@ void TMR0_IRQHandler(void)
             extern bool task_monitor_check(void);
             task_monitor_check();
         }
+
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+        // v0.6.3: LED 图案在节拍中推进, 主循环不再轮询翻转
+        hal_led_tick_isr();
+#endif
+#if defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ
+        // v0.6.3: 按键去抖 / 手势单次计时
+        hal_button_tick_isr();
+#endif
     }
 }
 #endif
@@ -60,11 +92,12 @@ int hal_timer_init(void)
 {
 #ifdef CH59X
     // Configure TMR0 for 1ms period
-    TMR0_TimerInit(TICK_PERIOD);
+    TMR0_TimerInit(tick_period);
     TMR0_ITCfg(ENABLE, TMR0_IT_CYC_END);
     PFIC_EnableIRQ(TMR0_IRQn);
     
     sys_tick_ms = 0;
+    sys_tick_ms_hi = 0;
     return 0;
 #else
     // Stub for non-CH59X builds
@@ -83,22 +116,90 @@ uint32_t hal_millis(void)
 #endif
 }
 
+#ifdef CH59X
+/**
+ * v0.6.3: 一致的 (ms, 1ms 内 us) 快照
+ * 读取期间节拍中断到来时重读; 中断被屏蔽 (临界区/更高优先级中断中) 时计数已回卷而
+ * sys_tick_ms 还没加, 由挂起的周期结束标志补上这 1ms, 返回值不会倒退
+ */
+__HIGH_CODE
+static uint32_t tick_snapshot(uint32_t *ms_hi, uint32_t *us_in_ms)
+{
+    uint32_t hi, ms, us;
+    
+    do {
+        hi = sys_tick_ms_hi;
+        ms = sys_tick_ms;
+        uint32_t count = TMR0_GetCurrentCount();    // 先读计数再读标志
+        us = sys_tick_us_offset + (count * 1000UL) / tick_period;
+        if (TMR0_GetITFlag(TMR0_IT_CYC_END) && count < tick_period / 2) {
+            us += 1000;
+        }
+    } while (ms != sys_tick_ms);
+    
+    // offset + 补偿最多接近 2ms, 折回 ms 部分 (跨 32 位回绕时进位到高位)
+    while (us >= 1000) {
+        us -= 1000;
+        if (++ms == 0) hi++;
+    }
+    *ms_hi = hi;
+    *us_in_ms = us;
+    return ms;
+}
+#endif
+
 uint32_t hal_micros(void)
 {
 #ifdef CH59X
-    // Get current timer count for sub-millisecond precision
-    uint32_t ms = sys_tick_ms;
-    uint32_t count = TMR0_GetCurrentCount();
-    
-    // Convert count to microseconds within current millisecond
-    uint32_t us_in_ms = (count * 1000UL) / TICK_PERIOD;
+    uint32_t hi, us;
+    uint32_t ms = tick_snapshot(&hi, &us);
     
-    return (ms * 1000UL) + us_in_ms;
+    return (ms * 1000UL) + us;
 #else
     return hal_millis() * 1000;
 #endif
 }
 
+uint64_t hal_micros64(void)
+{
+#ifdef CH59X
+    uint32_t hi, us;
+    uint32_t ms = tick_snapshot(&hi, &us);
+    
+    return ((((uint64_t)hi << 32) | ms) * 1000ULL) + us;
+#else
+    return (uint64_t)hal_micros();
+#endif
+}
+
+void hal_timer_set_sysclk(uint32_t hz)
+{
+    if (hz < 1000000UL || hz == sysclk_hz) return;
+#ifdef CH59X
+    __disable_irq();
+    // 把当前 1ms 内已走过的部分记入偏移, TMR0 按新周期从 0 重新计数
+    uint32_t us_in_ms = (TMR0_GetCurrentCount() * 1000UL) / tick_period;
+    uint32_t offset = sys_tick_us_offset + us_in_ms;
+    if (offset >= 1000) {
+        sys_tick_ms++;
+        offset -= 1000;
+    }
+    sys_tick_us_offset = offset;
+    tick_period = hz / TICK_RATE_HZ;
+    sysclk_hz = hz;
+    TMR0_TimerInit(tick_period);
+    __enable_irq();
+#else
+    sysclk_hz = hz;
+    tick_period = hz / TICK_RATE_HZ;
+#endif
+}
+
+uint32_t hal_get_sysclk_hz(void)
+{
+    return sysclk_hz;
+}
+
 void hal_delay_ms(uint32_t ms)
 {
 #ifdef CH59X
@@ -117,8 +218,8 @@ void hal_delay_us(uint32_t us)
 #ifdef CH59X
     // For short delays, use busy wait
     if (us < 1000) {
-        // Approximate cycles per microsecond at 60MHz
-        uint32_t cycles = us * 15;  // ~60MHz / 4 cycles per loop
+        // Approximate loop iterations per microsecond (4 cycles per loop)
+        uint32_t cycles = us * (sysclk_hz / 4000000UL);
         while (cycles--) {
             __NOP();
         }
@@ -127,7 +228,7 @@ void hal_delay_us(uint32_t us)
         hal_delay_ms(us / 1000);
         // Handle remainder
         uint32_t remainder = us % 1000;
-        uint32_t cycles = remainder * 15;
+        uint32_t cycles = remainder * (sysclk_hz / 4000000UL);
         while (cycles--) {
             __NOP();
         }
@@ -137,6 +238,156 @@ void hal_delay_us(uint32_t us)
 #endif
 }
 
+/*============================================================================
+ * v0.6.3: Low-power Wait Until Timestamp
+ *
+ * TMR3 单次定时在 (目标 - 提前量) 处唤醒, 期间 WFI 睡眠 (其他中断唤醒后继续睡);
+ * 醒来后忙等剩余的提前量. 提前量 = 学习到的唤醒延迟 + 固定余量,
+ * 唤醒延迟按每次实际醒来时刻与设定时刻之差做 1/8 指数平均
+ *============================================================================*/
+
+#define SLEEP_MIN_US            50      // 睡眠段短于此值直接忙等
+#define SLEEP_LATENCY_INIT_US   20      // 唤醒延迟初值
+#define SLEEP_LATENCY_MAX_US    500
+#define SLEEP_GUARD_US          10      // 学习值之外的固定余量
+#define WAIT_SEG_MAX_US         500000  // hal_wait_flag_until_us 单次装载上限
+
+static volatile bool sleep_wake = false;
+static uint16_t sleep_latency_us = SLEEP_LATENCY_INIT_US;
+
+#ifdef CH59X
+__INTERRUPT
+__HIGH_CODE
+void TMR3_IRQHandler(void)
+{
+    if (TMR3_GetITFlag(TMR3_IT_CYC_END)) {
+        TMR3_ClearITFlag(TMR3_IT_CYC_END);
+        TMR3_ITCfg(DISABLE, TMR3_IT_CYC_END);
+        TMR3_Enable(DISABLE);
+        sleep_wake = true;
+    }
+}
+#endif
+
+int32_t hal_sleep_until_us(uint32_t target_us)
+{
+#ifdef CH59X
+    uint32_t margin = sleep_latency_us + SLEEP_GUARD_US;
+    uint32_t now = hal_micros();
+    int32_t remain = (int32_t)(target_us - now);
+    
+    if (remain > (int32_t)(margin + SLEEP_MIN_US)) {
+        uint32_t sleep_us = (uint32_t)remain - margin;
+        uint32_t wake_at = now + sleep_us;
+        
+        sleep_wake = false;
+        TMR3_TimerInit(sleep_us * (sysclk_hz / 1000000UL));
+        TMR3_ITCfg(ENABLE, TMR3_IT_CYC_END);
+        PFIC_EnableIRQ(TMR3_IRQn);
+        
+        while (!sleep_wake && (int32_t)(wake_at - hal_micros()) > 0) {
+            __WFI();
+        }
+        
+        // 学习唤醒延迟 (只计晚醒部分)
+        int32_t late = (int32_t)(hal_micros() - wake_at);
+        if (late < 0) late = 0;
+        if (late > SLEEP_LATENCY_MAX_US) late = SLEEP_LATENCY_MAX_US;
+        sleep_latency_us = (uint16_t)((sleep_latency_us * 7 + (uint32_t)late + 7) / 8);
+    }
+    
+    // 最后一段忙等, 保证准时
+    while ((int32_t)(target_us - hal_micros()) > 0) {
+        __NOP();
+    }
+    return (int32_t)(hal_micros() - target_us);
+#else
+    (void)target_us;
+    return 0;
+#endif
+}
+
+uint16_t hal_sleep_get_latency_us(void)
+{
+    return sleep_latency_us;
+}
+
+bool hal_wait_flag_until_us(volatile bool *flag, uint32_t target_us)
+{
+#ifdef CH59X
+    for (;;) {
+        int32_t remain = (int32_t)(target_us - hal_micros());
+        if (*flag || remain <= SLEEP_MIN_US) break;
+        
+        // 长等待分段装载 (TMR3 计数 26 位)
+        uint32_t seg_us = (remain > WAIT_SEG_MAX_US) ? WAIT_SEG_MAX_US : (uint32_t)remain;
+        sleep_wake = false;
+        TMR3_TimerInit(seg_us * (sysclk_hz / 1000000UL));
+        TMR3_ITCfg(ENABLE, TMR3_IT_CYC_END);
+        PFIC_EnableIRQ(TMR3_IRQn);
+        
+        for (;;) {
+            // 关中断后检查再 WFI: 检查之后才到的中断仍会唤醒 WFI, 开中断后立即执行
+            __disable_irq();
+            if (*flag || sleep_wake) {
+                __enable_irq();
+                break;
+            }
+            __WFI();
+            __enable_irq();
+        }
+        if (!sleep_wake) {
+            TMR3_ITCfg(DISABLE, TMR3_IT_CYC_END);
+            TMR3_Enable(DISABLE);
+            break;
+        }
+    }
+    
+    // 不足一个睡眠段时忙等
+    while (!*flag && (int32_t)(target_us - hal_micros()) > 0) {
+        __NOP();
+    }
+    return *flag;
+#else
+    (void)target_us;
+    return *flag;
+#endif
+}
+
+/*============================================================================
+ * v0.6.3: RTC Timestamp (跨睡眠计时)
+ *============================================================================*/
+
+#ifdef CH59X
+#ifndef R32_RTC_CNT_32K
+// 高 16 位 = 2s 计数, 低 16 位 = 2s 内 32k 计数, 合起来即当天的 32k 周期数
+#define R32_RTC_CNT_32K         (*((volatile uint32_t *)0x40001038))
+#endif
+#endif
+
+uint32_t hal_rtc_get_cycles(void)
+{
+#ifdef CH59X
+    // 异步时钟域, 连续两次读到相同值才有效
+    uint32_t c;
+    do {
+        c = R32_RTC_CNT_32K;
+    } while (c != R32_RTC_CNT_32K);
+    return c;
+#else
+    return 0;
+#endif
+}
+
+uint32_t hal_rtc_elapsed_us(uint32_t since)
+{
+    uint32_t now = hal_rtc_get_cycles();
+    uint32_t cycles = (now >= since) ? (now - since) : (now + HAL_RTC_DAY_CYCLES - since);
+    uint64_t us = (uint64_t)cycles * 1000000ULL / HAL_RTC_HZ;
+    
+    return (us > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)us;
+}
+
 /*============================================================================
  * High Resolution Timer (for sensor timing)
  *============================================================================*/
@@ -191,31 +442,90 @@ uint64_t hal_hr_timer_get_ticks(void)
 uint32_t hal_hr_timer_ticks_to_us(uint64_t ticks)
 {
 #ifdef CH59X
-    // At 60MHz, 60 ticks = 1us
-    return (uint32_t)(ticks / 60);
+    // TMR1 counts system clock cycles (60 ticks = 1us at 60MHz);
+    // v0.6.3: after a clock change the conversion uses the new rate
+    return (uint32_t)(ticks / (sysclk_hz / 1000000UL));
 #else
     return (uint32_t)ticks;
 #endif
 }
 
 /*============================================================================
- * CRC16 Calculation (v0.6.2 统一实现)
+ * v0.6.3: Capture Timestamp (USE_HW_TIMESTAMP, HW_TS_IMU_CAPTURE)
  *============================================================================*/
 
-uint16_t hal_crc16(const void *data, uint16_t len)
+#if defined(USE_HW_TIMESTAMP) && USE_HW_TIMESTAMP && HW_TS_IMU_CAPTURE
+
+#ifdef CH59X
+#ifndef R8_TMR1_CTRL_MOD
+#define R8_TMR1_CTRL_MOD        (*((volatile uint8_t *)0x40002400))
+#define R8_TMR1_FIFO_COUNT      (*((volatile uint8_t *)0x40002407))
+#define R32_TMR1_COUNT          (*((volatile uint32_t *)0x40002408))
+#define R32_TMR1_CNT_END        (*((volatile uint32_t *)0x4000240C))
+#define R32_TMR1_FIFO           (*((volatile uint32_t *)0x40002410))
+#endif
+#ifndef RB_TMR_MODE_IN
+#define RB_TMR_MODE_IN          0x01
+#define RB_TMR_ALL_CLEAR        0x02
+#define RB_TMR_COUNT_EN         0x04
+#endif
+#define TS_CAP_RISE_TO_RISE     (3 << 6)        // RB_TMR_CAP_EDGE: 上升沿到上升沿
+#define TS_CAP_PIN              GPIO_Pin_10     // PA10 (TMR1 捕获输入)
+#endif
+
+#define TS_CAP_MASK             0x03FFFFFFUL    // 26 位计数/捕获值
+#define TS_CAP_MAX_LATENCY_US   1000            // 超过视为未接线/沿丢失, 退回中断时刻
+
+static volatile uint32_t ts_cap_period_ticks = 0;
+
+int hal_ts_capture_init(void)
 {
-    const uint8_t *p = (const uint8_t *)data;
-    uint16_t crc = 0xFFFF;
+#ifdef CH59X
+    // 捕获模式: 每个有效沿把距上一沿的计数存入 FIFO, 计数器从 0 重新开始,
+    // 所以当前计数就是最近一个沿到现在的系统时钟数
+    GPIOA_ModeCfg(TS_CAP_PIN, GPIO_ModeIN_Floating);
+    R32_TMR1_CNT_END = TS_CAP_MASK;
+    R8_TMR1_CTRL_MOD = RB_TMR_ALL_CLEAR;
+    R8_TMR1_CTRL_MOD = RB_TMR_COUNT_EN | RB_TMR_MODE_IN | TS_CAP_RISE_TO_RISE;
+    ts_cap_period_ticks = 0;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void hal_ts_capture_stop(void)
+{
+#ifdef CH59X
+    R8_TMR1_CTRL_MOD = RB_TMR_ALL_CLEAR;
+#endif
+    ts_cap_period_ticks = 0;
+}
+
+__HIGH_CODE
+uint32_t hal_ts_capture_edge_us(uint32_t *period_ns)
+{
+#ifdef CH59X
+    // 先读计数再取 hal_micros, 两次读取之间只差固定的几个周期
+    uint32_t since = R32_TMR1_COUNT & TS_CAP_MASK;
+    uint32_t now = hal_micros();
+    uint32_t ticks_per_us = sysclk_hz / 1000000UL;
     
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= p[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
+    // 取最新的沿间隔 (错过中断时 FIFO 中可能有多个)
+    while (R8_TMR1_FIFO_COUNT) {
+        ts_cap_period_ticks = R32_TMR1_FIFO & TS_CAP_MASK;
     }
-    return crc;
+    if (period_ns) {
+        uint32_t t = ts_cap_period_ticks;
+        *period_ns = (t / ticks_per_us) * 1000UL + (t % ticks_per_us) * 1000UL / ticks_per_us;
+    }
+    
+    uint32_t since_us = since / ticks_per_us;
+    return (since_us < TS_CAP_MAX_LATENCY_US) ? (now - since_us) : now;
+#else
+    if (period_ns) *period_ns = 0;
+    return hal_micros();
+#endif
 }
+
+#endif /* USE_HW_TIMESTAMP */
@@ -7,11 +7,15 @@
  * 2. HardFault处理 - 崩溃时保存现场到Retained RAM
  * 3. 复位原因检测 - 区分上电/看门狗/软复位
  * 4. 任务监控 - 软件层面检测主循环卡死
+ * 5. v0.6.3: 任务耗时预算 - 见 watchdog.h
+ * 6. v0.6.3: 崩溃时序快照 - 见 watchdog.h
  * 
  * 重要: 主循环必须定期调用wdog_feed()，否则系统将复位！
  */
 
+#include "config.h"
 #include "watchdog.h"
+#include "boot_token.h"
 #include "hal.h"
 #include "event_logger.h"
 #include "error_codes.h"
@@ -47,6 +51,24 @@ static uint8_t RETAINED_SECTION g_last_reset_reason;
 #define WDOG_RESET_MAGIC    0x57444F47  // "WDOG"
 static uint32_t RETAINED_SECTION g_wdog_reset_magic;
 
+#if CRASH_TIMING
+// v0.6.3: 与崩溃快照一起保存的时序 (g_crash_snapshot.magic 有效时有效)
+static crash_timing_t RETAINED_SECTION g_crash_timing;
+
+// 最近迭代的任务耗时环; 硬件看门狗复位后由 wdog_init 补记 (上电复位时内容随机, 不读取)
+static crash_frame_t RETAINED_SECTION g_timeline[CRASH_TIMELINE_DEPTH];
+static uint8_t RETAINED_SECTION g_timeline_head;        // 当前迭代
+static uint8_t RETAINED_SECTION g_timeline_frames;
+static volatile uint8_t RETAINED_SECTION g_task_cur;    // 正在执行的任务
+static void crash_timing_fill(crash_timing_t *out, bool live);
+#endif
+
+#if defined(USE_BOOT_WARM_TOKEN) && USE_BOOT_WARM_TOKEN
+// v0.6.3: bootloader 热启动令牌 (固定地址, 见 boot_token.h)
+static volatile boot_token_t g_boot_token __attribute__((section(".boot_token"), used));
+static bool g_boot_token_armed = false;
+#endif
+
 /*============================================================================
  * 任务监控状态
  *============================================================================*/
@@ -86,6 +108,10 @@ static void save_crash_snapshot(uint32_t *stack_frame, uint8_t fault_type)
     g_crash_snapshot.hfsr = 0;
     g_crash_snapshot.bfar = 0;
     g_crash_snapshot.mmfar = 0;
+    
+#if CRASH_TIMING
+    crash_timing_fill(&g_crash_timing, true);
+#endif
 }
 
 /*============================================================================
@@ -97,6 +123,18 @@ void wdog_init(uint32_t timeout_ms)
 #ifdef CH59X
     // 检查是否是看门狗复位
     if (g_wdog_reset_magic == WDOG_RESET_MAGIC) {
+#if CRASH_TIMING
+        // v0.6.3: 异常处理已保存现场 (随后软复位, 标记未清) 时保留其快照,
+        // 否则是硬件看门狗复位: 从保持的时序环补记一份
+        if (g_last_reset_reason != RESET_REASON_HARDFAULT) {
+            memset(&g_crash_snapshot, 0, sizeof(g_crash_snapshot));
+            g_crash_snapshot.magic = CRASH_SNAPSHOT_MAGIC;
+            g_crash_snapshot.reset_reason = RESET_REASON_WATCHDOG;
+            g_crash_snapshot.fault_type = CRASH_FAULT_WATCHDOG;
+            g_crash_snapshot.r0 = wdog_get_checkpoint();
+            crash_timing_fill(&g_crash_timing, false);
+        }
+#endif
         g_last_reset_reason = RESET_REASON_WATCHDOG;
         g_wdog_reset_magic = 0;  // 清除标记
         g_reset_count++;
@@ -131,6 +169,11 @@ void wdog_init(uint32_t timeout_ms)
 #else
     (void)timeout_ms;
 #endif
+#if CRASH_TIMING
+    g_timeline_head = 0;
+    g_timeline_frames = 0;
+    g_task_cur = CRASH_TASK_NONE;
+#endif
 }
 
 void wdog_feed(void)
@@ -142,6 +185,25 @@ void wdog_feed(void)
     g_task_monitor.last_feed_time = hal_get_tick_ms();
     g_task_monitor.feed_count++;
     g_task_monitor.timeout_count = 0;  // v0.6.2: 重置超时计数
+    
+#if defined(USE_BOOT_WARM_TOKEN) && USE_BOOT_WARM_TOKEN
+    // v0.6.3: 稳定运行一段时间后写入热启动令牌 (bootloader 启动时已清除)
+    if (!g_boot_token_armed && hal_get_tick_ms() >= BOOT_TOKEN_ARM_MS) {
+        uint32_t entry = *(const volatile uint32_t *)BOOT_TOKEN_APP_ADDR;
+        g_boot_token.app_entry = entry;
+        g_boot_token.check = ~(BOOT_TOKEN_MAGIC ^ entry);
+        g_boot_token.magic = BOOT_TOKEN_MAGIC;
+        g_boot_token_armed = true;
+    }
+#endif
+#endif
+}
+
+void wdog_boot_token_clear(void)
+{
+#if defined(USE_BOOT_WARM_TOKEN) && USE_BOOT_WARM_TOKEN
+    g_boot_token.magic = 0;
+    g_boot_token_armed = true;      // 本次运行不再写入
 #endif
 }
 
@@ -209,6 +271,19 @@ void wdog_print_crash_snapshot(void)
             g_crash_snapshot.r2, g_crash_snapshot.r3);
     LOG_ERR("Time: %lu ms", g_crash_snapshot.timestamp_ms);
     LOG_ERR("Type: %d", g_crash_snapshot.fault_type);
+#if CRASH_TIMING
+    if (g_crash_timing.cur_task != CRASH_TASK_NONE) {
+        LOG_ERR("Task: %u (%lu us)", g_crash_timing.cur_task, g_crash_timing.cur_elapsed_us);
+    }
+    for (uint8_t f = 0; f < g_crash_timing.frames && f < CRASH_TIMELINE_DEPTH; f++) {
+        uint8_t slow = 0;
+        for (uint8_t t = 1; t < TASK_COUNT; t++) {
+            if (g_crash_timing.frame[f].task_us[t] > g_crash_timing.frame[f].task_us[slow]) slow = t;
+        }
+        LOG_ERR("Frame %u: start %lu us, slowest task %u %u us", f,
+                g_crash_timing.frame[f].start_us, slow, g_crash_timing.frame[f].task_us[slow]);
+    }
+#endif
     LOG_ERR("======================");
 }
 
@@ -263,10 +338,13 @@ bool task_monitor_check(void)
         
         // 保存死锁信息到崩溃快照
         g_crash_snapshot.magic = CRASH_SNAPSHOT_MAGIC;
-        g_crash_snapshot.fault_type = 0xDD;  // 0xDD = Deadlock Detected
+        g_crash_snapshot.fault_type = CRASH_FAULT_DEADLOCK;
         g_crash_snapshot.timestamp_ms = now;
         g_crash_snapshot.reset_reason = RESET_REASON_LOCKUP;
         g_crash_snapshot.r0 = last_cp;  // 保存检查点到r0字段
+#if CRASH_TIMING
+        crash_timing_fill(&g_crash_timing, true);     // 卡住的任务及已用时间
+#endif
         
         // 记录事件
         event_log(EVT_CRASH, (uint8_t*)&elapsed, 4);
@@ -319,6 +397,169 @@ void task_monitor_get_stats(uint32_t *timeout_count, uint32_t *feed_count)
     if (feed_count) *feed_count = g_task_monitor.feed_count;
 }
 
+/*============================================================================
+ * v0.6.3: 任务耗时预算
+ *============================================================================*/
+
+#if defined(USE_TASK_BUDGET) && USE_TASK_BUDGET
+
+static const uint16_t task_budget_us[TASK_COUNT] = {
+    [TASK_SENSOR]  = TASK_BUDGET_SENSOR_US,
+    [TASK_RF]      = TASK_BUDGET_RF_US,
+    [TASK_USB]     = TASK_BUDGET_USB_US,
+    [TASK_LED]     = TASK_BUDGET_LED_US,
+    [TASK_STORAGE] = TASK_BUDGET_STORAGE_US,
+    [TASK_BATTERY] = TASK_BUDGET_BATTERY_US,
+};
+
+static task_budget_stat_t g_task_stats[TASK_COUNT];
+static uint32_t g_task_t0[TASK_COUNT];
+static uint8_t g_task_skip[TASK_COUNT];
+static uint32_t g_loop_t0 = 0;
+static bool g_task_shed = (TASK_BUDGET_SHED != 0);
+
+void task_budget_loop_start(void)
+{
+    g_loop_t0 = hal_micros();
+#if CRASH_TIMING
+    uint8_t h = (uint8_t)((g_timeline_head + 1) % CRASH_TIMELINE_DEPTH);
+    memset(&g_timeline[h], 0, sizeof(g_timeline[h]));
+    g_timeline[h].start_us = g_loop_t0;
+    g_timeline_head = h;
+    if (g_timeline_frames < CRASH_TIMELINE_DEPTH) g_timeline_frames++;
+#endif
+}
+
+void task_budget_begin(task_id_t id)
+{
+    g_task_t0[id] = hal_micros();
+#if CRASH_TIMING
+    g_task_cur = (uint8_t)id;
+#endif
+}
+
+void task_budget_end(task_id_t id)
+{
+    uint32_t dt = hal_micros() - g_task_t0[id];
+    uint16_t us = (dt > 0xFFFF) ? 0xFFFF : (uint16_t)dt;
+    task_budget_stat_t *st = &g_task_stats[id];
+    
+#if CRASH_TIMING
+    // 同一迭代内多次执行的任务累加
+    uint32_t sum = (uint32_t)g_timeline[g_timeline_head].task_us[id] + us;
+    g_timeline[g_timeline_head].task_us[id] = (sum > 0xFFFF) ? 0xFFFF : (uint16_t)sum;
+    g_task_cur = CRASH_TASK_NONE;
+#endif
+
+    st->count++;
+    if (us <= task_budget_us[id]) {
+        return;
+    }
+
+    st->overruns++;
+    if (us > st->max_us) {
+        // 只记录刷新最大值的一次, 避免持续超时刷满事件环
+        st->max_us = us;
+        uint8_t data[3] = { (uint8_t)id, (uint8_t)(us & 0xFF), (uint8_t)(us >> 8) };
+        event_log(EVT_TASK_OVERRUN, data, sizeof(data));
+    }
+}
+
+bool task_budget_should_run(task_id_t id)
+{
+    if (!g_task_shed || (id != TASK_LED && id != TASK_BATTERY)) {
+        return true;
+    }
+    if ((hal_micros() - g_loop_t0) < TASK_LOOP_LATE_US ||
+        g_task_skip[id] >= TASK_SHED_MAX_SKIP) {
+        g_task_skip[id] = 0;
+        return true;
+    }
+    g_task_skip[id]++;
+    g_task_stats[id].shed++;
+    return false;
+}
+
+void task_budget_set_shed(bool enable)
+{
+    g_task_shed = enable;
+}
+
+bool task_budget_shed_enabled(void)
+{
+    return g_task_shed;
+}
+
+int task_budget_get(uint8_t id, task_budget_stat_t *out)
+{
+    if (id >= TASK_COUNT || !out) return -1;
+    memcpy(out, &g_task_stats[id], sizeof(*out));
+    out->budget_us = task_budget_us[id];
+    return 0;
+}
+
+void task_budget_reset(void)
+{
+    memset(g_task_stats, 0, sizeof(g_task_stats));
+    memset(g_task_skip, 0, sizeof(g_task_skip));
+}
+
+#endif /* USE_TASK_BUDGET */
+
+/*============================================================================
+ * v0.6.3: 崩溃时序快照
+ *============================================================================*/
+
+#if CRASH_TIMING
+
+// live = false: 复位后补记, 此时的 hal_micros 与保存的时间无关, 不计已用时间
+static void crash_timing_fill(crash_timing_t *out, bool live)
+{
+    memset(out, 0, sizeof(*out));
+    
+    uint8_t n = g_timeline_frames;
+    if (n > CRASH_TIMELINE_DEPTH) n = CRASH_TIMELINE_DEPTH;
+    uint8_t head = g_timeline_head % CRASH_TIMELINE_DEPTH;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t idx = (uint8_t)((head + CRASH_TIMELINE_DEPTH + 1 - n + i) % CRASH_TIMELINE_DEPTH);
+        out->frame[i] = g_timeline[idx];
+    }
+    out->frames = n;
+    
+    uint8_t cur = g_task_cur;
+    out->cur_task = (cur < TASK_COUNT) ? cur : CRASH_TASK_NONE;
+    if (live && cur < TASK_COUNT) {
+        out->cur_elapsed_us = hal_micros() - g_task_t0[cur];
+    }
+    
+#if defined(USE_PROFILE) && USE_PROFILE
+    // 异常上下文: 直接读表, 不经 prof_get (会重新开中断)
+    if (live) {
+        for (uint8_t p = 0; p < PROF_COUNT; p++) {
+            const prof_stat_t *st = &prof_table[p];
+            out->probe[p].count = st->count;
+            out->probe[p].max = st->max;
+            out->probe[p].avg = st->count ? (uint32_t)(st->total / st->count) : 0;
+        }
+        out->probes = PROF_COUNT;
+    }
+#endif
+}
+
+void wdog_crash_timing_capture(crash_timing_t *out)
+{
+    if (out) crash_timing_fill(out, true);
+}
+
+bool wdog_get_crash_timing(crash_timing_t *out)
+{
+    if (!out || !wdog_has_crash_snapshot()) return false;
+    memcpy(out, &g_crash_timing, sizeof(*out));
+    return true;
+}
+
+#endif /* CRASH_TIMING */
+
 /*============================================================================
  * HardFault处理 (由启动代码调用)
  *============================================================================*/
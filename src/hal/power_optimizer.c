@@ -14,9 +14,14 @@
 
 #include "hal.h"
 #include "board.h"
+#include "config.h"
 #include "power_optimizer.h"
 #include "rf_hw.h"
 #include "imu_interface.h"
+#include "motion_state.h"
+#include "profile.h"
+#include "rf_protocol.h"
+#include "selftest.h"
 #include <string.h>
 
 /*============================================================================
@@ -55,7 +60,6 @@
 
 // 触发阈值
 #define IDLE_TIMEOUT_MS         100     // 空闲超时
-#define MOTION_THRESHOLD        0.5f    // 运动检测阈值 (rad/s)
 #define LOW_BATTERY_PERCENT     15      // 低电量阈值
 
 /*============================================================================
@@ -95,6 +99,15 @@ typedef struct {
     // 配置
     bool auto_sleep_enabled;
     uint32_t auto_sleep_timeout_ms;
+    
+    // v0.6.3: IMU 功耗档最近一次切换时刻
+    uint32_t imu_profile_ms;
+    
+    // v0.6.3: 时钟调节器 (每超帧忙周期)
+    uint32_t gov_frame_us;          // 当前统计窗口起点
+    uint64_t gov_busy_last;         // 上一窗口结束时的探针累计周期
+    uint32_t gov_peak_cycles;       // 每帧忙周期峰值 (缓慢衰减)
+    uint16_t gov_down_frames;       // 连续可降档的帧数
 } power_state_t;
 
 static power_state_t pwr = {0};
@@ -120,8 +133,17 @@ static power_state_t pwr = {0};
  * 时钟控制
  *============================================================================*/
 
+// v0.6.3: 各时钟模式的系统时钟, 定时器周期据此重新派生
+static const uint32_t clk_mode_hz[] = {
+    [CLK_MODE_HIGH]   = 60000000UL,
+    [CLK_MODE_MEDIUM] = 32000000UL,
+    [CLK_MODE_LOW]    = 8000000UL,
+};
+
 void power_set_clock_mode(uint8_t mode)
 {
+    if (mode > CLK_MODE_LOW) return;
+    
     switch (mode) {
         case CLK_MODE_HIGH:     // 60MHz
             R8_CLK_CFG = 0x00;  // PLL / 1
@@ -136,6 +158,13 @@ void power_set_clock_mode(uint8_t mode)
             break;
     }
     
+    // v0.6.3: hal_micros 的 TMR0 和 RF 时隙定时器按新时钟重新装载
+    hal_timer_set_sysclk(clk_mode_hz[mode]);
+    rf_hw_timer_retime();
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+    hal_spi_set_sysclk(clk_mode_hz[mode]);  // 各 SPI 设备的分频按新时钟重新派生
+#endif
+    
     pwr.clock_mode = mode;
     
     // 更新功耗估算
@@ -313,26 +342,146 @@ void power_update_current_estimate(void)
     pwr.average_ma = pwr.average_ma * 0.95f + current * 0.05f;
 }
 
+/*============================================================================
+ * v0.6.3: IMU 功耗档
+ *============================================================================*/
+
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE
+static void power_update_imu_profile(uint32_t now)
+{
+    imu_power_profile_t want;
+    switch (motion_state_level()) {
+        case MOTION_LEVEL_REST:  want = IMU_PROFILE_LOW;    break;
+        case MOTION_LEVEL_STILL: want = IMU_PROFILE_NORMAL; break;
+        default:                 want = IMU_PROFILE_HIGH;   break;
+    }
+    if (want == IMU_PROFILE_HIGH && pwr.low_battery && !pwr.charging) {
+        want = IMU_PROFILE_NORMAL;
+    }
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    // 组休眠期间样本不发送, 只维持姿态跟踪
+    if (rf_transmitter_group_dozing()) {
+        want = IMU_PROFILE_LOW;
+    }
+#endif
+#if defined(USE_SELFTEST) && USE_SELFTEST
+    // 特性测量期间固定在指定档, 不随静止降档
+    if (selftest_pinned_profile() >= 0) {
+        want = (imu_power_profile_t)selftest_pinned_profile();
+    }
+#endif
+    
+    imu_power_profile_t cur = imu_get_power_profile();
+    // 升档立即 (运动开始不能丢样本), 降档需在当前档停留足够久, 避免在 STILL/MOTION 边界反复写寄存器
+    if (want != cur && (want < cur || now - pwr.imu_profile_ms >= IMU_PROFILE_HOLD_MS)) {
+        if (imu_set_power_profile(want) == 0) {
+            pwr.imu_profile_ms = now;
+        }
+    }
+    // IMU 复位后档位回到 HIGH, 每次同步一遍
+    motion_state_set_rate_div(imu_get_rate_div());
+}
+#endif
+
+/*============================================================================
+ * v0.6.3: 按负载调节时钟 / Workload-driven clock governor
+ *
+ * 每个超帧统计一次忙周期 (主循环探针 + 各中断探针, 主循环中被抢占的中断重复计入, 偏保守),
+ * 选能以 CLOCK_GOV_TARGET_PCT 占空完成峰值负载的最低时钟: 负载超出当前档立即升档,
+ * 连续 CLOCK_GOV_DOWN_FRAMES 帧都能降才降一档. 峰值每帧衰减 1/16, 偶发的长帧
+ * (校准保存/Flash 写) 不会立刻被忘掉
+ *============================================================================*/
+
+#if defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR
+static const uint8_t gov_probes[] = {
+    PROF_MAIN_LOOP, PROF_RF_ISR, PROF_RF_TIMER_ISR, PROF_USB_ISR,
+    PROF_SPI_DMA_ISR, PROF_I2C_ISR, PROF_GPIO_ISR,
+};
+
+static uint64_t gov_busy_total(void)
+{
+    uint64_t total = 0;
+    prof_stat_t st;
+    for (uint8_t i = 0; i < sizeof(gov_probes); i++) {
+        if (prof_get(gov_probes[i], &st) == 0) {
+            total += st.total;
+        }
+    }
+    return total;
+}
+
+// 该时钟下每帧可用周期 (按目标占空)
+static uint32_t gov_budget_cycles(uint8_t mode)
+{
+    return (uint32_t)((uint64_t)clk_mode_hz[mode] / 1000000UL * RF_FRAME_US *
+                      CLOCK_GOV_TARGET_PCT / 100);
+}
+
+void power_governor_update(void)
+{
+    uint32_t now = hal_micros();
+    uint32_t elapsed = now - pwr.gov_frame_us;
+    if (elapsed < RF_FRAME_US) return;
+    
+    uint64_t busy = gov_busy_total();
+    // prof_reset 之后累计值变小, 本窗口丢弃
+    uint64_t delta = (busy >= pwr.gov_busy_last) ? busy - pwr.gov_busy_last : 0;
+    uint64_t per = delta / (elapsed / RF_FRAME_US);
+    uint32_t per_frame = (per > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)per;
+    pwr.gov_busy_last = busy;
+    pwr.gov_frame_us = now;
+    
+    pwr.gov_peak_cycles -= pwr.gov_peak_cycles / 16;
+    if (per_frame > pwr.gov_peak_cycles) pwr.gov_peak_cycles = per_frame;
+    
+    // 满足峰值负载的最低档
+    uint8_t want = CLK_MODE_HIGH;
+    for (uint8_t m = CLK_MODE_LOW; m > CLK_MODE_HIGH; m--) {
+        if (pwr.gov_peak_cycles <= gov_budget_cycles(m)) {
+            want = m;
+            break;
+        }
+    }
+    
+    if (want < pwr.clock_mode) {
+        pwr.gov_down_frames = 0;
+        power_set_clock_mode(want);
+    } else if (want > pwr.clock_mode) {
+        if (++pwr.gov_down_frames >= CLOCK_GOV_DOWN_FRAMES) {
+            pwr.gov_down_frames = 0;
+            power_set_clock_mode(pwr.clock_mode + 1);
+        }
+    } else {
+        pwr.gov_down_frames = 0;
+    }
+}
+#endif
+
 /*============================================================================
  * 智能睡眠调度
  *============================================================================*/
 
-void power_update(float gyro_mag, float accel_mag)
+void power_update(bool moving)
 {
     uint32_t now = hal_get_tick_ms();
     
-    // 运动检测
-    bool was_moving = pwr.is_moving;
-    pwr.is_moving = (gyro_mag > MOTION_THRESHOLD);
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE
+    power_update_imu_profile(now);
+#endif
+    
+    // v0.6.3: 运动状态由共享 motion_state 提供, 与融合/RF 分频一致
+    pwr.is_moving = moving;
     
     if (pwr.is_moving) {
         pwr.last_motion_ms = now;
         pwr.idle_time_ms = 0;
         
+#if !(defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR)
         // 运动时切换到高性能模式
         if (pwr.clock_mode != CLK_MODE_HIGH) {
             power_set_clock_mode(CLK_MODE_HIGH);
         }
+#endif
         
         // 确保 RF 开启
         if (!pwr.rf_enabled) {
@@ -343,6 +492,7 @@ void power_update(float gyro_mag, float accel_mag)
     } else {
         pwr.idle_time_ms = now - pwr.last_motion_ms;
         
+#if !(defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR)
         // 空闲超时处理
         if (pwr.idle_time_ms > IDLE_TIMEOUT_MS) {
             // 降低时钟
@@ -357,6 +507,7 @@ void power_update(float gyro_mag, float accel_mag)
                 power_set_clock_mode(CLK_MODE_LOW);
             }
         }
+#endif
         
         // 自动睡眠
         if (pwr.auto_sleep_enabled && 
@@ -369,12 +520,26 @@ void power_update(float gyro_mag, float accel_mag)
     
     // 电池管理
     if (pwr.low_battery && !pwr.charging) {
-        // 低电量时强制省电
+        // 低电量时强制省电 (v0.6.3: 调节器启用时时钟仍按负载选择, 否则可能错过时隙)
+#if !(defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR)
         power_set_clock_mode(CLK_MODE_LOW);
+#endif
         power_disable_led();
     }
 }
 
+void power_motion_event(uint8_t events)
+{
+    if (events == 0) return;
+    
+    // 缓慢移动可能低于 MCU 的运动阈值, 但 IMU 已看到姿态变化
+    pwr.last_motion_ms = hal_get_tick_ms();
+    pwr.idle_time_ms = 0;
+    if (pwr.clock_mode != CLK_MODE_HIGH) {
+        power_set_clock_mode(CLK_MODE_HIGH);
+    }
+}
+
 /*============================================================================
  * RF 占空比优化
  *============================================================================*/
@@ -427,6 +592,10 @@ void power_optimizer_init(void)
     pwr.led_enabled = true;
     pwr.auto_sleep_enabled = false;
     pwr.auto_sleep_timeout_ms = 30000;  // 30秒
+#if defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR
+    pwr.gov_frame_us = hal_micros();
+    pwr.gov_busy_last = gov_busy_total();
+#endif
     
     power_update_current_estimate();
 }
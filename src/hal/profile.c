@@ -0,0 +1,88 @@
+/**
+ * @file profile.c
+ * @brief 周期计数探针 / Cycle-counter profiling probes
+ *
+ * v0.6.3: 见 profile.h
+ */
+
+#include "profile.h"
+#include <string.h>
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+static const char *const prof_names[PROF_COUNT] = {
+    [PROF_MAIN_LOOP]     = "main_loop",
+    [PROF_SENSOR_SAMPLE] = "sensor_sample",
+    [PROF_FUSION]        = "fusion",
+    [PROF_RF_TASK]       = "rf_task",
+    [PROF_USB_TASK]      = "usb_task",
+    [PROF_RF_ISR]        = "rf_isr",
+    [PROF_RF_TIMER_ISR]  = "rf_timer_isr",
+    [PROF_USB_ISR]       = "usb_isr",
+    [PROF_SPI_DMA_ISR]   = "spi_dma_isr",
+    [PROF_I2C_ISR]       = "i2c_isr",
+    [PROF_GPIO_ISR]      = "gpio_isr",
+};
+
+const char *prof_name(uint8_t id)
+{
+    return (id < PROF_COUNT) ? prof_names[id] : NULL;
+}
+
+#if defined(USE_PROFILE) && USE_PROFILE
+
+prof_stat_t prof_table[PROF_COUNT];
+
+int prof_get(uint8_t id, prof_stat_t *out)
+{
+    if (id >= PROF_COUNT || !out) return -1;
+
+    __disable_irq();
+    *out = prof_table[id];
+    __enable_irq();
+    return 0;
+}
+
+void prof_reset(void)
+{
+    __disable_irq();
+    memset(prof_table, 0, sizeof(prof_table));
+    __enable_irq();
+}
+
+uint32_t prof_take_window_max(uint8_t id)
+{
+    if (id >= PROF_COUNT) return 0;
+
+    __disable_irq();
+    uint32_t m = prof_table[id].win_max;
+    prof_table[id].win_max = 0;
+    __enable_irq();
+    return m;
+}
+
+#else
+
+int prof_get(uint8_t id, prof_stat_t *out)
+{
+    (void)id;
+    if (out) memset(out, 0, sizeof(*out));
+    return -1;
+}
+
+void prof_reset(void)
+{
+}
+
+uint32_t prof_take_window_max(uint8_t id)
+{
+    (void)id;
+    return 0;
+}
+
+#endif /* USE_PROFILE */
@@ -3,6 +3,7 @@
  * @brief Retained State Manager - 唤醒后快速恢复
  * 
  * v0.5.0: 保存和恢复关键状态，实现唤醒后姿态快速稳定
+ * v0.6.3: SRAM 后端 - cached_state 本身放在 Shutdown 保持区, 每次修改后重算 CRC
  */
 
 #include "retained_state.h"
@@ -14,14 +15,18 @@
  *============================================================================*/
 
 #define RETAINED_MAGIC          0x52455441  // "RETA"
-#define RETAINED_VERSION        1
+#define RETAINED_VERSION        3           // v0.6.3: 融合器检查点替代原始融合状态
 
 /*============================================================================
  * 静态变量
  *============================================================================*/
 
 // RAM缓存 (用于快速访问)
+#if RETAINED_USE_SRAM
+static retained_state_t cached_state __attribute__((section(".retained")));
+#else
 static retained_state_t cached_state;
+#endif
 static bool cache_valid = false;
 
 // 上次保存时间 (用于限制写入频率)
@@ -32,28 +37,6 @@ static uint32_t last_save_time = 0;
  * 内部函数
  *============================================================================*/
 
-/**
- * @brief 计算CRC16
- */
-static uint16_t calc_crc16(const void *data, uint16_t len)
-{
-    const uint8_t *p = (const uint8_t *)data;
-    uint16_t crc = 0xFFFF;
-    
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= p[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    
-    return crc;
-}
-
 /**
  * @brief 从Flash读取状态
  */
@@ -74,7 +57,7 @@ static int read_from_flash(retained_state_t *state)
     }
     
     // 验证CRC
-    uint16_t calc_crc = calc_crc16(state, sizeof(retained_state_t) - 2);
+    uint16_t calc_crc = hal_crc16(state, sizeof(retained_state_t) - 2);
     if (calc_crc != state->crc) {
         return -4;  // CRC错误
     }
@@ -85,6 +68,30 @@ static int read_from_flash(retained_state_t *state)
 #endif
 }
 
+/**
+ * @brief v0.6.3: 校验保持 RAM 中的状态 (复位后未清零)
+ */
+static bool ram_state_valid(void)
+{
+#if RETAINED_USE_SRAM
+    return cached_state.magic == RETAINED_MAGIC &&
+           cached_state.version == RETAINED_VERSION &&
+           cached_state.crc == hal_crc16(&cached_state, sizeof(retained_state_t) - 2);
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief v0.6.3: 修改缓存后重算 CRC (SRAM 后端下缓存即保持数据)
+ */
+static void seal_cache(void)
+{
+#if RETAINED_USE_SRAM
+    cached_state.crc = hal_crc16(&cached_state, sizeof(retained_state_t) - 2);
+#endif
+}
+
 /**
  * @brief 写入Flash
  */
@@ -111,6 +118,12 @@ static int write_to_flash(const retained_state_t *state)
 
 int retained_init(void)
 {
+    // v0.6.3: Shutdown 唤醒 (复位) 后保持 RAM 仍有效, 不读 Flash
+    if (ram_state_valid()) {
+        cache_valid = true;
+        return 0;
+    }
+    
     memset(&cached_state, 0, sizeof(cached_state));
     cache_valid = false;
     
@@ -127,6 +140,18 @@ int retained_save(const float quat[4], const float gyro_bias[3])
 {
     uint32_t now = hal_get_tick_ms();
     
+#if RETAINED_USE_SRAM
+    // v0.6.3: 只写保持 RAM, 没有擦写次数和延迟开销
+    cached_state.magic = RETAINED_MAGIC;
+    cached_state.version = RETAINED_VERSION;
+    cached_state.save_time_ms = now;
+    memcpy(cached_state.quat, quat, sizeof(float) * 4);
+    memcpy(cached_state.gyro_bias, gyro_bias, sizeof(float) * 3);
+    seal_cache();
+    cache_valid = true;
+    return 0;
+#endif
+    
     // 限制写入频率
     if (cache_valid && (now - last_save_time) < MIN_SAVE_INTERVAL_MS) {
         // 只更新RAM缓存
@@ -145,7 +170,7 @@ int retained_save(const float quat[4], const float gyro_bias[3])
     memcpy(cached_state.gyro_bias, gyro_bias, sizeof(float) * 3);
     
     // 计算CRC
-    cached_state.crc = calc_crc16(&cached_state, sizeof(retained_state_t) - 2);
+    cached_state.crc = hal_crc16(&cached_state, sizeof(retained_state_t) - 2);
     
     // 写入Flash
     int ret = write_to_flash(&cached_state);
@@ -203,7 +228,7 @@ bool retained_is_valid(void)
 
 void retained_clear(void)
 {
-    memset(&cached_state, 0, sizeof(cached_state));
+    memset(&cached_state, 0, sizeof(cached_state));    // magic 清零, 保持 RAM 同时失效
     cache_valid = false;
     
 #if RETAINED_USE_FLASH
@@ -211,40 +236,88 @@ void retained_clear(void)
 #endif
 }
 
-int retained_save_fusion_state(const void *state, uint16_t state_size)
+int retained_save_fusion(const fusion_checkpoint_t *ckpt)
 {
-    // 融合器状态通常较大，存储在单独区域
-    uint32_t offset = RETAINED_FLASH_OFFSET + sizeof(retained_state_t);
+    if (ckpt->version != FUSION_CKPT_VERSION) return -1;
     
-#if RETAINED_USE_FLASH
-    // 擦除
-    int ret = hal_storage_erase(offset, state_size);
-    if (ret != 0) return -1;
+    // 只更新缓存: 紧随其后的 retained_save() 写入时间戳/CRC 并落盘
+    memcpy(&cached_state.fusion, ckpt, sizeof(fusion_checkpoint_t));
+    seal_cache();
+    return 0;
+}
+
+int retained_restore_fusion(fusion_checkpoint_t *ckpt)
+{
+    if (!cache_valid) {
+        int ret = read_from_flash(&cached_state);
+        if (ret != 0) {
+            return ret;
+        }
+        cache_valid = true;
+    }
     
-    // 写入
-    ret = hal_storage_write(offset, state, state_size);
-    if (ret != 0) return -2;
+    if (cached_state.fusion.version != FUSION_CKPT_VERSION) {
+        return -5;
+    }
     
-    return 0;
-#else
-    (void)state;
-    (void)state_size;
-    return -1;
+    memcpy(ckpt, &cached_state.fusion, sizeof(fusion_checkpoint_t));
+    
+    uint32_t age = hal_get_tick_ms() - cached_state.save_time_ms;
+    return (age > RETAINED_VALID_TIMEOUT) ? 1 : 0;
+}
+
+int retained_save_link(const rf_link_snapshot_t *link)
+{
+    if (!cache_valid) return -1;
+    
+    memcpy(&cached_state.rf_link, link, sizeof(rf_link_snapshot_t));
+    cached_state.crc = hal_crc16(&cached_state, sizeof(retained_state_t) - 2);
+    
+#if RETAINED_USE_SRAM
+    return 0;   // v0.6.3: 保持 RAM 跨 Shutdown 有效
 #endif
+    
+    // Shutdown 会复位, 必须立即落盘 (同时写入被频率限制缓存的姿态)
+    int ret = write_to_flash(&cached_state);
+    if (ret == 0) {
+        last_save_time = hal_get_tick_ms();
+    }
+    
+    return ret;
+}
+
+int retained_restore_link(rf_link_snapshot_t *link)
+{
+    if (!cache_valid) {
+        int ret = read_from_flash(&cached_state);
+        if (ret != 0) {
+            return ret;
+        }
+        cache_valid = true;
+    }
+    
+    if (!cached_state.rf_link.valid) {
+        return -5;
+    }
+    
+    memcpy(link, &cached_state.rf_link, sizeof(rf_link_snapshot_t));
+    cached_state.rf_link.valid = 0;
+    seal_cache();
+    
+    return 0;
 }
 
-int retained_restore_fusion_state(void *state, uint16_t state_size)
+int retained_commit(void)
 {
-    uint32_t offset = RETAINED_FLASH_OFFSET + sizeof(retained_state_t);
+    if (!cache_valid) return -1;
+    
+    cached_state.crc = hal_crc16(&cached_state, sizeof(retained_state_t) - 2);
+    int ret = write_to_flash(&cached_state);
+    if (ret == 0) {
+        last_save_time = hal_get_tick_ms();
+    }
     
-#if RETAINED_USE_FLASH
-    int ret = hal_storage_read(offset, state, state_size);
     return ret;
-#else
-    (void)state;
-    (void)state_size;
-    return -1;
-#endif
 }
 
 void retained_increment_sleep_count(void)
@@ -253,6 +326,7 @@ void retained_increment_sleep_count(void)
         retained_init();
     }
     cached_state.sleep_count++;
+    seal_cache();
 }
 
 void retained_increment_wake_count(void)
@@ -261,6 +335,7 @@ void retained_increment_wake_count(void)
         retained_init();
     }
     cached_state.wake_count++;
+    seal_cache();
 }
 
 void retained_get_stats(uint32_t *sleep_count, uint32_t *wake_count, 
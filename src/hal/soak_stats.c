@@ -0,0 +1,246 @@
+/**
+ * @file soak_stats.c
+ * @brief 设备端窗口统计 / On-device windowed statistics
+ *
+ * v0.6.3: 见 soak_stats.h
+ */
+
+#include "soak_stats.h"
+#include "hal.h"
+#include "profile.h"
+#include <string.h>
+
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+#define SOAK_RING_MASK  (SOAK_RING_DEPTH - 1)
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+// 写入只在主循环 (关中断提交一条), 读出可在 USB 中断中
+static soak_window_t ring[SOAK_RING_DEPTH] RAM_ARENA(soak);
+static volatile uint16_t next_seq = 0;
+static volatile uint8_t stored = 0;
+
+static struct {
+    uint32_t start_ms;
+    uint32_t last_loop_us;              // 0 = 下一次迭代不计时
+    uint32_t loop_sum;
+    uint16_t loop_n;
+    uint16_t loop_min;
+    uint16_t loop_max;
+    uint32_t packets;
+    uint32_t lost;
+    int32_t  rssi_sum;
+    uint16_t rssi_n;
+    int8_t   rssi_min;
+    int8_t   rssi_max;
+    uint16_t sync_miss;
+    uint8_t  batt_min;
+    uint8_t  batt_max;
+#if defined(USE_PROFILE) && USE_PROFILE
+    uint32_t isr_count_last;
+    uint64_t isr_total_last;
+#endif
+} acc;
+
+#if defined(USE_PROFILE) && USE_PROFILE
+static const uint8_t isr_probes[] = {
+    PROF_RF_ISR, PROF_RF_TIMER_ISR, PROF_USB_ISR,
+    PROF_SPI_DMA_ISR, PROF_I2C_ISR, PROF_GPIO_ISR,
+};
+#endif
+
+static uint16_t sat16(uint32_t v)
+{
+    return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+static void window_reset(uint32_t now_ms)
+{
+    uint32_t last_loop_us = acc.last_loop_us;
+#if defined(USE_PROFILE) && USE_PROFILE
+    uint32_t isr_count_last = acc.isr_count_last;
+    uint64_t isr_total_last = acc.isr_total_last;
+#endif
+    memset(&acc, 0, sizeof(acc));
+    acc.start_ms = now_ms;
+    acc.last_loop_us = last_loop_us;
+    acc.loop_min = 0xFFFF;
+    acc.rssi_min = INT8_MAX;
+    acc.rssi_max = INT8_MIN;
+    acc.batt_min = 0xFF;
+#if defined(USE_PROFILE) && USE_PROFILE
+    acc.isr_count_last = isr_count_last;
+    acc.isr_total_last = isr_total_last;
+#endif
+}
+
+#if defined(USE_PROFILE) && USE_PROFILE
+// 各中断探针累计值之差; prof_reset 之后累计值变小, 本窗口记 0
+static void window_isr(soak_window_t *w)
+{
+    uint32_t count = 0;
+    uint64_t total = 0;
+    uint32_t max = 0;
+    prof_stat_t st;
+
+    for (uint8_t i = 0; i < sizeof(isr_probes); i++) {
+        if (prof_get(isr_probes[i], &st) != 0) continue;
+        count += st.count;
+        total += st.total;
+        uint32_t m = prof_take_window_max(isr_probes[i]);
+        if (m > max) max = m;
+    }
+
+    if (count >= acc.isr_count_last && total >= acc.isr_total_last) {
+        uint32_t dn = count - acc.isr_count_last;
+        uint64_t dt = total - acc.isr_total_last;
+        w->isr_count = sat16(dn);
+        w->isr_avg_cyc = dn ? sat16((uint32_t)(dt / dn)) : 0;
+        w->isr_max_cyc = max;
+    }
+    acc.isr_count_last = count;
+    acc.isr_total_last = total;
+}
+#endif
+
+static void window_commit(uint32_t now_ms)
+{
+    soak_window_t w;
+    memset(&w, 0, sizeof(w));
+
+    w.seq = next_seq;
+    w.dur_ms = sat16(now_ms - acc.start_ms);
+    if (acc.loop_n) {
+        w.loop_min_us = acc.loop_min;
+        w.loop_max_us = acc.loop_max;
+        w.loop_avg_us = (uint16_t)(acc.loop_sum / acc.loop_n);
+    }
+    w.packets = sat16(acc.packets);
+    w.lost = sat16(acc.lost);
+    if (acc.rssi_n) {
+        w.rssi_min = acc.rssi_min;
+        w.rssi_max = acc.rssi_max;
+        w.rssi_avg = (int8_t)(acc.rssi_sum / (int32_t)acc.rssi_n);
+    }
+    w.sync_miss = (acc.sync_miss > 0xFF) ? 0xFF : (uint8_t)acc.sync_miss;
+    w.batt_min = acc.batt_min;
+    w.batt_max = (acc.batt_min == 0xFF) ? 0xFF : acc.batt_max;
+#if defined(USE_PROFILE) && USE_PROFILE
+    window_isr(&w);
+#endif
+
+    __disable_irq();
+    ring[next_seq & SOAK_RING_MASK] = w;
+    next_seq++;
+    if (stored < SOAK_RING_DEPTH) stored++;
+    __enable_irq();
+}
+
+/*============================================================================
+ * 记录
+ *============================================================================*/
+
+void soak_init(void)
+{
+    __disable_irq();
+    next_seq = 0;
+    stored = 0;
+    __enable_irq();
+
+    acc.last_loop_us = 0;
+#if defined(USE_PROFILE) && USE_PROFILE
+    acc.isr_count_last = 0;
+    acc.isr_total_last = 0;
+    for (uint8_t i = 0; i < sizeof(isr_probes); i++) {
+        prof_take_window_max(isr_probes[i]);
+    }
+#endif
+    window_reset(hal_get_tick_ms());
+#if defined(USE_PROFILE) && USE_PROFILE
+    // 第一个窗口从当前累计值起算
+    soak_window_t w;
+    window_isr(&w);
+#endif
+}
+
+void soak_record_packets(uint16_t packets, uint16_t lost)
+{
+    acc.packets += packets;
+    acc.lost += lost;
+}
+
+void soak_record_rssi(int8_t rssi)
+{
+    if (rssi < acc.rssi_min) acc.rssi_min = rssi;
+    if (rssi > acc.rssi_max) acc.rssi_max = rssi;
+    acc.rssi_sum += rssi;
+    acc.rssi_n++;
+}
+
+void soak_record_sync_miss(void)
+{
+    acc.sync_miss++;
+}
+
+void soak_record_battery(uint8_t percent)
+{
+    if (percent < acc.batt_min) acc.batt_min = percent;
+    if (percent > acc.batt_max) acc.batt_max = percent;
+}
+
+bool soak_process(void)
+{
+    uint32_t now_us = hal_micros();
+
+    if (acc.last_loop_us != 0) {
+        uint16_t dt = sat16(now_us - acc.last_loop_us);
+        if (dt < acc.loop_min) acc.loop_min = dt;
+        if (dt > acc.loop_max) acc.loop_max = dt;
+        acc.loop_sum += dt;
+        acc.loop_n++;
+    }
+    acc.last_loop_us = now_us ? now_us : 1;
+
+    uint32_t now_ms = hal_get_tick_ms();
+    if (now_ms - acc.start_ms < SOAK_WINDOW_MS) return false;
+
+    window_commit(now_ms);
+    window_reset(now_ms);
+    return true;
+}
+
+/*============================================================================
+ * 读出
+ *============================================================================*/
+
+uint8_t soak_read(uint16_t from, soak_window_t *out, uint8_t max,
+                  uint16_t *first, uint16_t *next)
+{
+    __disable_irq();
+    uint16_t end = next_seq;
+    uint16_t oldest = (uint16_t)(end - stored);
+    if ((uint16_t)(end - from) > stored) from = oldest;
+
+    uint16_t avail = (uint16_t)(end - from);
+    uint8_t n = (avail < max) ? (uint8_t)avail : max;
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = ring[(uint16_t)(from + i) & SOAK_RING_MASK];
+    }
+    __enable_irq();
+
+    if (first) *first = from;
+    if (next) *next = end;
+    return n;
+}
+
+#endif /* USE_SOAK_STATS */
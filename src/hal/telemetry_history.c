@@ -0,0 +1,183 @@
+/**
+ * @file telemetry_history.c
+ * @brief 跨重启的每会话遥测汇总 / Flash-backed per-session telemetry
+ *
+ * v0.6.3: 见 telemetry_history.h
+ */
+
+#include "telemetry_history.h"
+#include "hal.h"
+#include "watchdog.h"
+#include <string.h>
+
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static telem_session_t cur;
+static uint32_t base_s = 0;             // 之前各段唤醒时间累计 (深睡眠复位 / Halt 后滴答重新计数)
+static uint32_t ref_ms = 0;             // 本段起点滴答
+static uint32_t last_save_ms = 0;
+static uint32_t last_loop_us = 0;       // 0 = 下一次迭代不计时 (启动/唤醒后)
+
+static uint16_t sat16(uint32_t v)
+{
+    return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+static uint32_t awake_s(void)
+{
+    return base_s + (hal_get_tick_ms() - ref_ms) / 1000;
+}
+
+static void snapshot(void)
+{
+    cur.duration_s = awake_s();
+    // 待写槽满时下一次迭代重试
+    if (hal_kv_set_deferred(HAL_KV_TELEM_CUR, &cur, sizeof(cur)) == 0) {
+        last_save_ms = hal_get_tick_ms();
+    }
+}
+
+/*============================================================================
+ * 初始化: 上一会话移入历史
+ *============================================================================*/
+
+void telem_init(bool resume)
+{
+    telem_session_t hist[TELEM_HISTORY_DEPTH];
+    telem_session_t prev;
+    uint16_t session = 0;
+
+    ref_ms = hal_get_tick_ms();
+    last_loop_us = 0;
+
+    bool have_prev = (hal_kv_get(HAL_KV_TELEM_CUR, &prev, sizeof(prev)) == (int)sizeof(prev));
+    if (resume && have_prev) {
+        // 深睡眠唤醒 (复位) 属于同一会话, 否则每次唤醒都会把历史挤掉
+        cur = prev;
+        base_s = prev.duration_s;
+        last_save_ms = ref_ms;
+        return;
+    }
+
+    int n = hal_kv_get(HAL_KV_TELEM_HIST, hist, sizeof(hist));
+    int depth = (n > 0) ? n / (int)sizeof(telem_session_t) : 0;
+    if (depth > TELEM_HISTORY_DEPTH) depth = TELEM_HISTORY_DEPTH;
+
+    if (have_prev) {
+        session = prev.session + 1;
+        if (depth == TELEM_HISTORY_DEPTH) {
+            depth--;
+        }
+        memmove(&hist[1], &hist[0], depth * sizeof(telem_session_t));
+        hist[0] = prev;
+        depth++;
+        // 每次启动只写一次, 之后只有周期快照
+        hal_kv_set(HAL_KV_TELEM_HIST, hist, depth * sizeof(telem_session_t));
+    }
+
+    memset(&cur, 0, sizeof(cur));
+    cur.session = session;
+    cur.reset_reason = (uint8_t)wdog_get_reset_reason();
+#if defined(BUILD_TRACKER)
+    cur.flags = TELEM_FLAG_TRACKER;
+#endif
+    cur.loop_min_us = 0xFFFF;
+    base_s = 0;
+
+    // 立即占位, 否则本会话在第一个周期前断电会把上一会话再移入历史一次
+    snapshot();
+}
+
+/*============================================================================
+ * 记录
+ *============================================================================*/
+
+void telem_record_rssi(int8_t rssi)
+{
+    int bin = ((int)rssi - TELEM_RSSI_BIN_BASE) / 10;
+    if (bin < 0) bin = 0;
+    if (bin >= TELEM_RSSI_BINS) bin = TELEM_RSSI_BINS - 1;
+    if (cur.rssi_hist[bin] < 0xFFFF) {
+        cur.rssi_hist[bin]++;
+    }
+}
+
+void telem_record_packets(uint16_t packets, uint16_t lost)
+{
+    cur.packets += packets;
+    cur.lost += lost;
+}
+
+void telem_record_sync_miss(void)
+{
+    if (cur.sync_miss < 0xFFFF) cur.sync_miss++;
+}
+
+void telem_record_sleep(void)
+{
+    if (cur.sleep_count < 0xFFFF) cur.sleep_count++;
+    base_s = awake_s();
+    ref_ms = hal_get_tick_ms();
+}
+
+void telem_record_wake(void)
+{
+    if (cur.wake_count < 0xFFFF) cur.wake_count++;
+    cur.flags &= (uint8_t)~TELEM_FLAG_CLEAN;
+    // 睡眠时长不计入运行时间和主循环迭代时间
+    ref_ms = hal_get_tick_ms();
+    last_save_ms = ref_ms;
+    last_loop_us = 0;
+}
+
+/*============================================================================
+ * 周期处理
+ *============================================================================*/
+
+void telem_process(void)
+{
+    uint32_t now_us = hal_micros();
+
+    if (last_loop_us != 0) {
+        uint16_t dt = sat16(now_us - last_loop_us);
+        if (dt < cur.loop_min_us) cur.loop_min_us = dt;
+        if (dt > cur.loop_max_us) cur.loop_max_us = dt;
+    }
+    last_loop_us = now_us ? now_us : 1;
+
+    if (hal_get_tick_ms() - last_save_ms >= TELEM_SAVE_INTERVAL_S * 1000UL) {
+        cur.flags &= (uint8_t)~TELEM_FLAG_CLEAN;
+        snapshot();
+    }
+}
+
+void telem_flush(void)
+{
+    cur.flags |= TELEM_FLAG_CLEAN;
+    snapshot();
+}
+
+bool telem_get_session(uint8_t index, telem_session_t *out)
+{
+    if (!out) return false;
+
+    if (index == 0) {
+        memcpy(out, &cur, sizeof(cur));
+        out->duration_s = awake_s();
+        return true;
+    }
+    if (index > TELEM_HISTORY_DEPTH) return false;
+
+    telem_session_t hist[TELEM_HISTORY_DEPTH];
+    int n = hal_kv_get(HAL_KV_TELEM_HIST, hist, sizeof(hist));
+    if (n < (int)(index * sizeof(telem_session_t))) return false;
+
+    memcpy(out, &hist[index - 1], sizeof(*out));
+    return true;
+}
+
+#endif /* USE_TELEMETRY_HISTORY */
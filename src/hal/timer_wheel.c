@@ -0,0 +1,234 @@
+/**
+ * @file timer_wheel.c
+ * @brief 分级时间轮 / Hierarchical timer wheel
+ *
+ * v0.6.3: 见 timer_wheel.h
+ */
+
+#include "timer_wheel.h"
+#include "hal.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+#define TW_MASK         (TW_SLOTS - 1)
+#define TW_SLOT_NONE    0xFF
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+// 槽表由主循环 (tw_process) 和装载/停止的调用者 (可能在中断中) 共同修改, 都在关中断临界区内
+static tw_timer_t *wheel[TW_LEVELS][TW_SLOTS];
+static uint16_t occupied[TW_LEVELS];            // 非空槽位图
+static uint32_t base_ms;                        // 下一个待处理的节拍
+static uint16_t armed;                          // 装载的定时器数
+
+/*============================================================================
+ * 链表
+ *============================================================================*/
+
+static void list_push(tw_timer_t **head, tw_timer_t *t)
+{
+    t->next = *head;
+    if (t->next) t->next->pprev = &t->next;
+    t->pprev = head;
+    *head = t;
+}
+
+static void list_unlink(tw_timer_t *t)
+{
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+// 按距 base_ms 的延时选级: 第 L 级放 [16^L, 16^(L+1)) 的延时, 更远的放最高级
+static void wheel_insert(tw_timer_t *t)
+{
+    int32_t delta = (int32_t)(t->expires_ms - base_ms);
+    if (delta < 0) {
+        t->expires_ms = base_ms;
+        delta = 0;
+    }
+
+    uint8_t level = 0;
+    while (level < TW_LEVELS - 1 && (uint32_t)delta >= (1UL << (TW_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    uint8_t slot = (uint8_t)((t->expires_ms >> (TW_SLOT_BITS * level)) & TW_MASK);
+
+    t->slot = (uint8_t)(level * TW_SLOTS + slot);
+    list_push(&wheel[level][slot], t);
+    occupied[level] |= (uint16_t)(1u << slot);
+}
+
+static void wheel_remove(tw_timer_t *t)
+{
+    uint8_t id = t->slot;
+    list_unlink(t);
+    if (id != TW_SLOT_NONE) {
+        uint8_t level = id / TW_SLOTS;
+        uint8_t slot = id % TW_SLOTS;
+        if (!wheel[level][slot]) occupied[level] &= (uint16_t)~(1u << slot);
+    }
+}
+
+// 把一个槽摘成局部链表
+static void detach(uint8_t level, uint8_t slot, tw_timer_t **local)
+{
+    *local = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    occupied[level] &= (uint16_t)~(1u << slot);
+    if (*local) (*local)->pprev = local;
+    for (tw_timer_t *t = *local; t; t = t->next) t->slot = TW_SLOT_NONE;
+}
+
+// 上一级的一个槽下移 (重新按剩余延时选级)
+static void cascade(uint8_t level, uint8_t slot)
+{
+    tw_timer_t *local;
+    detach(level, slot, &local);
+    while (local) {
+        tw_timer_t *t = local;
+        list_unlink(t);
+        wheel_insert(t);
+    }
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void tw_init(void)
+{
+    __disable_irq();
+    memset(wheel, 0, sizeof(wheel));
+    memset(occupied, 0, sizeof(occupied));
+    base_ms = hal_get_tick_ms();
+    armed = 0;
+    __enable_irq();
+}
+
+void tw_timer_init(tw_timer_t *t, tw_callback_t callback, void *ctx)
+{
+    memset(t, 0, sizeof(*t));
+    t->callback = callback;
+    t->ctx = ctx;
+    t->slot = TW_SLOT_NONE;
+}
+
+void tw_start(tw_timer_t *t, uint32_t delay_ms, uint32_t period_ms)
+{
+    if (delay_ms > TW_MAX_DELAY_MS) delay_ms = TW_MAX_DELAY_MS;
+    uint32_t now = hal_get_tick_ms();
+
+    __disable_irq();
+    if (tw_active(t)) {
+        wheel_remove(t);
+        armed--;
+    }
+    t->expires_ms = now + delay_ms;
+    t->period_ms = (period_ms > TW_MAX_DELAY_MS) ? TW_MAX_DELAY_MS : period_ms;
+    wheel_insert(t);
+    armed++;
+    __enable_irq();
+}
+
+void tw_stop(tw_timer_t *t)
+{
+    __disable_irq();
+    if (tw_active(t)) {
+        wheel_remove(t);
+        armed--;
+    }
+    __enable_irq();
+}
+
+void tw_process(void)
+{
+    uint32_t now = hal_get_tick_ms();
+
+    // 每个节拍一个临界区, 主循环迟到很多节拍时中断也不会被长时间屏蔽
+    for (;;) {
+        __disable_irq();
+        if ((int32_t)(now - base_ms) < 0) break;
+        if (armed == 0) {
+            base_ms = now + 1;          // 空转的节拍直接跳过
+            break;
+        }
+
+        uint32_t tick = base_ms;
+        uint8_t slot = (uint8_t)(tick & TW_MASK);
+
+        // 每 16 个节拍下移一级, 各级低位同时为 0 时继续下移更高一级
+        if (slot == 0) {
+            for (uint8_t level = 1; level < TW_LEVELS; level++) {
+                uint8_t idx = (uint8_t)((tick >> (TW_SLOT_BITS * level)) & TW_MASK);
+                cascade(level, idx);
+                if (idx != 0) break;
+            }
+        }
+
+        // 先前进再回调: 回调中装载的定时器最早落在下一个节拍
+        tw_timer_t *local;
+        detach(0, slot, &local);
+        base_ms = tick + 1;
+
+        // 回调时开中断; 其间停止的定时器从局部链表上摘除
+        while (local) {
+            tw_timer_t *t = local;
+            list_unlink(t);
+            if (t->period_ms) {
+                t->expires_ms += t->period_ms;
+                wheel_insert(t);
+            } else {
+                armed--;
+            }
+            tw_callback_t callback = t->callback;
+            void *ctx = t->ctx;
+            __enable_irq();
+            if (callback) callback(ctx);
+            __disable_irq();
+        }
+        __enable_irq();
+    }
+    __enable_irq();
+}
+
+uint32_t tw_next_ms(void)
+{
+    uint32_t now = hal_get_tick_ms();
+
+    __disable_irq();
+    if (armed == 0) {
+        __enable_irq();
+        return TW_NONE;
+    }
+
+    // 第 0 级从 base_ms 起找第一个非空槽; 都空时到下一次下移
+    uint32_t next = base_ms + (TW_SLOTS - (base_ms & TW_MASK));
+    for (uint8_t k = 0; k < TW_SLOTS; k++) {
+        uint8_t slot = (uint8_t)((base_ms + k) & TW_MASK);
+        if (k > 0 && slot == 0) break;
+        if (occupied[0] & (1u << slot)) {
+            next = base_ms + k;
+            break;
+        }
+    }
+    __enable_irq();
+
+    int32_t dt = (int32_t)(next - now);
+    return (dt > 0) ? (uint32_t)dt : 0;
+}
+
+#endif /* USE_TIMER_WHEEL */
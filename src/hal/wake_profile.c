@@ -0,0 +1,75 @@
+/**
+ * @file wake_profile.c
+ * @brief 唤醒耗时分段测量 / Wake-to-first-packet phase timing
+ *
+ * v0.6.3: 见 wake_profile.h
+ */
+
+#include "wake_profile.h"
+#include "hal.h"
+#include <string.h>
+
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+
+#define WAKE_KEEP_MAGIC     0x574B5550UL    // "WKUP"
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static wake_profile_t prof;
+static uint32_t last_us = 0;
+static uint32_t sleep_begin_us = 0;
+
+// Shutdown 进入耗时跨复位保存 (RAM2K 保持区, 上电复位时内容随机, magic 异或校验)
+static struct {
+    uint32_t check;
+    uint16_t entry_us;
+} keep __attribute__((section(".retained")));
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void wake_prof_start(uint8_t source)
+{
+    memset(&prof, 0, sizeof(prof));
+    prof.source = source;
+    if (keep.check == (WAKE_KEEP_MAGIC ^ keep.entry_us)) {
+        prof.entry_us = keep.entry_us;
+    }
+    keep.check = 0;
+    last_us = 0;            // 起点: hal_timer_init
+}
+
+void wake_prof_mark(wake_phase_t phase)
+{
+    if (prof.complete || phase >= WAKE_PH_COUNT) return;
+
+    uint32_t now = hal_micros();
+    prof.phase_us[phase] += now - last_us;
+    last_us = now;
+    if (phase == WAKE_PH_SYNC) {
+        prof.total_us = now;
+        prof.complete = 1;
+    }
+}
+
+void wake_prof_sleep_begin(void)
+{
+    sleep_begin_us = hal_micros();
+}
+
+void wake_prof_sleep_commit(void)
+{
+    uint32_t dt = hal_micros() - sleep_begin_us;
+    keep.entry_us = (dt > 0xFFFF) ? 0xFFFF : (uint16_t)dt;
+    keep.check = WAKE_KEEP_MAGIC ^ keep.entry_us;
+}
+
+void wake_prof_get(wake_profile_t *out)
+{
+    *out = prof;
+}
+
+#endif /* USE_WAKE_PROFILE */
@@ -0,0 +1,181 @@
+/**
+ * @file main_bench.c
+ * @brief 融合算法基准测试固件 / Fusion engine benchmark firmware
+ *
+ * v0.6.3: make TARGET=bench
+ * - 上电后等待 USB 枚举, 依次在目标板上回放轨迹跑全部融合引擎 (6 轴 + 9 轴)
+ * - 之后跑全部四元数编解码 (codec_bench.h)
+ * - 结果通过 usb_debug 日志输出, 之后每 5 秒重发一次, 便于主机随时接入
+ * - 主机: python tools/fusion_bench.py read
+ *
+ * 输出格式 (每行 < 56 字节):
+ *   FB trace <name> n=<samples> odr=<hz> mag=<0|1>
+ *   FB <engine> <6|9> cyc <min>/<avg>/<max>
+ *   FB <engine> <6|9> stk <bytes> st <bytes> n <samples>
+ *   FB <engine> <6|9> err <rms>/<max> tilt <rms>
+ *   CB <codec> <rnd|trj> cyc <enc>/<dec> B <bytes/sample>
+ *   CB <codec> err <rms>/<p50>/<p99>/<max>
+ *   CB <codec> n <samples> fail <failures>
+ *   FB done <runs>
+ */
+
+#include "hal.h"
+#include "board.h"
+#include "usb_hid_slime.h"
+#include "usb_debug.h"
+#include "fusion_bench.h"
+#include "codec_bench.h"
+#include <string.h>
+
+#ifdef CH59X
+#include "CH59x_common.h"
+#endif
+
+/*============================================================================
+ * usb_debug.c 引用的全局变量
+ *============================================================================*/
+
+float quaternion[4] = {1, 0, 0, 0};
+float gyro[3] = {0, 0, 0};
+float accel[3] = {0, 0, 0};
+uint8_t battery_percent = 100;
+bool is_charging = false;
+uint8_t tracker_id = 0xFF;
+
+/*============================================================================
+ * 结果缓存
+ *============================================================================*/
+
+#define BENCH_MAX_RUNS      16
+#define BENCH_REPEAT_MS     5000
+
+typedef struct {
+    fusion_bench_result_t result;
+    uint8_t axes;                   // 6 / 9
+} bench_entry_t;
+
+static bench_entry_t bench_results[BENCH_MAX_RUNS];
+static uint8_t bench_count = 0;
+static uint8_t bench_axes = 6;
+
+#define CODEC_MAX_RUNS      12
+
+static codec_bench_result_t codec_results[CODEC_MAX_RUNS];
+static uint8_t codec_count = 0;
+
+static void record_result(const fusion_bench_result_t *r)
+{
+    if (bench_count >= BENCH_MAX_RUNS) return;
+    bench_results[bench_count].result = *r;
+    bench_results[bench_count].axes = bench_axes;
+    bench_count++;
+}
+
+static void record_codec(const codec_bench_result_t *r)
+{
+    if (codec_count >= CODEC_MAX_RUNS) return;
+    codec_results[codec_count++] = *r;
+}
+
+// 日志包逐行发送, 等待 HID 端点空闲
+static void flush_usb(void)
+{
+    uint32_t start = hal_get_tick_ms();
+    while (usb_hid_busy() && (hal_get_tick_ms() - start) < 20) {
+        usb_hid_task();
+    }
+}
+
+static void report_all(const fusion_bench_trace_t *trace)
+{
+    usb_debug_printf("FB trace %s n=%lu odr=%u mag=%u", trace->name,
+                     (unsigned long)trace->count, trace->odr_hz, trace->has_mag ? 1 : 0);
+    flush_usb();
+
+    for (uint8_t i = 0; i < bench_count; i++) {
+        const fusion_bench_result_t *r = &bench_results[i].result;
+        uint8_t ax = bench_results[i].axes;
+
+        usb_debug_printf("FB %s %u cyc %lu/%lu/%lu", r->engine, ax,
+                         (unsigned long)r->cycles_min, (unsigned long)r->cycles_avg,
+                         (unsigned long)r->cycles_max);
+        flush_usb();
+        usb_debug_printf("FB %s %u stk %u st %u n %lu", r->engine, ax,
+                         r->stack_bytes, r->state_bytes, (unsigned long)r->samples);
+        flush_usb();
+        usb_debug_printf("FB %s %u err %.2f/%.2f tilt %.2f %s", r->engine, ax,
+                         r->err_rms_deg, r->err_max_deg, r->tilt_rms_deg,
+                         r->pass ? "ok" : "FAIL");
+        flush_usb();
+    }
+
+    for (uint8_t i = 0; i < codec_count; i++) {
+        const codec_bench_result_t *r = &codec_results[i];
+
+        usb_debug_printf("CB %s %s cyc %lu/%lu B %.2f", r->codec, r->trajectory ? "trj" : "rnd",
+                         (unsigned long)r->enc_cycles, (unsigned long)r->dec_cycles,
+                         r->bytes_per_sample);
+        flush_usb();
+        usb_debug_printf("CB %s err %.4f/%.4f/%.4f/%.4f", r->codec, r->err_rms_deg,
+                         r->err_p50_deg, r->err_p99_deg, r->err_max_deg);
+        flush_usb();
+        usb_debug_printf("CB %s n %lu fail %lu", r->codec, (unsigned long)r->samples,
+                         (unsigned long)r->failures);
+        flush_usb();
+    }
+
+    // v0.6.3: 超出引擎误差限值的次数, tools/fusion_bench.py read 据此返回非零
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < bench_count; i++) {
+        if (!bench_results[i].result.pass) failed++;
+    }
+    usb_debug_printf("FB done %u fail %u", bench_count, failed);
+    flush_usb();
+}
+
+/*============================================================================
+ * 主函数
+ *============================================================================*/
+
+int main(void)
+{
+#ifdef CH59X
+    SetSysClock(CLK_SOURCE_PLL_60MHz);
+#endif
+
+    hal_timer_init();
+
+    usb_hid_init();
+    usb_debug_init();
+
+    // 等待主机枚举
+    while (!usb_hid_connected()) {
+        usb_hid_task();
+    }
+    hal_delay_ms(1000);
+
+    const fusion_bench_trace_t *trace = fusion_bench_default_trace();
+
+    bench_axes = 6;
+    fusion_bench_run_all(trace, false, record_result);
+    if (trace->has_mag) {
+        bench_axes = 9;
+        fusion_bench_run_all(trace, true, record_result);
+    }
+    codec_bench_run_all(record_codec);
+
+    uint32_t last_report = 0;
+    bool first = true;
+
+    while (1) {
+        usb_hid_task();
+        usb_debug_process();
+
+        uint32_t now = hal_get_tick_ms();
+        if (first || now - last_report >= BENCH_REPEAT_MS) {
+            first = false;
+            last_report = now;
+            report_all(trace);
+        }
+    }
+}
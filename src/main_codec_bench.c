@@ -0,0 +1,57 @@
+/**
+ * @file main_codec_bench.c
+ * @brief 主机编解码基准 / Host-side packet codec microbenchmark
+ *
+ * v0.6.3: make codec-bench (主机编译器, 链接 hal_host.c 桩)
+ * - 与 TARGET=bench 相同的 codec_bench 模块, 时间单位为 ns (CLOCK_MONOTONIC)
+ * - 误差分布与平台无关, 可直接比较编解码精度; 周期数以片上结果为准
+ *
+ * 用法:
+ *   build/host/codec_bench [--csv]
+ */
+
+#include "codec_bench.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool csv_output = false;
+
+static void report(const codec_bench_result_t *r)
+{
+    if (csv_output) {
+        printf("%s,%s,%lu,%lu,%.3f,%.5f,%.5f,%.5f,%.5f,%lu,%lu\n", r->codec,
+               r->trajectory ? "trj" : "rnd",
+               (unsigned long)r->enc_cycles, (unsigned long)r->dec_cycles,
+               r->bytes_per_sample, r->err_rms_deg, r->err_p50_deg, r->err_p99_deg,
+               r->err_max_deg, (unsigned long)r->samples, (unsigned long)r->failures);
+        return;
+    }
+    printf("%-10s %-4s %7lu %7lu %7.2f %9.4f %9.4f %9.4f %9.4f %6lu %5lu\n", r->codec,
+           r->trajectory ? "trj" : "rnd",
+           (unsigned long)r->enc_cycles, (unsigned long)r->dec_cycles,
+           r->bytes_per_sample, r->err_rms_deg, r->err_p50_deg, r->err_p99_deg,
+           r->err_max_deg, (unsigned long)r->samples, (unsigned long)r->failures);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv_output = true;
+        } else {
+            fprintf(stderr, "usage: %s [--csv]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (csv_output) {
+        printf("codec,input,enc_ns,dec_ns,bytes,rms_deg,p50_deg,p99_deg,max_deg,n,fail\n");
+    } else {
+        printf("%-10s %-4s %7s %7s %7s %9s %9s %9s %9s %6s %5s\n", "codec", "in",
+               "enc_ns", "dec_ns", "B/smp", "rms_deg", "p50_deg", "p99_deg", "max_deg",
+               "n", "fail");
+    }
+
+    int done = codec_bench_run_all(report);
+    return (done == codec_bench_count()) ? 0 : 1;
+}
@@ -0,0 +1,788 @@
+/**
+ * @file main_netsim.c
+ * @brief 主机 TDMA 网络仿真 / Host-side TDMA network simulator
+ *
+ * v0.6.3: make netsim (主机编译器, BUILD_RECEIVER + rf_hw_host.c 仿真射频)
+ * - 接收端是真实固件: rf_receiver.c 的时隙布局/自动 ACK/备用时隙分配/自适应保护时间/
+ *   超帧速率, channel_manager.c 的信道质量与黑名单, rf_ultra_v2.c 的多样本解码
+ * - tracker 是模型: 按 rf_transmitter.c 的规则解析信标 (排名、保护时间、备用时隙、1Mbps),
+ *   用真实的 rf_multi_* 编码, 按本地时钟 (固定漂移 + 唤醒抖动) 在时隙发送;
+ *   未 ACK 的包在备用时隙按原序列号重传 (Selective Repeat), 丢信标时按标称帧周期预测
+ * - 空口: 每条链路 Gilbert-Elliott 突发丢包 (上下行独立), 一个 Wi-Fi 信道按占空比
+ *   干扰重叠的 RF 信道 (同时抬高能量检测 RSSI), 同信道时间重叠的包互相破坏
+ * - 报告每 tracker 样本吞吐、丢失率和延迟 p50/p95/p99 (样本时刻 → 接收器主循环取出)
+ *
+ * 简化:
+ * - tracker 总在接收器当前信道上发送 (跳频/信道映射跟随视为理想), 失步只来自丢信标和漂移
+ * - 只发关键帧多样本包; ACK / 信标中的命令 (FEC、功率、信道映射) 不执行
+ *
+ * 用法:
+ *   build/host/netsim [--trackers <n>] [--seconds <s>] [--loss <p>] [--burst <pkts>]
+ *                     [--wifi <1-13>] [--wifi-duty <p>] [--drift-ppm <ppm>] [--jitter-us <us>]
+ *                     [--rssi <dBm>] [--seed <n>] [--csv] [--max-loss <pct>]
+ */
+
+#include "hal.h"
+#include "config.h"
+#include "rf_hw.h"
+#include "rf_protocol.h"
+#include "rf_ultra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if !(defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME)
+#error "netsim models the adaptive superframe slot layout"
+#endif
+#if !(defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE)
+#error "netsim trackers send multi-sample packets"
+#endif
+
+#define SIM_WARMUP_US           500000      // 连接/保护时间收敛期, 不计入统计
+#define SIM_POLL_US             250         // 接收器主循环节拍
+#define SIM_AIR_MAX             32          // 同时在空中的包
+#define SIM_RETX_DEPTH          4           // 与 tracker 重传队列相同量级
+#define SIM_TX_PLAN_MAX         (1 + RF_SPARE_SLOT_MAX)
+#define SIM_BEACON_MARGIN_US    RF_SYNC_SLOT_US
+#define SIM_SYNC_LOST           10          // rf_transmitter.c SYNC_LOST_THRESHOLD
+#define SIM_LAT_BIN_US          10
+#define SIM_LAT_BINS            5000        // 50 ms, 更长的计入最后一格
+#define SIM_ODR_HZ              SENSOR_ODR_HZ
+#define SIM_NEVER               UINT64_MAX
+
+/*============================================================================
+ * 随机数 / 链路模型
+ *============================================================================*/
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng_next(void)
+{
+    // splitmix64
+    uint64_t z = (rng_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static double rng_unit(void)
+{
+    return (double)(rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+typedef struct {
+    double loss;                // 平均丢包率
+    double burst;               // 平均突发长度 (包), <= 1 为独立丢包
+    bool bad;
+} ge_link_t;
+
+/**
+ * @brief Gilbert-Elliott: 坏状态全丢, 好状态不丢; 离开坏状态概率 1/burst,
+ *        进入概率按稳态丢包率 loss 反推
+ */
+static bool ge_lost(ge_link_t *l)
+{
+    if (l->loss <= 0.0) return false;
+    if (l->burst <= 1.0) return rng_unit() < l->loss;
+
+    double p_bg = 1.0 / l->burst;
+    double p_gb = l->loss * p_bg / (1.0 - l->loss);
+    if (l->bad) {
+        if (rng_unit() < p_bg) l->bad = false;
+    } else {
+        if (rng_unit() < p_gb) l->bad = true;
+    }
+    return l->bad;
+}
+
+static uint8_t wifi_channel = 0;        // 0 = 无干扰
+static double wifi_duty = 0.3;
+
+static bool wifi_overlaps(uint8_t rf_channel)
+{
+    if (!wifi_channel) return false;
+    int f = RF_BASE_FREQ_MHZ + rf_channel * RF_CHANNEL_STEP_MHZ;
+    int center = 2407 + 5 * wifi_channel;
+    return abs(f - center) < 11 + 1;    // 22 MHz Wi-Fi 带宽 + 2 MHz 信号带宽
+}
+
+static bool wifi_hit(uint8_t rf_channel)
+{
+    return wifi_overlaps(rf_channel) && rng_unit() < wifi_duty;
+}
+
+static int8_t noise_rssi(uint8_t rf_channel)
+{
+    return wifi_hit(rf_channel) ? -50 : -95;
+}
+
+/*============================================================================
+ * tracker 模型
+ *============================================================================*/
+
+enum { TX_PRIMARY, TX_SPARE };
+
+typedef struct {
+    uint64_t at;
+    uint8_t kind;
+    bool slow;                  // 1Mbps 主时隙
+} tx_plan_t;
+
+typedef struct {
+    bool used;
+    uint8_t seq;
+    uint8_t len;
+    uint32_t sent_local;        // 上次构建/发送时刻 (本地时钟)
+    uint8_t pkt[RF_MAX_PAYLOAD_SIZE];
+} retx_entry_t;
+
+typedef struct {
+    uint8_t id;
+    double ppm;
+    double clk_offset_us;
+    int8_t rssi;
+    ge_link_t up;
+    ge_link_t down;
+
+    // 同步
+    bool synced;
+    uint64_t sync_us;           // 最近信标接收完成 (仿真时间)
+    uint64_t beacon_deadline;   // 此前未收到信标则计一次丢失
+    uint32_t frame_local_us;    // 标称帧周期 (本地时钟)
+    uint8_t missed;
+    uint8_t rank;
+    uint16_t slot_width_us;
+    bool slow;
+
+    tx_plan_t plan[SIM_TX_PLAN_MAX];
+    uint8_t plan_count;
+    uint8_t plan_next;
+
+    // 样本
+    uint64_t next_sample_us;
+    double sample_period_us;    // 仿真时间
+    uint32_t sample_index;
+    q15_t pend_quat[RF_MULTI_MAX_SAMPLES][4];
+    uint32_t pend_t[RF_MULTI_MAX_SAMPLES];
+    uint8_t pend_count;
+    uint8_t seq;
+    retx_entry_t retx[SIM_RETX_DEPTH];
+
+    // 统计 (预热期后)
+    uint32_t generated;
+    uint32_t overwritten;       // 发送前被新样本挤掉
+    uint32_t delivered;
+    uint32_t tx_packets;
+    uint32_t retx_packets;
+    uint32_t air_lost;          // 链路/干扰
+    uint32_t collided;
+    uint32_t not_listening;     // 到达时接收器不在该信道/速率/RX
+    uint32_t acked;
+    uint32_t beacons_missed;
+    uint32_t resyncs;
+    uint32_t lat_hist[SIM_LAT_BINS];
+    uint64_t lat_sum;
+    uint32_t lat_max;
+} sim_tracker_t;
+
+typedef struct {
+    bool used;
+    bool corrupt;
+    bool collided;
+    uint8_t tracker;
+    uint8_t seq;
+    uint8_t channel;
+    uint8_t rate;
+    uint8_t len;
+    uint32_t gen;
+    uint64_t start;
+    uint64_t end;
+    uint8_t data[RF_MAX_PAYLOAD_SIZE];
+} air_packet_t;
+
+static sim_tracker_t trackers[RF_MAX_TRACKERS];
+static uint8_t tracker_count = 10;
+static air_packet_t air[SIM_AIR_MAX];
+static uint64_t sim_now = 0;
+static uint64_t warmup_end = SIM_WARMUP_US;
+static uint32_t jitter_us = 5;
+static uint32_t beacons_sent = 0;
+static uint32_t air_overflow = 0;
+
+static rf_receiver_ctx_t rx;
+
+static inline bool counting(void)
+{
+    return sim_now >= warmup_end;
+}
+
+static uint32_t local_time(const sim_tracker_t *t, uint64_t us)
+{
+    return (uint32_t)(uint64_t)((double)us * (1.0 + t->ppm * 1e-6) + t->clk_offset_us);
+}
+
+/**
+ * @brief 本地时钟的时长 → 仿真时间
+ */
+static uint64_t local_span(const sim_tracker_t *t, uint32_t local_us)
+{
+    return (uint64_t)llround((double)local_us / (1.0 + t->ppm * 1e-6));
+}
+
+static uint64_t with_jitter(uint64_t at)
+{
+    if (!jitter_us) return at;
+    int64_t j = (int64_t)(rng_next() % (2 * jitter_us + 1)) - (int64_t)jitter_us;
+    return (uint64_t)((int64_t)at + j);
+}
+
+static void sample_quat(const sim_tracker_t *t, q15_t q[4])
+{
+    // 绕倾斜轴匀速转动, 每个 tracker 相位不同
+    double a = 0.5 * (2.0 * M_PI * 0.25 * (double)t->sample_index / SIM_ODR_HZ + t->id);
+    double s = sin(a);
+    q[0] = (q15_t)(cos(a) * 32767.0);
+    q[1] = (q15_t)(s * 0.48 * 32767.0);
+    q[2] = (q15_t)(s * 0.60 * 32767.0);
+    q[3] = (q15_t)(s * 0.64 * 32767.0);
+}
+
+static void tracker_sample(sim_tracker_t *t)
+{
+    if (t->pend_count == RF_MULTI_MAX_SAMPLES) {
+        memmove(t->pend_quat[0], t->pend_quat[1], sizeof(t->pend_quat[0]) * (RF_MULTI_MAX_SAMPLES - 1));
+        memmove(&t->pend_t[0], &t->pend_t[1], sizeof(t->pend_t[0]) * (RF_MULTI_MAX_SAMPLES - 1));
+        t->pend_count--;
+        if (counting()) t->overwritten++;
+    }
+    sample_quat(t, t->pend_quat[t->pend_count]);
+    t->pend_t[t->pend_count] = local_time(t, sim_now);
+    t->pend_count++;
+    t->sample_index++;
+    if (counting()) t->generated++;
+
+    t->next_sample_us = (uint64_t)llround((double)t->sample_index * t->sample_period_us) + t->id * 37;
+}
+
+static void plan_add(sim_tracker_t *t, uint64_t base, uint32_t offset_local, uint8_t kind, bool slow)
+{
+    if (t->plan_count >= SIM_TX_PLAN_MAX) return;
+    tx_plan_t *p = &t->plan[t->plan_count++];
+    p->at = with_jitter(base + local_span(t, offset_local));
+    p->kind = kind;
+    p->slow = slow;
+}
+
+static rf_tracker_mask_t mask_from(const uint8_t *bytes)
+{
+    rf_tracker_mask_t m = 0;
+    for (uint8_t i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+        m |= (rf_tracker_mask_t)bytes[i] << (i * 8);
+    }
+    return m;
+}
+
+/**
+ * @brief 信标 → 本帧发送计划 (rf_transmitter.c process_sync_beacon / calculate_my_slot_time)
+ */
+static void tracker_on_beacon(sim_tracker_t *t, const rf_sync_packet_t *sync, uint64_t end_us)
+{
+    rf_tracker_mask_t active = mask_from(sync->active_mask);
+    if (!((active >> t->id) & 1)) return;
+
+    if (!t->synced && counting()) t->resyncs++;
+    t->synced = true;
+    t->missed = 0;
+    t->sync_us = end_us;
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    t->frame_local_us = rf_frame_rate_period(RF_RATE_CUR(sync->frame_rate));
+#else
+    t->frame_local_us = RF_SUPERFRAME_US;
+#endif
+    t->beacon_deadline = end_us + local_span(t, t->frame_local_us) + SIM_BEACON_MARGIN_US;
+
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    uint8_t guard = sync->slot_guard;
+    if (guard > RF_GUARD_MAX_US) guard = RF_GUARD_MAX_US;
+    t->slot_width_us = RF_SLOT_WIDTH_US(guard);
+#else
+    t->slot_width_us = RF_SLOT_US;
+#endif
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    rf_tracker_mask_t sched = mask_from(sync->sched_mask);
+#else
+    rf_tracker_mask_t sched = active;
+#endif
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    rf_tracker_mask_t phy = mask_from(sync->phy_mask);
+#else
+    rf_tracker_mask_t phy = 0;
+#endif
+    t->slow = (phy >> t->id) & 1;
+
+    uint8_t rank = 0, total = 0;
+    for (uint8_t i = 0; i < RF_TRACKER_MASK_BYTES * 8; i++) {
+        if (!((sched >> i) & 1)) continue;
+        uint8_t w = ((phy >> i) & 1) ? 2 : 1;
+        if (i < t->id) rank += w;
+        total += w;
+    }
+    t->rank = rank;
+
+    t->plan_count = 0;
+    t->plan_next = 0;
+    if ((sched >> t->id) & 1) {
+        plan_add(t, end_us, RF_SYNC_SLOT_US + (uint32_t)rank * t->slot_width_us, TX_PRIMARY, t->slow);
+    }
+    for (uint8_t k = 0; k < RF_SPARE_SLOT_MAX; k++) {
+        if (total + k >= sync->slot_count) break;
+        if (sync->spare_owner[k] != t->id) continue;
+        plan_add(t, end_us, RF_SYNC_SLOT_US + (uint32_t)(total + k) * t->slot_width_us, TX_SPARE, false);
+    }
+}
+
+/**
+ * @brief 信标超时: 按标称周期预测本帧, 只用主时隙
+ */
+static void tracker_on_beacon_timeout(sim_tracker_t *t)
+{
+    uint64_t period = local_span(t, t->frame_local_us);
+
+    if (counting()) t->beacons_missed++;
+    if (++t->missed > SIM_SYNC_LOST) {
+        t->synced = false;
+        t->plan_count = 0;
+        t->beacon_deadline = SIM_NEVER;
+        return;
+    }
+    uint64_t predicted = t->sync_us + (uint64_t)t->missed * period;
+    t->beacon_deadline = predicted + period + SIM_BEACON_MARGIN_US;
+    t->plan_count = 0;
+    t->plan_next = 0;
+    plan_add(t, predicted, RF_SYNC_SLOT_US + (uint32_t)t->rank * t->slot_width_us, TX_PRIMARY, t->slow);
+}
+
+static int build_fresh(sim_tracker_t *t, uint8_t *pkt, uint32_t now_local)
+{
+    if (t->pend_count == 0) return 0;
+
+    rf_multi_clear();
+    for (uint8_t i = 0; i < t->pend_count; i++) {
+        rf_multi_push_sample(t->pend_quat[i], t->pend_t[i]);
+    }
+    t->pend_count = 0;
+    int len = rf_multi_build_packet(pkt, t->id, t->seq, 1000, 80, 0, now_local);
+    if (len <= 0) return 0;
+
+    // 入重传队列 (满时挤掉最旧)
+    retx_entry_t *slot = &t->retx[0];
+    for (uint8_t i = 0; i < SIM_RETX_DEPTH; i++) {
+        if (!t->retx[i].used) {
+            slot = &t->retx[i];
+            break;
+        }
+        if ((int8_t)(t->retx[i].seq - slot->seq) < 0) slot = &t->retx[i];
+    }
+    slot->used = true;
+    slot->seq = t->seq;
+    slot->len = (uint8_t)len;
+    slot->sent_local = now_local;
+    memcpy(slot->pkt, pkt, (size_t)len);
+
+    t->seq++;
+    return len;
+}
+
+static int build_retx(sim_tracker_t *t, uint8_t *pkt, uint32_t now_local)
+{
+    for (;;) {
+        retx_entry_t *e = NULL;
+        for (uint8_t i = 0; i < SIM_RETX_DEPTH; i++) {
+            if (t->retx[i].used && (!e || (int8_t)(t->retx[i].seq - e->seq) < 0)) e = &t->retx[i];
+        }
+        if (!e) return 0;
+        if (rf_multi_restamp_packet(e->pkt, e->len, now_local - e->sent_local) != 0) {
+            e->used = false;        // 年龄超出重传可表示范围
+            continue;
+        }
+        e->sent_local = now_local;
+        memcpy(pkt, e->pkt, e->len);
+        return e->len;
+    }
+}
+
+static void air_start(sim_tracker_t *t, const uint8_t *pkt, uint8_t len, bool slow)
+{
+    air_packet_t *a = NULL;
+    for (uint8_t i = 0; i < SIM_AIR_MAX; i++) {
+        if (!air[i].used) {
+            a = &air[i];
+            break;
+        }
+    }
+    if (!a) {
+        air_overflow++;
+        return;
+    }
+
+    uint32_t airtime = RF_AIRTIME_US(len) * (slow ? 2 : 1);
+    a->used = true;
+    a->tracker = t->id;
+    a->seq = pkt[2];
+    a->channel = rf_hw_get_channel();
+    a->rate = slow ? RF_MODE_1MBPS : RF_MODE_2MBPS;
+    a->gen = rf_hw_host_radio_gen();
+    a->len = len;
+    a->start = sim_now;
+    a->end = sim_now + airtime;
+    a->collided = false;
+    a->corrupt = ge_lost(&t->up) || wifi_hit(a->channel);
+    memcpy(a->data, pkt, len);
+
+    for (uint8_t i = 0; i < SIM_AIR_MAX; i++) {
+        air_packet_t *b = &air[i];
+        if (b == a || !b->used || b->channel != a->channel) continue;
+        if (b->end > a->start) {
+            a->collided = true;
+            b->collided = true;
+        }
+    }
+    if (counting()) t->tx_packets++;
+}
+
+static void tracker_tx(sim_tracker_t *t)
+{
+    tx_plan_t *p = &t->plan[t->plan_next++];
+    uint32_t now_local = local_time(t, sim_now);
+    uint8_t pkt[RF_MAX_PAYLOAD_SIZE];
+    int len = 0;
+
+    if (p->kind == TX_PRIMARY) {
+        len = build_fresh(t, pkt, now_local);
+    } else {
+        len = build_retx(t, pkt, now_local);
+        if (len > 0) {
+            if (counting()) t->retx_packets++;
+        } else {
+            len = build_fresh(t, pkt, now_local);   // 无待重传: 发第二样本
+        }
+    }
+    if (len > 0) air_start(t, pkt, (uint8_t)len, p->slow);
+}
+
+static void air_end(air_packet_t *a)
+{
+    sim_tracker_t *t = &trackers[a->tracker];
+    a->used = false;
+
+    if (a->collided) {
+        if (counting()) t->collided++;
+        return;
+    }
+    if (a->corrupt) {
+        if (counting()) t->air_lost++;
+        return;
+    }
+    int r = rf_hw_host_deliver(a->data, a->len, t->rssi, a->rate, a->gen);
+    if (r < 0) {
+        if (counting()) t->not_listening++;
+        return;
+    }
+    if (r == 1 && !ge_lost(&t->down) && !wifi_hit(a->channel)) {
+        for (uint8_t i = 0; i < SIM_RETX_DEPTH; i++) {
+            if (t->retx[i].used && t->retx[i].seq == a->seq) t->retx[i].used = false;
+        }
+        if (counting()) t->acked++;
+    }
+}
+
+/*============================================================================
+ * 下行 (接收器发出的包)
+ *============================================================================*/
+
+static void on_radio_tx(const uint8_t *data, uint8_t len, uint8_t channel, uint8_t rate)
+{
+    (void)rate;
+    if (len != sizeof(rf_sync_packet_t) || data[0] != RF_PKT_SYNC_BEACON) return;
+
+    rf_sync_packet_t sync;
+    memcpy(&sync, data, sizeof(sync));
+    uint64_t end = sim_now + RF_AIRTIME_US(len);
+    beacons_sent++;
+
+    for (uint8_t i = 0; i < tracker_count; i++) {
+        sim_tracker_t *t = &trackers[i];
+        if (ge_lost(&t->down) || wifi_hit(channel)) continue;
+        tracker_on_beacon(t, &sync, end);
+    }
+}
+
+/*============================================================================
+ * 接收器主循环
+ *============================================================================*/
+
+static void receiver_poll(void)
+{
+    rf_timeline_sample_t s[RF_TIMELINE_DEPTH];
+
+    rf_receiver_process(&rx);
+    for (uint8_t i = 0; i < tracker_count; i++) {
+        sim_tracker_t *t = &trackers[i];
+        uint8_t n = rf_receiver_timeline_read(i, s, RF_TIMELINE_DEPTH);
+        for (uint8_t k = 0; k < n; k++) {
+            if ((int32_t)(s[k].t_us - (uint32_t)warmup_end) < 0) continue;
+            int32_t lat = (int32_t)((uint32_t)sim_now - s[k].t_us);
+            if (lat < 0) lat = 0;
+            uint32_t bin = (uint32_t)lat / SIM_LAT_BIN_US;
+            if (bin >= SIM_LAT_BINS) bin = SIM_LAT_BINS - 1;
+            t->lat_hist[bin]++;
+            t->lat_sum += (uint32_t)lat;
+            if ((uint32_t)lat > t->lat_max) t->lat_max = (uint32_t)lat;
+            t->delivered++;
+        }
+    }
+}
+
+/*============================================================================
+ * 仿真主循环
+ *============================================================================*/
+
+static void run(uint64_t end_us)
+{
+    uint64_t next_poll = 0;
+
+    while (sim_now < end_us) {
+        uint64_t next = end_us;
+        uint64_t timer_at;
+        bool timer_on = rf_hw_host_next_timer(&timer_at);
+
+        if (timer_on && timer_at < next) next = timer_at;
+        if (next_poll < next) next = next_poll;
+        for (uint8_t i = 0; i < SIM_AIR_MAX; i++) {
+            if (air[i].used && air[i].end < next) next = air[i].end;
+        }
+        for (uint8_t i = 0; i < tracker_count; i++) {
+            sim_tracker_t *t = &trackers[i];
+            if (t->next_sample_us < next) next = t->next_sample_us;
+            if (t->synced && t->beacon_deadline < next) next = t->beacon_deadline;
+            if (t->plan_next < t->plan_count && t->plan[t->plan_next].at < next) {
+                next = t->plan[t->plan_next].at;
+            }
+        }
+        if (next < sim_now) next = sim_now;
+        sim_now = next;
+        hal_host_set_time_us(sim_now);
+
+        // 同一时刻: 包结束 → 接收器定时器 → tracker → 主循环
+        for (uint8_t i = 0; i < SIM_AIR_MAX; i++) {
+            if (air[i].used && air[i].end <= sim_now) air_end(&air[i]);
+        }
+        if (timer_on && timer_at <= sim_now) rf_hw_host_run_timer();
+        for (uint8_t i = 0; i < tracker_count; i++) {
+            sim_tracker_t *t = &trackers[i];
+            if (t->synced && t->beacon_deadline <= sim_now) tracker_on_beacon_timeout(t);
+            while (t->plan_next < t->plan_count && t->plan[t->plan_next].at <= sim_now) tracker_tx(t);
+            if (t->next_sample_us <= sim_now) tracker_sample(t);
+        }
+        if (next_poll <= sim_now) {
+            receiver_poll();
+            next_poll = sim_now + SIM_POLL_US;
+        }
+    }
+}
+
+/*============================================================================
+ * 报告
+ *============================================================================*/
+
+static uint32_t lat_percentile(const uint32_t *hist, uint32_t count, double p)
+{
+    if (!count) return 0;
+    uint32_t target = (uint32_t)ceil(p * count);
+    uint32_t acc = 0;
+    for (uint32_t b = 0; b < SIM_LAT_BINS; b++) {
+        acc += hist[b];
+        if (acc >= target) return b * SIM_LAT_BIN_US + SIM_LAT_BIN_US / 2;
+    }
+    return SIM_LAT_BINS * SIM_LAT_BIN_US;
+}
+
+static double loss_pct(const sim_tracker_t *t)
+{
+    if (!t->generated) return 0.0;
+    double lost = (double)t->generated - (double)t->delivered;
+    if (lost < 0.0) lost = 0.0;
+    return 100.0 * lost / t->generated;
+}
+
+static void report(double seconds, bool csv)
+{
+    static uint32_t all_hist[SIM_LAT_BINS];
+    sim_tracker_t all;
+    memset(&all, 0, sizeof(all));
+    memset(all_hist, 0, sizeof(all_hist));
+
+    if (csv) {
+        printf("id,ppm,generated,delivered,loss_pct,samples_hz,tx,retx,air_lost,collided,not_listening,"
+               "acked,beacons_missed,resyncs,lat_avg_us,lat_p50_us,lat_p95_us,lat_p99_us,lat_max_us\n");
+    } else {
+        printf("%-4s %7s %7s %7s %7s %8s %6s %6s %6s %6s %6s %6s %7s %6s %6s %6s %6s\n",
+               "id", "ppm", "gen", "dlv", "loss%", "Hz", "tx", "retx", "air", "coll", "miss",
+               "bcnX", "avg_us", "p50", "p95", "p99", "max");
+    }
+
+    for (uint8_t i = 0; i <= tracker_count; i++) {
+        const sim_tracker_t *t = &trackers[i];
+        const uint32_t *hist = t->lat_hist;
+        char name[8];
+
+        if (i == tracker_count) {
+            t = &all;
+            hist = all_hist;
+            snprintf(name, sizeof(name), "all");
+        } else {
+            snprintf(name, sizeof(name), "%u", t->id);
+            all.generated += t->generated;
+            all.delivered += t->delivered;
+            all.tx_packets += t->tx_packets;
+            all.retx_packets += t->retx_packets;
+            all.air_lost += t->air_lost;
+            all.collided += t->collided;
+            all.not_listening += t->not_listening;
+            all.acked += t->acked;
+            all.beacons_missed += t->beacons_missed;
+            all.resyncs += t->resyncs;
+            all.lat_sum += t->lat_sum;
+            if (t->lat_max > all.lat_max) all.lat_max = t->lat_max;
+            for (uint32_t b = 0; b < SIM_LAT_BINS; b++) all_hist[b] += t->lat_hist[b];
+        }
+
+        double hz = t->delivered / seconds;
+        if (i == tracker_count && tracker_count) hz /= tracker_count;
+        double avg = t->delivered ? (double)t->lat_sum / t->delivered : 0.0;
+        uint32_t p50 = lat_percentile(hist, t->delivered, 0.50);
+        uint32_t p95 = lat_percentile(hist, t->delivered, 0.95);
+        uint32_t p99 = lat_percentile(hist, t->delivered, 0.99);
+
+        if (csv) {
+            printf("%s,%.1f,%u,%u,%.3f,%.1f,%u,%u,%u,%u,%u,%u,%u,%u,%.0f,%u,%u,%u,%u\n",
+                   name, t->ppm, (unsigned)t->generated, (unsigned)t->delivered, loss_pct(t), hz,
+                   (unsigned)t->tx_packets, (unsigned)t->retx_packets, (unsigned)t->air_lost,
+                   (unsigned)t->collided, (unsigned)t->not_listening, (unsigned)t->acked,
+                   (unsigned)t->beacons_missed, (unsigned)t->resyncs, avg, (unsigned)p50,
+                   (unsigned)p95, (unsigned)p99, (unsigned)t->lat_max);
+        } else {
+            printf("%-4s %7.1f %7u %7u %7.3f %8.1f %6u %6u %6u %6u %6u %6u %7.0f %6u %6u %6u %6u\n",
+                   name, t->ppm, (unsigned)t->generated, (unsigned)t->delivered, loss_pct(t), hz,
+                   (unsigned)t->tx_packets, (unsigned)t->retx_packets, (unsigned)t->air_lost,
+                   (unsigned)t->collided, (unsigned)t->not_listening, (unsigned)t->beacons_missed,
+                   avg, (unsigned)p50, (unsigned)p95, (unsigned)p99, (unsigned)t->lat_max);
+        }
+    }
+}
+
+/*============================================================================
+ * 主程序
+ *============================================================================*/
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: netsim [--trackers <n>] [--seconds <s>] [--loss <p>] [--burst <pkts>]\n"
+            "              [--wifi <1-13>] [--wifi-duty <p>] [--drift-ppm <ppm>] [--jitter-us <us>]\n"
+            "              [--rssi <dBm>] [--seed <n>] [--csv] [--max-loss <pct>]\n");
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 10.0;
+    double loss = 0.0;
+    double burst = 1.0;
+    double drift_ppm = 20.0;
+    double max_loss = -1.0;
+    int rssi = -60;
+    uint32_t seed = 1;
+    bool csv = false;
+    int n = tracker_count;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has_val = (i + 1 < argc);
+
+        if (strcmp(a, "--trackers") == 0 && has_val) n = atoi(argv[++i]);
+        else if (strcmp(a, "--seconds") == 0 && has_val) seconds = strtod(argv[++i], NULL);
+        else if (strcmp(a, "--loss") == 0 && has_val) loss = strtod(argv[++i], NULL);
+        else if (strcmp(a, "--burst") == 0 && has_val) burst = strtod(argv[++i], NULL);
+        else if (strcmp(a, "--wifi") == 0 && has_val) wifi_channel = (uint8_t)atoi(argv[++i]);
+        else if (strcmp(a, "--wifi-duty") == 0 && has_val) wifi_duty = strtod(argv[++i], NULL);
+        else if (strcmp(a, "--drift-ppm") == 0 && has_val) drift_ppm = strtod(argv[++i], NULL);
+        else if (strcmp(a, "--jitter-us") == 0 && has_val) jitter_us = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(a, "--rssi") == 0 && has_val) rssi = atoi(argv[++i]);
+        else if (strcmp(a, "--seed") == 0 && has_val) seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(a, "--csv") == 0) csv = true;
+        else if (strcmp(a, "--max-loss") == 0 && has_val) max_loss = strtod(argv[++i], NULL);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (n < 1 || n > RF_MAX_TRACKERS || seconds <= 0.0 || loss < 0.0 || loss >= 1.0 ||
+        wifi_channel > 13) {
+        usage();
+        return 2;
+    }
+    tracker_count = (uint8_t)n;
+
+    rng_state ^= (uint64_t)seed * 0xD1B54A32D192ED03ull;
+    hal_host_seed_random(seed);
+    hal_host_set_time_us(0);
+    rf_hw_host_set_tx_hook(on_radio_tx);
+    rf_hw_host_set_noise(noise_rssi);
+
+    if (rf_receiver_init(&rx) != 0) {
+        fprintf(stderr, "rf_receiver_init failed\n");
+        return 1;
+    }
+    for (uint8_t i = 0; i < tracker_count; i++) {
+        sim_tracker_t *t = &trackers[i];
+        uint8_t mac[6] = { 0x02, 0x53, 0x49, 0x4D, 0x00, i };
+
+        t->id = i;
+        t->ppm = (2.0 * rng_unit() - 1.0) * drift_ppm;
+        t->clk_offset_us = (double)(rng_next() % 1000000);
+        t->rssi = (int8_t)(rssi - (i * 3) % 12);
+        t->up.loss = t->down.loss = loss;
+        t->up.burst = t->down.burst = burst;
+        t->beacon_deadline = SIM_NEVER;
+        t->sample_period_us = 1e6 / SIM_ODR_HZ / (1.0 + t->ppm * 1e-6);
+        t->next_sample_us = (uint64_t)i * 37;
+        rf_receiver_restore_pairing(&rx, i, mac);
+    }
+    rf_receiver_start(&rx);
+
+    uint64_t end_us = warmup_end + (uint64_t)(seconds * 1e6);
+    run(end_us);
+
+    printf("netsim: %u trackers, %.1f s (+%.1f s warmup), loss %.3f burst %.1f, wifi %u duty %.2f, "
+           "drift ±%.0f ppm, jitter ±%u us, seed %u\n",
+           tracker_count, seconds, warmup_end / 1e6, loss, burst, wifi_channel, wifi_duty,
+           drift_ppm, (unsigned)jitter_us, (unsigned)seed);
+    printf("beacons %u, frame %u us, rx ring dropped %u, air overflow %u\n",
+           (unsigned)beacons_sent, (unsigned)RF_FRAME_US, (unsigned)rf_receiver_get_rx_dropped(),
+           (unsigned)air_overflow);
+    report(seconds, csv);
+
+    if (max_loss >= 0.0) {
+        for (uint8_t i = 0; i < tracker_count; i++) {
+            if (loss_pct(&trackers[i]) > max_loss) {
+                printf("FAIL: tracker %u loss %.3f%% > %.3f%%\n", i, loss_pct(&trackers[i]), max_loss);
+                return 1;
+            }
+        }
+        printf("loss ok (<= %.3f%%)\n", max_loss);
+    }
+    return 0;
+}
@@ -10,6 +10,13 @@
  * - 信道质量监控
  * - UF2 固件更新 (MSC 模式)
  * - v0.6.2: RF Ultra高效数据包支持
+ * - v0.6.3: 抖动缓冲 + 帧对齐时间戳 USB 报告
+ * - v0.6.3: Bundle 报告, 一次中断传输携带全部 tracker
+ * - v0.6.3: 可选姿态外推到 USB 报告时刻 (USE_RX_PREDICTION)
+ * - v0.6.3: 可选按 tracker 的 One-Euro 自适应平滑 (USE_RX_SMOOTHING)
+ * - v0.6.3: 双接收器分集, 副接收器旁听 + 逐包转发报告 (USE_RX_DIVERSITY)
+ * - v0.6.3: 超帧时序追踪经 usb_debug 数据流输出 (USE_RF_AIRTIME_TRACE)
+ * - v0.6.3: 两台接收器组成漫游组, 各自独立调度一个小区 (USE_RF_ROAMING)
  * 
  * RAM 使用: ~2KB
  * Flash 使用: ~40KB
@@ -26,12 +33,48 @@
 #include "error_codes.h"
 #include "slime_packet.h"  // v0.4.25: nRF packet兼容层
 #include "watchdog.h"      // v0.6.2: 看门狗和故障恢复
+#include "rf_slot_optimizer.h"  // v0.6.3: 批量命令下发
+#include "profile.h"        // v0.6.3: 周期计数探针
+#include "telemetry_history.h"  // v0.6.3: 跨重启遥测汇总
+#include "soak_stats.h"         // v0.6.3: 窗口统计
+#include "timer_wheel.h"        // v0.6.3: 分级时间轮
+#include "hal_led.h"        // v0.6.3: 节拍驱动 LED 图案
 
 // v0.6.2: RF Ultra支持
 #if defined(USE_RF_ULTRA) && USE_RF_ULTRA
 #include "rf_ultra.h"
 #endif
 
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+#include "rx_predict.h"
+#endif
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+#include "rx_smooth.h"
+#endif
+
+#if (defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE) || \
+    (defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH) || \
+    (defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG) || \
+    (defined(USE_SOAK_STATS) && USE_SOAK_STATS)
+#include "usb_debug.h"          // v0.6.3: 追踪流/链路密钥/事件环/窗口统计命令转交 usb_debug_command()
+#endif
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+#include "rf_airtime_trace.h"
+#endif
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+#include "ota_update.h"
+#include "rf_ota.h"
+#endif
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+#include "diagnostics.h"
+#endif
+
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY
+#include "channel_manager.h"
+#endif
+
 #include <string.h>
 
 #ifdef CH59X
@@ -63,35 +106,13 @@
 #define LED_BLINK_SLOW_MS       500
 
 /*============================================================================
- * 追踪器数据结构 - Receiver本地使用，避免与rf_protocol.h中的tracker_info_t冲突
+ * 追踪器状态
+ * v0.6.3: 直接读取 rf_ctx.trackers[] (rf_receiver 在收包时写入, 整数 Q15/mg),
+ * 不再维护本地副本; active = 已配对, connected = 未超时
  *============================================================================*/
 
-typedef struct {
-    bool active;
-    bool paired;
-    uint8_t mac[6];
-    
-    // 最新数据
-    int16_t quat[4];            // Q15 格式
-    int16_t accel[3];           // mg
-    uint8_t battery;
-    uint8_t status;
-    int8_t rssi;
-    
-    // 统计
-    uint32_t last_seen;
-    uint32_t packet_count;
-    uint8_t packet_loss;
-    
-    // v0.4.23: 详细统计信息
-    uint32_t total_packets;     // 总接收包数
-    uint32_t lost_packets;      // 丢失包数
-    uint32_t retransmit_count;  // 重传次数
-    uint32_t timeout_count;     // 超时次数
-    uint32_t crc_error_count;   // CRC错误次数
-    uint8_t loss_rate_pct;      // 丢包率百分比 (滑动平均)
-    uint8_t last_sequence;      // 上一个序列号 (用于检测丢包)
-} receiver_tracker_t;  // 重命名避免冲突
+// 接收器 RSSI 按 dBm + 128 保存
+#define TRACKER_RSSI_DBM(t)     ((int8_t)((t)->rssi - 128))
 
 /*============================================================================
  * 运行状态
@@ -118,7 +139,6 @@ static uint8_t error_code = 0;
 static rf_receiver_ctx_t rf_ctx;
 
 // 追踪器
-static receiver_tracker_t trackers[MAX_TRACKERS];
 static uint8_t active_tracker_count = 0;
 static uint32_t tracker_mask = 0;       // 活跃追踪器位图
 
@@ -128,20 +148,34 @@ static uint8_t frame_number = 0;
 static uint32_t last_beacon_time = 0;
 
 // 配对
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+static tw_timer_t pair_timer;           // v0.6.3: 进入配对模式时装载的单次超时
+#else
 static uint32_t pair_mode_start = 0;
+#endif
+static bool pairing_started = false;
 
 // LED
+#if !(defined(USE_LED_PATTERN) && USE_LED_PATTERN)
 static uint32_t led_toggle_time = 0;
 static bool led_state = false;
+#endif
 
 // USB HID 发送缓冲区
 static uint8_t usb_tx_buffer[64];
 
+// v0.6.3: packet3/packet0 报告模板 (Report ID + 固定字段), 配对时按 tracker ID 生成一次,
+// 发送时只改写状态/电量字段
+#define SLIME_REPORT_SIZE       (1 + SLIME_PACKET_SIZE)
+static uint8_t status_reports[MAX_TRACKERS][SLIME_REPORT_SIZE] RAM_ARENA(receiver);
+static uint8_t info_reports[MAX_TRACKERS][SLIME_REPORT_SIZE] RAM_ARENA(receiver);
+static uint32_t report_template_mask = 0;
+
 /*============================================================================
  * Flash 存储 - 使用 hal_storage API
  *============================================================================*/
 
-// 使用hal_storage的相对地址 (CONFIG_STORAGE_ADDR = 0x0010)
+// v0.6.3: 保存到键值存储 HAL_KV_RX_CONFIG; 旧固定偏移只用于读取升级前的数据
 #define STORAGE_CONFIG_OFFSET   0x0010
 #define FLASH_MAGIC             0x52584E    // "NXR"
 
@@ -161,14 +195,25 @@ typedef struct {
  *============================================================================*/
 
 static void enter_state(receiver_state_t new_state);
+static bool fill_link_stats(uint8_t id, uint8_t out[28]);
+static void build_report_templates(uint8_t id);
 static void process_button(void);
 static void update_led(void);
+#if defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS
+static void send_frame_reports(void);    // v0.6.3: 帧对齐报告
+#else
 static void send_usb_report(void);
+#endif
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+static void send_forward_reports(void);  // v0.6.3: 分集转发报告
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+static void send_aux_reports(void);      // v0.6.3: 辅助 IMU 姿态报告
+#endif
 static void send_status_packets(void);   // v0.4.25: packet3状态包
 static void send_info_packets(void);     // v0.5.0: packet0设备信息
 static void save_config(void);
 static bool load_config(void);
-static uint8_t find_or_create_tracker(const uint8_t *mac);
 
 /*============================================================================
  * 状态切换
@@ -178,22 +223,37 @@ static void enter_state(receiver_state_t new_state)
 {
     state = new_state;
     state_enter_time = hal_get_tick_ms();
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+    if (new_state != STATE_PAIRING) tw_stop(&pair_timer);
+#endif
     
     switch (new_state) {
         case STATE_RUNNING:
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_ON);
+#else
             led_state = true;
             hal_gpio_write(PIN_LED, true);
+#endif
             rf_hw_set_mode(RF_MODE_RX);
             break;
             
         case STATE_PAIRING:
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+            tw_start(&pair_timer, PAIR_MODE_TIMEOUT_MS, 0);
+#else
             pair_mode_start = hal_get_tick_ms();
+#endif
             rf_hw_set_channel(PAIR_CHANNEL);
             rf_hw_set_mode(RF_MODE_RX);
             break;
             
         case STATE_BOOTLOADER:
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_OFF);
+#else
             hal_gpio_write(PIN_LED, false);
+#endif
             rf_hw_set_mode(RF_MODE_SLEEP);
             bootloader_enter_update_mode();
             break;
@@ -207,23 +267,586 @@ static void enter_state(receiver_state_t new_state)
     }
 }
 
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+static void pair_timeout_cb(void *ctx)
+{
+    (void)ctx;
+    if (state != STATE_PAIRING) return;
+    rf_receiver_stop_pairing(&rf_ctx);
+    pairing_started = false;
+    enter_state(STATE_RUNNING);
+}
+#endif
+
 /*============================================================================
  * 同步信标广播
  *============================================================================*/
 
 
+/**
+ * @brief v0.6.3: 链路统计 28 字节 (USB 命令 0x22 响应 [1..28], 批量流 USB_BULK_T_LINK)
+ * [0] ID, [1] bit0=active bit1=connected, [2-4] 窗口丢包/重复/迟到 %,
+ * [5] RSSI, [6] 电量, [7..26] received/lost/duplicate/late/ring_dropped (uint32 LE)
+ * @return false ID 无效
+ */
+static bool fill_link_stats(uint8_t id, uint8_t out[28])
+{
+    rf_link_stats_t ls;
+    if (!rf_receiver_get_link_stats(id, &ls)) return false;
+    
+    out[0] = id;
+    out[1] = (rf_ctx.trackers[id].active ? 0x01 : 0) |
+             (rf_ctx.trackers[id].connected ? 0x02 : 0);
+    out[2] = ls.window_loss_pct;
+    out[3] = ls.window_dup_pct;
+    out[4] = ls.window_late_pct;
+    out[5] = rf_ctx.trackers[id].rssi;
+    out[6] = rf_ctx.trackers[id].battery;
+    const uint32_t counters[5] = {
+        ls.received, ls.lost, ls.duplicate, ls.late, ls.ring_dropped
+    };
+    for (int k = 0; k < 5; k++) {
+        out[7 + k * 4] = (uint8_t)counters[k];
+        out[8 + k * 4] = (uint8_t)(counters[k] >> 8);
+        out[9 + k * 4] = (uint8_t)(counters[k] >> 16);
+        out[10 + k * 4] = (uint8_t)(counters[k] >> 24);
+    }
+    out[27] = 0;
+    return true;
+}
+
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+/*============================================================================
+ * v0.6.3: Vendor 批量数据流 (帧格式见 usb_hid_slime.h)
+ * 
+ * 样本在抖动缓冲/逐时隙报告取出时间线时逐个写入, 不受 HID 报告节拍限制;
+ * FIFO 满时整帧丢弃, HID 报告不受影响
+ *============================================================================*/
+
+#define BULK_STREAM_SAMPLES     0x01    // 每个解码样本 (需 USE_USB_FRAME_REPORTS)
+#define BULK_STREAM_TRACE       0x02    // 超帧时序记录 (需 USE_RF_AIRTIME_TRACE)
+#define BULK_STREAM_LINK        0x04    // 链路统计, 约 1Hz
+#define BULK_LINK_FRAMES        200
+#define BULK_SAMPLE_SIZE        20
+#define BULK_LINK_SIZE          28
+
+static uint8_t bulk_stream_mask = 0;
+
+static void bulk_stream_set(uint8_t mask)
+{
+    bulk_stream_mask = mask;
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+    rf_trace_enable((mask & BULK_STREAM_TRACE) != 0);
+#endif
+}
+
+static void bulk_stream_samples(uint8_t id, const rf_timeline_sample_t *s, uint8_t n)
+{
+    if (!(bulk_stream_mask & BULK_STREAM_SAMPLES)) return;
+    
+    for (uint8_t i = 0; i < n; i++, s++) {
+        uint8_t p[BULK_SAMPLE_SIZE];
+        p[0] = id;
+        p[1] = (uint8_t)s->frame;
+        p[2] = (uint8_t)(s->frame >> 8);
+        p[3] = (uint8_t)s->frame_offset_us;
+        p[4] = (uint8_t)((uint16_t)s->frame_offset_us >> 8);
+        p[5] = (uint8_t)s->t_us;
+        p[6] = (uint8_t)(s->t_us >> 8);
+        p[7] = (uint8_t)(s->t_us >> 16);
+        p[8] = (uint8_t)(s->t_us >> 24);
+        for (int c = 0; c < 4; c++) {
+            p[9 + c * 2] = (uint8_t)s->quat[c];
+            p[10 + c * 2] = (uint8_t)((uint16_t)s->quat[c] >> 8);
+        }
+        p[17] = 0;
+        p[18] = 0;
+        p[19] = rf_ctx.trackers[id].rssi;
+        if (usb_bulk_send(USB_BULK_T_SAMPLE, p, sizeof(p)) < 0) return;
+    }
+}
+
+static void bulk_stream_task(void)
+{
+    static uint16_t link_frames = 0;
+    
+    if (!bulk_stream_mask || !usb_hid_ready()) return;
+    
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+    if (bulk_stream_mask & BULK_STREAM_TRACE) {
+        uint8_t rec[64];
+        while (usb_bulk_free() >= USB_BULK_HDR_SIZE + sizeof(rec)) {
+            uint8_t n = rf_trace_read(rec);
+            if (n == 0) break;
+            usb_bulk_send(USB_BULK_T_TRACE, rec, n);
+        }
+    }
+#endif
+    
+    // 按超帧计数 (帧事件由 USB 报告路径消费, 这里用帧号差)
+    static uint16_t last_frame = 0;
+    uint16_t frame = rf_ctx.frame_number;
+    link_frames += (uint16_t)(frame - last_frame);
+    last_frame = frame;
+    if ((bulk_stream_mask & BULK_STREAM_LINK) && link_frames >= BULK_LINK_FRAMES) {
+        link_frames = 0;
+        for (uint8_t i = 0; i < MAX_TRACKERS; i++) {
+            if (!rf_ctx.trackers[i].active) continue;
+            uint8_t p[BULK_LINK_SIZE];
+            if (!fill_link_stats(i, p)) continue;
+            if (usb_bulk_send(USB_BULK_T_LINK, p, sizeof(p)) < 0) break;
+        }
+    }
+}
+#endif
+
+#if defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS
+/*============================================================================
+ * v0.6.3: 抖动缓冲 + 帧对齐 USB 报告
+ * 
+ * rf_receiver 时间线中的样本按 RF 帧号进入每tracker抖动缓冲, 每个超帧
+ * 结束后播放 USB_JITTER_FRAMES 帧之前的样本, USB 报告节拍跟随 RF 帧
+ * 而不是独立的 5ms 定时。
+ * 
+ * Report 0x02 (64 字节):
+ * [0]      0x02
+ * [1]      条目数 (本报告)
+ * [2-3]    帧号 (LE)
+ * [4..]    每tracker 12 字节:
+ *          [0]    tracker ID (bit7 = 本帧无新样本, 重复上一样本)
+ *          [1]    状态 (bit0=active, 其余同 legacy)
+ *          [2-9]  四元数 w,x,y,z int16 Q15 (LE)
+ *          [10-11] 样本相对帧起点的时间 int16 us (LE)
+ * tracker 多于 5 个时同一帧分多个报告发送
+ *============================================================================*/
+
+#define JITTER_DEPTH            8       // 每tracker缓存样本数 (2的幂)
+#define FRAME_REPORT_ID         0x02
+#define FRAME_REPORT_HDR_SIZE   4
+#define FRAME_REPORT_ENTRY_SIZE 12
+#define FRAME_REPORT_ENTRIES    ((64 - FRAME_REPORT_HDR_SIZE) / FRAME_REPORT_ENTRY_SIZE)
+#define FRAME_REPORT_MAX        ((MAX_TRACKERS + FRAME_REPORT_ENTRIES - 1) / FRAME_REPORT_ENTRIES)
+#define FRAME_STALE_FLAG        0x80
+#define PLAYOUT_MAX_LAG         8       // 落后超过N帧直接追到最新
+
+typedef struct {
+    rf_timeline_sample_t samples[JITTER_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    rf_timeline_sample_t last;          // 上次播放的样本
+    bool has_last;
+} jitter_buffer_t;
+
+static jitter_buffer_t jitter[MAX_TRACKERS] RAM_ARENA(receiver);
+static uint16_t playout_frame = 0;
+static bool playout_started = false;
+
+#if !(defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS)
+static uint8_t frame_reports[FRAME_REPORT_MAX][64];
+static uint8_t frame_report_count = 0;
+static uint8_t frame_report_sent = 0;
+#endif
+
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+/*
+ * v0.6.3: 端到端延迟 - 新样本写入待发报告时记下样本时刻, 该报告交给 USB 端点时
+ * 以 hal_micros() 与之相减 (同一接收器时钟); 重复上一样本的条目不计
+ */
+static uint32_t lat_sample_us[MAX_TRACKERS];
+static rf_tracker_mask_t lat_pending = 0;
+
+static void latency_mark(uint8_t id, uint32_t t_us)
+{
+    lat_sample_us[id] = t_us;
+    lat_pending |= (rf_tracker_mask_t)1 << id;
+}
+
+static void latency_submit(rf_tracker_mask_t ids)
+{
+    ids &= lat_pending;
+    lat_pending &= ~ids;
+    uint32_t now_us = hal_micros();
+    for (uint8_t i = 0; ids; i++, ids >>= 1) {
+        if (ids & 1) diag_record_latency(i, now_us - lat_sample_us[i]);
+    }
+}
+
+#if !(defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS)
+static rf_tracker_mask_t frame_report_fresh(const uint8_t *rep)
+{
+    rf_tracker_mask_t ids = 0;
+    for (uint8_t k = 0; k < rep[1]; k++) {
+        uint8_t e = rep[FRAME_REPORT_HDR_SIZE + k * FRAME_REPORT_ENTRY_SIZE];
+        if (!(e & FRAME_STALE_FLAG)) ids |= (rf_tracker_mask_t)1 << e;
+    }
+    return ids;
+}
+#endif
+#endif
+
+static void jitter_fill(uint8_t id)
+{
+    rf_timeline_sample_t in[RF_TIMELINE_DEPTH];
+    uint8_t n = rf_receiver_timeline_read(id, in, RF_TIMELINE_DEPTH);
+    jitter_buffer_t *jb = &jitter[id];
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+    bulk_stream_samples(id, in, n);
+#endif
+    
+    for (uint8_t i = 0; i < n; i++) {
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+        // v0.6.3: 重传补回的样本可能晚于更新的样本到达:
+        // 比已播放样本还旧的丢弃, 其余按 (帧号, 时刻) 插入保持有序
+        if (jb->has_last && (int32_t)(in[i].t_us - jb->last.t_us) <= 0) continue;
+#endif
+        jb->samples[jb->head] = in[i];
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+        rx_smooth_apply(id, jb->samples[jb->head].quat, in[i].t_us);
+#endif
+        jb->head = (jb->head + 1) & (JITTER_DEPTH - 1);
+        if (jb->count < JITTER_DEPTH) jb->count++;   // 满时覆盖最旧
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+        uint8_t pos = (jb->head - 1) & (JITTER_DEPTH - 1);
+        for (uint8_t k = 1; k < jb->count; k++) {
+            uint8_t prev = (pos - 1) & (JITTER_DEPTH - 1);
+            rf_timeline_sample_t *a = &jb->samples[prev];
+            rf_timeline_sample_t *b = &jb->samples[pos];
+            int16_t df = (int16_t)(a->frame - b->frame);
+            if (df < 0 || (df == 0 && (int32_t)(a->t_us - b->t_us) <= 0)) break;
+            rf_timeline_sample_t tmp = *a;
+            *a = *b;
+            *b = tmp;
+            pos = prev;
+        }
+#endif
+    }
+}
+
+/**
+ * @brief 取出属于 target 帧 (及更早) 的样本, 保留最新的一个用于播放
+ * @return true = 有新样本, false = 重复上一样本
+ */
+static bool jitter_take(uint8_t id, uint16_t target)
+{
+    jitter_buffer_t *jb = &jitter[id];
+    bool fresh = false;
+    
+    while (jb->count > 0) {
+        uint8_t tail = (jb->head - jb->count) & (JITTER_DEPTH - 1);
+        rf_timeline_sample_t *s = &jb->samples[tail];
+        if ((int16_t)(s->frame - target) > 0) break;   // 未到播放时刻
+        
+        jb->last = *s;
+        jb->has_last = true;
+        jb->count--;
+        fresh = true;
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+        rx_predict_feed(id, s->quat, s->t_us);
+#endif
+    }
+    
+    return fresh;
+}
+
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+/**
+ * @brief v0.6.3: 把播放帧的样本写入 USB bundle 缓存 (Report 0x03)
+ * 
+ * 10 个 tracker 只需一次中断传输, 状态随 bundle 旁路发送
+ */
+static bool bundle_pending = false;
+
+static void build_bundle(uint16_t frame)
+{
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+    uint32_t now_us = hal_micros();
+#endif
+    
+    for (int i = 0; i < MAX_TRACKERS; i++) {
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
+        if (!tr->active) {
+            usb_hid_remove_tracker(i);
+            continue;
+        }
+        
+        jitter_fill(i);
+        bool fresh = jitter_take(i, frame);
+        
+        if (!jitter[i].has_last) continue;
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+        // 外推到报告时刻: 没有新样本的帧也继续外推 (跨度受限)
+        int16_t pq[4];
+        int32_t span;
+        rx_predict_get(i, now_us, pq, &span);
+        if (fresh || span > 0) {
+            usb_hid_update_tracker(i, pq, tr->accel_mg, tr->battery, TRACKER_RSSI_DBM(tr));
+        }
+#else
+        if (fresh) {
+            usb_hid_update_tracker(i, jitter[i].last.quat, tr->accel_mg, tr->battery, TRACKER_RSSI_DBM(tr));
+        }
+#endif
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+        if (fresh) latency_mark(i, jitter[i].last.t_us);
+#endif
+        usb_hid_set_tracker_status(i, (tr->connected ? 0x01 : 0x00) | (tr->flags & 0xFE));
+    }
+    
+    usb_hid_bundle_begin(frame);
+    bundle_pending = true;
+}
+#else
+
+static void build_frame_reports(uint16_t frame)
+{
+    frame_report_count = 0;
+    frame_report_sent = 0;
+    
+    uint8_t *rep = NULL;
+    uint8_t entries = 0;
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+    uint32_t now_us = hal_micros();
+#endif
+    
+    for (int i = 0; i < MAX_TRACKERS; i++) {
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
+        if (!tr->active) continue;
+        
+        jitter_fill(i);
+        bool fresh = jitter_take(i, frame);
+        
+        jitter_buffer_t *jb = &jitter[i];
+        if (!jb->has_last) continue;
+        
+        if (!rep || entries >= FRAME_REPORT_ENTRIES) {
+            if (frame_report_count >= FRAME_REPORT_MAX) break;
+            rep = frame_reports[frame_report_count++];
+            memset(rep, 0, 64);
+            rep[0] = FRAME_REPORT_ID;
+            rep[2] = frame & 0xFF;
+            rep[3] = frame >> 8;
+            entries = 0;
+        }
+        
+        // 样本时间相对播放帧起点 (重复样本来自更早的帧)
+        int32_t offset = jb->last.frame_offset_us +
+                         (int32_t)(int16_t)(jb->last.frame - frame) * RF_FRAME_US;
+        
+        const int16_t *quat = jb->last.quat;
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+        // 外推后的姿态对应的时刻随之后移
+        int16_t pq[4];
+        int32_t span;
+        if (rx_predict_get(i, now_us, pq, &span)) {
+            quat = pq;
+            offset += span;
+        }
+        if (offset > INT16_MAX) offset = INT16_MAX;
+#endif
+        if (offset < INT16_MIN) offset = INT16_MIN;
+        
+        uint8_t *e = &rep[FRAME_REPORT_HDR_SIZE + entries * FRAME_REPORT_ENTRY_SIZE];
+        e[0] = i | (fresh ? 0 : FRAME_STALE_FLAG);
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+        if (fresh) latency_mark(i, jb->last.t_us);
+#endif
+        e[1] = (tr->connected ? 0x01 : 0x00) | (tr->flags & 0xFE);
+        for (int c = 0; c < 4; c++) {
+            e[2 + c * 2] = quat[c] & 0xFF;
+            e[3 + c * 2] = (quat[c] >> 8) & 0xFF;
+        }
+        e[10] = (uint8_t)offset;
+        e[11] = (uint8_t)((uint16_t)offset >> 8);
+        
+        entries++;
+        rep[1] = entries;
+    }
+}
+
+#if defined(USE_USB_SLOT_REPORTS) && USE_USB_SLOT_REPORTS
+/**
+ * @brief v0.6.3: 逐时隙报告 - 把刚解码的样本直接打包 (每 tracker 只取最新一个)
+ * 
+ * 报告头帧号取本报告第一个样本的帧, 时间戳相对该帧起点; 没有新样本的
+ * tracker 不出现在报告中
+ */
+static void build_slot_reports(void)
+{
+    frame_report_count = 0;
+    frame_report_sent = 0;
+    
+    uint8_t *rep = NULL;
+    uint8_t entries = 0;
+    uint16_t frame = 0;
+    
+    for (int i = 0; i < MAX_TRACKERS; i++) {
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
+        if (!tr->active) continue;
+        
+        rf_timeline_sample_t in[RF_TIMELINE_DEPTH];
+        uint8_t n = rf_receiver_timeline_read(i, in, RF_TIMELINE_DEPTH);
+        if (n == 0) continue;
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+        bulk_stream_samples(i, in, n);
+#endif
+        
+        jitter_buffer_t *jb = &jitter[i];
+        const rf_timeline_sample_t *s = &in[n - 1];
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+        // 重传补回的旧样本晚于新样本到达时不再发出
+        if (jb->has_last && (int32_t)(s->t_us - jb->last.t_us) <= 0) continue;
+#endif
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+        for (uint8_t k = 0; k < n; k++) {
+            if (jb->has_last && (int32_t)(in[k].t_us - jb->last.t_us) <= 0) continue;
+            rx_smooth_apply(i, in[k].quat, in[k].t_us);
+        }
+#endif
+        jb->last = *s;
+        jb->has_last = true;
+        
+        if (!rep || entries >= FRAME_REPORT_ENTRIES) {
+            if (frame_report_count >= FRAME_REPORT_MAX) break;
+            rep = frame_reports[frame_report_count++];
+            memset(rep, 0, 64);
+            frame = s->frame;
+            rep[0] = FRAME_REPORT_ID;
+            rep[2] = frame & 0xFF;
+            rep[3] = frame >> 8;
+            entries = 0;
+        }
+        
+        int32_t offset = s->frame_offset_us + (int32_t)(int16_t)(s->frame - frame) * RF_FRAME_US;
+        if (offset > INT16_MAX) offset = INT16_MAX;
+        if (offset < INT16_MIN) offset = INT16_MIN;
+        
+        uint8_t *e = &rep[FRAME_REPORT_HDR_SIZE + entries * FRAME_REPORT_ENTRY_SIZE];
+        e[0] = i;
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+        latency_mark(i, s->t_us);
+#endif
+        e[1] = (tr->connected ? 0x01 : 0x00) | (tr->flags & 0xFE);
+        for (int c = 0; c < 4; c++) {
+            e[2 + c * 2] = s->quat[c] & 0xFF;
+            e[3 + c * 2] = (s->quat[c] >> 8) & 0xFF;
+        }
+        e[10] = (uint8_t)offset;
+        e[11] = (uint8_t)((uint16_t)offset >> 8);
+        
+        entries++;
+        rep[1] = entries;
+    }
+}
+#endif
+#endif
+
+static void send_frame_reports(void)
+{
+    static uint32_t status_packet_counter = 0;  // v0.4.25: 状态包计数
+    static uint32_t info_packet_counter = 0;    // v0.5.0: 设备信息包计数
+    static bool status_due = false;
+    static bool info_due = false;
+    
+    // 先把当前帧剩余的报告发完
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+    if (bundle_pending) {
+        if (usb_hid_ready() && !usb_hid_busy()) {
+            int ret = usb_hid_send_bundle();
+            if (ret == 0 || ret == -1) bundle_pending = false;
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+            // 多块 bundle 按最后一块的提交时刻计 (每块最多 12 个 tracker)
+            if (ret == 0) latency_submit(lat_pending);
+            else if (ret == -1) lat_pending = 0;
+#endif
+        }
+        return;
+    }
+#else
+    if (frame_report_sent < frame_report_count) {
+        if (usb_hid_ready() && !usb_hid_busy()) {
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+            latency_submit(frame_report_fresh(frame_reports[frame_report_sent]));
+#endif
+            usb_hid_write(frame_reports[frame_report_sent++], 64);
+        }
+        return;
+    }
+#endif
+    
+    // v0.4.25 / v0.5.0: 低频状态包和设备信息包排在姿态报告之后
+    if (status_due) {
+        status_due = false;
+        send_status_packets();
+        return;
+    }
+    if (info_due) {
+        info_due = false;
+        send_info_packets();
+        return;
+    }
+    
+    // 帧结束事件: 先解码最后一个时隙刚入队的包, 报告里才是该帧实际收到的样本
+    uint16_t done;
+    uint8_t frames = rf_receiver_frame_event(&done);
+    if (frames) rf_receiver_process(&rf_ctx);
+    
+#if defined(USE_USB_SLOT_REPORTS) && USE_USB_SLOT_REPORTS
+    // 逐时隙: 每次进来都取新样本, 帧事件只用于低频包计数 (超时由 rf_receiver 判定)
+    build_slot_reports();
+    if (frames == 0) return;
+    (void)done;
+#else
+    uint16_t target = (uint16_t)(done - USB_JITTER_FRAMES);
+    
+    if (!playout_started) {
+        playout_frame = target;
+        playout_started = true;
+        return;
+    }
+    
+    int16_t lag = (int16_t)(target - playout_frame);
+    if (lag <= 0) return;
+    playout_frame = (lag > PLAYOUT_MAX_LAG) ? target : (uint16_t)(playout_frame + 1);
+    
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+    build_bundle(playout_frame);
+    (void)status_packet_counter;        // 状态已随 bundle 旁路发送
+#else
+    build_frame_reports(playout_frame);
+#endif
+#endif  // USE_USB_SLOT_REPORTS
+#if !(defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS)
+    
+    // 按帧计数: 状态包约 5Hz, 设备信息包约 1Hz
+    if (++status_packet_counter >= 40) {
+        status_packet_counter = 0;
+        status_due = true;
+    }
+#endif
+    if (++info_packet_counter >= 200) {
+        info_packet_counter = 0;
+        info_due = true;
+    }
+}
+
+#else
+
 static void send_usb_report(void)
 {
-    static uint32_t last_report_time = 0;
+    static bool report_due = false;
     static uint32_t status_packet_counter = 0;  // v0.4.25: 状态包计数
     static uint32_t info_packet_counter = 0;    // v0.5.0: 设备信息包计数
     
-    // 5ms 周期 (200Hz)
-    if ((hal_get_tick_ms() - last_report_time) < 5) return;
-    last_report_time = hal_get_tick_ms();
+    // v0.6.3: 每个 RF 超帧结束组装一次 (200Hz), 不再用 1ms 节拍的 5ms 定时与帧相位拍频
+    if (rf_receiver_frame_event(NULL)) {
+        rf_receiver_process(&rf_ctx);
+        report_due = true;
+    }
+    if (!report_due) return;
     
     if (!usb_hid_ready()) return;
     if (usb_hid_busy()) return;
+    report_due = false;
     
     // 构建 USB HID 报告
     // 格式: 64 字节
@@ -238,7 +861,7 @@ static void send_usb_report(void)
     //          [8]   : Battery %
     //          [9]   : RSSI (offset 100)
     
-    memset(usb_tx_buffer, 0, 64);
+    static uint8_t last_count = 0;
     
     // v0.4.25: 检查是否应该发送状态包 (每40帧约5Hz)
     status_packet_counter++;
@@ -257,24 +880,12 @@ static void send_usb_report(void)
     uint8_t *ptr = &usb_tx_buffer[2];
     
     for (int i = 0; i < MAX_TRACKERS && count < 6; i++) {
-        receiver_tracker_t *tr = &trackers[i];
-        
-        if (!tr->paired) continue;
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
         
-        // 检查超时
-        uint32_t now = hal_get_tick_ms();
-        if ((now - tr->last_seen) > TRACKER_TIMEOUT_MS) {
-            tr->active = false;
-        }
-        
-        // v0.4.23: 更新丢包率统计 (滑动平均)
-        if (tr->total_packets > 0) {
-            uint32_t loss_pct = (tr->lost_packets * 100) / tr->total_packets;
-            tr->loss_rate_pct = (uint8_t)((tr->loss_rate_pct * 7 + loss_pct) / 8);
-        }
+        if (!tr->active) continue;
         
         ptr[0] = i;
-        ptr[1] = (tr->active ? 0x01 : 0x00) | (tr->status & 0xFE);
+        ptr[1] = (tr->connected ? 0x01 : 0x00) | (tr->flags & 0xFE);
         ptr[2] = (tr->quat[0] >> 1) & 0xFF;
         ptr[3] = (tr->quat[0] >> 9) & 0xFF;
         ptr[4] = (tr->quat[1] >> 1) & 0xFF;
@@ -282,7 +893,7 @@ static void send_usb_report(void)
         ptr[6] = (tr->quat[2] >> 1) & 0xFF;
         ptr[7] = (tr->quat[2] >> 9) & 0xFF;
         ptr[8] = tr->battery;
-        ptr[9] = (uint8_t)(tr->rssi + 100);
+        ptr[9] = (uint8_t)(TRACKER_RSSI_DBM(tr) + 100);
         
         ptr += 10;
         count++;
@@ -290,6 +901,10 @@ static void send_usb_report(void)
     
     usb_tx_buffer[1] = count;
     
+    // v0.6.3: 条目每次整体覆盖, 只清掉上次多出的条目 (不再整包 memset)
+    if (count < last_count) memset(ptr, 0, (last_count - count) * 10);
+    last_count = count;
+    
     usb_hid_write(usb_tx_buffer, 64);
     
     // v0.4.25: 发送packet3状态包 (低频)
@@ -302,6 +917,67 @@ static void send_usb_report(void)
         send_info_packets();
     }
 }
+#endif
+
+/**
+ * @brief v0.6.3: 生成 tracker 的 packet3 / packet0 报告模板
+ * 
+ * 设备信息字段 (版本/板型/传感器) 配对后不再变化, 只在这里编码一次
+ */
+static void build_report_templates(uint8_t id)
+{
+    if (id >= MAX_TRACKERS) return;
+    
+    status_reports[id][0] = 0x13;  // packet3 report ID
+    slime_packet_template(&status_reports[id][1], SLIME_PKT_TYPE_STATUS, id);
+    
+    slime_device_info_t info = {
+        .tracker_id = id,
+        .fw_version_major = 0,
+        .fw_version_minor = 5,  // v0.5.0
+        .board_id = 0x59,       // CH59X
+#ifdef CH591
+        .mcu_id = 0x91,
+#else
+        .mcu_id = 0x92,
+#endif
+        .imu_id = 0x45,         // 假设ICM-45686
+        .mag_id = 0,
+        .battery_pct = 0,       // 发送时改写
+        .battery_mv = 0,        // 需要从tracker获取
+        .imu_temp = 0
+    };
+    info_reports[id][0] = 0x10;    // packet0 report ID
+    slime_make_packet0(&info_reports[id][1], &info);
+    
+    report_template_mask |= 1u << id;
+}
+
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG
+// v0.6.3: 主机经 Feature 报告 (0x2A) 读取 packet3/packet0 时, 可停止在 EP1 IN 上推送 (0x2B)
+static bool status_on_feature_only = false;
+#endif
+
+/**
+ * @brief v0.6.3: 按 tracker 当前状态改写 packet3 报告 (report ID 0x13)
+ */
+static uint8_t *update_status_report(uint8_t id)
+{
+    const tracker_info_t *tr = &rf_ctx.trackers[id];
+    
+    if (!(report_template_mask & (1u << id))) build_report_templates(id);
+    
+    // 模板上只改写状态字段 (report ID 0x13标识packet3)
+    slime_tracker_data_t data = {
+        .tracker_id = id,
+        .battery_pct = tr->battery,
+        .flags = tr->flags,
+        .rssi = TRACKER_RSSI_DBM(tr)
+    };
+    uint8_t *report = status_reports[id];
+    slime_update_packet3(&report[1], &data);
+    return report;
+}
 
 /**
  * @brief v0.4.25: 发送packet3状态包给所有活跃tracker
@@ -309,81 +985,90 @@ static void send_usb_report(void)
 static void send_status_packets(void)
 {
     if (!usb_hid_ready() || usb_hid_busy()) return;
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG
+    if (status_on_feature_only) return;
+#endif
     
     for (int i = 0; i < MAX_TRACKERS; i++) {
-        receiver_tracker_t *tr = &trackers[i];
-        if (!tr->paired || !tr->active) continue;
-        
-        // 构建slime_tracker_data_t
-        slime_tracker_data_t data = {
-            .tracker_id = i,
-            .battery_pct = tr->battery,
-            .flags = tr->status,
-            .rssi = tr->rssi
-        };
-        
-        // 生成packet3
-        uint8_t pkt[SLIME_PACKET_SIZE];
-        slime_make_packet3(pkt, &data);
-        
-        // 发送 (使用report ID 0x13标识packet3)
-        uint8_t report[17];
-        report[0] = 0x13;  // packet3 report ID
-        memcpy(&report[1], pkt, SLIME_PACKET_SIZE);
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
+        if (!tr->active || !tr->connected) continue;
+        
+        uint8_t *report = update_status_report((uint8_t)i);
         
         // 等待HID可用
         uint32_t timeout = hal_get_tick_ms() + 10;
         while (usb_hid_busy() && hal_get_tick_ms() < timeout);
         
         if (!usb_hid_busy()) {
-            usb_hid_write(report, 17);
+            usb_hid_write(report, SLIME_REPORT_SIZE);
         }
     }
 }
 
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+// v0.6.3: tracker IMU 型号 (imu_interface.h IMU_*) → SlimeVR 服务器 IMU 编号
+static const uint8_t slime_imu_ids[] = {
+    0,      // IMU_UNKNOWN
+    6,      // IMU_MPU6050
+    8,      // IMU_BMI160
+    11,     // IMU_BMI270
+    10,     // IMU_ICM42688
+    16,     // IMU_ICM45686
+    13,     // IMU_LSM6DSV
+    15,     // IMU_LSM6DSR
+};
+#endif
+
 /**
- * @brief v0.5.0: 发送packet0设备信息包
+ * @brief v0.6.3: 按 tracker 当前状态改写 packet0 报告 (report ID 0x10)
  */
-static void send_info_packets(void)
+static uint8_t *update_info_report(uint8_t id)
 {
-    if (!usb_hid_ready() || usb_hid_busy()) return;
+    const tracker_info_t *tr = &rf_ctx.trackers[id];
     
-    for (int i = 0; i < MAX_TRACKERS; i++) {
-        receiver_tracker_t *tr = &trackers[i];
-        if (!tr->paired) continue;
-        
-        // 构建设备信息
-        slime_device_info_t info = {
-            .tracker_id = i,
-            .fw_version_major = 0,
-            .fw_version_minor = 5,  // v0.5.0
-            .board_id = 0x59,       // CH59X
-#ifdef CH591
-            .mcu_id = 0x91,
+    if (!(report_template_mask & (1u << id))) build_report_templates(id);
+    
+    // 模板上只改写电量
+    uint8_t *report = info_reports[id];
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+    // v0.6.3: 状态旁路拼回的字段覆盖模板中的占位值
+    slime_update_packet0_power(&report[1], tr->battery, tr->battery_mv,
+                               (int8_t)(tr->temp_cc / 100));
+    if (tr->sideband_valid & (1u << RF_SB_FIELD_FW_VERSION)) {
+        report[1 + 2] = (uint8_t)(tr->fw_version >> 8);
+        report[1 + 3] = (uint8_t)tr->fw_version;
+    }
+    if ((tr->sideband_valid & (1u << RF_SB_FIELD_IMU_TYPE)) &&
+        tr->imu_type < sizeof(slime_imu_ids)) {
+        report[1 + 6] = slime_imu_ids[tr->imu_type];
+    }
 #else
-            .mcu_id = 0x92,
+    slime_update_packet0_power(&report[1], tr->battery, 0, 0);
 #endif
-            .imu_id = 0x45,         // 假设ICM-45686
-            .mag_id = 0,
-            .battery_pct = tr->battery,
-            .battery_mv = 0,        // 需要从tracker获取
-            .imu_temp = 0
-        };
-        
-        // 生成packet0
-        uint8_t pkt[SLIME_PACKET_SIZE];
-        slime_make_packet0(pkt, &info);
+    return report;
+}
+
+/**
+ * @brief v0.5.0: 发送packet0设备信息包
+ */
+static void send_info_packets(void)
+{
+    if (!usb_hid_ready() || usb_hid_busy()) return;
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG
+    if (status_on_feature_only) return;
+#endif
+    
+    for (int i = 0; i < MAX_TRACKERS; i++) {
+        const tracker_info_t *tr = &rf_ctx.trackers[i];
+        if (!tr->active) continue;
         
-        // 发送
-        uint8_t report[17];
-        report[0] = 0x10;  // packet0 report ID
-        memcpy(&report[1], pkt, SLIME_PACKET_SIZE);
+        uint8_t *report = update_info_report((uint8_t)i);
         
         uint32_t timeout = hal_get_tick_ms() + 10;
         while (usb_hid_busy() && hal_get_tick_ms() < timeout);
         
         if (!usb_hid_busy()) {
-            usb_hid_write(report, 17);
+            usb_hid_write(report, SLIME_REPORT_SIZE);
         }
     }
 }
@@ -402,9 +1087,9 @@ static void save_config(void)
     
     cfg.tracker_count = 0;
     for (int i = 0; i < MAX_TRACKERS && cfg.tracker_count < MAX_TRACKERS; i++) {
-        if (trackers[i].paired) {
+        if (rf_ctx.trackers[i].active) {
             memcpy(cfg.paired_trackers[cfg.tracker_count].mac, 
-                   trackers[i].mac, 6);
+                   rf_ctx.trackers[i].mac_address, 6);
             cfg.paired_trackers[cfg.tracker_count].id = i;
             cfg.tracker_count++;
         }
@@ -421,13 +1106,8 @@ static void save_config(void)
     
     // v0.6.2: 按照优化手册建议，添加错误返回值检查
 #ifdef CH59X
-    int ret = hal_storage_erase(STORAGE_CONFIG_OFFSET, 256);
-    if (ret != 0) {
-        LOG_ERR("Config erase failed: %d", ret);
-        return;
-    }
-    
-    ret = hal_storage_write(STORAGE_CONFIG_OFFSET, &cfg, sizeof(cfg));
+    // v0.6.3: 不再擦除 0x0000 所在页 (会清掉存储区 magic, 下次上电整区格式化)
+    int ret = hal_kv_set(HAL_KV_RX_CONFIG, &cfg, sizeof(cfg));
     if (ret != 0) {
         LOG_ERR("Config write failed: %d", ret);
         return;
@@ -443,7 +1123,12 @@ static bool load_config(void)
     
 #ifdef CH59X
     // v0.6.2: 按照优化手册建议，添加错误返回值检查
-    int ret = hal_storage_read(STORAGE_CONFIG_OFFSET, &cfg, sizeof(cfg));
+    int ret = hal_kv_get(HAL_KV_RX_CONFIG, &cfg, sizeof(cfg));
+    if (ret == HAL_KV_ERR_NOT_FOUND) {
+        ret = hal_storage_read(STORAGE_CONFIG_OFFSET, &cfg, sizeof(cfg));
+    } else if (ret == (int)sizeof(cfg)) {
+        ret = 0;
+    }
     if (ret != 0) {
         LOG_ERR("Config read failed: %d", ret);
         return false;
@@ -479,8 +1164,8 @@ static bool load_config(void)
     for (int i = 0; i < cfg.tracker_count; i++) {
         uint8_t id = cfg.paired_trackers[i].id;
         if (id < MAX_TRACKERS) {
-            memcpy(trackers[id].mac, cfg.paired_trackers[i].mac, 6);
-            trackers[id].paired = true;
+            rf_receiver_restore_pairing(&rf_ctx, id, cfg.paired_trackers[i].mac);
+            build_report_templates(id);
             tracker_mask |= (1 << id);
             active_tracker_count++;
         }
@@ -511,12 +1196,18 @@ static void process_button(void)
         
         if (duration > 3000) {
             // 长按: 清除所有配对
-            memset(trackers, 0, sizeof(trackers));
+            rf_receiver_unpair_all(&rf_ctx);
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+            rx_predict_init();
+#endif
             tracker_mask = 0;
             active_tracker_count = 0;
             save_config();
             
-            // LED 闪烁确认
+            // LED 闪烁确认 (阻塞期间暂停节拍图案, 之后由 update_led 恢复)
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_OFF);
+#endif
             for (int i = 0; i < 5; i++) {
                 hal_gpio_write(PIN_LED, true);
                 hal_delay_ms(100);
@@ -537,16 +1228,82 @@ static void process_button(void)
     last_state = pressed;
 }
 
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+/*============================================================================
+ * v0.6.3: 组休眠 - 主机不再读取数据 (USB 挂起) 时让所有 tracker 休眠
+ *============================================================================*/
+
+static void group_sleep_update(void)
+{
+    static uint32_t suspend_since = 0;      // 0 = 未挂起
+    
+    // 配对等其他状态需要正常信标
+    if (!usb_hid_suspended() || state != STATE_RUNNING) {
+        suspend_since = 0;
+        rf_receiver_set_group_sleep(&rf_ctx, false);
+        return;
+    }
+    
+    uint32_t now = hal_get_tick_ms();
+    if (suspend_since == 0) {
+        suspend_since = now | 1;
+    } else if (now - suspend_since >= GROUP_SLEEP_DELAY_MS) {
+        rf_receiver_set_group_sleep(&rf_ctx, true);
+    }
+}
+#endif
+
 /*============================================================================
  * LED 更新
  *============================================================================*/
 
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+// v0.6.3: 只按状态选图案, 闪烁与调光由 TMR0 节拍完成 (hal_led.c)
+static void update_led(void)
+{
+    led_pattern_t pattern;
+    
+    switch (state) {
+        case STATE_RUNNING:
+            // 有活跃追踪器时常亮，否则慢闪
+            pattern = (active_tracker_count > 0) ? LED_PATTERN_ON : LED_PATTERN_BLINK_SLOW;
+#if defined(USE_RX_FAST_BOOT) && USE_RX_FAST_BOOT
+            // 上电指示 (原先阻塞的 3 次闪烁)
+            if (hal_get_tick_ms() < RX_BOOT_BLINK_MS) pattern = LED_PATTERN_BLINK_FAST;
+#endif
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+            // USB 挂起时总线供电受限
+            if (rf_receiver_group_sleeping()) pattern = LED_PATTERN_OFF;
+#endif
+            break;
+        case STATE_PAIRING:     pattern = LED_PATTERN_BLINK_FAST;  break;
+        case STATE_BOOTLOADER:  pattern = LED_PATTERN_BLINK_RAPID; break;
+        case STATE_ERROR:       pattern = LED_PATTERN_BLINK_FAST;  break;
+        default:                pattern = LED_PATTERN_OFF;         break;
+    }
+    
+    if (pattern != hal_led_get_pattern()) {
+        hal_led_set_pattern(pattern);
+    }
+}
+#else
 static void update_led(void)
 {
     uint32_t now = hal_get_tick_ms();
     
     switch (state) {
         case STATE_RUNNING:
+#if defined(USE_RX_FAST_BOOT) && USE_RX_FAST_BOOT
+            // v0.6.3: 上电指示 (原先阻塞的 3 次闪烁)
+            if (now < RX_BOOT_BLINK_MS) {
+                if ((now - led_toggle_time) > LED_BLINK_FAST_MS) {
+                    led_toggle_time = now;
+                    led_state = !led_state;
+                    hal_gpio_write(PIN_LED, led_state);
+                }
+                break;
+            }
+#endif
             // 有活跃追踪器时常亮，否则慢闪
             if (active_tracker_count > 0) {
                 hal_gpio_write(PIN_LED, true);
@@ -589,6 +1346,387 @@ static void update_led(void)
             break;
     }
 }
+#endif
+
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+/*============================================================================
+ * v0.6.3: 分集转发报告
+ * 
+ * 主/副接收器把每个解码出的包原样转发 (不经抖动缓冲), 主机按
+ * (ID, 序列号) 去重并保留 RSSI 最好的副本, 两个接收器互补遮挡盲区
+ * 
+ * Report 0x04 (64 字节):
+ * [0]      0x04
+ * [1]      条目数
+ * [2..]    每条目 13 字节:
+ *          [0]    tracker ID (bit7 = 无序列号, 主机改按帧号去重)
+ *          [1]    序列号
+ *          [2]    RSSI + 128
+ *          [3-4]  RF 帧号 (LE)
+ *          [5-12] 四元数 w,x,y,z int16 Q15 (LE)
+ *============================================================================*/
+
+#define FWD_REPORT_ID           0x04
+#define FWD_REPORT_HDR_SIZE     2
+#define FWD_ENTRY_SIZE          13
+#define FWD_REPORT_ENTRIES      ((64 - FWD_REPORT_HDR_SIZE) / FWD_ENTRY_SIZE)
+#define FWD_QUEUE_DEPTH         4       // 报告队列 (2的幂)
+#define FWD_NO_SEQ_FLAG         0x80
+
+static uint8_t fwd_reports[FWD_QUEUE_DEPTH][64];
+static uint8_t fwd_head = 0;            // 正在填充的报告
+static uint8_t fwd_tail = 0;            // 下一个待发送的报告
+static uint32_t fwd_dropped = 0;        // 队列满丢弃的条目
+
+static void forward_report_reset(uint8_t *rep)
+{
+    rep[0] = FWD_REPORT_ID;
+    rep[1] = 0;
+}
+
+static void forward_callback(const rf_forward_info_t *info)
+{
+    uint8_t *rep = fwd_reports[fwd_head & (FWD_QUEUE_DEPTH - 1)];
+    
+    if (rep[1] >= FWD_REPORT_ENTRIES) {
+        if ((uint8_t)(fwd_head - fwd_tail) >= FWD_QUEUE_DEPTH - 1) {
+            fwd_dropped++;
+            return;
+        }
+        fwd_head++;
+        rep = fwd_reports[fwd_head & (FWD_QUEUE_DEPTH - 1)];
+        forward_report_reset(rep);
+    }
+    
+    uint8_t *e = &rep[FWD_REPORT_HDR_SIZE + rep[1] * FWD_ENTRY_SIZE];
+    e[0] = info->tracker_id | (info->has_sequence ? 0 : FWD_NO_SEQ_FLAG);
+    e[1] = info->sequence;
+    e[2] = (uint8_t)(info->rssi + 128);
+    e[3] = (uint8_t)info->frame;
+    e[4] = (uint8_t)(info->frame >> 8);
+    for (int c = 0; c < 4; c++) {
+        e[5 + c * 2] = info->quat[c] & 0xFF;
+        e[6 + c * 2] = (info->quat[c] >> 8) & 0xFF;
+    }
+    rep[1]++;
+}
+
+/**
+ * @brief 发送一个转发报告: 先发已满的, 否则发正在填充的 (不等凑满, 降低延迟)
+ */
+static void send_forward_reports(void)
+{
+    if (!usb_hid_ready() || usb_hid_busy()) return;
+    
+    uint8_t *rep = fwd_reports[fwd_tail & (FWD_QUEUE_DEPTH - 1)];
+    if (fwd_tail != fwd_head) {
+        usb_hid_write(rep, 64);
+        fwd_tail++;
+    } else if (rep[1] > 0) {
+        usb_hid_write(rep, 64);
+        forward_report_reset(rep);
+    }
+}
+
+static void forward_enable(bool enable)
+{
+    for (int i = 0; i < FWD_QUEUE_DEPTH; i++) {
+        forward_report_reset(fwd_reports[i]);
+    }
+    fwd_head = 0;
+    fwd_tail = 0;
+    rf_receiver_set_forward_callback(enable ? forward_callback : NULL);
+}
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/*============================================================================
+ * v0.6.3: 辅助 IMU 姿态报告
+ * 
+ * 双姿态包中的第二个姿态不进抖动缓冲, 收到后在端点空闲时上报
+ * 
+ * Report 0x05 (64 字节), 只带上次报告后有新值的 tracker:
+ * [0]      0x05
+ * [1]      条目数
+ * [2..]    每条目 9 字节: tracker ID, 四元数 w,x,y,z int16 Q15 (LE)
+ *============================================================================*/
+
+#define AUX_REPORT_ID           0x05
+#define AUX_REPORT_HDR_SIZE     2
+#define AUX_ENTRY_SIZE          9
+#define AUX_REPORT_ENTRIES      ((64 - AUX_REPORT_HDR_SIZE) / AUX_ENTRY_SIZE)
+
+static uint8_t aux_scan_start = 0;      // 一个报告装不下时从上次停下的 ID 继续
+
+static void send_aux_reports(void)
+{
+    if (!usb_hid_ready() || usb_hid_busy()) return;
+    
+    uint8_t rep[64] = {AUX_REPORT_ID, 0};
+    for (uint8_t k = 0; k < MAX_TRACKERS && rep[1] < AUX_REPORT_ENTRIES; k++) {
+        uint8_t id = (uint8_t)((aux_scan_start + k) % MAX_TRACKERS);
+        int16_t q[4];
+        if (!rf_receiver_take_aux_quat(id, q)) continue;
+        
+        uint8_t *e = &rep[AUX_REPORT_HDR_SIZE + rep[1] * AUX_ENTRY_SIZE];
+        e[0] = id;
+        for (int c = 0; c < 4; c++) {
+            e[1 + c * 2] = q[c] & 0xFF;
+            e[2 + c * 2] = (q[c] >> 8) & 0xFF;
+        }
+        rep[1]++;
+        aux_scan_start = (uint8_t)((id + 1) % MAX_TRACKERS);
+    }
+    
+    if (rep[1] > 0) {
+        usb_hid_write(rep, 64);
+    }
+}
+#endif
+
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG
+/*============================================================================
+ * v0.6.3: 诊断读出 (Feature 报告通道)
+ *
+ * 命令经 SET_REPORT(Feature) 下发时应答由 GET_REPORT(Feature) 读回 (usb_hid_reply),
+ * 轮询诊断不再与数据报告争用 EP1 IN; 经 EP1 OUT 下发时仍在 IN 上应答
+ *
+ * 0x2C 诊断报告分页 [1]=页号, 第 0 页重新生成快照, 后续页读同一快照:
+ * [0]      0x2C
+ * [1]      页号
+ * [2]      总页数
+ * [3-4]    报告总字节数 (LE)
+ * [5..]    本页数据, 每页 DIAG_PAGE_BYTES 字节
+ *============================================================================*/
+
+#define DIAG_PAGE_HDR_SIZE      5
+#define DIAG_PAGE_BYTES         (64 - DIAG_PAGE_HDR_SIZE)
+
+static uint8_t diag_snapshot[DIAG_REPORT_MAX_LEN] RAM_ARENA(receiver);
+static uint16_t diag_snapshot_len = 0;
+
+static void diag_page_reply(uint8_t page)
+{
+    if (page == 0) {
+        diag_snapshot_len = diag_generate_report(diag_snapshot, sizeof(diag_snapshot));
+    }
+    
+    uint8_t resp[64] = {0};
+    uint8_t pages = (uint8_t)((diag_snapshot_len + DIAG_PAGE_BYTES - 1) / DIAG_PAGE_BYTES);
+    uint16_t off = (uint16_t)page * DIAG_PAGE_BYTES;
+    resp[0] = 0x2C;
+    resp[1] = page;
+    resp[2] = pages;
+    resp[3] = (uint8_t)diag_snapshot_len;
+    resp[4] = (uint8_t)(diag_snapshot_len >> 8);
+    if (off < diag_snapshot_len) {
+        uint16_t n = diag_snapshot_len - off;
+        if (n > DIAG_PAGE_BYTES) n = DIAG_PAGE_BYTES;
+        memcpy(&resp[DIAG_PAGE_HDR_SIZE], &diag_snapshot[off], n);
+    }
+    usb_hid_reply(resp, sizeof(resp));
+}
+
+/**
+ * @brief 0x2A 读取 packet3/packet0 报告 [1]=ID [2]=0 packet3 / 1 packet0
+ *        响应 [1]=ID (0xFF = 未配对) [2]=类型 [3..] 与 EP1 IN 上推送的报告相同
+ */
+static void status_report_reply(uint8_t id, uint8_t kind)
+{
+    uint8_t resp[3 + SLIME_REPORT_SIZE] = {0};
+    resp[0] = 0x2A;
+    resp[1] = 0xFF;
+    resp[2] = kind;
+    if (id < MAX_TRACKERS && rf_ctx.trackers[id].active) {
+        const uint8_t *report = kind ? update_info_report(id) : update_status_report(id);
+        resp[1] = id;
+        memcpy(&resp[3], report, SLIME_REPORT_SIZE);
+    }
+    usb_hid_reply(resp, sizeof(resp));
+}
+#endif
+
+/*============================================================================
+ * Tracker 命令下发 (v0.6.3)
+ *============================================================================*/
+
+#define CMD_BATCH_MAX       16      // 单个 USB 报告最多携带的命令数
+#define CMD_TRACKER_ALL     0xFF
+#define CMD_SEQ_BATCH_MAX   15      // 0x19: 带序号的命令 (4 字节/条, 一个 64 字节报告)
+#define CMD_RESULT_BAD_ID   0x81    // 0x19 应答结果码 (0x00..0x7F = 进入的队列数)
+#define CMD_RESULT_NO_LINK  0x82
+#define CMD_RESULT_FULL     0x83
+
+static int tracker_cmd_sink(uint8_t tracker_id, uint8_t cmd, uint8_t param, bool first)
+{
+    if (first) {
+        return rf_receiver_send_command_first(&rf_ctx, tracker_id, (rf_command_t)cmd, param);
+    }
+    return rf_receiver_send_command(&rf_ctx, tracker_id, (rf_command_t)cmd, param);
+}
+
+/**
+ * @brief 批量命令 [ID, 命令, 参数] × n, ID = CMD_TRACKER_ALL 时展开到全部已连接 tracker
+ */
+static void tracker_cmd_batch(const uint8_t *data, uint8_t n)
+{
+    batch_item_t items[CMD_BATCH_MAX];
+    uint8_t count = 0;
+    
+    for (uint8_t i = 0; i < n; i++, data += 3) {
+        if (data[0] == CMD_TRACKER_ALL) {
+            rf_receiver_broadcast_command(&rf_ctx, (rf_command_t)data[1], data[2]);
+            continue;
+        }
+        if (count >= CMD_BATCH_MAX) break;
+        items[count].tracker_id = data[0];
+        items[count].data = (uint8_t *)&data[1];
+        items[count].len = 2;
+        count++;
+    }
+    
+    if (count > 0) {
+        slot_optimizer_batch_transmit(items, count);
+    }
+}
+
+/**
+ * @brief 带序号的批量命令 [序号, ID, 命令, 参数] × n, 一个报告应答全部结果
+ * @note 应答 [0]=0x19 [1]=n [2..] 每条 [序号, 结果]; 结果 0x00..0x7F = 进入的 tracker 队列数
+ *       (单个 ID 为 1, CMD_TRACKER_ALL 为已连接数), CMD_RESULT_* = 失败原因.
+ *       按报告内顺序入各 tracker 命令队列, 同一 tracker 的命令不会颠倒
+ */
+static void tracker_cmd_seq_batch(const uint8_t *data, uint8_t n)
+{
+    uint8_t resp[2 + CMD_SEQ_BATCH_MAX * 2] = {0};
+    if (n > CMD_SEQ_BATCH_MAX) n = CMD_SEQ_BATCH_MAX;
+    resp[0] = 0x19;
+    resp[1] = n;
+    
+    for (uint8_t i = 0; i < n; i++, data += 4) {
+        uint8_t result;
+        if (data[1] == CMD_TRACKER_ALL) {
+            result = (uint8_t)rf_receiver_broadcast_command(&rf_ctx, (rf_command_t)data[2], data[3]);
+        } else {
+            int ret = tracker_cmd_sink(data[1], data[2], data[3], false);
+            result = (ret == 0) ? 1 : (ret == -1) ? CMD_RESULT_BAD_ID :
+                     (ret == -2) ? CMD_RESULT_NO_LINK : CMD_RESULT_FULL;
+        }
+        resp[2 + i * 2] = data[0];
+        resp[3 + i * 2] = result;
+    }
+    usb_hid_reply(resp, sizeof(resp));
+}
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+/*============================================================================
+ * RF 固件广播 (v0.6.3)
+ * 暂存镜像要擦写 Flash, 命令从 USB 回调拷贝出来在主循环执行, 一次一条
+ *============================================================================*/
+
+#define OTA_STATUS_ENTRIES      18      // 0x43 每个报告携带的 tracker 数
+
+static uint8_t ota_cmd_buf[64];
+static volatile uint8_t ota_cmd_len = 0;
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void ota_host_command(const uint8_t *data, uint8_t len)
+{
+    if (ota_cmd_len != 0) return;       // 上一条未处理完, 主机等应答后再发
+    if (len > sizeof(ota_cmd_buf)) len = sizeof(ota_cmd_buf);
+    memcpy(ota_cmd_buf, data, len);
+    ota_cmd_len = len;
+}
+
+static void ota_host_status(uint8_t first, uint8_t *resp)
+{
+    uint16_t cursor, chunks;
+    resp[1] = (uint8_t)ota_get_state();
+    resp[2] = rf_ota_broadcast_status(&cursor, &chunks);
+    resp[3] = (uint8_t)cursor;
+    resp[4] = (uint8_t)(cursor >> 8);
+    resp[5] = (uint8_t)chunks;
+    resp[6] = (uint8_t)(chunks >> 8);
+    resp[7] = first;
+    
+    uint8_t n = 0;
+    for (uint8_t id = first; id < RF_MAX_TRACKERS && n < OTA_STATUS_ENTRIES; id++, n++) {
+        rf_ota_progress_t p;
+        rf_ota_get_progress(id, &p);
+        uint8_t *e = &resp[9 + n * 3];
+        // bit7 = 本会话有状态包, bit6 = 在线, 低位 = RF_OTA_FLAG_*
+        e[0] = (p.seen ? 0x80 : 0) | (rf_ctx.trackers[id].connected ? 0x40 : 0) | (p.flags & 0x3F);
+        e[1] = (uint8_t)p.base;
+        e[2] = (uint8_t)(p.base >> 8);
+    }
+    resp[8] = n;
+}
+
+/**
+ * @brief 主循环执行暂存的 OTA 命令并应答 (应答首字节 = 命令号)
+ */
+static void ota_host_task(void)
+{
+    uint8_t len = ota_cmd_len;
+    if (len == 0) return;
+    
+    const uint8_t *data = ota_cmd_buf;
+    uint8_t resp[64] = {0};
+    resp[0] = data[0];
+    int result = -1;
+    
+    switch (data[0]) {
+        case 0x40:  // 暂存开始 [1-4]=大小 [5-8]=CRC32 (LE)
+            if (len >= 9) {
+                if (rf_ota_broadcast_active()) rf_ota_broadcast_stop(&rf_ctx);
+                ota_abort();
+                result = ota_start(get_le32(&data[1]), get_le32(&data[5]));
+            }
+            break;
+            
+        case 0x41:  // 暂存数据 [1-4]=偏移 [5]=长度 [6..]=数据
+            if (len >= 6 && data[5] <= len - 6) {
+                result = ota_write_chunk(get_le32(&data[1]), &data[6], data[5]);
+                memcpy(&resp[2], &data[1], 4);
+            }
+            break;
+            
+        case 0x42:  // 广播 [1]=1 开始 (先校验暂存镜像) / 0 停止; 应答 [2]=会话号
+            if (len >= 2 && data[1] == 0) {
+                rf_ota_broadcast_stop(&rf_ctx);
+                result = 0;
+            } else if (len >= 2) {
+                if (ota_get_state() == OTA_VERIFYING) ota_verify();
+                result = rf_ota_broadcast_start();
+                if (result > 0) {
+                    resp[2] = (uint8_t)result;
+                    result = 0;
+                }
+            }
+            break;
+            
+        case 0x43:  // 状态 [1]=起始 tracker ID
+            ota_host_status((len >= 2) ? data[1] : 0, resp);
+            usb_hid_reply(resp, sizeof(resp));
+            ota_cmd_len = 0;
+            return;
+            
+        case 0x44:  // 全部 tracker 写入应用区并重启 [1]=会话号
+            if (len >= 2) {
+                result = rf_receiver_broadcast_command(&rf_ctx, RF_CMD_OTA_APPLY, data[1]);
+            }
+            break;
+    }
+    
+    resp[1] = (uint8_t)result;
+    usb_hid_reply(resp, sizeof(resp));
+    ota_cmd_len = 0;
+}
+#endif
 
 /*============================================================================
  * USB 接收回调
@@ -613,6 +1751,254 @@ static void usb_rx_callback(const uint8_t *data, uint8_t len)
             enter_state(STATE_RUNNING);
             break;
             
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+        case 0x13:  // v0.6.3: 设置tracker速率 [1]=ID [2]=分频 (1/2/4 = 200/100/50Hz)
+            if (len >= 3) {
+                rf_receiver_set_tracker_rate(&rf_ctx, data[1], data[2]);
+            }
+            break;
+#endif
+            
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+        case 0x14:  // v0.6.3: 姿态外推 [1]=使能 [2-3]=预测时长 us (LE, 报告时刻之后)
+            if (len >= 2) {
+                rx_predict_enable(data[1] != 0);
+            }
+            if (len >= 4) {
+                rx_predict_set_horizon_us((uint16_t)(data[2] | (data[3] << 8)));
+            }
+            break;
+#endif
+            
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+        case 0x15:  // v0.6.3: 分集转发报告 [1]=使能
+            if (len >= 2) {
+                forward_enable(data[1] != 0);
+            }
+            break;
+            
+        case 0x16:  // v0.6.3: 接收器角色 [1]=0 主/1 副, [2-5]=网络密钥 (LE, 副接收器必填)
+            if (len >= 2 && data[1] == 0) {
+                rf_receiver_start(&rf_ctx);
+            } else if (len >= 6) {
+                rf_ctx.network_key = (uint32_t)data[2] | ((uint32_t)data[3] << 8) |
+                                     ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 24);
+                rf_receiver_start_listener(&rf_ctx);
+            }
+            break;
+            
+        case 0x21:  // v0.6.3: 读取网络密钥和角色 (配置副接收器用)
+            {
+                uint8_t resp[16] = {0};
+                resp[0] = 0x21;
+                resp[1] = (uint8_t)rf_ctx.network_key;
+                resp[2] = (uint8_t)(rf_ctx.network_key >> 8);
+                resp[3] = (uint8_t)(rf_ctx.network_key >> 16);
+                resp[4] = (uint8_t)(rf_ctx.network_key >> 24);
+                resp[5] = (rf_ctx.state == RX_STATE_LISTEN) ? 1 : 0;
+                resp[6] = rf_receiver_listener_locked() ? 1 : 0;
+                usb_hid_reply(resp, 16);
+            }
+            break;
+#endif
+            
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+        case 0x26:  // v0.6.3: 漫游小区 [1]=小区号 [2-5]=组网络密钥 (LE), 保存后重启主接收器
+            if (len >= 6 && rf_receiver_set_roam_cell(&rf_ctx, data[1]) == 0) {
+                uint8_t cell = data[1];
+                rf_ctx.network_key = (uint32_t)data[2] | ((uint32_t)data[3] << 8) |
+                                     ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 24);
+                hal_storage_save_network_key(rf_ctx.network_key);
+                hal_kv_set(HAL_KV_ROAM_CELL, &cell, 1);
+                rf_receiver_start(&rf_ctx);
+            }
+            break;
+            
+        case 0x27:  // v0.6.3: 读取配对表项 [1]=序号; 响应 [1]=ID (0xFF = 结束) [2-7]=MAC [8]=配对数
+            if (len >= 2) {
+                uint8_t resp[16] = {0};
+                uint8_t n = 0;
+                resp[0] = 0x27;
+                resp[1] = 0xFF;
+                for (uint8_t i = 0; i < MAX_TRACKERS; i++) {
+                    if (!rf_ctx.trackers[i].active) continue;
+                    if (n++ == data[1]) {
+                        resp[1] = i;
+                        memcpy(&resp[2], rf_ctx.trackers[i].mac_address, 6);
+                        break;
+                    }
+                }
+                resp[8] = active_tracker_count;
+                usb_hid_reply(resp, 16);
+            }
+            break;
+            
+        case 0x28:  // v0.6.3: 写入配对表项 [1]=ID [2-7]=MAC (从同组另一接收器复制)
+            if (len >= 8 && data[1] < MAX_TRACKERS) {
+                uint8_t id = data[1];
+                bool was_paired = rf_ctx.trackers[id].active;
+                if (rf_receiver_restore_pairing(&rf_ctx, id, &data[2]) == 0) {
+                    build_report_templates(id);
+                    tracker_mask |= (1 << id);
+                    if (!was_paired) active_tracker_count++;
+                    save_config();
+                }
+            }
+            break;
+#endif
+            
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+        case 0x29:  // v0.6.3: 自适应平滑 [1]=ID (0xFF 全部) [2]=使能 [3-4]=最低截止 [5-6]=beta [7-8]=角速度截止
+                    // (LE, 0.01 Hz); 只带 [1] 时查询, 响应 [1]=ID [2-8] 同上
+            if (len >= 9) {
+                rx_smooth_params_t p;
+                p.enabled = (data[2] != 0);
+                p.min_cutoff_cHz = (uint16_t)(data[3] | (data[4] << 8));
+                p.beta_cHz = (uint16_t)(data[5] | (data[6] << 8));
+                p.d_cutoff_cHz = (uint16_t)(data[7] | (data[8] << 8));
+                rx_smooth_set(data[1], &p);
+            } else if (len >= 2) {
+                rx_smooth_params_t p;
+                uint8_t resp[16] = {0};
+                resp[0] = 0x29;
+                resp[1] = data[1];
+                if (rx_smooth_get(data[1], &p)) {
+                    resp[2] = p.enabled ? 1 : 0;
+                    resp[3] = p.min_cutoff_cHz & 0xFF;
+                    resp[4] = p.min_cutoff_cHz >> 8;
+                    resp[5] = p.beta_cHz & 0xFF;
+                    resp[6] = p.beta_cHz >> 8;
+                    resp[7] = p.d_cutoff_cHz & 0xFF;
+                    resp[8] = p.d_cutoff_cHz >> 8;
+                } else {
+                    resp[1] = 0xFF;
+                }
+                usb_hid_reply(resp, 16);
+            }
+            break;
+#endif
+            
+        case 0x17:  // v0.6.3: tracker 命令 [1]=ID (0xFF 全部) [2]=命令 [3]=参数, 随 ACK 下发
+        case 0x18:  // v0.6.3: 批量 tracker 命令, [1..] 每条 3 字节 同 0x17, 一个超帧内送达
+            if (len >= 4) {
+                tracker_cmd_batch(&data[1], (uint8_t)((len - 1) / 3));
+            }
+            break;
+            
+        case 0x19:  // v0.6.3: 带序号批量命令 [1..] 每条 [序号, ID, 命令, 参数], 单个报告应答
+            if (len >= 5) {
+                tracker_cmd_seq_batch(&data[1], (uint8_t)((len - 1) / 4));
+            }
+            break;
+            
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+        case 0x30:  // v0.6.3: usb_debug 数据流开始 [1]=stream_mask (bit4 = 时序追踪)
+        case 0x31:  // v0.6.3: usb_debug 数据流停止
+            usb_debug_command(data, len);
+            break;
+#endif
+            
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+        case 0x1C:  // v0.6.3: 窗口统计读出 [1-2]=起始序号, 同 usb_debug DBG_CMD_GET_SOAK
+            usb_debug_command(data, len);
+            break;
+#endif
+            
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        case 0x25:  // v0.6.3: 链路密钥 [1-16] (全 0 = 清除), 同 usb_debug DBG_CMD_SET_LINK_KEY
+            usb_debug_command(data, len);
+            break;
+#endif
+            
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG
+        case 0x2A:  // v0.6.3: 读取 packet3/packet0 [1]=ID [2]=0 状态 / 1 设备信息
+            if (len >= 2) {
+                status_report_reply(data[1], (len >= 3 && data[2]) ? 1 : 0);
+            }
+            break;
+            
+        case 0x2B:  // v0.6.3: [1]=1 停止在 EP1 IN 上推送 packet3/packet0 (改由 0x2A 读取), 0 恢复
+            if (len >= 2) {
+                status_on_feature_only = (data[1] != 0);
+            }
+            break;
+            
+        case 0x2C:  // v0.6.3: 诊断报告分页 [1]=页号 (0 = 重新生成)
+            diag_page_reply((len >= 2) ? data[1] : 0);
+            break;
+            
+        case 0x2D:  // v0.6.3: 事件环读出, [1-2] 同 usb_debug DBG_CMD_GET_EVENTS (响应 ID 0x97)
+            {
+                uint8_t req[3] = {0x17, 0, 0};
+                uint8_t n = (len > 3) ? 3 : len;
+                if (n > 1) memcpy(&req[1], &data[1], n - 1);
+                usb_debug_command(req, n);
+            }
+            break;
+#endif
+            
+        case 0x22:  // v0.6.3: 链路统计 [1]=ID; [29-31] 延迟 p50/p90/p99 (100us, USE_LATENCY_PROBE)
+            if (len >= 2) {
+                uint8_t resp[32] = {0};
+                resp[0] = 0x22;
+                if (!fill_link_stats(data[1], &resp[1])) break;
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+                diag_latency_t lat;
+                diag_get_latency(data[1], &lat);
+                resp[28] = lat.count;       // 链路统计保留字节
+                resp[29] = lat.p50;
+                resp[30] = lat.p90;
+                resp[31] = lat.p99;
+#endif
+                usb_hid_reply(resp, sizeof(resp));
+            }
+            break;
+            
+#if defined(USE_LATENCY_PROBE) && USE_LATENCY_PROBE
+        case 0x24:  // v0.6.3: 清空延迟窗口, 开始新一轮测量
+            diag_reset_latency();
+            break;
+#endif
+
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+        case 0x23:  // v0.6.3: 时间基准 [2-3]=帧号 [4-7]=帧起点 us [8-11]=当前 us [12-13]=超帧长度 us (LE)
+            {
+                // 主机以请求/应答的往返中点对应 [8-11], 拟合接收器时钟到主机时钟的映射
+                rf_time_base_t tb;
+                rf_receiver_get_time_base(&tb);
+                uint8_t resp[16] = {0};
+                resp[0] = 0x23;
+                resp[1] = (rf_ctx.state == RX_STATE_RUNNING || rf_ctx.state == RX_STATE_LISTEN) ? 1 : 0;
+                resp[2] = (uint8_t)tb.frame;
+                resp[3] = (uint8_t)(tb.frame >> 8);
+                memcpy(&resp[4], &tb.frame_start_us, 4);
+                memcpy(&resp[8], &tb.now_us, 4);
+                uint16_t frame_us = RF_FRAME_US;    // v0.6.3: 可变超帧速率时为当前周期
+                resp[12] = (uint8_t)frame_us;
+                resp[13] = (uint8_t)(frame_us >> 8);
+                usb_hid_reply(resp, 16);
+            }
+            break;
+#endif
+            
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+        case 0x32:  // v0.6.3: 批量数据流内容 [1]=BULK_STREAM_* 位图 (0 = 关闭)
+            if (len >= 2) {
+                bulk_stream_set(data[1]);
+            }
+            break;
+#endif
+            
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        case 0x40:  // v0.6.3: RF 固件广播, 主循环执行 (见 ota_host_task)
+        case 0x41:
+        case 0x42:
+        case 0x43:
+        case 0x44:
+            ota_host_command(data, len);
+            break;
+#endif
+            
         case 0x20:  // 请求版本信息
             {
                 uint8_t resp[16];
@@ -622,7 +2008,7 @@ static void usb_rx_callback(const uint8_t *data, uint8_t len)
                 resp[3] = FIRMWARE_VERSION_PATCH;
                 resp[4] = SLIMEVR_PROTOCOL_VERSION;
                 resp[5] = active_tracker_count;
-                usb_hid_write(resp, 16);
+                usb_hid_reply(resp, 16);
             }
             break;
     }
@@ -653,10 +2039,22 @@ int main(void)
         LOG_WARN("Last reset: %s", wdog_reset_reason_str(reset_reason));
     }
     
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_init(false);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_init();
+#endif
+    
     // GPIO 初始化
     hal_gpio_config(PIN_LED, HAL_GPIO_OUTPUT);
     hal_gpio_config(PIN_SW0, HAL_GPIO_INPUT_PULLUP);
     
+#if defined(USE_RX_FAST_BOOT) && USE_RX_FAST_BOOT
+    // v0.6.3: 启动闪烁由主循环 update_led 按 RX_BOOT_BLINK_MS 完成;
+    // 先使能 USB 上拉, 主机枚举在中断里进行, 与下面的 RF 初始化重叠
+    int usb_ret = usb_hid_init();
+#else
     // 启动闪烁
     for (int i = 0; i < 3; i++) {
         hal_gpio_write(PIN_LED, true);
@@ -664,45 +2062,86 @@ int main(void)
         hal_gpio_write(PIN_LED, false);
         hal_delay_ms(100);
     }
+#endif
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+    hal_led_init(PIN_LED);
+#endif
     
     // 初始化 Bootloader
     bootloader_init();
     
-    // 初始化追踪器数组
-    memset(trackers, 0, sizeof(trackers));
+#if defined(USE_RX_PREDICTION) && USE_RX_PREDICTION
+    rx_predict_init();
+#endif
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+    rx_smooth_init();
+#endif
+    
+    // 初始化 RF 接收器模块 (会自动初始化rf_hw)
+    memset(&rf_ctx, 0, sizeof(rf_ctx));
+    if (rf_receiver_init(&rf_ctx) != 0) {
+        error_code = ERR_RF_INIT;
+        enter_state(STATE_ERROR);
+    }
     
     // 加载配置
-    if (!load_config()) {
+    // v0.6.3: 配对直接恢复到 rf_ctx.trackers[] (唯一的每 tracker 记录), 须在 rf_receiver_init 之后
+    bool config_new = !load_config();
+    if (config_new) {
         // 生成随机网络密钥
 #ifdef CH59X
         *(uint32_t*)network_key = hal_get_random_u32();
 #else
         *(uint32_t*)network_key = 0x12345678;
 #endif
+#if !(defined(USE_RX_FAST_BOOT) && USE_RX_FAST_BOOT)
         save_config();
-    }
-    
-    // 初始化 RF 接收器模块 (会自动初始化rf_hw)
-    memset(&rf_ctx, 0, sizeof(rf_ctx));
-    rf_ctx.network_key = *(uint32_t*)network_key;
-    if (rf_receiver_init(&rf_ctx) != 0) {
-        error_code = ERR_RF_INIT;
-        enter_state(STATE_ERROR);
+#endif
     }
     
     // 初始化信道质量跟踪 (必须在RF接收器初始化之后)
     rf_channel_init();
     
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY
+    // v0.6.3: 启动能量普查 (USE_RX_FAST_BOOT 下 USB 已在中断中枚举), 持续忙的信道
+    // 不进入 rf_receiver_start 建立的首个跳频表
+    if (ch_mgr_boot_survey(&ch_manager) > 0) {
+        ch_mgr_export_blacklist(&ch_manager, rf_ctx.channel_blacklist,
+                                sizeof(rf_ctx.channel_blacklist));
+    }
+#endif
+    
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    {
+        uint8_t cell = 0;
+        if (hal_kv_get(HAL_KV_ROAM_CELL, &cell, 1) == 1) {
+            rf_receiver_set_roam_cell(&rf_ctx, cell);
+        }
+    }
+#endif
+    
     // 启动 RF 接收器
     rf_receiver_start(&rf_ctx);
+    slot_optimizer_set_command_sink(tracker_cmd_sink);
     
+#if defined(USE_RX_FAST_BOOT) && USE_RX_FAST_BOOT
+    // 首次上电的配置写入不再推迟首个信标
+    if (config_new) save_config();
+#else
     // 初始化 USB HID
-    if (usb_hid_init() != 0) {
+    int usb_ret = usb_hid_init();
+#endif
+    if (usb_ret != 0) {
         error_code = ERR_USB_INIT;
         enter_state(STATE_ERROR);
     }
     usb_hid_set_rx_callback(usb_rx_callback);
     
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+    tw_init();
+    tw_timer_init(&pair_timer, pair_timeout_cb, NULL);
+#endif
+    
     // 进入运行状态
     enter_state(STATE_RUNNING);
     
@@ -710,6 +2149,23 @@ int main(void)
     while (1) {
         // v0.6.2: 喂狗 (防止看门狗复位)
         wdog_feed();
+        PROF_BEGIN(PROF_MAIN_LOOP);
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+        telem_process();
+#endif
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+        tw_process();
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+        if (soak_process()) {
+            // 新窗口开始时各已连接 tracker 的电量各记一次
+            for (uint8_t i = 0; i < MAX_TRACKERS; i++) {
+                if (rf_ctx.trackers[i].active && rf_ctx.trackers[i].connected) {
+                    soak_record_battery(rf_ctx.trackers[i].battery);
+                }
+            }
+        }
+#endif
         
         // 错误状态
         if (state == STATE_ERROR) {
@@ -730,88 +2186,66 @@ int main(void)
         process_button();
         
         // RF 接收器处理 (统一处理同步信标、数据接收、配对)
+        PROF_BEGIN(PROF_RF_TASK);
         rf_receiver_process(&rf_ctx);
+        PROF_END(PROF_RF_TASK);
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+        group_sleep_update();
+#endif
         
-        // 同步本地追踪器状态 (从rf_ctx获取数据)
-        for (int i = 0; i < RF_MAX_TRACKERS && i < MAX_TRACKERS; i++) {
-            if (rf_ctx.trackers[i].active) {
-                receiver_tracker_t *local = &trackers[i];
-                tracker_info_t *remote = &rf_ctx.trackers[i];
-                
-                local->active = remote->connected;
-                local->paired = true;  // 已在rf_ctx.trackers[i].active条件内，表示已配对
-                if (remote->connected) {
-                    // v0.4.23: 丢包检测 (基于序列号)
-                    uint8_t expected_seq = local->last_sequence + 1;
-                    uint8_t actual_seq = remote->last_sequence;
-                    
-                    if (local->total_packets > 0 && actual_seq != expected_seq) {
-                        // 检测到丢包
-                        uint8_t lost = (uint8_t)(actual_seq - expected_seq);
-                        local->lost_packets += lost;
-                    }
-                    local->last_sequence = actual_seq;
-                    local->total_packets++;
-                    
-                    // 复制四元数和加速度数据
-                    // P0-5: 添加范围钳位防止溢出
-                    float q0 = remote->quaternion[0];
-                    float q1 = remote->quaternion[1];
-                    float q2 = remote->quaternion[2];
-                    float q3 = remote->quaternion[3];
-                    if (q0 > 1.0f) q0 = 1.0f; else if (q0 < -1.0f) q0 = -1.0f;
-                    if (q1 > 1.0f) q1 = 1.0f; else if (q1 < -1.0f) q1 = -1.0f;
-                    if (q2 > 1.0f) q2 = 1.0f; else if (q2 < -1.0f) q2 = -1.0f;
-                    if (q3 > 1.0f) q3 = 1.0f; else if (q3 < -1.0f) q3 = -1.0f;
-                    local->quat[0] = (int16_t)(q0 * 32767.0f);
-                    local->quat[1] = (int16_t)(q1 * 32767.0f);
-                    local->quat[2] = (int16_t)(q2 * 32767.0f);
-                    local->quat[3] = (int16_t)(q3 * 32767.0f);
-                    // 加速度范围钳位防止int16_t溢出 (±32.767g范围)
-                    float ax = remote->acceleration[0];
-                    float ay = remote->acceleration[1];
-                    float az = remote->acceleration[2];
-                    if (ax > 32.767f) ax = 32.767f; else if (ax < -32.768f) ax = -32.768f;
-                    if (ay > 32.767f) ay = 32.767f; else if (ay < -32.768f) ay = -32.768f;
-                    if (az > 32.767f) az = 32.767f; else if (az < -32.768f) az = -32.768f;
-                    local->accel[0] = (int16_t)(ax * 1000.0f);
-                    local->accel[1] = (int16_t)(ay * 1000.0f);
-                    local->accel[2] = (int16_t)(az * 1000.0f);
-                    local->battery = remote->battery;
-                    local->status = remote->flags;
-                    local->rssi = remote->rssi;
-                    local->last_seen = remote->last_seen_ms;
-                }
-            }
-        }
         active_tracker_count = rf_ctx.paired_count;
         
         // 配对模式处理
         if (state == STATE_PAIRING) {
-            static bool pairing_started = false;
             if (!pairing_started) {
                 rf_receiver_start_pairing(&rf_ctx);
                 pairing_started = true;
             }
             
-            // 检查配对超时
+#if !(defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL)
+            // 检查配对超时 (v0.6.3: USE_TIMER_WHEEL 时由 pair_timer 回调处理)
             if ((hal_get_tick_ms() - pair_mode_start) > PAIR_MODE_TIMEOUT_MS) {
                 rf_receiver_stop_pairing(&rf_ctx);
                 pairing_started = false;
                 enter_state(STATE_RUNNING);
             }
+#endif
         }
         
         // 运行模式 - 发送 USB 报告
         if (state == STATE_RUNNING) {
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+            // 转发报告优先占用端点, 姿态/状态报告在端点空闲时继续
+            send_forward_reports();
+#endif
+#if defined(USE_USB_FRAME_REPORTS) && USE_USB_FRAME_REPORTS
+            send_frame_reports();
+#else
             send_usb_report();
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+            send_aux_reports();     // 姿态报告之后的空闲端点
+#endif
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+            usb_debug_process();
+#endif
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM
+            bulk_stream_task();
+#endif
+#if defined(USE_RF_OTA) && USE_RF_OTA
+            ota_host_task();
+            rf_ota_receiver_task(&rf_ctx);
+#endif
         }
         
         // USB HID 任务
+        PROF_BEGIN(PROF_USB_TASK);
         usb_hid_task();
+        PROF_END(PROF_USB_TASK);
         
         // LED 更新
         update_led();
+        PROF_END(PROF_MAIN_LOOP);
         
         // 短延时
         hal_delay_us(100);
@@ -0,0 +1,636 @@
+/**
+ * @file main_replay.c
+ * @brief 主机回放传感器流水线 / Host-side replay of the sensor pipeline
+ *
+ * v0.6.3: make replay (主机编译器, 链接 hal_host.c 桩)
+ * - 按 main_tracker sensor_process_sample 的顺序逐样本运行真实模块:
+ *   换算 → 温度补偿 → motion_state → gyro_noise_filter → auto_calibration → 融合引擎
+ * - 每级计时 (ns/样本, 主机 CLOCK_MONOTONIC), 有参考姿态时统计误差
+ * - 输出/比对金标准姿态 (每 N 个样本一行), 偏差超限时返回非 0, 供 CI 使用
+ * - 有参考姿态时同时检查绝对误差 (fusion_bench 引擎限值), 超限同样返回非 0;
+ *   金标准只保证"与上次一致", 不能发现一起生成的发散结果
+ *
+ * 轨迹:
+ * - 无参数: fusion_bench 合成轨迹 (含参考姿态和磁力计)
+ * - tools/imu_capture.py 采集文件 (P/S 行): 与固件 sample_convert 相同的 float32 换算
+ * - fusion_bench.py CSV: gx,gy,gz (deg/s), ax,ay,az (g), 可选 mx,my,mz (uT),
+ *   qw,qx,qy,qz (参考), temp (°C)
+ *
+ * 用法:
+ *   build/host/replay [trace.csv] [--engine <name>|all] [--odr <hz>] [--mag]
+ *                     [--every <n>] [--golden <file>] [--write-golden <file>] [--tol <deg>]
+ */
+
+#include "hal.h"
+#include "config.h"
+#include "fusion_bench.h"
+#include "gyro_noise_filter.h"
+#include "motion_state.h"
+#include "auto_calibration.h"
+#include "temp_compensation.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+
+#define REPLAY_DEG2RAD          0.01745329252f
+#define REPLAY_TEMP_PERIOD_MS   100         // 与 main_tracker TEMP_FEED_PERIOD_MS 一致
+#define REPLAY_CALIB_PERIOD_MS  10          // auto_calib_process 空闲调用周期
+#define REPLAY_MAX_PARAMS       256
+#define REPLAY_LINE_MAX         512
+
+/*============================================================================
+ * 轨迹
+ *============================================================================*/
+
+typedef struct {
+    uint32_t seq;
+    int16_t raw[6];             // 采集文件: gx gy gz ax ay az
+    uint16_t pset;              // 采集文件: 换算参数组
+    float g[3];                 // 其他来源: rad/s
+    float a[3];                 // g
+    float m[3];                 // uT
+    float ref[4];
+    float temp;
+} replay_sample_t;
+
+typedef struct {
+    uint32_t seq;               // 生效序号
+    float v[12];                // gyro_gain, gyro_off, accel_gain, accel_off
+} replay_params_t;
+
+typedef struct {
+    char name[64];
+    replay_sample_t *s;
+    uint32_t count;
+    uint32_t cap;
+    uint16_t odr_hz;
+    bool raw;
+    bool has_mag;
+    bool has_ref;
+    bool has_temp;
+    uint32_t gaps;
+    replay_params_t params[REPLAY_MAX_PARAMS];
+    uint16_t param_count;
+} replay_trace_t;
+
+static replay_trace_t trace;
+
+static replay_sample_t *trace_append(void)
+{
+    if (trace.count == trace.cap) {
+        trace.cap = trace.cap ? trace.cap * 2 : 4096;
+        trace.s = realloc(trace.s, trace.cap * sizeof(replay_sample_t));
+        if (!trace.s) {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+    replay_sample_t *s = &trace.s[trace.count++];
+    memset(s, 0, sizeof(*s));
+    s->seq = trace.count - 1;
+    return s;
+}
+
+static void trace_load_synth(void)
+{
+    const fusion_bench_trace_t *tr = fusion_bench_default_trace();
+
+    snprintf(trace.name, sizeof(trace.name), "%s", tr->name);
+    trace.odr_hz = tr->odr_hz;
+    trace.has_mag = tr->has_mag;
+    trace.has_ref = true;
+    for (uint32_t i = 0; i < tr->count; i++) {
+        replay_sample_t *s = trace_append();
+        fusion_bench_trace_sample(tr, i, s->g, s->a, s->m, s->ref);
+    }
+}
+
+// 逗号分隔, 原地切分
+static int split_csv(char *line, char *field[], int max)
+{
+    int n = 0;
+    char *p = line;
+
+    while (n < max) {
+        field[n++] = p;
+        char *c = strchr(p, ',');
+        if (!c) break;
+        *c = '\0';
+        p = c + 1;
+    }
+    char *end = field[n - 1] + strcspn(field[n - 1], "\r\n");
+    *end = '\0';
+    return n;
+}
+
+enum {
+    COL_GX, COL_GY, COL_GZ, COL_AX, COL_AY, COL_AZ,
+    COL_MX, COL_MY, COL_MZ, COL_QW, COL_QX, COL_QY, COL_QZ, COL_TEMP, COL_COUNT
+};
+
+static const char *const col_names[COL_COUNT] = {
+    "gx", "gy", "gz", "ax", "ay", "az", "mx", "my", "mz", "qw", "qx", "qy", "qz", "temp"
+};
+
+static int trace_load_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[REPLAY_LINE_MAX];
+    char *field[32];
+    int col[COL_COUNT];
+    bool header = false;
+    int32_t last_seq = -1;
+
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+
+    const char *base = strrchr(path, '/');
+    snprintf(trace.name, sizeof(trace.name), "%s", base ? base + 1 : path);
+
+    while (fgets(line, sizeof(line), f)) {
+        int n = split_csv(line, field, 32);
+        if (n == 0 || field[0][0] == '\0' || field[0][0] == '#') continue;
+
+        // imu_capture.py 采集文件
+        if (strcmp(field[0], "P") == 0 && n >= 16) {
+            if (trace.param_count >= REPLAY_MAX_PARAMS) continue;
+            replay_params_t *p = &trace.params[trace.param_count++];
+            p->seq = (uint32_t)strtoul(field[1], NULL, 10);
+            trace.odr_hz = (uint16_t)atoi(field[3]);
+            for (int i = 0; i < 12; i++) p->v[i] = strtof(field[4 + i], NULL);
+            trace.raw = true;
+            continue;
+        }
+        if (strcmp(field[0], "S") == 0 && n >= 8) {
+            replay_sample_t *s = trace_append();
+            s->seq = (uint32_t)strtoul(field[1], NULL, 10);
+            for (int i = 0; i < 6; i++) s->raw[i] = (int16_t)atoi(field[2 + i]);
+            if (last_seq >= 0 && s->seq != (uint32_t)last_seq + 1) trace.gaps++;
+            last_seq = (int32_t)s->seq;
+            trace.raw = true;
+            continue;
+        }
+
+        // fusion_bench.py CSV
+        if (!header) {
+            for (int c = 0; c < COL_COUNT; c++) {
+                col[c] = -1;
+                for (int i = 0; i < n; i++) {
+                    if (strcasecmp(field[i], col_names[c]) == 0) col[c] = i;
+                }
+            }
+            for (int c = COL_GX; c <= COL_AZ; c++) {
+                if (col[c] < 0) {
+                    fprintf(stderr, "%s: missing column %s\n", path, col_names[c]);
+                    fclose(f);
+                    return -1;
+                }
+            }
+            trace.has_mag = col[COL_MX] >= 0 && col[COL_MY] >= 0 && col[COL_MZ] >= 0;
+            trace.has_ref = col[COL_QW] >= 0 && col[COL_QX] >= 0 &&
+                            col[COL_QY] >= 0 && col[COL_QZ] >= 0;
+            trace.has_temp = col[COL_TEMP] >= 0;
+            header = true;
+            continue;
+        }
+
+        replay_sample_t *s = trace_append();
+        float v[COL_COUNT] = {0};
+        for (int c = 0; c < COL_COUNT; c++) {
+            if (col[c] >= 0 && col[c] < n) v[c] = strtof(field[col[c]], NULL);
+        }
+        for (int i = 0; i < 3; i++) {
+            s->g[i] = v[COL_GX + i] * REPLAY_DEG2RAD;
+            s->a[i] = v[COL_AX + i];
+            s->m[i] = v[COL_MX + i];
+        }
+        for (int i = 0; i < 4; i++) s->ref[i] = v[COL_QW + i];
+        s->temp = v[COL_TEMP];
+    }
+    fclose(f);
+
+    if (trace.raw) {
+        if (trace.param_count == 0) {
+            fprintf(stderr, "%s: capture has no parameter rows\n", path);
+            return -1;
+        }
+        // 每个样本使用生效序号不大于自身的最后一组参数
+        uint16_t pi = 0;
+        for (uint32_t i = 0; i < trace.count; i++) {
+            while (pi + 1 < trace.param_count && trace.params[pi + 1].seq <= trace.s[i].seq) pi++;
+            trace.s[i].pset = pi;
+        }
+    }
+    return trace.count ? 0 : -1;
+}
+
+/*============================================================================
+ * 计时
+ *============================================================================*/
+
+enum {
+    STAGE_CONVERT, STAGE_TEMP, STAGE_MOTION, STAGE_FILTER, STAGE_CALIB, STAGE_FUSION, STAGE_COUNT
+};
+
+static const char *const stage_names[STAGE_COUNT] = {
+    "convert", "temp", "motion", "filter", "calib", "fusion"
+};
+
+typedef struct {
+    uint64_t sum_ns[STAGE_COUNT];
+    uint32_t max_ns[STAGE_COUNT];
+    uint32_t calls[STAGE_COUNT];
+} replay_timing_t;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void stage_end(replay_timing_t *t, int stage, uint64_t *t0)
+{
+    uint64_t t1 = now_ns();
+    uint32_t d = (uint32_t)(t1 - *t0);
+    t->sum_ns[stage] += d;
+    t->calls[stage]++;
+    if (d > t->max_ns[stage]) t->max_ns[stage] = d;
+    *t0 = t1;
+}
+
+/*============================================================================
+ * 金标准
+ *============================================================================*/
+
+typedef struct {
+    char engine[16];
+    uint32_t seq;
+    float q[4];
+} golden_entry_t;
+
+static golden_entry_t *golden = NULL;
+static uint32_t golden_count = 0;
+
+static int golden_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[REPLAY_LINE_MAX];
+    char *field[8];
+    uint32_t cap = 0;
+
+    if (!f) {
+        fprintf(stderr, "cannot open golden %s\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (split_csv(line, field, 8) < 6) continue;
+        if (golden_count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            golden = realloc(golden, cap * sizeof(golden_entry_t));
+            if (!golden) {
+                fclose(f);
+                return -1;
+            }
+        }
+        golden_entry_t *g = &golden[golden_count++];
+        snprintf(g->engine, sizeof(g->engine), "%s", field[0]);
+        g->seq = (uint32_t)strtoul(field[1], NULL, 10);
+        for (int i = 0; i < 4; i++) g->q[i] = strtof(field[2 + i], NULL);
+    }
+    fclose(f);
+    return 0;
+}
+
+// 金标准偏差 (deg): 双精度, 先归一化 (vqf_ultra 的 Q15 四元数模长不为 1),
+// 用弦长 4·asin(|q1 ∓ q2| / 2), 小角度处没有 acos 的精度损失
+static double golden_angle_deg(const float a[4], const float b[4])
+{
+    double na = 0.0, nb = 0.0, dot = 0.0, d2 = 0.0;
+
+    for (int i = 0; i < 4; i++) {
+        na += (double)a[i] * a[i];
+        nb += (double)b[i] * b[i];
+        dot += (double)a[i] * b[i];
+    }
+    na = sqrt(na);
+    nb = sqrt(nb);
+    if (na == 0.0 || nb == 0.0) return 180.0;
+
+    double s = (dot < 0.0) ? -1.0 : 1.0;
+    for (int i = 0; i < 4; i++) {
+        double d = a[i] / na - s * b[i] / nb;
+        d2 += d * d;
+    }
+    double c = 0.5 * sqrt(d2);
+    if (c > 1.0) c = 1.0;
+    return 4.0 * asin(c) * (180.0 / 3.14159265358979323846);
+}
+
+static const golden_entry_t *golden_find(const char *engine, uint32_t seq, uint32_t *hint)
+{
+    for (uint32_t i = *hint; i < golden_count; i++) {
+        if (golden[i].seq == seq && strcmp(golden[i].engine, engine) == 0) {
+            *hint = i + 1;
+            return &golden[i];
+        }
+    }
+    for (uint32_t i = 0; i < *hint && i < golden_count; i++) {
+        if (golden[i].seq == seq && strcmp(golden[i].engine, engine) == 0) {
+            *hint = i + 1;
+            return &golden[i];
+        }
+    }
+    return NULL;
+}
+
+/*============================================================================
+ * 回放
+ *============================================================================*/
+
+typedef struct {
+    bool use_mag;
+    uint32_t every;
+    float tol_deg;
+    FILE *golden_out;
+} replay_opts_t;
+
+typedef struct {
+    replay_timing_t timing;
+    float err_rms_deg;
+    float err_max_deg;
+    float tilt_rms_deg;
+    float golden_max_deg;
+    uint32_t golden_checked;
+    uint32_t golden_missing;
+} replay_result_t;
+
+static void pipeline_init(uint8_t engine, float dt)
+{
+    // 与 main_tracker sensor_task 的配置一致
+    gyro_filter_config_t gyro_cfg = {
+        .enable_median = true,
+        .enable_moving_avg = true,
+        .enable_kalman = false,
+        .enable_rest_detection = true,
+        .enable_temp_comp = false,
+        .process_noise = 0.001f,
+        .measurement_noise = 0.01f
+    };
+
+    hal_host_set_time_us(0);
+    gyro_filter_init(&gyro_cfg);
+    motion_state_init();
+    auto_calib_init();
+    temp_comp_init();
+    fusion_bench_engine_init(engine, dt);
+}
+
+static void replay_run(uint8_t engine, const replay_opts_t *opt, replay_result_t *res)
+{
+    const char *name = fusion_bench_engine_name(engine);
+    uint64_t period_us = 1000000ULL / trace.odr_hz;
+    uint32_t warmup = (uint32_t)FUSION_BENCH_WARMUP_S * trace.odr_hz;
+    uint32_t last_temp_ms = 0, last_calib_ms = 0;
+    uint32_t golden_hint = 0;
+    float comp[3] = {0, 0, 0};
+    float err2 = 0.0f, tilt2 = 0.0f;
+    uint32_t err_n = 0;
+    bool mag = opt->use_mag && trace.has_mag;
+
+    memset(res, 0, sizeof(*res));
+    pipeline_init(engine, 1.0f / trace.odr_hz);
+    if (trace.has_ref) fusion_bench_engine_set_quat(trace.s[0].ref);
+
+    for (uint32_t i = 0; i < trace.count; i++) {
+        const replay_sample_t *s = &trace.s[i];
+        float g[3], a[3], q[4];
+        uint64_t t0;
+
+        // 按序号推进时间: 采集丢失的样本在时间轴上留空
+        hal_host_set_time_us(s->seq * period_us);
+        uint32_t now_ms = hal_get_tick_ms();
+
+        t0 = now_ns();
+        if (trace.raw) {
+            // 与 imu_interface sample_convert 相同: raw × gain - off (float32)
+            const float *p = trace.params[s->pset].v;
+            for (int k = 0; k < 3; k++) {
+                g[k] = s->raw[k] * p[k] - p[3 + k];
+                a[k] = s->raw[3 + k] * p[6 + k] - p[9 + k];
+            }
+        } else {
+            memcpy(g, s->g, sizeof(g));
+            memcpy(a, s->a, sizeof(a));
+        }
+        stage_end(&res->timing, STAGE_CONVERT, &t0);
+
+        // 采集文件的换算参数已含温度补偿; 其他来源按 10Hz 喂温度, 补偿量由驱动换算时扣除
+        if (trace.has_temp) {
+            if (now_ms - last_temp_ms >= REPLAY_TEMP_PERIOD_MS) {
+                last_temp_ms = now_ms;
+                temp_comp_update_temp(s->temp);
+                temp_comp_get_compensation(comp);
+            }
+            g[0] -= comp[0];
+            g[1] -= comp[1];
+            g[2] -= comp[2];
+            stage_end(&res->timing, STAGE_TEMP, &t0);
+        }
+
+        motion_state_update(g, a);
+        stage_end(&res->timing, STAGE_MOTION, &t0);
+
+#if defined(GYRO_FILTER_DETECT_ONLY) && GYRO_FILTER_DETECT_ONLY
+        gyro_filter_process(g, NULL, a, s->temp);
+#else
+        float gf[3];
+        gyro_filter_process(g, gf, a, s->temp);
+#endif
+        stage_end(&res->timing, STAGE_FILTER, &t0);
+
+        auto_calib_update(g, a);
+        if (now_ms - last_calib_ms >= REPLAY_CALIB_PERIOD_MS) {
+            last_calib_ms = now_ms;
+            auto_calib_process();
+        }
+        stage_end(&res->timing, STAGE_CALIB, &t0);
+
+        fusion_bench_engine_update(g, a, mag ? s->m : NULL);
+        stage_end(&res->timing, STAGE_FUSION, &t0);
+
+        fusion_bench_engine_get_quat(q);
+
+        if (trace.has_ref && i >= warmup) {
+            float tilt;
+            float err = fusion_bench_angle_deg(q, s->ref, &tilt);
+            if (err > res->err_max_deg) res->err_max_deg = err;
+            err2 += err * err;
+            tilt2 += tilt * tilt;
+            err_n++;
+        }
+
+        if (opt->every && (s->seq % opt->every) == 0) {
+            if (opt->golden_out) {
+                fprintf(opt->golden_out, "%s,%u,%.9g,%.9g,%.9g,%.9g\n",
+                        name, (unsigned)s->seq, q[0], q[1], q[2], q[3]);
+            }
+            if (golden) {
+                const golden_entry_t *ge = golden_find(name, s->seq, &golden_hint);
+                if (ge) {
+                    float d = (float)golden_angle_deg(q, ge->q);
+                    if (d > res->golden_max_deg) res->golden_max_deg = d;
+                    res->golden_checked++;
+                } else {
+                    res->golden_missing++;
+                }
+            }
+        }
+    }
+
+    if (err_n > 0) {
+        res->err_rms_deg = sqrtf(err2 / err_n);
+        res->tilt_rms_deg = sqrtf(tilt2 / err_n);
+    }
+}
+
+static void report_header(void)
+{
+    printf("%-10s", "engine");
+    for (int k = 0; k < STAGE_COUNT; k++) printf(" %8s", stage_names[k]);
+    printf(" %8s %9s %16s %8s\n", "total", "fusion_mx", "err rms/max", "tilt");
+}
+
+static void report_result(const char *name, const replay_result_t *r)
+{
+    const replay_timing_t *t = &r->timing;
+    double total = 0.0;
+
+    printf("%-10s", name);
+    for (int k = 0; k < STAGE_COUNT; k++) {
+        if (t->calls[k] == 0) {
+            printf(" %8s", "-");
+            continue;
+        }
+        double avg = (double)t->sum_ns[k] / t->calls[k];
+        total += avg;
+        printf(" %8.1f", avg);
+    }
+    printf(" %8.1f %9u", total, (unsigned)t->max_ns[STAGE_FUSION]);
+    if (trace.has_ref) {
+        printf(" %7.3f/%-8.3f %8.3f", r->err_rms_deg, r->err_max_deg, r->tilt_rms_deg);
+    }
+    printf("\n");
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: replay [trace.csv] [--engine <name>|all] [--odr <hz>] [--mag]\n"
+            "              [--every <n>] [--golden <file>] [--write-golden <file>] [--tol <deg>]\n"
+            "engines:");
+    for (uint8_t i = 0; i < fusion_bench_engine_count(); i++) {
+        fprintf(stderr, " %s", fusion_bench_engine_name(i));
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    const char *engine_arg = "all";
+    const char *golden_path = NULL;
+    const char *write_path = NULL;
+    int odr = 0;
+    replay_opts_t opt = { .use_mag = false, .every = 50, .tol_deg = 0.05f, .golden_out = NULL };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has_val = (i + 1 < argc);
+
+        if (strcmp(a, "--engine") == 0 && has_val) engine_arg = argv[++i];
+        else if (strcmp(a, "--odr") == 0 && has_val) odr = atoi(argv[++i]);
+        else if (strcmp(a, "--mag") == 0) opt.use_mag = true;
+        else if (strcmp(a, "--every") == 0 && has_val) opt.every = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(a, "--golden") == 0 && has_val) golden_path = argv[++i];
+        else if (strcmp(a, "--write-golden") == 0 && has_val) write_path = argv[++i];
+        else if (strcmp(a, "--tol") == 0 && has_val) opt.tol_deg = strtof(argv[++i], NULL);
+        else if (a[0] != '-' && !path) path = a;
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    trace.odr_hz = SENSOR_ODR_HZ;
+    if (path) {
+        if (trace_load_file(path) != 0) return 2;
+    } else {
+        trace_load_synth();
+    }
+    if (odr > 0) trace.odr_hz = (uint16_t)odr;
+
+    int first = 0, last = fusion_bench_engine_count() - 1;
+    if (strcmp(engine_arg, "all") != 0) {
+        first = last = fusion_bench_engine_find(engine_arg);
+        if (first < 0) {
+            usage();
+            return 2;
+        }
+    }
+
+    if (golden_path && golden_load(golden_path) != 0) return 2;
+    if (write_path) {
+        opt.golden_out = fopen(write_path, "w");
+        if (!opt.golden_out) {
+            fprintf(stderr, "cannot write %s\n", write_path);
+            return 2;
+        }
+        fprintf(opt.golden_out, "# replay golden: trace=%s odr=%u mag=%d every=%u\n",
+                trace.name, trace.odr_hz, (opt.use_mag && trace.has_mag) ? 1 : 0,
+                (unsigned)opt.every);
+    }
+
+    printf("trace %s n=%u odr=%u raw=%d mag=%d ref=%d temp=%d gaps=%u\n",
+           trace.name, (unsigned)trace.count, trace.odr_hz, trace.raw, trace.has_mag,
+           trace.has_ref, trace.has_temp, (unsigned)trace.gaps);
+    printf("ns/sample (avg)\n");
+    report_header();
+
+    int failed = 0;
+    for (int e = first; e <= last; e++) {
+        replay_result_t r;
+        const char *name = fusion_bench_engine_name((uint8_t)e);
+
+        replay_run((uint8_t)e, &opt, &r);
+        report_result(name, &r);
+
+        if (trace.has_ref) {
+            const fusion_bench_limits_t *lim = fusion_bench_engine_limits((uint8_t)e);
+            bool ok = fusion_bench_within_limits((uint8_t)e, r.err_rms_deg, r.err_max_deg);
+            if (!ok) failed++;
+            printf("  limit %s: rms %.3f/%.1f max %.3f/%.1f deg\n", ok ? "ok" : "FAIL",
+                   r.err_rms_deg, lim->err_rms_deg, r.err_max_deg, lim->err_max_deg);
+        }
+
+        if (golden) {
+            bool ok = r.golden_checked > 0 && r.golden_missing == 0 &&
+                      r.golden_max_deg <= opt.tol_deg;
+            if (!ok) failed++;
+            printf("  golden %s: max %.4f deg (tol %.4f), %u checked, %u missing\n",
+                   ok ? "ok" : "FAIL", r.golden_max_deg, opt.tol_deg,
+                   (unsigned)r.golden_checked, (unsigned)r.golden_missing);
+        }
+    }
+
+    if (opt.golden_out) fclose(opt.golden_out);
+    free(trace.s);
+    free(golden);
+    return failed ? 1 : 0;
+}
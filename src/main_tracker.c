@@ -19,7 +19,10 @@
 #include "rf_hw.h"
 
 // v0.6.2: 根据FUSION_TYPE选择融合算法
-#if FUSION_TYPE == FUSION_VQF_ULTRA
+// v0.6.3: USE_FUSION_SWITCH 时由 fusion_switch 在运行时选择引擎
+#if defined(USE_FUSION_SWITCH) && USE_FUSION_SWITCH
+#include "fusion_switch.h"
+#elif FUSION_TYPE == FUSION_VQF_ULTRA
 #include "vqf_ultra.h"
 #elif FUSION_TYPE == FUSION_VQF_ADVANCED
 #include "vqf_advanced.h"
@@ -29,6 +32,10 @@
 #include "vqf_simple.h"
 #elif FUSION_TYPE == FUSION_EKF
 #include "ekf_ahrs.h"
+#elif FUSION_TYPE == FUSION_VQF_FIXED
+#include "vqf_fixed.h"
+#elif FUSION_TYPE == FUSION_EKF_FIXED
+#include "ekf_fixed.h"
 #else
 #include "vqf_advanced.h"  // 默认使用VQF Advanced
 #endif
@@ -40,6 +47,7 @@
 #include "watchdog.h"      // v0.6.2: 看门狗和故障恢复
 #include "event_logger.h"  // v0.6.2: 事件日志
 #include "gyro_noise_filter.h"  // v0.6.2: 陀螺仪滤波和静止检测
+#include "motion_state.h"       // v0.6.3: 共享运动状态
 #include "retained_state.h"     // v0.6.2: 睡眠状态保持
 #include "auto_calibration.h"   // v0.6.2: 运动中自动校准
 #include "temp_compensation.h"  // v0.6.2: 温度漂移补偿
@@ -47,6 +55,7 @@
 #include "power_optimizer.h"    // v0.6.2: 功耗优化
 #include "usb_debug.h"          // v0.6.2: USB调试接口
 #include "diagnostics.h"        // v0.6.2: 诊断统计
+#include "profile.h"            // v0.6.3: 周期计数探针
 #include "channel_manager.h"    // v0.6.2: 智能信道管理
 #include "rf_recovery.h"        // v0.6.2: RF自愈机制
 #include "rf_slot_optimizer.h"  // v0.6.2: 时隙优化
@@ -54,7 +63,23 @@
 #include "rf_ultra.h"           // v0.6.2: RF Ultra模式
 #include "sensor_optimized.h"   // v0.6.2: 优化传感器读取
 #include "usb_msc.h"            // v0.6.2: USB大容量存储
+#include "usb_hid_slime.h"      // v0.6.3: 有线数据流 (HID 枚举)
 #include "mag_interface.h"      // v0.6.2: 磁力计支持
+#include "event_queue.h"        // v0.6.3: 事件驱动主循环
+#include "timer_wheel.h"        // v0.6.3: 分级时间轮
+#include "imu_clock_sync.h"     // v0.6.3: IMU 采样相位锁定
+#include "gyro_preint.h"        // v0.6.3: 陀螺仪多样本预积分
+#include "hal_led.h"            // v0.6.3: 节拍驱动 LED 图案
+#include "hal_button.h"         // v0.6.3: 中断驱动按键
+#include "wake_profile.h"       // v0.6.3: 唤醒分段计时
+#include "rf_ota.h"             // v0.6.3: RF 固件广播升级
+#include "rf_arbiter.h"         // v0.6.3: 射频时分仲裁 (BLE 配置通道)
+#include "ble_slimevr.h"
+#include "telemetry_history.h"  // v0.6.3: 跨重启遥测汇总
+#include "soak_stats.h"         // v0.6.3: 窗口统计
+#include "fuel_gauge.h"         // v0.6.3: 电量计
+#include "selftest.h"           // v0.6.3: 器件特性测量
+#include "fast_math.h"
 #include <string.h>
 
 #ifdef CH59X
@@ -109,27 +134,64 @@ static void gpio_disable_interrupt(uint8_t pin)
  * 根据FUSION_TYPE自动选择正确的API
  *============================================================================*/
 
-#if FUSION_TYPE == FUSION_VQF_ULTRA
+#if defined(USE_FUSION_SWITCH) && USE_FUSION_SWITCH
+// v0.6.3: 运行时切换 vqf_ultra / FUSION_SWITCH_ACCURATE, 每样本由 FUSION_POLICY 选择
+#define FUSION_INIT(state, odr)         fusion_switch_init(state, odr)
+#define FUSION_UPDATE(state, g, a)      fusion_switch_update(state, g, a)
+#define FUSION_SET_DT(state, d)         fusion_switch_set_dt(state, d)
+#define FUSION_GET_QUAT(state, q)       fusion_switch_get_quat(state, q)
+#define FUSION_RESET(state)             fusion_switch_reset(state)
+#define FUSION_SET_QUAT(state, q)       fusion_switch_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     fusion_switch_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     fusion_switch_load_checkpoint(state, c)
+#define FUSION_POLICY(state, still, batt)   fusion_switch_policy(state, still, batt)
+#if FUSION_SWITCH_HAS_MAG
+#define FUSION_UPDATE_MAG(state, g, a, m)   fusion_switch_update_mag(state, g, a, m)
+#endif
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED && VQF_EXTERNAL_REST
+#define FUSION_SET_REST(state, r)       fusion_switch_set_rest(state, r)
+#endif
+
+#elif FUSION_TYPE == FUSION_VQF_ULTRA
 #define FUSION_INIT(state, odr)         vqf_ultra_init(state, odr)
 #define FUSION_UPDATE(state, g, a)      vqf_ultra_update(state, g, a)
+// dt 为 2 的幂次移位, 不支持逐样本 dt (无 FUSION_SET_DT)
 #define FUSION_GET_QUAT(state, q)       vqf_ultra_get_quat(state, q)
 #define FUSION_RESET(state)             vqf_ultra_reset(state)
 #define FUSION_SET_QUAT(state, q)       vqf_ultra_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     vqf_ultra_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     vqf_ultra_load_checkpoint(state, c)
 
 #elif FUSION_TYPE == FUSION_VQF_ADVANCED
 #define FUSION_INIT(state, odr)         vqf_advanced_init(state, 1.0f/(odr), 3.0f, 9.0f)
 #define FUSION_UPDATE(state, g, a)      vqf_advanced_update(state, g, a)
+#define FUSION_SET_DT(state, d)         ((state)->dt = (d))
 #define FUSION_GET_QUAT(state, q)       vqf_advanced_get_quat(state, q)
 #define FUSION_RESET(state)             vqf_advanced_reset(state)
 #define FUSION_SET_QUAT(state, q)       do { (state)->quat[0]=(q)[0]; (state)->quat[1]=(q)[1]; \
                                              (state)->quat[2]=(q)[2]; (state)->quat[3]=(q)[3]; } while(0)
+#define FUSION_CKPT_SAVE(state, c)     vqf_advanced_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     vqf_advanced_load_checkpoint(state, c)
+#define FUSION_PROPAGATE(state, g, d)   vqf_advanced_propagate(state, g, d)
+#define FUSION_CORRECT(state, g, a)     vqf_advanced_correct(state, g, a)
+#define FUSION_PROPAGATE_DELTA(state, d, t)  vqf_advanced_propagate_delta(state, d, t)
+#if VQF_USE_MAGNETOMETER
+#define FUSION_UPDATE_MAG(state, g, a, m)   vqf_advanced_update_mag(state, g, a, m)
+#define FUSION_CORRECT_MAG(state, g, a, m)  vqf_advanced_correct_mag(state, g, a, m)
+#endif
+#if VQF_EXTERNAL_REST
+#define FUSION_SET_REST(state, r)       vqf_advanced_set_rest(state, r)
+#endif
 
 #elif FUSION_TYPE == FUSION_VQF_OPT
 #define FUSION_INIT(state, odr)         vqf_opt_init(state, 1.0f/(odr))
 #define FUSION_UPDATE(state, g, a)      vqf_opt_update(state, g, a)
+#define FUSION_SET_DT(state, d)         ((state)->dt = (d))
 #define FUSION_GET_QUAT(state, q)       vqf_opt_get_quat(state, q)
 #define FUSION_RESET(state)             vqf_opt_reset(state)
 #define FUSION_SET_QUAT(state, q)       vqf_opt_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     vqf_opt_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     vqf_opt_load_checkpoint(state, c)
 
 #elif FUSION_TYPE == FUSION_VQF_SIMPLE
 #define FUSION_INIT(state, odr)         vqf_simple_init(state, 1.0f/(odr))
@@ -141,28 +203,115 @@ static void gpio_disable_interrupt(uint8_t pin)
 #elif FUSION_TYPE == FUSION_EKF
 #define FUSION_INIT(state, odr)         ekf_ahrs_init(state, 1.0f/(odr))
 #define FUSION_UPDATE(state, g, a)      ekf_ahrs_update(state, g, a)
+#define FUSION_SET_DT(state, d)         ((state)->dt = (d))
 #define FUSION_GET_QUAT(state, q)       ekf_ahrs_get_quat(state, q)
 #define FUSION_RESET(state)             ekf_ahrs_reset(state)
 #define FUSION_SET_QUAT(state, q)       ekf_ahrs_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     ekf_ahrs_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     ekf_ahrs_load_checkpoint(state, c)
+
+#elif FUSION_TYPE == FUSION_VQF_FIXED
+// v0.6.3: 定点 VQF, 浮点接口包装, 内部全整数
+#define FUSION_INIT(state, odr)         vqf_fixed_init(state, 1.0f/(odr), 3.0f, 9.0f)
+#define FUSION_UPDATE(state, g, a)      vqf_fixed_update(state, g, a)
+#define FUSION_SET_DT(state, d)         vqf_fixed_set_dt(state, d)
+#define FUSION_GET_QUAT(state, q)       vqf_fixed_get_quat(state, q)
+#define FUSION_RESET(state)             vqf_fixed_reset(state)
+#define FUSION_SET_QUAT(state, q)       vqf_fixed_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     vqf_fixed_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     vqf_fixed_load_checkpoint(state, c)
+#define FUSION_PROPAGATE(state, g, d)   vqf_fixed_propagate(state, g, d)
+#define FUSION_CORRECT(state, g, a)     vqf_fixed_correct(state, g, a)
+#define FUSION_PROPAGATE_DELTA(state, d, t)  vqf_fixed_propagate_delta(state, d, t)
+#if VQF_FIXED_USE_MAGNETOMETER
+#define FUSION_UPDATE_MAG(state, g, a, m)   vqf_fixed_update_mag(state, g, a, m)
+#define FUSION_CORRECT_MAG(state, g, a, m)  vqf_fixed_correct_mag(state, g, a, m)
+#endif
+
+#elif FUSION_TYPE == FUSION_EKF_FIXED
+// v0.6.3: 定点误差状态 EKF, 仅 6 轴 (无 FUSION_UPDATE_MAG)
+#define FUSION_INIT(state, odr)         ekf_fixed_init(state, 1.0f/(odr))
+#define FUSION_UPDATE(state, g, a)      ekf_fixed_update(state, g, a)
+#define FUSION_SET_DT(state, d)         ekf_fixed_set_dt(state, d)
+#define FUSION_GET_QUAT(state, q)       ekf_fixed_get_quat(state, q)
+#define FUSION_RESET(state)             ekf_fixed_reset(state)
+#define FUSION_SET_QUAT(state, q)       ekf_fixed_set_quat(state, q)
+#define FUSION_CKPT_SAVE(state, c)     ekf_fixed_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     ekf_fixed_load_checkpoint(state, c)
+#define FUSION_PROPAGATE(state, g, d)   ekf_fixed_propagate(state, g, d)
+#define FUSION_CORRECT(state, g, a)     ekf_fixed_correct(state, a)
+#define FUSION_PROPAGATE_DELTA(state, d, t)  ekf_fixed_propagate_delta(state, d, t)
 
 #else
 // 默认使用VQF Advanced
 #define FUSION_INIT(state, odr)         vqf_advanced_init(state, 1.0f/(odr), 3.0f, 9.0f)
 #define FUSION_UPDATE(state, g, a)      vqf_advanced_update(state, g, a)
+#define FUSION_SET_DT(state, d)         ((state)->dt = (d))
 #define FUSION_GET_QUAT(state, q)       vqf_advanced_get_quat(state, q)
 #define FUSION_RESET(state)             vqf_advanced_reset(state)
 #define FUSION_SET_QUAT(state, q)       do { (state)->quat[0]=(q)[0]; (state)->quat[1]=(q)[1]; \
                                              (state)->quat[2]=(q)[2]; (state)->quat[3]=(q)[3]; } while(0)
+#define FUSION_CKPT_SAVE(state, c)     vqf_advanced_save_checkpoint(state, c)
+#define FUSION_CKPT_LOAD(state, c)     vqf_advanced_load_checkpoint(state, c)
+#define FUSION_PROPAGATE(state, g, d)   vqf_advanced_propagate(state, g, d)
+#define FUSION_CORRECT(state, g, a)     vqf_advanced_correct(state, g, a)
+#define FUSION_PROPAGATE_DELTA(state, d, t)  vqf_advanced_propagate_delta(state, d, t)
+#if VQF_USE_MAGNETOMETER
+#define FUSION_UPDATE_MAG(state, g, a, m)   vqf_advanced_update_mag(state, g, a, m)
+#define FUSION_CORRECT_MAG(state, g, a, m)  vqf_advanced_correct_mag(state, g, a, m)
+#endif
+#if VQF_EXTERNAL_REST
+#define FUSION_SET_REST(state, r)       vqf_advanced_set_rest(state, r)
+#endif
+#endif
+
+/*
+ * v0.6.3: 陀螺仪在 SENSOR_ODR_HZ 下捷联积分, 校正步降到 FUSION_RATE_HZ
+ * 只对提供 FUSION_PROPAGATE/FUSION_CORRECT 的引擎生效, 其余引擎每个样本完整更新;
+ * 引擎以校正频率初始化 (增益/静止计时/过程噪声按校正周期), 传播 dt 逐样本传入
+ */
+#if defined(FUSION_PROPAGATE) && (FUSION_CORRECT_DIV > 1)
+#define FUSION_DECIMATED                1
+#define FUSION_INIT_HZ                  FUSION_RATE_HZ
+#else
+#define FUSION_DECIMATED                0
+#define FUSION_INIT_HZ                  SENSOR_ODR_HZ
+#endif
+
+// v0.6.3: 降频校正时可改为区间预积分 (锥运动补偿), 每次校正只乘一次四元数
+#if FUSION_DECIMATED && defined(USE_GYRO_PREINT) && USE_GYRO_PREINT
+#define FUSION_PREINT                   1
+#else
+#define FUSION_PREINT                   0
+#endif
+
+/*
+ * v0.6.3: IMU 功耗档降 ODR 时, 名义样本间隔和降频校正的样本数随之变化,
+ * 校正周期保持在 FUSION_RATE_HZ 附近 (ODR 低于校正频率时每样本一次)
+ */
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE
+#if !defined(FUSION_SET_DT) && !FUSION_DECIMATED
+#error "USE_IMU_POWER_PROFILE requires a fusion engine with per-sample dt (FUSION_SET_DT)!"
+#endif
+#define SENSOR_NOMINAL_DT               ((float)imu_get_rate_div() / SENSOR_ODR_HZ)
+#define FUSION_CORRECT_EVERY            (FUSION_CORRECT_DIV > imu_get_rate_div() ? \
+                                         FUSION_CORRECT_DIV / imu_get_rate_div() : 1)
+#else
+#define SENSOR_NOMINAL_DT               (1.0f / SENSOR_ODR_HZ)
+#define FUSION_CORRECT_EVERY            FUSION_CORRECT_DIV
 #endif
 
 /*============================================================================
  * 配置常量
  *============================================================================*/
 
-// 传感器
-#define SENSOR_ODR_HZ           200
+// 传感器 (SENSOR_ODR_HZ / FUSION_RATE_HZ 见 config.h)
 #define SENSOR_PERIOD_US        (1000000 / SENSOR_ODR_HZ)
 
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD && (SENSOR_ODR_HZ != RF_RAW_ODR_HZ)
+#error "USE_FUSION_OFFLOAD: SENSOR_ODR_HZ must match RF_RAW_ODR_HZ (receiver fusion dt)!"
+#endif
+
 // 按键
 #define BTN_DEBOUNCE_MS         50
 #define BTN_LONG_PRESS_MS       3000
@@ -196,7 +345,8 @@ typedef enum {
     STATE_CALIBRATING,      // 校准中
     STATE_SLEEPING,         // 低功耗睡眠
     STATE_BOOTLOADER,       // Bootloader 模式
-    STATE_ERROR             // 错误状态
+    STATE_ERROR,            // 错误状态
+    STATE_WIRED             // v0.6.3: USB 有线数据流 (RF 休眠)
 } tracker_state_t;
 
 /*============================================================================
@@ -221,27 +371,47 @@ static uint32_t state_enter_time = 0;
 static uint8_t error_code = 0;
 
 // 传感器 - v0.6.2: 根据FUSION_TYPE选择状态结构
-#if FUSION_TYPE == FUSION_VQF_ULTRA
-static vqf_ultra_state_t vqf_state;
+#if defined(USE_FUSION_SWITCH) && USE_FUSION_SWITCH
+typedef fusion_switch_t tracker_fusion_t;
+#elif FUSION_TYPE == FUSION_VQF_ULTRA
+typedef vqf_ultra_state_t tracker_fusion_t;
 #elif FUSION_TYPE == FUSION_VQF_ADVANCED
-static vqf_state_t vqf_state;
+typedef vqf_state_t tracker_fusion_t;
 #elif FUSION_TYPE == FUSION_VQF_OPT
-static vqf_opt_state_t vqf_state;
+typedef vqf_opt_state_t tracker_fusion_t;
 #elif FUSION_TYPE == FUSION_VQF_SIMPLE
-static vqf_simple_state_t vqf_state;
+typedef vqf_simple_state_t tracker_fusion_t;
 #elif FUSION_TYPE == FUSION_EKF
-static ekf_ahrs_state_t vqf_state;
+typedef ekf_ahrs_state_t tracker_fusion_t;
+#elif FUSION_TYPE == FUSION_VQF_FIXED
+typedef vqf_fixed_state_t tracker_fusion_t;
+#elif FUSION_TYPE == FUSION_EKF_FIXED
+typedef ekf_fixed_state_t tracker_fusion_t;
 #else
-static vqf_state_t vqf_state;  // 默认VQF Advanced
+typedef vqf_state_t tracker_fusion_t;  // 默认VQF Advanced
+#endif
+static tracker_fusion_t vqf_state;
+#if FUSION_DECIMATED
+static float fusion_prop_dt = 1.0f / SENSOR_ODR_HZ; // v0.6.3: 下一样本的传播 dt
+static uint8_t fusion_correct_count = 0;            // 距上次校正的样本数
 #endif
 
 // 这些变量被usb_debug.c引用，不能是static
 float quaternion[4] = {1, 0, 0, 0};
-float accel_linear[3] = {0, 0, 0};
 float gyro[3] = {0, 0, 0};  // 全局变量供usb_debug.c使用
 float accel[3] = {0, 0, 0};  // 全局变量供usb_debug.c使用
 static float gyro_bias[3] = {0, 0, 0};
 static uint32_t last_sensor_time_us = 0;
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+static uint32_t quat_sample_us = 0;     // v0.6.3: quaternion 对应的最新 IMU 样本时刻
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+// v0.6.3: 辅助 IMU - 独立的融合状态, 样本只用于自身姿态 (不参与运动状态/校准)
+static tracker_fusion_t aux_state;
+static float aux_quat[4] = {1, 0, 0, 0};
+static uint32_t aux_sample_us = 0;
+static bool aux_present = false;
+#endif
 
 // RF - 使用模块化 rf_transmitter
 static rf_transmitter_ctx_t rf_ctx;
@@ -264,24 +434,38 @@ uint8_t battery_percent = 100;
 bool is_charging = false;
 
 // 按键
+#if !(defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ)
 static button_state_t btn_main;
 static button_state_t btn_reset;
+#endif
 
 // LED
+#if !(defined(USE_LED_PATTERN) && USE_LED_PATTERN)
 static uint32_t led_toggle_time = 0;
 static bool led_state = false;
+#endif
 
 // 校准
 static float calib_gyro_sum[3] = {0, 0, 0};
 static uint16_t calib_sample_count = 0;
 #define CALIB_SAMPLES           500     // 2.5秒 @ 200Hz
 
-// v0.6.2: 新增模块的全局状态
-#if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
-// 这些变量被rf_transmitter.c引用，不能是static
-channel_manager_t ch_manager;
+#if defined(USE_GYRO_BIAS_REFINE) && USE_GYRO_BIAS_REFINE
+// v0.6.3: 存储偏置的上电检查 (窗口内校正后陀螺均值 + 加速度每轴范围) 和静止时的后台细化
+#define GYRO_DPS_TO_RAD(d)      ((d) * 0.017453293f)
+static bool bias_checked = false;
+static float bias_check_sum[3];
+static float bias_check_amin[3], bias_check_amax[3];
+static uint16_t bias_check_count = 0;
+static float bias_refine_sum[3];
+static uint16_t bias_refine_count = 0;
+static float bias_saved[3];             // 最近写入 Flash 的偏置
+static uint32_t bias_saved_ms = 0;
 #endif
 
+// v0.6.2: 新增模块的全局状态
+// v0.6.3: ch_manager 移至 channel_manager.c (所有信道统计共用一个实例)
+
 #if defined(USE_RF_RECOVERY) && USE_RF_RECOVERY
 // 这些变量被rf_transmitter.c引用，不能是static
 rf_recovery_state_t rf_recovery_state;
@@ -291,7 +475,7 @@ rf_recovery_state_t rf_recovery_state;
  * Flash 存储 - 使用 hal_storage API
  *============================================================================*/
 
-// 使用hal_storage的相对地址 (PAIR_STORAGE_ADDR = 0x0200)
+// v0.6.3: 保存到键值存储 HAL_KV_TRACKER_PAIRING; 旧固定偏移只用于读取升级前的数据
 #define STORAGE_PAIRING_OFFSET  0x0200
 #define FLASH_MAGIC             0x534C494D  // "SLIM"
 
@@ -308,14 +492,23 @@ typedef struct {
  *============================================================================*/
 
 static void enter_state(tracker_state_t new_state);
+#if !(defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ)
 static void process_button(button_state_t *btn, uint8_t pin, 
                           bool *single, bool *double_click, bool *long_press);
+#endif
 static void update_led(void);
 static void read_battery(void);
 static void save_pairing_data(void);
 static bool load_pairing_data(void);
 static void start_calibration(void);
 static void process_calibration(float gyro[3]);
+#if defined(USE_GYRO_BIAS_REFINE) && USE_GYRO_BIAS_REFINE
+static void bias_check(const float gyro[3]);
+static void bias_refine(const float gyro[3]);
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+static void aux_imu_suspend(void);
+#endif
 
 /*============================================================================
  * 状态切换
@@ -335,8 +528,13 @@ static void enter_state(tracker_state_t new_state)
             break;
             
         case STATE_RUNNING:
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_ON);
+#else
             led_state = true;
             hal_gpio_write(PIN_LED, true);
+#endif
+            WAKE_MARK(WAKE_PH_SYNC);    // 唤醒后首次同步, 本帧开始发送
             break;
             
         case STATE_PAIRING:
@@ -350,14 +548,28 @@ static void enter_state(tracker_state_t new_state)
             break;
             
         case STATE_SLEEPING:
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_OFF);
+#else
             hal_gpio_write(PIN_LED, false);
+#endif
             imu_suspend();
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+            aux_imu_suspend();
+#endif
             rf_hw_set_mode(RF_MODE_SLEEP);
             break;
             
         case STATE_BOOTLOADER:
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+            hal_led_set_pattern(LED_PATTERN_OFF);
+#else
             hal_gpio_write(PIN_LED, false);
+#endif
             imu_suspend();
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+            aux_imu_suspend();
+#endif
             rf_hw_set_mode(RF_MODE_SLEEP);
             bootloader_enter_update_mode();
             break;
@@ -371,54 +583,193 @@ static void enter_state(tracker_state_t new_state)
     }
 }
 
-/*============================================================================
- * 传感器处理
- *============================================================================*/
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+/*
+ * v0.6.3: SFLP 模式 - 姿态由 LSM6DSV 片上融合给出, MCU 只管航向:
+ * 静止时 SFLP 的航向变化只可能来自残余陀螺偏置, 累计到绕世界 z 轴的修正角里抵消
+ */
+static float sflp_yaw_corr = 0.0f;      // rad
+static float sflp_rest_yaw = 0.0f;      // 本次静止开始时 SFLP 的航向
+static float sflp_rest_corr = 0.0f;     // 本次静止开始时的修正角
+static bool sflp_was_rest = false;
 
-static void sensor_task(void)
+static float sflp_wrap_pi(float a)
 {
-    uint32_t now_us = hal_get_tick_us();
-    if ((now_us - last_sensor_time_us) < SENSOR_PERIOD_US) {
-        return;
+    if (a > FM_PI) a -= 2.0f * FM_PI;
+    else if (a < -FM_PI) a += 2.0f * FM_PI;
+    return a;
+}
+
+static void sflp_update_quat(void)
+{
+    float q[4];
+    if (!imu_sflp_get_quat(q)) return;
+    
+    float yaw = fm_atan2(2.0f * (q[0] * q[3] + q[1] * q[2]),
+                         1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]));
+    bool rest = motion_state_is_rest();
+    if (rest) {
+        if (!sflp_was_rest) {
+            sflp_rest_yaw = yaw;
+            sflp_rest_corr = sflp_yaw_corr;
+        }
+        sflp_yaw_corr = sflp_wrap_pi(sflp_rest_corr - sflp_wrap_pi(yaw - sflp_rest_yaw));
+    }
+    sflp_was_rest = rest;
+    
+    // quaternion = q_z(corr) ⊗ q
+    float s, c;
+    fm_sincos_small(0.5f * sflp_yaw_corr, &s, &c);
+    quaternion[0] = c * q[0] - s * q[3];
+    quaternion[1] = c * q[1] - s * q[2];
+    quaternion[2] = c * q[2] + s * q[1];
+    quaternion[3] = c * q[3] + s * q[0];
+}
+#endif
+
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE && \
+    !(defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD)
+/**
+ * @brief v0.6.3: 按 RF_MULTI_SAMPLE_HZ 缓存姿态样本, 下个时隙聚合上传
+ */
+static void rf_multi_capture(uint32_t ts_us)
+{
+    static uint32_t last_capture_us = 0;
+    
+    if (state != STATE_RUNNING) return;
+    if ((ts_us - last_capture_us) < (1000000UL / RF_MULTI_SAMPLE_HZ)) return;
+    last_capture_us = ts_us;
+    
+    float q[4];
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    if (imu_sflp_active()) {
+        sflp_update_quat();
+        memcpy(q, quaternion, sizeof(q));
+    } else
+#endif
+    {
+        FUSION_GET_QUAT(&vqf_state, q);
     }
-    last_sensor_time_us = now_us;
-    
-    // 读取 IMU (使用全局变量供usb_debug.c访问)
-    float temp = 25.0f;  // 默认温度
     
-#if defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED
-    // v0.6.2: 使用优化传感器读取 (FIFO+后台处理)
-    uint32_t sample_ts;
-    if (!sensor_optimized_get_sample(gyro, accel, &sample_ts)) {
-        return;
+    q15_t q15[4];
+    for (int i = 0; i < 4; i++) {
+        q15[i] = (q15_t)(q[i] * 32767.0f);
     }
-#elif defined(USE_SENSOR_DMA) && USE_SENSOR_DMA
-    // v0.6.2: 使用DMA读取
-    if (sensor_dma_data_ready()) {
-        if (sensor_dma_get_data(gyro, accel, &temp) != 0) {
-            return;
+    rf_multi_push_sample(q15, ts_us);
+}
+#endif
+
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+/**
+ * @brief v0.6.3: 融合卸载 - 缓存已校准的原始样本, 由接收器融合
+ */
+static void rf_raw_capture(uint32_t ts_us)
+{
+    if (state != STATE_RUNNING) return;
+    rf_raw_push_sample(gyro, accel, ts_us);
+}
+#endif
+
+/*============================================================================
+ * 传感器处理
+ *============================================================================*/
+
+/**
+ * v0.6.2: 读取磁力计 (用于航向校正)
+ * v0.6.3: 从单样本处理中拆出, 批量模式下每批只读一次
+ */
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER
+static float mag_data_f[3] = {0};
+static bool mag_fresh = false;      // v0.6.3: 新样本尚未用于融合
+
+static void mag_task(void)
+{
+    if (mag_is_enabled()) {
+        mag_data_t mag_data;
+        if (mag_read(&mag_data) == 0) {
+            // 转换为float数组
+            mag_data_f[0] = mag_data.x;
+            mag_data_f[1] = mag_data.y;
+            mag_data_f[2] = mag_data.z;
+            mag_fresh = true;
         }
-    } else {
-        return;
     }
+}
+#endif
+
+// v0.6.3: 芯片温度随数据突发读出, 温度补偿按此周期抽取更新 (10Hz)
+#define TEMP_FEED_PERIOD_MS     100
+
+// v0.6.3: 手动偏置 + 温度补偿由 IMU 驱动在换算时一次完成;
+// 仅 DMA 帧解码路径 (不经过 imu 驱动换算) 保留逐步处理
+#if defined(USE_SENSOR_DMA) && USE_SENSOR_DMA && \
+    !(defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED)
+#define SENSOR_PREPROC_IN_DRIVER    0
 #else
-    // 标准读取 (使用全局变量)
-    if (imu_read_all(gyro, accel) != 0) {
-        return;
+#define SENSOR_PREPROC_IN_DRIVER    1
+#endif
+
+/**
+ * v0.6.3: 校准或温度补偿变化后重新配置驱动的融合预处理
+ */
+static void sensor_preproc_update(void)
+{
+#if SENSOR_PREPROC_IN_DRIVER
+    imu_preproc_t pp = { 0 };
+    float comp[3];
+    
+    temp_comp_get_compensation(comp);
+    for (int i = 0; i < 3; i++) {
+        pp.gyro_offset[i] = gyro_bias[i] + comp[i];
     }
+    imu_set_preproc(&pp);
 #endif
+}
+
+/**
+ * v0.6.3: 用 IMU 实测芯片温度驱动温度补偿 (抽取)
+ * @param temp_c 最新芯片温度
+ */
+static void temp_feed(float temp_c)
+{
+    static uint32_t last_feed_ms = 0;
+    uint32_t now_ms = hal_get_tick_ms();
+    
+    if ((now_ms - last_feed_ms) < TEMP_FEED_PERIOD_MS) return;
+    last_feed_ms = now_ms;
+    temp_comp_update_temp(temp_c);
+    sensor_preproc_update();
+}
+
+/**
+ * v0.6.3: 单个样本的校准/融合处理 (输入为全局 gyro/accel)
+ * @param temp 当前估计温度
+ */
+static void sensor_process_sample(float temp)
+{
+    PROF_SCOPE(PROF_SENSOR_SAMPLE);
     
-    // v0.6.2: 更新温度补偿 (使用温度补偿模块内部的温度估计)
-    temp = temp_comp_get_temp();  // 获取当前估计温度
+#if !SENSOR_PREPROC_IN_DRIVER
     temp_comp_apply(gyro);  // 应用温度补偿到陀螺仪
+#endif
+    SELFTEST_FEED(gyro);
+    
+    // v0.6.3: 每样本一次运动状态估计, 滤波器/自动校准/功耗/RF/融合共用
+    motion_state_update(gyro, accel);
     
     // v0.6.2: 更新陀螺仪滤波器 (用于静止检测)
+    // v0.6.3: 只用静止标志, GYRO_FILTER_DETECT_ONLY 下不产生滤波输出
+#if defined(GYRO_FILTER_DETECT_ONLY) && GYRO_FILTER_DETECT_ONLY
+    gyro_filter_process(gyro, NULL, accel, temp);
+#else
     float gyro_filtered[3];
     gyro_filter_process(gyro, gyro_filtered, accel, temp);
+#endif
     
-    // v0.6.2: 更新自动校准 (运动中校准)
+    // v0.6.2: 更新自动校准 (运动中校准, 在样本上减去自身估计的残余偏移)
     auto_calib_update(gyro, accel);
     
+#if !SENSOR_PREPROC_IN_DRIVER
     // 应用偏置补偿
     if (auto_calib_is_valid()) {
         // 使用自动校准的偏移
@@ -433,70 +784,343 @@ static void sensor_task(void)
         gyro[1] -= gyro_bias[1];
         gyro[2] -= gyro_bias[2];
     }
-    
-    // v0.6.2: 读取磁力计 (用于航向校正)
-#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER
-    static float mag_data_f[3] = {0};
-    static bool mag_available = false;
-    
-    if (mag_is_enabled()) {
-        mag_data_t mag_data;
-        if (mag_read(&mag_data) == 0) {
-            // 转换为float数组
-            mag_data_f[0] = mag_data.x;
-            mag_data_f[1] = mag_data.y;
-            mag_data_f[2] = mag_data.z;
-            mag_available = true;
-        }
-    }
 #endif
     
     // v0.6.2: 更新功耗优化 (根据运动状态调整时钟)
-    float gyro_mag = gyro[0]*gyro[0] + gyro[1]*gyro[1] + gyro[2]*gyro[2];
-    float accel_mag = accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2];
-    // 使用平方值避免sqrt运算
-    power_update(gyro_mag, accel_mag);
+    power_update(motion_state_level() == MOTION_LEVEL_MOTION);
     
     // 校准模式: 累积陀螺仪数据
     if (state == STATE_CALIBRATING) {
         process_calibration(gyro);
         return;
     }
+#if defined(USE_GYRO_BIAS_REFINE) && USE_GYRO_BIAS_REFINE
+    bias_check(gyro);
+    bias_refine(gyro);
+#endif
+    
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    // v0.6.3: 姿态已由 IMU 片上融合算出 (sensor_task 末尾取出), MCU 不融合
+    if (imu_sflp_active()) {
+        return;
+    }
+#endif
     
     // 正常模式: 传感器融合
-#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER && VQF_USE_MAGNETOMETER
-    // 有磁力计数据时使用9DOF融合
-    if (mag_available && mag_is_calibrated()) {
-        vqf_advanced_update_mag(&vqf_state, gyro, accel, mag_data_f);
+    PROF_BEGIN(PROF_FUSION);
+    SELFTEST_BEGIN(SELFTEST_T_FUSION);
+#if defined(FUSION_POLICY) && !(defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD)
+    // v0.6.3: 低电量/持续静止降到 ultra, 运动时升回精确引擎 (经检查点交接)
+    FUSION_POLICY(&vqf_state, motion_state_still_ms(), battery_percent);
+#endif
+#if defined(FUSION_SET_REST)
+    FUSION_SET_REST(&vqf_state, motion_state_is_rest());
+#endif
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    // v0.6.3: 融合在接收器上执行, 样本由 rf_raw_capture 上传 (不含磁力计)
+#elif FUSION_PREINT
+    // v0.6.3: 区间内只累加增量角, 校正时一次应用旋转增量, 用区间平均角速度/加速度校正
+    gyro_preint_add(gyro, accel, fusion_prop_dt);
+    if (++fusion_correct_count >= FUSION_CORRECT_EVERY) {
+        float dtheta[3], rate[3], acc_mean[3];
+        float t = gyro_preint_get(dtheta, acc_mean);
+        float inv_t = 1.0f / t;
+
+        fusion_correct_count = 0;
+        gyro_preint_reset();
+        FUSION_PROPAGATE_DELTA(&vqf_state, dtheta, t);
+        rate[0] = dtheta[0] * inv_t;
+        rate[1] = dtheta[1] * inv_t;
+        rate[2] = dtheta[2] * inv_t;
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER && defined(FUSION_CORRECT_MAG)
+        if (mag_fresh && mag_is_calibrated()) {
+            FUSION_CORRECT_MAG(&vqf_state, rate, acc_mean, mag_data_f);
+            mag_fresh = false;
+        } else
+#endif
+        {
+            FUSION_CORRECT(&vqf_state, rate, acc_mean);
+        }
+    }
+#elif FUSION_DECIMATED
+    // v0.6.3: 每个样本捷联积分, 每 FUSION_CORRECT_DIV 个样本做一次加速度/磁力计校正
+    FUSION_PROPAGATE(&vqf_state, gyro, fusion_prop_dt);
+    if (++fusion_correct_count >= FUSION_CORRECT_EVERY) {
+        fusion_correct_count = 0;
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER && defined(FUSION_CORRECT_MAG)
+        if (mag_fresh && mag_is_calibrated()) {
+            FUSION_CORRECT_MAG(&vqf_state, gyro, accel, mag_data_f);
+            mag_fresh = false;
+        } else
+#endif
+        {
+            FUSION_CORRECT(&vqf_state, gyro, accel);
+        }
+    }
+#elif defined(USE_MAGNETOMETER) && USE_MAGNETOMETER && defined(FUSION_UPDATE_MAG)
+    // 有磁力计数据时使用9DOF融合 (v0.6.3: 由融合引擎提供 FUSION_UPDATE_MAG)
+    // v0.6.3: 每个磁力计样本只用一次, 其余 IMU 样本走 6 轴更新
+    if (mag_fresh && mag_is_calibrated()) {
+        FUSION_UPDATE_MAG(&vqf_state, gyro, accel, mag_data_f);
+        mag_fresh = false;
     } else {
         FUSION_UPDATE(&vqf_state, gyro, accel);
     }
 #else
     FUSION_UPDATE(&vqf_state, gyro, accel);
+#endif
+    SELFTEST_END(SELFTEST_T_FUSION, 1);
+    PROF_END(PROF_FUSION);
+}
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/**
+ * v0.6.3: 检测辅助 IMU 并重新开始融合 (上电/唤醒后, 主 IMU 的 FIFO 已使能)
+ */
+static void aux_imu_start(void)
+{
+    aux_present = (imu_aux_init() == 0);
+    if (aux_present) {
+        FUSION_INIT(&aux_state, SENSOR_ODR_HZ);     // 每样本完整更新, 不降频校正
+        LOG_INFO("Aux IMU found");
+    }
+    rf_transmitter_set_aux(&rf_ctx, NULL, 0);
+}
+
+static void aux_imu_suspend(void)
+{
+    if (imu_select(IMU_SENSOR_AUX) == 0) {
+        imu_suspend();
+        imu_select(IMU_SENSOR_PRIMARY);
+    }
+}
+
+/**
+ * v0.6.3: 主 IMU 突发读取之后紧接着读辅助 IMU 的 FIFO (同一总线, 主循环中顺序访问)
+ */
+static void aux_imu_task(uint32_t now_us)
+{
+    if (!aux_present || imu_select(IMU_SENSOR_AUX) != 0) return;
+    
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+    imu_gyro_range_update();
+#endif
+    float g[IMU_FIFO_MAX_BATCH][3], a[IMU_FIFO_MAX_BATCH][3];
+    int n = imu_fifo_read(g, a, NULL, IMU_FIFO_MAX_BATCH);
+    imu_select(IMU_SENSOR_PRIMARY);
+    if (n <= 0) return;
+    
+    PROF_BEGIN(PROF_FUSION);
+    for (int i = 0; i < n; i++) {
+        FUSION_UPDATE(&aux_state, g[i], a[i]);
+    }
+    PROF_END(PROF_FUSION);
+    FUSION_GET_QUAT(&aux_state, aux_quat);
+    aux_sample_us = now_us;
+}
+#endif
+
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+// v0.6.3: 有线数据流逐样本取姿态发送 (RF 只发每批最新的一个)
+static void wired_sample(uint32_t sample_us)
+{
+    if (state != STATE_WIRED) return;
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    if (imu_sflp_active()) return;
 #endif
     FUSION_GET_QUAT(&vqf_state, quaternion);
+    usb_debug_wired_sample(quaternion, accel, sample_us);
+}
+#endif
+
+static void sensor_task(void)
+{
+    uint32_t now_us = hal_get_tick_us();
+    
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+    // v0.6.3: 上一批样本都已换算, 在读取之前切换量程
+    imu_gyro_range_update();
+#endif
+    
+#if defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED && \
+    defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH
+    // v0.6.3: 批量模式 - 不按周期节拍取数, 水位中断到来后
+    // 突发读取 IMU FIFO, 并把环形缓冲里的所有样本一次处理完
+    // 主循环被 RF 阻塞时样本留在 FIFO 中, 不再丢失
+    if (sensor_optimized_poll() == 0 && sensor_optimized_available() == 0) {
+        return;
+    }
+    last_sensor_time_us = now_us;
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    aux_imu_task(now_us);
+#endif
+    
+    float temp;
+    if (imu_get_temperature(&temp)) {
+        temp_feed(temp);
+    }
+    temp = temp_comp_get_temp();
+    uint32_t sample_ts;
+    uint8_t processed = 0;
+    
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER
+    mag_task();
+#endif
     
-    // 计算线性加速度 (移除重力)
-    float gravity[3];
-    float gv[3] = {0, 0, 1};
+    while (sensor_optimized_get_sample(gyro, accel, &sample_ts)) {
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP && FUSION_DECIMATED
+        // v0.6.3: 降频校正时时间戳 dt 只用于传播, 校正周期保持标称值
+        float sample_dt = sensor_optimized_get_last_dt();
+        fusion_prop_dt = sample_dt > 0.0f ? sample_dt : SENSOR_NOMINAL_DT;
+#elif defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP && defined(FUSION_SET_DT)
+        // v0.6.3: 按 IMU 时间戳的实际间隔积分, 未知时回到标称 dt
+        float sample_dt = sensor_optimized_get_last_dt();
+        FUSION_SET_DT(&vqf_state, sample_dt > 0.0f ? sample_dt : SENSOR_NOMINAL_DT);
+#endif
+        sensor_process_sample(temp);
+        processed++;
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+        quat_sample_us = sample_ts;
+#endif
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+        wired_sample(sample_ts);
+#endif
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+        rf_raw_capture(sample_ts);
+#elif defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+        rf_multi_capture(sample_ts);
+#endif
+    }
+    
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+    // v0.6.3: 用本批最新样本的时间戳闭环 CLKIN, 使样本在本时隙前刚好就绪
+    if (processed > 0) {
+        if (state == STATE_RUNNING) {
+            imu_clock_sync_update(sample_ts, rf_ctx.sync_time_us,
+                                  rf_transmitter_get_slot_offset_us());
+        } else {
+            imu_clock_sync_hold();
+        }
+    }
+#endif
     
-    // 使用四元数旋转重力向量
-    float qw = quaternion[0], qx = quaternion[1];
-    float qy = quaternion[2], qz = quaternion[3];
+    if (processed == 0 || state == STATE_CALIBRATING) {
+        return;
+    }
+#else
+    if ((now_us - last_sensor_time_us) < SENSOR_PERIOD_US) {
+        return;
+    }
+    last_sensor_time_us = now_us;
+    
+    // 读取 IMU (使用全局变量供usb_debug.c访问)
+    float temp = 25.0f;  // 默认温度
     
-    gravity[0] = 2.0f * (qx*qz - qw*qy) * 1.0f;
-    gravity[1] = 2.0f * (qy*qz + qw*qx) * 1.0f;
-    gravity[2] = (qw*qw - qx*qx - qy*qy + qz*qz) * 1.0f;
+#if defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED
+    // v0.6.2: 使用优化传感器读取 (FIFO+后台处理)
+    uint32_t sample_ts;
+    if (!sensor_optimized_get_sample(gyro, accel, &sample_ts)) {
+        return;
+    }
+#elif defined(USE_SENSOR_DMA) && USE_SENSOR_DMA
+    // v0.6.2: 使用DMA读取
+    if (sensor_dma_data_ready()) {
+        if (sensor_dma_get_data(gyro, accel, &temp) != 0) {
+            return;
+        }
+        temp_feed(temp);    // DMA 帧自带温度
+    } else {
+        return;
+    }
+#else
+    // 标准读取 (使用全局变量), 芯片温度在同一次突发中读出
+    SELFTEST_BEGIN(SELFTEST_T_IMU_READ);
+    if (imu_read_all(gyro, accel) != 0) {
+        return;
+    }
+    SELFTEST_END(SELFTEST_T_IMU_READ, 1);
+#endif
     
-    accel_linear[0] = accel[0] - gravity[0];
-    accel_linear[1] = accel[1] - gravity[1];
-    accel_linear[2] = accel[2] - gravity[2];
+#if !(defined(USE_SENSOR_DMA) && USE_SENSOR_DMA) || (defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED)
+    if (imu_get_temperature(&temp)) {
+        temp_feed(temp);
+    }
+#endif
+    // v0.6.3: 补偿模块内的温度已由实测芯片温度更新
+    temp = temp_comp_get_temp();
+    
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER
+    mag_task();
+#endif
+    
+    sensor_process_sample(temp);
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    quat_sample_us = now_us;
+#endif
+    if (state == STATE_CALIBRATING) {
+        return;
+    }
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+    wired_sample(now_us);
+#endif
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    rf_raw_capture(now_us);
+#elif defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+    rf_multi_capture(now_us);
+#endif
+#endif
+    
+    // 整批处理完后只取一次姿态
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    if (imu_sflp_active()) {
+        sflp_update_quat();
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+        // SFLP 姿态按批给出, 有线数据流每批一个样本
+        if (state == STATE_WIRED) {
+            usb_debug_wired_sample(quaternion, accel, hal_get_tick_us());
+        }
+#endif
+        return;
+    }
+#endif
+    FUSION_GET_QUAT(&vqf_state, quaternion);
 }
 
 /*============================================================================
  * 校准处理
  *============================================================================*/
 
+// 更新RF发送器的传感器数据 (先计算flags，再传入函数)
+static void update_rf_data(void)
+{
+    bool is_stationary = motion_state_is_rest();  // v0.4.24, v0.6.3: 共享运动状态
+    uint8_t rf_flags = (is_charging ? RF_FLAG_CHARGING : 0) |
+                       (battery_percent < 20 ? RF_FLAG_LOW_BATTERY : 0) |
+                       (state == STATE_CALIBRATING ? RF_FLAG_CALIBRATING : 0) |
+                       (is_stationary ? RF_FLAG_STATIONARY : 0);  // v0.4.24
+    // v0.6.3: 传原始加速度, 线性加速度由发送器在组包时计算
+    rf_transmitter_set_data(&rf_ctx, quaternion, accel, battery_percent, rf_flags);
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    rf_transmitter_set_sample_time(&rf_ctx, quat_sample_us);
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    if (aux_present) {
+        rf_transmitter_set_aux(&rf_ctx, aux_quat, aux_sample_us);
+    }
+#endif
+}
+
+#if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING
+// v0.6.3: 时隙前回调 - 取出 FIFO 中已有的帧 (不等水位) 并融合,
+// 发送的姿态距采样最多约 JIT_SAMPLE_LEAD_US + 一个采样周期
+static void jit_pre_tx(void)
+{
+    sensor_optimized_flush();
+    sensor_task();
+    update_rf_data();
+}
+#endif
+
 static void start_calibration(void)
 {
     enter_state(STATE_CALIBRATING);
@@ -510,29 +1134,117 @@ static void process_calibration(float gyro[3])
     calib_gyro_sum[2] += gyro[2] + gyro_bias[2];
     calib_sample_count++;
     
-    // LED 快闪指示校准中
-    if ((hal_get_tick_ms() - led_toggle_time) > 50) {
-        led_toggle_time = hal_get_tick_ms();
-        led_state = !led_state;
-        hal_gpio_write(PIN_LED, led_state);
+#if !(defined(USE_LED_PATTERN) && USE_LED_PATTERN)
+    // LED 快闪指示校准中 (USE_LED_PATTERN 时由 update_led 选图案)
+    if ((hal_get_tick_ms() - led_toggle_time) > 50) {
+        led_toggle_time = hal_get_tick_ms();
+        led_state = !led_state;
+        hal_gpio_write(PIN_LED, led_state);
+    }
+#endif
+    
+    // 完成
+    if (calib_sample_count >= CALIB_SAMPLES) {
+        gyro_bias[0] = calib_gyro_sum[0] / CALIB_SAMPLES;
+        gyro_bias[1] = calib_gyro_sum[1] / CALIB_SAMPLES;
+        gyro_bias[2] = calib_gyro_sum[2] / CALIB_SAMPLES;
+        sensor_preproc_update();
+        
+        // 重置融合算法
+        FUSION_RESET(&vqf_state);
+        
+        // 保存校准数据
+        save_pairing_data();
+        
+        // 返回运行状态
+        enter_state(is_paired ? STATE_RUNNING : STATE_SEARCH_SYNC);
+    }
+}
+
+#if defined(USE_GYRO_BIAS_REFINE) && USE_GYRO_BIAS_REFINE
+static float vec3_max_abs(const float v[3])
+{
+    float m = fabsf(v[0]);
+    if (fabsf(v[1]) > m) m = fabsf(v[1]);
+    if (fabsf(v[2]) > m) m = fabsf(v[2]);
+    return m;
+}
+
+/**
+ * v0.6.3: 上电后检查存储的偏置 (输入为校正后的陀螺)
+ *
+ * 错误的偏置让 motion_state 永远判不出静止, 所以用加速度计判断窗口是否静止;
+ * 只有静止窗口才下结论, 运动中的窗口丢弃重来
+ */
+static void bias_check(const float gyro[3])
+{
+    if (bias_checked || !is_paired) return;
+    if (state != STATE_RUNNING && state != STATE_SEARCH_SYNC) return;
+    
+    for (int i = 0; i < 3; i++) {
+        if (bias_check_count == 0) {
+            bias_check_sum[i] = 0.0f;
+            bias_check_amin[i] = bias_check_amax[i] = accel[i];
+        }
+        bias_check_sum[i] += gyro[i];
+        if (accel[i] < bias_check_amin[i]) bias_check_amin[i] = accel[i];
+        if (accel[i] > bias_check_amax[i]) bias_check_amax[i] = accel[i];
+    }
+    if (++bias_check_count < GYRO_BIAS_CHECK_SAMPLES) return;
+    bias_check_count = 0;
+    
+    for (int i = 0; i < 3; i++) {
+        if (bias_check_amax[i] - bias_check_amin[i] > GYRO_BIAS_STILL_G) return;
+        bias_check_sum[i] /= GYRO_BIAS_CHECK_SAMPLES;
+    }
+    bias_checked = true;
+    memcpy(bias_saved, gyro_bias, sizeof(bias_saved));
+    bias_saved_ms = hal_get_tick_ms();
+    
+    if (vec3_max_abs(bias_check_sum) > GYRO_DPS_TO_RAD(GYRO_BIAS_CHECK_DPS)) {
+        LOG_WARN("Stored gyro bias off by %d mdps, calibrating",
+                 (int)(vec3_max_abs(bias_check_sum) * 57295.78f));
+        start_calibration();
+    }
+}
+
+/**
+ * v0.6.3: REST 期间把残余偏置并入存储的偏置 (输入为校正后的陀螺)
+ */
+static void bias_refine(const float gyro[3])
+{
+    if (!bias_checked || !motion_state_is_rest()) {
+        bias_refine_count = 0;
+        return;
+    }
+#if !SENSOR_PREPROC_IN_DRIVER
+    // 逐步处理路径下自动校准有效后就不再减 gyro_bias, 残差归自动校准
+    if (auto_calib_is_valid()) return;
+#endif
+    
+    for (int i = 0; i < 3; i++) {
+        if (bias_refine_count == 0) bias_refine_sum[i] = 0.0f;
+        bias_refine_sum[i] += gyro[i];
+    }
+    if (++bias_refine_count < GYRO_REFINE_SAMPLES) return;
+    bias_refine_count = 0;
+    
+    float delta[3];
+    for (int i = 0; i < 3; i++) {
+        gyro_bias[i] += bias_refine_sum[i] / GYRO_REFINE_SAMPLES * GYRO_REFINE_ALPHA;
+        delta[i] = gyro_bias[i] - bias_saved[i];
     }
+    sensor_preproc_update();
     
-    // 完成
-    if (calib_sample_count >= CALIB_SAMPLES) {
-        gyro_bias[0] = calib_gyro_sum[0] / CALIB_SAMPLES;
-        gyro_bias[1] = calib_gyro_sum[1] / CALIB_SAMPLES;
-        gyro_bias[2] = calib_gyro_sum[2] / CALIB_SAMPLES;
-        
-        // 重置融合算法
-        FUSION_RESET(&vqf_state);
-        
-        // 保存校准数据
+    uint32_t now_ms = hal_get_tick_ms();
+    if (vec3_max_abs(delta) > GYRO_DPS_TO_RAD(GYRO_REFINE_SAVE_DPS) &&
+        (now_ms - bias_saved_ms) > GYRO_REFINE_SAVE_MS) {
+        memcpy(bias_saved, gyro_bias, sizeof(bias_saved));
+        bias_saved_ms = now_ms;
         save_pairing_data();
-        
-        // 返回运行状态
-        enter_state(is_paired ? STATE_RUNNING : STATE_SEARCH_SYNC);
     }
 }
+#endif
 
 /*============================================================================
  * RF 发送
@@ -558,13 +1270,8 @@ static void save_pairing_data(void)
     
     // v0.6.2: 按照优化手册建议，添加错误返回值检查
 #ifdef CH59X
-    int ret = hal_storage_erase(STORAGE_PAIRING_OFFSET, 256);
-    if (ret != 0) {
-        LOG_ERR("Storage erase failed: %d", ret);
-        return;
-    }
-    
-    ret = hal_storage_write(STORAGE_PAIRING_OFFSET, &data, sizeof(data));
+    // v0.6.3: 校准完成时 tracker 仍在发送, 后台写入避免擦写阻塞跨过时隙
+    int ret = hal_kv_set_deferred(HAL_KV_TRACKER_PAIRING, &data, sizeof(data));
     if (ret != 0) {
         LOG_ERR("Storage write failed: %d", ret);
         return;
@@ -580,7 +1287,12 @@ static bool load_pairing_data(void)
     
 #ifdef CH59X
     // v0.6.2: 按照优化手册建议，添加错误返回值检查
-    int ret = hal_storage_read(STORAGE_PAIRING_OFFSET, &data, sizeof(data));
+    int ret = hal_kv_get(HAL_KV_TRACKER_PAIRING, &data, sizeof(data));
+    if (ret == HAL_KV_ERR_NOT_FOUND) {
+        ret = hal_storage_read(STORAGE_PAIRING_OFFSET, &data, sizeof(data));
+    } else if (ret == (int)sizeof(data)) {
+        ret = 0;
+    }
     if (ret != 0) {
         LOG_ERR("Storage read failed: %d", ret);
         return false;  // 读取失败，返回未配对状态
@@ -622,6 +1334,7 @@ static bool load_pairing_data(void)
  * 按键处理
  *============================================================================*/
 
+#if !(defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ)
 static void process_button(button_state_t *btn, uint8_t pin,
                           bool *single, bool *double_click, bool *long_press)
 {
@@ -684,11 +1397,34 @@ static void process_button(button_state_t *btn, uint8_t pin,
         }
     }
 }
+#endif
 
 /*============================================================================
  * LED 更新
  *============================================================================*/
 
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+// v0.6.3: 只按状态选图案, 闪烁与调光由 TMR0 节拍完成 (hal_led.c)
+static void update_led(void)
+{
+    led_pattern_t pattern;
+    
+    switch (state) {
+        case STATE_RUNNING:     pattern = LED_PATTERN_ON;          break;
+        case STATE_WIRED:       pattern = LED_PATTERN_ON;          break;
+        case STATE_SEARCH_SYNC: pattern = LED_PATTERN_BLINK_SLOW;  break;
+        case STATE_PAIRING:     pattern = LED_PATTERN_BLINK_PAIR;  break;
+        case STATE_CALIBRATING: pattern = LED_PATTERN_BLINK_RAPID; break;
+        case STATE_BOOTLOADER:  pattern = LED_PATTERN_BLINK_FAST;  break;
+        case STATE_ERROR:       pattern = LED_PATTERN_BLINK_FAST;  break;
+        default:                pattern = LED_PATTERN_OFF;         break;
+    }
+    
+    if (pattern != hal_led_get_pattern()) {
+        hal_led_set_pattern(pattern);
+    }
+}
+#else
 static void update_led(void)
 {
     uint32_t now = hal_get_tick_ms();
@@ -696,6 +1432,7 @@ static void update_led(void)
     
     switch (state) {
         case STATE_RUNNING:
+        case STATE_WIRED:
             hal_gpio_write(PIN_LED, true);
             return;
             
@@ -731,16 +1468,50 @@ static void update_led(void)
         hal_gpio_write(PIN_LED, led_state);
     }
 }
+#endif
 
 /*============================================================================
  * 电池检测
  *============================================================================*/
 
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+// v0.6.3: 1s 周期定时器置位, read_battery 在 TASK_BATTERY 预算内完成采样
+static tw_timer_t battery_timer;
+static bool battery_due = false;
+static uint32_t battery_due_ms = 0;
+
+static void battery_timer_cb(void *ctx)
+{
+    (void)ctx;
+    if (!battery_due) battery_due_ms = hal_get_tick_ms();
+    battery_due = true;
+}
+#endif
+
 static void read_battery(void)
 {
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+    if (!battery_due) return;
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE && defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+    // v0.6.3: 在 RF 空闲窗口采样, 端电压不含发射电流压降; 长时间等不到窗口时照常采样
+    if (rf_timing_get_idle_us() < FG_IDLE_MIN_US &&
+        (hal_get_tick_ms() - battery_due_ms) < FG_IDLE_WAIT_MS) {
+        return;
+    }
+#endif
+    battery_due = false;
+#else
     static uint32_t last_read = 0;
     if ((hal_get_tick_ms() - last_read) < 1000) return;
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE && defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+    // v0.6.3: 在 RF 空闲窗口采样, 端电压不含发射电流压降; 长时间等不到窗口时照常采样
+    if (rf_timing_get_idle_us() < FG_IDLE_MIN_US &&
+        (hal_get_tick_ms() - last_read) < 1000 + FG_IDLE_WAIT_MS) {
+        return;
+    }
+#endif
     last_read = hal_get_tick_ms();
+#endif
     
     // 读取 ADC
     uint16_t adc_val = 0;
@@ -748,6 +1519,14 @@ static void read_battery(void)
     adc_val = ADC_ExcutSingleConver();
 #endif
     
+    // 充电检测
+    is_charging = (hal_gpio_read(PIN_CHRG_DET) == 0);
+    
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE
+    // v0.6.3: 整数电量计 (放电曲线 + 内阻补偿, 负载取功耗估算)
+    fuel_gauge_update(adc_val, (uint16_t)power_optimizer_get_current(), is_charging);
+    battery_percent = fuel_gauge_get_percent();
+#else
     // 转换为电压 (按分压电阻与参考电压计算)
     const float divider_ratio = (VBAT_DIVIDER_R1_OHMS + VBAT_DIVIDER_R2_OHMS) / VBAT_DIVIDER_R2_OHMS;
     float voltage = (adc_val / 4096.0f) * ADC_REF_VOLTAGE * divider_ratio;
@@ -764,9 +1543,23 @@ static void read_battery(void)
         if (percent < 0.0f) percent = 0.0f;
         battery_percent = (uint8_t)percent;
     }
+#endif
     
-    // 充电检测
-    is_charging = (hal_gpio_read(PIN_CHRG_DET) == 0);
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+    // v0.6.3: 慢变化状态经数据包旁路发送, 不再单独占用时隙
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE
+    rf_sideband_set(RF_SB_FIELD_BATTERY_MV, fuel_gauge_get_raw_mv());
+#else
+    rf_sideband_set(RF_SB_FIELD_BATTERY_MV, (uint16_t)(voltage * 1000.0f));
+#endif
+    rf_sideband_set(RF_SB_FIELD_TEMP, (uint16_t)(int16_t)(temp_comp_get_temp() * 100.0f));
+    rf_sideband_set(RF_SB_FIELD_FW_VERSION, (FIRMWARE_VERSION_MAJOR << 8) | FIRMWARE_VERSION_MINOR);
+    rf_sideband_set(RF_SB_FIELD_IMU_TYPE, imu_get_type());
+#endif
+    
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_record_battery(battery_percent);
+#endif
     
     // v0.6.2: 更新功耗优化模块的电池状态
     power_optimizer_set_battery(battery_percent, is_charging);
@@ -781,6 +1574,9 @@ static void read_battery(void)
 // 静止检测计时器
 static uint32_t stationary_start_time = 0;
 static bool was_stationary = false;
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+static uint32_t last_motion_poll_ms = 0;
+#endif
 
 /**
  * @brief 配置IMU WOM中断用于深睡眠唤醒
@@ -788,10 +1584,15 @@ static bool was_stationary = false;
 static void configure_wom_wake(void)
 {
 #ifdef CH59X
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+    // v0.6.3: 显著运动/倾斜才唤醒, 不支持时 imu_motion_arm 自行退回阈值 WOM
+    imu_motion_arm(IMU_MOTION_SMD | IMU_MOTION_TILT, IMU_MOTION_WAKE_MG, true);
+#else
     // 配置IMU的WOM (Wake on Motion)中断
     // 阈值约 200mg，足够检测抬手动作
     imu_enable_wom(200);  // 需要IMU驱动支持
 #endif
+#endif
 }
 
 /**
@@ -799,12 +1600,38 @@ static void configure_wom_wake(void)
  */
 static void enter_deep_sleep(void)
 {
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+    wake_prof_sleep_begin();
+#endif
+    
     // v0.5.0: 保存当前状态用于快速恢复
+#ifdef FUSION_CKPT_SAVE
+    fusion_checkpoint_t ckpt;
+    FUSION_CKPT_SAVE(&vqf_state, &ckpt);
+    retained_save_fusion(&ckpt);
+#endif
     retained_save(quaternion, gyro_bias);
     retained_increment_sleep_count();
     
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+    // v0.6.3: 复位后用于快速重连
+    rf_link_snapshot_t link;
+    if (rf_transmitter_get_link(&rf_ctx, &link)) {
+        retained_save_link(&link);
+    }
+#endif
+    
+    // v0.6.3: 保持 RAM 由电池维持, 电量低时另存一份到 Flash
+    if (RETAINED_USE_SRAM && battery_percent < RETAINED_COMMIT_BATT_PCT) {
+        retained_commit();
+    }
+    
     enter_state(STATE_SLEEPING);
     
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+    imu_clock_sync_stop();  // WOM 使用内部振荡器
+#endif
+    
 #ifdef CH59X
     // 配置WOM唤醒
     configure_wom_wake();
@@ -816,35 +1643,170 @@ static void enter_deep_sleep(void)
     // 同时配置按键作为备用唤醒源
     gpio_config_input(PIN_SW0, GPIO_ModeIN_PU);
     
-    // 进入 Shutdown 模式 (最低功耗，复位唤醒)
-    LowPower_Shutdown(0);
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+    wake_prof_sleep_commit();
+#endif
+    
+    // 进入 Shutdown 模式 (最低功耗，复位唤醒; v0.6.3: 保持 RAM2K)
+    LowPower_Shutdown(RETAINED_SHUTDOWN_RM);
     
     // 不会执行到这里 - Shutdown会复位
 #endif
 }
 
+#if defined(CH59X) && defined(USE_WAKE_FIFO_CATCHUP) && USE_WAKE_FIFO_CATCHUP && \
+    defined(FUSION_CKPT_SAVE) && defined(FUSION_CKPT_LOAD)
+#define WAKE_FIFO_CATCHUP   1
+
+/**
+ * @brief v0.6.3: 把睡眠期间 FIFO 中的帧只做陀螺积分回放进融合器 (imu_resume 之前调用)
+ * @return 回放的帧数
+ */
+static uint16_t wake_fifo_catchup(void)
+{
+    float g[IMU_FIFO_MAX_BATCH][3], a[IMU_FIFO_MAX_BATCH][3];
+    const float dt = 1.0f / (float)IMU_SLEEP_FIFO_HZ;
+    uint16_t total = 0;
+    int n;
+#ifndef FUSION_PROPAGATE
+    float q[4];
+    FUSION_GET_QUAT(&vqf_state, q);
+#endif
+    
+    // 读取期间仍有新帧写入, 上限防止 FIFO 读不空时一直循环
+    while (total < 2 * IMU_SLEEP_FIFO_FRAMES &&
+           (n = imu_fifo_read(g, a, NULL, IMU_FIFO_MAX_BATCH)) > 0) {
+        for (int i = 0; i < n; i++) {
+#ifdef FUSION_PROPAGATE
+            FUSION_PROPAGATE(&vqf_state, g[i], dt);
+#else
+            // 引擎没有只积分的入口: 在本地四元数上积分, 最后写回
+            float phi[3] = { g[i][0] * dt, g[i][1] * dt, g[i][2] * dt };
+            float dq[4], r[4];
+            fm_rotvec_to_quat(phi, dq);
+            r[0] = q[0] * dq[0] - q[1] * dq[1] - q[2] * dq[2] - q[3] * dq[3];
+            r[1] = q[0] * dq[1] + q[1] * dq[0] + q[2] * dq[3] - q[3] * dq[2];
+            r[2] = q[0] * dq[2] - q[1] * dq[3] + q[2] * dq[0] + q[3] * dq[1];
+            r[3] = q[0] * dq[3] + q[1] * dq[2] - q[2] * dq[1] + q[3] * dq[0];
+            fm_quat_renorm(r);
+            memcpy(q, r, sizeof(q));
+#endif
+        }
+        total += (uint16_t)n;
+    }
+    
+#ifndef FUSION_PROPAGATE
+    if (total > 0) {
+        FUSION_SET_QUAT(&vqf_state, q);
+    }
+#endif
+    imu_sleep_fifo_stop();
+    return total;
+}
+#endif
+
 /**
  * @brief 进入轻度睡眠 (未配对/未同步时使用)
  */
 static void enter_light_sleep(void)
 {
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+    // v0.6.3: Halt 保持 RAM, 快照留在栈上即可
+    rf_link_snapshot_t link;
+    bool have_link = rf_transmitter_get_link(&rf_ctx, &link);
+#endif
+    
     enter_state(STATE_SLEEPING);
     
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+    imu_clock_sync_stop();
+#endif
+    
 #ifdef CH59X
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE && defined(FUSION_CKPT_SAVE) && defined(FUSION_CKPT_LOAD)
+    // v0.6.3: Halt 保持 RAM, 唤醒后载入检查点, 不必重新收敛
+    fusion_checkpoint_t ckpt;
+    FUSION_CKPT_SAVE(&vqf_state, &ckpt);
+#endif
+    
     // 配置唤醒源 (按键)
     gpio_config_input(PIN_SW0, GPIO_ModeIN_PU);
     gpio_config_interrupt(PIN_SW0, GPIO_ITMode_FallEdge);
     
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+    // v0.6.3: 轻度睡眠也由 IMU 运动事件唤醒 (原来只有按键)
+    bool imu_wake = (imu_motion_arm(IMU_MOTION_SMD | IMU_MOTION_TILT, IMU_MOTION_WAKE_MG, true) > 0);
+    if (imu_wake) {
+        gpio_config_interrupt(PIN_IMU_INT1, GPIO_ITMode_RiseEdge);
+    }
+#endif
+#if WAKE_FIFO_CATCHUP
+    // v0.6.3: 睡眠期间陀螺继续写 FIFO, 唤醒后回放 (不支持的 IMU 照旧从检查点恢复)
+    bool sleep_fifo = (imu_sleep_fifo_start() == 0);
+#endif
+    
     // 进入 Halt 模式 (可快速唤醒)
     LowPower_Halt(0);
     
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+    // 复位 IMU 前记下唤醒原因 (0 = 按键)
+    if (imu_wake) {
+        event_log_u8(EVT_WOM_TRIGGER, imu_motion_get_events());
+    }
+#endif
+    
     // 唤醒后重新初始化
     gpio_disable_interrupt(PIN_SW0);
     hal_timer_init();
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+    wake_prof_start(WAKE_FROM_LIGHT);
+#endif
+#if defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ
+    hal_button_resume();
+#endif
+    WAKE_MARK(WAKE_PH_HAL);
+#if WAKE_FIFO_CATCHUP
+    // imu_resume 会复位 FIFO: 先回放 (融合器状态在 Halt 中保持), 结果并入检查点
+    if (sleep_fifo) {
+        uint16_t frames = wake_fifo_catchup();
+        event_log_u8(EVT_WAKE_FIFO_REPLAY, (frames > 0xFF) ? 0xFF : (uint8_t)frames);
+        FUSION_CKPT_SAVE(&vqf_state, &ckpt);
+    }
+#endif
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE
+    // v0.6.3: Halt 不断电, 型号/总线/预处理参数仍有效, 只重新配置 (退出 WOM/运动引擎)
+    imu_resume();
+#else
     imu_init();
-    FUSION_INIT(&vqf_state, SENSOR_ODR_HZ);
+#endif
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    aux_imu_start();
+#endif
+#if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+    imu_clock_sync_init();
+#endif
+    WAKE_MARK(WAKE_PH_IMU);
+    FUSION_INIT(&vqf_state, FUSION_INIT_HZ);
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE && defined(FUSION_CKPT_SAVE) && defined(FUSION_CKPT_LOAD)
+    FUSION_CKPT_LOAD(&vqf_state, &ckpt);
+#endif
+#if FUSION_PREINT
+    gyro_preint_reset();
+    fusion_correct_count = 0;
+#endif
+    WAKE_MARK(WAKE_PH_RESTORE);
     
     enter_state(is_paired ? STATE_SEARCH_SYNC : STATE_INIT);
+    
+    if (is_paired) {
+        // RF 可能在睡眠前被置为 TX_STATE_SLEEP, 重新开始搜索
+        rf_transmitter_wake(&rf_ctx);
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+        if (have_link) {
+            rf_transmitter_resume_link(&rf_ctx, &link);
+        }
+#endif
+    }
 #endif
 }
 
@@ -857,9 +1819,20 @@ static void enter_light_sleep(void)
  */
 static void enter_sleep_mode(void)
 {
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_record_sleep();
+    telem_flush();
+#endif
+    
+    // v0.6.3: RF 已停止, 写完后台待写数据
+    hal_storage_flush();
+    
     if (!is_paired || sync_lost_count > SYNC_LOST_THRESHOLD) {
         // 未配对或失去同步: 使用轻度睡眠
         enter_light_sleep();
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+        telem_record_wake();
+#endif
     } else {
         // 已配对且同步正常: 可以深睡眠
         enter_deep_sleep();
@@ -871,19 +1844,43 @@ static void enter_sleep_mode(void)
  */
 static void check_sleep_condition(void)
 {
+#if defined(USE_SELFTEST) && USE_SELFTEST
+    // v0.6.3: 特性测量要求静置, 期间不计入静止超时
+    if (selftest_running()) {
+        was_stationary = false;
+        return;
+    }
+#endif
     // 检查静止状态
-    bool is_stationary = gyro_filter_is_stationary();
+    bool is_stationary = motion_state_is_rest();  // v0.6.3: 共享运动状态
     uint32_t now = hal_get_tick_ms();
     
     if (is_stationary && !was_stationary) {
         // 刚进入静止状态
         stationary_start_time = now;
         was_stationary = true;
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+        // v0.6.3: 以当前姿态为基准, 由 IMU WOM 复核整个静止计时
+        imu_motion_arm(IMU_MOTION_WOM, IMU_MOTION_STILL_MG, false);
+        last_motion_poll_ms = now;
+#endif
     } else if (!is_stationary) {
         // 运动中
         was_stationary = false;
         stationary_start_time = 0;
     }
+#if defined(USE_IMU_MOTION_ENGINE) && USE_IMU_MOTION_ENGINE
+    else if ((now - last_motion_poll_ms) >= IMU_MOTION_POLL_MS) {
+        // 缓慢转动 (低于 MCU 静止阈值, 如佩戴中坐着不动) 累计超过阈值: 重新计时并换基准
+        last_motion_poll_ms = now;
+        uint8_t ev = imu_motion_get_events();
+        if (ev) {
+            power_motion_event(ev);
+            stationary_start_time = now;
+            imu_motion_arm(IMU_MOTION_WOM, IMU_MOTION_STILL_MG, false);
+        }
+    }
+#endif
     
     // 检查静止超时
     if (was_stationary && AUTO_SLEEP_TIMEOUT_MS > 0) {
@@ -902,6 +1899,9 @@ static void handle_wake_from_sleep(void)
 {
     // 增加唤醒计数
     retained_increment_wake_count();
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_record_wake();
+#endif
     
     // 尝试恢复保存的状态
     float saved_quat[4], saved_bias[3];
@@ -914,6 +1914,15 @@ static void handle_wake_from_sleep(void)
         
         // 用保存的四元数初始化融合算法
         FUSION_SET_QUAT(&vqf_state, saved_quat);
+        
+#ifdef FUSION_CKPT_LOAD
+        // v0.6.3: 检查点同时恢复偏差/协方差/静止状态, 唤醒后不需要重新收敛;
+        // 无检查点或版本不符时保留上面只恢复姿态的结果
+        fusion_checkpoint_t ckpt;
+        if (retained_restore_fusion(&ckpt) >= 0) {
+            FUSION_CKPT_LOAD(&vqf_state, &ckpt);
+        }
+#endif
     }
     
     // 重置静止检测
@@ -926,6 +1935,101 @@ static void handle_wake_from_sleep(void)
  * 如需处理特定GPIO中断，使用 hal_gpio_set_interrupt() 设置回调
  *============================================================================*/
 
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+// v0.6.3: 事件驱动主循环
+// 中断只投递事件, 处理都在主循环; 没有事件时 WFI
+// (1ms 系统节拍仍会唤醒内核, 周期性任务由它驱动)
+
+// 提前于下一个同步信标唤醒, 留出 RX 启动和 rf_transmitter_process 内部同步窗口
+#define EVQ_RF_WAKE_ADVANCE_US  300
+
+static bool rf_wake_armed = false;
+
+static void evq_imu_isr(void)
+{
+    evq_post(EVQ_IMU_DATA);
+}
+
+static void evq_button_isr(void)
+{
+    evq_post(EVQ_BUTTON);
+}
+
+static void evq_rf_timer_isr(void)
+{
+    rf_hw_stop_timer();     // 单次
+    evq_post(EVQ_RF_FRAME);
+}
+
+// 在下一个超帧信标前 EVQ_RF_WAKE_ADVANCE_US 投递 EVQ_RF_FRAME
+static void evq_arm_rf_wakeup(void)
+{
+    uint32_t elapsed = rf_hw_get_time_us() - rf_ctx.sync_time_us;
+    uint32_t target = RF_FRAME_US - EVQ_RF_WAKE_ADVANCE_US;
+    
+    if (elapsed + 50 >= target) {
+        // 已经来不及定时 (或丢了信标), 直接处理
+        evq_post(EVQ_RF_FRAME);
+    } else {
+        rf_hw_start_timer(target - elapsed, evq_rf_timer_isr);
+    }
+    rf_wake_armed = true;
+}
+#endif
+
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+/*============================================================================
+ * v0.6.3: USB 有线数据流
+ * 主机请求后 RF 休眠 (不再发送, 接收器上该 tracker 超时离线, 时隙降速),
+ * 姿态逐样本经 USB 发送; 停止/拔出后重新搜索同步
+ *============================================================================*/
+
+static void wired_update(void)
+{
+    bool active = usb_debug_wired_active();
+    
+    if (active && (state == STATE_RUNNING || state == STATE_SEARCH_SYNC)) {
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+        rf_hw_stop_timer();
+        rf_wake_armed = false;
+#endif
+        rf_transmitter_sleep(&rf_ctx);
+        enter_state(STATE_WIRED);
+        LOG_INFO("USB wired stream");
+    } else if (!active && state == STATE_WIRED) {
+        rf_transmitter_wake(&rf_ctx);
+        enter_state(STATE_SEARCH_SYNC);
+    }
+}
+#endif
+
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+/*============================================================================
+ * v0.6.3: BLE 配置通道 (TDMA 时隙之间的空闲时间)
+ *============================================================================*/
+
+static void ble_command_handler(uint8_t cmd, const uint8_t *data, uint8_t len)
+{
+    (void)data;
+    (void)len;
+    
+    switch (cmd) {
+        case BLE_CMD_CALIBRATE_GYRO:
+            if (state == STATE_RUNNING) {
+                start_calibration();
+            }
+            break;
+            
+        case BLE_CMD_RESET:
+            hal_reset();
+            break;
+            
+        default:
+            break;
+    }
+}
+#endif
+
 /*============================================================================
  * 主函数
  *============================================================================*/
@@ -956,6 +2060,10 @@ int main(void)
     
     // v0.5.0: 初始化retained state模块
     retained_init();
+#if defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+    wake_prof_start(retained_is_valid() ? WAKE_FROM_DEEP : WAKE_FROM_COLD);
+#endif
+    WAKE_MARK(WAKE_PH_HAL);
     
     // v0.6.2: 初始化陀螺仪滤波器 (用于静止检测)
     // 必须在IMU初始化之前调用
@@ -969,6 +2077,7 @@ int main(void)
         .measurement_noise = 0.01f
     };
     gyro_filter_init(&gyro_cfg);
+    motion_state_init();
     
     // v0.6.2: 初始化自动校准模块 (运动中校准陀螺仪偏移)
     auto_calib_init();
@@ -979,6 +2088,9 @@ int main(void)
     // v0.6.2: 初始化功耗优化模块 (动态时钟/睡眠调度)
     power_optimizer_init();
     power_optimizer_set_auto_sleep(true, AUTO_SLEEP_TIMEOUT_MS);
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE
+    fuel_gauge_init();
+#endif
     
     // v0.6.2: 初始化DMA传感器模块 (可选，提高传感器读取效率)
     // 注意: 如果使用DMA模式，需要确保IMU的INT1引脚已正确配置
@@ -999,6 +2111,14 @@ int main(void)
     LOG_INFO("Diagnostics enabled");
     #endif
     
+    // v0.6.3: 跨重启遥测汇总 (深睡眠唤醒继续上一会话)
+    #if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_init(retained_is_valid());
+    #endif
+    #if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_init();
+    #endif
+    
     // v0.6.2: 初始化智能信道管理模块 (CCA检测+自动避让)
     #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
     ch_mgr_init(&ch_manager);
@@ -1020,6 +2140,7 @@ int main(void)
     // v0.6.2: 初始化时序优化模块 (精确同步+延迟补偿)
     #if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
     rf_timing_init();
+    hal_storage_set_window_cb(rf_timing_get_idle_us);   // v0.6.3: Flash 擦写避开时隙
     LOG_INFO("RF Timing Opt enabled");
     #endif
     
@@ -1035,8 +2156,24 @@ int main(void)
     LOG_INFO("Sensor Optimized enabled");
     #endif
     
+    // v0.6.3: 辅助 IMU 在主 IMU 的 FIFO 使能后检测 (沿用同一水位)
+    #if defined(USE_AUX_IMU) && USE_AUX_IMU
+    aux_imu_start();
+    #endif
+    
+    // v0.6.3: IMU CLKIN 相位锁定 (IMU 不支持 CLKIN 时保持内部时钟)
+    #if defined(USE_IMU_CLOCK_SYNC) && USE_IMU_CLOCK_SYNC
+    if (imu_clock_sync_init() == 0) {
+        LOG_INFO("IMU clock sync enabled");
+    }
+    #endif
+    
     // v0.6.2: 初始化USB大容量存储模块 (UF2拖放升级)
-    #if defined(USE_USB_MSC) && USE_USB_MSC
+    // v0.6.3: 有线数据流以 HID 枚举, MSC 在进入更新模式时接管
+    #if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+    usb_hid_init();
+    LOG_INFO("USB HID enabled");
+    #elif defined(USE_USB_MSC) && USE_USB_MSC
     usb_msc_init();
     LOG_INFO("USB MSC enabled");
     #endif
@@ -1049,24 +2186,60 @@ int main(void)
     }
     #endif
     
+    WAKE_MARK(WAKE_PH_MODULES);
+    
     // GPIO 初始化
     hal_gpio_config(PIN_LED, HAL_GPIO_OUTPUT);
     hal_gpio_config(PIN_SW0, HAL_GPIO_INPUT_PULLUP);
     hal_gpio_config(PIN_CHRG_DET, HAL_GPIO_INPUT_PULLUP);
     
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+    // v0.6.3: 中断 -> 事件 (INT1 可挂多个回调, 与 sensor_optimized 共存)
+    evq_init();
+    hal_gpio_set_interrupt(PIN_IMU_INT1, HAL_GPIO_INT_RISING, evq_imu_isr);
+#if !(defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ)
+    hal_gpio_set_interrupt(PIN_SW0, HAL_GPIO_INT_FALLING, evq_button_isr);
+#endif
+#endif
+    
+#if defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ
+    // v0.6.3: 去抖和手势计时都在中断里, 识别结果通知事件循环
+    static const hal_button_config_t btn_cfg = {
+        .debounce_ms = BTN_DEBOUNCE_MS,
+        .long_press_ms = BTN_LONG_PRESS_MS,
+        .double_click_ms = BTN_DOUBLE_CLICK_MS,
+    };
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+    hal_button_init(PIN_SW0, &btn_cfg, evq_button_isr);
+#else
+    hal_button_init(PIN_SW0, &btn_cfg, NULL);
+#endif
+#endif
+    
     // 启动闪烁 (版本指示)
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE
+    // v0.6.3: 深睡眠唤醒不闪 (600ms 阻塞是唤醒耗时的大头)
+    if (!retained_is_valid())
+#endif
     for (int i = 0; i < 3; i++) {
         hal_gpio_write(PIN_LED, true);
         hal_delay_ms(100);
         hal_gpio_write(PIN_LED, false);
         hal_delay_ms(100);
     }
+#if defined(USE_LED_PATTERN) && USE_LED_PATTERN
+    hal_led_init(PIN_LED);
+#endif
+    WAKE_MARK(WAKE_PH_GPIO);
     
     // 获取 MAC 地址
 #ifdef CH59X
     GetMACAddress(mac_address);
 #endif
     
+    // v0.6.3: IMU 检测并开始上传配置 (BMI270 约 8KB, DMA 后台进行), 与下面的 RF/融合/配对加载重叠
+    int imu_ret = imu_init_start();
+    
     // 初始化 Bootloader
     bootloader_init();
     
@@ -1076,15 +2249,24 @@ int main(void)
         error_code = ERR_RF_INIT;
         enter_state(STATE_ERROR);
     }
+#if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING
+    rf_transmitter_set_pre_tx_callback(jit_pre_tx);
+#endif
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+    rf_arbiter_init();
+    ble_slimevr_init();
+    ble_slimevr_set_command_callback(ble_command_handler);
+    ble_slimevr_start_advertising();
+#endif
     
-    // 初始化 IMU
-    if (imu_init() != 0) {
-        error_code = ERR_IMU_NOT_FOUND;
-        enter_state(STATE_ERROR);
-    }
+    WAKE_MARK(WAKE_PH_RF);
     
     // 初始化融合算法 (v0.6.2: 默认VQF Advanced)
-    FUSION_INIT(&vqf_state, SENSOR_ODR_HZ);
+    FUSION_INIT(&vqf_state, FUSION_INIT_HZ);
+#if FUSION_PREINT
+    gyro_preint_reset();
+    fusion_correct_count = 0;
+#endif
     
     // v0.5.0: 检查是否从睡眠唤醒，尝试恢复状态
     if (retained_is_valid()) {
@@ -1093,6 +2275,18 @@ int main(void)
     
     // 加载配对数据
     is_paired = load_pairing_data();
+    sensor_preproc_update();    // 偏置已从唤醒状态/配对数据恢复
+    WAKE_MARK(WAKE_PH_RESTORE);
+    
+    // 完成 IMU 初始化 (等待配置上传和 init_ok, 写 ODR/量程)
+    if (imu_ret == 0) {
+        imu_ret = imu_init_finish();
+    }
+    WAKE_MARK(WAKE_PH_IMU);
+    if (imu_ret != 0) {
+        error_code = ERR_IMU_NOT_FOUND;
+        enter_state(STATE_ERROR);
+    }
     
     // 如果已配对，更新RF上下文
     if (is_paired) {
@@ -1101,6 +2295,15 @@ int main(void)
         memcpy(&rf_ctx.network_key, network_key, 4);
         rf_transmitter_start(&rf_ctx);  // 开始搜索同步
         enter_state(STATE_SEARCH_SYNC);
+        
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+        // v0.6.3: 从深睡眠复位, 按保存的链路快照预测信道
+        // (enter_state 会切信道, 需在其后调用)
+        rf_link_snapshot_t link;
+        if (retained_restore_link(&link) == 0) {
+            rf_transmitter_resume_link(&rf_ctx, &link);
+        }
+#endif
     } else {
         enter_state(STATE_PAIRING);
     }
@@ -1110,11 +2313,28 @@ int main(void)
     ADC_BatteryInit();  // 使用SDK提供的电池ADC初始化函数
 #endif
     
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+    tw_init();
+    tw_timer_init(&battery_timer, battery_timer_cb, NULL);
+    tw_start(&battery_timer, 1000, 1000);
+#endif
+    
     // 主循环
     while (1) {
         // v0.6.2: 喂狗 (防止看门狗复位)
         wdog_feed();
         CHECKPOINT(CP_MAIN_LOOP_START);
+        PROF_BEGIN(PROF_MAIN_LOOP);
+        TASK_LOOP_START();
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+        telem_process();
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+        soak_process();
+#endif
+#if defined(USE_TIMER_WHEEL) && USE_TIMER_WHEEL
+        tw_process();
+#endif
         
         // 错误状态
         if (state == STATE_ERROR) {
@@ -1137,24 +2357,54 @@ int main(void)
             continue;
         }
         
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+        // v0.6.3: 取出本次唤醒期间累积的事件
+        uint8_t events = 0;
+        evq_event_t evt;
+        while ((evt = evq_get()) != EVQ_NONE) {
+            events |= EVQ_BIT(evt);
+        }
+#endif
+        
+#if defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+        wired_update();
+#endif
+        
         // 传感器任务
         CHECKPOINT(CP_MAIN_LOOP_IMU);
+        TASK_BEGIN(TASK_SENSOR);
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP && \
+    defined(USE_SENSOR_OPTIMIZED) && USE_SENSOR_OPTIMIZED && \
+    defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH
+        // 批量模式只在水位中断后读 FIFO; 其他读取模式仍按周期节拍
+        if (events & EVQ_BIT(EVQ_IMU_DATA)) {
+            sensor_task();
+        }
+#else
         sensor_task();
+#endif
         CHECKPOINT(CP_MAIN_LOOP_FUSION);
         
         // 更新RF发送器的传感器数据
-        // 先计算flags，再传入函数
-        bool is_stationary = gyro_filter_is_stationary();  // v0.4.24
-        uint8_t rf_flags = (is_charging ? RF_FLAG_CHARGING : 0) |
-                           (battery_percent < 20 ? RF_FLAG_LOW_BATTERY : 0) |
-                           (state == STATE_CALIBRATING ? RF_FLAG_CALIBRATING : 0) |
-                           (is_stationary ? RF_FLAG_STATIONARY : 0);  // v0.4.24
-        rf_transmitter_set_data(&rf_ctx, quaternion, accel_linear, battery_percent, rf_flags);
+        update_rf_data();
+        TASK_END(TASK_SENSOR);
         
         // RF 任务 - 使用模块化处理
         CHECKPOINT(CP_MAIN_LOOP_RF);
-        if (state == STATE_RUNNING || state == STATE_SEARCH_SYNC) {
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+        // v0.6.3: 同步后只在帧定时事件到来时处理 RF, 其余时间留给 WFI
+        // 搜索同步阶段仍每次唤醒都处理
+        bool rf_due = (state != STATE_RUNNING) || !rf_wake_armed ||
+                      (events & EVQ_BIT(EVQ_RF_FRAME));
+#else
+        bool rf_due = true;
+#endif
+        if ((state == STATE_RUNNING || state == STATE_SEARCH_SYNC) && rf_due) {
+            PROF_BEGIN(PROF_RF_TASK);
+            TASK_BEGIN(TASK_RF);
             rf_transmitter_process(&rf_ctx);
+            TASK_END(TASK_RF);
+            PROF_END(PROF_RF_TASK);
             
             // 检查RF状态并同步本地状态
             if (rf_ctx.state == TX_STATE_RUNNING && state == STATE_SEARCH_SYNC) {
@@ -1162,6 +2412,15 @@ int main(void)
             } else if (rf_ctx.state == TX_STATE_SEARCHING && state == STATE_RUNNING) {
                 enter_state(STATE_SEARCH_SYNC);
             }
+            
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+            if (state == STATE_RUNNING && rf_ctx.state == TX_STATE_RUNNING) {
+                evq_arm_rf_wakeup();
+            } else {
+                rf_hw_stop_timer();
+                rf_wake_armed = false;
+            }
+#endif
         } else if (state == STATE_PAIRING) {
             // 配对模式 - 使用rf_transmitter的配对功能
             static bool pairing_requested = false;
@@ -1182,21 +2441,59 @@ int main(void)
             }
         }
         
+        // v0.6.3: 后台 Flash 写入, 在 RF 任务之后的空闲窗口内执行
+        TASK_BEGIN(TASK_STORAGE);
+        hal_storage_process();
+        TASK_END(TASK_STORAGE);
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        // v0.6.3: 广播固件块写入 OTA 分区 (按扇区延迟擦除)
+        rf_ota_task();
+#endif
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+        // v0.6.3: BLE 只在本帧 TDMA 时隙之后、下一信标保护时间之前处理
+        ble_slimevr_process();
+#endif
+        
+        // v0.6.3: 加速度计椭球校准每次求解一步, 不在样本路径上
+        auto_calib_process();
+#if defined(USE_MAGNETOMETER) && USE_MAGNETOMETER
+        mag_calib_process();
+#endif
+        
         // 按键处理
         bool single1, double1, long1;
         bool single2, double2, long2;
         
+#if defined(USE_BUTTON_IRQ) && USE_BUTTON_IRQ
+        // v0.6.3: 手势已在中断中识别, 这里只取结果 (无事件时仅读一个字节)
+        uint8_t btn_events = hal_button_take_events();
+        single1 = (btn_events & HAL_BTN_SINGLE) != 0;
+        double1 = (btn_events & HAL_BTN_DOUBLE) != 0;
+        long1 = (btn_events & HAL_BTN_LONG) != 0;
+#elif defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+        // 空闲时只在按键边沿后进入状态机, 状态机运行中 (去抖/长按计时) 每次唤醒都处理
+        if ((events & EVQ_BIT(EVQ_BUTTON)) || btn_main.state != 0) {
+            process_button(&btn_main, PIN_SW0, &single1, &double1, &long1);
+        } else {
+            single1 = double1 = long1 = false;
+        }
+#else
         process_button(&btn_main, PIN_SW0, &single1, &double1, &long1);
+#endif
         
         // 长按: 进入睡眠
         if (long1) {
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+            rf_hw_stop_timer();
+            rf_wake_armed = false;
+#endif
             rf_transmitter_sleep(&rf_ctx);
             enter_sleep_mode();
         }
         
         // 双击: 进入配对 / 校准
         if (double1) {
-            if (state == STATE_RUNNING) {
+            if (state == STATE_RUNNING || state == STATE_WIRED) {
                 start_calibration();
             } else if (state != STATE_PAIRING) {
                 enter_state(STATE_PAIRING);
@@ -1204,12 +2501,19 @@ int main(void)
         }
         
         // 单击: (保留)
+        (void)single1;
         
-        // LED 更新
-        update_led();
-        
-        // 电池检测
-        read_battery();
+        // LED 更新 / 电池检测 (v0.6.3: 卸载模式下迭代迟到时跳过)
+        if (TASK_SHOULD_RUN(TASK_LED)) {
+            TASK_BEGIN(TASK_LED);
+            update_led();
+            TASK_END(TASK_LED);
+        }
+        if (TASK_SHOULD_RUN(TASK_BATTERY)) {
+            TASK_BEGIN(TASK_BATTERY);
+            read_battery();
+            TASK_END(TASK_BATTERY);
+        }
         
         // v0.4.24: 检查是否应该进入睡眠 (静止超时)
         if (state == STATE_RUNNING) {
@@ -1218,7 +2522,11 @@ int main(void)
         
         // v0.6.2: USB调试处理 (处理调试命令和数据流)
         #if defined(USE_USB_DEBUG) && USE_USB_DEBUG
+        PROF_BEGIN(PROF_USB_TASK);
+        TASK_BEGIN(TASK_USB);
         usb_debug_process();
+        TASK_END(TASK_USB);
+        PROF_END(PROF_USB_TASK);
         #endif
         
         // v0.6.2: 诊断统计周期性更新
@@ -1238,9 +2546,18 @@ int main(void)
         
         // v0.6.2: 主循环结束检查点
         CHECKPOINT(CP_MAIN_LOOP_END);
+        PROF_END(PROF_MAIN_LOOP);
+#if defined(USE_CLOCK_GOVERNOR) && USE_CLOCK_GOVERNOR
+        power_governor_update();
+#endif
         
+#if defined(USE_EVENT_LOOP) && USE_EVENT_LOOP
+        // v0.6.3: 无事件时 WFI 等待下一个中断
+        evq_wait();
+#else
         // 短延时
         hal_delay_us(100);
+#endif
     }
     
     return 0;
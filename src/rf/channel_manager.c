@@ -8,8 +8,13 @@
 #include "event_logger.h"
 #include <string.h>
 
-// v0.6.2: 黑名单恢复超时
-#define CH_BLACKLIST_RECOVERY_MS    30000   // 30秒后尝试恢复
+// v0.6.3: 唯一的信道统计实例
+channel_manager_t ch_manager;
+
+// RSSI 评分阈值
+#define CH_RSSI_GOOD            -60
+#define CH_RSSI_FAIR            -75
+#define CH_RSSI_POOR            -85
 
 /*============================================================================
  * 默认跳频序列
@@ -36,12 +41,12 @@ void ch_mgr_init(channel_manager_t *mgr)
     
     memset(mgr, 0, sizeof(channel_manager_t));
     
+    for (uint8_t i = 0; i < RF_CHANNEL_COUNT; i++) {
+        mgr->channels[i].avg_rssi = CH_RSSI_UNKNOWN;
+    }
+    
     // 初始化所有信道为活跃
     for (uint8_t i = 0; i < RF_CHANNEL_COUNT && i < DEFAULT_HOP_COUNT; i++) {
-        mgr->channels[i].blacklisted = false;
-        mgr->channels[i].loss_rate_pct = 0;
-        mgr->channels[i].avg_rssi = -50;  // 默认中等RSSI
-        
         mgr->active_channels[i] = default_hop_sequence[i];
     }
     mgr->active_count = DEFAULT_HOP_COUNT;
@@ -59,91 +64,129 @@ void ch_mgr_record_tx(channel_manager_t *mgr, uint8_t channel, bool ack_received
     
     channel_quality_t *ch = &mgr->channels[channel];
     
+    // 8位计数饱和时同比减半, 保持丢包率不变
+    if (ch->tx_count == 0xFF) {
+        ch->tx_count >>= 1;
+        ch->ack_count >>= 1;
+    }
     ch->tx_count++;
     if (ack_received) {
         ch->ack_count++;
     }
     
-    // RSSI统计
-    ch->rssi_sum += rssi;
-    ch->rssi_samples++;
+    // RSSI 指数平均 (1/8)
+    if (rssi != CH_RSSI_UNKNOWN) {
+        if (ch->avg_rssi == CH_RSSI_UNKNOWN) {
+            ch->avg_rssi = rssi;
+        } else {
+            ch->avg_rssi = (int8_t)((ch->avg_rssi * 7 + rssi) / 8);
+        }
+    }
 }
 
 void ch_mgr_record_crc_error(channel_manager_t *mgr, uint8_t channel)
 {
     if (!mgr || channel >= RF_CHANNEL_COUNT) return;
-    mgr->channels[channel].crc_errors++;
+    channel_quality_t *ch = &mgr->channels[channel];
+    if (ch->crc_errors < 15) ch->crc_errors++;
+}
+
+void ch_mgr_record_rssi_scan(channel_manager_t *mgr, uint8_t channel, int8_t rssi)
+{
+    if (!mgr || channel >= RF_CHANNEL_COUNT) return;
+    channel_quality_t *ch = &mgr->channels[channel];
+    
+    if (ch->cca_samples == 0xFF) {
+        ch->cca_samples >>= 1;
+        ch->cca_busy >>= 1;
+    }
+    ch->cca_samples++;
+    if (rssi >= CH_CCA_BUSY_DBM) {
+        ch->cca_busy++;
+    }
+}
+
+static bool cca_busy(const channel_quality_t *ch, uint8_t pct)
+{
+    if (ch->cca_samples < CH_CCA_MIN_SAMPLES) return false;
+    return (uint16_t)ch->cca_busy * 100 > (uint16_t)ch->cca_samples * pct;
+}
+
+static void blacklist_channel(channel_manager_t *mgr, uint8_t channel)
+{
+    channel_quality_t *ch = &mgr->channels[channel];
+    ch->blacklisted = true;
+    ch->blacklist_sec = CH_BLACKLIST_RECOVERY_SEC;
+    ch->recovery_count = 0;
+    mgr->active_count--;
+    
+    // 记录事件
+    event_log_u8(EVT_RF_BLACKLIST, channel);
 }
 
 /*============================================================================
  * 周期更新
  *============================================================================*/
 
-void ch_mgr_periodic_update(channel_manager_t *mgr)
+bool ch_mgr_periodic_update(channel_manager_t *mgr)
 {
-    if (!mgr) return;
+    if (!mgr) return false;
     
     uint32_t now = hal_get_tick_ms();
     if ((now - mgr->last_update_ms) < CH_QUALITY_UPDATE_MS) {
-        return;  // 未到更新时间
+        return false;  // 未到更新时间
     }
     mgr->last_update_ms = now;
     
-    uint8_t blacklist_count = 0;
+    bool changed = false;
     
     // 更新每个信道的质量
     for (uint8_t i = 0; i < RF_CHANNEL_COUNT; i++) {
         channel_quality_t *ch = &mgr->channels[i];
+        bool fresh = (ch->tx_count > 0);
         
-        if (ch->tx_count > 0) {
+        if (fresh) {
             // 计算丢包率
-            uint32_t lost = ch->tx_count - ch->ack_count;
+            uint16_t lost = ch->tx_count - ch->ack_count;
             ch->loss_rate_pct = (uint8_t)((lost * 100) / ch->tx_count);
         }
         
-        if (ch->rssi_samples > 0) {
-            // 计算平均RSSI
-            ch->avg_rssi = (int8_t)(ch->rssi_sum / (int16_t)ch->rssi_samples);
-        }
-        
-        // 黑名单判定
-        if (!ch->blacklisted && ch->loss_rate_pct > CH_BLACKLIST_THRESHOLD) {
+        // 黑名单判定 (丢包率, 或空闲扫描发现持续干扰)
+        if (!ch->blacklisted &&
+            (ch->loss_rate_pct > CH_BLACKLIST_THRESHOLD || cca_busy(ch, CH_CCA_BUSY_PCT))) {
             // 检查是否还有足够的活跃信道
             if (mgr->active_count > CH_MIN_ACTIVE_CHANNELS) {
-                ch->blacklisted = true;
-                ch->blacklist_time = now;
-                ch->recovery_count = 0;
-                
-                // 记录事件
-                event_log_u8(EVT_RF_BLACKLIST, i);
+                blacklist_channel(mgr, i);
+                changed = true;
             }
-        }
-        
-        // 恢复判定 (黑名单超时后尝试恢复)
-        if (ch->blacklisted && (now - ch->blacklist_time) > CH_BLACKLIST_RECOVERY_MS) {
-            if (ch->loss_rate_pct < CH_RECOVERY_THRESHOLD) {
+        } else if (ch->blacklisted && ch->blacklist_sec > 0) {
+            ch->blacklist_sec--;
+        } else if (ch->blacklisted) {
+            // 恢复判定 (黑名单到期后重新评估)
+            // 禁用期间没有新样本时直接试用, 否则按丢包率决定; 扫描仍忙则继续禁用
+            if ((!fresh || ch->loss_rate_pct < CH_RECOVERY_THRESHOLD) &&
+                !cca_busy(ch, CH_CCA_BUSY_PCT / 2)) {
                 ch->blacklisted = false;
+                ch->loss_rate_pct = 0;
+                changed = true;
             } else {
                 // 重置黑名单计时，继续禁用
-                ch->blacklist_time = now;
-                ch->recovery_count++;
+                ch->blacklist_sec = CH_BLACKLIST_RECOVERY_SEC;
+                if (ch->recovery_count < 15) ch->recovery_count++;
             }
         }
         
-        if (ch->blacklisted) {
-            blacklist_count++;
-        }
-        
         // 重置窗口统计 (部分衰减，保留历史趋势)
         ch->tx_count = ch->tx_count / 2;
         ch->ack_count = ch->ack_count / 2;
         ch->crc_errors = ch->crc_errors / 2;
-        ch->rssi_sum = ch->rssi_sum / 2;
-        ch->rssi_samples = ch->rssi_samples / 2;
+        ch->cca_samples = ch->cca_samples / 2;
+        ch->cca_busy = ch->cca_busy / 2;
     }
     
     // 刷新活跃信道列表
     ch_mgr_refresh_hop_sequence(mgr);
+    return changed;
 }
 
 /*============================================================================
@@ -205,13 +248,67 @@ bool ch_mgr_is_blacklisted(channel_manager_t *mgr, uint8_t channel)
     return mgr->channels[channel].blacklisted;
 }
 
+void ch_mgr_export_blacklist(channel_manager_t *mgr, uint8_t *bitmap, uint8_t len)
+{
+    if (!mgr || !bitmap) return;
+    
+    memset(bitmap, 0, len);
+    for (uint8_t i = 0; i < RF_CHANNEL_COUNT && (i / 8) < len; i++) {
+        if (mgr->channels[i].blacklisted) {
+            bitmap[i / 8] |= (uint8_t)(1 << (i % 8));
+        }
+    }
+}
+
 uint8_t ch_mgr_get_channel_quality(channel_manager_t *mgr, uint8_t channel)
 {
     if (!mgr || channel >= RF_CHANNEL_COUNT) return 0;
     
-    // 返回质量分数 (0-100, 100最好)
-    uint8_t loss = mgr->channels[channel].loss_rate_pct;
-    return (loss > 100) ? 0 : (100 - loss);
+    const channel_quality_t *ch = &mgr->channels[channel];
+    
+    if (ch->blacklisted) return 0;
+    
+    uint8_t rssi_score;
+    if (ch->avg_rssi == CH_RSSI_UNKNOWN) {
+        if (ch->tx_count == 0 && ch->loss_rate_pct == 0) {
+            // v0.6.3: 还没有链路样本, 有空闲扫描 (如启动普查) 时按空闲比例估计
+            if (ch->cca_samples >= CH_CCA_MIN_SAMPLES) {
+                return (uint8_t)(60 - (uint16_t)ch->cca_busy * 60 / ch->cca_samples);
+            }
+            return 50;  // 未知
+        }
+        rssi_score = 50;
+    } else if (ch->avg_rssi >= CH_RSSI_GOOD) {
+        rssi_score = 100;
+    } else if (ch->avg_rssi >= CH_RSSI_FAIR) {
+        rssi_score = 70;
+    } else if (ch->avg_rssi >= CH_RSSI_POOR) {
+        rssi_score = 40;
+    } else {
+        rssi_score = 10;
+    }
+    
+    // 返回质量分数 (0-100, 100最好): 成功率与 RSSI 综合
+    uint8_t loss = ch->loss_rate_pct;
+    uint8_t success = (loss > 100) ? 0 : (100 - loss);
+    return (uint8_t)((success + rssi_score) / 2);
+}
+
+int8_t ch_mgr_get_link_rssi(channel_manager_t *mgr)
+{
+    if (!mgr) return CH_RSSI_UNKNOWN;
+    
+    int32_t sum = 0;
+    uint16_t weight = 0;
+    
+    for (uint8_t i = 0; i < RF_CHANNEL_COUNT; i++) {
+        const channel_quality_t *ch = &mgr->channels[i];
+        if (ch->avg_rssi == CH_RSSI_UNKNOWN || ch->tx_count == 0) continue;
+        sum += (int32_t)ch->avg_rssi * ch->tx_count;
+        weight += ch->tx_count;
+    }
+    
+    return weight ? (int8_t)(sum / weight) : CH_RSSI_UNKNOWN;
 }
 
 uint8_t ch_mgr_get_active_count(channel_manager_t *mgr)
@@ -312,8 +409,8 @@ bool ch_mgr_is_channel_clear(uint8_t channel, int8_t threshold_dbm)
     // 短暂等待让RSSI稳定
     hal_delay_us(50);
     
-    // 读取RSSI
-    int8_t rssi = rf_hw_get_rssi();
+    // 读取RSSI (v0.6.3: 实时能量检测, rf_hw_get_rssi 只是上一个包的 RSSI)
+    int8_t rssi = rf_hw_sample_rssi();
     
     // 恢复原信道
     rf_hw_set_channel(saved_channel);
@@ -339,3 +436,62 @@ uint8_t ch_mgr_get_clear_channel(channel_manager_t *mgr, uint8_t max_retries)
     // 所有重试失败，返回当前信道
     return ch_mgr_get_current_channel(mgr);
 }
+
+/*============================================================================
+ * v0.6.3: 启动能量普查
+ *============================================================================*/
+
+#if defined(USE_RF_BOOT_SURVEY) && USE_RF_BOOT_SURVEY
+
+#define SURVEY_DWELL_US         50      // 切换信道后 RSSI 稳定时间 (同 ch_mgr_is_channel_clear)
+
+uint8_t ch_mgr_boot_survey(channel_manager_t *mgr)
+{
+    if (!mgr) return 0;
+    
+    uint8_t saved_channel = rf_hw_get_channel();
+    uint32_t round_us = (uint32_t)RF_BOOT_SURVEY_MS * 1000 / RF_BOOT_SURVEY_ROUNDS;
+    uint32_t start_us = hal_micros();
+    
+    // 每轮扫一遍全部信道 (40 x 50us = 2ms), 轮间等待使采样分布在整个普查时长内,
+    // 覆盖 WiFi 信标间隔 (约 100ms) 和突发业务
+    for (uint8_t r = 0; r < RF_BOOT_SURVEY_ROUNDS; r++) {
+        for (uint8_t i = 0; i < RF_CHANNEL_COUNT; i++) {
+            rf_hw_set_channel(i);
+            rf_hw_rx_mode();
+            hal_delay_us(SURVEY_DWELL_US);
+            ch_mgr_record_rssi_scan(mgr, i, rf_hw_sample_rssi());
+        }
+        uint32_t next_us = start_us + (uint32_t)(r + 1) * round_us;
+        int32_t wait_us = (int32_t)(next_us - hal_micros());
+        if (wait_us > 0) hal_delay_us((uint32_t)wait_us);
+    }
+    
+    rf_hw_set_channel(saved_channel);
+    
+    // 最忙的信道先拉黑, 活跃信道数到下限时停止
+    uint8_t count = 0;
+    while (mgr->active_count > CH_MIN_ACTIVE_CHANNELS) {
+        uint8_t worst = 0xFF;
+        uint16_t worst_busy = 0;
+        for (uint8_t i = 0; i < RF_CHANNEL_COUNT; i++) {
+            const channel_quality_t *ch = &mgr->channels[i];
+            if (ch->blacklisted || !cca_busy(ch, CH_CCA_BUSY_PCT)) continue;
+            uint16_t busy = (uint16_t)((uint16_t)ch->cca_busy * 100 / ch->cca_samples);
+            if (worst == 0xFF || busy > worst_busy) {
+                worst = i;
+                worst_busy = busy;
+            }
+        }
+        if (worst == 0xFF) break;
+        blacklist_channel(mgr, worst);
+        count++;
+    }
+    
+    if (count > 0) {
+        ch_mgr_refresh_hop_sequence(mgr);
+    }
+    return count;
+}
+
+#endif /* USE_RF_BOOT_SURVEY */
@@ -0,0 +1,508 @@
+/**
+ * @file codec_bench.c
+ * @brief Packet codec microbenchmark
+ *
+ * v0.6.3: 测量方法
+ * 1. 每批 CODEC_BENCH_BLOCK 个样本: 生成输入 → 关中断 → mcycle → 全部编码 →
+ *    mcycle → 全部解码 → mcycle → 开中断
+ * 2. 输入生成与误差计算在计时窗口之外; 包格式按包编码 (multi/delta 一包多样本)
+ * 3. 误差 = 解码结果相对 float 参考姿态的总旋转角, 含 float → Q15 量化,
+ *    即无线链路两端的实际误差
+ */
+
+#include "codec_bench.h"
+#include "config.h"
+#include "rf_ultra.h"
+#include "rf_protocol.h"
+#include "slime_packet.h"
+#include <string.h>
+#include <math.h>
+
+#ifdef CH59X
+#include "core_riscv.h"
+#define BENCH_CYCLES()      ((uint32_t)__get_MCYCLE())
+#define BENCH_IRQ_OFF()     __disable_irq()
+#define BENCH_IRQ_ON()      __enable_irq()
+#else
+#include <time.h>
+static uint32_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+#define BENCH_CYCLES()      host_ns()
+#define BENCH_IRQ_OFF()
+#define BENCH_IRQ_ON()
+#endif
+
+#define BENCH_PI            3.14159265f
+#define BENCH_RAD2DEG       (180.0f / BENCH_PI)
+#define ERR_LSB_DEG         0.0001f     // 误差表分辨率, 饱和于 6.5535°
+#define BENCH_SEED          0x2545F491u
+
+/*============================================================================
+ * Codec Table
+ *============================================================================*/
+
+typedef struct {
+    const char *name;
+    uint8_t per_pkt;            // 每次编码的样本数
+    uint8_t wire_bits;          // 裸编码的线上位数, 0 = 按编码长度
+    bool trajectory;            // 有状态编解码用连续轨迹
+    void (*reset)(void);
+    int  (*encode)(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out);
+    bool (*decode)(const uint8_t *in, int len, q15_t (*q)[4]);
+} codec_entry_t;
+
+static uint8_t bench_sequence;
+static uint32_t bench_t_us;
+
+static void reset_sequence(void)
+{
+    bench_sequence = 0;
+    bench_t_us = 0;
+}
+
+// --- ultra_f: quat_compress (float, 最大分量为正) ---
+static int ultra_f_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    int16_t o[4];
+    (void)q;
+    rf_ultra_bench_compress(qf[0], o);
+    memcpy(out, o, sizeof(o));
+    return sizeof(o);
+}
+
+// --- ultra_q15: quat_compress_q15 (w 为正) ---
+static int ultra_q15_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    int16_t o[4];
+    (void)qf;
+    rf_ultra_bench_compress_q15(q[0], o);
+    memcpy(out, o, sizeof(o));
+    return sizeof(o);
+}
+
+static bool raw8_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    (void)len;
+    memcpy(q[0], in, 4 * sizeof(q15_t));
+    return true;
+}
+
+// --- ultra_pkt: rf_ultra 12 字节数据包 ---
+static int ultra_pkt_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    (void)qf;
+    rf_ultra_build_quat_packet(out, 1, q[0], 0, 100);
+    return RF_ULTRA_PACKET_SIZE;
+}
+
+static bool ultra_pkt_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    rf_ultra_parsed_t p;
+    (void)len;
+    if (!rf_ultra_parse_packet(in, &p) || p.type != 0) return false;   // 0 = 四元数包
+    memcpy(q[0], p.quat, sizeof(p.quat));
+    return true;
+}
+
+// --- st48: smallest-three 3x Q14 (线上另需 2 位索引) ---
+static int st48_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    int16_t abc[3];
+    (void)qf;
+    rf_v2_bench_st_compress(q[0], abc, &out[6]);
+    memcpy(out, abc, sizeof(abc));
+    return 7;
+}
+
+static bool st48_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    int16_t abc[3];
+    (void)len;
+    memcpy(abc, in, sizeof(abc));
+    rf_v2_bench_st_decompress(abc, in[6], q[0]);
+    return true;
+}
+
+// --- st40: 40-bit smallest-three ---
+static int st40_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    (void)qf;
+    out[4] = 0;
+    rf_v2_quat_pack40(q[0], out);
+    return RF_QUAT40_SIZE;
+}
+
+static bool st40_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    (void)len;
+    rf_v2_quat_unpack40(in, q[0]);
+    return true;
+}
+
+// --- simple32: compress_quat_simple ---
+static int simple32_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    (void)qf;
+    uint32_t packed = compress_quat_simple(q[0][0], q[0][1], q[0][2], q[0][3]);
+    memcpy(out, &packed, sizeof(packed));
+    return sizeof(packed);
+}
+
+static bool simple32_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    uint32_t packed;
+    (void)len;
+    memcpy(&packed, in, sizeof(packed));
+    decompress_quat_simple(packed, q[0]);
+    return true;
+}
+
+// --- rf_pkt: rf_tracker_packet_t, 与 rf_transmitter.c build_data_packet 相同的转换 ---
+static int rf_pkt_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    rf_tracker_packet_t *pkt = (rf_tracker_packet_t *)out;
+    (void)q;
+    memset(pkt, 0, sizeof(rf_tracker_packet_t));
+    pkt->header.type = RF_PKT_TRACKER_DATA;
+    pkt->header.length = sizeof(rf_tracker_packet_t) - sizeof(rf_header_t);
+    pkt->tracker_id = 1;
+    pkt->sequence = bench_sequence++;
+
+    int16_t s[4];
+    for (int i = 0; i < 4; i++) {
+        float v = qf[0][i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        s[i] = (int16_t)(v * 32767.0f);
+    }
+    pkt->quat_w = s[0];
+    pkt->quat_x = s[1];
+    pkt->quat_y = s[2];
+    pkt->quat_z = s[3];
+    pkt->battery = 100;
+
+    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_tracker_packet_t) - 2);
+    return sizeof(rf_tracker_packet_t);
+}
+
+static bool rf_pkt_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    const rf_tracker_packet_t *pkt = (const rf_tracker_packet_t *)in;
+    slime_tracker_data_t d;
+    if (len < (int)sizeof(rf_tracker_packet_t)) return false;
+    if (rf_calc_crc16(pkt, sizeof(rf_tracker_packet_t) - 2) != pkt->crc) return false;
+
+    slime_convert_from_rf_packet(&d, pkt, 0);
+    q[0][0] = d.quat_w;
+    q[0][1] = d.quat_x;
+    q[0][2] = d.quat_y;
+    q[0][3] = d.quat_z;
+    return true;
+}
+
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+// --- multi: 多样本聚合包 ---
+static void multi_reset(void)
+{
+    reset_sequence();
+    rf_multi_clear();
+}
+
+static void push_samples(const q15_t (*q)[4])
+{
+    for (uint8_t i = 0; i < RF_MULTI_MAX_SAMPLES; i++) {
+        rf_multi_push_sample(q[i], bench_t_us);
+        bench_t_us += 1000000 / CODEC_BENCH_TRAJ_HZ;
+    }
+}
+
+static int multi_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    (void)qf;
+    push_samples(q);
+    return rf_multi_build_packet(out, 1, bench_sequence++, 0, 100, 0, bench_t_us);
+}
+
+static bool multi_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    rf_multi_parsed_t p;
+    if (!rf_multi_parse_packet(in, (uint8_t)len, &p) || p.count != RF_MULTI_MAX_SAMPLES) {
+        return false;
+    }
+    memcpy(q, p.quat, sizeof(p.quat));
+    return true;
+}
+#endif
+
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+// --- delta: 增量流, 每包立即 ACK; 解码端按序号保存最后样本 (同 rf_receiver.c) ---
+static struct {
+    q15_t quat[4];
+    uint8_t sequence;
+    bool valid;
+} delta_rx[RF_DELTA_HISTORY];
+
+static void delta_reset(void)
+{
+    reset_sequence();
+    rf_multi_clear();
+    rf_delta_reset();
+    memset(delta_rx, 0, sizeof(delta_rx));
+}
+
+static int delta_encode(const float (*qf)[4], const q15_t (*q)[4], uint8_t *out)
+{
+    (void)qf;
+    push_samples(q);
+    int len = rf_delta_build_packet(out, 1, bench_sequence++, 0, 100, 0, bench_t_us);
+    rf_delta_on_ack(out, (uint8_t)len);
+    return len;
+}
+
+static bool delta_decode(const uint8_t *in, int len, q15_t (*q)[4])
+{
+    rf_multi_parsed_t p;
+    uint8_t id, seq, ref;
+
+    if (rf_multi_is_packet(in, (uint8_t)len)) {
+        if (!rf_multi_parse_packet(in, (uint8_t)len, &p)) return false;
+    } else if (rf_delta_peek(in, (uint8_t)len, &id, &seq, &ref)) {
+        const q15_t *rq = delta_rx[ref & (RF_DELTA_HISTORY - 1)].quat;
+        if (!delta_rx[ref & (RF_DELTA_HISTORY - 1)].valid ||
+            delta_rx[ref & (RF_DELTA_HISTORY - 1)].sequence != ref ||
+            !rf_delta_parse_packet(in, (uint8_t)len, rq, &p)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    if (p.count != RF_MULTI_MAX_SAMPLES) return false;
+
+    uint8_t slot = p.sequence & (RF_DELTA_HISTORY - 1);
+    memcpy(delta_rx[slot].quat, p.quat[p.count - 1], sizeof(delta_rx[slot].quat));
+    delta_rx[slot].sequence = p.sequence;
+    delta_rx[slot].valid = true;
+
+    memcpy(q, p.quat, sizeof(p.quat));
+    return true;
+}
+#endif
+
+static const codec_entry_t codecs[] = {
+    { "ultra_f",   1, 64, false, NULL,           ultra_f_encode,   raw8_decode },
+    { "ultra_q15", 1, 64, false, NULL,           ultra_q15_encode, raw8_decode },
+    { "ultra_pkt", 1, 0,  false, NULL,           ultra_pkt_encode, ultra_pkt_decode },
+    { "st48",      1, 50, false, NULL,           st48_encode,      st48_decode },
+    { "st40",      1, 40, false, NULL,           st40_encode,      st40_decode },
+    { "simple32",  1, 32, false, NULL,           simple32_encode,  simple32_decode },
+    { "rf_pkt",    1, 0,  false, reset_sequence, rf_pkt_encode,    rf_pkt_decode },
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+    { "multi",     RF_MULTI_MAX_SAMPLES, 0, true, multi_reset, multi_encode, multi_decode },
+#endif
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+    { "delta",     RF_MULTI_MAX_SAMPLES, 0, true, delta_reset, delta_encode, delta_decode },
+#endif
+};
+
+#define CODEC_COUNT     (sizeof(codecs) / sizeof(codecs[0]))
+
+/*============================================================================
+ * Input Generation
+ *============================================================================*/
+
+static uint32_t rng_state;
+
+static float rng_uniform(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (float)(rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Shoemake: 均匀分布的单位四元数
+static void random_quat(float q[4])
+{
+    float u1 = rng_uniform();
+    float u2 = rng_uniform() * 2.0f * BENCH_PI;
+    float u3 = rng_uniform() * 2.0f * BENCH_PI;
+    float a = sqrtf(1.0f - u1), b = sqrtf(u1);
+    q[0] = a * sinf(u2);
+    q[1] = a * cosf(u2);
+    q[2] = b * sinf(u3);
+    q[3] = b * cosf(u3);
+}
+
+static void quat_mul(const float a[4], const float b[4], float o[4])
+{
+    o[0] = a[0]*b[0] - a[1]*b[1] - a[2]*b[2] - a[3]*b[3];
+    o[1] = a[0]*b[1] + a[1]*b[0] + a[2]*b[3] - a[3]*b[2];
+    o[2] = a[0]*b[2] - a[1]*b[3] + a[2]*b[0] + a[3]*b[1];
+    o[3] = a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + a[3]*b[0];
+}
+
+// 连续轨迹: 绕 Z 匀速 + 绕 X / Y 大幅摆动
+static void trajectory_quat(uint32_t i, float q[4])
+{
+    float t = (float)i * (1.0f / CODEC_BENCH_TRAJ_HZ);
+    float az = 1.0f * t;
+    float ax = 2.5f * sinf(2.0f * BENCH_PI * 0.4f * t);
+    float ay = 1.5f * sinf(2.0f * BENCH_PI * 0.7f * t + 1.0f);
+    float qz[4] = { cosf(0.5f * az), 0, 0, sinf(0.5f * az) };
+    float qx[4] = { cosf(0.5f * ax), sinf(0.5f * ax), 0, 0 };
+    float qy[4] = { cosf(0.5f * ay), 0, sinf(0.5f * ay), 0 };
+    float tmp[4];
+    quat_mul(qz, qx, tmp);
+    quat_mul(tmp, qy, q);
+}
+
+static void to_q15(const float in[4], q15_t out[4])
+{
+    for (int i = 0; i < 4; i++) {
+        float v = in[i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        out[i] = (q15_t)(v * 32767.0f);
+    }
+}
+
+/*============================================================================
+ * Error Statistics
+ *============================================================================*/
+
+static float angle_deg(const float ref[4], const q15_t q[4])
+{
+    float d[4] = { q[0] * (1.0f / 32767.0f), q[1] * (1.0f / 32767.0f),
+                   q[2] * (1.0f / 32767.0f), q[3] * (1.0f / 32767.0f) };
+    float c[4] = { ref[0], -ref[1], -ref[2], -ref[3] };
+    float e[4];
+    quat_mul(c, d, e);
+    float v = sqrtf(e[1]*e[1] + e[2]*e[2] + e[3]*e[3]);
+    return 2.0f * atan2f(v, fabsf(e[0])) * BENCH_RAD2DEG;
+}
+
+static void sort_u16(uint16_t *a, uint32_t n)
+{
+    for (uint32_t gap = n / 2; gap > 0; gap /= 2) {
+        for (uint32_t i = gap; i < n; i++) {
+            uint16_t v = a[i];
+            uint32_t j = i;
+            while (j >= gap && a[j - gap] > v) {
+                a[j] = a[j - gap];
+                j -= gap;
+            }
+            a[j] = v;
+        }
+    }
+}
+
+/*============================================================================
+ * Runner
+ *============================================================================*/
+
+static float in_f[CODEC_BENCH_BLOCK][4];
+static q15_t in_q[CODEC_BENCH_BLOCK][4];
+static q15_t out_q[CODEC_BENCH_BLOCK][4];
+static uint8_t pkt_buf[CODEC_BENCH_BLOCK][RF_MAX_PAYLOAD_SIZE];
+static int pkt_len[CODEC_BENCH_BLOCK];
+static bool pkt_ok[CODEC_BENCH_BLOCK];
+static uint16_t err_table[CODEC_BENCH_SAMPLES];
+
+uint8_t codec_bench_count(void)
+{
+    return (uint8_t)CODEC_COUNT;
+}
+
+int codec_bench_run(uint8_t codec, codec_bench_result_t *result)
+{
+    if (codec >= CODEC_COUNT || !result) return -1;
+    const codec_entry_t *c = &codecs[codec];
+    uint8_t pp = c->per_pkt;
+    uint32_t block = (CODEC_BENCH_BLOCK / pp) * pp;
+
+    memset(result, 0, sizeof(*result));
+    result->codec = c->name;
+    result->trajectory = c->trajectory;
+    if (c->reset) c->reset();
+    rng_state = BENCH_SEED;
+
+    uint64_t enc_total = 0, dec_total = 0, bytes_total = 0;
+    float sq_sum = 0.0f;
+    uint32_t n_err = 0;
+
+    for (uint32_t base = 0; base + pp <= CODEC_BENCH_SAMPLES; base += block) {
+        uint32_t n = CODEC_BENCH_SAMPLES - base;
+        if (n > block) n = block;
+        n -= n % pp;
+
+        for (uint32_t k = 0; k < n; k++) {
+            if (c->trajectory) {
+                trajectory_quat(base + k, in_f[k]);
+            } else {
+                random_quat(in_f[k]);
+            }
+            to_q15(in_f[k], in_q[k]);
+        }
+
+        BENCH_IRQ_OFF();
+        uint32_t t0 = BENCH_CYCLES();
+        for (uint32_t k = 0, p = 0; k < n; k += pp, p++) {
+            pkt_len[p] = c->encode((const float (*)[4])&in_f[k], (const q15_t (*)[4])&in_q[k],
+                                   pkt_buf[p]);
+        }
+        uint32_t t1 = BENCH_CYCLES();
+        for (uint32_t k = 0, p = 0; k < n; k += pp, p++) {
+            pkt_ok[p] = pkt_len[p] > 0 && c->decode(pkt_buf[p], pkt_len[p], &out_q[k]);
+        }
+        uint32_t t2 = BENCH_CYCLES();
+        BENCH_IRQ_ON();
+
+        enc_total += t1 - t0;
+        dec_total += t2 - t1;
+
+        for (uint32_t k = 0; k < n; k++) {
+            uint32_t p = k / pp;
+            if (k % pp == 0 && pkt_len[p] > 0) bytes_total += (uint32_t)pkt_len[p];
+            result->samples++;
+            if (!pkt_ok[p]) {
+                result->failures++;
+                continue;
+            }
+            float e = angle_deg(in_f[k], out_q[k]);
+            sq_sum += e * e;
+            if (e > result->err_max_deg) result->err_max_deg = e;
+            float lsb = e / ERR_LSB_DEG + 0.5f;
+            err_table[n_err++] = (lsb > 65535.0f) ? 65535 : (uint16_t)lsb;
+        }
+    }
+
+    if (result->samples) {
+        result->enc_cycles = (uint32_t)((enc_total + result->samples / 2) / result->samples);
+        result->dec_cycles = (uint32_t)((dec_total + result->samples / 2) / result->samples);
+        result->bytes_per_sample = c->wire_bits ? (float)c->wire_bits / (8.0f * pp) :
+                                   (float)bytes_total / (float)result->samples;
+    }
+    if (n_err) {
+        sort_u16(err_table, n_err);
+        result->err_rms_deg = sqrtf(sq_sum / (float)n_err);
+        result->err_p50_deg = err_table[n_err / 2] * ERR_LSB_DEG;
+        result->err_p99_deg = err_table[(n_err * 99) / 100] * ERR_LSB_DEG;
+    }
+    return 0;
+}
+
+int codec_bench_run_all(codec_bench_report_cb_t cb)
+{
+    int done = 0;
+    codec_bench_result_t r;
+
+    for (uint8_t i = 0; i < CODEC_COUNT; i++) {
+        if (codec_bench_run(i, &r) == 0) {
+            done++;
+            if (cb) cb(&r);
+        }
+    }
+    return done;
+}
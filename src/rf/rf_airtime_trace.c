@@ -0,0 +1,219 @@
+/**
+ * @file rf_airtime_trace.c
+ * @brief 接收器超帧时序追踪 / Receiver superframe airtime trace
+ *
+ * v0.6.3: 记录环 rec[w], 中断写 cur (= rec[w]), 帧结束时 w++ 发布;
+ * 主循环从 rec[r] 读取, 至少保留一帧 (w - r >= 2 才输出) 等待 CRC 补记
+ */
+
+#include "rf_airtime_trace.h"
+#include "hal.h"
+#include <string.h>
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef struct {
+    uint16_t start_off;     // 时隙开始 (定时器唤醒) 相对帧起点
+    uint8_t arrival;        // 包到达相对时隙开始, 2us 单位
+    uint8_t rx_isr_us;
+    uint8_t cb_us;
+    uint8_t flags;
+} trace_slot_t;
+
+typedef struct {
+    uint16_t frame;
+    uint32_t frame_start_us;
+    int16_t beacon_off;
+    uint8_t beacon_cb_us;
+    uint16_t end_off;
+    uint8_t dropped;
+    uint8_t slot_count;
+    bool truncated;
+    trace_slot_t slots[RF_TRACE_MAX_SLOTS];
+} trace_frame_t;
+
+static trace_frame_t rec[RF_TRACE_FRAMES];
+static trace_frame_t *cur = NULL;
+static volatile uint8_t rec_w = 0;      // 仅中断写
+static volatile uint8_t rec_r = 0;      // 仅主循环写
+static uint8_t read_slot = 0;           // 当前记录已输出的时隙数
+static uint8_t dropped = 0;
+static volatile bool trace_on = false;
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+static uint8_t sat_u8(uint32_t v)
+{
+    return (v > 0xFF) ? 0xFF : (uint8_t)v;
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+/*============================================================================
+ * 采集 (中断上下文)
+ *============================================================================*/
+
+void rf_trace_frame_begin(uint16_t frame, uint32_t frame_start_us,
+                          uint32_t wake_us, uint32_t done_us)
+{
+    cur = NULL;
+    if (!trace_on) return;
+
+    // 主机读取跟不上: 丢弃本帧, 不覆盖未读记录
+    if ((uint8_t)(rec_w - rec_r) >= RF_TRACE_FRAMES) {
+        if (dropped < 0xFF) dropped++;
+        return;
+    }
+
+    trace_frame_t *f = &rec[rec_w & (RF_TRACE_FRAMES - 1)];
+    memset(f, 0, sizeof(*f));
+    f->frame = frame;
+    f->frame_start_us = frame_start_us;
+    f->beacon_off = (int16_t)(int32_t)(wake_us - frame_start_us);
+    f->beacon_cb_us = sat_u8(done_us - wake_us);
+    f->dropped = dropped;
+    dropped = 0;
+    cur = f;
+}
+
+void rf_trace_slot_begin(uint8_t slot, uint8_t owner, uint32_t wake_us, uint32_t done_us)
+{
+    if (!cur) return;
+    if (slot >= RF_TRACE_MAX_SLOTS) {
+        cur->truncated = true;
+        return;
+    }
+
+    trace_slot_t *s = &cur->slots[slot];
+    s->start_off = (uint16_t)(wake_us - cur->frame_start_us);
+    s->arrival = RF_TRACE_NO_ARRIVAL;
+    s->cb_us = sat_u8(done_us - wake_us);
+    s->flags = (owner < RF_TRACE_OWNER_NONE) ? owner : RF_TRACE_OWNER_NONE;
+    if (slot >= cur->slot_count) cur->slot_count = slot + 1;
+}
+
+void rf_trace_rx(uint8_t slot, uint32_t rx_us, uint32_t done_us)
+{
+    if (!cur || slot >= cur->slot_count) return;
+
+    trace_slot_t *s = &cur->slots[slot];
+    if (s->flags & RF_TRACE_S_RX) return;   // 同一时隙只记首个包
+
+    uint16_t off = (uint16_t)(rx_us - cur->frame_start_us);
+    s->arrival = sat_u8((uint16_t)(off - s->start_off) / 2);
+    s->rx_isr_us = sat_u8(done_us - rx_us);
+    s->flags |= RF_TRACE_S_RX;
+}
+
+void rf_trace_frame_end(uint32_t wake_us)
+{
+    if (!cur) return;
+
+    cur->end_off = (uint16_t)(wake_us - cur->frame_start_us);
+    cur = NULL;
+
+    __asm__ volatile ("" ::: "memory");
+    rec_w++;
+}
+
+/*============================================================================
+ * 主循环
+ *============================================================================*/
+
+void rf_trace_enable(bool enable)
+{
+    __disable_irq();
+    trace_on = false;
+    cur = NULL;
+    rec_w = 0;
+    rec_r = 0;
+    read_slot = 0;
+    dropped = 0;
+    trace_on = enable;
+    __enable_irq();
+}
+
+bool rf_trace_enabled(void)
+{
+    return trace_on;
+}
+
+void rf_trace_crc(uint16_t frame, uint32_t rx_us, bool ok)
+{
+    if (!trace_on) return;
+
+    __disable_irq();
+    for (uint8_t i = rec_r; i != (uint8_t)(rec_w + 1); i++) {
+        trace_frame_t *f = &rec[i & (RF_TRACE_FRAMES - 1)];
+        if (i == rec_w && f != cur) break;      // 当前帧未在记录
+        if (f->frame != frame) continue;
+
+        // 到达时刻所在的时隙: 开始偏移不晚于到达的最后一个已收包时隙
+        uint16_t off = (uint16_t)(rx_us - f->frame_start_us);
+        for (int8_t s = (int8_t)f->slot_count - 1; s >= 0; s--) {
+            trace_slot_t *ts = &f->slots[s];
+            if ((ts->flags & RF_TRACE_S_RX) && ts->start_off <= off) {
+                ts->flags |= ok ? RF_TRACE_S_CRC_OK : RF_TRACE_S_CRC_BAD;
+                break;
+            }
+        }
+        break;
+    }
+    __enable_irq();
+}
+
+uint8_t rf_trace_read(uint8_t *buf)
+{
+    if ((uint8_t)(rec_w - rec_r) < 2) return 0;
+    __asm__ volatile ("" ::: "memory");
+
+    const trace_frame_t *f = &rec[rec_r & (RF_TRACE_FRAMES - 1)];
+    uint8_t n = f->slot_count - read_slot;
+    if (n > RF_TRACE_REPORT_SLOTS) n = RF_TRACE_REPORT_SLOTS;
+    bool last = (read_slot + n >= f->slot_count);
+
+    buf[0] = RF_TRACE_REPORT_ID;
+    put_u16(&buf[1], f->frame);
+    buf[3] = read_slot;
+    buf[4] = n;
+    buf[5] = (last ? RF_TRACE_F_LAST : 0) | (f->truncated ? RF_TRACE_F_TRUNCATED : 0);
+    put_u16(&buf[6], (uint16_t)f->beacon_off);
+    buf[8] = f->beacon_cb_us;
+    put_u16(&buf[9], f->end_off);
+    buf[11] = f->dropped;
+
+    uint8_t *p = &buf[RF_TRACE_HEADER_SIZE];
+    for (uint8_t i = 0; i < n; i++) {
+        const trace_slot_t *s = &f->slots[read_slot + i];
+        put_u16(p, s->start_off);
+        p[2] = s->arrival;
+        p[3] = s->rx_isr_us;
+        p[4] = s->cb_us;
+        p[5] = s->flags;
+        p += RF_TRACE_SLOT_SIZE;
+    }
+
+    if (last) {
+        read_slot = 0;
+        __asm__ volatile ("" ::: "memory");
+        rec_r++;
+    } else {
+        read_slot += n;
+    }
+    return (uint8_t)(p - buf);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file rf_arbiter.c
+ * @brief 射频时分仲裁 / Radio time-slice arbiter (TDMA + BLE)
+ *
+ * v0.6.3: 所有权只在主循环切换 (rf_transmitter_process 前后), 中断只读 owner;
+ * 交给 BLE 的窗口在下一帧信标前 RF_ARB_GUARD_US 结束, 事件循环的 RF 唤醒
+ * (信标前 EVQ_RF_WAKE_ADVANCE_US) 落在保护时间内
+ */
+
+#include "config.h"
+#include "rf_arbiter.h"
+#include "rf_hw.h"
+#include <string.h>
+
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static volatile radio_owner_t owner = RADIO_OWNER_RF;
+static uint32_t window_start_us = 0;
+static uint32_t window_end_us = 0;
+static rf_arbiter_stats_t stats;
+
+/*============================================================================
+ * 接口
+ *============================================================================*/
+
+void rf_arbiter_init(void)
+{
+    owner = RADIO_OWNER_RF;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void rf_arbiter_release(uint32_t next_frame_us)
+{
+    uint32_t now = rf_hw_get_time_us();
+    uint32_t end = next_frame_us - RF_ARB_GUARD_US;
+    int32_t window = (int32_t)(end - now);
+
+    if (window < RF_ARB_MIN_WINDOW_US) {
+        // 备用时隙 / OTA 监听占满了本帧, 不值得切换
+        stats.short_windows++;
+        return;
+    }
+
+    window_start_us = now;
+    window_end_us = end;
+    stats.windows++;
+    owner = RADIO_OWNER_BLE;
+}
+
+void rf_arbiter_acquire(void)
+{
+    if (owner == RADIO_OWNER_RF) {
+        return;
+    }
+
+    uint32_t now = rf_hw_get_time_us();
+    if ((int32_t)(window_end_us - now) > 0) {
+        // 事件循环来不及定时时直接处理 RF, BLE 窗口被提前截断
+        stats.preempts++;
+        stats.ble_us += now - window_start_us;
+    } else {
+        stats.ble_us += window_end_us - window_start_us;
+    }
+
+    owner = RADIO_OWNER_RF;
+    // BLE 协议栈改写过射频寄存器
+    rf_hw_reclaim();
+}
+
+uint32_t rf_arbiter_ble_budget(void)
+{
+    if (owner != RADIO_OWNER_BLE) {
+        return 0;
+    }
+    int32_t left = (int32_t)(window_end_us - rf_hw_get_time_us());
+    return (left > 0) ? (uint32_t)left : 0;
+}
+
+radio_owner_t rf_arbiter_owner(void)
+{
+    return owner;
+}
+
+void rf_arbiter_get_stats(rf_arbiter_stats_t *out)
+{
+    if (out) {
+        memcpy(out, &stats, sizeof(stats));
+    }
+}
+
+#endif /* USE_RADIO_ARBITER */
@@ -0,0 +1,430 @@
+/**
+ * @file rf_auth.c
+ * @brief v0.6.3 链路认证加密 (USE_RF_LINK_AUTH)
+ *
+ * AES-128 计数器模式密钥流 + GF(65537) 多项式 MIC, 格式见 rf_auth.h
+ * 密钥流按 nonce 缓存 (信标/数据包各一组), 主循环预先计算, 时隙中断内只做异或和哈希
+ */
+
+#include "rf_auth.h"
+#include "rf_protocol.h"
+#include "hal.h"
+#include "optimize.h"         // RAM_CODE_ISR
+#include <string.h>
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+
+#define AUTH_BLOCK              16
+#define AUTH_ROUNDS             10
+#define AUTH_MIC_P              65537u
+
+/*============================================================================
+ * AES-128 分组加密
+ *============================================================================*/
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint8_t link_key[RF_AUTH_KEY_SIZE];
+static uint8_t round_keys[(AUTH_ROUNDS + 1) * AUTH_BLOCK];     // 设置密钥时展开一次
+static bool key_valid = false;
+
+static uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+}
+
+static void aes_expand_key(const uint8_t *key)
+{
+    static const uint8_t rcon[AUTH_ROUNDS] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36
+    };
+
+    memcpy(round_keys, key, AUTH_BLOCK);
+    for (uint8_t i = 4; i < 4 * (AUTH_ROUNDS + 1); i++) {
+        uint8_t t[4];
+        memcpy(t, &round_keys[(i - 1) * 4], 4);
+        if ((i & 3) == 0) {
+            uint8_t u = t[0];
+            t[0] = (uint8_t)(aes_sbox[t[1]] ^ rcon[i / 4 - 1]);
+            t[1] = aes_sbox[t[2]];
+            t[2] = aes_sbox[t[3]];
+            t[3] = aes_sbox[u];
+        }
+        for (uint8_t j = 0; j < 4; j++) {
+            round_keys[i * 4 + j] = round_keys[(i - 4) * 4 + j] ^ t[j];
+        }
+    }
+}
+
+static void aes_encrypt_soft(const uint8_t *in, uint8_t *out)
+{
+    uint8_t s[AUTH_BLOCK];
+
+    for (uint8_t i = 0; i < AUTH_BLOCK; i++) s[i] = in[i] ^ round_keys[i];
+
+    for (uint8_t round = 1; round <= AUTH_ROUNDS; round++) {
+        // SubBytes + ShiftRows (列主序, s[c*4 + r])
+        uint8_t t[AUTH_BLOCK];
+        for (uint8_t c = 0; c < 4; c++) {
+            for (uint8_t r = 0; r < 4; r++) {
+                t[c * 4 + r] = aes_sbox[s[((c + r) & 3) * 4 + r]];
+            }
+        }
+
+        if (round < AUTH_ROUNDS) {
+            // MixColumns
+            for (uint8_t c = 0; c < 4; c++) {
+                uint8_t *col = &t[c * 4];
+                uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                col[0] ^= all ^ xtime(a0 ^ a1);
+                col[1] ^= all ^ xtime(a1 ^ a2);
+                col[2] ^= all ^ xtime(a2 ^ a3);
+                col[3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+
+        const uint8_t *rk = &round_keys[round * AUTH_BLOCK];
+        for (uint8_t i = 0; i < AUTH_BLOCK; i++) s[i] = t[i] ^ rk[i];
+    }
+
+    memcpy(out, s, AUTH_BLOCK);
+}
+
+#if defined(USE_BLE_SLIMEVR) && USE_BLE_SLIMEVR
+// WCH BLE 协议栈库: 芯片 AES 引擎 (key, plaintext, ciphertext), 返回 0 成功
+extern uint8_t LL_Encrypt(uint8_t *key, uint8_t *plaintextData, uint8_t *encryptData);
+
+#define AES_SOFT                0
+#define AES_HW                  1       // 字节序与 FIPS-197 相同
+#define AES_HW_REVERSED         2       // 密钥/数据/结果都按逆序 (BLE 控制器习惯)
+static uint8_t aes_mode = AES_SOFT;
+
+static void reverse16(uint8_t *dst, const uint8_t *src)
+{
+    for (uint8_t i = 0; i < AUTH_BLOCK; i++) dst[i] = src[AUTH_BLOCK - 1 - i];
+}
+
+static bool aes_encrypt_hw(const uint8_t *key, const uint8_t *in, uint8_t *out, bool reversed)
+{
+    uint8_t k[AUTH_BLOCK], p[AUTH_BLOCK], c[AUTH_BLOCK];
+
+    if (reversed) {
+        reverse16(k, key);
+        reverse16(p, in);
+    } else {
+        memcpy(k, key, AUTH_BLOCK);
+        memcpy(p, in, AUTH_BLOCK);
+    }
+    if (LL_Encrypt(k, p, c) != 0) return false;
+    if (reversed) {
+        reverse16(out, c);
+    } else {
+        memcpy(out, c, AUTH_BLOCK);
+    }
+    return true;
+}
+
+/**
+ * @brief 用 FIPS-197 附录 C.1 向量确定硬件引擎的字节序, 都不对时用软件实现
+ */
+static void aes_select_engine(void)
+{
+    static const uint8_t key[AUTH_BLOCK] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    };
+    static const uint8_t pt[AUTH_BLOCK] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+    };
+    static const uint8_t ct[AUTH_BLOCK] = {
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+        0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+    };
+    uint8_t out[AUTH_BLOCK];
+
+    aes_mode = AES_SOFT;
+    if (aes_encrypt_hw(key, pt, out, false) && memcmp(out, ct, AUTH_BLOCK) == 0) {
+        aes_mode = AES_HW;
+    } else if (aes_encrypt_hw(key, pt, out, true) && memcmp(out, ct, AUTH_BLOCK) == 0) {
+        aes_mode = AES_HW_REVERSED;
+    }
+}
+#endif
+
+static void aes_encrypt(const uint8_t *in, uint8_t *out)
+{
+#if defined(USE_BLE_SLIMEVR) && USE_BLE_SLIMEVR
+    if (aes_mode != AES_SOFT &&
+        aes_encrypt_hw(link_key, in, out, aes_mode == AES_HW_REVERSED)) {
+        return;
+    }
+#endif
+    aes_encrypt_soft(in, out);
+}
+
+/*============================================================================
+ * 密钥流
+ *============================================================================*/
+
+typedef struct {
+    volatile bool valid;            // 最后置位, 中断读取时未完成的缓存视为未命中
+    rf_auth_nonce_t nonce;
+    uint8_t blocks;
+    uint8_t stream[RF_AUTH_STREAM_MAX];
+} stream_cache_t;
+
+// [0] = 信标, [1] = 数据包
+static stream_cache_t stream_cache[2];
+
+static uint8_t stream_blocks(uint8_t len)
+{
+    uint16_t bytes = (uint16_t)RF_AUTH_MAC_KEY_SIZE + len;
+    if (bytes > RF_AUTH_STREAM_MAX) bytes = RF_AUTH_STREAM_MAX;
+    return (uint8_t)((bytes + AUTH_BLOCK - 1) / AUTH_BLOCK);
+}
+
+static bool nonce_equal(const rf_auth_nonce_t *a, const rf_auth_nonce_t *b)
+{
+    return a->epoch == b->epoch && a->frame == b->frame &&
+           a->tracker_id == b->tracker_id && a->attempt == b->attempt;
+}
+
+static void stream_generate(const rf_auth_nonce_t *nonce, uint8_t blocks, uint8_t *out)
+{
+    uint8_t ctr[AUTH_BLOCK] = {0};
+
+    ctr[0] = (uint8_t)nonce->epoch;
+    ctr[1] = (uint8_t)(nonce->epoch >> 8);
+    ctr[2] = (uint8_t)(nonce->epoch >> 16);
+    ctr[3] = (uint8_t)(nonce->epoch >> 24);
+    ctr[4] = (uint8_t)nonce->frame;
+    ctr[5] = (uint8_t)(nonce->frame >> 8);
+    ctr[6] = nonce->tracker_id;
+    ctr[7] = nonce->attempt;
+
+    for (uint8_t b = 0; b < blocks; b++) {
+        ctr[8] = b;
+        aes_encrypt(ctr, &out[b * AUTH_BLOCK]);
+    }
+}
+
+/**
+ * @brief 取 len 字节包所需的密钥流: 命中缓存时直接返回, 否则算到 scratch
+ */
+static const uint8_t *stream_get(const rf_auth_nonce_t *nonce, uint8_t len, uint8_t *scratch)
+{
+    uint8_t blocks = stream_blocks(len);
+    const stream_cache_t *c = &stream_cache[nonce->tracker_id == RF_AUTH_ID_BEACON ? 0 : 1];
+
+    if (c->valid && c->blocks >= blocks && nonce_equal(&c->nonce, nonce)) {
+        return c->stream;
+    }
+    stream_generate(nonce, blocks, scratch);
+    return scratch;
+}
+
+/*============================================================================
+ * MIC
+ *============================================================================*/
+
+/**
+ * @brief 以 16 位字在 GF(65537) 上求多项式哈希, 加上掩码 s
+ *
+ * h 始终 < p, (h + m) 约简后再乘, 乘积 < 2^32; 2^16 ≡ -1 (mod p), 约简为 低 16 位 - 高 16 位
+ */
+RAM_CODE_ISR
+static uint16_t mic_compute(const uint8_t *stream, const uint8_t *data, uint8_t len)
+{
+    uint32_t r = (uint32_t)stream[0] | ((uint32_t)stream[1] << 8);
+    uint16_t s = (uint16_t)(stream[2] | (stream[3] << 8));
+    if (r == 0) r = 1;
+
+    uint32_t h = len;
+    for (uint8_t i = 0; i < len; i += 2) {
+        uint32_t m = data[i];
+        if (i + 1 < len) m |= (uint32_t)data[i + 1] << 8;
+        h += m;
+        if (h >= AUTH_MIC_P) h -= AUTH_MIC_P;
+        uint32_t x = h * r;
+        int32_t y = (int32_t)(x & 0xFFFF) - (int32_t)(x >> 16);
+        if (y < 0) y += AUTH_MIC_P;
+        h = (uint32_t)y;
+    }
+    return (uint16_t)(h + s);
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+static void cache_clear(void)
+{
+    stream_cache[0].valid = false;
+    stream_cache[1].valid = false;
+}
+
+static void key_apply(const uint8_t *key)
+{
+    key_valid = false;
+    cache_clear();
+
+    bool any = false;
+    for (uint8_t i = 0; i < RF_AUTH_KEY_SIZE; i++) any = any || (key[i] != 0);
+    if (!any) return;
+
+    memcpy(link_key, key, RF_AUTH_KEY_SIZE);
+    aes_expand_key(link_key);
+    key_valid = true;
+}
+
+void rf_auth_init(void)
+{
+#if defined(USE_BLE_SLIMEVR) && USE_BLE_SLIMEVR
+    aes_select_engine();
+#endif
+
+    uint8_t key[RF_AUTH_KEY_SIZE] = {0};
+    if (hal_kv_get(HAL_KV_LINK_KEY, key, sizeof(key)) == RF_AUTH_KEY_SIZE) {
+        key_apply(key);
+    }
+}
+
+bool rf_auth_active(void)
+{
+    return key_valid;
+}
+
+int rf_auth_set_key(const uint8_t *key)
+{
+    static const uint8_t zero[RF_AUTH_KEY_SIZE] = {0};
+    if (!key) key = zero;
+
+    key_apply(key);
+    if (!key_valid) {
+        int ret = hal_kv_delete(HAL_KV_LINK_KEY);
+        return (ret == HAL_KV_ERR_NOT_FOUND || ret == HAL_KV_ERR_DELETED) ? 0 : ret;
+    }
+    return hal_kv_set(HAL_KV_LINK_KEY, link_key, RF_AUTH_KEY_SIZE);
+}
+
+void rf_auth_prepare(const rf_auth_nonce_t *nonce, uint8_t len)
+{
+    if (!key_valid || !nonce) return;
+
+    stream_cache_t *c = &stream_cache[nonce->tracker_id == RF_AUTH_ID_BEACON ? 0 : 1];
+    uint8_t blocks = stream_blocks(len);
+
+    if (c->valid && c->blocks >= blocks && nonce_equal(&c->nonce, nonce)) return;
+
+    c->valid = false;
+    __asm__ volatile ("" ::: "memory");
+    c->nonce = *nonce;
+    c->blocks = blocks;
+    stream_generate(nonce, blocks, c->stream);
+    __asm__ volatile ("" ::: "memory");
+    c->valid = true;
+}
+
+RAM_CODE_ISR
+uint8_t rf_auth_seal(uint8_t *out, const uint8_t *in, uint8_t len, const rf_auth_nonce_t *nonce)
+{
+    uint8_t scratch[RF_AUTH_STREAM_MAX];
+
+    if (len + RF_LINK_MIC_SIZE > RF_MAX_PAYLOAD_SIZE) len = RF_MAX_PAYLOAD_SIZE - RF_LINK_MIC_SIZE;
+    const uint8_t *ks = stream_get(nonce, len, scratch);
+
+    for (uint8_t i = 0; i < len; i++) {
+        out[i] = in[i] ^ ks[RF_AUTH_MAC_KEY_SIZE + i];
+    }
+    uint16_t mic = mic_compute(ks, out, len);
+    out[len] = (uint8_t)mic;
+    out[len + 1] = (uint8_t)(mic >> 8);
+    return (uint8_t)(len + RF_LINK_MIC_SIZE);
+}
+
+int rf_auth_open(uint8_t *out, const uint8_t *in, uint8_t len, const rf_auth_nonce_t *nonce)
+{
+    uint8_t scratch[RF_AUTH_STREAM_MAX];
+
+    if (len <= RF_LINK_MIC_SIZE || len > RF_MAX_PAYLOAD_SIZE) return -1;
+    len -= RF_LINK_MIC_SIZE;
+
+    const uint8_t *ks = stream_get(nonce, len, scratch);
+    uint16_t mic = mic_compute(ks, in, len);
+    if (in[len] != (uint8_t)mic || in[len + 1] != (uint8_t)(mic >> 8)) return -1;
+
+    for (uint8_t i = 0; i < len; i++) {
+        out[i] = in[i] ^ ks[RF_AUTH_MAC_KEY_SIZE + i];
+    }
+    return len;
+}
+
+RAM_CODE_ISR
+void rf_auth_sign(uint8_t *mic, const uint8_t *data, uint8_t len, const rf_auth_nonce_t *nonce)
+{
+    uint8_t scratch[RF_AUTH_STREAM_MAX];
+
+    // 只认证: 只用到密钥流的 MAC 密钥部分
+    const uint8_t *ks = stream_get(nonce, 0, scratch);
+    uint16_t m = mic_compute(ks, data, len);
+    mic[0] = (uint8_t)m;
+    mic[1] = (uint8_t)(m >> 8);
+}
+
+RAM_CODE_ISR
+bool rf_auth_verify(const uint8_t *mic, const uint8_t *data, uint8_t len,
+                    const rf_auth_nonce_t *nonce)
+{
+    uint8_t expect[RF_LINK_MIC_SIZE];
+
+    rf_auth_sign(expect, data, len, nonce);
+    return mic[0] == expect[0] && mic[1] == expect[1];
+}
+
+/*============================================================================
+ * 接收器: 纪元预留
+ *
+ * 纪元必须跨重启单调递增 (否则密钥流重复); 每次启动从存储的上限开始,
+ * 立即把上限推后 RF_AUTH_EPOCH_RESERVE, 运行中用掉一半时再顺延
+ *============================================================================*/
+
+static uint32_t epoch_reserved = 0;
+
+uint32_t rf_auth_epoch_start(void)
+{
+    uint32_t stored = 0;
+    if (hal_kv_get(HAL_KV_AUTH_EPOCH, &stored, sizeof(stored)) != sizeof(stored)) {
+        stored = 0;
+    }
+    epoch_reserved = stored + RF_AUTH_EPOCH_RESERVE;
+    hal_kv_set(HAL_KV_AUTH_EPOCH, &epoch_reserved, sizeof(epoch_reserved));
+    return stored;
+}
+
+void rf_auth_epoch_check(uint32_t epoch)
+{
+    if ((int32_t)(epoch_reserved - epoch) > RF_AUTH_EPOCH_RESERVE / 2) return;
+    epoch_reserved = epoch + RF_AUTH_EPOCH_RESERVE;
+    hal_kv_set_deferred(HAL_KV_AUTH_EPOCH, &epoch_reserved, sizeof(epoch_reserved));
+}
+
+#endif /* USE_RF_LINK_AUTH */
@@ -6,7 +6,32 @@
  */
 
 #include "rf_protocol.h"
+#include "hal.h"
 #include <stdint.h>
+#include <stdbool.h>
+
+#if (RF_HOP_TABLE_SIZE & (RF_HOP_TABLE_SIZE - 1)) != 0
+#error "RF_HOP_TABLE_SIZE must be a power of two"
+#endif
+
+// v0.6.3: 预计算跳频表 (tracker / receiver 共用)
+static uint8_t hop_table[RF_HOP_TABLE_SIZE];
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+static uint8_t hop_lane = RF_COEX_LANE_AUTO;    // 下次建表使用的车道
+static uint8_t hop_lane_built;                  // 当前表实际使用的车道
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+static uint8_t hop_cell = 0;                    // 漫游小区, 下次建表生效
+#endif
+
+// 映射到可用信道范围 (避开WiFi信道)
+// 使用2400-2480MHz中的低干扰信道
+static const uint8_t hop_channels[16] = {
+    5, 15, 25, 35, 45, 55, 65, 75,  // 主跳频序列
+    10, 20, 30, 40, 50, 60, 70, 80  // 备用序列
+};
 
 /*============================================================================
  * CRC-16 计算 (ModBus)
@@ -14,28 +39,15 @@
 
 uint16_t rf_calc_crc16(const void *data, uint16_t len)
 {
-    const uint8_t *ptr = (const uint8_t *)data;
-    uint16_t crc = 0xFFFF;
-    
-    for (uint16_t i = 0; i < len; i++) {
-        crc ^= ptr[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    
-    return crc;
+    // v0.6.3: 统一由 hal_crc 查表实现
+    return hal_crc16(data, len);
 }
 
 /*============================================================================
  * 跳频信道计算
  *============================================================================*/
 
-uint8_t rf_get_hop_channel(uint16_t frame_number, uint32_t network_key)
+static uint32_t hop_hash(uint16_t frame_number, uint32_t network_key)
 {
     // 使用简单哈希算法基于帧号和网络密钥计算信道
     uint32_t hash = frame_number;
@@ -45,13 +57,257 @@ uint8_t rf_get_hop_channel(uint16_t frame_number, uint32_t network_key)
     hash ^= (hash >> 13);
     hash *= 0xC2B2AE35;
     hash ^= (hash >> 16);
-    
-    // 映射到可用信道范围 (避开WiFi信道)
-    // 使用2400-2480MHz中的低干扰信道
-    static const uint8_t hop_channels[] = {
-        5, 15, 25, 35, 45, 55, 65, 75,  // 主跳频序列
-        10, 20, 30, 40, 50, 60, 70, 80  // 备用序列
-    };
-    
+    return hash;
+}
+
+uint8_t rf_get_hop_channel(uint16_t frame_number, uint32_t network_key)
+{
+    uint32_t hash = hop_hash(frame_number, network_key);
     return hop_channels[hash % (sizeof(hop_channels) / sizeof(hop_channels[0]))];
 }
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+uint8_t rf_get_lane_channel(uint16_t frame_number, uint8_t lane)
+{
+    uint32_t hash = hop_hash(frame_number, RF_COEX_HOP_KEY);
+    return hop_channels[(hash + lane) % RF_COEX_LANES];
+}
+
+void rf_hop_table_set_lane(uint8_t lane)
+{
+    hop_lane = (lane < RF_COEX_LANES) ? lane : RF_COEX_LANE_AUTO;
+}
+
+uint8_t rf_hop_table_get_lane(void)
+{
+    return hop_lane_built;
+}
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+void rf_hop_table_set_cell(uint8_t cell)
+{
+    hop_cell = (cell < RF_ROAM_CELLS) ? cell : 0;
+}
+
+uint8_t rf_hop_table_get_cell(void)
+{
+    return hop_cell;
+}
+#endif
+
+/*============================================================================
+ * v0.6.3: 预计算跳频表
+ *============================================================================*/
+
+static bool hop_blacklisted(const uint8_t *blacklist, uint8_t len, uint8_t channel)
+{
+    uint8_t byte_idx = channel / 8;
+    if (!blacklist || byte_idx >= len) return false;
+    return (blacklist[byte_idx] & (1 << (channel % 8))) != 0;
+}
+
+void rf_hop_table_build(uint32_t network_key, const uint8_t *blacklist,
+                        uint8_t blacklist_len)
+{
+    uint8_t base[RF_HOP_TABLE_SIZE];
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    // 未指定车道时由密钥导出, 未协调的套件之间也分散在不同车道
+    uint8_t lane = hop_lane;
+    if (lane == RF_COEX_LANE_AUTO) {
+        lane = (uint8_t)(rf_coex_net_tag(network_key) % RF_COEX_LANES);
+    }
+    hop_lane_built = lane;
+
+    for (uint16_t i = 0; i < RF_HOP_TABLE_SIZE; i++) {
+        base[i] = rf_get_lane_channel(i, lane);
+    }
+#else
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    // 相邻小区使用不同种子, 两台接收器的帧错开后也不会长期同信道
+    network_key = rf_roam_cell_key(network_key, hop_cell);
+#endif
+    for (uint16_t i = 0; i < RF_HOP_TABLE_SIZE; i++) {
+        base[i] = rf_get_hop_channel(i, network_key);
+    }
+#endif
+
+    for (uint16_t i = 0; i < RF_HOP_TABLE_SIZE; i++) {
+        uint8_t channel;
+        uint8_t attempts = 0;
+
+        do {
+            channel = base[(i + attempts) & (RF_HOP_TABLE_SIZE - 1)];
+            attempts++;
+        } while (hop_blacklisted(blacklist, blacklist_len, channel) &&
+                 attempts < RF_HOP_MAX_SKIP);
+
+        hop_table[i] = channel;
+    }
+}
+
+uint8_t rf_hop_table_get(uint16_t frame_number)
+{
+    return hop_table[frame_number & (RF_HOP_TABLE_SIZE - 1)];
+}
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+uint8_t rf_hop_lane_entry(uint16_t frame_number, uint8_t lane,
+                          const uint8_t *blacklist, uint8_t blacklist_len)
+{
+    uint8_t channel;
+    uint8_t attempts = 0;
+
+    do {
+        channel = rf_get_lane_channel((frame_number + attempts) & (RF_HOP_TABLE_SIZE - 1), lane);
+        attempts++;
+    } while (hop_blacklisted(blacklist, blacklist_len, channel) &&
+             attempts < RF_HOP_MAX_SKIP);
+
+    return channel;
+}
+#endif
+
+static uint16_t hop_max_gap(uint8_t channel)
+{
+    uint16_t first = RF_HOP_TABLE_SIZE, last = 0, gap = 0;
+
+    for (uint16_t i = 0; i < RF_HOP_TABLE_SIZE; i++) {
+        if (hop_table[i] != channel) continue;
+        if (first == RF_HOP_TABLE_SIZE) {
+            first = i;
+        } else if (i - last > gap) {
+            gap = i - last;
+        }
+        last = i;
+    }
+
+    if (first == RF_HOP_TABLE_SIZE) return 0;
+
+    // 循环: 最后一次出现到下一周期第一次出现
+    uint16_t wrap = first + RF_HOP_TABLE_SIZE - last;
+    return (wrap > gap) ? wrap : gap;
+}
+
+uint8_t rf_hop_table_pick_listen(const uint8_t *exclude, uint8_t exclude_len,
+                                 uint16_t *max_gap)
+{
+    uint8_t best = 0xFF;
+    uint16_t best_gap = 0xFFFF;
+    uint8_t seen[32] = {0};     // 每个信道只在首次出现时评估
+
+    for (uint16_t i = 0; i < RF_HOP_TABLE_SIZE; i++) {
+        uint8_t channel = hop_table[i];
+
+        if (hop_blacklisted(seen, sizeof(seen), channel)) continue;
+        seen[channel / 8] |= (uint8_t)(1 << (channel % 8));
+        if (hop_blacklisted(exclude, exclude_len, channel)) continue;
+        // rf_hw 无法调谐的信道 (两端都停留在上一信道, 实际访问间隔不可预测)
+        if (channel >= RF_CHANNEL_COUNT) continue;
+
+        uint16_t gap = hop_max_gap(channel);
+        if (gap < best_gap) {
+            best_gap = gap;
+            best = channel;
+        }
+    }
+
+    if (max_gap) *max_gap = (best == 0xFF) ? 0 : best_gap;
+    return best;
+}
+
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+/*============================================================================
+ * v0.6.3: 每 tracker 信道映射
+ *============================================================================*/
+
+int8_t rf_hop_channel_index(uint8_t channel)
+{
+    for (uint8_t i = 0; i < RF_HOP_MAP_BITS; i++) {
+        if (hop_channels[i] == channel) return (int8_t)i;
+    }
+    return -1;
+}
+
+uint8_t rf_hop_channel_at(uint8_t index)
+{
+    return hop_channels[index % RF_HOP_MAP_BITS];
+}
+
+uint8_t rf_hop_remap(uint8_t channel, uint16_t frame_number, uint8_t tracker_id,
+                     uint16_t bad_mask)
+{
+    int8_t idx = rf_hop_channel_index(channel);
+    if (idx < 0 || !(bad_mask & (1u << idx))) return channel;
+
+    // 起点随帧号和 tracker 错开: 同一坏信道的多个 tracker 不挤在同一个替代信道上
+    uint8_t start = (uint8_t)(frame_number + tracker_id);
+    for (uint8_t k = 0; k < RF_HOP_MAP_BITS; k++) {
+        uint8_t j = (uint8_t)((start + k) % RF_HOP_MAP_BITS);
+        uint8_t alt = hop_channels[j];
+        if (alt < RF_CHANNEL_COUNT && alt != channel && !(bad_mask & (1u << j))) {
+            return alt;
+        }
+    }
+    return channel;
+}
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+/*============================================================================
+ * v0.6.3: 可变超帧速率
+ *============================================================================*/
+
+static const uint16_t frame_rate_periods[RF_FRAME_RATE_COUNT] = RF_FRAME_RATE_PERIODS;
+
+volatile uint16_t rf_frame_us = RF_SUPERFRAME_US;
+static volatile uint8_t rate_cur = 0;
+static volatile uint8_t rate_next = 0;
+static volatile uint8_t rate_left = 0;          // 距切换的帧边界数, 0 = 无切换
+
+uint16_t rf_frame_rate_period(uint8_t rate)
+{
+    return frame_rate_periods[rate % RF_FRAME_RATE_COUNT];
+}
+
+uint8_t rf_frame_rate_get(void)
+{
+    return rate_cur;
+}
+
+bool rf_frame_rate_pending(void)
+{
+    return rate_left != 0;
+}
+
+void rf_frame_rate_schedule(uint8_t rate, uint8_t frames)
+{
+    rate_next = rate % RF_FRAME_RATE_COUNT;
+    rate_left = (frames > 15) ? 15 : frames;
+    if (rate_next == rate_cur) rate_left = 0;
+}
+
+bool rf_frame_rate_advance(void)
+{
+    if (rate_left == 0 || --rate_left != 0) return false;
+
+    bool changed = (rate_next != rate_cur);
+    rate_cur = rate_next;
+    rf_frame_us = frame_rate_periods[rate_cur];
+    return changed;
+}
+
+void rf_frame_rate_sync(uint8_t field)
+{
+    rate_cur = RF_RATE_CUR(field);
+    rate_next = RF_RATE_NEXT(field);
+    rate_left = RF_RATE_LEFT(field);
+    rf_frame_us = frame_rate_periods[rate_cur];
+}
+
+uint8_t rf_frame_rate_field(void)
+{
+    return RF_RATE_PACK(rate_cur, rate_left ? rate_next : rate_cur, rate_left);
+}
+#endif
@@ -9,8 +9,15 @@
 #include "rf_hw.h"
 #include "rf_protocol.h"  // 包含RF_CHANNEL_COUNT定义
 #include "hal.h"
+#include "profile.h"
+#include "optimize.h"
 #include <string.h>
 
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+#include "rf_arbiter.h"
+#include "ble_slimevr.h"
+#endif
+
 #ifdef CH59X
 #include "CH59x_common.h"
 
@@ -91,10 +98,25 @@ static bool rf_initialized = false;
 
 // TX/RX buffers
 static uint8_t tx_buffer[64];
-static uint8_t rx_buffer[2][64];            // 双缓冲
-static volatile uint8_t rx_active_buf = 0;  // 当前活动缓冲区索引
-static volatile uint8_t rx_len = 0;         // 在ISR中修改，需要volatile
-static volatile bool rx_pending = false;    // 在ISR中修改，需要volatile
+// v0.6.3: 接收缓冲池 (替代双缓冲) - 中断直接读入空闲缓冲, 上层按句柄取用后归还
+static rf_hw_rx_buf_t rx_pool[RF_HW_RX_POOL_SIZE];
+static volatile uint32_t rx_free_mask = (RF_HW_RX_POOL_SIZE == 32) ? 0xFFFFFFFFUL
+                                        : ((1UL << RF_HW_RX_POOL_SIZE) - 1);
+static volatile uint8_t rx_pending_h = RF_HW_RX_NONE;  // rf_hw_receive 读取的最新包
+static volatile uint32_t rx_pool_overruns = 0;
+static rf_hw_rx_pool_callback_t rx_pool_callback = NULL;
+static volatile bool rf_event = false;      // v0.6.3: 收/发完成中断置位, rf_hw_wait_rx 用
+static volatile bool tx_done = false;       // v0.6.3: TX_DONE 中断置位, rf_hw_transmit_wait 用
+
+#define RF_HW_TX_TIMEOUT_US         10000   // 与 rf_hw_transmit 的轮询上限一致
+
+// v0.6.3: 接收完成时刻在中断入口锁存 (USE_HW_TIMESTAMP)
+#if defined(CH59X) && defined(USE_HW_TIMESTAMP) && USE_HW_TIMESTAMP
+#define RF_HW_RX_LATCH              1
+static volatile uint32_t rx_time_us = 0;
+#else
+#define RF_HW_RX_LATCH              0
+#endif
 
 // ACK payload
 static uint8_t ack_payload[32];
@@ -105,17 +127,41 @@ static volatile uint8_t ack_payload_len = 0;  // 可能在ISR中使用
  *============================================================================*/
 
 static void (*timer_callback)(void) = NULL;
+static uint32_t timer_period_us = 0;
+static volatile uint32_t timer_start_us = 0;        // v0.6.3: 本周期起点 (换频时计算剩余时间)
+static volatile bool timer_restore_period = false;  // v0.6.3: 换频后的剩余时间段结束, 恢复完整周期
+// v0.6.3: rf_hw_timer_at - 按绝对时刻装载的单次定时; 回调中没有重新装载时到期后停止
+static volatile bool timer_oneshot = false;
+static volatile uint32_t timer_deadline_us = 0;
+static volatile uint8_t timer_arm_seq = 0;          // 每次装载递增, 中断据此判断回调是否已重新装载
+
+static uint32_t timer_ticks(uint32_t us)
+{
+    return (hal_get_sysclk_hz() / 1000000UL) * us;
+}
 
 #ifdef CH59X
 __INTERRUPT
 __HIGH_CODE
 void TMR2_IRQHandler(void)
 {
+    PROF_SCOPE(PROF_RF_TIMER_ISR);
+    
     if (TMR2_GetITFlag(TMR2_IT_CYC_END)) {
         TMR2_ClearITFlag(TMR2_IT_CYC_END);
+        if (timer_restore_period) {
+            timer_restore_period = false;
+            TMR2_TimerInit(timer_ticks(timer_period_us));
+        }
+        timer_start_us = hal_micros();
+        bool oneshot = timer_oneshot;
+        uint8_t seq = timer_arm_seq;
         if (timer_callback) {
             timer_callback();
         }
+        if (oneshot && seq == timer_arm_seq) {
+            rf_hw_stop_timer();
+        }
     }
 }
 #endif
@@ -127,14 +173,22 @@ void TMR2_IRQHandler(void)
  *============================================================================*/
 
 #ifdef CH59X
-__INTERRUPT
 __HIGH_CODE
-void RF_IRQHandler(void)
+static void rf_irq_service(void)
 {
+#if RF_HW_RX_LATCH
+    uint32_t entry_us = hal_micros();   // 在 PROF_SCOPE 和读寄存器之前取时刻
+#endif
+    PROF_SCOPE(PROF_RF_ISR);
     uint32_t status = RF_INT_FLAG;
     RF_INT_FLAG = status;  // Clear flags
     
+    if (status & (RF_INT_TX_DONE | RF_INT_RX_DONE)) {
+        rf_event = true;
+    }
+    
     if (status & RF_INT_TX_DONE) {
+        tx_done = true;
         if (tx_callback) {
             bool ack_ok = (status & RF_INT_ACK) != 0;
             tx_callback(ack_ok || !current_config.auto_ack);
@@ -142,26 +196,31 @@ void RF_IRQHandler(void)
     }
     
     if (status & RF_INT_RX_DONE) {
-        // 使用非活动缓冲区接收数据，避免竞态条件
-        uint8_t write_buf = 1 - rx_active_buf;
+#if RF_HW_RX_LATCH
+        rx_time_us = entry_us;
+#endif
+        // v0.6.3: 直接读入空闲池缓冲, 池耗尽时读空 FIFO 丢弃
+        uint8_t h = RF_HW_RX_NONE;
+        rf_hw_rx_buf_t *b = NULL;
         uint8_t len = 0;
-        
-        // Read packet from FIFO to inactive buffer
-        // 必须完全清空FIFO，即使超过64字节也要读完丢弃
+
+        if (rx_free_mask) {
+            h = (uint8_t)CTZ(rx_free_mask);
+            rx_free_mask &= ~(1UL << h);
+            b = &rx_pool[h];
+        } else {
+            rx_pool_overruns++;
+        }
+
+        // 必须完全清空FIFO，超过缓冲长度的部分读出丢弃
         while (!(RF_FIFO_STATUS & RF_FIFO_RX_EMPTY)) {
             uint8_t byte = (uint8_t)RF_RX_DATA;
-            if (len < 64) {
-                rx_buffer[write_buf][len++] = byte;
+            if (b && len < RF_HW_RX_BUF_SIZE) {
+                b->data[len++] = byte;
             }
-            // 超过64字节时继续读取但丢弃，确保FIFO完全清空
         }
         last_rssi = (int8_t)RF_RSSI;
         
-        // 原子切换缓冲区
-        rx_len = len;
-        rx_active_buf = write_buf;
-        rx_pending = true;
-        
         // Set ACK payload if available
         if (ack_payload_len > 0 && current_config.auto_ack) {
             for (uint8_t i = 0; i < ack_payload_len; i++) {
@@ -169,33 +228,39 @@ void RF_IRQHandler(void)
             }
         }
         
-        if (rx_callback && len > 0) {
-            rx_callback(rx_buffer[write_buf], len, last_rssi);
+        if (b) {
+            b->len = len;
+            b->rssi = last_rssi;
+            if (rx_callback && len > 0) {
+                rx_callback(b->data, len, last_rssi);
+            }
+            if (!(rx_pool_callback && len > 0 && rx_pool_callback(h, b))) {
+                // 未被保留: 成为最新包, 替换掉未读的上一个
+                if (rx_pending_h != RF_HW_RX_NONE) {
+                    rx_free_mask |= 1UL << rx_pending_h;
+                }
+                rx_pending_h = h;
+            }
         }
     }
 }
+
+__INTERRUPT
+__HIGH_CODE
+void RF_IRQHandler(void)
+{
+    rf_irq_service();
+}
 #endif
 
 /*============================================================================
  * Implementation
  *============================================================================*/
 
-int rf_hw_init(const rf_hw_config_t *config)
-{
-    if (!config) {
-        return -1;
-    }
-    
-    memcpy(&current_config, config, sizeof(current_config));
-    
 #ifdef CH59X
-    // Enable RF peripheral clock
-    // 注: BIT_PERI_RF在某些SDK版本中未定义，RF时钟通过其他方式启用
-    // PWR_PeriphClkCfg(ENABLE, BIT_PERI_RF);
-    
-    // Reset RF
-    RF_CTRL = 0;
-    hal_delay_ms(1);
+static void apply_config(void)
+{
+    const rf_hw_config_t *config = &current_config;
     
     // Configure packet format
     uint32_t pkt_cfg = 0;
@@ -227,6 +292,27 @@ int rf_hw_init(const rf_hw_config_t *config)
     
     // Enable interrupts
     RF_INT_EN = RF_INT_TX_DONE | RF_INT_RX_DONE | RF_INT_ACK;
+}
+#endif
+
+int rf_hw_init(const rf_hw_config_t *config)
+{
+    if (!config) {
+        return -1;
+    }
+    
+    memcpy(&current_config, config, sizeof(current_config));
+    
+#ifdef CH59X
+    // Enable RF peripheral clock
+    // 注: BIT_PERI_RF在某些SDK版本中未定义，RF时钟通过其他方式启用
+    // PWR_PeriphClkCfg(ENABLE, BIT_PERI_RF);
+    
+    // Reset RF
+    RF_CTRL = 0;
+    hal_delay_ms(1);
+    
+    apply_config();
     PFIC_EnableIRQ(BLE_IRQn);  // RF uses BLE IRQ
     
 #endif
@@ -235,6 +321,15 @@ int rf_hw_init(const rf_hw_config_t *config)
     return 0;
 }
 
+void rf_hw_reclaim(void)
+{
+#ifdef CH59X
+    if (rf_initialized) {
+        apply_config();
+    }
+#endif
+}
+
 int rf_hw_init_default(void)
 {
     // SlimeVR 默认配置
@@ -288,6 +383,20 @@ void rf_hw_set_tx_power(uint8_t power)
     current_config.tx_power = power;
 }
 
+void rf_hw_set_rate(uint8_t rate)
+{
+    if (rate == current_config.mode) return;
+#ifdef CH59X
+    RF_PKT_CFG = (RF_PKT_CFG & ~(0x03u << 4)) | ((uint32_t)(rate & 0x03) << 4);
+#endif
+    current_config.mode = rate;
+}
+
+uint8_t rf_hw_get_rate(void)
+{
+    return current_config.mode;
+}
+
 void rf_hw_set_sync_word(uint32_t sync_word)
 {
 #ifdef CH59X
@@ -431,6 +540,19 @@ int rf_hw_transmit_async(const uint8_t *data, uint8_t len)
 #endif
 }
 
+int rf_hw_transmit_wait(const uint8_t *data, uint8_t len)
+{
+    tx_done = false;
+    int ret = rf_hw_transmit_async(data, len);
+    if (ret == -3) {
+        return rf_hw_transmit(data, len);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+    return hal_wait_flag_until_us(&tx_done, hal_micros() + RF_HW_TX_TIMEOUT_US) ? 0 : -2;
+}
+
 int rf_hw_transmit_ack(const uint8_t *data, uint8_t len,
                         uint8_t *ack_buf, uint8_t *ack_len)
 {
@@ -501,28 +623,46 @@ int rf_hw_transmit_ack(const uint8_t *data, uint8_t len,
 bool rf_hw_rx_available(void)
 {
 #ifdef CH59X
-    return rx_pending || !(RF_FIFO_STATUS & RF_FIFO_RX_EMPTY);
+    return rx_pending_h != RF_HW_RX_NONE || !(RF_FIFO_STATUS & RF_FIFO_RX_EMPTY);
 #else
-    return rx_pending;
+    return rx_pending_h != RF_HW_RX_NONE;
 #endif
 }
 
+bool rf_hw_wait_rx(uint32_t deadline_us)
+{
+    while (!rf_hw_rx_available()) {
+        if ((int32_t)(deadline_us - hal_micros()) <= 0) {
+            return false;
+        }
+        // 先清标志再复查, 复查之后到的包一定会置位 rf_event
+        rf_event = false;
+        if (rf_hw_rx_available()) {
+            break;
+        }
+        hal_wait_flag_until_us(&rf_event, deadline_us);
+    }
+    return true;
+}
+
 int rf_hw_receive(uint8_t *data, uint8_t max_len, int8_t *rssi)
 {
     if (!data) {
         return -1;
     }
     
-    if (rx_pending) {
+    if (rx_pending_h != RF_HW_RX_NONE) {
         // 临界区：禁用中断以确保数据一致性
         __disable_irq();
-        uint8_t read_buf = rx_active_buf;
-        uint8_t len = (rx_len < max_len) ? rx_len : max_len;
-        memcpy(data, rx_buffer[read_buf], len);
+        uint8_t h = rx_pending_h;
+        const rf_hw_rx_buf_t *b = &rx_pool[h];
+        uint8_t len = (b->len < max_len) ? b->len : max_len;
+        memcpy(data, b->data, len);
         if (rssi) {
-            *rssi = last_rssi;
+            *rssi = b->rssi;
         }
-        rx_pending = false;
+        rx_pending_h = RF_HW_RX_NONE;
+        rx_free_mask |= 1UL << h;
         __enable_irq();
         return len;
     }
@@ -559,6 +699,18 @@ void rf_hw_set_ack_payload(const uint8_t *data, uint8_t len)
     }
 }
 
+void rf_hw_set_auto_ack(bool enable)
+{
+    current_config.auto_ack = enable;
+#ifdef CH59X
+    if (enable) {
+        RF_CTRL |= RF_CTRL_AUTO_ACK;
+    } else {
+        RF_CTRL &= ~RF_CTRL_AUTO_ACK;
+    }
+#endif
+}
+
 void rf_hw_flush_tx(void)
 {
 #ifdef CH59X
@@ -581,8 +733,12 @@ void rf_hw_flush_rx(void)
         (void)dummy;
     }
 #endif
-    rx_pending = false;
-    rx_len = 0;
+    __disable_irq();
+    if (rx_pending_h != RF_HW_RX_NONE) {
+        rx_free_mask |= 1UL << rx_pending_h;
+        rx_pending_h = RF_HW_RX_NONE;
+    }
+    __enable_irq();
 }
 
 int8_t rf_hw_get_rssi(void)
@@ -590,6 +746,15 @@ int8_t rf_hw_get_rssi(void)
     return last_rssi;
 }
 
+int8_t rf_hw_sample_rssi(void)
+{
+#ifdef CH59X
+    return (int8_t)RF_RSSI;
+#else
+    return -127;
+#endif
+}
+
 bool rf_hw_carrier_detect(void)
 {
 #ifdef CH59X
@@ -605,6 +770,31 @@ void rf_hw_set_rx_callback(rf_hw_rx_callback_t callback)
     rx_callback = callback;
 }
 
+void rf_hw_set_rx_pool_callback(rf_hw_rx_pool_callback_t callback)
+{
+    rx_pool_callback = callback;
+}
+
+const rf_hw_rx_buf_t *rf_hw_rx_buf(uint8_t handle)
+{
+    return (handle < RF_HW_RX_POOL_SIZE) ? &rx_pool[handle] : NULL;
+}
+
+void rf_hw_rx_release(uint8_t handle)
+{
+    if (handle >= RF_HW_RX_POOL_SIZE) {
+        return;
+    }
+    __disable_irq();
+    rx_free_mask |= 1UL << handle;
+    __enable_irq();
+}
+
+uint32_t rf_hw_rx_pool_overruns(void)
+{
+    return rx_pool_overruns;
+}
+
 void rf_hw_set_tx_callback(rf_hw_tx_callback_t callback)
 {
     tx_callback = callback;
@@ -655,6 +845,15 @@ uint32_t rf_hw_get_time_us(void)
     return hal_micros();
 }
 
+uint32_t rf_hw_get_rx_time_us(void)
+{
+#if RF_HW_RX_LATCH
+    return rx_time_us;
+#else
+    return hal_micros();
+#endif
+}
+
 void rf_hw_delay_us(uint32_t us)
 {
     hal_delay_us(us);
@@ -666,17 +865,45 @@ void rf_hw_start_timer(uint32_t period_us, void (*callback)(void))
     rf_hw_stop_timer();
     
     timer_callback = callback;
+    timer_period_us = period_us;
+    timer_restore_period = false;
+    timer_oneshot = false;
+    timer_arm_seq++;
+    timer_start_us = hal_micros();
     
 #ifdef CH59X
-    // Use TMR2 for slot timing
-    uint32_t ticks = (GetSysClock() / 1000000) * period_us;
-    TMR2_TimerInit(ticks);
+    // Use TMR2 for slot timing (v0.6.3: 按当前系统时钟换算, 见 rf_hw_timer_retime)
+    TMR2_TimerInit(timer_ticks(period_us));
     TMR2_ITCfg(ENABLE, TMR2_IT_CYC_END);
     PFIC_EnableIRQ(TMR2_IRQn);
 #endif
     (void)period_us;
 }
 
+void rf_hw_timer_at(uint32_t deadline_us, void (*callback)(void))
+{
+    rf_hw_stop_timer();
+    
+    // 装载量取自自由运行的 hal_micros 时基, 中断延迟只影响本次, 不累积到下一个时刻
+    uint32_t now = hal_micros();
+    int32_t remain = (int32_t)(deadline_us - now);
+    if (remain < RF_HW_TIMER_MIN_US) remain = RF_HW_TIMER_MIN_US;
+    
+    timer_callback = callback;
+    timer_period_us = (uint32_t)remain;
+    timer_restore_period = false;
+    timer_oneshot = true;
+    timer_deadline_us = deadline_us;
+    timer_arm_seq++;
+    timer_start_us = now;
+    
+#ifdef CH59X
+    TMR2_TimerInit(timer_ticks((uint32_t)remain));
+    TMR2_ITCfg(ENABLE, TMR2_IT_CYC_END);
+    PFIC_EnableIRQ(TMR2_IRQn);
+#endif
+}
+
 void rf_hw_stop_timer(void)
 {
 #ifdef CH59X
@@ -684,6 +911,29 @@ void rf_hw_stop_timer(void)
     PFIC_DisableIRQ(TMR2_IRQn);
 #endif
     timer_callback = NULL;
+    timer_restore_period = false;
+    timer_oneshot = false;
+}
+
+void rf_hw_timer_retime(void)
+{
+    if (!timer_callback) return;
+    
+#ifdef CH59X
+    __disable_irq();
+    if (timer_oneshot) {
+        // 单次定时直接按绝对时刻重算
+        int32_t left = (int32_t)(timer_deadline_us - hal_micros());
+        TMR2_TimerInit(timer_ticks(left > 0 ? (uint32_t)left : 1));
+    } else {
+        // 计数按旧时钟走过的部分不变, 剩余时间按新时钟重新装载, 到期后恢复完整周期
+        uint32_t elapsed = hal_micros() - timer_start_us;
+        uint32_t remain = (elapsed < timer_period_us) ? timer_period_us - elapsed : 1;
+        TMR2_TimerInit(timer_ticks(remain));
+        timer_restore_period = true;
+    }
+    __enable_irq();
+#endif
 }
 
 /*============================================================================
@@ -692,5 +942,19 @@ void rf_hw_stop_timer(void)
  * 启动文件向量表使用BLE_IRQHandler，这里创建别名指向RF_IRQHandler
  *============================================================================*/
 #ifdef CH59X
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+// v0.6.3: 射频时分仲裁时按当前所有者分发给私有驱动或 BLE 协议栈
+__INTERRUPT
+__HIGH_CODE
+void BLE_IRQHandler(void)
+{
+    if (rf_arbiter_owner() == RADIO_OWNER_BLE) {
+        ble_slimevr_irq_handler();
+    } else {
+        rf_irq_service();
+    }
+}
+#else
 void BLE_IRQHandler(void) __attribute__((alias("RF_IRQHandler")));
 #endif
+#endif
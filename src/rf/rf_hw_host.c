@@ -0,0 +1,269 @@
+/**
+ * @file rf_hw_host.c
+ * @brief 主机仿真射频 / Simulated radio for the host network simulator
+ *
+ * v0.6.3: 实现 rf_receiver.c 用到的 rf_hw 接口 (make netsim)
+ * - 时间取自 hal_host.c 的仿真时钟, 定时器只记录到期时刻, 由仿真主循环触发回调
+ * - 发送交给仿真程序注册的钩子 (空口模型在 main_netsim.c)
+ * - 接收: 仿真程序在包结束时刻调用 rf_hw_host_deliver, 射频处于 RX 且信道/速率
+ *   与包开始时一致才进入缓冲池并调用池回调, 与硬件中断中的处理顺序相同
+ */
+
+#include "rf_hw.h"
+#include "rf_protocol.h"
+#include "hal.h"
+#include <string.h>
+
+#if defined(BUILD_HOST)
+
+static rf_hw_config_t current_config;
+static uint8_t radio_mode = RF_MODE_STANDBY;
+static uint32_t radio_gen = 0;          // 信道/速率/模式每次变化加一
+
+static uint8_t ack_payload[RF_MAX_PAYLOAD_SIZE];
+static uint8_t ack_len = 0;
+
+static rf_hw_rx_pool_callback_t rx_pool_callback = NULL;
+static rf_hw_rx_buf_t rx_pool[RF_HW_RX_POOL_SIZE];
+static uint32_t rx_pool_free = 0;
+static uint32_t rx_pool_overrun = 0;
+static uint32_t rx_time_us = 0;
+
+static void (*timer_cb)(void) = NULL;
+static uint64_t timer_deadline = 0;
+static uint32_t timer_period = 0;       // 0 = 单次 (rf_hw_timer_at)
+
+static rf_hw_host_tx_hook_t tx_hook = NULL;
+static rf_hw_host_noise_t noise_model = NULL;
+
+static const uint8_t host_mac[6] = { 0x02, 0x48, 0x4F, 0x53, 0x54, 0x00 };
+
+static void radio_changed(void)
+{
+    radio_gen++;
+}
+
+/*============================================================================
+ * 配置
+ *============================================================================*/
+
+int rf_hw_init(const rf_hw_config_t *config)
+{
+    if (!config) return -1;
+    current_config = *config;
+    radio_mode = RF_MODE_STANDBY;
+    rx_pool_free = (RF_HW_RX_POOL_SIZE >= 32) ? 0xFFFFFFFFu : ((1u << RF_HW_RX_POOL_SIZE) - 1);
+    timer_cb = NULL;
+    ack_len = 0;
+    radio_changed();
+    return 0;
+}
+
+int rf_hw_set_channel(uint8_t channel)
+{
+    if (channel >= RF_CHANNEL_COUNT) return -1;
+    if (channel != current_config.channel) {
+        current_config.channel = channel;
+        radio_changed();
+    }
+    return 0;
+}
+
+uint8_t rf_hw_get_channel(void)
+{
+    return current_config.channel;
+}
+
+void rf_hw_set_rate(uint8_t rate)
+{
+    if (rate == current_config.mode) return;
+    current_config.mode = rate;
+    radio_changed();
+}
+
+uint8_t rf_hw_get_rate(void)
+{
+    return current_config.mode;
+}
+
+static void set_mode(uint8_t mode)
+{
+    if (mode == radio_mode) return;
+    radio_mode = mode;
+    radio_changed();
+}
+
+void rf_hw_rx_mode(void)
+{
+    set_mode(RF_MODE_RX);
+}
+
+void rf_hw_tx_mode(void)
+{
+    set_mode(RF_MODE_TX);
+}
+
+void rf_hw_standby(void)
+{
+    set_mode(RF_MODE_STANDBY);
+}
+
+void rf_hw_set_auto_ack(bool enable)
+{
+    current_config.auto_ack = enable;
+}
+
+void rf_hw_set_ack_payload(const uint8_t *data, uint8_t len)
+{
+    if (!data || len > sizeof(ack_payload)) len = 0;
+    if (len) memcpy(ack_payload, data, len);
+    ack_len = len;
+}
+
+void rf_hw_get_mac_address(uint8_t *mac)
+{
+    memcpy(mac, host_mac, sizeof(host_mac));
+}
+
+/*============================================================================
+ * 发送
+ *============================================================================*/
+
+int rf_hw_transmit(const uint8_t *data, uint8_t len)
+{
+    if (!data || len == 0 || len > RF_MAX_PAYLOAD_SIZE) return -1;
+    if (tx_hook) tx_hook(data, len, current_config.channel, current_config.mode);
+    return 0;
+}
+
+int rf_hw_transmit_async(const uint8_t *data, uint8_t len)
+{
+    return rf_hw_transmit(data, len);
+}
+
+/*============================================================================
+ * 接收缓冲池
+ *============================================================================*/
+
+void rf_hw_set_rx_pool_callback(rf_hw_rx_pool_callback_t callback)
+{
+    rx_pool_callback = callback;
+}
+
+const rf_hw_rx_buf_t *rf_hw_rx_buf(uint8_t handle)
+{
+    return (handle < RF_HW_RX_POOL_SIZE) ? &rx_pool[handle] : NULL;
+}
+
+void rf_hw_rx_release(uint8_t handle)
+{
+    if (handle < RF_HW_RX_POOL_SIZE) rx_pool_free |= 1u << handle;
+}
+
+uint32_t rf_hw_rx_pool_overruns(void)
+{
+    return rx_pool_overrun;
+}
+
+int8_t rf_hw_sample_rssi(void)
+{
+    return noise_model ? noise_model(current_config.channel) : -100;
+}
+
+/*============================================================================
+ * 定时
+ *============================================================================*/
+
+uint32_t rf_hw_get_time_us(void)
+{
+    return hal_micros();
+}
+
+uint32_t rf_hw_get_rx_time_us(void)
+{
+    return rx_time_us;
+}
+
+void rf_hw_start_timer(uint32_t period_us, void (*callback)(void))
+{
+    timer_cb = callback;
+    timer_period = period_us;
+    timer_deadline = hal_micros64() + period_us;
+}
+
+void rf_hw_timer_at(uint32_t deadline_us, void (*callback)(void))
+{
+    int32_t wait = (int32_t)(deadline_us - hal_micros());
+    if (wait < RF_HW_TIMER_MIN_US) wait = RF_HW_TIMER_MIN_US;
+    timer_cb = callback;
+    timer_period = 0;
+    timer_deadline = hal_micros64() + (uint32_t)wait;
+}
+
+void rf_hw_stop_timer(void)
+{
+    timer_cb = NULL;
+}
+
+/*============================================================================
+ * 仿真接口
+ *============================================================================*/
+
+void rf_hw_host_set_tx_hook(rf_hw_host_tx_hook_t hook)
+{
+    tx_hook = hook;
+}
+
+void rf_hw_host_set_noise(rf_hw_host_noise_t model)
+{
+    noise_model = model;
+}
+
+bool rf_hw_host_next_timer(uint64_t *deadline_us)
+{
+    if (!timer_cb) return false;
+    *deadline_us = timer_deadline;
+    return true;
+}
+
+void rf_hw_host_run_timer(void)
+{
+    void (*cb)(void) = timer_cb;
+    if (!cb || hal_micros64() < timer_deadline) return;
+
+    // 周期模式先装载下一周期, 回调中可重新装载或停止
+    if (timer_period) {
+        timer_deadline += timer_period;
+    } else {
+        timer_cb = NULL;
+    }
+    cb();
+}
+
+uint32_t rf_hw_host_radio_gen(void)
+{
+    return radio_gen;
+}
+
+int rf_hw_host_deliver(const uint8_t *data, uint8_t len, int8_t rssi, uint8_t rate, uint32_t gen)
+{
+    if (radio_mode != RF_MODE_RX || rate != current_config.mode || gen != radio_gen) return -1;
+    if (len > RF_HW_RX_BUF_SIZE) len = RF_HW_RX_BUF_SIZE;
+
+    rx_time_us = hal_micros();
+    if (!rx_pool_free) {
+        rx_pool_overrun++;
+    } else {
+        uint8_t h = (uint8_t)__builtin_ctz(rx_pool_free);
+        rx_pool_free &= ~(1u << h);
+        memcpy(rx_pool[h].data, data, len);
+        rx_pool[h].len = len;
+        rx_pool[h].rssi = rssi;
+        if (!rx_pool_callback || !rx_pool_callback(h, &rx_pool[h])) {
+            rx_pool_free |= 1u << h;
+        }
+    }
+    return current_config.auto_ack ? 1 : 0;
+}
+
+#endif /* BUILD_HOST */
@@ -0,0 +1,464 @@
+/**
+ * @file rf_ota.c
+ * @brief v0.6.3 RF 固件广播升级 (USE_RF_OTA)
+ *
+ * 接收器侧: 广播调度 (顺序轮次 + 按缺失位图补发), 镜像从自身 OTA 分区读取
+ * Tracker 侧: 块接收、写入 OTA 分区、缺失位图上报
+ *
+ * 格式见 rf_protocol.h (RF_PKT_OTA_*), 流程见 rf_ota.h
+ */
+
+#include "rf_ota.h"
+#include "ota_update.h"
+#include "hal.h"
+#include "optimize.h"         // v0.6.3: RAM_ARENA
+#include <string.h>
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+#define OTA_MAX_CHUNKS          ((OTA_MAX_SIZE + RF_OTA_CHUNK_SIZE - 1) / RF_OTA_CHUNK_SIZE)
+
+static uint16_t chunk_count(uint32_t size)
+{
+    return (uint16_t)((size + RF_OTA_CHUNK_SIZE - 1) / RF_OTA_CHUNK_SIZE);
+}
+
+// 最后一块可能不满
+static uint8_t chunk_len(uint32_t size, uint16_t chunk)
+{
+    uint32_t offset = (uint32_t)chunk * RF_OTA_CHUNK_SIZE;
+    uint32_t left = size - offset;
+    return (left > RF_OTA_CHUNK_SIZE) ? RF_OTA_CHUNK_SIZE : (uint8_t)left;
+}
+
+#ifdef BUILD_RECEIVER
+
+/*============================================================================
+ * 接收器: 广播调度
+ *============================================================================*/
+
+#define OTA_INFO_INTERVAL       32      // 每 N 次调度插入一个镜像信息包 (无数据时每帧算一次)
+#define OTA_LISTEN_RETRY_MS     1000    // 在线但未上报的 tracker 重发 LISTEN 命令的间隔
+
+// 待补发位图: 主循环按状态包写入, 中断发送后清位
+typedef struct {
+    uint16_t base;
+    uint32_t missing;
+} repair_t;
+
+static struct {
+    uint8_t session;                // 最近一次会话号, 0 = 从未广播
+    volatile bool active;
+    uint32_t size;
+    uint32_t crc;
+    uint16_t chunks;
+    volatile uint16_t cursor;       // 本轮下一个顺序块
+    uint8_t info_left;              // 距下一个信息包的调度次数
+    uint8_t repair_rr;              // 补发轮询起点
+    bool pass_done;                 // 本轮顺序发送已结束
+    uint32_t pass_end_ms;
+    uint32_t listen_ms;
+} ota_tx;
+
+static repair_t repair[RF_MAX_TRACKERS] RAM_ARENA(rf_ota);
+static rf_ota_progress_t progress[RF_MAX_TRACKERS] RAM_ARENA(rf_ota);
+static uint32_t report_missing[RF_MAX_TRACKERS] RAM_ARENA(rf_ota);   // 最近状态包的原始位图
+
+int rf_ota_broadcast_start(void)
+{
+    if (ota_get_state() != OTA_COMPLETE) return -1;
+    uint32_t size = ota_get_size();
+    if (size == 0 || size > OTA_MAX_SIZE) return -1;
+
+    ota_tx.active = false;
+    memset(repair, 0, sizeof(repair));
+    memset(progress, 0, sizeof(progress));
+    memset(report_missing, 0, sizeof(report_missing));
+
+    ota_tx.session = (ota_tx.session == 0xFF) ? 1 : ota_tx.session + 1;
+    ota_tx.size = size;
+    ota_tx.crc = ota_get_crc();
+    ota_tx.chunks = chunk_count(size);
+    ota_tx.cursor = 0;
+    ota_tx.info_left = 0;
+    ota_tx.repair_rr = 0;
+    ota_tx.pass_done = false;
+    ota_tx.listen_ms = hal_millis() - OTA_LISTEN_RETRY_MS;
+    ota_tx.active = true;
+
+    return ota_tx.session;
+}
+
+void rf_ota_broadcast_stop(rf_receiver_ctx_t *ctx)
+{
+    ota_tx.active = false;
+    rf_receiver_broadcast_command(ctx, RF_CMD_OTA_LISTEN, 0);
+}
+
+bool rf_ota_broadcast_active(void)
+{
+    return ota_tx.active;
+}
+
+// 同一块在其他 tracker 的窗口里也清掉 (组播一次全部受益)
+static void repair_clear(uint16_t chunk)
+{
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        repair_t *r = &repair[i];
+        if (r->missing && chunk >= r->base && chunk - r->base < RF_OTA_REPORT_BITS) {
+            r->missing &= ~((uint32_t)1 << (chunk - r->base));
+        }
+    }
+}
+
+static uint16_t repair_pick(void)
+{
+    for (uint8_t n = 0; n < RF_MAX_TRACKERS; n++) {
+        repair_t *r = &repair[ota_tx.repair_rr];
+        if (++ota_tx.repair_rr >= RF_MAX_TRACKERS) ota_tx.repair_rr = 0;
+
+        for (uint8_t k = 0; r->missing && k < RF_OTA_REPORT_BITS; k++) {
+            uint32_t bit = (uint32_t)1 << k;
+            if (!(r->missing & bit)) continue;
+            r->missing &= ~bit;
+
+            // 本轮还没发到的块留给顺序发送
+            uint16_t chunk = r->base + k;
+            if (chunk >= ota_tx.cursor || chunk >= ota_tx.chunks) continue;
+
+            repair_clear(chunk);
+            return chunk;
+        }
+    }
+    return RF_OTA_CHUNK_NONE;
+}
+
+uint8_t rf_ota_next_packet(uint8_t *buf)
+{
+    if (!ota_tx.active) return 0;
+
+    if (ota_tx.info_left == 0) {
+        ota_tx.info_left = OTA_INFO_INTERVAL;
+
+        rf_ota_info_packet_t *info = (rf_ota_info_packet_t *)buf;
+        info->header.type = RF_PKT_OTA_INFO;
+        info->header.length = sizeof(rf_ota_info_packet_t) - sizeof(rf_header_t);
+        info->session = ota_tx.session;
+        info->image_size = ota_tx.size;
+        info->image_crc = ota_tx.crc;
+        info->crc = rf_calc_crc16(info, sizeof(rf_ota_info_packet_t) - 2);
+        return sizeof(rf_ota_info_packet_t);
+    }
+    ota_tx.info_left--;
+
+    // 补发优先, 其次本轮顺序块
+    uint16_t chunk = repair_pick();
+    if (chunk == RF_OTA_CHUNK_NONE) {
+        if (ota_tx.cursor >= ota_tx.chunks) return 0;
+        chunk = ota_tx.cursor++;
+    }
+
+    rf_ota_data_packet_t *pkt = (rf_ota_data_packet_t *)buf;
+    pkt->header.type = RF_PKT_OTA_DATA;
+    pkt->header.length = sizeof(rf_ota_data_packet_t) - sizeof(rf_header_t);
+    pkt->session = ota_tx.session;
+    pkt->chunk = chunk;
+    memset(pkt->data, 0xFF, RF_OTA_CHUNK_SIZE);
+    ota_read((uint32_t)chunk * RF_OTA_CHUNK_SIZE, pkt->data, chunk_len(ota_tx.size, chunk));
+    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_ota_data_packet_t) - 2);
+    return sizeof(rf_ota_data_packet_t);
+}
+
+void rf_ota_on_status(const rf_ota_status_packet_t *pkt)
+{
+    if (pkt->tracker_id >= RF_MAX_TRACKERS) return;
+    if (!ota_tx.active || pkt->session != ota_tx.session) return;
+
+    uint8_t id = pkt->tracker_id;
+    progress[id].seen = true;
+    progress[id].flags = pkt->flags;
+    progress[id].base = pkt->base;
+    progress[id].last_ms = hal_millis();
+    report_missing[id] = (pkt->base == RF_OTA_CHUNK_NONE) ? 0 : pkt->missing;
+
+    __disable_irq();
+    repair[id].base = pkt->base;
+    repair[id].missing = report_missing[id];
+    __enable_irq();
+}
+
+void rf_ota_receiver_task(rf_receiver_ctx_t *ctx)
+{
+    if (!ota_tx.active) return;
+
+    uint32_t now = hal_millis();
+
+    // tracker 可能晚于广播开始上线, LISTEN 命令随 ACK 下发
+    if (now - ota_tx.listen_ms >= OTA_LISTEN_RETRY_MS) {
+        ota_tx.listen_ms = now;
+        for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+            if (ctx->trackers[i].connected && !progress[i].seen &&
+                rf_receiver_command_pending(i) == 0) {
+                rf_receiver_send_command(ctx, i, RF_CMD_OTA_LISTEN, ota_tx.session);
+            }
+        }
+    }
+
+    if (ota_tx.cursor < ota_tx.chunks) return;
+    if (!ota_tx.pass_done) {
+        ota_tx.pass_done = true;
+        ota_tx.pass_end_ms = now;
+        return;
+    }
+
+    // 一轮结束: 补发窗口整段缺失 (晚加入或长时间丢包) 的 tracker 从其首个缺失块重新顺序发送;
+    // 只采用本轮结束后的状态包, 且等中断把零散补发发完
+    uint16_t restart = RF_OTA_CHUNK_NONE;
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (repair[i].missing) return;
+
+        const rf_ota_progress_t *p = &progress[i];
+        if (!ctx->trackers[i].connected || !p->seen) continue;
+        if ((int32_t)(p->last_ms - ota_tx.pass_end_ms) <= 0) continue;
+        if (report_missing[i] == 0xFFFFFFFF && p->base < restart) {
+            restart = p->base;
+        }
+    }
+
+    if (restart < ota_tx.chunks) {
+        __disable_irq();
+        ota_tx.cursor = restart;
+        __enable_irq();
+        ota_tx.pass_done = false;
+    }
+}
+
+uint8_t rf_ota_broadcast_status(uint16_t *cursor, uint16_t *chunks)
+{
+    if (cursor) *cursor = ota_tx.cursor;
+    if (chunks) *chunks = ota_tx.chunks;
+    return ota_tx.active ? ota_tx.session : 0;
+}
+
+bool rf_ota_get_progress(uint8_t tracker_id, rf_ota_progress_t *out)
+{
+    if (tracker_id >= RF_MAX_TRACKERS || !out) return false;
+    *out = progress[tracker_id];
+    return true;
+}
+
+#else
+
+/*============================================================================
+ * Tracker: 块接收与上报
+ * rf_ota_on_packet 可能在射频接收中断中调用: 块队列单生产者 (中断) / 单消费者
+ * (rf_ota_task), 阶段切换前先准备好状态, 不需要关中断
+ *============================================================================*/
+
+#define OTA_QUEUE_DEPTH         16      // 接收窗口 → rf_ota_task 写 Flash 的块队列
+
+typedef enum {
+    RX_OTA_IDLE = 0,
+    RX_OTA_WAIT_INFO,               // 已收到 LISTEN, 等镜像信息包
+    RX_OTA_START,                   // 等主循环开始写入分区 (ota_start)
+    RX_OTA_RECEIVING,
+    RX_OTA_VERIFIED,
+    RX_OTA_ERROR,
+} rx_ota_phase_t;
+
+static struct {
+    volatile uint8_t phase;
+    uint8_t session;
+    uint32_t size;
+    uint32_t crc;
+    uint16_t chunks;
+    uint16_t written;               // 已写入 Flash 的块数
+    uint16_t first_missing;         // 位图扫描起点
+    uint8_t report_left;            // 距下一个状态包的发送帧数
+    volatile uint8_t q_w;           // 块队列写位置 (rf_ota_on_packet)
+    volatile uint8_t q_r;           // 块队列读位置 (rf_ota_task)
+} ota_rx;
+
+static uint8_t chunk_map[(OTA_MAX_CHUNKS + 7) / 8];    // bit = 已收到 (入队即置位)
+
+static struct {
+    uint16_t chunk;
+    uint8_t data[RF_OTA_CHUNK_SIZE];
+} chunk_queue[OTA_QUEUE_DEPTH];
+
+static bool map_get(uint16_t chunk)
+{
+    return (chunk_map[chunk >> 3] >> (chunk & 7)) & 1;
+}
+
+void rf_ota_listen(uint8_t session)
+{
+    if (session == 0) {
+        ota_rx.phase = RX_OTA_IDLE;
+        return;
+    }
+    if (session == ota_rx.session && ota_rx.phase != RX_OTA_IDLE) return;
+
+    ota_rx.session = session;
+    ota_rx.phase = RX_OTA_WAIT_INFO;
+    ota_rx.report_left = 0;
+}
+
+bool rf_ota_listening(void)
+{
+    return ota_rx.phase == RX_OTA_WAIT_INFO || ota_rx.phase == RX_OTA_RECEIVING;
+}
+
+void rf_ota_on_packet(const uint8_t *data, uint8_t len)
+{
+    if (ota_rx.phase == RX_OTA_IDLE) return;
+
+    if (data[0] == RF_PKT_OTA_INFO) {
+        if (len < sizeof(rf_ota_info_packet_t)) return;
+        const rf_ota_info_packet_t *info = (const rf_ota_info_packet_t *)data;
+        if (rf_calc_crc16(info, sizeof(rf_ota_info_packet_t) - 2) != info->crc) return;
+        if (info->session != ota_rx.session || ota_rx.phase != RX_OTA_WAIT_INFO) return;
+
+        if (info->image_size == 0 || info->image_size > OTA_MAX_SIZE) {
+            ota_rx.phase = RX_OTA_ERROR;
+            return;
+        }
+        ota_rx.size = info->image_size;
+        ota_rx.crc = info->image_crc;
+        ota_rx.chunks = chunk_count(info->image_size);
+        ota_rx.phase = RX_OTA_START;
+        return;
+    }
+
+    if (data[0] == RF_PKT_OTA_DATA) {
+        if (len < sizeof(rf_ota_data_packet_t)) return;
+        const rf_ota_data_packet_t *pkt = (const rf_ota_data_packet_t *)data;
+        if (rf_calc_crc16(pkt, sizeof(rf_ota_data_packet_t) - 2) != pkt->crc) return;
+        if (pkt->session != ota_rx.session || ota_rx.phase != RX_OTA_RECEIVING) return;
+
+        uint16_t chunk = pkt->chunk;
+        if (chunk >= ota_rx.chunks || map_get(chunk)) return;
+        uint8_t next = (ota_rx.q_w + 1) % OTA_QUEUE_DEPTH;
+        if (next == ota_rx.q_r) return;     // 队列满, 丢弃, 由补发找回
+
+        chunk_queue[ota_rx.q_w].chunk = chunk;
+        memcpy(chunk_queue[ota_rx.q_w].data, pkt->data, RF_OTA_CHUNK_SIZE);
+        chunk_map[chunk >> 3] |= (uint8_t)(1 << (chunk & 7));
+        ota_rx.q_w = next;
+    }
+}
+
+uint8_t rf_ota_build_status(uint8_t tracker_id, uint8_t *buf)
+{
+    if (ota_rx.phase == RX_OTA_IDLE) return 0;
+    if (ota_rx.report_left > 0) {
+        ota_rx.report_left--;
+        return 0;
+    }
+    ota_rx.report_left = RF_OTA_REPORT_FRAMES - 1;
+
+    rf_ota_status_packet_t *pkt = (rf_ota_status_packet_t *)buf;
+    pkt->header.type = RF_PKT_OTA_STATUS;
+    pkt->header.length = sizeof(rf_ota_status_packet_t) - sizeof(rf_header_t);
+    pkt->tracker_id = tracker_id;
+    pkt->session = ota_rx.session;
+    pkt->flags = 0;
+    pkt->base = 0;
+    pkt->missing = 0;
+
+    switch (ota_rx.phase) {
+        case RX_OTA_RECEIVING: {
+            pkt->flags = RF_OTA_FLAG_READY;
+            while (ota_rx.first_missing < ota_rx.chunks && map_get(ota_rx.first_missing)) {
+                ota_rx.first_missing++;
+            }
+            if (ota_rx.first_missing >= ota_rx.chunks) {
+                pkt->base = RF_OTA_CHUNK_NONE;     // 全部收到, 尚在写入/校验
+                break;
+            }
+            pkt->base = ota_rx.first_missing;
+            for (uint8_t k = 0; k < RF_OTA_REPORT_BITS; k++) {
+                uint32_t c = (uint32_t)pkt->base + k;
+                if (c < ota_rx.chunks && !map_get((uint16_t)c)) {
+                    pkt->missing |= (uint32_t)1 << k;
+                }
+            }
+            break;
+        }
+        case RX_OTA_VERIFIED:
+            pkt->flags = RF_OTA_FLAG_READY | RF_OTA_FLAG_VERIFIED;
+            pkt->base = RF_OTA_CHUNK_NONE;
+            break;
+        case RX_OTA_ERROR:
+            pkt->flags = RF_OTA_FLAG_ERROR;
+            pkt->base = RF_OTA_CHUNK_NONE;
+            break;
+        default:
+            break;
+    }
+
+    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_ota_status_packet_t) - 2);
+    return sizeof(rf_ota_status_packet_t);
+}
+
+void rf_ota_apply(uint8_t session)
+{
+    if (ota_rx.phase != RX_OTA_VERIFIED || session != ota_rx.session) return;
+
+    if (ota_apply() == 0) {
+        hal_reset();
+    }
+    ota_rx.phase = RX_OTA_ERROR;
+}
+
+void rf_ota_task(void)
+{
+    switch (ota_rx.phase) {
+        case RX_OTA_START:
+            ota_abort();
+            if (ota_start(ota_rx.size, ota_rx.crc) != 0) {
+                ota_rx.phase = RX_OTA_ERROR;
+                break;
+            }
+            memset(chunk_map, 0, sizeof(chunk_map));
+            ota_rx.written = 0;
+            ota_rx.first_missing = 0;
+            ota_rx.q_w = 0;
+            ota_rx.q_r = 0;
+            ota_rx.report_left = 0;
+            ota_rx.phase = RX_OTA_RECEIVING;
+            break;
+
+        case RX_OTA_RECEIVING:
+            while (ota_rx.q_r != ota_rx.q_w) {
+                uint8_t r = ota_rx.q_r;
+                uint16_t chunk = chunk_queue[r].chunk;
+                if (ota_write_chunk((uint32_t)chunk * RF_OTA_CHUNK_SIZE, chunk_queue[r].data,
+                                    chunk_len(ota_rx.size, chunk)) != 0) {
+                    ota_rx.phase = RX_OTA_ERROR;
+                    return;
+                }
+                ota_rx.q_r = (r + 1) % OTA_QUEUE_DEPTH;
+                ota_rx.written++;
+            }
+            if (ota_rx.written >= ota_rx.chunks) {
+                ota_rx.phase = (ota_verify() == 0) ? RX_OTA_VERIFIED : RX_OTA_ERROR;
+                ota_rx.report_left = 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+#endif // BUILD_RECEIVER
+
+#endif // USE_RF_OTA
@@ -13,6 +13,7 @@
 #include "rf_protocol.h"
 #include "rf_hw.h"
 #include "hal.h"
+#include "channel_manager.h"
 #include <string.h>
 
 /*============================================================================
@@ -29,11 +30,9 @@
 #define RSSI_FAIR               -75
 #define RSSI_POOR               -85
 
-// 信道质量
-#define CHANNEL_COUNT           40
-#define QUALITY_HISTORY_SIZE    16
-#define BLACKLIST_THRESHOLD     50      // 低于50%成功率加入黑名单
-#define BLACKLIST_TIMEOUT_MS    30000   // 30秒后重新评估
+// 信道质量 (v0.6.3: 统计与黑名单由 channel_manager 统一维护)
+#define CHANNEL_COUNT           RF_CHANNEL_COUNT
+#define MIN_HOP_CHANNELS        8       // 可用信道少于此数时忽略黑名单
 
 // 时间同步
 #define SYNC_BEACON_INTERVAL_MS 5       // 5ms 超帧
@@ -44,16 +43,6 @@
  * 数据结构
  *============================================================================*/
 
-// 信道质量记录
-typedef struct {
-    uint8_t success_count;      // 成功次数
-    uint8_t total_count;        // 总尝试次数
-    int8_t avg_rssi;            // 平均 RSSI
-    uint32_t last_update;       // 最后更新时间
-    bool blacklisted;           // 是否黑名单
-    uint32_t blacklist_time;    // 加入黑名单时间
-} channel_quality_t;
-
 // 重传统计
 typedef struct {
     uint32_t tx_count;          // 发送总数
@@ -74,7 +63,6 @@ typedef struct {
  * 全局变量
  *============================================================================*/
 
-static channel_quality_t channels[CHANNEL_COUNT];
 static retransmit_stats_t stats;
 static link_quality_t link;
 
@@ -92,78 +80,19 @@ static uint8_t hop_index = 0;
 
 void rf_channel_init(void)
 {
-    memset(channels, 0, sizeof(channels));
+    ch_mgr_init(&ch_manager);
     memset(&stats, 0, sizeof(stats));
     memset(&link, 0, sizeof(link));
-    
-    for (int i = 0; i < CHANNEL_COUNT; i++) {
-        channels[i].avg_rssi = -100;
-    }
 }
 
 void rf_channel_update(uint8_t channel, bool success, int8_t rssi)
 {
-    if (channel >= CHANNEL_COUNT) return;
-    
-    channel_quality_t *ch = &channels[channel];
-    
-    ch->total_count++;
-    if (success) {
-        ch->success_count++;
-    }
-    
-    // 更新 RSSI (指数移动平均)
-    if (ch->avg_rssi == -100) {
-        ch->avg_rssi = rssi;
-    } else {
-        ch->avg_rssi = (ch->avg_rssi * 7 + rssi) / 8;
-    }
-    
-    ch->last_update = hal_get_tick_ms();
-    
-    // 检查是否需要加入黑名单
-    if (ch->total_count >= 10) {
-        uint8_t success_rate = (ch->success_count * 100) / ch->total_count;
-        
-        if (success_rate < BLACKLIST_THRESHOLD && !ch->blacklisted) {
-            ch->blacklisted = true;
-            ch->blacklist_time = hal_get_tick_ms();
-        }
-        
-        // 重置计数器
-        ch->success_count = success_rate;  // 保持比例
-        ch->total_count = 100;
-    }
-    
-    // 检查黑名单超时
-    if (ch->blacklisted) {
-        if ((hal_get_tick_ms() - ch->blacklist_time) > BLACKLIST_TIMEOUT_MS) {
-            ch->blacklisted = false;
-            ch->success_count = 0;
-            ch->total_count = 0;
-        }
-    }
+    ch_mgr_record_tx(&ch_manager, channel, success, rssi);
 }
 
 uint8_t rf_channel_get_quality(uint8_t channel)
 {
-    if (channel >= CHANNEL_COUNT) return 0;
-    
-    channel_quality_t *ch = &channels[channel];
-    
-    if (ch->blacklisted) return 0;
-    if (ch->total_count == 0) return 50;  // 未知
-    
-    // 综合成功率和 RSSI
-    uint8_t success_rate = (ch->success_count * 100) / ch->total_count;
-    
-    uint8_t rssi_score;
-    if (ch->avg_rssi >= RSSI_GOOD) rssi_score = 100;
-    else if (ch->avg_rssi >= RSSI_FAIR) rssi_score = 70;
-    else if (ch->avg_rssi >= RSSI_POOR) rssi_score = 40;
-    else rssi_score = 10;
-    
-    return (success_rate + rssi_score) / 2;
+    return ch_mgr_get_channel_quality(&ch_manager, channel);
 }
 
 bool rf_channel_is_good(uint8_t channel)
@@ -180,16 +109,13 @@ void rf_channel_generate_hop_sequence(uint32_t seed)
     uint8_t count = 0;
     
     for (int i = 0; i < CHANNEL_COUNT; i++) {
-        if (!channels[i].blacklisted) {
+        if (!ch_mgr_is_blacklisted(&ch_manager, i)) {
             available[count++] = i;
         }
     }
     
-    // 如果可用信道太少，重置黑名单
-    if (count < 8) {
-        for (int i = 0; i < CHANNEL_COUNT; i++) {
-            channels[i].blacklisted = false;
-        }
+    // 如果可用信道太少，忽略黑名单 (黑名单状态由 channel_manager 维护)
+    if (count < MIN_HOP_CHANNELS) {
         count = CHANNEL_COUNT;
         for (int i = 0; i < CHANNEL_COUNT; i++) {
             available[i] = i;
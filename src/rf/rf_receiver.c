@@ -6,18 +6,48 @@
  * Manages TDMA scheduling, tracker synchronization, and data aggregation.
  * 
  * v0.6.2: 支持RF Ultra高效数据包格式
+ * v0.6.3: 自适应超帧 (紧凑时隙 + 备用重传/第二样本时隙)
+ * v0.6.3: 多超帧调度 (按速率交错分配主时隙, 16-24 tracker)
+ * v0.6.3: 多样本聚合包解包到每tracker姿态时间线
+ * v0.6.3: 接收中断只入队 (SPSC), 解码在主循环 rf_receiver_process() 中完成
  */
 
 #include "rf_protocol.h"
 #include "rf_hw.h"
 #include "hal.h"
-#include "board.h"
+#include "config.h"           // MAX_TRACKERS (不依赖板级引脚, 主机 netsim 同样编译)
+#include "optimize.h"         // v0.6.3: RAM_CODE_ISR
 
-// v0.6.2: RF Ultra支持
+// v0.6.2: RF Ultra支持 (v0.6.3: 多样本聚合包同样在 rf_ultra.h 中)
 #if defined(USE_RF_ULTRA) && USE_RF_ULTRA
 #include "rf_ultra.h"
 #endif
 
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+#include "channel_manager.h"
+#endif
+
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+#include "diagnostics.h"
+#endif
+
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+#include "rf_airtime_trace.h"
+#endif
+
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+#include "rx_fusion.h"
+#endif
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+#include "rf_ota.h"
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#include "rf_auth.h"
+#endif
+
+#include <stddef.h>
 #include <string.h>
 
 // 中断控制宏 (避免与其他头文件冲突)
@@ -35,6 +65,24 @@
 #define CHANNEL_EVAL_INTERVAL_MS    10000   // Evaluate channels every 10s
 #define TRACKER_TIMEOUT_MS          500     // Mark tracker disconnected
 #define MAX_CONSECUTIVE_LOSS        5       // Max missed packets before disconnect
+#define RX_RING_SIZE                32      // ISR → 主循环包队列 (2的幂, 覆盖主循环 ~10ms 阻塞)
+#define CMD_QUEUE_DEPTH             4       // 每 tracker 待发命令数 (2的幂)
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+#define RX_AUTO_ACK                 false   // v0.6.3: 确认随下一帧信标下发
+#else
+#define RX_AUTO_ACK                 true
+#endif
+
+#if (RX_RING_SIZE & (RX_RING_SIZE - 1)) != 0
+#error "RX_RING_SIZE must be a power of 2"
+#endif
+#if defined(BUILD_RECEIVER) && (RF_HW_RX_POOL_SIZE < RX_RING_SIZE || RF_HW_RX_BUF_SIZE < RF_MAX_PAYLOAD_SIZE)
+#error "RF_HW_RX_POOL_SIZE must cover RX_RING_SIZE and RF_MAX_PAYLOAD_SIZE"
+#endif
+
+// v0.6.3: MAC → tracker ID 开放寻址索引 (线性探测, 负载 <= 50%)
+#define MAC_INDEX_SIZE              (RF_MAX_TRACKERS <= 16 ? 32 : 64)
+#define MAC_INDEX_EMPTY             0xFF
 
 /*============================================================================
  * Static Variables
@@ -43,198 +91,2488 @@
 static rf_receiver_ctx_t *rx_ctx = NULL;
 static rf_rx_data_callback_t data_callback = NULL;
 static rf_rx_connect_callback_t connect_callback = NULL;
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+static rf_rx_forward_callback_t forward_callback = NULL;
+#endif
 
 // Slot timing
 static volatile uint8_t current_slot = 0;
 static volatile bool slot_active = false;
 static volatile bool sync_sent = false;
 
-// Pending command for tracker
-static struct {
-    uint8_t tracker_id;
-    rf_command_t command;
-    uint8_t param;
-    bool pending;
-} pending_cmd = {0};
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+// v0.6.3: 组休眠 - 主循环写, 定时器中断读 (announce_left 仅中断递减)
+static volatile bool doze_active = false;
+static volatile uint8_t doze_announce_left = 0;
+#define DOZE_SLOT_END               0xFF    // current_slot 置为此值: 本帧不开数据时隙
+#endif
+
+#if defined(USE_RF_BEACON_PREBUILD) && USE_RF_BEACON_PREBUILD
+// v0.6.3: 下一帧信标 - 帧末由定时器中断构建, 帧起点直接发送 (仅中断读写, 跳频表重建时作废)
+static rf_sync_packet_t beacon_next;
+static uint16_t beacon_next_frame = 0;
+static uint8_t beacon_next_state = 0;
+static bool beacon_next_doze = false;
+static volatile bool beacon_next_ready = false;
+#endif
+
+// v0.6.3: 帧结束事件 - 超帧最后一个时隙结束时由定时器中断置位, 主循环据此组装 USB 报告
+static volatile uint16_t frame_event_frame = 0;     // 最近完成的帧号
+static volatile uint8_t frame_event_seq = 0;        // 仅中断写
+static uint8_t frame_event_seen = 0;                // 仅主循环写
+
+// v0.6.3: 每个 tracker 一个命令队列, 随该 tracker 时隙的 ACK 逐条下发,
+// 各 tracker 互不覆盖, 一次配置下发到全部 tracker 只需一个超帧
+// 时隙开始时队首装入 ACK, 本时隙收到包 (自动应答已发出) 才出队, 未发出的下一时隙重发
+typedef struct {
+    uint8_t command[CMD_QUEUE_DEPTH];
+    uint8_t param[CMD_QUEUE_DEPTH];
+    volatile uint8_t head;      // 中断出队; 主循环只在临界区内插队
+    volatile uint8_t tail;      // 仅主循环写
+} cmd_queue_t;
+
+static cmd_queue_t cmd_queue[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+static volatile uint8_t cmd_offer_owner = 0xFF;     // 当前时隙 ACK 携带了队首命令的 tracker
+
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+// v0.6.3: 组确认 - 本帧各时隙收到包的位图 (中断置位), 下一帧信标取走;
+// 命令改由信标携带, cmd_offer_owner 改为 "本帧信标命令的目标"
+static volatile rf_tracker_mask_t gack_rx_mask = 0;
+static volatile uint8_t gack_rx_spare = 0;          // bit k = 第 k 个备用时隙
+static uint8_t gack_idle_rr = 0;                    // 空闲命令 (功率/FEC) 轮转到的 tracker
+#endif
 
 // Statistics
 static uint32_t slot_start_time_us;
 
+// v0.6.3: 链路统计, 计数在解码时累计, 窗口桶由 rf_receiver_process() 轮转
+typedef struct {
+    uint16_t rx, lost, dup, late;
+} link_bucket_t;
+
+static rf_link_stats_t link_stats[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+static link_bucket_t link_bucket[RF_MAX_TRACKERS][RF_LINK_BUCKETS] RAM_ARENA(rf_receiver);
+static link_bucket_t link_sum[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);         // 除当前桶外的窗口和
+static uint8_t link_bucket_idx = 0;
+static uint32_t link_bucket_ms = 0;
+
+// v0.6.3: ISR → 主循环单生产者/单消费者包队列
+// ISR 只保留 rf_hw 接收缓冲 (零拷贝, 按句柄) 和接收时刻的帧上下文, 解码/浮点转换/
+// tracker 状态更新全部在 rf_receiver_process() 中完成, 解码后归还缓冲,
+// 主循环读取 trackers[] 不会读到半更新的数据
+typedef struct {
+    uint8_t buf;                    // rf_hw 接收缓冲句柄
+    uint16_t frame;                 // 接收时的超帧号
+#if (defined(USE_RF_FEC) && USE_RF_FEC) || (defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH)
+    uint8_t owner;                  // 接收时的时隙归属 (0xFF = 非数据时隙)
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    uint8_t attempt;                // 0 = 主时隙, 1 + k = 第 k 个备用时隙 (nonce)
+    uint32_t epoch;                 // 接收时的认证纪元
+#endif
+    uint32_t rx_us;                 // 接收时刻
+    uint32_t frame_start_us;        // 接收时的超帧起点
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    uint8_t channel;                // 接收时的信道 (映射后)
+#endif
+} rx_ring_entry_t;
+
+static rx_ring_entry_t rx_ring[RX_RING_SIZE];
+static volatile uint8_t rx_ring_head = 0;   // 仅 ISR 写
+static volatile uint8_t rx_ring_tail = 0;   // 仅主循环写
+static volatile uint32_t rx_ring_dropped = 0;
+
+// 当前解码包的帧上下文 (timeline_push 使用)
+static uint16_t decode_frame = 0;
+static uint32_t decode_frame_start_us = 0;
+#if defined(USE_RF_FEC) && USE_RF_FEC
+static uint8_t decode_owner = 0xFF;
+#endif
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+static uint8_t decode_channel = 0;
+#endif
+#if defined(USE_RF_ULTRA) && USE_RF_ULTRA && \
+    defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+// v0.6.3: Ultra 包没有序列号, 备用时隙重传按帧号 + 内容去重
+static uint16_t ultra_last_frame[RF_MAX_TRACKERS];
+#endif
+
+// v0.6.3: 每tracker姿态时间线 (主循环解码时写入, 主循环读取)
+static struct {
+    rf_timeline_sample_t samples[RF_TIMELINE_DEPTH];
+    uint8_t head;                   // 下一个写入位置
+    uint8_t count;
+} timeline[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+// v0.6.3: 自适应超帧布局 (帧开始时由 build_slot_layout 生成)
+static uint8_t slot_owner[RF_FRAME_SLOT_MAX];       // 时隙 -> tracker_id
+static uint8_t slot_total = 0;                      // 本帧数据时隙数
+static uint8_t slot_primary = 0;                    // 其中主时隙数
+static uint8_t spare_owner[RF_SPARE_SLOT_MAX];      // 随信标下发
+static uint8_t spare_rr = 0;                        // 第二样本轮询起点
+static volatile rf_tracker_mask_t frame_rx_mask = 0;    // 本帧已收到数据的tracker
+static rf_tracker_mask_t retx_mask = 0;                 // 上一帧未收到的tracker
+#endif
+
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+// v0.6.3: 自适应保护时间 - 到达偏移统计由 RF 中断写入, 主循环每秒评估一次
+#define GUARD_EVAL_MS           1000
+#define GUARD_MIN_SAMPLES       64      // 样本不足的tracker按最大保护时间计
+#define GUARD_MISS_STREAK       3       // 连续漏收主时隙数, 达到后立即放宽到最大
+#define GUARD_DEV_K             4       // 保护时间 = |均值 - 公共偏置| + K × 平均绝对偏差 + 余量
+#define GUARD_ARRIVAL_LIMIT_US  1000    // 超出视为非本时隙的包
+
+typedef struct {
+    int32_t mean_q4;            // 发送开始相对名义时隙开始 EWMA (1/16 us, 正值晚到)
+    uint32_t dev_q4;            // 平均绝对偏差 EWMA (1/16 us)
+    uint16_t samples;
+    uint8_t miss_streak;
+} arrival_stat_t;
+
+static arrival_stat_t arrival[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+static volatile uint8_t guard_us = RF_GUARD_MAX_US;    // 下一帧生效
+static uint16_t slot_width_us = RF_SLOT_US;             // 本帧时隙宽度 (帧开始时锁存)
+static uint8_t slot_capacity = RF_FRAME_SLOT_CAPACITY;
+static uint32_t slot_ref_us = 0;                        // tracker 侧的信标接收时刻估计
+static uint32_t guard_last_ms = 0;
+
+#define SLOT_WIDTH_US           slot_width_us
+#define SLOT_CAPACITY           slot_capacity
+#else
+#define SLOT_WIDTH_US           RF_SLOT_US
+#define SLOT_CAPACITY           RF_SLOTS_IN_FRAME(RF_SLOT_US)
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+// v0.6.3: 可变超帧速率 - 主循环选目标档, 帧末中断通告并在约定的帧边界切换
+static volatile uint8_t rate_target = 0;
+static uint32_t rate_hold_ms = 0;       // 更快一档的条件开始成立的时刻
+#endif
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+// v0.6.3: 每tracker最近 16 个序列号的接收位图 (bit k = last_sequence - k)
+#define SEQ_WINDOW_SIZE         16
+static uint16_t seq_window[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+// v0.6.3: 双姿态包中的辅助 IMU 姿态, aux_fresh 位 = 上次读取后有新值
+static int16_t aux_quat[RF_MAX_TRACKERS][4];
+static rf_tracker_mask_t aux_fresh = 0;
+#endif
+
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+// v0.6.3: 增量流参考 - 每tracker最近 RF_DELTA_HISTORY 个包的最后样本 (按序列号索引)
+typedef struct {
+    q15_t quat[4];
+    uint8_t sequence;
+    bool valid;
+} delta_ref_t;
+static delta_ref_t delta_ref[RF_MAX_TRACKERS][RF_DELTA_HISTORY] RAM_ARENA(rf_receiver);
+#endif
+
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+// v0.6.3: 分集副接收器帧跟随 (信标中断对齐, TMR2 逐帧切换信道)
+static uint8_t listen_map[5];           // 最近信标携带的后续信道
+static uint8_t listen_map_idx = 0;
+static uint8_t listen_channel = 0;      // 失步时驻留的必经信道
+static uint8_t listen_missed = 0;       // 距上次信标的帧数
+static volatile bool listen_locked = false;
+#endif
+
+#if defined(USE_RF_FEC) && USE_RF_FEC
+// v0.6.3: 每tracker本周期的比特错误事件 (CRC 失败 + FEC 纠错), 按时隙归属计数
+static uint8_t fec_err_count[RF_MAX_TRACKERS];
+static bool fec_mode[RF_MAX_TRACKERS];
+static uint32_t fec_last_ms = 0;
+#endif
+
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+// v0.6.3: 帧末空闲 RSSI 扫描 (定时器回调链, 结束后回到 slot_timer_callback)
+#define IDLE_SCAN_BUDGET_US     (RF_IDLE_SCAN_CHANNELS * RF_IDLE_SCAN_DWELL_US + RF_GUARD_TIME_US)
+static uint8_t scan_left = 0;           // 本帧剩余待扫描的跳频表项
+static uint16_t scan_frame = 0;         // 下一个扫描表项 (帧号)
+static uint8_t scan_channel = 0;        // 正在驻留的信道
+#endif
+
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+// v0.6.3: 多套件共存 - 邻居表和换车道/帧对齐请求 (主循环写, 帧末中断执行)
+typedef struct {
+    uint16_t tag;                       // 网络标签, 0 = 空
+    uint8_t lane;
+    uint32_t last_ms;
+} coex_peer_t;
+
+static coex_peer_t coex_peers[RF_COEX_MAX_PEERS];
+static uint16_t coex_tag = 0;           // 本网络标签
+static volatile bool coex_switch_pending = false;
+static uint8_t coex_next_lane = 0;
+static uint16_t coex_switch_frame = 0;  // 从这一帧起使用 coex_next_lane
+static volatile uint8_t coex_leader_lane = 0xFF;    // 跟随的主导者车道, 0xFF = 不跟随
+static volatile bool coex_realign = false;
+static uint32_t coex_ref_us = 0;        // 帧 coex_ref_frame 应开始的时刻
+static uint16_t coex_ref_frame = 0;
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+// v0.6.3: 链路认证纪元 - 启动时从存储的预留上限开始, 之后每次启动和帧号回绕递增,
+// (纪元, 帧号) 在接收器整个寿命内不重复
+static volatile uint32_t auth_epoch = 0;
+static bool auth_epoch_loaded = false;
+#endif
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+// v0.6.3: 帧末固件块广播 (定时器回调链, tracker 停在本帧信道接收到帧末)
+static uint8_t ota_left = 0;            // 本帧剩余可发块数
+static uint32_t ota_end_us = 0;         // 本帧广播截止时刻
+#endif
+
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+// v0.6.3: 每tracker发射功率等级 (RF_TX_POWER_xxx), 随每个 ACK 下发
+static uint8_t tx_power_level[RF_MAX_TRACKERS];
+static uint32_t power_ctrl_last_ms = 0;
+#endif
+
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+// v0.6.3: 每tracker PHY 速率 - 主循环按功率控制窗口更新, 帧开始时锁存并随信标下发
+static rf_tracker_mask_t phy_slow_mask = 0;         // 用 1Mbps 的 tracker (主循环写)
+static rf_tracker_mask_t frame_phy_mask = 0;        // 本帧布局使用的副本
+static uint8_t phy_streak[RF_MAX_TRACKERS];         // 连续满足切换条件的评估周期数
+
+#define PHY_SLOW(id)            ((frame_phy_mask >> (id)) & 1)
+// 1Mbps tracker 的第二个主时隙 (接收机保持, 不重新装载 ACK)
+#define SLOT_CONTINUES(slot)    ((slot) > 0 && (slot) < slot_primary && \
+                                 slot_owner[(slot) - 1] == slot_owner[slot])
+#else
+#define PHY_SLOW(id)            0
+#define SLOT_CONTINUES(slot)    0
+#endif
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+// v0.6.3: 多超帧调度状态
+static rf_tracker_mask_t sched_mask = 0;                // 本帧分到主时隙的tracker
+static rf_tracker_mask_t sched_active = 0;              // 上次分配相位时的活跃集合
+static bool sched_dirty = true;                         // 速率变化, 需重新分配相位
+static uint8_t sched_rr = 0;                            // 超额时的轮转起点
+#endif
+
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE
+// v0.6.3: 运动自适应速率, rate_div 由主机设定值和静止状态共同决定
+static uint8_t rate_base[RF_MAX_TRACKERS];              // 主机设定的 (运动时) 分频, 0 = 默认
+static uint32_t still_since_ms[RF_MAX_TRACKERS];
+static bool still[RF_MAX_TRACKERS];
+#endif
+
 /*============================================================================
  * Channel Hopping
  * 注: rf_calc_crc16和rf_get_hop_channel已移到rf_common.c
+ * v0.6.3: 跳帧/黑名单跳过在 rf_hop_table_build 中预先完成, 时隙中断只查表
+ *============================================================================*/
+
+uint32_t rf_get_channel_freq(uint8_t channel)
+{
+    return (RF_BASE_FREQ_MHZ + channel * RF_CHANNEL_STEP_MHZ) * 1000000;
+}
+
+void rf_receiver_update_hop_table(rf_receiver_ctx_t *ctx)
+{
+    if (!ctx) return;
+    rf_hop_table_build(ctx->network_key, ctx->channel_blacklist,
+                       sizeof(ctx->channel_blacklist));
+#if defined(USE_RF_BEACON_PREBUILD) && USE_RF_BEACON_PREBUILD
+    beacon_next_ready = false;      // 预构建信标的 channel_map 按旧跳频表
+#endif
+}
+
+/**
+ * @brief v0.6.3: 帧对应信道 - 换车道已生效但跳频表尚未在主循环重建时按新车道单独计算
+ */
+static inline uint8_t hop_channel(rf_receiver_ctx_t *ctx, uint16_t frame)
+{
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    if (coex_switch_pending && (int16_t)(frame - coex_switch_frame) >= 0) {
+        return rf_hop_lane_entry(frame, coex_next_lane, ctx->channel_blacklist,
+                                 sizeof(ctx->channel_blacklist));
+    }
+#else
+    (void)ctx;
+#endif
+    return rf_hop_table_get(frame);
+}
+
+/*============================================================================
+ * v0.6.3: Orientation Timeline
+ *============================================================================*/
+
+static void timeline_push(uint8_t id, uint32_t t_us, const int16_t quat[4])
+{
+    rf_timeline_sample_t *s = &timeline[id].samples[timeline[id].head];
+    s->t_us = t_us;
+    memcpy(s->quat, quat, sizeof(s->quat));
+    
+    // superframe_start_us 在发送信标时即为本帧起点, 帧结束时才更新为下一帧
+    // (取包入队时的快照, 解码可能已跨帧)
+    int32_t offset = (int32_t)(t_us - decode_frame_start_us);
+    if (offset > INT16_MAX) offset = INT16_MAX;
+    if (offset < INT16_MIN) offset = INT16_MIN;
+    s->frame = decode_frame;
+    s->frame_offset_us = (int16_t)offset;
+    
+    timeline[id].head = (timeline[id].head + 1) & (RF_TIMELINE_DEPTH - 1);
+    if (timeline[id].count < RF_TIMELINE_DEPTH) {
+        timeline[id].count++;       // 满时覆盖最旧样本
+    }
+}
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+/**
+ * @brief v0.6.3: 迟到 (重传恢复) 样本 - 按样本时刻归入其所在超帧,
+ * 使抖动缓冲在原播放帧输出它
+ */
+static void timeline_push_recovered(uint8_t id, uint32_t t_us, const int16_t quat[4])
+{
+    timeline_push(id, t_us, quat);
+    
+    uint8_t last = (timeline[id].head - 1) & (RF_TIMELINE_DEPTH - 1);
+    rf_timeline_sample_t *s = &timeline[id].samples[last];
+    int32_t offset = (int32_t)(t_us - decode_frame_start_us);
+    
+    while (offset < 0 && offset > -(int32_t)(RF_SEQ_LATE_FRAMES_MAX * RF_FRAME_US)) {
+        offset += RF_FRAME_US;
+        s->frame--;
+    }
+    s->frame_offset_us = (int16_t)offset;
+}
+#endif
+
+/*============================================================================
+ * v0.6.3: 链路统计
+ *============================================================================*/
+
+static void link_count_rx(uint8_t id, uint8_t lost)
+{
+    link_bucket_t *b = &link_bucket[id][link_bucket_idx];
+    link_stats[id].received++;
+    link_stats[id].lost += lost;
+    if (b->rx < 0xFFFF) b->rx++;
+    b->lost = (b->lost + lost > 0xFFFF) ? 0xFFFF : (uint16_t)(b->lost + lost);
+}
+
+static void link_count_dup(uint8_t id)
+{
+    link_bucket_t *b = &link_bucket[id][link_bucket_idx];
+    link_stats[id].duplicate++;
+    if (b->dup < 0xFFFF) b->dup++;
+}
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+/**
+ * @brief 迟到包补回: 已计入缺口的一个丢包改为收到
+ */
+static void link_count_late(uint8_t id)
+{
+    link_bucket_t *b = &link_bucket[id][link_bucket_idx];
+    link_stats[id].received++;
+    link_stats[id].late++;
+    if (link_stats[id].lost > 0) link_stats[id].lost--;
+    if (b->rx < 0xFFFF) b->rx++;
+    if (b->late < 0xFFFF) b->late++;
+}
+#endif
+
+static uint8_t link_pct(uint32_t n, uint32_t total)
+{
+    if (total == 0) return 0;
+    return (uint8_t)((n * 100 + total / 2) / total);
+}
+
+/**
+ * @brief 窗口桶轮转 (主循环, 每 RF_LINK_BUCKET_MS 一次): 更新窗口比率,
+ * 最旧的桶移出窗口和后清零作为新的当前桶
+ */
+static void link_stats_update(void)
+{
+    uint32_t now = hal_millis();
+    if ((now - link_bucket_ms) < RF_LINK_BUCKET_MS) return;
+    link_bucket_ms = now;
+    
+    uint8_t next = (uint8_t)((link_bucket_idx + 1) % RF_LINK_BUCKETS);
+    
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        link_bucket_t *cur = &link_bucket[i][link_bucket_idx];
+        link_bucket_t *old = &link_bucket[i][next];
+        link_bucket_t *sum = &link_sum[i];
+        
+        // 窗口 = 之前的桶 + 刚结束的当前桶
+        uint32_t rx = sum->rx + cur->rx;
+        uint32_t lost = sum->lost + cur->lost;
+        uint32_t late = sum->late + cur->late;
+        uint32_t net_lost = (lost > late) ? lost - late : 0;
+        link_stats[i].window_loss_pct = link_pct(net_lost, rx + net_lost);
+        link_stats[i].window_dup_pct = link_pct(sum->dup + cur->dup, rx);
+        link_stats[i].window_late_pct = link_pct(late, rx);
+        
+        sum->rx += cur->rx - old->rx;
+        sum->lost += cur->lost - old->lost;
+        sum->dup += cur->dup - old->dup;
+        sum->late += cur->late - old->late;
+        memset(old, 0, sizeof(*old));
+    }
+    
+    link_bucket_idx = next;
+}
+
+static void link_stats_reset(uint8_t id)
+{
+    memset(&link_stats[id], 0, sizeof(link_stats[id]));
+    memset(link_bucket[id], 0, sizeof(link_bucket[id]));
+    memset(&link_sum[id], 0, sizeof(link_sum[id]));
+}
+
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+/*============================================================================
+ * v0.6.3: Per-tracker Hop Map
+ * 丢包按序列号缺口归到对应帧的信道; 坏信道只对该 tracker 映射走 (rf_hop_remap)
+ *============================================================================*/
+
+typedef struct {
+    uint8_t tx;                     // 发送数 (饱和时与 ack 一起减半, 每秒减半)
+    uint8_t ack;                    // 其中收到的
+    uint8_t hold_s;                 // 映射剩余时间 (秒)
+} hop_stat_t;
+
+static hop_stat_t hop_stat[RF_MAX_TRACKERS][RF_HOP_MAP_BITS] RAM_ARENA(rf_receiver);
+static uint16_t hop_bad[RF_MAX_TRACKERS];               // 按丢包率映射走的信道
+static volatile uint16_t hop_map[RF_MAX_TRACKERS];      // 实际使用并下发的映射 = hop_bad | 全局黑名单
+static volatile uint8_t hop_map_dirty[RF_MAX_TRACKERS]; // bit0/1 = 低/高字节待下发
+static uint8_t hop_map_refresh[RF_MAX_TRACKERS];        // 定期重发轮到的字节
+static uint16_t hop_last_frame[RF_MAX_TRACKERS];        // 上一个收到的包的帧号
+static uint32_t hop_update_ms = 0;
+
+#define HOP_MAP_MAX_GAP             8       // 更长的缺口多为链路中断, 不按信道统计
+
+/**
+ * @brief tracker id 在帧 frame 的时隙信道 (与 tracker 端计算一致), 可在中断中调用
+ */
+static inline uint8_t hop_slot_channel(rf_receiver_ctx_t *ctx, uint8_t id, uint16_t frame)
+{
+    return rf_hop_remap(hop_channel(ctx, frame), frame, id, hop_map[id]);
+}
+
+static void hop_stat_record(uint8_t id, uint8_t channel, bool ok)
+{
+    if (channel >= RF_CHANNEL_COUNT) return;    // rf_hw 无法调谐, 实际停在上一信道
+    int8_t idx = rf_hop_channel_index(channel);
+    if (idx < 0) return;
+    
+    hop_stat_t *s = &hop_stat[id][idx];
+    if (s->tx == 0xFF) {
+        s->tx >>= 1;
+        s->ack >>= 1;
+    }
+    s->tx++;
+    if (ok) s->ack++;
+}
+
+/**
+ * @brief 收到 tracker 的新包 (主循环解码)
+ *
+ * 只有 tracker 逐帧发送 (缺口帧数 = 丢包数) 时才能确定丢包所在的帧;
+ * 静止降速/多超帧调度的跳发和丢包无法区分, 不计丢包
+ */
+static void hop_map_on_rx(uint8_t id, uint8_t lost)
+{
+    uint16_t gap = (uint16_t)(decode_frame - hop_last_frame[id]);
+    if (lost > 0 && gap == (uint16_t)lost + 1 && lost <= HOP_MAP_MAX_GAP) {
+        for (uint8_t k = 1; k <= lost; k++) {
+            uint16_t f = (uint16_t)(decode_frame - k);
+            hop_stat_record(id, hop_slot_channel(rx_ctx, id, f), false);
+        }
+    }
+    hop_stat_record(id, decode_channel, true);
+    hop_last_frame[id] = decode_frame;
+}
+
+static uint8_t hop_good_count(uint16_t map)
+{
+    uint8_t n = 0;
+    for (uint8_t j = 0; j < RF_HOP_MAP_BITS; j++) {
+        if (!(map & (1u << j)) && rf_hop_channel_at(j) < RF_CHANNEL_COUNT) n++;
+    }
+    return n;
+}
+
+/**
+ * @brief 每秒评估一次各 tracker 的信道丢包率, 映射变化的字节标记待下发 (主循环)
+ */
+static void hop_map_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    if ((now - hop_update_ms) < 1000) return;
+    hop_update_ms = now;
+    
+    // 全局黑名单中的信道也不能用作替代信道
+    uint16_t global = 0;
+    for (uint8_t j = 0; j < RF_HOP_MAP_BITS; j++) {
+        uint8_t ch = rf_hop_channel_at(j);
+        if (ch / 8 < sizeof(ctx->channel_blacklist) &&
+            (ctx->channel_blacklist[ch / 8] & (1 << (ch % 8)))) {
+            global |= (uint16_t)(1u << j);
+        }
+    }
+    
+    for (uint8_t id = 0; id < RF_MAX_TRACKERS; id++) {
+        if (!ctx->trackers[id].active) continue;
+        
+        uint16_t bad = hop_bad[id];
+        for (uint8_t j = 0; j < RF_HOP_MAP_BITS; j++) {
+            hop_stat_t *s = &hop_stat[id][j];
+            uint16_t bit = (uint16_t)(1u << j);
+            
+            if (bad & bit) {
+                // 到期后回到该信道试用, 重新统计
+                if (s->hold_s && --s->hold_s == 0) {
+                    bad &= (uint16_t)~bit;
+                    s->tx = 0;
+                    s->ack = 0;
+                }
+            } else if (s->tx >= RF_HOP_MAP_MIN_SAMPLES &&
+                       (uint16_t)(s->tx - s->ack) * 100 > (uint16_t)s->tx * RF_HOP_MAP_LOSS_PCT &&
+                       hop_good_count(bad | global | bit) >= RF_HOP_MAP_MIN_GOOD) {
+                bad |= bit;
+                s->hold_s = RF_HOP_MAP_HOLD_S;
+            }
+            s->tx >>= 1;
+            s->ack >>= 1;
+        }
+        hop_bad[id] = bad;
+        
+        uint16_t map = bad | global;
+        uint16_t diff = map ^ hop_map[id];
+        if (diff) {
+            __disable_irq();
+            hop_map[id] = map;
+            if (diff & 0x00FF) hop_map_dirty[id] |= 1;
+            if (diff & 0xFF00) hop_map_dirty[id] |= 2;
+            __enable_irq();
+        }
+    }
+}
+
+/**
+ * @brief 取一个待下发的映射字节 (中断中, 填 ACK / 组确认命令字段)
+ * @param refresh 无变化时也重发 (轮流低/高字节)
+ * @return RF_CMD_SET_HOP_LO/HI, 无需下发时 RF_CMD_NONE
+ */
+RAM_CODE_ISR
+static uint8_t hop_map_offer(uint8_t id, bool refresh, uint8_t *param)
+{
+    uint8_t chunk;
+    
+    if (hop_map_dirty[id]) {
+        chunk = (hop_map_dirty[id] & 1) ? 0 : 1;
+        hop_map_dirty[id] &= (uint8_t)~(1u << chunk);
+    } else if (refresh) {
+        chunk = hop_map_refresh[id]++ & 1;
+    } else {
+        return RF_CMD_NONE;
+    }
+    *param = (uint8_t)(hop_map[id] >> (chunk * 8));
+    return chunk ? RF_CMD_SET_HOP_HI : RF_CMD_SET_HOP_LO;
+}
+
+static void hop_map_reset(uint8_t id)
+{
+    memset(hop_stat[id], 0, sizeof(hop_stat[id]));
+    hop_bad[id] = 0;
+    hop_map[id] = 0;
+    hop_map_dirty[id] = 0;
+}
+#endif
+
+/**
+ * @brief 序列号检查与丢包率估计
+ */
+static void update_sequence(tracker_info_t *tracker, uint8_t sequence)
+{
+    uint8_t expected_seq = tracker->last_sequence + 1;
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    if (tracker->connected) {
+        diag_update_packet_loss((uint8_t)(tracker - rx_ctx->trackers), expected_seq, sequence);
+    }
+#endif
+    uint8_t lost = 0;
+    if (sequence != expected_seq && tracker->connected) {
+        lost = sequence - expected_seq;
+        rx_ctx->lost_packets += lost;
+        tracker->packet_loss = (tracker->packet_loss * 7 + lost * 10) / 8;
+    } else {
+        tracker->packet_loss = (tracker->packet_loss * 7) / 8;
+    }
+    link_count_rx((uint8_t)(tracker - rx_ctx->trackers), lost);
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    if (tracker->connected) hop_map_on_rx((uint8_t)(tracker - rx_ctx->trackers), lost);
+#endif
+    
+    tracker->last_sequence = sequence;
+}
+
+static void mark_connected(tracker_info_t *tracker, uint8_t id)
+{
+    if (!tracker->connected) {
+        tracker->connected = true;
+        if (connect_callback) {
+            connect_callback(id, true);
+        }
+    }
+}
+
+/*============================================================================
+ * v0.6.3: MAC Index
+ * 配对请求按 MAC 找已有 ID 时不再逐个比较 6 字节; 表项只存 ID, MAC 以
+ * trackers[id].mac_address 为准. 配对/解配/上电恢复时维护, 配置里保存的
+ * MAC-ID 列表在 load_config 时经 rf_receiver_restore_pairing 重建索引
+ *============================================================================*/
+
+static uint8_t mac_index[MAC_INDEX_SIZE];
+
+static inline uint8_t mac_hash(const uint8_t mac[6])
+{
+    // FNV-1a, 高位折回低位
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        h = (h ^ mac[i]) * 16777619u;
+    }
+    return (uint8_t)((h ^ (h >> 16)) & (MAC_INDEX_SIZE - 1));
+}
+
+static void mac_index_clear(void)
+{
+    memset(mac_index, MAC_INDEX_EMPTY, sizeof(mac_index));
+}
+
+static int8_t mac_index_find(const tracker_info_t *trackers, const uint8_t mac[6])
+{
+    uint8_t pos = mac_hash(mac);
+    for (uint8_t n = 0; n < MAC_INDEX_SIZE; n++) {
+        uint8_t id = mac_index[pos];
+        if (id == MAC_INDEX_EMPTY) break;
+        if (memcmp(trackers[id].mac_address, mac, 6) == 0) return (int8_t)id;
+        pos = (pos + 1) & (MAC_INDEX_SIZE - 1);
+    }
+    return -1;
+}
+
+static void mac_index_remove(const tracker_info_t *trackers, uint8_t id)
+{
+    uint8_t pos = mac_hash(trackers[id].mac_address);
+    for (uint8_t n = 0; mac_index[pos] != id; n++) {
+        if (mac_index[pos] == MAC_INDEX_EMPTY || n == MAC_INDEX_SIZE) return;
+        pos = (pos + 1) & (MAC_INDEX_SIZE - 1);
+    }
+    
+    // 后移删除: 把探测链上后面的表项挪回空位, 不留墓碑
+    uint8_t hole = pos;
+    for (;;) {
+        pos = (pos + 1) & (MAC_INDEX_SIZE - 1);
+        uint8_t e = mac_index[pos];
+        if (e == MAC_INDEX_EMPTY) break;
+        uint8_t home = mac_hash(trackers[e].mac_address);
+        // home 不在 (hole, pos] 之间时可以挪到 hole
+        if (((pos - home) & (MAC_INDEX_SIZE - 1)) >= ((pos - hole) & (MAC_INDEX_SIZE - 1))) {
+            mac_index[hole] = e;
+            hole = pos;
+        }
+    }
+    mac_index[hole] = MAC_INDEX_EMPTY;
+}
+
+/**
+ * @note trackers[id].mac_address 须已写入
+ */
+static void mac_index_insert(const tracker_info_t *trackers, uint8_t id)
+{
+    const uint8_t *mac = trackers[id].mac_address;
+    int8_t old = mac_index_find(trackers, mac);
+    if (old == (int8_t)id) return;
+    if (old >= 0) mac_index_remove(trackers, (uint8_t)old);   // 同一 MAC 换了 ID
+    
+    uint8_t pos = mac_hash(mac);
+    while (mac_index[pos] != MAC_INDEX_EMPTY) {
+        pos = (pos + 1) & (MAC_INDEX_SIZE - 1);
+    }
+    mac_index[pos] = id;
+}
+
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+/*============================================================================
+ * v0.6.3: Slotted Pairing
+ * 配对请求 (主循环解码) 只登记到待分配表, 不立即应答; 每个配对信标后的批量应答
+ * 一次公告全部待分配项, 收到确认或公告 RF_PAIR_ANNOUNCE 次后移出.
+ * 待分配的 ID 视为已占用, 同一周期内不会分给两个 tracker
  *============================================================================*/
 
-uint32_t rf_get_channel_freq(uint8_t channel)
+typedef struct {
+    uint8_t mac[6];
+    uint8_t tracker_id;
+    uint8_t announce;               // 剩余公告次数
+} pair_pending_t;
+
+static pair_pending_t pair_pending[RF_PAIR_BATCH_MAX];
+static uint8_t pair_pending_count;
+
+static bool pair_pending_has_id(uint8_t id)
+{
+    for (uint8_t i = 0; i < pair_pending_count; i++) {
+        if (pair_pending[i].tracker_id == id) return true;
+    }
+    return false;
+}
+
+static void pair_pending_add(const rf_receiver_ctx_t *ctx, const uint8_t mac[6])
+{
+    for (uint8_t i = 0; i < pair_pending_count; i++) {
+        if (memcmp(pair_pending[i].mac, mac, 6) == 0) {
+            // 没收到批量应答的重发请求: 重新计数公告次数
+            pair_pending[i].announce = RF_PAIR_ANNOUNCE;
+            return;
+        }
+    }
+    if (pair_pending_count >= RF_PAIR_BATCH_MAX) return;  // 本周期已满, tracker 退避后重试
+    
+    // 已有表项 (MAC 索引) 或第一个未占用的 ID
+    int8_t id = mac_index_find(ctx->trackers, mac);
+    for (int i = 0; id < 0 && i < RF_MAX_TRACKERS; i++) {
+        if (!ctx->trackers[i].active && !pair_pending_has_id(i)) id = i;
+    }
+    if (id < 0) return;
+    
+    pair_pending_t *p = &pair_pending[pair_pending_count++];
+    memcpy(p->mac, mac, 6);
+    p->tracker_id = (uint8_t)id;
+    p->announce = RF_PAIR_ANNOUNCE;
+}
+
+static void pair_pending_confirm(uint8_t id)
+{
+    for (uint8_t i = 0; i < pair_pending_count; i++) {
+        if (pair_pending[i].tracker_id == id) {
+            pair_pending[i] = pair_pending[--pair_pending_count];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 配对信标之后发送批量应答 (无待分配项时 count = 0, 只作为时隙起点)
+ */
+static void send_pair_batch(rf_receiver_ctx_t *ctx)
+{
+    rf_pair_batch_t pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.header.type = RF_PKT_PAIR_BATCH;
+    pkt.header.length = sizeof(rf_pair_batch_t) - sizeof(rf_header_t);
+    rf_hw_get_mac_address(pkt.receiver_mac);
+    pkt.network_key = ctx->network_key;
+    
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < pair_pending_count; i++) {
+        pair_pending_t p = pair_pending[i];
+        if (p.announce == 0) continue;      // 公告 RF_PAIR_ANNOUNCE 次仍未确认, 放弃
+        p.announce--;
+        memcpy(pkt.assign[kept].mac_tail, &p.mac[2], 4);
+        pkt.assign[kept].tracker_id = p.tracker_id;
+        pair_pending[kept++] = p;
+    }
+    pair_pending_count = kept;
+    pkt.count = kept;
+    pkt.crc = rf_calc_crc16(&pkt, sizeof(pkt) - 2);
+    
+    rf_hw_transmit((uint8_t *)&pkt, sizeof(pkt));
+}
+#endif
+
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+/*============================================================================
+ * v0.6.3: Adaptive Superframe Layout
+ * 主时隙只分配给活跃tracker (按ID顺序紧凑排列), 剩余时隙作为备用:
+ * 先给上一帧丢包的tracker做重传, 再轮询分给其他tracker发第二样本
+ *============================================================================*/
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+static uint8_t tracker_rate_div(const tracker_info_t *t)
+{
+    return t->rate_div ? t->rate_div : RF_DEFAULT_RATE_DIV;
+}
+
+/**
+ * @brief 为每个活跃tracker分配相位, 使 RF_SCHED_CYCLE 帧内各帧负载均衡
+ * 高速率先分配, 低速率选择当前负载最轻的相位
+ */
+static void assign_phases(rf_receiver_ctx_t *ctx)
+{
+    uint8_t load[RF_SCHED_CYCLE] = {0};
+    
+    for (uint8_t div = 1; div <= RF_SCHED_CYCLE; div <<= 1) {
+        for (int i = 0; i < RF_MAX_TRACKERS; i++) {
+            tracker_info_t *t = &ctx->trackers[i];
+            if (!t->active || tracker_rate_div(t) != div) continue;
+            
+            uint8_t best = 0, best_load = 0xFF;
+            for (uint8_t p = 0; p < div; p++) {
+                uint8_t worst = 0;
+                for (uint8_t k = p; k < RF_SCHED_CYCLE; k += div) {
+                    if (load[k] > worst) worst = load[k];
+                }
+                if (worst < best_load) {
+                    best_load = worst;
+                    best = p;
+                }
+            }
+            
+            t->rate_phase = best;
+            for (uint8_t k = best; k < RF_SCHED_CYCLE; k += div) load[k]++;
+        }
+    }
+}
+
+/**
+ * @brief 本帧分到主时隙的tracker (ID 顺序), 超出容量时轮转起点保证公平
+ */
+static uint8_t schedule_primaries(rf_receiver_ctx_t *ctx)
+{
+    rf_tracker_mask_t active = 0;
+    for (int i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (ctx->trackers[i].active) active |= (rf_tracker_mask_t)1 << i;
+    }
+    if (sched_dirty || active != sched_active) {
+        assign_phases(ctx);
+        sched_active = active;
+        sched_dirty = false;
+    }
+    
+    rf_tracker_mask_t due = 0;
+    uint8_t due_count = 0;              // 所需时隙数 (1Mbps tracker 计两个)
+    for (int i = 0; i < RF_MAX_TRACKERS; i++) {
+        tracker_info_t *t = &ctx->trackers[i];
+        if (!t->active) continue;
+        if ((ctx->frame_number % tracker_rate_div(t)) != t->rate_phase) continue;
+        due |= (rf_tracker_mask_t)1 << i;
+        due_count += 1 + PHY_SLOW(i);
+    }
+    
+    if (due_count > SLOT_CAPACITY) {
+        // 超额: 从 sched_rr 开始取满容量, 被跳过的tracker下一帧优先
+        rf_tracker_mask_t picked = 0;
+        uint8_t n = 0;
+        for (int j = 0; j < RF_MAX_TRACKERS && n < SLOT_CAPACITY; j++) {
+            uint8_t id = (uint8_t)((sched_rr + j) % RF_MAX_TRACKERS);
+            if (due & ((rf_tracker_mask_t)1 << id)) {
+                if (n + 1 + PHY_SLOW(id) > SLOT_CAPACITY) break;
+                picked |= (rf_tracker_mask_t)1 << id;
+                n += 1 + PHY_SLOW(id);
+                sched_rr = (uint8_t)((id + 1) % RF_MAX_TRACKERS);
+            }
+        }
+        due = picked;
+    }
+    
+    sched_mask = due;
+    
+    uint8_t n = 0;
+    for (int i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (due & ((rf_tracker_mask_t)1 << i)) {
+            slot_owner[n++] = i;
+            if (PHY_SLOW(i)) slot_owner[n++] = i;
+        }
+    }
+    return n;
+}
+#endif
+
+static void build_slot_layout(rf_receiver_ctx_t *ctx)
+{
+    uint8_t n = 0;
+    
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    frame_phy_mask = phy_slow_mask;
+#endif
+    
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    // 保护时间只在帧边界变化, 本帧所有时隙等宽
+    slot_width_us = RF_SLOT_WIDTH_US(guard_us);
+    slot_capacity = RF_SLOTS_IN_FRAME(slot_width_us);
+    if (slot_capacity > RF_FRAME_SLOT_MAX) slot_capacity = RF_FRAME_SLOT_MAX;
+#endif
+    
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    n = schedule_primaries(ctx);
+#else
+    for (int i = 0; i < RF_MAX_TRACKERS && n < SLOT_CAPACITY; i++) {
+        if (ctx->trackers[i].active) {
+            if (n + 1 + PHY_SLOW(i) > SLOT_CAPACITY) break;
+            slot_owner[n++] = i;
+            if (PHY_SLOW(i)) slot_owner[n++] = i;
+        }
+    }
+#endif
+    
+    uint8_t primary = n;
+    uint8_t spare = SLOT_CAPACITY - primary;
+    if (spare > RF_SPARE_SLOT_MAX) spare = RF_SPARE_SLOT_MAX;
+    
+    memset(spare_owner, RF_SPARE_SLOT_FREE, sizeof(spare_owner));
+    
+    if (primary > 0) {
+        uint8_t k = 0;
+        
+        // 重传优先: 在线但上一帧没收到的tracker (1Mbps tracker 不分配备用时隙)
+        for (uint8_t j = 0; j < primary && k < spare; j++) {
+            uint8_t id = slot_owner[j];
+            if (PHY_SLOW(id)) continue;
+            if ((retx_mask & (1u << id)) && ctx->trackers[id].connected) {
+                spare_owner[k++] = id;
+            }
+        }
+        
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        bool any_fast = false;
+        for (uint8_t j = 0; j < primary; j++) {
+            if (!PHY_SLOW(slot_owner[j])) any_fast = true;
+        }
+        if (!any_fast) spare = k;
+#endif
+        
+        // 剩余备用时隙轮询分配 (第二样本)
+        while (k < spare) {
+            if (spare_rr >= primary) spare_rr = 0;
+            uint8_t id = slot_owner[spare_rr++];
+            if (PHY_SLOW(id)) continue;
+            spare_owner[k++] = id;
+        }
+        
+        for (uint8_t j = 0; j < k; j++) {
+            slot_owner[n++] = spare_owner[j];
+        }
+    }
+    
+    slot_total = n;
+    slot_primary = primary;
+}
+#endif
+
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+/*============================================================================
+ * v0.6.3: Group ACK
+ * 接收器不再在时隙内回 ACK; 时隙内收到包 (与原先硬件自动应答一样以硬件 CRC 为准)
+ * 记入位图, 下一帧信标一并下发. 每个信标带一条命令: 排队命令优先 (从轮转位置起找),
+ * 目标 tracker 在该帧发了包才出队, 否则下一帧信标重发; 没有排队命令时轮转下发
+ * 功率等级/FEC 开关 (绝对值, 每个 tracker 连续两帧各一次)
+ *============================================================================*/
+
+/**
+ * @brief 记录本时隙收到包 (RF 接收中断)
+ */
+RAM_CODE_ISR
+static void group_ack_on_rx(void)
+{
+    if (!sync_sent || current_slot == 0) return;
+    uint8_t slot = current_slot - 1;
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    if (slot >= slot_total) return;
+    uint8_t owner = slot_owner[slot];
+    if (slot < slot_primary) {
+        gack_rx_mask |= (rf_tracker_mask_t)1 << owner;
+    } else if (slot - slot_primary < RF_SPARE_SLOT_MAX) {
+        gack_rx_spare |= (uint8_t)(1u << (slot - slot_primary));
+    }
+#else
+    if (slot >= RF_MAX_TRACKERS) return;
+    uint8_t owner = slot;
+    gack_rx_mask |= (rf_tracker_mask_t)1 << owner;
+#endif
+    
+    if (owner == cmd_offer_owner) {
+        cmd_queue[owner].head++;
+        cmd_offer_owner = 0xFF;
+    }
+}
+
+/**
+ * @brief 信标中填入上一帧的接收位图和本帧命令 (帧开始, 定时器中断)
+ */
+RAM_CODE_ISR
+static void group_ack_fill(rf_receiver_ctx_t *ctx, rf_sync_packet_t *pkt)
+{
+    rf_tracker_mask_t mask = gack_rx_mask;
+    gack_rx_mask = 0;
+    for (int i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+        pkt->ack_mask[i] = (uint8_t)(mask >> (i * 8));
+    }
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    pkt->ack_spare = gack_rx_spare;
+    gack_rx_spare = 0;
+#endif
+    
+    cmd_offer_owner = 0xFF;
+    pkt->cmd_tracker = RF_GROUP_CMD_NONE;
+    if (ctx->state == RX_STATE_PAIRING) return;     // 配对信标由主循环发送, 不带命令
+    
+    for (uint8_t n = 0; n < RF_MAX_TRACKERS; n++) {
+        uint8_t id = (uint8_t)((gack_idle_rr + n) % RF_MAX_TRACKERS);
+        cmd_queue_t *q = &cmd_queue[id];
+        if (!ctx->trackers[id].active || q->head == q->tail) continue;
+        
+        pkt->cmd_tracker = id;
+        pkt->command = q->command[q->head & (CMD_QUEUE_DEPTH - 1)];
+        pkt->command_data = q->param[q->head & (CMD_QUEUE_DEPTH - 1)];
+        cmd_offer_owner = id;
+        return;
+    }
+    
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    // v0.6.3: 信道映射变化优先于 FEC/功率等级下发; 轮到的 tracker 定期重发
+    bool hop_refresh = (ctx->frame_number & (RF_HOP_MAP_REFRESH - 1)) == 0;
+    for (uint8_t n = 0; n < RF_MAX_TRACKERS; n++) {
+        uint8_t id = (uint8_t)((gack_idle_rr + n) % RF_MAX_TRACKERS);
+        if (!ctx->trackers[id].active) continue;
+        uint8_t cmd = hop_map_offer(id, n == 0 && hop_refresh, &pkt->command_data);
+        if (cmd == RF_CMD_NONE) continue;
+        pkt->cmd_tracker = id;
+        pkt->command = cmd;
+        return;
+    }
+#endif
+    
+#if (defined(USE_RF_FEC) && USE_RF_FEC) || (defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL)
+    // 偶数帧换下一个活跃 tracker, 奇数帧 FEC / 偶数帧功率等级
+    if (!(ctx->frame_number & 1)) {
+        for (uint8_t n = 1; n <= RF_MAX_TRACKERS; n++) {
+            uint8_t id = (uint8_t)((gack_idle_rr + n) % RF_MAX_TRACKERS);
+            if (ctx->trackers[id].active) {
+                gack_idle_rr = id;
+                break;
+            }
+        }
+    }
+    uint8_t id = gack_idle_rr;
+    if (!ctx->trackers[id].active) return;
+#if defined(USE_RF_FEC) && USE_RF_FEC
+    if (ctx->frame_number & 1) {
+        pkt->cmd_tracker = id;
+        pkt->command = RF_CMD_SET_FEC;
+        pkt->command_data = fec_mode[id] ? 1 : 0;
+        return;
+    }
+#endif
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    pkt->cmd_tracker = id;
+    pkt->command = RF_CMD_SET_POWER;
+    pkt->command_data = tx_power_level[id];
+#endif
+#endif
+}
+#endif
+
+/*============================================================================
+ * Packet Building
+ *============================================================================*/
+
+RAM_CODE_ISR
+static void build_sync_beacon(rf_receiver_ctx_t *ctx, rf_sync_packet_t *pkt)
+{
+    memset(pkt, 0, sizeof(rf_sync_packet_t));
+    
+    pkt->header.type = (ctx->state == RX_STATE_PAIRING) ? 
+                        RF_PKT_SYNC_PAIRING : RF_PKT_SYNC_BEACON;
+    pkt->header.length = sizeof(rf_sync_packet_t) - sizeof(rf_header_t);
+    pkt->frame_number = ctx->frame_number;
+    
+    // Build active tracker mask
+    for (int i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (ctx->trackers[i].active) {
+            pkt->active_mask[i / 8] |= (1 << (i % 8));
+        }
+    }
+    
+    // Build channel map for next 5 frames
+    for (int i = 0; i < 5; i++) {
+        pkt->channel_map[i] = hop_channel(ctx, ctx->frame_number + i + 1);
+    }
+    
+    pkt->tx_power = 7;  // Max power
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    pkt->slot_count = slot_total;
+    memcpy(pkt->spare_owner, spare_owner, RF_SPARE_SLOT_MAX);
+#endif
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    pkt->slot_guard = (uint8_t)((slot_width_us - RF_SLOT_AIR_US) / 2);
+#endif
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    pkt->frame_rate = rf_frame_rate_field();
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    pkt->roam_cell = rf_hop_table_get_cell();
+#endif
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    for (int i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+        pkt->sched_mask[i] = (uint8_t)(sched_mask >> (i * 8));
+    }
+#endif
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    for (int i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+        pkt->phy_mask[i] = (uint8_t)(frame_phy_mask >> (i * 8));
+    }
+#endif
+    
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    if (doze_active) {
+        // tracker 只听 frame % N == 0 的帧, 告诉它下一个休眠信标的信道
+        // (超出 5 帧 channel_map 后 tracker 的跳频表不含接收器黑名单)
+        uint16_t next = (uint16_t)((ctx->frame_number + GROUP_SLEEP_INTERVAL) &
+                                   ~(uint16_t)(GROUP_SLEEP_INTERVAL - 1));
+        pkt->doze_interval = GROUP_SLEEP_INTERVAL;
+        pkt->channel_map[0] = hop_channel(ctx, next);
+    }
+#endif
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    pkt->net_tag = coex_tag;
+    pkt->hop_lane = coex_switch_pending ? coex_next_lane : rf_hop_table_get_lane();
+#endif
+    
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    group_ack_fill(ctx, pkt);
+#endif
+    
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    // v0.6.3: 信标只认证; MAC 密钥由主循环按下一帧预先算好
+    pkt->auth_epoch = auth_epoch;
+    if (pkt->header.type == RF_PKT_SYNC_BEACON && rf_auth_active()) {
+        rf_auth_nonce_t nonce = {
+            .epoch = auth_epoch,
+            .frame = ctx->frame_number,
+            .tracker_id = RF_AUTH_ID_BEACON,
+            .attempt = 0,
+        };
+        rf_auth_sign(pkt->mic, (const uint8_t *)pkt, offsetof(rf_sync_packet_t, mic), &nonce);
+    }
+#endif
+    
+    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_sync_packet_t) - 2);
+}
+
+RAM_CODE_ISR
+static void build_ack_packet(rf_ack_packet_t *pkt, uint8_t tracker_id, 
+                              uint8_t sequence, rf_command_t cmd, uint8_t param)
+{
+    memset(pkt, 0, sizeof(rf_ack_packet_t));
+    
+    pkt->header.type = RF_PKT_ACK;
+    pkt->header.length = sizeof(rf_ack_packet_t) - sizeof(rf_header_t);
+    pkt->tracker_id = tracker_id;
+    pkt->ack_sequence = sequence;
+    pkt->command = cmd;
+    pkt->command_data = param;
+    
+    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_ack_packet_t) - 2);
+}
+
+/*============================================================================
+ * Slot Timer Callback
+ *============================================================================*/
+
+static void slot_timer_callback(void);
+
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+/*============================================================================
+ * v0.6.3: Adaptive Slot Guard
+ *============================================================================*/
+
+/**
+ * @brief 记录一次到达偏移 (RF 中断)
+ *
+ * RX 完成中断时刻减去包空口时间 = tracker 开始发送时刻,
+ * 与 tracker 按信标排出的名义时隙开始比较
+ */
+RAM_CODE_ISR
+static void guard_record_arrival(uint8_t slot, uint8_t len, uint32_t rx_us)
+{
+    uint8_t id = slot_owner[slot];
+    uint32_t air = RF_AIRTIME_US(len);
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    if (PHY_SLOW(id)) {
+        if (SLOT_CONTINUES(slot)) slot--;   // 1Mbps 包跨入第二个时隙才收完
+        air *= RF_PHY_1M_FACTOR;
+    }
+#endif
+    uint32_t nominal = slot_ref_us + RF_SYNC_SLOT_US + (uint32_t)slot * slot_width_us;
+    int32_t late = (int32_t)(rx_us - nominal) - (int32_t)air;
+    if (late > GUARD_ARRIVAL_LIMIT_US || late < -GUARD_ARRIVAL_LIMIT_US) return;
+    
+    arrival_stat_t *a = &arrival[id];
+    int32_t x = late * 16;
+    if (a->samples == 0) {
+        a->mean_q4 = x;
+        a->dev_q4 = 0;
+    } else {
+        int32_t d = x - a->mean_q4;
+        uint32_t ad = (d < 0) ? (uint32_t)-d : (uint32_t)d;
+        a->mean_q4 += d / 8;
+        a->dev_q4 = a->dev_q4 - a->dev_q4 / 8 + ad / 8;
+    }
+    if (a->samples < 0xFFFF) a->samples++;
+    a->miss_streak = 0;
+}
+
+/**
+ * @brief 帧结束: 在线tracker连续漏收主时隙时立即放宽 (定时器中断)
+ *
+ * 统计同时清零, 评估时该tracker按样本不足处理, 重新积累后才允许收窄
+ */
+static void guard_on_frame_end(void)
+{
+    for (uint8_t j = 0; j < slot_primary; j++) {
+        uint8_t id = slot_owner[j];
+        if (!rx_ctx->trackers[id].connected) continue;
+        if (frame_rx_mask & ((rf_tracker_mask_t)1 << id)) continue;
+        
+        arrival_stat_t *a = &arrival[id];
+        if (++a->miss_streak >= GUARD_MISS_STREAK) {
+            a->miss_streak = 0;
+            a->samples = 0;
+            guard_us = RF_GUARD_MAX_US;
+        }
+    }
+}
+
+/**
+ * @brief 按各tracker到达偏移分布评估保护时间 (主循环)
+ *
+ * 所有tracker共有的偏置 (信标发送延迟等) 整体平移时隙网格, 不影响相邻时隙,
+ * 由帧末 RF_GUARD_TIME_US 吸收; 保护时间只需覆盖各tracker相对公共偏置的偏离
+ * 放宽立即生效, 收窄每次最多 1us, 跳听信标的tracker错过一次宽度变化时
+ * 第 k 个时隙的累积误差不超过 2k us
+ */
+static void guard_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    if ((now - guard_last_ms) < GUARD_EVAL_MS) return;
+    guard_last_ms = now;
+    
+    int32_t sum = 0;
+    uint8_t count = 0;
+    bool incomplete = false;
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (!ctx->trackers[i].active || !ctx->trackers[i].connected) continue;
+        if (arrival[i].samples < GUARD_MIN_SAMPLES) {
+            incomplete = true;
+            continue;
+        }
+        sum += arrival[i].mean_q4;
+        count++;
+    }
+    
+    uint32_t need = RF_GUARD_MAX_US;
+    if (count > 0 && !incomplete) {
+        int32_t center = sum / count;
+        uint32_t worst = 0;
+        for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+            if (!ctx->trackers[i].active || !ctx->trackers[i].connected) continue;
+            int32_t off = arrival[i].mean_q4 - center;
+            uint32_t spread = ((off < 0) ? (uint32_t)-off : (uint32_t)off) +
+                              GUARD_DEV_K * arrival[i].dev_q4;
+            if (spread > worst) worst = spread;
+        }
+        need = (worst + 15) / 16 + RF_GUARD_MARGIN_US;
+    }
+    if (need < RF_GUARD_MIN_US) need = RF_GUARD_MIN_US;
+    if (need > RF_GUARD_MAX_US) need = RF_GUARD_MAX_US;
+    
+    uint8_t g = guard_us;
+    if (need >= g) {
+        g = (uint8_t)need;
+    } else {
+        g--;
+    }
+    guard_us = g;
+}
+#endif
+
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+static void scan_timer_callback(void);
+
+/**
+ * @brief v0.6.3: 切到下一个待扫描信道并开始驻留
+ * @return false 本帧扫描完成
+ */
+static bool scan_next_channel(void)
+{
+    while (scan_left > 0) {
+        scan_left--;
+        uint8_t ch = rf_hop_table_get(scan_frame++);
+        if (ch >= RF_CHANNEL_COUNT) continue;   // 超出射频范围的表项
+        
+        scan_channel = ch;
+        rf_hw_set_channel(ch);
+        rf_hw_rx_mode();
+        rf_hw_start_timer(RF_IDLE_SCAN_DWELL_US, scan_timer_callback);
+        return true;
+    }
+    return false;
+}
+
+static void scan_timer_callback(void)
+{
+    if (!rx_ctx) return;
+    
+    ch_mgr_record_rssi_scan(&ch_manager, scan_channel, rf_hw_sample_rssi());
+    
+    if (scan_next_channel()) return;
+    
+    // 扫描结束: 回到下一帧信道, 按原定超帧起点发信标
+    rf_hw_set_channel(rx_ctx->current_channel);
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+    rf_hw_timer_at(rx_ctx->superframe_start_us, slot_timer_callback);
+#else
+    int32_t wait = (int32_t)(rx_ctx->superframe_start_us - rf_hw_get_time_us());
+    if (wait < RF_GUARD_TIME_US / 4) wait = RF_GUARD_TIME_US / 4;
+    rf_hw_start_timer((uint32_t)wait, slot_timer_callback);
+#endif
+}
+#endif
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+static void ota_timer_callback(void);
+
+/**
+ * @brief v0.6.3: 发送下一个广播包
+ * @return false 本帧广播结束
+ */
+static bool ota_send_next(void)
+{
+    if (ota_left == 0) return false;
+    if ((int32_t)(ota_end_us - rf_hw_get_time_us()) < (int32_t)RF_OTA_PACKET_US) return false;
+    
+    uint8_t buf[RF_MAX_PAYLOAD_SIZE];
+    uint8_t len = rf_ota_next_packet(buf);
+    if (len == 0) return false;
+    
+    ota_left--;
+    rf_hw_tx_mode();
+    rf_hw_transmit_async(buf, len);
+    rf_hw_start_timer(RF_OTA_PACKET_US, ota_timer_callback);
+    return true;
+}
+
+static void ota_timer_callback(void)
+{
+    if (!rx_ctx) return;
+    
+    if (ota_send_next()) return;
+    
+    // 广播结束: 回到下一帧信道, 按原定超帧起点发信标
+    rf_hw_set_channel(rx_ctx->current_channel);
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+    rf_hw_timer_at(rx_ctx->superframe_start_us, slot_timer_callback);
+#else
+    int32_t wait = (int32_t)(rx_ctx->superframe_start_us - rf_hw_get_time_us());
+    if (wait < RF_GUARD_TIME_US / 4) wait = RF_GUARD_TIME_US / 4;
+    rf_hw_start_timer((uint32_t)wait, slot_timer_callback);
+#endif
+}
+#endif
+
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+/**
+ * @brief v0.6.3: 组休眠广播期过后只在 frame % N == 0 发信标, 其余帧射频空闲
+ */
+static inline bool doze_skip_frame(uint16_t frame)
+{
+    return doze_active && doze_announce_left == 0 &&
+           (frame & (GROUP_SLEEP_INTERVAL - 1)) != 0;
+}
+#endif
+
+/**
+ * @brief 构建本帧 (ctx->frame_number) 的时隙布局和同步信标
+ */
+RAM_CODE_ISR
+static void beacon_build(rf_receiver_ctx_t *ctx, rf_sync_packet_t *pkt)
+{
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    build_slot_layout(ctx);
+    frame_rx_mask = 0;
+#endif
+    build_sync_beacon(ctx, pkt);
+}
+
+#if defined(USE_RF_BEACON_PREBUILD) && USE_RF_BEACON_PREBUILD
+/**
+ * @brief v0.6.3: 帧末预构建下一帧信标 (上一帧时隙已全部结束, slot_owner 可以改写)
+ */
+RAM_CODE_ISR
+static void beacon_prebuild(rf_receiver_ctx_t *ctx)
+{
+    beacon_next_ready = false;
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    if (doze_skip_frame(ctx->frame_number)) return;     // 该帧不发信标
+    beacon_next_doze = doze_active;
+#endif
+    beacon_build(ctx, &beacon_next);
+    beacon_next_frame = ctx->frame_number;
+    beacon_next_state = (uint8_t)ctx->state;
+    beacon_next_ready = true;
+}
+
+/**
+ * @brief 帧起点取信标: 帧末之后帧号、工作状态和组休眠状态都未变时用预构建的, 否则现场构建
+ */
+RAM_CODE_ISR
+static const rf_sync_packet_t *beacon_take(rf_receiver_ctx_t *ctx)
+{
+    bool ok = beacon_next_ready &&
+              beacon_next_frame == ctx->frame_number &&
+              beacon_next_state == (uint8_t)ctx->state;
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    ok = ok && beacon_next_doze == doze_active;
+#endif
+    beacon_next_ready = false;
+    if (!ok) beacon_build(ctx, &beacon_next);
+    return &beacon_next;
+}
+#endif
+
+RAM_CODE_ISR
+static void slot_timer_callback(void)
+{
+    if (!rx_ctx) return;
+    
+    uint32_t now = rf_hw_get_time_us();
+    
+#if !(defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK)
+    // 上一时隙的 ACK 窗口已结束 (1Mbps tracker 的 ACK 在第二个时隙内)
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    if (!(sync_sent && current_slot < slot_total && SLOT_CONTINUES(current_slot)))
+#endif
+    cmd_offer_owner = 0xFF;
+#endif
+    
+    if (!sync_sent) {
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+        // v0.6.3: 组休眠 - 广播期过后只在 frame % N == 0 发信标, 其余帧射频空闲到帧末
+        if (doze_skip_frame(rx_ctx->frame_number)) {
+            rf_hw_standby();
+            sync_sent = true;
+            current_slot = DOZE_SLOT_END;
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+            rf_hw_timer_at(now + RF_SYNC_SLOT_US, slot_timer_callback);
+#else
+            rf_hw_start_timer(RF_SYNC_SLOT_US, slot_timer_callback);
+#endif
+            return;
+        }
+        if (doze_announce_left) doze_announce_left--;
+#endif
+        // Send sync beacon at start of superframe (non-blocking)
+#if defined(USE_RF_BEACON_PREBUILD) && USE_RF_BEACON_PREBUILD
+        const rf_sync_packet_t *sync_pkt = beacon_take(rx_ctx);
+#else
+        rf_sync_packet_t sync_buf;
+        const rf_sync_packet_t *sync_pkt = &sync_buf;
+        beacon_build(rx_ctx, &sync_buf);
+#endif
+        
+        rf_hw_set_channel(rx_ctx->current_channel);
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        rf_hw_set_rate(RF_MODE_2MBPS);
+#endif
+        rf_hw_tx_mode();
+        // 使用非阻塞发送，避免在定时器回调中阻塞
+        rf_hw_transmit_async((const uint8_t *)sync_pkt, sizeof(rf_sync_packet_t));
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+        // tracker 以信标接收完成时刻为基准排时隙
+        slot_ref_us = rf_hw_get_time_us() + RF_AIRTIME_US(sizeof(rf_sync_packet_t));
+#endif
+        
+        sync_sent = true;
+        current_slot = 0;
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+        if (doze_active) current_slot = DOZE_SLOT_END;  // tracker 休眠期间不发数据
+#endif
+        slot_start_time_us = now + RF_SYNC_SLOT_US;
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+        // v0.6.3: 时隙基准跟随实际信标时刻 (tracker 以信标为基准), 本帧后续时隙都从它推算
+        rf_hw_timer_at(slot_start_time_us, slot_timer_callback);
+#else
+        // v0.6.3: 定时器是周期模式, 需重新装载为同步时隙长度,
+        // 否则第一个数据时隙沿用上一帧末尾的等待时长
+        rf_hw_start_timer(RF_SYNC_SLOT_US, slot_timer_callback);
+#endif
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+        rf_trace_frame_begin(rx_ctx->frame_number, rx_ctx->superframe_start_us,
+                             now, rf_hw_get_time_us());
+#endif
+        return;
+    }
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    // v0.6.3: 只遍历本帧布局中的时隙, 每个时隙都有归属
+    if (current_slot < slot_total) {
+        uint8_t owner = slot_owner[current_slot];
+        if (rx_ctx->trackers[owner].active && !SLOT_CONTINUES(current_slot)) {
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+            rf_hw_set_rate(PHY_SLOW(owner) ? RF_MODE_1MBPS : RF_MODE_2MBPS);
+#endif
+#else
+    // Check if current slot is for an active tracker
+    if (current_slot < RF_MAX_TRACKERS) {
+        uint8_t owner = current_slot;
+        if (rx_ctx->trackers[owner].active) {
+#endif
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            // v0.6.3: 该 tracker 的映射信道 (与 tracker 端 rf_hop_remap 一致)
+            uint8_t slot_ch = hop_slot_channel(rx_ctx, owner, rx_ctx->frame_number);
+            if (slot_ch != rf_hw_get_channel()) rf_hw_set_channel(slot_ch);
+#endif
+            // Switch to RX mode for this tracker's slot
+            rf_hw_rx_mode();
+            
+#if !(defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK)
+            // Prepare ACK payload
+            rf_ack_packet_t ack;
+            rf_command_t cmd = RF_CMD_NONE;
+            uint8_t param = 0;
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            uint8_t hop_cmd;
+#endif
+            
+            cmd_queue_t *q = &cmd_queue[owner];
+            if (q->head != q->tail) {
+                cmd = (rf_command_t)q->command[q->head & (CMD_QUEUE_DEPTH - 1)];
+                param = q->param[q->head & (CMD_QUEUE_DEPTH - 1)];
+                cmd_offer_owner = owner;
+            }
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            else if ((hop_cmd = hop_map_offer(owner,
+                          (rx_ctx->frame_number & (RF_HOP_MAP_REFRESH - 1)) == 0,
+                          &param)) != RF_CMD_NONE) {
+                // v0.6.3: 信道映射变化后优先下发, 无变化时定期重发
+                cmd = (rf_command_t)hop_cmd;
+            }
+#endif
+#if defined(USE_RF_FEC) && USE_RF_FEC
+            else if (rx_ctx->frame_number & 1) {
+                // v0.6.3: 空闲命令字段奇数帧携带 FEC 开关 (偶数帧留给功率等级)
+                cmd = RF_CMD_SET_FEC;
+                param = fec_mode[owner] ? 1 : 0;
+            }
+#endif
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+            else {
+                // v0.6.3: 空闲的命令字段携带功率等级 (绝对值, 重复下发无副作用)
+                cmd = RF_CMD_SET_POWER;
+                param = tx_power_level[owner];
+            }
+#endif
+            
+            build_ack_packet(&ack, owner, 
+                             rx_ctx->trackers[owner].last_sequence + 1,
+                             cmd, param);
+            rf_hw_set_ack_payload((uint8_t *)&ack, sizeof(ack));
+#endif
+        }
+        
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+        rf_trace_slot_begin(current_slot,
+                            rx_ctx->trackers[owner].active ? owner : RF_TRACE_OWNER_NONE,
+                            now, rf_hw_get_time_us());
+#endif
+        
+        // P0-1: 使用临界区保护slot递增操作
+        __disable_irq();
+        current_slot++;
+        __enable_irq();
+        
+        // Schedule next slot
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+        rf_hw_timer_at(slot_start_time_us + (uint32_t)current_slot * SLOT_WIDTH_US,
+                       slot_timer_callback);
+#else
+        rf_hw_start_timer(SLOT_WIDTH_US, slot_timer_callback);
+#endif
+    } else {
+        // End of frame - prepare for next superframe
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+        rf_trace_frame_end(now);
+#endif
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        rf_hw_set_rate(RF_MODE_2MBPS);     // 帧末广播/扫描和下一帧信标都是 2Mbps
+#endif
+        // P1-3: 使用临界区保护帧号递增
+        __disable_irq();
+        frame_event_frame = rx_ctx->frame_number;
+        frame_event_seq++;
+        rx_ctx->frame_number++;
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        if (rx_ctx->frame_number == 0) auth_epoch++;
+#endif
+        __enable_irq();
+        rx_ctx->current_channel = hop_channel(rx_ctx, rx_ctx->frame_number);
+        sync_sent = false;
+        
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+        // 记录本帧未收到的tracker, 下一帧优先分配重传时隙
+        retx_mask = 0;
+        for (uint8_t j = 0; j < slot_total; j++) {
+            uint8_t id = slot_owner[j];
+            if (!(frame_rx_mask & (1u << id))) retx_mask |= (1u << id);
+        }
+#endif
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+        guard_on_frame_end();
+#endif
+        
+        // v0.4.22 P0-2: 强制固定5000us超帧周期
+        // 计算本帧实际用时，确保下一帧严格在5000us后开始
+        uint32_t frame_elapsed = now - rx_ctx->superframe_start_us;
+        uint32_t next_frame_delay;
+        
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+        // v0.6.3: 帧起点沿固定栅格推进 (不以本次回调时刻为基准), 超时后才重新对齐到当前时刻
+        if (frame_elapsed + RF_GUARD_TIME_US <= RF_FRAME_US) {
+            next_frame_delay = RF_FRAME_US - frame_elapsed;
+            rx_ctx->superframe_start_us += RF_FRAME_US;
+        } else {
+            next_frame_delay = RF_GUARD_TIME_US;
+            rx_ctx->superframe_start_us = now + next_frame_delay;
+        }
+#else
+        if (frame_elapsed < RF_FRAME_US) {
+            // 还有剩余时间，等待到正好5000us
+            next_frame_delay = RF_FRAME_US - frame_elapsed;
+        } else {
+            // 已超时（异常情况），立即开始下一帧
+            // 但至少留出最小guard时间
+            next_frame_delay = RF_GUARD_TIME_US;
+        }
+        
+        rx_ctx->superframe_start_us = now + next_frame_delay;
+#endif
+        
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+        // v0.6.3: 对齐到主导者帧栅格 - 下一帧取参考栅格上不早于 now + 保护时间的点, 帧号随之对齐
+        if (coex_realign) {
+            coex_realign = false;
+            uint32_t t = coex_ref_us;
+            uint16_t f = coex_ref_frame;
+            while ((int32_t)(t - (now + RF_GUARD_TIME_US)) < 0) {
+                t += RF_FRAME_US;
+                f++;
+            }
+            rx_ctx->superframe_start_us = t;
+            next_frame_delay = t - now;
+            coex_switch_frame += (uint16_t)(f - rx_ctx->frame_number);  // 换车道保持原定提前量
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+            if (f < rx_ctx->frame_number) auth_epoch++;     // 帧号后退, 保持 (纪元, 帧号) 递增
+#endif
+            rx_ctx->frame_number = f;
+            rx_ctx->current_channel = hop_channel(rx_ctx, f);
+        }
+#endif
+        
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+        // v0.6.3: 本帧按原周期结束 (下一帧起点已定), 之后才推进到下一帧的速率档;
+        // 组休眠期间 tracker 只听少数信标, 不发起新的切换
+        rf_frame_rate_advance();
+        if (!rf_frame_rate_pending() && rate_target != rf_frame_rate_get()
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+            && !doze_active
+#endif
+           ) {
+            rf_frame_rate_schedule(rate_target, RF_FRAME_RATE_ANNOUNCE);
+        }
+#endif
+        
+#if defined(USE_RF_BEACON_PREBUILD) && USE_RF_BEACON_PREBUILD
+        // 帧号和信道已定, 趁帧末空闲构建下一帧信标 (帧末广播/扫描/跟随都不改信标内容)
+        beacon_prebuild(rx_ctx);
+#endif
+        
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+        // 跟随时定期在帧末转到主导者下一帧的信道, 它的信标比本帧起点早 RF_COEX_PHASE_US;
+        // 下一帧定时器发信标前会切回本帧信道
+        if (coex_leader_lane != 0xFF &&
+            (rx_ctx->frame_number % RF_COEX_TRACK_FRAMES) == 0 &&
+            next_frame_delay >= RF_COEX_PHASE_US + RF_GUARD_TIME_US) {
+            rf_hw_set_channel(rf_get_lane_channel(rx_ctx->frame_number, coex_leader_lane));
+            rf_hw_rx_mode();
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+            rf_hw_timer_at(rx_ctx->superframe_start_us, slot_timer_callback);
+#else
+            rf_hw_start_timer(next_frame_delay, slot_timer_callback);
+#endif
+            return;
+        }
+#endif
+        
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        // v0.6.3: 固件广播优先于空闲扫描; 射频此时仍在刚结束帧的信道, tracker 也停在该信道
+        if (rf_ota_broadcast_active() &&
+            next_frame_delay >= RF_OTA_PACKET_US + RF_GUARD_TIME_US) {
+            ota_left = RF_OTA_CHUNKS_PER_FRAME;
+            ota_end_us = rx_ctx->superframe_start_us - RF_GUARD_TIME_US;
+            if (ota_send_next()) return;
+        }
+#endif
+        
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+        // v0.6.3: 空闲时间够用时先对后续跳频信道做能量检测
+        if (next_frame_delay >= IDLE_SCAN_BUDGET_US) {
+            scan_left = RF_IDLE_SCAN_CHANNELS;
+            scan_frame = rx_ctx->frame_number + RF_IDLE_SCAN_LOOKAHEAD;
+            if (scan_next_channel()) return;
+        }
+#endif
+        
+        // Schedule next superframe with fixed timing
+#if defined(USE_RF_ABS_SLOT_TIMER) && USE_RF_ABS_SLOT_TIMER
+        rf_hw_timer_at(rx_ctx->superframe_start_us, slot_timer_callback);
+#else
+        rf_hw_start_timer(next_frame_delay, slot_timer_callback);
+#endif
+    }
+}
+
+/*============================================================================
+ * v0.6.3: Per-tracker TX Power Control
+ *============================================================================*/
+
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+/**
+ * @brief v0.6.3: 1Mbps 回退后所需的主时隙数仍在一帧之内 (多超帧调度时超额由调度器轮转)
+ */
+static bool phy_slot_room(rf_receiver_ctx_t *ctx)
+{
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+    (void)ctx;
+    return true;
+#else
+    uint8_t need = 1;
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (!ctx->trackers[i].active) continue;
+        need += ((phy_slow_mask >> i) & 1) ? 2 : 1;
+    }
+    return need <= RF_FRAME_SLOT_CAPACITY;
+#endif
+}
+
+/**
+ * @brief v0.6.3: 按功率控制窗口切换一个 tracker 的 PHY 速率 (主循环, 功率等级已更新)
+ *
+ * 最大功率下仍持续丢包 → 1Mbps; 1Mbps 下功率保持最大, RSSI 足够且几乎无丢包
+ * 持续 RF_PHY_2M_PERIODS 个周期 → 2Mbps; 链路中断时回到 2Mbps 重新评估
+ */
+static void phy_update(rf_receiver_ctx_t *ctx, uint8_t i, bool linked, int8_t rssi, uint8_t loss)
+{
+    rf_tracker_mask_t bit = (rf_tracker_mask_t)1 << i;
+    bool slow = (phy_slow_mask & bit) != 0;
+    bool hit;
+    
+    if (!linked) {
+        phy_slow_mask &= ~bit;
+        phy_streak[i] = 0;
+        return;
+    }
+    
+    if (slow) {
+        tx_power_level[i] = RF_TX_POWER_4DBM;
+        hit = rssi >= RF_PHY_2M_RSSI_DBM && loss <= RF_PWR_LOSS_DOWN_PCT;
+    } else {
+        hit = tx_power_level[i] == RF_TX_POWER_4DBM && loss > RF_PHY_1M_LOSS_PCT;
+    }
+    if (!hit) {
+        phy_streak[i] = 0;
+    } else if (phy_streak[i] < 0xFF) {
+        phy_streak[i]++;
+    }
+    
+    if (slow && phy_streak[i] >= RF_PHY_2M_PERIODS) {
+        phy_slow_mask &= ~bit;
+        phy_streak[i] = 0;
+    } else if (!slow && phy_streak[i] >= RF_PHY_1M_PERIODS && phy_slot_room(ctx)) {
+        phy_slow_mask |= bit;
+        phy_streak[i] = 0;
+    }
+}
+#endif
+
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+/**
+ * @brief 按近期 RSSI/丢包率调整每个 tracker 的功率等级 (主循环)
+ *
+ * 丢包 → 立即升两级; RSSI 低于目标窗口 → 升一级;
+ * RSSI 高于目标窗口且几乎无丢包 → 降一级; 链路中断 → 回到最大功率
+ */
+static void power_ctrl_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    if ((now - power_ctrl_last_ms) < RF_PWR_CTRL_PERIOD_MS) return;
+    power_ctrl_last_ms = now;
+    
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (!ctx->trackers[i].active) continue;
+        
+        int8_t rssi = 0;
+        uint8_t loss = 0;
+        uint8_t level = tx_power_level[i];
+        bool linked = ctx->trackers[i].connected && diag_take_link_window(i, &rssi, &loss);
+        
+        if (!linked) {
+            level = RF_TX_POWER_4DBM;
+        } else if (loss > RF_PWR_LOSS_UP_PCT) {
+            level = (level + 2 > RF_TX_POWER_4DBM) ? RF_TX_POWER_4DBM : level + 2;
+        } else if (rssi < RF_PWR_TARGET_RSSI_DBM - RF_PWR_HYST_DB) {
+            if (level < RF_TX_POWER_4DBM) level++;
+        } else if (rssi > RF_PWR_TARGET_RSSI_DBM + RF_PWR_HYST_DB &&
+                   loss <= RF_PWR_LOSS_DOWN_PCT) {
+            if (level > RF_PWR_MIN_LEVEL) level--;
+        }
+        
+        tx_power_level[i] = level;
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        phy_update(ctx, i, linked, rssi, loss);
+#endif
+    }
+}
+#endif
+
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE
+/**
+ * @brief v0.6.3: 按 tracker 上报的静止标志调整调度速率 (主循环)
+ *
+ * 降速要求静止持续 RF_MOTION_RATE_HOLD_MS, 恢复运动立即回到设定速率;
+ * FEC 模式下的 Ultra 包不带标志, 按运动处理以免停在低速率
+ */
+static void motion_rate_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        tracker_info_t *t = &ctx->trackers[i];
+        if (!t->active) {
+            still[i] = false;
+            continue;
+        }
+        
+        // 超时离线的 tracker (如改走 USB 有线数据流) 同样降速让出时隙, 重新上线后按标志恢复
+        bool stationary = !t->connected || (t->flags & RF_FLAG_STATIONARY);
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        if (fec_mode[i]) stationary = false;
+#endif
+        if (stationary && !still[i]) still_since_ms[i] = now;
+        still[i] = stationary;
+        
+        uint8_t div = rate_base[i] ? rate_base[i] : RF_DEFAULT_RATE_DIV;
+        if (stationary && (now - still_since_ms[i]) >= RF_MOTION_RATE_HOLD_MS &&
+            div < RF_MOTION_RATE_DIV) {
+            div = RF_MOTION_RATE_DIV;
+        }
+        
+        if (tracker_rate_div(t) != div) {
+            t->rate_div = div;
+            sched_dirty = true;         // 下一帧开始时重新分配相位
+        }
+    }
+}
+#endif
+
+#if defined(USE_RF_FEC) && USE_RF_FEC
+/**
+ * @brief v0.6.3: 记录一次比特错误事件 (当前解码包所在时隙的 tracker)
+ *
+ * 包内 tracker_id 可能正是出错的字节, 所以按接收时的时隙归属计数
+ */
+static void fec_record_error(void)
+{
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+    ch_mgr_record_crc_error(&ch_manager, rf_hop_table_get(decode_frame));
+#endif
+    if (decode_owner >= RF_MAX_TRACKERS) return;
+    if (fec_err_count[decode_owner] < 0xFF) fec_err_count[decode_owner]++;
+}
+
+/**
+ * @brief v0.6.3: 按周期内比特错误事件切换每个 tracker 的 FEC 模式 (主循环)
+ *
+ * 开启后 CRC 失败大多变成可纠正错误, 仍按同一计数判断, 计数降到
+ * RF_FEC_OFF_ERRORS 以下才关闭, 两个阈值之间保持不变
+ */
+static void fec_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    if ((now - fec_last_ms) < RF_FEC_PERIOD_MS) return;
+    fec_last_ms = now;
+    
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        uint8_t errors = fec_err_count[i];
+        fec_err_count[i] = 0;
+        
+        if (!ctx->trackers[i].active || !ctx->trackers[i].connected) {
+            fec_mode[i] = false;
+        } else if (!fec_mode[i] && errors >= RF_FEC_ON_ERRORS) {
+            fec_mode[i] = true;
+        } else if (fec_mode[i] && errors <= RF_FEC_OFF_ERRORS) {
+            fec_mode[i] = false;
+        }
+    }
+}
+#endif
+
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+/**
+ * @brief v0.6.3: 选择能容纳全部主时隙和 RF_FRAME_RATE_SPARE 个备用时隙的最快速率档 (主循环)
+ *
+ * 时隙按最大保护时间计, 保护时间收窄后多出的空间留给备用时隙; 配对期间固定 200Hz.
+ * 减速立即生效 (帧末中断随后通告), 加速需条件持续 RF_FRAME_RATE_HOLD_MS
+ */
+static void frame_rate_update(rf_receiver_ctx_t *ctx)
+{
+    uint8_t want = 0;
+    
+    if (ctx->state == RX_STATE_RUNNING) {
+        uint8_t need = RF_FRAME_RATE_SPARE;
+        for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+            if (!ctx->trackers[i].active) continue;
+            need++;
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+            need += (phy_slow_mask >> i) & 1;   // 1Mbps 主时隙占两个时隙
+#endif
+        }
+        
+        want = RF_FRAME_RATE_MAX;
+        while (want > 0 &&
+               (rf_frame_rate_period(want) - RF_SYNC_SLOT_US - RF_GUARD_TIME_US) / RF_SLOT_US < need) {
+            want--;
+        }
+    }
+    
+    uint32_t now = hal_millis();
+    if (want > rate_target) {
+        if ((now - rate_hold_ms) >= RF_FRAME_RATE_HOLD_MS) rate_target = want;
+    } else {
+        rate_target = want;
+        rate_hold_ms = now;
+    }
+}
+#endif
+
+/**
+ * @brief v0.6.3: 解码结果补记到时序追踪 (按包所在帧和到达时刻定位时隙)
+ */
+static void trace_crc(uint32_t rx_us, bool ok)
+{
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+    rf_trace_crc(decode_frame, rx_us, ok);
+#endif
+}
+
+/*============================================================================
+ * Packet Reception Handler
+ *============================================================================*/
+
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+/**
+ * @brief v0.6.3: 把新接收的包交给分集转发 (重复包不转发)
+ */
+static void forward_packet(uint8_t id, int sequence, int8_t rssi, const int16_t quat[4])
+{
+    if (!forward_callback) return;
+    
+    rf_forward_info_t info;
+    info.tracker_id = id;
+    info.sequence = (uint8_t)sequence;
+    info.has_sequence = (sequence >= 0);
+    info.rssi = rssi;
+    info.frame = decode_frame;
+    memcpy(info.quat, quat, sizeof(info.quat));
+    forward_callback(&info);
+}
+#endif
+
+#if defined(USE_RF_ULTRA) && USE_RF_ULTRA && \
+    defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+/**
+ * @brief v0.6.3: 保存包内最后一个样本, 作为后续增量包的参考
+ */
+static void delta_ref_store(const rf_multi_parsed_t *m)
+{
+    delta_ref_t *e = &delta_ref[m->tracker_id][m->sequence & (RF_DELTA_HISTORY - 1)];
+    memcpy(e->quat, m->quat[m->count - 1], sizeof(e->quat));
+    e->sequence = m->sequence;
+    e->valid = true;
+}
+#endif
+
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+static rf_sideband_rx_t sideband_rx[RF_MAX_TRACKERS] RAM_ARENA(rf_receiver);
+
+/**
+ * @brief v0.6.3: 拼装状态旁路 (重复包和补回的包同样送入, 补齐窗口)
+ */
+static void sideband_take(tracker_info_t *tracker, const rf_multi_parsed_t *m)
+{
+    uint8_t field;
+    uint16_t value;
+    if (!rf_sideband_feed(&sideband_rx[m->tracker_id], m->sequence, m->sideband, &field, &value)) {
+        return;
+    }
+    
+    switch (field) {
+        case RF_SB_FIELD_BATTERY_MV: tracker->battery_mv = value; break;
+        case RF_SB_FIELD_TEMP:       tracker->temp_cc = (int16_t)value; break;
+        case RF_SB_FIELD_FW_VERSION: tracker->fw_version = value; break;
+        case RF_SB_FIELD_IMU_TYPE:   tracker->imu_type = (uint8_t)value; break;
+        default: return;
+    }
+    tracker->sideband_valid |= (uint8_t)(1u << field);
+}
+#endif
+
+/**
+ * @brief v0.6.3: 多样本聚合包 - 按子帧时间戳展开到时间线
+ */
+static void handle_multi_samples(const rf_multi_parsed_t *m, int8_t rssi, uint32_t rx_us)
 {
-    return (RF_BASE_FREQ_MHZ + channel * RF_CHANNEL_STEP_MHZ) * 1000000;
+    trace_crc(rx_us, true);
+    if (m->tracker_id >= RF_MAX_TRACKERS) return;
+    if (!rx_ctx->trackers[m->tracker_id].active) return;
+    
+    tracker_info_t *tracker = &rx_ctx->trackers[m->tracker_id];
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+    sideband_take(tracker, m);
+#endif
+    
+    // 备用时隙重传的重复包
+    if (tracker->connected && m->sequence == tracker->last_sequence) {
+        tracker->retransmit_count++;
+        tracker->last_seen_ms = hal_millis();
+        link_count_dup(m->tracker_id);
+        return;
+    }
+    
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+    // v0.6.3: 序列号落后于最新包 - 选择性重传补回的丢包
+    int8_t behind = (int8_t)(tracker->last_sequence - m->sequence);
+    // (落后超过窗口视为 tracker 重启后序列号重新开始, 按新包处理)
+    if (tracker->connected && behind > 0 && behind < SEQ_WINDOW_SIZE) {
+        uint16_t bit = (uint16_t)1 << behind;
+        tracker->last_seen_ms = hal_millis();
+        tracker->retransmit_count++;
+        if (seq_window[m->tracker_id] & bit) {
+            link_count_dup(m->tracker_id);
+            return;     // 已收到, 仅 ACK 丢失
+        }
+        seq_window[m->tracker_id] |= bit;
+        if (rx_ctx->lost_packets > 0) rx_ctx->lost_packets--;
+        link_count_late(m->tracker_id);
+        
+        // 只补时间线, 当前姿态/状态保持最新包
+        for (uint8_t i = 0; i < m->count; i++) {
+            timeline_push_recovered(m->tracker_id, rx_us - m->age_us[i], m->quat[i]);
+        }
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+        delta_ref_store(m);
+#endif
+        return;
+    }
+    
+    uint8_t gap = (uint8_t)(m->sequence - tracker->last_sequence);
+    seq_window[m->tracker_id] = (tracker->connected && gap < SEQ_WINDOW_SIZE) ?
+                               (uint16_t)((seq_window[m->tracker_id] << gap) | 1) : 1;
+#endif
+    
+    update_sequence(tracker, m->sequence);
+    tracker->last_seen_ms = hal_millis();
+    tracker->rssi = (uint8_t)(rssi + 128);
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    diag_record_rssi(m->tracker_id, rssi);
+#endif
+    if (!m->delta) {
+        // 增量包不带电池/标志, 保持上一个关键帧的值
+        tracker->battery = m->battery_pct;
+        tracker->flags = m->flags;
+    }
+    
+    for (uint8_t i = 0; i < m->count; i++) {
+        timeline_push(m->tracker_id, rx_us - m->age_us[i], m->quat[i]);
+    }
+    
+    // 最新样本作为当前姿态
+    memcpy(tracker->quat, m->quat[m->count - 1], sizeof(tracker->quat));
+    tracker->accel_mg[0] = 0;
+    tracker->accel_mg[1] = 0;
+    tracker->accel_mg[2] = m->accel_z_mg;
+    
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+    delta_ref_store(m);
+#endif
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+    forward_packet(m->tracker_id, m->sequence, rssi, m->quat[m->count - 1]);
+#endif
+    
+    mark_connected(tracker, m->tracker_id);
+    rx_ctx->total_packets++;
 }
 
-static bool is_channel_blacklisted(rf_receiver_ctx_t *ctx, uint8_t channel)
+static void handle_multi_packet(const uint8_t *data, uint8_t len, int8_t rssi, uint32_t rx_us)
 {
-    uint8_t byte_idx = channel / 8;
-    uint8_t bit_idx = channel % 8;
-    return (ctx->channel_blacklist[byte_idx] & (1 << bit_idx)) != 0;
+    rf_multi_parsed_t m;
+    if (!rf_multi_parse_packet(data, len, &m)) {
+        trace_crc(rx_us, false);
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        fec_record_error();
+#endif
+        return;
+    }
+    
+    handle_multi_samples(&m, rssi, rx_us);
 }
 
-static uint8_t get_next_good_channel(rf_receiver_ctx_t *ctx, uint16_t frame)
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+/**
+ * @brief v0.6.3: 增量包 - 用已保存的参考样本还原后按聚合包处理
+ */
+static void handle_delta_packet(const uint8_t *data, uint8_t len, int8_t rssi, uint32_t rx_us)
 {
-    uint8_t channel;
-    uint8_t attempts = 0;
+    uint8_t id, seq, ref_seq;
+    if (!rf_delta_peek(data, len, &id, &seq, &ref_seq)) return;
+    if (id >= RF_MAX_TRACKERS) return;
     
-    do {
-        channel = rf_get_hop_channel(frame + attempts, ctx->network_key);
-        attempts++;
-    } while (is_channel_blacklisted(ctx, channel) && attempts < 10);
+    const delta_ref_t *ref = &delta_ref[id][ref_seq & (RF_DELTA_HISTORY - 1)];
+    if (!ref->valid || ref->sequence != ref_seq) {
+        // 参考缺失 (接收器重启等): 硬件已 ACK, tracker 会把它当参考,
+        // 作废该序号的旧条目, 之后引用它的包同样丢弃, 直到下一个关键帧
+        delta_ref[id][seq & (RF_DELTA_HISTORY - 1)].valid = false;
+        return;
+    }
+    
+    rf_multi_parsed_t m;
+    if (!rf_delta_parse_packet(data, len, ref->quat, &m)) {
+        trace_crc(rx_us, false);
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        fec_record_error();
+#endif
+        return;
+    }
     
-    return channel;
+    handle_multi_samples(&m, rssi, rx_us);
 }
+#endif
+#endif
 
-/*============================================================================
- * Packet Building
- *============================================================================*/
-
-static void build_sync_beacon(rf_receiver_ctx_t *ctx, rf_sync_packet_t *pkt)
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+/**
+ * @brief v0.6.3: 原始样本包 (融合卸载) - 样本交给 rx_fusion, 姿态由融合输出回调更新
+ */
+static void handle_raw_packet(const uint8_t *data, uint8_t len, int8_t rssi, uint32_t rx_us)
 {
-    memset(pkt, 0, sizeof(rf_sync_packet_t));
+    rf_raw_parsed_t r;
+    if (!rf_raw_parse_packet(data, len, &r)) {
+        trace_crc(rx_us, false);
+        return;
+    }
+    trace_crc(rx_us, true);
+    if (r.tracker_id >= RF_MAX_TRACKERS) return;
+    if (!rx_ctx->trackers[r.tracker_id].active) return;
     
-    pkt->header.type = (ctx->state == RX_STATE_PAIRING) ? 
-                        RF_PKT_SYNC_PAIRING : RF_PKT_SYNC_BEACON;
-    pkt->header.length = sizeof(rf_sync_packet_t) - sizeof(rf_header_t);
-    pkt->frame_number = ctx->frame_number;
+    tracker_info_t *tracker = &rx_ctx->trackers[r.tracker_id];
     
-    // Build active tracker mask
-    pkt->active_mask[0] = 0;
-    pkt->active_mask[1] = 0;
-    for (int i = 0; i < RF_MAX_TRACKERS; i++) {
-        if (ctx->trackers[i].active) {
-            if (i < 8)
-                pkt->active_mask[0] |= (1 << i);
-            else
-                pkt->active_mask[1] |= (1 << (i - 8));
-        }
+    if (tracker->connected && r.sequence == tracker->last_sequence) {
+        tracker->retransmit_count++;
+        tracker->last_seen_ms = hal_millis();
+        link_count_dup(r.tracker_id);
+        return;
     }
     
-    // Build channel map for next 5 frames
-    for (int i = 0; i < 5; i++) {
-        pkt->channel_map[i] = get_next_good_channel(ctx, ctx->frame_number + i + 1);
+    update_sequence(tracker, r.sequence);
+    tracker->last_seen_ms = hal_millis();
+    tracker->rssi = (uint8_t)(rssi + 128);
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    diag_record_rssi(r.tracker_id, rssi);
+#endif
+    tracker->battery = r.battery_pct;
+    tracker->flags = r.flags;
+    memcpy(tracker->accel_mg, r.accel[r.count - 1], sizeof(tracker->accel_mg));
+    
+    // 样本等间隔: 最旧样本时刻 = 最新样本时刻 - (N-1) 个周期
+    uint32_t t_newest = rx_us - r.age_us;
+    for (uint8_t i = 0; i < r.count; i++) {
+        uint8_t back = r.count - 1 - i;
+        rx_fusion_push(r.tracker_id, (uint8_t)(r.index - back), r.gyro[i], r.accel[i],
+                       t_newest - back * RF_RAW_PERIOD_US);
     }
     
-    pkt->tx_power = 7;  // Max power
+    mark_connected(tracker, r.tracker_id);
+    rx_ctx->total_packets++;
+}
+
+/**
+ * @brief 融合输出 (rx_fusion_process 回调): 按样本时刻归入所在超帧,
+ * 解码快照可能已是之后的帧
+ */
+static void fusion_output(uint8_t id, const int16_t quat[4], uint32_t t_us)
+{
+    if (id >= RF_MAX_TRACKERS || !rx_ctx->trackers[id].active) return;
     
-    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_sync_packet_t) - 2);
+    timeline_push(id, t_us, quat);
+    
+    uint8_t last = (timeline[id].head - 1) & (RF_TIMELINE_DEPTH - 1);
+    rf_timeline_sample_t *s = &timeline[id].samples[last];
+    int32_t offset = (int32_t)(t_us - decode_frame_start_us);
+    while (offset < 0 && offset > -(int32_t)(RF_SEQ_LATE_FRAMES_MAX * RF_FRAME_US)) {
+        offset += RF_FRAME_US;
+        s->frame--;
+    }
+    if (offset >= 0) s->frame_offset_us = (int16_t)offset;
+    
+    memcpy(rx_ctx->trackers[id].quat, quat, sizeof(rx_ctx->trackers[id].quat));
 }
+#endif
 
-static void build_ack_packet(rf_ack_packet_t *pkt, uint8_t tracker_id, 
-                              uint8_t sequence, rf_command_t cmd, uint8_t param)
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/**
+ * @brief v0.6.3: 双姿态包 - 主 IMU 姿态按普通样本处理, 辅助 IMU 姿态另存
+ */
+static void handle_dual_packet(const uint8_t *data, uint8_t len, int8_t rssi, uint32_t rx_us)
 {
-    memset(pkt, 0, sizeof(rf_ack_packet_t));
+    rf_dual_parsed_t d;
+    if (!rf_dual_parse_packet(data, len, &d)) {
+        trace_crc(rx_us, false);
+        return;
+    }
+    trace_crc(rx_us, true);
+    if (d.tracker_id >= RF_MAX_TRACKERS) return;
+    if (!rx_ctx->trackers[d.tracker_id].active) return;
     
-    pkt->header.type = RF_PKT_ACK;
-    pkt->header.length = sizeof(rf_ack_packet_t) - sizeof(rf_header_t);
-    pkt->tracker_id = tracker_id;
-    pkt->ack_sequence = sequence;
-    pkt->command = cmd;
-    pkt->command_data = param;
+    tracker_info_t *tracker = &rx_ctx->trackers[d.tracker_id];
     
-    pkt->crc = rf_calc_crc16(pkt, sizeof(rf_ack_packet_t) - 2);
+    if (tracker->connected && d.sequence == tracker->last_sequence) {
+        tracker->retransmit_count++;
+        tracker->last_seen_ms = hal_millis();
+        link_count_dup(d.tracker_id);
+        return;
+    }
+    
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+    // 双姿态包不重传, 只维护接收位图
+    uint8_t gap = (uint8_t)(d.sequence - tracker->last_sequence);
+    seq_window[d.tracker_id] = (tracker->connected && gap < SEQ_WINDOW_SIZE) ?
+                               (uint16_t)((seq_window[d.tracker_id] << gap) | 1) : 1;
+#endif
+    
+    update_sequence(tracker, d.sequence);
+    tracker->last_seen_ms = hal_millis();
+    tracker->rssi = (uint8_t)(rssi + 128);
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    diag_record_rssi(d.tracker_id, rssi);
+#endif
+    tracker->battery = d.battery_pct;
+    tracker->flags = d.flags;
+    
+    timeline_push(d.tracker_id, rx_us - d.age_us[0], d.quat[0]);
+    memcpy(tracker->quat, d.quat[0], sizeof(tracker->quat));
+    tracker->accel_mg[0] = 0;
+    tracker->accel_mg[1] = 0;
+    tracker->accel_mg[2] = d.accel_z_mg;
+    
+    memcpy(aux_quat[d.tracker_id], d.quat[1], sizeof(aux_quat[0]));
+    aux_fresh |= (rf_tracker_mask_t)1 << d.tracker_id;
+    
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+    forward_packet(d.tracker_id, d.sequence, rssi, d.quat[0]);
+#endif
+    
+    mark_connected(tracker, d.tracker_id);
+    rx_ctx->total_packets++;
 }
+#endif
 
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
 /*============================================================================
- * Slot Timer Callback
+ * v0.6.3: Multi-kit Coexistence
  *============================================================================*/
 
-static void slot_timer_callback(void)
+static bool coex_lane_used(uint8_t lane)
 {
-    if (!rx_ctx) return;
+    for (uint8_t i = 0; i < RF_COEX_MAX_PEERS; i++) {
+        if (coex_peers[i].tag && coex_peers[i].lane == lane) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 邻居表中标签最小且小于本网络的套件 (主导者), 没有时返回 NULL
+ */
+static const coex_peer_t *coex_leader(void)
+{
+    const coex_peer_t *best = NULL;
+    for (uint8_t i = 0; i < RF_COEX_MAX_PEERS; i++) {
+        const coex_peer_t *p = &coex_peers[i];
+        if (!p->tag || p->tag >= coex_tag) continue;
+        if (!best || p->tag < best->tag) best = p;
+    }
+    return best;
+}
+
+/**
+ * @brief 其他套件的信标 (主循环): 更新邻居表, 车道冲突时让出, 帧栅格对齐到主导者
+ */
+static void coex_on_beacon(const uint8_t *data, uint8_t len, uint32_t rx_us)
+{
+    if (len < sizeof(rf_sync_packet_t)) return;
     
-    uint32_t now = rf_hw_get_time_us();
-    uint32_t elapsed = now - rx_ctx->superframe_start_us;
+    const rf_sync_packet_t *sync = (const rf_sync_packet_t *)data;
+    if (rf_calc_crc16(sync, sizeof(rf_sync_packet_t) - 2) != sync->crc) return;
+    if (sync->net_tag == 0 || sync->net_tag == coex_tag) return;
+    if (sync->hop_lane >= RF_COEX_LANES) return;
     
-    if (!sync_sent) {
-        // Send sync beacon at start of superframe (non-blocking)
-        rf_sync_packet_t sync_pkt;
-        build_sync_beacon(rx_ctx, &sync_pkt);
-        
-        rf_hw_set_channel(rx_ctx->current_channel);
-        rf_hw_tx_mode();
-        // 使用非阻塞发送，避免在定时器回调中阻塞
-        rf_hw_transmit_async((uint8_t *)&sync_pkt, sizeof(sync_pkt));
-        
-        sync_sent = true;
-        current_slot = 0;
-        slot_start_time_us = now + RF_SYNC_SLOT_US;
-        return;
+    // 记入邻居表 (已满时替换最久未听到的)
+    coex_peer_t *peer = NULL;
+    coex_peer_t *oldest = &coex_peers[0];
+    for (uint8_t i = 0; i < RF_COEX_MAX_PEERS; i++) {
+        coex_peer_t *p = &coex_peers[i];
+        if (p->tag == sync->net_tag) {
+            peer = p;
+            break;
+        }
+        if (!p->tag || (oldest->tag && p->last_ms < oldest->last_ms)) oldest = p;
     }
+    if (!peer) peer = oldest;
+    peer->tag = sync->net_tag;
+    peer->lane = sync->hop_lane;
+    peer->last_ms = hal_millis();
     
-    // Check if current slot is for an active tracker
-    if (current_slot < RF_MAX_TRACKERS) {
-        if (rx_ctx->trackers[current_slot].active) {
-            // Switch to RX mode for this tracker's slot
-            rf_hw_rx_mode();
-            
-            // Prepare ACK payload
-            rf_ack_packet_t ack;
-            rf_command_t cmd = RF_CMD_NONE;
-            uint8_t param = 0;
-            
-            if (pending_cmd.pending && pending_cmd.tracker_id == current_slot) {
-                cmd = pending_cmd.command;
-                param = pending_cmd.param;
-                pending_cmd.pending = false;
-            }
-            
-            build_ack_packet(&ack, current_slot, 
-                             rx_ctx->trackers[current_slot].last_sequence + 1,
-                             cmd, param);
-            rf_hw_set_ack_payload((uint8_t *)&ack, sizeof(ack));
+    // 车道冲突: 标签较大的一方换到邻居都未使用的车道, 新车道提前写入信标 channel_map
+    uint8_t lane = coex_switch_pending ? coex_next_lane : rf_hop_table_get_lane();
+    if (sync->hop_lane == lane && coex_tag > sync->net_tag) {
+        for (uint8_t k = 1; k < RF_COEX_LANES; k++) {
+            uint8_t cand = (uint8_t)((lane + k) % RF_COEX_LANES);
+            if (coex_lane_used(cand)) continue;
+            __disable_irq();
+            coex_next_lane = cand;
+            coex_switch_frame = (uint16_t)(rx_ctx->frame_number + RF_COEX_SWITCH_FRAMES);
+            coex_switch_pending = true;
+            __enable_irq();
+            break;
         }
-        
-        // P0-1: 使用临界区保护slot递增操作
-        __disable_irq();
-        current_slot++;
-        __enable_irq();
-        
-        // Schedule next slot
-        rf_hw_start_timer(RF_DATA_SLOT_US, slot_timer_callback);
-    } else {
-        // End of frame - prepare for next superframe
-        // P1-3: 使用临界区保护帧号递增
+    }
+    
+    const coex_peer_t *leader = coex_leader();
+    if (leader != peer) return;
+    coex_leader_lane = peer->lane;
+    
+    // 主导者帧 f 的起点 (信标接收完成时刻减空口时间), 本网络帧 f 应在其后 RF_COEX_PHASE_US 开始
+    uint32_t want_us = rx_us - RF_AIRTIME_US(sizeof(rf_sync_packet_t)) + RF_COEX_PHASE_US;
+    uint32_t have_us = decode_frame_start_us +
+                       (int32_t)(int16_t)(sync->frame_number - decode_frame) * RF_FRAME_US;
+    int32_t err = (int32_t)(want_us - have_us);
+    if (err > RF_COEX_LOCK_US || err < -RF_COEX_LOCK_US) {
         __disable_irq();
-        rx_ctx->frame_number++;
+        coex_ref_us = want_us;
+        coex_ref_frame = sync->frame_number;
+        coex_realign = true;
         __enable_irq();
-        rx_ctx->current_channel = get_next_good_channel(rx_ctx, rx_ctx->frame_number);
-        sync_sent = false;
-        
-        // v0.4.22 P0-2: 强制固定5000us超帧周期
-        // 计算本帧实际用时，确保下一帧严格在5000us后开始
-        uint32_t frame_elapsed = now - rx_ctx->superframe_start_us;
-        uint32_t next_frame_delay;
-        
-        if (frame_elapsed < RF_SUPERFRAME_US) {
-            // 还有剩余时间，等待到正好5000us
-            next_frame_delay = RF_SUPERFRAME_US - frame_elapsed;
-        } else {
-            // 已超时（异常情况），立即开始下一帧
-            // 但至少留出最小guard时间
-            next_frame_delay = RF_GUARD_TIME_US;
-        }
-        
-        rx_ctx->superframe_start_us = now + next_frame_delay;
-        
-        // Schedule next superframe with fixed timing
-        rf_hw_start_timer(next_frame_delay, slot_timer_callback);
     }
 }
 
-/*============================================================================
- * Packet Reception Handler
- *============================================================================*/
+/**
+ * @brief 主循环: 邻居超时, 换车道生效后重建跳频表
+ */
+static void coex_update(rf_receiver_ctx_t *ctx)
+{
+    uint32_t now = hal_millis();
+    for (uint8_t i = 0; i < RF_COEX_MAX_PEERS; i++) {
+        if (coex_peers[i].tag && now - coex_peers[i].last_ms > RF_COEX_PEER_TIMEOUT_MS) {
+            coex_peers[i].tag = 0;
+        }
+    }
+    const coex_peer_t *leader = coex_leader();
+    coex_leader_lane = leader ? leader->lane : 0xFF;
+    
+    // 重建期间中断仍按新车道单独计算, 完成后才清除标志
+    if (coex_switch_pending && (int16_t)(ctx->frame_number - coex_switch_frame) >= 0) {
+        rf_hop_table_set_lane(coex_next_lane);
+        rf_receiver_update_hop_table(ctx);
+        coex_switch_pending = false;
+    }
+}
+#endif
 
-static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
+static void rx_packet_decode(const uint8_t *data, uint8_t len, int8_t rssi, uint32_t rx_us)
 {
     if (!rx_ctx || len < 1) return;
     
+    #if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    // v0.6.3: 运行中收到的信标只可能来自其他套件 (本机不会收到自己的信标)
+    if (rx_ctx->state == RX_STATE_RUNNING &&
+        (data[0] == RF_PKT_SYNC_BEACON || data[0] == RF_PKT_SYNC_PAIRING)) {
+        coex_on_beacon(data, len, rx_us);
+        return;
+    }
+    #endif
+    
+    #if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    // v0.6.3: 原始样本包 (头 0xB0|N, 长度 21-27 字节)
+    if (rf_raw_is_packet(data, len)) {
+        handle_raw_packet(data, len, rssi, rx_us);
+        return;
+    }
+    #endif
+    
+    #if defined(USE_AUX_IMU) && USE_AUX_IMU
+    // v0.6.3: 双姿态包 (头 0xA0, 20 字节)
+    if (rf_dual_is_packet(data, len)) {
+        handle_dual_packet(data, len, rssi, rx_us);
+        return;
+    }
+    #endif
+    
+    #if defined(USE_RF_ULTRA) && USE_RF_ULTRA && \
+        defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+    // v0.6.3: 多样本聚合包 (头 0xE0|N, 长度 16-31 字节)
+    if (rf_multi_is_packet(data, len)) {
+        handle_multi_packet(data, len, rssi, rx_us);
+        return;
+    }
+    #endif
+    
+    #if defined(USE_RF_FEC) && USE_RF_FEC
+    // v0.6.3: FEC 包 (头 0xC0|L, 长度 2L+1): 纠错后按内层包处理
+    if (rf_fec_is_packet(data, len)) {
+        uint8_t inner[RF_FEC_MAX_INNER];
+        uint8_t corrected = 0;
+        int n = rf_fec_decode(data, len, inner, &corrected);
+        if (n < 0 || corrected > 0) fec_record_error();
+        if (n < 0) trace_crc(rx_us, false);
+        if (n > 0 && !rf_fec_is_packet(inner, (uint8_t)n)) {
+            rx_packet_decode(inner, (uint8_t)n, rssi, rx_us);
+        }
+        return;
+    }
+    #endif
+    
+    #if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+    // v0.6.3: 增量包 (头 0xD0|N, 长度 13-28 字节)
+    if (rf_delta_is_packet(data, len)) {
+        handle_delta_packet(data, len, rssi, rx_us);
+        return;
+    }
+    #endif
+    
     // v0.6.2: 检测RF Ultra数据包 (12字节，特殊格式)
     #if defined(USE_RF_ULTRA) && USE_RF_ULTRA
     if (len == RF_ULTRA_PACKET_SIZE) {
@@ -242,6 +2580,7 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
         rf_ultra_parsed_t parsed;
         if (rf_ultra_parse_packet(data, &parsed)) {
             parsed.rssi = rssi;
+            trace_crc(rx_us, true);
             
             // 验证tracker_id
             if (parsed.tracker_id >= RF_MAX_TRACKERS) return;
@@ -249,33 +2588,51 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             
             tracker_info_t *tracker = &rx_ctx->trackers[parsed.tracker_id];
             
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+            // 备用时隙重传: 与本帧已收到的包内容相同 (仅ACK丢失), 丢弃;
+            // 第二样本姿态不同, 照常处理
+            if (tracker->connected && ultra_last_frame[parsed.tracker_id] == decode_frame &&
+                memcmp(tracker->quat, parsed.quat, sizeof(tracker->quat)) == 0 &&
+                tracker->accel_mg[2] == parsed.accel_z_mg) {
+                tracker->retransmit_count++;
+                tracker->last_seen_ms = hal_millis();
+                link_count_dup(parsed.tracker_id);
+                return;
+            }
+            ultra_last_frame[parsed.tracker_id] = decode_frame;
+#endif
+            
             // 更新tracker信息
             tracker->last_seen_ms = hal_millis();
             tracker->rssi = (uint8_t)(rssi + 128);
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+            diag_record_rssi(parsed.tracker_id, rssi);
+#endif
             tracker->battery = parsed.battery_pct;
             
-            // 转换Q15四元数到float
-            tracker->quaternion[0] = parsed.quat[0] / 32767.0f;
-            tracker->quaternion[1] = parsed.quat[1] / 32767.0f;
-            tracker->quaternion[2] = parsed.quat[2] / 32767.0f;
-            tracker->quaternion[3] = parsed.quat[3] / 32767.0f;
+            // Q15 四元数直接保存
+            memcpy(tracker->quat, parsed.quat, sizeof(tracker->quat));
             
             // 垂直加速度 (其他轴为0)
-            tracker->acceleration[0] = 0.0f;
-            tracker->acceleration[1] = 0.0f;
-            tracker->acceleration[2] = parsed.accel_z_mg / 1000.0f;
+            tracker->accel_mg[0] = 0;
+            tracker->accel_mg[1] = 0;
+            tracker->accel_mg[2] = parsed.accel_z_mg;
             
-            // 标记为已连接
-            if (!tracker->connected) {
-                tracker->connected = true;
-                if (connect_callback) {
-                    connect_callback(parsed.tracker_id, true);
-                }
-            }
+            timeline_push(parsed.tracker_id, rx_us, parsed.quat);
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+            forward_packet(parsed.tracker_id, -1, rssi, parsed.quat);
+#endif
             
+            // 标记为已连接 (Ultra 包无序列号, 只计收到)
+            link_count_rx(parsed.tracker_id, 0);
+            mark_connected(tracker, parsed.tracker_id);
             rx_ctx->total_packets++;
             return;  // 处理完毕
         }
+        trace_crc(rx_us, false);
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        fec_record_error();
+#endif
     }
     #endif
     
@@ -292,6 +2649,7 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             
             // Verify CRC
             uint16_t calc_crc = rf_calc_crc16(pkt, sizeof(rf_tracker_packet_t) - 2);
+            trace_crc(rx_us, calc_crc == pkt->crc);
             if (calc_crc != pkt->crc) return;
             
             // Verify tracker ID
@@ -300,47 +2658,103 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             
             tracker_info_t *tracker = &rx_ctx->trackers[pkt->tracker_id];
             
-            // Check sequence for packet loss
-            uint8_t expected_seq = tracker->last_sequence + 1;
-            if (pkt->sequence != expected_seq && tracker->connected) {
-                uint8_t lost = pkt->sequence - expected_seq;
-                rx_ctx->lost_packets += lost;
-                tracker->packet_loss = (tracker->packet_loss * 7 + lost * 10) / 8;
-            } else {
-                tracker->packet_loss = (tracker->packet_loss * 7) / 8;
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+            // 备用时隙重传: 主时隙已收到 (仅ACK丢失), 丢弃重复包
+            if (tracker->connected && pkt->sequence == tracker->last_sequence) {
+                tracker->retransmit_count++;
+                tracker->last_seen_ms = hal_millis();
+                link_count_dup(pkt->tracker_id);
+                return;
             }
+#endif
             
-            tracker->last_sequence = pkt->sequence;
+            // Check sequence for packet loss
+            update_sequence(tracker, pkt->sequence);
             tracker->last_seen_ms = hal_millis();
             tracker->rssi = (uint8_t)(rssi + 128);
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+            diag_record_rssi(pkt->tracker_id, rssi);
+#endif
             tracker->battery = pkt->battery;
             tracker->flags = pkt->flags;
             
-            // Convert sensor data
-            tracker->quaternion[0] = pkt->quat_w / 32767.0f;
-            tracker->quaternion[1] = pkt->quat_x / 32767.0f;
-            tracker->quaternion[2] = pkt->quat_y / 32767.0f;
-            tracker->quaternion[3] = pkt->quat_z / 32767.0f;
-            tracker->acceleration[0] = pkt->accel_x / 1000.0f;
-            tracker->acceleration[1] = pkt->accel_y / 1000.0f;
-            tracker->acceleration[2] = pkt->accel_z / 1000.0f;
+            // Sensor data (Q15 / mg, 与包内格式一致)
+            tracker->quat[0] = pkt->quat_w;
+            tracker->quat[1] = pkt->quat_x;
+            tracker->quat[2] = pkt->quat_y;
+            tracker->quat[3] = pkt->quat_z;
+            tracker->accel_mg[0] = pkt->accel_x;
+            tracker->accel_mg[1] = pkt->accel_y;
+            tracker->accel_mg[2] = pkt->accel_z;
+            
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+            timeline_push(pkt->tracker_id, rx_us - (uint32_t)pkt->sample_age * RF_SAMPLE_AGE_TICK_US,
+                          tracker->quat);
+#else
+            timeline_push(pkt->tracker_id, rx_us, tracker->quat);
+#endif
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+            forward_packet(pkt->tracker_id, pkt->sequence, rssi, tracker->quat);
+#endif
+            
+            // Mark as connected
+            mark_connected(tracker, pkt->tracker_id);
+            
+            rx_ctx->total_packets++;
+            
+            // Call data callback
+            if (data_callback) {
+                data_callback(pkt->tracker_id, pkt);
+            }
+            break;
+        }
+        
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        case RF_PKT_OTA_STATUS: {
+            // v0.6.3: 固件广播接收状态 (代替该帧的数据包)
+            if (len < sizeof(rf_ota_status_packet_t)) return;
+            
+            rf_ota_status_packet_t *pkt = (rf_ota_status_packet_t *)data;
+            uint16_t calc_crc = rf_calc_crc16(pkt, sizeof(rf_ota_status_packet_t) - 2);
+            trace_crc(rx_us, calc_crc == pkt->crc);
+            if (calc_crc != pkt->crc) return;
+            
+            if (pkt->tracker_id >= RF_MAX_TRACKERS) return;
+            if (!rx_ctx->trackers[pkt->tracker_id].active) return;
             
-            // Mark as connected
-            if (!tracker->connected) {
-                tracker->connected = true;
-                if (connect_callback) {
-                    connect_callback(pkt->tracker_id, true);
-                }
-            }
+            rx_ctx->trackers[pkt->tracker_id].last_seen_ms = hal_millis();
+            rf_ota_on_status(pkt);
+            break;
+        }
+#endif
+        
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+        case RF_PKT_SYNC_BEACON: {
+            // v0.6.3: 副接收器从主接收器信标得知已配对的 tracker (时序已在中断中对齐)
+            if (rx_ctx->state != RX_STATE_LISTEN) return;
+            if (len < sizeof(rf_sync_packet_t)) return;
             
-            rx_ctx->total_packets++;
+            const rf_sync_packet_t *sync = (const rf_sync_packet_t *)data;
+            if (rf_calc_crc16(sync, sizeof(rf_sync_packet_t) - 2) != sync->crc) return;
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+            if (sync->net_tag != coex_tag) return;
+#endif
             
-            // Call data callback
-            if (data_callback) {
-                data_callback(pkt->tracker_id, pkt);
+            for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+                bool on = (sync->active_mask[i / 8] >> (i % 8)) & 1;
+                if (on && !rx_ctx->trackers[i].active) {
+                    rx_ctx->trackers[i].active = true;
+                    rx_ctx->trackers[i].connected = false;
+                    rx_ctx->paired_count++;
+                } else if (!on && rx_ctx->trackers[i].active) {
+                    rx_ctx->trackers[i].active = false;
+                    rx_ctx->trackers[i].connected = false;
+                    if (rx_ctx->paired_count > 0) rx_ctx->paired_count--;
+                }
             }
             break;
         }
+#endif
         
         case RF_PKT_PAIR_REQUEST: {
             if (rx_ctx->state != RX_STATE_PAIRING) return;
@@ -352,16 +2766,14 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             uint16_t calc_crc = rf_calc_crc16(req, sizeof(rf_pair_request_t) - 2);
             if (calc_crc != req->crc) return;
             
-            // Find free slot or existing entry
-            int8_t slot = -1;
-            for (int i = 0; i < RF_MAX_TRACKERS; i++) {
-                if (!rx_ctx->trackers[i].active) {
-                    if (slot < 0) slot = i;
-                } else if (memcmp(rx_ctx->trackers[i].mac_address, 
-                                  req->mac_address, 6) == 0) {
-                    slot = i;  // Already paired
-                    break;
-                }
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+            // v0.6.3: 在下一个配对信标后的批量应答中分配
+            pair_pending_add(rx_ctx, req->mac_address);
+#else
+            // Existing entry (MAC index) or first free slot
+            int8_t slot = mac_index_find(rx_ctx->trackers, req->mac_address);
+            for (int i = 0; slot < 0 && i < RF_MAX_TRACKERS; i++) {
+                if (!rx_ctx->trackers[i].active) slot = i;
             }
             
             if (slot < 0) return;  // No free slots
@@ -380,6 +2792,7 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             rf_hw_tx_mode();
             rf_hw_transmit((uint8_t *)&resp, sizeof(resp));
             rf_hw_rx_mode();
+#endif
             break;
         }
         
@@ -397,14 +2810,22 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
             if (conf->status != 0) return;
             
             // Activate tracker
+            // 重新配对 (同一 ID 已激活) 不重复计数
             tracker_info_t *tracker = &rx_ctx->trackers[conf->tracker_id];
+            if (tracker->active) {
+                mac_index_remove(rx_ctx->trackers, conf->tracker_id);
+            } else {
+                rx_ctx->paired_count++;
+            }
             memcpy(tracker->mac_address, conf->mac_address, 6);
+            mac_index_insert(rx_ctx->trackers, conf->tracker_id);
             tracker->active = true;
             tracker->connected = false;
             tracker->last_sequence = 0;
             tracker->packet_loss = 0;
-            
-            rx_ctx->paired_count++;
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+            pair_pending_confirm(conf->tracker_id);
+#endif
             break;
         }
         
@@ -413,6 +2834,240 @@ static void rx_packet_handler(const uint8_t *data, uint8_t len, int8_t rssi)
     }
 }
 
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+/**
+ * @brief v0.6.3: 副接收器逐帧切换信道 (TMR2, 下一帧开始前 RF_LISTEN_LEAD_US)
+ */
+static void listen_timer_callback(void)
+{
+    if (!rx_ctx || rx_ctx->state != RX_STATE_LISTEN) return;
+    
+    if (++listen_missed > RF_LISTEN_LOST_FRAMES) {
+        // 失步: 回到必经信道等下一个信标
+        rf_hw_stop_timer();
+        listen_locked = false;
+        rx_ctx->current_channel = listen_channel;
+        rf_hw_set_channel(listen_channel);
+        rf_hw_rx_mode();
+        return;
+    }
+    
+    frame_event_frame = rx_ctx->frame_number;
+    frame_event_seq++;
+    rx_ctx->frame_number++;
+    rx_ctx->superframe_start_us += RF_FRAME_US;
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    // 按信标通告的切换帧预测周期, 周期定时器随之重新装载
+    if (rf_frame_rate_advance()) rf_hw_start_timer(RF_FRAME_US, listen_timer_callback);
+#endif
+    
+    // 信标 channel_map 已含主接收器黑名单, 用完后退回不含黑名单的跳频表 (同 tracker)
+    uint8_t ch = (listen_map_idx < sizeof(listen_map)) ?
+                 listen_map[listen_map_idx++] : rf_hop_table_get(rx_ctx->frame_number);
+    rx_ctx->current_channel = ch;
+    rf_hw_set_channel(ch);
+    rf_hw_rx_mode();
+}
+
+/**
+ * @brief v0.6.3: 副接收器收到信标 - 重新对齐帧号和帧起点 (中断上下文)
+ */
+static void listen_on_beacon(const uint8_t *data, uint8_t len, uint32_t rx_us)
+{
+    if (len < sizeof(rf_sync_packet_t)) return;
+    
+    const rf_sync_packet_t *sync = (const rf_sync_packet_t *)data;
+    if (sync->header.type != RF_PKT_SYNC_BEACON) return;
+    if (rf_calc_crc16(sync, sizeof(rf_sync_packet_t) - 2) != sync->crc) return;
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    if (sync->net_tag != coex_tag) return;
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    if (sync->roam_cell != rf_hop_table_get_cell()) return;  // 邻小区的信标
+#endif
+    
+    // 帧起点取信标到达时刻 (同帧内两个接收器的帧号一致即可, 不需要更精确)
+    rx_ctx->frame_number = sync->frame_number;
+    rx_ctx->superframe_start_us = rx_us;
+    memcpy(listen_map, sync->channel_map, sizeof(listen_map));
+    listen_map_idx = 0;
+    listen_missed = 0;
+    listen_locked = true;
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    rf_frame_rate_sync(sync->frame_rate);
+#endif
+    
+    rf_hw_start_timer(RF_FRAME_US - RF_LISTEN_LEAD_US, listen_timer_callback);
+}
+#endif
+
+/**
+ * @brief v0.6.3: RF 接收中断 - 只入队缓冲句柄, 不解码不拷贝
+ * @return true = 已入队, 缓冲由 rx_ring_drain 归还
+ */
+RAM_CODE_ISR
+static bool rx_packet_isr(uint8_t handle, const rf_hw_rx_buf_t *b)
+{
+    uint8_t len = b->len;
+    if (!rx_ctx || len < 1) return false;
+    
+    uint32_t rx_us = rf_hw_get_time_us();
+    
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    group_ack_on_rx();
+#else
+    // v0.6.3: 本时隙 ACK 带了命令, 收到包说明 ACK 已随自动应答发出, 出队
+    if (cmd_offer_owner < RF_MAX_TRACKERS) {
+        cmd_queue[cmd_offer_owner].head++;
+        cmd_offer_owner = 0xFF;
+    }
+#endif
+    
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+    // 副接收器: 信标决定帧时序, 必须在中断中立即对齐 (之后照常入队取活跃掩码)
+    if (rx_ctx->state == RX_STATE_LISTEN) {
+        listen_on_beacon(b->data, len, rx_us);
+    }
+#endif
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    // 时隙内收到的包归属该时隙的 tracker (与预装的自动 ACK 一致),
+    // 帧结束时据此分配重传时隙, 必须在本帧内置位而不能等主循环解码
+    if (sync_sent && current_slot > 0 && current_slot <= slot_total) {
+        frame_rx_mask |= (rf_tracker_mask_t)1 << slot_owner[current_slot - 1];
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+        guard_record_arrival(current_slot - 1, len, rx_us);
+#endif
+    }
+#endif
+    
+    uint8_t head = rx_ring_head;
+    if ((uint8_t)(head - rx_ring_tail) >= RX_RING_SIZE) {
+        rx_ring_dropped++;
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+        if (sync_sent && current_slot > 0 && current_slot <= slot_total) {
+            link_stats[slot_owner[current_slot - 1]].ring_dropped++;
+        }
+#else
+        if (sync_sent && current_slot > 0 && current_slot <= RF_MAX_TRACKERS) {
+            link_stats[current_slot - 1].ring_dropped++;
+        }
+#endif
+        return false;
+    }
+    
+    rx_ring_entry_t *e = &rx_ring[head & (RX_RING_SIZE - 1)];
+#if (defined(USE_RF_FEC) && USE_RF_FEC) || (defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH)
+    e->owner = 0xFF;
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    e->attempt = 0;
+    e->epoch = auth_epoch;
+#endif
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    if (sync_sent && current_slot > 0 && current_slot <= slot_total) {
+        e->owner = slot_owner[current_slot - 1];
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        if (current_slot > slot_primary) e->attempt = (uint8_t)(current_slot - slot_primary);
+#endif
+    }
+#else
+    if (sync_sent && current_slot > 0 && current_slot <= RF_MAX_TRACKERS) {
+        e->owner = current_slot - 1;
+    }
+#endif
+#endif
+    e->buf = handle;
+    e->rx_us = rx_us;
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    e->channel = rf_hw_get_channel();
+#endif
+    e->frame = rx_ctx->frame_number;
+    e->frame_start_us = rx_ctx->superframe_start_us;
+    
+    // 条目写完后再发布 head (单核, 编译器屏障即可)
+    __asm__ volatile ("" ::: "memory");
+    rx_ring_head = head + 1;
+    
+#if defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+    if (sync_sent && current_slot > 0) {
+        rf_trace_rx(current_slot - 1, rx_us, rf_hw_get_time_us());
+    }
+#endif
+    return true;
+}
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+/**
+ * @brief v0.6.3: 校验并解密时隙数据包后解码
+ *
+ * 明文只放行配对阶段的包和其他套件的信标 (运行中只进入共存处理);
+ * 运行中时隙外的包和 MIC 校验失败的包丢弃
+ */
+static void rx_auth_decode(const rx_ring_entry_t *e, const rf_hw_rx_buf_t *b)
+{
+    bool pairing = (rx_ctx->state == RX_STATE_PAIRING);
+    
+    if ((b->data[0] == RF_PKT_SYNC_BEACON || b->data[0] == RF_PKT_SYNC_PAIRING) &&
+        b->len == sizeof(rf_sync_packet_t)) {
+        rx_packet_decode(b->data, b->len, b->rssi, e->rx_us);
+        return;
+    }
+    
+    if (e->owner < RF_MAX_TRACKERS) {
+        rf_auth_nonce_t nonce = {
+            .epoch = e->epoch,
+            .frame = e->frame,
+            .tracker_id = e->owner,
+            .attempt = e->attempt,
+        };
+        uint8_t plain[RF_MAX_PAYLOAD_SIZE];
+        int n = rf_auth_open(plain, b->data, b->len, &nonce);
+        if (n > 0) {
+            rx_packet_decode(plain, (uint8_t)n, b->rssi, e->rx_us);
+            return;
+        }
+        if (!pairing) {
+            link_stats[e->owner].auth_rejected++;
+            return;
+        }
+    }
+    
+    // 配对请求/确认不加密
+    if (pairing) rx_packet_decode(b->data, b->len, b->rssi, e->rx_us);
+}
+#endif
+
+/**
+ * @brief v0.6.3: 主循环中解码队列中的全部包
+ */
+static void rx_ring_drain(void)
+{
+    while (rx_ring_tail != rx_ring_head) {
+        __asm__ volatile ("" ::: "memory");
+        rx_ring_entry_t *e = &rx_ring[rx_ring_tail & (RX_RING_SIZE - 1)];
+        const rf_hw_rx_buf_t *b = rf_hw_rx_buf(e->buf);
+        
+        decode_frame = e->frame;
+        decode_frame_start_us = e->frame_start_us;
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        decode_owner = e->owner;
+#endif
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+        decode_channel = e->channel;
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        if (rf_auth_active()) {
+            rx_auth_decode(e, b);
+        } else
+#endif
+        rx_packet_decode(b->data, b->len, b->rssi, e->rx_us);
+        rf_hw_rx_release(e->buf);
+        
+        __asm__ volatile ("" ::: "memory");
+        rx_ring_tail++;
+    }
+}
+
 /*============================================================================
  * Public API - Receiver
  *============================================================================*/
@@ -423,6 +3078,19 @@ int rf_receiver_init(rf_receiver_ctx_t *ctx)
     
     memset(ctx, 0, sizeof(rf_receiver_ctx_t));
     ctx->state = RX_STATE_INIT;
+    mac_index_clear();
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    rx_fusion_init();
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    rf_auth_init();
+#endif
+    
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    // 新连接的 tracker 从最大功率开始收敛
+    memset(tx_power_level, RF_TX_POWER_4DBM, sizeof(tx_power_level));
+    diag_init();
+#endif
     
     // 从存储加载或生成新的网络密钥
     if (!hal_storage_load_network_key(&ctx->network_key)) {
@@ -441,6 +3109,9 @@ int rf_receiver_init(rf_receiver_ctx_t *ctx)
         // 保存到存储
         hal_storage_save_network_key(ctx->network_key);
     }
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    coex_tag = rf_coex_net_tag(ctx->network_key);
+#endif
     
     // Initialize RF hardware
     rf_hw_config_t rf_cfg = {
@@ -450,7 +3121,7 @@ int rf_receiver_init(rf_receiver_ctx_t *ctx)
         .crc_mode = RF_CRC_16BIT,
         .sync_word = RF_SYNC_WORD,
         .channel = 0,
-        .auto_ack = true,
+        .auto_ack = RX_AUTO_ACK,
         .ack_timeout = 4,   // 1ms
         .retry_count = 0,
     };
@@ -458,7 +3129,7 @@ int rf_receiver_init(rf_receiver_ctx_t *ctx)
     int err = rf_hw_init(&rf_cfg);
     if (err) return err;
     
-    rf_hw_set_rx_callback(rx_packet_handler);
+    rf_hw_set_rx_pool_callback(rx_packet_isr);
     
     rx_ctx = ctx;
     ctx->state = RX_STATE_IDLE;
@@ -470,14 +3141,46 @@ int rf_receiver_start(rf_receiver_ctx_t *ctx)
 {
     if (!ctx || ctx->state == RX_STATE_ERROR) return -1;
     
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+    rf_hw_set_auto_ack(RX_AUTO_ACK);    // 从副接收器模式切回
+#endif
     ctx->state = RX_STATE_RUNNING;
     ctx->frame_number = 0;
-    ctx->current_channel = get_next_good_channel(ctx, 0);
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    // 车道保留 (配对结束重启后仍与邻居错开), 帧栅格重新对齐
+    coex_tag = rf_coex_net_tag(ctx->network_key);
+    memset(coex_peers, 0, sizeof(coex_peers));
+    coex_switch_pending = false;
+    coex_leader_lane = 0xFF;
+    coex_realign = false;
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    // 帧号从 0 重新开始, 纪元必须前进
+    if (!auth_epoch_loaded) {
+        auth_epoch = rf_auth_epoch_start();
+        auth_epoch_loaded = true;
+    } else {
+        auth_epoch++;
+    }
+#endif
+    rf_receiver_update_hop_table(ctx);
+    ctx->current_channel = rf_hop_table_get(0);
     ctx->superframe_start_us = rf_hw_get_time_us();
     
     sync_sent = false;
     current_slot = 0;
     
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    memset(arrival, 0, sizeof(arrival));
+    guard_us = RF_GUARD_MAX_US;
+#endif
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    // 帧栅格重新开始, 从 200Hz 起步, 之后由主循环按活跃 tracker 数加速
+    rf_frame_rate_sync(RF_RATE_PACK(0, 0, 0));
+    rate_target = 0;
+    rate_hold_ms = hal_millis();
+#endif
+    
     // Start superframe timer
     rf_hw_start_timer(100, slot_timer_callback);  // Start immediately
     
@@ -493,6 +3196,9 @@ int rf_receiver_start_pairing(rf_receiver_ctx_t *ctx)
     
     ctx->state = RX_STATE_PAIRING;
     ctx->last_sync_ms = hal_millis();
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+    pair_pending_count = 0;
+#endif
     
     // Switch to fixed pairing channel
     rf_hw_set_channel(RF_PAIRING_CHANNEL);
@@ -513,9 +3219,73 @@ void rf_receiver_process(rf_receiver_ctx_t *ctx)
 {
     if (!ctx) return;
     
+    // v0.6.3: 先解码中断期间收到的包
+    rx_ring_drain();
+    link_stats_update();
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    // v0.6.3: 融合卸载 - 每次主循环按预算轮转执行各 tracker 的待融合样本
+    rx_fusion_process(fusion_output, RX_FUSION_BUDGET);
+#endif
+    
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    if (ctx->state == RX_STATE_RUNNING) coex_update(ctx);
+#endif
+    
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    // v0.6.3: 预先算好下一个信标的 MAC 密钥, 信标中断里只做哈希
+    if (ctx->state == RX_STATE_RUNNING && rf_auth_active()) {
+        rf_auth_nonce_t nonce = {
+            .epoch = auth_epoch,
+            .frame = ctx->frame_number,
+            .tracker_id = RF_AUTH_ID_BEACON,
+            .attempt = 0,
+        };
+        if (sync_sent && ++nonce.frame == 0) nonce.epoch++;
+        rf_auth_prepare(&nonce, 0);
+        rf_auth_epoch_check(nonce.epoch);
+    }
+#endif
+    
+#if defined(USE_RF_IDLE_SCAN) && USE_RF_IDLE_SCAN
+    // v0.6.3: 扫描统计每秒评估一次, 黑名单变化时重建跳频表
+    if (ch_mgr_periodic_update(&ch_manager) && ctx->state != RX_STATE_LISTEN) {
+        ch_mgr_export_blacklist(&ch_manager, ctx->channel_blacklist,
+                                sizeof(ctx->channel_blacklist));
+        rf_receiver_update_hop_table(ctx);
+    }
+#endif
+    
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    if (ctx->state != RX_STATE_LISTEN) hop_map_update(ctx);
+#endif
+    
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+    power_ctrl_update(ctx);
+#endif
+    
+#if defined(USE_RF_FEC) && USE_RF_FEC
+    fec_update(ctx);
+#endif
+    
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    guard_update(ctx);
+#endif
+    
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE
+    motion_rate_update(ctx);
+#endif
+    
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    if (ctx->state != RX_STATE_LISTEN) frame_rate_update(ctx);
+#endif
+    
     uint32_t now = hal_millis();
     
     // Check for tracker timeouts
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    // v0.6.3: 组休眠期间 tracker 按约定不发数据, 不算断开
+    if (!doze_active)
+#endif
     for (int i = 0; i < RF_MAX_TRACKERS; i++) {
         tracker_info_t *tracker = &ctx->trackers[i];
         
@@ -544,23 +3314,117 @@ void rf_receiver_process(rf_receiver_ctx_t *ctx)
             
             rf_hw_tx_mode();
             rf_hw_transmit((uint8_t *)&sync_pkt, sizeof(sync_pkt));
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+            send_pair_batch(ctx);
+#endif
             rf_hw_rx_mode();
         }
     }
 }
 
+/**
+ * @brief v0.6.3: 命令入队 (主循环)
+ * @param first true = 插到队首 (已装入当前 ACK 的那条之后)
+ * @return 0 成功, -3 队列已满
+ */
+static int cmd_queue_push(uint8_t id, rf_command_t cmd, uint8_t param, bool first)
+{
+    cmd_queue_t *q = &cmd_queue[id];
+    int ret = 0;
+    
+    __disable_irq();
+    uint8_t head = q->head;
+    uint8_t tail = q->tail;
+    if ((uint8_t)(tail - head) >= CMD_QUEUE_DEPTH) {
+        ret = -3;
+    } else {
+        uint8_t pos = tail;
+        if (first) {
+            // 已在 ACK 中的队首仍等待确认出队, 不能被挤到后面
+            pos = (cmd_offer_owner == id && head != tail) ? (uint8_t)(head + 1) : head;
+            for (uint8_t i = tail; i != pos; i--) {
+                q->command[i & (CMD_QUEUE_DEPTH - 1)] = q->command[(uint8_t)(i - 1) & (CMD_QUEUE_DEPTH - 1)];
+                q->param[i & (CMD_QUEUE_DEPTH - 1)] = q->param[(uint8_t)(i - 1) & (CMD_QUEUE_DEPTH - 1)];
+            }
+        }
+        q->command[pos & (CMD_QUEUE_DEPTH - 1)] = (uint8_t)cmd;
+        q->param[pos & (CMD_QUEUE_DEPTH - 1)] = param;
+        q->tail = tail + 1;
+    }
+    __enable_irq();
+    
+    return ret;
+}
+
+static void cmd_queue_flush(uint8_t id)
+{
+    __disable_irq();
+    cmd_queue[id].head = cmd_queue[id].tail;
+    if (cmd_offer_owner == id) cmd_offer_owner = 0xFF;
+    __enable_irq();
+}
+
 int rf_receiver_send_command(rf_receiver_ctx_t *ctx, uint8_t tracker_id,
                               rf_command_t cmd, uint8_t param)
 {
     if (!ctx || tracker_id >= RF_MAX_TRACKERS) return -1;
     if (!ctx->trackers[tracker_id].active) return -2;
     
-    pending_cmd.tracker_id = tracker_id;
-    pending_cmd.command = cmd;
-    pending_cmd.param = param;
-    pending_cmd.pending = true;
+    return cmd_queue_push(tracker_id, cmd, param, false);
+}
+
+int rf_receiver_send_command_first(rf_receiver_ctx_t *ctx, uint8_t tracker_id,
+                                    rf_command_t cmd, uint8_t param)
+{
+    if (!ctx || tracker_id >= RF_MAX_TRACKERS) return -1;
+    if (!ctx->trackers[tracker_id].active) return -2;
+    
+    return cmd_queue_push(tracker_id, cmd, param, true);
+}
+
+int rf_receiver_broadcast_command(rf_receiver_ctx_t *ctx, rf_command_t cmd, uint8_t param)
+{
+    if (!ctx) return -1;
     
-    return 0;
+    int queued = 0;
+    for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+        if (ctx->trackers[i].active && cmd_queue_push(i, cmd, param, false) == 0) {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+void rf_receiver_set_group_sleep(rf_receiver_ctx_t *ctx, bool sleep)
+{
+    if (!ctx || sleep == doze_active) return;
+    
+    if (sleep) {
+        __disable_irq();
+        doze_announce_left = GROUP_SLEEP_ANNOUNCE_FRAMES;
+        doze_active = true;
+        __enable_irq();
+    } else {
+        doze_active = false;
+        // 休眠期间没有收包, 从现在起重新计算超时
+        uint32_t now = hal_millis();
+        for (uint8_t i = 0; i < RF_MAX_TRACKERS; i++) {
+            ctx->trackers[i].last_seen_ms = now;
+        }
+    }
+}
+
+bool rf_receiver_group_sleeping(void)
+{
+    return doze_active;
+}
+#endif
+
+uint8_t rf_receiver_command_pending(uint8_t tracker_id)
+{
+    if (tracker_id >= RF_MAX_TRACKERS) return 0;
+    return (uint8_t)(cmd_queue[tracker_id].tail - cmd_queue[tracker_id].head);
 }
 
 int rf_receiver_unpair(rf_receiver_ctx_t *ctx, uint8_t tracker_id)
@@ -574,7 +3438,23 @@ int rf_receiver_unpair(rf_receiver_ctx_t *ctx, uint8_t tracker_id)
     rf_receiver_send_command(ctx, tracker_id, RF_CMD_UNPAIR, 0);
     
     // Clear tracker info
+    mac_index_remove(ctx->trackers, tracker_id);
+    // 清除后该时隙不再发 ACK, 排队的命令 (含上面的 UNPAIR) 不会再送达, 一并丢弃,
+    // 避免同一 ID 重新配对后收到旧命令
     memset(&ctx->trackers[tracker_id], 0, sizeof(tracker_info_t));
+    timeline[tracker_id].count = 0;
+    cmd_queue_flush(tracker_id);
+    link_stats_reset(tracker_id);
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    hop_map_reset(tracker_id);
+#endif
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    rx_fusion_reset(tracker_id);
+#endif
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE
+    rate_base[tracker_id] = 0;
+    still[tracker_id] = false;
+#endif
     
     // 安全递减paired_count（防止下溢）
     if (ctx->paired_count > 0) {
@@ -595,6 +3475,114 @@ void rf_receiver_unpair_all(rf_receiver_ctx_t *ctx)
     }
 }
 
+int rf_receiver_restore_pairing(rf_receiver_ctx_t *ctx, uint8_t tracker_id, const uint8_t mac[6])
+{
+    if (!ctx || !mac || tracker_id >= RF_MAX_TRACKERS) return -1;
+    
+    tracker_info_t *tracker = &ctx->trackers[tracker_id];
+    if (tracker->active) {
+        mac_index_remove(ctx->trackers, tracker_id);
+    } else {
+        ctx->paired_count++;
+    }
+    memcpy(tracker->mac_address, mac, 6);
+    mac_index_insert(ctx->trackers, tracker_id);
+    tracker->active = true;
+    tracker->connected = false;
+    return 0;
+}
+
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+int rf_receiver_set_tracker_rate(rf_receiver_ctx_t *ctx, uint8_t tracker_id, uint8_t rate_div)
+{
+    if (!ctx || tracker_id >= RF_MAX_TRACKERS) return -1;
+    if (rate_div != 1 && rate_div != 2 && rate_div != 4) return -1;
+    
+    ctx->trackers[tracker_id].rate_div = rate_div;
+    sched_dirty = true;             // 下一帧开始时重新分配相位
+#if defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE
+    rate_base[tracker_id] = rate_div;   // 静止时仍会降到 RF_MOTION_RATE_DIV
+#endif
+    return 0;
+}
+#endif
+
+uint8_t rf_receiver_timeline_read(uint8_t tracker_id, rf_timeline_sample_t *out, uint8_t max)
+{
+    if (tracker_id >= RF_MAX_TRACKERS || !out) return 0;
+    
+    __disable_irq();
+    uint8_t n = timeline[tracker_id].count;
+    if (n > max) n = max;
+    
+    uint8_t tail = (timeline[tracker_id].head - timeline[tracker_id].count) & (RF_TIMELINE_DEPTH - 1);
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = timeline[tracker_id].samples[(tail + i) & (RF_TIMELINE_DEPTH - 1)];
+    }
+    timeline[tracker_id].count -= n;
+    __enable_irq();
+    
+    return n;
+}
+
+uint32_t rf_receiver_get_rx_dropped(void)
+{
+    return rx_ring_dropped;
+}
+
+uint8_t rf_receiver_frame_event(uint16_t *frame)
+{
+    __disable_irq();
+    uint8_t seq = frame_event_seq;
+    uint16_t f = frame_event_frame;
+    __enable_irq();
+    
+    uint8_t n = (uint8_t)(seq - frame_event_seen);
+    frame_event_seen = seq;
+    if (frame) *frame = f;
+    return n;
+}
+
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+void rf_receiver_get_time_base(rf_time_base_t *out)
+{
+    if (!out) return;
+    if (!rx_ctx) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    
+    // 帧号与帧起点在帧末同一次定时器中断中更新
+    __disable_irq();
+    out->now_us = rf_hw_get_time_us();
+    out->frame_start_us = rx_ctx->superframe_start_us;
+    out->frame = rx_ctx->frame_number;
+    __enable_irq();
+}
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+bool rf_receiver_take_aux_quat(uint8_t tracker_id, int16_t quat[4])
+{
+    if (tracker_id >= RF_MAX_TRACKERS) return false;
+    rf_tracker_mask_t bit = (rf_tracker_mask_t)1 << tracker_id;
+    if (!(aux_fresh & bit)) return false;
+    
+    aux_fresh &= ~bit;
+    memcpy(quat, aux_quat[tracker_id], sizeof(aux_quat[0]));
+    return true;
+}
+#endif
+
+bool rf_receiver_get_link_stats(uint8_t tracker_id, rf_link_stats_t *out)
+{
+    if (tracker_id >= RF_MAX_TRACKERS || !out) return false;
+    
+    // ring_dropped 由中断累加, 单字读写无需关中断
+    *out = link_stats[tracker_id];
+    return true;
+}
+
 void rf_receiver_set_data_callback(rf_rx_data_callback_t cb)
 {
     data_callback = cb;
@@ -604,3 +3592,50 @@ void rf_receiver_set_connect_callback(rf_rx_connect_callback_t cb)
 {
     connect_callback = cb;
 }
+
+#if defined(USE_RX_DIVERSITY) && USE_RX_DIVERSITY
+int rf_receiver_start_listener(rf_receiver_ctx_t *ctx)
+{
+    if (!ctx || ctx->state == RX_STATE_ERROR) return -1;
+    
+    rf_hw_stop_timer();
+    rf_hw_set_auto_ack(false);
+    rf_hw_set_ack_payload(NULL, 0);
+    
+    // 不含黑名单建表, 与 tracker 一致; 活跃 tracker 随信标掩码更新
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    coex_tag = rf_coex_net_tag(ctx->network_key);
+#endif
+    rf_hop_table_build(ctx->network_key, NULL, 0);
+    listen_channel = rf_hop_table_pick_listen(NULL, 0, NULL);
+    listen_map_idx = sizeof(listen_map);
+    listen_missed = 0;
+    listen_locked = false;
+    
+    ctx->state = RX_STATE_LISTEN;
+    ctx->current_channel = listen_channel;
+    rf_hw_set_channel(listen_channel);
+    rf_hw_rx_mode();
+    
+    return 0;
+}
+
+bool rf_receiver_listener_locked(void)
+{
+    return listen_locked;
+}
+
+void rf_receiver_set_forward_callback(rf_rx_forward_callback_t cb)
+{
+    forward_callback = cb;
+}
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+int rf_receiver_set_roam_cell(rf_receiver_ctx_t *ctx, uint8_t cell)
+{
+    if (!ctx || cell >= RF_ROAM_CELLS) return -1;
+    rf_hop_table_set_cell(cell);
+    return 0;
+}
+#endif
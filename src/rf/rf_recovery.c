@@ -11,6 +11,149 @@
 #include "channel_manager.h"
 #include <string.h>
 
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+
+#define COST_EWMA_SHIFT     3       // 成功率/耗时 EWMA 权重 1/8
+#define COST_P_MIN_Q8       8       // 成功率下限: 长期失败的动作仍会在排序末尾被重试
+
+typedef struct {
+    uint8_t min_miss;               // 连续丢失达到此值才可选, 0 = 不参与选择
+    uint8_t p_q8;                   // 初始成功率
+    uint16_t ms;                    // 初始恢复耗时
+    uint16_t budget_min_ms;         // 耗时预算下限
+    uint16_t budget_max_ms;         // 耗时预算上限; 超过此值才恢复的算作失败
+} action_prior_t;
+
+// 初值: 越靠后的动作越慢、单独成功率越低, 无历史时排序与原固定门限一致
+static const action_prior_t priors[RECOVERY_ACTION_COUNT] = {
+    [RECOVERY_RESYNC]         = { MISS_SYNC_LEVEL1_THRESHOLD, 192,  100,  50,  2000 },
+    [RECOVERY_CHANNEL_SWITCH] = { MISS_SYNC_LEVEL2_THRESHOLD, 128,  150, 100,  2000 },
+    [RECOVERY_FULL_SCAN]      = { MISS_SYNC_LEVEL3_THRESHOLD,  96,  400, 200,  5000 },
+    [RECOVERY_DEEP_SEARCH]    = { MISS_SYNC_LEVEL4_THRESHOLD,  64, 1000, 500, 10000 },
+    [RECOVERY_HOP_PREDICT]    = { 1,                          160,   20,  10,   200 },
+};
+
+static uint16_t action_budget_ms(const rf_recovery_state_t *state, uint8_t a)
+{
+    uint32_t b = (uint32_t)state->action_stats[a].avg_ms * 2;
+    if (b < priors[a].budget_min_ms) b = priors[a].budget_min_ms;
+    if (b > priors[a].budget_max_ms) b = priors[a].budget_max_ms;
+    return (uint16_t)b;
+}
+
+// 排序分数 = 成功率 / 预期耗时 (放大 2^16), 越大越先试
+static uint32_t action_score(const rf_recovery_state_t *state, uint8_t a)
+{
+    const recovery_action_stats_t *st = &state->action_stats[a];
+    uint32_t p = st->p_q8;
+    uint32_t cost = (p * st->avg_ms + (256 - p) * action_budget_ms(state, a)) >> 8;
+    if (cost == 0) cost = 1;
+    return (p << 16) / cost;
+}
+
+static bool predict_allowed(const rf_recovery_state_t *state)
+{
+    return state->drift_known && state->consecutive_miss <= RECOVERY_PREDICT_MAX_MISS;
+}
+
+static bool action_eligible(const rf_recovery_state_t *state, uint8_t a)
+{
+    if (priors[a].min_miss == 0) return false;
+    if (state->tried_mask & (1u << a)) return false;
+    if (state->consecutive_miss < priors[a].min_miss) return false;
+    if (a == RECOVERY_HOP_PREDICT && !predict_allowed(state)) return false;
+    return true;
+}
+
+static void action_start(rf_recovery_state_t *state, uint8_t a, uint32_t now)
+{
+    recovery_action_stats_t *st = &state->action_stats[a];
+    if (st->attempts < 0xFFFF) st->attempts++;
+    
+    state->current_action = (recovery_action_t)a;
+    state->action_start_ms = now;
+    state->tried_mask |= (uint8_t)(1u << a);
+    
+    switch (a) {
+        case RECOVERY_RESYNC:         state->level1_recoveries++; break;
+        case RECOVERY_CHANNEL_SWITCH: state->level2_recoveries++; break;
+        case RECOVERY_FULL_SCAN:      state->level3_recoveries++; break;
+        case RECOVERY_DEEP_SEARCH:
+            state->level4_recoveries++;
+            event_log_u32(EVT_RF_SYNC_LOST, state->consecutive_miss);
+            break;
+        default: break;
+    }
+}
+
+static void action_record(rf_recovery_state_t *state, uint8_t a, bool success, uint32_t elapsed_ms)
+{
+    recovery_action_stats_t *st = &state->action_stats[a];
+    
+    if (success) {
+        if (st->successes < 0xFFFF) st->successes++;
+        st->p_q8 = (uint16_t)(st->p_q8 + ((256 - st->p_q8) >> COST_EWMA_SHIFT));
+        if (elapsed_ms > 0xFFFF) elapsed_ms = 0xFFFF;
+        st->avg_ms = (uint16_t)(((uint32_t)st->avg_ms * ((1u << COST_EWMA_SHIFT) - 1) + elapsed_ms)
+                                >> COST_EWMA_SHIFT);
+    } else {
+        st->p_q8 = (uint16_t)(st->p_q8 - (st->p_q8 >> COST_EWMA_SHIFT));
+        if (st->p_q8 < COST_P_MIN_Q8) st->p_q8 = COST_P_MIN_Q8;
+    }
+}
+
+// 当前动作在预算内且仍排在最前时继续; 否则记一次失败, 换排序最靠前的可选动作
+static recovery_action_t cost_select(rf_recovery_state_t *state)
+{
+    uint32_t now = hal_get_tick_ms();
+    uint8_t cur = (uint8_t)state->current_action;
+    if (cur >= RECOVERY_ACTION_COUNT || priors[cur].min_miss == 0) cur = RECOVERY_IDLE;
+    
+    uint8_t best = RECOVERY_IDLE;
+    uint32_t best_score = 0;
+    for (uint8_t a = RECOVERY_RESYNC; a < RECOVERY_ACTION_COUNT; a++) {
+        if (!action_eligible(state, a)) continue;
+        uint32_t score = action_score(state, a);
+        if (best == RECOVERY_IDLE || score > best_score) {
+            best = a;
+            best_score = score;
+        }
+    }
+    
+    if (cur != RECOVERY_IDLE) {
+        // 没有可换的动作: 超出预算也继续当前动作
+        if (best == RECOVERY_IDLE) return (recovery_action_t)cur;
+        
+        uint32_t elapsed = now - state->action_start_ms;
+        bool over = elapsed > action_budget_ms(state, cur);
+        if (cur == RECOVERY_HOP_PREDICT && !predict_allowed(state)) over = true;
+        if (!over && best_score <= action_score(state, cur)) return (recovery_action_t)cur;
+        
+        action_record(state, cur, false, elapsed);
+    }
+    
+    if (best != RECOVERY_IDLE) {
+        action_start(state, best, now);
+    }
+    return (recovery_action_t)best;
+}
+
+void rf_recovery_set_drift_known(rf_recovery_state_t *state, bool known)
+{
+    if (!state) return;
+    state->drift_known = known;
+}
+
+int rf_recovery_get_action_stats(const rf_recovery_state_t *state, recovery_action_t action,
+                                 recovery_action_stats_t *out)
+{
+    if (!state || !out || (unsigned)action >= RECOVERY_ACTION_COUNT) return -1;
+    *out = state->action_stats[action];
+    return 0;
+}
+
+#endif /* USE_RF_RECOVERY_COST */
+
 /*============================================================================
  * 初始化
  *============================================================================*/
@@ -22,6 +165,13 @@ void rf_recovery_init(rf_recovery_state_t *state)
     memset(state, 0, sizeof(rf_recovery_state_t));
     state->current_action = RECOVERY_IDLE;
     state->last_sync_ms = hal_get_tick_ms();
+    
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+    for (uint8_t a = 0; a < RECOVERY_ACTION_COUNT; a++) {
+        state->action_stats[a].p_q8 = priors[a].p_q8;
+        state->action_stats[a].avg_ms = priors[a].ms;
+    }
+#endif
 }
 
 /*============================================================================
@@ -35,6 +185,9 @@ recovery_action_t rf_recovery_report_miss_sync(rf_recovery_state_t *state)
     state->miss_sync_count++;
     state->consecutive_miss++;
     
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+    return cost_select(state);
+#else
     recovery_action_t action = RECOVERY_IDLE;
     
     // 分级判定
@@ -59,6 +212,7 @@ recovery_action_t rf_recovery_report_miss_sync(rf_recovery_state_t *state)
     }
     
     return action;
+#endif
 }
 
 void rf_recovery_report_sync_ok(rf_recovery_state_t *state)
@@ -70,6 +224,16 @@ void rf_recovery_report_sync_ok(rf_recovery_state_t *state)
         event_log_u32(EVT_RF_SYNC_FOUND, state->consecutive_miss);
     }
     
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST
+    // 恢复耗时计入当前动作; 超过预算上限才恢复的 (如搜索超时后休眠唤醒) 不算该动作成功
+    uint8_t cur = (uint8_t)state->current_action;
+    if (cur < RECOVERY_ACTION_COUNT && priors[cur].min_miss != 0) {
+        uint32_t elapsed = hal_get_tick_ms() - state->action_start_ms;
+        action_record(state, cur, elapsed <= priors[cur].budget_max_ms, elapsed);
+    }
+    state->tried_mask = 0;
+#endif
+    
     state->consecutive_miss = 0;
     state->current_action = RECOVERY_IDLE;
     state->last_sync_ms = hal_get_tick_ms();
@@ -91,7 +255,7 @@ bool rf_recovery_slot_end(rf_recovery_state_t *state, uint8_t slot_id)
     if (!state) return true;
     
     uint32_t elapsed = hal_get_tick_us() - state->slot_start_us;
-    uint32_t slot_limit = RF_DATA_SLOT_US - SLOT_GUARD_US;
+    uint32_t slot_limit = RF_SLOT_US - SLOT_GUARD_US;
     
     if (elapsed > slot_limit) {
         // 越界
@@ -118,7 +282,7 @@ bool rf_recovery_check_slot_overrun(rf_recovery_state_t *state,
 {
     if (!state) return false;
     
-    uint32_t slot_limit = RF_DATA_SLOT_US - SLOT_GUARD_US;
+    uint32_t slot_limit = RF_SLOT_US - SLOT_GUARD_US;
     
     if (elapsed_us > slot_limit) {
         state->slot_overrun_count++;
@@ -12,6 +12,7 @@
  * 5. 并行处理
  */
 
+#include "rf_slot_optimizer.h"
 #include "rf_protocol.h"
 #include "rf_hw.h"
 #include "hal.h"
@@ -71,6 +72,7 @@ typedef struct {
 } slot_manager_t;
 
 static slot_manager_t sm = {0};
+static slot_optimizer_cmd_sink_t cmd_sink = NULL;
 
 /*============================================================================
  * 时隙计算
@@ -356,14 +358,6 @@ uint32_t slot_optimizer_get_remaining_us(void)
  * 统计接口
  *============================================================================*/
 
-typedef struct {
-    uint8_t active_trackers;
-    uint16_t avg_latency_us;
-    uint16_t max_latency_us;
-    uint8_t utilization;
-    uint32_t frame_number;
-} slot_optimizer_stats_t;
-
 void slot_optimizer_get_stats(slot_optimizer_stats_t *stats)
 {
     if (!stats) return;
@@ -384,8 +378,19 @@ void slot_optimizer_get_stats(slot_optimizer_stats_t *stats)
  * 
  * 用于单个 Tracker 场景或紧急数据
  */
+void slot_optimizer_set_command_sink(slot_optimizer_cmd_sink_t sink)
+{
+    cmd_sink = sink;
+}
+
 int slot_optimizer_fast_transmit(uint8_t tracker_id, const uint8_t *data, uint8_t len)
 {
+    // v0.6.3: 接收器侧经命令队列随 ACK 下发, 直接发射会打乱 TDMA 时隙
+    if (cmd_sink) {
+        if (!data || len < 1) return -1;
+        return cmd_sink(tracker_id, data[0], (len >= 2) ? data[1] : 0, true);
+    }
+    
     uint32_t start = hal_get_tick_us();
     
     // 直接传输，不经过调度
@@ -403,11 +408,15 @@ int slot_optimizer_fast_transmit(uint8_t tracker_id, const uint8_t *data, uint8_
  * 批量传输优化
  *============================================================================*/
 
-typedef struct {
-    uint8_t tracker_id;
-    uint8_t *data;
-    uint8_t len;
-} batch_item_t;
+static int tracker_priority(uint8_t tracker_id)
+{
+    for (int k = 0; k < MAX_TRACKERS; k++) {
+        if (sm.slots[k].active && sm.slots[k].tracker_id == tracker_id) {
+            return sm.slots[k].priority;
+        }
+    }
+    return PRIORITY_NORMAL;
+}
 
 /**
  * 批量传输多个 Tracker 的数据
@@ -419,26 +428,27 @@ int slot_optimizer_batch_transmit(batch_item_t *items, uint8_t count)
     if (!items || count == 0) return -1;
     
     int success = 0;
-    uint32_t frame_start = hal_get_tick_us();
     
-    // 按优先级排序
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = i + 1; j < count; j++) {
-            int pri_i = PRIORITY_NORMAL, pri_j = PRIORITY_NORMAL;
-            
-            for (int k = 0; k < MAX_TRACKERS; k++) {
-                if (sm.slots[k].active) {
-                    if (sm.slots[k].tracker_id == items[i].tracker_id) pri_i = sm.slots[k].priority;
-                    if (sm.slots[k].tracker_id == items[j].tracker_id) pri_j = sm.slots[k].priority;
-                }
-            }
-            
-            if (pri_j > pri_i) {
-                batch_item_t tmp = items[i];
-                items[i] = items[j];
-                items[j] = tmp;
-            }
+    // 按优先级排序 (插入排序保持同优先级原顺序, 同一 tracker 的多条命令不会颠倒)
+    for (int i = 1; i < count; i++) {
+        batch_item_t tmp = items[i];
+        int pri = tracker_priority(tmp.tracker_id);
+        int j = i - 1;
+        while (j >= 0 && tracker_priority(items[j].tracker_id) < pri) {
+            items[j + 1] = items[j];
+            j--;
+        }
+        items[j + 1] = tmp;
+    }
+    
+    // v0.6.3: 入各 tracker 命令队列, 不受本帧剩余时间限制
+    if (cmd_sink) {
+        for (int i = 0; i < count; i++) {
+            if (!items[i].data || items[i].len < 1) continue;
+            uint8_t param = (items[i].len >= 2) ? items[i].data[1] : 0;
+            if (cmd_sink(items[i].tracker_id, items[i].data[0], param, false) == 0) success++;
         }
+        return success;
     }
     
     // 顺序传输
@@ -13,20 +13,36 @@
 
 #include "hal.h"
 #include "rf_hw.h"
+#include "rf_protocol.h"
+#include "rf_timing_opt.h"
+#include "config.h"
 #include <string.h>
 
 /*============================================================================
  * 时序参数 (优化后)
  *============================================================================*/
 
-#define SUPERFRAME_US           10000   // 超帧 10ms (100Hz)
-#define SYNC_SLOT_US            500     // 同步时隙 500us
-#define TRACKER_SLOT_US         500     // Tracker 时隙 500us
 #define ACK_WAIT_US             200     // ACK 等待 200us
 #define GUARD_US                50      // 保护间隔 50us
 #define WAKEUP_ADVANCE_US       100     // 提前唤醒 100us
 #define CHANNEL_SWITCH_US       50      // 信道切换 50us
 
+// v0.6.3: 漂移估计基线 - 至少累积这么多帧再计算一次 (信标抖动摊到长基线上)
+#define DRIFT_BASELINE_FRAMES   200     // 1s @ 200Hz
+#define DRIFT_BASELINE_MAX      2000    // 超过 (长时间失步) 则重新锚定
+
+// v0.6.3: 信标跳听 - 漂移估计可信度
+#ifndef RF_BEACON_SKIP_MAX
+#define RF_BEACON_SKIP_MAX      1
+#endif
+#ifndef RF_BEACON_SKIP_GUARD_US
+#define RF_BEACON_SKIP_GUARD_US 20
+#endif
+#define DRIFT_STABLE_PPB        20000   // 单次基线与估计值之差在 20ppm 内算稳定
+#define DRIFT_STABLE_BASELINES  3       // 连续稳定基线数 (约 3s) 后才允许跳听
+#define DRIFT_RESID_FLOOR_PPB   2000    // 残差下限 (信标时间戳抖动)
+#define SLOT_FAIL_STREAK_MAX    2       // 连续无 ACK 达到此数恢复每帧监听
+
 /*============================================================================
  * 时序状态
  *============================================================================*/
@@ -40,10 +56,19 @@ typedef struct {
     // 时隙信息
     uint8_t my_slot;                // 我的时隙
     uint8_t total_slots;            // 总时隙数
+    uint16_t slot_width_us;         // v0.6.3: 时隙宽度 (自适应保护时间随信标变化)
     
     // 时钟补偿
     int32_t clock_drift_ppb;        // 时钟漂移 (ppb)
     int32_t drift_accumulator;      // 累积漂移
+    uint32_t drift_anchor_us;       // v0.6.3: 漂移基线起点 (接收时刻)
+    uint16_t drift_anchor_frame;    // v0.6.3: 基线起点帧号
+    uint16_t drift_anchor_frame_us; // v0.6.3: 基线起点的超帧周期 (可变速率时切换后重新起算)
+    bool drift_anchor_valid;
+    bool drift_estimated;           // v0.6.3: 已有至少一个基线估计
+    uint32_t drift_resid_ppb;       // v0.6.3: 基线估计与滤波值之差 (平均绝对值)
+    uint8_t drift_stable;           // v0.6.3: 连续稳定基线数
+    uint8_t fail_streak;            // v0.6.3: 连续无 ACK 时隙数
     int16_t slot_offset_us;         // 时隙微调
     
     // 自适应参数
@@ -68,25 +93,71 @@ void rf_timing_init(void)
 {
     memset(&rf_timing, 0, sizeof(rf_timing));
     rf_timing.slot_offset_us = WAKEUP_ADVANCE_US;
+    rf_timing.slot_width_us = RF_SLOT_US;
 }
 
 /*============================================================================
  * 时钟漂移补偿
  *============================================================================*/
 
-static void update_clock_drift(uint32_t expected_us, uint32_t actual_us)
+/**
+ * v0.6.3: 按帧号计算长基线漂移
+ * 本地时钟测得的信标间隔 vs 帧数 × RF_FRAME_US (接收器时钟, 基线内周期不变);
+ * 正值表示本地时钟比接收器快 (信标"晚到")
+ */
+static void update_clock_drift(uint32_t rx_time_us, uint16_t frame_num)
 {
-    int32_t error = (int32_t)(actual_us - expected_us);
+    if (!rf_timing.drift_anchor_valid || rf_timing.drift_anchor_frame_us != RF_FRAME_US) {
+        rf_timing.drift_anchor_us = rx_time_us;
+        rf_timing.drift_anchor_frame = frame_num;
+        rf_timing.drift_anchor_frame_us = RF_FRAME_US;
+        rf_timing.drift_anchor_valid = true;
+        return;
+    }
+    
+    uint16_t frames = (uint16_t)(frame_num - rf_timing.drift_anchor_frame);
+    if (frames < DRIFT_BASELINE_FRAMES) {
+        return;
+    }
+    
+    uint32_t elapsed = rx_time_us - rf_timing.drift_anchor_us;
+    uint32_t expected = (uint32_t)frames * RF_FRAME_US;
+    rf_timing.drift_anchor_us = rx_time_us;
+    rf_timing.drift_anchor_frame = frame_num;
     
-    // 限制误差范围
-    if (error > 5000 || error < -5000) {
-        return;  // 跳过异常值
+    if (frames > DRIFT_BASELINE_MAX) {
+        rf_timing.drift_stable = 0;
+        return;
+    }
+    
+    int32_t error = (int32_t)(elapsed - expected);
+    
+    // 限制误差范围 (±1000ppm 以外视为帧号跳变/异常)
+    if ((int64_t)error * 1000 > (int64_t)expected || (int64_t)error * -1000 > (int64_t)expected) {
+        rf_timing.drift_stable = 0;
+        return;
     }
     
     // IIR 滤波更新漂移估计
-    // drift_ppb = error_us / frame_period_us * 1000000
-    int32_t instant_drift = (error * 100);  // 简化计算
-    rf_timing.clock_drift_ppb = (rf_timing.clock_drift_ppb * 15 + instant_drift) / 16;
+    int32_t instant_drift = (int32_t)((int64_t)error * 1000000000LL / expected);
+    if (!rf_timing.drift_estimated) {
+        rf_timing.clock_drift_ppb = instant_drift;  // 首个基线直接采用
+        rf_timing.drift_estimated = true;
+        rf_timing.drift_resid_ppb = DRIFT_STABLE_PPB;
+        rf_timing.drift_stable = 0;
+    } else {
+        // v0.6.3: 残差 = 新基线相对估计值的偏差, 用于判断漂移估计是否可信
+        int32_t dev = instant_drift - rf_timing.clock_drift_ppb;
+        uint32_t abs_dev = (dev < 0) ? (uint32_t)-dev : (uint32_t)dev;
+        rf_timing.drift_resid_ppb = (rf_timing.drift_resid_ppb * 3 + abs_dev) / 4;
+        if (abs_dev < DRIFT_STABLE_PPB) {
+            if (rf_timing.drift_stable < 255) rf_timing.drift_stable++;
+        } else {
+            rf_timing.drift_stable = 0;
+        }
+        
+        rf_timing.clock_drift_ppb += (instant_drift - rf_timing.clock_drift_ppb) / 4;
+    }
     
     // 限制范围 (±500ppm)
     if (rf_timing.clock_drift_ppb > 500000) rf_timing.clock_drift_ppb = 500000;
@@ -101,22 +172,22 @@ uint32_t rf_timing_get_slot_time(void)
 {
     uint32_t now_us = hal_micros();
     
-    // 基础时隙时间
+    // 基础时隙时间 (v0.6.3: 与接收器时隙布局一致)
     uint32_t slot_start = rf_timing.sync_time_us + 
-                          SYNC_SLOT_US + 
-                          (rf_timing.my_slot * TRACKER_SLOT_US);
+                          RF_SYNC_SLOT_US + 
+                          ((uint32_t)rf_timing.my_slot * rf_timing.slot_width_us);
     
     // 时钟漂移补偿
     uint32_t elapsed = now_us - rf_timing.sync_time_us;
-    int32_t drift_comp = (int32_t)((int64_t)elapsed * rf_timing.clock_drift_ppb / 1000000);
+    int32_t drift_comp = (int32_t)((int64_t)elapsed * rf_timing.clock_drift_ppb / 1000000000LL);
     slot_start += drift_comp;
     
     // 自适应微调
     slot_start -= rf_timing.slot_offset_us;
     
     // 如果已经过了，计算下一帧
-    while (slot_start < now_us + WAKEUP_ADVANCE_US) {
-        slot_start += SUPERFRAME_US;
+    while ((int32_t)(slot_start - now_us) < WAKEUP_ADVANCE_US) {
+        slot_start += RF_FRAME_US;
     }
     
     return slot_start;
@@ -130,13 +201,8 @@ void rf_timing_on_sync(uint32_t rx_time_us, uint16_t frame_num, uint8_t channel)
 {
     rf_timing.sync_count++;
     
-    // 计算期望时间
-    uint32_t expected = rf_timing.sync_time_us + SUPERFRAME_US;
-    
-    // 更新时钟漂移 (第二次同步后)
-    if (rf_timing.sync_count > 1) {
-        update_clock_drift(expected, rx_time_us);
-    }
+    // 更新时钟漂移 (长基线, 按帧号计数漏掉的信标)
+    update_clock_drift(rx_time_us, frame_num);
     
     // 更新同步时间
     rf_timing.last_sync_us = rf_timing.sync_time_us;
@@ -147,6 +213,11 @@ void rf_timing_on_sync(uint32_t rx_time_us, uint16_t frame_num, uint8_t channel)
     rf_timing.drift_accumulator = 0;
 }
 
+void rf_timing_rebase(uint32_t frame_start_us)
+{
+    rf_timing.sync_time_us = frame_start_us;
+}
+
 /*============================================================================
  * 时隙结果反馈
  *============================================================================*/
@@ -154,6 +225,8 @@ void rf_timing_on_sync(uint32_t rx_time_us, uint16_t frame_num, uint8_t channel)
 void rf_timing_slot_feedback(bool success, int32_t offset_us)
 {
     if (success) {
+        rf_timing.fail_streak = 0;
+        
         // 计算延迟
         uint32_t latency = (offset_us > 0) ? offset_us : -offset_us;
         
@@ -191,6 +264,7 @@ void rf_timing_slot_feedback(bool success, int32_t offset_us)
         if (rf_timing.slot_offset_us < 0) rf_timing.slot_offset_us = 0;
     } else {
         rf_timing.miss_count++;
+        if (rf_timing.fail_streak < 255) rf_timing.fail_streak++;
     }
 }
 
@@ -204,25 +278,24 @@ void rf_timing_set_slot(uint8_t slot, uint8_t total)
     rf_timing.total_slots = total;
 }
 
+void rf_timing_set_slot_width(uint16_t width_us)
+{
+    rf_timing.slot_width_us = width_us;
+}
+
 /*============================================================================
  * 等待下一时隙
  *============================================================================*/
 
 void rf_timing_wait_slot(void)
 {
-    uint32_t target = rf_timing_get_slot_time();
-    uint32_t now = hal_micros();
-    
-    while (now < target) {
-        // 长等待使用睡眠
-        if (target - now > 1000) {
-            hal_delay_us(100);
-        } else {
-            // 短等待忙等
-            __asm volatile ("nop");
-        }
-        now = hal_micros();
-    }
+    rf_timing_wait_until(rf_timing_get_slot_time());
+}
+
+void rf_timing_wait_until(uint32_t target_us)
+{
+    // v0.6.3: 定时唤醒睡眠, 提前量由 HAL 按实测唤醒延迟学习
+    hal_sleep_until_us(target_us);
 }
 
 /*============================================================================
@@ -250,6 +323,66 @@ void rf_timing_get_stats(uint32_t *sync, uint32_t *miss,
     if (drift_ppb) *drift_ppb = rf_timing.clock_drift_ppb;
 }
 
+int32_t rf_timing_get_drift_ppb(void)
+{
+    return rf_timing.clock_drift_ppb;
+}
+
+/**
+ * v0.6.3: 跳听 N-1 个信标期间本地按漂移估计自由运行,
+ * 累积误差 ≈ 残差 × N × 超帧; 取不超过 RF_BEACON_SKIP_GUARD_US 的最大 N
+ */
+uint8_t rf_timing_get_beacon_interval(void)
+{
+    if (!rf_timing.drift_estimated ||
+        rf_timing.drift_stable < DRIFT_STABLE_BASELINES ||
+        rf_timing.fail_streak >= SLOT_FAIL_STREAK_MAX) {
+        return 1;
+    }
+    
+    uint32_t resid = rf_timing.drift_resid_ppb + DRIFT_RESID_FLOOR_PPB;
+    uint64_t n = (uint64_t)RF_BEACON_SKIP_GUARD_US * 1000000000ULL /
+                 ((uint64_t)resid * RF_FRAME_US);
+    if (n < 1) n = 1;
+    if (n > RF_BEACON_SKIP_MAX) n = RF_BEACON_SKIP_MAX;
+    return (uint8_t)n;
+}
+
+void rf_timing_set_drift_ppb(int32_t drift_ppb)
+{
+    if (drift_ppb > 500000) drift_ppb = 500000;
+    if (drift_ppb < -500000) drift_ppb = -500000;
+    
+    rf_timing.clock_drift_ppb = drift_ppb;
+    rf_timing.drift_estimated = true;
+    rf_timing.drift_resid_ppb = DRIFT_STABLE_PPB;
+    rf_timing.drift_stable = 0;
+    rf_timing.drift_anchor_valid = false;   // 睡眠期间本地时基停止, 旧基线无效
+}
+
+/**
+ * v0.6.3: 信标按每帧计算 (跳听时也避开), 时隙含提前唤醒和 ACK 等待
+ */
+uint32_t rf_timing_get_idle_us(void)
+{
+    if (!rf_timing_is_synced()) return UINT32_MAX;   // 未同步, 没有时隙需要保护
+    
+    uint32_t now_us = hal_micros();
+    int32_t phase = (int32_t)((now_us - rf_timing.sync_time_us) % RF_FRAME_US);
+    
+    // 本帧时隙进行中
+    int32_t slot_begin = RF_SYNC_SLOT_US + (int32_t)rf_timing.my_slot * rf_timing.slot_width_us;
+    int32_t busy_from = slot_begin - rf_timing.slot_offset_us - WAKEUP_ADVANCE_US;
+    int32_t busy_to = slot_begin + rf_timing.slot_width_us + ACK_WAIT_US;
+    if (phase >= busy_from && phase < busy_to) return 0;
+    
+    uint32_t to_slot = rf_timing_get_slot_time() - now_us;
+    uint32_t to_beacon = RF_FRAME_US - (uint32_t)phase;
+    uint32_t idle = (to_slot < to_beacon) ? to_slot : to_beacon;
+    
+    return (idle > WAKEUP_ADVANCE_US + GUARD_US) ? idle - WAKEUP_ADVANCE_US - GUARD_US : 0;
+}
+
 bool rf_timing_is_synced(void)
 {
     uint32_t now = hal_micros();
@@ -11,7 +11,8 @@
 #include "rf_hw.h"
 #include "hal.h"
 #include "board.h"
-#include "gyro_noise_filter.h"  // v0.4.22: 用于静止检测
+#include "optimize.h"           // v0.6.3: RAM_CODE_ISR
+#include "motion_state.h"       // v0.6.3: 共享静止检测
 
 // v0.6.2: RF优化模块 (条件编译)
 #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
@@ -34,6 +35,35 @@
 #include "rf_ultra.h"
 #endif
 
+#if defined(USE_RF_OTA) && USE_RF_OTA
+#include "rf_ota.h"
+#endif
+
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+#include "rf_arbiter.h"
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#include "rf_auth.h"
+#endif
+
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+#include "telemetry_history.h"
+#endif
+
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+#include "soak_stats.h"
+#endif
+
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE
+#include "imu_interface.h"      // v0.6.3: IMU 功耗档分频
+#endif
+
+#if defined(USE_SELFTEST) && USE_SELFTEST
+#include "selftest.h"
+#endif
+
+#include <stddef.h>
 #include <string.h>
 
 /*============================================================================
@@ -73,23 +103,162 @@
 static rf_transmitter_ctx_t *tx_ctx = NULL;
 static rf_tx_sync_callback_t sync_callback = NULL;
 static rf_tx_ack_callback_t ack_callback = NULL;
+static rf_tx_pre_tx_callback_t pre_tx_callback = NULL;
 
 // Sync tracking
 static uint8_t missed_sync_count = 0;
 static uint8_t channel_map[5] = {0};
 static uint8_t channel_map_idx = 0;
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+// v0.6.3: 接收器下发的本 tracker 信道映射 (重启后为 0, 接收器定期重发)
+static volatile uint16_t hop_map = 0;
+#endif
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+// v0.6.3: 信标跳听 - 收到信标后接下来 beacon_skip_left 帧不监听
+static uint8_t beacon_skip_left = 0;
+static bool beacon_skip_frame = false;  // 当前帧为计划跳听帧 (接收机关闭)
+#endif
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+// v0.6.3: 信标宣告的跳频车道与本地跳频表不同, 待主循环重建 (0xFF = 无)
+static volatile uint8_t coex_pending_lane = 0xFF;
+#endif
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+// v0.6.3: 链路认证 - 纪元随信标学习, 本地预测帧号回绕时递增;
+// 已接受信标的 (纪元, 帧号) 必须严格递增 (防重放)
+static volatile uint32_t auth_epoch = 0;
+static uint32_t auth_last_epoch = 0;
+static uint16_t auth_last_frame = 0;
+static bool auth_last_valid = false;
+#endif
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+// v0.6.3: 组休眠 - 信标下发的休眠信标间隔 (帧), 0 = 正常运行
+static uint8_t doze_interval = 0;
+static uint8_t doze_channel = 0;        // 下一个休眠信标的信道
+static bool doze_skip_frame = false;    // 当前帧不是休眠信标帧 (接收机关闭)
+#endif
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+// v0.6.3: 最近一次实际收到的信标 (ctx->frame_number 在丢信标时按预测推进)
+static uint16_t link_beacon_frame = 0;
+static uint32_t link_beacon_us = 0;
+static bool link_beacon_valid = false;
+// 唤醒快速重连: 停在预测信道上直到 rejoin_deadline_us
+static bool rejoin_active = false;
+static uint8_t rejoin_channel = 0;
+static uint32_t rejoin_deadline_us = 0;
+#endif
+#if defined(USE_RF_FAST_ACQUIRE) && USE_RF_FAST_ACQUIRE
+// v0.6.3: 同步捕获 - 固定监听一个必然在 max_gap 帧内被访问的信道
+static bool acq_active = false;
+static uint32_t acq_deadline_us = 0;
+static uint8_t acq_tried[16] = {0};     // 本轮已监听过的信道位图
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+// v0.6.3: 漫游 - 各小区信标 RSSI 的 EWMA (dBm × 16), 丢失的本小区信标按 RF_ROAM_MISS_RSSI 计入
+static int16_t roam_rssi_q4[RF_ROAM_CELLS];
+static uint8_t roam_samples[RF_ROAM_CELLS];
+static uint32_t roam_heard_ms[RF_ROAM_CELLS];
+static uint32_t roam_last_ms = 0;                   // 上次迁移时刻
+// 已迁移到新小区, 待主循环重建跳频表 (0xFF = 无; 之后 5 帧以信标 channel_map 为准)
+static volatile uint8_t roam_cell_pending = 0xFF;
+static volatile bool roam_switched = false;
+#endif
 
 // Timing
 static uint32_t slot_start_time_us = 0;
+static uint32_t my_slot_offset_us = 0;     // v0.6.3: 主时隙相对同步信标的偏移
 static bool in_my_slot = false;
 
+#if defined(USE_RF_TX_PRESTAGE) && USE_RF_TX_PRESTAGE
+// v0.6.3: 主时隙预组的发送帧 (发送后复制到 last_tx_buf 供备用时隙使用)
+static uint8_t tx_stage_buf[RF_MAX_PAYLOAD_SIZE];
+#endif
+
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+// v0.6.3: 自适应超帧布局 (来自同步信标)
+static uint8_t my_slot_index = 0;       // 主时隙 = 本tracker在active_mask中的排名
+static uint8_t primary_slot_count = 0;  // 活跃tracker数
+static uint8_t my_spare_mask = 0;       // bit k = 第k个备用时隙归本tracker
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+static bool phy_slow = false;           // v0.6.3: 信标 phy_mask 要求本tracker主时隙用 1Mbps
+#endif
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+static bool my_slot_scheduled = false;  // 本帧信标是否分给本tracker主时隙
+#endif
+static uint8_t last_tx_buf[RF_MAX_PAYLOAD_SIZE];  // 重传用
+static uint8_t last_tx_len = 0;
+static bool tx_data_fresh = false;      // set_data 之后尚未发送的新样本
+#endif
+
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+// v0.6.3: 时隙宽度随信标下发 (保护时间由接收器按实测到达偏移调整)
+static uint16_t slot_width_us = RF_SLOT_US;
+#define SLOT_WIDTH_US           slot_width_us
+#else
+#define SLOT_WIDTH_US           RF_SLOT_US
+#endif
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+// v0.6.3: 选择性重传队列 - 未确认的聚合包 (原序列号), 最旧优先重发
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+#define RETX_QUEUE_DEPTH            4       // 本帧 (主 + 备用, 等信标确认) + 上一帧
+#else
+#define RETX_QUEUE_DEPTH            2       // 本帧 + 上一帧
+#endif
+
+typedef struct {
+    uint8_t buf[RF_MAX_PAYLOAD_SIZE];
+    uint8_t len;
+    uint32_t built_us;                  // 构建时刻 (包内样本年龄的基准)
+    bool pending;
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    uint8_t ack_slot;                   // 等待确认的发送时隙, GACK_SLOT_NONE = 可重传
+    bool resent;
+#endif
+} retx_entry_t;
+
+static retx_entry_t retx_queue[RETX_QUEUE_DEPTH];
+static uint8_t retx_head = 0;           // 下一个写入位置
+static uint32_t retx_recovered = 0;     // 重传后收到 ACK 的包数
+static uint32_t retx_expired = 0;       // 超过期限放弃的包数
+#endif
+
+static bool ack_seen = false;           // wait_for_ack 期间收到本tracker的 ACK
+
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+// v0.6.3: 组确认 - 本帧已发出、等下一帧信标确认位图的包
+#define GACK_SLOT_NONE              0xFF
+#define GACK_SLOT_PRIMARY           0xFE
+
+static struct {
+    uint16_t frame;                     // 发送所在帧
+    bool primary;                       // 主时隙发过包
+    uint8_t spare;                      // bit k = 第 k 个备用时隙发过包
+    uint8_t channel;
+    uint8_t sequence;                   // 主时隙包序列号 (ack_callback)
+    uint32_t latency_us;
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM && \
+    !(defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT)
+    uint8_t buf[RF_MAX_PAYLOAD_SIZE];   // 主时隙包, 确认后作为差分参考 (有重传队列时由队列负责)
+    uint8_t len;
+#endif
+} gack;
+
+static void gack_on_beacon(rf_transmitter_ctx_t *ctx, const rf_sync_packet_t *sync);
+#endif
+
+#if defined(USE_RF_FEC) && USE_RF_FEC
+static bool fec_mode = false;           // v0.6.3: 接收器要求发送 FEC 包
+#endif
+
 // v0.4.22 P1: 静止降速状态
 static uint32_t frame_skip_counter = 0;  // 帧跳过计数器
 static uint8_t current_tx_divider = MOVING_TX_DIVIDER;  // 当前发送分频
 
 // v0.6.2: RF自适应功率状态
+#if !(defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER)
 static int8_t rssi_history[RSSI_SAMPLE_COUNT] = {-50};
 static uint8_t rssi_history_idx = 0;
+#endif
 static uint8_t current_tx_power = TX_POWER_MED;
 
 /*============================================================================
@@ -101,6 +270,11 @@ static uint8_t current_tx_power = TX_POWER_MED;
  */
 static int8_t update_rssi_avg(int8_t new_rssi)
 {
+#if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
+    // v0.6.3: 样本已由 ch_mgr_record_tx 记录, 与黑名单使用同一份统计
+    int8_t avg = ch_mgr_get_link_rssi(&ch_manager);
+    return (avg == CH_RSSI_UNKNOWN) ? new_rssi : avg;
+#else
     rssi_history[rssi_history_idx] = new_rssi;
     rssi_history_idx = (rssi_history_idx + 1) % RSSI_SAMPLE_COUNT;
     
@@ -109,6 +283,7 @@ static int8_t update_rssi_avg(int8_t new_rssi)
         sum += rssi_history[i];
     }
     return (int8_t)(sum / RSSI_SAMPLE_COUNT);
+#endif
 }
 
 /**
@@ -142,7 +317,48 @@ static void adaptive_tx_power_adjust(int8_t rssi)
  * Packet Building
  *============================================================================*/
 
-static void build_data_packet(rf_transmitter_ctx_t *ctx, rf_tracker_packet_t *pkt)
+/*
+ * v0.6.3: 线性加速度 (去除重力) 只在实际发送的包里计算, 不在每个传感器样本上计算
+ * ctx->acceleration 为机体系原始加速度 (g); 重力方向 g = Rᵀ·e_z 由 Q15 四元数整数计算,
+ * 乘积为 Q30, 单位四元数下 |qx·qz| + |qw·qy| <= 0.5, 不会溢出 int32
+ */
+static int16_t sat_i16(int32_t v)
+{
+    return (v > 32767) ? 32767 : ((v < -32768) ? -32768 : (int16_t)v);
+}
+
+static void quat_to_q15(const float in[4], int16_t out[4])
+{
+    for (int i = 0; i < 4; i++) {
+        float v = in[i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        out[i] = (int16_t)(v * 32767.0f);
+    }
+}
+
+static int16_t linear_accel_z_mg(const rf_transmitter_ctx_t *ctx, const int16_t q[4])
+{
+    int32_t gz = (int32_t)q[0] * q[0] - (int32_t)q[1] * q[1] -
+                 (int32_t)q[2] * q[2] + (int32_t)q[3] * q[3];          // Q30
+    int32_t az = (int32_t)(ctx->acceleration[2] * 1000.0f);
+    return sat_i16(az - (((gz >> 14) * 1000) >> 16));
+}
+
+static void linear_accel_mg(const rf_transmitter_ctx_t *ctx, const int16_t q[4], int16_t out[3])
+{
+    // 2·(qx·qz - qw·qy), 2·(qy·qz + qw·qx): 因子 2 并入移位 (Q30 → Q16 少移一位)
+    int32_t gx = (int32_t)q[1] * q[3] - (int32_t)q[0] * q[2];
+    int32_t gy = (int32_t)q[2] * q[3] + (int32_t)q[0] * q[1];
+    int32_t ax = (int32_t)(ctx->acceleration[0] * 1000.0f);
+    int32_t ay = (int32_t)(ctx->acceleration[1] * 1000.0f);
+
+    out[0] = sat_i16(ax - (((gx >> 13) * 1000) >> 16));
+    out[1] = sat_i16(ay - (((gy >> 13) * 1000) >> 16));
+    out[2] = linear_accel_z_mg(ctx, q);
+}
+
+static void build_data_packet(rf_transmitter_ctx_t *ctx, rf_tracker_packet_t *pkt,
+                              uint32_t tx_us)
 {
     memset(pkt, 0, sizeof(rf_tracker_packet_t));
     
@@ -151,31 +367,32 @@ static void build_data_packet(rf_transmitter_ctx_t *ctx, rf_tracker_packet_t *pk
     pkt->tracker_id = ctx->tracker_id;
     pkt->sequence = ctx->sequence++;
     
-    // Convert quaternion to int16
-    // 四元数范围钳位防止溢出
-    float q0 = ctx->quaternion[0], q1 = ctx->quaternion[1];
-    float q2 = ctx->quaternion[2], q3 = ctx->quaternion[3];
-    if (q0 > 1.0f) q0 = 1.0f; else if (q0 < -1.0f) q0 = -1.0f;
-    if (q1 > 1.0f) q1 = 1.0f; else if (q1 < -1.0f) q1 = -1.0f;
-    if (q2 > 1.0f) q2 = 1.0f; else if (q2 < -1.0f) q2 = -1.0f;
-    if (q3 > 1.0f) q3 = 1.0f; else if (q3 < -1.0f) q3 = -1.0f;
-    pkt->quat_w = (int16_t)(q0 * 32767.0f);
-    pkt->quat_x = (int16_t)(q1 * 32767.0f);
-    pkt->quat_y = (int16_t)(q2 * 32767.0f);
-    pkt->quat_z = (int16_t)(q3 * 32767.0f);
-    
-    // 加速度范围钳位防止int16_t溢出 (±32.767g范围)
-    float ax = ctx->acceleration[0], ay = ctx->acceleration[1], az = ctx->acceleration[2];
-    if (ax > 32.767f) ax = 32.767f; else if (ax < -32.768f) ax = -32.768f;
-    if (ay > 32.767f) ay = 32.767f; else if (ay < -32.768f) ay = -32.768f;
-    if (az > 32.767f) az = 32.767f; else if (az < -32.768f) az = -32.768f;
-    pkt->accel_x = (int16_t)(ax * 1000.0f);
-    pkt->accel_y = (int16_t)(ay * 1000.0f);
-    pkt->accel_z = (int16_t)(az * 1000.0f);
+    // Convert quaternion to int16 (范围钳位防止溢出)
+    int16_t q[4];
+    quat_to_q15(ctx->quaternion, q);
+    pkt->quat_w = q[0];
+    pkt->quat_x = q[1];
+    pkt->quat_y = q[2];
+    pkt->quat_z = q[3];
+    
+    // 线性加速度 mg (饱和到 int16)
+    int16_t lin[3];
+    linear_accel_mg(ctx, q, lin);
+    pkt->accel_x = lin[0];
+    pkt->accel_y = lin[1];
+    pkt->accel_z = lin[2];
     
     pkt->battery = ctx->battery;
     pkt->flags = ctx->flags;
     
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    // v0.6.3: 年龄相对 (预计) 发送时刻
+    uint32_t age = (tx_us - ctx->sample_us) / RF_SAMPLE_AGE_TICK_US;
+    pkt->sample_age = (age > 0xFF) ? 0xFF : (uint8_t)age;
+#else
+    (void)tx_us;
+#endif
+    
     pkt->crc = rf_calc_crc16(pkt, sizeof(rf_tracker_packet_t) - 2);
 }
 
@@ -206,6 +423,114 @@ static void build_pair_confirm(rf_transmitter_ctx_t *ctx, rf_pair_confirm_t *pkt
     pkt->crc = rf_calc_crc16(pkt, sizeof(rf_pair_confirm_t) - 2);
 }
 
+/**
+ * @brief 按当前格式 (RF Ultra / 标准) 构建数据帧
+ * @return 帧长度
+ */
+#if defined(USE_RF_ULTRA) && USE_RF_ULTRA
+/**
+ * @brief 构建单样本 RF Ultra 包
+ * @return 帧长度
+ */
+static uint8_t build_ultra_frame(rf_transmitter_ctx_t *ctx, uint8_t *buf)
+{
+    // 使用RF Ultra高效数据包格式 (12字节 vs 21字节标准格式)
+    // 转换float四元数到Q15格式
+    q15_t quat_q15[4];
+    quat_to_q15(ctx->quaternion, quat_q15);
+    
+    // 垂直线性加速度 (mg单位), 只在发送时计算
+    int16_t accel_z_mg = linear_accel_z_mg(ctx, quat_q15);
+    
+    rf_ultra_build_quat_packet(buf, ctx->tracker_id, quat_q15,
+                               accel_z_mg, ctx->battery);
+    ctx->sequence++;  // 序列号自增
+    return RF_ULTRA_PACKET_SIZE;
+}
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/**
+ * @brief v0.6.3: 构建双姿态包 (主 IMU + 辅助 IMU)
+ * @return 帧长度
+ */
+static uint8_t build_dual_frame(rf_transmitter_ctx_t *ctx, uint8_t *buf, uint32_t tx_us)
+{
+    q15_t q[4], aux_q[4];
+    quat_to_q15(ctx->quaternion, q);
+    quat_to_q15(ctx->aux_quaternion, aux_q);
+    
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    uint32_t sample_us[2] = { ctx->sample_us, ctx->aux_sample_us };
+#else
+    uint32_t sample_us[2] = { tx_us, ctx->aux_sample_us };
+#endif
+    return (uint8_t)rf_dual_build_packet(buf, ctx->tracker_id, ctx->sequence++, q, aux_q,
+                                         linear_accel_z_mg(ctx, q), ctx->battery, ctx->flags,
+                                         sample_us, tx_us);
+}
+#endif
+#endif
+
+static uint8_t build_tx_frame(rf_transmitter_ctx_t *ctx, uint8_t *buf, uint32_t tx_us)
+{
+    (void)tx_us;
+#if defined(USE_RF_ULTRA) && USE_RF_ULTRA
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+    // v0.6.3: 融合卸载 - 只发原始样本包 (每包带最近 2 个样本, 发送后不清空);
+    // 姿态由接收器融合, 不再切换到 FEC 单样本包
+    if (rf_raw_pending()) {
+        return (uint8_t)rf_raw_build_packet(buf, ctx->tracker_id, ctx->sequence++,
+                                            ctx->battery, ctx->flags, tx_us);
+    }
+#endif
+    
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    // v0.6.3: 有辅助 IMU 时两个姿态合在一个包里 (20 字节, 超出 FEC 内层上限, 不做增量)
+    if (ctx->aux_valid) {
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+        rf_multi_clear();
+#endif
+        return build_dual_frame(ctx, buf, tx_us);
+    }
+#endif
+    
+#if defined(USE_RF_FEC) && USE_RF_FEC
+    // v0.6.3: 误码多时发送汉明码保护的单样本包 (12 → 25 字节)
+    if (fec_mode) {
+        uint8_t inner[RF_ULTRA_PACKET_SIZE];
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+        rf_multi_clear();
+#endif
+        uint8_t inner_len = build_ultra_frame(ctx, inner);
+        return (uint8_t)rf_fec_encode(buf, inner, inner_len);
+    }
+#endif
+    
+#if defined(USE_RF_MULTI_SAMPLE) && USE_RF_MULTI_SAMPLE
+    // v0.6.3: 有缓存样本时发送多样本聚合包 (1-4 个带时间戳的姿态)
+    if (rf_multi_pending()) {
+        int16_t q[4];
+        quat_to_q15(ctx->quaternion, q);
+        int16_t az_mg = linear_accel_z_mg(ctx, q);
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+        // v0.6.3: 关键帧之间只发相对已确认参考的增量
+        return (uint8_t)rf_delta_build_packet(buf, ctx->tracker_id, ctx->sequence++,
+                                              az_mg, ctx->battery, ctx->flags, tx_us);
+#else
+        return (uint8_t)rf_multi_build_packet(buf, ctx->tracker_id, ctx->sequence++,
+                                              az_mg, ctx->battery, ctx->flags, tx_us);
+#endif
+    }
+#endif
+    
+    return build_ultra_frame(ctx, buf);
+#else
+    // 使用标准数据包格式
+    build_data_packet(ctx, (rf_tracker_packet_t *)buf, tx_us);
+    return sizeof(rf_tracker_packet_t);
+#endif
+}
+
 /*============================================================================
  * v0.4.22 P1: 静止降速辅助函数
  * 根据运动状态动态调整发送频率
@@ -217,8 +542,13 @@ static void build_pair_confirm(rf_transmitter_ctx_t *ctx, rf_pair_confirm_t *pkt
  */
 static void update_tx_divider(void)
 {
-    // 使用gyro_noise_filter的静止检测
-    bool is_stationary = gyro_filter_is_stationary();
+    // v0.6.3: 使用共享的 motion_state 静止检测
+    bool is_stationary = motion_state_is_rest();
+    
+#if defined(USE_RF_OTA) && USE_RF_OTA
+    // v0.6.3: 固件广播期间每帧发送, 接收广播块只在本 tracker 时隙之后进行
+    if (rf_ota_listening()) is_stationary = false;
+#endif
     
     if (is_stationary) {
         // 静止：每4帧发送1次 (50Hz)
@@ -227,6 +557,17 @@ static void update_tx_divider(void)
         // 运动：每帧发送 (200Hz)
         current_tx_divider = MOVING_TX_DIVIDER;
     }
+    
+#if defined(USE_IMU_POWER_PROFILE) && USE_IMU_POWER_PROFILE
+    // v0.6.3: IMU 降 ODR 时不比新样本更快地发送 (OTA 期间除外)
+    uint8_t imu_div = imu_get_rate_div();
+#if defined(USE_RF_OTA) && USE_RF_OTA
+    if (rf_ota_listening()) imu_div = 1;
+#endif
+    if (current_tx_divider < imu_div) {
+        current_tx_divider = imu_div;
+    }
+#endif
 }
 
 /**
@@ -249,17 +590,124 @@ static bool should_transmit_this_frame(void)
  * Sync Beacon Processing
  *============================================================================*/
 
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+RAM_CODE_ISR
+static void roam_sample(uint8_t cell, int8_t rssi, uint32_t now_ms)
+{
+    // 长时间没听到的小区从新样本重新开始
+    if (roam_samples[cell] == 0 || now_ms - roam_heard_ms[cell] > RF_ROAM_PEER_TIMEOUT_MS) {
+        roam_rssi_q4[cell] = (int16_t)rssi * 16;
+        roam_samples[cell] = 0;
+    } else {
+        roam_rssi_q4[cell] += ((int16_t)rssi * 16 - roam_rssi_q4[cell]) / 8;
+    }
+    if (roam_samples[cell] < 255) roam_samples[cell]++;
+    roam_heard_ms[cell] = now_ms;
+}
+
+static inline uint8_t roam_own_cell(void)
+{
+    return (roam_cell_pending != 0xFF) ? roam_cell_pending : rf_hop_table_get_cell();
+}
+
+/**
+ * @brief v0.6.3: 按信标所属小区决定是否跟随
+ * @return true = 本小区 (或刚迁移到该小区), 按正常信标处理
+ */
+RAM_CODE_ISR
+static bool roam_on_beacon(rf_transmitter_ctx_t *ctx, const rf_sync_packet_t *sync, int8_t rssi)
+{
+    uint8_t cell = sync->roam_cell;
+    uint8_t own = roam_own_cell();
+    uint32_t now_ms = hal_millis();
+    
+    if (cell >= RF_ROAM_CELLS) return false;
+    roam_sample(cell, rssi, now_ms);
+    if (cell == own) return true;
+    
+    // 配对未复制到该接收器时信标掩码里没有本 tracker, 跟随它会被当成解除配对
+    bool listed = ctx->tracker_id < RF_TRACKER_MASK_BYTES * 8 &&
+                  (sync->active_mask[ctx->tracker_id / 8] & (1 << (ctx->tracker_id % 8)));
+    
+    if (!ctx->paired || ctx->state == TX_STATE_PAIRING) {
+        // 未入网: 跟随先听到的小区
+    } else if (!listed) {
+        return false;
+    } else if (ctx->state != TX_STATE_SEARCHING) {
+        // 运行中: 邻小区稳定地强出余量才迁移, 两次迁移之间至少间隔 RF_ROAM_HOLD_MS
+        if (roam_samples[cell] < RF_ROAM_MIN_SAMPLES ||
+            now_ms - roam_last_ms < RF_ROAM_HOLD_MS ||
+            roam_rssi_q4[cell] - roam_rssi_q4[own] <= RF_ROAM_MARGIN_DB * 16) {
+            return false;
+        }
+    }
+    
+    roam_cell_pending = cell;
+    roam_last_ms = now_ms;
+    roam_switched = true;
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    hop_map = 0;                    // 映射属于原接收器
+#endif
+    return true;
+}
+#endif
+
+RAM_CODE_ISR
 static void process_sync_beacon(rf_transmitter_ctx_t *ctx, 
-                                 const rf_sync_packet_t *sync)
+                                 const rf_sync_packet_t *sync, int8_t rssi)
 {
     // Verify CRC
     uint16_t calc_crc = rf_calc_crc16(sync, sizeof(rf_sync_packet_t) - 2);
     if (calc_crc != sync->crc) return;
     
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    // v0.6.3: 两台接收器共用网络密钥和同步字, 只跟随本小区 (或按信号择优迁移)
+    if (!roam_on_beacon(ctx, sync, rssi)) return;
+#else
+    (void)rssi;
+#endif
+    
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    // v0.6.3: 同一房间的其他套件共用同步字, 已配对时只跟随本网络的信标
+    if (ctx->paired && ctx->state != TX_STATE_PAIRING &&
+        sync->net_tag != rf_coex_net_tag(ctx->network_key)) return;
+    if (sync->hop_lane < RF_COEX_LANES && sync->hop_lane != rf_hop_table_get_lane()) {
+        coex_pending_lane = sync->hop_lane;
+    }
+#endif
+    
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    // v0.6.3: 已配对时只接受带正确 MIC 且比上一个更新的信标 (配对中的 tracker 还没有对应的接收器)
+    if (ctx->paired && ctx->state != TX_STATE_PAIRING && rf_auth_active()) {
+        rf_auth_nonce_t nonce = {
+            .epoch = sync->auth_epoch,
+            .frame = sync->frame_number,
+            .tracker_id = RF_AUTH_ID_BEACON,
+            .attempt = 0,
+        };
+        if (!rf_auth_verify(sync->mic, (const uint8_t *)sync,
+                            offsetof(rf_sync_packet_t, mic), &nonce)) return;
+        if (auth_last_valid &&
+            (sync->auth_epoch < auth_last_epoch ||
+             (sync->auth_epoch == auth_last_epoch && sync->frame_number <= auth_last_frame))) {
+            return;
+        }
+        auth_last_epoch = sync->auth_epoch;
+        auth_last_frame = sync->frame_number;
+        auth_last_valid = true;
+    }
+    auth_epoch = sync->auth_epoch;
+#endif
+    
     // Update frame number and timing
     ctx->frame_number = sync->frame_number;
-    ctx->sync_time_us = rf_hw_get_time_us();
+    // v0.6.3: 接收中断入口锁存的时刻, 不含 FIFO 读取和信标校验的耗时 (USE_HW_TIMESTAMP)
+    ctx->sync_time_us = rf_hw_get_rx_time_us();
     ctx->last_sync_ms = hal_millis();
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    // v0.6.3: 本帧周期和已通告的切换 (下一帧时刻和漂移基线按它计算)
+    rf_frame_rate_sync(sync->frame_rate);
+#endif
     
     // Store channel map
     memcpy(channel_map, sync->channel_map, 5);
@@ -267,6 +715,17 @@ static void process_sync_beacon(rf_transmitter_ctx_t *ctx,
     
     missed_sync_count = 0;
     
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+    link_beacon_frame = ctx->frame_number;
+    link_beacon_us = ctx->sync_time_us;
+    link_beacon_valid = true;
+    rejoin_active = false;
+#endif
+#if defined(USE_RF_FAST_ACQUIRE) && USE_RF_FAST_ACQUIRE
+    acq_active = false;
+    memset(acq_tried, 0, sizeof(acq_tried));
+#endif
+    
     // v0.6.2: 通知时序优化模块同步成功
     #if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
     rf_timing_on_sync(ctx->sync_time_us, ctx->frame_number, channel_map[0]);
@@ -283,12 +742,36 @@ static void process_sync_beacon(rf_transmitter_ctx_t *ctx,
         ctx->state = TX_STATE_SYNCED;
     }
     
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+    // v0.6.3: 监听间隔由漂移估计可信度决定; 重新锁定后先逐帧监听
+    if (ctx->state == TX_STATE_SYNCED) {
+        beacon_skip_left = 0;
+        beacon_skip_frame = false;
+    } else {
+        beacon_skip_left = rf_timing_get_beacon_interval() - 1;
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+        // 速率切换通告期间逐帧监听, 切换帧以信标为准
+        if (rf_frame_rate_pending()) beacon_skip_left = 0;
+#endif
+    }
+#endif
+    
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+    // v0.6.3: 休眠期间听哪些帧由帧号决定, 不用漂移估计的跳听间隔
+    doze_interval = sync->doze_interval;
+    if (ctx->state == TX_STATE_SYNCED) doze_skip_frame = false;
+    if (doze_interval) {
+        doze_channel = sync->channel_map[0];
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+        beacon_skip_left = 0;
+#endif
+    }
+#endif
+    
     // Check if we're in the active mask
     bool am_active = false;
-    if (ctx->tracker_id < 8) {
-        am_active = (sync->active_mask[0] & (1 << ctx->tracker_id)) != 0;
-    } else if (ctx->tracker_id < 16) {
-        am_active = (sync->active_mask[1] & (1 << (ctx->tracker_id - 8))) != 0;
+    if (ctx->tracker_id < RF_TRACKER_MASK_BYTES * 8) {
+        am_active = (sync->active_mask[ctx->tracker_id / 8] & (1 << (ctx->tracker_id % 8))) != 0;
     }
     
     if (!am_active && ctx->paired) {
@@ -297,6 +780,64 @@ static void process_sync_beacon(rf_transmitter_ctx_t *ctx,
         ctx->state = TX_STATE_UNPAIRED;
     }
     
+#if defined(USE_RF_ADAPTIVE_GUARD) && USE_RF_ADAPTIVE_GUARD
+    {
+        uint8_t guard = sync->slot_guard;
+        if (guard > RF_GUARD_MAX_US) guard = RF_GUARD_MAX_US;
+        slot_width_us = RF_SLOT_WIDTH_US(guard);
+    }
+#endif
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    // v0.6.3: 主时隙按ID顺序紧凑排列, 排名 = 比本ID小的活跃tracker数
+    // 多超帧调度时只统计本帧分到主时隙的tracker (sched_mask)
+    if (am_active) {
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+        const uint8_t *slot_mask = sync->sched_mask;
+#else
+        const uint8_t *slot_mask = sync->active_mask;
+#endif
+        rf_tracker_mask_t mask = 0;
+        for (uint8_t i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+            mask |= (rf_tracker_mask_t)slot_mask[i] << (i * 8);
+        }
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        // 1Mbps tracker 的主时隙占两个连续时隙, 排名和总数按时隙数计
+        rf_tracker_mask_t phy = 0;
+        for (uint8_t i = 0; i < RF_TRACKER_MASK_BYTES; i++) {
+            phy |= (rf_tracker_mask_t)sync->phy_mask[i] << (i * 8);
+        }
+        phy_slow = (phy >> ctx->tracker_id) & 1;
+#endif
+        uint8_t rank = 0, total = 0;
+        for (uint8_t i = 0; i < RF_TRACKER_MASK_BYTES * 8; i++) {
+            if (mask & ((rf_tracker_mask_t)1 << i)) {
+                uint8_t w = 1;
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+                if (phy & ((rf_tracker_mask_t)1 << i)) w = 2;
+#endif
+                if (i < ctx->tracker_id) rank += w;
+                total += w;
+            }
+        }
+        my_slot_index = rank;
+        primary_slot_count = total;
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+        my_slot_scheduled = (mask & ((rf_tracker_mask_t)1 << ctx->tracker_id)) != 0;
+#endif
+        
+        my_spare_mask = 0;
+        for (uint8_t k = 0; k < RF_SPARE_SLOT_MAX; k++) {
+            if (primary_slot_count + k >= sync->slot_count) break;
+            if (sync->spare_owner[k] == ctx->tracker_id) my_spare_mask |= (1u << k);
+        }
+    }
+#endif
+    
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    if (ctx->paired) gack_on_beacon(ctx, sync);
+#endif
+    
     // Call sync callback
     if (sync_callback) {
         sync_callback(ctx->frame_number);
@@ -307,15 +848,87 @@ static void process_sync_beacon(rf_transmitter_ctx_t *ctx,
  * ACK Processing
  *============================================================================*/
 
-static void process_ack(rf_transmitter_ctx_t *ctx, const rf_ack_packet_t *ack)
+/**
+ * @brief 执行接收器下发的命令 (ACK 或组确认信标携带)
+ */
+RAM_CODE_ISR
+static void apply_command(rf_transmitter_ctx_t *ctx, uint8_t command, uint8_t data)
 {
+    if (command == RF_CMD_NONE) return;
+    
+    switch (command) {
+        case RF_CMD_CALIBRATE_GYRO:
+            ctx->flags |= RF_FLAG_CALIBRATING;
+            // Trigger calibration in main app
+            break;
+            
+        case RF_CMD_TARE:
+            // Trigger tare in main app
+            break;
+            
+        case RF_CMD_SLEEP:
+            rf_transmitter_sleep(ctx);
+            break;
+            
+        case RF_CMD_SET_POWER:
+            // v0.6.3: 接收器闭环功率控制 (每个 ACK 都带当前等级)
+            if (data <= RF_TX_POWER_4DBM && data != current_tx_power) {
+                current_tx_power = data;
+                rf_hw_set_tx_power(current_tx_power);
+            }
+            break;
+            
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        case RF_CMD_SET_FEC:
+            // v0.6.3: 接收器按 CRC 错误统计切换 (绝对值, 与功率等级交替下发)
+            fec_mode = (data != 0);
+            break;
+#endif
+            
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+        case RF_CMD_SET_HOP_LO:
+            // v0.6.3: 本 tracker 信道映射 (绝对值, 低/高字节分开下发)
+            hop_map = (uint16_t)((hop_map & 0xFF00) | data);
+            break;
+            
+        case RF_CMD_SET_HOP_HI:
+            hop_map = (uint16_t)((hop_map & 0x00FF) | ((uint16_t)data << 8));
+            break;
+#endif
+            
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        case RF_CMD_OTA_LISTEN:
+            rf_ota_listen(data);
+            break;
+            
+        case RF_CMD_OTA_APPLY:
+            rf_ota_apply(data);
+            break;
+#endif
+            
+        case RF_CMD_UNPAIR:
+            ctx->paired = false;
+            ctx->state = TX_STATE_UNPAIRED;
+            // Clear stored pairing data
+            break;
+            
+        default:
+            break;
+    }
+}
+
+RAM_CODE_ISR
+static void process_ack(rf_transmitter_ctx_t *ctx, const rf_ack_packet_t *ack,
+                        int8_t rssi)
+{
+    (void)rssi;
+    
     // Verify CRC
     uint16_t calc_crc = rf_calc_crc16(ack, sizeof(rf_ack_packet_t) - 2);
     if (calc_crc != ack->crc) {
         // v0.6.2: CRC错误反馈给信道管理器
         #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
-        extern channel_manager_t ch_manager;
-        ch_mgr_record_crc_error(&ch_manager, channel_map[channel_map_idx]);
+        ch_mgr_record_crc_error(&ch_manager, ctx->current_channel);
         #endif
         return;
     }
@@ -324,14 +937,21 @@ static void process_ack(rf_transmitter_ctx_t *ctx, const rf_ack_packet_t *ack)
     if (ack->tracker_id != ctx->tracker_id) return;
     
     // Mark ACK received
+    ack_seen = true;
+    
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_record_rssi(rssi);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    soak_record_rssi(rssi);
+#endif
     ctx->pending_ack = 0;
     ctx->retry_count = 0;
     
     // v0.6.2: 成功ACK反馈给信道管理器
     #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
-    extern channel_manager_t ch_manager;
-    // RSSI信息在ACK包中不可用，使用0作为默认值
-    ch_mgr_record_tx(&ch_manager, channel_map[channel_map_idx], true, 0);
+    // v0.6.3: 记在本次发送所用信道上, 并带上 ACK 的接收 RSSI
+    ch_mgr_record_tx(&ch_manager, ctx->current_channel, true, rssi);
     #endif
     
     // v0.6.2: 时序反馈
@@ -340,31 +960,7 @@ static void process_ack(rf_transmitter_ctx_t *ctx, const rf_ack_packet_t *ack)
     #endif
     
     // Process command if present
-    if (ack->command != RF_CMD_NONE) {
-        switch (ack->command) {
-            case RF_CMD_CALIBRATE_GYRO:
-                ctx->flags |= RF_FLAG_CALIBRATING;
-                // Trigger calibration in main app
-                break;
-                
-            case RF_CMD_TARE:
-                // Trigger tare in main app
-                break;
-                
-            case RF_CMD_SLEEP:
-                rf_transmitter_sleep(ctx);
-                break;
-                
-            case RF_CMD_UNPAIR:
-                ctx->paired = false;
-                ctx->state = TX_STATE_UNPAIRED;
-                // Clear stored pairing data
-                break;
-                
-            default:
-                break;
-        }
-    }
+    apply_command(ctx, ack->command, ack->command_data);
     
     // Call ACK callback
     if (ack_callback) {
@@ -372,6 +968,90 @@ static void process_ack(rf_transmitter_ctx_t *ctx, const rf_ack_packet_t *ack)
     }
 }
 
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+/**
+ * @brief v0.6.3: 按信标中的组确认位图结算上一帧发出的包, 并执行捎带给本tracker的命令
+ *
+ * 漏听了中间的信标时上一帧结果未知, 按未确认处理 (重传包接收器会去重)
+ */
+RAM_CODE_ISR
+static void gack_on_beacon(rf_transmitter_ctx_t *ctx, const rf_sync_packet_t *sync)
+{
+    bool prev = (uint16_t)(sync->frame_number - gack.frame) == 1;
+    bool primary_ok = false;
+    uint8_t spare_ok = 0;
+    if (prev && ctx->tracker_id < RF_TRACKER_MASK_BYTES * 8) {
+        primary_ok = (sync->ack_mask[ctx->tracker_id / 8] >> (ctx->tracker_id % 8)) & 1;
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+        spare_ok = sync->ack_spare & gack.spare;
+#endif
+    }
+    
+    if (gack.primary) {
+        if (primary_ok) {
+            ctx->pending_ack = 0;
+            ctx->retry_count = 0;
+        }
+#if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
+        // 信标与发送不在同一信道, 不带 RSSI
+        ch_mgr_record_tx(&ch_manager, gack.channel, primary_ok, CH_RSSI_UNKNOWN);
+#endif
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+        rf_timing_slot_feedback(primary_ok, 0);
+#endif
+#if defined(USE_RF_SLOT_OPTIMIZER) && USE_RF_SLOT_OPTIMIZER
+        slot_optimizer_report_result(ctx->tracker_id, primary_ok, gack.latency_us);
+#endif
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+        telem_record_packets(1, primary_ok ? 0 : 1);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+        soak_record_packets(1, primary_ok ? 0 : 1);
+#endif
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM && \
+    !(defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT)
+        if (primary_ok) rf_delta_on_ack(gack.buf, gack.len);
+#endif
+        if (ack_callback) {
+            ack_callback(gack.sequence, primary_ok);
+        }
+    }
+    
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+    // 未确认的留在队列里, 由之后的备用时隙重传
+    for (uint8_t i = 0; i < RETX_QUEUE_DEPTH; i++) {
+        retx_entry_t *e = &retx_queue[i];
+        if (!e->pending || e->ack_slot == GACK_SLOT_NONE) continue;
+        
+        bool ok = (e->ack_slot == GACK_SLOT_PRIMARY) ? primary_ok
+                                                     : ((spare_ok >> e->ack_slot) & 1);
+        e->ack_slot = GACK_SLOT_NONE;
+        if (!ok) continue;
+        
+        e->pending = false;
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+        rf_delta_on_ack(e->buf, e->len);
+#endif
+        if (e->resent) {
+            retx_recovered++;
+            if (ack_callback) {
+                ack_callback(e->buf[2], true);  // 聚合包 [2] = 序列号
+            }
+        }
+    }
+#else
+    (void)spare_ok;
+#endif
+    
+    gack.primary = false;
+    gack.spare = 0;
+    
+    if (sync->cmd_tracker == ctx->tracker_id) {
+        apply_command(ctx, sync->command, sync->command_data);
+    }
+}
+#endif
+
 /*============================================================================
  * Pairing Response Processing
  *============================================================================*/
@@ -391,6 +1071,10 @@ static void process_pair_response(rf_transmitter_ctx_t *ctx,
     memcpy(ctx->receiver_mac, resp->receiver_mac, 6);
     ctx->network_key = resp->network_key;
     ctx->paired = true;
+    rf_hop_table_build(ctx->network_key, NULL, 0);
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+    hop_map = 0;
+#endif
     
     // Send confirmation
     rf_pair_confirm_t conf;
@@ -405,6 +1089,92 @@ static void process_pair_response(rf_transmitter_ctx_t *ctx,
     ctx->state = TX_STATE_SEARCHING;
 }
 
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+#define PAIR_SLOTTED_TIMEOUT_MS     10000
+
+static inline uint32_t pair_slot_us(uint32_t batch_us, uint8_t slot)
+{
+    return batch_us + RF_PAIR_GUARD_US + (uint32_t)slot * RF_PAIR_SLOT_US;
+}
+
+/**
+ * @brief v0.6.3: 时隙配对 - 每收到一个批量应答算一个周期
+ *
+ * 应答里有自己 (MAC 后 4 字节) 的分配: 在第 k 个确认时隙发确认, 配对完成.
+ * 否则若上一周期发过请求 (冲突或接收器本周期已满) 退避指数加一, 随机跳过
+ * [0, 2^n) 个周期; 不跳过时在 [count, RF_PAIR_SLOTS) 中随机选一个时隙发请求
+ */
+static int pair_slotted(rf_transmitter_ctx_t *ctx)
+{
+    rf_pair_request_t req;
+    build_pair_request(ctx, &req);
+    
+    uint32_t deadline_us = rf_hw_get_time_us() + PAIR_SLOTTED_TIMEOUT_MS * 1000UL;
+    uint8_t backoff = 0;
+    uint8_t skip = 0;
+    bool requested = false;
+    
+    while (rf_hw_wait_rx(deadline_us)) {
+        uint8_t buf[RF_MAX_PAYLOAD_SIZE];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        uint32_t batch_us = rf_hw_get_time_us();
+        if (len < (int)sizeof(rf_pair_batch_t)) continue;
+        
+        const rf_pair_batch_t *batch = (const rf_pair_batch_t *)buf;
+        if (batch->header.type != RF_PKT_PAIR_BATCH) continue;
+        if (rf_calc_crc16(batch, sizeof(rf_pair_batch_t) - 2) != batch->crc) continue;
+        
+        uint8_t count = batch->count;
+        if (count > RF_PAIR_BATCH_MAX) continue;
+        
+        for (uint8_t k = 0; k < count; k++) {
+            const rf_pair_assign_t *a = &batch->assign[k];
+            if (memcmp(a->mac_tail, &ctx->mac_address[2], 4) != 0) continue;
+            if (a->tracker_id >= RF_MAX_TRACKERS) break;
+            
+            ctx->tracker_id = a->tracker_id;
+            memcpy(ctx->receiver_mac, batch->receiver_mac, 6);
+            ctx->network_key = batch->network_key;
+            ctx->paired = true;
+            rf_hop_table_build(ctx->network_key, NULL, 0);
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            hop_map = 0;
+#endif
+            
+            rf_pair_confirm_t conf;
+            build_pair_confirm(ctx, &conf);
+            hal_sleep_until_us(pair_slot_us(batch_us, k));
+            rf_hw_tx_mode();
+            rf_hw_transmit_wait((uint8_t *)&conf, sizeof(conf));
+            
+            ctx->state = TX_STATE_SEARCHING;
+            return 0;
+        }
+        
+        if (requested) {
+            requested = false;
+            if (backoff < RF_PAIR_BACKOFF_MAX) backoff++;
+            skip = (uint8_t)(hal_get_random_u32() & ((1u << backoff) - 1));
+        }
+        if (skip > 0) {
+            skip--;
+            continue;
+        }
+        
+        uint8_t slot = count + (uint8_t)(hal_get_random_u32() % (RF_PAIR_SLOTS - count));
+        hal_sleep_until_us(pair_slot_us(batch_us, slot));
+        rf_hw_tx_mode();
+        rf_hw_transmit_wait((uint8_t *)&req, sizeof(req));
+        rf_hw_rx_mode();
+        requested = true;
+    }
+    
+    ctx->state = TX_STATE_UNPAIRED;
+    return -3;
+}
+#endif
+
 /*============================================================================
  * Slot Timer
  *============================================================================*/
@@ -412,75 +1182,393 @@ static void process_pair_response(rf_transmitter_ctx_t *ctx,
 static void calculate_my_slot_time(rf_transmitter_ctx_t *ctx)
 {
     // Calculate when our slot starts relative to sync beacon
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    uint32_t slot_offset = RF_SYNC_SLOT_US + (my_slot_index * SLOT_WIDTH_US);
+#else
     uint32_t slot_offset = RF_SYNC_SLOT_US + (ctx->tracker_id * RF_DATA_SLOT_US);
+#endif
+    my_slot_offset_us = slot_offset;
     slot_start_time_us = ctx->sync_time_us + slot_offset;
 }
 
 static void wait_for_my_slot(rf_transmitter_ctx_t *ctx)
 {
-    uint32_t now = rf_hw_get_time_us();
-    uint32_t target = slot_start_time_us;
+    uint32_t now = rf_hw_get_time_us();
+    uint32_t target = slot_start_time_us;
+    
+    // Handle wraparound
+    if ((int32_t)(target - now) > 0) {
+        // v0.6.3: 定时唤醒睡眠到时隙开始 (rf_hw_get_time_us 即 hal_micros)
+        hal_sleep_until_us(target);
+    }
+    
+    in_my_slot = true;
+}
+
+#if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING
+// v0.6.3: 在时隙前 JIT_SAMPLE_LEAD_US 让上层刷新姿态数据
+// 信标晚到或主循环被占用导致余量不足一半时跳过, 沿用已有数据, 保证不错过时隙
+static void jit_prepare(uint32_t slot_at)
+{
+    if (!pre_tx_callback) return;
+    
+    int32_t remain = (int32_t)(slot_at - rf_hw_get_time_us());
+    if (remain < JIT_SAMPLE_LEAD_US / 2) {
+        return;
+    }
+    if (remain > JIT_SAMPLE_LEAD_US) {
+        hal_sleep_until_us(slot_at - JIT_SAMPLE_LEAD_US);
+    }
+    
+    pre_tx_callback();
+}
+#endif
+
+/*============================================================================
+ * RX Callback
+ *============================================================================*/
+
+RAM_CODE_ISR
+static void rx_handler(const uint8_t *data, uint8_t len, int8_t rssi)
+{
+    if (!tx_ctx || len < sizeof(rf_header_t)) return;
+    
+    rf_header_t *header = (rf_header_t *)data;
+    
+    switch (header->type) {
+        case RF_PKT_SYNC_BEACON:
+        case RF_PKT_SYNC_PAIRING:
+            if (len >= sizeof(rf_sync_packet_t)) {
+                process_sync_beacon(tx_ctx, (rf_sync_packet_t *)data, rssi);
+            }
+            break;
+            
+        case RF_PKT_PAIR_RESPONSE:
+            if (tx_ctx->state == TX_STATE_PAIRING && 
+                len >= sizeof(rf_pair_response_t)) {
+                process_pair_response(tx_ctx, (rf_pair_response_t *)data);
+            }
+            break;
+            
+        case RF_PKT_ACK:
+            if (len >= sizeof(rf_ack_packet_t)) {
+                process_ack(tx_ctx, (rf_ack_packet_t *)data, rssi);
+            }
+            break;
+            
+#if defined(USE_RF_OTA) && USE_RF_OTA
+        case RF_PKT_OTA_INFO:
+        case RF_PKT_OTA_DATA:
+            rf_ota_on_packet(data, len);
+            break;
+#endif
+            
+        default:
+            break;
+    }
+}
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+/**
+ * @brief v0.6.3: 等待时隙前算好本帧时隙 (attempt: 0 = 主时隙, 1 + k = 备用时隙 k)
+ *        和本帧信标的密钥流
+ */
+static void auth_prepare_slot(rf_transmitter_ctx_t *ctx, uint8_t attempt)
+{
+    if (!rf_auth_active()) return;
+    
+    rf_auth_nonce_t nonce = {
+        .epoch = auth_epoch,
+        .frame = ctx->frame_number,
+        .tracker_id = ctx->tracker_id,
+        .attempt = attempt,
+    };
+    rf_auth_prepare(&nonce, RF_SLOT_PAYLOAD_MAX);
+    if (attempt == 0) {
+        nonce.tracker_id = RF_AUTH_ID_BEACON;
+        rf_auth_prepare(&nonce, 0);
+    }
+}
+#endif
+
+/**
+ * @brief v0.6.3: 时隙内发送数据包 (USE_RF_LINK_AUTH 时加密并附加 MIC, 缓冲区保留明文)
+ */
+static int slot_transmit(rf_transmitter_ctx_t *ctx, const uint8_t *buf, uint8_t len,
+                         uint8_t attempt)
+{
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    if (rf_auth_active()) {
+        rf_auth_nonce_t nonce = {
+            .epoch = auth_epoch,
+            .frame = ctx->frame_number,
+            .tracker_id = ctx->tracker_id,
+            .attempt = attempt,
+        };
+        uint8_t air[RF_MAX_PAYLOAD_SIZE];
+        len = rf_auth_seal(air, buf, len, &nonce);
+        return rf_hw_transmit_wait(air, len);
+    }
+#else
+    (void)ctx;
+    (void)attempt;
+#endif
+    return rf_hw_transmit_wait(buf, len);
+}
+
+/*============================================================================
+ * ACK Wait / Spare Slots
+ *============================================================================*/
+
+static bool wait_for_ack(void)
+{
+    rf_hw_rx_mode();
+    uint32_t ack_start = rf_hw_get_time_us();
+    uint32_t window = RF_ACK_TIME_US * 2;
+    ack_seen = false;
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+    if (rf_hw_get_rate() == RF_MODE_1MBPS) window *= RF_PHY_1M_FACTOR;
+#endif
+    
+    // v0.6.3: 只有发给本tracker且 CRC 正确的 ACK 才算确认; 两包之间睡眠等射频中断
+    while (rf_hw_wait_rx(ack_start + window)) {
+        uint8_t buf[32];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        if (len > 0) {
+            rx_handler(buf, len, rssi);
+        }
+        if (ack_seen) return true;      // 也可能已在接收中断的回调里确认
+    }
+    
+    return ack_seen;
+}
+
+#if defined(USE_RF_OTA) && USE_RF_OTA
+/**
+ * @brief v0.6.3: 时隙之后停留在本帧信道接收固件广播, 下一帧信标前返回
+ */
+static void ota_listen(rf_transmitter_ctx_t *ctx)
+{
+    uint32_t end_us = ctx->sync_time_us + RF_FRAME_US - RF_GUARD_TIME_US;
+    
+    rf_hw_rx_mode();
+    while (rf_hw_wait_rx(end_us)) {
+        uint8_t buf[32];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        if (len > 0) {
+            rx_handler(buf, len, rssi);
+        }
+    }
+}
+#endif
+
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+/**
+ * @brief v0.6.3: 本小区信号弱时, 时隙之后留在帧信道上旁听邻小区的信标
+ *
+ * 两个小区的跳频序列取自同一组信道, 邻小区信标随机落在本信道上; 迁移后立即返回
+ */
+static void roam_probe(rf_transmitter_ctx_t *ctx)
+{
+    uint32_t end_us = ctx->sync_time_us + RF_FRAME_US - RF_GUARD_TIME_US;
+    
+    roam_switched = false;
+    rf_hw_rx_mode();
+    while (!roam_switched && rf_hw_wait_rx(end_us)) {
+        uint8_t buf[32];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        // 只处理信标: 本小区其他 tracker 的数据/ACK 也在这个信道上
+        if (len >= (int)sizeof(rf_sync_packet_t) &&
+            ((const rf_header_t *)buf)->type == RF_PKT_SYNC_BEACON) {
+            process_sync_beacon(ctx, (const rf_sync_packet_t *)buf, rssi);
+        }
+    }
+}
+#endif
+
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+/**
+ * @brief 记录已发送的聚合包; 未确认时留待备用时隙重传
+ */
+static retx_entry_t *retx_track(const uint8_t *buf, uint8_t len, uint32_t built_us, bool acked)
+{
+    if (acked) return NULL;
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+    if (!rf_multi_is_packet(buf, len) && !rf_delta_is_packet(buf, len)) return NULL;
+#else
+    if (!rf_multi_is_packet(buf, len)) return NULL;
+#endif
+    
+    retx_entry_t *e = &retx_queue[retx_head];
+    if (e->pending) retx_expired++;     // 被更新的包挤出
+    memcpy(e->buf, buf, len);
+    e->len = len;
+    e->built_us = built_us;
+    e->pending = true;
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+    e->ack_slot = GACK_SLOT_NONE;
+    e->resent = false;
+#endif
+    retx_head = (retx_head + 1) % RETX_QUEUE_DEPTH;
+    return e;
+}
+
+/**
+ * @brief 取最旧的仍在期限内的待重传包
+ */
+static retx_entry_t *retx_next(uint32_t now_us)
+{
+    retx_entry_t *best = NULL;
+    
+    for (uint8_t i = 0; i < RETX_QUEUE_DEPTH; i++) {
+        retx_entry_t *e = &retx_queue[i];
+        if (!e->pending) continue;
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+        if (e->ack_slot != GACK_SLOT_NONE) continue;    // 本帧刚发出, 结果未知
+#endif
+        
+        if ((now_us - e->built_us) > RF_RETX_DEADLINE_US) {
+            e->pending = false;
+            retx_expired++;
+            continue;
+        }
+        if (!best || (int32_t)(e->built_us - best->built_us) < 0) {
+            best = e;
+        }
+    }
+    
+    return best;
+}
+#endif
+
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+/**
+ * @brief v0.6.3: 在接收器分配的备用时隙中发送
+ * - 主时隙未收到ACK: 原样重传 (相同序列号, 接收器会去重)
+ * - 主时隙已ACK且有新数据: 发送第二样本
+ * - 否则放弃该时隙, 保持待机省电
+ */
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+/**
+ * @brief v0.6.3: 备用时隙 - 选择性重传优先, 其次第二样本
+ * - 待重传队列里最旧且未超期的聚合包: 原序列号, 样本年龄按重发时刻重算
+ * - 队列为空且有新数据: 发送第二样本 (未确认时同样进入重传队列)
+ * - 否则放弃该时隙, 保持待机省电
+ */
+static void transmit_in_spare_slots(rf_transmitter_ctx_t *ctx, bool acked)
+{
+    (void)acked;
     
-    // Handle wraparound
-    if (target > now) {
-        uint32_t wait_us = target - now;
+    for (uint8_t k = 0; k < RF_SPARE_SLOT_MAX; k++) {
+        if (!(my_spare_mask & (1u << k))) continue;
+        
+        slot_start_time_us = ctx->sync_time_us + RF_SYNC_SLOT_US +
+                             (uint32_t)(primary_slot_count + k) * SLOT_WIDTH_US;
+        
+        retx_entry_t *e = retx_next(slot_start_time_us);
+        if (!e && !tx_data_fresh) break;
         
-        // v0.4.22 P0修复: 使用低功耗等待代替忙等
-        if (wait_us > 1000) {
-            // 等待时间长，使用低功耗睡眠
-            // 提前500us唤醒以确保准时
-            hal_delay_us(wait_us - 500);
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        auth_prepare_slot(ctx, (uint8_t)(1 + k));
+#endif
+        wait_for_my_slot(ctx);
+        uint32_t now_us = rf_hw_get_time_us();
+        
+        rf_hw_tx_mode();
+        if (e) {
+            uint8_t buf[RF_MAX_PAYLOAD_SIZE];
+            memcpy(buf, e->buf, e->len);
+            if (rf_multi_restamp_packet(buf, e->len, now_us - e->built_us) != 0) {
+                e->pending = false;     // 最旧样本年龄已无法表示
+                retx_expired++;
+                in_my_slot = false;
+                continue;
+            }
+            slot_transmit(ctx, buf, e->len, (uint8_t)(1 + k));
+        } else {
+            last_tx_len = build_tx_frame(ctx, last_tx_buf, now_us);
+            tx_data_fresh = false;
+            slot_transmit(ctx, last_tx_buf, last_tx_len, (uint8_t)(1 + k));
         }
         
-        // 最后的精确等待使用WFI（低功耗等待中断）
-        while (rf_hw_get_time_us() < target) {
-#ifdef CH59X
-            // __WFI 在 core_riscv.h 中定义，通过 hal.h 间接包含
-            __asm__ volatile ("wfi");  // Wait For Interrupt - 低功耗等待
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+        // v0.6.3: 不等 ACK, 结果随下一帧信标的备用时隙位图到达
+        in_my_slot = false;
+        gack.spare |= (uint8_t)(1u << k);
+        if (e) {
+            e->resent = true;
+        } else {
+            e = retx_track(last_tx_buf, last_tx_len, now_us, false);
+        }
+        if (e) e->ack_slot = k;
+#else
+        bool got = wait_for_ack();
+        in_my_slot = false;
+        
+        if (e) {
+            if (got) {
+                e->pending = false;
+                retx_recovered++;
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+                rf_delta_on_ack(e->buf, e->len);
+#endif
+                if (ack_callback) {
+                    ack_callback(e->buf[2], true);  // 聚合包 [2] = 序列号
+                }
+            }
+        } else {
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+            if (got) rf_delta_on_ack(last_tx_buf, last_tx_len);
 #endif
+            retx_track(last_tx_buf, last_tx_len, now_us, got);
         }
+#endif
     }
-    
-    in_my_slot = true;
 }
-
-/*============================================================================
- * RX Callback
- *============================================================================*/
-
-static void rx_handler(const uint8_t *data, uint8_t len, int8_t rssi)
+#else
+static void transmit_in_spare_slots(rf_transmitter_ctx_t *ctx, bool acked)
 {
-    (void)rssi;
-    
-    if (!tx_ctx || len < sizeof(rf_header_t)) return;
-    
-    rf_header_t *header = (rf_header_t *)data;
-    
-    switch (header->type) {
-        case RF_PKT_SYNC_BEACON:
-        case RF_PKT_SYNC_PAIRING:
-            if (len >= sizeof(rf_sync_packet_t)) {
-                process_sync_beacon(tx_ctx, (rf_sync_packet_t *)data);
-            }
-            break;
-            
-        case RF_PKT_PAIR_RESPONSE:
-            if (tx_ctx->state == TX_STATE_PAIRING && 
-                len >= sizeof(rf_pair_response_t)) {
-                process_pair_response(tx_ctx, (rf_pair_response_t *)data);
-            }
-            break;
-            
-        case RF_PKT_ACK:
-            if (len >= sizeof(rf_ack_packet_t)) {
-                process_ack(tx_ctx, (rf_ack_packet_t *)data);
-            }
-            break;
-            
-        default:
-            break;
+    for (uint8_t k = 0; k < RF_SPARE_SLOT_MAX; k++) {
+        if (!(my_spare_mask & (1u << k))) continue;
+        if (acked && !tx_data_fresh) break;
+        
+        slot_start_time_us = ctx->sync_time_us + RF_SYNC_SLOT_US +
+                             (uint32_t)(primary_slot_count + k) * SLOT_WIDTH_US;
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        auth_prepare_slot(ctx, (uint8_t)(1 + k));
+#endif
+        wait_for_my_slot(ctx);
+        
+        rf_hw_tx_mode();
+        if (acked) {
+            last_tx_len = build_tx_frame(ctx, last_tx_buf, rf_hw_get_time_us());
+            tx_data_fresh = false;
+        }
+        slot_transmit(ctx, last_tx_buf, last_tx_len, (uint8_t)(1 + k));
+        
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+        // v0.6.3: 组确认时主时隙结果未知, 调用方传 acked = true, 只发第二样本;
+        // 没有重传队列, 备用时隙包不参与确认
+        in_my_slot = false;
+#else
+        bool got = wait_for_ack();
+        in_my_slot = false;
+        
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+        if (got) rf_delta_on_ack(last_tx_buf, last_tx_len);
+#endif
+        if (!acked && got && ack_callback) {
+            ack_callback(ctx->sequence - 1, true);
+        }
+        acked = acked || got;
+#endif
     }
 }
+#endif  /* USE_RF_SELECTIVE_REPEAT */
+#endif
 
 /*============================================================================
  * Public API - Transmitter
@@ -502,6 +1590,10 @@ int rf_transmitter_init(rf_transmitter_ctx_t *ctx)
     ctx->quaternion[2] = 0.0f;
     ctx->quaternion[3] = 0.0f;
     
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+    rf_auth_init();
+#endif
+    
     // Load pairing info from storage
     // if (hal_storage_load_pairing(...) == 0) {
     //     ctx->paired = true;
@@ -551,8 +1643,26 @@ int rf_transmitter_start(rf_transmitter_ctx_t *ctx)
         ctx->last_sync_ms = hal_millis();
         
         // Start scanning for sync beacons
-        rf_hw_set_channel(rf_get_hop_channel(0, ctx->network_key));
+        // v0.6.3: tracker 不知道接收器黑名单, 只用密钥建表; 实际信道以信标 channel_map 为准
+        rf_hop_table_build(ctx->network_key, NULL, 0);
+        rf_hw_set_channel(rf_hop_table_get(0));
         rf_hw_rx_mode();
+#if defined(USE_RF_FAST_ACQUIRE) && USE_RF_FAST_ACQUIRE
+        acq_active = false;
+        memset(acq_tried, 0, sizeof(acq_tried));
+#endif
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+        rf_delta_reset();
+#endif
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+        rf_raw_reset();
+#endif
+#if defined(USE_RF_FEC) && USE_RF_FEC
+        fec_mode = false;
+#endif
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+        phy_slow = false;
+#endif
     } else {
         ctx->state = TX_STATE_UNPAIRED;
     }
@@ -571,25 +1681,23 @@ int rf_transmitter_request_pairing(rf_transmitter_ctx_t *ctx)
     rf_hw_rx_mode();
     
     // Wait for pairing sync beacon, then send request
-    uint32_t start = hal_millis();
+    // v0.6.3: 睡眠等射频中断, 不再每 10ms 轮询 (轮询间隔内到的第二个包会覆盖第一个)
+    uint32_t deadline_us = rf_hw_get_time_us() + 5000000UL;
     bool got_sync = false;
     
-    while (hal_millis() - start < 5000) {
+    while (rf_hw_wait_rx(deadline_us)) {
         // Check for sync beacon
-        if (rf_hw_rx_available()) {
-            uint8_t buf[64];
-            int8_t rssi;
-            int len = rf_hw_receive(buf, sizeof(buf), &rssi);
-            
-            if (len > 0) {
-                rf_header_t *header = (rf_header_t *)buf;
-                if (header->type == RF_PKT_SYNC_PAIRING) {
-                    got_sync = true;
-                    break;
-                }
+        uint8_t buf[64];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        
+        if (len > 0) {
+            rf_header_t *header = (rf_header_t *)buf;
+            if (header->type == RF_PKT_SYNC_PAIRING) {
+                got_sync = true;
+                break;
             }
         }
-        hal_delay_ms(10);
     }
     
     if (!got_sync) {
@@ -597,35 +1705,39 @@ int rf_transmitter_request_pairing(rf_transmitter_ctx_t *ctx)
         return -2;  // No receiver found
     }
     
+#if defined(USE_RF_SLOTTED_PAIRING) && USE_RF_SLOTTED_PAIRING
+    // v0.6.3: 多个 tracker 同时配对时用时隙 + 退避代替立即请求
+    return pair_slotted(ctx);
+#else
     // Send pairing request
     rf_pair_request_t req;
     build_pair_request(ctx, &req);
     
     rf_hw_tx_mode();
-    rf_hw_transmit((uint8_t *)&req, sizeof(req));
+    rf_hw_transmit_wait((uint8_t *)&req, sizeof(req));
     rf_hw_rx_mode();
     
     // Wait for response
-    start = hal_millis();
-    while (hal_millis() - start < 1000) {
-        if (rf_hw_rx_available()) {
-            uint8_t buf[64];
-            int8_t rssi;
-            int len = rf_hw_receive(buf, sizeof(buf), &rssi);
-            
-            if (len > 0) {
-                rx_handler(buf, len, rssi);
-                
-                if (ctx->paired) {
-                    return 0;  // Success
-                }
-            }
+    deadline_us = rf_hw_get_time_us() + 1000000UL;
+    while (rf_hw_wait_rx(deadline_us)) {
+        uint8_t buf[64];
+        int8_t rssi;
+        int len = rf_hw_receive(buf, sizeof(buf), &rssi);
+        
+        if (len > 0) {
+            rx_handler(buf, len, rssi);
+        }
+        if (ctx->paired) {
+            return 0;  // Success
         }
-        hal_delay_ms(1);
+    }
+    if (ctx->paired) {
+        return 0;   // 配对应答在接收中断回调里处理
     }
     
     ctx->state = TX_STATE_UNPAIRED;
     return -3;  // Pairing failed
+#endif
 }
 
 void rf_transmitter_set_data(rf_transmitter_ctx_t *ctx,
@@ -640,7 +1752,35 @@ void rf_transmitter_set_data(rf_transmitter_ctx_t *ctx,
     memcpy(ctx->acceleration, accel, sizeof(float) * 3);
     ctx->battery = battery;
     ctx->flags = flags;
+    
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+    ctx->sample_us = rf_hw_get_time_us();     // 未单独设置样本时刻时按更新时刻
+#endif
+    
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+    tx_data_fresh = true;
+#endif
+}
+
+#if defined(USE_RF_SAMPLE_TIME) && USE_RF_SAMPLE_TIME
+void rf_transmitter_set_sample_time(rf_transmitter_ctx_t *ctx, uint32_t sample_us)
+{
+    if (!ctx) return;
+    ctx->sample_us = sample_us;
+}
+#endif
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+void rf_transmitter_set_aux(rf_transmitter_ctx_t *ctx, const float quat[4], uint32_t sample_us)
+{
+    if (!ctx) return;
+    ctx->aux_valid = (quat != NULL);
+    if (quat) {
+        memcpy(ctx->aux_quaternion, quat, sizeof(ctx->aux_quaternion));
+        ctx->aux_sample_us = sample_us;
+    }
 }
+#endif
 
 void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
 {
@@ -648,6 +1788,29 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
     
     uint32_t now_ms = hal_millis();
     
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    // v0.6.3: 接收器换了车道 - 重建后备跳频表 (后续 5 帧以信标 channel_map 为准)
+    if (coex_pending_lane != 0xFF) {
+        rf_hop_table_set_lane(coex_pending_lane);
+        coex_pending_lane = 0xFF;
+        rf_hop_table_build(ctx->network_key, NULL, 0);
+    }
+#endif
+    
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    // v0.6.3: 已迁移到另一台接收器 - 按它的小区重建后备跳频表
+    if (roam_cell_pending != 0xFF) {
+        rf_hop_table_set_cell(roam_cell_pending);
+        roam_cell_pending = 0xFF;
+        rf_hop_table_build(ctx->network_key, NULL, 0);
+    }
+#endif
+    
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+    // v0.6.3: 信标前从 BLE 收回射频 (搜索/配对时射频一直归 TDMA)
+    rf_arbiter_acquire();
+#endif
+    
     switch (ctx->state) {
         case TX_STATE_UNPAIRED:
             // Waiting for user to initiate pairing
@@ -658,6 +1821,14 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             break;
             
         case TX_STATE_SEARCHING: {
+#if defined(USE_RF_POWER_CTRL) && USE_RF_POWER_CTRL
+            // v0.6.3: 失步后不再受接收器功率控制, 恢复最大功率直到重新同步
+            if (current_tx_power != RF_TX_POWER_4DBM) {
+                current_tx_power = RF_TX_POWER_4DBM;
+                rf_hw_set_tx_power(current_tx_power);
+            }
+#endif
+            
             // Look for sync beacon
             rf_hw_rx_mode();
             
@@ -670,12 +1841,47 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
                 }
             }
             
-            // Channel hop while searching
-            static uint32_t last_hop = 0;
-            if (now_ms - last_hop > 10) {
-                last_hop = now_ms;
-                uint8_t ch = rf_get_hop_channel((now_ms / 10) % 1000, ctx->network_key);
-                rf_hw_set_channel(ch);
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+            // v0.6.3: 快速重连期间停在预测信道, 窗口结束仍未收到信标则改为常规搜索
+            if (rejoin_active &&
+                (int32_t)(rf_hw_get_time_us() - rejoin_deadline_us) > 0) {
+                rejoin_active = false;
+            }
+            if (!rejoin_active)
+#endif
+            {
+#if defined(USE_RF_FAST_ACQUIRE) && USE_RF_FAST_ACQUIRE
+                // v0.6.3: 在最坏间隔内没收到信标 (接收器拉黑了该信道), 换下一个
+                uint32_t now_us = rf_hw_get_time_us();
+                if (acq_active && (int32_t)(now_us - acq_deadline_us) > 0) {
+                    acq_active = false;
+                }
+                if (!acq_active) {
+                    uint16_t gap;
+                    uint8_t ch = rf_hop_table_pick_listen(acq_tried, sizeof(acq_tried), &gap);
+                    if (ch == 0xFF) {
+                        // 全部试过, 开始新一轮
+                        memset(acq_tried, 0, sizeof(acq_tried));
+                        ch = rf_hop_table_pick_listen(NULL, 0, &gap);
+                    }
+                    if (ch != 0xFF) {
+                        acq_tried[ch / 8] |= (uint8_t)(1 << (ch % 8));
+                        acq_deadline_us = now_us + (uint32_t)(gap + 1) * RF_FRAME_US +
+                                          RF_SYNC_SLOT_US;
+                        acq_active = true;
+                        rf_hw_set_channel(ch);
+                        rf_hw_rx_mode();
+                    }
+                }
+#else
+                // Channel hop while searching
+                static uint32_t last_hop = 0;
+                if (now_ms - last_hop > 10) {
+                    last_hop = now_ms;
+                    uint8_t ch = rf_get_hop_channel((now_ms / 10) % 1000, ctx->network_key);
+                    rf_hw_set_channel(ch);
+                }
+#endif
             }
             
             // Timeout
@@ -695,7 +1901,14 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             // Normal operation
             
             // Wait for sync beacon at frame start
-            rf_hw_rx_mode();
+            bool rx_off = false;
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+            rx_off = beacon_skip_frame;
+#endif
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+            rx_off = rx_off || doze_skip_frame;
+#endif
+            if (!rx_off) rf_hw_rx_mode();
             
             uint32_t frame_start = ctx->sync_time_us;
             uint32_t now_us = rf_hw_get_time_us();
@@ -713,45 +1926,139 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
                 }
             } else {
                 // Sync window passed, check if we got beacon
-                missed_sync_count++;
-                
-                // v0.6.2: 报告同步丢失给RF自愈模块
-                #if defined(USE_RF_RECOVERY) && USE_RF_RECOVERY
-                extern rf_recovery_state_t rf_recovery_state;
-                recovery_action_t action = rf_recovery_report_miss_sync(&rf_recovery_state);
-                if (action == RECOVERY_RESYNC) {
-                    ctx->state = TX_STATE_SEARCHING;
-                    break;
-                } else if (action == RECOVERY_ABORT) {
-                    // 重新初始化RF - 使用默认配置重新初始化
-                    rf_hw_config_t rf_cfg = {
-                        .mode = RF_MODE_2MBPS,
-                        .tx_power = RF_TX_POWER_4DBM,
-                        .addr_width = RF_ADDR_WIDTH_4,
-                        .crc_mode = RF_CRC_16BIT,
-                        .sync_word = RF_SYNC_WORD,
-                        .channel = 0,
-                        .auto_ack = false,
-                        .ack_timeout = 0,
-                        .retry_count = 0,
-                    };
-                    rf_hw_init(&rf_cfg);
-                    ctx->state = TX_STATE_SEARCHING;
-                    break;
+                bool planned_skip = false;
+#if defined(USE_RF_BEACON_SKIP) && USE_RF_BEACON_SKIP
+                // v0.6.3: 下一帧是否跳听; 跳听帧不算信标丢失, 接收机关到时隙开始
+                planned_skip = (beacon_skip_left > 0);
+                if (planned_skip) {
+                    beacon_skip_left--;
+                    rf_hw_standby();
+                } else if (beacon_skip_frame) {
+                    rf_hw_rx_mode();
                 }
-                #endif
+                beacon_skip_frame = planned_skip;
+#endif
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+                // v0.6.3: 组休眠 - 只在 frame % N == 0 的帧打开接收机 (在下一个休眠信标的信道上),
+                // 其余帧本来就没有信标, 不算丢失; 连续丢 SYNC_LOST_THRESHOLD 个休眠信标才重新搜索
+                if (doze_interval) {
+                    uint16_t next = (uint16_t)(ctx->frame_number + 1);
+                    planned_skip = (next & (doze_interval - 1)) != 0;
+                    if (planned_skip) {
+                        rf_hw_standby();
+                    } else {
+                        rf_hw_set_channel(doze_channel);
+                        rf_hw_rx_mode();
+                        // 这次没收到时, 按本地跳频表猜下一个休眠信标的信道
+                        doze_channel = rf_hop_table_get((uint16_t)(next + doze_interval));
+                    }
+                    doze_skip_frame = planned_skip;
+                } else if (doze_skip_frame) {
+                    doze_skip_frame = false;
+                    rf_hw_rx_mode();
+                }
+#endif
                 
-                if (missed_sync_count > SYNC_LOST_THRESHOLD) {
-                    ctx->state = TX_STATE_SEARCHING;
-                    break;
+                if (!planned_skip) {
+                    missed_sync_count++;
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+                    roam_sample(roam_own_cell(), RF_ROAM_MISS_RSSI, hal_millis());
+#endif
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+                    telem_record_sync_miss();
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+                    soak_record_sync_miss();
+#endif
+                    
+                    // v0.6.2: 报告同步丢失给RF自愈模块
+                    #if defined(USE_RF_RECOVERY) && USE_RF_RECOVERY
+                    extern rf_recovery_state_t rf_recovery_state;
+#if defined(USE_RF_RECOVERY_COST) && USE_RF_RECOVERY_COST && \
+    defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+                    // v0.6.3: 漂移估计稳定 (允许跳听信标) 时可先按预测时序继续接收
+                    rf_recovery_set_drift_known(&rf_recovery_state,
+                                                rf_timing_get_beacon_interval() > 1);
+#endif
+                    // RECOVERY_HOP_PREDICT 与其余动作一样留在运行态按预测时序继续
+                    recovery_action_t action = rf_recovery_report_miss_sync(&rf_recovery_state);
+                    if (action == RECOVERY_RESYNC) {
+                        ctx->state = TX_STATE_SEARCHING;
+                        break;
+                    } else if (action == RECOVERY_ABORT) {
+                        // 重新初始化RF - 使用默认配置重新初始化
+                        rf_hw_config_t rf_cfg = {
+                            .mode = RF_MODE_2MBPS,
+                            .tx_power = RF_TX_POWER_4DBM,
+                            .addr_width = RF_ADDR_WIDTH_4,
+                            .crc_mode = RF_CRC_16BIT,
+                            .sync_word = RF_SYNC_WORD,
+                            .channel = 0,
+                            .auto_ack = false,
+                            .ack_timeout = 0,
+                            .retry_count = 0,
+                        };
+                        rf_hw_init(&rf_cfg);
+                        ctx->state = TX_STATE_SEARCHING;
+                        break;
+                    }
+                    #endif
+                    
+                    if (missed_sync_count > SYNC_LOST_THRESHOLD) {
+                        ctx->state = TX_STATE_SEARCHING;
+                        break;
+                    }
                 }
                 
                 // Use predicted timing
                 ctx->frame_number++;
-                ctx->sync_time_us += RF_SUPERFRAME_US;
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+                if (ctx->frame_number == 0) auth_epoch++;
+#endif
+                ctx->sync_time_us += RF_FRAME_US;
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+                // v0.6.3: 按上一个信标通告的切换帧推进速率, 切换后时隙预测以本帧起点为基准
+                if (rf_frame_rate_advance()) {
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+                    rf_timing_rebase(ctx->sync_time_us);
+#endif
+                }
+#endif
+                
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+                // 时隙布局逐帧变化, 没收到信标时不能沿用上一帧的排名
+                my_slot_scheduled = false;
+                my_spare_mask = 0;
+#endif
+            }
+            
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+            // v0.6.3: 组休眠期间不发数据 (接收器也不开时隙)
+            if (doze_interval) {
+                in_my_slot = false;
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+                if (doze_skip_frame) rf_arbiter_release(ctx->sync_time_us + RF_FRAME_US);
+#endif
+                break;
+            }
+#endif
+            
+#if defined(USE_MULTI_SUPERFRAME) && USE_MULTI_SUPERFRAME
+            // v0.6.3: 本帧没有分到主时隙 (低速率tracker的间隔帧)
+            if (!my_slot_scheduled) {
+                in_my_slot = false;
+                rf_hw_standby();
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+                rf_arbiter_release(ctx->sync_time_us + RF_FRAME_US);
+#endif
+                break;
             }
+#endif
             
             // Wait for our slot
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+            auth_prepare_slot(ctx, 0);
+#endif
             calculate_my_slot_time(ctx);
             
             // v0.6.2: 使用时隙优化器获取动态时隙
@@ -769,22 +2076,60 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             
             // v0.6.2: 使用时序优化模块等待时隙
             #if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+            #if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+            rf_timing_set_slot(my_slot_index, primary_slot_count);
+            rf_timing_set_slot_width(SLOT_WIDTH_US);
+            #else
             rf_timing_set_slot(ctx->tracker_id, MAX_TRACKERS);
-            rf_timing_wait_slot();
+            #endif
+            // 时隙时刻只算一次: 回调之后再算可能因余量不足被推到下一帧
+            uint32_t slot_at = rf_timing_get_slot_time();
             #else
-            wait_for_my_slot(ctx);
+            uint32_t slot_at = slot_start_time_us;
+            #endif
+            #if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING
+            jit_prepare(slot_at);
             #endif
             
+#if !(defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE)
             // v0.4.22 P1: 更新发送分频器（根据静止状态）
+            // v0.6.3: USE_RF_MOTION_RATE 时由接收器按静止标志排程, 不再本地跳帧
             update_tx_divider();
+            bool tx_due = should_transmit_this_frame();
+#else
+            bool tx_due = true;
+            (void)tx_due;
+#endif
+            
+#if defined(USE_RF_TX_PRESTAGE) && USE_RF_TX_PRESTAGE
+            // v0.6.3: 姿态已是本时隙要发的数据, 等待之前按预计发送时刻组好整帧
+            uint8_t *tx_buf = tx_stage_buf;
+            uint8_t tx_len = 0;
+            if (tx_due) {
+                uint32_t now_us = rf_hw_get_time_us();
+                uint32_t tx_us = ((int32_t)(slot_at - now_us) > 0) ? slot_at : now_us;
+#if defined(USE_RF_OTA) && USE_RF_OTA
+                tx_len = rf_ota_build_status(ctx->tracker_id, tx_buf);
+#endif
+                if (tx_len == 0) tx_len = build_tx_frame(ctx, tx_buf, tx_us);
+            }
+#endif
+            
+            #if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+            rf_timing_wait_until(slot_at);
+            #else
+            wait_for_my_slot(ctx);
+            #endif
             
+#if !(defined(USE_RF_MOTION_RATE) && USE_RF_MOTION_RATE)
             // v0.4.22 P1: 静止降速 - 检查本帧是否需要发送
-            if (!should_transmit_this_frame()) {
+            if (!tx_due) {
                 // 跳过本帧发送，但保持同步
                 // 进入低功耗等待直到下一帧
                 in_my_slot = false;
                 break;
             }
+#endif
             
             // v0.6.2: 帧开始，通知时隙优化器
             #if defined(USE_RF_SLOT_OPTIMIZER) && USE_RF_SLOT_OPTIMIZER
@@ -795,12 +2140,17 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             if (channel_map_idx < 5) {
                 ctx->current_channel = channel_map[channel_map_idx++];
             } else {
-                ctx->current_channel = rf_get_hop_channel(ctx->frame_number, ctx->network_key);
+                ctx->current_channel = rf_hop_table_get(ctx->frame_number);
             }
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            // v0.6.3: 本帧信道对本 tracker 不好时换到映射的替代信道 (接收器在本时隙同样换过去)
+            uint8_t frame_channel = ctx->current_channel;
+            ctx->current_channel = rf_hop_remap(frame_channel, ctx->frame_number,
+                                                ctx->tracker_id, hop_map);
+#endif
             
             // v0.6.2: 使用信道管理器检查信道
             #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
-            extern channel_manager_t ch_manager;
             if (!ch_mgr_is_channel_clear(ctx->current_channel, -65)) {
                 // 信道繁忙，尝试获取替代信道
                 uint8_t alt_ch = ch_mgr_get_clear_channel(&ch_manager, 2);
@@ -820,59 +2170,61 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             // v0.6.2: 构建并发送数据包 - 使用RF Ultra或标准格式
             uint32_t tx_start_us = rf_hw_get_time_us();
             
-            #if defined(USE_RF_ULTRA) && USE_RF_ULTRA
-            // 使用RF Ultra高效数据包格式 (12字节 vs 21字节标准格式)
-            {
-                uint8_t ultra_pkt[RF_ULTRA_PACKET_SIZE];
-                
-                // 转换float四元数到Q15格式
-                q15_t quat_q15[4];
-                quat_q15[0] = (q15_t)(ctx->quaternion[0] * 32767.0f);
-                quat_q15[1] = (q15_t)(ctx->quaternion[1] * 32767.0f);
-                quat_q15[2] = (q15_t)(ctx->quaternion[2] * 32767.0f);
-                quat_q15[3] = (q15_t)(ctx->quaternion[3] * 32767.0f);
-                
-                // 提取垂直加速度 (mg单位) - 使用acceleration而非accel_linear
-                int16_t accel_z_mg = (int16_t)(ctx->acceleration[2] * 1000.0f);
-                
-                rf_ultra_build_quat_packet(ultra_pkt, 
-                                           ctx->tracker_id,
-                                           quat_q15,
-                                           accel_z_mg,
-                                           ctx->battery);  // 使用battery而非battery_level
-                
-                rf_hw_tx_mode();
-                int result = rf_hw_transmit(ultra_pkt, RF_ULTRA_PACKET_SIZE);
-                (void)result;  // 忽略警告
-            }
-            ctx->sequence++;  // 序列号自增
-            #else
-            // 使用标准数据包格式
-            rf_tracker_packet_t pkt;
-            build_data_packet(ctx, &pkt);
+#if !(defined(USE_RF_TX_PRESTAGE) && USE_RF_TX_PRESTAGE)
+            uint8_t tx_buf[RF_MAX_PAYLOAD_SIZE];
+            uint8_t tx_len = 0;
+#if defined(USE_RF_OTA) && USE_RF_OTA
+            // v0.6.3: 固件广播期间每 RF_OTA_REPORT_FRAMES 帧用状态包代替一个数据包
+            tx_len = rf_ota_build_status(ctx->tracker_id, tx_buf);
+#endif
+            if (tx_len == 0) tx_len = build_tx_frame(ctx, tx_buf, tx_start_us);
+#endif
             
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+            rf_hw_set_rate(phy_slow ? RF_MODE_1MBPS : RF_MODE_2MBPS);
+#endif
             rf_hw_tx_mode();
-            int result = rf_hw_transmit((uint8_t *)&pkt, sizeof(pkt));
+            int result = slot_transmit(ctx, tx_buf, tx_len, 0);
             (void)result;  // 忽略警告
-            #endif
             
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+            memcpy(last_tx_buf, tx_buf, tx_len);
+            last_tx_len = tx_len;
+            tx_data_fresh = false;
+#endif
+            
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+            // v0.6.3: 不开接收机等 ACK, 结果在下一帧信标的组确认位图中结算
+            gack.frame = ctx->frame_number;
+            gack.primary = true;
+            gack.channel = ctx->current_channel;
+            gack.sequence = (uint8_t)(ctx->sequence - 1);  // sequence已经自增
+            gack.latency_us = rf_hw_get_time_us() - tx_start_us;
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+            retx_entry_t *pe = retx_track(tx_buf, tx_len, tx_start_us, false);
+            if (pe) pe->ack_slot = GACK_SLOT_PRIMARY;
+#elif defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+            memcpy(gack.buf, tx_buf, tx_len);
+            gack.len = tx_len;
+#endif
+            in_my_slot = false;
+#else
             // Wait for ACK
-            rf_hw_rx_mode();
-            uint32_t ack_start = rf_hw_get_time_us();
-            bool got_ack = false;
+            bool got_ack = wait_for_ack();
             
-            while (rf_hw_get_time_us() - ack_start < RF_ACK_TIME_US * 2) {
-                if (rf_hw_rx_available()) {
-                    uint8_t buf[32];
-                    int8_t rssi;
-                    int len = rf_hw_receive(buf, sizeof(buf), &rssi);
-                    if (len > 0) {
-                        rx_handler(buf, len, rssi);
-                        got_ack = true;
-                        break;
-                    }
-                }
-            }
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+            if (got_ack) rf_delta_on_ack(tx_buf, tx_len);
+#endif
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+            retx_track(tx_buf, tx_len, tx_start_us, got_ack);
+#endif
+            
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+            telem_record_packets(1, got_ack ? 0 : 1);
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+            soak_record_packets(1, got_ack ? 0 : 1);
+#endif
             
             // v0.6.2: 计算传输延迟
             uint32_t tx_latency_us = rf_hw_get_time_us() - tx_start_us;
@@ -881,7 +2233,6 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
             if (!got_ack) {
                 // 未收到ACK
                 #if defined(USE_CHANNEL_MANAGER) && USE_CHANNEL_MANAGER
-                extern channel_manager_t ch_manager;
                 ch_mgr_record_tx(&ch_manager, ctx->current_channel, false, -127);
                 #endif
                 
@@ -897,21 +2248,52 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
                 #if defined(USE_RF_SLOT_OPTIMIZER) && USE_RF_SLOT_OPTIMIZER
                 slot_optimizer_report_result(ctx->tracker_id, true, tx_latency_us);
                 #endif
+                #if defined(USE_SELFTEST) && USE_SELFTEST
+                selftest_time(SELFTEST_T_RF_RTT, tx_latency_us, 1);
+                #endif
             }
             
             in_my_slot = false;
             
             // Call ACK callback
             if (ack_callback) {
-                #if defined(USE_RF_ULTRA) && USE_RF_ULTRA
                 ack_callback(ctx->sequence - 1, got_ack);  // sequence已经自增
-                #else
-                ack_callback(pkt.sequence, got_ack);
-                #endif
             }
+#endif
+            
+#if defined(USE_RF_PHY_FALLBACK) && USE_RF_PHY_FALLBACK
+            rf_hw_set_rate(RF_MODE_2MBPS);     // 备用时隙/固件广播/下一帧信标都是 2Mbps
+#endif
+            
+#if defined(USE_ADAPTIVE_SUPERFRAME) && USE_ADAPTIVE_SUPERFRAME
+            // v0.6.3: 本帧分到的备用时隙 (重传 / 第二样本)
+            if (my_spare_mask) {
+#if defined(USE_RF_GROUP_ACK) && USE_RF_GROUP_ACK
+                transmit_in_spare_slots(ctx, true);     // 结果未知, 重传交给重传队列
+#else
+                transmit_in_spare_slots(ctx, got_ack);
+#endif
+            }
+#endif
+            
+#if defined(USE_RF_TRACKER_HOP_MAP) && USE_RF_TRACKER_HOP_MAP
+            // 固件广播和下一帧信标在帧信道上
+            if (rf_hw_get_channel() != frame_channel) rf_hw_set_channel(frame_channel);
+#endif
+            
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+            if (roam_rssi_q4[roam_own_cell()] < RF_ROAM_PROBE_RSSI * 16) roam_probe(ctx);
+#endif
+#if defined(USE_RF_OTA) && USE_RF_OTA
+            if (rf_ota_listening()) ota_listen(ctx);
+#endif
             
             // Enter low power until next frame
             rf_hw_standby();
+#if defined(USE_RADIO_ARBITER) && USE_RADIO_ARBITER
+            // v0.6.3: 本帧余下时间交给 BLE
+            rf_arbiter_release(ctx->sync_time_us + RF_FRAME_US);
+#endif
             break;
         }
             
@@ -929,6 +2311,13 @@ void rf_transmitter_process(rf_transmitter_ctx_t *ctx)
     }
 }
 
+#if defined(USE_GROUP_SLEEP) && USE_GROUP_SLEEP
+bool rf_transmitter_group_dozing(void)
+{
+    return doze_interval != 0 && tx_ctx && tx_ctx->state == TX_STATE_RUNNING;
+}
+#endif
+
 void rf_transmitter_sleep(rf_transmitter_ctx_t *ctx)
 {
     if (!ctx) return;
@@ -960,12 +2349,121 @@ void rf_transmitter_wake(rf_transmitter_ctx_t *ctx)
     ctx->last_sync_ms = hal_millis();
 }
 
+bool rf_transmitter_get_link(const rf_transmitter_ctx_t *ctx, rf_link_snapshot_t *link)
+{
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+    if (!ctx || !link || !ctx->paired || !link_beacon_valid) return false;
+    
+    memset(link, 0, sizeof(*link));
+    link->valid = 1;
+    link->frame_number = link_beacon_frame;
+    link->network_key = ctx->network_key;
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    link->hop_lane = rf_hop_table_get_lane();
+#endif
+    link->beacon_age_us = rf_hw_get_time_us() - link_beacon_us;
+    link->rtc_cycles = hal_rtc_get_cycles();
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+    link->drift_ppb = rf_timing_get_drift_ppb();
+#endif
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    link->frame_rate = rf_frame_rate_get();
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    link->roam_cell = roam_own_cell();
+#endif
+    return true;
+#else
+    (void)ctx;
+    (void)link;
+    return false;
+#endif
+}
+
+int rf_transmitter_resume_link(rf_transmitter_ctx_t *ctx, const rf_link_snapshot_t *link)
+{
+#if defined(USE_RF_FAST_REJOIN) && USE_RF_FAST_REJOIN
+    if (!ctx || !link || !link->valid || !ctx->paired) return -1;
+    if (link->network_key != ctx->network_key) return -2;
+    
+#if defined(USE_RF_FRAME_RATE) && USE_RF_FRAME_RATE
+    // 按保存时的速率预测; 睡眠期间接收器若已切换速率, 目标帧收不到信标, 回到正常捕获
+    rf_frame_rate_sync(RF_RATE_PACK(link->frame_rate & 0x03, link->frame_rate & 0x03, 0));
+#endif
+    
+    // 距最近信标经过的时间 (睡眠部分只能靠 RTC)
+    uint32_t elapsed_us = hal_rtc_elapsed_us(link->rtc_cycles);
+    if (elapsed_us > 0xFFFFFFFFUL - link->beacon_age_us) return -3;
+    elapsed_us += link->beacon_age_us;
+    
+    // 不确定度: RTC 误差 + 1 帧 (RTC 读数粒度 / 信标抖动)
+    uint32_t uncert_us = (uint32_t)((uint64_t)elapsed_us * RF_REJOIN_RTC_PPM / 1000000ULL);
+    uint32_t uncert_frames = uncert_us / RF_FRAME_US + 1;
+    if (uncert_frames > RF_REJOIN_MAX_FRAMES) return -3;
+    
+    // 目标帧: 即使 RTC 偏差取到上限, 它的信标也还没发出
+    uint32_t frames_elapsed = elapsed_us / RF_FRAME_US;
+    uint32_t phase_us = elapsed_us % RF_FRAME_US;
+    uint16_t target = (uint16_t)(link->frame_number + frames_elapsed + uncert_frames + 1);
+    uint32_t target_at = rf_hw_get_time_us() +
+                         (uncert_frames + 1) * RF_FRAME_US - phase_us;
+    
+#if defined(USE_RF_COEXIST) && USE_RF_COEXIST
+    rf_hop_table_set_lane(link->hop_lane);
+#endif
+#if defined(USE_RF_ROAMING) && USE_RF_ROAMING
+    rf_hop_table_set_cell(link->roam_cell);
+    roam_cell_pending = 0xFF;
+#endif
+    rf_hop_table_build(ctx->network_key, NULL, 0);
+    rejoin_channel = rf_hop_table_get(target);
+    rejoin_deadline_us = target_at + uncert_frames * RF_FRAME_US + RF_SYNC_SLOT_US;
+    rejoin_active = true;
+    
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+    rf_timing_set_drift_ppb(link->drift_ppb);
+#endif
+    
+    ctx->frame_number = target;
+    ctx->state = TX_STATE_SEARCHING;
+    ctx->last_sync_ms = hal_millis();
+    rf_hw_set_channel(rejoin_channel);
+    rf_hw_rx_mode();
+    return 0;
+#else
+    (void)ctx;
+    (void)link;
+    return -1;
+#endif
+}
+
 void rf_transmitter_set_sync_callback(rf_tx_sync_callback_t cb)
 {
     sync_callback = cb;
 }
 
+uint32_t rf_transmitter_get_slot_offset_us(void)
+{
+    return my_slot_offset_us;
+}
+
+void rf_transmitter_get_retx_stats(uint32_t *recovered, uint32_t *expired)
+{
+#if defined(USE_RF_SELECTIVE_REPEAT) && USE_RF_SELECTIVE_REPEAT
+    if (recovered) *recovered = retx_recovered;
+    if (expired) *expired = retx_expired;
+#else
+    if (recovered) *recovered = 0;
+    if (expired) *expired = 0;
+#endif
+}
+
 void rf_transmitter_set_ack_callback(rf_tx_ack_callback_t cb)
 {
     ack_callback = cb;
 }
+
+void rf_transmitter_set_pre_tx_callback(rf_tx_pre_tx_callback_t cb)
+{
+    pre_tx_callback = cb;
+}
@@ -18,6 +18,8 @@
 
 #include "rf_ultra.h"
 #include "optimize.h"
+#include "config.h"
+#include "hal.h"
 #include <string.h>
 
 /*============================================================================
@@ -41,28 +43,6 @@
 #define PKT_TYPE_STATUS     2   // Status/battery
 #define PKT_TYPE_RESERVED   3
 
-/*============================================================================
- * CRC8 (Optimized, no table)
- *============================================================================*/
-
-static FORCE_INLINE uint8_t crc8_update(uint8_t crc, uint8_t data)
-{
-    crc ^= data;
-    for (int i = 0; i < 8; i++) {
-        crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
-    }
-    return crc;
-}
-
-static uint8_t HOT crc8_calc(const uint8_t *data, uint8_t len)
-{
-    uint8_t crc = 0xFF;
-    while (len--) {
-        crc = crc8_update(crc, *data++);
-    }
-    return crc;
-}
-
 /*============================================================================
  * Quaternion Compression
  *============================================================================*/
@@ -105,6 +85,19 @@ static FORCE_INLINE void quat_compress_q15(const q15_t q[4], int16_t out[4])
     out[3] = q[3] * sign;
 }
 
+#if defined(BUILD_BENCH) || defined(BUILD_HOST)
+// v0.6.3: 编解码基准入口 (codec_bench.c)
+void rf_ultra_bench_compress(const float q[4], int16_t out[4])
+{
+    quat_compress(q, out);
+}
+
+void rf_ultra_bench_compress_q15(const q15_t q[4], int16_t out[4])
+{
+    quat_compress_q15(q, out);
+}
+#endif
+
 /*============================================================================
  * Packet Building
  *============================================================================*/
@@ -139,7 +132,7 @@ void rf_ultra_build_quat_packet(uint8_t *pkt,
     pkt[PKT_AUX_OFFSET + 1] = (uint8_t)(((az_12 >> 8) & 0x0F) | (batt_4 << 4));
     
     // CRC
-    pkt[PKT_CRC_OFFSET] = crc8_calc(pkt, PKT_SIZE - 1);
+    pkt[PKT_CRC_OFFSET] = hal_crc8(pkt, PKT_SIZE - 1);
 }
 
 // Build info packet (type 1)
@@ -167,7 +160,7 @@ void rf_ultra_build_info_packet(uint8_t *pkt,
     
     pkt[10] = 0;  // Reserved
     
-    pkt[PKT_CRC_OFFSET] = crc8_calc(pkt, PKT_SIZE - 1);
+    pkt[PKT_CRC_OFFSET] = hal_crc8(pkt, PKT_SIZE - 1);
 }
 
 // Build status packet (type 2)
@@ -190,7 +183,7 @@ void rf_ultra_build_status_packet(uint8_t *pkt,
     pkt[9] = 0;
     pkt[10] = 0;
     
-    pkt[PKT_CRC_OFFSET] = crc8_calc(pkt, PKT_SIZE - 1);
+    pkt[PKT_CRC_OFFSET] = hal_crc8(pkt, PKT_SIZE - 1);
 }
 
 /*============================================================================
@@ -200,7 +193,7 @@ void rf_ultra_build_status_packet(uint8_t *pkt,
 bool rf_ultra_parse_packet(const uint8_t *pkt, rf_ultra_parsed_t *out)
 {
     // Verify CRC
-    if (crc8_calc(pkt, PKT_SIZE - 1) != pkt[PKT_CRC_OFFSET]) {
+    if (hal_crc8(pkt, PKT_SIZE - 1) != pkt[PKT_CRC_OFFSET]) {
         return false;
     }
     
@@ -305,8 +298,6 @@ const uint8_t* rf_ultra_tx_update(uint8_t tracker_id,
  * Receiver State Machine
  *============================================================================*/
 
-#include "board.h"  // 使用统一的 MAX_TRACKERS
-
 #define MAX_TRACKERS_ULTRA  MAX_TRACKERS  // 使用 config.h 中定义
 
 static struct {
@@ -11,6 +11,7 @@
  * 4. 智能跳频 - 基于 RSSI 选择最佳通道
  * 5. 包聚合 - 多追踪器数据合并
  * 6. 压缩四元数 - 只传输 3 个分量 (smallest-three)
+ * 7. v0.6.3: 多样本聚合 - 单包 1-4 个增量压缩样本 + 子帧时间戳
  * 
  * 数据包格式对比:
  * | 版本 | 包大小 | 有效载荷 | 开销 |
@@ -22,6 +23,9 @@
 
 #include "rf_ultra.h"
 #include "optimize.h"
+#include "channel_manager.h"
+#include "hal.h"
+#include "config.h"
 #include <string.h>
 
 /*============================================================================
@@ -144,37 +148,178 @@ static void quat_decompress_smallest_three(const smallest_three_t *in, q15_t q[4
     }
 }
 
+#if defined(BUILD_BENCH) || defined(BUILD_HOST)
+// v0.6.3: 编解码基准入口 (codec_bench.c)
+void rf_v2_bench_st_compress(const q15_t q[4], int16_t abc[3], uint8_t *dropped)
+{
+    smallest_three_t st;
+    quat_compress_smallest_three(q, &st);
+    abc[0] = st.a;
+    abc[1] = st.b;
+    abc[2] = st.c;
+    *dropped = st.dropped;
+}
+
+void rf_v2_bench_st_decompress(const int16_t abc[3], uint8_t dropped, q15_t q[4])
+{
+    smallest_three_t st = { abc[0], abc[1], abc[2], dropped };
+    quat_decompress_smallest_three(&st, q);
+}
+#endif
+
+/*============================================================================
+ * v0.6.3: 40-bit smallest-three (USB bundle 报告使用)
+ * 
+ * bit0-1   被丢弃分量索引
+ * bit2-37  3 个保留分量, 12-bit 有符号, 满量程 ±1/√2
+ * bit38-39 调用方标志位 (保持不变)
+ *============================================================================*/
+
+#define QUAT40_C12_MAX      2047
+#define QUAT40_Q14_MAX      11585       // 16384 / √2
+
+static int16_t q14_to_c12(int16_t v)
+{
+    int32_t c = ((int32_t)v * QUAT40_C12_MAX * 2 + (v >= 0 ? QUAT40_Q14_MAX : -QUAT40_Q14_MAX))
+                / (2 * QUAT40_Q14_MAX);
+    if (c > QUAT40_C12_MAX) c = QUAT40_C12_MAX;
+    if (c < -QUAT40_C12_MAX) c = -QUAT40_C12_MAX;
+    return (int16_t)c;
+}
+
+void rf_v2_quat_pack40(const q15_t q[4], uint8_t out[RF_QUAT40_SIZE])
+{
+    smallest_three_t st;
+    quat_compress_smallest_three(q, &st);
+    
+    uint64_t bits = st.dropped & 0x03;
+    bits |= (uint64_t)((uint16_t)q14_to_c12(st.a) & 0xFFF) << 2;
+    bits |= (uint64_t)((uint16_t)q14_to_c12(st.b) & 0xFFF) << 14;
+    bits |= (uint64_t)((uint16_t)q14_to_c12(st.c) & 0xFFF) << 26;
+    
+    out[0] = (uint8_t)bits;
+    out[1] = (uint8_t)(bits >> 8);
+    out[2] = (uint8_t)(bits >> 16);
+    out[3] = (uint8_t)(bits >> 24);
+    out[4] = (out[4] & 0xC0) | ((uint8_t)(bits >> 32) & 0x3F);
+}
+
+void rf_v2_quat_unpack40(const uint8_t in[RF_QUAT40_SIZE], q15_t q[4])
+{
+    uint64_t bits = (uint64_t)in[0] | ((uint64_t)in[1] << 8) | ((uint64_t)in[2] << 16) |
+                    ((uint64_t)in[3] << 24) | ((uint64_t)(in[4] & 0x3F) << 32);
+    int16_t c[3];
+    
+    for (int i = 0; i < 3; i++) {
+        int16_t v = (int16_t)((bits >> (2 + 12 * i)) & 0xFFF);
+        if (v & 0x800) v -= 0x1000;                 // 符号扩展
+        c[i] = (int16_t)((int32_t)v * QUAT40_Q14_MAX / QUAT40_C12_MAX);
+    }
+    
+    smallest_three_t st = { c[0], c[1], c[2], (uint8_t)(bits & 0x03) };
+    quat_decompress_smallest_three(&st, q);
+}
+
 /*============================================================================
  * 汉明码 (7,4) FEC / Hamming(7,4) FEC
  * 
  * 可纠正 1 位错误, 检测 2 位错误
- * 用于保护 header 和关键标志
+ * v0.6.3: 码字 bit0-6 为位置 7..1 (位置 1/2/4 为校验位), bit7 为整体偶校验,
+ * 构成扩展汉明码 (8,4): 单比特纠正, 双比特检出而不是误纠
  *============================================================================*/
 
-// 编码表: 4 位数据 → 7 位编码
+// 编码表: 4 位数据 → 8 位编码
 static const uint8_t hamming_encode_table[16] = {
-    0x00, 0x71, 0x62, 0x13, 0x54, 0x25, 0x36, 0x47,
-    0x38, 0x49, 0x5A, 0x2B, 0x6C, 0x1D, 0x0E, 0x7F
+    0x00, 0x69, 0xAA, 0xC3, 0xCC, 0xA5, 0x66, 0x0F,
+    0xF0, 0x99, 0x5A, 0x33, 0x3C, 0x55, 0x96, 0xFF
 };
 
-// 解码表: 7 位编码 → 4 位数据 (高位为错误标志)
+static FORCE_INLINE uint8_t parity8(uint8_t v)
+{
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return v & 1;
+}
+
+/**
+ * @brief 解码一个码字
+ * @return 0-15 数据, 0x10 | 数据 = 已纠正 1 位, 0xFF = 不可纠正 (2 位错误)
+ */
 static uint8_t hamming_decode(uint8_t code)
 {
+    uint8_t odd = parity8(code);
+    uint8_t c = code & 0x7F;
+    
     // 计算校验位
-    uint8_t p1 = ((code >> 6) ^ (code >> 4) ^ (code >> 2) ^ code) & 1;
-    uint8_t p2 = ((code >> 5) ^ (code >> 4) ^ (code >> 1) ^ code) & 1;
-    uint8_t p4 = ((code >> 3) ^ (code >> 2) ^ (code >> 1) ^ code) & 1;
+    uint8_t p1 = ((c >> 6) ^ (c >> 4) ^ (c >> 2) ^ c) & 1;
+    uint8_t p2 = ((c >> 5) ^ (c >> 4) ^ (c >> 1) ^ c) & 1;
+    uint8_t p4 = ((c >> 3) ^ (c >> 2) ^ (c >> 1) ^ c) & 1;
     
     uint8_t syndrome = (p4 << 2) | (p2 << 1) | p1;
     
+    if (syndrome != 0 && !odd) {
+        return 0xFF;
+    }
     if (syndrome != 0) {
         // 纠正单比特错误
-        code ^= (1 << (7 - syndrome));
+        c ^= (1 << (7 - syndrome));
     }
     
-    // 提取数据位
-    return ((code >> 4) & 0x08) | ((code >> 2) & 0x04) | 
-           ((code >> 1) & 0x02) | (code & 0x01);
+    // 提取数据位 (位置 3/5/6/7)
+    uint8_t data = ((c >> 1) & 0x08) | (c & 0x07);
+    return odd ? (data | 0x10) : data;
+}
+
+/*============================================================================
+ * v0.6.3: FEC 包 / FEC Packet
+ * 格式见 rf_ultra.h
+ *============================================================================*/
+
+#define FEC_HDR_LEN_MASK        0x0F
+
+int rf_fec_encode(uint8_t *out, const uint8_t *in, uint8_t len)
+{
+    if (len == 0 || len > RF_FEC_MAX_INNER) return -1;
+    
+    out[0] = RF_FEC_HEADER | len;
+    for (uint8_t i = 0; i < len; i++) {
+        out[1 + 2 * i] = hamming_encode_table[in[i] & 0x0F];
+        out[2 + 2 * i] = hamming_encode_table[in[i] >> 4];
+    }
+    
+    return RF_FEC_PACKET_SIZE(len);
+}
+
+bool rf_fec_is_packet(const uint8_t *pkt, uint8_t len)
+{
+    if (len < RF_FEC_PACKET_SIZE(1) || len > RF_FEC_PACKET_SIZE(RF_FEC_MAX_INNER)) return false;
+    if (!(len & 1)) return false;
+    
+    // 头部由长度唯一确定, 允许 1 位错误
+    uint8_t expect = RF_FEC_HEADER | ((len - 1) / 2);
+    uint8_t diff = pkt[0] ^ expect;
+    return (diff & (diff - 1)) == 0;
+}
+
+int rf_fec_decode(const uint8_t *pkt, uint8_t len, uint8_t *out, uint8_t *corrected)
+{
+    if (!rf_fec_is_packet(pkt, len)) return -1;
+    
+    uint8_t n = (len - 1) / 2;
+    uint8_t fixed = (pkt[0] != (RF_FEC_HEADER | n)) ? 1 : 0;
+    
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t lo = hamming_decode(pkt[1 + 2 * i]);
+        uint8_t hi = hamming_decode(pkt[2 + 2 * i]);
+        if (lo == 0xFF || hi == 0xFF) return -2;
+        
+        fixed += (lo >> 4) + (hi >> 4);
+        out[i] = (uint8_t)(((hi & FEC_HDR_LEN_MASK) << 4) | (lo & FEC_HDR_LEN_MASK));
+    }
+    
+    if (corrected) *corrected = fixed;
+    return n;
 }
 
 /*============================================================================
@@ -186,7 +331,6 @@ typedef struct {
     uint8_t delta_count;        // 连续增量包计数
     uint8_t motion_level;       // 运动强度 (0-255)
     uint8_t tx_divider;         // 发送分频 (1=200Hz, 2=100Hz, ...)
-    uint8_t channel_quality[5]; // 各通道质量 (0=差, 255=优)
     uint8_t current_channel;    // 当前通道
 } adaptive_tx_state_t;
 
@@ -199,9 +343,6 @@ void rf_v2_adaptive_init(void)
 {
     memset(&atx_state, 0, sizeof(atx_state));
     atx_state.tx_divider = 1;
-    for (int i = 0; i < 5; i++) {
-        atx_state.channel_quality[i] = 128;
-    }
 }
 
 /**
@@ -364,20 +505,17 @@ static const uint8_t channel_freq[5] = {
     12      // 2428 MHz (数据通道 12)
 };
 
+// v0.6.3: 对应的 RF 信道号 ((MHz - RF_BASE_FREQ_MHZ) / RF_CHANNEL_STEP_MHZ),
+// 质量统计统一记在 channel_manager 中
+static const uint8_t channel_stats_idx[5] = { 0, 12, 39, 1, 13 };
+
 /**
  * @brief 更新通道质量 (接收端调用)
  */
 void rf_v2_update_channel_quality(uint8_t channel, int8_t rssi, bool crc_ok)
 {
     if (channel >= 5) return;
-    
-    // 指数移动平均
-    int16_t quality = atx_state.channel_quality[channel];
-    int16_t new_sample = crc_ok ? (rssi + 100) * 2 : 0;
-    quality = (quality * 7 + new_sample) >> 3;
-    if (quality > 255) quality = 255;
-    if (quality < 0) quality = 0;
-    atx_state.channel_quality[channel] = quality;
+    ch_mgr_record_tx(&ch_manager, channel_stats_idx[channel], crc_ok, rssi);
 }
 
 /**
@@ -386,11 +524,12 @@ void rf_v2_update_channel_quality(uint8_t channel, int8_t rssi, bool crc_ok)
 uint8_t rf_v2_select_best_channel(void)
 {
     uint8_t best_ch = 0;
-    uint8_t best_q = atx_state.channel_quality[0];
+    uint8_t best_q = ch_mgr_get_channel_quality(&ch_manager, channel_stats_idx[0]);
     
     for (int i = 1; i < 5; i++) {
-        if (atx_state.channel_quality[i] > best_q) {
-            best_q = atx_state.channel_quality[i];
+        uint8_t q = ch_mgr_get_channel_quality(&ch_manager, channel_stats_idx[i]);
+        if (q > best_q) {
+            best_q = q;
             best_ch = i;
         }
     }
@@ -453,6 +592,721 @@ int rf_v2_build_aggregate_packet(uint8_t *pkt, const aggregate_packet_t *data)
     return offset;
 }
 
+/*============================================================================
+ * v0.6.3: 多样本聚合包 / Multi-Sample Aggregate Packet
+ * 格式见 rf_ultra.h
+ * 
+ * 增量在发送端闭环量化 (相对接收端重建值), 量化误差不会沿样本累积
+ *============================================================================*/
+
+#define MULTI_HDR_COUNT_MASK    0x0F
+#define MULTI_SHIFT_MASK        0x07
+#define MULTI_DROPPED_SHIFT     6
+#define MULTI_RETX_FLAG         0x08
+#define MULTI_SIDEBAND_SHIFT    4       // v0.6.3: 状态旁路 2 位 (USE_RF_SIDEBAND)
+#define MULTI_SIDEBAND_MASK     0x30
+#define MULTI_AGE_OFFSET        14
+#define DELTA_REF_OFFSET        3       // 增量包 (USE_RF_DELTA_STREAM)
+#define DELTA_FLAG_OFFSET       4
+#define DELTA_AGE_OFFSET        7
+
+static struct {
+    q15_t quat[RF_MULTI_MAX_SAMPLES][4];
+    uint32_t t_us[RF_MULTI_MAX_SAMPLES];
+    uint8_t count;
+} multi_buf;
+
+#if defined(USE_RF_SIDEBAND) && USE_RF_SIDEBAND
+/*============================================================================
+ * v0.6.3: 状态旁路 / Status Sideband
+ * 格式见 rf_ultra.h
+ *============================================================================*/
+
+#define SB_WINDOW_SHIFT         4       // 16 个包一个窗口
+#define SB_WINDOW_MASK          0x0F
+
+static struct {
+    uint16_t value[RF_SB_FIELD_COUNT];
+    uint32_t word;                      // 当前窗口发送的字
+    uint8_t window;
+    bool latched;
+} sb_tx;
+
+static uint32_t sb_make_word(uint8_t field, uint16_t value)
+{
+    uint8_t b[4] = { field, (uint8_t)value, (uint8_t)(value >> 8), 0 };
+    b[3] = hal_crc8(b, 3);
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+void rf_sideband_set(uint8_t field, uint16_t value)
+{
+    if (field < RF_SB_FIELD_COUNT) sb_tx.value[field] = value;
+}
+
+/**
+ * @brief 本包携带的 2 位; 字在窗口内第一次组包时锁定, 窗口内不随新值变化
+ */
+static uint8_t sb_bits(uint8_t sequence)
+{
+    uint8_t window = sequence >> SB_WINDOW_SHIFT;
+    if (!sb_tx.latched || window != sb_tx.window) {
+        uint8_t field = window % RF_SB_FIELD_COUNT;
+        sb_tx.word = sb_make_word(field, sb_tx.value[field]);
+        sb_tx.window = window;
+        sb_tx.latched = true;
+    }
+    return (uint8_t)((sb_tx.word >> ((sequence & SB_WINDOW_MASK) * 2)) & 0x03);
+}
+
+bool rf_sideband_feed(rf_sideband_rx_t *rx, uint8_t sequence, uint8_t bits,
+                      uint8_t *field, uint16_t *value)
+{
+    uint8_t window = sequence >> SB_WINDOW_SHIFT;
+    uint8_t pos = sequence & SB_WINDOW_MASK;
+    
+    if (window != rx->window) {
+        rx->window = window;
+        rx->word = 0;
+        rx->mask = 0;
+    }
+    if (rx->mask == 0xFFFF) return false;                 // 本窗口已拼出
+    
+    rx->word = (rx->word & ~(0x03UL << (pos * 2))) | ((uint32_t)(bits & 0x03) << (pos * 2));
+    rx->mask |= (uint16_t)(1u << pos);
+    if (rx->mask != 0xFFFF) return false;
+    
+    uint8_t b[4] = { (uint8_t)rx->word, (uint8_t)(rx->word >> 8),
+                     (uint8_t)(rx->word >> 16), (uint8_t)(rx->word >> 24) };
+    if (hal_crc8(b, 3) != b[3] || b[0] >= RF_SB_FIELD_COUNT ||
+        b[0] != window % RF_SB_FIELD_COUNT) {
+        return false;
+    }
+    *field = b[0];
+    *value = (uint16_t)(b[1] | (b[2] << 8));
+    return true;
+}
+#define SB_BITS(seq)            ((uint8_t)(sb_bits(seq) << MULTI_SIDEBAND_SHIFT))
+#else
+#define SB_BITS(seq)            0
+#endif
+
+static FORCE_INLINE q15_t sat_q15(int32_t v)
+{
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (q15_t)v;
+}
+
+void rf_multi_push_sample(const q15_t quat[4], uint32_t t_us)
+{
+    if (multi_buf.count >= RF_MULTI_MAX_SAMPLES) {
+        // 丢弃最旧样本
+        memmove(&multi_buf.quat[0], &multi_buf.quat[1],
+                sizeof(multi_buf.quat[0]) * (RF_MULTI_MAX_SAMPLES - 1));
+        memmove(&multi_buf.t_us[0], &multi_buf.t_us[1],
+                sizeof(multi_buf.t_us[0]) * (RF_MULTI_MAX_SAMPLES - 1));
+        multi_buf.count = RF_MULTI_MAX_SAMPLES - 1;
+    }
+    
+    memcpy(multi_buf.quat[multi_buf.count], quat, sizeof(multi_buf.quat[0]));
+    multi_buf.t_us[multi_buf.count] = t_us;
+    multi_buf.count++;
+}
+
+uint8_t rf_multi_pending(void)
+{
+    return multi_buf.count;
+}
+
+void rf_multi_clear(void)
+{
+    multi_buf.count = 0;
+}
+
+// 选择增量移位: 相邻样本最大分量差 (含 q/-q 对齐) 能放进 int8
+// 第一个增量相对 prev, 之后相对上一样本; 7 位移位仍放不下时 *fits = false
+static uint8_t multi_pick_shift(const q15_t *prev, const q15_t (*q)[4], uint8_t n,
+                                bool *fits)
+{
+    int32_t max_diff = 0;
+    const q15_t *a = prev;
+    for (uint8_t i = 0; i < n; i++) {
+        const q15_t *b = q[i];
+        int32_t dot = 0;
+        for (int c = 0; c < 4; c++) dot += ((int32_t)a[c] * b[c]) >> 15;
+        for (int c = 0; c < 4; c++) {
+            int32_t d = (dot < 0) ? (-b[c] - a[c]) : (b[c] - a[c]);
+            if (d < 0) d = -d;
+            if (d > max_diff) max_diff = d;
+        }
+        a = b;
+    }
+    uint8_t shift = 0;
+    while (shift < MULTI_SHIFT_MASK && ((max_diff + (1 << shift)) >> shift) > 127) {
+        shift++;
+    }
+    if (fits) *fits = (((max_diff + (1 << shift)) >> shift) <= 127);
+    return shift;
+}
+
+// 闭环量化增量: rec 输入为接收端当前重建值, 输出为最后一个样本的重建值
+static int multi_encode_deltas(uint8_t *out, q15_t rec[4], const q15_t (*q)[4],
+                               uint8_t n, uint8_t shift)
+{
+    int offset = 0;
+    int32_t half = (1 << shift) >> 1;
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t dot = 0;
+        for (int c = 0; c < 4; c++) dot += ((int32_t)rec[c] * q[i][c]) >> 15;
+        
+        for (int c = 0; c < 4; c++) {
+            int32_t d = ((dot < 0) ? -q[i][c] : q[i][c]) - rec[c];
+            d = (d >= 0) ? ((d + half) >> shift) : -((-d + half) >> shift);
+            if (d > 127) d = 127;
+            if (d < -128) d = -128;
+            out[offset++] = (uint8_t)(int8_t)d;
+            rec[c] = sat_q15(rec[c] + (d << shift));
+        }
+    }
+    return offset;
+}
+
+static void multi_write_ages(uint8_t *out, uint8_t n, uint32_t now_us)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t age = (now_us - multi_buf.t_us[i] + RF_MULTI_TICK_US / 2) / RF_MULTI_TICK_US;
+        out[i] = (age > 255) ? 255 : (uint8_t)age;
+    }
+}
+
+static int multi_build(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                       int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                       uint32_t now_us, q15_t rec[4])
+{
+    uint8_t n = multi_buf.count;
+    
+    // 基准样本: smallest-three, 重建值与接收端一致
+    smallest_three_t st;
+    quat_compress_smallest_three(multi_buf.quat[0], &st);
+    quat_decompress_smallest_three(&st, rec);
+    
+    uint8_t shift = multi_pick_shift(multi_buf.quat[0], &multi_buf.quat[1], n - 1, NULL);
+    
+    pkt[0] = RF_MULTI_HEADER | n;
+    pkt[1] = tracker_id;
+    pkt[2] = sequence;
+    pkt[3] = shift | SB_BITS(sequence) | (st.dropped << MULTI_DROPPED_SHIFT);
+    pkt[4] = battery_pct;
+    pkt[5] = flags;
+    pkt[6] = (uint8_t)accel_z_mg;
+    pkt[7] = (uint8_t)((uint16_t)accel_z_mg >> 8);
+    pkt[8] = (uint8_t)st.a;
+    pkt[9] = (uint8_t)((uint16_t)st.a >> 8);
+    pkt[10] = (uint8_t)st.b;
+    pkt[11] = (uint8_t)((uint16_t)st.b >> 8);
+    pkt[12] = (uint8_t)st.c;
+    pkt[13] = (uint8_t)((uint16_t)st.c >> 8);
+    
+    int offset = MULTI_AGE_OFFSET;
+    multi_write_ages(&pkt[offset], n, now_us);
+    offset += n;
+    offset += multi_encode_deltas(&pkt[offset], rec, &multi_buf.quat[1], n - 1, shift);
+    
+    pkt[offset] = hal_crc8(pkt, offset);
+    offset++;
+    
+    return offset;
+}
+
+int rf_multi_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                          int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                          uint32_t now_us)
+{
+    if (multi_buf.count == 0) return 0;
+    
+    q15_t rec[4];
+    int len = multi_build(pkt, tracker_id, sequence, accel_z_mg, battery_pct, flags,
+                          now_us, rec);
+    multi_buf.count = 0;
+    return len;
+}
+
+int rf_multi_restamp_packet(uint8_t *pkt, uint8_t len, uint32_t delay_us)
+{
+    uint8_t n = pkt[0] & MULTI_HDR_COUNT_MASK;
+    int size;
+    uint8_t flag_idx;
+    uint8_t *ages;
+    
+    if (rf_multi_is_packet(pkt, len)) {
+        size = RF_MULTI_PACKET_SIZE(n);
+        flag_idx = 3;
+        ages = &pkt[MULTI_AGE_OFFSET];
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+    } else if (rf_delta_is_packet(pkt, len)) {
+        size = RF_DELTA_PACKET_SIZE(n);
+        flag_idx = DELTA_FLAG_OFFSET;
+        ages = &pkt[DELTA_AGE_OFFSET];
+#endif
+    } else {
+        return -1;
+    }
+    uint32_t tick = (pkt[flag_idx] & MULTI_RETX_FLAG) ? RF_MULTI_RETX_TICK_US : RF_MULTI_TICK_US;
+    
+    // 最旧样本年龄最大, 先检查再改写
+    uint32_t oldest = ages[0] * tick + delay_us;
+    if ((oldest + RF_MULTI_RETX_TICK_US / 2) / RF_MULTI_RETX_TICK_US > 255) {
+        return -2;
+    }
+    
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t age = ages[i] * tick + delay_us;
+        ages[i] = (uint8_t)((age + RF_MULTI_RETX_TICK_US / 2) / RF_MULTI_RETX_TICK_US);
+    }
+    pkt[flag_idx] |= MULTI_RETX_FLAG;
+    pkt[size - 1] = hal_crc8(pkt, size - 1);
+    
+    return 0;
+}
+
+bool rf_multi_is_packet(const uint8_t *pkt, uint8_t len)
+{
+    if (len < RF_MULTI_PACKET_SIZE(1)) return false;
+    if ((pkt[0] & 0xF0) != RF_MULTI_HEADER) return false;
+    
+    uint8_t n = pkt[0] & MULTI_HDR_COUNT_MASK;
+    return (n >= 1 && n <= RF_MULTI_MAX_SAMPLES && len >= RF_MULTI_PACKET_SIZE(n));
+}
+
+bool rf_multi_parse_packet(const uint8_t *pkt, uint8_t len, rf_multi_parsed_t *out)
+{
+    if (!rf_multi_is_packet(pkt, len)) return false;
+    
+    uint8_t n = pkt[0] & MULTI_HDR_COUNT_MASK;
+    int size = RF_MULTI_PACKET_SIZE(n);
+    if (hal_crc8(pkt, size - 1) != pkt[size - 1]) return false;
+    
+    uint8_t shift = pkt[3] & MULTI_SHIFT_MASK;
+    
+    out->tracker_id = pkt[1];
+    out->sequence = pkt[2];
+    out->count = n;
+    out->delta = false;
+    out->ref_sequence = 0;
+    out->sideband = (pkt[3] & MULTI_SIDEBAND_MASK) >> MULTI_SIDEBAND_SHIFT;
+    out->battery_pct = pkt[4];
+    out->flags = pkt[5];
+    out->accel_z_mg = (int16_t)(pkt[6] | (pkt[7] << 8));
+    
+    smallest_three_t st;
+    st.dropped = pkt[3] >> MULTI_DROPPED_SHIFT;
+    st.a = (int16_t)(pkt[8] | (pkt[9] << 8));
+    st.b = (int16_t)(pkt[10] | (pkt[11] << 8));
+    st.c = (int16_t)(pkt[12] | (pkt[13] << 8));
+    quat_decompress_smallest_three(&st, out->quat[0]);
+    
+    const uint8_t *ages = &pkt[MULTI_AGE_OFFSET];
+    const int8_t *delta = (const int8_t *)&pkt[MULTI_AGE_OFFSET + n];
+    uint16_t tick = (pkt[3] & MULTI_RETX_FLAG) ? RF_MULTI_RETX_TICK_US : RF_MULTI_TICK_US;
+    
+    out->age_us[0] = ages[0] * tick;
+    for (uint8_t i = 1; i < n; i++) {
+        for (int c = 0; c < 4; c++) {
+            out->quat[i][c] = sat_q15(out->quat[i - 1][c] + ((int32_t)*delta++ << shift));
+        }
+        out->age_us[i] = ages[i] * tick;
+    }
+    
+    return true;
+}
+
+#if defined(USE_RF_DELTA_STREAM) && USE_RF_DELTA_STREAM
+/*============================================================================
+ * v0.6.3: 增量流 / Delta Stream
+ * 格式见 rf_ultra.h
+ * 
+ * 关键帧 = 多样本聚合包; 其余包的第一个增量相对 "已被 ACK 的参考包" 最后
+ * 一个样本的重建值. 参考包由硬件 ACK 确认, 接收端必然已解码并保存了它,
+ * 因此丢包只影响当前包, 不会破坏后续增量链
+ *============================================================================*/
+
+#define DELTA_HISTORY_MASK      (RF_DELTA_HISTORY - 1)
+
+typedef struct {
+    q15_t quat[4];          // 该包最后一个样本的接收端重建值
+    uint8_t sequence;
+    bool valid;
+} delta_entry_t;
+
+static struct {
+    delta_entry_t hist[RF_DELTA_HISTORY];   // 已发送, 等待 ACK
+    delta_entry_t ref;                      // 最新已确认
+    uint8_t since_key;
+    uint8_t key_flags;                      // 最近关键帧携带的状态标志
+} delta_tx;
+
+void rf_delta_reset(void)
+{
+    memset(&delta_tx, 0, sizeof(delta_tx));
+}
+
+int rf_delta_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                          int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                          uint32_t now_us)
+{
+    uint8_t n = multi_buf.count;
+    if (n == 0) return 0;
+    
+    // 参考过旧时接收端的历史环可能已被覆盖, 发关键帧
+    // 状态标志 (静止/充电等) 变化也立即发关键帧, 接收端不必等到下一个周期关键帧
+    bool key = !delta_tx.ref.valid ||
+               delta_tx.since_key >= RF_DELTA_KEYFRAME_INTERVAL ||
+               flags != delta_tx.key_flags ||
+               (uint8_t)(sequence - delta_tx.ref.sequence) >= RF_DELTA_HISTORY;
+    
+    uint8_t shift = 0;
+    if (!key) {
+        bool fits;
+        shift = multi_pick_shift(delta_tx.ref.quat, multi_buf.quat, n, &fits);
+        key = !fits;
+    }
+    
+    q15_t rec[4];
+    int offset;
+    if (key) {
+        offset = multi_build(pkt, tracker_id, sequence, accel_z_mg, battery_pct, flags,
+                             now_us, rec);
+        delta_tx.since_key = 0;
+        delta_tx.key_flags = flags;
+    } else {
+        memcpy(rec, delta_tx.ref.quat, sizeof(rec));
+        
+        pkt[0] = RF_DELTA_HEADER | n;
+        pkt[1] = tracker_id;
+        pkt[2] = sequence;
+        pkt[DELTA_REF_OFFSET] = delta_tx.ref.sequence;
+        pkt[DELTA_FLAG_OFFSET] = shift | SB_BITS(sequence);
+        pkt[5] = (uint8_t)accel_z_mg;
+        pkt[6] = (uint8_t)((uint16_t)accel_z_mg >> 8);
+        
+        offset = DELTA_AGE_OFFSET;
+        multi_write_ages(&pkt[offset], n, now_us);
+        offset += n;
+        offset += multi_encode_deltas(&pkt[offset], rec, multi_buf.quat, n, shift);
+        
+        pkt[offset] = hal_crc8(pkt, offset);
+        offset++;
+        delta_tx.since_key++;
+    }
+    
+    delta_entry_t *e = &delta_tx.hist[sequence & DELTA_HISTORY_MASK];
+    memcpy(e->quat, rec, sizeof(e->quat));
+    e->sequence = sequence;
+    e->valid = true;
+    
+    multi_buf.count = 0;
+    return offset;
+}
+
+void rf_delta_on_ack(const uint8_t *pkt, uint8_t len)
+{
+    if (!rf_multi_is_packet(pkt, len) && !rf_delta_is_packet(pkt, len)) return;
+    
+    uint8_t seq = pkt[2];
+    const delta_entry_t *e = &delta_tx.hist[seq & DELTA_HISTORY_MASK];
+    if (!e->valid || e->sequence != seq) return;
+    
+    // 重传包的 ACK 可能晚于更新的包到达, 只前移参考
+    if (delta_tx.ref.valid && (int8_t)(seq - delta_tx.ref.sequence) <= 0) return;
+    delta_tx.ref = *e;
+}
+
+bool rf_delta_is_packet(const uint8_t *pkt, uint8_t len)
+{
+    if (len < RF_DELTA_PACKET_SIZE(1)) return false;
+    if ((pkt[0] & 0xF0) != RF_DELTA_HEADER) return false;
+    
+    uint8_t n = pkt[0] & MULTI_HDR_COUNT_MASK;
+    return (n >= 1 && n <= RF_MULTI_MAX_SAMPLES && len >= RF_DELTA_PACKET_SIZE(n));
+}
+
+bool rf_delta_peek(const uint8_t *pkt, uint8_t len, uint8_t *tracker_id,
+                   uint8_t *sequence, uint8_t *ref_sequence)
+{
+    if (!rf_delta_is_packet(pkt, len)) return false;
+    
+    *tracker_id = pkt[1];
+    *sequence = pkt[2];
+    *ref_sequence = pkt[DELTA_REF_OFFSET];
+    return true;
+}
+
+bool rf_delta_parse_packet(const uint8_t *pkt, uint8_t len, const q15_t ref[4],
+                           rf_multi_parsed_t *out)
+{
+    if (!rf_delta_is_packet(pkt, len)) return false;
+    
+    uint8_t n = pkt[0] & MULTI_HDR_COUNT_MASK;
+    int size = RF_DELTA_PACKET_SIZE(n);
+    if (hal_crc8(pkt, size - 1) != pkt[size - 1]) return false;
+    
+    uint8_t shift = pkt[DELTA_FLAG_OFFSET] & MULTI_SHIFT_MASK;
+    uint16_t tick = (pkt[DELTA_FLAG_OFFSET] & MULTI_RETX_FLAG) ?
+                    RF_MULTI_RETX_TICK_US : RF_MULTI_TICK_US;
+    
+    out->tracker_id = pkt[1];
+    out->sequence = pkt[2];
+    out->count = n;
+    out->delta = true;
+    out->ref_sequence = pkt[DELTA_REF_OFFSET];
+    out->sideband = (pkt[DELTA_FLAG_OFFSET] & MULTI_SIDEBAND_MASK) >> MULTI_SIDEBAND_SHIFT;
+    out->battery_pct = 0;
+    out->flags = 0;
+    out->accel_z_mg = (int16_t)(pkt[5] | (pkt[6] << 8));
+    
+    const uint8_t *ages = &pkt[DELTA_AGE_OFFSET];
+    const int8_t *delta = (const int8_t *)&pkt[DELTA_AGE_OFFSET + n];
+    const q15_t *prev = ref;
+    
+    for (uint8_t i = 0; i < n; i++) {
+        for (int c = 0; c < 4; c++) {
+            out->quat[i][c] = sat_q15(prev[c] + ((int32_t)*delta++ << shift));
+        }
+        out->age_us[i] = ages[i] * tick;
+        prev = out->quat[i];
+    }
+    
+    return true;
+}
+#endif /* USE_RF_DELTA_STREAM */
+
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+/*============================================================================
+ * v0.6.3: 原始样本包 / Raw IMU Packet (融合卸载)
+ * 格式见 rf_ultra.h
+ *============================================================================*/
+
+#define RAW_SHIFT_MASK          0x0F
+#define RAW_BASE_OFFSET         8
+#define RAW_DELTA_OFFSET        20
+
+static struct {
+    int16_t val[RF_RAW_MAX_SAMPLES][6];     // gyro[3] mrad/s, accel[3] mg
+    uint32_t t_us;                          // 最新样本时刻
+    uint8_t index;                          // 最新样本序号
+    uint8_t count;
+    bool started;                           // 首个样本序号为 0
+} raw_buf;
+
+static FORCE_INLINE int16_t sat_i16(float v)
+{
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)(v + ((v >= 0.0f) ? 0.5f : -0.5f));
+}
+
+void rf_raw_push_sample(const float gyro[3], const float accel[3], uint32_t t_us)
+{
+    if (raw_buf.count >= RF_RAW_MAX_SAMPLES) {
+        memmove(&raw_buf.val[0], &raw_buf.val[1],
+                sizeof(raw_buf.val[0]) * (RF_RAW_MAX_SAMPLES - 1));
+        raw_buf.count = RF_RAW_MAX_SAMPLES - 1;
+    }
+    
+    int16_t *v = raw_buf.val[raw_buf.count];
+    for (int c = 0; c < 3; c++) {
+        v[c] = sat_i16(gyro[c] * 1000.0f);
+        v[3 + c] = sat_i16(accel[c] * 1000.0f);
+    }
+    if (raw_buf.started) raw_buf.index++;
+    raw_buf.started = true;
+    raw_buf.t_us = t_us;
+    raw_buf.count++;
+}
+
+uint8_t rf_raw_pending(void)
+{
+    return raw_buf.count;
+}
+
+void rf_raw_reset(void)
+{
+    memset(&raw_buf, 0, sizeof(raw_buf));
+}
+
+// 增量移位: 相邻样本在 [first, first+3) 分量上的最大差能放进 int8
+static uint8_t raw_pick_shift(uint8_t n, int first)
+{
+    int32_t max_diff = 0;
+    for (uint8_t i = 1; i < n; i++) {
+        for (int c = first; c < first + 3; c++) {
+            int32_t d = (int32_t)raw_buf.val[i][c] - raw_buf.val[i - 1][c];
+            if (d < 0) d = -d;
+            if (d > max_diff) max_diff = d;
+        }
+    }
+    uint8_t shift = 0;
+    while (shift < RAW_SHIFT_MASK && ((max_diff + (1 << shift)) >> shift) > 127) {
+        shift++;
+    }
+    return shift;
+}
+
+int rf_raw_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                        uint8_t battery_pct, uint8_t flags, uint32_t now_us)
+{
+    uint8_t n = raw_buf.count;
+    if (n == 0) return 0;
+    
+    uint8_t gshift = raw_pick_shift(n, 0);
+    uint8_t ashift = raw_pick_shift(n, 3);
+    uint32_t age = (now_us - raw_buf.t_us + RF_MULTI_TICK_US / 2) / RF_MULTI_TICK_US;
+    
+    pkt[0] = RF_RAW_HEADER | n;
+    pkt[1] = tracker_id;
+    pkt[2] = sequence;
+    pkt[3] = raw_buf.index;
+    pkt[4] = (age > 255) ? 255 : (uint8_t)age;
+    pkt[5] = battery_pct;
+    pkt[6] = flags;
+    pkt[7] = gshift | (ashift << 4);
+    
+    int16_t rec[6];
+    int offset = RAW_BASE_OFFSET;
+    for (int c = 0; c < 6; c++) {
+        rec[c] = raw_buf.val[0][c];
+        pkt[offset++] = (uint8_t)rec[c];
+        pkt[offset++] = (uint8_t)((uint16_t)rec[c] >> 8);
+    }
+    
+    // 闭环量化: 相对接收端重建值, 量化误差不累积
+    for (uint8_t i = 1; i < n; i++) {
+        for (int c = 0; c < 6; c++) {
+            uint8_t shift = (c < 3) ? gshift : ashift;
+            int32_t half = (1 << shift) >> 1;
+            int32_t d = (int32_t)raw_buf.val[i][c] - rec[c];
+            d = (d >= 0) ? ((d + half) >> shift) : -((-d + half) >> shift);
+            if (d > 127) d = 127;
+            if (d < -128) d = -128;
+            pkt[offset++] = (uint8_t)(int8_t)d;
+            int32_t r = rec[c] + (d << shift);
+            rec[c] = (r > 32767) ? 32767 : (r < -32768) ? -32768 : (int16_t)r;
+        }
+    }
+    
+    pkt[offset] = hal_crc8(pkt, offset);
+    offset++;
+    
+    return offset;
+}
+
+bool rf_raw_is_packet(const uint8_t *pkt, uint8_t len)
+{
+    if (len < RF_RAW_PACKET_SIZE(1)) return false;
+    if ((pkt[0] & 0xF0) != RF_RAW_HEADER) return false;
+    
+    uint8_t n = pkt[0] & 0x0F;
+    return (n >= 1 && n <= RF_RAW_MAX_SAMPLES && len >= RF_RAW_PACKET_SIZE(n));
+}
+
+bool rf_raw_parse_packet(const uint8_t *pkt, uint8_t len, rf_raw_parsed_t *out)
+{
+    if (!rf_raw_is_packet(pkt, len)) return false;
+    
+    uint8_t n = pkt[0] & 0x0F;
+    int size = RF_RAW_PACKET_SIZE(n);
+    if (hal_crc8(pkt, size - 1) != pkt[size - 1]) return false;
+    
+    out->tracker_id = pkt[1];
+    out->sequence = pkt[2];
+    out->count = n;
+    out->index = pkt[3];
+    out->age_us = pkt[4] * RF_MULTI_TICK_US;
+    out->battery_pct = pkt[5];
+    out->flags = pkt[6];
+    
+    int16_t rec[6];
+    for (int c = 0; c < 6; c++) {
+        rec[c] = (int16_t)(pkt[RAW_BASE_OFFSET + 2 * c] | (pkt[RAW_BASE_OFFSET + 2 * c + 1] << 8));
+    }
+    
+    const int8_t *delta = (const int8_t *)&pkt[RAW_DELTA_OFFSET];
+    for (uint8_t i = 0; i < n; i++) {
+        if (i > 0) {
+            for (int c = 0; c < 6; c++) {
+                uint8_t shift = (pkt[7] >> ((c < 3) ? 0 : 4)) & RAW_SHIFT_MASK;
+                int32_t r = rec[c] + ((int32_t)*delta++ << shift);
+                rec[c] = (r > 32767) ? 32767 : (r < -32768) ? -32768 : (int16_t)r;
+            }
+        }
+        memcpy(out->gyro[i], &rec[0], sizeof(out->gyro[i]));
+        memcpy(out->accel[i], &rec[3], sizeof(out->accel[i]));
+    }
+    
+    return true;
+}
+#endif /* USE_FUSION_OFFLOAD */
+
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+/*============================================================================
+ * v0.6.3: 双姿态包 / Dual IMU Packet
+ * 格式见 rf_ultra.h
+ *============================================================================*/
+
+#define DUAL_AGE_OFFSET(k)      (7 + (k) * (1 + RF_QUAT40_SIZE))
+
+int rf_dual_build_packet(uint8_t *pkt, uint8_t tracker_id, uint8_t sequence,
+                         const q15_t quat[4], const q15_t aux_quat[4],
+                         int16_t accel_z_mg, uint8_t battery_pct, uint8_t flags,
+                         const uint32_t sample_us[2], uint32_t now_us)
+{
+    pkt[0] = RF_DUAL_HEADER;
+    pkt[1] = tracker_id;
+    pkt[2] = sequence;
+    pkt[3] = battery_pct;
+    pkt[4] = flags;
+    pkt[5] = (uint8_t)accel_z_mg;
+    pkt[6] = (uint8_t)((uint16_t)accel_z_mg >> 8);
+    
+    for (int k = 0; k < 2; k++) {
+        uint32_t age = (now_us - sample_us[k] + RF_MULTI_TICK_US / 2) / RF_MULTI_TICK_US;
+        uint8_t *p = &pkt[DUAL_AGE_OFFSET(k)];
+        p[0] = (age > 255) ? 255 : (uint8_t)age;
+        p[RF_QUAT40_SIZE] = 0;              // 末字节高 2 位保留
+        rf_v2_quat_pack40(k == 0 ? quat : aux_quat, &p[1]);
+    }
+    
+    pkt[RF_DUAL_PACKET_SIZE - 1] = hal_crc8(pkt, RF_DUAL_PACKET_SIZE - 1);
+    return RF_DUAL_PACKET_SIZE;
+}
+
+bool rf_dual_is_packet(const uint8_t *pkt, uint8_t len)
+{
+    return (len >= RF_DUAL_PACKET_SIZE && pkt[0] == RF_DUAL_HEADER);
+}
+
+bool rf_dual_parse_packet(const uint8_t *pkt, uint8_t len, rf_dual_parsed_t *out)
+{
+    if (!rf_dual_is_packet(pkt, len)) return false;
+    if (hal_crc8(pkt, RF_DUAL_PACKET_SIZE - 1) != pkt[RF_DUAL_PACKET_SIZE - 1]) return false;
+    
+    out->tracker_id = pkt[1];
+    out->sequence = pkt[2];
+    out->battery_pct = pkt[3];
+    out->flags = pkt[4];
+    out->accel_z_mg = (int16_t)(pkt[5] | (pkt[6] << 8));
+    
+    for (int k = 0; k < 2; k++) {
+        const uint8_t *p = &pkt[DUAL_AGE_OFFSET(k)];
+        out->age_us[k] = p[0] * RF_MULTI_TICK_US;
+        rf_v2_quat_unpack40(&p[1], out->quat[k]);
+    }
+    
+    return true;
+}
+#endif /* USE_AUX_IMU */
+
 /*============================================================================
  * 性能统计 / Performance Statistics
  *============================================================================*/
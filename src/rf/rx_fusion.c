@@ -0,0 +1,199 @@
+/**
+ * @file rx_fusion.c
+ * @brief 接收端传感器融合 / Receiver-side sensor fusion
+ *
+ * v0.6.3: 每 tracker 一个 vqf_fixed 实例 + 待融合样本 FIFO
+ *   gyro  Q24 rad/s = mrad/s × 16777.216
+ *   accel Q16 g     = mg × 65.536
+ * 解码和调度都在主循环中, 不需要关中断
+ *
+ * 调度: 每轮从每个有待融合样本的 tracker 取一个样本, 一次
+ * vqf_fixed_update_batch_q 更新全部实例; 补足步数的样本留在 FIFO 头,
+ * 下一轮再走一步, 不会让单个 tracker 占满一轮
+ */
+
+#include "rx_fusion.h"
+#include "rf_ultra.h"
+#include "vqf_fixed.h"
+#include "config.h"
+#include <string.h>
+
+#if defined(USE_FUSION_OFFLOAD) && USE_FUSION_OFFLOAD
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef struct {
+    int16_t gyro[3];
+    int16_t accel[3];
+    uint32_t t_us;
+    uint8_t steps;          // 距上一个样本的步数 (1 = 连续)
+} fusion_sample_t;
+
+typedef struct {
+    vqf_fixed_state_t vqf;
+    fusion_sample_t fifo[RX_FUSION_FIFO];
+    uint8_t head;
+    uint8_t tail;
+    uint8_t next_index;     // 期望的下一个样本序号
+    bool synced;            // 已收到首个样本
+    bool initialized;       // vqf 已初始化
+    rx_fusion_stats_t stats;
+} fusion_tracker_t;
+
+static fusion_tracker_t fusion[MAX_TRACKERS] RAM_ARENA(rx_fusion);
+static uint8_t rr_next = 0;     // 轮转起点
+
+// 每轮批量更新的输入 (主循环专用, 避免占用栈)
+static vqf_fixed_state_t *batch_state[MAX_TRACKERS] RAM_ARENA(rx_fusion);
+static int32_t batch_gyro[MAX_TRACKERS][3] RAM_ARENA(rx_fusion);
+static int32_t batch_accel[MAX_TRACKERS][3] RAM_ARENA(rx_fusion);
+static uint8_t batch_id[MAX_TRACKERS] RAM_ARENA(rx_fusion);
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+static void to_q24_gyro(const int16_t in[3], int32_t out[3])
+{
+    for (int i = 0; i < 3; i++) {
+        int32_t v = in[i];
+        out[i] = v * 16777 + (v * 216) / 1000;
+    }
+}
+
+static void to_q16_accel(const int16_t in[3], int32_t out[3])
+{
+    for (int i = 0; i < 3; i++) {
+        int32_t v = in[i];
+        out[i] = v * 65 + (v * 536) / 1000;
+    }
+}
+
+static void quat_q30_to_q15(const int32_t in[4], int16_t out[4])
+{
+    for (int i = 0; i < 4; i++) {
+        int32_t v = in[i] >> 15;
+        if (v > 32767) v = 32767; else if (v < -32767) v = -32767;
+        out[i] = (int16_t)v;
+    }
+}
+
+// FIFO 头样本加入本轮批量, 返回批内序号
+static uint8_t batch_add(uint8_t n, uint8_t id)
+{
+    fusion_tracker_t *f = &fusion[id];
+    const fusion_sample_t *s = &f->fifo[f->tail & (RX_FUSION_FIFO - 1)];
+
+    if (!f->initialized) {
+        // 所有实例 dt/tau 相同, 批量更新共用增益
+        vqf_fixed_init(&f->vqf, 1.0f / RF_RAW_ODR_HZ, RX_FUSION_TAU_ACC, 0.0f);
+        f->initialized = true;
+    }
+    batch_state[n] = &f->vqf;
+    batch_id[n] = id;
+    to_q24_gyro(s->gyro, batch_gyro[n]);
+    to_q16_accel(s->accel, batch_accel[n]);
+    return n + 1;
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void rx_fusion_init(void)
+{
+    memset(fusion, 0, sizeof(fusion));
+    rr_next = 0;
+}
+
+void rx_fusion_reset(uint8_t id)
+{
+    if (id >= MAX_TRACKERS) return;
+    memset(&fusion[id], 0, sizeof(fusion_tracker_t));
+}
+
+int rx_fusion_push(uint8_t id, uint8_t index, const int16_t gyro[3],
+                   const int16_t accel[3], uint32_t t_us)
+{
+    if (id >= MAX_TRACKERS) return -2;
+    fusion_tracker_t *f = &fusion[id];
+
+    uint8_t steps = 1;
+    if (f->synced) {
+        int8_t ahead = (int8_t)(index - f->next_index);
+        if (ahead < 0 && ahead >= -RX_FUSION_MAX_HOLD) {
+            f->stats.duplicate++;
+            return 1;
+        }
+        // 缺失的步数用本样本补足; tracker 重启 (序号大幅跳变) 时只走一步
+        if (ahead >= 0 && ahead < RX_FUSION_MAX_HOLD) {
+            steps = (uint8_t)(ahead + 1);
+            f->stats.held += ahead;
+        }
+    }
+
+    if ((uint8_t)(f->head - f->tail) >= RX_FUSION_FIFO) {
+        // 不推进期望序号, 下一个样本按跳变补足
+        f->stats.overflow++;
+        return -1;
+    }
+
+    fusion_sample_t *s = &f->fifo[f->head & (RX_FUSION_FIFO - 1)];
+    memcpy(s->gyro, gyro, sizeof(s->gyro));
+    memcpy(s->accel, accel, sizeof(s->accel));
+    s->t_us = t_us;
+    s->steps = steps;
+    f->head++;
+
+    f->next_index = index + 1;
+    f->synced = true;
+    return 0;
+}
+
+uint16_t rx_fusion_process(rx_fusion_output_cb_t cb, uint16_t budget)
+{
+    uint16_t done = 0;
+
+    // 每轮每个 tracker 最多一步, 直到预算用完或全部清空
+    while (done < budget) {
+        uint8_t n = 0;
+        for (uint8_t k = 0; k < MAX_TRACKERS && done + n < budget; k++) {
+            uint8_t id = (uint8_t)((rr_next + k) % MAX_TRACKERS);
+            if (fusion[id].head != fusion[id].tail) n = batch_add(n, id);
+        }
+        if (n == 0) break;
+
+        vqf_fixed_update_batch_q(batch_state, (const int32_t (*)[3])batch_gyro,
+                                 (const int32_t (*)[3])batch_accel, n);
+        done += n;
+
+        for (uint8_t i = 0; i < n; i++) {
+            fusion_tracker_t *f = &fusion[batch_id[i]];
+            fusion_sample_t *s = &f->fifo[f->tail & (RX_FUSION_FIFO - 1)];
+            f->stats.updates++;
+            if (--s->steps > 0) continue;
+
+            if (cb) {
+                int16_t q[4];
+                quat_q30_to_q15(f->vqf.quat, q);
+                cb(batch_id[i], q, s->t_us);
+            }
+            f->tail++;
+        }
+    }
+
+    // 下次从下一个 tracker 开始, 预算不足时不总是饿死同一批
+    rr_next = (uint8_t)((rr_next + 1) % MAX_TRACKERS);
+    return done;
+}
+
+bool rx_fusion_get_stats(uint8_t id, rx_fusion_stats_t *stats)
+{
+    if (id >= MAX_TRACKERS || !fusion[id].synced) return false;
+    *stats = fusion[id].stats;
+    return true;
+}
+
+#endif /* USE_FUSION_OFFLOAD */
@@ -0,0 +1,167 @@
+/**
+ * @file rx_predict.c
+ * @brief 接收端姿态预测 / Receiver-side orientation extrapolation
+ *
+ * v0.6.3:
+ *   dq    = conj(q_prev) ⊗ q_cur            机体系增量旋转
+ *   ω     ≈ 2 · vec(dq) / Δt                (5ms 间隔内小角度近似)
+ *   q(t)  = q_last ⊗ [1, ω·h/2] 归一化      h = 目标时刻 - 样本时刻
+ */
+
+#include "rx_predict.h"
+#include "config.h"
+#include "optimize.h"         // v0.6.3: RAM_ARENA
+#include <string.h>
+#include <math.h>
+
+/*============================================================================
+ * 配置
+ *============================================================================*/
+
+#define PREDICT_OMEGA_ALPHA     0.5f    // 角速度低通系数 (每样本)
+
+#ifndef RX_PREDICT_HORIZON_US
+#define RX_PREDICT_HORIZON_US   0
+#endif
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef struct {
+    float q[4];             // 最近样本
+    float omega[3];         // 机体角速度估计 [rad/us]
+    uint32_t t_us;          // 最近样本时刻
+    bool has_sample;
+    bool has_omega;
+} predict_state_t;
+
+static predict_state_t predict[MAX_TRACKERS] RAM_ARENA(rx_predict);
+static uint16_t horizon_us = RX_PREDICT_HORIZON_US;
+static bool predict_enabled = true;
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+static void quat_from_q15(const int16_t in[4], float out[4])
+{
+    for (int i = 0; i < 4; i++) {
+        out[i] = (float)in[i] * (1.0f / 32767.0f);
+    }
+}
+
+static void quat_to_q15(const float in[4], int16_t out[4])
+{
+    for (int i = 0; i < 4; i++) {
+        float v = in[i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        out[i] = (int16_t)(v * 32767.0f);
+    }
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void rx_predict_init(void)
+{
+    memset(predict, 0, sizeof(predict));
+}
+
+void rx_predict_reset(uint8_t id)
+{
+    if (id >= MAX_TRACKERS) return;
+    memset(&predict[id], 0, sizeof(predict_state_t));
+}
+
+void rx_predict_feed(uint8_t id, const int16_t quat[4], uint32_t t_us)
+{
+    if (id >= MAX_TRACKERS) return;
+    predict_state_t *p = &predict[id];
+
+    float q[4];
+    quat_from_q15(quat, q);
+
+    int32_t dt = (int32_t)(t_us - p->t_us);
+    if (p->has_sample && dt > 0 && dt < RX_PREDICT_MAX_GAP_US) {
+        // dq = conj(q_prev) ⊗ q
+        const float *a = p->q;
+        float dw =  a[0]*q[0] + a[1]*q[1] + a[2]*q[2] + a[3]*q[3];
+        float dx =  a[0]*q[1] - a[1]*q[0] - a[2]*q[3] + a[3]*q[2];
+        float dy =  a[0]*q[2] + a[1]*q[3] - a[2]*q[0] - a[3]*q[1];
+        float dz =  a[0]*q[3] - a[1]*q[2] + a[2]*q[1] - a[3]*q[0];
+
+        // q 与 -q 表示同一姿态, 取最短路径
+        float k = (dw < 0.0f ? -2.0f : 2.0f) / (float)dt;
+        float w[3] = { dx * k, dy * k, dz * k };
+
+        if (p->has_omega) {
+            for (int i = 0; i < 3; i++) {
+                p->omega[i] += PREDICT_OMEGA_ALPHA * (w[i] - p->omega[i]);
+            }
+        } else {
+            memcpy(p->omega, w, sizeof(w));
+            p->has_omega = true;
+        }
+    } else {
+        // 首个样本或间断 (离线/丢包过多): 重新估计
+        p->has_omega = false;
+    }
+
+    memcpy(p->q, q, sizeof(q));
+    p->t_us = t_us;
+    p->has_sample = true;
+}
+
+bool rx_predict_get(uint8_t id, uint32_t now_us, int16_t out[4], int32_t *dt_us)
+{
+    if (dt_us) *dt_us = 0;
+    if (id >= MAX_TRACKERS || !predict[id].has_sample) return false;
+    predict_state_t *p = &predict[id];
+
+    int32_t h = (int32_t)(now_us + horizon_us - p->t_us);
+    if (!predict_enabled || !p->has_omega || h <= 0 || h > RX_PREDICT_MAX_SPAN_US) {
+        quat_to_q15(p->q, out);
+        return true;
+    }
+
+    // q ⊗ [1, ω·h/2]
+    float hx = p->omega[0] * (float)h * 0.5f;
+    float hy = p->omega[1] * (float)h * 0.5f;
+    float hz = p->omega[2] * (float)h * 0.5f;
+    const float *a = p->q;
+    float r[4] = {
+        a[0]        - a[1] * hx - a[2] * hy - a[3] * hz,
+        a[0] * hx   + a[1]      + a[2] * hz - a[3] * hy,
+        a[0] * hy   - a[1] * hz + a[2]      + a[3] * hx,
+        a[0] * hz   + a[1] * hy - a[2] * hx + a[3]
+    };
+
+    float n = sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2] + r[3]*r[3]);
+    if (n < 1e-6f) {
+        quat_to_q15(p->q, out);
+        return true;
+    }
+    n = 1.0f / n;
+    for (int i = 0; i < 4; i++) r[i] *= n;
+
+    quat_to_q15(r, out);
+    if (dt_us) *dt_us = h;
+    return true;
+}
+
+void rx_predict_set_horizon_us(uint16_t us)
+{
+    horizon_us = (us > RX_PREDICT_MAX_HORIZON_US) ? RX_PREDICT_MAX_HORIZON_US : us;
+}
+
+uint16_t rx_predict_get_horizon_us(void)
+{
+    return horizon_us;
+}
+
+void rx_predict_enable(bool enable)
+{
+    predict_enabled = enable;
+}
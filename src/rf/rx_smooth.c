@@ -0,0 +1,177 @@
+/**
+ * @file rx_smooth.c
+ * @brief 接收端自适应姿态平滑 / Receiver-side One-Euro orientation smoothing
+ *
+ * v0.6.3:
+ *   dq    = conj(q̂) ⊗ q                     上次输出 → 新样本 (取最短路径)
+ *   h     = atan2(|vec(dq)|, w(dq))          半角
+ *   q̂'    = q̂ ⊗ [cos(αh), sin(αh)·vec(dq)/|vec(dq)|]   即 slerp(q̂, q, α)
+ */
+
+#include "rx_smooth.h"
+#include "config.h"
+#include "fast_math.h"
+#include "optimize.h"         // v0.6.3: RAM_ARENA
+#include <string.h>
+
+#if defined(USE_RX_SMOOTHING) && USE_RX_SMOOTHING
+
+/*============================================================================
+ * 配置
+ *============================================================================*/
+
+#ifndef RX_SMOOTH_MIN_CUTOFF_CHZ
+#define RX_SMOOTH_MIN_CUTOFF_CHZ    100
+#endif
+#ifndef RX_SMOOTH_BETA_CHZ
+#define RX_SMOOTH_BETA_CHZ          1000
+#endif
+#ifndef RX_SMOOTH_D_CUTOFF_CHZ
+#define RX_SMOOTH_D_CUTOFF_CHZ      100
+#endif
+
+#define TWO_PI_CHZ_US   (2.0f * FM_PI * 0.01f * 1e-6f)     // 2π · 0.01 Hz · 1 us
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef struct {
+    float q[4];             // 上次输出
+    float speed;            // 角速度估计 [rad/s]
+    uint32_t t_us;
+    bool has_sample;
+} smooth_state_t;
+
+static smooth_state_t smooth[MAX_TRACKERS] RAM_ARENA(rx_smooth);
+static rx_smooth_params_t params[MAX_TRACKERS];
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+/**
+ * @brief 一阶低通系数 α = r / (1 + r), r = 2π·fc·Δt
+ */
+static float lowpass_alpha(uint16_t cutoff_cHz, float dt_us)
+{
+    float r = TWO_PI_CHZ_US * (float)cutoff_cHz * dt_us;
+    return r / (1.0f + r);
+}
+
+static void restart(smooth_state_t *s, const int16_t quat[4], uint32_t t_us)
+{
+    for (int i = 0; i < 4; i++) {
+        s->q[i] = (float)quat[i] * (1.0f / 32767.0f);
+    }
+    s->speed = 0.0f;
+    s->t_us = t_us;
+    s->has_sample = true;
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void rx_smooth_init(void)
+{
+    memset(smooth, 0, sizeof(smooth));
+    for (uint8_t i = 0; i < MAX_TRACKERS; i++) {
+        params[i].enabled = true;
+        params[i].min_cutoff_cHz = RX_SMOOTH_MIN_CUTOFF_CHZ;
+        params[i].beta_cHz = RX_SMOOTH_BETA_CHZ;
+        params[i].d_cutoff_cHz = RX_SMOOTH_D_CUTOFF_CHZ;
+    }
+}
+
+void rx_smooth_reset(uint8_t id)
+{
+    if (id >= MAX_TRACKERS) return;
+    memset(&smooth[id], 0, sizeof(smooth_state_t));
+}
+
+void rx_smooth_apply(uint8_t id, int16_t quat[4], uint32_t t_us)
+{
+    if (id >= MAX_TRACKERS || !params[id].enabled) return;
+    smooth_state_t *s = &smooth[id];
+    const rx_smooth_params_t *p = &params[id];
+
+    int32_t dt = (int32_t)(t_us - s->t_us);
+    if (!s->has_sample || dt >= RX_SMOOTH_MAX_GAP_US) {
+        restart(s, quat, t_us);
+        return;
+    }
+    if (dt <= 0) dt = 1;        // 同一时刻的样本: 按极短间隔处理, 输出几乎不动
+
+    float q[4];
+    for (int i = 0; i < 4; i++) {
+        q[i] = (float)quat[i] * (1.0f / 32767.0f);
+    }
+
+    // dq = conj(q̂) ⊗ q
+    const float *a = s->q;
+    float dw =  a[0]*q[0] + a[1]*q[1] + a[2]*q[2] + a[3]*q[3];
+    float dx =  a[0]*q[1] - a[1]*q[0] - a[2]*q[3] + a[3]*q[2];
+    float dy =  a[0]*q[2] + a[1]*q[3] - a[2]*q[0] - a[3]*q[1];
+    float dz =  a[0]*q[3] - a[1]*q[2] + a[2]*q[1] - a[3]*q[0];
+    if (dw < 0.0f) {
+        dw = -dw; dx = -dx; dy = -dy; dz = -dz;
+    }
+    float vn = fm_sqrt(dx*dx + dy*dy + dz*dz);
+    float half = fm_atan2(vn, dw);
+
+    // 角速度低通, 截止频率随角速度升高
+    float fdt = (float)dt;
+    float speed = 2.0f * half / (fdt * 1e-6f);
+    s->speed += lowpass_alpha(p->d_cutoff_cHz, fdt) * (speed - s->speed);
+    float cutoff = (float)p->min_cutoff_cHz + (float)p->beta_cHz * s->speed;
+    float r = TWO_PI_CHZ_US * cutoff * fdt;
+    float alpha = r / (1.0f + r);
+
+    // q̂ ⊗ [cos(αh), sin(αh)·v̂]
+    if (vn > 1e-7f) {
+        float sn, cs;
+        fm_sincos_small(alpha * half, &sn, &cs);
+        float k = sn / vn;
+        float hx = dx * k, hy = dy * k, hz = dz * k;
+        float o[4] = {
+            a[0] * cs - a[1] * hx - a[2] * hy - a[3] * hz,
+            a[0] * hx + a[1] * cs + a[2] * hz - a[3] * hy,
+            a[0] * hy - a[1] * hz + a[2] * cs + a[3] * hx,
+            a[0] * hz + a[1] * hy - a[2] * hx + a[3] * cs
+        };
+        float n = fm_inv_sqrt(o[0]*o[0] + o[1]*o[1] + o[2]*o[2] + o[3]*o[3]);
+        for (int i = 0; i < 4; i++) s->q[i] = o[i] * n;
+    }
+    s->t_us = t_us;
+
+    for (int i = 0; i < 4; i++) {
+        float v = s->q[i];
+        if (v > 1.0f) v = 1.0f; else if (v < -1.0f) v = -1.0f;
+        quat[i] = (int16_t)(v * 32767.0f);
+    }
+}
+
+int rx_smooth_set(uint8_t id, const rx_smooth_params_t *p)
+{
+    if (id == RX_SMOOTH_ALL) {
+        for (uint8_t i = 0; i < MAX_TRACKERS; i++) {
+            params[i] = *p;
+        }
+        memset(smooth, 0, sizeof(smooth));
+        return 0;
+    }
+    if (id >= MAX_TRACKERS) return -1;
+    params[id] = *p;
+    rx_smooth_reset(id);
+    return 0;
+}
+
+bool rx_smooth_get(uint8_t id, rx_smooth_params_t *p)
+{
+    if (id >= MAX_TRACKERS) return false;
+    *p = params[id];
+    return true;
+}
+
+#endif /* USE_RX_SMOOTHING */
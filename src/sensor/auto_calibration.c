@@ -5,11 +5,12 @@
  * 功能:
  * 1. 静止检测 + 陀螺仪偏移校准
  * 2. 运动中漂移补偿
- * 3. 加速度计校准
+ * 3. 加速度计校准 (v0.6.3: 静止姿态在线椭球拟合, 偏置 + 每轴缩放)
  * 4. 磁力计融合校准
  */
 
 #include "hal.h"
+#include "motion_state.h"
 #include <string.h>
 #include <math.h>
 
@@ -17,13 +18,28 @@
  * 配置
  *============================================================================*/
 
-#define GYRO_STILL_THRESHOLD    0.02f   // rad/s
-#define ACCEL_STILL_THRESHOLD   0.3f    // m/s^2 偏离 1g
+// v0.6.3: 静止判定来自共享 motion_state (阈值见 motion_state.h)
 #define STILL_TIME_MS           1000    // 静止判定时间
 
 #define GYRO_OFFSET_ALPHA       0.001f  // 偏移更新率
 #define GYRO_DRIFT_ALPHA        0.0001f // 漂移补偿率
-#define ACCEL_SCALE_ALPHA       0.01f   // 加速度缩放率
+
+// v0.6.3: 加速度计椭球校准
+#define ACC_POSE_MAX            12
+#define ACC_POSE_SAMPLES        100     // 每个姿态平均的样本数 (0.5s @200Hz)
+#define ACC_POSE_MIN_COS        0.906f  // 与已有姿态相差 25° 以上才算新姿态
+#define ACC_POSE_WEIGHT_MAX     8       // 重复姿态的平均权重上限
+#define ACC_MIN_POSES           6
+#define ACC_MIN_SPAN            1.2f    // 每轴姿态分量跨度 (g), 偏置和缩放才可分离
+#define ACC_LM_LAMBDA           1e-3f   // Levenberg-Marquardt 阻尼
+#define ACC_MAX_ITER            8
+#define ACC_CONVERGE_EPS        1e-10f  // 参数步长平方和
+#define ACC_RMS_MAX             0.02f   // 接受解的残差 RMS (g)
+#define ACC_BIAS_MAX            0.2f    // g
+#define ACC_SCALE_MIN           0.9f
+#define ACC_SCALE_MAX           1.1f
+#define ACC_SAVE_DELTA          0.002f  // 变化超过该值才重新写 Flash
+#define ACC_CALIB_MAGIC         0x31434341  // "ACC1"
 
 #define MAG_HEADING_THRESHOLD   30.0f   // 航向偏差阈值 (度)
 #define MAG_CORRECTION_ALPHA    0.005f  // 磁力计修正率
@@ -32,6 +48,43 @@
  * 校准状态
  *============================================================================*/
 
+typedef enum {
+    ACC_SOLVE_IDLE = 0,
+    ACC_SOLVE_ACCUM,    // 每步累加一个姿态的法方程
+    ACC_SOLVE_ELIM,     // 每步消元一列
+    ACC_SOLVE_BACK      // 回代 + 更新参数
+} acc_solve_step_t;
+
+typedef struct {
+    // 姿态表 (未校准的静止平均值, g)
+    float pose[ACC_POSE_MAX][3];
+    uint8_t weight[ACC_POSE_MAX];
+    uint8_t pose_count;
+    uint8_t pose_next;          // 表满时轮转替换
+    float sum[3];
+    uint16_t sum_count;
+    bool dirty;                 // 姿态表变化, 需要重新求解
+    
+    // 分步求解器: 参数 p = [b0 b1 b2 s0 s1 s2], a_cal = (a - b) ∘ s
+    acc_solve_step_t step;
+    uint8_t k;
+    uint8_t iter;
+    float p[6];
+    float ne[6][7];             // 增广法方程 [JᵀJ + λ·diag | -Jᵀr]
+    float sse;
+    
+    // 生效的校准
+    float bias[3];
+    float scale[3];
+    bool valid;
+} accel_calib_t;
+
+typedef struct {
+    uint32_t magic;
+    float bias[3];
+    float scale[3];
+} accel_calib_store_t;
+
 typedef struct {
     // 陀螺仪偏移
     float gyro_offset[3];
@@ -43,8 +96,8 @@ typedef struct {
     float gyro_drift_accum[3];
     uint32_t last_drift_ms;
     
-    // 加速度缩放
-    float accel_scale[3];
+    // 加速度计校准
+    accel_calib_t acc;
     
     // 磁力计
     bool mag_enabled;
@@ -52,10 +105,8 @@ typedef struct {
     float mag_heading_offset;
     float mag_hard_iron[3];
     
-    // 静止检测
+    // 静止检测 (motion_state 的快照)
     bool is_still;
-    uint32_t still_start_ms;
-    float gyro_variance;
     
     // 校准状态
     bool calibration_valid;
@@ -72,10 +123,18 @@ void auto_calib_init(void)
 {
     memset(&ac, 0, sizeof(ac));
     
-    // 默认缩放
-    ac.accel_scale[0] = 1.0f;
-    ac.accel_scale[1] = 1.0f;
-    ac.accel_scale[2] = 1.0f;
+    // 默认缩放, 已保存的椭球校准优先
+    ac.acc.scale[0] = 1.0f;
+    ac.acc.scale[1] = 1.0f;
+    ac.acc.scale[2] = 1.0f;
+    
+    accel_calib_store_t st;
+    if (hal_kv_get(HAL_KV_ACCEL_CALIB, &st, sizeof(st)) == (int)sizeof(st) &&
+        st.magic == ACC_CALIB_MAGIC) {
+        memcpy(ac.acc.bias, st.bias, sizeof(st.bias));
+        memcpy(ac.acc.scale, st.scale, sizeof(st.scale));
+        ac.acc.valid = true;
+    }
     
     ac.last_drift_ms = hal_get_tick_ms();
 }
@@ -84,28 +143,10 @@ void auto_calib_init(void)
  * 静止检测
  *============================================================================*/
 
-static void update_still_detection(const float gyro[3], const float accel[3])
+// v0.6.3: 只读取共享 motion_state (本样本已由 motion_state_update 更新)
+static void update_still_detection(void)
 {
-    // 陀螺仪幅值
-    float gyro_mag = sqrtf(gyro[0]*gyro[0] + gyro[1]*gyro[1] + gyro[2]*gyro[2]);
-    
-    // 加速度偏离 1g
-    float accel_mag = sqrtf(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
-    float accel_dev = fabsf(accel_mag - 9.81f);
-    
-    // 判断静止
-    bool currently_still = (gyro_mag < GYRO_STILL_THRESHOLD) && 
-                           (accel_dev < ACCEL_STILL_THRESHOLD);
-    
-    if (currently_still) {
-        if (!ac.is_still) {
-            ac.still_start_ms = hal_get_tick_ms();
-            ac.is_still = true;
-        }
-        ac.gyro_variance = ac.gyro_variance * 0.9f + gyro_mag * 0.1f;
-    } else {
-        ac.is_still = false;
-    }
+    ac.is_still = motion_state_is_still();
 }
 
 /*============================================================================
@@ -114,9 +155,7 @@ static void update_still_detection(const float gyro[3], const float accel[3])
 
 static void calibrate_gyro_offset(const float gyro[3])
 {
-    uint32_t still_duration = hal_get_tick_ms() - ac.still_start_ms;
-    
-    if (still_duration > STILL_TIME_MS) {
+    if (motion_state_still_ms() > STILL_TIME_MS) {
         // 累积样本
         ac.gyro_offset_accum[0] += gyro[0];
         ac.gyro_offset_accum[1] += gyro[1];
@@ -171,24 +210,263 @@ static void compensate_gyro_drift(float gyro[3])
 }
 
 /*============================================================================
- * 加速度缩放校准
+ * v0.6.3: 加速度计在线椭球校准
+ *
+ * 静止 (motion_state) 超过 STILL_TIME_MS 后平均 ACC_POSE_SAMPLES 个样本作为一个姿态,
+ * 与已有姿态方向相近时并入该姿态; 模型 a_cal = (a - b) ∘ s, 目标 |a_cal| = 1g
+ * 求解在主循环空闲时由 auto_calib_process 分步执行 (每次一个姿态或一列消元),
+ * 样本路径上只有累加和一次乘减
  *============================================================================*/
 
-static void calibrate_accel_scale(const float accel[3])
+static float vec3_dot(const float a[3], const float b[3])
 {
-    if (!ac.is_still) return;
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+static void accel_pose_add(const float m[3])
+{
+    accel_calib_t *c = &ac.acc;
+    float n2 = vec3_dot(m, m);
+    if (n2 < 0.64f || n2 > 1.44f) return;     // 不是静止重力 (0.8-1.2g)
     
-    uint32_t still_duration = hal_get_tick_ms() - ac.still_start_ms;
-    if (still_duration < STILL_TIME_MS * 2) return;
+    for (uint8_t j = 0; j < c->pose_count; j++) {
+        float d = vec3_dot(c->pose[j], m);
+        float pn2 = vec3_dot(c->pose[j], c->pose[j]);
+        // cos 比较用平方, 只看同向
+        if (d > 0.0f && d * d > ACC_POSE_MIN_COS * ACC_POSE_MIN_COS * n2 * pn2) {
+            float w = c->weight[j];
+            for (int i = 0; i < 3; i++) {
+                c->pose[j][i] = (c->pose[j][i] * w + m[i]) / (w + 1.0f);
+            }
+            if (c->weight[j] < ACC_POSE_WEIGHT_MAX) c->weight[j]++;
+            c->dirty = true;
+            return;
+        }
+    }
+    
+    uint8_t j;
+    if (c->pose_count < ACC_POSE_MAX) {
+        j = c->pose_count++;
+    } else {
+        j = c->pose_next;
+        c->pose_next = (uint8_t)((c->pose_next + 1) % ACC_POSE_MAX);
+    }
+    memcpy(c->pose[j], m, sizeof(c->pose[j]));
+    c->weight[j] = 1;
+    c->dirty = true;
+}
+
+// 样本路径: 只累加未校准的加速度
+static void accel_pose_capture(const float accel[3])
+{
+    accel_calib_t *c = &ac.acc;
     
-    float accel_mag = sqrtf(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
+    if (!ac.is_still || motion_state_still_ms() <= STILL_TIME_MS) {
+        c->sum_count = 0;
+        memset(c->sum, 0, sizeof(c->sum));
+        return;
+    }
     
-    if (accel_mag > 8.0f && accel_mag < 12.0f) {
-        float scale = 9.81f / accel_mag;
-        for (int i = 0; i < 3; i++) {
-            ac.accel_scale[i] += (scale - ac.accel_scale[i]) * ACCEL_SCALE_ALPHA;
+    c->sum[0] += accel[0];
+    c->sum[1] += accel[1];
+    c->sum[2] += accel[2];
+    if (++c->sum_count >= ACC_POSE_SAMPLES) {
+        float m[3] = {
+            c->sum[0] / c->sum_count,
+            c->sum[1] / c->sum_count,
+            c->sum[2] / c->sum_count
+        };
+        accel_pose_add(m);
+        c->sum_count = 0;
+        memset(c->sum, 0, sizeof(c->sum));
+    }
+}
+
+// 姿态数量和每轴跨度足够时偏置与缩放才可分离
+static bool accel_poses_observable(void)
+{
+    const accel_calib_t *c = &ac.acc;
+    if (c->pose_count < ACC_MIN_POSES) return false;
+    
+    for (int i = 0; i < 3; i++) {
+        float lo = c->pose[0][i], hi = lo;
+        for (uint8_t j = 1; j < c->pose_count; j++) {
+            if (c->pose[j][i] < lo) lo = c->pose[j][i];
+            if (c->pose[j][i] > hi) hi = c->pose[j][i];
         }
+        if (hi - lo < ACC_MIN_SPAN) return false;
     }
+    return true;
+}
+
+static void accel_solve_begin_iter(void)
+{
+    accel_calib_t *c = &ac.acc;
+    memset(c->ne, 0, sizeof(c->ne));
+    c->sse = 0.0f;
+    c->k = 0;
+    c->step = ACC_SOLVE_ACCUM;
+}
+
+static void accel_solve_finish(void)
+{
+    accel_calib_t *c = &ac.acc;
+    c->step = ACC_SOLVE_IDLE;
+    
+    if (c->sse > ACC_RMS_MAX * ACC_RMS_MAX * c->pose_count) return;
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(c->p[i]) > ACC_BIAS_MAX) return;
+        if (c->p[3 + i] < ACC_SCALE_MIN || c->p[3 + i] > ACC_SCALE_MAX) return;
+    }
+    
+    // 同一姿态重复采集会反复求解, 只有明显变化才写 Flash
+    bool changed = !c->valid;
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(c->p[i] - c->bias[i]) > ACC_SAVE_DELTA ||
+            fabsf(c->p[3 + i] - c->scale[i]) > ACC_SAVE_DELTA) {
+            changed = true;
+        }
+    }
+    
+    memcpy(c->bias, &c->p[0], sizeof(c->bias));
+    memcpy(c->scale, &c->p[3], sizeof(c->scale));
+    c->valid = true;
+    if (!changed) return;
+    
+    // 运行中保存, 后台写入
+    accel_calib_store_t st;
+    st.magic = ACC_CALIB_MAGIC;
+    memcpy(st.bias, c->bias, sizeof(st.bias));
+    memcpy(st.scale, c->scale, sizeof(st.scale));
+    hal_kv_set_deferred(HAL_KV_ACCEL_CALIB, &st, sizeof(st));
+}
+
+// 累加一个姿态: r = |(x - b) ∘ s| - 1
+static void accel_solve_accum(void)
+{
+    accel_calib_t *c = &ac.acc;
+    const float *x = c->pose[c->k];
+    float d[3], cal[3], J[6];
+    
+    for (int i = 0; i < 3; i++) {
+        d[i] = x[i] - c->p[i];
+        cal[i] = d[i] * c->p[3 + i];
+    }
+    float n = sqrtf(vec3_dot(cal, cal));
+    if (n < 1e-3f) n = 1e-3f;
+    float r = n - 1.0f;
+    
+    for (int i = 0; i < 3; i++) {
+        J[i] = -cal[i] * c->p[3 + i] / n;     // ∂r/∂b_i
+        J[3 + i] = cal[i] * d[i] / n;         // ∂r/∂s_i
+    }
+    for (int row = 0; row < 6; row++) {
+        for (int col = row; col < 6; col++) {
+            c->ne[row][col] += J[row] * J[col];
+        }
+        c->ne[row][6] -= J[row] * r;
+    }
+    c->sse += r * r;
+    
+    if (++c->k >= c->pose_count) {
+        // 补全对称下三角, 加阻尼
+        for (int row = 0; row < 6; row++) {
+            for (int col = 0; col < row; col++) {
+                c->ne[row][col] = c->ne[col][row];
+            }
+            c->ne[row][row] += ACC_LM_LAMBDA * c->ne[row][row] + 1e-9f;
+        }
+        c->k = 0;
+        c->step = ACC_SOLVE_ELIM;
+    }
+}
+
+// 消元一列 (列主元)
+static void accel_solve_elim(void)
+{
+    accel_calib_t *c = &ac.acc;
+    uint8_t k = c->k;
+    
+    uint8_t piv = k;
+    for (uint8_t row = k + 1; row < 6; row++) {
+        if (fabsf(c->ne[row][k]) > fabsf(c->ne[piv][k])) piv = row;
+    }
+    if (fabsf(c->ne[piv][k]) < 1e-12f) {
+        c->step = ACC_SOLVE_IDLE;   // 病态, 等待更多姿态
+        return;
+    }
+    if (piv != k) {
+        float tmp[7];
+        memcpy(tmp, c->ne[k], sizeof(tmp));
+        memcpy(c->ne[k], c->ne[piv], sizeof(tmp));
+        memcpy(c->ne[piv], tmp, sizeof(tmp));
+    }
+    for (uint8_t row = k + 1; row < 6; row++) {
+        float f = c->ne[row][k] / c->ne[k][k];
+        for (uint8_t col = k; col < 7; col++) {
+            c->ne[row][col] -= f * c->ne[k][col];
+        }
+    }
+    
+    if (++c->k >= 6) c->step = ACC_SOLVE_BACK;
+}
+
+static void accel_solve_back(void)
+{
+    accel_calib_t *c = &ac.acc;
+    float delta[6];
+    float step2 = 0.0f;
+    
+    for (int row = 5; row >= 0; row--) {
+        float v = c->ne[row][6];
+        for (int col = row + 1; col < 6; col++) {
+            v -= c->ne[row][col] * delta[col];
+        }
+        delta[row] = v / c->ne[row][row];
+        step2 += delta[row] * delta[row];
+    }
+    for (int i = 0; i < 6; i++) {
+        c->p[i] += delta[i];
+    }
+    
+    if (step2 < ACC_CONVERGE_EPS || ++c->iter >= ACC_MAX_ITER) {
+        accel_solve_finish();
+    } else {
+        accel_solve_begin_iter();
+    }
+}
+
+void auto_calib_process(void)
+{
+    accel_calib_t *c = &ac.acc;
+    
+    switch (c->step) {
+        case ACC_SOLVE_IDLE:
+            if (!c->dirty || !accel_poses_observable()) return;
+            c->dirty = false;
+            // 从当前校准出发, 姿态表更新后通常 1-2 次迭代收敛
+            memcpy(&c->p[0], c->bias, sizeof(c->bias));
+            memcpy(&c->p[3], c->scale, sizeof(c->scale));
+            c->iter = 0;
+            accel_solve_begin_iter();
+            break;
+        case ACC_SOLVE_ACCUM:
+            accel_solve_accum();
+            break;
+        case ACC_SOLVE_ELIM:
+            accel_solve_elim();
+            break;
+        case ACC_SOLVE_BACK:
+            accel_solve_back();
+            break;
+    }
+}
+
+bool auto_calib_get_accel_calib(float bias[3], float scale[3])
+{
+    memcpy(bias, ac.acc.bias, sizeof(ac.acc.bias));
+    memcpy(scale, ac.acc.scale, sizeof(ac.acc.scale));
+    return ac.acc.valid;
 }
 
 /*============================================================================
@@ -234,26 +512,28 @@ bool auto_calib_should_use_mag(float imu_heading, float mag_heading)
 void auto_calib_update(float gyro[3], float accel[3])
 {
     // 静止检测
-    update_still_detection(gyro, accel);
+    update_still_detection();
     
     // 应用偏移
     gyro[0] -= ac.gyro_offset[0];
     gyro[1] -= ac.gyro_offset[1];
     gyro[2] -= ac.gyro_offset[2];
     
-    // 静止校准
+    // 静止校准 (加速度姿态在应用校准之前采集)
     if (ac.is_still) {
         calibrate_gyro_offset(gyro);
-        calibrate_accel_scale(accel);
     }
+    accel_pose_capture(accel);
     
     // 漂移补偿
     compensate_gyro_drift(gyro);
     
-    // 应用加速度缩放
-    accel[0] *= ac.accel_scale[0];
-    accel[1] *= ac.accel_scale[1];
-    accel[2] *= ac.accel_scale[2];
+    // 应用加速度校准
+    if (ac.acc.valid) {
+        accel[0] = (accel[0] - ac.acc.bias[0]) * ac.acc.scale[0];
+        accel[1] = (accel[1] - ac.acc.bias[1]) * ac.acc.scale[1];
+        accel[2] = (accel[2] - ac.acc.bias[2]) * ac.acc.scale[2];
+    }
 }
 
 /*============================================================================
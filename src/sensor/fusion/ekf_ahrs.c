@@ -19,6 +19,7 @@
  */
 
 #include "ekf_ahrs.h"
+#include "fast_math.h"
 #include <string.h>
 #include <math.h>
 
@@ -42,25 +43,10 @@
  * 辅助函数 / Helper Functions
  *============================================================================*/
 
-// 快速平方根倒数 / Fast inverse square root
-// 注意: 输入必须 > 0，否则结果未定义
-static inline float inv_sqrt(float x)
-{
-    // 防止除零和负数
-    if (x < 1e-10f) return 1000.0f;  // 返回一个大的值避免INF
-    
-    float halfx = 0.5f * x;
-    int i = *(int*)&x;
-    i = 0x5f3759df - (i >> 1);
-    float y = *(float*)&i;
-    y = y * (1.5f - (halfx * y * y));
-    return y;
-}
-
 // 四元数归一化 / Quaternion normalization
 static void ekf_quat_normalize(float q[4])
 {
-    float inv_norm = inv_sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    float inv_norm = fm_inv_sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
     q[0] *= inv_norm;
     q[1] *= inv_norm;
     q[2] *= inv_norm;
@@ -156,7 +142,7 @@ static void ekf_predict(ekf_ahrs_state_t *ekf, const float gyro[3])
     ekf->q[1] += dq1;
     ekf->q[2] += dq2;
     ekf->q[3] += dq3;
-    ekf_quat_normalize(ekf->q);
+    fm_quat_renorm(ekf->q);
     
     // 更新协方差 (简化对角模型)
     // Update covariance (simplified diagonal model)
@@ -179,7 +165,7 @@ static void ekf_predict(ekf_ahrs_state_t *ekf, const float gyro[3])
 static void ekf_update_acc(ekf_ahrs_state_t *ekf, const float accel[3])
 {
     // 归一化加速度 / Normalize acceleration
-    float acc_norm = inv_sqrt(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
+    float acc_norm = fm_inv_sqrt(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
     float ax = accel[0] * acc_norm;
     float ay = accel[1] * acc_norm;
     float az = accel[2] * acc_norm;
@@ -226,7 +212,7 @@ static void ekf_update_acc(ekf_ahrs_state_t *ekf, const float accel[3])
     ekf->q[1] += dq1;
     ekf->q[2] += dq2;
     ekf->q[3] += dq3;
-    ekf_quat_normalize(ekf->q);
+    fm_quat_renorm(ekf->q);
     
     // 偏差更新 (缓慢) / Bias update (slow)
     float bias_K = K * 0.01f;
@@ -268,7 +254,7 @@ void ekf_ahrs_update(ekf_ahrs_state_t *ekf,
         
         // 检查磁力计数据有效性 (25-65 μT 正常地磁场范围)
         if (mag_norm_sq > 625.0f && mag_norm_sq < 4225.0f) {
-            float mag_inv = inv_sqrt(mag_norm_sq);
+            float mag_inv = fm_inv_sqrt(mag_norm_sq);
             mx *= mag_inv;
             my *= mag_inv;
             mz *= mag_inv;
@@ -287,7 +273,7 @@ void ekf_ahrs_update(ekf_ahrs_state_t *ekf,
                      + mz * 2.0f * (q2*q3 - q0*q1);
             
             // 参考磁场方向 (假设北方)
-            float bx = sqrtf(hx*hx + hy*hy);  // 水平分量
+            float bx = fm_sqrt(hx*hx + hy*hy);  // 水平分量
             // float bz = mx * 2.0f * (q1*q3 - q0*q2) + my * 2.0f * (q2*q3 + q0*q1) 
             //          + mz * (q0*q0 - q1*q1 - q2*q2 + q3*q3);  // 垂直分量 (未使用)
             
@@ -295,7 +281,8 @@ void ekf_ahrs_update(ekf_ahrs_state_t *ekf,
             // 预期: 磁场指向北方 (bx, 0, bz)
             // 测量: 当前朝向 (hx, hy, hz)
             // 仅修正航向 (yaw), 使用 hy 作为误差信号
-            float mag_error = hy;  // 如果正确对准北方, hy 应为 0
+            // v0.6.3: 除以水平分量得到 sin(航向误差), 与倾角无关; 垂直磁场不修正
+            float mag_error = (bx > 0.1f) ? hy / bx : 0.0f;  // 如果正确对准北方, hy 应为 0
             
             // 限制误差幅度
             if (mag_error > 0.3f) mag_error = 0.3f;
@@ -305,18 +292,20 @@ void ekf_ahrs_update(ekf_ahrs_state_t *ekf,
             const float MAG_GAIN = 0.01f;
             
             // 仅修正 z 轴旋转 (航向)
-            // 误差转换为四元数修正: 绕 z 轴
+            // 误差转换为四元数修正: 绕世界系 z 轴
+            // v0.6.3: 原先 q = q * dq 绕机体 z 轴且符号为正反馈, 9 轴时航向发散到 180°;
+            //         改为与 vqf_advanced 相同的 q = dq * q, 转动 -误差
             float dq_w = 1.0f;
-            float dq_z = mag_error * MAG_GAIN * 0.5f;
+            float dq_z = -mag_error * MAG_GAIN * 0.5f;
             
-            // 应用修正: q = q * dq
+            // 应用修正: q = dq * q
             float new_q0 = q0 * dq_w - q3 * dq_z;
-            float new_q1 = q1 * dq_w + q2 * dq_z;
-            float new_q2 = q2 * dq_w - q1 * dq_z;
+            float new_q1 = q1 * dq_w - q2 * dq_z;
+            float new_q2 = q2 * dq_w + q1 * dq_z;
             float new_q3 = q3 * dq_w + q0 * dq_z;
             
             // 归一化
-            float norm = inv_sqrt(new_q0*new_q0 + new_q1*new_q1 + new_q2*new_q2 + new_q3*new_q3);
+            float norm = fm_inv_sqrt(new_q0*new_q0 + new_q1*new_q1 + new_q2*new_q2 + new_q3*new_q3);
             ekf->q[0] = new_q0 * norm;
             ekf->q[1] = new_q1 * norm;
             ekf->q[2] = new_q2 * norm;
@@ -348,18 +337,18 @@ void ekf_ahrs_get_euler(const ekf_ahrs_state_t *ekf, float *roll, float *pitch,
     // Roll (x-axis rotation)
     float sinr = 2.0f * (q0*q1 + q2*q3);
     float cosr = 1.0f - 2.0f * (q1*q1 + q2*q2);
-    *roll = atan2f(sinr, cosr) * 57.2957795f;
+    *roll = fm_atan2(sinr, cosr) * 57.2957795f;
     
     // Pitch (y-axis rotation)
     float sinp = 2.0f * (q0*q2 - q3*q1);
     if (sinp > 1.0f) sinp = 1.0f;
     if (sinp < -1.0f) sinp = -1.0f;
-    *pitch = asinf(sinp) * 57.2957795f;
+    *pitch = fm_asin(sinp) * 57.2957795f;
     
     // Yaw (z-axis rotation)
     float siny = 2.0f * (q0*q3 + q1*q2);
     float cosy = 1.0f - 2.0f * (q2*q2 + q3*q3);
-    *yaw = atan2f(siny, cosy) * 57.2957795f;
+    *yaw = fm_atan2(siny, cosy) * 57.2957795f;
 }
 
 /**
@@ -372,6 +361,45 @@ void ekf_ahrs_get_bias(const ekf_ahrs_state_t *ekf, float bias[3])
     bias[2] = ekf->bias[2];
 }
 
+/**
+ * @brief v0.6.3: 导出检查点 / Save checkpoint
+ */
+void ekf_ahrs_save_checkpoint(const ekf_ahrs_state_t *ekf, fusion_checkpoint_t *ckpt)
+{
+    fusion_ckpt_header(ckpt, FUSION_EKF);
+    memcpy(ckpt->quat, ekf->q, sizeof(ckpt->quat));
+    memcpy(ckpt->gyro_bias, ekf->bias, sizeof(ckpt->gyro_bias));
+    memset(ckpt->acc_lp, 0, sizeof(ckpt->acc_lp));
+    memset(ckpt->mag_ref, 0, sizeof(ckpt->mag_ref));
+
+    float p = ekf->P[4];
+    if (ekf->P[5] > p) p = ekf->P[5];
+    if (ekf->P[6] > p) p = ekf->P[6];
+    ckpt->bias_sigma = fusion_ckpt_sigma(p);
+}
+
+/**
+ * @brief v0.6.3: 从检查点恢复 / Load checkpoint
+ */
+int ekf_ahrs_load_checkpoint(ekf_ahrs_state_t *ekf, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    float q[4];
+    memcpy(q, ckpt->quat, sizeof(q));
+    ekf_quat_normalize(q);
+    memcpy(ekf->q, q, sizeof(ekf->q));
+    memcpy(ekf->bias, ckpt->gyro_bias, sizeof(ekf->bias));
+
+    if (ckpt->bias_sigma > 0.0f) {
+        float p = ckpt->bias_sigma * ckpt->bias_sigma;
+        ekf->P[4] = p;
+        ekf->P[5] = p;
+        ekf->P[6] = p;
+    }
+    return 0;
+}
+
 /*============================================================================
  * 与 VQF 兼容的接口 / VQF-Compatible Interface
  *============================================================================*/
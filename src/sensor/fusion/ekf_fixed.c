@@ -0,0 +1,407 @@
+/**
+ * @file ekf_fixed.c
+ * @brief Fixed-Point Error-State EKF AHRS Implementation
+ *
+ * v0.6.3: 6 状态误差 EKF, Q30 整数运算 (见 ekf_fixed.h)
+ *
+ * 误差定义: q_true = q ⊗ [1, δθ/2], δb = b_true - b
+ * 误差动力学 (θ = (ω - b)·dt):
+ *   δθ' = (I - [θ×]) δθ - dt·δb
+ *   δb' = δb
+ * 加速度观测 (机体系重力方向 g = Rᵀ·e_z):
+ *   a ≈ g + [g×] δθ
+ *
+ * 与 ekf_ahrs.c 的差异: 协方差保留姿态/偏差全部相关项 (ekf_ahrs 只保留对角),
+ * 但上三角存储 + 稀疏观测行, 每次更新约 200 次 32x32→64 乘法和 3 次 64 位除法
+ */
+
+#include "ekf_fixed.h"
+#include "fx_math.h"
+#include "fast_math.h"
+#include <string.h>
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+// 加速度范数窗口, Q32 平方: 超出窄窗口时观测噪声 x10, 超出宽窗口不更新
+#define FX32_SQ(v)              ((int64_t)((v) * (v) * 4294967296.0))
+#define ACC_NORM2_MIN           FX32_SQ(0.5)
+#define ACC_NORM2_MAX           FX32_SQ(1.5)
+#define ACC_NORM2_STILL_MIN     FX32_SQ(0.9)
+#define ACC_NORM2_STILL_MAX     FX32_SQ(1.1)
+
+#define ACC_R_MOTION_SCALE      10      // 运动时 R 乘 10
+
+// 单行残差限幅: 大初始误差时限制线性化步长
+#define RESIDUAL_MAX            FX(0.5)
+
+// 协方差限幅: 偏航方向不可观, 对角元不超过 1 rad², 且不低于 1 LSB
+#define P_DIAG_MAX              FX(1.0)
+#define P_DIAG_MIN              1
+
+#define BIAS_MAX                FX(0.5)     // rad/s
+
+#define N_STATE                 6
+
+// 上三角下标 (i, j) → P[], 对称访问
+static const uint8_t P_IDX[N_STATE][N_STATE] = {
+    {  0,  1,  2,  3,  4,  5 },
+    {  1,  6,  7,  8,  9, 10 },
+    {  2,  7, 11, 12, 13, 14 },
+    {  3,  8, 12, 15, 16, 17 },
+    {  4,  9, 13, 16, 18, 19 },
+    {  5, 10, 14, 17, 19, 20 },
+};
+
+#define PE(i, j)                (state->P[P_IDX[i][j]])
+
+/*============================================================================
+ * Internal Functions
+ *============================================================================*/
+
+static FORCE_INLINE int32_t fx_clamp(int32_t x, int32_t lim)
+{
+    return (x > lim) ? lim : ((x < -lim) ? -lim : x);
+}
+
+// q ⊗ [1, v/2], v 为 Q30 rad (小角度)
+static FORCE_INLINE void quat_rotate_small(int32_t q[4], const int32_t v[3])
+{
+    int32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    int32_t hx = v[0] >> 1, hy = v[1] >> 1, hz = v[2] >> 1;
+
+    q[0] = q0 - fx_mul(q1, hx) - fx_mul(q2, hy) - fx_mul(q3, hz);
+    q[1] = q1 + fx_mul(q0, hx) + fx_mul(q2, hz) - fx_mul(q3, hy);
+    q[2] = q2 + fx_mul(q0, hy) - fx_mul(q1, hz) + fx_mul(q3, hx);
+    q[3] = q3 + fx_mul(q0, hz) + fx_mul(q1, hy) - fx_mul(q2, hx);
+
+    fx_quat_normalize(q);
+}
+
+static void reset_covariance(ekf_fixed_state_t *state)
+{
+    const float sb = EKF_FIXED_BIAS_SIGMA_INIT * (float)(1 << EKF_FIXED_BIAS_SHIFT);
+
+    memset(state->P, 0, sizeof(state->P));
+    for (int i = 0; i < 3; i++) {
+        PE(i, i) = FX(EKF_FIXED_ATT_SIGMA_INIT * EKF_FIXED_ATT_SIGMA_INIT);
+        PE(i + 3, i + 3) = (int32_t)(sb * sb * 1073741824.0f);
+    }
+}
+
+/*
+ * 预测: F = [[R, -c·I], [0, I]], R = I - [θ×]
+ *   P_aa' = R·P_aa·Rᵀ - c·(M + Mᵀ) + q_att·I     (M = R·P_ab, 省略 c²·P_bb)
+ *   P_ab' = M - c·P_bb
+ *   P_bb' = P_bb + q_bias·I
+ */
+// 名义状态传播: q ⊗ [1, θ/2], θ 累加到 th_acc 供协方差预测使用
+static FORCE_INLINE void propagate(ekf_fixed_state_t *state, const int32_t gyro[3], int32_t dt)
+{
+    int32_t th[3];
+    for (int i = 0; i < 3; i++) {
+        int32_t w = gyro[i] - (state->gyro_bias[i] >> 6);          // Q24
+        th[i] = (int32_t)(((int64_t)w * dt) >> 24);               // Q30
+        state->th_acc[i] += th[i];
+    }
+
+    quat_rotate_small(state->quat, th);
+}
+
+// v0.6.3: 协方差预测覆盖上次校正以来的全部传播 (θ = th_acc, 时长 = state->dt)
+static void predict(ekf_fixed_state_t *state)
+{
+    int32_t th[3] = { state->th_acc[0], state->th_acc[1], state->th_acc[2] };
+    state->th_acc[0] = state->th_acc[1] = state->th_acc[2] = 0;
+
+    const int32_t r[3][3] = {
+        {  FX_ONE,  th[2], -th[1] },
+        { -th[2],  FX_ONE,  th[0] },
+        {  th[1], -th[0],  FX_ONE },
+    };
+
+    // T = R·P_aa, M = R·P_ab (64 位累加)
+    int32_t t[3][3], m[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            int64_t sa = 0, sb = 0;
+            for (int k = 0; k < 3; k++) {
+                sa += (int64_t)r[i][k] * PE(k, j);
+                sb += (int64_t)r[i][k] * PE(k, j + 3);
+            }
+            t[i][j] = (int32_t)(sa >> FX_FRAC);
+            m[i][j] = (int32_t)(sb >> FX_FRAC);
+        }
+    }
+
+    const int32_t c = state->c_ab;
+
+    // P_ab' (在覆盖 P_bb 之前, 需要旧 P_bb)
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            PE(i, j + 3) = m[i][j] - fx_mul(c, PE(i + 3, j + 3));
+        }
+    }
+
+    // P_aa' 上三角
+    for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) {
+            int64_t s = 0;
+            for (int k = 0; k < 3; k++) {
+                s += (int64_t)t[i][k] * r[j][k];
+            }
+            PE(i, j) = (int32_t)(s >> FX_FRAC) - fx_mul(c, m[i][j] + m[j][i]);
+        }
+        PE(i, i) += state->q_att;
+        if (PE(i, i) > P_DIAG_MAX) PE(i, i) = P_DIAG_MAX;
+    }
+
+    for (int i = 3; i < N_STATE; i++) {
+        PE(i, i) += state->q_bias;
+    }
+}
+
+/*
+ * 单行标量更新, 观测行 h 只有 (j, hj) 和 (k, hk) 两个非零元素
+ * @param x 误差状态累加 (Q30)
+ * @param res 本行残差 (Q30)
+ */
+static void update_row(ekf_fixed_state_t *state, int32_t x[N_STATE], int32_t res,
+                       uint8_t j, int32_t hj, uint8_t k, int32_t hk, int32_t r_acc)
+{
+    int32_t ph[N_STATE];
+    for (int i = 0; i < N_STATE; i++) {
+        ph[i] = (int32_t)(((int64_t)PE(i, j) * hj + (int64_t)PE(i, k) * hk) >> FX_FRAC);
+    }
+
+    int64_t s = (((int64_t)ph[j] * hj + (int64_t)ph[k] * hk) >> FX_FRAC) + r_acc;
+    if (s <= 0) return;
+
+    // 1/s 用 Q24 (s >= r_acc, 1/s 不超过 1/R)
+    int32_t inv = (int32_t)(((int64_t)1 << 54) / s);
+
+    int32_t y = res - fx_mul(hj, x[j]) - fx_mul(hk, x[k]);
+    y = fx_clamp(y, RESIDUAL_MAX);
+
+    int32_t kg[N_STATE];
+    for (int i = 0; i < N_STATE; i++) {
+        int64_t g = ((int64_t)ph[i] * inv) >> 24;
+        kg[i] = (g > FX_ONE) ? FX_ONE : ((g < -FX_ONE) ? -FX_ONE : (int32_t)g);
+        x[i] += fx_mul(kg[i], y);
+    }
+
+    // P -= K·phᵀ (对称, 只更新上三角)
+    for (int a = 0; a < N_STATE; a++) {
+        for (int b = a; b < N_STATE; b++) {
+            PE(a, b) -= fx_mul(kg[a], ph[b]);
+        }
+        if (PE(a, a) < P_DIAG_MIN) PE(a, a) = P_DIAG_MIN;
+    }
+}
+
+static void update_accel(ekf_fixed_state_t *state, const int32_t accel[3])
+{
+    int64_t n2 = (int64_t)accel[0] * accel[0] + (int64_t)accel[1] * accel[1] +
+                 (int64_t)accel[2] * accel[2];                      // Q32
+
+    state->flags &= ~EKF_FIXED_FLAG_ACC_USED;
+    if (n2 < ACC_NORM2_MIN || n2 > ACC_NORM2_MAX) return;
+
+    int32_t r_acc = state->r_acc;
+    if (n2 < ACC_NORM2_STILL_MIN || n2 > ACC_NORM2_STILL_MAX) {
+        r_acc = (r_acc > INT32_MAX / ACC_R_MOTION_SCALE) ? INT32_MAX : r_acc * ACC_R_MOTION_SCALE;
+    }
+
+    int32_t a[3];
+    fx_vec3_unit_q16(accel, fx_isqrt64((uint64_t)n2), a);
+
+    // 机体系重力方向
+    int32_t q0 = state->quat[0], q1 = state->quat[1];
+    int32_t q2 = state->quat[2], q3 = state->quat[3];
+    int32_t gx = (fx_mul(q1, q3) - fx_mul(q0, q2)) << 1;
+    int32_t gy = (fx_mul(q0, q1) + fx_mul(q2, q3)) << 1;
+    int32_t gz = fx_mul(q0, q0) - fx_mul(q1, q1) - fx_mul(q2, q2) + fx_mul(q3, q3);
+
+    int32_t x[N_STATE] = { 0 };
+
+    // H = [g×]: 行 0 = (0, -gz, gy), 行 1 = (gz, 0, -gx), 行 2 = (-gy, gx, 0)
+    update_row(state, x, fx_clamp(a[0] - gx, RESIDUAL_MAX), 1, -gz, 2,  gy, r_acc);
+    update_row(state, x, fx_clamp(a[1] - gy, RESIDUAL_MAX), 0,  gz, 2, -gx, r_acc);
+    update_row(state, x, fx_clamp(a[2] - gz, RESIDUAL_MAX), 0, -gy, 1,  gx, r_acc);
+
+    // 注入误差状态
+    quat_rotate_small(state->quat, x);
+    for (int i = 0; i < 3; i++) {
+        int32_t b = state->gyro_bias[i] + (x[i + 3] >> EKF_FIXED_BIAS_SHIFT);
+        state->gyro_bias[i] = fx_clamp(b, BIAS_MAX);
+    }
+
+    state->flags |= EKF_FIXED_FLAG_ACC_USED;
+}
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+void ekf_fixed_init(ekf_fixed_state_t *state, float dt)
+{
+    memset(state, 0, sizeof(ekf_fixed_state_t));
+
+    state->quat[0] = FX_ONE;
+    ekf_fixed_set_dt(state, dt);
+
+    const float bs = (float)(1 << EKF_FIXED_BIAS_SHIFT);
+    state->q_att = (int32_t)(EKF_FIXED_GYRO_NOISE * EKF_FIXED_GYRO_NOISE * dt * 1073741824.0f);
+    state->q_bias = (int32_t)(EKF_FIXED_BIAS_NOISE * EKF_FIXED_BIAS_NOISE * dt * bs * bs *
+                              1073741824.0f);
+    state->r_acc = FX(EKF_FIXED_ACC_NOISE * EKF_FIXED_ACC_NOISE);
+    if (state->q_att < 1) state->q_att = 1;
+    if (state->q_bias < 1) state->q_bias = 1;
+
+    reset_covariance(state);
+    state->flags = EKF_FIXED_FLAG_INITIALIZED;
+}
+
+void NO_INLINE ekf_fixed_update_q(ekf_fixed_state_t *state, const int32_t gyro[3],
+                                  const int32_t accel[3])
+{
+    propagate(state, gyro, state->dt);
+    ekf_fixed_correct_q(state, accel);
+}
+
+void HOT ekf_fixed_propagate_q(ekf_fixed_state_t *state, const int32_t gyro[3], int32_t dt)
+{
+    propagate(state, gyro, dt);
+}
+
+void ekf_fixed_propagate_delta(ekf_fixed_state_t *state, const float dtheta[3], float dt)
+{
+    const float s = 1.0f / 1073741824.0f;
+    float phi[3], dqf[4];
+    for (int i = 0; i < 3; i++) {
+        phi[i] = dtheta[i] - state->gyro_bias[i] * s * dt;
+        state->th_acc[i] += (int32_t)(phi[i] * 1073741824.0f);
+    }
+    fm_rotvec_to_quat(phi, dqf);
+
+    int32_t dq[4], q[4];
+    for (int i = 0; i < 4; i++) {
+        dq[i] = (int32_t)(dqf[i] * 1073741823.0f);     // |dq[i]| <= 1
+    }
+    memcpy(q, state->quat, sizeof(q));
+    fx_quat_mul(q, dq, state->quat);
+    fx_quat_normalize(state->quat);
+}
+
+void ekf_fixed_correct_q(ekf_fixed_state_t *state, const int32_t accel[3])
+{
+    predict(state);
+    update_accel(state, accel);
+    state->sample_count++;
+}
+
+/*============================================================================
+ * Float Wrappers
+ *============================================================================*/
+
+static FORCE_INLINE void to_q(const float in[3], int32_t out[3], float scale)
+{
+    out[0] = (int32_t)(in[0] * scale);
+    out[1] = (int32_t)(in[1] * scale);
+    out[2] = (int32_t)(in[2] * scale);
+}
+
+void ekf_fixed_update(ekf_fixed_state_t *state, const float gyro[3], const float accel[3])
+{
+    int32_t g[3], a[3];
+    to_q(gyro, g, (float)(1L << EKF_FIXED_GYRO_FRAC));
+    to_q(accel, a, (float)(1L << EKF_FIXED_ACC_FRAC));
+    ekf_fixed_update_q(state, g, a);
+}
+
+void ekf_fixed_propagate(ekf_fixed_state_t *state, const float gyro[3], float dt)
+{
+    int32_t g[3];
+    to_q(gyro, g, (float)(1L << EKF_FIXED_GYRO_FRAC));
+    propagate(state, g, (int32_t)(dt * 1073741824.0f));
+}
+
+void ekf_fixed_correct(ekf_fixed_state_t *state, const float accel[3])
+{
+    int32_t a[3];
+    to_q(accel, a, (float)(1L << EKF_FIXED_ACC_FRAC));
+    ekf_fixed_correct_q(state, a);
+}
+
+void ekf_fixed_get_quat(const ekf_fixed_state_t *state, float quat[4])
+{
+    const float s = 1.0f / 1073741824.0f;
+    quat[0] = state->quat[0] * s;
+    quat[1] = state->quat[1] * s;
+    quat[2] = state->quat[2] * s;
+    quat[3] = state->quat[3] * s;
+}
+
+void ekf_fixed_set_quat(ekf_fixed_state_t *state, const float quat[4])
+{
+    for (int i = 0; i < 4; i++) {
+        float v = quat[i];
+        if (v > 1.0f) v = 1.0f;
+        if (v < -1.0f) v = -1.0f;
+        state->quat[i] = (int32_t)(v * 1073741823.0f);
+    }
+    fx_quat_normalize(state->quat);
+}
+
+void ekf_fixed_get_bias(const ekf_fixed_state_t *state, float bias[3])
+{
+    const float s = 1.0f / 1073741824.0f;
+    bias[0] = state->gyro_bias[0] * s;
+    bias[1] = state->gyro_bias[1] * s;
+    bias[2] = state->gyro_bias[2] * s;
+}
+
+void ekf_fixed_save_checkpoint(const ekf_fixed_state_t *state, fusion_checkpoint_t *ckpt)
+{
+    fusion_ckpt_header(ckpt, FUSION_EKF_FIXED);
+    ekf_fixed_get_quat(state, ckpt->quat);
+    ekf_fixed_get_bias(state, ckpt->gyro_bias);
+    memset(ckpt->acc_lp, 0, sizeof(ckpt->acc_lp));
+    memset(ckpt->mag_ref, 0, sizeof(ckpt->mag_ref));
+
+    int32_t p = PE(3, 3);
+    if (PE(4, 4) > p) p = PE(4, 4);
+    if (PE(5, 5) > p) p = PE(5, 5);
+    const float bs = (float)(1 << EKF_FIXED_BIAS_SHIFT);
+    ckpt->bias_sigma = fusion_ckpt_sigma(p / (1073741824.0f * bs * bs));
+}
+
+int ekf_fixed_load_checkpoint(ekf_fixed_state_t *state, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    ekf_fixed_set_quat(state, ckpt->quat);
+    for (int i = 0; i < 3; i++) {
+        state->gyro_bias[i] = fx_clamp((int32_t)(ckpt->gyro_bias[i] * 1073741824.0f), BIAS_MAX);
+    }
+
+    // 姿态协方差保持初值 (唤醒后首个加速度样本即修正倾角), 偏差按检查点不确定度
+    reset_covariance(state);
+    memset(state->th_acc, 0, sizeof(state->th_acc));
+    if (ckpt->bias_sigma > 0.0f) {
+        float sb = ckpt->bias_sigma * (float)(1 << EKF_FIXED_BIAS_SHIFT);
+        float p = sb * sb;
+        if (p > 1.0f) p = 1.0f;
+        for (int i = 3; i < N_STATE; i++) {
+            PE(i, i) = (int32_t)(p * 1073741824.0f);
+            if (PE(i, i) < P_DIAG_MIN) PE(i, i) = P_DIAG_MIN;
+        }
+    }
+    return 0;
+}
+
+void ekf_fixed_reset(ekf_fixed_state_t *state)
+{
+    ekf_fixed_init(state, state->dt_f);
+}
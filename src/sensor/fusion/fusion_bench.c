@@ -0,0 +1,489 @@
+/**
+ * @file fusion_bench.c
+ * @brief On-target fusion engine benchmark
+ *
+ * v0.6.3: 测量方法
+ * 1. 每个样本: 关中断 → 涂栈 → mcycle → update → mcycle → 扫栈 → 开中断
+ * 2. 轨迹解码/参考积分/误差计算均在计时窗口之外
+ * 3. 所有引擎共用一个 union 状态缓冲区, 依次运行
+ *
+ * 引擎输入单位不同 (rad/s, deg/s, 0.01 deg/s + mg), 由各自的包装函数转换,
+ * 包装函数内的转换计入周期数 —— 与 main_tracker 中的实际调用一致
+ */
+
+#include "fusion_bench.h"
+#include "vqf_ultra.h"
+#include "vqf_advanced.h"
+#include "vqf_fixed.h"
+#include "vqf_opt.h"
+#include "vqf_simple.h"
+#include "ekf_ahrs.h"
+#include "ekf_fixed.h"
+#include <string.h>
+#include <math.h>
+
+#ifdef CH59X
+#include "core_riscv.h"
+#define BENCH_CYCLES()      __get_MCYCLE()
+#define BENCH_IRQ_OFF()     __disable_irq()
+#define BENCH_IRQ_ON()      __enable_irq()
+#else
+#define BENCH_CYCLES()      0
+#define BENCH_IRQ_OFF()
+#define BENCH_IRQ_ON()
+#endif
+
+#define BENCH_PI            3.14159265f
+#define BENCH_DEG2RAD       (BENCH_PI / 180.0f)
+#define BENCH_RAD2DEG       (180.0f / BENCH_PI)
+#define STACK_PATTERN       0xA5A5A5A5UL
+
+/*============================================================================
+ * Engine Table
+ *============================================================================*/
+
+typedef union {
+    vqf_ultra_state_t ultra;
+    vqf_state_t advanced;
+    vqf_fixed_state_t fixed;
+    vqf_opt_state_t opt;
+    ekf_ahrs_state_t ekf;
+    ekf_fixed_state_t ekf_fixed;
+} bench_state_t;
+
+typedef struct {
+    const char *name;
+    uint16_t state_bytes;
+    fusion_bench_limits_t limits;
+    void (*init)(bench_state_t *s, float dt);
+    void (*set_quat)(bench_state_t *s, const float q[4]);
+    // mag 为 NULL 时走 6 轴
+    void (*update)(bench_state_t *s, const float g[3], const float a[3], const float *m);
+    void (*get_quat)(bench_state_t *s, float q[4]);
+} bench_engine_t;
+
+static bench_state_t bench_state;
+
+// --- vqf_ultra (0.01 deg/s, mg) ---
+static void ultra_init(bench_state_t *s, float dt)
+{
+    vqf_ultra_init(&s->ultra, (uint16_t)(1.0f / dt + 0.5f));
+}
+static void ultra_set_quat(bench_state_t *s, const float q[4]) { vqf_ultra_set_quat(&s->ultra, q); }
+static void ultra_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    int16_t gr[3], ar[3];
+    for (int i = 0; i < 3; i++) {
+        float gd = g[i] * (BENCH_RAD2DEG * 100.0f);
+        if (gd > 32767.0f) gd = 32767.0f;
+        if (gd < -32767.0f) gd = -32767.0f;
+        gr[i] = (int16_t)gd;
+        ar[i] = (int16_t)(a[i] * 1000.0f);
+    }
+    (void)m;
+    vqf_ultra_update(&s->ultra, gr, ar);
+}
+static void ultra_get_quat(bench_state_t *s, float q[4]) { vqf_ultra_get_quat(&s->ultra, q); }
+
+// --- vqf_advanced ---
+static void adv_init(bench_state_t *s, float dt) { vqf_advanced_init(&s->advanced, dt, 3.0f, 9.0f); }
+static void adv_set_quat(bench_state_t *s, const float q[4]) { memcpy(s->advanced.quat, q, sizeof(float) * 4); }
+static void adv_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    if (m) vqf_advanced_update_mag(&s->advanced, g, a, m);
+    else vqf_advanced_update(&s->advanced, g, a);
+}
+static void adv_get_quat(bench_state_t *s, float q[4]) { vqf_advanced_get_quat(&s->advanced, q); }
+
+// --- vqf_fixed ---
+static void fixed_init(bench_state_t *s, float dt) { vqf_fixed_init(&s->fixed, dt, 3.0f, 9.0f); }
+static void fixed_set_quat(bench_state_t *s, const float q[4]) { vqf_fixed_set_quat(&s->fixed, q); }
+static void fixed_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    if (m) vqf_fixed_update_mag(&s->fixed, g, a, m);
+    else vqf_fixed_update(&s->fixed, g, a);
+}
+static void fixed_get_quat(bench_state_t *s, float q[4]) { vqf_fixed_get_quat(&s->fixed, q); }
+
+// --- vqf_opt ---
+static void opt_init(bench_state_t *s, float dt) { vqf_opt_init(&s->opt, dt, 3.0f, 9.0f); }
+static void opt_set_quat(bench_state_t *s, const float q[4]) { memcpy(s->opt.quat, q, sizeof(float) * 4); }
+static void opt_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    vqf_opt_update(&s->opt, g, a, m);
+}
+static void opt_get_quat(bench_state_t *s, float q[4]) { vqf_opt_get_quat(&s->opt, q); }
+
+// --- vqf_simple (内部静态状态, deg/s 输入, 无 set_quat) ---
+static void simple_init(bench_state_t *s, float dt) { (void)s; vqf_init(dt, 3.0f, 9.0f); }
+static void simple_set_quat(bench_state_t *s, const float q[4]) { (void)s; (void)q; }
+static void simple_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    (void)s;
+    float gd[3] = { g[0] * BENCH_RAD2DEG, g[1] * BENCH_RAD2DEG, g[2] * BENCH_RAD2DEG };
+    vqf_update(gd, a, m);
+}
+static void simple_get_quat(bench_state_t *s, float q[4]) { (void)s; vqf_get_quaternion(q); }
+
+// --- ekf_ahrs ---
+static void ekf_init(bench_state_t *s, float dt) { ekf_ahrs_init(&s->ekf, dt); }
+static void ekf_set_quat(bench_state_t *s, const float q[4]) { memcpy(s->ekf.q, q, sizeof(float) * 4); }
+static void ekf_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    ekf_ahrs_update(&s->ekf, g, a, m);
+}
+static void ekf_get_quat(bench_state_t *s, float q[4]) { ekf_ahrs_get_quat(&s->ekf, q); }
+
+// --- ekf_fixed (6 轴, 忽略磁力计) ---
+static void ekfx_init(bench_state_t *s, float dt) { ekf_fixed_init(&s->ekf_fixed, dt); }
+static void ekfx_set_quat(bench_state_t *s, const float q[4]) { ekf_fixed_set_quat(&s->ekf_fixed, q); }
+static void ekfx_update(bench_state_t *s, const float g[3], const float a[3], const float *m)
+{
+    (void)m;
+    ekf_fixed_update(&s->ekf_fixed, g, a);
+}
+static void ekfx_get_quat(bench_state_t *s, float q[4]) { ekf_fixed_get_quat(&s->ekf_fixed, q); }
+
+// 顺序与 config.h FUSION_xxx 编号无关, 仅用于报告
+// 限值 (rms/max deg): 合成轨迹实测值之上留余量, 全部低于 5° rms;
+// 6 轴航向不可观测, 限值按 6 轴结果取 (9 轴只会更好)
+static const bench_engine_t engines[] = {
+    { "ultra",    sizeof(vqf_ultra_state_t), { 3.0f, 5.0f }, ultra_init, ultra_set_quat, ultra_update, ultra_get_quat },
+    { "advanced", sizeof(vqf_state_t),       { 4.5f, 6.5f }, adv_init,   adv_set_quat,   adv_update,   adv_get_quat   },
+    { "fixed",    sizeof(vqf_fixed_state_t), { 1.0f, 2.0f }, fixed_init, fixed_set_quat, fixed_update, fixed_get_quat },
+    { "opt",      sizeof(vqf_opt_state_t),   { 4.5f, 6.5f }, opt_init,   opt_set_quat,   opt_update,   opt_get_quat   },
+    { "simple",   0,                         { 4.0f, 6.0f }, simple_init, simple_set_quat, simple_update, simple_get_quat },
+    { "ekf",      sizeof(ekf_ahrs_state_t),  { 4.5f, 6.5f }, ekf_init,   ekf_set_quat,   ekf_update,   ekf_get_quat   },
+    { "ekf_fixed", sizeof(ekf_fixed_state_t), { 1.5f, 2.5f }, ekfx_init, ekfx_set_quat, ekfx_update,  ekfx_get_quat  },
+};
+
+#define ENGINE_COUNT    (sizeof(engines) / sizeof(engines[0]))
+
+/*============================================================================
+ * Trace Source
+ *============================================================================*/
+
+#if defined(FUSION_BENCH_RECORDED) && FUSION_BENCH_RECORDED
+// 由 tools/fusion_bench.py 生成
+extern const fusion_bench_trace_t fusion_bench_recorded_trace;
+#endif
+
+static const fusion_bench_trace_t synth_trace = {
+    .name = "synth",
+    .samples = NULL,
+    .count = FUSION_BENCH_SYNTH_SECONDS * 200,
+    .odr_hz = 200,
+    .has_mag = true,
+    .gyro_lsb_dps = 1.0f,
+    .accel_lsb_g = 1.0f,
+    .mag_lsb_ut = 1.0f,
+};
+
+// 合成轨迹状态: 参考四元数逐样本积分
+static float synth_q[4];
+static uint32_t synth_rng;
+
+static float synth_noise(float amp)
+{
+    synth_rng = synth_rng * 1664525UL + 1013904223UL;
+    return amp * ((float)(int32_t)(synth_rng >> 8) / 8388608.0f - 1.0f);
+}
+
+static void quat_mul(const float a[4], const float b[4], float out[4])
+{
+    out[0] = a[0]*b[0] - a[1]*b[1] - a[2]*b[2] - a[3]*b[3];
+    out[1] = a[0]*b[1] + a[1]*b[0] + a[2]*b[3] - a[3]*b[2];
+    out[2] = a[0]*b[2] - a[1]*b[3] + a[2]*b[0] + a[3]*b[1];
+    out[3] = a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + a[3]*b[0];
+}
+
+// earth → body: v_b = R(q)^T v_e
+static void rotate_inv(const float q[4], const float v[3], float out[3])
+{
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+    out[0] = (1 - 2*(y*y + z*z))*v[0] + 2*(x*y + w*z)*v[1] + 2*(x*z - w*y)*v[2];
+    out[1] = 2*(x*y - w*z)*v[0] + (1 - 2*(x*x + z*z))*v[1] + 2*(y*z + w*x)*v[2];
+    out[2] = 2*(x*z + w*y)*v[0] + 2*(y*z - w*x)*v[1] + (1 - 2*(x*x + y*y))*v[2];
+}
+
+// 合成运动: 静止 2s → 三轴正弦摆动, 10-12s 再静止一次 (偏差估计)
+// 真值 gyro 加 0.3 deg/s 常偏置和白噪声
+static void synth_sample(uint32_t i, uint16_t odr, float g[3], float a[3], float m[3], float ref[4])
+{
+    float dt = 1.0f / odr;
+    float t = i * dt;
+    float w[3] = {0, 0, 0};
+
+    if (i == 0) {
+        synth_q[0] = 1.0f;
+        synth_q[1] = synth_q[2] = synth_q[3] = 0.0f;
+        synth_rng = 12345;
+    }
+
+    bool moving = (t >= 2.0f && t < 10.0f) || (t >= 12.0f);
+    if (moving) {
+        w[0] = 1.5f * sinf(2.1f * t);
+        w[1] = 1.0f * sinf(1.3f * t + 0.5f);
+        w[2] = 2.0f * sinf(0.7f * t);
+    }
+
+    // 参考姿态: 用真值角速度做精确指数映射积分
+    float wn = sqrtf(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]);
+    if (wn > 1e-9f) {
+        float half = 0.5f * wn * dt;
+        float s = sinf(half) / wn;
+        float dq[4] = { cosf(half), w[0] * s, w[1] * s, w[2] * s };
+        float qn[4];
+        quat_mul(synth_q, dq, qn);
+        float n = 1.0f / sqrtf(qn[0]*qn[0] + qn[1]*qn[1] + qn[2]*qn[2] + qn[3]*qn[3]);
+        for (int k = 0; k < 4; k++) synth_q[k] = qn[k] * n;
+    }
+    memcpy(ref, synth_q, sizeof(synth_q));
+
+    static const float grav_e[3] = {0.0f, 0.0f, 1.0f};
+    static const float mag_e[3] = {22.0f, 0.0f, -40.0f};   // ~61° 倾角, uT
+    rotate_inv(synth_q, grav_e, a);
+    rotate_inv(synth_q, mag_e, m);
+
+    for (int k = 0; k < 3; k++) {
+        g[k] = w[k] + 0.3f * BENCH_DEG2RAD + synth_noise(0.002f);
+        a[k] += synth_noise(0.004f);
+        m[k] += synth_noise(0.3f);
+    }
+}
+
+static void trace_sample(const fusion_bench_trace_t *tr, uint32_t i,
+                         float g[3], float a[3], float m[3], float ref[4])
+{
+    if (tr->samples == NULL) {
+        synth_sample(i, tr->odr_hz, g, a, m, ref);
+        return;
+    }
+
+    const fusion_bench_sample_t *s = &tr->samples[i];
+    float gs = tr->gyro_lsb_dps * BENCH_DEG2RAD;
+    for (int k = 0; k < 3; k++) {
+        g[k] = s->gyro[k] * gs;
+        a[k] = s->accel[k] * tr->accel_lsb_g;
+        m[k] = s->mag[k] * tr->mag_lsb_ut;
+    }
+    for (int k = 0; k < 4; k++) {
+        ref[k] = s->ref[k] * (1.0f / 16384.0f);
+    }
+}
+
+const fusion_bench_trace_t *fusion_bench_default_trace(void)
+{
+#if defined(FUSION_BENCH_RECORDED) && FUSION_BENCH_RECORDED
+    return &fusion_bench_recorded_trace;
+#else
+    return &synth_trace;
+#endif
+}
+
+/*============================================================================
+ * Measurement Helpers
+ *============================================================================*/
+
+#ifdef CH59X
+static FORCE_INLINE uint32_t *stack_pointer(void)
+{
+    uint32_t *sp;
+    __asm__ volatile ("mv %0, sp" : "=r"(sp));
+    return sp;
+}
+
+// 在当前 sp 以下涂色; 必须内联, 不能有自己的栈帧
+static FORCE_INLINE void stack_paint(uint32_t *sp)
+{
+    volatile uint32_t *p = sp - FUSION_BENCH_STACK_PAINT / 4;
+    while (p < sp) *p++ = STACK_PATTERN;
+}
+
+static FORCE_INLINE uint16_t stack_used(uint32_t *sp)
+{
+    const volatile uint32_t *p = sp - FUSION_BENCH_STACK_PAINT / 4;
+    while (p < sp && *p == STACK_PATTERN) p++;
+    return (uint16_t)((sp - (const uint32_t *)p) * 4);
+}
+#else
+// 主机构建 (语法检查): 不测栈
+static FORCE_INLINE uint32_t *stack_pointer(void) { return NULL; }
+static FORCE_INLINE void stack_paint(uint32_t *sp) { (void)sp; }
+static FORCE_INLINE uint16_t stack_used(uint32_t *sp) { (void)sp; return 0; }
+#endif
+
+// 两个四元数之间的旋转角 (deg)
+static float quat_angle_deg(const float a[4], const float b[4])
+{
+    float d = fabsf(a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3]);
+    if (d > 1.0f) d = 1.0f;
+    return 2.0f * acosf(d) * BENCH_RAD2DEG;
+}
+
+// 重力方向夹角 (deg), 与航向无关
+static float tilt_angle_deg(const float a[4], const float b[4])
+{
+    static const float down[3] = {0.0f, 0.0f, 1.0f};
+    float ga[3], gb[3];
+    rotate_inv(a, down, ga);
+    rotate_inv(b, down, gb);
+    float d = ga[0]*gb[0] + ga[1]*gb[1] + ga[2]*gb[2];
+    if (d > 1.0f) d = 1.0f;
+    if (d < -1.0f) d = -1.0f;
+    return acosf(d) * BENCH_RAD2DEG;
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+uint8_t fusion_bench_engine_count(void)
+{
+    return ENGINE_COUNT;
+}
+
+int NO_INLINE fusion_bench_run(uint8_t engine, const fusion_bench_trace_t *trace,
+                               fusion_bench_result_t *result, bool use_mag)
+{
+    if (engine >= ENGINE_COUNT || !trace || !result || trace->count == 0 || trace->odr_hz == 0) {
+        return -1;
+    }
+
+    const bench_engine_t *e = &engines[engine];
+    float g[3], a[3], m[3], ref[4], q[4];
+    bool mag = use_mag && trace->has_mag;
+    uint32_t warmup = (uint32_t)FUSION_BENCH_WARMUP_S * trace->odr_hz;
+    uint64_t cyc_sum = 0;
+    float err2_sum = 0.0f, tilt2_sum = 0.0f;
+    uint32_t err_n = 0;
+
+    memset(result, 0, sizeof(*result));
+    result->engine = e->name;
+    result->state_bytes = e->state_bytes;
+    result->cycles_min = 0xFFFFFFFFUL;
+
+    memset(&bench_state, 0, sizeof(bench_state));
+    e->init(&bench_state, 1.0f / trace->odr_hz);
+
+    uint32_t *sp = stack_pointer();
+
+    for (uint32_t i = 0; i < trace->count; i++) {
+        trace_sample(trace, i, g, a, m, ref);
+        if (i == 0 && trace->samples != NULL) {
+            // 录制轨迹从参考初始姿态开始
+            e->set_quat(&bench_state, ref);
+        }
+
+        BENCH_IRQ_OFF();
+        stack_paint(sp);
+        uint32_t t0 = BENCH_CYCLES();
+        e->update(&bench_state, g, a, mag ? m : NULL);
+        uint32_t cyc = BENCH_CYCLES() - t0;
+        uint16_t used = stack_used(sp);
+        BENCH_IRQ_ON();
+
+        if (cyc < result->cycles_min) result->cycles_min = cyc;
+        if (cyc > result->cycles_max) result->cycles_max = cyc;
+        if (used > result->stack_bytes) result->stack_bytes = used;
+        cyc_sum += cyc;
+
+        if (i >= warmup) {
+            e->get_quat(&bench_state, q);
+            float err = quat_angle_deg(q, ref);
+            float tilt = tilt_angle_deg(q, ref);
+            if (err > result->err_max_deg) result->err_max_deg = err;
+            err2_sum += err * err;
+            tilt2_sum += tilt * tilt;
+            err_n++;
+        }
+    }
+
+    result->samples = trace->count;
+    result->cycles_avg = (uint32_t)(cyc_sum / trace->count);
+    if (err_n > 0) {
+        result->err_rms_deg = sqrtf(err2_sum / err_n);
+        result->tilt_rms_deg = sqrtf(tilt2_sum / err_n);
+    }
+    result->pass = fusion_bench_within_limits(engine, result->err_rms_deg, result->err_max_deg);
+    return 0;
+}
+
+int fusion_bench_run_all(const fusion_bench_trace_t *trace, bool use_mag,
+                         fusion_bench_report_cb_t cb)
+{
+    fusion_bench_result_t r;
+    int done = 0;
+
+    for (uint8_t i = 0; i < ENGINE_COUNT; i++) {
+        if (fusion_bench_run(i, trace, &r, use_mag) == 0) {
+            done++;
+            if (cb) cb(&r);
+        }
+    }
+    return done;
+}
+
+static uint8_t cur_engine = 0;
+
+const char *fusion_bench_engine_name(uint8_t engine)
+{
+    return (engine < ENGINE_COUNT) ? engines[engine].name : NULL;
+}
+
+const fusion_bench_limits_t *fusion_bench_engine_limits(uint8_t engine)
+{
+    return (engine < ENGINE_COUNT) ? &engines[engine].limits : NULL;
+}
+
+bool fusion_bench_within_limits(uint8_t engine, float err_rms_deg, float err_max_deg)
+{
+    const fusion_bench_limits_t *lim = fusion_bench_engine_limits(engine);
+    // NaN 比较为假, 发散成 NaN 的引擎同样判为超限
+    return lim && err_rms_deg <= lim->err_rms_deg && err_max_deg <= lim->err_max_deg;
+}
+
+int fusion_bench_engine_find(const char *name)
+{
+    for (uint8_t i = 0; i < ENGINE_COUNT; i++) {
+        if (name && strcmp(engines[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+int fusion_bench_engine_init(uint8_t engine, float dt)
+{
+    if (engine >= ENGINE_COUNT || dt <= 0.0f) return -1;
+
+    cur_engine = engine;
+    memset(&bench_state, 0, sizeof(bench_state));
+    engines[engine].init(&bench_state, dt);
+    return 0;
+}
+
+void fusion_bench_engine_set_quat(const float q[4])
+{
+    engines[cur_engine].set_quat(&bench_state, q);
+}
+
+void HOT fusion_bench_engine_update(const float g[3], const float a[3], const float *m)
+{
+    engines[cur_engine].update(&bench_state, g, a, m);
+}
+
+void fusion_bench_engine_get_quat(float q[4])
+{
+    engines[cur_engine].get_quat(&bench_state, q);
+}
+
+float fusion_bench_angle_deg(const float a[4], const float b[4], float *tilt_deg)
+{
+    if (tilt_deg) *tilt_deg = tilt_angle_deg(a, b);
+    return quat_angle_deg(a, b);
+}
+
+void fusion_bench_trace_sample(const fusion_bench_trace_t *trace, uint32_t i,
+                               float g[3], float a[3], float m[3], float ref[4])
+{
+    trace_sample(trace, i, g, a, m, ref);
+}
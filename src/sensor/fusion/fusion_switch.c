@@ -0,0 +1,226 @@
+/**
+ * @file fusion_switch.c
+ * @brief 运行时切换融合引擎 / Runtime-switchable fusion engine with hot handoff
+ *
+ * v0.6.3: vqf_ultra 与 FUSION_SWITCH_ACCURATE 共用状态存储, 经检查点交接
+ */
+
+#include "fusion_switch.h"
+
+#if defined(USE_FUSION_SWITCH) && USE_FUSION_SWITCH
+
+#define RAD_TO_CDPS     5729.578f       // rad/s -> 0.01 deg/s
+
+/*============================================================================
+ * 引擎适配
+ *============================================================================*/
+
+static void accurate_init(fusion_switch_t *fs)
+{
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    vqf_advanced_init(&fs->u.accurate, fs->dt, 3.0f, 9.0f);
+#else
+    ekf_fixed_init(&fs->u.accurate, fs->dt);
+#endif
+}
+
+static int16_t to_i16(float v)
+{
+    if (v > 32767.0f) return 32767;
+    if (v < -32767.0f) return -32767;
+    return (int16_t)v;
+}
+
+// ultra 输入: 陀螺 0.01 deg/s (±327 dps 饱和), 加速度 mg
+static void ultra_update(vqf_ultra_state_t *state, const float gyro[3], const float accel[3])
+{
+    int16_t g[3], a[3];
+
+    for (int i = 0; i < 3; i++) {
+        g[i] = to_i16(gyro[i] * RAD_TO_CDPS);
+        a[i] = to_i16(accel[i] * 1000.0f);
+    }
+    vqf_ultra_update(state, g, a);
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void fusion_switch_init(fusion_switch_t *fs, uint16_t odr_hz)
+{
+    fs->odr_hz = odr_hz;
+    fs->dt = 1.0f / (float)odr_hz;
+    fs->hold = 0;
+    fs->low_batt = 0;
+    fs->switches = 0;
+    fs->engine = FUSION_SWITCH_ACCURATE;
+    accurate_init(fs);
+}
+
+void HOT fusion_switch_update(fusion_switch_t *fs, const float gyro[3], const float accel[3])
+{
+    if (fs->hold < 0xFFFF) fs->hold++;
+
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        ultra_update(&fs->u.ultra, gyro, accel);
+        return;
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    vqf_advanced_update(&fs->u.accurate, gyro, accel);
+#else
+    ekf_fixed_update(&fs->u.accurate, gyro, accel);
+#endif
+}
+
+#if FUSION_SWITCH_HAS_MAG
+void HOT fusion_switch_update_mag(fusion_switch_t *fs, const float gyro[3],
+                                  const float accel[3], const float mag[3])
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        fusion_switch_update(fs, gyro, accel);
+        return;
+    }
+    if (fs->hold < 0xFFFF) fs->hold++;
+    vqf_advanced_update_mag(&fs->u.accurate, gyro, accel, mag);
+}
+#endif
+
+void fusion_switch_set_dt(fusion_switch_t *fs, float dt)
+{
+    if (fs->engine == FUSION_VQF_ULTRA) return;
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    fs->u.accurate.dt = dt;
+#else
+    ekf_fixed_set_dt(&fs->u.accurate, dt);
+#endif
+}
+
+void fusion_switch_set_rest(fusion_switch_t *fs, bool rest)
+{
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED && VQF_EXTERNAL_REST
+    if (fs->engine != FUSION_VQF_ULTRA) {
+        vqf_advanced_set_rest(&fs->u.accurate, rest);
+    }
+#else
+    (void)fs;
+    (void)rest;
+#endif
+}
+
+void fusion_switch_get_quat(const fusion_switch_t *fs, float quat[4])
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        vqf_ultra_get_quat(&fs->u.ultra, quat);
+        return;
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    vqf_advanced_get_quat(&fs->u.accurate, quat);
+#else
+    ekf_fixed_get_quat(&fs->u.accurate, quat);
+#endif
+}
+
+void fusion_switch_set_quat(fusion_switch_t *fs, const float quat[4])
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        vqf_ultra_set_quat(&fs->u.ultra, quat);
+        return;
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    for (int i = 0; i < 4; i++) fs->u.accurate.quat[i] = quat[i];
+#else
+    ekf_fixed_set_quat(&fs->u.accurate, quat);
+#endif
+}
+
+void fusion_switch_reset(fusion_switch_t *fs)
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        vqf_ultra_reset(&fs->u.ultra);
+        return;
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    vqf_advanced_reset(&fs->u.accurate);
+#else
+    ekf_fixed_reset(&fs->u.accurate);
+#endif
+}
+
+void fusion_switch_save_checkpoint(const fusion_switch_t *fs, fusion_checkpoint_t *ckpt)
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        vqf_ultra_save_checkpoint(&fs->u.ultra, ckpt);
+        return;
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    vqf_advanced_save_checkpoint(&fs->u.accurate, ckpt);
+#else
+    ekf_fixed_save_checkpoint(&fs->u.accurate, ckpt);
+#endif
+}
+
+int fusion_switch_load_checkpoint(fusion_switch_t *fs, const fusion_checkpoint_t *ckpt)
+{
+    if (fs->engine == FUSION_VQF_ULTRA) {
+        return vqf_ultra_load_checkpoint(&fs->u.ultra, ckpt);
+    }
+#if FUSION_SWITCH_ACCURATE == FUSION_VQF_ADVANCED
+    return vqf_advanced_load_checkpoint(&fs->u.accurate, ckpt);
+#else
+    return ekf_fixed_load_checkpoint(&fs->u.accurate, ckpt);
+#endif
+}
+
+int fusion_switch_select(fusion_switch_t *fs, uint8_t engine)
+{
+    if (engine != FUSION_VQF_ULTRA && engine != FUSION_SWITCH_ACCURATE) return -1;
+    if (engine == fs->engine) return 0;
+
+    // 两个引擎共用 union: 先导出, 再初始化目标引擎 (覆盖旧状态) 并载入
+    fusion_checkpoint_t ckpt;
+    fusion_switch_save_checkpoint(fs, &ckpt);
+
+    fs->engine = engine;
+    if (engine == FUSION_VQF_ULTRA) {
+        vqf_ultra_init(&fs->u.ultra, fs->odr_hz);
+    } else {
+        accurate_init(fs);
+    }
+
+    if (fusion_switch_load_checkpoint(fs, &ckpt) != 0) {
+        // 检查点无效 (源引擎发散): 至少保留姿态连续
+        fusion_switch_set_quat(fs, ckpt.quat);
+    }
+
+    fs->hold = 0;
+    fs->switches++;
+    return 0;
+}
+
+uint8_t fusion_switch_policy(fusion_switch_t *fs, uint32_t still_ms, uint8_t battery_pct)
+{
+    if (battery_pct < FUSION_SWITCH_LOW_BATT_PCT) {
+        fs->low_batt = 1;
+    } else if (battery_pct >= FUSION_SWITCH_LOW_BATT_PCT + FUSION_SWITCH_BATT_HYST_PCT) {
+        fs->low_batt = 0;
+    }
+
+    // 低电量立即降档; 运动/静止切换需满足最短驻留
+    uint8_t target;
+    if (fs->low_batt || still_ms >= FUSION_SWITCH_STILL_MS) {
+        target = FUSION_VQF_ULTRA;
+    } else if (still_ms == 0) {
+        target = FUSION_SWITCH_ACCURATE;
+    } else {
+        target = fs->engine;    // 介于两者之间: 保持
+    }
+
+    if (target != fs->engine &&
+        (fs->low_batt || fs->hold >= FUSION_SWITCH_MIN_SAMPLES)) {
+        fusion_switch_select(fs, target);
+    }
+    return fs->engine;
+}
+
+#endif /* USE_FUSION_SWITCH */
@@ -28,6 +28,18 @@
 #define MIN_ACC_NORM    0.5f    // Minimum accel norm for correction
 #define MAX_ACC_NORM    1.5f    // Maximum accel norm for correction
 
+// Per-sample bias rates (decimated updates scale these by the interval length)
+#define REST_BIAS_ALPHA     0.01f   // Slow adaptation
+#define REST_P_DECAY        0.99f
+#define MOTION_DECAY_XY     0.99f
+#define MOTION_DECAY_Z      0.999f
+#define MOTION_APPLY_XY     0.001f
+#define MOTION_APPLY_Z      0.0001f // Z轴应用速率降低10倍
+
+#if VQF_BIAS_DECIM < 1 || VQF_BIAS_DECIM > 255
+#error "VQF_BIAS_DECIM must be 1..255"
+#endif
+
 /*============================================================================
  * Internal Functions
  *============================================================================*/
@@ -39,7 +51,20 @@ static float compute_gain(float tau, float dt)
     return 1.0f - vqf_expf(-dt / tau);
 }
 
+// x^n for the per-interval decay factors (n <= VQF_BIAS_DECIM)
+static float pow_u8(float x, u8 n)
+{
+    float r = 1.0f;
+    while (n) {
+        if (n & 1) r *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return r;
+}
+
 // Apply accelerometer correction using gradient descent
+RAM_CODE_FUSION
 static void NO_INLINE apply_accel_correction(vqf_state_t *state, const float acc[3])
 {
     float q0 = state->quat[0], q1 = state->quat[1];
@@ -60,15 +85,13 @@ static void NO_INLINE apply_accel_correction(vqf_state_t *state, const float acc
     az *= inv_norm;
     
     // Low-pass filter accelerometer
+    // v0.6.3: acc_lp 在机体系滤波, 转动时滞后 tau_acc (合成回放倾角误差 ~12°);
+    // 只留给运动偏差/检查点用, 误差用本样本的单位加速度 (平滑已由增益 k_acc 提供)
     float alpha = state->k_acc;
     state->acc_lp[0] += alpha * (ax - state->acc_lp[0]);
     state->acc_lp[1] += alpha * (ay - state->acc_lp[1]);
     state->acc_lp[2] += alpha * (az - state->acc_lp[2]);
     
-    ax = state->acc_lp[0];
-    ay = state->acc_lp[1];
-    az = state->acc_lp[2];
-    
     // Estimated gravity direction from quaternion
     float vx = 2.0f * (q1*q3 - q0*q2);
     float vy = 2.0f * (q0*q1 + q2*q3);
@@ -101,31 +124,38 @@ static void NO_INLINE apply_accel_correction(vqf_state_t *state, const float acc
     state->quat[3] += qDot3;
     
     // Normalize quaternion
-    vqf_quat_normalize(state->quat);
+    fm_quat_renorm(state->quat);
 }
 
 // Gyroscope bias estimation during rest
-static void update_bias_at_rest(vqf_state_t *state, const float gyro[3])
+// v0.6.3: n 个样本的陀螺仪之和; n 步 EMA 作用在区间均值上, 等效速率 1 - 0.99^n
+static void update_bias_at_rest(vqf_state_t *state, const float gyro_sum[3], u8 n)
 {
     // Simple exponential moving average of gyro readings
-    float alpha = 0.01f;  // Slow adaptation
+    float alpha = REST_BIAS_ALPHA;
+    float inv_n = 1.0f;
+    if (n > 1) {
+        alpha = 1.0f - pow_u8(1.0f - REST_BIAS_ALPHA, n);
+        inv_n = 1.0f / (float)n;
+    }
     
-    state->gyro_bias[0] += alpha * (gyro[0] - state->gyro_bias[0]);
-    state->gyro_bias[1] += alpha * (gyro[1] - state->gyro_bias[1]);
-    state->gyro_bias[2] += alpha * (gyro[2] - state->gyro_bias[2]);
+    state->gyro_bias[0] += alpha * (gyro_sum[0] * inv_n - state->gyro_bias[0]);
+    state->gyro_bias[1] += alpha * (gyro_sum[1] * inv_n - state->gyro_bias[1]);
+    state->gyro_bias[2] += alpha * (gyro_sum[2] * inv_n - state->gyro_bias[2]);
     
     // Reduce covariance
-    state->bias_p[0] *= 0.99f;
-    state->bias_p[1] *= 0.99f;
-    state->bias_p[2] *= 0.99f;
+    float decay = pow_u8(REST_P_DECAY, n);
+    state->bias_p[0] *= decay;
+    state->bias_p[1] *= decay;
+    state->bias_p[2] *= decay;
 }
 
 // Gyroscope bias estimation during motion
 // v0.6.2: 修复"信噪比陷阱" - Z轴偏差在6轴模式下不可观测
 // 问题: 原来对所有轴使用相同的遗忘因子(0.0001)，导致站立时Z轴漂移
 // 修复: X/Y轴可从加速度计观测，Z轴(偏航)需要磁力计，6轴模式下大幅降低遗忘速率
-static void update_bias_in_motion(vqf_state_t *state, const float gyro[3],
-                                   const float error[3])
+// v0.6.3: error 为 n 个样本的误差之和; 累加器的逐样本应用+衰减按等比级数折算
+static void update_bias_in_motion(vqf_state_t *state, const float error[3], u8 n)
 {
 #if VQF_USE_MOTION_BIAS
     // v0.6.2: X/Y轴(可从加速度计观测)使用正常速率
@@ -149,31 +179,93 @@ static void update_bias_in_motion(vqf_state_t *state, const float gyro[3],
     
     // v0.6.2: 对不同轴使用不同的应用速率
     // X/Y轴可以较快应用(可观测)，Z轴极慢应用(不可观测)
-    state->gyro_bias[0] += 0.001f * state->bias_motion[0];
-    state->gyro_bias[1] += 0.001f * state->bias_motion[1];
-    state->gyro_bias[2] += 0.0001f * state->bias_motion[2];  // Z轴应用速率降低10倍
+    float apply_xy = MOTION_APPLY_XY, apply_z = MOTION_APPLY_Z;
+    float decay_xy = MOTION_DECAY_XY, decay_z = MOTION_DECAY_Z;
+    if (n > 1) {
+        decay_xy = pow_u8(MOTION_DECAY_XY, n);
+        decay_z = pow_u8(MOTION_DECAY_Z, n);
+        apply_xy *= (1.0f - decay_xy) / (1.0f - MOTION_DECAY_XY);
+        apply_z *= (1.0f - decay_z) / (1.0f - MOTION_DECAY_Z);
+    }
+    state->gyro_bias[0] += apply_xy * state->bias_motion[0];
+    state->gyro_bias[1] += apply_xy * state->bias_motion[1];
+    state->gyro_bias[2] += apply_z * state->bias_motion[2];
     
     // Decay motion bias (防止累积过大)
-    state->bias_motion[0] *= 0.99f;
-    state->bias_motion[1] *= 0.99f;
-    state->bias_motion[2] *= 0.999f;  // Z轴衰减更慢，保持记忆
+    state->bias_motion[0] *= decay_xy;
+    state->bias_motion[1] *= decay_xy;
+    state->bias_motion[2] *= decay_z;  // Z轴衰减更慢，保持记忆
 #else
-    (void)state; (void)gyro; (void)error;
+    (void)state; (void)error; (void)n;
 #endif
 }
 
+// v0.6.3: 结算当前偏差累计区间
+static void NO_INLINE bias_flush(vqf_state_t *state)
+{
+    u8 n = state->bias_n;
+    if (n == 0) return;
+    
+    float sum[3] = { state->bias_acc[0], state->bias_acc[1], state->bias_acc[2] };
+    if (state->flags & VQF_FLAG_BIAS_REST) {
+        update_bias_at_rest(state, sum, n);
+    } else {
+        update_bias_in_motion(state, sum, n);
+    }
+    state->bias_acc[0] = state->bias_acc[1] = state->bias_acc[2] = 0.0f;
+    state->bias_n = 0;
+}
+
+// v0.6.3: 每个校正步只累加, 满 VQF_BIAS_DECIM 步或静止/运动切换时结算
+static FORCE_INLINE void bias_accumulate(vqf_state_t *state, const float gyro[3],
+                                         const float accel[3])
+{
+    u8 rest = (state->flags & VQF_FLAG_REST) ? VQF_FLAG_BIAS_REST : 0;
+    if ((state->flags & VQF_FLAG_BIAS_REST) != rest) {
+        bias_flush(state);
+        state->flags ^= VQF_FLAG_BIAS_REST;
+    }
+    
+    if (rest) {
+        state->bias_acc[0] += gyro[0];
+        state->bias_acc[1] += gyro[1];
+        state->bias_acc[2] += gyro[2];
+    } else {
+        // Compute error for motion bias
+        state->bias_acc[0] += accel[0] - state->acc_lp[0];
+        state->bias_acc[1] += accel[1] - state->acc_lp[1];
+        state->bias_acc[2] += accel[2] - state->acc_lp[2];
+    }
+    
+    if (++state->bias_n >= VQF_BIAS_DECIM) {
+        bias_flush(state);
+    }
+}
+
 // Rest detection
 // v0.6.2: 添加滞后机制，防止呼吸/微动导致频繁切换Rest/Motion
+// v0.6.3: 陀螺仪用增量均值/方差 (EMA 递推) 代替单样本模长, 单个噪声尖峰不再打断静止;
+//         阈值比较都在平方域进行, 不开方
 static void update_rest_detection(vqf_state_t *state, const float gyro[3],
                                    const float accel[3])
 {
-#if VQF_USE_REST_DETECTION
-    // Compute gyro variance
-    float gyro_norm = vqf_vec3_norm(gyro) * RAD2DEG;
-    
-    // Compute accel deviation from 1g
-    float accel_norm = vqf_vec3_norm(accel);
-    float accel_dev = fabsf(accel_norm - 1.0f) * GRAVITY;
+#if VQF_USE_REST_DETECTION && !VQF_EXTERNAL_REST
+    // Incremental gyro mean / variance
+    float k = state->k_rest;
+    float d0 = gyro[0] - state->rest_last_gyro[0];
+    float d1 = gyro[1] - state->rest_last_gyro[1];
+    float d2 = gyro[2] - state->rest_last_gyro[2];
+    float m0 = state->rest_last_gyro[0] + k * d0;
+    float m1 = state->rest_last_gyro[1] + k * d1;
+    float m2 = state->rest_last_gyro[2] + k * d2;
+    state->rest_last_gyro[0] = m0;
+    state->rest_last_gyro[1] = m1;
+    state->rest_last_gyro[2] = m2;
+    state->rest_var += k * ((1.0f - k) * (d0*d0 + d1*d1 + d2*d2) - state->rest_var);
+    float mean_sq = m0*m0 + m1*m1 + m2*m2;
+    
+    // Accel norm² against the 1g band
+    float accel_sq = accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2];
     
     // v0.6.2: 使用滞后阈值防止频繁切换
     // 进入Rest: 使用严格阈值
@@ -182,30 +274,30 @@ static void update_rest_detection(vqf_state_t *state, const float gyro[3],
                     (VQF_REST_GYRO_TH * 1.5f) : VQF_REST_GYRO_TH;
     float accel_th = (state->flags & VQF_FLAG_REST) ? 
                      (VQF_REST_ACCEL_TH * 1.5f) : VQF_REST_ACCEL_TH;
+    float gyro_th_sq = (gyro_th * DEG2RAD) * (gyro_th * DEG2RAD);
+    float acc_lo = 1.0f - accel_th / GRAVITY;
+    float acc_hi = 1.0f + accel_th / GRAVITY;
     
-    // Check rest conditions
-    if (gyro_norm < gyro_th && accel_dev < accel_th) {
+    // Check rest conditions: 均值 (慢转动/残余偏差) 与方差 (抖动) 都低于阈值
+    if (mean_sq < gyro_th_sq && state->rest_var < gyro_th_sq &&
+        accel_sq > acc_lo * acc_lo && accel_sq < acc_hi * acc_hi) {
         state->rest_time += state->dt;
         
         if (state->rest_time >= VQF_REST_TIME_TH) {
+            // v0.6.3: 封顶, 否则长时间静止后要同样长的转动才能退出, 期间转动被学成偏差
+            state->rest_time = VQF_REST_TIME_TH;
             state->flags |= VQF_FLAG_REST;
         }
+    } else if (state->flags & VQF_FLAG_REST) {
+        // v0.6.3: 已超出宽松 (1.5 倍) 退出阈值, 滞后已由阈值提供, 立即退出
+        state->rest_time = 0.0f;
+        state->flags &= ~VQF_FLAG_REST;
     } else {
-        // v0.6.2: 不立即退出Rest，需要持续运动一段时间
-        // 这避免了呼吸等微动触发Motion模式
-        if (state->rest_time > 0.0f) {
-            state->rest_time -= state->dt * 2.0f;  // 退出速度是进入的2倍
-            if (state->rest_time < 0.0f) {
-                state->rest_time = 0.0f;
-                state->flags &= ~VQF_FLAG_REST;
-            }
-        }
+        // v0.6.2: 进入前的噪声尖峰只按 2 倍速率回退计时, 不清零
+        state->rest_time -= state->dt * 2.0f;
+        if (state->rest_time < 0.0f) state->rest_time = 0.0f;
     }
     
-    // Store last gyro for variance computation
-    state->rest_last_gyro[0] = gyro[0];
-    state->rest_last_gyro[1] = gyro[1];
-    state->rest_last_gyro[2] = gyro[2];
 #else
     (void)state; (void)gyro; (void)accel;
 #endif
@@ -234,9 +326,7 @@ static void apply_mag_correction(vqf_state_t *state, const float mag[3])
     state->mag_lp[1] += alpha * (my - state->mag_lp[1]);
     state->mag_lp[2] += alpha * (mz - state->mag_lp[2]);
     
-    mx = state->mag_lp[0];
-    my = state->mag_lp[1];
-    mz = state->mag_lp[2];
+    // v0.6.3: 与加速度校正相同, 机体系 mag_lp 转动时滞后, 航向误差用本样本
     
     // Transform mag to earth frame
     float mag_earth[3] = {mx, my, mz};
@@ -250,8 +340,12 @@ static void apply_mag_correction(vqf_state_t *state, const float mag[3])
     if (h_norm < 0.1f) return;  // Vertical field, skip
     
     // Check for magnetic disturbance
-    float dip_angle = fabsf(mag_earth[2]) / mag_norm;
-    if (state->mag_ref[2] != 0.0f) {
+    // v0.6.3: mag_earth 已是单位向量, 原先再除以原始范数, 倾角恒接近 0,
+    // 与 0.5 的初值比较永远判为干扰, 航向从不修正; 参考值为 0 表示尚未建立, 用首个样本播种
+    float dip_angle = fabsf(mag_earth[2]);
+    if (state->mag_ref[2] == 0.0f) {
+        state->mag_ref[2] = dip_angle;
+    } else {
         float expected_dip = fabsf(state->mag_ref[2]);
         if (fabsf(dip_angle - expected_dip) > 0.3f) {
             state->flags |= VQF_FLAG_MAG_DISTURBED;
@@ -275,15 +369,16 @@ static void apply_mag_correction(vqf_state_t *state, const float mag[3])
     }
     
     // Heading error (yaw correction only)
-    float heading_error = atan2f(hy, hx);
+    // v0.6.3: 多项式 atan2 + 小角度 sin/cos, 每次磁力计更新不再调用软浮点 libm
+    float heading_error = fm_atan2(hy, hx);
     
     // Apply correction
     float k_mag = compute_gain(state->tau_mag, state->dt);
     float half_angle = -0.5f * heading_error * k_mag;
     
-    // Yaw correction quaternion
-    float cz = cosf(half_angle);
-    float sz = sinf(half_angle);
+    // Yaw correction quaternion (k_mag << 1, 半角远小于 FM_SMALL_ANGLE_MAX)
+    float cz, sz;
+    fm_sincos_small(half_angle, &sz, &cz);
     float q_corr[4] = {cz, 0, 0, sz};
     
     // Apply to current quaternion
@@ -316,6 +411,9 @@ void vqf_advanced_init(vqf_state_t *state, float dt, float tau_acc, float tau_ma
     state->tau_acc = (tau_acc > 0.0f) ? tau_acc : VQF_TAU_ACC_DEFAULT;
     state->tau_mag = tau_mag;
     state->k_acc = compute_gain(state->tau_acc, dt);
+#if VQF_USE_REST_DETECTION && !VQF_EXTERNAL_REST
+    state->k_rest = compute_gain(VQF_REST_TAU, dt);
+#endif
     
     // Initialize accelerometer LP to down
     state->acc_lp[0] = 0.0f;
@@ -330,16 +428,16 @@ void vqf_advanced_init(vqf_state_t *state, float dt, float tau_acc, float tau_ma
 #if VQF_USE_MAGNETOMETER
     state->mag_ref[0] = 1.0f;  // Initial reference pointing north
     state->mag_ref[1] = 0.0f;
-    state->mag_ref[2] = 0.5f;  // Assume ~60° inclination
+    state->mag_ref[2] = 0.0f;  // 倾角参考未建立, 首个磁力计样本播种
     state->mag_dist_time = 10.0f;  // Start with settled state
 #endif
     
     state->flags = VQF_FLAG_INITIALIZED;
 }
 
-void NO_INLINE vqf_advanced_update(vqf_state_t *state, const float gyro[3], const float accel[3])
+// Gyroscope strapdown integration over dt
+static FORCE_INLINE void integrate_gyro(vqf_state_t *state, const float gyro[3], float dt)
 {
-    float dt = state->dt;
     float q0 = state->quat[0], q1 = state->quat[1];
     float q2 = state->quat[2], q3 = state->quat[3];
     
@@ -348,9 +446,6 @@ void NO_INLINE vqf_advanced_update(vqf_state_t *state, const float gyro[3], cons
     float gy = gyro[1] - state->gyro_bias[1];
     float gz = gyro[2] - state->gyro_bias[2];
     
-    // Update rest detection
-    update_rest_detection(state, gyro, accel);
-    
     // Gyroscope integration (quaternion derivative)
     float qDot0 = 0.5f * (-q1*gx - q2*gy - q3*gz);
     float qDot1 = 0.5f * ( q0*gx + q2*gz - q3*gy);
@@ -364,27 +459,73 @@ void NO_INLINE vqf_advanced_update(vqf_state_t *state, const float gyro[3], cons
     state->quat[3] = q3 + qDot3 * dt;
     
     // Normalize
-    vqf_quat_normalize(state->quat);
+    fm_quat_renorm(state->quat);
+}
+
+// 校正步: 静止检测 + 加速度修正 + 偏差估计 (增益按 state->dt 计算)
+// v0.6.3: 偏差估计只累加, 每 VQF_BIAS_DECIM 步结算一次
+static FORCE_INLINE void correct_accel(vqf_state_t *state, const float gyro[3], const float accel[3])
+{
+    // Update rest detection
+    update_rest_detection(state, gyro, accel);
     
     // Apply accelerometer correction
     apply_accel_correction(state, accel);
     
     // Update gyro bias
-    if (state->flags & VQF_FLAG_REST) {
-        update_bias_at_rest(state, gyro);
-    } else {
-        // Compute error for motion bias
-        float error[3] = {
-            accel[0] - state->acc_lp[0],
-            accel[1] - state->acc_lp[1],
-            accel[2] - state->acc_lp[2]
-        };
-        update_bias_in_motion(state, gyro, error);
-    }
+    bias_accumulate(state, gyro, accel);
     
     state->sample_count++;
 }
 
+RAM_CODE_FUSION
+void NO_INLINE vqf_advanced_update(vqf_state_t *state, const float gyro[3], const float accel[3])
+{
+    integrate_gyro(state, gyro, state->dt);
+    correct_accel(state, gyro, accel);
+}
+
+RAM_CODE_FUSION
+void HOT vqf_advanced_propagate(vqf_state_t *state, const float gyro[3], float dt)
+{
+    integrate_gyro(state, gyro, dt);
+}
+
+void vqf_advanced_propagate_delta(vqf_state_t *state, const float dtheta[3], float dt)
+{
+    float phi[3] = {
+        dtheta[0] - state->gyro_bias[0] * dt,
+        dtheta[1] - state->gyro_bias[1] * dt,
+        dtheta[2] - state->gyro_bias[2] * dt
+    };
+    float dq[4], q[4], q_new[4];
+    fm_rotvec_to_quat(phi, dq);
+    memcpy(q, state->quat, sizeof(q));
+    vqf_quat_multiply(q, dq, q_new);
+    fm_quat_renorm(q_new);
+    memcpy(state->quat, q_new, sizeof(q_new));
+}
+
+RAM_CODE_FUSION
+void vqf_advanced_correct(vqf_state_t *state, const float gyro[3], const float accel[3])
+{
+    correct_accel(state, gyro, accel);
+}
+
+void vqf_advanced_correct_mag(vqf_state_t *state, const float gyro[3],
+                              const float accel[3], const float mag[3])
+{
+    correct_accel(state, gyro, accel);
+    
+#if VQF_USE_MAGNETOMETER
+    if (mag != NULL && state->tau_mag > 0.0f) {
+        apply_mag_correction(state, mag);
+    }
+#else
+    (void)mag;
+#endif
+}
+
 void vqf_advanced_update_mag(vqf_state_t *state, const float gyro[3],
                               const float accel[3], const float mag[3])
 {
@@ -416,12 +557,77 @@ void vqf_advanced_set_bias(vqf_state_t *state, const float bias[3])
     state->gyro_bias[1] = bias[1];
     state->gyro_bias[2] = bias[2];
     
+    // v0.6.3: 未结算的区间按旧偏差累计, 丢弃
+    memset(state->bias_acc, 0, sizeof(state->bias_acc));
+    state->bias_n = 0;
+    
     // Reset covariance to reflect known bias
     state->bias_p[0] = 0.01f;
     state->bias_p[1] = 0.01f;
     state->bias_p[2] = 0.01f;
 }
 
+void vqf_advanced_save_checkpoint(const vqf_state_t *state, fusion_checkpoint_t *ckpt)
+{
+    fusion_ckpt_header(ckpt, FUSION_VQF_ADVANCED);
+    memcpy(ckpt->quat, state->quat, sizeof(ckpt->quat));
+    memcpy(ckpt->gyro_bias, state->gyro_bias, sizeof(ckpt->gyro_bias));
+    memcpy(ckpt->acc_lp, state->acc_lp, sizeof(ckpt->acc_lp));
+    ckpt->flags |= FUSION_CKPT_F_ACC_LP;
+
+    float p = state->bias_p[0];
+    if (state->bias_p[1] > p) p = state->bias_p[1];
+    if (state->bias_p[2] > p) p = state->bias_p[2];
+    ckpt->bias_sigma = fusion_ckpt_sigma(p);
+
+    if (state->flags & VQF_FLAG_REST) ckpt->flags |= FUSION_CKPT_F_REST;
+
+#if VQF_USE_MAGNETOMETER
+    memcpy(ckpt->mag_ref, state->mag_ref, sizeof(ckpt->mag_ref));
+    ckpt->flags |= FUSION_CKPT_F_MAG;
+#else
+    memset(ckpt->mag_ref, 0, sizeof(ckpt->mag_ref));
+#endif
+}
+
+int vqf_advanced_load_checkpoint(vqf_state_t *state, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    float q[4];
+    memcpy(q, ckpt->quat, sizeof(q));
+    vqf_quat_normalize(q);
+    memcpy(state->quat, q, sizeof(state->quat));
+    memcpy(state->gyro_bias, ckpt->gyro_bias, sizeof(state->gyro_bias));
+    memset(state->bias_motion, 0, sizeof(state->bias_motion));
+    memset(state->bias_acc, 0, sizeof(state->bias_acc));
+    state->bias_n = 0;
+
+    if (ckpt->bias_sigma > 0.0f) {
+        float p = ckpt->bias_sigma * ckpt->bias_sigma;
+        state->bias_p[0] = p;
+        state->bias_p[1] = p;
+        state->bias_p[2] = p;
+    }
+
+    if (ckpt->flags & FUSION_CKPT_F_ACC_LP) {
+        memcpy(state->acc_lp, ckpt->acc_lp, sizeof(state->acc_lp));
+    }
+
+    // 保存时已静止: 直接进入 Rest, 不再等待 VQF_REST_TIME_TH
+    if (ckpt->flags & FUSION_CKPT_F_REST) {
+        state->rest_time = VQF_REST_TIME_TH;
+        state->flags |= VQF_FLAG_REST;
+    }
+
+#if VQF_USE_MAGNETOMETER
+    if ((ckpt->flags & FUSION_CKPT_F_MAG) && ckpt->engine == FUSION_VQF_ADVANCED) {
+        memcpy(state->mag_ref, ckpt->mag_ref, sizeof(state->mag_ref));
+    }
+#endif
+    return 0;
+}
+
 void vqf_advanced_set_params(vqf_state_t *state, float tau_acc, float tau_mag)
 {
     state->tau_acc = tau_acc;
@@ -0,0 +1,699 @@
+/**
+ * @file vqf_fixed.c
+ * @brief Fixed-Point VQF Sensor Fusion Implementation
+ *
+ * v0.6.3: 逐步移植 vqf_advanced.c, 每个函数与原版一一对应:
+ * 1. Gyroscope Integration: Q24 角速度 × Q30 半采样周期
+ * 2. Accelerometer Correction: 叉积误差 + 自适应增益
+ * 3. Rest Detection: 平方比较代替 sqrt, 计时改为样本计数
+ * 4. Motion Bias: XY/Z 分轴遗忘速率
+ * 5. Magnetometer: LP → 地球系 → 倾角干扰检测 → 偏航修正
+ *
+ * 整数技巧:
+ * - 范数阈值全部以平方比较, 只在需要单位向量时做一次 isqrt
+ * - 归一化用一次 64 位除法求倒数, 分量用乘法
+ * - 四元数近单位时用一阶牛顿迭代归一化 (无除法)
+ * - atan2 为分象限多项式 (误差 < 0.1°), sin/cos 为泰勒展开
+ */
+
+#include "vqf_fixed.h"
+#include "fx_math.h"
+#include "fast_math.h"
+#include <string.h>
+
+/*============================================================================
+ * Fixed-Point Constants
+ *============================================================================*/
+
+// Q29 角度 (±π 需要 2 位整数)
+#define FX29_PI         1686629713L
+#define FX29_HALF_PI    843314857L
+
+#define FX_PI_4         FX(0.78539816)
+
+#define DEG2RAD_D       (3.14159265358979 / 180.0)
+#define GRAVITY_D       9.81
+
+// 加速度范数窗口 (与 vqf_advanced MIN/MAX_ACC_NORM 相同), Q32 平方
+#define FX32_SQ(v)              ((int64_t)((v) * (v) * 4294967296.0))
+#define ACC_NORM2_MIN           FX32_SQ(0.5)
+#define ACC_NORM2_MAX           FX32_SQ(1.5)
+
+// 静止检测阈值平方: 陀螺仪 Q48 (rad/s)², 加速度 Q32 g²
+#define REST_GYRO2_TH           ((int64_t)((VQF_REST_GYRO_TH * DEG2RAD_D) * \
+                                           (VQF_REST_GYRO_TH * DEG2RAD_D) * 281474976710656.0))
+#define REST_GYRO2_TH_EXIT      ((int64_t)((VQF_REST_GYRO_TH * 1.5 * DEG2RAD_D) * \
+                                           (VQF_REST_GYRO_TH * 1.5 * DEG2RAD_D) * 281474976710656.0))
+#define REST_ACC_DEV            (VQF_REST_ACCEL_TH / GRAVITY_D)
+#define REST_ACC_DEV_EXIT       (VQF_REST_ACCEL_TH * 1.5 / GRAVITY_D)
+
+// 磁力计范数下限 0.1, Q32 平方
+#define MAG_NORM2_MIN           FX32_SQ(0.1)
+
+/*============================================================================
+ * Integer Math Helpers
+ *============================================================================*/
+
+// x += k * (target - x), 差值可超出 int32
+static FORCE_INLINE int32_t fx_lp(int32_t x, int32_t target, int32_t k)
+{
+    return x + (int32_t)((((int64_t)target - x) * k) >> FX_FRAC);
+}
+
+static FORCE_INLINE int32_t fx_clamp(int32_t x, int32_t lim)
+{
+    if (x > lim) return lim;
+    if (x < -lim) return -lim;
+    return x;
+}
+
+// atan(z), z ∈ [0, 1] Q30 → Q30
+static FORCE_INLINE int32_t fx_atan_unit(int32_t z)
+{
+    // atan(z) ≈ π/4·z - z(z-1)(0.2447 + 0.0663z), 最大误差 0.0015 rad
+    int32_t t = fx_mul(z, z - FX_ONE);
+    int32_t p = FX(0.2447) + fx_mul(FX(0.0663), z);
+    return fx_mul(FX_PI_4, z) - fx_mul(t, p);
+}
+
+// atan2(y, x), Q30 输入 → Q29 弧度
+static int32_t fx_atan2(int32_t y, int32_t x)
+{
+    int32_t ax = fx_abs(x), ay = fx_abs(y);
+    int32_t a;
+
+    if (ax == 0 && ay == 0) return 0;
+
+    if (ay <= ax) {
+        a = fx_atan_unit((int32_t)(((int64_t)ay << FX_FRAC) / ax)) >> 1;
+    } else {
+        a = FX29_HALF_PI - (fx_atan_unit((int32_t)(((int64_t)ax << FX_FRAC) / ay)) >> 1);
+    }
+
+    if (x < 0) a = FX29_PI - a;
+    return (y < 0) ? -a : a;
+}
+
+// sin/cos, |x| ≤ π/4 Q30
+static FORCE_INLINE void fx_sincos(int32_t x, int32_t *s, int32_t *c)
+{
+    int32_t x2 = fx_mul(x, x);
+    *s = fx_mul(x, FX_ONE - fx_mul(x2, FX(1.0 / 6.0) - fx_mul(x2, FX(1.0 / 120.0))));
+    *c = FX_ONE - (x2 >> 1) + fx_mul(fx_mul(x2, x2), FX(1.0 / 24.0));
+}
+
+// 与 vqf_advanced 的 compute_gain 相同 (仅 init 使用)
+static int32_t compute_gain_q30(float tau, float dt)
+{
+    if (tau <= 0.0f) return 0;
+    return (int32_t)((1.0f - vqf_expf(-dt / tau)) * 1073741824.0f);
+}
+
+/*============================================================================
+ * Internal Functions
+ *============================================================================*/
+
+// Apply accelerometer correction using gradient descent
+RAM_CODE_FUSION
+static void NO_INLINE apply_accel_correction(vqf_fixed_state_t *state, const int32_t acc[3],
+                                             int64_t acc_norm2, int32_t k)
+{
+    int32_t q0 = state->quat[0], q1 = state->quat[1];
+    int32_t q2 = state->quat[2], q3 = state->quat[3];
+
+    // Skip correction if accel norm is too far from 1g
+    if (acc_norm2 < ACC_NORM2_MIN || acc_norm2 > ACC_NORM2_MAX) {
+        return;
+    }
+
+    int32_t a[3];
+    fx_vec3_unit_q16(acc, fx_isqrt64((uint64_t)acc_norm2), a);
+
+    // Low-pass filter accelerometer
+    // v0.6.3: acc_lp 在机体系滤波, 转动时滞后 tau_acc; 只留给运动偏差/检查点用,
+    // 误差用本样本的单位加速度 (平滑已由增益 k 提供)
+    state->acc_lp[0] = fx_lp(state->acc_lp[0], a[0], k);
+    state->acc_lp[1] = fx_lp(state->acc_lp[1], a[1], k);
+    state->acc_lp[2] = fx_lp(state->acc_lp[2], a[2], k);
+
+    int32_t ax = a[0];
+    int32_t ay = a[1];
+    int32_t az = a[2];
+
+    // Estimated gravity direction from quaternion
+    int32_t vx = (fx_mul(q1, q3) - fx_mul(q0, q2)) << 1;
+    int32_t vy = (fx_mul(q0, q1) + fx_mul(q2, q3)) << 1;
+    int32_t vz = fx_mul(q0, q0) - fx_mul(q1, q1) - fx_mul(q2, q2) + fx_mul(q3, q3);
+
+    // Error: cross product of estimated and measured gravity
+    int32_t ex = fx_mul(ay, vz) - fx_mul(az, vy);
+    int32_t ey = fx_mul(az, vx) - fx_mul(ax, vz);
+    int32_t ez = fx_mul(ax, vy) - fx_mul(ay, vx);
+
+    // Adaptive gain: reduce correction when error is large (|e| > 0.1)
+    int64_t e2 = (int64_t)ex * ex + (int64_t)ey * ey + (int64_t)ez * ez;   // Q60
+    int32_t gain = k;
+    if (e2 > ((int64_t)FX(0.01) << FX_FRAC)) {
+        uint32_t e_norm = fx_isqrt64((uint64_t)e2);
+        gain = (int32_t)(((int64_t)fx_mul(k, FX(0.1)) << FX_FRAC) / e_norm);
+        if (gain < FX(0.001)) gain = FX(0.001);
+    }
+
+    // Apply correction as quaternion derivative
+    int32_t h = gain >> 1;
+    state->quat[0] -= fx_mul(fx_mul(q1, ex) + fx_mul(q2, ey) + fx_mul(q3, ez), h);
+    state->quat[1] += fx_mul(fx_mul(q0, ex) + fx_mul(q2, ez) - fx_mul(q3, ey), h);
+    state->quat[2] += fx_mul(fx_mul(q0, ey) - fx_mul(q1, ez) + fx_mul(q3, ex), h);
+    state->quat[3] += fx_mul(fx_mul(q0, ez) + fx_mul(q1, ey) - fx_mul(q2, ex), h);
+
+    fx_quat_normalize(state->quat);
+}
+
+// Gyroscope bias estimation during rest
+static void update_bias_at_rest(vqf_fixed_state_t *state, const int32_t gyro[3])
+{
+    // EMA alpha = 0.01, gyro Q24 → Q30
+    for (int i = 0; i < 3; i++) {
+        int64_t d = ((int64_t)gyro[i] << 6) - state->gyro_bias[i];
+        state->gyro_bias[i] += (int32_t)((d * FX(0.01)) >> FX_FRAC);
+        state->bias_p[i] = fx_mul(state->bias_p[i], FX(0.99));
+    }
+}
+
+// Gyroscope bias estimation during motion
+// Z 轴在 6 轴模式下不可观测, 遗忘/应用速率均降低 (同 vqf_advanced v0.6.2)
+static void update_bias_in_motion(vqf_fixed_state_t *state, const int32_t error_q16[3])
+{
+#if VQF_USE_MOTION_BIAS
+    // alpha (Q30) × error (Q16) >> 16 → Q30
+    state->bias_motion[0] += (int32_t)(((int64_t)FX(VQF_MOTION_BIAS_ALPHA_XY) * error_q16[0]) >> 16);
+    state->bias_motion[1] += (int32_t)(((int64_t)FX(VQF_MOTION_BIAS_ALPHA_XY) * error_q16[1]) >> 16);
+    state->bias_motion[2] += (int32_t)(((int64_t)FX(VQF_MOTION_BIAS_ALPHA_Z) * error_q16[2]) >> 16);
+
+    for (int i = 0; i < 3; i++) {
+        state->bias_motion[i] = fx_clamp(state->bias_motion[i], FX(VQF_MOTION_BIAS_LIMIT));
+    }
+
+    state->gyro_bias[0] += fx_mul(FX(0.001), state->bias_motion[0]);
+    state->gyro_bias[1] += fx_mul(FX(0.001), state->bias_motion[1]);
+    state->gyro_bias[2] += fx_mul(FX(0.0001), state->bias_motion[2]);
+
+    state->bias_motion[0] = fx_mul(state->bias_motion[0], FX(0.99));
+    state->bias_motion[1] = fx_mul(state->bias_motion[1], FX(0.99));
+    state->bias_motion[2] = fx_mul(state->bias_motion[2], FX(0.999));
+#else
+    (void)state; (void)error_q16;
+#endif
+}
+
+// Rest detection (滞后: 进入用严格阈值并持续 rest_count_th 个样本, 退出用 1.5 倍阈值)
+// v0.6.3: 计数封顶在 rest_count_th, 超出退出阈值的第一个样本即清除 REST;
+// 返回本样本是否满足严格阈值 (静止偏差只用这些样本学习, 不把转动当成偏差)
+static bool update_rest_detection(vqf_fixed_state_t *state, const int32_t gyro[3],
+                                  int64_t acc_norm2)
+{
+#if VQF_USE_REST_DETECTION
+    int64_t g2 = (int64_t)gyro[0] * gyro[0] + (int64_t)gyro[1] * gyro[1] +
+                 (int64_t)gyro[2] * gyro[2];                        // Q48
+
+    bool strict = g2 < REST_GYRO2_TH &&
+                  acc_norm2 > FX32_SQ(1.0 - REST_ACC_DEV) &&
+                  acc_norm2 < FX32_SQ(1.0 + REST_ACC_DEV);
+
+    if (state->flags & VQF_FIXED_FLAG_REST) {
+        bool quiet = g2 < REST_GYRO2_TH_EXIT &&
+                     acc_norm2 > FX32_SQ(1.0 - REST_ACC_DEV_EXIT) &&
+                     acc_norm2 < FX32_SQ(1.0 + REST_ACC_DEV_EXIT);
+        if (!quiet) {
+            state->rest_count = 0;
+            state->flags &= ~VQF_FIXED_FLAG_REST;
+        }
+    } else if (strict) {
+        if (++state->rest_count >= state->rest_count_th) {
+            state->rest_count = state->rest_count_th;
+            state->flags |= VQF_FIXED_FLAG_REST;
+        }
+    } else {
+        // 进入前的单个噪声尖峰只回退 2 个样本
+        state->rest_count = (state->rest_count > 2) ? (uint16_t)(state->rest_count - 2) : 0;
+    }
+    return strict;
+#else
+    (void)state; (void)gyro; (void)acc_norm2;
+    return false;
+#endif
+}
+
+#if VQF_FIXED_USE_MAGNETOMETER
+// Magnetometer correction
+static void apply_mag_correction(vqf_fixed_state_t *state, const int32_t mag[3])
+{
+    if (state->k_mag == 0) return;
+
+    int64_t m2 = (int64_t)mag[0] * mag[0] + (int64_t)mag[1] * mag[1] +
+                 (int64_t)mag[2] * mag[2];                          // Q32
+    if (m2 < MAG_NORM2_MIN) return;
+
+    uint32_t mag_norm = fx_isqrt64((uint64_t)m2);                   // Q16
+    int32_t m[3];
+    fx_vec3_unit_q16(mag, mag_norm, m);
+
+    // Low-pass filter
+    state->mag_lp[0] = fx_lp(state->mag_lp[0], m[0], state->k_mag_lp);
+    state->mag_lp[1] = fx_lp(state->mag_lp[1], m[1], state->k_mag_lp);
+    state->mag_lp[2] = fx_lp(state->mag_lp[2], m[2], state->k_mag_lp);
+
+    // v0.6.3: 与加速度校正相同, 机体系 mag_lp 转动时滞后, 航向误差用本样本
+    int32_t mx = m[0], my = m[1], mz = m[2];
+
+    // Transform mag to earth frame (rotation matrix of q)
+    int32_t qw = state->quat[0], qx = state->quat[1];
+    int32_t qy = state->quat[2], qz = state->quat[3];
+    int32_t xx = fx_mul(qx, qx), yy = fx_mul(qy, qy), zz = fx_mul(qz, qz);
+    int32_t xy = fx_mul(qx, qy), xz = fx_mul(qx, qz), yz = fx_mul(qy, qz);
+    int32_t wx = fx_mul(qw, qx), wy = fx_mul(qw, qy), wz = fx_mul(qw, qz);
+
+    int32_t hx = fx_mul(FX_ONE - ((yy + zz) << 1), mx) +
+                 fx_mul((xy - wz) << 1, my) + fx_mul((xz + wy) << 1, mz);
+    int32_t hy = fx_mul((xy + wz) << 1, mx) +
+                 fx_mul(FX_ONE - ((xx + zz) << 1), my) + fx_mul((yz - wx) << 1, mz);
+    int32_t hz = fx_mul((xz - wy) << 1, mx) +
+                 fx_mul((yz + wx) << 1, my) + fx_mul(FX_ONE - ((xx + yy) << 1), mz);
+
+    // Horizontal component (for heading)
+    int64_t h2 = (int64_t)hx * hx + (int64_t)hy * hy;             // Q60
+    if (h2 < ((int64_t)FX(0.01) << FX_FRAC)) return;              // Vertical field, skip
+    uint32_t h_norm = fx_isqrt64((uint64_t)h2);                    // Q30
+
+    // Check for magnetic disturbance
+    // v0.6.3: mag_lp 已是单位向量, 倾角 = |hz| / |h| (原先再除以原始范数, 结果恒接近 0,
+    // 与 0.5 的初值比较永远判为干扰, 航向从不修正); 参考值为 0 表示尚未建立, 用首个样本播种
+    uint32_t t_norm = fx_isqrt64((uint64_t)(h2 + (int64_t)hz * hz));  // Q30
+    int32_t dip = (int32_t)(((int64_t)fx_abs(hz) << FX_FRAC) / t_norm);
+    if (state->mag_ref[2] == 0) {
+        state->mag_ref[2] = dip;
+    } else {
+        int32_t expected_dip = fx_abs(state->mag_ref[2]);
+        if (fx_abs(dip - expected_dip) > FX(0.3)) {
+            state->flags |= VQF_FIXED_FLAG_MAG_DISTURBED;
+            state->mag_settle = 0;
+            return;  // Skip correction during disturbance
+        }
+    }
+
+    // Clear disturbance flag after settling time
+    if (state->mag_settle < 0xFFFF) state->mag_settle++;
+    if (state->mag_settle > state->mag_settle_th) {
+        state->flags &= ~VQF_FIXED_FLAG_MAG_DISTURBED;
+    }
+
+    // Update reference
+    if (!(state->flags & VQF_FIXED_FLAG_MAG_DISTURBED)) {
+        int32_t hxn = (int32_t)(((int64_t)hx << FX_FRAC) / h_norm);
+        int32_t hyn = (int32_t)(((int64_t)hy << FX_FRAC) / h_norm);
+        state->mag_ref[0] = fx_lp(state->mag_ref[0], hxn, FX(0.001));
+        state->mag_ref[1] = fx_lp(state->mag_ref[1], hyn, FX(0.001));
+        state->mag_ref[2] = fx_lp(state->mag_ref[2], dip, FX(0.001));
+    }
+
+    // Heading error (Q29) → half angle -0.5 * err * k_mag (Q30, 数值相同)
+    int32_t heading_error = fx_atan2(hy, hx);
+    int32_t half_angle = -(int32_t)(((int64_t)heading_error * state->k_mag) >> FX_FRAC);
+    // 泰勒展开有效范围; 仅 tau_mag 接近 dt 时才会触发
+    half_angle = fx_clamp(half_angle, FX_PI_4);
+
+    // Yaw correction quaternion q_corr = [c, 0, 0, s], q = q_corr ⊗ q
+    int32_t s, c;
+    fx_sincos(half_angle, &s, &c);
+
+    state->quat[0] = fx_mul(c, qw) - fx_mul(s, qz);
+    state->quat[1] = fx_mul(c, qx) - fx_mul(s, qy);
+    state->quat[2] = fx_mul(c, qy) + fx_mul(s, qx);
+    state->quat[3] = fx_mul(c, qz) + fx_mul(s, qw);
+
+    // 泰勒截断误差会累积到范数
+    fx_quat_normalize(state->quat);
+}
+#endif
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+void vqf_fixed_init(vqf_fixed_state_t *state, float dt, float tau_acc, float tau_mag)
+{
+    memset(state, 0, sizeof(vqf_fixed_state_t));
+
+    // Identity quaternion
+    state->quat[0] = FX_ONE;
+
+    // Filter parameters
+    state->dt = dt;
+    state->tau_acc = (tau_acc > 0.0f) ? tau_acc : VQF_TAU_ACC_DEFAULT;
+    state->tau_mag = tau_mag;
+    state->half_dt = (int32_t)(dt * 0.5f * 1073741824.0f);
+    state->k_acc = compute_gain_q30(state->tau_acc, dt);
+
+    float odr = (dt > 0.0f) ? (1.0f / dt) : 200.0f;
+    state->rest_count_th = (uint16_t)(VQF_REST_TIME_TH * odr + 0.5f);
+
+    // Initialize accelerometer LP to down
+    state->acc_lp[2] = FX_ONE;
+
+    // Initialize bias covariance
+    state->bias_p[0] = FX(VQF_BIAS_SIGMA_INIT * VQF_BIAS_SIGMA_INIT);
+    state->bias_p[1] = FX(VQF_BIAS_SIGMA_INIT * VQF_BIAS_SIGMA_INIT);
+    state->bias_p[2] = FX(VQF_BIAS_SIGMA_INIT * VQF_BIAS_SIGMA_INIT);
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    state->k_mag = compute_gain_q30(tau_mag, dt);
+    state->k_mag_lp = compute_gain_q30(tau_mag * 0.1f, dt);
+    state->mag_ref[0] = FX_ONE;         // Initial reference pointing north
+    state->mag_ref[2] = 0;              // 倾角参考未建立, 首个磁力计样本播种
+    state->mag_settle_th = (uint16_t)(2.0f * odr);
+    state->mag_settle = 0xFFFF;         // Start with settled state
+#endif
+
+    state->flags = VQF_FIXED_FLAG_INITIALIZED;
+}
+
+// 陀螺仪捷联积分, half_dt 为 Q30 的 dt/2
+static FORCE_INLINE void integrate_gyro(vqf_fixed_state_t *state, const int32_t gyro[3],
+                                        int32_t half_dt)
+{
+    int32_t q0 = state->quat[0], q1 = state->quat[1];
+    int32_t q2 = state->quat[2], q3 = state->quat[3];
+
+    // Subtract bias (Q30 → Q24), scale by dt/2 → Q30 half-angle increments
+    int32_t hx = (int32_t)(((int64_t)(gyro[0] - (state->gyro_bias[0] >> 6)) * half_dt) >> 24);
+    int32_t hy = (int32_t)(((int64_t)(gyro[1] - (state->gyro_bias[1] >> 6)) * half_dt) >> 24);
+    int32_t hz = (int32_t)(((int64_t)(gyro[2] - (state->gyro_bias[2] >> 6)) * half_dt) >> 24);
+
+    // Gyroscope integration (quaternion derivative)
+    state->quat[0] = q0 - fx_mul(q1, hx) - fx_mul(q2, hy) - fx_mul(q3, hz);
+    state->quat[1] = q1 + fx_mul(q0, hx) + fx_mul(q2, hz) - fx_mul(q3, hy);
+    state->quat[2] = q2 + fx_mul(q0, hy) - fx_mul(q1, hz) + fx_mul(q3, hx);
+    state->quat[3] = q3 + fx_mul(q0, hz) + fx_mul(q1, hy) - fx_mul(q2, hx);
+
+    fx_quat_normalize(state->quat);
+}
+
+// 校正步: 静止检测 + 加速度修正 + 偏差估计
+static FORCE_INLINE void correct_core(vqf_fixed_state_t *state, const int32_t gyro[3],
+                                      const int32_t accel[3], int32_t k_acc)
+{
+    int64_t acc_norm2 = (int64_t)accel[0] * accel[0] + (int64_t)accel[1] * accel[1] +
+                        (int64_t)accel[2] * accel[2];               // Q32
+
+    // Update rest detection
+    bool strict = update_rest_detection(state, gyro, acc_norm2);
+
+    // Apply accelerometer correction
+    apply_accel_correction(state, accel, acc_norm2, k_acc);
+
+    // Update gyro bias (REST 滞后区内超出严格阈值的样本不参与)
+    if (state->flags & VQF_FIXED_FLAG_REST) {
+        if (strict) {
+            update_bias_at_rest(state, gyro);
+        }
+    } else {
+        // Error for motion bias: raw accel (Q16) - acc_lp (Q30 → Q16)
+        int32_t error[3] = {
+            accel[0] - (state->acc_lp[0] >> 14),
+            accel[1] - (state->acc_lp[1] >> 14),
+            accel[2] - (state->acc_lp[2] >> 14)
+        };
+        update_bias_in_motion(state, error);
+    }
+
+    state->sample_count++;
+}
+
+// 6 轴更新; half_dt/k_acc 由调用方传入, 批量路径对所有实例只取一次
+static FORCE_INLINE void update_core(vqf_fixed_state_t *state, const int32_t gyro[3],
+                                     const int32_t accel[3], int32_t half_dt, int32_t k_acc)
+{
+    integrate_gyro(state, gyro, half_dt);
+    correct_core(state, gyro, accel, k_acc);
+}
+
+RAM_CODE_FUSION
+void NO_INLINE vqf_fixed_update_q(vqf_fixed_state_t *state, const int32_t gyro[3],
+                                  const int32_t accel[3])
+{
+    update_core(state, gyro, accel, state->half_dt, state->k_acc);
+}
+
+RAM_CODE_FUSION
+void vqf_fixed_update_batch_q(vqf_fixed_state_t *const states[], const int32_t gyro[][3],
+                              const int32_t accel[][3], uint8_t n)
+{
+    if (n == 0) return;
+
+    int32_t half_dt = states[0]->half_dt;
+    int32_t k_acc = states[0]->k_acc;
+    for (uint8_t i = 0; i < n; i++) {
+        update_core(states[i], gyro[i], accel[i], half_dt, k_acc);
+    }
+}
+
+void vqf_fixed_update_mag_q(vqf_fixed_state_t *state, const int32_t gyro[3],
+                            const int32_t accel[3], const int32_t mag[3])
+{
+    // First do 6-axis update
+    vqf_fixed_update_q(state, gyro, accel);
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    if (mag != NULL) {
+        apply_mag_correction(state, mag);
+    }
+#else
+    (void)mag;
+#endif
+}
+
+RAM_CODE_FUSION
+void HOT vqf_fixed_propagate_q(vqf_fixed_state_t *state, const int32_t gyro[3], int32_t half_dt)
+{
+    integrate_gyro(state, gyro, half_dt);
+}
+
+void vqf_fixed_propagate_delta(vqf_fixed_state_t *state, const float dtheta[3], float dt)
+{
+    const float s = 1.0f / 1073741824.0f;
+    float phi[3], dqf[4];
+    for (int i = 0; i < 3; i++) {
+        phi[i] = dtheta[i] - state->gyro_bias[i] * s * dt;
+    }
+    fm_rotvec_to_quat(phi, dqf);
+
+    int32_t dq[4], q[4];
+    for (int i = 0; i < 4; i++) {
+        dq[i] = (int32_t)(dqf[i] * 1073741823.0f);     // |dq[i]| <= 1
+    }
+    memcpy(q, state->quat, sizeof(q));
+    fx_quat_mul(q, dq, state->quat);
+    fx_quat_normalize(state->quat);
+}
+
+RAM_CODE_FUSION
+void vqf_fixed_correct_q(vqf_fixed_state_t *state, const int32_t gyro[3],
+                         const int32_t accel[3], const int32_t mag[3])
+{
+    correct_core(state, gyro, accel, state->k_acc);
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    if (mag != NULL) {
+        apply_mag_correction(state, mag);
+    }
+#else
+    (void)mag;
+#endif
+}
+
+/*============================================================================
+ * Float Wrappers
+ *============================================================================*/
+
+static FORCE_INLINE void to_q(const float in[3], int32_t out[3], float scale)
+{
+    out[0] = (int32_t)(in[0] * scale);
+    out[1] = (int32_t)(in[1] * scale);
+    out[2] = (int32_t)(in[2] * scale);
+}
+
+void vqf_fixed_update(vqf_fixed_state_t *state, const float gyro[3], const float accel[3])
+{
+    int32_t g[3], a[3];
+    to_q(gyro, g, (float)(1L << VQF_FIXED_GYRO_FRAC));
+    to_q(accel, a, (float)(1L << VQF_FIXED_ACC_FRAC));
+    vqf_fixed_update_q(state, g, a);
+}
+
+void vqf_fixed_update_mag(vqf_fixed_state_t *state, const float gyro[3],
+                          const float accel[3], const float mag[3])
+{
+    int32_t g[3], a[3], m[3];
+    to_q(gyro, g, (float)(1L << VQF_FIXED_GYRO_FRAC));
+    to_q(accel, a, (float)(1L << VQF_FIXED_ACC_FRAC));
+    if (mag == NULL) {
+        vqf_fixed_update_q(state, g, a);
+        return;
+    }
+    to_q(mag, m, (float)(1L << VQF_FIXED_MAG_FRAC));
+    vqf_fixed_update_mag_q(state, g, a, m);
+}
+
+void vqf_fixed_propagate(vqf_fixed_state_t *state, const float gyro[3], float dt)
+{
+    int32_t g[3];
+    to_q(gyro, g, (float)(1L << VQF_FIXED_GYRO_FRAC));
+    vqf_fixed_propagate_q(state, g, (int32_t)(dt * 0.5f * 1073741824.0f));
+}
+
+void vqf_fixed_correct(vqf_fixed_state_t *state, const float gyro[3], const float accel[3])
+{
+    int32_t g[3], a[3];
+    to_q(gyro, g, (float)(1L << VQF_FIXED_GYRO_FRAC));
+    to_q(accel, a, (float)(1L << VQF_FIXED_ACC_FRAC));
+    vqf_fixed_correct_q(state, g, a, NULL);
+}
+
+void vqf_fixed_correct_mag(vqf_fixed_state_t *state, const float gyro[3],
+                           const float accel[3], const float mag[3])
+{
+    int32_t g[3], a[3], m[3];
+    to_q(gyro, g, (float)(1L << VQF_FIXED_GYRO_FRAC));
+    to_q(accel, a, (float)(1L << VQF_FIXED_ACC_FRAC));
+    if (mag == NULL) {
+        vqf_fixed_correct_q(state, g, a, NULL);
+        return;
+    }
+    to_q(mag, m, (float)(1L << VQF_FIXED_MAG_FRAC));
+    vqf_fixed_correct_q(state, g, a, m);
+}
+
+void vqf_fixed_get_quat(const vqf_fixed_state_t *state, float quat[4])
+{
+    const float s = 1.0f / 1073741824.0f;
+    quat[0] = state->quat[0] * s;
+    quat[1] = state->quat[1] * s;
+    quat[2] = state->quat[2] * s;
+    quat[3] = state->quat[3] * s;
+}
+
+void vqf_fixed_set_quat(vqf_fixed_state_t *state, const float quat[4])
+{
+    for (int i = 0; i < 4; i++) {
+        float v = quat[i];
+        if (v > 1.0f) v = 1.0f;
+        if (v < -1.0f) v = -1.0f;
+        state->quat[i] = (int32_t)(v * 1073741823.0f);
+    }
+    fx_quat_normalize(state->quat);
+}
+
+void vqf_fixed_get_bias(const vqf_fixed_state_t *state, float bias[3])
+{
+    const float s = 1.0f / 1073741824.0f;
+    bias[0] = state->gyro_bias[0] * s;
+    bias[1] = state->gyro_bias[1] * s;
+    bias[2] = state->gyro_bias[2] * s;
+}
+
+void vqf_fixed_set_bias(vqf_fixed_state_t *state, const float bias[3])
+{
+    for (int i = 0; i < 3; i++) {
+        float b = bias[i];
+        if (b > 1.9f) b = 1.9f;
+        if (b < -1.9f) b = -1.9f;
+        state->gyro_bias[i] = (int32_t)(b * 1073741824.0f);
+        // Reset covariance to reflect known bias
+        state->bias_p[i] = FX(0.01);
+    }
+}
+
+void vqf_fixed_save_checkpoint(const vqf_fixed_state_t *state, fusion_checkpoint_t *ckpt)
+{
+    const float s = 1.0f / 1073741824.0f;
+
+    fusion_ckpt_header(ckpt, FUSION_VQF_FIXED);
+    vqf_fixed_get_quat(state, ckpt->quat);
+    vqf_fixed_get_bias(state, ckpt->gyro_bias);
+    for (int i = 0; i < 3; i++) {
+        ckpt->acc_lp[i] = state->acc_lp[i] * s;
+    }
+    ckpt->flags |= FUSION_CKPT_F_ACC_LP;
+
+    int32_t p = state->bias_p[0];
+    if (state->bias_p[1] > p) p = state->bias_p[1];
+    if (state->bias_p[2] > p) p = state->bias_p[2];
+    ckpt->bias_sigma = fusion_ckpt_sigma(p * s);
+
+    if (state->flags & VQF_FIXED_FLAG_REST) ckpt->flags |= FUSION_CKPT_F_REST;
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    for (int i = 0; i < 3; i++) {
+        ckpt->mag_ref[i] = state->mag_ref[i] * s;
+    }
+    ckpt->flags |= FUSION_CKPT_F_MAG;
+#else
+    memset(ckpt->mag_ref, 0, sizeof(ckpt->mag_ref));
+#endif
+}
+
+static FORCE_INLINE int32_t unit_to_q30(float v)
+{
+    if (v > 1.0f) v = 1.0f;
+    if (v < -1.0f) v = -1.0f;
+    return (int32_t)(v * 1073741823.0f);
+}
+
+int vqf_fixed_load_checkpoint(vqf_fixed_state_t *state, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    vqf_fixed_set_quat(state, ckpt->quat);
+    for (int i = 0; i < 3; i++) {
+        state->gyro_bias[i] = (int32_t)(ckpt->gyro_bias[i] * 1073741824.0f);
+        state->bias_motion[i] = 0;
+    }
+
+    if (ckpt->bias_sigma > 0.0f) {
+        float p = ckpt->bias_sigma * ckpt->bias_sigma;
+        if (p > 1.0f) p = 1.0f;
+        for (int i = 0; i < 3; i++) {
+            state->bias_p[i] = (int32_t)(p * 1073741824.0f);
+        }
+    }
+
+    if (ckpt->flags & FUSION_CKPT_F_ACC_LP) {
+        for (int i = 0; i < 3; i++) {
+            state->acc_lp[i] = unit_to_q30(ckpt->acc_lp[i]);
+        }
+    }
+
+    // 保存时已静止: 直接进入 Rest, 不再等待 rest_count_th
+    if (ckpt->flags & FUSION_CKPT_F_REST) {
+        state->rest_count = state->rest_count_th;
+        state->flags |= VQF_FIXED_FLAG_REST;
+    }
+
+#if VQF_FIXED_USE_MAGNETOMETER
+    if ((ckpt->flags & FUSION_CKPT_F_MAG) && ckpt->engine == FUSION_VQF_FIXED) {
+        for (int i = 0; i < 3; i++) {
+            state->mag_ref[i] = unit_to_q30(ckpt->mag_ref[i]);
+        }
+    }
+#endif
+    return 0;
+}
+
+void vqf_fixed_reset(vqf_fixed_state_t *state)
+{
+    float dt = state->dt;
+    float tau_acc = state->tau_acc;
+    float tau_mag = state->tau_mag;
+
+    vqf_fixed_init(state, dt, tau_acc, tau_mag);
+}
@@ -55,6 +55,33 @@ void vqf_opt_reset(vqf_opt_state_t *state)
     state->sample_count = 0;
 }
 
+void vqf_opt_save_checkpoint(const vqf_opt_state_t *state, fusion_checkpoint_t *ckpt)
+{
+    fusion_ckpt_header(ckpt, FUSION_VQF_OPT);
+    memcpy(ckpt->quat, state->quat, sizeof(ckpt->quat));
+    memcpy(ckpt->gyro_bias, state->gyro_bias, sizeof(ckpt->gyro_bias));
+    memcpy(ckpt->acc_lp, state->acc_lp, sizeof(ckpt->acc_lp));
+    memset(ckpt->mag_ref, 0, sizeof(ckpt->mag_ref));
+    ckpt->bias_sigma = 0.0f;    // 无偏差协方差
+    ckpt->flags |= FUSION_CKPT_F_ACC_LP;
+}
+
+int vqf_opt_load_checkpoint(vqf_opt_state_t *state, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    float inv_norm = fm_inv_sqrt(ckpt->quat[0] * ckpt->quat[0] + ckpt->quat[1] * ckpt->quat[1] +
+                                 ckpt->quat[2] * ckpt->quat[2] + ckpt->quat[3] * ckpt->quat[3]);
+    for (int i = 0; i < 4; i++) {
+        state->quat[i] = ckpt->quat[i] * inv_norm;
+    }
+    memcpy(state->gyro_bias, ckpt->gyro_bias, sizeof(state->gyro_bias));
+    if (ckpt->flags & FUSION_CKPT_F_ACC_LP) {
+        memcpy(state->acc_lp, ckpt->acc_lp, sizeof(state->acc_lp));
+    }
+    return 0;
+}
+
 void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
                                const float accel[3], const float mag[3])
 {
@@ -78,7 +105,7 @@ void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
     
     // Compute accelerometer correction
     float ax = accel[0], ay = accel[1], az = accel[2];
-    float acc_norm = fast_invsqrt(ax*ax + ay*ay + az*az);
+    float acc_norm = fm_inv_sqrt(ax*ax + ay*ay + az*az);
     
     if (acc_norm > 0.0f && acc_norm < 1e10f) {
         ax *= acc_norm;
@@ -86,15 +113,12 @@ void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
         az *= acc_norm;
         
         // Low-pass filter accelerometer
+        // v0.6.3: acc_lp 在机体系滤波, 转动时滞后 tau_acc; 只留给检查点, 误差用本样本
         float alpha = dt / (state->tau_acc + dt);
         state->acc_lp[0] += alpha * (ax - state->acc_lp[0]);
         state->acc_lp[1] += alpha * (ay - state->acc_lp[1]);
         state->acc_lp[2] += alpha * (az - state->acc_lp[2]);
         
-        ax = state->acc_lp[0];
-        ay = state->acc_lp[1];
-        az = state->acc_lp[2];
-        
         // Estimated direction of gravity
         float vx = 2.0f * (q1 * q3 - q0 * q2);
         float vy = 2.0f * (q0 * q1 + q2 * q3);
@@ -112,18 +136,19 @@ void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
         qDot3 += beta * (q0 * ez + q1 * ey - q2 * ex) * 0.5f;
         
         // Update gyro bias estimate (slow adaptation)
+        // v0.6.3: 修正量 +e 加在角速度上, 偏差 (从陀螺仪中减去) 应向 -e 方向积分
         if (state->sample_count > 200) {
             float bias_alpha = 0.0001f;
-            state->gyro_bias[0] += bias_alpha * ex;
-            state->gyro_bias[1] += bias_alpha * ey;
-            state->gyro_bias[2] += bias_alpha * ez;
+            state->gyro_bias[0] -= bias_alpha * ex;
+            state->gyro_bias[1] -= bias_alpha * ey;
+            state->gyro_bias[2] -= bias_alpha * ez;
         }
     }
     
     // Optional magnetometer correction
     if (mag != NULL && state->tau_mag > 0.0f) {
         float mx = mag[0], my = mag[1], mz = mag[2];
-        float mag_norm = fast_invsqrt(mx*mx + my*my + mz*mz);
+        float mag_norm = fm_inv_sqrt(mx*mx + my*my + mz*mz);
         
         if (mag_norm > 0.0f && mag_norm < 1e10f) {
             mx *= mag_norm;
@@ -133,7 +158,7 @@ void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
             // Reference direction of Earth's magnetic field
             float hx = 2.0f * (mx * (0.5f - q2*q2 - q3*q3) + my * (q1*q2 - q0*q3) + mz * (q1*q3 + q0*q2));
             float hy = 2.0f * (mx * (q1*q2 + q0*q3) + my * (0.5f - q1*q1 - q3*q3) + mz * (q2*q3 - q0*q1));
-            float bx = fast_sqrt(hx*hx + hy*hy);
+            float bx = fm_sqrt(hx*hx + hy*hy);
             float bz = 2.0f * (mx * (q1*q3 - q0*q2) + my * (q2*q3 + q0*q1) + mz * (0.5f - q1*q1 - q2*q2));
             
             // Estimated direction of magnetic field
@@ -160,12 +185,13 @@ void NO_INLINE vqf_opt_update(vqf_opt_state_t *state, const float gyro[3],
     q2 += qDot2 * dt;
     q3 += qDot3 * dt;
     
-    // Normalize quaternion
-    float inv_norm = fast_invsqrt(q0*q0 + q1*q1 + q2*q2 + q3*q3);
-    state->quat[0] = q0 * inv_norm;
-    state->quat[1] = q1 * inv_norm;
-    state->quat[2] = q2 * inv_norm;
-    state->quat[3] = q3 * inv_norm;
+    // Normalize quaternion (v0.6.3: fm_quat_renorm, 误差小时惰性修正)
+    float q[4] = { q0, q1, q2, q3 };
+    fm_quat_renorm(q);
+    state->quat[0] = q[0];
+    state->quat[1] = q[1];
+    state->quat[2] = q[2];
+    state->quat[3] = q[3];
     
     state->sample_count++;
 }
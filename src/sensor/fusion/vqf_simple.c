@@ -14,6 +14,7 @@
  */
 
 #include "vqf_simple.h"
+#include "fast_math.h"
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
@@ -29,29 +30,6 @@
  * Helper Functions
  *============================================================================*/
 
-static inline float fast_sqrt(float x)
-{
-    // Newton-Raphson approximation for sqrt
-    if (x <= 0.0f) return 0.0f;
-    float guess = x * 0.5f;
-    for (int i = 0; i < 3; i++) {
-        guess = 0.5f * (guess + x / guess);
-    }
-    return guess;
-}
-
-static void quat_normalize(float q[4])
-{
-    float norm = fast_sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
-    if (norm > 1e-10f) {
-        float inv = 1.0f / norm;
-        q[0] *= inv;
-        q[1] *= inv;
-        q[2] *= inv;
-        q[3] *= inv;
-    }
-}
-
 static void quat_multiply(const float q1[4], const float q2[4], float out[4])
 {
     out[0] = q1[0]*q2[0] - q1[1]*q2[1] - q1[2]*q2[2] - q1[3]*q2[3];
@@ -138,12 +116,12 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
     };
     
     // Gyroscope integration using quaternion derivative
-    float omega_mag = fast_sqrt(gyr[0]*gyr[0] + gyr[1]*gyr[1] + gyr[2]*gyr[2]);
+    float omega_mag = fm_sqrt(gyr[0]*gyr[0] + gyr[1]*gyr[1] + gyr[2]*gyr[2]);
     
     if (omega_mag > 1e-10f) {
         float half_angle = 0.5f * omega_mag * dt;
-        float sin_half = sinf(half_angle);
-        float cos_half = cosf(half_angle);
+        float sin_half, cos_half;
+        fm_sincos_small(half_angle, &sin_half, &cos_half);
         
         float dq[4] = {
             cos_half,
@@ -155,11 +133,11 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
         float new_quat[4];
         quat_multiply(vqf.quat, dq, new_quat);
         memcpy(vqf.quat, new_quat, sizeof(vqf.quat));
-        quat_normalize(vqf.quat);
+        fm_quat_renorm(vqf.quat);
     }
     
     // Accelerometer correction (gravity vector alignment)
-    float acc_norm = fast_sqrt(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
+    float acc_norm = fm_sqrt(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
     
     if (acc_norm > 0.5f && acc_norm < 1.5f) {
         // Normalize acceleration
@@ -189,14 +167,14 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
         };
         
         // Apply as small rotation
-        float corr_mag = fast_sqrt(correction[0]*correction[0] + 
+        float corr_mag = fm_sqrt(correction[0]*correction[0] + 
                                    correction[1]*correction[1] + 
                                    correction[2]*correction[2]);
         
         if (corr_mag > 1e-10f) {
             float half_corr = 0.5f * corr_mag;
-            float sin_half = sinf(half_corr);
-            float cos_half = cosf(half_corr);
+            float sin_half, cos_half;
+            fm_sincos_small(half_corr, &sin_half, &cos_half);
             
             float dq_corr[4] = {
                 cos_half,
@@ -208,7 +186,7 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
             float new_quat[4];
             quat_multiply(dq_corr, vqf.quat, new_quat);
             memcpy(vqf.quat, new_quat, sizeof(vqf.quat));
-            quat_normalize(vqf.quat);
+            fm_quat_renorm(vqf.quat);
         }
         
         // Bias estimation (slow adaptation)
@@ -220,7 +198,7 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
     
     // Magnetometer correction (heading only)
     if (mag != NULL) {
-        float mag_norm = fast_sqrt(mag[0]*mag[0] + mag[1]*mag[1] + mag[2]*mag[2]);
+        float mag_norm = fm_sqrt(mag[0]*mag[0] + mag[1]*mag[1] + mag[2]*mag[2]);
         
         if (mag_norm > 10.0f && mag_norm < 100.0f) {
             // Normalize magnetometer
@@ -231,24 +209,27 @@ void vqf_update(const float gyro[3], const float accel[3], const float *mag)
             rotate_vector(vqf.quat, mag_n, mag_world);
             
             // Project to horizontal plane
-            float heading_error = atan2f(mag_world[1], mag_world[0]);
+            float heading_error = fm_atan2(mag_world[1], mag_world[0]);
             
             // Apply yaw correction only
+            // v0.6.3: 转动 -误差 (与 vqf_advanced 一致), 原先的正号是正反馈, 航向越修越偏
             float k_mag = dt / vqf.tau_mag;
-            float yaw_corr = heading_error * k_mag * 0.5f;
+            float yaw_corr = -heading_error * k_mag * 0.5f;
             
             // Rotation around world Z axis
+            float sin_yaw, cos_yaw;
+            fm_sincos_small(yaw_corr, &sin_yaw, &cos_yaw);
             float dq_yaw[4] = {
-                cosf(yaw_corr),
+                cos_yaw,
                 0.0f,
                 0.0f,
-                sinf(yaw_corr)
+                sin_yaw
             };
             
             float new_quat[4];
             quat_multiply(dq_yaw, vqf.quat, new_quat);
             memcpy(vqf.quat, new_quat, sizeof(vqf.quat));
-            quat_normalize(vqf.quat);
+            fm_quat_renorm(vqf.quat);
         }
     }
 }
@@ -268,19 +249,19 @@ void vqf_get_euler(float *roll, float *pitch, float *yaw)
     // Roll (x-axis rotation)
     float sinr_cosp = 2.0f * (q0 * q1 + q2 * q3);
     float cosr_cosp = 1.0f - 2.0f * (q1 * q1 + q2 * q2);
-    *roll = atan2f(sinr_cosp, cosr_cosp) * RAD_TO_DEG;
+    *roll = fm_atan2(sinr_cosp, cosr_cosp) * RAD_TO_DEG;
     
     // Pitch (y-axis rotation)
     float sinp = 2.0f * (q0 * q2 - q3 * q1);
     if (fabsf(sinp) >= 1.0f)
         *pitch = copysignf(90.0f, sinp);
     else
-        *pitch = asinf(sinp) * RAD_TO_DEG;
+        *pitch = fm_asin(sinp) * RAD_TO_DEG;
     
     // Yaw (z-axis rotation)
     float siny_cosp = 2.0f * (q0 * q3 + q1 * q2);
     float cosy_cosp = 1.0f - 2.0f * (q2 * q2 + q3 * q3);
-    *yaw = atan2f(siny_cosp, cosy_cosp) * RAD_TO_DEG;
+    *yaw = fm_atan2(siny_cosp, cosy_cosp) * RAD_TO_DEG;
 }
 
 void vqf_reset(void)
@@ -15,6 +15,9 @@
  */
 
 #include "vqf_ultra.h"
+#if VQF_ULTRA_QUAT_Q30
+#include "fx_math.h"
+#endif
 #include <string.h>
 
 /*============================================================================
@@ -40,6 +43,9 @@
 #define Q15_MIN_ACC     16384       // 0.5 in Q15
 #define Q15_MAX_ACC     49152       // 1.5 in Q15 (approximate)
 
+// Rest 进入计数 (~0.5 s at 200 Hz), 计数封顶在 REST_COUNT_TH + 1
+#define REST_COUNT_TH   100
+
 /*============================================================================
  * Lookup Tables (in Flash)
  *============================================================================*/
@@ -142,6 +148,31 @@ static FORCE_INLINE q15_t q15_add_sat(q15_t a, q15_t b)
     return (q15_t)sum;
 }
 
+static q15_t float_to_q15_sat(float v)
+{
+    int32_t x = (int32_t)(v * 32768.0f);
+    if (x > 32767) x = 32767;
+    if (x < -32768) x = -32768;
+    return (q15_t)x;
+}
+
+// v0.6.3: 四元数存储格式 (VQF_ULTRA_QUAT_Q30)
+#if VQF_ULTRA_QUAT_Q30
+#define QUAT_ONE        FX_ONE
+#define QUAT_TO_FLOAT   (1.0f / 1073741824.0f)
+
+static int32_t float_to_quat_sat(float v)
+{
+    if (v >= 1.0f) return FX_ONE;
+    if (v <= -1.0f) return -FX_ONE;
+    return (int32_t)(v * 1073741824.0f);
+}
+#else
+#define QUAT_ONE        Q15_ONE
+#define QUAT_TO_FLOAT   (1.0f / 32768.0f)
+#define float_to_quat_sat   float_to_q15_sat
+#endif
+
 // Fast square root using lookup + Newton-Raphson
 // Input: Q15 (0 to 1), Output: Q15
 static q15_t q15_sqrt(q15_t x)
@@ -200,35 +231,34 @@ static FORCE_INLINE q15_t q15_cos(int32_t angle)
  *============================================================================*/
 
 // Normalize quaternion (in-place, takes pointer to first element)
+// v0.6.3: 牛顿迭代 s = (3 - |q|²) / 2, 旧版查表 invsqrt 的输入范围错误, 每步把范数缩小
+#if !VQF_ULTRA_QUAT_Q30
 static void quat_normalize_q15(q15_t *q)
 {
-    // Compute magnitude squared
-    int32_t mag_sq = (int32_t)q[0]*q[0] + (int32_t)q[1]*q[1] + 
-                     (int32_t)q[2]*q[2] + (int32_t)q[3]*q[3];
-    
-    // Fast inverse square root
-    q15_t inv_mag;
-    if (mag_sq > 0) {
-        // Shift to Q15 range
-        int shift = 0;
-        while (mag_sq > 32767 && shift < 16) {
-            mag_sq >>= 2;
-            shift++;
+    for (int iter = 0; iter < 3; iter++) {
+        // |q|² in Q30 (各分量 <= 1, 和 <= 4, 用无符号避免溢出)
+        uint32_t mag_sq = (uint32_t)((int32_t)q[0]*q[0]) + (uint32_t)((int32_t)q[1]*q[1]) +
+                          (uint32_t)((int32_t)q[2]*q[2]) + (uint32_t)((int32_t)q[3]*q[3]);
+        if (mag_sq < (1U << 26)) {
+            // 退化 (|q| < 0.25): 回到单位四元数
+            q[0] = Q15_ONE; q[1] = 0; q[2] = 0; q[3] = 0;
+            return;
+        }
+
+        int32_t err = (int32_t)(mag_sq >> 15) - 32768;     // |q|² - 1, Q15
+        if (err > -4 && err < 4) return;
+
+        int32_t scale = 49152 - (int32_t)(mag_sq >> 16);    // (3 - |q|²) / 2, Q15
+        if (scale < Q15_HALF) scale = Q15_HALF;             // |q| 远大于 1 时限制步长
+        for (int i = 0; i < 4; i++) {
+            int32_t v = ((int32_t)q[i] * scale) >> 15;
+            if (v > Q15_ONE) v = Q15_ONE;
+            if (v < -Q15_ONE) v = -Q15_ONE;
+            q[i] = (q15_t)v;
         }
-        inv_mag = q15_invsqrt((q15_t)mag_sq);
-        inv_mag <<= shift;
-    } else {
-        // Reset to identity
-        q[0] = Q15_ONE; q[1] = 0; q[2] = 0; q[3] = 0;
-        return;
     }
-    
-    // Normalize
-    q[0] = q15_mul(q[0], inv_mag);
-    q[1] = q15_mul(q[1], inv_mag);
-    q[2] = q15_mul(q[2], inv_mag);
-    q[3] = q15_mul(q[3], inv_mag);
 }
+#endif
 
 // Quaternion multiply: out = a * b
 static void quat_multiply_q15(const q15_t a[4], const q15_t b[4], q15_t out[4])
@@ -256,9 +286,9 @@ static void quat_multiply_q15(const q15_t a[4], const q15_t b[4], q15_t out[4])
 //     q15_t k_bias;           // 2 bytes - bias gain
 //     uint16_t rest_count;    // 2 bytes - rest counter
 //     uint16_t sample_count;  // 2 bytes - total samples
+//     uint16_t k_gyro;        // 2 bytes - rate -> half-angle gain
 //     uint8_t flags;          // 1 byte  - status flags
-//     uint8_t dt_shift;       // 1 byte  - dt as power of 2
-// } vqf_ultra_state_t;        // Total: 30 bytes (padded to 32)
+// } vqf_ultra_state_t;        // Total: 31 bytes (packed)
 
 /*============================================================================
  * Public API
@@ -269,14 +299,12 @@ void vqf_ultra_init(vqf_ultra_state_t *state, uint16_t sample_rate_hz)
     memset(state, 0, sizeof(vqf_ultra_state_t));
     
     // Identity quaternion
-    state->quat[0] = Q15_ONE;
+    state->quat[0] = QUAT_ONE;
     
-    // Compute dt as shift (for power-of-2 rates)
-    // 200Hz -> dt = 0.005s = 1/200 ≈ 1/256 = shift 8
-    // 100Hz -> dt = 0.01s = 1/100 ≈ 1/128 = shift 7
-    if (sample_rate_hz >= 200) state->dt_shift = 8;
-    else if (sample_rate_hz >= 100) state->dt_shift = 7;
-    else state->dt_shift = 6;
+    // v0.6.3: 半角增量系数 h(Q19) = g * k_gyro >> 16, g 单位 0.01 deg/s x 6
+    // k_gyro = (π / 108000) / (2·ODR) · 2^35 ≈ 499755 / ODR (200Hz: 2499)
+    if (sample_rate_hz < VQF_ULTRA_MIN_RATE_HZ) sample_rate_hz = VQF_ULTRA_MIN_RATE_HZ;
+    state->k_gyro = (uint16_t)((499755UL + sample_rate_hz / 2) / sample_rate_hz);
     
     // Accelerometer gain (tau=3s at 200Hz)
     // k = 1 - exp(-dt/tau) ≈ dt/tau for small dt
@@ -292,109 +320,179 @@ void vqf_ultra_init(vqf_ultra_state_t *state, uint16_t sample_rate_hz)
     state->flags = VQF_ULTRA_INITIALIZED;
 }
 
+// 32 位整数平方根 (逐位法, 16 次迭代)
+static uint32_t isqrt32(uint32_t x)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+static FORCE_INLINE int32_t clamp_i32(int32_t v, int32_t lim)
+{
+    return (v > lim) ? lim : ((v < -lim) ? -lim : v);
+}
+
+// 四舍五入右移 (n >= 1)
+static FORCE_INLINE int32_t rshift_round(int32_t v, int n)
+{
+    return (v + (1L << (n - 1))) >> n;
+}
+
 void HOT vqf_ultra_update(vqf_ultra_state_t *state, 
                           const int16_t gyro_raw[3],   // Raw gyro in 0.01 deg/s
                           const int16_t accel_raw[3])  // Raw accel in 0.001g
 {
-    // Convert gyro to Q15 rad/s
-    // gyro_raw is in 0.01 deg/s = 0.000175 rad/s
-    // Scale: 0.000175 * 32768 ≈ 5.7 per LSB
-    q15_t gx = (q15_t)((gyro_raw[0] * 6) >> 0) - state->gyro_bias[0];
-    q15_t gy = (q15_t)((gyro_raw[1] * 6) >> 0) - state->gyro_bias[1];
-    q15_t gz = (q15_t)((gyro_raw[2] * 6) >> 0) - state->gyro_bias[2];
-    
-    // Convert accel to Q15 (normalize to ~1g)
-    // accel_raw is in 0.001g, so divide by 1000 and scale to Q15
-    // 1000 * 32.768 = 32768, so direct use after /1000
-    q15_t ax = (q15_t)((accel_raw[0] * 33) >> 0);
-    q15_t ay = (q15_t)((accel_raw[1] * 33) >> 0);
-    q15_t az = (q15_t)((accel_raw[2] * 33) >> 0);
+    // v0.6.3: 角速度保持 int32 (0.01 deg/s x 6, 与偏差同单位);
+    // 旧版截断为 q15_t, 超过约 54 deg/s 即回绕
+    int32_t gx = (int32_t)gyro_raw[0] * 6 - state->gyro_bias[0];
+    int32_t gy = (int32_t)gyro_raw[1] * 6 - state->gyro_bias[1];
+    int32_t gz = (int32_t)gyro_raw[2] * 6 - state->gyro_bias[2];
     
     // ---- Gyroscope Integration ----
     // q_dot = 0.5 * q * [0, gx, gy, gz]
-    // Using dt as shift
+    // v0.6.3: 半角增量 h = ω·dt/2 (Q19 rad), k_gyro 在 init 中按实际采样率计算;
+    // 旧版以 2 的幂次近似 dt (200Hz 按 1/256), 积分增益偏低约 18%
+#if VQF_ULTRA_QUAT_Q30
+    // v0.6.3: Q30 累加 - 半角增量直接取 Q30 (g·k_gyro 为 Q35), 慢速旋转不再被
+    // Q19 截断为 0; 偏差较大时 g·k_gyro 可超过 int32, 用 64 位乘积
+    int32_t hx = (int32_t)(((int64_t)gx * state->k_gyro + 16) >> 5);
+    int32_t hy = (int32_t)(((int64_t)gy * state->k_gyro + 16) >> 5);
+    int32_t hz = (int32_t)(((int64_t)gz * state->k_gyro + 16) >> 5);
+    int32_t q0 = state->quat[0], q1 = state->quat[1];
+    int32_t q2 = state->quat[2], q3 = state->quat[3];
+    {
+        int32_t qt[4];
+        qt[0] = q0 - fx_mul(q1, hx) - fx_mul(q2, hy) - fx_mul(q3, hz);
+        qt[1] = q1 + fx_mul(q0, hx) + fx_mul(q2, hz) - fx_mul(q3, hy);
+        qt[2] = q2 + fx_mul(q0, hy) - fx_mul(q1, hz) + fx_mul(q3, hx);
+        qt[3] = q3 + fx_mul(q0, hz) + fx_mul(q1, hy) - fx_mul(q2, hx);
+        fx_quat_normalize(qt);
+        state->quat[0] = qt[0]; state->quat[1] = qt[1];
+        state->quat[2] = qt[2]; state->quat[3] = qt[3];
+    }
+#else
+    int32_t hx = (gx * state->k_gyro) >> 16;
+    int32_t hy = (gy * state->k_gyro) >> 16;
+    int32_t hz = (gz * state->k_gyro) >> 16;
+    
     q15_t q0 = state->quat[0], q1 = state->quat[1];
     q15_t q2 = state->quat[2], q3 = state->quat[3];
     
-    // Quaternion derivative (simplified, half factor absorbed in dt)
-    int32_t qd0 = -(int32_t)q1*gx - (int32_t)q2*gy - (int32_t)q3*gz;
-    int32_t qd1 =  (int32_t)q0*gx + (int32_t)q2*gz - (int32_t)q3*gy;
-    int32_t qd2 =  (int32_t)q0*gy - (int32_t)q1*gz + (int32_t)q3*gx;
-    int32_t qd3 =  (int32_t)q0*gz + (int32_t)q1*gy - (int32_t)q2*gx;
-    
-    // Integrate: q += qd * dt/2
-    // dt is 1/(2^dt_shift), half factor makes it 1/(2^(dt_shift+1))
-    uint8_t shift = state->dt_shift + 16;  // +15 for Q15, +1 for half
-    state->quat[0] = q0 + (q15_t)(qd0 >> shift);
-    state->quat[1] = q1 + (q15_t)(qd1 >> shift);
-    state->quat[2] = q2 + (q15_t)(qd2 >> shift);
-    state->quat[3] = q3 + (q15_t)(qd3 >> shift);
-    
-    // Normalize quaternion (copy to local, normalize, copy back)
+    // |q| <= 1, 每行之和 <= 32767·|h|, 50Hz 满量程下仍在 int32 内
+    int32_t qd0 = -(int32_t)q1*hx - (int32_t)q2*hy - (int32_t)q3*hz;
+    int32_t qd1 =  (int32_t)q0*hx + (int32_t)q2*hz - (int32_t)q3*hy;
+    int32_t qd2 =  (int32_t)q0*hy - (int32_t)q1*hz + (int32_t)q3*hx;
+    int32_t qd3 =  (int32_t)q0*hz + (int32_t)q1*hy - (int32_t)q2*hx;
+    
+    // Integrate: q += q ⊗ h (四舍五入, 减小慢速旋转的截断偏差)
     {
-        q15_t qt[4] = {state->quat[0], state->quat[1], state->quat[2], state->quat[3]};
+        q15_t qt[4];
+        qt[0] = (q15_t)clamp_i32(q0 + rshift_round(qd0, 19), Q15_ONE);
+        qt[1] = (q15_t)clamp_i32(q1 + rshift_round(qd1, 19), Q15_ONE);
+        qt[2] = (q15_t)clamp_i32(q2 + rshift_round(qd2, 19), Q15_ONE);
+        qt[3] = (q15_t)clamp_i32(q3 + rshift_round(qd3, 19), Q15_ONE);
         quat_normalize_q15(qt);
         state->quat[0] = qt[0]; state->quat[1] = qt[1];
         state->quat[2] = qt[2]; state->quat[3] = qt[3];
     }
+#endif
     
     // ---- Accelerometer Correction ----
-    // Compute accel magnitude
-    int32_t acc_sq = (int32_t)ax*ax + (int32_t)ay*ay + (int32_t)az*az;
+    // v0.6.3: 幅值在 mg 下计算 (1g = 1e6), 旧版 mg*33 在 1g 处即溢出 q15
+    int32_t amx = accel_raw[0], amy = accel_raw[1], amz = accel_raw[2];
+    uint32_t acc_sq = (uint32_t)(amx*amx) + (uint32_t)(amy*amy) + (uint32_t)(amz*amz);
     
     // Check if magnitude is close to 1g (skip during high acceleration)
-    // 1g^2 in our scaling ≈ 32768^2 = 1073741824
-    // Allow 0.5g to 1.5g: 268M to 2415M (use unsigned for comparison)
-    uint32_t acc_sq_u = (uint32_t)acc_sq;
-    if (acc_sq_u < 268000000U || acc_sq_u > 2147000000U) {
+    // Allow 0.5g to 1.5g
+    if (acc_sq < 250000U || acc_sq > 2250000U) {
         goto skip_accel;
     }
     
-    // Normalize accel
-    q15_t inv_acc = q15_invsqrt((q15_t)(acc_sq >> 15));
-    ax = q15_mul(ax, inv_acc);
-    ay = q15_mul(ay, inv_acc);
-    az = q15_mul(az, inv_acc);
+    // Normalize accel to Q15 unit vector
+    int32_t acc_norm = (int32_t)isqrt32(acc_sq);
+    q15_t ax = (q15_t)clamp_i32((amx * Q15_ONE) / acc_norm, Q15_ONE);
+    q15_t ay = (q15_t)clamp_i32((amy * Q15_ONE) / acc_norm, Q15_ONE);
+    q15_t az = (q15_t)clamp_i32((amz * Q15_ONE) / acc_norm, Q15_ONE);
     
     // Low-pass filter
+    // v0.6.3: acc_lp 在机体系滤波, 转动时滞后; 只留给检查点, 误差用本样本
     state->acc_lp[0] += (q15_t)(((int32_t)(ax - state->acc_lp[0]) * state->k_acc) >> 15);
     state->acc_lp[1] += (q15_t)(((int32_t)(ay - state->acc_lp[1]) * state->k_acc) >> 15);
     state->acc_lp[2] += (q15_t)(((int32_t)(az - state->acc_lp[2]) * state->k_acc) >> 15);
     
     // Estimated gravity from quaternion
-    // v = q^-1 * [0,0,1] * q
+    // v = q^-1 * [0,0,1] * q (Q15, int32 避免 2x 乘法在 ±1 处回绕)
     q0 = state->quat[0]; q1 = state->quat[1];
     q2 = state->quat[2]; q3 = state->quat[3];
     
-    q15_t vx = 2 * (q15_mul(q1, q3) - q15_mul(q0, q2));
-    q15_t vy = 2 * (q15_mul(q0, q1) + q15_mul(q2, q3));
-    q15_t vz = q15_mul(q0, q0) - q15_mul(q1, q1) - q15_mul(q2, q2) + q15_mul(q3, q3);
-    
-    // Error = cross(acc, v)
-    q15_t ex = q15_mul(state->acc_lp[1], vz) - q15_mul(state->acc_lp[2], vy);
-    q15_t ey = q15_mul(state->acc_lp[2], vx) - q15_mul(state->acc_lp[0], vz);
-    q15_t ez = q15_mul(state->acc_lp[0], vy) - q15_mul(state->acc_lp[1], vx);
-    
-    // Apply correction
-    q15_t gain = state->k_acc;
-    state->quat[0] -= (q15_t)(((int32_t)q1*ex + (int32_t)q2*ey + (int32_t)q3*ez) * gain >> 30);
-    state->quat[1] += (q15_t)(((int32_t)q0*ex + (int32_t)q2*ez - (int32_t)q3*ey) * gain >> 30);
-    state->quat[2] += (q15_t)(((int32_t)q0*ey - (int32_t)q1*ez + (int32_t)q3*ex) * gain >> 30);
-    state->quat[3] += (q15_t)(((int32_t)q0*ez + (int32_t)q1*ey - (int32_t)q2*ex) * gain >> 30);
-    
-    // Normalize quaternion (copy to local, normalize, copy back)
+#if VQF_ULTRA_QUAT_Q30
+    int32_t vx = (fx_mul(q1, q3) - fx_mul(q0, q2)) >> 14;
+    int32_t vy = (fx_mul(q0, q1) + fx_mul(q2, q3)) >> 14;
+    int32_t vz = (fx_mul(q0, q0) - fx_mul(q1, q1) - fx_mul(q2, q2) + fx_mul(q3, q3)) >> 15;
+#else
+    int32_t vx = ((int32_t)q1*q3 - (int32_t)q0*q2) >> 14;
+    int32_t vy = ((int32_t)q0*q1 + (int32_t)q2*q3) >> 14;
+    int32_t vz = ((int32_t)q0*q0 - (int32_t)q1*q1 - (int32_t)q2*q2 + (int32_t)q3*q3) >> 15;
+#endif
+    
+    // Error = cross(acc, v), Q15
+    int32_t ex = (ay * vz - az * vy) >> 15;
+    int32_t ey = (az * vx - ax * vz) >> 15;
+    int32_t ez = (ax * vy - ay * vx) >> 15;
+    
+    // Apply correction: q += k_acc · q ⊗ [0, e]
+#if VQF_ULTRA_QUAT_Q30
     {
-        q15_t qt[4] = {state->quat[0], state->quat[1], state->quat[2], state->quat[3]};
+        // e (Q15) · k_acc (Q15) 即为 Q30 修正角
+        int32_t kx = ex * state->k_acc, ky = ey * state->k_acc, kz = ez * state->k_acc;
+        int32_t qt[4];
+        qt[0] = q0 - fx_mul(q1, kx) - fx_mul(q2, ky) - fx_mul(q3, kz);
+        qt[1] = q1 + fx_mul(q0, kx) + fx_mul(q2, kz) - fx_mul(q3, ky);
+        qt[2] = q2 + fx_mul(q0, ky) - fx_mul(q1, kz) + fx_mul(q3, kx);
+        qt[3] = q3 + fx_mul(q0, kz) + fx_mul(q1, ky) - fx_mul(q2, kx);
+        fx_quat_normalize(qt);
+        state->quat[0] = qt[0]; state->quat[1] = qt[1];
+        state->quat[2] = qt[2]; state->quat[3] = qt[3];
+    }
+#else
+    // 先移到 Q22 再乘增益, 避免 int32 溢出; 两次移位都四舍五入 (算术右移向下取整,
+    // 误差很小时每步固定 -1 LSB, 会把四元数分量持续拉向负方向)
+    {
+        int32_t gain = state->k_acc;
+        int32_t c0 = -(int32_t)q1*ex - (int32_t)q2*ey - (int32_t)q3*ez;
+        int32_t c1 =  (int32_t)q0*ex + (int32_t)q2*ez - (int32_t)q3*ey;
+        int32_t c2 =  (int32_t)q0*ey - (int32_t)q1*ez + (int32_t)q3*ex;
+        int32_t c3 =  (int32_t)q0*ez + (int32_t)q1*ey - (int32_t)q2*ex;
+        q15_t qt[4];
+        qt[0] = (q15_t)clamp_i32(q0 + rshift_round(rshift_round(c0, 8) * gain, 22), Q15_ONE);
+        qt[1] = (q15_t)clamp_i32(q1 + rshift_round(rshift_round(c1, 8) * gain, 22), Q15_ONE);
+        qt[2] = (q15_t)clamp_i32(q2 + rshift_round(rshift_round(c2, 8) * gain, 22), Q15_ONE);
+        qt[3] = (q15_t)clamp_i32(q3 + rshift_round(rshift_round(c3, 8) * gain, 22), Q15_ONE);
         quat_normalize_q15(qt);
         state->quat[0] = qt[0]; state->quat[1] = qt[1];
         state->quat[2] = qt[2]; state->quat[3] = qt[3];
     }
+#endif
     
 skip_accel:
     {  // 开始块，避免标签后直接跟声明
     // ---- Rest Detection & Bias Update ----
     // v0.6.2: 优化Rest检测参数，解决"大动稳、小动飘"问题
-    int32_t gyro_sq = (int32_t)gx*gx + (int32_t)gy*gy + (int32_t)gz*gz;
+    // v0.6.3: 平方前限幅, 阈值只需区分约 2.5 deg/s 以内
+    int32_t rx = clamp_i32(gx, 4096), ry = clamp_i32(gy, 4096), rz = clamp_i32(gz, 4096);
+    int32_t gyro_sq = rx*rx + ry*ry + rz*rz;
     
     // v0.6.2: 使用滞后阈值防止呼吸/微动触发Motion
     // 进入Rest: 阈值 ~1.5 deg/s (gyro_sq < 500000)
@@ -403,23 +501,27 @@ skip_accel:
     
     if (gyro_sq < threshold) {
         // v0.6.2: 快速进入Rest (从300降到100，约0.5s at 200Hz)
-        if (state->rest_count < 65535) state->rest_count++;
+        // v0.6.3: 计数封顶, 否则长时间静止后要同样长的转动才能退出, 期间转动被学成偏差
+        if (state->rest_count <= REST_COUNT_TH) state->rest_count++;
         
-        if (state->rest_count > 100) {  // v0.6.2: ~0.5s at 200Hz
+        if (state->rest_count > REST_COUNT_TH) {  // v0.6.2: ~0.5s at 200Hz
             state->flags |= VQF_ULTRA_AT_REST;
-            
-            // Update bias slowly (仅在Rest状态下更新，避免Motion时遗忘)
+        }
+        
+        // Update bias slowly (仅在Rest状态下更新，避免Motion时遗忘)
+        // v0.6.3: 滞后区 (进入与退出阈值之间) 的样本不参与
+        if ((state->flags & VQF_ULTRA_AT_REST) && gyro_sq < 500000) {
             state->gyro_bias[0] += (q15_t)(((int32_t)(gyro_raw[0] * 6) - state->gyro_bias[0]) >> 8);
             state->gyro_bias[1] += (q15_t)(((int32_t)(gyro_raw[1] * 6) - state->gyro_bias[1]) >> 8);
             state->gyro_bias[2] += (q15_t)(((int32_t)(gyro_raw[2] * 6) - state->gyro_bias[2]) >> 8);
         }
+    } else if (state->flags & VQF_ULTRA_AT_REST) {
+        // v0.6.3: 已超出宽松退出阈值, 滞后已由阈值提供, 立即退出
+        state->rest_count = 0;
+        state->flags &= ~VQF_ULTRA_AT_REST;
     } else {
-        // v0.6.2: 缓慢退出Rest，避免呼吸等微动触发Motion
-        if (state->rest_count > 0) {
-            state->rest_count -= 2;  // 退出速度是进入的2倍
-        } else {
-            state->flags &= ~VQF_ULTRA_AT_REST;
-        }
+        // v0.6.2: 进入前的噪声尖峰按 2 倍速率回退计时, 不清零
+        state->rest_count = (state->rest_count >= 2) ? state->rest_count - 2 : 0;
     }
     
     state->sample_count++;
@@ -428,19 +530,25 @@ skip_accel:
 
 void vqf_ultra_get_quat(const vqf_ultra_state_t *state, float quat[4])
 {
-    // Convert Q15 to float
-    quat[0] = (float)state->quat[0] / 32768.0f;
-    quat[1] = (float)state->quat[1] / 32768.0f;
-    quat[2] = (float)state->quat[2] / 32768.0f;
-    quat[3] = (float)state->quat[3] / 32768.0f;
+    // Convert Q15 (Q30) to float
+    quat[0] = (float)state->quat[0] * QUAT_TO_FLOAT;
+    quat[1] = (float)state->quat[1] * QUAT_TO_FLOAT;
+    quat[2] = (float)state->quat[2] * QUAT_TO_FLOAT;
+    quat[3] = (float)state->quat[3] * QUAT_TO_FLOAT;
 }
 
 void vqf_ultra_get_quat_q15(const vqf_ultra_state_t *state, q15_t quat[4])
 {
+#if VQF_ULTRA_QUAT_Q30
+    for (int i = 0; i < 4; i++) {
+        quat[i] = (q15_t)clamp_i32(rshift_round(state->quat[i], 15), Q15_ONE);
+    }
+#else
     quat[0] = state->quat[0];
     quat[1] = state->quat[1];
     quat[2] = state->quat[2];
     quat[3] = state->quat[3];
+#endif
 }
 
 /**
@@ -448,11 +556,11 @@ void vqf_ultra_get_quat_q15(const vqf_ultra_state_t *state, q15_t quat[4])
  */
 void vqf_ultra_set_quat(vqf_ultra_state_t *state, const float quat[4])
 {
-    // Convert float to Q15
-    state->quat[0] = (q15_t)(quat[0] * 32768.0f);
-    state->quat[1] = (q15_t)(quat[1] * 32768.0f);
-    state->quat[2] = (q15_t)(quat[2] * 32768.0f);
-    state->quat[3] = (q15_t)(quat[3] * 32768.0f);
+    // Convert float to Q15 (v0.6.3: 饱和, w = 1.0 时不再回绕为 -1)
+    state->quat[0] = float_to_quat_sat(quat[0]);
+    state->quat[1] = float_to_quat_sat(quat[1]);
+    state->quat[2] = float_to_quat_sat(quat[2]);
+    state->quat[3] = float_to_quat_sat(quat[3]);
     
     // 重置一些收敛相关的状态，避免恢复后跳变
     state->rest_count = 0;
@@ -461,8 +569,9 @@ void vqf_ultra_set_quat(vqf_ultra_state_t *state, const float quat[4])
 void vqf_ultra_get_euler(const vqf_ultra_state_t *state, int16_t euler[3])
 {
     // Convert quaternion to Euler angles in 0.01 degrees
-    q15_t q0 = state->quat[0], q1 = state->quat[1];
-    q15_t q2 = state->quat[2], q3 = state->quat[3];
+    q15_t q[4];
+    vqf_ultra_get_quat_q15(state, q);
+    q15_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
     
     // Roll (x-axis rotation)
     int32_t sinr_cosp = 2 * ((int32_t)q0*q1 + (int32_t)q2*q3);
@@ -484,20 +593,71 @@ void vqf_ultra_get_euler(const vqf_ultra_state_t *state, int16_t euler[3])
 
 void vqf_ultra_reset(vqf_ultra_state_t *state)
 {
-    uint8_t dt_shift = state->dt_shift;
+    uint16_t k_gyro = state->k_gyro;
     q15_t k_acc = state->k_acc;
     q15_t k_bias = state->k_bias;
     
     memset(state, 0, sizeof(vqf_ultra_state_t));
     
-    state->quat[0] = Q15_ONE;
+    state->quat[0] = QUAT_ONE;
     state->acc_lp[2] = Q15_ONE;
-    state->dt_shift = dt_shift;
+    state->k_gyro = k_gyro;
     state->k_acc = k_acc;
     state->k_bias = k_bias;
     state->flags = VQF_ULTRA_INITIALIZED;
 }
 
+/*============================================================================
+ * v0.6.3: Checkpoint
+ *============================================================================*/
+
+// gyro_bias 单位: 0.01 deg/s x 6
+#define BIAS_TO_RAD     (0.01f * 3.14159265f / 180.0f / 6.0f)
+#define RAD_TO_BIAS     (6.0f * 180.0f / 3.14159265f / 0.01f)
+
+void vqf_ultra_save_checkpoint(const vqf_ultra_state_t *state, fusion_checkpoint_t *ckpt)
+{
+    fusion_ckpt_header(ckpt, FUSION_VQF_ULTRA);
+    vqf_ultra_get_quat(state, ckpt->quat);
+    for (int i = 0; i < 3; i++) {
+        ckpt->gyro_bias[i] = state->gyro_bias[i] * BIAS_TO_RAD;
+        ckpt->acc_lp[i] = state->acc_lp[i] / 32768.0f;
+        ckpt->mag_ref[i] = 0.0f;
+    }
+    ckpt->bias_sigma = 0.0f;    // 无偏差协方差
+    ckpt->flags |= FUSION_CKPT_F_ACC_LP;
+    if (state->flags & VQF_ULTRA_AT_REST) ckpt->flags |= FUSION_CKPT_F_REST;
+}
+
+int vqf_ultra_load_checkpoint(vqf_ultra_state_t *state, const fusion_checkpoint_t *ckpt)
+{
+    if (!fusion_ckpt_valid(ckpt)) return -1;
+
+    // 检查点四元数已校验为近单位, 与 vqf_ultra_set_quat 相同直接转换 (饱和到 Q15)
+    for (int i = 0; i < 4; i++) {
+        state->quat[i] = float_to_quat_sat(ckpt->quat[i]);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        state->gyro_bias[i] = (q15_t)(ckpt->gyro_bias[i] * RAD_TO_BIAS);
+    }
+    if (ckpt->flags & FUSION_CKPT_F_ACC_LP) {
+        for (int i = 0; i < 3; i++) {
+            state->acc_lp[i] = float_to_q15_sat(ckpt->acc_lp[i]);
+        }
+    }
+
+    // 保存时已静止: 直接进入 Rest, 偏差继续更新
+    if (ckpt->flags & FUSION_CKPT_F_REST) {
+        state->rest_count = REST_COUNT_TH + 1;
+        state->flags |= VQF_ULTRA_AT_REST;
+    } else {
+        state->rest_count = 0;
+        state->flags &= ~VQF_ULTRA_AT_REST;
+    }
+    return 0;
+}
+
 void vqf_ultra_set_bias(vqf_ultra_state_t *state, const int16_t bias[3])
 {
     state->gyro_bias[0] = (q15_t)(bias[0] * 6);
@@ -10,6 +10,9 @@
  * 3. 算法级: 自适应卡尔曼滤波
  * 4. 静止检测: 零速更新 (ZUPT)
  * 
+ * v0.6.3: 滤波级由 GYRO_FILTER_MEDIAN/MOVING_AVG/KALMAN 在编译期选择;
+ * GYRO_FILTER_DETECT_ONLY 不运行滤波级, 静止判定取共享的 motion_state, 不产生滤波输出
+ * 
  * 噪音特性分析:
  * - 白噪声: 高频随机波动 → 低通滤波
  * - 偏差漂移: 缓慢变化 → 偏差估计
@@ -18,6 +21,8 @@
  */
 
 #include "gyro_noise_filter.h"
+#include "motion_state.h"
+#include "config.h"
 #include "hal.h"
 #include <string.h>
 #include <math.h>
@@ -27,7 +32,35 @@
  *============================================================================*/
 
 // 滤波器窗口大小 / Filter window sizes
-#define MEDIAN_WINDOW_SIZE      5       // 中值滤波窗口
+#ifndef GYRO_MEDIAN_WINDOW
+#define GYRO_MEDIAN_WINDOW      5
+#endif
+#define MEDIAN_WINDOW_SIZE      GYRO_MEDIAN_WINDOW  // 中值滤波窗口
+
+#if (MEDIAN_WINDOW_SIZE < 3) || (MEDIAN_WINDOW_SIZE > 31) || !(MEDIAN_WINDOW_SIZE & 1)
+#error "GYRO_MEDIAN_WINDOW must be odd and 3..31"
+#endif
+
+#ifndef GYRO_FILTER_DETECT_ONLY
+#define GYRO_FILTER_DETECT_ONLY 0
+#endif
+#if GYRO_FILTER_DETECT_ONLY
+#undef GYRO_FILTER_MEDIAN
+#undef GYRO_FILTER_MOVING_AVG
+#undef GYRO_FILTER_KALMAN
+#define GYRO_FILTER_MEDIAN      0
+#define GYRO_FILTER_MOVING_AVG  0
+#define GYRO_FILTER_KALMAN      0
+#endif
+#ifndef GYRO_FILTER_MEDIAN
+#define GYRO_FILTER_MEDIAN      1
+#endif
+#ifndef GYRO_FILTER_MOVING_AVG
+#define GYRO_FILTER_MOVING_AVG  1
+#endif
+#ifndef GYRO_FILTER_KALMAN
+#define GYRO_FILTER_KALMAN      1
+#endif
 #define MOVING_AVG_SIZE         4       // 移动平均窗口
 #define CALIBRATION_SAMPLES     500     // 校准采样数
 
@@ -46,8 +79,10 @@
  *============================================================================*/
 
 // 中值滤波缓冲区 / Median filter buffer
+// v0.6.3: buffer 按到达顺序, sorted 始终有序, 中值直接取 sorted[count/2]
 typedef struct {
     float buffer[MEDIAN_WINDOW_SIZE];
+    float sorted[MEDIAN_WINDOW_SIZE];
     uint8_t index;
     uint8_t count;
 } median_filter_t;
@@ -75,9 +110,15 @@ typedef struct {
 static gyro_filter_state_t filter_state;
 
 // 每轴滤波器 / Per-axis filters
+#if GYRO_FILTER_MEDIAN
 static median_filter_t median_x, median_y, median_z;
+#endif
+#if GYRO_FILTER_MOVING_AVG
 static moving_avg_t mavg_x, mavg_y, mavg_z;
+#endif
+#if GYRO_FILTER_KALMAN
 static kalman_1d_t kalman_x, kalman_y, kalman_z;
+#endif
 
 // 校准数据 / Calibration data
 static float gyro_offset[3] = {0, 0, 0};
@@ -93,35 +134,58 @@ static bool is_resting = false;
  * 辅助函数 / Helper Functions
  *============================================================================*/
 
-// 快速排序用于中值滤波 / Quick sort for median filter
-static void sort_float(float *arr, int n)
+#if GYRO_FILTER_MEDIAN
+// 有序窗口中查找值的位置 (二分) / Binary search in sorted window
+static int median_find(const float *sorted, int n, float v)
 {
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (arr[j] > arr[j + 1]) {
-                float temp = arr[j];
-                arr[j] = arr[j + 1];
-                arr[j + 1] = temp;
-            }
-        }
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (sorted[mid] < v) lo = mid + 1;
+        else hi = mid;
     }
+    return lo;
 }
 
 // 中值滤波 / Median filter
+// v0.6.3: 增量有序窗口 - 最旧样本在有序数组中的位置直接替换为新样本,
+// 再向左/右移动到正确位置。陀螺仪信号连续, 移动距离通常只有 0-2 个位置,
+// 每样本代价约 log2(N) 次比较 + 少量移动, 与窗口大小基本无关
 static float median_filter_update(median_filter_t *f, float input)
 {
+    float *s = f->sorted;
+    int n = f->count;
+    int pos;
+    
+    if (n < MEDIAN_WINDOW_SIZE) {
+        // 预热阶段: 插入
+        pos = median_find(s, n, input);
+        memmove(&s[pos + 1], &s[pos], (n - pos) * sizeof(float));
+        s[pos] = input;
+        f->count++;
+    } else {
+        // 替换最旧样本 (相等值任取其一即可)
+        pos = median_find(s, n, f->buffer[f->index]);
+        s[pos] = input;
+        
+        while (pos > 0 && s[pos - 1] > input) {
+            s[pos] = s[pos - 1];
+            s[--pos] = input;
+        }
+        while (pos < n - 1 && s[pos + 1] < input) {
+            s[pos] = s[pos + 1];
+            s[++pos] = input;
+        }
+    }
+    
     f->buffer[f->index] = input;
     f->index = (f->index + 1) % MEDIAN_WINDOW_SIZE;
-    if (f->count < MEDIAN_WINDOW_SIZE) f->count++;
-    
-    // 复制并排序
-    float sorted[MEDIAN_WINDOW_SIZE];
-    memcpy(sorted, f->buffer, f->count * sizeof(float));
-    sort_float(sorted, f->count);
     
-    return sorted[f->count / 2];
+    return s[f->count / 2];
 }
+#endif /* GYRO_FILTER_MEDIAN */
 
+#if GYRO_FILTER_MOVING_AVG
 // 移动平均 / Moving average
 static float moving_avg_update(moving_avg_t *f, float input)
 {
@@ -136,7 +200,9 @@ static float moving_avg_update(moving_avg_t *f, float input)
     
     return f->sum / f->count;
 }
+#endif /* GYRO_FILTER_MOVING_AVG */
 
+#if GYRO_FILTER_KALMAN
 // 1D 卡尔曼滤波 / 1D Kalman filter
 static float kalman_update(kalman_1d_t *kf, float measurement)
 {
@@ -160,6 +226,45 @@ static void kalman_init(kalman_1d_t *kf, float q, float r)
     kf->q = q;
     kf->r = r;
 }
+#endif /* GYRO_FILTER_KALMAN */
+
+#if !GYRO_FILTER_DETECT_ONLY
+// 加速度幅值接近 1g (平方比较, 不开方)
+static bool accel_near_1g(const float accel[3])
+{
+    const float lo = (1.0f - REST_ACCEL_THRESHOLD) * (1.0f - REST_ACCEL_THRESHOLD);
+    const float hi = (1.0f + REST_ACCEL_THRESHOLD) * (1.0f + REST_ACCEL_THRESHOLD);
+    float m2 = accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2];
+    return m2 > lo && m2 < hi;
+}
+#endif
+
+// 静止状态机: quiet 持续 REST_TIME_MS 后缓慢更新偏差估计, 返回 true 表示可零速更新
+static bool rest_track(bool quiet, const float g[3])
+{
+    if (!quiet) {
+        is_resting = false;
+        filter_state.is_stationary = false;
+        return false;
+    }
+    
+    if (!is_resting) {
+        rest_start_time = hal_millis();
+        is_resting = true;
+    }
+    if ((hal_millis() - rest_start_time) <= REST_TIME_MS) {
+        return false;
+    }
+    
+    // 缓慢更新偏差 / Slowly update bias
+    const float alpha = 0.001f;
+    gyro_offset[0] += alpha * g[0];
+    gyro_offset[1] += alpha * g[1];
+    gyro_offset[2] += alpha * g[2];
+    
+    filter_state.is_stationary = true;
+    return true;
+}
 
 /*============================================================================
  * API 实现 / API Implementation
@@ -169,22 +274,28 @@ void gyro_filter_init(const gyro_filter_config_t *config)
 {
     memset(&filter_state, 0, sizeof(filter_state));
     
+#if GYRO_FILTER_MEDIAN
     // 初始化中值滤波器 / Initialize median filters
     memset(&median_x, 0, sizeof(median_filter_t));
     memset(&median_y, 0, sizeof(median_filter_t));
     memset(&median_z, 0, sizeof(median_filter_t));
+#endif
     
+#if GYRO_FILTER_MOVING_AVG
     // 初始化移动平均 / Initialize moving average
     memset(&mavg_x, 0, sizeof(moving_avg_t));
     memset(&mavg_y, 0, sizeof(moving_avg_t));
     memset(&mavg_z, 0, sizeof(moving_avg_t));
+#endif
     
+#if GYRO_FILTER_KALMAN
     // 初始化卡尔曼滤波 / Initialize Kalman filters
     float q = config ? config->process_noise : 0.001f;
     float r = config ? config->measurement_noise : 0.01f;
     kalman_init(&kalman_x, q, r);
     kalman_init(&kalman_y, q, r);
     kalman_init(&kalman_z, q, r);
+#endif
     
     // 使用配置或默认值 / Use config or defaults
     if (config) {
@@ -205,16 +316,21 @@ void gyro_filter_init(const gyro_filter_config_t *config)
 
 void gyro_filter_reset(void)
 {
+#if GYRO_FILTER_MEDIAN
     memset(&median_x, 0, sizeof(median_filter_t));
     memset(&median_y, 0, sizeof(median_filter_t));
     memset(&median_z, 0, sizeof(median_filter_t));
+#endif
+#if GYRO_FILTER_MOVING_AVG
     memset(&mavg_x, 0, sizeof(moving_avg_t));
     memset(&mavg_y, 0, sizeof(moving_avg_t));
     memset(&mavg_z, 0, sizeof(moving_avg_t));
-    
+#endif
+#if GYRO_FILTER_KALMAN
     kalman_x.x = 0; kalman_x.p = 1.0f;
     kalman_y.x = 0; kalman_y.p = 1.0f;
     kalman_z.x = 0; kalman_z.p = 1.0f;
+#endif
     
     filter_state.sample_count = 0;
     is_resting = false;
@@ -252,6 +368,7 @@ int gyro_filter_calibrate(float gyro_samples[][3], int count, float temperature)
     filter_state.noise_level[1] = sqrtf(var[1] / count);
     filter_state.noise_level[2] = sqrtf(var[2] / count);
     
+#if GYRO_FILTER_KALMAN
     // 更新卡尔曼滤波器测量噪声 / Update Kalman measurement noise
     float avg_noise = (filter_state.noise_level[0] + 
                        filter_state.noise_level[1] + 
@@ -259,6 +376,7 @@ int gyro_filter_calibrate(float gyro_samples[][3], int count, float temperature)
     kalman_x.r = avg_noise * avg_noise;
     kalman_y.r = avg_noise * avg_noise;
     kalman_z.r = avg_noise * avg_noise;
+#endif
     
     calibration_temp = temperature;
     filter_state.calibrated = true;
@@ -288,64 +406,59 @@ void gyro_filter_process(const float gyro_in[3], float gyro_out[3],
         }
     }
     
+#if GYRO_FILTER_DETECT_ONLY
+    // 仅静止检测: 安静判定和均值来自共享 motion_state (本样本已更新), 不运行滤波级
+    if (filter_state.config.enable_rest_detection && accel != NULL) {
+        float mean[3];
+        motion_state_get_gyro_mean(mean);
+        rest_track(motion_state_is_still(), mean);
+    }
+    
+    // 不产生滤波输出, 需要时给出偏差校正后的原始值
+    if (gyro_out) {
+        gyro_out[0] = gx;
+        gyro_out[1] = gy;
+        gyro_out[2] = gz;
+    }
+#else
+#if GYRO_FILTER_MEDIAN
     // 2. 中值滤波 (去除尖峰噪声) / Median filter (remove spikes)
     if (filter_state.config.enable_median) {
         gx = median_filter_update(&median_x, gx);
         gy = median_filter_update(&median_y, gy);
         gz = median_filter_update(&median_z, gz);
     }
+#endif
     
+#if GYRO_FILTER_MOVING_AVG
     // 3. 移动平均 (平滑) / Moving average (smoothing)
     if (filter_state.config.enable_moving_avg) {
         gx = moving_avg_update(&mavg_x, gx);
         gy = moving_avg_update(&mavg_y, gy);
         gz = moving_avg_update(&mavg_z, gz);
     }
+#endif
     
+#if GYRO_FILTER_KALMAN
     // 4. 卡尔曼滤波 (自适应噪声抑制) / Kalman filter
     if (filter_state.config.enable_kalman) {
         gx = kalman_update(&kalman_x, gx);
         gy = kalman_update(&kalman_y, gy);
         gz = kalman_update(&kalman_z, gz);
     }
+#endif
     
     // 5. 静止检测与零速更新 / Rest detection and ZUPT
     if (filter_state.config.enable_rest_detection && accel != NULL) {
-        // 计算陀螺仪幅值 / Calculate gyro magnitude
-        float gyro_mag = sqrtf(gx*gx + gy*gy + gz*gz);
-        
-        // 计算加速度幅值偏离 1g 的程度 / Accel magnitude deviation from 1g
-        float accel_mag = sqrtf(accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2]);
-        float accel_dev = fabsf(accel_mag - 1.0f);
-        
-        // 判断是否静止 / Check if resting
-        if (gyro_mag < REST_GYRO_THRESHOLD && accel_dev < REST_ACCEL_THRESHOLD) {
-            if (!is_resting) {
-                rest_start_time = hal_millis();
-                is_resting = true;
-            }
-            
-            // 静止超过阈值时间，更新偏差估计
-            // If resting for threshold time, update bias estimate
-            uint32_t rest_duration = hal_millis() - rest_start_time;
-            if (rest_duration > REST_TIME_MS) {
-                // 缓慢更新偏差 / Slowly update bias
-                float alpha = 0.001f;
-                gyro_offset[0] += alpha * gx;
-                gyro_offset[1] += alpha * gy;
-                gyro_offset[2] += alpha * gz;
-                
-                // 零速更新: 强制陀螺仪输出为零
-                // ZUPT: Force gyro output to zero
-                gx = 0;
-                gy = 0;
-                gz = 0;
-                
-                filter_state.is_stationary = true;
-            }
-        } else {
-            is_resting = false;
-            filter_state.is_stationary = false;
+        const float g[3] = { gx, gy, gz };
+        bool quiet = (gx*gx + gy*gy + gz*gz) < REST_GYRO_THRESHOLD * REST_GYRO_THRESHOLD &&
+                     accel_near_1g(accel);
+        if (rest_track(quiet, g)) {
+            // 零速更新: 强制陀螺仪输出为零
+            // ZUPT: Force gyro output to zero
+            gx = 0;
+            gy = 0;
+            gz = 0;
         }
     }
     
@@ -359,6 +472,7 @@ void gyro_filter_process(const float gyro_in[3], float gyro_out[3],
     gyro_out[0] = gx;
     gyro_out[1] = gy;
     gyro_out[2] = gz;
+#endif /* GYRO_FILTER_DETECT_ONLY */
     
     filter_state.sample_count++;
 }
@@ -0,0 +1,68 @@
+/**
+ * @file gyro_preint.c
+ * @brief 陀螺仪多样本预积分 / Multi-sample gyro preintegration with coning correction
+ *
+ * v0.6.3: 见 gyro_preint.h
+ */
+
+#include "gyro_preint.h"
+#include <string.h>
+
+static struct {
+    float alpha[3];             // Σ Δα
+    float beta[3];              // 锥运动补偿项
+    float prev[3];              // 上一个 Δα
+    float acc_sum[3];
+    float t;                    // Σ dt
+    uint8_t n;
+} pi;
+
+static inline void cross(const float a[3], const float b[3], float out[3])
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void gyro_preint_reset(void)
+{
+    memset(&pi, 0, sizeof(pi));
+}
+
+void gyro_preint_add(const float gyro[3], const float accel[3], float dt)
+{
+    float da[3] = { gyro[0] * dt, gyro[1] * dt, gyro[2] * dt };
+    float c1[3], c2[3];
+
+    // 区间内第一个样本: α = 0, prev = 0, 两个叉乘都为 0
+    cross(pi.alpha, da, c1);
+    cross(pi.prev, da, c2);
+    for (int i = 0; i < 3; i++) {
+        pi.beta[i] += 0.5f * c1[i] + (1.0f / 12.0f) * c2[i];
+        pi.alpha[i] += da[i];
+        pi.prev[i] = da[i];
+        pi.acc_sum[i] += accel[i];
+    }
+    pi.t += dt;
+    if (pi.n < 0xFF) pi.n++;
+}
+
+uint8_t gyro_preint_count(void)
+{
+    return pi.n;
+}
+
+float gyro_preint_get(float dtheta[3], float accel_mean[3])
+{
+    if (pi.n == 0) {
+        dtheta[0] = dtheta[1] = dtheta[2] = 0.0f;
+        return 0.0f;
+    }
+
+    float inv_n = 1.0f / (float)pi.n;
+    for (int i = 0; i < 3; i++) {
+        dtheta[i] = pi.alpha[i] + pi.beta[i];
+        if (accel_mean) accel_mean[i] = pi.acc_sum[i] * inv_n;
+    }
+    return pi.t;
+}
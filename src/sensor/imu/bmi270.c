@@ -12,6 +12,7 @@
  */
 
 #include "bmi270.h"
+#include "bmi270_config.h"  // v0.6.3: 与 imu_interface.c 共用
 #include "hal.h"
 #include <string.h>
 
@@ -56,18 +57,6 @@
 
 #define BMI270_CHIP_ID_VAL      0x24
 
-/*============================================================================
- * BMI270 Configuration Firmware (abbreviated for example)
- *============================================================================*/
-
-// Note: Full firmware is ~8KB, included from separate header
-// This is just a placeholder - use the actual firmware from the nRF project
-static const uint8_t bmi270_config_file[] = {
-    // ... BMI270 firmware data goes here ...
-    // Copy from: SlimeVR-Tracker-nRF/src/sensor/imu/BMI270_firmware.h
-    0x00  // Placeholder
-};
-
 /*============================================================================
  * Driver State
  *============================================================================*/
@@ -276,3 +265,96 @@ int bmi270_resume(void)
     hal_delay_us(450);
     return err;
 }
+
+/*============================================================================
+ * v0.6.3: FIFO Batch Read (header mode: gyro and accel may run at different ODRs)
+ *============================================================================*/
+
+// Headerless mode requires equal ODRs (init runs accel at half the gyro rate),
+// so frames carry a header: regular frames hold gyro(6) and/or accel(6)
+#define BMI270_FH_GYR_ACC       0x8C
+#define BMI270_FH_GYR           0x88
+#define BMI270_FH_ACC           0x84
+#define BMI270_FH_SKIP          0x40    // + 1 byte: frames dropped on overflow
+#define BMI270_FH_SENSORTIME    0x44    // + 3 bytes, appended when the FIFO is read empty
+#define BMI270_FH_CONFIG        0x48    // + 4 bytes: config change
+#define BMI270_FH_MASK          0xFC    // low 2 bits: external interrupt tag
+#define BMI270_FIFO_FRAME_MAX   13      // header + gyro + accel
+
+static uint8_t bmi270_fifo_wm = 0;
+
+int bmi270_fifo_enable(uint8_t watermark)
+{
+    if (!bmi270_state.initialized) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    // Watermark in bytes: one gyro frame per sample, accel payload at the ODR ratio
+    uint8_t acc_odr = 0, gyr_odr = 0;
+    bmi270_read_reg(BMI270_ACC_CONF, &acc_odr, 1);
+    bmi270_read_reg(BMI270_GYR_CONF, &gyr_odr, 1);
+    acc_odr &= 0x0F;
+    gyr_odr &= 0x0F;
+    uint8_t shift = (gyr_odr > acc_odr) ? (uint8_t)(gyr_odr - acc_odr) : 0;
+    uint16_t wm_bytes = (uint16_t)(watermark * 7 + (watermark >> shift) * 6);
+
+    int err = bmi270_write_reg(BMI270_FIFO_WTM_0, wm_bytes & 0xFF);
+    if (err) return err;
+    bmi270_write_reg(BMI270_FIFO_WTM_0 + 1, (wm_bytes >> 8) & 0x1F);
+    bmi270_write_reg(BMI270_FIFO_CONFIG_1, 0xD0);   // GYR+ACC, header enabled
+    bmi270_write_reg(BMI270_INT1_IO_CTRL, 0x0A);    // INT1 active high, push-pull
+    err = bmi270_write_reg(BMI270_INT_MAP_DATA, 0x02);  // FWM -> INT1
+    if (err) return err;
+
+    bmi270_fifo_wm = watermark;
+    return 0;
+}
+
+int bmi270_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    (void)ts;   // no per-frame sensortime
+    if (!bmi270_state.initialized || bmi270_fifo_wm == 0) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * BMI270_FIFO_FRAME_MAX];
+    uint8_t cnt[2];
+    int err = bmi270_read_reg(BMI270_FIFO_LENGTH_0, cnt, 2);
+    if (err) return err;
+
+    uint16_t bytes = (uint16_t)(cnt[0] | ((cnt[1] & 0x3F) << 8));
+    if (bytes > (uint16_t)n * BMI270_FIFO_FRAME_MAX) bytes = (uint16_t)n * BMI270_FIFO_FRAME_MAX;
+    if (bytes == 0) return 0;
+
+    err = bmi270_read_reg(BMI270_FIFO_DATA, buf, bytes);
+    if (err) return err;
+
+    // A frame cut off at the end of the buffer is not decoded; the next read starts at a header
+    uint8_t got = 0;
+    uint16_t pos = 0;
+    while (pos < bytes && got < n) {
+        const uint8_t *f = &buf[pos];
+        uint8_t h = f[0] & BMI270_FH_MASK;
+        uint8_t len;
+        switch (h) {
+            case BMI270_FH_GYR_ACC:    len = 13; break;
+            case BMI270_FH_GYR:
+            case BMI270_FH_ACC:        len = 7; break;
+            case BMI270_FH_SKIP:       len = 2; break;
+            case BMI270_FH_SENSORTIME: len = 4; break;
+            case BMI270_FH_CONFIG:     len = 5; break;
+            default:                   return got;     // 0x80: FIFO empty
+        }
+        if (pos + len > bytes) break;
+        pos += len;
+        if (h != BMI270_FH_GYR_ACC && h != BMI270_FH_GYR) continue;   // accel-only frames are dropped
+
+        for (uint8_t k = 0; k < 3; k++) {
+            out[got].gyro[k] = (int16_t)(f[1 + k * 2] | (f[2 + k * 2] << 8));
+            out[got].accel[k] = (h == BMI270_FH_GYR_ACC) ?
+                                (int16_t)(f[7 + k * 2] | (f[8 + k * 2] << 8)) : 0;
+        }
+        out[got].accel_valid = (h == BMI270_FH_GYR_ACC);
+        got++;
+    }
+    return got;
+}
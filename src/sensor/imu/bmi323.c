@@ -50,6 +50,9 @@
 // FIFO
 #define BMI323_FIFO_FILL_LEVEL      0x15
 #define BMI323_FIFO_DATA            0x16
+#define BMI323_FIFO_WATERMARK       0x35
+#define BMI323_FIFO_CONF            0x36
+#define BMI323_FIFO_CTRL            0x37
 
 // 配置寄存器
 #define BMI323_ACC_CONF             0x20
@@ -126,6 +129,11 @@ typedef struct {
     
     float acc_sensitivity;  // mg/LSB
     float gyr_sensitivity;  // mdps/LSB
+    
+    // v0.6.3: FIFO 批量读取
+    uint8_t fifo_wm;        // 0 = 未使能
+    uint16_t fifo_ts_last;  // 上一帧 16 位 sensortime
+    uint32_t fifo_ts_ext;   // 扩展为 32 位 (39.0625us)
 } bmi323_ctx_t;
 
 static bmi323_ctx_t ctx;
@@ -376,3 +384,59 @@ void bmi323_power_up(void)
     bmi323_set_accel_config(ctx.acc_odr, ctx.acc_range);
     bmi323_set_gyro_config(ctx.gyr_odr, ctx.gyr_range);
 }
+
+/*============================================================================
+ * v0.6.3: FIFO 批量读取 (帧 = 加速度 3 字 + 陀螺 3 字 + sensortime 1 字)
+ *============================================================================*/
+
+#define BMI323_FIFO_FRAME_WORDS     7
+#define BMI323_FIFO_EMPTY_WORD      0x8000  // FIFO 读空时返回的填充字
+#define BMI323_FIFO_ACC_DUMMY       0x7F01  // 加速度计 ODR 低于陀螺时本帧无加速度样本
+
+int bmi323_fifo_enable(uint8_t watermark)
+{
+    if (!ctx.initialized) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    write_reg16(BMI323_FIFO_CTRL, 0x0001);     // 清空
+    write_reg16(BMI323_FIFO_CONF, 0x0700);     // time_en + acc_en + gyr_en
+    write_reg16(BMI323_FIFO_WATERMARK, (uint16_t)watermark * BMI323_FIFO_FRAME_WORDS);
+    write_reg16(BMI323_INT_MAP1, 0x0000);      // 取消 DRDY 路由
+    write_reg16(BMI323_INT_MAP2, 0x4000);      // fifo_wm -> INT1
+
+    ctx.fifo_wm = watermark;
+    ctx.fifo_ts_last = 0;
+    ctx.fifo_ts_ext = 0;
+    return 0;
+}
+
+int bmi323_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    if (!ctx.initialized || ctx.fifo_wm == 0) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint16_t buf[IMU_FIFO_MAX_BATCH * BMI323_FIFO_FRAME_WORDS];
+    uint16_t frames = (read_reg16(BMI323_FIFO_FILL_LEVEL) & 0x07FF) / BMI323_FIFO_FRAME_WORDS;
+    if (frames > n) frames = n;
+    if (frames == 0) return 0;
+
+    read_burst(BMI323_FIFO_DATA, buf, (uint8_t)(frames * BMI323_FIFO_FRAME_WORDS));
+
+    uint8_t got = 0;
+    for (uint16_t i = 0; i < frames; i++) {
+        const uint16_t *f = &buf[i * BMI323_FIFO_FRAME_WORDS];
+        if (f[0] == BMI323_FIFO_EMPTY_WORD) break;
+        for (uint8_t k = 0; k < 3; k++) {
+            out[got].accel[k] = (int16_t)f[k];
+            out[got].gyro[k]  = (int16_t)f[3 + k];
+        }
+        out[got].accel_valid = (f[0] != BMI323_FIFO_ACC_DUMMY);
+        // 16 位 sensortime 回绕扩展为 32 位, ts 为 NULL 时也跟踪
+        ctx.fifo_ts_ext += (uint16_t)(f[6] - ctx.fifo_ts_last);
+        ctx.fifo_ts_last = f[6];
+        if (ts) ts[got] = ctx.fifo_ts_ext;
+        got++;
+    }
+    return got;
+}
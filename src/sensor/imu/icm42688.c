@@ -407,3 +407,73 @@ bool icm42688_data_ready(void)
     }
     return (status & 0x08) != 0;  // DATA_RDY_INT
 }
+
+/*============================================================================
+ * v0.6.3: FIFO 批量读取 (包格式 3: 头 + 加速度 + 陀螺 + 温度 + 时间戳 = 16 字节)
+ *============================================================================*/
+
+#define ICM42688_FIFO_FRAME_SIZE       16
+#define ICM42688_FIFO_HEADER_EMPTY     0x80
+#define ICM42688_FIFO_ACCEL_INVALID    ((int16_t)0x8000)   // 加速度计 ODR 较低时只含陀螺的包
+
+static uint8_t icm42688_fifo_wm = 0;
+static uint16_t icm42688_fifo_ts_last = 0;
+static uint32_t icm42688_fifo_ts_ext = 0;
+
+int icm42688_fifo_enable(uint8_t watermark)
+{
+    if (!icm42688_state.initialized) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    uint16_t wm_bytes = (uint16_t)watermark * ICM42688_FIFO_FRAME_SIZE;
+    int err = icm42688_write_reg(ICM42688_INTF_CONFIG0, 0x30);  // FIFO计数/数据大端, 与寄存器解码一致
+    if (err) return err;
+    icm42688_write_reg(ICM42688_FIFO_CONFIG1, 0x0F);   // ACCEL+GYRO+TEMP+TMST_FSYNC → 包格式3
+    icm42688_write_reg(ICM42688_FIFO_CONFIG2, wm_bytes & 0xFF);
+    icm42688_write_reg(ICM42688_FIFO_CONFIG3, (wm_bytes >> 8) & 0x0F);
+    icm42688_write_reg(ICM42688_FIFO_CONFIG, 0x40);    // Stream-to-FIFO
+    err = icm42688_write_reg(ICM42688_INT_SOURCE0, 0x04);  // FIFO_THS → INT1 (替代DRDY)
+    if (err) return err;
+
+    icm42688_fifo_wm = watermark;
+    icm42688_fifo_ts_ext = 0;
+    icm42688_fifo_ts_last = 0;
+    return 0;
+}
+
+int icm42688_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    if (!icm42688_state.initialized || icm42688_fifo_wm == 0) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * ICM42688_FIFO_FRAME_SIZE];
+    uint8_t cnt[2];
+    int err = icm42688_read_reg(ICM42688_FIFO_COUNTH, cnt, 2);
+    if (err) return err;
+
+    uint16_t frames = (uint16_t)((cnt[0] << 8) | cnt[1]) / ICM42688_FIFO_FRAME_SIZE;
+    if (frames > n) frames = n;
+    if (frames == 0) return 0;
+
+    err = icm42688_read_reg(ICM42688_FIFO_DATA, buf, frames * ICM42688_FIFO_FRAME_SIZE);
+    if (err) return err;
+
+    uint8_t got = 0;
+    for (uint8_t i = 0; i < frames; i++) {
+        const uint8_t *f = &buf[i * ICM42688_FIFO_FRAME_SIZE];
+        if (f[0] & ICM42688_FIFO_HEADER_EMPTY) break;
+        for (uint8_t k = 0; k < 3; k++) {
+            out[got].accel[k] = (int16_t)((f[1 + k * 2] << 8) | f[2 + k * 2]);
+            out[got].gyro[k]  = (int16_t)((f[7 + k * 2] << 8) | f[8 + k * 2]);
+        }
+        out[got].accel_valid = (out[got].accel[0] != ICM42688_FIFO_ACCEL_INVALID);
+        // 16 位 TMST (1us) 回绕扩展为 32 位, ts 为 NULL 时也跟踪以免漏掉回绕
+        uint16_t t = (uint16_t)((f[14] << 8) | f[15]);
+        icm42688_fifo_ts_ext += (uint16_t)(t - icm42688_fifo_ts_last);
+        icm42688_fifo_ts_last = t;
+        if (ts) ts[got] = icm42688_fifo_ts_ext;
+        got++;
+    }
+    return got;
+}
@@ -319,12 +319,18 @@ int icm45686_read_raw(icm45686_raw_data_t *data)
 {
     if (!data) return -1;
     
-    uint8_t buf[14];
+    uint8_t buf[ICM45686_BURST_LEN];
     
     // Read all sensor data in one burst (temp + accel + gyro)
-    int err = read_regs(ICM45686_REG_TEMP_DATA1, buf, 14);
+    int err = read_regs(ICM45686_BURST_REG, buf, ICM45686_BURST_LEN);
     if (err) return err;
     
+    icm45686_decode_raw(buf, data);
+    return 0;
+}
+
+void icm45686_decode_raw(const uint8_t *buf, icm45686_raw_data_t *data)
+{
     // Temperature (big-endian)
     data->temp_raw = (int16_t)((buf[0] << 8) | buf[1]);
     
@@ -337,8 +343,22 @@ int icm45686_read_raw(icm45686_raw_data_t *data)
     data->gyro_raw[0] = (int16_t)((buf[8] << 8) | buf[9]);
     data->gyro_raw[1] = (int16_t)((buf[10] << 8) | buf[11]);
     data->gyro_raw[2] = (int16_t)((buf[12] << 8) | buf[13]);
+}
+
+void icm45686_decode_burst(const uint8_t *buf, float gyro_dps[3], float accel_g[3], float *temp)
+{
+    // Decode straight from the (DMA) burst buffer, no staging copy
+    float gyro_sens = gyro_sensitivity[current_gyro_range];
+    float accel_sens = accel_sensitivity[current_accel_range];
     
-    return 0;
+    for (int i = 0; i < 3; i++) {
+        accel_g[i]  = (int16_t)((buf[2 + i * 2] << 8) | buf[3 + i * 2]) / accel_sens;
+        gyro_dps[i] = (int16_t)((buf[8 + i * 2] << 8) | buf[9 + i * 2]) / gyro_sens;
+    }
+    
+    if (temp) {
+        *temp = (int16_t)((buf[0] << 8) | buf[1]) / 128.0f + 25.0f;
+    }
 }
 
 bool icm45686_data_ready(void)
@@ -424,3 +444,72 @@ float icm45686_get_accel_sensitivity(void)
 {
     return accel_sensitivity[current_accel_range];
 }
+
+/*============================================================================
+ * v0.6.3: FIFO Batch Read (16-byte packet: header + accel + gyro + temp + TMST)
+ *============================================================================*/
+
+#define ICM45686_FIFO_FRAME_SIZE    16
+#define ICM45686_FIFO_HEADER_EMPTY  0x80
+#define ICM45686_FIFO_ACCEL_INVALID ((int16_t)0x8000)   // gyro-only packet (accel ODR below gyro)
+
+static uint8_t fifo_wm = 0;
+static uint16_t fifo_ts_last = 0;
+static uint32_t fifo_ts_ext = 0;
+
+int icm45686_fifo_enable(uint8_t watermark)
+{
+    if (!use_spi && device_addr == 0) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    uint16_t wm_bytes = (uint16_t)watermark * ICM45686_FIFO_FRAME_SIZE;
+    int err = write_reg(ICM45686_REG_SIGNAL_PATH_RESET, ICM45686_FIFO_FLUSH);
+    if (err) return err;
+    write_reg(ICM45686_REG_FIFO_CONFIG1, 0x0F);     // ACCEL+GYRO+TEMP+TMST
+    write_reg(ICM45686_REG_FIFO_CONFIG2, wm_bytes & 0xFF);
+    write_reg(ICM45686_REG_FIFO_CONFIG3, (wm_bytes >> 8) & 0x0F);
+    err = write_reg(ICM45686_REG_INT_SOURCE0, ICM45686_FIFO_THS_INT1_EN);  // replaces DRDY
+    if (err) return err;
+
+    fifo_wm = watermark;
+    fifo_ts_ext = 0;
+    fifo_ts_last = 0;
+    return 0;
+}
+
+int icm45686_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    if (fifo_wm == 0) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    uint8_t cnt[2];
+    int err = read_regs(ICM45686_REG_FIFO_COUNTH, cnt, 2);
+    if (err) return err;
+
+    uint16_t frames = (uint16_t)((cnt[0] << 8) | cnt[1]) / ICM45686_FIFO_FRAME_SIZE;
+    if (frames > n) frames = n;
+
+    // FIFO_DATA does not auto-increment: consecutive transfers keep popping packets.
+    // One packet per transfer stays inside read_regs' 32-byte SPI buffer.
+    uint8_t got = 0;
+    for (uint8_t i = 0; i < frames; i++) {
+        uint8_t f[ICM45686_FIFO_FRAME_SIZE];
+        err = read_regs(ICM45686_REG_FIFO_DATA, f, ICM45686_FIFO_FRAME_SIZE);
+        if (err) return got ? got : err;
+        if (f[0] & ICM45686_FIFO_HEADER_EMPTY) break;
+
+        for (uint8_t k = 0; k < 3; k++) {
+            out[got].accel[k] = (int16_t)((f[1 + k * 2] << 8) | f[2 + k * 2]);
+            out[got].gyro[k]  = (int16_t)((f[7 + k * 2] << 8) | f[8 + k * 2]);
+        }
+        out[got].accel_valid = (out[got].accel[0] != ICM45686_FIFO_ACCEL_INVALID);
+        // 16-bit TMST (1us) unwrapped to 32 bit, tracked even when ts is NULL
+        uint16_t t = (uint16_t)((f[14] << 8) | f[15]);
+        fifo_ts_ext += (uint16_t)(t - fifo_ts_last);
+        fifo_ts_last = t;
+        if (ts) ts[got] = fifo_ts_ext;
+        got++;
+    }
+    return got;
+}
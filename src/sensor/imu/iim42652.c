@@ -12,6 +12,7 @@
  */
 
 #include "hal.h"
+#include "imu_fifo.h"
 #include <string.h>
 #include <math.h>
 
@@ -46,6 +47,8 @@ static uint8_t iim42652_addr = IIM42652_ADDR_LOW;
 #define REG_GYRO_CONFIG1        0x51
 #define REG_ACCEL_CONFIG1       0x53
 #define REG_FIFO_CONFIG1        0x5F
+#define REG_FIFO_CONFIG2        0x60
+#define REG_FIFO_CONFIG3        0x61
 #define REG_INT_CONFIG0         0x63
 #define REG_INT_SOURCE0         0x65
 #define REG_SELF_TEST_CONFIG    0x70
@@ -91,6 +94,8 @@ typedef struct {
     float gyro_scale;
     float accel_scale;
     bool fifo_enabled;
+    uint16_t fifo_ts_last;      // v0.6.3: 上一帧 16 位 TMST
+    uint32_t fifo_ts_ext;       // v0.6.3: 扩展为 32 位的 TMST (1us)
     uint32_t sample_count;
     float temp_c;
 } iim42652_state_t;
@@ -286,15 +291,62 @@ float iim42652_read_temp(void)
  * FIFO
  *============================================================================*/
 
-int iim42652_fifo_enable(void)
+// v0.6.3: 包格式 3 (头 + 加速度 + 陀螺 + 温度 + TMST = 16 字节, 大端), 与 ICM-42688 相同
+#define FIFO_FRAME_SIZE         16
+#define FIFO_HEADER_EMPTY       0x80
+#define FIFO_ACCEL_INVALID      ((int16_t)0x8000)   // 加速度计 ODR 较低时只含陀螺的包
+
+int iim42652_fifo_enable(uint8_t watermark)
 {
     if (!state.initialized) return -1;
-    write_reg(REG_FIFO_CONFIG1, 0x03);
-    write_reg(REG_FIFO_CONFIG, 0x40);
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    uint16_t wm_bytes = (uint16_t)watermark * FIFO_FRAME_SIZE;
+    write_reg(REG_FIFO_CONFIG1, 0x0F);      // ACCEL+GYRO+TEMP+TMST_FSYNC → 包格式3
+    write_reg(REG_FIFO_CONFIG2, wm_bytes & 0xFF);
+    write_reg(REG_FIFO_CONFIG3, (wm_bytes >> 8) & 0x0F);
+    write_reg(REG_FIFO_CONFIG, 0x40);       // Stream-to-FIFO
+    write_reg(REG_INT_SOURCE0, 0x04);       // FIFO_THS → INT1 (替代DRDY)
     state.fifo_enabled = true;
+    state.fifo_ts_last = 0;
+    state.fifo_ts_ext = 0;
     return 0;
 }
 
+int iim42652_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    if (!state.initialized || !state.fifo_enabled) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * FIFO_FRAME_SIZE];
+    uint8_t cnt[2];
+    if (read_regs(REG_FIFO_COUNTH, cnt, 2) != 0) return -2;
+
+    uint16_t frames = (uint16_t)((cnt[0] << 8) | cnt[1]) / FIFO_FRAME_SIZE;
+    if (frames > n) frames = n;
+    if (frames == 0) return 0;
+    if (read_regs(REG_FIFO_DATA, buf, frames * FIFO_FRAME_SIZE) != 0) return -2;
+
+    uint8_t got = 0;
+    for (uint8_t i = 0; i < frames; i++) {
+        const uint8_t *f = &buf[i * FIFO_FRAME_SIZE];
+        if (f[0] & FIFO_HEADER_EMPTY) break;
+        for (uint8_t k = 0; k < 3; k++) {
+            out[got].accel[k] = (int16_t)((f[1 + k * 2] << 8) | f[2 + k * 2]);
+            out[got].gyro[k]  = (int16_t)((f[7 + k * 2] << 8) | f[8 + k * 2]);
+        }
+        out[got].accel_valid = (out[got].accel[0] != FIFO_ACCEL_INVALID);
+        uint16_t t = (uint16_t)((f[14] << 8) | f[15]);
+        state.fifo_ts_ext += (uint16_t)(t - state.fifo_ts_last);
+        state.fifo_ts_last = t;
+        if (ts) ts[got] = state.fifo_ts_ext;
+        got++;
+    }
+    state.sample_count += got;
+    return got;
+}
+
 int iim42652_fifo_disable(void)
 {
     write_reg(REG_FIFO_CONFIG, 0x00);
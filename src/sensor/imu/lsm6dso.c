@@ -344,3 +344,101 @@ void lsm6dso_power_up(void)
     lsm6dso_set_accel_config(ctx.accel_odr, ctx.accel_fs);
     lsm6dso_set_gyro_config(ctx.gyro_odr, ctx.gyro_fs);
 }
+
+/*============================================================================
+ * v0.6.3: FIFO 批量读取 / FIFO Batch Read
+ *============================================================================*/
+
+// FIFO 字 = 标签(1) + 6 字节数据, 每帧 = 时间戳字 + 陀螺字 + 加速度字 (DEC_TS_BATCH=1)
+#define LSM6DSO_FIFO_WORD_SIZE     7
+#define LSM6DSO_FIFO_WORDS_PER_FRAME 3
+#define LSM6DSO_TAG_GYRO           0x01
+#define LSM6DSO_TAG_ACCEL          0x02
+#define LSM6DSO_TAG_TIMESTAMP      0x04
+#define LSM6DSO_ACC_WORDS(frames)   (((frames) + (1u << lsm6dso_fifo.acc_shift) - 1) >> lsm6dso_fifo.acc_shift)
+
+static struct {
+    uint8_t watermark;      // 0 = 未使能
+    bool pend_valid;        // 读取上限截在陀螺字和加速度字之间时, 未配对的陀螺字留到下次
+    int16_t pend_g[3];
+    uint32_t pend_ts;       // 未配对陀螺字所属批次的时间戳
+    uint32_t ts;            // 最近的时间戳字 (25us)
+    uint8_t acc_shift;      // 加速度计比陀螺低的 ODR 档数 (每档减半)
+} lsm6dso_fifo;
+
+int lsm6dso_fifo_enable(uint8_t watermark)
+{
+    if (!ctx.initialized) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+
+    // 批量速率跟随当前 ODR (BDR 与 ODR 编码相同)
+    uint8_t odr_xl = read_reg(LSM6DSO_CTRL1_XL) >> 4;
+    uint8_t odr_g = read_reg(LSM6DSO_CTRL2_G) >> 4;
+    write_reg(LSM6DSO_FIFO_CTRL3, (uint8_t)((odr_g << 4) | odr_xl));
+    write_reg(LSM6DSO_CTRL10_C, read_reg(LSM6DSO_CTRL10_C) | 0x20);    // TIMESTAMP_EN
+    // 陀螺字 + 时间戳字每帧一个, 加速度字按两路 ODR 之比
+    lsm6dso_fifo.acc_shift = (odr_g > odr_xl) ? (uint8_t)(odr_g - odr_xl) : 0;
+    write_reg(LSM6DSO_FIFO_CTRL1, (uint8_t)(watermark * 2 + LSM6DSO_ACC_WORDS(watermark)));
+    write_reg(LSM6DSO_FIFO_CTRL4, 0x46);        // 连续模式 + 每批次时间戳字
+    write_reg(LSM6DSO_INT1_CTRL, 0x08);         // FIFO_TH → INT1 (替代DRDY)
+
+    lsm6dso_fifo.watermark = watermark;
+    lsm6dso_fifo.pend_valid = false;
+    lsm6dso_fifo.ts = 0;
+    return 0;
+}
+
+int lsm6dso_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    if (!ctx.initialized || lsm6dso_fifo.watermark == 0) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * LSM6DSO_FIFO_WORDS_PER_FRAME * LSM6DSO_FIFO_WORD_SIZE];
+    uint8_t st[2];
+    read_regs(LSM6DSO_FIFO_STATUS1, st, 2);
+    uint16_t words = (uint16_t)(st[0] | ((st[1] & 0x03) << 8));
+    uint16_t max_words = (uint16_t)(n * 2 + LSM6DSO_ACC_WORDS(n));
+    if (words > max_words) words = max_words;
+    if (words == 0) return 0;
+
+    // IF_INC 下 0x78..0x7E 读完自动回到 0x78, 一次突发读出全部字
+    read_regs(LSM6DSO_FIFO_DATA_OUT_TAG, buf, (uint8_t)(words * LSM6DSO_FIFO_WORD_SIZE));
+
+    uint8_t got = 0;
+    for (uint16_t i = 0; i < words && got < n; i++) {
+        const uint8_t *w = &buf[i * LSM6DSO_FIFO_WORD_SIZE];
+        uint8_t tag = w[0] >> 3;
+        if (tag == LSM6DSO_TAG_GYRO) {
+            // 加速度批量率较低: 上一个陀螺字没有等到加速度字, 单独成帧
+            if (lsm6dso_fifo.pend_valid) {
+                for (uint8_t k = 0; k < 3; k++) {
+                    out[got].gyro[k] = lsm6dso_fifo.pend_g[k];
+                    out[got].accel[k] = 0;
+                }
+                out[got].accel_valid = 0;
+                if (ts) ts[got] = lsm6dso_fifo.pend_ts;
+                got++;
+            }
+            for (uint8_t k = 0; k < 3; k++) {
+                lsm6dso_fifo.pend_g[k] = (int16_t)(w[1 + k * 2] | (w[2 + k * 2] << 8));
+            }
+            lsm6dso_fifo.pend_valid = true;
+            lsm6dso_fifo.pend_ts = lsm6dso_fifo.ts;
+        } else if (tag == LSM6DSO_TAG_ACCEL && lsm6dso_fifo.pend_valid) {
+            for (uint8_t k = 0; k < 3; k++) {
+                out[got].gyro[k] = lsm6dso_fifo.pend_g[k];
+                out[got].accel[k] = (int16_t)(w[1 + k * 2] | (w[2 + k * 2] << 8));
+            }
+            out[got].accel_valid = 1;
+            if (ts) ts[got] = lsm6dso_fifo.pend_ts;
+            lsm6dso_fifo.pend_valid = false;
+            got++;
+        } else if (tag == LSM6DSO_TAG_TIMESTAMP) {
+            // 时间戳字在它所属批次的传感器字之前
+            lsm6dso_fifo.ts = (uint32_t)w[1] | ((uint32_t)w[2] << 8) |
+                          ((uint32_t)w[3] << 16) | ((uint32_t)w[4] << 24);
+        }
+    }
+    return got;
+}
@@ -11,6 +11,7 @@
  */
 
 #include "hal.h"
+#include "imu_fifo.h"
 #include <string.h>
 #include <math.h>
 
@@ -292,14 +293,49 @@ float sc7i22_read_temp(void)
  * FIFO
  *============================================================================*/
 
-int sc7i22_fifo_enable(void)
+// v0.6.3: FIFO 帧 = 加速度(6) + 温度(2) + 陀螺(6), 大端, 与数据寄存器顺序相同; 帧内无时间戳
+#define FIFO_FRAME_SIZE         14
+
+/**
+ * @note 寄存器表中没有水位寄存器: INT 仍为数据就绪,
+ *       调用方每 watermark 个 DRDY 调用一次 sc7i22_read_fifo
+ */
+int sc7i22_fifo_enable(uint8_t watermark)
 {
+    (void)watermark;
     if (!state.initialized) return -1;
     write_reg(REG_FIFO_CONFIG, 0x07);  // Enable FIFO for accel + gyro + temp
     state.fifo_enabled = true;
     return 0;
 }
 
+int sc7i22_read_fifo(imu_raw_sample_t *out, uint8_t n, uint32_t *ts)
+{
+    (void)ts;   // 帧内无传感器时间
+    if (!state.initialized || !state.fifo_enabled) return -1;
+    if (n > IMU_FIFO_MAX_BATCH) n = IMU_FIFO_MAX_BATCH;
+
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * FIFO_FRAME_SIZE];
+    uint8_t cnt;
+    if (read_reg(REG_FIFO_COUNT, &cnt) != 0) return -2;
+
+    uint8_t frames = cnt / FIFO_FRAME_SIZE;
+    if (frames > n) frames = n;
+    if (frames == 0) return 0;
+    if (read_regs(REG_FIFO_DATA, buf, frames * FIFO_FRAME_SIZE) != 0) return -2;
+
+    for (uint8_t i = 0; i < frames; i++) {
+        const uint8_t *f = &buf[i * FIFO_FRAME_SIZE];
+        for (uint8_t k = 0; k < 3; k++) {
+            out[i].accel[k] = (int16_t)((f[k * 2] << 8) | f[1 + k * 2]);
+            out[i].gyro[k]  = (int16_t)((f[8 + k * 2] << 8) | f[9 + k * 2]);
+        }
+        out[i].accel_valid = 1;
+    }
+    state.sample_count += frames;
+    return frames;
+}
+
 int sc7i22_fifo_disable(void)
 {
     write_reg(REG_FIFO_CONFIG, 0x00);
@@ -0,0 +1,195 @@
+/**
+ * @file imu_capture.c
+ * @brief 原始 IMU 全速率采集 / Raw IMU capture at full ODR for offline replay
+ *
+ * v0.6.3: 见 imu_capture.h. 单生产者 (样本路径) / 单消费者 (主循环) 环形缓冲,
+ * 写指针只由 push 修改, 读指针只由 ack 修改
+ */
+
+#include "imu_capture.h"
+#include "config.h"
+#include "optimize.h"
+#include <string.h>
+
+#if defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+#define CAP_MASK    (IMU_CAPTURE_DEPTH - 1)
+
+typedef struct {
+    uint16_t seq;
+    int16_t g[3];
+    int16_t a[3];
+} cap_sample_t;
+
+static cap_sample_t ring[IMU_CAPTURE_DEPTH] RAM_ARENA(imu);
+static volatile uint8_t ring_w = 0;     // 仅 push 写
+static volatile uint8_t ring_r = 0;     // 仅 ack 写
+static volatile uint16_t cap_seq = 0;   // 下一个样本序号 (丢弃也递增)
+static volatile uint32_t cap_dropped = 0;
+static volatile bool cap_on = false;
+
+static struct {
+    float val[12];                      // gyro_gain, gyro_off, accel_gain, accel_off
+    uint16_t seq;                       // 生效序号
+    uint8_t imu_type;
+    uint8_t gen;                        // 每次更新递增
+    bool pending;
+} params;
+
+static uint8_t last_kind = 0;           // 上次 build 的报告类型
+static uint8_t last_gen = 0;
+static uint8_t last_count = 0;
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint8_t build_params(uint8_t *buf)
+{
+    buf[0] = IMU_CAPTURE_PARAM_ID;
+    buf[1] = params.imu_type;
+    put_u16(&buf[2], SENSOR_ODR_HZ);
+    put_u16(&buf[4], params.seq);
+    memcpy(&buf[6], params.val, sizeof(params.val));    // RISC-V 小端
+    return IMU_CAPTURE_PARAM_SIZE;
+}
+
+static uint8_t build_samples(uint8_t *buf)
+{
+    uint8_t r = ring_r;
+    uint8_t avail = (uint8_t)(ring_w - r);
+    if (avail == 0) return 0;
+    if (avail > IMU_CAPTURE_PER_REPORT) avail = IMU_CAPTURE_PER_REPORT;
+
+    uint16_t first = ring[r & CAP_MASK].seq;
+    uint8_t *p = &buf[IMU_CAPTURE_HEADER_SIZE];
+    uint8_t n = 0;
+
+    // 只打包序号连续的一段, 丢失处由下一个报告的首序号体现
+    while (n < avail) {
+        const cap_sample_t *s = &ring[(uint8_t)(r + n) & CAP_MASK];
+        if (s->seq != (uint16_t)(first + n)) break;
+        for (int i = 0; i < 3; i++) put_u16(&p[i * 2], (uint16_t)s->g[i]);
+        for (int i = 0; i < 3; i++) put_u16(&p[6 + i * 2], (uint16_t)s->a[i]);
+        p += IMU_CAPTURE_SAMPLE_SIZE;
+        n++;
+    }
+
+    buf[0] = IMU_CAPTURE_REPORT_ID;
+    buf[1] = n;
+    put_u16(&buf[2], first);
+    last_count = n;
+    return (uint8_t)(IMU_CAPTURE_HEADER_SIZE + n * IMU_CAPTURE_SAMPLE_SIZE);
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void imu_capture_enable(bool enable)
+{
+    __disable_irq();
+    if (enable && !cap_on) {
+        ring_w = 0;
+        ring_r = 0;
+        cap_seq = 0;
+        cap_dropped = 0;
+        params.seq = 0;
+        params.pending = true;
+    }
+    cap_on = enable;
+    last_kind = 0;
+    __enable_irq();
+}
+
+bool imu_capture_enabled(void)
+{
+    return cap_on;
+}
+
+void HOT imu_capture_push(const int16_t gyro[3], const int16_t accel[3])
+{
+    if (!cap_on) return;
+
+    uint16_t seq = cap_seq;
+    cap_seq = (uint16_t)(seq + 1);
+
+    uint8_t w = ring_w;
+    if ((uint8_t)(w - ring_r) >= IMU_CAPTURE_DEPTH) {
+        cap_dropped++;
+        return;
+    }
+
+    cap_sample_t *s = &ring[w & CAP_MASK];
+    s->seq = seq;
+    for (int i = 0; i < 3; i++) {
+        s->g[i] = gyro[i];
+        s->a[i] = accel[i];
+    }
+    ring_w = (uint8_t)(w + 1);
+}
+
+void imu_capture_set_params(uint8_t imu_type, const float gyro_gain[3], const float gyro_off[3],
+                            const float accel_gain[3], const float accel_off[3])
+{
+    // 与样本路径互斥: 生效序号之前的样本全部按旧参数换算
+    // 上一组尚未发出时被覆盖 (两次变化间隔短于一个报告周期)
+    __disable_irq();
+    for (int i = 0; i < 3; i++) {
+        params.val[i] = gyro_gain[i];
+        params.val[3 + i] = gyro_off[i];
+        params.val[6 + i] = accel_gain[i];
+        params.val[9 + i] = accel_off[i];
+    }
+    params.imu_type = imu_type;
+    params.seq = cap_seq;
+    params.gen++;
+    params.pending = true;
+    __enable_irq();
+}
+
+uint8_t imu_capture_build(uint8_t *buf)
+{
+    if (!cap_on) return 0;
+
+    if (params.pending) {
+        last_kind = IMU_CAPTURE_PARAM_ID;
+        last_gen = params.gen;
+        return build_params(buf);
+    }
+
+    uint8_t len = build_samples(buf);
+    last_kind = len ? IMU_CAPTURE_REPORT_ID : 0;
+    return len;
+}
+
+void imu_capture_ack(void)
+{
+    if (last_kind == IMU_CAPTURE_PARAM_ID) {
+        // 发送期间参数又变化: 保留 pending, 下次发送新的一组
+        if (params.gen == last_gen) params.pending = false;
+    } else if (last_kind == IMU_CAPTURE_REPORT_ID) {
+        ring_r = (uint8_t)(ring_r + last_count);
+    }
+    last_kind = 0;
+}
+
+uint32_t imu_capture_dropped(void)
+{
+    return cap_dropped;
+}
+
+#endif /* USE_IMU_CAPTURE */
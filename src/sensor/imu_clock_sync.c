@@ -0,0 +1,168 @@
+/**
+ * @file imu_clock_sync.c
+ * @brief IMU 采样与 RF 超帧相位锁定 / IMU ODR phase lock to RF superframe
+ *
+ * v0.6.3: PI 环
+ *   e    = wrap((sample_ts - sync_time - target) mod P)   样本晚到为正
+ *   trim = -drift_ff + KP * e + I,  I += KI * e
+ * 晚到时略微提高 CLKIN 频率, 后续样本逐步前移, 直到落在目标相位
+ */
+
+#include "imu_clock_sync.h"
+#include "hal_clkin.h"
+#include "imu_interface.h"
+#include "config.h"
+#include "rf_protocol.h"
+#include <string.h>
+
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+#include "rf_timing_opt.h"
+#endif
+
+/*============================================================================
+ * 配置
+ *============================================================================*/
+
+#define CLKSYNC_PERIOD_US       (1000000L / SENSOR_ODR_HZ)
+
+#if (RF_SUPERFRAME_US % CLKSYNC_PERIOD_US) != 0
+#error "IMU clock sync requires RF_SUPERFRAME_US to be a multiple of the IMU sample period"
+#endif
+
+// 即时采样读取时刻必须晚于样本就绪时刻
+#if defined(USE_JIT_SAMPLING) && USE_JIT_SAMPLING && (JIT_SAMPLE_LEAD_US >= IMU_CLKSYNC_LEAD_US)
+#error "JIT_SAMPLE_LEAD_US must be smaller than IMU_CLKSYNC_LEAD_US"
+#endif
+
+// 增益 (每次更新, 约每个水位周期一次)
+// KP: 100us 误差 → 100ppm, 约 1s 收敛; KI 取 ζ≈0.7
+#define CLKSYNC_KP_PPB_PER_US   1000
+#define CLKSYNC_KI_PPB_PER_US   5
+#define CLKSYNC_I_MAX_PPB       500000      // 积分限幅 ±500 ppm
+#define CLKSYNC_I_WINDOW_US     300         // 捕获阶段 (大误差) 只用比例项, 避免积分饱和超调
+
+// 锁定判定
+#define CLKSYNC_LOCK_WINDOW_US  50
+#define CLKSYNC_LOCK_COUNT      32
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+static struct {
+    bool active;
+    bool locked;
+    uint8_t in_window;
+    int32_t integ_ppb;
+    int32_t trim_ppb;
+    int32_t phase_err_us;
+} clksync;
+
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+static int32_t clamp_i32(int32_t v, int32_t lim)
+{
+    if (v > lim) return lim;
+    if (v < -lim) return -lim;
+    return v;
+}
+
+static int32_t feed_forward_ppb(void)
+{
+#if defined(USE_RF_TIMING_OPT) && USE_RF_TIMING_OPT
+    // 本地时钟偏快 d → CLKIN (由本地时钟分频) 也偏快 d, 需要反向补偿
+    return -rf_timing_get_drift_ppb();
+#else
+    return 0;
+#endif
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+int imu_clock_sync_init(void)
+{
+    memset(&clksync, 0, sizeof(clksync));
+
+    if (hal_clkout_init() != 0) {
+        return -1;
+    }
+
+    if (imu_set_external_clock(true) != 0) {
+        hal_clkout_stop();
+        return -2;
+    }
+
+    clksync.active = true;
+    return 0;
+}
+
+void imu_clock_sync_stop(void)
+{
+    if (!clksync.active) return;
+
+    imu_set_external_clock(false);
+    hal_clkout_stop();
+    clksync.active = false;
+    clksync.locked = false;
+}
+
+void imu_clock_sync_update(uint32_t sample_ts_us, uint32_t sync_time_us,
+                           uint32_t slot_offset_us)
+{
+    if (!clksync.active) return;
+
+    // 相位误差, 按采样周期取模后折叠到 [-P/2, P/2)
+    // (样本可能早于信标, 先取有符号差值再取模)
+    int32_t target = (int32_t)(slot_offset_us % CLKSYNC_PERIOD_US) - IMU_CLKSYNC_LEAD_US;
+    int32_t e = ((int32_t)(sample_ts_us - sync_time_us) - target) % CLKSYNC_PERIOD_US;
+    if (e >= CLKSYNC_PERIOD_US / 2) e -= CLKSYNC_PERIOD_US;
+    if (e < -CLKSYNC_PERIOD_US / 2) e += CLKSYNC_PERIOD_US;
+    clksync.phase_err_us = e;
+
+    if (e < CLKSYNC_I_WINDOW_US && e > -CLKSYNC_I_WINDOW_US) {
+        clksync.integ_ppb = clamp_i32(clksync.integ_ppb + e * CLKSYNC_KI_PPB_PER_US,
+                                      CLKSYNC_I_MAX_PPB);
+    }
+    clksync.trim_ppb = clamp_i32(feed_forward_ppb() + e * CLKSYNC_KP_PPB_PER_US +
+                                 clksync.integ_ppb, IMU_CLKSYNC_MAX_PPB);
+    hal_clkout_set_trim_ppb(clksync.trim_ppb);
+
+    // 锁定检测
+    if (e < CLKSYNC_LOCK_WINDOW_US && e > -CLKSYNC_LOCK_WINDOW_US) {
+        if (clksync.in_window < CLKSYNC_LOCK_COUNT) {
+            clksync.in_window++;
+        } else {
+            clksync.locked = true;
+        }
+    } else {
+        clksync.in_window = 0;
+        clksync.locked = false;
+    }
+}
+
+void imu_clock_sync_hold(void)
+{
+    if (!clksync.active) return;
+
+    // 没有信标时相位无参考, 只保留频率 (去掉比例项)
+    clksync.trim_ppb = clamp_i32(feed_forward_ppb() + clksync.integ_ppb,
+                                 IMU_CLKSYNC_MAX_PPB);
+    hal_clkout_set_trim_ppb(clksync.trim_ppb);
+    clksync.in_window = 0;
+    clksync.locked = false;
+}
+
+bool imu_clock_sync_locked(void)
+{
+    return clksync.locked;
+}
+
+void imu_clock_sync_get_state(int32_t *phase_err_us, int32_t *trim_ppb)
+{
+    if (phase_err_us) *phase_err_us = clksync.phase_err_us;
+    if (trim_ppb) *trim_ppb = clksync.trim_ppb;
+}
@@ -7,6 +7,9 @@
  * 优先级: SPI > I2C
  * 初始化时自动检测接口类型
  * 
+ * v0.6.3: make IMU=<型号> IMU_BUS=SPI|I2C 时型号和总线在编译期固定,
+ * 寄存器访问直接内联到对应总线, 检测代码和其他型号的分支不再编译进固件
+ * 
  * 支持的 IMU:
  * - ICM-45686 (默认, 推荐)
  * - ICM-42688
@@ -18,12 +21,33 @@
 #include "imu_interface.h"
 #include "hal.h"
 #include "board.h"
+#include "config.h"
+#include "bmi270_config.h"  // v0.6.3: BMI270 配置文件
+#include "icm45686.h"       // v0.6.3: ICM-45686 寄存器地址 (FIFO 路径)
+#include "fast_math.h"
 #include <string.h>
 
+#if defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+#include "imu_capture.h"
+#endif
+
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+#include "bus_sched.h"
+#endif
+
 #ifdef CH59X
 #include "CH59x_common.h"
 #endif
 
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+#endif
+
 /*============================================================================
  * 配置 / Configuration
  *============================================================================*/
@@ -40,6 +64,26 @@ typedef enum {
 #define IMU_TYPE    IMU_ICM45686
 #endif
 
+// v0.6.3: 安装方向 (板级 config.h 未定义时不换轴)
+#ifndef IMU_AXIS_X
+#define IMU_AXIS_X  1
+#define IMU_AXIS_Y  2
+#define IMU_AXIS_Z  3
+#endif
+
+#define IMU_AXIS_ABS(a)     ((a) < 0 ? -(a) : (a))
+
+#if IMU_AXIS_ABS(IMU_AXIS_X) < 1 || IMU_AXIS_ABS(IMU_AXIS_X) > 3 || \
+    IMU_AXIS_ABS(IMU_AXIS_Y) < 1 || IMU_AXIS_ABS(IMU_AXIS_Y) > 3 || \
+    IMU_AXIS_ABS(IMU_AXIS_Z) < 1 || IMU_AXIS_ABS(IMU_AXIS_Z) > 3
+#error "IMU_AXIS_X/Y/Z must be +/-1..3"
+#endif
+#if IMU_AXIS_ABS(IMU_AXIS_X) == IMU_AXIS_ABS(IMU_AXIS_Y) || \
+    IMU_AXIS_ABS(IMU_AXIS_X) == IMU_AXIS_ABS(IMU_AXIS_Z) || \
+    IMU_AXIS_ABS(IMU_AXIS_Y) == IMU_AXIS_ABS(IMU_AXIS_Z)
+#error "IMU_AXIS_X/Y/Z must map to three different chip axes"
+#endif
+
 /*============================================================================
  * WHO_AM_I 寄存器定义 / WHO_AM_I Register Definitions
  *============================================================================*/
@@ -76,14 +120,62 @@ typedef enum {
 #define LSM6DSV_I2C_ADDR_0      0x6A
 #define LSM6DSV_I2C_ADDR_1      0x6B
 
+/*============================================================================
+ * v0.6.3: 编译期固定型号/总线 / Compile-time fixed IMU
+ *============================================================================*/
+
+#if defined(IMU_FIXED_BUS)
+#if defined(USE_IMU_ICM45686_ONLY)
+#define IMU_FIXED_TYPE          IMU_ICM45686
+#define IMU_FIXED_WHO_REG       ICM45686_WHO_AM_I_REG
+#define IMU_FIXED_WHO_VAL       ICM45686_WHO_AM_I_VAL
+#elif defined(USE_IMU_ICM42688_ONLY)
+#define IMU_FIXED_TYPE          IMU_ICM42688
+#define IMU_FIXED_WHO_REG       ICM42688_WHO_AM_I_REG
+#define IMU_FIXED_WHO_VAL       ICM42688_WHO_AM_I_VAL
+#elif defined(USE_IMU_BMI270_ONLY)
+#define IMU_FIXED_TYPE          IMU_BMI270
+#define IMU_FIXED_WHO_REG       BMI270_WHO_AM_I_REG
+#define IMU_FIXED_WHO_VAL       BMI270_WHO_AM_I_VAL
+#elif defined(USE_IMU_LSM6DSV_ONLY)
+#define IMU_FIXED_TYPE          IMU_LSM6DSV
+#define IMU_FIXED_WHO_REG       LSM6DSV_WHO_AM_I_REG
+#define IMU_FIXED_WHO_VAL       LSM6DSV_WHO_AM_I_VAL
+#elif defined(USE_IMU_LSM6DSR_ONLY)
+#define IMU_FIXED_TYPE          IMU_LSM6DSR
+#define IMU_FIXED_WHO_REG       LSM6DSR_WHO_AM_I_REG
+#define IMU_FIXED_WHO_VAL       LSM6DSR_WHO_AM_I_VAL
+#else
+#error "IMU_FIXED_BUS requires IMU=ICM45686|ICM42688|BMI270|LSM6DSV|LSM6DSR"
+#endif
+
+#if IMU_FIXED_BUS != IMU_BUS_SPI && IMU_FIXED_BUS != IMU_BUS_I2C
+#error "IMU_FIXED_BUS must be IMU_BUS_SPI or IMU_BUS_I2C"
+#endif
+
+// I2C 地址默认取 SA0=0, 可用 -DIMU_FIXED_I2C_ADDR=0x69 覆盖
+#ifndef IMU_FIXED_I2C_ADDR
+#if IMU_FIXED_TYPE == IMU_LSM6DSV || IMU_FIXED_TYPE == IMU_LSM6DSR
+#define IMU_FIXED_I2C_ADDR      LSM6DSV_I2C_ADDR_0
+#else
+#define IMU_FIXED_I2C_ADDR      ICM45686_I2C_ADDR_0
+#endif
+#endif
+#endif /* IMU_FIXED_BUS */
+
+#if defined(IMU_FIXED_TYPE) && defined(USE_AUX_IMU) && USE_AUX_IMU
+#error "USE_AUX_IMU requires runtime IMU detection (no IMU_FIXED_BUS)"
+#endif
+
 /*============================================================================
  * 状态 / State
  *============================================================================*/
 
-static struct {
+typedef struct {
     imu_interface_type_t interface;
     uint8_t imu_type;
     uint8_t i2c_addr;
+    bool init_started;      // v0.6.3: imu_init_start 成功, 等待 imu_init_finish
     bool initialized;
     
     // 量程配置
@@ -93,133 +185,258 @@ static struct {
     // 校准数据
     float gyro_bias[3];
     float accel_bias[3];
-} imu_ctx;
+    
+    // v0.6.3: 融合预处理 (由量程/偏置预先算好, 每样本一次乘减)
+    float pp_gyro_gain[3];  // gyro_scale × deg2rad
+    float pp_accel_gain[3];
+    float pp_gyro_off[3];   // rad/s, 输出坐标系
+    float pp_accel_off[3];  // g, 输出坐标系
+    imu_preproc_t pp;
+    
+    // v0.6.3: 功耗档 (imu_power_profile_t), 初始化/恢复后为 IMU_PROFILE_HIGH
+    uint8_t profile;
+    
+    // v0.6.3: 芯片温度 (随数据突发/FIFO 读出)
+    float temp_c;
+    bool temp_valid;
+    uint8_t temp_decim;
+    
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+    // v0.6.3: 陀螺量程自动切换 (解码路径统计, imu_gyro_range_update 切换)
+    uint8_t gr_level;       // 档位: 满量程 500 << gr_level dps
+    uint8_t gr_backlog;     // 切换时已产生的旧量程样本数, 解码时换到新量程计数
+    int8_t gr_shift;        // 旧 → 新量程计数的移位 (> 0 左移)
+    bool gr_saturated;      // 上次更新以来出现饱和样本
+    bool gr_seen;           // 上次更新以来有样本
+    bool gr_quiet;          // 峰值持续低于收窄阈值, 起始于 gr_quiet_ms
+    uint16_t gr_peak;       // 上次更新以来最大 |raw|
+    uint32_t gr_quiet_ms;
+#endif
+} imu_ctx_t;
+
+// v0.6.3: 每个 IMU 一份状态, 寄存器访问和换算都作用于 imu_select 选中的那一个
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+#define IMU_SENSOR_COUNT    2
+static imu_ctx_t imu_sensors[IMU_SENSOR_COUNT];
+static uint8_t imu_sel = IMU_SENSOR_PRIMARY;
+#define IMU_CUR_SENSOR      imu_sel
+#define IMU_CUR_CS          (imu_sel == IMU_SENSOR_AUX ? IMU_AUX_SPI_CS_PIN : GPIO_Pin_4)
+#define IMU_CUR_SPI_DEV     (imu_sel == IMU_SENSOR_AUX ? HAL_SPI_DEV_IMU_AUX : HAL_SPI_DEV_IMU)
+#else
+#define IMU_SENSOR_COUNT    1
+static imu_ctx_t imu_sensors[IMU_SENSOR_COUNT];
+#define IMU_CUR_SENSOR      IMU_SENSOR_PRIMARY
+#define IMU_CUR_CS          GPIO_Pin_4
+#define IMU_CUR_SPI_DEV     HAL_SPI_DEV_IMU
+#endif
+#define imu_ctx             imu_sensors[IMU_CUR_SENSOR]
+#define IMU_IS_PRIMARY      (IMU_CUR_SENSOR == IMU_SENSOR_PRIMARY)
+
+// 运动引擎/SFLP/上传 DMA 只用于主 IMU
+static uint8_t motion_armed = 0;        // v0.6.3: imu_motion_arm 已使能的事件 (IMU_MOTION_*)
+
+// 当前型号/总线/地址: 固定模式下为编译期常量, switch 和总线分支被常量折叠
+#if defined(IMU_FIXED_TYPE)
+#define IMU_CUR_TYPE    IMU_FIXED_TYPE
+#define IMU_CUR_IF      IMU_FIXED_BUS
+#define IMU_CUR_ADDR    IMU_FIXED_I2C_ADDR
+#else
+#define IMU_CUR_TYPE    imu_ctx.imu_type
+#define IMU_CUR_IF      imu_ctx.interface
+#define IMU_CUR_ADDR    imu_ctx.i2c_addr
+#endif
 
 /*============================================================================
  * 底层通信 / Low-level Communication
  *============================================================================*/
 
 // SPI 读写
-static uint8_t spi_read_reg(uint8_t reg)
+// v0.6.3: 每个事务用 hal_spi_sync_begin/end 括起, 数据就绪中断中的乒乓环 DMA
+// 不会在 CS 拉低期间插入 (推迟到 end 时启动)
+static inline uint8_t spi_read_reg(uint8_t reg)
 {
-    uint8_t val;
+    uint8_t val = 0;
 #ifdef CH59X
-    GPIOA_ResetBits(GPIO_Pin_4);  // CS low
+    hal_spi_sync_begin();
+    GPIOA_ResetBits(IMU_CUR_CS);  // CS low
     hal_spi_xfer(reg | 0x80);     // Read: bit7 = 1
     val = hal_spi_xfer(0x00);
-    GPIOA_SetBits(GPIO_Pin_4);    // CS high
+    GPIOA_SetBits(IMU_CUR_CS);    // CS high
+    hal_spi_sync_end();
 #endif
     return val;
 }
 
-static void spi_write_reg(uint8_t reg, uint8_t val)
+static inline void spi_write_reg(uint8_t reg, uint8_t val)
 {
 #ifdef CH59X
-    GPIOA_ResetBits(GPIO_Pin_4);  // CS low
+    hal_spi_sync_begin();
+    GPIOA_ResetBits(IMU_CUR_CS);  // CS low
     hal_spi_xfer(reg & 0x7F);     // Write: bit7 = 0
     hal_spi_xfer(val);
-    GPIOA_SetBits(GPIO_Pin_4);    // CS high
+    GPIOA_SetBits(IMU_CUR_CS);    // CS high
+    hal_spi_sync_end();
 #endif
 }
 
-static void spi_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
+static inline void spi_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
 {
 #ifdef CH59X
-    GPIOA_ResetBits(GPIO_Pin_4);
+    hal_spi_sync_begin();
+    GPIOA_ResetBits(IMU_CUR_CS);
     hal_spi_xfer(reg | 0x80);
     for (uint8_t i = 0; i < len; i++) {
         buf[i] = hal_spi_xfer(0x00);
     }
-    GPIOA_SetBits(GPIO_Pin_4);
+    GPIOA_SetBits(IMU_CUR_CS);
+    hal_spi_sync_end();
 #endif
 }
 
 // I2C 读写
-static uint8_t i2c_read_reg(uint8_t reg)
+// v0.6.3: 统一走 hal_i2c (USE_HW_I2C 时为硬件外设, 带超时和 NACK 检测);
+// USE_BUS_SCHED 时经总线调度, 磁力计读取在途时等其结束而不是读取失败
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+#define IMU_BUS_CLIENT      (IMU_IS_PRIMARY ? BUS_CLIENT_IMU : BUS_CLIENT_IMU_AUX)
+#define imu_i2c_read(reg, buf, len)     bus_sched_read(IMU_BUS_CLIENT, IMU_CUR_ADDR, reg, buf, len)
+#define imu_i2c_write(reg, data, len)   bus_sched_write(IMU_BUS_CLIENT, IMU_CUR_ADDR, reg, data, len)
+#else
+#define imu_i2c_read(reg, buf, len)     hal_i2c_read_reg(IMU_CUR_ADDR, reg, buf, len)
+#define imu_i2c_write(reg, data, len)   hal_i2c_write_reg(IMU_CUR_ADDR, reg, data, len)
+#endif
+
+// v0.6.3: 不再忽略返回值. 非调度模式下磁力计异步读取在途时 hal_i2c 返回 -2,
+// 等其结束 (最多 IMU_I2C_BUSY_WAIT_US) 后重试; 仍失败时缓冲区清零并返回错误, 不留旧数据
+#define IMU_I2C_BUSY_WAIT_US    2000
+
+static int i2c_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
 {
-    uint8_t val = 0;
-#ifdef CH59X
-    I2C_Start();
-    I2C_SendByte((imu_ctx.i2c_addr << 1) | 0);  // Write
-    I2C_SendByte(reg);
-    I2C_Start();  // Repeated start
-    I2C_SendByte((imu_ctx.i2c_addr << 1) | 1);  // Read
-    val = I2C_RecvByte(0);  // NACK for single byte
-    I2C_Stop();
+    int ret = imu_i2c_read(reg, buf, len);
+#if !(defined(USE_BUS_SCHED) && USE_BUS_SCHED)
+    for (uint16_t t = 0; ret == -2 && t < IMU_I2C_BUSY_WAIT_US; t += 10) {
+        hal_delay_us(10);
+        ret = imu_i2c_read(reg, buf, len);
+    }
 #endif
-    return val;
+    if (ret != 0) memset(buf, 0, len);
+    return ret;
 }
 
-static void i2c_write_reg(uint8_t reg, uint8_t val)
+static inline int i2c_read_reg(uint8_t reg, uint8_t *val)
 {
-#ifdef CH59X
-    I2C_Start();
-    I2C_SendByte((imu_ctx.i2c_addr << 1) | 0);
-    I2C_SendByte(reg);
-    I2C_SendByte(val);
-    I2C_Stop();
-#endif
+    return i2c_read_regs(reg, val, 1);
 }
 
-static void i2c_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
+static inline void i2c_write_reg(uint8_t reg, uint8_t val)
 {
-#ifdef CH59X
-    I2C_Start();
-    I2C_SendByte((imu_ctx.i2c_addr << 1) | 0);
-    I2C_SendByte(reg);
-    I2C_Start();
-    I2C_SendByte((imu_ctx.i2c_addr << 1) | 1);
-    for (uint8_t i = 0; i < len; i++) {
-        buf[i] = I2C_RecvByte(i < len - 1 ? 1 : 0);  // ACK for all except last
-    }
-    I2C_Stop();
-#endif
+    imu_i2c_write(reg, &val, 1);
 }
 
 // 统一接口
-static uint8_t imu_read_reg(uint8_t reg)
+// I2C 读失败时返回 0 (配置寄存器读改写); 数据路径用 imu_read_regs 的返回值
+static inline uint8_t imu_read_reg(uint8_t reg)
 {
-    if (imu_ctx.interface == IMU_IF_SPI) {
+    if (IMU_CUR_IF == IMU_IF_SPI) {
         return spi_read_reg(reg);
     } else {
-        return i2c_read_reg(reg);
+        uint8_t val;
+        i2c_read_reg(reg, &val);
+        return val;
     }
 }
 
-static void imu_write_reg(uint8_t reg, uint8_t val)
+static inline void imu_write_reg(uint8_t reg, uint8_t val)
 {
-    if (imu_ctx.interface == IMU_IF_SPI) {
+    if (IMU_CUR_IF == IMU_IF_SPI) {
         spi_write_reg(reg, val);
     } else {
         i2c_write_reg(reg, val);
     }
 }
 
-static void imu_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
+static inline int imu_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
 {
-    if (imu_ctx.interface == IMU_IF_SPI) {
+    if (IMU_CUR_IF == IMU_IF_SPI) {
         spi_read_regs(reg, buf, len);
-    } else {
-        i2c_read_regs(reg, buf, len);
+        return 0;
     }
+    return i2c_read_regs(reg, buf, len);
 }
 
 /*============================================================================
  * IMU 检测 / IMU Detection
  *============================================================================*/
 
-static bool detect_imu_spi(void)
+static void spi_bus_init(void)
 {
-    // 初始化 SPI
 #ifdef CH59X
     // SPI CS 引脚
-    GPIOA_SetBits(GPIO_Pin_4);
-    GPIOA_ModeCfg(GPIO_Pin_4, GPIO_ModeOut_PP_5mA);
+    GPIOA_SetBits(IMU_CUR_CS);
+    GPIOA_ModeCfg(IMU_CUR_CS, GPIO_ModeOut_PP_5mA);
     
-    // SPI 初始化 (Mode 3, 8MHz)
+    // SPI 初始化 (Mode 3, 7.5MHz)
     SPI0_MasterDefInit();
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+    // v0.6.3: 检测在保守档进行, imu_init_start 检测到之后再验证更高的档
+    hal_spi_profile_set(IMU_CUR_SPI_DEV, SPI_IMU_DEFAULT_HZ);
+    hal_spi_select(IMU_CUR_SPI_DEV);
+#else
     SPI0_CLKCfg(8);  // 60MHz / 8 = 7.5MHz
 #endif
+#endif
+}
+
+static void i2c_bus_init(void)
+{
+#ifdef CH59X
+    // CH59x I2C初始化 - 使用hal_i2c_init
+    hal_i2c_config_t i2c_cfg = {
+        .speed_hz = 400000,  // 400kHz
+    };
+    hal_i2c_init(&i2c_cfg);
+#endif
+}
+
+#if (defined(USE_FAST_WAKE) && USE_FAST_WAKE && !defined(IMU_FIXED_TYPE)) || \
+    (defined(USE_SPI_PROFILES) && USE_SPI_PROFILES)
+// v0.6.3: 当前型号的 WHO_AM_I 寄存器和期望值, 返回 false 表示型号未知
+static bool who_layout(uint8_t *reg, uint8_t *val)
+{
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686: *reg = ICM45686_WHO_AM_I_REG; *val = ICM45686_WHO_AM_I_VAL; return true;
+        case IMU_ICM42688: *reg = ICM42688_WHO_AM_I_REG; *val = ICM42688_WHO_AM_I_VAL; return true;
+        case IMU_BMI270:   *reg = BMI270_WHO_AM_I_REG;   *val = BMI270_WHO_AM_I_VAL;   return true;
+        case IMU_LSM6DSV:  *reg = LSM6DSV_WHO_AM_I_REG;  *val = LSM6DSV_WHO_AM_I_VAL;  return true;
+        case IMU_LSM6DSR:  *reg = LSM6DSR_WHO_AM_I_REG;  *val = LSM6DSR_WHO_AM_I_VAL;  return true;
+        default:           return false;
+    }
+}
+#endif
+
+#if defined(IMU_FIXED_TYPE)
+
+// v0.6.3: 固定模式只初始化指定总线, 校验一次 WHO_AM_I
+static bool detect_imu_fixed(void)
+{
+#if IMU_FIXED_BUS == IMU_BUS_SPI
+    spi_bus_init();
+    imu_ctx.interface = IMU_IF_SPI;
+#else
+    i2c_bus_init();
+    imu_ctx.interface = IMU_IF_I2C;
+    imu_ctx.i2c_addr = IMU_FIXED_I2C_ADDR;
+#endif
+    imu_ctx.imu_type = IMU_FIXED_TYPE;
+    
+    return imu_read_reg(IMU_FIXED_WHO_REG) == IMU_FIXED_WHO_VAL;
+}
+
+#else
+
+static bool detect_imu_spi(void)
+{
+    // 初始化 SPI
+    spi_bus_init();
     
     imu_ctx.interface = IMU_IF_SPI;
     
@@ -278,16 +495,11 @@ static bool detect_imu_spi(void)
     return false;
 }
 
-static bool detect_imu_i2c(void)
+// skip_addr: 已被其他 IMU 占用的地址 (0 = 无)
+static bool detect_imu_i2c(uint8_t skip_addr)
 {
     // 初始化 I2C
-#ifdef CH59X
-    // CH59x I2C初始化 - 使用hal_i2c_init
-    hal_i2c_config_t i2c_cfg = {
-        .speed_hz = 400000,  // 400kHz
-    };
-    hal_i2c_init(&i2c_cfg);
-#endif
+    i2c_bus_init();
     
     imu_ctx.interface = IMU_IF_I2C;
     
@@ -295,13 +507,15 @@ static bool detect_imu_i2c(void)
     static const uint8_t addrs[] = {0x68, 0x69, 0x6A, 0x6B};
     
     for (int i = 0; i < 4; i++) {
+        if (addrs[i] == skip_addr) continue;
         imu_ctx.i2c_addr = addrs[i];
         
         uint8_t who;
         
         // ICM-45686 / ICM-42688 / IIM-42652 / SC7I22
+        // 首次读失败 (地址无应答) 时跳过该地址
         if (addrs[i] == 0x68 || addrs[i] == 0x69) {
-            who = i2c_read_reg(ICM45686_WHO_AM_I_REG);
+            if (i2c_read_reg(ICM45686_WHO_AM_I_REG, &who) != 0) continue;
             if (who == ICM45686_WHO_AM_I_VAL) {
                 imu_ctx.imu_type = IMU_ICM45686;
                 return true;
@@ -316,14 +530,12 @@ static bool detect_imu_i2c(void)
             }
             
             // SC7I22 使用不同的 WHO_AM_I 寄存器
-            who = i2c_read_reg(SC7I22_WHO_AM_I_REG);
-            if (who == SC7I22_WHO_AM_I_VAL) {
+            if (i2c_read_reg(SC7I22_WHO_AM_I_REG, &who) == 0 && who == SC7I22_WHO_AM_I_VAL) {
                 imu_ctx.imu_type = IMU_SC7I22;
                 return true;
             }
             
-            who = i2c_read_reg(BMI270_WHO_AM_I_REG);
-            if (who == BMI270_WHO_AM_I_VAL) {
+            if (i2c_read_reg(BMI270_WHO_AM_I_REG, &who) == 0 && who == BMI270_WHO_AM_I_VAL) {
                 imu_ctx.imu_type = IMU_BMI270;
                 return true;
             }
@@ -331,7 +543,7 @@ static bool detect_imu_i2c(void)
         
         // LSM6DSV / LSM6DSR
         if (addrs[i] == 0x6A || addrs[i] == 0x6B) {
-            who = i2c_read_reg(LSM6DSV_WHO_AM_I_REG);
+            if (i2c_read_reg(LSM6DSV_WHO_AM_I_REG, &who) != 0) continue;
             if (who == LSM6DSV_WHO_AM_I_VAL) {
                 imu_ctx.imu_type = IMU_LSM6DSV;
                 return true;
@@ -346,6 +558,69 @@ static bool detect_imu_i2c(void)
     return false;
 }
 
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+// v0.6.3: 辅助 IMU 与主 IMU 在同一总线上: SPI 换片选, I2C 跳过主 IMU 的地址
+static bool detect_imu_aux(void)
+{
+    const imu_ctx_t *pri = &imu_sensors[IMU_SENSOR_PRIMARY];
+    
+    if (pri->interface == IMU_IF_SPI) {
+        return detect_imu_spi();
+    }
+    return detect_imu_i2c(pri->i2c_addr);
+}
+#endif
+
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE
+// v0.6.3: 上次识别出的型号/总线/地址放在 Shutdown 保持的 RAM2K 中, 深睡眠复位后
+// 只读一次该型号的 WHO_AM_I; 上电复位时内容随机, 用 magic 异或内容校验
+#define IMU_HINT_MAGIC          0x494D5548UL    // "IMUH"
+
+static struct {
+    uint32_t check;
+    uint8_t imu_type;
+    uint8_t interface;
+    uint8_t i2c_addr;
+} imu_hint __attribute__((section(".retained")));
+
+static uint32_t imu_hint_check(void)
+{
+    return IMU_HINT_MAGIC ^ imu_hint.imu_type ^ ((uint32_t)imu_hint.interface << 8) ^
+           ((uint32_t)imu_hint.i2c_addr << 16);
+}
+
+static bool imu_who_matches(void)
+{
+    uint8_t reg, val;
+    return who_layout(&reg, &val) && imu_read_reg(reg) == val;
+}
+
+static bool detect_imu_hint(void)
+{
+    if (imu_hint.check != imu_hint_check()) return false;
+    
+    imu_ctx.imu_type = imu_hint.imu_type;
+    imu_ctx.interface = (imu_interface_type_t)imu_hint.interface;
+    imu_ctx.i2c_addr = imu_hint.i2c_addr;
+    if (imu_ctx.interface == IMU_IF_SPI) {
+        spi_bus_init();
+    } else {
+        i2c_bus_init();
+    }
+    return imu_who_matches();
+}
+
+static void imu_hint_save(void)
+{
+    imu_hint.imu_type = imu_ctx.imu_type;
+    imu_hint.interface = (uint8_t)imu_ctx.interface;
+    imu_hint.i2c_addr = imu_ctx.i2c_addr;
+    imu_hint.check = imu_hint_check();
+}
+#endif
+
+#endif /* IMU_FIXED_TYPE */
+
 /*============================================================================
  * IMU 初始化 / IMU Initialization
  *============================================================================*/
@@ -375,13 +650,176 @@ static int init_icm45686(void)
     return 0;
 }
 
-static int init_bmi270(void)
+/*
+ * v0.6.3: BMI270 配置文件上传
+ * 每次突发前写 INIT_ADDR (字地址 = 偏移 / 2), 数据写 INIT_DATA; 全部写完后 INIT_CTRL=1,
+ * 20ms 后 INTERNAL_STATUS 报告 init_ok. MCU 热复位不断 IMU 电源, 配置仍在时整段跳过.
+ * SPI + USE_BMI270_DMA_UPLOAD: Flash → RAM 双缓冲 → DMA, 完成中断里发下一块并准备再下一块,
+ * imu_init_start 返回后上传在后台进行, imu_init_finish 等待并完成其余配置
+ */
+#define BMI_REG_INTERNAL_STATUS 0x21
+#define BMI_REG_INIT_CTRL       0x59
+#define BMI_REG_INIT_ADDR_0     0x5B
+#define BMI_REG_INIT_ADDR_1     0x5C
+#define BMI_REG_INIT_DATA       0x5E
+#define BMI_REG_PWR_CONF        0x7C
+#define BMI_STATUS_MSG_MASK     0x0F
+#define BMI_STATUS_INIT_OK      0x01
+#define BMI_INIT_WAIT_US        20000   // INIT_CTRL=1 到状态有效
+#define BMI_UPLOAD_TIMEOUT_US   100000
+
+static struct {
+    volatile bool busy;
+    volatile bool failed;
+    bool skipped;               // 热复位, 配置仍在
+    bool prefilled;             // 下一块已在另一缓冲区 (首块由主循环上下文准备)
+    uint8_t idx;
+    uint16_t off;
+    uint32_t done_us;
+} bmi_cfg;
+
+#if defined(USE_BMI270_DMA_UPLOAD) && USE_BMI270_DMA_UPLOAD
+static uint8_t __attribute__((aligned(4))) bmi_cfg_buf[2][BMI270_CFG_BURST];
+#endif
+
+static uint8_t bmi_read_status(void)
+{
+    if (IMU_CUR_IF == IMU_IF_SPI) {
+        // BMI270 SPI 读的第一个字节是哑字节
+        uint8_t buf[2];
+        imu_read_regs(BMI_REG_INTERNAL_STATUS, buf, 2);
+        return buf[1];
+    }
+    return imu_read_reg(BMI_REG_INTERNAL_STATUS);
+}
+
+static uint16_t bmi_cfg_chunk(uint16_t off)
+{
+    uint16_t left = (uint16_t)(sizeof(bmi270_config_file) - off);
+    return (left < BMI270_CFG_BURST) ? left : BMI270_CFG_BURST;
+}
+
+static void bmi_cfg_set_addr(uint16_t off)
+{
+    imu_write_reg(BMI_REG_INIT_ADDR_0, (off >> 1) & 0x0F);
+    imu_write_reg(BMI_REG_INIT_ADDR_1, (uint8_t)(off >> 5));
+}
+
+static void bmi_cfg_complete(void)
+{
+    imu_write_reg(BMI_REG_INIT_CTRL, 0x01);
+    bmi_cfg.done_us = hal_micros();
+    bmi_cfg.busy = false;
+}
+
+#if defined(USE_BMI270_DMA_UPLOAD) && USE_BMI270_DMA_UPLOAD
+// 上一块发送完成 (SPI0 中断, CS 已释放) 或首次启动时调用
+static void bmi_cfg_dma_next(void)
+{
+    uint16_t off = bmi_cfg.off;
+    if (off >= sizeof(bmi270_config_file)) {
+        bmi_cfg_complete();
+        return;
+    }
+    
+    uint16_t len = bmi_cfg_chunk(off);
+    const uint8_t *buf = bmi_cfg_buf[bmi_cfg.idx];
+    bmi_cfg_set_addr(off);
+    bmi_cfg.off = off + len;
+    bmi_cfg.idx ^= 1;
+    
+    if (hal_spi_dma_write(PIN_SPI_CS, BMI_REG_INIT_DATA & 0x7F, buf, len, bmi_cfg_dma_next) != 0) {
+        bmi_cfg.failed = true;
+        bmi_cfg.busy = false;
+        return;
+    }
+    
+    // DMA 发送本块期间把再下一块拷进刚空出的缓冲区
+    if (bmi_cfg.prefilled) {
+        bmi_cfg.prefilled = false;
+    } else if (bmi_cfg.off < sizeof(bmi270_config_file)) {
+        memcpy(bmi_cfg_buf[bmi_cfg.idx], &bmi270_config_file[bmi_cfg.off], bmi_cfg_chunk(bmi_cfg.off));
+    }
+}
+#endif
+
+static void bmi_cfg_upload_pio(void)
+{
+    for (uint16_t off = 0; off < sizeof(bmi270_config_file); off += BMI270_CFG_BURST) {
+        uint16_t len = bmi_cfg_chunk(off);
+        bmi_cfg_set_addr(off);
+        if (IMU_CUR_IF == IMU_IF_SPI) {
+#ifdef CH59X
+            hal_spi_sync_begin();
+            GPIOA_ResetBits(IMU_CUR_CS);
+            hal_spi_xfer(BMI_REG_INIT_DATA & 0x7F);
+            for (uint16_t i = 0; i < len; i++) {
+                hal_spi_xfer(bmi270_config_file[off + i]);
+            }
+            GPIOA_SetBits(IMU_CUR_CS);
+            hal_spi_sync_end();
+#endif
+        } else {
+            imu_i2c_write(BMI_REG_INIT_DATA, &bmi270_config_file[off], len);
+        }
+    }
+    bmi_cfg_complete();
+}
+
+static int init_bmi270_start(void)
+{
+    memset(&bmi_cfg, 0, sizeof(bmi_cfg));
+    
+    if ((bmi_read_status() & BMI_STATUS_MSG_MASK) == BMI_STATUS_INIT_OK) {
+        bmi_cfg.skipped = true;
+        return 0;
+    }
+    
+    imu_write_reg(BMI_REG_PWR_CONF, 0x00);      // 关闭高级省电, 之后至少 450us 才能写
+    hal_delay_us(450);
+    imu_write_reg(BMI_REG_INIT_CTRL, 0x00);
+    bmi_cfg.busy = true;
+    
+#if defined(USE_BMI270_DMA_UPLOAD) && USE_BMI270_DMA_UPLOAD
+    // DMA 写固定使用主 IMU 片选
+    if (IMU_CUR_IF == IMU_IF_SPI && IMU_IS_PRIMARY) {
+        memcpy(bmi_cfg_buf[0], &bmi270_config_file[0], bmi_cfg_chunk(0));
+        if (bmi_cfg_chunk(0) < sizeof(bmi270_config_file)) {
+            uint16_t next = bmi_cfg_chunk(0);
+            memcpy(bmi_cfg_buf[1], &bmi270_config_file[next], bmi_cfg_chunk(next));
+            bmi_cfg.prefilled = true;
+        }
+        bmi_cfg_dma_next();
+        return bmi_cfg.failed ? -1 : 0;
+    }
+#endif
+    
+    bmi_cfg_upload_pio();
+    return 0;
+}
+
+static int init_bmi270_finish(void)
 {
-    // 初始化需要加载配置文件，这里简化
-    imu_write_reg(0x7C, 0x00);  // PWR_CONF
-    hal_delay_ms(1);
-    imu_write_reg(0x59, 0x00);  // INIT_CTRL
-    hal_delay_ms(1);
+    if (!bmi_cfg.skipped) {
+        uint32_t t0 = hal_micros();
+        while (bmi_cfg.busy) {
+            if (hal_micros() - t0 > BMI_UPLOAD_TIMEOUT_US) {
+                return -2;
+            }
+        }
+        if (bmi_cfg.failed) {
+            return -2;
+        }
+        
+        // 上传完成后的 20ms 多半已被 RF/存储初始化占满
+        uint32_t since = hal_micros() - bmi_cfg.done_us;
+        if (since < BMI_INIT_WAIT_US) {
+            hal_delay_us(BMI_INIT_WAIT_US - since);
+        }
+        if ((bmi_read_status() & BMI_STATUS_MSG_MASK) != BMI_STATUS_INIT_OK) {
+            return -2;
+        }
+    }
     
     // 配置 Accel: ODR=200Hz, FS=4g
     imu_write_reg(0x40, 0xA8);  // ACC_CONF
@@ -400,11 +838,28 @@ static int init_bmi270(void)
     return 0;
 }
 
+static int init_bmi270(void)
+{
+    int ret = init_bmi270_start();
+    return (ret == 0) ? init_bmi270_finish() : ret;
+}
+
+// v0.6.3: LSM6DSV 片上融合 (SFLP) 输出, 已换到板级安装坐标系
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+static bool sflp_on = false;
+static bool sflp_fresh = false;
+static float sflp_q[4] = {1, 0, 0, 0};
+static float sflp_mount_q[4];           // 换轴矩阵 M 的共轭四元数: q_板 = q_芯片 ⊗ q(M)*
+#endif
+
 static int init_lsm6dsv(void)
 {
     // 软复位
     imu_write_reg(0x12, 0x01);  // CTRL3_C
     hal_delay_ms(10);
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    if (IMU_IS_PRIMARY) sflp_on = false;    // 嵌入式功能随复位关闭, 由 imu_fifo_enable 重新打开
+#endif
     
     // CTRL3_C: BDU=1, IF_INC=1
     imu_write_reg(0x12, 0x44);
@@ -422,137 +877,425 @@ static int init_lsm6dsv(void)
 }
 
 /*============================================================================
- * 公共 API / Public API
+ * v0.6.3: 融合预处理 / Fused preprocessing
  *============================================================================*/
 
-int imu_init(void)
+// 量程、驱动偏置 (imu_set_gyro_bias, dps) 和上层偏置/温度补偿合并为每轴一个增益
+// 和一个偏移, 配置变化时重算, 每样本只做一次 raw × gain - off (轴映射已在解码时完成)
+static void preproc_rebuild(void)
 {
-    memset(&imu_ctx, 0, sizeof(imu_ctx));
+    const float deg2rad = 0.01745329252f;
     
-    // 优先尝试 SPI
-    if (detect_imu_spi()) {
-        // SPI 检测成功
+    for (int i = 0; i < 3; i++) {
+        imu_ctx.pp_gyro_gain[i] = imu_ctx.gyro_scale * deg2rad;
+        imu_ctx.pp_accel_gain[i] = imu_ctx.accel_scale;
+        imu_ctx.pp_gyro_off[i] = imu_ctx.gyro_bias[i] * deg2rad + imu_ctx.pp.gyro_offset[i];
+        imu_ctx.pp_accel_off[i] = imu_ctx.accel_bias[i] + imu_ctx.pp.accel_offset[i];
     }
-    // 备选 I2C
-    else if (detect_imu_i2c()) {
-        // I2C 检测成功
-    }
-    else {
-        return -1;  // 未检测到 IMU
+#if defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+    imu_capture_set_params(IMU_CUR_TYPE, imu_ctx.pp_gyro_gain, imu_ctx.pp_gyro_off,
+                           imu_ctx.pp_accel_gain, imu_ctx.pp_accel_off);
+#endif
+}
+
+static inline void sample_scale(const int16_t g[3], const int16_t a[3],
+                                float gyro[3], float accel[3])
+{
+    for (int i = 0; i < 3; i++) {
+        gyro[i] = g[i] * imu_ctx.pp_gyro_gain[i] - imu_ctx.pp_gyro_off[i];
+        accel[i] = a[i] * imu_ctx.pp_accel_gain[i] - imu_ctx.pp_accel_off[i];
     }
-    
-    // 根据检测到的 IMU 类型初始化
-    int ret = -1;
-    switch (imu_ctx.imu_type) {
+}
+
+static inline void sample_convert(const int16_t g[3], const int16_t a[3],
+                                  float gyro[3], float accel[3])
+{
+#if defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+    imu_capture_push(g, a);
+#endif
+    sample_scale(g, a, gyro, accel);
+}
+
+void imu_raw_to_si(const int16_t g[3], const int16_t a[3], float gyro[3], float accel[3])
+{
+    sample_scale(g, a, gyro, accel);
+}
+
+void imu_set_preproc(const imu_preproc_t *cfg)
+{
+    imu_ctx.pp = *cfg;
+    preproc_rebuild();
+}
+
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+#define GR_LEVEL_INIT           2       // init_* 写入的 2000dps, 满量程 500 << level dps
+
+// 初始化/重新初始化后回到 init_* 的量程
+static void gyro_range_reset(void)
+{
+    imu_ctx.gr_level = GR_LEVEL_INIT;
+    imu_ctx.gr_backlog = 0;
+    imu_ctx.gr_saturated = false;
+    imu_ctx.gr_seen = false;
+    imu_ctx.gr_quiet = false;
+    imu_ctx.gr_peak = 0;
+}
+#endif
+
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+static bool burst_layout(uint8_t *reg, uint8_t *len);
+
+// 型号手册上的 SPI 最高时钟
+static uint32_t spi_type_max_hz(void)
+{
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686:
-        case IMU_ICM42688:
-            ret = init_icm45686();
-            break;
-        case IMU_BMI270:
-            ret = init_bmi270();
-            break;
-        case IMU_LSM6DSV:
-        case IMU_LSM6DSR:
-            ret = init_lsm6dsv();
-            break;
+        case IMU_ICM42688: return 24000000UL;
+        default:           return 10000000UL;   // BMI270, LSM6DSV/DSR
     }
-    
-    if (ret == 0) {
-        imu_ctx.initialized = true;
+}
+
+// 当前档下连续读取, WHO_AM_I 和数据块 (pattern 非空时) 每次都须与参考值一致
+static bool spi_qualify_pass(uint8_t who_reg, uint8_t who_val,
+                             uint8_t reg, uint8_t len, const uint8_t *pattern)
+{
+    uint8_t buf[16];
+    for (uint8_t i = 0; i < SPI_QUALIFY_REPEAT; i++) {
+        if (spi_read_reg(who_reg) != who_val) return false;
+        if (pattern) {
+            spi_read_regs(reg, buf, len);
+            if (memcmp(buf, pattern, len) != 0) return false;
+        }
     }
-    
-    return ret;
+    return true;
 }
 
-int imu_read_all(float gyro[3], float accel[3])
+/**
+ * v0.6.3: 检测之后、配置传感器之前验证当前 IMU 的最高 SCK.
+ * 此时数据寄存器为复位值, 不随采样变化, 保守档下读出的数据块作参考图样;
+ * 两次参考读取不一致 (热复位后传感器仍在运行) 时只比较 WHO_AM_I.
+ * 从型号上限逐档降低, 第一个通过的档再退一档, 不低于保守档
+ */
+static void spi_qualify(void)
 {
-    if (!imu_ctx.initialized) return -1;
+    uint8_t dev = IMU_CUR_SPI_DEV;
+    uint8_t who_reg, who_val, reg, len;
+    uint8_t ref[16], chk[16];
     
-    uint8_t buf[12];
-    uint8_t gyro_reg, accel_reg;
+    hal_spi_profile_set(dev, SPI_IMU_DEFAULT_HZ);
+    hal_spi_select(dev);
+    if (!who_layout(&who_reg, &who_val) || !burst_layout(&reg, &len)) return;
     
-    // 根据 IMU 类型确定寄存器地址
-    switch (imu_ctx.imu_type) {
-        case IMU_ICM45686:
-        case IMU_ICM42688:
-            gyro_reg = 0x25;   // GYRO_DATA_X1
-            accel_reg = 0x1F;  // ACCEL_DATA_X1
-            break;
-        case IMU_BMI270:
-            gyro_reg = 0x12;   // DATA_8
-            accel_reg = 0x0C;  // DATA_0
+    spi_read_regs(reg, ref, len);
+    spi_read_regs(reg, chk, len);
+    const uint8_t *pattern = (memcmp(ref, chk, len) == 0) ? ref : NULL;
+    
+    uint32_t floor_hz = hal_spi_profile_hz(dev);
+    uint32_t pass_hz = 0;
+    for (uint32_t hz = spi_type_max_hz(); hz > floor_hz; hz = hal_spi_step_down(hz)) {
+        hal_spi_profile_set(dev, hz);
+        if (spi_qualify_pass(who_reg, who_val, reg, len, pattern)) {
+            pass_hz = hz;
+            break;
+        }
+    }
+    
+    uint32_t use_hz = pass_hz ? hal_spi_step_down(pass_hz) : 0;
+    hal_spi_profile_set(dev, (use_hz > floor_hz) ? use_hz : SPI_IMU_DEFAULT_HZ);
+}
+#endif
+
+/*============================================================================
+ * 公共 API / Public API
+ *============================================================================*/
+
+int imu_init_start(void)
+{
+    memset(&imu_ctx, 0, sizeof(imu_ctx));
+    if (IMU_IS_PRIMARY) motion_armed = 0;
+    
+#if defined(IMU_FIXED_TYPE)
+    if (!detect_imu_fixed()) {
+        return -1;  // 指定总线上没有预期的 IMU
+    }
+#else
+    bool found = false;
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    if (!IMU_IS_PRIMARY) {
+        if (!detect_imu_aux()) return -1;
+        found = true;
+    }
+#endif
+#if defined(USE_FAST_WAKE) && USE_FAST_WAKE
+    if (!found) found = detect_imu_hint();
+#endif
+    // 优先尝试 SPI, 备选 I2C
+    if (!found) found = detect_imu_spi();
+    if (!found) found = detect_imu_i2c(0);
+    if (!found) {
+        return -1;  // 未检测到 IMU
+    }
+#endif
+    
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+    if (IMU_CUR_IF == IMU_IF_SPI) spi_qualify();
+#endif
+    
+    // 根据检测到的 IMU 类型初始化
+    int ret = -1;
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+            ret = init_icm45686();
+            break;
+        case IMU_BMI270:
+            // v0.6.3: 配置上传在后台进行, imu_init_finish 中完成
+            ret = init_bmi270_start();
             break;
         case IMU_LSM6DSV:
         case IMU_LSM6DSR:
-            gyro_reg = 0x22;   // OUTX_L_G
-            accel_reg = 0x28;  // OUTX_L_A
+            ret = init_lsm6dsv();
             break;
-        default:
-            return -1;
     }
     
-    // 读取陀螺仪
-    imu_read_regs(gyro_reg, buf, 6);
-    int16_t gx = (int16_t)(buf[0] | (buf[1] << 8));
-    int16_t gy = (int16_t)(buf[2] | (buf[3] << 8));
-    int16_t gz = (int16_t)(buf[4] | (buf[5] << 8));
-    
-    // 读取加速度计
-    imu_read_regs(accel_reg, buf, 6);
-    int16_t ax = (int16_t)(buf[0] | (buf[1] << 8));
-    int16_t ay = (int16_t)(buf[2] | (buf[3] << 8));
-    int16_t az = (int16_t)(buf[4] | (buf[5] << 8));
+    imu_ctx.init_started = (ret == 0);
+    return ret;
+}
+
+int imu_init_finish(void)
+{
+    if (!imu_ctx.init_started) return -1;
+    if (imu_ctx.initialized) return 0;
     
-    // 转换为物理单位
-    float deg2rad = 0.01745329252f;
-    gyro[0] = (gx * imu_ctx.gyro_scale - imu_ctx.gyro_bias[0]) * deg2rad;
-    gyro[1] = (gy * imu_ctx.gyro_scale - imu_ctx.gyro_bias[1]) * deg2rad;
-    gyro[2] = (gz * imu_ctx.gyro_scale - imu_ctx.gyro_bias[2]) * deg2rad;
+    int ret = 0;
+    if (IMU_CUR_TYPE == IMU_BMI270) {
+        ret = init_bmi270_finish();
+    }
     
-    accel[0] = ax * imu_ctx.accel_scale - imu_ctx.accel_bias[0];
-    accel[1] = ay * imu_ctx.accel_scale - imu_ctx.accel_bias[1];
-    accel[2] = az * imu_ctx.accel_scale - imu_ctx.accel_bias[2];
+    if (ret == 0) {
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+        gyro_range_reset();
+#endif
+        preproc_rebuild();
+        imu_ctx.initialized = true;
+#if !defined(IMU_FIXED_TYPE) && defined(USE_FAST_WAKE) && USE_FAST_WAKE
+        if (IMU_IS_PRIMARY) imu_hint_save();
+#endif
+    }
     
-    return 0;
+    return ret;
 }
 
-int imu_read_raw(int16_t gyro[3], int16_t accel[3])
+int imu_init(void)
 {
-    if (!imu_ctx.initialized) return -1;
+    int ret = imu_init_start();
+    return (ret == 0) ? imu_init_finish() : ret;
+}
+
+/*============================================================================
+ * v0.6.3: 数据突发读取 + 芯片温度 / Data burst with die temperature
+ *============================================================================*/
+
+// ICM/LSM 的温度寄存器紧挨在数据寄存器之前, 起始地址前移 2 字节即可并入同一次突发;
+// BMI270 的温度寄存器与数据不相邻, 按 IMU_BMI_TEMP_DECIM 抽取单独读取
+#define ICM_REG_TEMP_DATA       0x1D    // TEMP_DATA1, 其后 ACCEL_DATA/GYRO_DATA
+#define LSM_REG_OUT_TEMP        0x20    // OUT_TEMP_L, 其后 OUTX_L_G/OUTX_L_A
+#define BMI_REG_DATA_8          0x0C    // ACC_X_LSB, 其后 GYR_X_LSB (0x12)
+#define BMI_REG_TEMPERATURE     0x22
+#define BMI_TEMP_INVALID        ((int16_t)0x8000)
+#define IMU_BMI_TEMP_DECIM      24      // 240Hz 数据 → 约 10Hz 温度
+#define IMU_BURST_SIZE          14
+
+static inline int16_t le16(const uint8_t *p)
+{
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+// 反向时 -32768 饱和到 32767
+static inline int16_t neg16(int16_t v)
+{
+    return (v == INT16_MIN) ? INT16_MAX : (int16_t)-v;
+}
+
+// v0.6.3: 安装方向在解码时按常量换轴, 条件在编译期折叠, 每轴一次 le16 (必要时取反)
+#define IMU_AXIS_LE16(p, a) \
+    ((a) < 0 ? neg16(le16((p) + 2 * (-(a) - 1))) : le16((p) + 2 * ((a) - 1)))
+
+static inline void decode_axes(const uint8_t *p, int16_t out[3])
+{
+    out[0] = IMU_AXIS_LE16(p, IMU_AXIS_X);
+    out[1] = IMU_AXIS_LE16(p, IMU_AXIS_Y);
+    out[2] = IMU_AXIS_LE16(p, IMU_AXIS_Z);
+}
+
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+// v0.6.3: 解码后的每个陀螺样本 (可在 DMA 完成中断中调用): 切换前产生的旧量程样本
+// 换到新量程计数, 使同一增益适用于切换前后的样本; 再统计饱和与峰值
+static inline void gyro_range_observe(int16_t g[3])
+{
+    uint16_t peak = imu_ctx.gr_peak;
     
-    uint8_t buf[12];
+    for (int i = 0; i < 3; i++) {
+        int32_t v = g[i];
+        if (imu_ctx.gr_backlog) {
+            v = (imu_ctx.gr_shift > 0) ? v * (1 << imu_ctx.gr_shift) : v >> -imu_ctx.gr_shift;
+            if (v > INT16_MAX) v = INT16_MAX;
+            if (v < -INT16_MAX) v = -INT16_MAX;
+            g[i] = (int16_t)v;
+        }
+        uint16_t m = (uint16_t)(v < 0 ? -v : v);
+        if (m > peak) peak = m;
+    }
+    if (imu_ctx.gr_backlog) imu_ctx.gr_backlog--;
+    if (peak >= GYRO_RANGE_SAT_RAW) imu_ctx.gr_saturated = true;
+    imu_ctx.gr_peak = peak;
+    imu_ctx.gr_seen = true;
+}
+#define GYRO_RANGE_OBSERVE(g)   gyro_range_observe(g)
+#else
+#define GYRO_RANGE_OBSERVE(g)   ((void)0)
+#endif
+
+static inline void temp_store(float temp_c)
+{
+    imu_ctx.temp_c = temp_c;
+    imu_ctx.temp_valid = true;
+}
+
+// 温度变化远慢于数据, 首次立即读, 之后每 IMU_BMI_TEMP_DECIM 次调用读一次
+static void bmi_temp_poll(void)
+{
+    if (imu_ctx.temp_valid && ++imu_ctx.temp_decim < IMU_BMI_TEMP_DECIM) return;
+    imu_ctx.temp_decim = 0;
     
-    // 读取原始数据 (根据 IMU 类型)
-    switch (imu_ctx.imu_type) {
+    uint8_t t[2];
+    if (imu_read_regs(BMI_REG_TEMPERATURE, t, 2) != 0) return;
+    int16_t raw = le16(t);
+    if (raw != BMI_TEMP_INVALID) {
+        temp_store(raw / 512.0f + 23.0f);   // 1/512 K/LSB, 0 = 23°C
+    }
+}
+
+// 突发起始寄存器和长度 (同步读取和 DMA 读取共用), 返回 false 表示型号不支持
+static bool burst_layout(uint8_t *reg, uint8_t *len)
+{
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+            *reg = ICM_REG_TEMP_DATA;       // TEMP + ACCEL + GYRO
+            *len = IMU_BURST_SIZE;
+            return true;
+        case IMU_BMI270:
+            *reg = BMI_REG_DATA_8;          // ACCEL + GYRO
+            *len = 12;
+            return true;
+        case IMU_LSM6DSV:
+        case IMU_LSM6DSR:
+            *reg = LSM_REG_OUT_TEMP;        // TEMP + GYRO + ACCEL
+            *len = IMU_BURST_SIZE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 解码一次突发, ICM/LSM 同时更新芯片温度 (可在 DMA 完成中断中调用)
+static void decode_burst(const uint8_t *buf, int16_t gyro[3], int16_t accel[3])
+{
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686:
         case IMU_ICM42688:
-            imu_read_regs(0x1F, buf, 12);  // ACCEL + GYRO
-            accel[0] = (int16_t)(buf[0] | (buf[1] << 8));
-            accel[1] = (int16_t)(buf[2] | (buf[3] << 8));
-            accel[2] = (int16_t)(buf[4] | (buf[5] << 8));
-            gyro[0] = (int16_t)(buf[6] | (buf[7] << 8));
-            gyro[1] = (int16_t)(buf[8] | (buf[9] << 8));
-            gyro[2] = (int16_t)(buf[10] | (buf[11] << 8));
+            temp_store(le16(&buf[0]) / (IMU_CUR_TYPE == IMU_ICM45686 ? 128.0f : 132.48f) + 25.0f);
+            decode_axes(&buf[2], accel);
+            decode_axes(&buf[8], gyro);
+            break;
+            
+        case IMU_BMI270:
+            decode_axes(&buf[0], accel);
+            decode_axes(&buf[6], gyro);
             break;
             
         case IMU_LSM6DSV:
         case IMU_LSM6DSR:
-            imu_read_regs(0x22, buf, 12);  // GYRO + ACCEL
-            gyro[0] = (int16_t)(buf[0] | (buf[1] << 8));
-            gyro[1] = (int16_t)(buf[2] | (buf[3] << 8));
-            gyro[2] = (int16_t)(buf[4] | (buf[5] << 8));
-            accel[0] = (int16_t)(buf[6] | (buf[7] << 8));
-            accel[1] = (int16_t)(buf[8] | (buf[9] << 8));
-            accel[2] = (int16_t)(buf[10] | (buf[11] << 8));
+            temp_store(le16(&buf[0]) / 256.0f + 25.0f);
+            decode_axes(&buf[2], gyro);
+            decode_axes(&buf[8], accel);
             break;
-            
-        default:
-            return -1;
     }
+    GYRO_RANGE_OBSERVE(gyro);
+}
+
+// 一次突发读出陀螺/加速度原始值, 同时更新芯片温度
+static int read_burst(int16_t gyro[3], int16_t accel[3])
+{
+    uint8_t buf[IMU_BURST_SIZE];
+    uint8_t reg, len;
+    
+    if (!burst_layout(&reg, &len)) return -1;
+    
+    if (imu_read_regs(reg, buf, len) != 0) return -1;
+    decode_burst(buf, gyro, accel);
+    if (IMU_CUR_TYPE == IMU_BMI270) {
+        bmi_temp_poll();
+    }
+    return 0;
+}
+
+int imu_read_all(float gyro[3], float accel[3])
+{
+    if (!imu_ctx.initialized) return -1;
     
+    int16_t g[3], a[3];
+    if (read_burst(g, a) != 0) return -1;
+    
+    // 转换为物理单位 (含偏置/温度补偿/轴映射)
+    sample_convert(g, a, gyro, accel);
     return 0;
 }
 
+int imu_read_raw(int16_t gyro[3], int16_t accel[3])
+{
+    if (!imu_ctx.initialized) return -1;
+    
+    return read_burst(gyro, accel);
+}
+
+/*============================================================================
+ * v0.6.3: 异步突发读取 (SPI DMA) / Async burst read
+ *============================================================================*/
+
+int imu_dma_burst_get(imu_dma_burst_t *burst)
+{
+    uint8_t reg, len;
+    
+    if (!burst || !imu_ctx.initialized || IMU_CUR_IF != IMU_IF_SPI) return -1;
+    if (!burst_layout(&reg, &len)) return -1;
+    
+    burst->cmd = reg | 0x80;
+    burst->len = len;
+    burst->decode = imu_decode_dma;
+    return 0;
+}
+
+int imu_decode_dma(const uint8_t *data, uint16_t len, float gyro[3], float accel[3])
+{
+    uint8_t reg, expect;
+    
+    if (!burst_layout(&reg, &expect) || len != expect) return -1;
+    
+    int16_t g[3], a[3];
+    decode_burst(data, g, a);
+    sample_convert(g, a, gyro, accel);
+    return 0;
+}
+
+bool imu_get_temperature(float *temp_c)
+{
+    if (!imu_ctx.temp_valid) return false;
+    *temp_c = imu_ctx.temp_c;
+    return true;
+}
+
 bool imu_data_ready(void)
 {
 #ifdef CH59X
@@ -570,7 +1313,7 @@ uint8_t imu_get_type(void)
 
 const char* imu_get_type_name(void)
 {
-    switch (imu_ctx.imu_type) {
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686: return "ICM-45686";
         case IMU_ICM42688: return "ICM-42688";
         case IMU_BMI270:   return "BMI270";
@@ -590,13 +1333,14 @@ void imu_set_gyro_bias(const float bias[3])
     imu_ctx.gyro_bias[0] = bias[0];
     imu_ctx.gyro_bias[1] = bias[1];
     imu_ctx.gyro_bias[2] = bias[2];
+    preproc_rebuild();
 }
 
 void imu_suspend(void)
 {
     if (!imu_ctx.initialized) return;
     
-    switch (imu_ctx.imu_type) {
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686:
         case IMU_ICM42688:
             imu_write_reg(0x4E, 0x00);  // PWR_MGMT0: sleep
@@ -616,8 +1360,10 @@ void imu_resume(void)
 {
     if (!imu_ctx.initialized) return;
     
-    // 重新初始化
-    switch (imu_ctx.imu_type) {
+    // 重新初始化 (ODR 回到全速, 软复位同时关闭运动引擎)
+    imu_ctx.profile = IMU_PROFILE_HIGH;
+    motion_armed = 0;
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686:
         case IMU_ICM42688:
             init_icm45686();
@@ -630,6 +1376,11 @@ void imu_resume(void)
             init_lsm6dsv();
             break;
     }
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+    // init_* 已回到 2000dps, 增益随之恢复
+    gyro_range_reset();
+    preproc_rebuild();
+#endif
 }
 
 /*============================================================================
@@ -640,7 +1391,7 @@ int imu_enable_wom(uint16_t threshold_mg)
 {
     if (!imu_ctx.initialized) return -1;
     
-    switch (imu_ctx.imu_type) {
+    switch (IMU_CUR_TYPE) {
         case IMU_ICM45686:
         case IMU_ICM42688:
             // ICM-45686/42688 WOM配置
@@ -712,3 +1463,1141 @@ int imu_disable_wom(void)
     
     return 0;
 }
+
+/*============================================================================
+ * v0.6.3: FIFO 水位批量读取 / FIFO watermark batch read
+ *
+ * 水位中断到来后一次突发读取 N 帧, 减少每样本的 SPI 事务和 MCU 唤醒次数
+ *============================================================================*/
+
+// ICM-42688/45686 (FIFO 包格式 3: 16 字节, 位定义相同)
+// 两者的寄存器地址不同: 42688 用 bank0 地址, 45686 用 icm45686.h 的地址, 按当前型号选择
+#define ICM_SEL(r42688, r45686) (IMU_CUR_TYPE == IMU_ICM45686 ? (r45686) : (r42688))
+#define ICM_REG_INTF_CONFIG0    ICM_SEL(0x4C, ICM45686_REG_INTF_CONFIG0)
+#define ICM_REG_FIFO_CONFIG1    ICM_SEL(0x5F, ICM45686_REG_FIFO_CONFIG1)
+#define ICM_REG_FIFO_CONFIG2    ICM_SEL(0x60, ICM45686_REG_FIFO_CONFIG2)
+#define ICM_REG_FIFO_CONFIG3    ICM_SEL(0x61, ICM45686_REG_FIFO_CONFIG3)
+#define ICM_REG_INT_SOURCE0     ICM_SEL(0x65, ICM45686_REG_INT_SOURCE0)
+#define ICM_REG_FIFO_COUNTH     ICM_SEL(0x2E, ICM45686_REG_FIFO_COUNTH)
+#define ICM_REG_FIFO_DATA       ICM_SEL(0x30, ICM45686_REG_FIFO_DATA)
+#define ICM_REG_GYRO_CONFIG0    ICM_SEL(0x4F, ICM45686_REG_GYRO_CONFIG0)    // bit[3:0] GYRO_ODR
+#define ICM_REG_ACCEL_CONFIG0   ICM_SEL(0x50, ICM45686_REG_ACCEL_CONFIG0)   // bit[3:0] ACCEL_ODR
+#define ICM_REG_FIFO_FLUSH      ICM_SEL(0x4B, ICM45686_REG_SIGNAL_PATH_RESET)
+#define ICM_FIFO_FLUSH_BIT      ICM_SEL(0x02, ICM45686_FIFO_FLUSH)
+// 只有 42688: 45686 没有单独的 FIFO 模式/时间戳配置寄存器, TMST 由 FIFO_CONFIG1 bit3 打开
+#define ICM42688_REG_FIFO_CONFIG    0x16
+#define ICM42688_REG_TMST_CONFIG    0x54
+#define ICM_FIFO_FRAME_SIZE     16
+#define ICM_FIFO_HEADER_EMPTY   0x80
+#define ICM_FIFO_ACCEL_INVALID  ((int16_t)0x8000)   // 加速度计 ODR 较低时只含陀螺的包
+#define ICM_TS_TICK_NS          1000    // TMST_RES=0: 1us/LSB (IMU 内部时钟)
+
+// BMI270 (无帧头模式: GYR 6 + ACC 6; 分开 ODR 时用带帧头模式)
+#define BMI_REG_ACC_CONF        0x40
+#define BMI_REG_GYR_CONF        0x42
+#define BMI_REG_FIFO_LENGTH_0   0x24
+#define BMI_REG_FIFO_DATA       0x26
+#define BMI_REG_FIFO_WTM_0      0x46
+#define BMI_REG_FIFO_CONFIG_1   0x49
+#define BMI_REG_INT1_IO_CTRL    0x53
+#define BMI_REG_INT_MAP_DATA    0x58
+#define BMI_FIFO_FRAME_SIZE     12
+#define BMI_FH_GYR_ACC          0x8C    // 常规帧: 帧头 + GYR 6 + ACC 6
+#define BMI_FH_GYR              0x88    // 帧头 + GYR 6
+#define BMI_FH_ACC              0x84    // 帧头 + ACC 6
+#define BMI_FH_SKIP             0x40    // 控制帧: 溢出丢弃的帧数 (1 字节)
+#define BMI_FH_SENSORTIME       0x44    // 读空时附加的传感器时间 (3 字节)
+#define BMI_FH_CONFIG           0x48    // 配置变化 (4 字节)
+#define BMI_FH_MASK             0xFC    // 低 2 位为外部中断标记
+
+// LSM6DSV/DSR (带标签的 7 字节字, 陀螺/加速度分别成字)
+#define LSM_REG_CTRL1           0x10
+#define LSM_REG_CTRL2           0x11
+#define LSM_REG_FIFO_CTRL1      0x07
+#define LSM_REG_FIFO_CTRL3      0x09
+#define LSM_REG_FIFO_CTRL4      0x0A
+#define LSM_REG_INT1_CTRL       0x0D
+#define LSM_REG_FIFO_STATUS1    0x1B
+#define LSM_REG_FIFO_DATA_TAG   0x78
+#define LSM_FIFO_WORD_SIZE      7
+#define LSM_TAG_GYRO            0x01
+#define LSM_TAG_ACCEL           0x02
+#define LSM_TAG_TEMPERATURE     0x03
+#define LSM_TAG_TIMESTAMP       0x04
+#define LSM_TAG_SFLP_GAME       0x13        // SFLP 游戏旋转向量 (x/y/z 半精度浮点)
+#define LSM6DSV_REG_FUNCTIONS_ENABLE 0x50   // bit6 TIMESTAMP_EN
+// v0.6.3: SFLP 配置在嵌入式功能寄存器页
+#define LSM6DSV_REG_FUNC_CFG_ACCESS  0x01   // bit7 EMB_FUNC_REG_ACCESS
+#define LSM6DSV_EMB_FUNC_EN_A        0x04   // bit1 SFLP_GAME_EN
+#define LSM6DSV_EMB_FUNC_FIFO_EN_A   0x44   // bit1 SFLP_GAME_FIFO_EN
+#define LSM6DSV_EMB_SFLP_ODR         0x5E   // bit[5:3] SFLP_GAME_ODR, 其余位保持复位值 0x43
+#define LSM6DSV_EMB_FUNC_INIT_A      0x66   // bit1 SFLP_GAME_INIT
+#define LSM6DSV_SFLP_GAME_BIT        0x02
+#define LSM6DSR_REG_CTRL10_C    0x19        // bit5 TIMESTAMP_EN
+#define LSM6DSV_TS_TICK_NS      21750       // 典型值, 实际由上层标定
+#define LSM6DSR_TS_TICK_NS      25000
+
+// v0.6.3: 每个 IMU 一份 FIFO 状态 (不随 imu_init 清零)
+static struct {
+    uint8_t watermark;
+    
+    // LSM 读取上限可能截在陀螺字和加速度字之间 (温度字占位), 未配对的陀螺字留到下次
+    int16_t lsm_pend_g[3];
+    bool lsm_pend_valid;
+    
+    // FIFO 时间戳 (IMU 时钟域, 扩展为 32 位单调计数)
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    uint32_t ts_tick_ns;                // 0 = 当前 IMU 不输出时间戳
+    uint32_t icm_ts_ext;
+    uint16_t icm_ts_last;
+    bool icm_ts_started;
+    uint32_t lsm_pend_ts;               // 未配对陀螺字所属批次的时间戳
+#endif
+    
+    // v0.6.3: 加速度计低于陀螺 ODR 时, 不带加速度的帧沿用最近一次的值
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+    uint8_t acc_shift;                  // 加速度计比陀螺低的 ODR 档数 (0 = 同 ODR)
+    bool acc_held;
+    int16_t acc_hold[3];                // 已换轴的原始计数
+    uint8_t acc_mask;                   // 最近一次读取: bit i = 第 i 帧带新加速度
+#endif
+} fifo_state[IMU_SENSOR_COUNT];
+#define fifo_st                 fifo_state[IMU_CUR_SENSOR]
+
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+#define FIFO_ACC_SHIFT          (fifo_st.acc_shift)
+#else
+#define FIFO_ACC_SHIFT          0
+#endif
+// frames 帧陀螺对应的加速度样本数 (向上取整)
+#define FIFO_ACC_FRAMES(frames) ((uint16_t)(((frames) + (1u << FIFO_ACC_SHIFT) - 1) >> FIFO_ACC_SHIFT))
+
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+// N 帧 (240Hz) 期间的 SFLP 字数 (向上取整)
+#define SFLP_WORDS(frames)      ((uint8_t)(((uint16_t)(frames) * SFLP_ODR_HZ + 239) / 240))
+
+static uint8_t sflp_odr_code(void)
+{
+    // 000 = 15Hz, 每级翻倍, 101 = 480Hz
+    uint8_t code = 0;
+    for (uint16_t hz = 15; hz < SFLP_ODR_HZ && code < 5; hz <<= 1) {
+        code++;
+    }
+    return code;
+}
+
+// 换轴矩阵 (有符号置换, 右手系) → 单位四元数的共轭
+static void sflp_build_mount(void)
+{
+    static const int8_t map[3] = { IMU_AXIS_X, IMU_AXIS_Y, IMU_AXIS_Z };
+    float m[3][3] = { { 0 } };
+    for (int i = 0; i < 3; i++) {
+        int8_t a = map[i];
+        m[i][IMU_AXIS_ABS(a) - 1] = (a < 0) ? -1.0f : 1.0f;
+    }
+    
+    float q[4];
+    float tr = m[0][0] + m[1][1] + m[2][2];
+    if (tr > 0.0f) {
+        float s = fm_sqrt(tr + 1.0f) * 2.0f;
+        q[0] = 0.25f * s;
+        q[1] = (m[2][1] - m[1][2]) / s;
+        q[2] = (m[0][2] - m[2][0]) / s;
+        q[3] = (m[1][0] - m[0][1]) / s;
+    } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+        float s = fm_sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+        q[0] = (m[2][1] - m[1][2]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (m[0][1] + m[1][0]) / s;
+        q[3] = (m[0][2] + m[2][0]) / s;
+    } else if (m[1][1] > m[2][2]) {
+        float s = fm_sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+        q[0] = (m[0][2] - m[2][0]) / s;
+        q[1] = (m[0][1] + m[1][0]) / s;
+        q[2] = 0.25f * s;
+        q[3] = (m[1][2] + m[2][1]) / s;
+    } else {
+        float s = fm_sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+        q[0] = (m[1][0] - m[0][1]) / s;
+        q[1] = (m[0][2] + m[2][0]) / s;
+        q[2] = (m[1][2] + m[2][1]) / s;
+        q[3] = 0.25f * s;
+    }
+    sflp_mount_q[0] = q[0];
+    sflp_mount_q[1] = -q[1];
+    sflp_mount_q[2] = -q[2];
+    sflp_mount_q[3] = -q[3];
+}
+
+static void sflp_enable(void)
+{
+    imu_write_reg(LSM6DSV_REG_FUNC_CFG_ACCESS, 0x80);
+    imu_write_reg(LSM6DSV_EMB_SFLP_ODR, (uint8_t)(0x43 | (sflp_odr_code() << 3)));
+    imu_write_reg(LSM6DSV_EMB_FUNC_FIFO_EN_A, LSM6DSV_SFLP_GAME_BIT);
+    imu_write_reg(LSM6DSV_EMB_FUNC_EN_A, LSM6DSV_SFLP_GAME_BIT);
+    imu_write_reg(LSM6DSV_EMB_FUNC_INIT_A, LSM6DSV_SFLP_GAME_BIT);   // 重新初始化算法
+    imu_write_reg(LSM6DSV_REG_FUNC_CFG_ACCESS, 0x00);
+    
+    sflp_build_mount();
+    sflp_on = true;
+    sflp_fresh = false;
+}
+
+static float half_to_float(uint16_t h)
+{
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t man = h & 0x3FF;
+    if (exp == 0) {
+        // 非规格化数 man × 2^-24 (SFLP 不输出 Inf/NaN)
+        float f = (float)man * (1.0f / 16777216.0f);
+        return (h & 0x8000) ? -f : f;
+    }
+    union { uint32_t u; float f; } v;
+    v.u = ((uint32_t)(h & 0x8000) << 16) | ((exp + 112) << 23) | (man << 13);
+    return v.f;
+}
+
+static void sflp_store(const uint8_t *p)
+{
+    float x = half_to_float(le16(&p[0]));
+    float y = half_to_float(le16(&p[2]));
+    float z = half_to_float(le16(&p[4]));
+    float w = fm_sqrt(1.0f - (x * x + y * y + z * z));   // 游戏旋转向量不输出 w, 取 w >= 0
+    const float *m = sflp_mount_q;
+    
+    // 机体坐标系换到板级安装方向: q ⊗ q(M)*
+    sflp_q[0] = w * m[0] - x * m[1] - y * m[2] - z * m[3];
+    sflp_q[1] = w * m[1] + x * m[0] + y * m[3] - z * m[2];
+    sflp_q[2] = w * m[2] - x * m[3] + y * m[0] + z * m[1];
+    sflp_q[3] = w * m[3] + x * m[2] - y * m[1] + z * m[0];
+    sflp_fresh = true;
+}
+#endif
+
+static int fifo_enable(uint8_t watermark, uint8_t acc_shift)
+{
+    if (!imu_ctx.initialized) return -1;
+    if (watermark == 0) watermark = 1;
+    if (watermark > IMU_FIFO_MAX_BATCH) watermark = IMU_FIFO_MAX_BATCH;
+    
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    // SFLP 要求加速度计 ODR 不低于 SFLP 输出率
+    if (IMU_CUR_TYPE == IMU_LSM6DSV && IMU_IS_PRIMARY) acc_shift = 0;
+#endif
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+    fifo_st.acc_shift = acc_shift;
+    fifo_st.acc_held = false;
+#else
+    (void)acc_shift;
+#endif
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            // 水位以字节计 (包长固定, 只含陀螺的包加速度字段填无效值)
+            uint16_t wm_bytes = (uint16_t)watermark * ICM_FIFO_FRAME_SIZE;
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+            if (acc_shift) {
+                // ODR 码每 +1 减半
+                uint8_t gyr = imu_read_reg(ICM_REG_GYRO_CONFIG0) & 0x0F;
+                uint8_t acc = imu_read_reg(ICM_REG_ACCEL_CONFIG0);
+                imu_write_reg(ICM_REG_ACCEL_CONFIG0, (uint8_t)((acc & 0xF0) | (gyr + acc_shift)));
+            }
+#endif
+            if (IMU_CUR_TYPE == IMU_ICM45686) {
+                imu_write_reg(ICM_REG_FIFO_FLUSH, ICM_FIFO_FLUSH_BIT);
+            }
+            imu_write_reg(ICM_REG_INTF_CONFIG0, 0x00);      // FIFO计数/数据小端
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+            // v0.6.3: 包格式3 字节14-15 写入 ODR 时间戳 (1us, 绝对值, 16位回绕)
+            if (IMU_CUR_TYPE == IMU_ICM42688) {
+                imu_write_reg(ICM42688_REG_TMST_CONFIG, 0x21);  // TMST_EN, 非增量, 无 FSYNC
+            }
+            imu_write_reg(ICM_REG_FIFO_CONFIG1, 0x0F);      // + TMST_FSYNC_EN (45686: TMST)
+            fifo_st.ts_tick_ns = ICM_TS_TICK_NS;
+            fifo_st.icm_ts_started = false;
+#else
+            imu_write_reg(ICM_REG_FIFO_CONFIG1, 0x07);      // ACCEL+GYRO+TEMP → 包格式3
+#endif
+            imu_write_reg(ICM_REG_FIFO_CONFIG2, wm_bytes & 0xFF);
+            imu_write_reg(ICM_REG_FIFO_CONFIG3, (wm_bytes >> 8) & 0x0F);
+            if (IMU_CUR_TYPE == IMU_ICM42688) {
+                imu_write_reg(ICM42688_REG_FIFO_CONFIG, 0x40);  // Stream-to-FIFO (45686 默认流模式)
+            }
+            imu_write_reg(ICM_REG_INT_SOURCE0, 0x04);       // FIFO_THS → INT1 (替代DRDY)
+            break;
+        }
+        case IMU_BMI270:
+        {
+            uint16_t wm_bytes = (uint16_t)watermark * BMI_FIFO_FRAME_SIZE;
+            uint8_t fifo_cfg = 0xC0;                        // GYR+ACC, 无帧头
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+            if (acc_shift) {
+                // 无帧头模式要求同 ODR; 带帧头时只含陀螺的帧 7 字节, 带加速度的 13 字节
+                uint8_t gyr = imu_read_reg(BMI_REG_GYR_CONF) & 0x0F;
+                uint8_t acc = imu_read_reg(BMI_REG_ACC_CONF);
+                imu_write_reg(BMI_REG_ACC_CONF, (uint8_t)((acc & 0xF0) | (gyr - acc_shift)));
+                wm_bytes = (uint16_t)(watermark * 7 + (watermark >> acc_shift) * 6);
+                fifo_cfg = 0xD0;                            // + fifo_header_en
+            }
+#endif
+            imu_write_reg(BMI_REG_FIFO_WTM_0, wm_bytes & 0xFF);
+            imu_write_reg(BMI_REG_FIFO_WTM_0 + 1, (wm_bytes >> 8) & 0x1F);
+            imu_write_reg(BMI_REG_FIFO_CONFIG_1, fifo_cfg);
+            imu_write_reg(BMI_REG_INT1_IO_CTRL, 0x0A);      // INT1 高电平, 推挽
+            imu_write_reg(BMI_REG_INT_MAP_DATA, 0x02);      // FWM → INT1
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+            fifo_st.ts_tick_ns = 0;    // 无帧头模式不带传感器时间
+#endif
+            break;
+        }
+        case IMU_LSM6DSV:
+        case IMU_LSM6DSR:
+        {
+            // 每帧 = 陀螺字 + 加速度字 (加速度批量率较低时按比例), 水位以字计
+            uint8_t wm_words = (uint8_t)(watermark + FIFO_ACC_FRAMES(watermark));
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+            if (acc_shift) {
+                // ODR/BDR 码 (高 4 位) 每 -1 减半
+                uint8_t gyr = imu_read_reg(LSM_REG_CTRL2) >> 4;
+                uint8_t acc = (uint8_t)(gyr - acc_shift);
+                imu_write_reg(LSM_REG_CTRL1, (uint8_t)((acc << 4) | (imu_read_reg(LSM_REG_CTRL1) & 0x0F)));
+                imu_write_reg(LSM_REG_FIFO_CTRL3, (uint8_t)((gyr << 4) | acc));
+            } else
+#endif
+            imu_write_reg(LSM_REG_FIFO_CTRL3, 0x77);        // BDR_GY=BDR_XL=240Hz
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+            // v0.6.3: 每个批次写入一个时间戳字 (DEC_TS_BATCH=1)
+            if (IMU_CUR_TYPE == IMU_LSM6DSV) {
+                imu_write_reg(LSM6DSV_REG_FUNCTIONS_ENABLE, 0x40);
+                fifo_st.ts_tick_ns = LSM6DSV_TS_TICK_NS;
+            } else {
+                imu_write_reg(LSM6DSR_REG_CTRL10_C, 0x20);
+                fifo_st.ts_tick_ns = LSM6DSR_TS_TICK_NS;
+            }
+            imu_write_reg(LSM_REG_FIFO_CTRL4, 0x66);        // 连续模式 + 时间戳 + 温度 (ODR_T_BATCH=10)
+            // 时间戳字占 FIFO, 每帧 (陀螺批次) 多一字
+            wm_words = (uint8_t)(wm_words + watermark);
+#else
+            imu_write_reg(LSM_REG_FIFO_CTRL4, 0x26);        // 连续模式 + 温度 (ODR_T_BATCH=10, 12.5/15Hz)
+#endif
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+            // v0.6.3: 游戏旋转向量字按 SFLP 自身 ODR 插入
+            if (IMU_CUR_TYPE == IMU_LSM6DSV && IMU_IS_PRIMARY) {
+                sflp_enable();
+                wm_words += SFLP_WORDS(watermark);
+            }
+#endif
+            imu_write_reg(LSM_REG_FIFO_CTRL1, wm_words);
+            imu_write_reg(LSM_REG_INT1_CTRL, 0x08);         // FIFO_TH → INT1
+            fifo_st.lsm_pend_valid = false;
+            break;
+        }
+            
+        default:
+            return -2;
+    }
+    
+    fifo_st.watermark = watermark;
+    return 0;
+}
+
+int imu_fifo_enable(uint8_t watermark)
+{
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+    return fifo_enable(watermark, IMU_ACCEL_ODR_SHIFT);
+#else
+    return fifo_enable(watermark, 0);
+#endif
+}
+
+// v0.6.3: 原始计数在读取时即送入采集环, 换算由调用方在用到时做
+static inline void sample_raw_store(const int16_t g[3], int16_t gyro[3], int16_t accel[3])
+{
+    gyro[0] = g[0];
+    gyro[1] = g[1];
+    gyro[2] = g[2];
+    GYRO_RANGE_OBSERVE(gyro);
+#if defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+    imu_capture_push(gyro, accel);
+#endif
+}
+
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+// 带新加速度的帧更新保持值并记入掩码, 其余帧沿用保持值; 第一次新加速度之前的帧丢弃 (返回 false)
+static bool acc_resolve(int16_t accel[3], bool fresh, uint8_t n)
+{
+    if (fresh) {
+        memcpy(fifo_st.acc_hold, accel, sizeof(fifo_st.acc_hold));
+        fifo_st.acc_held = true;
+        fifo_st.acc_mask |= (uint8_t)(1u << n);
+        return true;
+    }
+    if (!fifo_st.acc_held) return false;
+    memcpy(accel, fifo_st.acc_hold, sizeof(fifo_st.acc_hold));
+    return true;
+}
+
+// BMI270 带帧头 FIFO: 常规帧按 GYR/ACC 顺序, 截断在缓冲区末尾的不完整帧不解码 (下次从帧头开始)
+static uint8_t bmi_fifo_parse(const uint8_t *buf, uint16_t bytes,
+                              int16_t gyro[][3], int16_t accel[][3], uint8_t max_frames)
+{
+    uint8_t n = 0;
+    uint16_t pos = 0;
+    bool acc_only = false;      // 单独的加速度帧已更新保持值, 记到下一帧
+    int16_t g[3];
+    
+    while (pos < bytes && n < max_frames) {
+        const uint8_t *f = &buf[pos];
+        uint8_t h = f[0] & BMI_FH_MASK;
+        uint8_t len;
+        switch (h) {
+            case BMI_FH_GYR_ACC:    len = 13; break;
+            case BMI_FH_GYR:
+            case BMI_FH_ACC:        len = 7; break;
+            case BMI_FH_SKIP:       len = 2; break;
+            case BMI_FH_SENSORTIME: len = 4; break;
+            case BMI_FH_CONFIG:     len = 5; break;
+            default:                return n;       // 0x80 = 已读空
+        }
+        if (pos + len > bytes) break;
+        pos += len;
+        
+        if (h == BMI_FH_ACC) {
+            decode_axes(&f[1], fifo_st.acc_hold);
+            fifo_st.acc_held = true;
+            acc_only = true;
+        } else if (h == BMI_FH_GYR_ACC || h == BMI_FH_GYR) {
+            decode_axes(&f[1], g);
+            bool fresh = (h == BMI_FH_GYR_ACC);
+            if (fresh) {
+                decode_axes(&f[7], accel[n]);
+            } else if (acc_only) {
+                memcpy(accel[n], fifo_st.acc_hold, sizeof(fifo_st.acc_hold));
+                fresh = true;
+            }
+            acc_only = false;
+            if (!acc_resolve(accel[n], fresh, n)) continue;
+            sample_raw_store(g, gyro[n], accel[n]);
+            n++;
+        }
+    }
+    return n;
+}
+#endif
+
+int imu_fifo_read_raw(int16_t gyro[][3], int16_t accel[][3], uint32_t ts[], uint8_t max_frames)
+{
+    if (!imu_ctx.initialized || fifo_st.watermark == 0) return -1;
+    if (max_frames > IMU_FIFO_MAX_BATCH) max_frames = IMU_FIFO_MAX_BATCH;
+    
+    // 按最大批次分配, 一次突发读取
+    static uint8_t buf[IMU_FIFO_MAX_BATCH * ICM_FIFO_FRAME_SIZE];
+    uint8_t n = 0;
+    int16_t g[3];
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+    fifo_st.acc_mask = 0;
+#endif
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            uint8_t cnt[2];
+            imu_read_regs(ICM_REG_FIFO_COUNTH, cnt, 2);
+            uint16_t frames = (uint16_t)(cnt[0] | (cnt[1] << 8)) / ICM_FIFO_FRAME_SIZE;
+            if (frames > max_frames) frames = max_frames;
+            if (frames == 0) return 0;
+            
+            // 读失败时帧留在 FIFO, 下次再读 (计数读失败清零即为 0 帧)
+            if (imu_read_regs(ICM_REG_FIFO_DATA, buf, frames * ICM_FIFO_FRAME_SIZE) != 0) return -1;
+            int8_t temp8 = 0;
+            for (uint16_t i = 0; i < frames; i++) {
+                const uint8_t *f = &buf[i * ICM_FIFO_FRAME_SIZE];
+                if (f[0] & ICM_FIFO_HEADER_EMPTY) break;
+                temp8 = (int8_t)f[13];      // 包格式3 的 8 位温度
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                if (ts) {
+                    uint16_t t16 = (uint16_t)(f[14] | (f[15] << 8));
+                    if (fifo_st.icm_ts_started) {
+                        fifo_st.icm_ts_ext += (uint16_t)(t16 - fifo_st.icm_ts_last);
+                    }
+                    fifo_st.icm_ts_last = t16;
+                    fifo_st.icm_ts_started = true;
+                    ts[n] = fifo_st.icm_ts_ext;
+                }
+#endif
+                decode_axes(&f[1], accel[n]);
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+                if (!acc_resolve(accel[n], le16(&f[1]) != ICM_FIFO_ACCEL_INVALID, n)) continue;
+#endif
+                decode_axes(&f[7], g);
+                sample_raw_store(g, gyro[n], accel[n]);
+                n++;
+            }
+            if (n > 0) {
+                temp_store(temp8 / (IMU_CUR_TYPE == IMU_ICM45686 ? 2.0f : 2.07f) + 25.0f);
+            }
+            break;
+        }
+        case IMU_BMI270:
+        {
+            uint8_t cnt[2];
+            imu_read_regs(BMI_REG_FIFO_LENGTH_0, cnt, 2);
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+            if (fifo_st.acc_shift) {
+                // 帧长可变, 按每帧最长 13 字节读取
+                uint16_t bytes = (uint16_t)(cnt[0] | ((cnt[1] & 0x3F) << 8));
+                if (bytes > (uint16_t)max_frames * 13) bytes = (uint16_t)max_frames * 13;
+                if (bytes == 0) return 0;
+                if (imu_read_regs(BMI_REG_FIFO_DATA, buf, bytes) != 0) return -1;
+                n = bmi_fifo_parse(buf, bytes, gyro, accel, max_frames);
+                bmi_temp_poll();
+                break;
+            }
+#endif
+            uint16_t frames = (uint16_t)(cnt[0] | ((cnt[1] & 0x3F) << 8)) / BMI_FIFO_FRAME_SIZE;
+            if (frames > max_frames) frames = max_frames;
+            if (frames == 0) return 0;
+            
+            if (imu_read_regs(BMI_REG_FIFO_DATA, buf, frames * BMI_FIFO_FRAME_SIZE) != 0) return -1;
+            for (uint16_t i = 0; i < frames; i++) {
+                const uint8_t *f = &buf[i * BMI_FIFO_FRAME_SIZE];
+                decode_axes(&f[0], g);
+                decode_axes(&f[6], accel[n]);
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+                acc_resolve(accel[n], true, n);
+#endif
+                sample_raw_store(g, gyro[n], accel[n]);
+                n++;
+            }
+            // 无帧头 FIFO 不带温度, 单独抽取读取
+            bmi_temp_poll();
+            break;
+        }
+        case IMU_LSM6DSV:
+        case IMU_LSM6DSR:
+        {
+            uint8_t st[2];
+            imu_read_regs(LSM_REG_FIFO_STATUS1, st, 2);
+            uint16_t words = (uint16_t)(st[0] | ((st[1] & 0x01) << 8));
+            uint16_t max_words = (uint16_t)(max_frames + FIFO_ACC_FRAMES(max_frames));
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+            // 每帧另有时间戳字, 受缓冲区大小限制, 放不下的留在 FIFO 下次再读
+            max_words += max_frames;
+#endif
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+            if (sflp_on && IMU_IS_PRIMARY) max_words += SFLP_WORDS(max_frames);
+#endif
+            if (max_words > sizeof(buf) / LSM_FIFO_WORD_SIZE) {
+                max_words = sizeof(buf) / LSM_FIFO_WORD_SIZE;
+            }
+            if (words > max_words) words = max_words;
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+            uint32_t lsm_ts = 0;
+#endif
+            if (words == 0) return 0;
+            
+            if (imu_read_regs(LSM_REG_FIFO_DATA_TAG, buf, words * LSM_FIFO_WORD_SIZE) != 0) return -1;
+            for (uint16_t i = 0; i < words && n < max_frames; i++) {
+                const uint8_t *w = &buf[i * LSM_FIFO_WORD_SIZE];
+                uint8_t tag = w[0] >> 3;
+                if (tag == LSM_TAG_GYRO) {
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+                    // 加速度批量率较低: 上一个陀螺字没有等到加速度字, 单独成帧
+                    if (fifo_st.lsm_pend_valid && acc_resolve(accel[n], false, n)) {
+                        sample_raw_store(fifo_st.lsm_pend_g, gyro[n], accel[n]);
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                        if (ts) ts[n] = fifo_st.lsm_pend_ts;
+#endif
+                        n++;
+                    }
+#endif
+                    decode_axes(&w[1], fifo_st.lsm_pend_g);
+                    fifo_st.lsm_pend_valid = true;
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                    fifo_st.lsm_pend_ts = lsm_ts;
+#endif
+                } else if (tag == LSM_TAG_ACCEL && fifo_st.lsm_pend_valid) {
+                    // 陀螺字先到, 加速度字凑齐一帧
+                    decode_axes(&w[1], accel[n]);
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+                    acc_resolve(accel[n], true, n);
+#endif
+                    sample_raw_store(fifo_st.lsm_pend_g, gyro[n], accel[n]);
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                    if (ts) ts[n] = fifo_st.lsm_pend_ts;
+#endif
+                    n++;
+                    fifo_st.lsm_pend_valid = false;
+                } else if (tag == LSM_TAG_TEMPERATURE) {
+                    temp_store(le16(&w[1]) / 256.0f + 25.0f);
+                }
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+                else if (tag == LSM_TAG_SFLP_GAME) {
+                    sflp_store(&w[1]);
+                }
+#endif
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                else if (tag == LSM_TAG_TIMESTAMP) {
+                    // 时间戳字出现在它所属批次的传感器字之前
+                    lsm_ts = (uint32_t)w[1] | ((uint32_t)w[2] << 8) |
+                             ((uint32_t)w[3] << 16) | ((uint32_t)w[4] << 24);
+                }
+#endif
+            }
+            break;
+        }
+        default:
+            return -2;
+    }
+    
+    return n;
+}
+
+int imu_fifo_read(float gyro[][3], float accel[][3], uint32_t ts[], uint8_t max_frames)
+{
+    int16_t g[IMU_FIFO_MAX_BATCH][3], a[IMU_FIFO_MAX_BATCH][3];
+    int n = imu_fifo_read_raw(g, a, ts, max_frames);
+    
+    for (int i = 0; i < n; i++) {
+        sample_scale(g[i], a[i], gyro[i], accel[i]);
+    }
+    return n;
+}
+
+uint8_t imu_fifo_get_watermark(void)
+{
+    return fifo_st.watermark;
+}
+
+uint8_t imu_fifo_accel_mask(void)
+{
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+    return fifo_st.acc_mask;
+#else
+    return 0xFF;
+#endif
+}
+
+bool imu_sflp_active(void)
+{
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    return sflp_on;
+#else
+    return false;
+#endif
+}
+
+bool imu_sflp_get_quat(float q[4])
+{
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+    if (!sflp_fresh) return false;
+    memcpy(q, sflp_q, sizeof(sflp_q));
+    sflp_fresh = false;
+    return true;
+#else
+    (void)q;
+    return false;
+#endif
+}
+
+/*============================================================================
+ * v0.6.3: 外部参考时钟 (CLKIN) / External clock input
+ *============================================================================*/
+
+#define ICM_REG_BANK_SEL        0x76
+#define ICM_REG_INTF_CONFIG1    0x4D    // bank0, bit2 RTC_MODE
+#define ICM_REG_INTF_CONFIG5    0x7B    // bank1, bit[2:1] PIN9_FUNCTION (10 = CLKIN)
+#define ICM_INTF_CONFIG1_RTC    0x95    // 复位值 0x91 | RTC_MODE
+#define ICM_INTF_CONFIG1_DEF    0x91
+
+int imu_set_external_clock(bool enable)
+{
+    if (!imu_ctx.initialized) return -1;
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+            // 引脚 9 切换为 CLKIN, 再打开 RTC 模式 (ODR 由 CLKIN 分频)
+            imu_write_reg(ICM_REG_BANK_SEL, 1);
+            imu_write_reg(ICM_REG_INTF_CONFIG5, enable ? 0x04 : 0x00);
+            imu_write_reg(ICM_REG_BANK_SEL, 0);
+            imu_write_reg(ICM_REG_INTF_CONFIG1, enable ? ICM_INTF_CONFIG1_RTC : ICM_INTF_CONFIG1_DEF);
+            return 0;
+            
+        default:
+            return -2;  // 无 CLKIN 引脚
+    }
+}
+
+uint32_t imu_fifo_ts_tick_ns(void)
+{
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    return (fifo_st.watermark != 0) ? fifo_st.ts_tick_ns : 0;
+#else
+    return 0;
+#endif
+}
+
+/*============================================================================
+ * v0.6.3: 片上运动事件 / On-chip motion events
+ *============================================================================*/
+
+// ICM-42688/45686 (与上面 WOM 代码相同的寄存器布局)
+#define ICM_REG_INT_STATUS2     0x37    // bit3 SMD, bit[2:0] WOM_Z/Y/X (读清除)
+#define ICM_REG_INT_STATUS3     0x38    // bit3 TILT_DET (读清除)
+#define ICM_REG_SIGNAL_PATH_RST 0x4B    // bit5 DMP_INIT_EN
+#define ICM_REG_PWR_MGMT0       ICM_SEL(0x4E, ICM45686_REG_PWR_MGMT0)  // 模式位相同
+#define ICM_REG_APEX_CONFIG0    0x56    // bit4 TILT_ENABLE, bit[1:0] DMP_ODR (10 = 50Hz)
+#define ICM_REG_SMD_CONFIG      0x57    // bit2 WOM_MODE, bit[1:0] SMD_MODE
+#define ICM_REG_INT_SOURCE1     0x66    // bit3 SMD_INT1_EN, bit[2:0] WOM_Z/Y/X_INT1_EN
+#define ICM_REG_WOM_X_THR       0x4A    // bank4, X/Y/Z 连续, 1000/256 mg/LSB
+#define ICM_REG_INT_SOURCE6     0x4D    // bank4, bit3 TILT_DET_INT1_EN
+#define ICM_SMD_MODE_WOM        0x01
+#define ICM_SMD_MODE_SHORT      0x02    // 约 1s 内两次 WOM 才判为显著运动
+#define ICM_WOM_MODE_PREV       0x04    // 与上一样本比较 (0 = 与使能时的首个样本比较)
+
+int imu_motion_arm(uint8_t events, uint16_t threshold_mg, bool wake)
+{
+    if (!imu_ctx.initialized) return -1;
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            uint32_t th = ((uint32_t)threshold_mg * 256 + 500) / 1000;
+            if (th == 0) th = 1;
+            if (th > 255) th = 255;
+            
+            // SMD 以 WOM 为输入, 共用阈值
+            imu_write_reg(ICM_REG_BANK_SEL, 4);
+            imu_write_reg(ICM_REG_WOM_X_THR, (uint8_t)th);
+            imu_write_reg(ICM_REG_WOM_X_THR + 1, (uint8_t)th);
+            imu_write_reg(ICM_REG_WOM_X_THR + 2, (uint8_t)th);
+            imu_write_reg(ICM_REG_INT_SOURCE6, (wake && (events & IMU_MOTION_TILT)) ? 0x08 : 0x00);
+            imu_write_reg(ICM_REG_BANK_SEL, 0);
+            
+            if (wake) {
+                // 只留加速度计, 低功耗 50Hz (APEX 的 DMP 频率)
+                uint8_t acc = imu_read_reg(ICM_REG_ACCEL_CONFIG0);
+                imu_write_reg(ICM_REG_ACCEL_CONFIG0, (uint8_t)((acc & 0xF0) | 0x09));
+                imu_write_reg(ICM_REG_PWR_MGMT0, 0x02);
+                hal_delay_ms(1);
+            }
+            
+            // 唤醒时逐样本比较 (检测运动); 静止复核时与首个样本比较, 缓慢转动也会累计触发
+            uint8_t armed = IMU_MOTION_WOM;
+            uint8_t smd = wake ? ICM_WOM_MODE_PREV : 0;
+            if (events & IMU_MOTION_SMD) {
+                smd |= ICM_SMD_MODE_SHORT;
+                armed |= IMU_MOTION_SMD;
+            } else {
+                smd |= ICM_SMD_MODE_WOM;
+            }
+            imu_write_reg(ICM_REG_SMD_CONFIG, smd);
+            
+            if (events & IMU_MOTION_TILT) {
+                imu_write_reg(ICM_REG_SIGNAL_PATH_RST, 0x20);
+                hal_delay_ms(1);
+                imu_write_reg(ICM_REG_APEX_CONFIG0, 0x12);
+                armed |= IMU_MOTION_TILT;
+            }
+            
+            if (wake) {
+                // 请求 SMD 时单次 WOM (磕碰) 不唤醒
+                imu_write_reg(ICM_REG_INT_SOURCE0, 0x00);
+                imu_write_reg(ICM_REG_INT_SOURCE1, (events & IMU_MOTION_SMD) ? 0x08 : 0x07);
+            }
+            
+            motion_armed = armed;
+            (void)imu_motion_get_events();      // 清除使能前的状态
+            return armed;
+        }
+        
+        default:
+            // 其它 IMU 只有阈值唤醒, 不提供状态读取
+            if (!wake) return 0;
+            motion_armed = 0;
+            return (imu_enable_wom(threshold_mg) == 0) ? IMU_MOTION_WOM : 0;
+    }
+}
+
+uint8_t imu_motion_get_events(void)
+{
+    if (!imu_ctx.initialized || motion_armed == 0) return 0;
+    
+    uint8_t s2 = imu_read_reg(ICM_REG_INT_STATUS2);
+    uint8_t s3 = imu_read_reg(ICM_REG_INT_STATUS3);
+    uint8_t ev = 0;
+    if (s2 & 0x07) ev |= IMU_MOTION_WOM;
+    if (s2 & 0x08) ev |= IMU_MOTION_SMD;
+    if (s3 & 0x08) ev |= IMU_MOTION_TILT;
+    return ev & motion_armed;
+}
+
+/*============================================================================
+ * v0.6.3: 功耗档 / Power profile (ODR + 低功耗模式)
+ *
+ * 每降一档 ODR 减半 (ODR 码 ±1), 只改 ODR/模式字段, 量程、FIFO 和中断配置不动;
+ * 基准值与 init_* 写入的全速配置一致
+ *============================================================================*/
+
+#define ICM_ODR_CODE_BASE       ICM_SEL(0x07, ICM45686_GYRO_ODR_200HZ)   // 200Hz, 100Hz/50Hz 依次 +1
+#define ICM_PWR_LN              0x0F    // 陀螺 + 加速度计低噪声
+#define ICM_PWR_ACC_LP          0x0E    // 陀螺低噪声 + 加速度计低功耗 (片内平均)
+#define BMI_ACC_CONF_BASE       0xA8    // filter_perf + norm_avg4, ODR 码每档 -1
+#define BMI_GYR_CONF_BASE       0xA9
+#define BMI_CONF_PERF           0x80    // acc/gyr_filter_perf, 清除 = 省电滤波 (按 bwp 平均)
+#define BMI_CONF_NOISE_PERF     0x40    // gyr_noise_perf
+#define LSM_REG_CTRL6_C         0x15    // LSM6DSR bit4 XL_HM_MODE (1 = 关闭高性能模式)
+#define LSM_ODR_CODE_BASE       7       // 240Hz, 高 4 位, 每档 -1
+
+static uint8_t profile_shift(imu_power_profile_t p)
+{
+    return (p == IMU_PROFILE_LOW) ? 2 : (p == IMU_PROFILE_NORMAL) ? 1 : 0;
+}
+
+int imu_set_power_profile(imu_power_profile_t profile)
+{
+    if (!imu_ctx.initialized) return -1;
+    if (profile > IMU_PROFILE_LOW) return -3;
+    if (profile == imu_ctx.profile) return 0;
+    
+    uint8_t sh = profile_shift(profile);
+    bool low = (profile == IMU_PROFILE_LOW);
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            uint8_t code = ICM_ODR_CODE_BASE + sh;
+            uint8_t acc = imu_read_reg(ICM_REG_ACCEL_CONFIG0);
+            uint8_t gyr = imu_read_reg(ICM_REG_GYRO_CONFIG0);
+            imu_write_reg(ICM_REG_ACCEL_CONFIG0, (uint8_t)((acc & 0xF0) | (code + FIFO_ACC_SHIFT)));
+            imu_write_reg(ICM_REG_GYRO_CONFIG0, (uint8_t)((gyr & 0xF0) | code));
+            imu_write_reg(ICM_REG_PWR_MGMT0, low ? ICM_PWR_ACC_LP : ICM_PWR_LN);
+            break;
+        }
+        case IMU_BMI270:
+        {
+            uint8_t acc = (uint8_t)(BMI_ACC_CONF_BASE - sh);
+            uint8_t gyr = (uint8_t)(BMI_GYR_CONF_BASE - sh);
+#if defined(USE_IMU_MIXED_ODR) && USE_IMU_MIXED_ODR
+            if (fifo_st.acc_shift) {
+                // 分开 ODR 时加速度计跟随陀螺 ODR 码
+                acc = (uint8_t)((BMI_ACC_CONF_BASE & 0xF0) | ((gyr & 0x0F) - fifo_st.acc_shift));
+            }
+#endif
+            if (low) {
+                acc &= (uint8_t)~BMI_CONF_PERF;
+                gyr &= (uint8_t)~(BMI_CONF_PERF | BMI_CONF_NOISE_PERF);
+            }
+            imu_write_reg(BMI_REG_ACC_CONF, acc);
+            imu_write_reg(BMI_REG_GYR_CONF, gyr);
+            break;
+        }
+        case IMU_LSM6DSV:
+        case IMU_LSM6DSR:
+        {
+#if defined(USE_IMU_SFLP) && USE_IMU_SFLP
+            // SFLP 要求陀螺/加速度计 ODR 不低于 SFLP 输出率
+            if (sflp_on) return -2;
+#endif
+            uint8_t code = (uint8_t)((LSM_ODR_CODE_BASE - sh) << 4);
+            uint8_t acode = (uint8_t)((LSM_ODR_CODE_BASE - sh - FIFO_ACC_SHIFT) << 4);
+            imu_write_reg(LSM_REG_CTRL1, acode | 0x01);
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+            // 量程可能已被自动切换改过, 保留低 4 位
+            imu_write_reg(LSM_REG_CTRL2, code | (imu_read_reg(LSM_REG_CTRL2) & 0x0F));
+#else
+            imu_write_reg(LSM_REG_CTRL2, code | 0x04);
+#endif
+            if (fifo_st.watermark != 0) {
+                // FIFO 批量率跟随 ODR, 否则同一样本重复入队
+                imu_write_reg(LSM_REG_FIFO_CTRL3, (uint8_t)(code | (acode >> 4)));
+            }
+            if (IMU_CUR_TYPE == IMU_LSM6DSR) {
+                imu_write_reg(LSM_REG_CTRL6_C, low ? 0x10 : 0x00);
+            }
+            break;
+        }
+        default:
+            return -2;
+    }
+    
+    imu_ctx.profile = (uint8_t)profile;
+    return 0;
+}
+
+imu_power_profile_t imu_get_power_profile(void)
+{
+    return (imu_power_profile_t)imu_ctx.profile;
+}
+
+uint8_t imu_get_rate_div(void)
+{
+    return (uint8_t)(1u << profile_shift((imu_power_profile_t)imu_ctx.profile));
+}
+
+uint16_t imu_get_odr_hz(void)
+{
+    return (uint16_t)(SENSOR_ODR_HZ / imu_get_rate_div());
+}
+
+/*============================================================================
+ * v0.6.3: 睡眠 FIFO / Sleep FIFO (USE_WAKE_FIFO_CATCHUP)
+ *
+ * 运动引擎已把加速度计设为低功耗 50Hz; 这里再打开陀螺 (同 ODR) 并开 Stream-to-FIFO,
+ * FIFO 满后新帧覆盖最旧帧, 唤醒时留下的是最近约 2.5s. 水位中断不路由 (INT1 仍是运动事件)
+ *============================================================================*/
+
+#if defined(USE_WAKE_FIFO_CATCHUP) && USE_WAKE_FIFO_CATCHUP
+
+#define ICM_ODR_CODE_50HZ       ICM_SEL(0x09, ICM45686_GYRO_ODR_50HZ)
+
+static uint8_t sleep_fifo_saved_wm = 0;
+
+int imu_sleep_fifo_start(void)
+{
+    if (!imu_ctx.initialized) return -1;
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            sleep_fifo_saved_wm = fifo_st.watermark;
+            
+            uint8_t acc = imu_read_reg(ICM_REG_ACCEL_CONFIG0);
+            uint8_t gyr = imu_read_reg(ICM_REG_GYRO_CONFIG0);
+            imu_write_reg(ICM_REG_ACCEL_CONFIG0, (uint8_t)((acc & 0xF0) | ICM_ODR_CODE_50HZ));
+            imu_write_reg(ICM_REG_GYRO_CONFIG0, (uint8_t)((gyr & 0xF0) | ICM_ODR_CODE_50HZ));
+            imu_write_reg(ICM_REG_PWR_MGMT0, ICM_PWR_ACC_LP);
+            hal_delay_ms(1);
+            
+            // 水位取最大批次 (只为让 imu_fifo_read 可用), 随后撤掉 FIFO_THS 的 INT1 路由;
+            // 加速度计保持运动引擎的 50Hz
+            fifo_enable(IMU_FIFO_MAX_BATCH, 0);
+            imu_write_reg(ICM_REG_INT_SOURCE0, 0x00);
+            imu_write_reg(ICM_REG_FIFO_FLUSH, ICM_FIFO_FLUSH_BIT);
+            return 0;
+        }
+        
+        default:
+            return -2;
+    }
+}
+
+void imu_sleep_fifo_stop(void)
+{
+    fifo_st.watermark = sleep_fifo_saved_wm;
+}
+
+#endif /* USE_WAKE_FIFO_CATCHUP */
+
+/*============================================================================
+ * v0.6.3: 陀螺量程自动切换 / Gyro auto range
+ *
+ * 解码路径只做统计 (gyro_range_observe), 寄存器写入和增益切换在主循环两次读取之间
+ * (已读出的原始样本都已换算). 写入量程时 FIFO 中已有的帧和正在转换的样本仍是旧量程,
+ * 记为 gr_backlog, 解码时按 2 的幂换到新量程计数; 增益在同一临界区内更新,
+ * 融合看到的物理量在切换点连续. 档位: 满量程 500 << level dps
+ *============================================================================*/
+
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+
+#define GR_LEVEL_COUNT          4
+#define GR_LEVEL_OF(dps)        ((dps) <= 500 ? 0 : (dps) <= 1000 ? 1 : (dps) <= 2000 ? 2 : 3)
+#define GR_CODE_NONE            0xFF
+#define BMI_REG_GYR_RANGE       0x43
+#define GR_NARROW_RAW           ((uint16_t)(16384UL * GYRO_RANGE_NARROW_PCT / 100))
+
+// 每档的量程码 (500/1000/2000/4000 dps), 与 src/sensor/imu 下各驱动的编码一致
+static const uint8_t gr_code_icm[GR_LEVEL_COUNT] = { 2, 1, 0, GR_CODE_NONE };     // GYRO_FS_SEL, bit[7:5]
+static const uint8_t gr_code_bmi[GR_LEVEL_COUNT] = { 2, 1, 0, GR_CODE_NONE };     // GYR_RANGE
+static const uint8_t gr_code_dsv[GR_LEVEL_COUNT] = { 0x02, 0x03, 0x04, 0x0C };    // CTRL2 bit[3:0]
+static const uint8_t gr_code_dsr[GR_LEVEL_COUNT] = { 0x02, 0x04, 0x06, GR_CODE_NONE };
+
+static const uint8_t *gr_codes(void)
+{
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:  return gr_code_icm;
+        case IMU_BMI270:    return gr_code_bmi;
+        case IMU_LSM6DSV:   return gr_code_dsv;
+        case IMU_LSM6DSR:   return gr_code_dsr;
+        default:            return NULL;
+    }
+}
+
+// 写入量程寄存器, 返回写入前 FIFO 中已有的帧数 + 转换中的样本 (随后按旧量程解码)
+static uint8_t gr_write_range(uint8_t code)
+{
+    uint8_t cnt[2];
+    uint16_t frames = 0;
+    
+    switch (IMU_CUR_TYPE) {
+        case IMU_ICM45686:
+        case IMU_ICM42688:
+        {
+            uint8_t gyr = imu_read_reg(ICM_REG_GYRO_CONFIG0);
+            if (fifo_st.watermark != 0) {
+                imu_read_regs(ICM_REG_FIFO_COUNTH, cnt, 2);
+                frames = (uint16_t)(cnt[0] | (cnt[1] << 8)) / ICM_FIFO_FRAME_SIZE;
+            }
+            imu_write_reg(ICM_REG_GYRO_CONFIG0, (uint8_t)((gyr & 0x1F) | (code << 5)));
+            break;
+        }
+        case IMU_BMI270:
+            if (fifo_st.watermark != 0) {
+                imu_read_regs(BMI_REG_FIFO_LENGTH_0, cnt, 2);
+                frames = (uint16_t)(cnt[0] | ((cnt[1] & 0x3F) << 8)) / BMI_FIFO_FRAME_SIZE;
+            }
+            imu_write_reg(BMI_REG_GYR_RANGE, code);
+            break;
+        case IMU_LSM6DSV:
+        case IMU_LSM6DSR:
+        {
+            uint8_t ctrl2 = imu_read_reg(LSM_REG_CTRL2);
+            if (fifo_st.watermark != 0) {
+                // 按每帧陀螺 + 加速度 (+ 时间戳) 字估算, 温度/SFLP 字使结果略偏大
+                imu_read_regs(LSM_REG_FIFO_STATUS1, cnt, 2);
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+                frames = (uint16_t)(cnt[0] | ((cnt[1] & 0x01) << 8)) / 3;
+#else
+                frames = (uint16_t)(cnt[0] | ((cnt[1] & 0x01) << 8)) / 2;
+#endif
+            }
+            imu_write_reg(LSM_REG_CTRL2, (uint8_t)((ctrl2 & 0xF0) | code));
+            break;
+        }
+    }
+    frames += GYRO_RANGE_SETTLE_SAMPLES;
+    return (uint8_t)(frames > 0xFF ? 0xFF : frames);
+}
+
+static void gr_apply(uint8_t level, uint8_t code)
+{
+    const float deg2rad = 0.01745329252f;
+    uint8_t backlog = gr_write_range(code);
+    float scale = (float)(500u << level) / 32768.0f;
+    
+    // 与解码路径 (DMA 中断) 互斥: 积压计数、移位和增益同时生效
+    __disable_irq();
+    imu_ctx.gr_shift = (int8_t)(imu_ctx.gr_level - level);
+    imu_ctx.gr_backlog = backlog;
+    imu_ctx.gr_level = level;
+    imu_ctx.gyro_scale = scale;
+    for (int i = 0; i < 3; i++) {
+        imu_ctx.pp_gyro_gain[i] = scale * deg2rad;
+    }
+    imu_ctx.gr_saturated = false;
+    imu_ctx.gr_peak = 0;
+    imu_ctx.gr_seen = false;
+    __enable_irq();
+    
+    imu_ctx.gr_quiet = false;
+    preproc_rebuild();      // 同步采集参数
+}
+
+#endif /* USE_GYRO_AUTO_RANGE */
+
+int imu_gyro_range_update(void)
+{
+#if defined(USE_GYRO_AUTO_RANGE) && USE_GYRO_AUTO_RANGE
+    if (!imu_ctx.initialized) return -1;
+    const uint8_t *codes = gr_codes();
+    if (!codes) return -2;
+    
+    __disable_irq();
+    bool sat = imu_ctx.gr_saturated;
+    bool seen = imu_ctx.gr_seen;
+    uint16_t peak = imu_ctx.gr_peak;
+    imu_ctx.gr_saturated = false;
+    imu_ctx.gr_seen = false;
+    imu_ctx.gr_peak = 0;
+    __enable_irq();
+    
+    if (!seen) return 0;
+    
+    uint8_t level = imu_ctx.gr_level;
+    uint32_t now_ms = hal_get_tick_ms();
+    
+    if (sat) {
+        // 饱和: 立即放宽一档 (型号不支持的档位跳过)
+        for (uint8_t l = level + 1; l <= GR_LEVEL_OF(GYRO_RANGE_MAX_DPS); l++) {
+            if (codes[l] != GR_CODE_NONE) {
+                gr_apply(l, codes[l]);
+                return 1;
+            }
+        }
+        imu_ctx.gr_quiet = false;
+        return 0;
+    }
+    
+    if (level == GR_LEVEL_OF(GYRO_RANGE_MIN_DPS) || peak >= GR_NARROW_RAW) {
+        imu_ctx.gr_quiet = false;
+        return 0;
+    }
+    if (!imu_ctx.gr_quiet) {
+        imu_ctx.gr_quiet = true;
+        imu_ctx.gr_quiet_ms = now_ms;
+        return 0;
+    }
+    if ((now_ms - imu_ctx.gr_quiet_ms) < GYRO_RANGE_HOLD_MS) return 0;
+    
+    // 持续低于下一档满量程的 GYRO_RANGE_NARROW_PCT%: 收窄一档
+    gr_apply(level - 1, codes[level - 1]);
+    return 1;
+#else
+    return -2;
+#endif
+}
+
+uint16_t imu_get_gyro_range_dps(void)
+{
+    return (uint16_t)(imu_ctx.gyro_scale * 32768.0f + 0.5f);
+}
+
+/*============================================================================
+ * v0.6.3: 辅助 IMU / Auxiliary IMU
+ *============================================================================*/
+
+int imu_aux_init(void)
+{
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    if (!imu_sensors[IMU_SENSOR_PRIMARY].initialized) return -1;
+    
+    imu_sel = IMU_SENSOR_AUX;
+    int ret = imu_init();
+    if (ret == 0 && fifo_state[IMU_SENSOR_PRIMARY].watermark != 0) {
+        // 不接中断, 水位只决定 FIFO 模式; 由主 IMU 水位突发后顺带读取
+        ret = (imu_fifo_enable(fifo_state[IMU_SENSOR_PRIMARY].watermark) == 0) ? 0 : -2;
+    }
+    if (ret != 0) {
+        imu_sensors[IMU_SENSOR_AUX].initialized = false;
+    }
+    imu_sel = IMU_SENSOR_PRIMARY;
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+    if (IMU_CUR_IF == IMU_IF_SPI) hal_spi_select(HAL_SPI_DEV_IMU);
+#endif
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+int imu_select(uint8_t sensor)
+{
+#if defined(USE_AUX_IMU) && USE_AUX_IMU
+    if (sensor >= IMU_SENSOR_COUNT || !imu_sensors[sensor].initialized) return -1;
+    imu_sel = sensor;
+#if defined(USE_SPI_PROFILES) && USE_SPI_PROFILES
+    if (IMU_CUR_IF == IMU_IF_SPI) hal_spi_select(IMU_CUR_SPI_DEV);
+#endif
+    return 0;
+#else
+    return (sensor == IMU_SENSOR_PRIMARY) ? 0 : -1;
+#endif
+}
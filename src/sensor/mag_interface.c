@@ -7,13 +7,22 @@
  * 2. 默认禁用，需手动启用
  * 3. IMU 为主，磁力计辅助
  * 4. 偏差过大自动禁用
+ * 5. v0.6.3: 按磁力计自身输出率发起读取, 两次转换之间 mag_read 不访问总线
+ * 6. v0.6.3: 校准以定点应用 (原始计数偏移 + Q14 软铁矩阵); USE_MAG_ELLIPSOID 时
+ *    后台累加椭球拟合统计量, 空闲时分步求解
  */
 
 #include "mag_interface.h"
 #include "hal.h"
+#include "config.h"
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+#include "bus_sched.h"
+#endif
+
 /*============================================================================
  * I2C 地址和寄存器
  *============================================================================*/
@@ -37,6 +46,34 @@
 #define IIS2_REG_CFG_A      0x60
 #define IIS2_REG_DATA       0x68
 
+// v0.6.3: 各型号输出率 (与 mag_enable 的配置一致), 读取按此节拍发起
+#define QMC_ODR_HZ          100     // CTRL1 0x19: 连续, 100Hz, OSR 4
+#define HMC_ODR_HZ          75      // CFG_A 0x78: 8 次平均, 75Hz
+#define IIS2_ODR_HZ         100     // CFG_A 0x8C: 温补, 100Hz, 连续
+
+// 各型号灵敏度 (uT/LSB)
+#define QMC_LSB_UT          0.0125f
+#define HMC_LSB_UT          0.092f
+#define IIS2_LSB_UT         0.15f
+
+// v0.6.3: 软铁矩阵定点格式, 每行绝对值之和 <= 2.0 保证 int32 不溢出
+#define MAG_SI_FRAC         14
+#define MAG_SI_ONE          (1 << MAG_SI_FRAC)
+#define MAG_SI_ROW_MAX      (2 * MAG_SI_ONE)
+
+// v0.6.3: 椭球拟合
+#define MAG_ELL_NORM_UT     50.0f   // 归一化单位, 统计量量级约为 1
+#define MAG_ELL_MIN_STEP    0.1f    // 与上一个采用样本相距 (归一化单位), 静止时不重复累加
+#define MAG_ELL_MIN_SAMPLES 150
+#define MAG_ELL_MAX_SAMPLES 2000    // 达到后统计量减半 (遗忘旧环境, 限制浮点累加误差)
+#define MAG_ELL_SOLVE_EVERY 50      // 每采用这么多新样本重新求解一次
+#define MAG_ELL_RMS_MAX     0.06f   // 代数残差 RMS (约 3% 半径误差)
+#define MAG_ELL_AXIS_RATIO  2.0f    // 最长/最短半轴
+#define MAG_ELL_MIN_SPAN    1.2f    // 每轴采样跨度 / 平均半径
+#define MAG_ELL_FIELD_MIN   15.0f   // uT
+#define MAG_ELL_FIELD_MAX   100.0f  // uT
+#define MAG_CALIB_MAGIC     0x3147414D  // "MAG1"
+
 /*============================================================================
  * 状态
  *============================================================================*/
@@ -46,9 +83,9 @@ static struct {
     mag_state_t state;
     bool enabled;
     
-    // 校准
-    float hard_iron[3];
-    float scale[3];
+    // 校准 (v0.6.3: 定点, cal = W·(raw - offset) >> MAG_SI_FRAC)
+    int16_t offset[3];          // 硬铁偏移, 原始计数
+    int16_t soft_iron[9];       // 软铁矩阵 W, Q14, 行主序
     bool calibrated;
     
     float min_vals[3];
@@ -58,8 +95,68 @@ static struct {
     // 场强参考
     float field_ref;
     uint32_t error_count;
+    
+    // v0.6.3: 读取节拍
+    uint32_t period_us;
+    uint32_t last_trigger_us;
 } mag = {0};
 
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+typedef enum {
+    MAG_ELL_IDLE = 0,
+    MAG_ELL_CHOL,       // 每步分解一列 (Cholesky)
+    MAG_ELL_SOLVE,      // 前代 + 回代
+    MAG_ELL_FINISH      // 提取中心/软铁矩阵并校验
+} mag_ell_step_t;
+
+// 二次曲面 u'Au + 2g'u = 1, 参数 θ = [A00 A11 A22 A01 A02 A12 g0 g1 g2]
+// u = (raw - ref)·norm, ref 在统计量清空时取当前偏移
+static struct {
+    float ata[45];              // ΣppT, 下三角压缩
+    float atb[9];               // Σp
+    float n;
+    float last[3];
+    float lo[3], hi[3];
+    int16_t ref[3];
+    float norm;
+    uint16_t fresh;             // 上次求解后新采用的样本数
+    
+    mag_ell_step_t step;
+    uint8_t k;
+    bool accepted;              // 最近一次求解结果被采用
+    float l[45];                // 分解工作区
+    float y[9];
+} ell;
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint8_t type;               // 偏移以原始计数保存, 仅对同型号有效
+    uint8_t reserved;
+    int16_t offset[3];
+    int16_t soft_iron[9];
+    float field_ref;
+} mag_calib_store_t;
+
+// v0.6.3: USE_BUS_SCHED 时经总线调度 (磁力计优先级低于 IMU)
+static int mag_i2c_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+    return bus_sched_read(BUS_CLIENT_MAG, addr, reg, buf, len);
+#else
+    return hal_i2c_read_reg(addr, reg, buf, len);
+#endif
+}
+
+static int mag_i2c_write_byte(uint8_t addr, uint8_t reg, uint8_t val)
+{
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+    return bus_sched_write_byte(BUS_CLIENT_MAG, addr, reg, val);
+#else
+    return hal_i2c_write_byte(addr, reg, val);
+#endif
+}
+
 /*============================================================================
  * 检测
  *============================================================================*/
@@ -69,18 +166,18 @@ mag_type_t mag_detect(void)
     uint8_t id;
     
     // QMC5883P
-    if (hal_i2c_read_reg(QMC_ADDR, QMC_REG_CHIP_ID, &id, 1) == 0) {
+    if (mag_i2c_read(QMC_ADDR, QMC_REG_CHIP_ID, &id, 1) == 0) {
         if (id == 0xFF || id == 0x06) return MAG_TYPE_QMC5883P;
     }
     
     // IIS2MDC
-    if (hal_i2c_read_reg(IIS2_ADDR, IIS2_REG_WHO, &id, 1) == 0) {
+    if (mag_i2c_read(IIS2_ADDR, IIS2_REG_WHO, &id, 1) == 0) {
         if (id == 0x40) return MAG_TYPE_IIS2MDC;
     }
     
     // HMC5883L
     uint8_t hmc_id[3];
-    if (hal_i2c_read_reg(HMC_ADDR, HMC_REG_ID_A, hmc_id, 3) == 0) {
+    if (mag_i2c_read(HMC_ADDR, HMC_REG_ID_A, hmc_id, 3) == 0) {
         if (hmc_id[0] == 'H' && hmc_id[1] == '4' && hmc_id[2] == '3') {
             // 尝试区分 5883L 和 5983
             return MAG_TYPE_HMC5883L;
@@ -94,11 +191,67 @@ mag_type_t mag_detect(void)
  * 初始化
  *============================================================================*/
 
+static void mag_calib_identity(void)
+{
+    memset(mag.offset, 0, sizeof(mag.offset));
+    memset(mag.soft_iron, 0, sizeof(mag.soft_iron));
+    mag.soft_iron[0] = mag.soft_iron[4] = mag.soft_iron[8] = MAG_SI_ONE;
+}
+
+static float mag_lsb_ut(void)
+{
+    switch (mag.type) {
+        case MAG_TYPE_QMC5883P: return QMC_LSB_UT;
+        case MAG_TYPE_HMC5883L:
+        case MAG_TYPE_HMC5983:  return HMC_LSB_UT;
+        case MAG_TYPE_IIS2MDC:  return IIS2_LSB_UT;
+        default:                return 1.0f;
+    }
+}
+
+static void mag_calib_save(void)
+{
+    mag_calib_store_t st;
+    memset(&st, 0, sizeof(st));
+    st.magic = MAG_CALIB_MAGIC;
+    st.type = (uint8_t)mag.type;
+    memcpy(st.offset, mag.offset, sizeof(st.offset));
+    memcpy(st.soft_iron, mag.soft_iron, sizeof(st.soft_iron));
+    st.field_ref = mag.field_ref;
+    hal_kv_set_deferred(HAL_KV_MAG_CALIB, &st, sizeof(st));
+}
+
+static void mag_calib_load(void)
+{
+    mag_calib_store_t st;
+    if (hal_kv_get(HAL_KV_MAG_CALIB, &st, sizeof(st)) != (int)sizeof(st)) return;
+    if (st.magic != MAG_CALIB_MAGIC || st.type != (uint8_t)mag.type) return;
+    if (!(st.field_ref > 0.0f)) return;
+    
+    memcpy(mag.offset, st.offset, sizeof(mag.offset));
+    memcpy(mag.soft_iron, st.soft_iron, sizeof(mag.soft_iron));
+    mag.field_ref = st.field_ref;
+    mag.calibrated = true;
+}
+
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+static void mag_ell_reset(void)
+{
+    memset(&ell, 0, sizeof(ell));
+    memcpy(ell.ref, mag.offset, sizeof(ell.ref));
+    ell.norm = mag_lsb_ut() / MAG_ELL_NORM_UT;
+    for (int i = 0; i < 3; i++) {
+        ell.lo[i] = 1e9f;
+        ell.hi[i] = -1e9f;
+    }
+}
+#endif
+
 int mag_init(void)
 {
     memset(&mag, 0, sizeof(mag));
     
-    mag.scale[0] = mag.scale[1] = mag.scale[2] = 1.0f;
+    mag_calib_identity();
     for (int i = 0; i < 3; i++) {
         mag.min_vals[i] = 1000.0f;
         mag.max_vals[i] = -1000.0f;
@@ -111,6 +264,11 @@ int mag_init(void)
         return -1;
     }
     
+    mag_calib_load();
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+    mag_ell_reset();
+#endif
+    
     mag.state = MAG_STATE_INIT;
     return 0;
 }
@@ -127,15 +285,19 @@ int mag_enable(void)
     
     switch (mag.type) {
         case MAG_TYPE_QMC5883P:
-            ret = hal_i2c_write_byte(QMC_ADDR, QMC_REG_CTRL1, 0x1D);  // 200Hz, 8G
+            // v0.6.3: 200Hz → 100Hz, 融合只在新样本到来时使用磁力计
+            ret = mag_i2c_write_byte(QMC_ADDR, QMC_REG_CTRL1, 0x19);
+            mag.period_us = 1000000UL / QMC_ODR_HZ;
             break;
         case MAG_TYPE_HMC5883L:
         case MAG_TYPE_HMC5983:
-            hal_i2c_write_byte(HMC_ADDR, HMC_REG_CFG_A, 0x78);
-            ret = hal_i2c_write_byte(HMC_ADDR, HMC_REG_MODE, 0x00);
+            mag_i2c_write_byte(HMC_ADDR, HMC_REG_CFG_A, 0x78);
+            ret = mag_i2c_write_byte(HMC_ADDR, HMC_REG_MODE, 0x00);
+            mag.period_us = 1000000UL / HMC_ODR_HZ;
             break;
         case MAG_TYPE_IIS2MDC:
-            ret = hal_i2c_write_byte(IIS2_ADDR, IIS2_REG_CFG_A, 0x8C);
+            ret = mag_i2c_write_byte(IIS2_ADDR, IIS2_REG_CFG_A, 0x8C);
+            mag.period_us = 1000000UL / IIS2_ODR_HZ;
             break;
         default:
             return -1;
@@ -144,6 +306,7 @@ int mag_enable(void)
     if (ret == 0) {
         mag.enabled = true;
         mag.state = MAG_STATE_READY;
+        mag.last_trigger_us = hal_micros() - mag.period_us;     // 首次立即读取
     }
     
     return ret;
@@ -160,6 +323,56 @@ int mag_disable(void)
  * 数据读取
  *============================================================================*/
 
+// 各型号数据寄存器
+static int mag_data_location(uint8_t *addr, uint8_t *reg)
+{
+    switch (mag.type) {
+        case MAG_TYPE_QMC5883P:
+            *addr = QMC_ADDR;  *reg = QMC_REG_DATA;
+            return 0;
+        case MAG_TYPE_HMC5883L:
+        case MAG_TYPE_HMC5983:
+            *addr = HMC_ADDR;  *reg = HMC_REG_DATA;
+            return 0;
+        case MAG_TYPE_IIS2MDC:
+            *addr = IIS2_ADDR; *reg = IIS2_REG_DATA;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+#if defined(USE_HW_I2C) && USE_HW_I2C
+// v0.6.3: 硬件 I2C 异步读取, 不再阻塞 200Hz 主循环
+static uint8_t mag_async_buf[6];
+static volatile bool mag_async_pending = false;
+static volatile bool mag_async_done = false;
+static volatile int mag_async_status = 0;
+
+static void mag_async_cb(int status, void *ctx)
+{
+    (void)ctx;
+    mag_async_status = status;
+    mag_async_pending = false;
+    mag_async_done = true;
+}
+#endif
+
+static int mag_process_raw(const uint8_t *buf, mag_data_t *data);
+
+// v0.6.3: 距上次读取已过一个输出周期 (之前读到的仍是同一个转换结果)
+static bool mag_read_due(void)
+{
+    uint32_t now = hal_micros();
+    if ((now - mag.last_trigger_us) < mag.period_us) return false;
+    mag.last_trigger_us = now;
+    return true;
+}
+
+/**
+ * v0.6.3: USE_HW_I2C 下为流水线读取: 返回上一次异步读取的结果,
+ * 到磁力计输出周期时发起下一次; 尚无新数据时返回 1 (data->valid 保持不变)
+ */
 int mag_read(mag_data_t *data)
 {
     if (!data || !mag.enabled) {
@@ -167,60 +380,144 @@ int mag_read(mag_data_t *data)
         return -1;
     }
     
+    uint8_t addr, reg;
+    if (mag_data_location(&addr, &reg) != 0) {
+        data->valid = false;
+        return -1;
+    }
+    
+#if defined(USE_HW_I2C) && USE_HW_I2C
+    int ret = 1;
+    if (mag_async_done) {
+        mag_async_done = false;
+        if (mag_async_status == 0) {
+            ret = mag_process_raw(mag_async_buf, data);
+        } else {
+            data->valid = false;
+            ret = -1;
+        }
+    }
+    
+#if defined(USE_BUS_SCHED) && USE_BUS_SCHED
+    // 排队等总线, IMU 访问在传输边界优先
+    if (!mag_async_pending && mag_read_due()) {
+        mag_async_pending = true;
+        if (bus_sched_read_async(BUS_CLIENT_MAG, addr, reg, mag_async_buf, 6,
+                                 mag_async_cb, NULL) != 0) {
+#else
+    // 总线空闲时发起下一次读取 (IMU 同步访问占用总线时下轮再试)
+    if (!mag_async_pending && !hal_i2c_busy() && mag_read_due()) {
+        mag_async_pending = true;
+        if (hal_i2c_read_reg_async(addr, reg, mag_async_buf, 6, mag_async_cb, NULL) != 0) {
+#endif
+            mag_async_pending = false;
+        }
+    }
+    return ret;
+#else
+    if (!mag_read_due()) return 1;
+    
     uint8_t buf[6];
+    if (mag_i2c_read(addr, reg, buf, 6) != 0) {
+        data->valid = false;
+        return -1;
+    }
+    return mag_process_raw(buf, data);
+#endif
+}
+
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+// 样本路径: 覆盖度门限 + 法方程累加 (54 次乘加)
+static void mag_ell_add(const int16_t raw[3])
+{
+    float u[3];
+    for (int i = 0; i < 3; i++) {
+        u[i] = (float)(raw[i] - ell.ref[i]) * ell.norm;
+    }
+    
+    if (ell.n > 0.0f) {
+        float dx = u[0] - ell.last[0], dy = u[1] - ell.last[1], dz = u[2] - ell.last[2];
+        if (dx*dx + dy*dy + dz*dz < MAG_ELL_MIN_STEP * MAG_ELL_MIN_STEP) return;
+    }
+    memcpy(ell.last, u, sizeof(ell.last));
+    for (int i = 0; i < 3; i++) {
+        if (u[i] < ell.lo[i]) ell.lo[i] = u[i];
+        if (u[i] > ell.hi[i]) ell.hi[i] = u[i];
+    }
+    
+    const float p[9] = {
+        u[0]*u[0], u[1]*u[1], u[2]*u[2],
+        2.0f*u[0]*u[1], 2.0f*u[0]*u[2], 2.0f*u[1]*u[2],
+        2.0f*u[0], 2.0f*u[1], 2.0f*u[2]
+    };
+    float *a = ell.ata;
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j <= i; j++) {
+            *a++ += p[i] * p[j];
+        }
+        ell.atb[i] += p[i];
+    }
+    ell.n += 1.0f;
+    
+    if (ell.n >= MAG_ELL_MAX_SAMPLES) {
+        for (int i = 0; i < 45; i++) ell.ata[i] *= 0.5f;
+        for (int i = 0; i < 9; i++) ell.atb[i] *= 0.5f;
+        ell.n *= 0.5f;
+    }
+    if (ell.fresh < 0xFFFF) ell.fresh++;
+}
+#endif
+
+// v0.6.3: 定点校准 cal = W·(raw - offset), 行和 <= 2.0 保证不溢出
+static void mag_apply_calib(const int16_t raw[3], int32_t out[3])
+{
+    int32_t d[3];
+    for (int i = 0; i < 3; i++) {
+        d[i] = (int32_t)raw[i] - mag.offset[i];
+        if (d[i] > 32767) d[i] = 32767;
+        if (d[i] < -32767) d[i] = -32767;
+    }
+    for (int i = 0; i < 3; i++) {
+        const int16_t *w = &mag.soft_iron[3 * i];
+        out[i] = (w[0] * d[0] + w[1] * d[1] + w[2] * d[2] + (MAG_SI_ONE >> 1)) >> MAG_SI_FRAC;
+    }
+}
+
+static int mag_process_raw(const uint8_t *buf, mag_data_t *data)
+{
     int16_t raw[3];
-    float scale = 1.0f;
     
     switch (mag.type) {
         case MAG_TYPE_QMC5883P:
-            if (hal_i2c_read_reg(QMC_ADDR, QMC_REG_DATA, buf, 6) != 0) {
-                data->valid = false;
-                return -1;
-            }
+        case MAG_TYPE_IIS2MDC:
             raw[0] = (int16_t)(buf[1] << 8 | buf[0]);
             raw[1] = (int16_t)(buf[3] << 8 | buf[2]);
             raw[2] = (int16_t)(buf[5] << 8 | buf[4]);
-            scale = 0.0125f;
             break;
             
         case MAG_TYPE_HMC5883L:
         case MAG_TYPE_HMC5983:
-            if (hal_i2c_read_reg(HMC_ADDR, HMC_REG_DATA, buf, 6) != 0) {
-                data->valid = false;
-                return -1;
-            }
             raw[0] = (int16_t)(buf[0] << 8 | buf[1]);
             raw[2] = (int16_t)(buf[2] << 8 | buf[3]);
             raw[1] = (int16_t)(buf[4] << 8 | buf[5]);
-            scale = 0.092f;
-            break;
-            
-        case MAG_TYPE_IIS2MDC:
-            if (hal_i2c_read_reg(IIS2_ADDR, IIS2_REG_DATA, buf, 6) != 0) {
-                data->valid = false;
-                return -1;
-            }
-            raw[0] = (int16_t)(buf[1] << 8 | buf[0]);
-            raw[1] = (int16_t)(buf[3] << 8 | buf[2]);
-            raw[2] = (int16_t)(buf[5] << 8 | buf[4]);
-            scale = 0.15f;
             break;
             
         default:
             data->valid = false;
             return -1;
     }
+    float scale = mag_lsb_ut();
     
-    // 转换为 uT
-    float val[3];
-    val[0] = raw[0] * scale;
-    val[1] = raw[1] * scale;
-    val[2] = raw[2] * scale;
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+    mag_ell_add(raw);
+#endif
     
-    // 应用校准
-    data->x = (val[0] - mag.hard_iron[0]) * mag.scale[0];
-    data->y = (val[1] - mag.hard_iron[1]) * mag.scale[1];
-    data->z = (val[2] - mag.hard_iron[2]) * mag.scale[2];
+    // 应用校准, 转换为 uT
+    int32_t cal[3];
+    mag_apply_calib(raw, cal);
+    data->x = cal[0] * scale;
+    data->y = cal[1] * scale;
+    data->z = cal[2] * scale;
     
     // 计算航向
     data->heading = atan2f(data->y, data->x) * 180.0f / 3.14159f;
@@ -230,6 +527,7 @@ int mag_read(mag_data_t *data)
     
     // 校准数据收集
     if (mag.state == MAG_STATE_CALIBRATING) {
+        float val[3] = { raw[0] * scale, raw[1] * scale, raw[2] * scale };
         for (int i = 0; i < 3; i++) {
             if (val[i] < mag.min_vals[i]) mag.min_vals[i] = val[i];
             if (val[i] > mag.max_vals[i]) mag.max_vals[i] = val[i];
@@ -260,6 +558,242 @@ int mag_read(mag_data_t *data)
  * 校准
  *============================================================================*/
 
+static int16_t mag_to_i16(float v)
+{
+    if (v > 32767.0f) return 32767;
+    if (v < -32767.0f) return -32767;
+    return (int16_t)(v + ((v >= 0.0f) ? 0.5f : -0.5f));
+}
+
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+/*
+ * v0.6.3: 椭球拟合 (代数最小二乘)
+ * 每个采用的样本累加 p = [x² y² z² 2xy 2xz 2yz 2x 2y 2z] 的 ΣppT / Σp (pᵀθ = 1);
+ * 空闲时对 9x9 法方程分步 Cholesky 分解, 再由 A、g 得到中心 c = -A⁻¹g,
+ * 归一化 M = A / (1 + cᵀAc), 软铁矩阵 W = r·M^½ (r 为平均半径, 不改变量纲)
+ */
+
+#define ELL_IDX(i, j)   ((i) * ((i) + 1) / 2 + (j))     // i >= j
+
+// 3x3 对称矩阵 Jacobi 特征分解: a = V·diag(d)·Vᵀ (a 被破坏)
+static void sym3_eigen(float a[3][3], float v[3][3], float d[3])
+{
+    static const uint8_t pq[3][2] = { {0, 1}, {0, 2}, {1, 2} };
+    
+    memset(v, 0, sizeof(float) * 9);
+    v[0][0] = v[1][1] = v[2][2] = 1.0f;
+    
+    for (int sweep = 0; sweep < 10; sweep++) {
+        float off = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+        float diag = a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+        if (off <= 1e-14f * diag) break;
+        
+        for (int r = 0; r < 3; r++) {
+            int p = pq[r][0], q = pq[r][1];
+            if (fabsf(a[p][q]) < 1e-20f) continue;
+            float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+            float t = 1.0f / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+            if (theta < 0.0f) t = -t;
+            float c = 1.0f / sqrtf(t * t + 1.0f), s = t * c;
+            
+            for (int k = 0; k < 3; k++) {
+                float akp = a[k][p], akq = a[k][q];
+                a[k][p] = c * akp - s * akq;
+                a[k][q] = s * akp + c * akq;
+            }
+            for (int k = 0; k < 3; k++) {
+                float apk = a[p][k], aqk = a[q][k];
+                a[p][k] = c * apk - s * aqk;
+                a[q][k] = s * apk + c * aqk;
+            }
+            for (int k = 0; k < 3; k++) {
+                float vkp = v[k][p], vkq = v[k][q];
+                v[k][p] = c * vkp - s * vkq;
+                v[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+    d[0] = a[0][0];
+    d[1] = a[1][1];
+    d[2] = a[2][2];
+}
+
+static void mag_ell_begin(void)
+{
+    memcpy(ell.l, ell.ata, sizeof(ell.l));
+    memcpy(ell.y, ell.atb, sizeof(ell.y));
+    ell.fresh = 0;
+    ell.k = 0;
+    ell.accepted = false;
+    ell.step = MAG_ELL_CHOL;
+}
+
+// 分解一列 (left-looking): L[i][k] = (a[i][k] - Σ L[i][m]·L[k][m]) / L[k][k]
+static void mag_ell_chol(void)
+{
+    uint8_t k = ell.k;
+    
+    for (uint8_t i = k; i < 9; i++) {
+        float s = ell.l[ELL_IDX(i, k)];
+        for (uint8_t m = 0; m < k; m++) {
+            s -= ell.l[ELL_IDX(i, m)] * ell.l[ELL_IDX(k, m)];
+        }
+        if (i == k) {
+            if (s <= 1e-6f * ell.l[ELL_IDX(k, k)]) {
+                ell.step = MAG_ELL_IDLE;    // 病态 (覆盖不足), 等待更多样本
+                return;
+            }
+            ell.l[ELL_IDX(k, k)] = sqrtf(s);
+        } else {
+            ell.l[ELL_IDX(i, k)] = s / ell.l[ELL_IDX(k, k)];
+        }
+    }
+    
+    if (++ell.k >= 9) ell.step = MAG_ELL_SOLVE;
+}
+
+static void mag_ell_solve(void)
+{
+    float *y = ell.y;
+    
+    for (int i = 0; i < 9; i++) {
+        float v = y[i];
+        for (int m = 0; m < i; m++) v -= ell.l[ELL_IDX(i, m)] * y[m];
+        y[i] = v / ell.l[ELL_IDX(i, i)];
+    }
+    for (int i = 8; i >= 0; i--) {
+        float v = y[i];
+        for (int m = i + 1; m < 9; m++) v -= ell.l[ELL_IDX(m, i)] * y[m];
+        y[i] = v / ell.l[ELL_IDX(i, i)];
+    }
+    ell.step = MAG_ELL_FINISH;
+}
+
+static void mag_ell_finish(void)
+{
+    const float *th = ell.y;
+    ell.step = MAG_ELL_IDLE;
+    
+    // 代数残差 Σ(pᵀθ - 1)² = θᵀ(ΣppT)θ - 2θᵀΣp + n (统计量为求解期间的最新值)
+    float sse = ell.n;
+    for (int i = 0; i < 9; i++) {
+        float row = 0.0f;
+        for (int j = 0; j < 9; j++) {
+            row += ell.ata[(i >= j) ? ELL_IDX(i, j) : ELL_IDX(j, i)] * th[j];
+        }
+        sse += th[i] * (row - 2.0f * ell.atb[i]);
+    }
+    if (sse > MAG_ELL_RMS_MAX * MAG_ELL_RMS_MAX * ell.n) return;
+    
+    float a[3][3] = {
+        { th[0], th[3], th[4] },
+        { th[3], th[1], th[5] },
+        { th[4], th[5], th[2] }
+    };
+    
+    // c = -A⁻¹g (伴随矩阵)
+    float adj[3][3];
+    adj[0][0] = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+    adj[0][1] = a[0][2]*a[2][1] - a[0][1]*a[2][2];
+    adj[0][2] = a[0][1]*a[1][2] - a[0][2]*a[1][1];
+    adj[1][1] = a[0][0]*a[2][2] - a[0][2]*a[2][0];
+    adj[1][2] = a[0][2]*a[1][0] - a[0][0]*a[1][2];
+    adj[2][2] = a[0][0]*a[1][1] - a[0][1]*a[1][0];
+    adj[1][0] = adj[0][1];
+    adj[2][0] = adj[0][2];
+    adj[2][1] = adj[1][2];
+    float det = a[0][0]*adj[0][0] + a[0][1]*adj[1][0] + a[0][2]*adj[2][0];
+    if (!(det > 1e-12f)) return;    // A 须正定
+    
+    float c[3];
+    for (int i = 0; i < 3; i++) {
+        c[i] = -(adj[i][0]*th[6] + adj[i][1]*th[7] + adj[i][2]*th[8]) / det;
+    }
+    float k = 1.0f;
+    for (int i = 0; i < 3; i++) {
+        k += c[i] * (a[i][0]*c[0] + a[i][1]*c[1] + a[i][2]*c[2]);
+    }
+    if (!(k > 0.0f)) return;
+    
+    float v[3][3], lam[3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) a[i][j] /= k;
+    }
+    sym3_eigen(a, v, lam);
+    
+    float lmin = lam[0], lmax = lam[0];
+    for (int i = 1; i < 3; i++) {
+        if (lam[i] < lmin) lmin = lam[i];
+        if (lam[i] > lmax) lmax = lam[i];
+    }
+    if (!(lmin > 0.0f) || lmax > MAG_ELL_AXIS_RATIO * MAG_ELL_AXIS_RATIO * lmin) return;
+    
+    // 平均半径 r = (r0·r1·r2)^(1/3), r_i = λ_i^(-1/2)
+    float r = powf(lam[0] * lam[1] * lam[2], -1.0f / 6.0f);
+    float field = r * MAG_ELL_NORM_UT;
+    if (field < MAG_ELL_FIELD_MIN || field > MAG_ELL_FIELD_MAX) return;
+    for (int i = 0; i < 3; i++) {
+        if (ell.hi[i] - ell.lo[i] < MAG_ELL_MIN_SPAN * r) return;
+    }
+    
+    // W = r·V·diag(√λ)·Vᵀ
+    int16_t w[9];
+    float s[3] = { r * sqrtf(lam[0]), r * sqrtf(lam[1]), r * sqrtf(lam[2]) };
+    for (int i = 0; i < 3; i++) {
+        int32_t row = 0;
+        for (int j = 0; j < 3; j++) {
+            float e = v[i][0]*s[0]*v[j][0] + v[i][1]*s[1]*v[j][1] + v[i][2]*s[2]*v[j][2];
+            w[3 * i + j] = mag_to_i16(e * MAG_SI_ONE);
+            row += (w[3 * i + j] < 0) ? -w[3 * i + j] : w[3 * i + j];
+        }
+        if (row > MAG_SI_ROW_MAX) return;
+    }
+    
+    int16_t off[3];
+    for (int i = 0; i < 3; i++) {
+        off[i] = mag_to_i16(ell.ref[i] + c[i] / ell.norm);
+    }
+    
+    bool changed = !mag.calibrated;
+    for (int i = 0; i < 3; i++) {
+        if (abs(off[i] - mag.offset[i]) > 2) changed = true;
+    }
+    for (int i = 0; i < 9; i++) {
+        if (abs(w[i] - mag.soft_iron[i]) > (MAG_SI_ONE >> 8)) changed = true;
+    }
+    
+    memcpy(mag.offset, off, sizeof(mag.offset));
+    memcpy(mag.soft_iron, w, sizeof(mag.soft_iron));
+    mag.field_ref = field;
+    mag.error_count = 0;
+    mag.calibrated = true;
+    ell.accepted = true;
+    if (changed) mag_calib_save();
+}
+#endif
+
+void mag_calib_process(void)
+{
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+    switch (ell.step) {
+        case MAG_ELL_IDLE:
+            if (mag.type == MAG_TYPE_NONE) return;
+            if (ell.n < MAG_ELL_MIN_SAMPLES || ell.fresh < MAG_ELL_SOLVE_EVERY) return;
+            mag_ell_begin();
+            break;
+        case MAG_ELL_CHOL:
+            mag_ell_chol();
+            break;
+        case MAG_ELL_SOLVE:
+            mag_ell_solve();
+            break;
+        case MAG_ELL_FINISH:
+            mag_ell_finish();
+            break;
+    }
+#endif
+}
+
 int mag_calibrate_start(void)
 {
     if (!mag.enabled) return -1;
@@ -269,6 +803,9 @@ int mag_calibrate_start(void)
         mag.max_vals[i] = -1000.0f;
     }
     mag.cal_samples = 0;
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+    mag_ell_reset();
+#endif
     mag.state = MAG_STATE_CALIBRATING;
     
     return 0;
@@ -279,25 +816,38 @@ int mag_calibrate_stop(void)
     if (mag.state != MAG_STATE_CALIBRATING) return -1;
     if (mag.cal_samples < 100) return -1;
     
-    // 计算硬铁偏移
-    for (int i = 0; i < 3; i++) {
-        mag.hard_iron[i] = (mag.max_vals[i] + mag.min_vals[i]) / 2.0f;
+#if defined(USE_MAG_ELLIPSOID) && USE_MAG_ELLIPSOID
+    // 手动校准结束: 立即完整求解一次椭球
+    if (ell.n >= MAG_ELL_MIN_SAMPLES) {
+        mag_ell_begin();
+        while (ell.step != MAG_ELL_IDLE) mag_calib_process();
+        if (ell.accepted) {
+            mag.state = MAG_STATE_READY;
+            return 0;
+        }
     }
+#endif
     
-    // 计算缩放
+    // 计算硬铁偏移 / 每轴缩放 (min/max)
+    float lsb = mag_lsb_ut();
     float range[3];
     for (int i = 0; i < 3; i++) {
         range[i] = (mag.max_vals[i] - mag.min_vals[i]) / 2.0f;
     }
     float avg_range = (range[0] + range[1] + range[2]) / 3.0f;
     
+    mag_calib_identity();
     for (int i = 0; i < 3; i++) {
-        mag.scale[i] = avg_range / range[i];
+        mag.offset[i] = mag_to_i16((mag.max_vals[i] + mag.min_vals[i]) / 2.0f / lsb);
+        float s = (range[i] > 0.0f) ? avg_range / range[i] : 1.0f;
+        if (s > 1.99f) s = 1.99f;
+        mag.soft_iron[4 * i] = mag_to_i16(s * MAG_SI_ONE);
     }
     
     mag.field_ref = avg_range;
     mag.calibrated = true;
     mag.state = MAG_STATE_READY;
+    mag_calib_save();
     
     return 0;
 }
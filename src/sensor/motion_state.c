@@ -0,0 +1,103 @@
+/**
+ * @file motion_state.c
+ * @brief 共享运动状态估计 / Shared motion-state estimator
+ *
+ * v0.6.3: 计时按样本计数 (批量模式下同一批样本的系统时间相同), 阈值比较全部用平方,
+ * 每样本无开方
+ */
+
+#include "motion_state.h"
+#include "config.h"
+#include <string.h>
+
+#define MOTION_REST_SAMPLES     ((uint32_t)MOTION_REST_MS * SENSOR_ODR_HZ / 1000)
+#define MOTION_EXIT_SCALE       1.5f    // 离开安静状态时的阈值放宽倍数
+
+static struct {
+    float mean[3];
+    float var[3];
+    uint32_t still_samples;     // 连续安静样本数
+    uint32_t rest_count;        // REST 计时 (样本), 不安静时 2 倍回退
+    uint8_t rate_div;           // 样本间隔 = rate_div 个 SENSOR_ODR_HZ 周期
+    motion_level_t level;
+} ms;
+
+void motion_state_init(void)
+{
+    memset(&ms, 0, sizeof(ms));
+    ms.level = MOTION_LEVEL_MOTION;
+    ms.rate_div = 1;
+}
+
+void motion_state_set_rate_div(uint8_t div)
+{
+    ms.rate_div = div ? div : 1;
+}
+
+void motion_state_update(const float gyro[3], const float accel[3])
+{
+    float mean2 = 0.0f, var_sum = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = gyro[i] - ms.mean[i];
+        ms.mean[i] += MOTION_EWMA_ALPHA * d;
+        ms.var[i] = (1.0f - MOTION_EWMA_ALPHA) * (ms.var[i] + MOTION_EWMA_ALPHA * d * d);
+        mean2 += ms.mean[i] * ms.mean[i];
+        var_sum += ms.var[i];
+    }
+    
+    // 已安静时用放宽的阈值 (滞后)
+    float k = (ms.level != MOTION_LEVEL_MOTION) ? MOTION_EXIT_SCALE : 1.0f;
+    float gyro_th = MOTION_GYRO_TH * k;
+    float accel_th = MOTION_ACCEL_TH * k;
+    float a2 = accel[0]*accel[0] + accel[1]*accel[1] + accel[2]*accel[2];
+    
+    bool quiet = mean2 < gyro_th * gyro_th &&
+                 var_sum < MOTION_GYRO_VAR_TH * k * k &&
+                 a2 > (1.0f - accel_th) * (1.0f - accel_th) &&
+                 a2 < (1.0f + accel_th) * (1.0f + accel_th);
+    
+    if (quiet) {
+        // 计数单位是 SENSOR_ODR_HZ 周期, 降 ODR 时每样本记 rate_div 个
+        if (ms.still_samples < UINT32_MAX - ms.rate_div) ms.still_samples += ms.rate_div;
+        ms.rest_count += ms.rate_div;
+        if (ms.rest_count > MOTION_REST_SAMPLES) ms.rest_count = MOTION_REST_SAMPLES;
+        if (ms.rest_count >= MOTION_REST_SAMPLES) {
+            ms.level = MOTION_LEVEL_REST;
+        } else if (ms.level == MOTION_LEVEL_MOTION) {
+            ms.level = MOTION_LEVEL_STILL;
+        }
+    } else {
+        ms.still_samples = 0;
+        uint32_t back = 2u * ms.rate_div;
+        ms.rest_count = (ms.rest_count > back) ? ms.rest_count - back : 0;
+        // REST 计时回退到 0 前保持 REST, 否则立即回到 MOTION
+        if (ms.level != MOTION_LEVEL_REST || ms.rest_count == 0) {
+            ms.level = MOTION_LEVEL_MOTION;
+        }
+    }
+}
+
+motion_level_t motion_state_level(void)
+{
+    return ms.level;
+}
+
+bool motion_state_is_still(void)
+{
+    return ms.still_samples > 0;
+}
+
+bool motion_state_is_rest(void)
+{
+    return ms.level == MOTION_LEVEL_REST;
+}
+
+uint32_t motion_state_still_ms(void)
+{
+    return (uint32_t)((uint64_t)ms.still_samples * 1000 / SENSOR_ODR_HZ);
+}
+
+void motion_state_get_gyro_mean(float mean[3])
+{
+    memcpy(mean, ms.mean, sizeof(ms.mean));
+}
@@ -0,0 +1,235 @@
+/**
+ * @file selftest.c
+ * @brief v0.6.3 Tracker 器件特性测量 (USE_SELFTEST)
+ *
+ * Allan 偏差按层流式计算: 第 k 层的簇均值由第 k-1 层相邻两个簇均值平均得到,
+ * 每层只保留未配对的半簇、上一个簇均值和差分平方和; 每样本平均更新 2 层
+ */
+
+#include "selftest.h"
+#include "imu_interface.h"
+#include "hal.h"
+#include "fast_math.h"
+#include <string.h>
+
+#if defined(USE_SELFTEST) && USE_SELFTEST
+
+#define RAD2DEG     57.29577951f
+
+typedef struct {
+    uint8_t state;
+    uint8_t profile;
+    uint16_t duration_s;
+    bool started;               // 已收到首个样本
+    uint32_t t_first_us;
+    uint32_t t_last_us;
+    uint32_t samples;
+    float max_rate2;            // (rad/s)^2
+    uint8_t imu_type;
+    uint16_t odr_hz;
+    uint16_t range_dps;
+    float temp_start_c;
+    float temp_end_c;
+
+    // Allan 偏差: 每层的未配对半簇 / 上一簇均值 / 差分平方和 (长时间累加用 double)
+    uint32_t has_half;          // 按层的位
+    uint32_t has_prev;
+    float half[SELFTEST_ADEV_LEVELS][3];
+    float prev[SELFTEST_ADEV_LEVELS][3];
+    double acc[SELFTEST_ADEV_LEVELS][3];
+    uint32_t diffs[SELFTEST_ADEV_LEVELS];
+
+    selftest_timing_t timing[SELFTEST_T_COUNT];
+} selftest_ctx_t;
+
+static selftest_ctx_t st;
+
+static float safe_sqrt(float x)
+{
+    return (x > 0.0f) ? fm_sqrt(x) : 0.0f;
+}
+
+static float read_temp(void)
+{
+    float t;
+    return imu_get_temperature(&t) ? t : 0.0f;
+}
+
+void selftest_start(uint16_t duration_s, uint8_t profile)
+{
+    memset(&st, 0, sizeof(st));
+    if (duration_s == 0) duration_s = SELFTEST_DEFAULT_S;
+    if (duration_s > SELFTEST_MAX_S) duration_s = SELFTEST_MAX_S;  // hal_micros 约 71 分钟回绕
+    st.duration_s = duration_s;
+    st.profile = profile;
+    for (int i = 0; i < SELFTEST_T_COUNT; i++) {
+        st.timing[i].min_us = UINT32_MAX;
+    }
+    // 先切到固定的功耗档, 首个样本记录的 ODR 即整个测量期间的 ODR
+    if (profile != SELFTEST_PROFILE_ANY) {
+        imu_set_power_profile((imu_power_profile_t)profile);
+    }
+    st.state = SELFTEST_RUNNING;
+}
+
+void selftest_stop(void)
+{
+    if (st.state != SELFTEST_RUNNING) return;
+    st.temp_end_c = read_temp();
+    st.state = SELFTEST_DONE;
+}
+
+bool selftest_running(void)
+{
+    return st.state == SELFTEST_RUNNING;
+}
+
+int selftest_pinned_profile(void)
+{
+    if (st.state != SELFTEST_RUNNING || st.profile == SELFTEST_PROFILE_ANY) return -1;
+    return st.profile;
+}
+
+static void adev_add(const float y[3])
+{
+    float v[3] = { y[0], y[1], y[2] };
+
+    for (uint8_t k = 0; k < SELFTEST_ADEV_LEVELS; k++) {
+        uint32_t bit = 1UL << k;
+
+        if (st.has_prev & bit) {
+            for (int i = 0; i < 3; i++) {
+                float d = v[i] - st.prev[k][i];
+                st.acc[k][i] += (double)(d * d);
+            }
+            st.diffs[k]++;
+        }
+        memcpy(st.prev[k], v, sizeof(v));
+        st.has_prev |= bit;
+
+        // 与本层上一个簇配对成上一层的簇
+        if (!(st.has_half & bit)) {
+            memcpy(st.half[k], v, sizeof(v));
+            st.has_half |= bit;
+            return;
+        }
+        st.has_half &= ~bit;
+        for (int i = 0; i < 3; i++) {
+            v[i] = 0.5f * (st.half[k][i] + v[i]);
+        }
+    }
+}
+
+void selftest_feed(const float gyro[3])
+{
+    if (st.state != SELFTEST_RUNNING) return;
+
+    uint32_t now_us = hal_micros();
+    if (!st.started) {
+        st.started = true;
+        st.t_first_us = now_us;
+        st.imu_type = imu_get_type();
+        st.odr_hz = imu_get_odr_hz();
+        st.range_dps = imu_get_gyro_range_dps();
+        st.temp_start_c = read_temp();
+    }
+    st.t_last_us = now_us;
+    st.samples++;
+
+    float r2 = gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2];
+    if (r2 > st.max_rate2) st.max_rate2 = r2;
+
+    adev_add(gyro);
+
+    if (now_us - st.t_first_us >= (uint32_t)st.duration_s * 1000000UL) {
+        selftest_stop();
+    }
+}
+
+void selftest_time(selftest_timer_t id, uint32_t us, uint16_t items)
+{
+    if (st.state != SELFTEST_RUNNING || id >= SELFTEST_T_COUNT) return;
+
+    selftest_timing_t *t = &st.timing[id];
+    t->count++;
+    t->items += items;
+    t->total_us += us;
+    if (us < t->min_us) t->min_us = us;
+    if (us > t->max_us) t->max_us = us;
+}
+
+static uint8_t adev_levels(void)
+{
+    uint8_t n = 0;
+    while (n < SELFTEST_ADEV_LEVELS && st.diffs[n] > 0) n++;
+    return n;
+}
+
+static uint8_t build_status(uint8_t *buf)
+{
+    selftest_status_t s;
+
+    s.state = st.state;
+    s.imu_type = st.imu_type;
+    s.odr_hz = st.odr_hz;
+    s.gyro_range_dps = st.range_dps;
+    s.duration_s = st.duration_s;
+    s.samples = st.samples;
+    s.elapsed_us = st.t_last_us - st.t_first_us;
+    s.max_rate_dps = safe_sqrt(st.max_rate2) * RAD2DEG;
+    s.temp_start_c = st.temp_start_c;
+    s.temp_end_c = (st.state == SELFTEST_DONE) ? st.temp_end_c : read_temp();
+    s.adev_levels = adev_levels();
+    memcpy(buf, &s, sizeof(s));
+    return sizeof(s);
+}
+
+uint8_t selftest_command(const uint8_t *data, uint8_t len, uint8_t *buf)
+{
+    uint8_t sub = (len > 1) ? data[1] : SELFTEST_SUB_STATUS;
+
+    buf[0] = sub;
+    if (sub == SELFTEST_SUB_START) {
+        uint16_t dur = (len > 3) ? (uint16_t)(data[2] | (data[3] << 8)) : 0;
+        uint8_t profile = (len > 4) ? data[4] : SELFTEST_PROFILE_ANY;
+        if (profile != SELFTEST_PROFILE_ANY && profile > IMU_PROFILE_LOW) {
+            buf[0] = 0xFF;
+            return 1;
+        }
+        selftest_start(dur, profile);
+        return 1 + build_status(&buf[1]);
+    }
+    if (sub == SELFTEST_SUB_STOP) {
+        selftest_stop();
+        return 1 + build_status(&buf[1]);
+    }
+    if (sub == SELFTEST_SUB_STATUS) {
+        return 1 + build_status(&buf[1]);
+    }
+    if (sub >= SELFTEST_SUB_TIMING && sub < SELFTEST_SUB_TIMING + SELFTEST_T_COUNT) {
+        selftest_timing_t t = st.timing[sub - SELFTEST_SUB_TIMING];
+        if (t.count == 0) t.min_us = 0;
+        memcpy(&buf[1], &t, sizeof(t));
+        return 1 + sizeof(t);
+    }
+    if (sub >= SELFTEST_SUB_ADEV && sub < SELFTEST_SUB_ADEV + SELFTEST_ADEV_LEVELS) {
+        uint8_t k = sub - SELFTEST_SUB_ADEV;
+        selftest_adev_t a;
+        float tau0 = st.odr_hz ? 1.0f / st.odr_hz : 0.0f;
+
+        a.clusters = st.diffs[k];
+        a.tau_s = tau0 * (float)(1UL << k);
+        for (int i = 0; i < 3; i++) {
+            // AVAR(τ) = Σ(ȳ[j+1] - ȳ[j])² / (2(M-1))
+            float avar = a.clusters ? (float)(st.acc[k][i] / (2.0 * a.clusters)) : 0.0f;
+            a.adev_dps[i] = safe_sqrt(avar) * RAD2DEG;
+        }
+        memcpy(&buf[1], &a, sizeof(a));
+        return 1 + sizeof(a);
+    }
+
+    buf[0] = 0xFF;
+    return 1;
+}
+
+#endif /* USE_SELFTEST */
@@ -1,63 +1,69 @@
 /**
  * @file sensor_dma.c
  * @brief DMA + 中断优化的传感器读取模块
- * 
+ *
  * 目标: 传感器延迟 < 3ms
- * 
+ *
  * 优化方案:
  * 1. SPI DMA 双缓冲传输
  * 2. 中断驱动数据就绪
  * 3. 零拷贝数据处理
  * 4. 预取下一帧
+ *
+ * v0.6.3: 私有 DMA 缓冲区和 latest_data 中转已移除, 改用 hal_dma.c 的
+ * 乒乓环; 突发寄存器/长度/解码函数取自 imu_dma_burst_get (按检测到的型号),
+ * 直接在 DMA 缓冲区上解码到调用者的数组, 解码完成后槽位立即归还 DMA
+ * (每样本少两次拷贝)
  */
 
 #include "hal.h"
 #include "board.h"
+#include "imu_interface.h"
+#include "sensor_dma.h"
 #include <string.h>
 
 /*============================================================================
  * 配置
  *============================================================================*/
 
-#define DMA_BUFFER_SIZE     32          // 足够容纳 IMU 数据
-#define DMA_EXPECTED_LEN    15          // 预期数据长度: cmd(1) + accel(6) + gyro(6) + temp(2)
-#define DOUBLE_BUFFER       1           // 启用双缓冲
+#define SENSOR_DMA_TEMP_DEFAULT     25.0f   // 型号突发不含温度时的输出
 
 /*============================================================================
- * DMA 缓冲区 (双缓冲)
+ * 状态
  *============================================================================*/
 
-static volatile uint8_t dma_buffer[2][DMA_BUFFER_SIZE] __attribute__((aligned(4)));
-static volatile uint8_t current_buffer = 0;
-static volatile bool data_ready = false;
 static volatile uint32_t data_timestamp = 0;
 
-// 处理后的传感器数据
-typedef struct {
-    float gyro[3];
-    float accel[3];
-    float temp;
-    uint32_t timestamp;
-    bool valid;
-} sensor_data_t;
-
-static volatile sensor_data_t latest_data = {0};
+// 当前型号的突发描述 (decode == NULL 表示乒乓环尚未启用)
+static imu_dma_burst_t burst;
 
 // 回调函数
 static void (*data_callback)(const sensor_data_t *data) = NULL;
 
 /*============================================================================
- * CH59X DMA 寄存器
+ * 数据解析 (零拷贝)
  *============================================================================*/
 
-// SPI0 DMA 配置 (CH592)
-#define R32_SPI0_DMA_BEG    (*((volatile uint32_t *)0x40004040))
-#define R32_SPI0_DMA_END    (*((volatile uint32_t *)0x40004044))
-#define R8_SPI0_DMA_CFG     (*((volatile uint8_t *)0x40004048))
+static int decode_frame(const hal_dma_frame_t *frame, float gyro[3], float accel[3], float *temp)
+{
+    // 驱动直接读 DMA 缓冲区 (含偏置/温度补偿/轴映射), 芯片温度随突发更新
+    if (burst.decode(frame->data, frame->len, gyro, accel) != 0) {
+        return -1;
+    }
+    if (temp && !imu_get_temperature(temp)) {
+        *temp = SENSOR_DMA_TEMP_DEFAULT;
+    }
+    return 0;
+}
 
-#define RB_SPI_DMA_ENABLE   0x01
-#define RB_SPI_DMA_LOOP     0x04
-#define RB_SPI_DMA_END_IE   0x10
+// I2C 总线或型号不支持突发读取时不启用乒乓环, sensor_dma_data_ready 恒为 false
+static void ring_setup(void)
+{
+    if (imu_dma_burst_get(&burst) != 0 ||
+        hal_spi_dma_ring_init(PIN_SPI_CS, burst.cmd, burst.len, sensor_dma_complete_handler) != 0) {
+        memset(&burst, 0, sizeof(burst));
+    }
+}
 
 /*============================================================================
  * 中断处理
@@ -68,28 +74,34 @@ void sensor_dma_int1_handler(void)
 {
     // 记录时间戳
     data_timestamp = hal_get_tick_us();
-    
+
+    // 首个数据就绪沿到来时 IMU 已完成初始化, 此时按检测到的型号配置乒乓环
+    if (!burst.decode) {
+        ring_setup();
+    }
+
     // 触发 DMA 读取
     sensor_dma_start_transfer();
 }
 
-// DMA 传输完成中断
+// DMA 传输完成中断 (由 hal_dma 乒乓环在 SPI0 中断中回调)
 void sensor_dma_complete_handler(void)
 {
-    // P0-19: 安全的缓冲区切换 - 使用位操作确保只有0或1
-    uint8_t completed_buffer = current_buffer & 0x01;
-    current_buffer = (current_buffer + 1) & 0x01;  // 等价于 1 - current_buffer，但更安全
-    
-    // 标记数据就绪
-    data_ready = true;
-    
-    // 解析数据
-    parse_sensor_data(completed_buffer);
-    
-    // 预取下一帧 (如果使用双缓冲)
-#if DOUBLE_BUFFER
-    sensor_dma_prefetch_next();
-#endif
+    sensor_dma_update_stats();
+
+    // 注册了回调时在中断中直接解码并交给上层, 槽位随即归还
+    if (data_callback) {
+        const hal_dma_frame_t *frame = hal_spi_dma_ring_acquire();
+        if (frame) {
+            sensor_data_t data;
+            int err = decode_frame(frame, data.gyro, data.accel, &data.temp);
+            data.timestamp = frame->timestamp_us;
+            hal_spi_dma_ring_release(frame);
+            if (err == 0) {
+                data_callback(&data);
+            }
+        }
+    }
 }
 
 /*============================================================================
@@ -98,196 +110,92 @@ void sensor_dma_complete_handler(void)
 
 void sensor_dma_init(void)
 {
-    // 清空缓冲区
-    memset((void *)dma_buffer, 0, sizeof(dma_buffer));
-    
-    // 配置 SPI DMA
-    R32_SPI0_DMA_BEG = (uint32_t)dma_buffer[0];
-    R32_SPI0_DMA_END = (uint32_t)dma_buffer[0] + 14;  // 14 bytes: 6+6+2
-    R8_SPI0_DMA_CFG = RB_SPI_DMA_ENABLE | RB_SPI_DMA_END_IE;
-    
+    hal_dma_init();
+    memset(&burst, 0, sizeof(burst));
+
     // 配置 IMU INT1 中断
-    hal_gpio_config(PIN_IMU_INT1_PORT, PIN_IMU_INT1, GPIO_MODE_INPUT_PULLDOWN);
-    hal_gpio_int_enable(PIN_IMU_INT1_PORT, PIN_IMU_INT1, GPIO_INT_RISING);
-    
-    current_buffer = 0;
-    data_ready = false;
+    hal_gpio_config(PIN_IMU_INT1, HAL_GPIO_INPUT_PULLDOWN);
+    hal_gpio_set_interrupt(PIN_IMU_INT1, HAL_GPIO_INT_RISING, sensor_dma_int1_handler);
 }
 
 void sensor_dma_start_transfer(void)
 {
-    // 设置当前缓冲区
-    uint8_t *buf = (uint8_t *)dma_buffer[current_buffer];
-    
-    // 发送读取命令 (首字节是寄存器地址 | 0x80)
-    buf[0] = 0x80 | 0x1F;  // 加速度数据起始地址
-    
-    // 配置 DMA 目标地址
-    R32_SPI0_DMA_BEG = (uint32_t)buf;
-    R32_SPI0_DMA_END = (uint32_t)buf + 14;
-    
-    // CS 拉低
-    hal_gpio_write(GPIOA, PIN_SPI_CS, 0);
-    
-    // 启动 DMA
-    R8_SPI0_DMA_CFG |= RB_SPI_DMA_ENABLE;
+    hal_spi_dma_ring_kick(data_timestamp);
 }
 
 void sensor_dma_prefetch_next(void)
 {
-    // 预配置下一帧的 DMA
-    uint8_t next_buffer = 1 - current_buffer;
-    uint8_t *buf = (uint8_t *)dma_buffer[next_buffer];
-    buf[0] = 0x80 | 0x1F;
-}
-
-/*============================================================================
- * 数据解析 (零拷贝)
- *============================================================================*/
-
-// IMU 缩放因子
-static const float ACCEL_SCALE = 9.81f / 2048.0f;     // ±16g
-static const float GYRO_SCALE = 0.001065264f;          // ±2000dps -> rad/s
-static const float TEMP_SCALE = 1.0f / 132.48f;
-static const float TEMP_OFFSET = 25.0f;
-
-static void parse_sensor_data(uint8_t buffer_idx)
-{
-    // P0-7 & P0-19: 边界检查 - 确保buffer_idx有效
-    if (buffer_idx > 1) {
-        buffer_idx = 0;  // 安全回退
-    }
-    
-    const uint8_t *buf = (const uint8_t *)dma_buffer[buffer_idx];
-    
-    // 直接从 DMA 缓冲区解析 (零拷贝)
-    // 数据格式: [cmd][ax_h][ax_l][ay_h][ay_l][az_h][az_l][gx_h][gx_l][gy_h][gy_l][gz_h][gz_l][t_h][t_l]
-    // P0-7: 验证缓冲区有效性 (DMA配置为传输14字节，需要索引0-14)
-    // 注意：DMA传输在中断中完成，到达这里时数据应该已经有效
-    
-    int16_t raw_accel[3], raw_gyro[3], raw_temp;
-    
-    raw_accel[0] = (int16_t)(buf[1] << 8 | buf[2]);
-    raw_accel[1] = (int16_t)(buf[3] << 8 | buf[4]);
-    raw_accel[2] = (int16_t)(buf[5] << 8 | buf[6]);
-    raw_gyro[0] = (int16_t)(buf[7] << 8 | buf[8]);
-    raw_gyro[1] = (int16_t)(buf[9] << 8 | buf[10]);
-    raw_gyro[2] = (int16_t)(buf[11] << 8 | buf[12]);
-    raw_temp = (int16_t)(buf[13] << 8 | buf[14]);
-    
-    // 转换为物理量 (使用内联计算)
-    sensor_data_t *data = (sensor_data_t *)&latest_data;
-    data->accel[0] = raw_accel[0] * ACCEL_SCALE;
-    data->accel[1] = raw_accel[1] * ACCEL_SCALE;
-    data->accel[2] = raw_accel[2] * ACCEL_SCALE;
-    data->gyro[0] = raw_gyro[0] * GYRO_SCALE;
-    data->gyro[1] = raw_gyro[1] * GYRO_SCALE;
-    data->gyro[2] = raw_gyro[2] * GYRO_SCALE;
-    data->temp = raw_temp * TEMP_SCALE + TEMP_OFFSET;
-    data->timestamp = data_timestamp;
-    data->valid = true;
-    
-    // 调用回调 (如果注册)
-    if (data_callback) {
-        data_callback(data);
-    }
+    // 乒乓环在 release 时即可接收下一帧, 无需额外预配置
 }
 
 /*============================================================================
  * 高级功能: 批量读取
  *============================================================================*/
 
-#define BATCH_SIZE      4       // 批量读取帧数
-
-typedef struct {
-    sensor_data_t samples[BATCH_SIZE];
-    uint8_t count;
-    uint32_t start_time;
-} sensor_batch_t;
-
-static sensor_batch_t batch_data = {0};
-
 int sensor_dma_read_batch(sensor_batch_t *batch)
 {
     if (!batch) return -1;
-    
+
     batch->start_time = hal_get_tick_us();
+    batch->period_us = (uint16_t)(1000000UL / SENSOR_ODR_HZ);
     batch->count = 0;
-    
-    // 配置 FIFO 批量读取
-    uint8_t fifo_cmd[2] = {0x80 | 0x3F, 0x00};  // FIFO 数据寄存器
-    uint8_t fifo_data[BATCH_SIZE * 12];
-    
-    // 单次 DMA 传输读取多帧
-    hal_gpio_write(GPIOA, PIN_SPI_CS, 0);
-    hal_spi_transfer(fifo_cmd, fifo_data, 2 + BATCH_SIZE * 12);
-    hal_gpio_write(GPIOA, PIN_SPI_CS, 1);
-    
-    // 解析多帧数据
-    for (int i = 0; i < BATCH_SIZE; i++) {
-        const uint8_t *frame = &fifo_data[2 + i * 12];
-        
-        int16_t raw_accel[3], raw_gyro[3];
-        raw_accel[0] = (int16_t)(frame[0] << 8 | frame[1]);
-        raw_accel[1] = (int16_t)(frame[2] << 8 | frame[3]);
-        raw_accel[2] = (int16_t)(frame[4] << 8 | frame[5]);
-        raw_gyro[0] = (int16_t)(frame[6] << 8 | frame[7]);
-        raw_gyro[1] = (int16_t)(frame[8] << 8 | frame[9]);
-        raw_gyro[2] = (int16_t)(frame[10] << 8 | frame[11]);
-        
-        batch->samples[i].accel[0] = raw_accel[0] * ACCEL_SCALE;
-        batch->samples[i].accel[1] = raw_accel[1] * ACCEL_SCALE;
-        batch->samples[i].accel[2] = raw_accel[2] * ACCEL_SCALE;
-        batch->samples[i].gyro[0] = raw_gyro[0] * GYRO_SCALE;
-        batch->samples[i].gyro[1] = raw_gyro[1] * GYRO_SCALE;
-        batch->samples[i].gyro[2] = raw_gyro[2] * GYRO_SCALE;
-        batch->samples[i].timestamp = batch->start_time + i * 5000;  // 5ms 间隔
-        batch->samples[i].valid = true;
-        batch->count++;
+
+    // v0.6.3: 复用 imu_interface 的 FIFO 突发读取, 原始计数直接写入批次;
+    // 单次突发最多 IMU_FIFO_MAX_BATCH 帧, 批次更深时读到 FIFO 空为止
+    while (batch->count < SENSOR_BATCH_DEPTH) {
+        uint8_t room = SENSOR_BATCH_DEPTH - batch->count;
+        int16_t g[IMU_FIFO_MAX_BATCH][3], a[IMU_FIFO_MAX_BATCH][3];
+        int n = imu_fifo_read_raw(g, a, NULL, room < IMU_FIFO_MAX_BATCH ? room : IMU_FIFO_MAX_BATCH);
+        if (n < 0 && batch->count == 0) {
+            return n;
+        }
+        if (n <= 0) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            sensor_raw_t *d = &batch->data[batch->count++];
+            memcpy(d->gyro, g[i], sizeof(d->gyro));
+            memcpy(d->accel, a[i], sizeof(d->accel));
+        }
+        if (n < IMU_FIFO_MAX_BATCH) {
+            break;
+        }
     }
-    
+
     return batch->count;
 }
 
+uint32_t sensor_batch_get(const sensor_batch_t *batch, uint8_t i, float gyro[3], float accel[3])
+{
+    const sensor_raw_t *d = &batch->data[i];
+    imu_raw_to_si(d->gyro, d->accel, gyro, accel);
+    return batch->start_time - (uint32_t)(batch->count - 1 - i) * batch->period_us;
+}
+
 /*============================================================================
  * 公共接口
  *============================================================================*/
 
 bool sensor_dma_data_ready(void)
 {
-    return data_ready;
+    return hal_spi_dma_ring_pending();
 }
 
 int sensor_dma_get_data(float gyro[3], float accel[3], float *temp)
 {
-    if (!data_ready) return -1;
-    
-    // 复制最新数据
-    const sensor_data_t *data = (const sensor_data_t *)&latest_data;
-    
-    if (gyro) {
-        gyro[0] = data->gyro[0];
-        gyro[1] = data->gyro[1];
-        gyro[2] = data->gyro[2];
-    }
-    
-    if (accel) {
-        accel[0] = data->accel[0];
-        accel[1] = data->accel[1];
-        accel[2] = data->accel[2];
-    }
-    
-    if (temp) {
-        *temp = data->temp;
-    }
-    
-    data_ready = false;
-    return 0;
+    if (!gyro || !accel) return -1;
+
+    const hal_dma_frame_t *frame = hal_spi_dma_ring_acquire();
+    if (!frame) return -1;
+
+    int err = decode_frame(frame, gyro, accel, temp);
+    hal_spi_dma_ring_release(frame);
+    return err;
 }
 
 uint32_t sensor_dma_get_timestamp(void)
 {
-    return latest_data.timestamp;
+    return data_timestamp;
 }
 
 uint32_t sensor_dma_get_latency_us(void)
@@ -317,17 +225,18 @@ static sensor_dma_stats_t stats = {0};
 void sensor_dma_update_stats(void)
 {
     stats.total_reads++;
-    
+    stats.dma_reads++;
+
     uint32_t latency = sensor_dma_get_latency_us();
-    
+
     if (latency > stats.max_latency_us) {
         stats.max_latency_us = latency;
     }
-    
+
     // 移动平均
     stats.avg_latency_us = (stats.avg_latency_us * 15 + latency) / 16;
-    
-    // 超时检测 (>3ms)
+
+    // 超时检测 (>3ms); 槽位未归还导致的丢帧见 hal_spi_dma_ring_overruns()
     if (latency > 3000) {
         stats.overruns++;
     }
@@ -8,14 +8,29 @@
  * 1. IMU 中断触发数据就绪
  * 2. DMA 传输读取数据
  * 3. 后台处理融合算法
+ *
+ * v0.6.3: 单样本模式下数据就绪中断启动 hal_dma 乒乓环的突发读取 (寄存器/长度/
+ * 解码函数取自 imu_dma_burst_get), 完成中断在 DMA 缓冲区上原地解码后写入样本 FIFO
+ * 并归还槽位; I2C 总线时退回主循环同步读取.
+ * 批量模式仍在主循环突发读取 IMU FIFO (长度取决于 FIFO 计数)
  */
 
 #include "board.h"
+#include "config.h"
 #include "hal.h"
 #include "imu_interface.h"
+#include "sensor_optimized.h"
 #include "vqf_ultra.h"
+#include "selftest.h"
 #include <string.h>
 
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
 /*============================================================================
  * 配置
  *============================================================================*/
@@ -23,6 +38,25 @@
 #define SENSOR_FIFO_SIZE        16      // 数据 FIFO 深度
 #define SENSOR_READ_TIMEOUT_US  2000    // 读取超时 2ms
 
+// v0.6.3: 批量模式
+#ifndef SENSOR_FIFO_WATERMARK
+#define SENSOR_FIFO_WATERMARK   2       // 水位 (帧)
+#endif
+#define SENSOR_SAMPLE_PERIOD_US (1000000UL / SENSOR_ODR_HZ)
+// 水位中断丢失时的兜底轮询间隔 (两个水位周期)
+#define SENSOR_BATCH_POLL_US    (2UL * SENSOR_FIFO_WATERMARK * SENSOR_SAMPLE_PERIOD_US)
+
+// v0.6.3: IMU 时间戳标定窗口 - 每 ~1s 用水位中断时刻 (MCU 晶振) 校正 IMU 时钟速率
+#define SENSOR_TS_CAL_WINDOW_US 1000000UL
+#define SENSOR_TS_CAL_MAX_US    (4UL * SENSOR_TS_CAL_WINDOW_US)
+
+// v0.6.3: 数据就绪/水位沿由 TMR1 硬件捕获 (需要 INT1 接到 PA10)
+#if defined(USE_HW_TIMESTAMP) && USE_HW_TIMESTAMP && HW_TS_IMU_CAPTURE
+#define SENSOR_HW_TS            1
+#else
+#define SENSOR_HW_TS            0
+#endif
+
 /*============================================================================
  * 数据结构
  *============================================================================*/
@@ -31,7 +65,9 @@ typedef struct {
     float gyro[3];
     float accel[3];
     uint32_t timestamp_us;
+    float dt;                   // v0.6.3: 与上一帧的实际间隔 [s], 0 = 未知
     bool valid;
+    bool accel_fresh;           // v0.6.3: false = 加速度沿用上一帧 (USE_IMU_MIXED_ODR)
 } sensor_sample_t;
 
 typedef struct {
@@ -45,18 +81,43 @@ typedef struct {
     volatile bool reading;
     volatile uint32_t last_read_us;
     volatile uint32_t read_latency_us;
+#if SENSOR_HW_TS
+    volatile uint32_t edge_period_ns;   // 单样本模式: 相邻数据就绪沿的间隔 (0 = 未知)
+#endif
     
     // 统计
     uint32_t total_samples;
     uint32_t dropped_samples;
     uint32_t max_latency_us;
     float avg_latency_us;
+    
+    // v0.6.3: 批量模式状态
+    bool batch_active;
+    bool ring_active;                   // 单样本模式: 乒乓环已按当前型号配置
+    volatile uint32_t irq_time_us;      // 最近一次水位中断时刻
+    uint32_t last_burst_us;
+    uint32_t burst_count;
+    
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    // v0.6.3: IMU FIFO 时间戳 → MCU 时间
+    float ts_nominal_us;        // 标称 us/计数 (0 = IMU 不提供时间戳)
+    float ts_us_per_tick;       // 标定后的 us/计数
+    uint32_t ts_last_tick;
+    bool ts_have_last;
+    uint32_t ts_ref_tick;       // 标定参考点 (水位帧时间戳, 中断时刻)
+    uint32_t ts_ref_us;
+    bool ts_ref_valid;
+#endif
 } sensor_fifo_t;
 
 static sensor_fifo_t sensor_fifo = {0};
+static float last_sample_dt = 0.0f;
+static bool last_accel_fresh = true;
 
-// DMA 读取缓冲区
-static uint8_t imu_dma_buf[16] __attribute__((aligned(4)));
+static imu_dma_burst_t dma_burst;
+
+static void imu_dma_complete_callback(void);
+static bool dma_ring_setup(void);
 
 /*============================================================================
  * IMU 数据就绪中断
@@ -64,79 +125,140 @@ static uint8_t imu_dma_buf[16] __attribute__((aligned(4)));
 
 static void imu_data_ready_callback(void)
 {
+#if SENSOR_HW_TS
+    // v0.6.3: 沿时刻由捕获计数回推, 时间戳不再包含中断响应延迟
+    uint32_t period_ns;
+    uint32_t now_us = hal_ts_capture_edge_us(&period_ns);
+    sensor_fifo.edge_period_ns = period_ns;
+#else
     uint32_t now_us = hal_micros();
+#endif
     
     sensor_fifo.data_ready = true;
     
-    // 立即启动 DMA 读取
+#if defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH
+    // v0.6.3: 批量模式下这是水位中断, 只记录时刻,
+    // 由 sensor_optimized_poll() 在主循环中突发读取
+    if (sensor_fifo.batch_active) {
+        sensor_fifo.irq_time_us = now_us;
+        return;
+    }
+#endif
+    
+    // 立即启动 DMA 读取 (非阻塞), 数据在完成回调中写入样本 FIFO
     if (!sensor_fifo.reading) {
         sensor_fifo.reading = true;
         sensor_fifo.last_read_us = now_us;
         
-        // 触发 DMA 读取 (非阻塞)
-        // 实际数据在 DMA 完成回调中处理
-        // TODO: 实现 DMA 异步读取功能
-        // imu_read_dma_async(imu_dma_buf, sizeof(imu_dma_buf), NULL);
+        // v0.6.3: I2C 总线或两个槽位都未归还时由主循环同步读取 (data_ready 保持置位);
+        // 同步 SPI 事务进行中时 kick 推迟 (-3), 由 hal_spi_sync_end 启动, reading 保持
+        int kick = dma_ring_setup() ? hal_spi_dma_ring_kick(now_us) : -1;
+        if (kick != 0 && kick != -3) {
+            sensor_fifo.reading = false;
+        }
     }
 }
 
 /*============================================================================
- * DMA 完成回调
+ * 样本写入
  *============================================================================*/
 
-static void imu_dma_complete_callback(uint8_t *data, uint16_t len)
+static void fifo_push(const float gyro[3], const float accel[3], uint32_t ts, float dt, bool accel_fresh)
 {
-    uint32_t now_us = hal_micros();
-    
-    // 计算延迟
-    sensor_fifo.read_latency_us = now_us - sensor_fifo.last_read_us;
-    
-    // 更新统计
-    if (sensor_fifo.read_latency_us > sensor_fifo.max_latency_us) {
-        sensor_fifo.max_latency_us = sensor_fifo.read_latency_us;
-    }
-    
-    // 滑动平均
-    sensor_fifo.avg_latency_us = sensor_fifo.avg_latency_us * 0.95f + 
-                                  sensor_fifo.read_latency_us * 0.05f;
-    
-    // 解析数据
-    sensor_sample_t sample;
-    sample.timestamp_us = now_us;
-    sample.valid = true;
-    
-    // 根据 IMU 类型解析 (假设 ICM42688 格式)
-    int16_t raw_accel[3], raw_gyro[3];
-    raw_accel[0] = (data[0] << 8) | data[1];
-    raw_accel[1] = (data[2] << 8) | data[3];
-    raw_accel[2] = (data[4] << 8) | data[5];
-    raw_gyro[0] = (data[6] << 8) | data[7];
-    raw_gyro[1] = (data[8] << 8) | data[9];
-    raw_gyro[2] = (data[10] << 8) | data[11];
-    
-    // 转换为物理单位
-    float accel_scale = 9.81f / 2048.0f;  // ±16g
-    float gyro_scale = 0.001065264f;       // ±2000dps in rad/s
-    
-    sample.accel[0] = raw_accel[0] * accel_scale;
-    sample.accel[1] = raw_accel[1] * accel_scale;
-    sample.accel[2] = raw_accel[2] * accel_scale;
-    sample.gyro[0] = raw_gyro[0] * gyro_scale;
-    sample.gyro[1] = raw_gyro[1] * gyro_scale;
-    sample.gyro[2] = raw_gyro[2] * gyro_scale;
-    
-    // 写入 FIFO
-    if (sensor_fifo.count < SENSOR_FIFO_SIZE) {
-        sensor_fifo.samples[sensor_fifo.write_idx] = sample;
-        sensor_fifo.write_idx = (sensor_fifo.write_idx + 1) % SENSOR_FIFO_SIZE;
-        sensor_fifo.count++;
-        sensor_fifo.total_samples++;
-    } else {
+    if (sensor_fifo.count >= SENSOR_FIFO_SIZE) {
         sensor_fifo.dropped_samples++;
+        return;
     }
     
+    sensor_sample_t *sample = &sensor_fifo.samples[sensor_fifo.write_idx];
+    memcpy(sample->gyro, gyro, sizeof(float) * 3);
+    memcpy(sample->accel, accel, sizeof(float) * 3);
+    sample->timestamp_us = ts;
+    sample->dt = dt;
+    sample->valid = true;
+    sample->accel_fresh = accel_fresh;
+    
+    sensor_fifo.write_idx = (sensor_fifo.write_idx + 1) % SENSOR_FIFO_SIZE;
+    sensor_fifo.count++;
+    sensor_fifo.total_samples++;
+}
+
+static void latency_update(uint32_t latency_us)
+{
+    sensor_fifo.read_latency_us = latency_us;
+    if (latency_us > sensor_fifo.max_latency_us) {
+        sensor_fifo.max_latency_us = latency_us;
+    }
+    sensor_fifo.avg_latency_us = sensor_fifo.avg_latency_us * 0.95f +
+                                  latency_us * 0.05f;
+}
+
+// v0.6.3: 单样本模式下每个沿对应一帧, 沿间隔即该帧的实际 dt (MCU 晶振);
+// 跨睡眠/丢沿的间隔视为未知, 由融合使用标称 dt
+static float edge_dt(void)
+{
+#if SENSOR_HW_TS
+    float dt_us = sensor_fifo.edge_period_ns * 1e-3f;
+    if (dt_us > 0.25f * SENSOR_SAMPLE_PERIOD_US && dt_us < 5.0f * SENSOR_SAMPLE_PERIOD_US) {
+        return dt_us * 1e-6f;
+    }
+#endif
+    return 0.0f;
+}
+
+/*============================================================================
+ * DMA 完成回调 (SPI0 中断上下文)
+ *============================================================================*/
+
+// v0.6.3: 首个数据就绪沿到来时 IMU 已完成初始化, 此时按检测到的型号配置乒乓环;
+// I2C 总线/型号不支持时每次返回 false
+static bool dma_ring_setup(void)
+{
+    if (!sensor_fifo.ring_active &&
+        imu_dma_burst_get(&dma_burst) == 0 &&
+        hal_spi_dma_ring_init(PIN_SPI_CS, dma_burst.cmd, dma_burst.len, imu_dma_complete_callback) == 0) {
+        sensor_fifo.ring_active = true;
+    }
+    return sensor_fifo.ring_active;
+}
+
+static void imu_dma_complete_callback(void)
+{
+    const hal_dma_frame_t *frame = hal_spi_dma_ring_acquire();
+    
+    if (frame) {
+        uint32_t ts = frame->timestamp_us;
+        latency_update(hal_micros() - ts);
+        
+        // v0.6.3: 按当前型号在槽位上解码 (含偏置/温度补偿/轴映射), 时间戳取数据就绪中断时刻
+        float gyro[3], accel[3];
+        if (dma_burst.decode(frame->data, frame->len, gyro, accel) == 0) {
+            fifo_push(gyro, accel, ts, edge_dt(), true);
+        }
+        hal_spi_dma_ring_release(frame);
+    }
+    
+    sensor_fifo.data_ready = false;
     sensor_fifo.reading = false;
+}
+
+// v0.6.3: 数据就绪但未能启动 DMA (I2C 总线等) 时在主循环同步读取
+static void sync_read_pending(void)
+{
+    if (sensor_fifo.batch_active || sensor_fifo.reading || !sensor_fifo.data_ready) {
+        return;
+    }
+    // 读取期间占住 reading, 中断不再启动 DMA 与主循环同时写 FIFO
+    sensor_fifo.reading = true;
     sensor_fifo.data_ready = false;
+    
+    float gyro[3], accel[3];
+    uint32_t ts = sensor_fifo.last_read_us;
+    if (imu_read_all(gyro, accel) == 0) {
+        latency_update(hal_micros() - ts);
+        fifo_push(gyro, accel, ts, edge_dt(), true);
+    }
+    sensor_fifo.reading = false;
 }
 
 /*============================================================================
@@ -150,6 +272,21 @@ int sensor_optimized_init(void)
     // 初始化 DMA
     hal_dma_init();
     
+#if defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH
+    // v0.6.3: 使能 IMU 硬件 FIFO 水位中断, 不支持时退回单样本模式
+    sensor_fifo.batch_active = (imu_fifo_enable(SENSOR_FIFO_WATERMARK) == 0);
+    sensor_fifo.last_burst_us = hal_micros();
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    sensor_fifo.ts_nominal_us = imu_fifo_ts_tick_ns() / 1000.0f;
+    sensor_fifo.ts_us_per_tick = sensor_fifo.ts_nominal_us;
+#endif
+#endif
+    
+#if SENSOR_HW_TS
+    // v0.6.3: 先启动捕获, 第一个沿之前的时间戳退回中断时刻
+    hal_ts_capture_init();
+#endif
+    
     // 配置 IMU 中断回调
     // 使用hal_gpio_set_interrupt注册回调，这样GPIOA_IRQHandler会自动调用它
 #ifdef PIN_IMU_INT1
@@ -166,6 +303,167 @@ int sensor_optimized_init(void)
     return 0;
 }
 
+/*============================================================================
+ * v0.6.3: 批量突发读取
+ *============================================================================*/
+
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+/**
+ * v0.6.3: 用水位中断时刻标定 IMU 时钟
+ * IMU 时间戳无抖动但跟随 IMU 内部振荡器 (±2-5%), 中断时刻有几十 us 抖动但
+ * 跟随 MCU 晶振; 取 1s 以上窗口的比值低通, 得到晶振时钟下的 us/计数
+ */
+static void ts_calibrate(uint32_t tick, uint32_t mcu_us)
+{
+    if (!sensor_fifo.ts_ref_valid) {
+        sensor_fifo.ts_ref_tick = tick;
+        sensor_fifo.ts_ref_us = mcu_us;
+        sensor_fifo.ts_ref_valid = true;
+        return;
+    }
+    
+    uint32_t d_us = mcu_us - sensor_fifo.ts_ref_us;
+    if (d_us < SENSOR_TS_CAL_WINDOW_US) {
+        return;
+    }
+    uint32_t d_tick = tick - sensor_fifo.ts_ref_tick;
+    sensor_fifo.ts_ref_tick = tick;
+    sensor_fifo.ts_ref_us = mcu_us;
+    
+    // 间隔过长 (睡眠/丢中断) 或计数异常时不参与标定
+    if (d_us > SENSOR_TS_CAL_MAX_US || d_tick == 0) {
+        return;
+    }
+    
+    float measured = (float)d_us / (float)d_tick;
+    float nominal = sensor_fifo.ts_nominal_us;
+    if (measured < nominal * 0.9f || measured > nominal * 1.1f) {
+        return;
+    }
+    sensor_fifo.ts_us_per_tick += (measured - sensor_fifo.ts_us_per_tick) * 0.125f;
+}
+#endif
+
+static uint8_t fifo_burst(bool force)
+{
+#if defined(USE_SENSOR_FIFO_BATCH) && USE_SENSOR_FIFO_BATCH
+    if (!sensor_fifo.batch_active) {
+        return 0;
+    }
+    
+    uint32_t now_us = hal_micros();
+    
+    // 等待水位中断; 中断沿丢失时按兜底间隔轮询
+    if (!force && !sensor_fifo.data_ready &&
+        (now_us - sensor_fifo.last_burst_us) < SENSOR_BATCH_POLL_US) {
+        return 0;
+    }
+    
+    uint32_t irq_us = sensor_fifo.irq_time_us;
+    bool from_irq = sensor_fifo.data_ready;
+    sensor_fifo.data_ready = false;
+    sensor_fifo.last_burst_us = now_us;
+    
+    uint8_t room = SENSOR_FIFO_SIZE - sensor_fifo.count;
+    if (room > IMU_FIFO_MAX_BATCH) room = IMU_FIFO_MAX_BATCH;
+    if (room == 0) {
+        return 0;  // 上层未消费, 数据留在 IMU FIFO 中
+    }
+    
+    float g[IMU_FIFO_MAX_BATCH][3], a[IMU_FIFO_MAX_BATCH][3];
+    SELFTEST_BEGIN(SELFTEST_T_IMU_READ);
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    uint32_t t[IMU_FIFO_MAX_BATCH];
+    bool have_ts = (sensor_fifo.ts_nominal_us > 0.0f);
+    int n = imu_fifo_read(g, a, have_ts ? t : NULL, room);
+#else
+    int n = imu_fifo_read(g, a, NULL, room);
+#endif
+    if (n <= 0) {
+        return 0;
+    }
+    SELFTEST_END(SELFTEST_T_IMU_READ, (uint16_t)n);
+    uint8_t acc_mask = imu_fifo_accel_mask();
+    
+    // 每帧时间戳: 最新一帧对应水位触发时刻 (中断之后新到的帧顺延),
+    // 其余按 ODR 周期向前回推
+    uint32_t newest_us = now_us;
+    if (from_irq && n >= SENSOR_FIFO_WATERMARK) {
+        newest_us = irq_us + (uint32_t)(n - SENSOR_FIFO_WATERMARK) * SENSOR_SAMPLE_PERIOD_US;
+        if ((int32_t)(newest_us - now_us) > 0) newest_us = now_us;
+    }
+    
+    latency_update(now_us - newest_us);
+    
+#if defined(USE_IMU_FIFO_TIMESTAMP) && USE_IMU_FIFO_TIMESTAMP
+    if (have_ts) {
+        // 每帧时间和 dt 都由 IMU 时间戳换算, 不再假设固定 ODR
+        float us_per_tick = sensor_fifo.ts_us_per_tick;
+        for (int i = 0; i < n; i++) {
+            float dt = 0.0f;
+            if (sensor_fifo.ts_have_last) {
+                float dt_us = (float)(t[i] - sensor_fifo.ts_last_tick) * us_per_tick;
+                // 跨睡眠/FIFO 溢出的间隔视为未知, 由融合使用标称 dt;
+                // 16 位时间戳可能已回绕多圈, 标定窗口也要重新开始
+                if (dt_us > 0.25f * SENSOR_SAMPLE_PERIOD_US &&
+                    dt_us < 4.0f * SENSOR_SAMPLE_PERIOD_US) {
+                    dt = dt_us * 1e-6f;
+                } else {
+                    sensor_fifo.ts_ref_valid = false;
+                }
+            }
+            sensor_fifo.ts_last_tick = t[i];
+            sensor_fifo.ts_have_last = true;
+            
+            uint32_t ts = newest_us - (uint32_t)((float)(t[n - 1] - t[i]) * us_per_tick);
+            fifo_push(g[i], a[i], ts, dt, (acc_mask >> i) & 1);
+        }
+        
+        if (from_irq && n >= SENSOR_FIFO_WATERMARK) {
+            ts_calibrate(t[SENSOR_FIFO_WATERMARK - 1], irq_us);
+        }
+    } else
+#endif
+    for (int i = 0; i < n; i++) {
+        uint32_t ts = newest_us - (uint32_t)(n - 1 - i) * SENSOR_SAMPLE_PERIOD_US;
+        fifo_push(g[i], a[i], ts, 0.0f, (acc_mask >> i) & 1);
+    }
+    
+    sensor_fifo.burst_count++;
+    return (uint8_t)n;
+#else
+    (void)force;
+    return 0;
+#endif
+}
+
+uint8_t sensor_optimized_poll(void)
+{
+    sync_read_pending();
+    return fifo_burst(false);
+}
+
+uint8_t sensor_optimized_flush(void)
+{
+    // 不足水位的帧按读取时刻打时间戳 (带 IMU 时间戳时按 tick 回推)
+    return fifo_burst(true);
+}
+
+bool sensor_optimized_batch_active(void)
+{
+    return sensor_fifo.batch_active;
+}
+
+float sensor_optimized_get_last_dt(void)
+{
+    return last_sample_dt;
+}
+
+bool sensor_optimized_get_last_accel_fresh(void)
+{
+    return last_accel_fresh;
+}
+
 /*============================================================================
  * 获取传感器数据
  *============================================================================*/
@@ -177,7 +475,10 @@ bool sensor_optimized_get_sample(float gyro[3], float accel[3], uint32_t *timest
     }
     
     if (sensor_fifo.count == 0) {
-        return false;
+        sync_read_pending();
+        if (sensor_fifo.count == 0) {
+            return false;
+        }
     }
     
     // 从 FIFO 读取
@@ -193,10 +494,14 @@ bool sensor_optimized_get_sample(float gyro[3], float accel[3], uint32_t *timest
     if (timestamp_us) {
         *timestamp_us = sample->timestamp_us;
     }
+    last_sample_dt = sample->dt;
+    last_accel_fresh = sample->accel_fresh;
     
-    // 更新读指针
+    // 更新读指针 (count 也由 DMA 完成中断修改)
     sensor_fifo.read_idx = (sensor_fifo.read_idx + 1) % SENSOR_FIFO_SIZE;
+    __disable_irq();
     sensor_fifo.count--;
+    __enable_irq();
     
     return true;
 }
@@ -206,7 +511,7 @@ bool sensor_optimized_get_sample(float gyro[3], float accel[3], uint32_t *timest
  *============================================================================*/
 
 void sensor_optimized_get_stats(uint32_t *total, uint32_t *dropped, 
-                                 float *avg_latency, uint32_t *max_latency)
+                                 uint32_t *max_latency, float *avg_latency)
 {
     if (total) *total = sensor_fifo.total_samples;
     if (dropped) *dropped = sensor_fifo.dropped_samples;
@@ -4,6 +4,8 @@
  * 
  * 原理: 陀螺仪偏移随温度变化 (约 0.03 dps/°C)
  * 模型: offset = a + b*(T-Tref) + c*(T-Tref)^2
+ * v0.6.3: 改为 -10~60°C 分段线性节点, 上电升温段按实测逐段拟合;
+ *         补偿值缓存, 每样本只做减法
  */
 
 #include "hal.h"
@@ -17,26 +19,42 @@
 #define TEMP_REF_C          25.0f       // 参考温度
 #define TEMP_MIN_C          -10.0f
 #define TEMP_MAX_C          60.0f
-#define TEMP_LEARN_ALPHA    0.001f      // 系数学习率
+#define TEMP_LEARN_ALPHA    0.001f      // 系数学习率 (v0.6.3: 下限, 样本少时更快)
 #define TEMP_STABLE_THRESH  0.5f        // 温度稳定阈值
 
+// v0.6.3: 分段线性模型, 节点 TEMP_MIN_C + i * TEMP_BIN_WIDTH_C
+#define TEMP_BIN_WIDTH_C    10.0f
+#define TEMP_BIN_COUNT      8           // -10 ~ 60°C
+#define TEMP_RECALC_C       0.25f       // 温度变化超过此值才重算补偿值
+
+#define TEMP_COMP_MAGIC_V1      0x54454D50  // "TEMP" 二次多项式 a/b/c
+#define TEMP_COMP_MAGIC_V2      0x544D5032  // "TMP2" 分段线性节点
+#define TEMP_COMP_V1_SIZE       40          // magic + a/b/c 各 3 个 float
+#define TEMP_COMP_LEGACY_ADDR   0x100       // v0.6.3 之前的固定偏移
+
 /*============================================================================
  * 状态
  *============================================================================*/
 
 typedef struct {
-    // 多项式系数 (每轴)
-    float coeff_a[3];   // 常数项
-    float coeff_b[3];   // 一次项
-    float coeff_c[3];   // 二次项
+    uint32_t magic;
+    float node[TEMP_BIN_COUNT][3];      // 各节点温度下的偏移 (rad/s)
+    uint16_t count[TEMP_BIN_COUNT];     // 各节点学习样本数, 0 = 未观测
+} __attribute__((packed)) temp_store_t;
+
+typedef struct {
+    // v0.6.3: 分段线性节点 (取代二次多项式系数)
+    float node[TEMP_BIN_COUNT][3];
+    uint16_t count[TEMP_BIN_COUNT];
     
     // 当前温度
     float current_temp;
     float temp_rate;    // °C/s
     uint32_t last_update_ms;
     
-    // 补偿值
+    // 补偿值 (v0.6.3: 缓存, 只在温度变化超过 TEMP_RECALC_C 或学习后重算)
     float compensation[3];
+    float cached_temp;
     
     // 统计
     float temp_min;
@@ -45,6 +63,49 @@ typedef struct {
 
 static temp_comp_t tc = {0};
 
+/*============================================================================
+ * 内部函数
+ *============================================================================*/
+
+// 温度所在的段 [i, i+1] 及段内位置 f (0..1), 范围外钳位到端点
+static uint8_t locate_bin(float temp_c, float *f)
+{
+    float x = (temp_c - TEMP_MIN_C) / TEMP_BIN_WIDTH_C;
+    if (x <= 0.0f) {
+        *f = 0.0f;
+        return 0;
+    }
+    if (x >= (float)(TEMP_BIN_COUNT - 1)) {
+        *f = 1.0f;
+        return TEMP_BIN_COUNT - 2;
+    }
+    uint8_t i = (uint8_t)x;
+    *f = x - (float)i;
+    return i;
+}
+
+static void recompute_compensation(void)
+{
+    float f;
+    uint8_t i = locate_bin(tc.current_temp, &f);
+    for (int k = 0; k < 3; k++) {
+        tc.compensation[k] = tc.node[i][k] + (tc.node[i + 1][k] - tc.node[i][k]) * f;
+    }
+    tc.cached_temp = tc.current_temp;
+}
+
+// 按二次多项式填充节点 (默认值 / 旧格式迁移), 节点计为未观测
+static void nodes_from_quadratic(const float a[3], const float b[3], const float c[3])
+{
+    for (int n = 0; n < TEMP_BIN_COUNT; n++) {
+        float t = TEMP_MIN_C + n * TEMP_BIN_WIDTH_C - TEMP_REF_C;
+        for (int k = 0; k < 3; k++) {
+            tc.node[n][k] = a[k] + b[k] * t + c[k] * t * t;
+        }
+        tc.count[n] = 0;
+    }
+}
+
 /*============================================================================
  * 默认系数
  *============================================================================*/
@@ -52,37 +113,65 @@ static temp_comp_t tc = {0};
 static void load_defaults(void)
 {
     // 典型 ICM42688 温度系数 (rad/s/°C)
-    for (int i = 0; i < 3; i++) {
-        tc.coeff_a[i] = 0.0f;
-        tc.coeff_b[i] = 0.00052f;   // ~0.03 dps/°C
-        tc.coeff_c[i] = 0.000001f;  // 小的二次项
-    }
+    const float a[3] = { 0.0f, 0.0f, 0.0f };
+    const float b[3] = { 0.00052f, 0.00052f, 0.00052f };     // ~0.03 dps/°C
+    const float c[3] = { 0.000001f, 0.000001f, 0.000001f };  // 小的二次项
+    nodes_from_quadratic(a, b, c);
 }
 
 /*============================================================================
  * 初始化
  *============================================================================*/
 
+// 旧格式: magic + a/b/c
+static bool load_v1(const uint8_t *data)
+{
+    uint32_t magic;
+    memcpy(&magic, data, 4);
+    if (magic != TEMP_COMP_MAGIC_V1) return false;
+    
+    float a[3], b[3], c[3];
+    memcpy(a, &data[4], 12);
+    memcpy(b, &data[16], 12);
+    memcpy(c, &data[28], 12);
+    nodes_from_quadratic(a, b, c);
+    return true;
+}
+
+static bool load_stored(void)
+{
+    // v0.6.3: 键值存储; 未写入过时读旧偏移 0x100 的 v1 数据
+    union {
+        temp_store_t v2;
+        uint8_t raw[sizeof(temp_store_t)];
+    } buf;
+    
+    int n = hal_kv_get(HAL_KV_TEMP_COMP, &buf, sizeof(buf));
+    if (n == (int)sizeof(temp_store_t) && buf.v2.magic == TEMP_COMP_MAGIC_V2) {
+        memcpy(tc.node, buf.v2.node, sizeof(tc.node));
+        memcpy(tc.count, buf.v2.count, sizeof(tc.count));
+        return true;
+    }
+    if (n == TEMP_COMP_V1_SIZE) {
+        return load_v1(buf.raw);
+    }
+    if (n == HAL_KV_ERR_NOT_FOUND &&
+        hal_storage_read(TEMP_COMP_LEGACY_ADDR, buf.raw, TEMP_COMP_V1_SIZE) == 0) {
+        return load_v1(buf.raw);
+    }
+    return false;
+}
+
 void temp_comp_init(void)
 {
     memset(&tc, 0, sizeof(tc));
     tc.current_temp = TEMP_REF_C;
     tc.last_update_ms = hal_get_tick_ms();
     
-    // 尝试从 Flash 加载
-    uint8_t data[48];
-    if (hal_storage_read(0x100, data, 48) == 0) {
-        uint32_t magic;
-        memcpy(&magic, data, 4);
-        if (magic == 0x54454D50) {  // "TEMP"
-            memcpy(tc.coeff_a, &data[4], 12);
-            memcpy(tc.coeff_b, &data[16], 12);
-            memcpy(tc.coeff_c, &data[28], 12);
-            return;
-        }
+    if (!load_stored()) {
+        load_defaults();
     }
-    
-    load_defaults();
+    recompute_compensation();
 }
 
 /*============================================================================
@@ -110,6 +199,11 @@ void temp_comp_update_temp(float temp_c)
     // 更新统计
     if (temp_c < tc.temp_min || tc.temp_min == 0) tc.temp_min = temp_c;
     if (temp_c > tc.temp_max) tc.temp_max = temp_c;
+    
+    // v0.6.3: 温度变化足够大才重算, 每样本路径只做减法
+    if (fabsf(temp_c - tc.cached_temp) >= TEMP_RECALC_C) {
+        recompute_compensation();
+    }
 }
 
 /*============================================================================
@@ -118,36 +212,61 @@ void temp_comp_update_temp(float temp_c)
 
 void temp_comp_apply(float gyro[3])
 {
-    float t = tc.current_temp - TEMP_REF_C;
-    float t2 = t * t;
-    
-    for (int i = 0; i < 3; i++) {
-        tc.compensation[i] = tc.coeff_a[i] + tc.coeff_b[i] * t + tc.coeff_c[i] * t2;
-        gyro[i] -= tc.compensation[i];
-    }
+    gyro[0] -= tc.compensation[0];
+    gyro[1] -= tc.compensation[1];
+    gyro[2] -= tc.compensation[2];
 }
 
 /*============================================================================
  * 自适应学习
  *============================================================================*/
 
+static float node_alpha(uint8_t n)
+{
+    // 样本少时步长大 (1/(count+2)), 之后降到 TEMP_LEARN_ALPHA
+    float alpha = 1.0f / ((float)tc.count[n] + 2.0f);
+    return (alpha > TEMP_LEARN_ALPHA) ? alpha : TEMP_LEARN_ALPHA;
+}
+
 void temp_comp_learn(const float observed_offset[3])
 {
     // 只在温度稳定时学习
     if (fabsf(tc.temp_rate) > TEMP_STABLE_THRESH) return;
     
-    float t = tc.current_temp - TEMP_REF_C;
-    float t2 = t * t;
+    float f;
+    uint8_t i = locate_bin(tc.current_temp, &f);
+    float wi = (1.0f - f) * node_alpha(i);
+    float wj = f * node_alpha(i + 1);
+    
+    // 已观测范围 (学习前)
+    int lo = -1, hi = -1;
+    for (int n = 0; n < TEMP_BIN_COUNT; n++) {
+        if (tc.count[n]) {
+            if (lo < 0) lo = n;
+            hi = n;
+        }
+    }
     
-    for (int i = 0; i < 3; i++) {
-        float predicted = tc.coeff_a[i] + tc.coeff_b[i] * t + tc.coeff_c[i] * t2;
-        float error = observed_offset[i] - predicted;
+    for (int k = 0; k < 3; k++) {
+        float predicted = tc.node[i][k] + (tc.node[i + 1][k] - tc.node[i][k]) * f;
+        float error = observed_offset[k] - predicted;
+        
+        // 两端节点按线性插值权重分摊误差
+        tc.node[i][k] += error * wi;
+        tc.node[i + 1][k] += error * wj;
         
-        // 梯度下降更新
-        tc.coeff_a[i] += error * TEMP_LEARN_ALPHA;
-        tc.coeff_b[i] += error * t * TEMP_LEARN_ALPHA;
-        tc.coeff_c[i] += error * t2 * TEMP_LEARN_ALPHA * 0.1f;
+        // 观测范围以外、从未观测的节点整体平移, 保留默认斜率
+        float shift = error * (wi > wj ? wi : wj);
+        for (int n = 0; n < TEMP_BIN_COUNT; n++) {
+            if (n == i || n == i + 1 || tc.count[n]) continue;
+            if (lo < 0 || n < lo || n > hi) tc.node[n][k] += shift;
+        }
     }
+    
+    uint8_t nearest = (f < 0.5f) ? i : (uint8_t)(i + 1);
+    if (tc.count[nearest] < 0xFFFF) tc.count[nearest]++;
+    
+    recompute_compensation();
 }
 
 /*============================================================================
@@ -156,13 +275,11 @@ void temp_comp_learn(const float observed_offset[3])
 
 void temp_comp_save(void)
 {
-    uint8_t data[48];
-    uint32_t magic = 0x54454D50;
-    memcpy(data, &magic, 4);
-    memcpy(&data[4], tc.coeff_a, 12);
-    memcpy(&data[16], tc.coeff_b, 12);
-    memcpy(&data[28], tc.coeff_c, 12);
-    hal_storage_write(0x100, data, 44);
+    temp_store_t data;
+    data.magic = TEMP_COMP_MAGIC_V2;
+    memcpy(data.node, tc.node, sizeof(data.node));
+    memcpy(data.count, tc.count, sizeof(data.count));
+    hal_kv_set_deferred(HAL_KV_TEMP_COMP, &data, sizeof(data));  // 运行中保存, 后台写入
 }
 
 /*============================================================================
@@ -8,7 +8,10 @@
  * 启用方法: make OTA=1
  */
 
+#include "config.h"
 #include "hal.h"
+#include "ota_update.h"
+#include "watchdog.h"
 #include <string.h>
 
 #ifdef CH59X
@@ -27,11 +30,8 @@
  *============================================================================*/
 
 #define OTA_MAGIC           0x4F544155  // "OTAU"
-#define OTA_BLOCK_SIZE      256
-#define OTA_MAX_SIZE        0x38000     // 224KB
-#define OTA_PARTITION_ADDR  0x38000     // OTA 分区
-#define APP_PARTITION_ADDR  0x1000      // 应用分区
 #define OTA_TIMEOUT_MS      30000
+#define OTA_ERASE_SIZE      256         // 擦除步长
 
 /*============================================================================
  * CodeFlash 操作
@@ -76,14 +76,6 @@ static int codeflash_write(uint32_t addr, const void *data, uint32_t len)
  * 状态
  *============================================================================*/
 
-typedef enum {
-    OTA_IDLE = 0,
-    OTA_RECEIVING,
-    OTA_VERIFYING,
-    OTA_COMPLETE,
-    OTA_ERROR
-} ota_state_t;
-
 typedef struct {
     ota_state_t state;
     uint32_t total_size;
@@ -94,6 +86,7 @@ typedef struct {
     uint32_t last_activity;
     uint8_t error_code;
     uint32_t crc32;
+    uint32_t erased;                    // v0.6.3: 分区内已擦除的长度 (从分区起点连续)
 } ota_ctx_t;
 
 static ota_ctx_t ota = {0};
@@ -114,6 +107,173 @@ static uint32_t calc_crc32(const uint8_t *data, uint32_t len)
     return ~crc;
 }
 
+/*============================================================================
+ * v0.6.3: 延迟擦除
+ * ota_start 不再整区擦除, 写入前只擦到本次写入末尾所在的扇区, 擦除分摊到接收过程中.
+ * 已擦除区间从分区起点连续增长, 乱序写入 (RF 广播补发) 落在已擦除区间内不受影响
+ *============================================================================*/
+
+static int ensure_erased(uint32_t end)
+{
+    while (ota.erased < end) {
+#ifdef CH59X
+        if (codeflash_erase(OTA_PARTITION_ADDR + ota.erased, OTA_ERASE_SIZE) != 0) {
+            return -1;
+        }
+#endif
+        ota.erased += OTA_ERASE_SIZE;
+    }
+    return 0;
+}
+
+#if defined(USE_OTA_PACK) && USE_OTA_PACK
+/*============================================================================
+ * v0.6.3: 打包镜像解码 (格式见 ota_update.h)
+ * 输出写到分区内容器之后 (按擦除步长对齐), 先经小缓冲再编程;
+ * MATCH 的源在缓冲中或已写入 Flash (直接映射读取)
+ *============================================================================*/
+
+#define PACK_OUT_BUF        64
+
+static const uint8_t *const ota_part = (const uint8_t *)(uintptr_t)OTA_PARTITION_ADDR;
+static const uint8_t *const app_part = (const uint8_t *)(uintptr_t)APP_PARTITION_ADDR;
+
+static struct {
+    uint32_t in;                        // 输入位置 (分区内偏移)
+    uint32_t base;                      // 输出起点 (分区内偏移)
+    uint32_t limit;                     // 输出上限 (头部 out_size)
+    uint32_t size;                      // 已输出字节数
+    uint32_t flushed;                   // 已写入 Flash 的字节数
+    uint8_t buf[PACK_OUT_BUF];
+} pack;
+
+static int pack_flush(void)
+{
+    uint32_t n = pack.size - pack.flushed;
+    if (n == 0) return 0;
+    
+    uint32_t off = pack.base + pack.flushed;
+    if (ensure_erased(off + n) != 0) return -1;
+#ifdef CH59X
+    if (codeflash_write(OTA_PARTITION_ADDR + off, pack.buf, n) != 0) return -1;
+#endif
+    pack.flushed = pack.size;
+    return 0;
+}
+
+static int pack_put(uint8_t b)
+{
+    if (pack.size >= pack.limit) return -1;
+    pack.buf[pack.size - pack.flushed] = b;
+    pack.size++;
+    return (pack.size - pack.flushed >= PACK_OUT_BUF) ? pack_flush() : 0;
+}
+
+static uint8_t pack_get(uint32_t pos)
+{
+    if (pos >= pack.flushed) return pack.buf[pos - pack.flushed];
+    return ota_part[pack.base + pos];
+}
+
+static int pack_varint(uint32_t *out)
+{
+    uint32_t v = 0;
+    for (uint8_t shift = 0; shift < 32; shift += 7) {
+        if (pack.in >= ota.total_size) return -1;
+        uint8_t b = ota_part[pack.in++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int pack_decode(const ota_pack_header_t *hdr)
+{
+    pack.in = sizeof(ota_pack_header_t);
+    
+    while (pack.in < ota.total_size) {
+        uint8_t op = ota_part[pack.in++];
+        uint32_t len = op & 0x3F;
+        uint32_t arg = 0;
+        
+        if (len == 0x3F) {
+            uint32_t ext;
+            if (pack_varint(&ext) != 0) return -1;
+            len += ext;
+        }
+        
+        switch (op >> 6) {
+            case OTA_PACK_LITERAL:
+                len += 1;
+                if (len > ota.total_size - pack.in) return -1;
+                while (len--) {
+                    if (pack_put(ota_part[pack.in++]) != 0) return -1;
+                }
+                break;
+                
+            case OTA_PACK_MATCH:
+                len += 3;
+                if (pack_varint(&arg) != 0 || arg >= pack.size) return -1;
+                arg = pack.size - arg - 1;
+                while (len--) {
+                    if (pack_put(pack_get(arg++)) != 0) return -1;
+                }
+                break;
+                
+            case OTA_PACK_BASE:
+                len += 1;
+                if (pack_varint(&arg) != 0) return -1;
+                if (arg > hdr->base_size || len > hdr->base_size - arg) return -1;
+                while (len--) {
+                    if (pack_put(app_part[arg++]) != 0) return -1;
+                }
+                break;
+                
+            default:    // OTA_PACK_FILL
+                len += 3;
+                if (pack.in >= ota.total_size) return -1;
+                arg = ota_part[pack.in++];
+                while (len--) {
+                    if (pack_put((uint8_t)arg) != 0) return -1;
+                }
+                break;
+        }
+    }
+    
+    if (pack_flush() != 0) return -1;
+    return (pack.size == hdr->out_size) ? 0 : -1;
+}
+
+/**
+ * @brief 解码打包镜像
+ * @param out_off 输出解码结果在分区内的偏移
+ * @return 0 成功, -2 解码失败或输出 CRC 不符, -3 基准固件不符
+ */
+static int pack_unpack(const ota_pack_header_t *hdr, uint32_t *out_off)
+{
+    if (hdr->base_size > 0) {
+        if (hdr->base_size > OTA_MAX_SIZE ||
+            calc_crc32(app_part, hdr->base_size) != hdr->base_crc) {
+            return -3;
+        }
+    }
+    
+    memset(&pack, 0, sizeof(pack));
+    pack.base = (ota.total_size + OTA_ERASE_SIZE - 1) / OTA_ERASE_SIZE * OTA_ERASE_SIZE;
+    if (hdr->out_size > OTA_MAX_SIZE - pack.base) return -2;
+    pack.limit = hdr->out_size;
+    
+    if (pack_decode(hdr) != 0) return -2;
+    if (calc_crc32(ota_part + pack.base, hdr->out_size) != hdr->out_crc) return -2;
+    
+    *out_off = pack.base;
+    return 0;
+}
+#endif
+
 /*============================================================================
  * OTA API
  *============================================================================*/
@@ -130,13 +290,7 @@ int ota_start(uint32_t size, uint32_t crc)
     ota.total_blocks = (size + OTA_BLOCK_SIZE - 1) / OTA_BLOCK_SIZE;
     ota.start_time = hal_get_tick_ms();
     ota.last_activity = ota.start_time;
-    
-    // 擦除 OTA 分区
-#ifdef CH59X
-    for (uint32_t addr = OTA_PARTITION_ADDR; addr < OTA_PARTITION_ADDR + size; addr += 256) {
-        codeflash_erase(addr, 256);
-    }
-#endif
+    ota.erased = 0;     // v0.6.3: 分区在写入时按需擦除
     
     return 0;
 }
@@ -148,6 +302,12 @@ int ota_write_block(uint16_t block_num, const uint8_t *data, uint16_t len)
     
     uint32_t addr = OTA_PARTITION_ADDR + block_num * OTA_BLOCK_SIZE;
     
+    if (ensure_erased(block_num * OTA_BLOCK_SIZE + len) != 0) {
+        ota.state = OTA_ERROR;
+        ota.error_code = 1;
+        return -3;
+    }
+    
 #ifdef CH59X
     if (codeflash_write(addr, data, len) != 0) {
         ota.state = OTA_ERROR;
@@ -167,6 +327,48 @@ int ota_write_block(uint16_t block_num, const uint8_t *data, uint16_t len)
     return 0;
 }
 
+int ota_write_chunk(uint32_t offset, const uint8_t *data, uint16_t len)
+{
+    if (ota.state != OTA_RECEIVING) return -1;
+    if (offset + len > ota.total_size) return -2;
+    
+    if (ensure_erased(offset + len) != 0) {
+        ota.state = OTA_ERROR;
+        ota.error_code = 1;
+        return -3;
+    }
+    
+#ifdef CH59X
+    if (codeflash_write(OTA_PARTITION_ADDR + offset, data, len) != 0) {
+        ota.state = OTA_ERROR;
+        ota.error_code = 1;
+        return -3;
+    }
+#endif
+    
+    ota.received += len;
+    ota.received_blocks = ota.received / OTA_BLOCK_SIZE;
+    ota.last_activity = hal_get_tick_ms();
+    
+    if (ota.received >= ota.total_size) {
+        ota.state = OTA_VERIFYING;
+    }
+    
+    return 0;
+}
+
+int ota_read(uint32_t offset, uint8_t *out, uint16_t len)
+{
+    if (offset + len > OTA_MAX_SIZE) return -1;
+    
+#ifdef CH59X
+    memcpy(out, (const uint8_t *)(OTA_PARTITION_ADDR + offset), len);
+#else
+    memset(out, 0xFF, len);
+#endif
+    return 0;
+}
+
 int ota_verify(void)
 {
     if (ota.state != OTA_VERIFYING) return -1;
@@ -187,19 +389,43 @@ int ota_apply(void)
 {
     if (ota.state != OTA_COMPLETE) return -1;
     
+    uint32_t image_off = 0;
+    uint32_t image_size = ota.total_size;
+    
+#if defined(USE_OTA_PACK) && USE_OTA_PACK
+    // v0.6.3: 打包镜像先解码到分区空闲区域, 应用区在校验通过前不动
+    ota_pack_header_t hdr;
+    memcpy(&hdr, (const void *)(uintptr_t)OTA_PARTITION_ADDR, sizeof(hdr));
+    if (ota.total_size >= sizeof(hdr) && hdr.magic == OTA_PACK_MAGIC) {
+        int ret = pack_unpack(&hdr, &image_off);
+        if (ret != 0) {
+            ota.state = OTA_ERROR;
+            ota.error_code = (ret == -3) ? 5 : 4;
+            return ret;
+        }
+        image_size = hdr.out_size;
+    }
+#endif
+    
+    // v0.6.3: 新镜像首次启动走 bootloader 完整检查
+    wdog_boot_token_clear();
+    
 #ifdef CH59X
     // 擦除应用分区
-    for (uint32_t addr = APP_PARTITION_ADDR; addr < APP_PARTITION_ADDR + ota.total_size; addr += 256) {
+    for (uint32_t addr = APP_PARTITION_ADDR; addr < APP_PARTITION_ADDR + image_size; addr += 256) {
         codeflash_erase(addr, 256);
     }
     
     // 复制固件
-    for (uint32_t i = 0; i < ota.total_size; i += OTA_BLOCK_SIZE) {
-        uint32_t src = OTA_PARTITION_ADDR + i;
+    for (uint32_t i = 0; i < image_size; i += OTA_BLOCK_SIZE) {
+        uint32_t src = OTA_PARTITION_ADDR + image_off + i;
         uint32_t dst = APP_PARTITION_ADDR + i;
-        uint32_t len = (ota.total_size - i > OTA_BLOCK_SIZE) ? OTA_BLOCK_SIZE : (ota.total_size - i);
+        uint32_t len = (image_size - i > OTA_BLOCK_SIZE) ? OTA_BLOCK_SIZE : (image_size - i);
         codeflash_write(dst, (void*)src, len);
     }
+#else
+    (void)image_off;
+    (void)image_size;
 #endif
     
     return 0;
@@ -227,6 +453,9 @@ uint8_t ota_get_progress(void)
     return (ota.received_blocks * 100) / ota.total_blocks;
 }
 uint8_t ota_get_error(void) { return ota.error_code; }
+uint32_t ota_get_size(void) { return ota.total_size; }
+uint32_t ota_get_crc(void) { return ota.crc32; }
+void ota_init(void) {}
 
 #else  // OTA_ENABLED == 0
 
@@ -239,5 +468,11 @@ int ota_apply(void) { return -1; }
 void ota_abort(void) {}
 void ota_process(void) {}
 uint8_t ota_get_progress(void) { return 0; }
+int ota_write_chunk(uint32_t o, const uint8_t *d, uint16_t l) { (void)o; (void)d; (void)l; return -1; }
+int ota_read(uint32_t o, uint8_t *d, uint16_t l) { (void)o; (void)d; (void)l; return -1; }
+ota_state_t ota_get_state(void) { return OTA_IDLE; }
+uint8_t ota_get_error(void) { return 0; }
+uint32_t ota_get_size(void) { return 0; }
+uint32_t ota_get_crc(void) { return 0; }
 
 #endif // OTA_ENABLED
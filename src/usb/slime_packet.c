@@ -80,13 +80,15 @@ static inline uint8_t map_server_status(uint8_t ch_flags)
  * Packet 生成函数
  *============================================================================*/
 
-void slime_make_packet1(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+void slime_packet_template(uint8_t out[SLIME_PACKET_SIZE], uint8_t type, uint8_t tracker_id)
 {
     memset(out, 0, SLIME_PACKET_SIZE);
-    
-    out[0] = SLIME_PKT_TYPE_QUAT_ACCEL;  // 0x01
-    out[1] = data->tracker_id;
-    
+    out[0] = type;
+    out[1] = tracker_id;
+}
+
+void slime_update_packet1(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+{
     // nRF语义: qx, qy, qz, qw (注意CH通常是wxyz，需要转换)
     // CH: quat_w, quat_x, quat_y, quat_z
     // nRF: quat_x, quat_y, quat_z, quat_w
@@ -101,23 +103,14 @@ void slime_make_packet1(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data
     wr_i16_le(&out[14], accel_mg_to_fixed7(data->accel_z));
 }
 
-void slime_make_packet2(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+void slime_update_packet2(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
 {
-    memset(out, 0, SLIME_PACKET_SIZE);
-    
-    out[0] = SLIME_PKT_TYPE_COMPRESSED;  // 0x02
-    out[1] = data->tracker_id;
-    
     // Battery (bit7=valid flag)
     uint8_t batt_pct = data->battery_pct;
     if (batt_pct > 100) batt_pct = 100;
     out[2] = 0x80 | batt_pct;
     
-    // Battery voltage (待扩展，暂填0)
-    out[3] = 0;
-    
-    // Temperature (待扩展，暂填0)
-    out[4] = 0;
+    // byte 3 电压, byte 4 温度 (待扩展, 模板中为0)
     
     // 压缩四元数 (32-bit) - v0.6.2 smallest-three压缩
     uint32_t q_compressed = compress_quat_simple(
@@ -136,42 +129,57 @@ void slime_make_packet2(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data
     out[15] = (uint8_t)data->rssi;
 }
 
-void slime_make_packet3(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+void slime_update_packet3(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
 {
-    memset(out, 0, SLIME_PACKET_SIZE);
-    
-    out[0] = SLIME_PKT_TYPE_STATUS;      // 0x03
-    out[1] = data->tracker_id;
     out[2] = map_server_status(data->flags);   // server_status
     out[3] = map_tracker_status(data->flags);  // tracker_status bitfield
     // byte 4..15 保留/填0
 }
 
-void slime_make_packet0(uint8_t out[SLIME_PACKET_SIZE], const slime_device_info_t *info)
+void slime_update_packet0_power(uint8_t out[SLIME_PACKET_SIZE], uint8_t battery_pct,
+                                uint16_t battery_mv, int8_t imu_temp)
 {
-    memset(out, 0, SLIME_PACKET_SIZE);
+    // Battery
+    out[8] = battery_pct;
+    wr_i16_le(&out[9], battery_mv);
     
-    out[0] = SLIME_PKT_TYPE_INFO;        // 0x00
-    out[1] = info->tracker_id;
+    // Temperature
+    out[11] = (uint8_t)imu_temp;
+}
+
+void slime_make_packet1(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+{
+    slime_packet_template(out, SLIME_PKT_TYPE_QUAT_ACCEL, data->tracker_id);   // 0x01
+    slime_update_packet1(out, data);
+}
+
+void slime_make_packet2(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+{
+    slime_packet_template(out, SLIME_PKT_TYPE_COMPRESSED, data->tracker_id);   // 0x02
+    slime_update_packet2(out, data);
+}
+
+void slime_make_packet3(uint8_t out[SLIME_PACKET_SIZE], const slime_tracker_data_t *data)
+{
+    slime_packet_template(out, SLIME_PKT_TYPE_STATUS, data->tracker_id);       // 0x03
+    slime_update_packet3(out, data);
+}
+
+void slime_make_packet0(uint8_t out[SLIME_PACKET_SIZE], const slime_device_info_t *info)
+{
+    slime_packet_template(out, SLIME_PKT_TYPE_INFO, info->tracker_id);         // 0x00
     out[2] = info->fw_version_major;
     out[3] = info->fw_version_minor;
     out[4] = info->board_id;
     out[5] = info->mcu_id;
     out[6] = info->imu_id;
     out[7] = info->mag_id;
-    
-    // Battery
-    out[8] = info->battery_pct;
-    wr_i16_le(&out[9], info->battery_mv);
-    
-    // Temperature
-    out[11] = (uint8_t)info->imu_temp;
-    
+    slime_update_packet0_power(out, info->battery_pct, info->battery_mv, info->imu_temp);
     // byte 12..15 保留
 }
 
 /*============================================================================
- * 简化四元数压缩 (占位实现)
+ * 简化四元数压缩 (32-bit smallest-three)
  *============================================================================*/
 
 uint32_t compress_quat_simple(int16_t qw, int16_t qx, int16_t qy, int16_t qz)
@@ -179,43 +187,69 @@ uint32_t compress_quat_simple(int16_t qw, int16_t qx, int16_t qy, int16_t qz)
     // v0.6.2: 实现完整的smallest-three压缩
     // 原理: 四元数满足 w^2+x^2+y^2+z^2=1，只需传3个分量
     // 找出绝对值最大的分量，传输另外3个
+    // v0.6.3: 每个 tracker 每帧调用, 改为无分支整数实现:
+    // 比较结果转掩码选最大分量, 查表取其余 3 个, 移位缩放 (四舍五入) 后打包
+    static const uint8_t others[4][3] = {
+        { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 }
+    };
+    const int32_t q[4] = { qw, qx, qy, qz };
     
-    int16_t q[4] = {qw, qx, qy, qz};
-    uint8_t largest_idx = 0;
-    int16_t largest_val = (qw < 0) ? -qw : qw;
+    int32_t largest_val = (q[0] ^ (q[0] >> 31)) - (q[0] >> 31);
+    uint32_t largest_idx = 0;
+    for (uint32_t i = 1; i < 4; i++) {
+        int32_t abs_val = (q[i] ^ (q[i] >> 31)) - (q[i] >> 31);
+        int32_t mask = -(int32_t)(abs_val > largest_val);
+        largest_val ^= (largest_val ^ abs_val) & mask;
+        largest_idx ^= (largest_idx ^ i) & (uint32_t)mask;
+    }
     
-    for (int i = 1; i < 4; i++) {
-        int16_t abs_val = (q[i] < 0) ? -q[i] : q[i];
-        if (abs_val > largest_val) {
-            largest_val = abs_val;
-            largest_idx = i;
-        }
+    // 最大分量为负时翻转整个四元数 (保持等价): sign = 0 或 -1
+    int32_t sign = q[largest_idx] >> 31;
+    
+    // 3个较小分量缩放到10bit: Q15 / 64, 范围 -512~511
+    uint32_t packed = largest_idx << 30;
+    for (int j = 0; j < 3; j++) {
+        int32_t v = (q[others[largest_idx][j]] ^ sign) - sign;
+        int32_t scaled = (v + 32) >> 6;
+        scaled = scaled > 511 ? 511 : scaled;
+        scaled = scaled < -512 ? -512 : scaled;
+        packed |= ((uint32_t)(scaled + 512) & 0x3FF) << (20 - 10 * j);
     }
     
-    // 如果最大分量为负，翻转整个四元数（保持等价）
-    int16_t sign = (q[largest_idx] < 0) ? -1 : 1;
+    return packed;
+}
+
+void decompress_quat_simple(uint32_t packed, int16_t q[4])
+{
+    // v0.6.3: compress_quat_simple 的逆过程, 最大分量由单位长度恢复 (总为正)
+    uint8_t largest_idx = (packed >> 30) & 0x3;
+    int32_t small[3] = {
+        (int32_t)((packed >> 20) & 0x3FF) - 512,
+        (int32_t)((packed >> 10) & 0x3FF) - 512,
+        (int32_t)(packed & 0x3FF) - 512
+    };
     
-    // 提取3个较小分量 (每个10bit, 范围-512~511)
-    int16_t small[3];
-    int j = 0;
-    for (int i = 0; i < 4; i++) {
-        if (i != largest_idx) {
-            // 缩放到10bit: q[i] 范围是 -32768~32767, 压缩到 -512~511
-            int32_t scaled = ((int32_t)(q[i] * sign) * 512) / 32768;
-            if (scaled > 511) scaled = 511;
-            if (scaled < -512) scaled = -512;
-            small[j++] = (int16_t)scaled;
-        }
+    int32_t sum_sq = 0;
+    for (int i = 0; i < 3; i++) {
+        small[i] *= 64;                         // 10bit → Q15
+        sum_sq += small[i] * small[i];
     }
     
-    // 打包: [2bit index][10bit a][10bit b][10bit c] = 32bit
-    uint32_t packed = 0;
-    packed |= ((uint32_t)largest_idx & 0x3) << 30;
-    packed |= ((uint32_t)(small[0] + 512) & 0x3FF) << 20;
-    packed |= ((uint32_t)(small[1] + 512) & 0x3FF) << 10;
-    packed |= ((uint32_t)(small[2] + 512) & 0x3FF);
+    // largest = sqrt(32768² - sum_sq), 整数牛顿迭代
+    int32_t rem = (int32_t)(1u << 30) - sum_sq;
+    int32_t largest = 0;
+    if (rem > 0) {
+        int32_t x = 32768;
+        for (int i = 0; i < 6; i++) {
+            x = (x + rem / x) >> 1;
+        }
+        largest = (x > 32767) ? 32767 : x;
+    }
     
-    return packed;
+    int j = 0;
+    for (int i = 0; i < 4; i++) {
+        q[i] = (int16_t)((i == largest_idx) ? largest : small[j++]);
+    }
 }
 
 /*============================================================================
@@ -8,9 +8,14 @@
  * - 固件验证和启动
  */
 
+#include "config.h"
 #include "usb_bootloader.h"
 #include "hal.h"
 #include "version.h"
+#include "watchdog.h"
+#include "event_logger.h"       // v0.6.3: 只读日志文件
+#include "telemetry_history.h"
+#include "soak_stats.h"
 #include <string.h>
 
 #ifdef CH59X
@@ -20,6 +25,7 @@
 
 // 外部函数声明
 extern int usb_msc_init(void);
+extern void usb_msc_task(void);
 
 /*============================================================================
  * UF2 格式定义
@@ -542,6 +548,9 @@ int bootloader_enter_update_mode(void)
     bootloader_ctx.total_blocks = 0;
     bootloader_ctx.flash_valid = false;
     
+    // v0.6.3: 更新后的首次启动不走热启动快速路径
+    wdog_boot_token_clear();
+    
     // 初始化 USB MSC
 #ifdef CH59X
     // 切换到 MSC 模式
@@ -573,6 +582,11 @@ void bootloader_exit_update_mode(bool reboot)
  */
 void bootloader_process(void)
 {
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+    // UF2 块在这里编程 (首块到达前状态仍为 IDLE, 所以放在状态检查之前)
+    usb_msc_task();
+#endif
+    
     if (bootloader_ctx.state == BOOT_STATE_IDLE) {
         return;
     }
@@ -622,6 +636,243 @@ boot_error_t bootloader_get_error(void)
     return bootloader_ctx.error;
 }
 
+/*============================================================================
+ * v0.6.3: 只读日志文件 (USE_MSC_LOG_FILES, Tracker)
+ *
+ * 根目录在卷标之后列出 EVENTS.BIN / TELEM.BIN / CRASH.BIN / DIAG.BIN (只读属性),
+ * 各占从 LBA 8 (簇 6, INFO_UF2.TXT 之后) 起的固定连续簇, FAT 链按文件大小生成.
+ * 内容在读扇区时从事件环 / 遥测会话 / 崩溃快照 / 窗口统计现场生成, 不占缓冲:
+ * - EVENTS.BIN: event_log_info_t + 环内 EVENT_RING_BYTES 字节 (旧 -> 新, 结束于 head)
+ * - TELEM.BIN:  telem_session_t 数组 (0 = 当前会话, 之后为历史)
+ * - CRASH.BIN:  crash_snapshot_t + crash_timing_t (同 usb_debug 0x1D), 无快照时为空
+ * - DIAG.BIN:   soak_window_t 数组 (旧 -> 新)
+ * 主机缓存目录和 FAT, 所以文件大小和事件环的 head 在读引导扇区 (挂载) 时锁定,
+ * 重新插拔后更新; 锁定之后被覆盖的事件字节读出为 0. 写入这些簇的数据不是 UF2 块, 被忽略
+ *============================================================================*/
+
+#if defined(USE_MSC_LOG_FILES) && USE_MSC_LOG_FILES && \
+    defined(BUILD_TRACKER) && !defined(BUILD_BENCH)
+#define MSC_LOG_FILES   1
+#else
+#define MSC_LOG_FILES   0
+#endif
+
+#if MSC_LOG_FILES
+
+#define DATA_START_LBA      (RESERVED_SECTORS + NUM_FATS * SECTORS_PER_FAT + 1)     // 簇 2
+#define LOGFS_FIRST_LBA     8
+#define LOGFS_SECTORS(n)    (((n) + SECTOR_SIZE - 1) / SECTOR_SIZE)
+
+#if defined(CRASH_TIMING) && CRASH_TIMING
+#define LOGFS_CRASH_MAX     (sizeof(crash_snapshot_t) + sizeof(crash_timing_t))
+#else
+#define LOGFS_CRASH_MAX     sizeof(crash_snapshot_t)
+#endif
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+#define LOGFS_TELEM_MAX     ((TELEM_HISTORY_DEPTH + 1) * sizeof(telem_session_t))
+#else
+#define LOGFS_TELEM_MAX     0
+#endif
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+#define LOGFS_DIAG_MAX      (SOAK_RING_DEPTH * sizeof(soak_window_t))
+#else
+#define LOGFS_DIAG_MAX      0
+#endif
+
+enum { LOGFS_EVENTS = 0, LOGFS_TELEM, LOGFS_CRASH, LOGFS_DIAG, LOGFS_COUNT };
+
+static const struct {
+    char name[11];
+    u16  sectors;                   // 分配的簇数 (最大文件大小)
+} logfs_files[LOGFS_COUNT] = {
+    { "EVENTS  BIN", LOGFS_SECTORS(sizeof(event_log_info_t) + EVENT_RING_BYTES) },
+    { "TELEM   BIN", LOGFS_SECTORS(LOGFS_TELEM_MAX) },
+    { "CRASH   BIN", LOGFS_SECTORS(LOGFS_CRASH_MAX) },
+    { "DIAG    BIN", LOGFS_SECTORS(LOGFS_DIAG_MAX) },
+};
+
+// 挂载时锁定 (USB 中断中读写)
+static struct {
+    bool latched;
+    u32  size[LOGFS_COUNT];
+    event_log_info_t events;        // 锁定时的环状态, 文件内容结束于 events.head
+    u16  diag_first;                // 第一个窗口的序号
+} logfs;
+
+static u32 logfs_first_lba(u8 file)
+{
+    u32 lba = LOGFS_FIRST_LBA;
+    for (u8 i = 0; i < file; i++) lba += logfs_files[i].sectors;
+    return lba;
+}
+
+static void logfs_latch(void)
+{
+    memset(&logfs, 0, sizeof(logfs));
+
+    event_log_get_info(&logfs.events);
+    logfs.size[LOGFS_EVENTS] = sizeof(event_log_info_t) + EVENT_RING_BYTES;
+
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    telem_session_t s;
+    u8 n = 0;
+    while (n <= TELEM_HISTORY_DEPTH && telem_get_session(n, &s)) n++;
+    logfs.size[LOGFS_TELEM] = n * sizeof(telem_session_t);
+#endif
+
+    crash_snapshot_t snap;
+    if (wdog_get_crash_snapshot(&snap)) {
+        logfs.size[LOGFS_CRASH] = LOGFS_CRASH_MAX;
+    }
+
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    u16 first, next;
+    soak_read(0, NULL, 0, &first, &next);
+    logfs.diag_first = first;
+    logfs.size[LOGFS_DIAG] = (u16)(next - first) * sizeof(soak_window_t);
+#endif
+
+    logfs.latched = true;
+}
+
+// 文件内偏移 at 起的 n 字节 src 中落在本扇区 [base, base + SECTOR_SIZE) 的部分拷入 data
+static void logfs_span(u8 *data, u32 base, u32 at, const void *src, u32 n)
+{
+    if (at + n <= base || at >= base + SECTOR_SIZE) return;
+    u32 from = (at < base) ? base - at : 0;
+    u32 to = (at + n > base + SECTOR_SIZE) ? base + SECTOR_SIZE - at : n;
+    memcpy(data + (at + from - base), (const u8 *)src + from, to - from);
+}
+
+// 定长记录数组中与本扇区相交的记录下标范围 [*k0, *k1)
+static void logfs_records(u32 base, u32 rec_size, u32 count, u32 *k0, u32 *k1)
+{
+    *k0 = base / rec_size;
+    *k1 = (base + SECTOR_SIZE + rec_size - 1) / rec_size;
+    if (*k1 > count) *k1 = count;
+}
+
+static void logfs_fill(u8 file, u32 base, u8 *data)
+{
+    u32 size = logfs.size[file];
+
+    switch (file) {
+    case LOGFS_EVENTS: {
+        logfs_span(data, base, 0, &logfs.events, sizeof(logfs.events));
+        u16 start = (u16)(logfs.events.head - EVENT_RING_BYTES);
+        u16 pos = start;
+        while (pos != logfs.events.head) {
+            u8 n;
+            const u8 *p = event_log_peek(pos, 0xFF, &n);
+            if (!p) {
+                // 锁定之后被新记录覆盖的部分留 0, 从当前最旧的字节继续
+                u16 oldest = (u16)(event_log_head() - EVENT_RING_BYTES);
+                if (oldest == pos || (u16)(logfs.events.head - oldest) > EVENT_RING_BYTES) break;
+                pos = oldest;
+                continue;
+            }
+            logfs_span(data, base, sizeof(event_log_info_t) + (u16)(pos - start), p, n);
+            pos = (u16)(pos + n);
+        }
+        break;
+    }
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+    case LOGFS_TELEM: {
+        u32 k0, k1;
+        logfs_records(base, sizeof(telem_session_t), size / sizeof(telem_session_t), &k0, &k1);
+        for (u32 k = k0; k < k1; k++) {
+            telem_session_t s;
+            if (!telem_get_session((u8)k, &s)) break;
+            logfs_span(data, base, k * sizeof(s), &s, sizeof(s));
+        }
+        break;
+    }
+#endif
+    case LOGFS_CRASH: {
+        struct __attribute__((packed)) {
+            crash_snapshot_t snap;
+#if defined(CRASH_TIMING) && CRASH_TIMING
+            crash_timing_t timing;
+#endif
+        } blob;
+        memset(&blob, 0, sizeof(blob));
+        if (size == 0 || !wdog_get_crash_snapshot(&blob.snap)) break;
+#if defined(CRASH_TIMING) && CRASH_TIMING
+        wdog_get_crash_timing(&blob.timing);
+#endif
+        logfs_span(data, base, 0, &blob, sizeof(blob));
+        break;
+    }
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+    case LOGFS_DIAG: {
+        u32 k0, k1;
+        logfs_records(base, sizeof(soak_window_t), size / sizeof(soak_window_t), &k0, &k1);
+        for (u32 k = k0; k < k1; k++) {
+            soak_window_t w;
+            if (soak_read((u16)(logfs.diag_first + k), &w, 1, NULL, NULL) == 0) break;
+            logfs_span(data, base, k * sizeof(w), &w, sizeof(w));
+        }
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+}
+
+static void fat12_set(u8 *fat, u16 cluster, u16 val)
+{
+    u16 off = cluster + cluster / 2;
+    if (cluster & 1) {
+        fat[off] = (u8)((fat[off] & 0x0F) | (val << 4));
+        fat[off + 1] = (u8)(val >> 4);
+    } else {
+        fat[off] = (u8)val;
+        fat[off + 1] = (u8)((fat[off + 1] & 0xF0) | ((val >> 8) & 0x0F));
+    }
+}
+
+static void logfs_fat(u8 *data)
+{
+    for (u8 i = 0; i < LOGFS_COUNT; i++) {
+        u16 n = (u16)LOGFS_SECTORS(logfs.size[i]);
+        u16 cluster = (u16)(logfs_first_lba(i) - DATA_START_LBA + 2);
+        for (u16 c = 0; c < n; c++) {
+            fat12_set(data, cluster + c, (c + 1 < n) ? (u16)(cluster + c + 1) : 0xFFF);
+        }
+    }
+}
+
+static void logfs_dir(u8 *data)
+{
+    u8 *e = data + sizeof(fat_root_dir);
+    for (u8 i = 0; i < LOGFS_COUNT; i++) {
+        if (logfs_files[i].sectors == 0) continue;
+        u32 size = logfs.size[i];
+        u16 cluster = size ? (u16)(logfs_first_lba(i) - DATA_START_LBA + 2) : 0;
+        memcpy(e, logfs_files[i].name, 11);
+        e[11] = 0x01;                                   // 只读
+        e[26] = cluster & 0xFF;
+        e[27] = cluster >> 8;
+        memcpy(&e[28], &size, 4);
+        e += 32;
+    }
+}
+
+// 日志文件所在扇区按文件内容生成, 文件末尾之后和空闲扇区为 0
+static void logfs_read(u32 lba, u8 *data)
+{
+    for (u8 i = 0; i < LOGFS_COUNT; i++) {
+        u32 first = logfs_first_lba(i);
+        if (lba < first || lba >= first + logfs_files[i].sectors) continue;
+        u32 base = (lba - first) * SECTOR_SIZE;
+        if (base < logfs.size[i]) logfs_fill(i, base, data);
+        return;
+    }
+}
+
+#endif /* MSC_LOG_FILES */
+
 /*============================================================================
  * MSC 回调函数 (供 usb_msc.c 调用)
  *============================================================================*/
@@ -645,6 +896,12 @@ s32 msc_read(u32 lba, u32 offset, void *buffer, u32 length)
     // 确保缓冲区清零
     memset(data, 0, length);
     
+#if MSC_LOG_FILES
+    // v0.6.3: 日志文件按整扇区生成 (usb_msc.c 每扇区调用一次)
+    bool logfs_ok = (length >= SECTOR_SIZE);
+    if (logfs_ok && (lba == 0 || !logfs.latched)) logfs_latch();
+#endif
+    
     if (lba == 0) {
         // Boot sector (引导扇区)
         if (length >= sizeof(fat_boot_sector)) {
@@ -655,10 +912,17 @@ s32 msc_read(u32 lba, u32 offset, void *buffer, u32 length)
         data[0] = 0xF8;  // Media type
         data[1] = 0xFF;
         data[2] = 0xFF;
+#if MSC_LOG_FILES
+        if (logfs_ok) logfs_fat(data);
+#endif
     } else if (lba == 3) {
         // Root directory (根目录)
         memcpy(data, fat_root_dir, sizeof(fat_root_dir));
-    } else if (lba >= 4 && lba < 8) {
+#if MSC_LOG_FILES
+        if (logfs_ok) logfs_dir(data);
+#endif
+    }
+    else if (lba >= 4 && lba < 8) {
         // INFO_UF2.TXT 内容
         const char *info = "UF2 Bootloader " FIRMWARE_VERSION_STRING "\r\n"
                           "Model: SlimeVR CH59X Tracker\r\n"
@@ -671,6 +935,11 @@ s32 msc_read(u32 lba, u32 offset, void *buffer, u32 length)
             memcpy(data, info + info_offset, copy_len);
         }
     }
+#if MSC_LOG_FILES
+    else if (logfs_ok) {
+        logfs_read(lba, data);
+    }
+#endif
     
     return length;
 }
@@ -10,11 +10,20 @@
  * 
  * 同时支持 Tracker 和 Receiver
  * Receiver 可同时接收数据和调试
+ * v0.6.3: Receiver 没有传感器数据, 只编译通用命令和 RF 时序追踪流,
+ *         命令由 main_receiver 的 USB 回调转交 usb_debug_command()
  */
 
 #include "hal.h"
 #include "usb_hid_slime.h"
 #include "version.h"      // FIRMWARE_VERSION_xxx
+#include "profile.h"      // v0.6.3: 周期计数探针
+#include "event_logger.h" // v0.6.3: 事件环读出
+#include "telemetry_history.h" // v0.6.3: 跨重启遥测汇总
+#include "soak_stats.h"     // v0.6.3: 窗口统计
+#include "watchdog.h"     // v0.6.3: 任务耗时预算
+#include "fuel_gauge.h"   // v0.6.3: 电量计
+#include "wake_profile.h" // v0.6.3: 唤醒分段计时
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -23,6 +32,43 @@
 #include "CH59x_common.h"  // SYS_ResetExecute
 #endif
 
+#if defined(BUILD_RECEIVER) && defined(USE_RF_AIRTIME_TRACE) && USE_RF_AIRTIME_TRACE
+#include "rf_airtime_trace.h"
+#define DBG_RF_TRACE        1
+#else
+#define DBG_RF_TRACE        0
+#endif
+
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+#include "rf_auth.h"
+#endif
+
+#if !defined(BUILD_RECEIVER) && defined(USE_IMU_CAPTURE) && USE_IMU_CAPTURE
+#include "imu_capture.h"
+#define DBG_IMU_CAPTURE     1
+#else
+#define DBG_IMU_CAPTURE     0
+#endif
+
+#if !defined(BUILD_RECEIVER) && defined(USE_SELFTEST) && USE_SELFTEST
+#include "selftest.h"
+#define DBG_SELFTEST        1
+#else
+#define DBG_SELFTEST        0
+#endif
+
+#if !defined(BUILD_RECEIVER) && defined(USE_USB_WIRED_STREAM) && USE_USB_WIRED_STREAM
+#define DBG_WIRED           1
+#else
+#define DBG_WIRED           0
+#endif
+
+#define DBG_STREAM_RF_TRACE 0x10    // stream_mask bit4: 超帧时序追踪
+#define DBG_STREAM_IMU_RAW  0x20    // stream_mask bit5: 原始 IMU 采集 (Tracker)
+#define DBG_TRACE_BURST     4       // 每次处理最多发送的追踪报告数
+#define DBG_CAPTURE_BURST   8       // 每次处理最多发送的采集报告数
+#define DBG_WIRED_REPORT    0xFD    // 有线数据流样本报告
+
 /*============================================================================
  * 调试命令定义
  *============================================================================*/
@@ -40,14 +86,24 @@ typedef enum {
     DBG_CMD_GET_BATTERY     = 0x13,
     DBG_CMD_GET_TEMP        = 0x14,
     DBG_CMD_GET_STATS       = 0x15,
+    DBG_CMD_GET_PROFILE     = 0x16,     // v0.6.3: [1]=探针索引, 0xFF=全部清零
+    DBG_CMD_GET_EVENTS      = 0x17,     // v0.6.3: 无参数=环状态, [1-2]=位置 读环内字节
+    DBG_CMD_GET_TELEMETRY   = 0x18,     // v0.6.3: [1]=会话索引 (0=当前, 1..=历史)
+    DBG_CMD_GET_TASKS       = 0x19,     // v0.6.3: [1]=任务索引, 0xFF=清零, 0xFE=设置卸载模式
+    DBG_CMD_GET_WAKE        = 0x1A,     // v0.6.3: 最近一次唤醒的分段耗时 (Tracker)
+    DBG_CMD_SELFTEST        = 0x1B,     // v0.6.3: [1]=子命令, 器件特性测量 (Tracker, 见 selftest.h)
+    DBG_CMD_GET_SOAK        = 0x1C,     // v0.6.3: [1-2]=起始窗口序号, 窗口统计批量读出
+    DBG_CMD_GET_CRASH       = 0x1D,     // v0.6.3: [1-2]=偏移, 崩溃快照 + 时序分段读出
     
     DBG_CMD_CALIBRATE       = 0x20,
     DBG_CMD_RESET           = 0x21,
     DBG_CMD_ENTER_BOOT      = 0x22,
     DBG_CMD_SAVE_CONFIG     = 0x23,
+    DBG_CMD_SET_LINK_KEY    = 0x25,     // v0.6.3: [1-16]=链路密钥 (全 0 = 清除), 无参数=查询
     
     DBG_CMD_STREAM_START    = 0x30,
     DBG_CMD_STREAM_STOP     = 0x31,
+    DBG_CMD_WIRED_STREAM    = 0x32,     // v0.6.3: [1]=1 开始 / 0 停止有线数据流 (Tracker)
     
     DBG_CMD_MAG_ENABLE      = 0x40,
     DBG_CMD_MAG_DISABLE     = 0x41,
@@ -68,9 +124,14 @@ typedef enum {
 typedef struct {
     bool enabled;
     bool streaming;
-    uint8_t stream_mask;    // bit0=quat, bit1=gyro, bit2=accel, bit3=temp
+    uint8_t stream_mask;    // bit0=quat, bit1=gyro, bit2=accel, bit3=temp, bit4=RF 追踪 (Receiver), bit5=原始 IMU (Tracker)
     uint32_t stream_interval_ms;
     uint32_t last_stream_ms;
+#if DBG_WIRED
+    bool wired;             // 主机请求有线数据流
+    uint8_t wired_seq;      // 每样本递增, 端点忙丢弃的样本在主机端表现为序号缺口
+    uint32_t wired_drops;
+#endif
     
     // 统计
     uint32_t rx_count;
@@ -84,6 +145,7 @@ static uint8_t tx_buf[64];
  * 外部数据引用
  *============================================================================*/
 
+#if !defined(BUILD_RECEIVER)
 // Tracker
 extern float quaternion[4];
 extern float gyro[3], accel[3];
@@ -102,6 +164,7 @@ extern bool auto_calib_is_valid(void);
 extern int mag_enable(void);
 extern int mag_disable(void);
 extern int mag_calibrate_start(void);
+#endif
 
 // Bootloader
 extern int bootloader_enter_update_mode(void);
@@ -122,23 +185,31 @@ static void handle_command(const uint8_t *data, uint8_t len)
         case DBG_CMD_PING:
             tx_buf[1] = 'O';
             tx_buf[2] = 'K';
-            usb_hid_write(tx_buf, 3);
+            {
+                // v0.6.3: [3-10] hal_micros64 (LE), 主机据此对齐设备时间, 长时间测试不回绕
+                uint64_t now_us = hal_micros64();
+                for (uint8_t i = 0; i < 8; i++) {
+                    tx_buf[3 + i] = (uint8_t)(now_us >> (8 * i));
+                }
+            }
+            usb_hid_reply(tx_buf, 11);
             break;
             
         case DBG_CMD_GET_VERSION:
             tx_buf[1] = FIRMWARE_VERSION_MAJOR;
             tx_buf[2] = FIRMWARE_VERSION_MINOR;
             tx_buf[3] = FIRMWARE_VERSION_PATCH;
-            usb_hid_write(tx_buf, 4);
+            usb_hid_reply(tx_buf, 4);
             break;
             
+#if !defined(BUILD_RECEIVER)
         case DBG_CMD_GET_STATUS:
             tx_buf[1] = tracker_id;
             tx_buf[2] = (uint8_t)battery_percent;
             tx_buf[3] = is_charging ? 1 : 0;
             tx_buf[4] = auto_calib_is_valid() ? 1 : 0;
             tx_buf[5] = dbg.streaming ? 1 : 0;
-            usb_hid_write(tx_buf, 6);
+            usb_hid_reply(tx_buf, 6);
             break;
             
         case DBG_CMD_GET_SENSORS:
@@ -156,7 +227,7 @@ static void handle_command(const uint8_t *data, uint8_t len)
                 tx_buf[7] = ax & 0xFF; tx_buf[8] = ax >> 8;
                 tx_buf[9] = ay & 0xFF; tx_buf[10] = ay >> 8;
                 tx_buf[11] = az & 0xFF; tx_buf[12] = az >> 8;
-                usb_hid_write(tx_buf, 13);
+                usb_hid_reply(tx_buf, 13);
             }
             break;
             
@@ -171,25 +242,43 @@ static void handle_command(const uint8_t *data, uint8_t len)
                 tx_buf[3] = qx & 0xFF; tx_buf[4] = qx >> 8;
                 tx_buf[5] = qy & 0xFF; tx_buf[6] = qy >> 8;
                 tx_buf[7] = qz & 0xFF; tx_buf[8] = qz >> 8;
-                usb_hid_write(tx_buf, 9);
+                usb_hid_reply(tx_buf, 9);
             }
             break;
             
+#if defined(USE_FUEL_GAUGE) && USE_FUEL_GAUGE
+        case DBG_CMD_GET_BATTERY:
+            // v0.6.3: [1]=%, [2]=充电, [3-4]=开路电压 mV, [5-6]=端电压 mV, [7-8]=剩余分钟 (0xFFFF 未知)
+            {
+                uint16_t ocv = fuel_gauge_get_ocv_mv();
+                uint16_t raw = fuel_gauge_get_raw_mv();
+                uint16_t tte = fuel_gauge_get_tte_min();
+                tx_buf[1] = battery_percent;
+                tx_buf[2] = is_charging ? 1 : 0;
+                tx_buf[3] = ocv & 0xFF; tx_buf[4] = ocv >> 8;
+                tx_buf[5] = raw & 0xFF; tx_buf[6] = raw >> 8;
+                tx_buf[7] = tte & 0xFF; tx_buf[8] = tte >> 8;
+                usb_hid_reply(tx_buf, 9);
+            }
+            break;
+#endif
+            
         case DBG_CMD_GET_TEMP:
             {
                 float temp = temp_comp_get_temp();
                 int16_t t = (int16_t)(temp * 100);
                 tx_buf[1] = t & 0xFF;
                 tx_buf[2] = t >> 8;
-                usb_hid_write(tx_buf, 3);
+                usb_hid_reply(tx_buf, 3);
             }
             break;
             
         case DBG_CMD_CALIBRATE:
             auto_calib_force();
             tx_buf[1] = 1;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
+#endif
             
         case DBG_CMD_RESET:
             hal_delay_ms(100);
@@ -204,36 +293,263 @@ static void handle_command(const uint8_t *data, uint8_t len)
         case DBG_CMD_ENTER_BOOT:
             bootloader_enter_update_mode();
             tx_buf[1] = 1;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
+            break;
+            
+#if defined(USE_RF_LINK_AUTH) && USE_RF_LINK_AUTH
+        case DBG_CMD_SET_LINK_KEY:
+            // v0.6.3: 链路密钥只经 USB 写入, 不回读; [1]=1 成功 [2]=链路已认证加密
+            tx_buf[1] = 1;
+            if (len > RF_AUTH_KEY_SIZE) {
+                tx_buf[1] = (rf_auth_set_key(&data[1]) == 0) ? 1 : 0;
+            }
+            tx_buf[2] = rf_auth_active() ? 1 : 0;
+            usb_hid_reply(tx_buf, 3);
+            break;
+#endif
+            
+        case DBG_CMD_GET_PROFILE:
+            // v0.6.3: [1]=索引 [2]=探针数 [3-6]次数 [7-10]最小 [11-14]最大 [15-22]累计 (周期, LE)
+            //         [23..] 名称 (NUL 结尾); 未启用 USE_PROFILE 时 [1]=0xFE
+            {
+                uint8_t id = (len > 1) ? data[1] : 0;
+                prof_stat_t st;
+                
+                if (id == 0xFF) {
+                    prof_reset();
+                    tx_buf[1] = 0xFF;
+                    usb_hid_reply(tx_buf, 2);
+                    break;
+                }
+                if (prof_get(id, &st) != 0) {
+                    tx_buf[1] = (id < PROF_COUNT) ? 0xFE : 0xFF;
+                    tx_buf[2] = PROF_COUNT;
+                    usb_hid_reply(tx_buf, 3);
+                    break;
+                }
+                tx_buf[1] = id;
+                tx_buf[2] = PROF_COUNT;
+                memcpy(&tx_buf[3], &st.count, 4);
+                memcpy(&tx_buf[7], &st.min, 4);
+                memcpy(&tx_buf[11], &st.max, 4);
+                memcpy(&tx_buf[15], &st.total, 8);
+                
+                const char *name = prof_name(id);
+                uint8_t n = (uint8_t)strlen(name);
+                if (n > 24) n = 24;
+                memcpy(&tx_buf[23], name, n);
+                tx_buf[23 + n] = 0;
+                usb_hid_reply(tx_buf, 24 + n);
+            }
+            break;
+            
+        case DBG_CMD_GET_EVENTS:
+            // v0.6.3: 无参数: [1-2]head [3-4]环大小 [5-8]最新记录时间 [9-12]当前时间 [13-16]累计记录数
+            //         [1-2]=pos: [1-2]pos [3-4]复制后的 head [5]字节数 [6..] 环内原始字节
+            //         主机丢弃 pos < head - 环大小 的字节, 解码和 JSON 见 tools/event_dump.py
+            if (len < 3) {
+                event_log_info_t info;
+                event_log_get_info(&info);
+                memcpy(&tx_buf[1], &info.head, 2);
+                memcpy(&tx_buf[3], &info.size, 2);
+                memcpy(&tx_buf[5], &info.last_ms, 4);
+                memcpy(&tx_buf[9], &info.now_ms, 4);
+                memcpy(&tx_buf[13], &info.count, 4);
+                usb_hid_reply(tx_buf, 17);
+            } else {
+                uint16_t pos = data[1] | ((uint16_t)data[2] << 8);
+                uint8_t n = 0;
+                const uint8_t *src = event_log_peek(pos, sizeof(tx_buf) - 6, &n);
+                if (src) {
+                    memcpy(&tx_buf[6], src, n);
+                }
+                uint16_t head = event_log_head();
+                memcpy(&tx_buf[1], &pos, 2);
+                memcpy(&tx_buf[3], &head, 2);
+                tx_buf[5] = n;
+                usb_hid_reply(tx_buf, 6 + n);
+            }
+            break;
+            
+#if defined(USE_TELEMETRY_HISTORY) && USE_TELEMETRY_HISTORY
+        case DBG_CMD_GET_TELEMETRY:
+            // v0.6.3: [1]索引 [2]有效 [3..] telem_session_t, 解码见 tools/telemetry_dump.py
+            {
+                telem_session_t s;
+                uint8_t index = (len > 1) ? data[1] : 0;
+                bool ok = telem_get_session(index, &s);
+                tx_buf[1] = index;
+                tx_buf[2] = ok ? 1 : 0;
+                if (ok) {
+                    memcpy(&tx_buf[3], &s, sizeof(s));
+                }
+                usb_hid_reply(tx_buf, ok ? 3 + sizeof(s) : 3);
+            }
+            break;
+#endif
+            
+#if defined(USE_SOAK_STATS) && USE_SOAK_STATS
+        case DBG_CMD_GET_SOAK:
+            // v0.6.3: [1-2]第一条的序号 [3-4]下一个窗口序号 [5]条数 [6..] soak_window_t (LE);
+            //         请求序号已被覆盖时从最旧一条开始, 主机按序号差计丢失窗口
+            {
+                soak_window_t w[(sizeof(tx_buf) - 6) / sizeof(soak_window_t)];
+                uint16_t from = (len > 2) ? (uint16_t)(data[1] | (data[2] << 8)) : 0;
+                uint16_t first, next;
+                uint8_t n = soak_read(from, w, sizeof(w) / sizeof(w[0]), &first, &next);
+                memcpy(&tx_buf[1], &first, 2);
+                memcpy(&tx_buf[3], &next, 2);
+                tx_buf[5] = n;
+                memcpy(&tx_buf[6], w, n * sizeof(soak_window_t));
+                usb_hid_reply(tx_buf, 6 + n * sizeof(soak_window_t));
+            }
+            break;
+#endif
+            
+#if defined(USE_TASK_BUDGET) && USE_TASK_BUDGET
+        case DBG_CMD_GET_TASKS:
+            // v0.6.3: [1]=索引 [2]=任务数 [3]=卸载模式 [4-7]次数 [8-11]超预算 [12-15]被跳过
+            //         [16-17]预算us [18-19]最大us (LE); [1]=0xFF 清零; [1]=0xFE [2]=0/1 设置卸载模式
+            {
+                uint8_t id = (len > 1) ? data[1] : 0;
+                task_budget_stat_t st;
+                
+                if (id == 0xFF || id == 0xFE) {
+                    if (id == 0xFF) {
+                        task_budget_reset();
+                    } else if (len > 2) {
+                        task_budget_set_shed(data[2] != 0);
+                    }
+                    tx_buf[1] = id;
+                    tx_buf[2] = TASK_COUNT;
+                    tx_buf[3] = task_budget_shed_enabled() ? 1 : 0;
+                    usb_hid_reply(tx_buf, 4);
+                    break;
+                }
+                if (task_budget_get(id, &st) != 0) {
+                    tx_buf[1] = 0xFD;
+                    tx_buf[2] = TASK_COUNT;
+                    usb_hid_reply(tx_buf, 3);
+                    break;
+                }
+                tx_buf[1] = id;
+                tx_buf[2] = TASK_COUNT;
+                tx_buf[3] = task_budget_shed_enabled() ? 1 : 0;
+                memcpy(&tx_buf[4], &st.count, 4);
+                memcpy(&tx_buf[8], &st.overruns, 4);
+                memcpy(&tx_buf[12], &st.shed, 4);
+                memcpy(&tx_buf[16], &st.budget_us, 2);
+                memcpy(&tx_buf[18], &st.max_us, 2);
+                usb_hid_reply(tx_buf, 20);
+            }
             break;
+#endif
+            
+#if CRASH_TIMING
+        case DBG_CMD_GET_CRASH:
+            // v0.6.3: [1]有效 [2-3]总长 [4-5]偏移 [6]字节数 [7..] crash_snapshot_t + crash_timing_t
+            //         自偏移起的原始字节 (LE), 解码见 tools/crash_dump.py
+            {
+                struct __attribute__((packed)) {
+                    crash_snapshot_t snap;
+                    crash_timing_t timing;
+                } blob;
+                uint16_t off = (len > 2) ? (uint16_t)(data[1] | (data[2] << 8)) : 0;
+                uint16_t total = sizeof(blob);
+                bool ok = wdog_get_crash_snapshot(&blob.snap) && wdog_get_crash_timing(&blob.timing);
+                uint8_t n = 0;
+                if (ok && off < total) {
+                    uint16_t left = total - off;
+                    n = (left > sizeof(tx_buf) - 7) ? (uint8_t)(sizeof(tx_buf) - 7) : (uint8_t)left;
+                    memcpy(&tx_buf[7], (const uint8_t *)&blob + off, n);
+                }
+                tx_buf[1] = ok ? 1 : 0;
+                memcpy(&tx_buf[2], &total, 2);
+                memcpy(&tx_buf[4], &off, 2);
+                tx_buf[6] = n;
+                usb_hid_reply(tx_buf, 7 + n);
+            }
+            break;
+#endif
+            
+#if !defined(BUILD_RECEIVER) && defined(USE_WAKE_PROFILE) && USE_WAKE_PROFILE
+        case DBG_CMD_GET_WAKE:
+            // v0.6.3: [1]来源 [2]完成 [3-4]进入 Shutdown us [5-8]总计 us [9..]各阶段 us (LE u32)
+            {
+                wake_profile_t wp;
+                wake_prof_get(&wp);
+                tx_buf[1] = wp.source;
+                tx_buf[2] = wp.complete;
+                memcpy(&tx_buf[3], &wp.entry_us, 2);
+                memcpy(&tx_buf[5], &wp.total_us, 4);
+                memcpy(&tx_buf[9], wp.phase_us, sizeof(wp.phase_us));
+                usb_hid_reply(tx_buf, 9 + sizeof(wp.phase_us));
+            }
+            break;
+#endif
+            
+#if DBG_SELFTEST
+        case DBG_CMD_SELFTEST:
+            // v0.6.3: [1]=子命令 [2..] 状态/耗时/Allan 偏差, 解码见 tools/selftest.py
+            usb_hid_reply(tx_buf, 1 + selftest_command(data, len, &tx_buf[1]));
+            break;
+#endif
             
         case DBG_CMD_STREAM_START:
             dbg.streaming = true;
             dbg.stream_mask = (len > 1) ? data[1] : 0x0F;
             dbg.stream_interval_ms = (len > 2) ? (data[2] * 10) : 50;
+#if DBG_RF_TRACE
+            rf_trace_enable((dbg.stream_mask & DBG_STREAM_RF_TRACE) != 0);
+#endif
+#if DBG_IMU_CAPTURE
+            imu_capture_enable((dbg.stream_mask & DBG_STREAM_IMU_RAW) != 0);
+#endif
             tx_buf[1] = 1;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
             
         case DBG_CMD_STREAM_STOP:
             dbg.streaming = false;
+#if DBG_RF_TRACE
+            rf_trace_enable(false);
+#endif
+#if DBG_IMU_CAPTURE
+            imu_capture_enable(false);
+#endif
             tx_buf[1] = 1;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
             
+#if DBG_WIRED
+        case DBG_CMD_WIRED_STREAM:
+            // v0.6.3: [1]=当前请求状态 [2-5]=累计丢弃样本数 (LE)
+            if (len > 1) {
+                dbg.wired = (data[1] != 0);
+                dbg.wired_seq = 0;
+                dbg.wired_drops = 0;
+            }
+            tx_buf[1] = dbg.wired ? 1 : 0;
+            memcpy(&tx_buf[2], &dbg.wired_drops, 4);
+            usb_hid_reply(tx_buf, 6);
+            break;
+#endif
+            
+#if !defined(BUILD_RECEIVER)
         case DBG_CMD_MAG_ENABLE:
             tx_buf[1] = (mag_enable() == 0) ? 1 : 0;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
             
         case DBG_CMD_MAG_DISABLE:
             tx_buf[1] = (mag_disable() == 0) ? 1 : 0;
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
+#endif
             
         default:
             tx_buf[1] = 0xFF;  // 未知命令
-            usb_hid_write(tx_buf, 2);
+            usb_hid_reply(tx_buf, 2);
             break;
     }
     
@@ -248,6 +564,32 @@ static void stream_output(void)
 {
     if (!dbg.streaming) return;
     
+#if DBG_RF_TRACE
+    // v0.6.3: 追踪报告不按间隔节流, 每帧 1-2 个, 读取跟不上时由采集端丢帧计数
+    if (dbg.stream_mask & DBG_STREAM_RF_TRACE) {
+        for (uint8_t i = 0; i < DBG_TRACE_BURST; i++) {
+            uint8_t n = rf_trace_read(tx_buf);
+            if (n == 0) break;
+            usb_hid_write(tx_buf, n);
+            dbg.tx_count++;
+        }
+    }
+#endif
+    
+#if DBG_IMU_CAPTURE
+    // v0.6.3: 采集报告同样不节流; 端点忙时不确认, 样本留在缓冲中下次重发
+    if (dbg.stream_mask & DBG_STREAM_IMU_RAW) {
+        for (uint8_t i = 0; i < DBG_CAPTURE_BURST; i++) {
+            uint8_t n = imu_capture_build(tx_buf);
+            if (n == 0) break;
+            if (usb_hid_write(tx_buf, n) < 0) break;
+            imu_capture_ack();
+            dbg.tx_count++;
+        }
+    }
+#endif
+    
+#if !defined(BUILD_RECEIVER)
     uint32_t now = hal_get_tick_ms();
     if (now - dbg.last_stream_ms < dbg.stream_interval_ms) return;
     dbg.last_stream_ms = now;
@@ -304,21 +646,60 @@ static void stream_output(void)
     
     usb_hid_write(tx_buf, idx);
     dbg.tx_count++;
+#endif
 }
 
+#if DBG_WIRED
+/*============================================================================
+ * v0.6.3: 有线数据流
+ *============================================================================*/
+
+bool usb_debug_wired_active(void)
+{
+    return dbg.wired && usb_hid_ready();
+}
+
+void usb_debug_wired_sample(const float quat[4], const float acc[3], uint32_t sample_us)
+{
+    // 不与 tx_buf 共用: 命令应答在 USB 中断中写 tx_buf
+    uint8_t buf[22];
+    uint8_t idx = 0;
+    
+    buf[idx++] = DBG_WIRED_REPORT;
+    buf[idx++] = dbg.wired_seq++;
+    memcpy(&buf[idx], &sample_us, 4);
+    idx += 4;
+    for (int i = 0; i < 4; i++) {
+        int16_t q = (int16_t)(quat[i] * 32767);
+        buf[idx++] = q & 0xFF;
+        buf[idx++] = q >> 8;
+    }
+    for (int i = 0; i < 3; i++) {
+        int16_t a = (int16_t)(acc[i] * 100);
+        buf[idx++] = a & 0xFF;
+        buf[idx++] = a >> 8;
+    }
+    buf[idx++] = battery_percent;
+    buf[idx++] = is_charging ? 1 : 0;
+    
+    if (usb_hid_write(buf, idx) < 0) {
+        dbg.wired_drops++;
+    } else {
+        dbg.tx_count++;
+    }
+}
+#endif
+
 /*============================================================================
  * 日志输出
  *============================================================================*/
 
-void debug_log(const char *fmt, ...)
+static void log_vprintf(const char *fmt, va_list args)
 {
     if (!dbg.enabled) return;
     
     char buf[56];
-    va_list args;
-    va_start(args, fmt);
     int len = vsnprintf(buf, sizeof(buf), fmt, args);
-    va_end(args);
     
     if (len > 0 && len < 56) {
         tx_buf[0] = DBG_CMD_LOG | 0x80;
@@ -328,6 +709,23 @@ void debug_log(const char *fmt, ...)
     }
 }
 
+void debug_log(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    log_vprintf(fmt, args);
+    va_end(args);
+}
+
+// v0.6.3: 头文件声明的接口此前未实现, 与 debug_log 共用同一输出路径
+void usb_debug_printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    log_vprintf(fmt, args);
+    va_end(args);
+}
+
 /*============================================================================
  * USB 回调
  *============================================================================*/
@@ -346,9 +744,20 @@ static void rx_callback(const uint8_t *data, uint8_t len)
 
 void usb_debug_process(void)
 {
+#if DBG_WIRED
+    // 总线复位/拔出后不自动恢复, 重新插入需主机再次请求
+    if (dbg.wired && !usb_hid_connected()) {
+        dbg.wired = false;
+    }
+#endif
     stream_output();
 }
 
+void usb_debug_command(const uint8_t *data, uint8_t len)
+{
+    handle_command(data, len);
+}
+
 void usb_debug_init(void)
 {
     memset(&dbg, 0, sizeof(dbg));
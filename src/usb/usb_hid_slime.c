@@ -8,14 +8,40 @@
 
 #include "usb_hid_slime.h"
 #include "hal.h"
+#include "profile.h"
 #include "version.h"
 #include <string.h>
 
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+#include "rf_ultra.h"
+#endif
+
 #ifdef CH59X
 #include "CH59x_common.h"
 #include "ch59x_usb_regs.h"  // 补充 USB 寄存器定义
 #endif
 
+// v0.6.3: 批量数据流只加在 Receiver 描述符上 (Tracker 使用 usb_msc.c 的中断和描述符)
+#if defined(USE_USB_BULK_STREAM) && USE_USB_BULK_STREAM && defined(BUILD_RECEIVER)
+#define USB_BULK_ENABLED        1
+#define USB_CONFIG_TOTAL_LEN    (41 + 9 + 7)
+#define USB_NUM_INTERFACES      2
+#if (USB_BULK_FIFO_SIZE & (USB_BULK_FIFO_SIZE - 1)) != 0 || USB_BULK_FIFO_SIZE > 32768
+#error "USB_BULK_FIFO_SIZE must be a power of 2 <= 32768"
+#endif
+#else
+#define USB_BULK_ENABLED        0
+#define USB_CONFIG_TOTAL_LEN    41
+#define USB_NUM_INTERFACES      1
+#endif
+
+// v0.6.3: Feature 报告诊断通道同样只在 Receiver 上 (EP0 数据阶段由本文件的中断处理)
+#if defined(USE_USB_FEATURE_DIAG) && USE_USB_FEATURE_DIAG && defined(BUILD_RECEIVER)
+#define USB_FEATURE_ENABLED     1
+#else
+#define USB_FEATURE_ENABLED     0
+#endif
+
 /*============================================================================
  * USB 描述符定义 / USB Descriptors
  *============================================================================*/
@@ -42,6 +68,16 @@ static const uint8_t usb_hid_report_desc[] = {
     0x95, 0x40,             //   Report Count (64)
     0x91, 0x02,             //   Output (Data, Var, Abs)
     
+#if USB_FEATURE_ENABLED
+    // v0.6.3: Feature Report (64 bytes) - 诊断命令/应答, 走 EP0 控制传输
+    0x09, 0x03,             //   Usage (Vendor Usage 3)
+    0x15, 0x00,             //   Logical Minimum (0)
+    0x26, 0xFF, 0x00,       //   Logical Maximum (255)
+    0x75, 0x08,             //   Report Size (8 bits)
+    0x95, 0x40,             //   Report Count (64)
+    0xB1, 0x02,             //   Feature (Data, Var, Abs)
+    
+#endif
     0xC0,                   // End Collection
 };
 
@@ -68,8 +104,8 @@ static const uint8_t usb_config_desc[] = {
     // Configuration Descriptor
     9,                      // bLength
     0x02,                   // bDescriptorType (Configuration)
-    41, 0,                  // wTotalLength (9+9+9+7+7=41)
-    1,                      // bNumInterfaces
+    USB_CONFIG_TOTAL_LEN, 0,    // wTotalLength (9+9+9+7+7=41, 批量接口 +16)
+    USB_NUM_INTERFACES,     // bNumInterfaces
     1,                      // bConfigurationValue
     0,                      // iConfiguration
     0x80,                   // bmAttributes (bus powered)
@@ -110,6 +146,27 @@ static const uint8_t usb_config_desc[] = {
     0x03,                   // bmAttributes (Interrupt)
     USB_HID_EP_SIZE, 0,     // wMaxPacketSize (64)
     USB_HID_INTERVAL,       // bInterval (5ms)
+    
+#if USB_BULK_ENABLED
+    // v0.6.3: Interface 1 - Vendor 批量数据流
+    9,                      // bLength
+    0x04,                   // bDescriptorType (Interface)
+    1,                      // bInterfaceNumber
+    0,                      // bAlternateSetting
+    1,                      // bNumEndpoints (IN)
+    0xFF,                   // bInterfaceClass (Vendor)
+    0x00,                   // bInterfaceSubClass
+    0x00,                   // bInterfaceProtocol
+    0,                      // iInterface
+    
+    // Endpoint IN Descriptor (Bulk)
+    7,                      // bLength
+    0x05,                   // bDescriptorType (Endpoint)
+    USB_BULK_EP_IN,         // bEndpointAddress (IN 3)
+    0x02,                   // bmAttributes (Bulk)
+    USB_HID_EP_SIZE, 0,     // wMaxPacketSize (64)
+    0,                      // bInterval (bulk 忽略)
+#endif
 };
 
 // 字符串描述符
@@ -123,8 +180,13 @@ static const uint8_t usb_string_mfg[] = {
 static const uint8_t usb_string_prod[] = {
     36, 0x03,
     'C', 0, 'H', 0, '5', 0, '9', 0, 'X', 0, ' ', 0,
+#if defined(BUILD_RECEIVER)
     'R', 0, 'e', 0, 'c', 0, 'e', 0, 'i', 0, 'v', 0, 'e', 0, 'r', 0,
     ' ', 0, ' ', 0, ' ', 0,
+#else
+    'T', 0, 'r', 0, 'a', 0, 'c', 0, 'k', 0, 'e', 0, 'r', 0,
+    ' ', 0, ' ', 0, ' ', 0, ' ', 0,
+#endif
 };
 
 static const uint8_t usb_string_serial[] = {
@@ -155,6 +217,8 @@ static const uint8_t usb_string_serial[] = {
 #define HID_REQ_SET_IDLE            0x0A
 #define HID_REQ_SET_PROTOCOL        0x0B
 
+#define HID_REPORT_TYPE_FEATURE     0x03    // GET/SET_REPORT wValue 高字节
+
 #define USB_DESC_TYPE_DEVICE        0x01
 #define USB_DESC_TYPE_CONFIG        0x02
 #define USB_DESC_TYPE_STRING        0x03
@@ -188,6 +252,41 @@ static uint8_t __attribute__((aligned(4))) ep0_buffer[64];
 static uint8_t __attribute__((aligned(4))) ep1_in_buffer[USB_HID_EP_SIZE];
 static uint8_t __attribute__((aligned(4))) ep1_out_buffer[USB_HID_EP_SIZE];
 
+#if defined(USE_USB_TX_QUEUE) && USE_USB_TX_QUEUE
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+// v0.6.3: 端点缓冲只有一个 (UEP1 TX DMA), 排队的报告在 IN 完成中断里拷入
+// 写指针只由 usb_hid_write 修改, 读指针只由中断修改
+static uint8_t ep1_tx_queue[USB_TX_QUEUE_DEPTH][USB_HID_EP_SIZE];
+static uint8_t ep1_tx_len[USB_TX_QUEUE_DEPTH];
+static volatile uint8_t ep1_tx_w = 0;
+static volatile uint8_t ep1_tx_r = 0;
+#endif
+
+#if USB_BULK_ENABLED
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+// v0.6.3: 批量流字节 FIFO, 写指针只由主循环修改, 读指针只由 EP3 装包修改
+#define BULK_MASK   (USB_BULK_FIFO_SIZE - 1)
+static uint8_t __attribute__((aligned(4))) ep3_in_buffer[USB_HID_EP_SIZE];
+static uint8_t bulk_fifo[USB_BULK_FIFO_SIZE];
+static volatile uint16_t bulk_w = 0;
+static volatile uint16_t bulk_r = 0;
+static volatile bool ep3_in_busy = false;
+static uint8_t bulk_seq = 0;
+static uint32_t bulk_dropped = 0;
+#endif
+
 static struct {
     uint8_t bmRequestType;
     uint8_t bRequest;
@@ -201,6 +300,21 @@ static uint16_t ep0_tx_len = 0;
 
 static usb_hid_rx_callback_t rx_callback = NULL;
 
+#if USB_FEATURE_ENABLED
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+// v0.6.3: 最近一条命令经 SET_REPORT(Feature) 到达时, usb_hid_reply 的应答写入 feature_buf,
+// 直到下一条命令经 EP1 OUT 到达; 每条 Feature 命令先清空缓冲, 主机轮询到应答 ID 即完成
+static uint8_t feature_buf[USB_HID_EP_SIZE];
+static volatile bool feature_reply = false;
+static volatile bool ep0_rx_feature = false;    // SET_REPORT(Feature) 数据阶段待接收
+#endif
+
 /*============================================================================
  * 内部函数
  *============================================================================*/
@@ -221,6 +335,65 @@ static void ep0_send_zlp(void)
     R8_UEP0_CTRL = (R8_UEP0_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
 }
 
+// v0.6.3: IN 完成中断中装入下一个排队报告, 端点保持 ACK; 队列空返回 false
+static inline bool ep1_tx_next(void)
+{
+#if defined(USE_USB_TX_QUEUE) && USE_USB_TX_QUEUE
+    uint8_t r = ep1_tx_r;
+    if (r == ep1_tx_w) return false;
+    uint8_t slot = r % USB_TX_QUEUE_DEPTH;
+    memcpy(ep1_in_buffer, ep1_tx_queue[slot], ep1_tx_len[slot]);
+    R8_UEP1_T_LEN = ep1_tx_len[slot];
+    ep1_tx_r = (uint8_t)(r + 1);
+    R8_UEP1_CTRL = (R8_UEP1_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
+    return true;
+#else
+    return false;
+#endif
+}
+
+static inline void ep1_tx_flush(void)
+{
+#if defined(USE_USB_TX_QUEUE) && USE_USB_TX_QUEUE
+    ep1_tx_r = ep1_tx_w;
+#endif
+}
+
+#if USB_BULK_ENABLED
+/**
+ * @brief v0.6.3: 从 FIFO 装入下一包 (EP3 IN 完成中断, 或主循环关中断后启动)
+ */
+static void ep3_load(void)
+{
+    uint16_t r = bulk_r;
+    uint16_t n = (uint16_t)(bulk_w - r);
+    if (n == 0) {
+        ep3_in_busy = false;
+        R8_UEP3_CTRL = (R8_UEP3_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_NAK;
+        return;
+    }
+    if (n > USB_HID_EP_SIZE) n = USB_HID_EP_SIZE;
+    
+    uint16_t off = r & BULK_MASK;
+    uint16_t first = USB_BULK_FIFO_SIZE - off;
+    if (first > n) first = n;
+    memcpy(ep3_in_buffer, &bulk_fifo[off], first);
+    memcpy(&ep3_in_buffer[first], bulk_fifo, n - first);
+    bulk_r = (uint16_t)(r + n);
+    
+    ep3_in_busy = true;
+    R8_UEP3_T_LEN = (uint8_t)n;
+    R8_UEP3_CTRL = (R8_UEP3_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
+}
+
+static inline void ep3_reset(void)
+{
+    bulk_r = bulk_w;
+    ep3_in_busy = false;
+    R8_UEP3_CTRL = UEP_T_RES_NAK | RB_UEP_AUTO_TOG;
+}
+#endif
+
 static void ep0_stall(void)
 {
     R8_UEP0_CTRL = UEP_T_RES_STALL | UEP_R_RES_STALL;
@@ -331,6 +504,10 @@ static void handle_standard_device_request(void)
             if (usb_configured) {
                 R8_UEP1_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
                 ep1_in_busy = false;
+                ep1_tx_flush();
+#if USB_BULK_ENABLED
+                ep3_reset();
+#endif
             }
             ep0_send_zlp();
             break;
@@ -373,11 +550,28 @@ static void handle_hid_class_request(void)
 {
     switch (setup_packet.bRequest) {
         case HID_REQ_GET_REPORT:
+#if USB_FEATURE_ENABLED
+            if ((setup_packet.wValue >> 8) == HID_REPORT_TYPE_FEATURE) {
+                uint16_t n = (setup_packet.wLength > USB_HID_EP_SIZE) ? USB_HID_EP_SIZE : setup_packet.wLength;
+                memcpy(ep0_buffer, feature_buf, n);
+                R8_UEP0_T_LEN = (uint8_t)n;
+                R8_UEP0_CTRL = RB_UEP_R_TOG | RB_UEP_T_TOG | UEP_R_RES_ACK | UEP_T_RES_ACK;
+                break;
+            }
+#endif
             memset(ep0_buffer, 0, USB_HID_EP_SIZE);
             ep0_send_data(ep0_buffer, (setup_packet.wLength > 64) ? 64 : setup_packet.wLength);
             break;
             
         case HID_REQ_SET_REPORT:
+#if USB_FEATURE_ENABLED
+            // v0.6.3: 接收数据阶段 (DATA1), 在 EP0 OUT 中断里交给 rx_callback 后回状态阶段
+            if ((setup_packet.wValue >> 8) == HID_REPORT_TYPE_FEATURE && setup_packet.wLength > 0) {
+                ep0_rx_feature = true;
+                R8_UEP0_CTRL = RB_UEP_R_TOG | RB_UEP_T_TOG | UEP_R_RES_ACK | UEP_T_RES_NAK;
+                break;
+            }
+#endif
             R8_UEP0_CTRL = (R8_UEP0_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_ACK;
             break;
             
@@ -488,10 +682,19 @@ static void handle_setup_packet(void)
 
 // USB_IRQHandler 在 usb_msc.c 中定义（Tracker目标）
 // 这里只定义Receiver版本的USB中断处理
+// v0.6.3: Tracker 有线数据流模式下同一处理体编译为 usb_hid_irq (计时探针在 usb_msc.c 入口)
 #if defined(BUILD_RECEIVER)
+RAM_CODE_ISR
 __attribute__((interrupt("WCH-Interrupt-fast")))
 void USB_IRQHandler(void)
+#elif USB_HID_IRQ_ENABLED
+void usb_hid_irq(void)
+#endif
+#if USB_HID_IRQ_ENABLED
 {
+#if defined(BUILD_RECEIVER)
+    PROF_SCOPE(PROF_USB_ISR);
+#endif
     uint8_t int_flag = R8_USB_INT_FG;
     uint8_t int_st = R8_USB_INT_ST;
     
@@ -523,6 +726,22 @@ void USB_IRQHandler(void)
                         break;
                         
                     case UIS_TOKEN_OUT:
+#if USB_FEATURE_ENABLED
+                        if (ep0_rx_feature) {
+                            uint8_t len = R8_USB_RX_LEN;
+                            if (len > USB_HID_EP_SIZE) len = USB_HID_EP_SIZE;
+                            ep0_rx_feature = false;
+                            feature_reply = true;
+                            memset(feature_buf, 0, sizeof(feature_buf));
+                            if (rx_callback && len > 0) {
+                                rx_callback(ep0_buffer, len);
+                            }
+                            // 状态阶段: IN 零长度包 (DATA1)
+                            R8_UEP0_T_LEN = 0;
+                            R8_UEP0_CTRL = RB_UEP_T_TOG | UEP_T_RES_ACK | UEP_R_RES_NAK;
+                            break;
+                        }
+#endif
                         R8_UEP0_CTRL = UEP_T_RES_NAK | UEP_R_RES_NAK;
                         break;
                 }
@@ -531,11 +750,15 @@ void USB_IRQHandler(void)
             case 1:
                 switch (token) {
                     case UIS_TOKEN_IN:
+                        if (ep1_tx_next()) break;
                         ep1_in_busy = false;
                         R8_UEP1_CTRL = (R8_UEP1_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_NAK;
                         break;
                         
                     case UIS_TOKEN_OUT:
+#if USB_FEATURE_ENABLED
+                        feature_reply = false;      // 经中断 OUT 下发的命令在 IN 上应答
+#endif
                         if (rx_callback) {
                             uint8_t len = R8_USB_RX_LEN;
                             // 防止缓冲区溢出：限制长度不超过端点大小
@@ -558,6 +781,12 @@ void USB_IRQHandler(void)
                 }
                 break;
 #endif
+                
+#if USB_BULK_ENABLED
+            case 3:
+                if (token == UIS_TOKEN_IN) ep3_load();
+                break;
+#endif
         }
         
         R8_USB_INT_FG = RB_UIF_TRANSFER;
@@ -569,6 +798,14 @@ void USB_IRQHandler(void)
         usb_configured = false;
         usb_config_value = 0;
         ep1_in_busy = false;
+        ep1_tx_flush();
+#if USB_BULK_ENABLED
+        ep3_reset();
+#endif
+#if USB_FEATURE_ENABLED
+        feature_reply = false;
+        ep0_rx_feature = false;
+#endif
         R8_UEP0_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
         R8_UEP1_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
         R8_USB_INT_FG = RB_UIF_BUS_RST;
@@ -579,7 +816,7 @@ void USB_IRQHandler(void)
         R8_USB_INT_FG = RB_UIF_SUSPEND;
     }
 }
-#endif  // BUILD_RECEIVER
+#endif  // USB_HID_IRQ_ENABLED
 
 #endif // CH59X
 
@@ -602,6 +839,11 @@ int usb_hid_init(void)
     R8_UEP4_1_MOD = RB_UEP1_TX_EN | RB_UEP1_RX_EN;
     R8_UEP0_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
     R8_UEP1_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
+#if USB_BULK_ENABLED
+    R16_UEP3_DMA = (uint16_t)(uint32_t)ep3_in_buffer;
+    R8_UEP2_3_MOD |= RB_UEP3_TX_EN;
+    ep3_reset();
+#endif
     
     R8_USB_CTRL = 0;
     R8_USB_DEV_AD = 0;
@@ -642,7 +884,11 @@ bool usb_hid_suspended(void)
 
 bool usb_hid_busy(void)
 {
+#if defined(USE_USB_TX_QUEUE) && USE_USB_TX_QUEUE
+    return ep1_in_busy && (uint8_t)(ep1_tx_w - ep1_tx_r) >= USB_TX_QUEUE_DEPTH;
+#else
     return ep1_in_busy;
+#endif
 }
 
 int usb_hid_write(const uint8_t *data, uint8_t len)
@@ -650,9 +896,29 @@ int usb_hid_write(const uint8_t *data, uint8_t len)
     if (!data) return -4;
     if (len == 0) return -3;
     if (!usb_configured) return -1;
-    if (ep1_in_busy) return -2;
     if (len > USB_HID_EP_SIZE) len = USB_HID_EP_SIZE;
     
+#if defined(USE_USB_TX_QUEUE) && USE_USB_TX_QUEUE
+    // 关中断判断: 避免中断在检查 busy 之后、入队之前取空队列并释放端点
+    __disable_irq();
+    if (ep1_in_busy) {
+        uint8_t w = ep1_tx_w;
+        if ((uint8_t)(w - ep1_tx_r) >= USB_TX_QUEUE_DEPTH) {
+            __enable_irq();
+            return -2;
+        }
+        uint8_t slot = w % USB_TX_QUEUE_DEPTH;
+        memcpy(ep1_tx_queue[slot], data, len);
+        ep1_tx_len[slot] = len;
+        ep1_tx_w = (uint8_t)(w + 1);
+        __enable_irq();
+        return len;
+    }
+    __enable_irq();
+#else
+    if (ep1_in_busy) return -2;
+#endif
+    
     memcpy(ep1_in_buffer, data, len);
     ep1_in_busy = true;
     
@@ -668,7 +934,7 @@ int usb_hid_write_blocking(const uint8_t *data, uint8_t len, uint32_t timeout_ms
 {
     uint32_t start = hal_get_tick_ms();
     
-    while (ep1_in_busy) {
+    while (usb_hid_busy()) {
         if (hal_get_tick_ms() - start > timeout_ms) {
             return -3;
         }
@@ -677,6 +943,24 @@ int usb_hid_write_blocking(const uint8_t *data, uint8_t len, uint32_t timeout_ms
     return usb_hid_write(data, len);
 }
 
+int usb_hid_reply(const uint8_t *data, uint8_t len)
+{
+#if USB_FEATURE_ENABLED
+    if (feature_reply) {
+        if (!data) return -4;
+        if (len == 0) return -3;
+        if (len > USB_HID_EP_SIZE) len = USB_HID_EP_SIZE;
+        // 主循环中的延后应答与 GET_REPORT 中断互斥, 主机不会读到半条
+        __disable_irq();
+        memcpy(feature_buf, data, len);
+        memset(&feature_buf[len], 0, sizeof(feature_buf) - len);
+        __enable_irq();
+        return len;
+    }
+#endif
+    return usb_hid_write(data, len);
+}
+
 void usb_hid_set_rx_callback(usb_hid_rx_callback_t callback)
 {
     rx_callback = callback;
@@ -686,3 +970,187 @@ void usb_hid_task(void)
 {
     // 周期性处理
 }
+
+#if USB_BULK_ENABLED
+/*============================================================================
+ * v0.6.3: Vendor 批量数据流 (格式见 usb_hid_slime.h)
+ *============================================================================*/
+
+static inline void bulk_put(uint16_t pos, uint8_t b)
+{
+    bulk_fifo[pos & BULK_MASK] = b;
+}
+
+uint16_t usb_bulk_free(void)
+{
+    return (uint16_t)(USB_BULK_FIFO_SIZE - (uint16_t)(bulk_w - bulk_r));
+}
+
+int usb_bulk_send(uint8_t type, const void *payload, uint8_t len)
+{
+    if (!usb_configured) return -1;
+    
+    uint16_t need = USB_BULK_HDR_SIZE + len;
+    if (usb_bulk_free() < need) {
+        bulk_dropped++;
+        bulk_seq++;             // 主机按序号间隔统计丢帧
+        return -2;
+    }
+    
+    uint16_t w = bulk_w;
+    bulk_put(w++, USB_BULK_SYNC);
+    bulk_put(w++, type);
+    bulk_put(w++, len);
+    bulk_put(w++, bulk_seq++);
+    const uint8_t *p = (const uint8_t *)payload;
+    for (uint8_t i = 0; i < len; i++) bulk_put(w++, p[i]);
+    bulk_w = w;                 // 整帧写完才发布
+    
+    // 端点空闲时由这里启动第一包, 之后由 IN 完成中断续传
+    if (!ep3_in_busy) {
+        __disable_irq();
+        if (!ep3_in_busy) ep3_load();
+        __enable_irq();
+    }
+    return 0;
+}
+
+uint32_t usb_bulk_dropped(void)
+{
+    return bulk_dropped;
+}
+#endif
+
+#if defined(USE_USB_BUNDLE_REPORTS) && USE_USB_BUNDLE_REPORTS
+/*============================================================================
+ * v0.6.3: Tracker 缓存 + Bundle 报告 (格式见 usb_hid_slime.h)
+ *============================================================================*/
+
+#define BUNDLE_HDR_SIZE         4
+#define BUNDLE_ENTRY_SIZE       RF_QUAT40_SIZE
+#define BUNDLE_STATUS_SIZE      4
+#define BUNDLE_STALE_FLAG       0x40
+#define BUNDLE_STATUS_FLAG      0x80
+#define BUNDLE_BLOCKS           ((MAX_TRACKERS + USB_BUNDLE_BLOCK - 1) / USB_BUNDLE_BLOCK)
+
+#if (BUNDLE_HDR_SIZE + USB_BUNDLE_BLOCK * BUNDLE_ENTRY_SIZE) > USB_HID_EP_SIZE
+#error "USB bundle block does not fit one HID report"
+#endif
+#if BUNDLE_BLOCKS > 16
+#error "USB bundle supports at most 16 blocks (192 trackers)"
+#endif
+
+typedef struct {
+    int16_t quat[4];
+    uint8_t battery;
+    uint8_t status;
+    int8_t rssi;
+    bool valid;
+    bool fresh;                         // 上次 bundle 之后有新样本
+} bundle_tracker_t;
+
+static bundle_tracker_t bundle_trackers[MAX_TRACKERS] RAM_ARENA(usb_hid);
+static uint8_t bundle_frame = 0;
+static uint8_t bundle_block = 0;
+static uint8_t bundle_status_next = 0;  // 状态旁路轮转位置
+
+void usb_hid_update_tracker(uint8_t id, const int16_t quat[4],
+                            const int16_t accel[3], uint8_t battery, int8_t rssi)
+{
+    (void)accel;
+    if (id >= MAX_TRACKERS || !quat) return;
+    
+    bundle_tracker_t *t = &bundle_trackers[id];
+    memcpy(t->quat, quat, sizeof(t->quat));
+    t->battery = battery;
+    t->rssi = rssi;
+    t->valid = true;
+    t->fresh = true;
+}
+
+void usb_hid_remove_tracker(uint8_t id)
+{
+    if (id >= MAX_TRACKERS) return;
+    bundle_trackers[id].valid = false;
+    bundle_trackers[id].fresh = false;
+}
+
+void usb_hid_set_tracker_status(uint8_t id, uint8_t status)
+{
+    if (id >= MAX_TRACKERS) return;
+    bundle_trackers[id].status = status;
+}
+
+void usb_hid_bundle_begin(uint16_t frame)
+{
+    bundle_frame = (uint8_t)frame;
+    bundle_block = 0;
+}
+
+int usb_hid_send_bundle(void)
+{
+    if (!usb_configured) return -1;
+    if (usb_hid_busy()) return -2;
+    
+    // 跳过没有 tracker 的块
+    while (bundle_block < BUNDLE_BLOCKS) {
+        uint8_t base = bundle_block * USB_BUNDLE_BLOCK;
+        bool any = false;
+        for (uint8_t i = 0; i < USB_BUNDLE_BLOCK && base + i < MAX_TRACKERS; i++) {
+            if (bundle_trackers[base + i].valid) { any = true; break; }
+        }
+        if (any) break;
+        bundle_block++;
+    }
+    if (bundle_block >= BUNDLE_BLOCKS) return 0;
+    
+    uint8_t rep[USB_HID_EP_SIZE];
+    memset(rep, 0, sizeof(rep));
+    
+    uint8_t base = bundle_block * USB_BUNDLE_BLOCK;
+    uint16_t mask = (uint16_t)bundle_block << 12;
+    uint8_t off = BUNDLE_HDR_SIZE;
+    
+    for (uint8_t i = 0; i < USB_BUNDLE_BLOCK && base + i < MAX_TRACKERS; i++) {
+        bundle_tracker_t *t = &bundle_trackers[base + i];
+        if (!t->valid) continue;
+        
+        rf_v2_quat_pack40(t->quat, &rep[off]);
+        if (!t->fresh) rep[off + 4] |= BUNDLE_STALE_FLAG;
+        mask |= 1u << i;
+        off += BUNDLE_ENTRY_SIZE;
+    }
+    
+    rep[0] = USB_BUNDLE_REPORT_ID;
+    rep[1] = bundle_frame;
+    rep[2] = mask & 0xFF;
+    rep[3] = mask >> 8;
+    
+    // 剩余空间轮转携带状态, 替代独立的低频状态包
+    uint8_t next = bundle_status_next;
+    for (uint8_t n = 0; n < MAX_TRACKERS && off + BUNDLE_STATUS_SIZE <= (int)sizeof(rep); n++) {
+        uint8_t id = (uint8_t)((next + n) % MAX_TRACKERS);
+        bundle_tracker_t *t = &bundle_trackers[id];
+        if (!t->valid) continue;
+        
+        rep[off++] = BUNDLE_STATUS_FLAG | id;
+        rep[off++] = t->status;
+        rep[off++] = t->battery;
+        rep[off++] = (uint8_t)(t->rssi + 100);
+        bundle_status_next = (uint8_t)((id + 1) % MAX_TRACKERS);
+    }
+    
+    int ret = usb_hid_write(rep, sizeof(rep));
+    if (ret < 0) {
+        bundle_status_next = next;      // 未发出, 下次重发同一批状态
+        return ret;
+    }
+    
+    for (uint8_t i = 0; i < USB_BUNDLE_BLOCK && base + i < MAX_TRACKERS; i++) {
+        bundle_trackers[base + i].fresh = false;
+    }
+    bundle_block++;
+    
+    return (bundle_block < BUNDLE_BLOCKS) ? 1 : 0;
+}
+#endif  // USE_USB_BUNDLE_REPORTS
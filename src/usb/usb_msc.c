@@ -10,6 +10,8 @@
 
 #include "usb_bootloader.h"
 #include "hal.h"
+#include "profile.h"
+#include "usb_hid_slime.h"  // v0.6.3: USB_HID_IRQ_ENABLED (有线数据流)
 #include <string.h>
 
 #ifdef CH59X
@@ -52,6 +54,16 @@
 #define CSW_STATUS_FAILED       0x01
 #define CSW_STATUS_PHASE_ERROR  0x02
 
+#define MSC_SECTOR_SIZE         512
+
+// v0.6.3: 整扇区读取 - 每个扇区调用一次 msc_read 生成到 msc_ctx.buffer, 再分 8 包发送
+// (之前每扇区只发一包 64 字节, 只读得出各扇区开头; 日志文件需要完整扇区)
+#if defined(USE_MSC_LOG_FILES) && USE_MSC_LOG_FILES
+#define MSC_SECTOR_READ         1
+#else
+#define MSC_SECTOR_READ         0
+#endif
+
 /*============================================================================
  * USB 描述符
  *============================================================================*/
@@ -155,11 +167,19 @@ static struct {
     uint32_t transfer_lba;
     uint32_t transfer_blocks;
     bool transfer_read;
+#if MSC_SECTOR_READ
+    uint16_t read_pos;          // 当前扇区内已发送字节数
+#endif
     
     // 缓冲区
     uint8_t buffer[512];
 } msc_ctx;
 
+#if USB_HID_IRQ_ENABLED && !defined(BUILD_RECEIVER)
+// v0.6.3: Tracker 应用以 HID 枚举, usb_msc_init 之后 USB 中断才由 MSC 处理
+static volatile bool msc_owns_usb = false;
+#endif
+
 /*============================================================================
  * SCSI 命令处理
  *============================================================================*/
@@ -230,6 +250,9 @@ static int process_scsi_cmd(const uint8_t *cbw)
             msc_ctx.transfer_lba = lba;
             msc_ctx.transfer_blocks = blocks;
             msc_ctx.transfer_read = true;
+#if MSC_SECTOR_READ
+            msc_ctx.read_pos = 0;
+#endif
             return blocks * 512;
             
         case SCSI_WRITE_10:
@@ -267,6 +290,99 @@ static volatile uint8_t usb_addr = 0;
 static const uint8_t *ep0_tx_ptr = NULL;
 static uint16_t ep0_tx_len = 0;
 
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+#ifndef __disable_irq
+#define __disable_irq()  __asm__ volatile ("csrci mstatus, 0x08")
+#endif
+#ifndef __enable_irq
+#define __enable_irq()   __asm__ volatile ("csrsi mstatus, 0x08")
+#endif
+
+// v0.6.3: 流式写入. 中断把 64 字节 OUT 包拼进 wr_buf[wr_fill], 满 512 字节置 wr_full 位
+// 交给主循环 (usb_msc_task) 按顺序编程; wr_full 只由中断置位、主循环清除
+#define MSC_STREAM_IDLE_MS  2       // 数据阶段内无新扇区超过该时间, 主循环不再等待
+
+static uint8_t __attribute__((aligned(4))) wr_buf[2][MSC_SECTOR_SIZE] RAM_ARENA(usb_msc);
+static uint32_t wr_lba[2];
+static volatile uint8_t wr_full = 0;
+static uint8_t wr_fill = 0;         // 中断正在填充的缓冲
+static uint8_t wr_prog = 0;         // 主循环下一个编程的缓冲
+static uint16_t wr_pos = 0;
+static volatile bool wr_active = false;     // WRITE_10 数据阶段或尚有扇区未编程
+static volatile bool wr_nak = false;        // 两个缓冲都满, OUT 暂停应答
+
+static void stream_write_reset(void)
+{
+    wr_full = 0;
+    wr_fill = 0;
+    wr_prog = 0;
+    wr_pos = 0;
+    wr_active = false;
+    wr_nak = false;
+}
+
+static void send_csw(uint8_t status, uint32_t residue)
+{
+    *(uint32_t*)(msc_ctx.csw) = CSW_SIGNATURE;
+    *(uint32_t*)(msc_ctx.csw + 4) = msc_ctx.tag;
+    *(uint32_t*)(msc_ctx.csw + 8) = residue;
+    msc_ctx.csw[12] = status;
+    
+    memcpy(ep2_in_buf, msc_ctx.csw, CSW_SIZE);
+    R8_UEP2_T_LEN = CSW_SIZE;
+    R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
+}
+
+/**
+ * @brief 接收一个数据包 (中断上下文)
+ * @return true 两个缓冲都已满, 本包之后 OUT 回 NAK
+ */
+static bool stream_write_rx(uint8_t len)
+{
+    uint16_t n = len;
+    if (n > MSC_SECTOR_SIZE - wr_pos) n = MSC_SECTOR_SIZE - wr_pos;
+    memcpy(wr_buf[wr_fill] + wr_pos, ep2_out_buf, n);
+    wr_pos += n;
+    if (wr_pos < MSC_SECTOR_SIZE) return false;
+    
+    wr_lba[wr_fill] = msc_ctx.transfer_lba++;
+    msc_ctx.transfer_blocks--;
+    wr_full |= (1 << wr_fill);
+    wr_fill ^= 1;
+    wr_pos = 0;
+    
+    // 另一个缓冲还在等编程: 暂停接收, 由主循环编程完后重新 ACK
+    if (msc_ctx.transfer_blocks > 0 && (wr_full & (1 << wr_fill))) {
+        wr_nak = true;
+    }
+    return wr_nak;
+}
+#endif
+
+#if MSC_SECTOR_READ
+// 发送当前扇区的下一包; 扇区开头时生成整个扇区
+static void read_send_packet(void)
+{
+    if (msc_ctx.read_pos == 0) {
+        msc_read(msc_ctx.transfer_lba, 0, msc_ctx.buffer, MSC_SECTOR_SIZE);
+    }
+    memcpy(ep2_in_buf, msc_ctx.buffer + msc_ctx.read_pos, 64);
+    R8_UEP2_T_LEN = 64;
+    R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
+}
+
+// 一包发送完成: 扇区发完后前进到下一扇区
+static void read_packet_done(void)
+{
+    msc_ctx.read_pos += 64;
+    if (msc_ctx.read_pos >= MSC_SECTOR_SIZE) {
+        msc_ctx.read_pos = 0;
+        msc_ctx.transfer_lba++;
+        msc_ctx.transfer_blocks--;
+    }
+}
+#endif
+
 static void ep0_send(const uint8_t *data, uint16_t len)
 {
     if (len > 64) len = 64;
@@ -358,6 +474,11 @@ static void handle_setup(void)
     else if ((setup_req_type & 0x60) == 0x20) {
         switch (setup_req) {
             case MSC_REQ_RESET:
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+                stream_write_reset();
+                msc_ctx.transfer_blocks = 0;
+                R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_ACK;
+#endif
                 ep0_zlp();
                 break;
             case MSC_REQ_GET_MAX_LUN:
@@ -390,11 +511,22 @@ static void handle_bulk_out(void)
         
         if (result >= 0) {
             // 发送数据或 CSW
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+            if (!msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
+                // WRITE_10: 等数据阶段, CSW 在最后一个扇区编程完后由主循环发送
+                stream_write_reset();
+                wr_active = true;
+            } else
+#endif
             if (msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
                 // 读取扇区数据
+#if MSC_SECTOR_READ
+                read_send_packet();
+#else
                 msc_read(msc_ctx.transfer_lba, 0, ep2_in_buf, 64);
                 R8_UEP2_T_LEN = 64;
                 R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
+#endif
             } else if (result > 0) {
                 // 发送响应数据
                 memcpy(ep2_in_buf, msc_ctx.buffer, (result > 64) ? 64 : result);
@@ -424,6 +556,14 @@ static void handle_bulk_out(void)
         }
     }
     // 写入数据
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+    else if (!msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
+        if (stream_write_rx(len)) {
+            R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_NAK;
+            return;
+        }
+    }
+#else
     else if (!msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
         msc_write(msc_ctx.transfer_lba, 0, ep2_out_buf, len);
         msc_ctx.transfer_lba++;
@@ -441,6 +581,7 @@ static void handle_bulk_out(void)
             R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
         }
     }
+#endif
     
     R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_ACK;
 }
@@ -453,9 +594,17 @@ static void handle_bulk_out(void)
 
 #ifndef BUILD_RECEIVER
 // Tracker目标：只使用MSC，在这里定义USB中断处理
+// v0.6.3: USE_USB_WIRED_STREAM 时 MSC 接管之前转交 HID
 __attribute__((interrupt("WCH-Interrupt-fast")))
 void USB_IRQHandler(void)
 {
+    PROF_SCOPE(PROF_USB_ISR);
+#if USB_HID_IRQ_ENABLED
+    if (!msc_owns_usb) {
+        usb_hid_irq();
+        return;
+    }
+#endif
     uint8_t int_flag = R8_USB_INT_FG;
     uint8_t int_st = R8_USB_INT_ST;
     
@@ -492,6 +641,13 @@ void USB_IRQHandler(void)
                 } else if (token == UIS_TOKEN_IN) {
                     // 继续读取传输
                     if (msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
+#if MSC_SECTOR_READ
+                        read_packet_done();
+                        
+                        if (msc_ctx.transfer_blocks > 0) {
+                            read_send_packet();
+                        } else {
+#else
                         msc_ctx.transfer_lba++;
                         msc_ctx.transfer_blocks--;
                         
@@ -500,6 +656,7 @@ void USB_IRQHandler(void)
                             R8_UEP2_T_LEN = 64;
                             R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
                         } else {
+#endif
                             // 读取完成，发送 CSW
                             *(uint32_t*)(msc_ctx.csw) = CSW_SIGNATURE;
                             *(uint32_t*)(msc_ctx.csw + 4) = msc_ctx.tag;
@@ -524,6 +681,10 @@ void USB_IRQHandler(void)
         R8_USB_DEV_AD = 0;
         usb_addr = 0;
         msc_ctx.configured = false;
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE
+        stream_write_reset();
+        msc_ctx.transfer_blocks = 0;
+#endif
         R8_UEP0_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
         R8_UEP2_CTRL = UEP_T_RES_NAK | UEP_R_RES_ACK;
         R8_USB_INT_FG = RB_UIF_BUS_RST;
@@ -547,6 +708,13 @@ void usb_msc_handle_ep2(uint8_t token)
     } else if (token == UIS_TOKEN_IN) {
         // 继续读取传输
         if (msc_ctx.transfer_read && msc_ctx.transfer_blocks > 0) {
+#if MSC_SECTOR_READ
+            read_packet_done();
+            
+            if (msc_ctx.transfer_blocks > 0) {
+                read_send_packet();
+            } else {
+#else
             msc_ctx.transfer_lba++;
             msc_ctx.transfer_blocks--;
             
@@ -555,6 +723,7 @@ void usb_msc_handle_ep2(uint8_t token)
                 R8_UEP2_T_LEN = 64;
                 R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_T_RES) | UEP_T_RES_ACK;
             } else {
+#endif
                 // 读取完成，发送 CSW
                 *(uint32_t*)(msc_ctx.csw) = CSW_SIGNATURE;
                 *(uint32_t*)(msc_ctx.csw + 4) = msc_ctx.tag;
@@ -583,6 +752,14 @@ int usb_msc_init(void)
     memset(&msc_ctx, 0, sizeof(msc_ctx));
     
 #ifdef CH59X
+#if USB_HID_IRQ_ENABLED && !defined(BUILD_RECEIVER)
+    // v0.6.3: 从 HID 切换过来时先断开上拉, 让主机看到拔出后按 MSC 重新枚举
+    if (!msc_owns_usb) {
+        usb_hid_deinit();
+        hal_delay_ms(USB_REENUM_DETACH_MS);
+        msc_owns_usb = true;
+    }
+#endif
     // 开启 USB 时钟
     R8_SAFE_ACCESS_SIG = SAFE_ACCESS_SIG1;
     R8_SAFE_ACCESS_SIG = SAFE_ACCESS_SIG2;
@@ -623,5 +800,33 @@ bool usb_msc_connected(void)
 
 void usb_msc_task(void)
 {
-    // 由中断处理
+#if defined(USE_MSC_STREAM_WRITE) && USE_MSC_STREAM_WRITE && defined(CH59X)
+    // 数据阶段内留在这里: 编程当前扇区时中断在填另一个缓冲, 避免主循环延时拖慢整段写入
+    uint32_t idle_start = hal_get_tick_ms();
+    
+    while (wr_active) {
+        uint8_t i = wr_prog;
+        
+        if (!(wr_full & (1 << i))) {
+            if ((hal_get_tick_ms() - idle_start) > MSC_STREAM_IDLE_MS) break;
+            continue;
+        }
+        
+        msc_write(wr_lba[i], 0, wr_buf[i], MSC_SECTOR_SIZE);
+        wr_prog ^= 1;
+        idle_start = hal_get_tick_ms();
+        
+        __disable_irq();
+        wr_full &= ~(1 << i);
+        if (wr_nak) {
+            wr_nak = false;
+            R8_UEP2_CTRL = (R8_UEP2_CTRL & ~MASK_UEP_R_RES) | UEP_R_RES_ACK;
+        }
+        if (msc_ctx.transfer_blocks == 0 && wr_full == 0) {
+            wr_active = false;
+            send_csw(CSW_STATUS_PASSED, 0);
+        }
+        __enable_irq();
+    }
+#endif
 }
@@ -23,7 +23,10 @@
  *============================================================================*/
 
 #define USB_TX_BUFFER_SIZE      512
-#define USB_RX_BUFFER_SIZE      128
+#define USB_RX_RING_SIZE        256     // v0.6.3: 2 的幂, 读写计数自由增长按掩码取模
+#define USB_RX_RING_MASK        (USB_RX_RING_SIZE - 1)
+#define USB_RX_FRAME_MAX        64      // 最长主机命令帧 (头 + 类型 + 长度 + 负载 + 校验)
+#define USB_RX_REFILLS          4       // 每次调用最多重新填充次数 (主机连发命令)
 #define USB_SEND_INTERVAL_MS    5       // Send every 5ms (200Hz)
 
 /*============================================================================
@@ -31,10 +34,13 @@
  *============================================================================*/
 
 static uint8_t tx_buffer[USB_TX_BUFFER_SIZE];
-static uint8_t rx_buffer[USB_RX_BUFFER_SIZE];
 static uint16_t tx_len = 0;
-static uint16_t rx_len = 0;
-static uint16_t rx_read_idx = 0;
+
+// v0.6.3: 接收环形缓冲, 帧就地解析, 不搬移内存
+static uint8_t rx_ring[USB_RX_RING_SIZE];
+static uint16_t rx_head = 0;    // 累计写入字节
+static uint16_t rx_tail = 0;    // 累计消费字节
+static uint8_t rx_frame[USB_RX_FRAME_MAX];  // 仅跨环尾的帧拷贝到这里
 
 static bool usb_connected = false;
 static uint32_t last_send_time = 0;
@@ -92,11 +98,32 @@ static bool usb_hw_tx_ready(void) { return true; }
 
 static uint8_t calc_checksum(const uint8_t *data, uint16_t len)
 {
-    uint8_t sum = 0;
-    for (uint16_t i = 0; i < len; i++) {
-        sum += data[i];
+    // v0.6.3: 按 32 位字累加; 偶/奇字节分两路 16 位通道, 128 字内通道不溢出
+    uint32_t sum = 0;
+    while (len && ((uintptr_t)data & 3)) {
+        sum += *data++;
+        len--;
+    }
+    
+    const uint32_t *w = (const uint32_t *)data;
+    while (len >= 4) {
+        uint16_t words = len / 4;
+        if (words > 128) words = 128;
+        len -= words * 4;
+        
+        uint32_t lanes = 0;
+        while (words--) {
+            uint32_t v = *w++;
+            lanes += (v & 0x00FF00FF) + ((v >> 8) & 0x00FF00FF);
+        }
+        sum += (lanes & 0xFFFF) + (lanes >> 16);
+    }
+    
+    data = (const uint8_t *)w;
+    while (len--) {
+        sum += *data++;
     }
-    return ~sum;
+    return ~(uint8_t)sum;
 }
 
 /*============================================================================
@@ -139,8 +166,8 @@ int usb_protocol_init(void)
 {
     usb_hw_init();
     tx_len = 0;
-    rx_len = 0;
-    rx_read_idx = 0;
+    rx_head = 0;
+    rx_tail = 0;
     usb_connected = false;
     return 0;
 }
@@ -181,13 +208,13 @@ void usb_send_tracker_data(uint16_t frame_number,
         if (trackers[i].active && trackers[i].connected) {
             usb_tracker_data_t data;
             data.tracker_id = i;
-            data.quat_w = (int16_t)(trackers[i].quaternion[0] * 32767.0f);
-            data.quat_x = (int16_t)(trackers[i].quaternion[1] * 32767.0f);
-            data.quat_y = (int16_t)(trackers[i].quaternion[2] * 32767.0f);
-            data.quat_z = (int16_t)(trackers[i].quaternion[3] * 32767.0f);
-            data.accel_x = (int16_t)(trackers[i].acceleration[0] * 1000.0f);
-            data.accel_y = (int16_t)(trackers[i].acceleration[1] * 1000.0f);
-            data.accel_z = (int16_t)(trackers[i].acceleration[2] * 1000.0f);
+            data.quat_w = trackers[i].quat[0];
+            data.quat_x = trackers[i].quat[1];
+            data.quat_y = trackers[i].quat[2];
+            data.quat_z = trackers[i].quat[3];
+            data.accel_x = trackers[i].accel_mg[0];
+            data.accel_y = trackers[i].accel_mg[1];
+            data.accel_z = trackers[i].accel_mg[2];
             data.battery = trackers[i].battery;
             data.flags = trackers[i].flags;
             
@@ -298,100 +325,145 @@ void usb_send_debug(const char *msg)
     buffer_flush();
 }
 
+/*============================================================================
+ * v0.6.3: RX Ring Parser
+ *============================================================================*/
+
+/**
+ * @brief 从 USB 端点读入环形缓冲 (写指针到环尾, 环头到读指针, 最多两段)
+ */
+static void rx_fill(void)
+{
+    for (uint8_t seg = 0; seg < 2; seg++) {
+        uint16_t space = USB_RX_RING_SIZE - (uint16_t)(rx_head - rx_tail);
+        uint16_t off = rx_head & USB_RX_RING_MASK;
+        uint16_t run = USB_RX_RING_SIZE - off;
+        if (run > space) run = space;
+        if (run == 0) break;
+        
+        uint16_t got = usb_hw_receive(rx_ring + off, run);
+        rx_head += got;
+        if (got < run) break;
+    }
+}
+
+/**
+ * @brief 丢弃帧头 0x55 0xAA 之前的字节
+ * @return true = 读指针停在帧头上
+ * @note 用 memchr (按字比较) 一次跳过整段垃圾, 不逐字节回到解析循环
+ */
+static bool rx_sync(void)
+{
+    while (rx_head != rx_tail) {
+        uint16_t used = (uint16_t)(rx_head - rx_tail);
+        uint16_t off = rx_tail & USB_RX_RING_MASK;
+        uint16_t run = USB_RX_RING_SIZE - off;
+        if (run > used) run = used;
+        
+        const uint8_t *p = memchr(rx_ring + off, 0x55, run);
+        if (!p) {
+            rx_tail += run;
+            continue;
+        }
+        rx_tail += (uint16_t)(p - (rx_ring + off));
+        if ((uint16_t)(rx_head - rx_tail) < 2) return false;   // 等第二个头字节
+        if (rx_ring[(rx_tail + 1) & USB_RX_RING_MASK] == 0xAA) return true;
+        rx_tail++;
+    }
+    return false;
+}
+
+/**
+ * @brief 读指针处 len 字节的连续视图 (跨环尾时拷贝到 rx_frame)
+ */
+static const uint8_t *rx_peek(uint16_t len)
+{
+    uint16_t off = rx_tail & USB_RX_RING_MASK;
+    uint16_t run = USB_RX_RING_SIZE - off;
+    if (run >= len) return rx_ring + off;
+    
+    memcpy(rx_frame, rx_ring + off, run);
+    memcpy(rx_frame + run, rx_ring, len - run);
+    return rx_frame;
+}
+
+static void rx_handle_frame(rf_receiver_ctx_t *rx_ctx, const uint8_t *f)
+{
+    switch (f[2]) {
+        case USB_CMD_GET_STATUS:
+            usb_send_system_status(rx_ctx);
+            break;
+            
+        case USB_CMD_START_PAIRING:
+            rf_receiver_start_pairing(rx_ctx);
+            usb_send_pair_event(0, 0, NULL);
+            break;
+            
+        case USB_CMD_STOP_PAIRING:
+            rf_receiver_stop_pairing(rx_ctx);
+            usb_send_pair_event(2, 0, NULL);
+            break;
+            
+        case USB_CMD_UNPAIR:
+            rf_receiver_unpair(rx_ctx, f[4]);
+            break;
+            
+        case USB_CMD_UNPAIR_ALL:
+            rf_receiver_unpair_all(rx_ctx);
+            break;
+            
+        case USB_CMD_TRACKER_CMD: {
+            const usb_tracker_cmd_t *cmd = (const usb_tracker_cmd_t *)f;
+            rf_receiver_send_command(rx_ctx, cmd->tracker_id, 
+                                      cmd->command, cmd->param);
+            break;
+        }
+            
+        case USB_CMD_RESET:
+#ifdef CH59X
+            SYS_ResetExecute();
+#endif
+            break;
+            
+        default:
+            break;
+    }
+}
+
 void usb_process_rx(rf_receiver_ctx_t *rx_ctx)
 {
     // Check for USB connection state
     // usb_connected = usb_hw_is_connected();
     usb_connected = true;  // Assume connected for now
     
-    // Read incoming data
-    uint16_t received = usb_hw_receive(rx_buffer + rx_len, 
-                                        USB_RX_BUFFER_SIZE - rx_len);
-    rx_len += received;
-    
-    // Process complete packets
-    while (rx_len >= 4) {
-        // Look for header
-        if (rx_buffer[rx_read_idx] != 0x55 || rx_buffer[rx_read_idx + 1] != 0xAA) {
-            // Sync error, skip byte
-            rx_read_idx++;
-            rx_len--;
-            continue;
-        }
-        
-        uint8_t type = rx_buffer[rx_read_idx + 2];
-        uint8_t length = rx_buffer[rx_read_idx + 3];
-        
-        // Check if complete packet available
-        if (rx_len < 4 + length) {
-            break;  // Wait for more data
-        }
-        
-        // Verify checksum
-        uint8_t calc_chk = calc_checksum(rx_buffer + rx_read_idx + 2, length - 1);
-        uint8_t pkt_chk = rx_buffer[rx_read_idx + 3 + length];
-        
-        if (calc_chk != pkt_chk) {
-            // Checksum error, skip
-            rx_read_idx++;
-            rx_len--;
-            continue;
-        }
+    // 主机连发配置命令时一次调用处理完: 环满则解析后再填充
+    for (uint8_t pass = 0; pass < USB_RX_REFILLS; pass++) {
+        rx_fill();
+        bool more = (uint16_t)(rx_head - rx_tail) == USB_RX_RING_SIZE;
         
-        // Process command
-        switch (type) {
-            case USB_CMD_GET_STATUS:
-                usb_send_system_status(rx_ctx);
-                break;
-                
-            case USB_CMD_START_PAIRING:
-                rf_receiver_start_pairing(rx_ctx);
-                usb_send_pair_event(0, 0, NULL);
-                break;
-                
-            case USB_CMD_STOP_PAIRING:
-                rf_receiver_stop_pairing(rx_ctx);
-                usb_send_pair_event(2, 0, NULL);
-                break;
-                
-            case USB_CMD_UNPAIR: {
-                uint8_t tracker_id = rx_buffer[rx_read_idx + 4];
-                rf_receiver_unpair(rx_ctx, tracker_id);
-                break;
+        while (rx_sync()) {
+            uint16_t avail = (uint16_t)(rx_head - rx_tail);
+            if (avail < 4) break;
+            
+            uint8_t length = rx_ring[(rx_tail + 3) & USB_RX_RING_MASK];
+            uint16_t total = 4 + length;
+            if (length == 0 || total > USB_RX_FRAME_MAX) {
+                rx_tail++;      // 不可能的长度: 假帧头
+                continue;
             }
-                
-            case USB_CMD_UNPAIR_ALL:
-                rf_receiver_unpair_all(rx_ctx);
-                break;
-                
-            case USB_CMD_TRACKER_CMD: {
-                usb_tracker_cmd_t *cmd = (usb_tracker_cmd_t *)(rx_buffer + rx_read_idx);
-                rf_receiver_send_command(rx_ctx, cmd->tracker_id, 
-                                          cmd->command, cmd->param);
-                break;
+            if (avail < total) break;   // Wait for more data
+            
+            const uint8_t *f = rx_peek(total);
+            if (calc_checksum(f + 2, length - 1) != f[3 + length]) {
+                rx_tail++;      // Checksum error, resync
+                continue;
             }
-                
-            case USB_CMD_RESET:
-#ifdef CH59X
-                SYS_ResetExecute();
-#endif
-                break;
-                
-            default:
-                break;
+            
+            rx_tail += total;
+            rx_handle_frame(rx_ctx, f);
         }
         
-        // Consume packet
-        rx_read_idx += 4 + length;
-        rx_len -= 4 + length;
-    }
-    
-    // Compact buffer if needed
-    if (rx_read_idx > 0 && rx_len > 0) {
-        memmove(rx_buffer, rx_buffer + rx_read_idx, rx_len);
-        rx_read_idx = 0;
-    } else if (rx_len == 0) {
-        rx_read_idx = 0;
+        if (!more) break;
     }
 }
 
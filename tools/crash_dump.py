@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 崩溃快照读取 v0.6.3
+Crash snapshot + timing dump
+
+用途:
+- 经 usb_debug 0x1D 命令分段读出崩溃快照和时序 (固件需 USE_CRASH_TIMING=1)
+- 打印故障类型/寄存器, 复位前最近几次主循环迭代的各任务耗时 (超预算的标 *),
+  保存时正在执行的任务, 以及探针表 (固件另需 USE_PROFILE=1)
+- 硬件看门狗复位的快照由复位后的 wdog_init 补记, 没有寄存器和探针表
+
+依赖:
+- pip install hidapi
+
+用法:
+- python crash_dump.py
+- python crash_dump.py --mhz 60
+"""
+
+import argparse
+import struct
+import sys
+import time
+from typing import Dict, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_CRASH = 0x1D
+
+# 与 watchdog.h / profile.h 一致
+TIMELINE_DEPTH = 4
+TASK_NAMES = ['sensor', 'rf', 'usb', 'led', 'storage', 'battery']
+TASK_BUDGET_US = [1000, 2500, 500, 100, 1500, 200]
+PROBE_NAMES = ['main_loop', 'sensor_sample', 'fusion', 'rf_task', 'usb_task', 'rf_isr',
+               'rf_timer_isr', 'usb_isr', 'spi_dma_isr', 'i2c_isr', 'gpio_isr']
+TASK_NONE = 0xFF
+
+SNAP_FMT = '<15IBB2x'                               # crash_snapshot_t, 64 字节
+FRAME_FMT = '<I%dH' % len(TASK_NAMES)               # crash_frame_t
+TIMING_HDR_FMT = '<BBBxI'
+PROBE_FMT = '<III'
+
+FAULT_NAMES = {
+    0x02: '非法指令', 0x05: '加载访问故障', 0x07: '存储访问故障', 0x08: 'HardFault',
+    0xDD: '主循环死锁 (任务监控)', 0xD0: '硬件看门狗复位',
+}
+RESET_NAMES = {
+    0x00: 'UNKNOWN', 0x01: 'POWER_ON', 0x02: 'SOFTWARE', 0x04: 'WATCHDOG',
+    0x08: 'HARDFAULT', 0x10: 'LOCKUP', 0x20: 'EXTERNAL', 0x40: 'BROWNOUT',
+}
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (CMD_GET_CRASH | 0x80):
+            return bytes(data)
+    return None
+
+
+def read_blob(device) -> Optional[bytes]:
+    blob = b''
+    total = None
+    while total is None or len(blob) < total:
+        send_command(device, bytes([CMD_GET_CRASH, len(blob) & 0xFF, len(blob) >> 8]))
+        data = wait_response(device)
+        if not data:
+            raise SystemExit("无响应 (固件未启用 USE_CRASH_TIMING?)")
+        if not data[1]:
+            return None
+        total, off, n = struct.unpack_from('<HHB', data, 2)
+        if off != len(blob) or n == 0:
+            raise SystemExit("读取中断")
+        blob += data[7:7 + n]
+    return blob
+
+#==============================================================================
+# 解码
+#==============================================================================
+
+def decode(blob: bytes) -> Dict:
+    v = struct.unpack_from(SNAP_FMT, blob, 0)
+    snap = {'pc': v[1], 'lr': v[2], 'sp': v[3], 'r': v[4:8], 'time_ms': v[14],
+            'reset_reason': v[15], 'fault_type': v[16]}
+    pos = struct.calcsize(SNAP_FMT)
+
+    frames_n, probes_n, cur_task, cur_us = struct.unpack_from(TIMING_HDR_FMT, blob, pos)
+    pos += struct.calcsize(TIMING_HDR_FMT)
+    frames = []
+    for i in range(TIMELINE_DEPTH):
+        f = struct.unpack_from(FRAME_FMT, blob, pos)
+        pos += struct.calcsize(FRAME_FMT)
+        if i < frames_n:
+            frames.append({'start_us': f[0], 'task_us': list(f[1:])})
+    probes = []
+    for i in range(len(PROBE_NAMES)):
+        if pos + struct.calcsize(PROBE_FMT) > len(blob):
+            break
+        p = struct.unpack_from(PROBE_FMT, blob, pos)
+        pos += struct.calcsize(PROBE_FMT)
+        if i < probes_n:
+            probes.append({'name': PROBE_NAMES[i], 'count': p[0], 'max': p[1], 'avg': p[2]})
+    return {'snap': snap, 'frames': frames, 'cur_task': cur_task, 'cur_us': cur_us, 'probes': probes}
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def task_name(i: int) -> str:
+    return TASK_NAMES[i] if i < len(TASK_NAMES) else f'task{i}'
+
+
+def report(d: Dict, mhz: float):
+    s = d['snap']
+    print(f"\n故障: 0x{s['fault_type']:02X} {FAULT_NAMES.get(s['fault_type'], '')}  "
+          f"复位原因: {RESET_NAMES.get(s['reset_reason'], hex(s['reset_reason']))}  "
+          f"时间: {s['time_ms']} ms")
+    if s['fault_type'] == 0xDD or s['fault_type'] == 0xD0:
+        print(f"最后检查点: 0x{s['r'][0]:02X}")
+    else:
+        print(f"PC 0x{s['pc']:08X}  LR 0x{s['lr']:08X}  SP 0x{s['sp']:08X}")
+
+    if d['cur_task'] != TASK_NONE:
+        elapsed = f"{d['cur_us']} us" if d['cur_us'] else '时间未知'
+        print(f"保存时正在执行: {task_name(d['cur_task'])} ({elapsed})")
+
+    if d['frames']:
+        print(f"\n{'帧':<4} {'间隔us':>8} " + ' '.join(f"{task_name(i):>8}" for i in range(len(TASK_NAMES))))
+        prev = None
+        for n, f in enumerate(d['frames']):
+            gap = '' if prev is None else str((f['start_us'] - prev) & 0xFFFFFFFF)
+            prev = f['start_us']
+            cells = []
+            for i, us in enumerate(f['task_us']):
+                mark = '*' if i < len(TASK_BUDGET_US) and us > TASK_BUDGET_US[i] else ''
+                cells.append(f"{str(us) + mark:>8}" if us else f"{'-':>8}")
+            print(f"{n:<4} {gap:>8} " + ' '.join(cells))
+        print("(最后一帧为保存时的迭代, * 超预算)")
+
+    if d['probes']:
+        print(f"\n{'探针':<14} {'次数':>9} {'平均us':>8} {'最大us':>8}")
+        for p in d['probes']:
+            print(f"{p['name']:<14} {p['count']:>9} {p['avg'] / mhz:>8.2f} {p['max'] / mhz:>8.2f}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X crash snapshot + timing dump')
+    parser.add_argument('--mhz', type=float, default=60.0, help='CPU 主频 (MHz, 默认 60)')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        blob = read_blob(device)
+        if blob is None:
+            print("没有崩溃快照")
+            return 0
+        report(decode(blob), args.mhz)
+    finally:
+        device.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
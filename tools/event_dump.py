@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 事件日志读取 v0.6.3
+Event log dump
+
+用途:
+- 经 usb_debug 0x17 命令读出事件环的原始字节 (格式见 include/event_logger.h)
+- 从写指针往回按记录末尾长度字节逐条回溯, 用增量时间戳还原每条事件的时间
+- 默认打印表格, --json 输出诊断报告 (docs/TEST_PLAN.md E 节)
+- v0.6.3: 令牌化日志 (EVT_LOG_*, USE_LOG_TOKENS) 只记录令牌和整数参数, --elf 指定
+  同一次构建的 ELF 后从其 .logstr 段取出格式串还原为文本 (%s 参数从 .rodata 读取)
+
+依赖:
+- pip install hidapi
+
+用法:
+- python event_dump.py
+- python event_dump.py --json > SlimeVR_CH59X_Report.json
+- python event_dump.py --elf build/tracker/SlimeVR_CH59X.elf
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_VERSION = 0x02
+CMD_GET_EVENTS = 0x17
+
+REC_MIN_LEN = 3
+REC_MAX_LEN = 23
+
+EVENT_NAMES = {
+    0x01: 'BOOT', 0x02: 'SHUTDOWN', 0x03: 'CRASH', 0x04: 'WATCHDOG', 0x05: 'LOW_BATTERY',
+    0x06: 'TASK_OVERRUN',
+    0x08: 'LOG_ERR', 0x09: 'LOG_WARN', 0x0A: 'LOG_INFO', 0x0B: 'LOG_DBG',
+    0x10: 'RF_SYNC_LOST', 0x11: 'RF_SYNC_FOUND', 0x12: 'RF_TIMEOUT', 0x13: 'RF_CRC_FAIL',
+    0x14: 'RF_CHANNEL_SWITCH', 0x15: 'RF_BLACKLIST',
+    0x20: 'PAIR_START', 0x21: 'PAIR_SUCCESS', 0x22: 'PAIR_FAIL', 0x23: 'PAIR_CLEAR',
+    0x30: 'SLEEP_ENTER', 0x31: 'SLEEP_EXIT', 0x32: 'WOM_TRIGGER', 0x33: 'BTN_WAKE',
+    0x34: 'WAKE_FIFO_REPLAY',
+    0x40: 'IMU_ERROR', 0x41: 'IMU_CALIB_START', 0x42: 'IMU_CALIB_DONE', 0x43: 'IMU_WOM_SET',
+    0x50: 'BTN_PRESS', 0x51: 'BTN_LONG', 0x52: 'BTN_DOUBLE',
+}
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def read_info(device) -> Dict:
+    send_command(device, bytes([CMD_GET_EVENTS]))
+    data = wait_response(device, CMD_GET_EVENTS)
+    if not data or len(data) < 17:
+        raise SystemExit("无响应")
+    head, size, last_ms, now_ms, count = struct.unpack_from('<HHIII', data, 1)
+    return {'head': head, 'size': size, 'last_ms': last_ms, 'now_ms': now_ms, 'count': count}
+
+
+def read_window(device, info: Dict) -> bytes:
+    """读取 [head - size, head), 返回从回溯起点到 head 的未被覆盖字节"""
+    head, size = info['head'], info['size']
+    start = (head - size) & 0xFFFF
+    out = bytearray()
+    valid_from = 0          # out 中此偏移之前的字节已被新记录覆盖
+    pos = start
+    while len(out) < size:
+        send_command(device, struct.pack('<BH', CMD_GET_EVENTS, pos))
+        data = wait_response(device, CMD_GET_EVENTS)
+        if not data:
+            raise SystemExit(f"读取失败 @{pos}")
+        _, head_now, n = struct.unpack_from('<HHB', data, 1)
+        # 读取期间写入的字节覆盖了环中最旧的部分
+        overwritten = (head_now - head) & 0xFFFF
+        if overwritten >= size:
+            raise SystemExit("读取期间写入过多事件, 请重试")
+        valid_from = max(valid_from, overwritten)
+        if n == 0:
+            if len(out) >= overwritten:
+                break
+            # 当前位置已被覆盖, 跳到仍有效的部分
+            out += bytes(overwritten - len(out))
+            pos = (start + len(out)) & 0xFFFF
+            continue
+        out += data[6:6 + n]
+        pos = (pos + n) & 0xFFFF
+    return bytes(out[valid_from:])
+
+#==============================================================================
+# 解码
+#==============================================================================
+
+def read_varint(data: bytes, pos: int):
+    v, shift = 0, 0
+    while True:
+        b = data[pos]
+        pos += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, pos
+
+
+def decode(window: bytes, last_ms: int) -> List[Dict]:
+    events = []
+    end = len(window)
+    while end >= REC_MIN_LEN:
+        n = window[end - 1]
+        if n < REC_MIN_LEN or n > REC_MAX_LEN or n > end:
+            break
+        rec = window[end - n:end]
+        try:
+            dt, p = read_varint(rec, 1)
+        except IndexError:
+            break
+        if p > n - 1:
+            break
+        events.append({'type': rec[0], 'dt': dt, 'data': rec[p:n - 1]})
+        end -= n
+
+    # 最新一条的时间已知, 往回逐条减去增量
+    ts = last_ms
+    for e in events:
+        e['ts'] = ts
+        ts -= e['dt']
+    events.reverse()
+    return events
+
+#==============================================================================
+# 令牌化日志
+#==============================================================================
+
+EVT_LOG_FIRST = 0x08
+EVT_LOG_LAST = 0x0B
+LOG_FMT_RE = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diuxXcsp%])')
+
+
+class ElfStrings:
+    """从 ELF32 小端文件读取段内容, 按地址取 C 字符串"""
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+            raise SystemExit(f"{path}: 不是 ELF32 小端文件")
+        shoff, = struct.unpack_from('<I', data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+        headers = [struct.unpack_from('<IIIIII', data, shoff + i * shentsize) for i in range(shnum)]
+        names = headers[shstrndx]
+        self.sections = {}
+        for name_off, sh_type, _, addr, off, size in headers:
+            end = data.index(b'\0', names[4] + name_off)
+            name = data[names[4] + name_off:end].decode()
+            if sh_type != 8:        # SHT_NOBITS 无内容
+                self.sections[name] = (addr, data[off:off + size])
+
+    def string_at(self, addr: int) -> Optional[str]:
+        for base, blob in self.sections.values():
+            if base <= addr < base + len(blob):
+                end = blob.find(b'\0', addr - base)
+                return blob[addr - base:end if end >= 0 else len(blob)].decode(errors='replace')
+        return None
+
+    def log_format(self, token: int) -> Optional[str]:
+        sec = self.sections.get('.logstr')
+        if not sec:
+            return None
+        return self.string_at(sec[0] + token)
+
+
+def decode_log(data: bytes):
+    """[令牌 LE16][zigzag varint...] -> (令牌, 参数)"""
+    if len(data) < 2:
+        return None, []
+    token = data[0] | (data[1] << 8)
+    args, pos = [], 2
+    while pos < len(data):
+        try:
+            z, pos = read_varint(data, pos)
+        except IndexError:
+            break
+        args.append((z >> 1) ^ -(z & 1))
+    return token, args
+
+
+def format_log(elf: ElfStrings, data: bytes) -> Optional[str]:
+    token, args = decode_log(data)
+    if token is None:
+        return None
+    fmt = elf.log_format(token)
+    if fmt is None:
+        return f"<未知令牌 0x{token:04X}> " + ' '.join(str(a) for a in args)
+    where, _, fmt = fmt.partition('|')
+    it = iter(args)
+
+    def conv(m):
+        flags, width, prec, c = m.groups()
+        if c == '%':
+            return '%'
+        v = next(it, None)
+        if v is None:
+            return '?'              # 超出记录长度被截断的参数
+        if c == 's':
+            s = elf.string_at(v & 0xFFFFFFFF)
+            return s if s is not None else f'<0x{v & 0xFFFFFFFF:08X}>'
+        if c in 'uxXp':
+            v &= 0xFFFFFFFF
+        if c == 'c':
+            return chr(v & 0xFF)
+        spec = '%' + flags + width + ('.' + prec if prec else '') + ('x' if c == 'p' else c)
+        return spec % v
+
+    return f"{LOG_FMT_RE.sub(conv, fmt)}  ({where.rsplit('/', 1)[-1]})"
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def event_name(t: int) -> str:
+    return EVENT_NAMES.get(t, f'0x{t:02X}')
+
+
+def event_text(e: Dict, elf: Optional[ElfStrings]) -> str:
+    if elf and EVT_LOG_FIRST <= e['type'] <= EVT_LOG_LAST:
+        text = format_log(elf, e['data'])
+        if text is not None:
+            return text
+    return e['data'].hex(' ')
+
+
+def report_table(info: Dict, events: List[Dict], elf: Optional[ElfStrings]):
+    print(f"环 {info['size']} 字节, 累计 {info['count']} 条, 保留 {len(events)} 条, "
+          f"运行 {info['now_ms'] / 1000:.1f}s")
+    for e in events:
+        print(f"{e['ts'] / 1000:>10.3f}s  {event_name(e['type']):<18} {event_text(e, elf)}")
+
+
+def report_json(device, info: Dict, events: List[Dict], elf: Optional[ElfStrings]):
+    send_command(device, bytes([CMD_GET_VERSION]))
+    ver = wait_response(device, CMD_GET_VERSION)
+    report = {
+        'fw_version': f"{ver[1]}.{ver[2]}.{ver[3]}" if ver else None,
+        'uptime_ms': info['now_ms'],
+        'event_total': info['count'],
+        'recent_events': [{'ts': e['ts'], 'type': e['type'], 'name': event_name(e['type']),
+                           'data': e['data'].hex(),
+                           **({'text': event_text(e, elf)}
+                              if elf and EVT_LOG_FIRST <= e['type'] <= EVT_LOG_LAST else {})}
+                          for e in events],
+    }
+    print(json.dumps(report, indent=2, ensure_ascii=False))
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X event log dump')
+    parser.add_argument('--json', action='store_true', help='输出 JSON 诊断报告')
+    parser.add_argument('--elf', help='固件 ELF, 用于还原令牌化日志')
+    args = parser.parse_args()
+    elf = ElfStrings(args.elf) if args.elf else None
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        info = read_info(device)
+        events = decode(read_window(device, info), info['last_ms'])
+        if args.json:
+            report_json(device, info, events, elf)
+        else:
+            report_table(info, events, elf)
+    finally:
+        device.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,324 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 融合算法基准测试工具 v0.6.3
+Fusion engine benchmark helper
+
+用途:
+- convert: 把录制的传感器 CSV 转换为固件可回放的 C 轨迹 (make TARGET=bench BENCH_TRACE=...)
+- read:    从 bench 固件的 USB 调试日志读取结果并打印汇总表 (--save 另存为 JSON); 有引擎误差超限 (FAIL) 时退出码为 1
+           含编解码基准 (CB 行, 见 include/codec_bench.h)
+- compare: 比较两次 read --save 的结果 (如 make opt-compare 的全 -Os 与按模块优化版本)
+
+CSV 格式 (首行表头, 列名不区分大小写):
+    gx,gy,gz      陀螺仪 deg/s
+    ax,ay,az      加速度 g
+    mx,my,mz      磁力计 uT (可选)
+    qw,qx,qy,qz   参考四元数 (可选; 缺失时若安装了 vqf 包则离线计算)
+
+依赖:
+- read 需要 pip install hidapi
+- 缺少参考四元数时需要 pip install vqf numpy
+
+用法:
+- python fusion_bench.py convert trace.csv -o build/bench/bench_trace.c --odr 200
+- python fusion_bench.py read --timeout 30
+- python fusion_bench.py read --save os.json        (刷入 build/bench-os 固件)
+- python fusion_bench.py read --save hot.json       (刷入默认固件)
+- python fusion_bench.py compare os.json hot.json
+"""
+
+import argparse
+import csv
+import json
+import math
+import sys
+import time
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+# usb_debug.c: DBG_CMD_LOG | 0x80
+LOG_PACKET_ID = 0xF0
+
+#==============================================================================
+# convert
+#==============================================================================
+
+def _load_csv(path):
+    with open(path, newline='') as f:
+        reader = csv.DictReader(f)
+        cols = {c.strip().lower(): c for c in reader.fieldnames}
+        rows = list(reader)
+
+    def col(name):
+        key = cols.get(name)
+        return None if key is None else [float(r[key]) for r in rows]
+
+    data = {n: col(n) for n in ('gx', 'gy', 'gz', 'ax', 'ay', 'az',
+                                'mx', 'my', 'mz', 'qw', 'qx', 'qy', 'qz')}
+    for n in ('gx', 'gy', 'gz', 'ax', 'ay', 'az'):
+        if data[n] is None:
+            raise SystemExit(f"missing column '{n}' in {path}")
+    return data, len(rows)
+
+
+def _offline_reference(data, odr, has_mag):
+    try:
+        import numpy as np
+        from vqf import offlineVQF
+    except ImportError:
+        raise SystemExit("no qw..qz columns and 'vqf' package not installed "
+                         "(pip install vqf numpy)")
+
+    gyr = np.radians(np.array([data['gx'], data['gy'], data['gz']]).T).copy()
+    acc = (np.array([data['ax'], data['ay'], data['az']]).T * 9.81).copy()
+    mag = np.array([data['mx'], data['my'], data['mz']]).T.copy() if has_mag else None
+    out = offlineVQF(gyr, acc, mag, 1.0 / odr)
+    q = out['quat9D'] if has_mag else out['quat6D']
+    return [list(map(float, row)) for row in q]
+
+
+def _lsb(values, default):
+    peak = max((abs(v) for v in values), default=0.0)
+    if peak == 0.0:
+        return default
+    return peak / 32000.0
+
+
+def _q16(values, lsb):
+    return [max(-32768, min(32767, int(round(v / lsb)))) for v in values]
+
+
+def cmd_convert(args):
+    data, n = _load_csv(args.csv)
+    if n == 0:
+        raise SystemExit("empty trace")
+
+    has_mag = all(data[c] is not None for c in ('mx', 'my', 'mz'))
+    if all(data[c] is not None for c in ('qw', 'qx', 'qy', 'qz')):
+        ref = list(zip(data['qw'], data['qx'], data['qy'], data['qz']))
+    else:
+        ref = _offline_reference(data, args.odr, has_mag)
+
+    g_lsb = _lsb(data['gx'] + data['gy'] + data['gz'], 1.0 / 16)
+    a_lsb = _lsb(data['ax'] + data['ay'] + data['az'], 1.0 / 8192)
+    m_lsb = _lsb(data['mx'] + data['my'] + data['mz'], 0.01) if has_mag else 0.01
+
+    g = [_q16(data[c], g_lsb) for c in ('gx', 'gy', 'gz')]
+    a = [_q16(data[c], a_lsb) for c in ('ax', 'ay', 'az')]
+    m = [_q16(data[c], m_lsb) for c in ('mx', 'my', 'mz')] if has_mag else [[0] * n] * 3
+
+    name = args.name or args.csv.replace('\\', '/').split('/')[-1].rsplit('.', 1)[0]
+    with open(args.output, 'w') as f:
+        f.write("// 由 tools/fusion_bench.py 生成, 请勿手动修改\n")
+        f.write(f"// source: {args.csv}\n\n")
+        f.write('#include "fusion_bench.h"\n\n')
+        f.write("static const fusion_bench_sample_t trace_samples[] = {\n")
+        for i in range(n):
+            qw, qx, qy, qz = ref[i]
+            norm = math.sqrt(qw * qw + qx * qx + qy * qy + qz * qz) or 1.0
+            q = [int(round(v / norm * 16384)) for v in (qw, qx, qy, qz)]
+            f.write("    {{%d,%d,%d},{%d,%d,%d},{%d,%d,%d},{%d,%d,%d,%d}},\n" % (
+                g[0][i], g[1][i], g[2][i], a[0][i], a[1][i], a[2][i],
+                m[0][i], m[1][i], m[2][i], q[0], q[1], q[2], q[3]))
+        f.write("};\n\n")
+        f.write("const fusion_bench_trace_t fusion_bench_recorded_trace = {\n")
+        f.write(f"    .name = \"{name[:16]}\",\n")
+        f.write("    .samples = trace_samples,\n")
+        f.write(f"    .count = {n},\n")
+        f.write(f"    .odr_hz = {args.odr},\n")
+        f.write(f"    .has_mag = {'true' if has_mag else 'false'},\n")
+        f.write(f"    .gyro_lsb_dps = {g_lsb:.9g}f,\n")
+        f.write(f"    .accel_lsb_g = {a_lsb:.9g}f,\n")
+        f.write(f"    .mag_lsb_ut = {m_lsb:.9g}f,\n")
+        f.write("};\n")
+
+    print(f"[convert] {n} samples, mag={'yes' if has_mag else 'no'}, "
+          f"{n * 26 / 1024:.1f} KB flash -> {args.output}")
+
+#==============================================================================
+# read
+#==============================================================================
+
+def _parse_codec_line(parts, table):
+    # CB <codec> <rnd|trj> cyc <enc>/<dec> B <bytes> | CB <codec> err ... | CB <codec> n <n> fail <n>
+    entry = table['codecs'].setdefault(parts[1], {})
+    if len(parts) >= 7 and parts[3] == 'cyc':
+        entry['input'] = parts[2]
+        entry['cyc'] = parts[4]
+        entry['bytes'] = parts[6]
+    elif len(parts) >= 4 and parts[2] == 'err':
+        entry['err'] = parts[3]
+    elif len(parts) >= 6 and parts[2] == 'n':
+        entry['n'] = parts[3]
+        entry['fail'] = parts[5]
+
+
+def _parse_line(line, table):
+    parts = line.split()
+    if len(parts) >= 3 and parts[0] == 'CB':
+        _parse_codec_line(parts, table)
+        return False
+    if len(parts) < 2 or parts[0] != 'FB':
+        return False
+    if parts[1] == 'done':
+        return True
+    if parts[1] == 'trace':
+        table['trace'] = ' '.join(parts[2:])
+        return False
+    if len(parts) < 5:
+        return False
+
+    key = (parts[1], parts[2])
+    entry = table['engines'].setdefault(key, {})
+    if parts[3] == 'cyc':
+        entry['cyc'] = parts[4]
+    elif parts[3] == 'stk':
+        entry['stk'] = parts[4]
+        entry['st'] = parts[6] if len(parts) > 6 else '?'
+    elif parts[3] == 'err':
+        entry['err'] = parts[4]
+        entry['tilt'] = parts[6] if len(parts) > 6 else '?'
+        entry['limit'] = parts[7] if len(parts) > 7 else '?'
+    return False
+
+
+def _print_table(table):
+    print(f"trace: {table.get('trace', '?')}")
+    print(f"{'engine':<10}{'axes':>5}  {'cycles min/avg/max':<24}{'stack':>6}{'state':>6}"
+          f"  {'err rms/max deg':<16}{'tilt rms':>9}{'limit':>7}")
+    for (engine, axes), e in table['engines'].items():
+        print(f"{engine:<10}{axes:>5}  {e.get('cyc', '?'):<24}{e.get('stk', '?'):>6}"
+              f"{e.get('st', '?'):>6}  {e.get('err', '?'):<16}{e.get('tilt', '?'):>9}"
+              f"{e.get('limit', '?'):>7}")
+    if table.get('codecs'):
+        print()
+        print(f"{'codec':<10}{'in':>4}  {'cycles enc/dec':<16}{'B/smp':>6}"
+              f"  {'err rms/p50/p99/max deg':<32}{'fail':>5}")
+        for codec, e in table['codecs'].items():
+            print(f"{codec:<10}{e.get('input', '?'):>4}  {e.get('cyc', '?'):<16}"
+                  f"{e.get('bytes', '?'):>6}  {e.get('err', '?'):<32}{e.get('fail', '?'):>5}")
+
+
+def _save_table(table, path):
+    engines = [{'engine': k[0], 'axes': k[1], **e} for k, e in table['engines'].items()]
+    codecs = [{'codec': k, **e} for k, e in table.get('codecs', {}).items()]
+    with open(path, 'w') as f:
+        json.dump({'trace': table.get('trace', '?'), 'engines': engines, 'codecs': codecs},
+                  f, indent=2)
+
+
+def _finish_read(table, args):
+    _print_table(table)
+    if args.save:
+        _save_table(table, args.save)
+    # 误差超出引擎限值 (固件报告 FAIL) 时返回非零, 便于在 CI 中使用
+    failed = [f"{k[0]}/{k[1]}" for k, e in table['engines'].items() if e.get('limit') == 'FAIL']
+    if failed:
+        print(f"FAIL: error limit exceeded: {' '.join(failed)}", file=sys.stderr)
+        return 1
+    return 0
+
+
+def cmd_read(args):
+    try:
+        import hid
+    except ImportError:
+        raise SystemExit("请安装 hidapi: pip install hidapi")
+
+    dev = hid.device()
+    dev.open(USB_VID, USB_PID)
+    table = {'engines': {}, 'codecs': {}}
+    deadline = time.time() + args.timeout
+
+    try:
+        while time.time() < deadline:
+            data = dev.read(64, timeout_ms=500)
+            if not data:
+                continue
+            # 部分平台在报告前附带 report id
+            off = 0 if data[0] == LOG_PACKET_ID else (1 if len(data) > 1 and data[1] == LOG_PACKET_ID else -1)
+            if off < 0 or len(data) < off + 2:
+                continue
+            n = data[off + 1]
+            line = bytes(data[off + 2:off + 2 + n]).decode('ascii', errors='replace')
+            if args.verbose:
+                print(line)
+            if _parse_line(line, table) and table['engines']:
+                return _finish_read(table, args)
+    finally:
+        dev.close()
+
+    print("timeout waiting for 'FB done'", file=sys.stderr)
+    if table['engines']:
+        _finish_read(table, args)
+    return 1
+
+#==============================================================================
+# compare
+#==============================================================================
+
+def _load_saved(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get('trace', '?'), {(e['engine'], e['axes']): e for e in data['engines']}
+
+
+def _avg_cycles(entry):
+    # 'min/avg/max'
+    try:
+        return int(entry.get('cyc', '').split('/')[1])
+    except (IndexError, ValueError):
+        return None
+
+
+def cmd_compare(args):
+    trace_a, base = _load_saved(args.base)
+    trace_b, new = _load_saved(args.new)
+    if trace_a != trace_b:
+        print(f"warning: different traces ({trace_a} / {trace_b})", file=sys.stderr)
+
+    print(f"{'engine':<10}{'axes':>5}  {'base avg':>9}{'new avg':>9}{'delta':>9}{'%':>8}")
+    for key, b in base.items():
+        n = new.get(key)
+        ca, cb = _avg_cycles(b), _avg_cycles(n) if n else None
+        if ca is None or cb is None:
+            print(f"{key[0]:<10}{key[1]:>5}  {'?':>9}{'?':>9}")
+            continue
+        pct = 100.0 * (cb - ca) / ca if ca else 0.0
+        print(f"{key[0]:<10}{key[1]:>5}  {ca:>9}{cb:>9}{cb - ca:>+9}{pct:>+8.1f}")
+    return 0
+
+#==============================================================================
+# main
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description="SlimeVR CH59X fusion benchmark helper")
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('convert', help='CSV trace -> C source for TARGET=bench')
+    p.add_argument('csv')
+    p.add_argument('-o', '--output', required=True)
+    p.add_argument('--odr', type=int, default=200, help='sample rate (Hz)')
+    p.add_argument('--name', help='trace name shown in the report')
+    p.set_defaults(func=cmd_convert)
+
+    p = sub.add_parser('read', help='read benchmark results over USB debug')
+    p.add_argument('--timeout', type=float, default=30.0)
+    p.add_argument('-v', '--verbose', action='store_true')
+    p.add_argument('--save', help='also write the results to a JSON file')
+    p.set_defaults(func=cmd_read)
+
+    p = sub.add_parser('compare', help='cycle delta between two saved reads')
+    p.add_argument('base', help='e.g. global -Os build (make opt-compare)')
+    p.add_argument('new', help='e.g. per-module optimized build')
+    p.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    return args.func(args) or 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X RAM 热代码报告 v0.6.3
+RAM hot-code (.highcode) report
+
+用途:
+- 从链接后的 ELF 读出 .highcode 段中每个函数的大小, 按层 (通用 __HIGH_CODE / ISR / 融合) 汇总
+- 层边界来自 sdk/Ld/Link.ld 的 _highcode_isr_* / _highcode_fusion_* 符号
+- 与 Makefile HIGHCODE_BUDGET 比较; 链接脚本同样检查, 超出时链接失败
+- 每次链接后 Makefile 以 --summary 打印一行, make highcode-report 打印明细
+
+用法:
+- python highcode_report.py build/tracker/SlimeVR_CH59X.elf --budget 6144
+- python highcode_report.py firmware.elf --nm riscv-none-elf-nm --summary
+"""
+
+import argparse
+import subprocess
+import sys
+from typing import Dict, List, Tuple
+
+TIERS = [('isr', '_highcode_isr_start', '_highcode_isr_end'),
+         ('fusion', '_highcode_fusion_start', '_highcode_fusion_end')]
+
+#==============================================================================
+# 符号读取
+#==============================================================================
+
+def read_symbols(nm: str, elf: str) -> Tuple[Dict[str, int], List[Tuple[int, int, str]]]:
+    try:
+        out = subprocess.run([nm, '-S', elf], check=True, capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        raise SystemExit(f"运行 {nm} 失败: {e}")
+
+    marks: Dict[str, int] = {}
+    funcs: List[Tuple[int, int, str]] = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3:
+            marks[parts[2]] = int(parts[0], 16)
+        elif len(parts) == 4 and parts[2] in 'tTwW':
+            funcs.append((int(parts[0], 16), int(parts[1], 16), parts[3]))
+    return marks, funcs
+
+
+def classify(marks: Dict[str, int], funcs: List[Tuple[int, int, str]]) -> Dict[str, List[Tuple[int, str]]]:
+    if '_highcode_vma_start' not in marks or '_highcode_vma_end' not in marks:
+        raise SystemExit("ELF 中没有 .highcode 边界符号 (链接脚本过旧?)")
+    lo, hi = marks['_highcode_vma_start'], marks['_highcode_vma_end']
+
+    tiers: Dict[str, List[Tuple[int, str]]] = {'highcode': [], 'isr': [], 'fusion': []}
+    for addr, size, name in funcs:
+        if not lo <= addr < hi:
+            continue
+        tier = 'highcode'
+        for tname, start, end in TIERS:
+            if marks.get(start, 0) <= addr < marks.get(end, 0):
+                tier = tname
+        tiers[tier].append((size, name))
+    return tiers
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def report(tiers: Dict[str, List[Tuple[int, str]]], total: int, budget: int, summary: bool):
+    sums = {t: sum(s for s, _ in fs) for t, fs in tiers.items()}
+    state = '超出预算!' if budget and total > budget else 'OK'
+    budget_text = f" / {budget}" if budget else ''
+    if summary:
+        print(f"[HIGHCODE] RAM {total}{budget_text} B  (__HIGH_CODE {sums['highcode']}, "
+              f"ISR {sums['isr']}, 融合 {sums['fusion']})  {state}")
+        return
+
+    for tier, label in (('highcode', '__HIGH_CODE'), ('isr', 'RAM_CODE_ISR'), ('fusion', 'RAM_CODE_FUSION')):
+        print(f"\n{label}: {sums[tier]} B")
+        for size, name in sorted(tiers[tier], reverse=True):
+            print(f"  {size:>6}  {name}")
+    print(f"\n合计 {total}{budget_text} B (含对齐)  {state}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X RAM hot-code report')
+    parser.add_argument('elf', help='链接后的 ELF')
+    parser.add_argument('--nm', default='riscv-none-elf-nm', help='nm 工具')
+    parser.add_argument('--budget', type=int, default=0, help='HIGHCODE_BUDGET (字节)')
+    parser.add_argument('--summary', action='store_true', help='只打印一行汇总')
+    args = parser.parse_args()
+
+    marks, funcs = read_symbols(args.nm, args.elf)
+    tiers = classify(marks, funcs)
+    total = marks['_highcode_vma_end'] - marks['_highcode_vma_start']
+    report(tiers, total, args.budget, args.summary)
+    return 1 if args.budget and total > args.budget else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
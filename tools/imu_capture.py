@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 原始 IMU 采集 v0.6.3
+Raw IMU capture at full ODR for offline replay
+
+用途:
+- 开启追踪器 usb_debug 原始 IMU 流 (固件需 USE_IMU_CAPTURE=1)
+- 解码 0xFC 样本报告和 0xFB 参数报告, 按序号检测丢失, 写 CSV
+- --convert 把采集 CSV 换算为融合输入 (rad/s, g), 按 float32 逐步舍入,
+  与固件 sample_convert 的结果逐位一致
+
+CSV 格式 (序号已展开为连续整数):
+- P,seq,imu_type,odr_hz,gyro_gain×3,gyro_off×3,accel_gain×3,accel_off×3  从 seq 起生效
+- S,seq,gx,gy,gz,ax,ay,az                                                原始 int16
+
+依赖:
+- pip install hidapi
+
+用法:
+- python imu_capture.py --duration 60 --csv capture.csv
+- python imu_capture.py --convert capture.csv --out samples.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+SAMPLE_REPORT_ID = 0xFC
+PARAM_REPORT_ID = 0xFB
+HEADER_SIZE = 4
+SAMPLE_SIZE = 12
+PARAM_SIZE = 54
+
+CMD_STREAM_START = 0x30
+CMD_STREAM_STOP = 0x31
+STREAM_IMU_RAW = 0x20
+
+#==============================================================================
+# 报告解析
+#==============================================================================
+
+def parse_report(data: bytes) -> Optional[Dict]:
+    """解析 0xFC / 0xFB 报告 (格式见 include/imu_capture.h)"""
+    if len(data) >= HEADER_SIZE and data[0] == SAMPLE_REPORT_ID:
+        n = data[1]
+        if n == 0 or len(data) < HEADER_SIZE + n * SAMPLE_SIZE:
+            return None
+        seq = struct.unpack_from('<H', data, 2)[0]
+        samples = [struct.unpack_from('<6h', data, HEADER_SIZE + i * SAMPLE_SIZE) for i in range(n)]
+        return {'type': 'samples', 'seq': seq, 'samples': samples}
+
+    if len(data) >= PARAM_SIZE and data[0] == PARAM_REPORT_ID:
+        odr, seq = struct.unpack_from('<HH', data, 2)
+        return {'type': 'params', 'imu_type': data[1], 'odr': odr, 'seq': seq,
+                'values': list(struct.unpack_from('<12f', data, 6))}
+    return None
+
+
+class SeqUnwrapper:
+    """16 位序号展开, 参考点为最近一个样本 (参数报告的生效序号可能略超前或滞后)"""
+
+    def __init__(self):
+        self.last = None
+
+    def unwrap(self, seq: int, update: bool = True) -> int:
+        if self.last is None:
+            full = seq
+        else:
+            delta = ((seq - self.last) + 0x8000) & 0xFFFF
+            full = self.last + delta - 0x8000
+        if update:
+            self.last = full
+        return full
+
+
+class CaptureStats:
+    def __init__(self):
+        self.samples = 0
+        self.lost = 0
+        self.gaps = 0
+        self.params = 0
+        self.next_seq = None
+        self.first_time = None
+        self.last_time = None
+
+    def add(self, seq: int, n: int):
+        now = time.time()
+        if self.first_time is None:
+            self.first_time = now
+        self.last_time = now
+        if self.next_seq is not None and seq != self.next_seq:
+            self.gaps += 1
+            self.lost += max(0, seq - self.next_seq)
+        self.next_seq = seq + n
+        self.samples += n
+
+    def report(self):
+        print(f"\n样本 {self.samples}, 丢失 {self.lost} ({self.gaps} 处), 参数报告 {self.params}")
+        if self.samples and self.last_time and self.last_time > self.first_time:
+            total = self.samples + self.lost
+            print(f"接收速率 {self.samples / (self.last_time - self.first_time):.1f} 样本/秒, "
+                  f"丢失率 {100.0 * self.lost / total:.3f}%")
+
+#==============================================================================
+# 离线换算
+#==============================================================================
+
+def f32(v: float) -> float:
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def convert(src: str, dst: str) -> int:
+    """按固件 float32 运算顺序换算: raw × gain 舍入, 再减 off 舍入"""
+    params: List = []
+    rows: List = []
+    with open(src, newline='') as f:
+        for row in csv.reader(f):
+            if not row:
+                continue
+            if row[0] == 'P':
+                params.append((int(row[1]), [float(v) for v in row[4:16]]))
+            elif row[0] == 'S':
+                rows.append((int(row[1]), [int(v) for v in row[2:8]]))
+    if not params:
+        print("错误: 采集文件中没有参数报告")
+        return 1
+    params.sort(key=lambda p: p[0])
+
+    with open(dst, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['seq', 'gx', 'gy', 'gz', 'ax', 'ay', 'az'])
+        pi = 0
+        for seq, raw in rows:
+            while pi + 1 < len(params) and params[pi + 1][0] <= seq:
+                pi += 1
+            v = params[pi][1]
+            out = [f32(f32(raw[i] * v[i]) - v[3 + i]) for i in range(3)]
+            out += [f32(f32(raw[3 + i] * v[6 + i]) - v[9 + i]) for i in range(3)]
+            writer.writerow([seq] + [repr(x) for x in out])
+    print(f"换算 {len(rows)} 个样本, {len(params)} 组参数 -> {dst}")
+    return 0
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def capture(args) -> int:
+    try:
+        import hid
+    except ImportError:
+        print("错误: 请安装 hidapi: pip install hidapi")
+        return 1
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开追踪器: {e}")
+        return 1
+
+    csv_file = open(args.csv, 'w', newline='')
+    writer = csv.writer(csv_file)
+    unwrap = SeqUnwrapper()
+    stats = CaptureStats()
+
+    send_command(device, bytes([CMD_STREAM_START, STREAM_IMU_RAW]))
+    print(f"采集 {args.duration:.0f} 秒...")
+    deadline = time.time() + args.duration
+    try:
+        while time.time() < deadline:
+            data = device.read(64, timeout_ms=10)
+            if not data:
+                continue
+            rep = parse_report(bytes(data))
+            if not rep:
+                continue
+            if rep['type'] == 'params':
+                seq = unwrap.unwrap(rep['seq'], update=False)
+                writer.writerow(['P', seq, rep['imu_type'], rep['odr']] +
+                                [repr(v) for v in rep['values']])
+                stats.params += 1
+                continue
+            seq = unwrap.unwrap(rep['seq'])
+            stats.add(seq, len(rep['samples']))
+            for i, s in enumerate(rep['samples']):
+                writer.writerow(['S', seq + i] + list(s))
+            unwrap.unwrap((rep['seq'] + len(rep['samples']) - 1) & 0xFFFF)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        send_command(device, bytes([CMD_STREAM_STOP]))
+        device.close()
+        csv_file.close()
+
+    stats.report()
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X raw IMU capture')
+    parser.add_argument('--duration', type=float, default=10.0, help='采集时长 (秒, 默认 10)')
+    parser.add_argument('--csv', type=str, default='imu_capture.csv', help='采集输出文件')
+    parser.add_argument('--convert', type=str, help='换算已有采集文件, 不连接设备')
+    parser.add_argument('--out', type=str, default='imu_samples.csv', help='--convert 输出文件')
+    args = parser.parse_args()
+
+    if args.convert:
+        return convert(args.convert, args.out)
+    return capture(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 链路密钥写入 v0.6.3
+Link key provisioning over USB
+
+用途:
+- 经 0x25 命令把 128 位链路密钥写入接收器或 tracker (固件需 USE_RF_LINK_AUTH=1)
+- 同一套件的接收器和全部 tracker 必须写入同一密钥; 密钥只经 USB 写入, 设备不回读
+- 写入全 0 (--clear) 恢复明文链路
+- 不带参数时只查询当前设备是否已设置密钥
+
+依赖:
+- pip install hidapi
+
+用法:
+- python link_key.py --generate          (生成随机密钥写入, 并打印以便写入其他设备)
+- python link_key.py --key 00112233445566778899aabbccddeeff
+- python link_key.py --clear
+"""
+
+import argparse
+import secrets
+import sys
+import time
+from typing import Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_SET_LINK_KEY = 0x25
+KEY_SIZE = 16
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def parse_key(text: str) -> bytes:
+    try:
+        key = bytes.fromhex(text.replace(':', '').replace(' ', ''))
+    except ValueError:
+        raise SystemExit(f"无法解析密钥 '{text}' (需要 32 位十六进制)")
+    if len(key) != KEY_SIZE:
+        raise SystemExit(f"密钥长度为 {len(key)} 字节, 需要 {KEY_SIZE} 字节")
+    return key
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X link key provisioning')
+    group = parser.add_mutually_exclusive_group()
+    group.add_argument('--key', help='32 位十六进制密钥')
+    group.add_argument('--generate', action='store_true', help='生成随机密钥')
+    group.add_argument('--clear', action='store_true', help='清除密钥 (明文链路)')
+    args = parser.parse_args()
+
+    key = None
+    if args.key:
+        key = parse_key(args.key)
+    elif args.generate:
+        key = secrets.token_bytes(KEY_SIZE)
+    elif args.clear:
+        key = bytes(KEY_SIZE)
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        payload = bytes([CMD_SET_LINK_KEY]) + (key if key is not None else b'')
+        send_command(device, payload)
+        resp = wait_response(device, CMD_SET_LINK_KEY)
+    finally:
+        device.close()
+
+    if not resp:
+        print("无响应 (固件未启用 USE_RF_LINK_AUTH?)")
+        return 1
+    if key is not None and not resp[1]:
+        print("写入失败 (存储错误)")
+        return 1
+
+    if args.generate:
+        print(f"已写入密钥: {key.hex()}")
+        print(f"其他设备: python link_key.py --key {key.hex()}")
+    print("链路认证加密: " + ("已启用" if resp[2] else "未设置密钥 (明文)"))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -8,21 +8,27 @@ Long-run stability test logger
 - 每10秒记录一行JSONL
 - 生成最终健康报告
 - 检测异常并告警
+- v0.6.3: 记录每 tracker 样本到 USB 提交的延迟百分位 (固件 USE_LATENCY_PROBE)
+- v0.6.3: 命令/应答走 HID Feature 报告 (固件 USE_USB_FEATURE_DIAG), 轮询不再占用
+  数据报告的中断 IN 端点; 旧固件自动退回 IN 报告 (--in-endpoint 强制)
+- v0.6.3: 每次采样取回接收器的 1s 窗口统计 (固件 USE_SOAK_STATS), 两次轮询之间的
+  短时突发也能告警; 窗口逐条写入记录的 windows 字段
 
 依赖:
 - pip install hidapi pyserial
 
 用法:
-- python longrun_logger.py --duration 3600 --output report.jsonl
+- python longrun_logger.py --duration 3600 --output report.jsonl [--in-endpoint]
 """
 
 import argparse
 import json
+import struct
 import time
 import sys
 import os
 from datetime import datetime
-from dataclasses import dataclass, asdict
+from dataclasses import dataclass, asdict, field
 from typing import Optional, List, Dict
 
 # 尝试导入HID库
@@ -42,6 +48,23 @@ REPORT_ID_DATA = 0x01
 REPORT_ID_STATUS = 0x13
 REPORT_ID_DIAG = 0x20
 
+# v0.6.3: 接收器命令 (见 main_receiver.c usb_rx_callback)
+CMD_GET_VERSION = 0x20
+CMD_GET_LINK_STATS = 0x22
+CMD_RESET_LATENCY = 0x24
+CMD_GET_SOAK = 0x1C     # 响应 ID 0x9C (usb_debug DBG_CMD_GET_SOAK)
+LATENCY_UNIT_MS = 0.1
+MAX_TRACKERS = 10
+
+# v0.6.3: soak_stats.h soak_window_t (28 字节, LE)
+SOAK_WINDOW_FMT = '<HHHHHHHbbbBBBHHI'
+SOAK_WINDOW_FIELDS = ('seq', 'dur_ms', 'loop_min_us', 'loop_max_us', 'loop_avg_us',
+                      'packets', 'lost', 'rssi_min', 'rssi_max', 'rssi_avg', 'sync_miss',
+                      'batt_min', 'batt_max', 'isr_count', 'isr_avg_cyc', 'isr_max_cyc')
+SOAK_WINDOW_SIZE = struct.calcsize(SOAK_WINDOW_FMT)
+SOAK_LOOP_MAX_ALERT_US = 20000
+SOAK_LOSS_ALERT_PCT = 10.0
+
 @dataclass
 class TrackerStats:
     """单个Tracker统计"""
@@ -52,6 +75,13 @@ class TrackerStats:
     loss_rate_pct: float
     total_packets: int
     lost_packets: int
+    duplicate_packets: int = 0
+    late_packets: int = 0
+    ring_dropped: int = 0
+    interval_loss_pct: float = 0.0     # 本采样周期内 (计数器差值)
+    latency_p50_ms: Optional[float] = None  # 样本 → USB 提交 (最近若干样本)
+    latency_p90_ms: Optional[float] = None
+    latency_p99_ms: Optional[float] = None
 
 @dataclass
 class ReceiverStats:
@@ -71,16 +101,22 @@ class TestRecord:
     receiver: ReceiverStats
     trackers: List[TrackerStats]
     alerts: List[str]
+    windows: List[Dict] = field(default_factory=list)   # 本次采样取回的设备端窗口
 
 class LongRunLogger:
-    def __init__(self, duration_sec: int, output_file: str, verbose: bool = False):
+    def __init__(self, duration_sec: int, output_file: str, verbose: bool = False,
+                 use_feature: bool = True):
         self.duration_sec = duration_sec
+        self.use_feature = use_feature
         self.output_file = output_file
         self.verbose = verbose
         self.device = None
         self.records: List[TestRecord] = []
         self.start_time = None
         self.alerts_count = 0
+        self.last_counters: Dict[int, tuple] = {}
+        self.soak_next: Optional[int] = None     # 下一个待取窗口序号
+        self.soak_missed = 0
         
     def connect(self) -> bool:
         """连接USB设备"""
@@ -93,6 +129,12 @@ class LongRunLogger:
             self.device.open(USB_VID, USB_PID)
             self.device.set_nonblocking(True)
             print(f"Connected to {self.device.get_manufacturer_string()} {self.device.get_product_string()}")
+            # 固件不支持 Feature 报告时 (无应答或 STALL) 退回中断端点
+            if self.use_feature and self._feature_request([CMD_GET_VERSION], CMD_GET_VERSION) is None:
+                print("Feature report channel unavailable, polling over interrupt IN")
+                self.use_feature = False
+            # 延迟窗口从测试开始计 (旧固件忽略该命令)
+            self._send([CMD_RESET_LATENCY])
             return True
         except Exception as e:
             print(f"Failed to connect: {e}")
@@ -118,32 +160,125 @@ class LongRunLogger:
             }
         
         try:
-            # 发送诊断请求
-            self.device.write([REPORT_ID_DIAG, 0x01])  # 请求统计
-            
-            # 读取响应
-            data = self.device.read(64, timeout_ms=1000)
-            if not data:
-                return None
+            stats = {
+                'uptime_sec': 0,
+                'superframe_count': 0,
+                'data_received': 0,
+                'frame_overrun': 0,
+                'usb_tx_count': 0,
+                'trackers': []
+            }
             
-            # 解析响应 (根据实际协议)
-            return self._parse_diag_response(data)
+            # v0.6.3: 逐个 tracker 读取接收器包解码处维护的链路统计
+            for tid in range(MAX_TRACKERS):
+                resp = self._request([CMD_GET_LINK_STATS, tid], CMD_GET_LINK_STATS)
+                if resp is None or resp[1] != tid:
+                    continue
+                tr = self._parse_link_stats(resp)
+                if tr['paired']:
+                    stats['trackers'].append(tr)
+                    stats['data_received'] += tr['total_packets']
+            return stats
             
         except Exception as e:
             if self.verbose:
                 print(f"Read error: {e}")
             return None
     
-    def _parse_diag_response(self, data: bytes) -> Dict:
-        """解析诊断响应"""
-        # 简化解析，实际需要根据协议
+    def _send(self, payload: List[int]):
+        """只下发命令, 不等应答"""
+        # hidapi 约定首字节为报告 ID, 接收器不使用报告 ID
+        if self.use_feature:
+            self.device.send_feature_report([0x00] + payload)
+        else:
+            self.device.write([0x00] + payload)
+    
+    def _feature_request(self, payload: List[int], resp_id: int) -> Optional[bytes]:
+        """经 Feature 报告发送命令, 轮询 GET_REPORT 直到缓冲中出现对应应答"""
+        try:
+            self.device.send_feature_report([0x00] + payload)
+            deadline = time.time() + 0.5
+            while time.time() < deadline:
+                data = self.device.get_feature_report(0x00, 65)
+                # 返回值首字节为报告 ID (0), 其后是 64 字节 Feature 缓冲
+                if data and len(data) > 1 and data[1] == resp_id:
+                    return bytes(data[1:])
+                time.sleep(0.002)
+        except (IOError, OSError, ValueError) as e:
+            if self.verbose:
+                print(f"Feature request error: {e}")
+        return None
+    
+    def _request(self, payload: List[int], resp_id: int) -> Optional[bytes]:
+        """发送命令并等待对应响应 (中断 IN 路径上其间的数据报告丢弃)"""
+        if self.use_feature:
+            return self._feature_request(payload, resp_id)
+        self.device.write([0x00] + payload)
+        deadline = time.time() + 0.5
+        while time.time() < deadline:
+            data = self.device.read(64, timeout_ms=50)
+            if data and data[0] == resp_id:
+                return bytes(data)
+        return None
+    
+    def read_windows(self) -> List[Dict]:
+        """取回上次之后的全部窗口统计 (旧固件无应答时返回空)"""
+        if not HID_AVAILABLE:
+            return []
+        windows = []
+        while True:
+            start = self.soak_next if self.soak_next is not None else 0
+            resp = self._request([CMD_GET_SOAK, start & 0xFF, start >> 8], CMD_GET_SOAK | 0x80)
+            if resp is None:
+                break
+            first, nxt, n = struct.unpack_from('<HHB', resp, 1)
+            if self.soak_next is not None:
+                # 主机读取过慢时最旧窗口已被覆盖
+                self.soak_missed += (first - start) & 0xFFFF
+            for k in range(n):
+                vals = struct.unpack_from(SOAK_WINDOW_FMT, resp, 6 + k * SOAK_WINDOW_SIZE)
+                windows.append(dict(zip(SOAK_WINDOW_FIELDS, vals)))
+            self.soak_next = (first + n) & 0xFFFF
+            if n == 0 or self.soak_next == nxt:
+                break
+        return windows
+    
+    def _parse_link_stats(self, data: bytes) -> Dict:
+        """解析 0x22 链路统计响应"""
+        received, lost, dup, late, dropped = (
+            int.from_bytes(data[8 + k * 4:12 + k * 4], 'little') for k in range(5))
+        tid = data[1]
+        
+        # 周期内丢包率用累计计数器差值计算, 不依赖固件窗口长度
+        interval_loss = 0.0
+        prev = self.last_counters.get(tid)
+        if prev and received >= prev[0]:
+            d_rx = received - prev[0]
+            d_lost = max(0, lost - prev[1])
+            if d_rx + d_lost > 0:
+                interval_loss = 100.0 * d_lost / (d_rx + d_lost)
+        self.last_counters[tid] = (received, lost)
+        
+        latency = {}
+        if len(data) >= 32 and data[28]:
+            # [28] 窗口样本数, [29-31] p50/p90/p99
+            latency = {f'latency_{name}_ms': round(data[k] * LATENCY_UNIT_MS, 1)
+                       for name, k in (('p50', 29), ('p90', 30), ('p99', 31))}
+        
         return {
-            'uptime_sec': int.from_bytes(data[4:8], 'little') if len(data) > 8 else 0,
-            'superframe_count': int.from_bytes(data[8:12], 'little') if len(data) > 12 else 0,
-            'data_received': int.from_bytes(data[12:16], 'little') if len(data) > 16 else 0,
-            'frame_overrun': int.from_bytes(data[16:20], 'little') if len(data) > 20 else 0,
-            'usb_tx_count': int.from_bytes(data[20:24], 'little') if len(data) > 24 else 0,
-            'trackers': []
+            **latency,
+            'tracker_id': tid,
+            'paired': bool(data[2] & 0x01),
+            'connected': bool(data[2] & 0x02),
+            'loss_rate_pct': data[3],
+            'rssi': data[6] - 128,
+            'battery_pct': data[7],
+            'total_packets': received,
+            'lost_packets': lost,
+            'duplicate_packets': dup,
+            'late_packets': late,
+            'ring_dropped': dropped,
+            'interval_loss_pct': round(interval_loss, 2),
         }
     
     def check_alerts(self, stats: Dict) -> List[str]:
@@ -161,11 +296,24 @@ class LongRunLogger:
             if tr.get('loss_rate_pct', 0) > 10:
                 alerts.append(f"HIGH_LOSS_RATE: tracker={tr.get('tracker_id')}, loss={tr.get('loss_rate_pct')}%")
         
+        # v0.6.3: 设备端窗口, 轮询之间的突发
+        for w in stats.get('windows', []):
+            if w['loop_max_us'] > SOAK_LOOP_MAX_ALERT_US:
+                alerts.append(f"LONG_LOOP: window={w['seq']}, max={w['loop_max_us']}us")
+            total = w['packets'] + w['lost']
+            if total and 100.0 * w['lost'] / total > SOAK_LOSS_ALERT_PCT:
+                alerts.append(f"LOSS_BURST: window={w['seq']}, lost={w['lost']}/{total}")
+        
         return alerts
     
     def record_sample(self) -> TestRecord:
         """记录一个样本"""
         stats = self.read_stats() or {}
+        try:
+            stats['windows'] = self.read_windows()
+        except Exception as e:
+            if self.verbose:
+                print(f"Window read error: {e}")
         
         elapsed = int(time.time() - self.start_time) if self.start_time else 0
         
@@ -186,7 +334,14 @@ class LongRunLogger:
                 battery_pct=tr.get('battery_pct', 100),
                 loss_rate_pct=tr.get('loss_rate_pct', 0),
                 total_packets=tr.get('total_packets', 0),
-                lost_packets=tr.get('lost_packets', 0)
+                lost_packets=tr.get('lost_packets', 0),
+                duplicate_packets=tr.get('duplicate_packets', 0),
+                late_packets=tr.get('late_packets', 0),
+                ring_dropped=tr.get('ring_dropped', 0),
+                interval_loss_pct=tr.get('interval_loss_pct', 0.0),
+                latency_p50_ms=tr.get('latency_p50_ms'),
+                latency_p90_ms=tr.get('latency_p90_ms'),
+                latency_p99_ms=tr.get('latency_p99_ms')
             )
             for i, tr in enumerate(stats.get('trackers', []))
         ]
@@ -199,7 +354,8 @@ class LongRunLogger:
             elapsed_sec=elapsed,
             receiver=receiver,
             trackers=trackers,
-            alerts=alerts
+            alerts=alerts,
+            windows=stats.get('windows', [])
         )
         
         return record
@@ -272,9 +428,48 @@ class LongRunLogger:
                 'final_uptime': self.records[-1].receiver.uptime_sec,
                 'final_superframes': self.records[-1].receiver.superframe_count,
                 'final_frame_overrun': self.records[-1].receiver.frame_overrun,
-            }
+            },
+            'trackers': {}
         }
         
+        # v0.6.3: 设备端窗口统计汇总
+        windows = [w for rec in self.records for w in rec.windows]
+        if windows:
+            report['windows'] = {
+                'count': len(windows),
+                'missed': self.soak_missed,
+                'loop_max_us': max(w['loop_max_us'] for w in windows),
+                'isr_max_cyc': max(w['isr_max_cyc'] for w in windows),
+                'worst_loss': max((w['lost'], w['packets']) for w in windows),
+                'sync_miss': sum(w['sync_miss'] for w in windows),
+            }
+        
+        # v0.6.3: 整个测试期间的丢包率 (首尾累计计数器差值)
+        first: Dict[int, TrackerStats] = {}
+        for rec in self.records:
+            for tr in rec.trackers:
+                first.setdefault(tr.tracker_id, tr)
+        for tr in self.records[-1].trackers:
+            f = first.get(tr.tracker_id, tr)
+            d_rx = max(0, tr.total_packets - f.total_packets)
+            d_lost = max(0, tr.lost_packets - f.lost_packets)
+            report['trackers'][str(tr.tracker_id)] = {
+                'received': d_rx,
+                'lost': d_lost,
+                'duplicate': max(0, tr.duplicate_packets - f.duplicate_packets),
+                'late': max(0, tr.late_packets - f.late_packets),
+                'ring_dropped': max(0, tr.ring_dropped - f.ring_dropped),
+                'loss_pct': round(100.0 * d_lost / (d_rx + d_lost), 3) if d_rx + d_lost else 0.0,
+            }
+            # v0.6.3: 每次采样的窗口百分位, 报告取中位 p50 与最差 p99
+            p50 = sorted(t.latency_p50_ms for rec in self.records for t in rec.trackers
+                         if t.tracker_id == tr.tracker_id and t.latency_p50_ms is not None)
+            p99 = [t.latency_p99_ms for rec in self.records for t in rec.trackers
+                   if t.tracker_id == tr.tracker_id and t.latency_p99_ms is not None]
+            if p50:
+                report['trackers'][str(tr.tracker_id)]['latency_p50_ms'] = p50[len(p50) // 2]
+                report['trackers'][str(tr.tracker_id)]['latency_p99_max_ms'] = max(p99)
+        
         # 写入报告
         report_file = self.output_file.replace('.jsonl', '_report.json')
         with open(report_file, 'w') as f:
@@ -289,10 +484,13 @@ def main():
     parser.add_argument('--duration', type=int, default=3600, help='Test duration in seconds (default: 3600)')
     parser.add_argument('--output', type=str, default='longrun_test.jsonl', help='Output file (JSONL format)')
     parser.add_argument('--verbose', '-v', action='store_true', help='Verbose output')
+    parser.add_argument('--in-endpoint', action='store_true',
+                        help='Poll over interrupt IN reports instead of HID feature reports')
     
     args = parser.parse_args()
     
-    logger = LongRunLogger(args.duration, args.output, args.verbose)
+    logger = LongRunLogger(args.duration, args.output, args.verbose,
+                           use_feature=not args.in_endpoint)
     success = logger.run()
     
     sys.exit(0 if success else 1)
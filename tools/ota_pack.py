@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X OTA 镜像打包 v0.6.3
+Compressed / delta OTA image packer
+
+用途:
+- 把固件 .bin 打包为压缩镜像, 或相对 --base 旧固件的增量补丁 (固件需 USE_OTA_PACK=1)
+- 格式见 include/ota_update.h (OTA_PACK_*), ota_apply 时在设备上解码
+- 输出文件可直接交给 rf_ota.py 广播; 打包后自检解码结果
+
+依赖:
+- 无 (仅标准库)
+
+用法:
+- python ota_pack.py output/tracker_CH592_v0.4.2.bin -o tracker.otz
+- python ota_pack.py new.bin --base old.bin -o patch.otz
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+from typing import Dict, List, Optional, Tuple
+
+MAGIC = 0x5A41544F
+HEADER = struct.Struct('<5I')
+
+OP_LITERAL = 0
+OP_MATCH = 1
+OP_BASE = 2
+OP_FILL = 3
+MIN_LEN = {OP_LITERAL: 1, OP_MATCH: 3, OP_BASE: 1, OP_FILL: 3}
+
+HASH_LEN = 4
+CHAIN_DEPTH = 16            # 每个哈希最多比较的候选位置
+
+#==============================================================================
+# 编码
+#==============================================================================
+
+def varint(v: int) -> bytes:
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def op(kind: int, length: int, arg: bytes = b'') -> bytes:
+    n = length - MIN_LEN[kind]
+    if n < 63:
+        return bytes([(kind << 6) | n]) + arg
+    return bytes([(kind << 6) | 63]) + varint(n - 63) + arg
+
+
+def match_len(a: bytes, i: int, b: bytes, j: int, limit: int) -> int:
+    n = 0
+    while n < limit and a[i + n] == b[j + n]:
+        n += 1
+    return n
+
+
+class Index:
+    """4 字节哈希 → 位置链 (新位置在前)"""
+
+    def __init__(self):
+        self.table: Dict[bytes, List[int]] = {}
+
+    def add(self, data: bytes, pos: int):
+        if pos + HASH_LEN <= len(data):
+            chain = self.table.setdefault(data[pos:pos + HASH_LEN], [])
+            chain.insert(0, pos)
+            del chain[CHAIN_DEPTH:]
+
+    def best(self, src: bytes, data: bytes, i: int) -> Tuple[int, int]:
+        if i + HASH_LEN > len(data):
+            return 0, 0
+        best_len, best_pos = 0, 0
+        for pos in self.table.get(data[i:i + HASH_LEN], ()):
+            limit = len(data) - i
+            if src is not data:
+                limit = min(limit, len(src) - pos)
+            else:
+                limit = min(limit, i - pos) if pos < i else 0
+            n = match_len(data, i, src, pos, limit)
+            if n > best_len:
+                best_len, best_pos = n, pos
+        return best_len, best_pos
+
+
+def pack(image: bytes, base: Optional[bytes]) -> bytes:
+    base_index = Index()
+    if base:
+        for p in range(len(base) - HASH_LEN + 1):
+            base_index.add(base, p)
+    out_index = Index()
+
+    body = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        if literal:
+            body.extend(op(OP_LITERAL, len(literal), bytes(literal)))
+            literal.clear()
+
+    i = 0
+    while i < len(image):
+        run = 1
+        while i + run < len(image) and image[i + run] == image[i]:
+            run += 1
+        m_len, m_pos = out_index.best(image, image, i)
+        b_len, b_pos = base_index.best(base, image, i) if base else (0, 0)
+
+        # 按节省的字节数选择 (操作开销: FILL 2, MATCH 1+距离, BASE 1+偏移)
+        choices = []
+        if run >= 3:
+            choices.append((run - 2, OP_FILL, run, image[i]))
+        if m_len >= 4:
+            choices.append((m_len - 1 - len(varint(i - m_pos - 1)), OP_MATCH, m_len, i - m_pos - 1))
+        if b_len >= 4:
+            choices.append((b_len - 1 - len(varint(b_pos)), OP_BASE, b_len, b_pos))
+        choices = [c for c in choices if c[0] > 1]
+
+        if not choices:
+            literal.append(image[i])
+            out_index.add(image, i)
+            i += 1
+            continue
+
+        _, kind, length, arg = max(choices)
+        flush_literal()
+        if kind == OP_FILL:
+            body.extend(op(OP_FILL, length, bytes([arg])))
+        else:
+            body.extend(op(kind, length, varint(arg)))
+        for p in range(i, i + length):
+            out_index.add(image, p)
+        i += length
+    flush_literal()
+
+    base_size = len(base) if base else 0
+    base_crc = binascii.crc32(base) & 0xFFFFFFFF if base else 0
+    header = HEADER.pack(MAGIC, len(image), binascii.crc32(image) & 0xFFFFFFFF,
+                         base_size, base_crc)
+    return header + bytes(body)
+
+#==============================================================================
+# 解码 (自检, 与 ota_update.c pack_decode 一致)
+#==============================================================================
+
+def read_varint(data: bytes, pos: int) -> Tuple[int, int]:
+    v, shift = 0, 0
+    while True:
+        b = data[pos]
+        pos += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, pos
+
+
+def unpack(data: bytes, base: Optional[bytes]) -> bytes:
+    magic, out_size, out_crc, base_size, base_crc = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("不是打包镜像")
+    if base_size and (not base or binascii.crc32(base[:base_size]) & 0xFFFFFFFF != base_crc):
+        raise ValueError("基准固件不符")
+
+    out = bytearray()
+    pos = HEADER.size
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        kind, length = code >> 6, code & 0x3F
+        if length == 63:
+            ext, pos = read_varint(data, pos)
+            length += ext
+        length += MIN_LEN[kind]
+        if kind == OP_LITERAL:
+            out += data[pos:pos + length]
+            pos += length
+        elif kind == OP_MATCH:
+            dist, pos = read_varint(data, pos)
+            src = len(out) - dist - 1
+            for k in range(length):
+                out.append(out[src + k])
+        elif kind == OP_BASE:
+            src, pos = read_varint(data, pos)
+            out += base[src:src + length]
+        else:
+            out += bytes([data[pos]]) * length
+            pos += 1
+    if len(out) != out_size or binascii.crc32(out) & 0xFFFFFFFF != out_crc:
+        raise ValueError("解码结果 CRC 不符")
+    return bytes(out)
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X OTA image packer')
+    parser.add_argument('image', help='新固件 (.bin)')
+    parser.add_argument('-o', '--output', required=True, help='输出打包镜像')
+    parser.add_argument('--base', type=str, help='设备当前运行的旧固件 (.bin), 生成增量补丁')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    base = None
+    if args.base:
+        with open(args.base, 'rb') as f:
+            base = f.read()
+
+    packed = pack(image, base)
+    if unpack(packed, base) != image:
+        print("错误: 自检失败")
+        return 1
+
+    with open(args.output, 'wb') as f:
+        f.write(packed)
+    kind = '增量补丁' if base else '压缩镜像'
+    print(f"{kind}: {len(image)} → {len(packed)} 字节 ({len(packed) * 100 / len(image):.1f}%)")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 周期计数探针读取 v0.6.3
+Cycle-counter probe dump
+
+用途:
+- 经 usb_debug 0x16 命令逐个读取探针 (固件需 USE_PROFILE=1)
+- 打印次数、最小/平均/最大周期数和换算后的微秒, 以及累计占 CPU 的比例
+- --reset 读完后清零, --interval 周期性读取 (每次读完清零, 得到区间统计)
+
+依赖:
+- pip install hidapi
+
+用法:
+- python profile_dump.py
+- python profile_dump.py --interval 5 --mhz 60
+"""
+
+import argparse
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_PROFILE = 0x16
+RESP_GET_PROFILE = CMD_GET_PROFILE | 0x80
+PROBE_RESET = 0xFF
+PROBE_DISABLED = 0xFE
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == RESP_GET_PROFILE:
+            return bytes(data)
+    return None
+
+
+def read_probe(device, index: int) -> Optional[Dict]:
+    send_command(device, bytes([CMD_GET_PROFILE, index]))
+    data = wait_response(device)
+    if not data or len(data) < 3:
+        return None
+    if data[1] == PROBE_DISABLED:
+        raise SystemExit("固件未启用 USE_PROFILE")
+    if data[1] != index or len(data) < 24:
+        return None
+    count, cmin, cmax, total = struct.unpack_from('<IIIQ', data, 3)
+    name = data[23:].split(b'\x00', 1)[0].decode('ascii', 'replace')
+    return {'index': index, 'probes': data[2], 'name': name, 'count': count,
+            'min': cmin, 'max': cmax, 'total': total}
+
+
+def read_all(device) -> List[Dict]:
+    first = read_probe(device, 0)
+    if not first:
+        raise SystemExit("无响应")
+    probes = [first]
+    for i in range(1, first['probes']):
+        p = read_probe(device, i)
+        if p:
+            probes.append(p)
+    return probes
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def report(probes: List[Dict], mhz: float, window_s: Optional[float]):
+    print(f"\n{'探针':<14} {'次数':>9} {'最小':>9} {'平均':>10} {'最大':>9} "
+          f"{'平均us':>8} {'最大us':>8} {'CPU%':>6}")
+    for p in probes:
+        if p['count'] == 0:
+            print(f"{p['name']:<14} {0:>9}")
+            continue
+        avg = p['total'] / p['count']
+        load = ''
+        if window_s:
+            load = f"{100.0 * p['total'] / (mhz * 1e6 * window_s):.2f}"
+        print(f"{p['name']:<14} {p['count']:>9} {p['min']:>9} {avg:>10.1f} {p['max']:>9} "
+              f"{avg / mhz:>8.2f} {p['max'] / mhz:>8.2f} {load:>6}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X cycle-counter probe dump')
+    parser.add_argument('--mhz', type=float, default=60.0, help='CPU 主频 (MHz, 默认 60)')
+    parser.add_argument('--reset', action='store_true', help='读取后清零')
+    parser.add_argument('--interval', type=float, help='周期读取间隔 (秒), 每次读完清零')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        if not args.interval:
+            report(read_all(device), args.mhz, None)
+            if args.reset:
+                send_command(device, bytes([CMD_GET_PROFILE, PROBE_RESET]))
+            return 0
+
+        send_command(device, bytes([CMD_GET_PROFILE, PROBE_RESET]))
+        last = time.time()
+        while True:
+            time.sleep(args.interval)
+            probes = read_all(device)
+            send_command(device, bytes([CMD_GET_PROFILE, PROBE_RESET]))
+            now = time.time()
+            report(probes, args.mhz, now - last)
+            last = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        device.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X RAM 占用报告 v0.6.3
+RAM budget report
+
+用途:
+- 读链接 map 文件, 列出 RAM 中各输出段 (热代码/data/bss/集中区/堆/栈/保持区) 的大小
+- 按模块 (源文件) 汇总 data + bss; LTO 下 map 中的输入段都来自 ltrans 临时文件,
+  此时用 ELF 符号表 (nm -S) 拆出各变量, 再按定义所在的源文件归属
+- 集中区 (.bss.arena.<module>, 见 optimize.h RAM_ARENA) 按模块单列, 并与 RAM_ARENA_BUDGET 比较
+- 每次链接后 Makefile 以 --summary 打印一行, make ram-report 打印明细
+
+用法:
+- python ram_report.py build/receiver/SlimeVR_CH59X.map --elf build/receiver/SlimeVR_CH59X.elf
+- python ram_report.py firmware.map --elf firmware.elf --nm riscv-none-elf-nm --arena-budget 12288 --summary
+- python ram_report.py firmware.map --elf firmware.elf --symbols 20
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+from typing import Dict, List, Optional, Tuple
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+RAM_SECTIONS = {'.highcode': '热代码', '.data': 'data', '.bss': 'bss', '.heap': '堆',
+                '.boot_token': '启动令牌', '.retained': '保持区', '.stack': '栈'}
+
+ARENA_PREFIX = '.bss.arena.'
+
+#==============================================================================
+# map 解析
+#==============================================================================
+
+def parse_map(path: str):
+    """返回 (内存区 {名: (起点, 长度)}, 输出段 [(名, 地址, 大小)], 输入段 [(输出段, 名, 地址, 大小, 文件)], LOAD 文件)"""
+    with open(path, errors='replace') as f:
+        lines = f.read().splitlines()
+
+    regions: Dict[str, Tuple[int, int]] = {}
+    outs: List[Tuple[str, int, int]] = []
+    ins: List[Tuple[str, str, int, int, str]] = []
+    loads: List[str] = []
+
+    i = 0
+    while i < len(lines) and lines[i].strip() != 'Memory Configuration':
+        i += 1
+    i += 1
+    while i < len(lines) and lines[i].strip() != 'Linker script and memory map':
+        m = re.match(r'^(\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)', lines[i])
+        if m and m.group(1) != '*default*':
+            regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+        i += 1
+
+    cur = None
+    pending = None          # 名字单独一行时, 地址在下一行
+    for line in lines[i:]:
+        if line.startswith('LOAD '):
+            loads.append(line[5:].strip())
+            continue
+        if pending is not None:
+            name, is_out = pending
+            pending = None
+            m = re.match(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s*(.*)$', line)
+            if m:
+                addr, size, rest = int(m.group(1), 16), int(m.group(2), 16), m.group(3)
+                if is_out:
+                    cur = name
+                    outs.append((name, addr, size))
+                elif cur:
+                    ins.append((cur, name, addr, size, rest.strip()))
+                continue
+
+        m = re.match(r'^(\.\S+|/DISCARD/)\s*(?:0x([0-9a-f]+)\s+0x([0-9a-f]+))?', line)
+        if m:
+            if m.group(2) is None:
+                pending = (m.group(1), True)
+            else:
+                cur = m.group(1)
+                outs.append((cur, int(m.group(2), 16), int(m.group(3), 16)))
+            continue
+
+        m = re.match(r'^ (\.\S+|COMMON)\s*(?:0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.*))?$', line)
+        if m and cur:
+            if m.group(2) is None:
+                pending = (m.group(1), False)
+            else:
+                ins.append((cur, m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()))
+    return regions, outs, ins, loads
+
+#==============================================================================
+# 符号与源文件归属
+#==============================================================================
+
+def read_symbols(nm: str, elf: str) -> Tuple[Dict[str, int], List[Tuple[int, int, str]]]:
+    try:
+        out = subprocess.run([nm, '-S', elf], check=True, capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        raise SystemExit(f"运行 {nm} 失败: {e}")
+
+    marks: Dict[str, int] = {}
+    objs: List[Tuple[int, int, str]] = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3:
+            marks[parts[2]] = int(parts[0], 16)
+        elif len(parts) == 4 and parts[2] in 'bBdDgGsSvV':
+            objs.append((int(parts[0], 16), int(parts[1], 16), parts[3]))
+    return marks, objs
+
+
+def source_of(obj: str) -> Optional[str]:
+    """build/<target>/src/hal/foo.o -> src/hal/foo.c"""
+    m = re.search(r'(?:^|/)build/[^/]+/(.+)\.o$', obj)
+    if not m:
+        return None
+    for ext in ('.c', '.S'):
+        p = m.group(1) + ext
+        if os.path.exists(os.path.join(ROOT, p)):
+            return p
+    return None
+
+
+def module_name(path: str) -> str:
+    path = re.sub(r'\.[cSo]$', '', path)
+    return path[4:] if path.startswith('src/') else path
+
+
+class SourceIndex:
+    """变量名 -> 定义所在的源文件 (在链接用到的源文件里按声明形式查找)"""
+
+    def __init__(self, sources: List[str]):
+        self.texts = {}
+        for s in sources:
+            try:
+                with open(os.path.join(ROOT, s), errors='replace') as f:
+                    text = re.sub(r'/\*.*?\*/', '', f.read(), flags=re.S)
+                self.texts[s] = re.sub(r'//[^\n]*', '', text)
+            except OSError:
+                pass
+        self.cache: Dict[str, Optional[str]] = {}
+
+    def lookup(self, sym: str) -> Optional[str]:
+        base = sym.split('.')[0]        # LTO 静态变量: name.lto_priv.0, 函数内静态: name.0
+        if base in self.cache:
+            return self.cache[base]
+        n = re.escape(base)
+        decl = re.compile(r'^\s*(?!return\b|else\b|case\b|goto\b)'
+                          r'(?:(?:[A-Za-z_]\w*|__attribute__\(\(.*?\)\))[\s\*]+)+' + n + r'\b\s*[\[=;,A-Z_]'
+                          r'|^\s*\}\s*' + n + r'\b'
+                          r'|^\s*static\b[^;(=]*,\s*\**' + n + r'\b\s*[\[=;,]', re.M)   # static T a, b, c;
+        hits = [s for s, t in self.texts.items() if decl.search(t)]
+        # 优先非 extern 定义
+        defs = [s for s in hits if not re.search(r'^\s*extern\b[^;]*\b' + n + r'\b', self.texts[s], re.M)]
+        found = (defs or hits or [None])[0]
+        self.cache[base] = found
+        return found
+
+#==============================================================================
+# 归类
+#==============================================================================
+
+def lib_name(obj: str) -> str:
+    m = re.search(r'([^/]+)\.a\(', obj)
+    return m.group(1) if m else os.path.basename(obj)
+
+
+def attribute(ins, objs, index: Optional[SourceIndex]):
+    """返回明细 [(模块, 符号/输入段, 大小, 是否集中区)]"""
+    rows: List[Tuple[str, str, int, bool]] = []
+    for out, name, addr, size, obj in ins:
+        if out not in ('.data', '.bss') or size == 0:
+            continue
+        arena = name.startswith(ARENA_PREFIX)
+        src = source_of(obj)
+        if src:
+            rows.append((module_name(src), name, size, arena))
+            continue
+        if '.a(' in obj:
+            rows.append((lib_name(obj), name, size, arena))
+            continue
+        # LTO / 无法识别的对象: 按符号拆分
+        used = 0
+        for saddr, ssize, sname in objs:
+            if addr <= saddr < addr + size and ssize:
+                src = index.lookup(sname) if index else None
+                if src:
+                    mod = module_name(src)
+                else:
+                    mod = name[len(ARENA_PREFIX):] + '?' if arena else '?'
+                rows.append((mod, sname, ssize, arena))
+                used += ssize
+        if used < size:
+            rows.append(('(对齐/未命名)', name, size - used, arena))
+    return rows
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def in_region(addr: int, regions: Dict[str, Tuple[int, int]], names) -> bool:
+    return any(r in regions and regions[r][0] <= addr < regions[r][0] + regions[r][1] for r in names)
+
+
+def report(regions, outs, ins, rows, marks, arena_budget: int, summary: bool, top: int):
+    ram_names = [r for r in regions if r.startswith('RAM')]
+    ram_total = sum(regions[r][1] for r in ram_names)
+    secs = {n: s for n, a, s in outs if n in RAM_SECTIONS and in_region(a, regions, ram_names)}
+    used = sum(secs.values())
+
+    if '_arena_start' in marks and '_arena_end' in marks:
+        arena = marks['_arena_end'] - marks['_arena_start']
+    else:
+        arena = sum(s for _, n, _, s, _ in ins if n.startswith(ARENA_PREFIX))
+    over = arena_budget and arena > arena_budget
+    budget_text = f" / {arena_budget}" if arena_budget else ''
+
+    if summary:
+        print(f"[RAM] {used} / {ram_total} B  (data {secs.get('.data', 0)}, bss {secs.get('.bss', 0)} "
+              f"含集中区 {arena}{budget_text}, 热代码 {secs.get('.highcode', 0)}, "
+              f"堆 {secs.get('.heap', 0)}, 栈 {secs.get('.stack', 0)})  空闲 {ram_total - used} B"
+              f"{'  集中区超出预算!' if over else ''}")
+        return
+
+    print("输出段:")
+    for name, label in RAM_SECTIONS.items():
+        if name in secs:
+            print(f"  {name:<12} {secs[name]:>7}  {label}")
+    print(f"  {'合计':<10} {used:>7} / {ram_total}  空闲 {ram_total - used}")
+
+    mods: Dict[str, List[int]] = {}
+    for mod, _, size, is_arena in rows:
+        m = mods.setdefault(mod, [0, 0])
+        m[1 if is_arena else 0] += size
+    print(f"\n{'模块':<30} {'data+bss':>9} {'集中区':>7} {'合计':>7}")
+    for mod, (plain, ar) in sorted(mods.items(), key=lambda kv: -sum(kv[1])):
+        print(f"{mod:<32} {plain:>9} {ar:>7} {plain + ar:>7}")
+
+    arena_mods: Dict[str, int] = {}
+    for _, name, _, size, _ in ins:
+        if name.startswith(ARENA_PREFIX):
+            tag = name[len(ARENA_PREFIX):]
+            arena_mods[tag] = arena_mods.get(tag, 0) + size
+    if arena_mods:
+        print("\n集中区 (RAM_ARENA):")
+        for tag, size in sorted(arena_mods.items(), key=lambda kv: -kv[1]):
+            print(f"  {tag:<20} {size:>7}")
+    print(f"  {'合计':<18} {arena:>7}{budget_text}  {'超出预算!' if over else 'OK'}")
+
+    if top:
+        print(f"\n最大的 {top} 个变量:")
+        for mod, sym, size, is_arena in sorted(rows, key=lambda r: -r[2])[:top]:
+            print(f"  {size:>6}  {sym:<32} {mod}{'  [集中区]' if is_arena else ''}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X RAM budget report')
+    parser.add_argument('map', help='链接 map 文件')
+    parser.add_argument('--elf', help='链接后的 ELF (LTO 构建按符号拆分模块时需要)')
+    parser.add_argument('--nm', default='riscv-none-elf-nm', help='nm 工具')
+    parser.add_argument('--arena-budget', type=int, default=0, help='RAM_ARENA_BUDGET (字节)')
+    parser.add_argument('--symbols', type=int, default=0, metavar='N', help='列出最大的 N 个变量')
+    parser.add_argument('--summary', action='store_true', help='只打印一行汇总')
+    args = parser.parse_args()
+
+    regions, outs, ins, loads = parse_map(args.map)
+    if not any(r.startswith('RAM') for r in regions):
+        raise SystemExit("map 中没有 RAM 内存区")
+    marks, objs = read_symbols(args.nm, args.elf) if args.elf else ({}, [])
+    sources = [s for s in (source_of(l) for l in loads) if s]
+    rows = [] if args.summary else attribute(ins, objs, SourceIndex(sources))
+    report(regions, outs, ins, rows, marks, args.arena_budget, args.summary, args.symbols)
+
+    if args.arena_budget and '_arena_start' in marks:
+        return 1 if marks['_arena_end'] - marks['_arena_start'] > args.arena_budget else 0
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X RF 固件广播升级 v0.6.3
+RF firmware broadcast to all trackers
+
+用途:
+- 经 HID 命令 0x40/0x41 把 tracker 固件暂存到接收器 OTA 分区 (固件需 USE_RF_OTA=1, make OTA=1)
+- 0x42 开始广播, 所有在线 tracker 同时接收; 0x43 轮询每个 tracker 的进度
+- 全部 tracker 校验通过后 (或 --apply 指定), 0x44 让 tracker 写入应用区并重启
+
+依赖:
+- pip install hidapi
+
+用法:
+- python rf_ota.py tracker.bin
+- python rf_ota.py tracker.bin --apply --timeout 300
+- python rf_ota.py patch.otz --apply        (ota_pack.py 生成的压缩/增量镜像, 广播时间按打包后大小)
+- python rf_ota.py --status
+- python rf_ota.py --stop
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x7690
+
+CMD_STAGE_BEGIN = 0x40
+CMD_STAGE_DATA = 0x41
+CMD_BROADCAST = 0x42
+CMD_STATUS = 0x43
+CMD_APPLY = 0x44
+
+STAGE_CHUNK = 56            # 每个报告的数据字节数 (64 - 命令头 6 - 余量)
+STATUS_ENTRIES = 18
+MAX_TRACKERS = 24
+
+OTA_STATES = ['空闲', '接收', '待校验', '就绪', '错误']
+FLAG_READY = 0x01
+FLAG_VERIFIED = 0x02
+FLAG_ERROR = 0x04
+FLAG_CONNECTED = 0x40
+FLAG_SEEN = 0x80
+CHUNK_NONE = 0xFFFF
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 2.0) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == cmd:
+            return bytes(data)
+    return None
+
+
+def command(device, payload: bytes, timeout_s: float = 2.0) -> bytes:
+    send_command(device, payload)
+    resp = wait_response(device, payload[0], timeout_s)
+    if resp is None:
+        raise SystemExit(f"命令 0x{payload[0]:02X} 无响应 (固件未启用 USE_RF_OTA?)")
+    return resp
+
+
+def result(resp: bytes) -> int:
+    return struct.unpack_from('<b', resp, 1)[0]
+
+#==============================================================================
+# 暂存 / 广播
+#==============================================================================
+
+def stage_image(device, image: bytes):
+    crc = binascii.crc32(image) & 0xFFFFFFFF
+    print(f"暂存镜像: {len(image)} 字节, CRC32 0x{crc:08X}")
+
+    # 分区在写入时按扇区擦除, 每个数据报告都可能包含一次擦除
+    r = result(command(device, struct.pack('<BII', CMD_STAGE_BEGIN, len(image), crc)))
+    if r != 0:
+        raise SystemExit(f"暂存开始失败: {r}")
+
+    for offset in range(0, len(image), STAGE_CHUNK):
+        chunk = image[offset:offset + STAGE_CHUNK]
+        resp = command(device, struct.pack('<BIB', CMD_STAGE_DATA, offset, len(chunk)) + chunk)
+        if result(resp) != 0:
+            raise SystemExit(f"写入失败 @0x{offset:06X}: {result(resp)}")
+        if offset % (STAGE_CHUNK * 64) == 0:
+            print(f"\r  {offset * 100 // len(image):3d}%", end='', flush=True)
+    print("\r  100%")
+
+
+def read_status(device) -> Dict:
+    status = None
+    trackers: List[Dict] = []
+    for first in range(0, MAX_TRACKERS, STATUS_ENTRIES):
+        resp = command(device, bytes([CMD_STATUS, first]))
+        state, session, cursor, chunks, start, n = struct.unpack_from('<BBHHBB', resp, 1)
+        status = {'state': state, 'session': session, 'cursor': cursor, 'chunks': chunks}
+        for k in range(n):
+            flags, base = struct.unpack_from('<BH', resp, 9 + k * 3)
+            trackers.append({'id': start + k, 'flags': flags, 'base': base})
+        if n < STATUS_ENTRIES:
+            break
+    status['trackers'] = trackers
+    return status
+
+
+def print_status(status: Dict):
+    state = OTA_STATES[status['state']] if status['state'] < len(OTA_STATES) else '?'
+    print(f"镜像 {state}, 会话 {status['session'] or '-'}, "
+          f"顺序发送 {status['cursor']}/{status['chunks']}")
+    for t in status['trackers']:
+        f = t['flags']
+        if not f & (FLAG_CONNECTED | FLAG_SEEN):
+            continue
+        if not f & FLAG_SEEN:
+            desc = '等待 LISTEN'
+        elif f & FLAG_ERROR:
+            desc = '错误'
+        elif f & FLAG_VERIFIED:
+            desc = '已校验'
+        elif f & FLAG_READY:
+            done = status['chunks'] if t['base'] == CHUNK_NONE else t['base']
+            desc = f"接收中 {done}/{status['chunks']}"
+        else:
+            desc = '等待镜像信息'
+        print(f"  T{t['id']:02d} {'在线' if f & FLAG_CONNECTED else '离线'} {desc}")
+
+
+def pending_trackers(status: Dict) -> List[int]:
+    return [t['id'] for t in status['trackers']
+            if t['flags'] & FLAG_CONNECTED and not t['flags'] & (FLAG_VERIFIED | FLAG_ERROR)]
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X RF firmware broadcast')
+    parser.add_argument('image', nargs='?', help='tracker 固件 (.bin 或 ota_pack.py 打包镜像)')
+    parser.add_argument('--apply', action='store_true', help='全部在线 tracker 校验通过后写入并重启')
+    parser.add_argument('--timeout', type=float, default=600.0, help='广播超时 (秒, 默认 600)')
+    parser.add_argument('--status', action='store_true', help='只打印当前状态')
+    parser.add_argument('--stop', action='store_true', help='停止广播')
+    args = parser.parse_args()
+
+    device = hid.device()
+    device.open(USB_VID, USB_PID)
+    try:
+        if args.status:
+            print_status(read_status(device))
+            return 0
+        if args.stop:
+            return 0 if result(command(device, bytes([CMD_BROADCAST, 0]))) == 0 else 1
+        if not args.image:
+            parser.error("需要固件文件")
+
+        with open(args.image, 'rb') as f:
+            stage_image(device, f.read())
+
+        resp = command(device, bytes([CMD_BROADCAST, 1]), timeout_s=5.0)
+        if result(resp) != 0:
+            raise SystemExit(f"广播开始失败 (镜像校验未通过?): {result(resp)}")
+        session = resp[2]
+        print(f"广播会话 {session}")
+
+        start = time.time()
+        status = read_status(device)
+        while time.time() - start < args.timeout:
+            time.sleep(1.0)
+            status = read_status(device)
+            print_status(status)
+            if status['trackers'] and not pending_trackers(status) and \
+                    any(t['flags'] & FLAG_SEEN for t in status['trackers']):
+                break
+        else:
+            print(f"超时, 未完成: {pending_trackers(status)}")
+
+        verified = [t['id'] for t in status['trackers'] if t['flags'] & FLAG_VERIFIED]
+        print(f"已校验: {verified}")
+        if args.apply and verified:
+            result(command(device, bytes([CMD_APPLY, session])))
+            print("已下发写入命令, tracker 将重启")
+        command(device, bytes([CMD_BROADCAST, 0]))
+    finally:
+        device.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
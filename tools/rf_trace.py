@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 接收器超帧时序追踪解码 v0.6.3
+Receiver superframe airtime trace decoder
+
+用途:
+- 开启接收器 usb_debug 时序追踪流 (固件需 USE_RF_AIRTIME_TRACE=1)
+- 按帧重组 0xFD 报告, 可选逐时隙写 CSV
+- 结束时输出统计: 信标定时器抖动, 各时隙开始偏移/包到达偏移/中断耗时,
+  时隙利用率和 CRC 失败率, 帧末空闲时间
+
+依赖:
+- pip install hidapi
+
+用法:
+- python rf_trace.py --duration 30 --csv trace.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+from collections import defaultdict
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+TRACE_REPORT_ID = 0xFD
+TRACE_HEADER_SIZE = 12
+TRACE_SLOT_SIZE = 6
+
+CMD_STREAM_START = 0x30
+CMD_STREAM_STOP = 0x31
+STREAM_RF_TRACE = 0x10
+
+F_LAST = 0x01
+F_TRUNCATED = 0x02
+
+OWNER_NONE = 0x1F
+S_RX = 0x20
+S_CRC_OK = 0x40
+S_CRC_BAD = 0x80
+
+SUPERFRAME_US = 5000
+
+#==============================================================================
+# 报告解析
+#==============================================================================
+
+def parse_trace_report(data: bytes) -> Optional[Dict]:
+    """解析一个 0xFD 报告 (格式见 include/rf_airtime_trace.h)"""
+    if len(data) < TRACE_HEADER_SIZE or data[0] != TRACE_REPORT_ID:
+        return None
+
+    frame, base, count, flags, beacon_off, beacon_cb, end_off, dropped = \
+        struct.unpack('<HBBBhBHB', data[1:TRACE_HEADER_SIZE])
+
+    slots = []
+    for i in range(count):
+        off = TRACE_HEADER_SIZE + i * TRACE_SLOT_SIZE
+        if off + TRACE_SLOT_SIZE > len(data):
+            break
+        start, arrival, rx_isr, cb, sflags = struct.unpack('<HBBBB', data[off:off + TRACE_SLOT_SIZE])
+        owner = sflags & 0x1F
+        slots.append({
+            'slot': base + i,
+            'owner': None if owner == OWNER_NONE else owner,
+            'start_us': start,
+            'arrival_us': arrival * 2 if (sflags & S_RX) else None,
+            'rx_isr_us': rx_isr if (sflags & S_RX) else None,
+            'cb_us': cb,
+            'crc': 'ok' if (sflags & S_CRC_OK) else 'bad' if (sflags & S_CRC_BAD) else
+                   ('?' if (sflags & S_RX) else ''),
+        })
+
+    return {
+        'frame': frame,
+        'base': base,
+        'last': bool(flags & F_LAST),
+        'truncated': bool(flags & F_TRUNCATED),
+        'beacon_off_us': beacon_off,
+        'beacon_cb_us': beacon_cb,
+        'end_off_us': end_off,
+        'dropped': dropped,
+        'slots': slots,
+    }
+
+class FrameAssembler:
+    """把同一帧的多个报告合并为一帧"""
+
+    def __init__(self):
+        self.pending: Optional[Dict] = None
+
+    def feed(self, part: Dict) -> Optional[Dict]:
+        if part['base'] == 0 or self.pending is None or self.pending['frame'] != part['frame']:
+            self.pending = dict(part, slots=list(part['slots']))
+        else:
+            self.pending['slots'].extend(part['slots'])
+        if part['last']:
+            frame, self.pending = self.pending, None
+            return frame
+        return None
+
+#==============================================================================
+# 统计
+#==============================================================================
+
+class Series:
+    """简单的min/mean/max/p99 统计"""
+
+    def __init__(self):
+        self.values: List[int] = []
+
+    def add(self, v: Optional[int]):
+        if v is not None:
+            self.values.append(v)
+
+    def summary(self) -> str:
+        if not self.values:
+            return "-"
+        v = sorted(self.values)
+        p99 = v[min(len(v) - 1, int(len(v) * 0.99))]
+        return f"{v[0]}/{sum(v) / len(v):.1f}/{p99}/{v[-1]}"
+
+class TraceStats:
+    def __init__(self):
+        self.frames = 0
+        self.dropped = 0
+        self.truncated = 0
+        self.frame_gaps = 0
+        self.last_frame = None
+        self.beacon_off = Series()
+        self.beacon_cb = Series()
+        self.idle_us = Series()
+        self.slot_start = defaultdict(Series)
+        self.slot_arrival = defaultdict(Series)
+        self.slot_isr = defaultdict(Series)
+        self.slot_cb = defaultdict(Series)
+        self.slot_owned = defaultdict(int)
+        self.slot_rx = defaultdict(int)
+        self.slot_crc_bad = defaultdict(int)
+
+    def add(self, f: Dict):
+        self.frames += 1
+        self.dropped += f['dropped']
+        self.truncated += f['truncated']
+        if self.last_frame is not None:
+            gap = (f['frame'] - self.last_frame) & 0xFFFF
+            if gap != 1:
+                self.frame_gaps += 1
+        self.last_frame = f['frame']
+
+        self.beacon_off.add(f['beacon_off_us'])
+        self.beacon_cb.add(f['beacon_cb_us'])
+        self.idle_us.add(SUPERFRAME_US - f['end_off_us'])
+
+        for s in f['slots']:
+            i = s['slot']
+            self.slot_start[i].add(s['start_us'])
+            self.slot_cb[i].add(s['cb_us'])
+            if s['owner'] is not None:
+                self.slot_owned[i] += 1
+            if s['arrival_us'] is not None:
+                self.slot_rx[i] += 1
+                self.slot_arrival[i].add(s['arrival_us'])
+                self.slot_isr[i].add(s['rx_isr_us'])
+                if s['crc'] == 'bad':
+                    self.slot_crc_bad[i] += 1
+
+    def report(self):
+        print(f"\n帧数 {self.frames}, 固件丢弃 {self.dropped}, 帧号不连续 {self.frame_gaps}, "
+              f"时隙截断 {self.truncated}")
+        print("单位 us, 统计值为 min/mean/p99/max")
+        print(f"信标唤醒偏移  {self.beacon_off.summary()}")
+        print(f"信标回调耗时  {self.beacon_cb.summary()}")
+        print(f"帧末空闲      {self.idle_us.summary()}")
+        print()
+        print(f"{'时隙':>4} {'开始偏移':>22} {'到达偏移':>18} {'RF中断':>14} "
+              f"{'回调':>14} {'利用率':>7} {'CRC失败':>7}")
+        for i in sorted(self.slot_start):
+            owned = self.slot_owned[i]
+            util = f"{100.0 * self.slot_rx[i] / owned:.1f}%" if owned else "-"
+            bad = f"{100.0 * self.slot_crc_bad[i] / self.slot_rx[i]:.2f}%" if self.slot_rx[i] else "-"
+            print(f"{i:>4} {self.slot_start[i].summary():>22} {self.slot_arrival[i].summary():>18} "
+                  f"{self.slot_isr[i].summary():>14} {self.slot_cb[i].summary():>14} "
+                  f"{util:>7} {bad:>7}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 接收器不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X receiver airtime trace decoder')
+    parser.add_argument('--duration', type=float, default=10.0, help='采集时长 (秒, 默认 10)')
+    parser.add_argument('--csv', type=str, help='逐时隙 CSV 输出文件')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开接收器: {e}")
+        return 1
+
+    writer = None
+    csv_file = None
+    if args.csv:
+        csv_file = open(args.csv, 'w', newline='')
+        writer = csv.writer(csv_file)
+        writer.writerow(['frame', 'beacon_off_us', 'beacon_cb_us', 'end_off_us', 'slot', 'owner',
+                         'start_us', 'arrival_us', 'rx_isr_us', 'cb_us', 'crc'])
+
+    assembler = FrameAssembler()
+    stats = TraceStats()
+
+    send_command(device, bytes([CMD_STREAM_START, STREAM_RF_TRACE]))
+    print(f"采集 {args.duration:.0f} 秒...")
+    deadline = time.time() + args.duration
+    try:
+        while time.time() < deadline:
+            data = device.read(64, timeout_ms=10)
+            if not data:
+                continue
+            part = parse_trace_report(bytes(data))
+            if not part:
+                continue
+            frame = assembler.feed(part)
+            if not frame:
+                continue
+            stats.add(frame)
+            if writer:
+                for s in frame['slots']:
+                    writer.writerow([frame['frame'], frame['beacon_off_us'], frame['beacon_cb_us'],
+                                     frame['end_off_us'], s['slot'],
+                                     '' if s['owner'] is None else s['owner'], s['start_us'],
+                                     '' if s['arrival_us'] is None else s['arrival_us'],
+                                     '' if s['rx_isr_us'] is None else s['rx_isr_us'],
+                                     s['cb_us'], s['crc']])
+    except KeyboardInterrupt:
+        pass
+    finally:
+        send_command(device, bytes([CMD_STREAM_STOP]))
+        device.close()
+        if csv_file:
+            csv_file.close()
+
+    stats.report()
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 器件特性测量 v0.6.3
+On-device characterization suite over USB
+
+用途:
+- 经 0x1B 命令启动 tracker 上的测量 (固件需 USE_SELFTEST=1), tracker 静置放好
+- 测量期间追踪照常运行, 结束后读取陀螺 Allan 偏差曲线、实际 ODR 和各环节耗时
+- 由 Allan 偏差计算噪声密度、角度随机游走和零偏不稳定性, 用于选择滤波参数和 ODR
+
+依赖:
+- pip install hidapi
+
+用法:
+- python selftest.py                      (默认时长, 不固定功耗档)
+- python selftest.py --duration 1800 --profile high
+- python selftest.py --status             (只读取上次结果, 不重新开始)
+- python selftest.py --json > selftest.json
+"""
+
+import argparse
+import json
+import math
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_SELFTEST = 0x1B
+SUB_STATUS = 0x00
+SUB_START = 0x01
+SUB_STOP = 0x02
+SUB_TIMING = 0x10
+SUB_ADEV = 0x20
+SUB_INVALID = 0xFF
+
+STATE_NAMES = ['idle', 'running', 'done']
+IMU_NAMES = ['unknown', 'MPU6050', 'BMI160', 'BMI270', 'ICM42688', 'ICM45686', 'LSM6DSV', 'LSM6DSR']
+PROFILES = {'any': 0xFF, 'high': 0, 'normal': 1, 'low': 2}
+TIMER_NAMES = ['imu_read', 'fusion', 'rf_rtt']
+
+STATUS_FMT = '<BBHHHIIfffB'
+TIMING_FMT = '<IIIII'
+ADEV_FMT = '<Iffff'
+
+# 静置判定: 最大角速度超过此值时提示结果不可信
+STILL_MAX_DPS = 5.0
+# 零偏不稳定性: ADEV 最小值 / sqrt(2 ln2 / pi)
+BIAS_INSTABILITY_FACTOR = 0.664
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def request(device, sub: int, args: bytes = b'') -> bytes:
+    send_command(device, bytes([CMD_SELFTEST, sub]) + args)
+    resp = wait_response(device, CMD_SELFTEST)
+    if not resp:
+        raise SystemExit("无响应 (固件未启用 USE_SELFTEST?)")
+    if resp[1] == SUB_INVALID:
+        raise SystemExit(f"子命令 0x{sub:02X} 被拒绝")
+    return resp[2:]
+
+
+def parse_status(data: bytes) -> Dict:
+    (state, imu_type, odr_hz, range_dps, duration_s, samples, elapsed_us,
+     max_rate, temp_start, temp_end, levels) = struct.unpack_from(STATUS_FMT, data)
+    return {
+        'state': STATE_NAMES[state] if state < len(STATE_NAMES) else str(state),
+        'imu': IMU_NAMES[imu_type] if imu_type < len(IMU_NAMES) else str(imu_type),
+        'odr_hz': odr_hz,
+        'gyro_range_dps': range_dps,
+        'duration_s': duration_s,
+        'samples': samples,
+        'elapsed_s': elapsed_us / 1e6,
+        'max_rate_dps': max_rate,
+        'temp_start_c': temp_start,
+        'temp_end_c': temp_end,
+        'adev_levels': levels,
+    }
+
+
+def read_timing(device) -> Dict:
+    timing = {}
+    for i, name in enumerate(TIMER_NAMES):
+        count, items, min_us, max_us, total_us = struct.unpack_from(TIMING_FMT, request(device, SUB_TIMING + i))
+        timing[name] = {
+            'count': count,
+            'items': items,
+            'min_us': min_us,
+            'max_us': max_us,
+            'avg_us': total_us / count if count else 0.0,
+            'avg_us_per_item': total_us / items if items else 0.0,
+        }
+    return timing
+
+
+def read_adev(device, levels: int) -> List[Dict]:
+    curve = []
+    for k in range(levels):
+        clusters, tau, ax, ay, az = struct.unpack_from(ADEV_FMT, request(device, SUB_ADEV + k))
+        curve.append({'tau_s': tau, 'clusters': clusters, 'adev_dps': [ax, ay, az]})
+    return curve
+
+#==============================================================================
+# 分析
+#==============================================================================
+
+def analyze(status: Dict, curve: List[Dict]) -> Dict:
+    result = {}
+
+    if status['elapsed_s'] > 0 and status['samples'] > 1 and status['odr_hz']:
+        odr = (status['samples'] - 1) / status['elapsed_s']
+        result['odr_measured_hz'] = odr
+        result['odr_error_ppm'] = (odr / status['odr_hz'] - 1.0) * 1e6
+
+    if not curve or not status['odr_hz']:
+        return result
+
+    # 噪声密度: 单样本 ADEV 对应带宽 ODR/2
+    result['noise_density_mdps_rthz'] = [
+        a * math.sqrt(2.0 / status['odr_hz']) * 1000.0 for a in curve[0]['adev_dps']]
+
+    # 角度随机游走: 白噪声段 ADEV·sqrt(τ), 取最接近 1 s 的一档
+    arw = min(curve, key=lambda c: abs(math.log(c['tau_s'])) if c['tau_s'] > 0 else 1e9)
+    result['arw_tau_s'] = arw['tau_s']
+    result['arw_dps_rthz'] = [a * math.sqrt(arw['tau_s']) for a in arw['adev_dps']]
+    result['arw_deg_rthr'] = [v * 60.0 for v in result['arw_dps_rthz']]
+
+    # 零偏不稳定性: 每轴 ADEV 曲线最小值 (簇数太少的档不参与)
+    usable = [c for c in curve if c['clusters'] >= 8] or curve
+    result['bias_instability_dph'] = []
+    result['bias_instability_tau_s'] = []
+    for axis in range(3):
+        best = min(usable, key=lambda c: c['adev_dps'][axis])
+        result['bias_instability_dph'].append(best['adev_dps'][axis] / BIAS_INSTABILITY_FACTOR * 3600.0)
+        result['bias_instability_tau_s'].append(best['tau_s'])
+    return result
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def print_report(status: Dict, timing: Dict, curve: List[Dict], result: Dict):
+    print(f"IMU: {status['imu']}  ODR: {status['odr_hz']} Hz  量程: ±{status['gyro_range_dps']} dps")
+    print(f"状态: {status['state']}  样本: {status['samples']}  时长: {status['elapsed_s']:.1f}/{status['duration_s']} s")
+    print(f"温度: {status['temp_start_c']:.1f} → {status['temp_end_c']:.1f} °C")
+    if status['max_rate_dps'] > STILL_MAX_DPS:
+        print(f"警告: 期间最大角速度 {status['max_rate_dps']:.1f} dps, tracker 未静置, 结果不可信")
+
+    if 'odr_measured_hz' in result:
+        print(f"\n实际 ODR: {result['odr_measured_hz']:.3f} Hz ({result['odr_error_ppm']:+.0f} ppm, 相对 MCU 时钟)")
+
+    if curve:
+        print(f"\n{'τ (s)':>10} {'簇差分':>9} {'X (dps)':>11} {'Y (dps)':>11} {'Z (dps)':>11}")
+        for c in curve:
+            ax, ay, az = c['adev_dps']
+            print(f"{c['tau_s']:>10.4f} {c['clusters']:>9} {ax:>11.5f} {ay:>11.5f} {az:>11.5f}")
+
+    if 'noise_density_mdps_rthz' in result:
+        nd = result['noise_density_mdps_rthz']
+        arw = result['arw_deg_rthr']
+        bi = result['bias_instability_dph']
+        print(f"\n噪声密度 (mdps/√Hz): {nd[0]:.2f} {nd[1]:.2f} {nd[2]:.2f}")
+        print(f"角度随机游走 (°/√h, τ={result['arw_tau_s']:.3f} s): {arw[0]:.3f} {arw[1]:.3f} {arw[2]:.3f}")
+        print("零偏不稳定性 (°/h): " + ' '.join(
+            f"{v:.2f}@{t:.1f}s" for v, t in zip(bi, result['bias_instability_tau_s'])))
+
+    print(f"\n{'耗时':<10} {'次数':>8} {'平均 us':>9} {'每项 us':>9} {'最小':>7} {'最大':>7}")
+    for name, t in timing.items():
+        if not t['count']:
+            print(f"{name:<10} {'-':>8}")
+            continue
+        print(f"{name:<10} {t['count']:>8} {t['avg_us']:>9.1f} {t['avg_us_per_item']:>9.1f} "
+              f"{t['min_us']:>7} {t['max_us']:>7}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X on-device characterization')
+    parser.add_argument('--duration', type=int, default=0, help='测量时长 s (0 = 固件默认)')
+    parser.add_argument('--profile', choices=PROFILES.keys(), default='any', help='测量期间固定的 IMU 功耗档')
+    parser.add_argument('--status', action='store_true', help='只读取当前/上次结果')
+    parser.add_argument('--stop', action='store_true', help='提前结束当前测量并读取结果')
+    parser.add_argument('--json', action='store_true', help='输出 JSON')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        if args.stop:
+            status = parse_status(request(device, SUB_STOP))
+        elif args.status:
+            status = parse_status(request(device, SUB_STATUS))
+        else:
+            start = struct.pack('<HB', args.duration, PROFILES[args.profile])
+            status = parse_status(request(device, SUB_START, start))
+            print(f"测量开始 ({status['duration_s']} s), 请保持 tracker 静置...", file=sys.stderr)
+            while status['state'] == 'running':
+                time.sleep(2.0)
+                status = parse_status(request(device, SUB_STATUS))
+                print(f"\r  {status['elapsed_s']:.0f}/{status['duration_s']} s  "
+                      f"{status['samples']} 样本", end='', file=sys.stderr)
+            print(file=sys.stderr)
+
+        timing = read_timing(device)
+        curve = read_adev(device, status['adev_levels'])
+    except KeyboardInterrupt:
+        request(device, SUB_STOP)
+        print("\n已中止", file=sys.stderr)
+        return 1
+    finally:
+        device.close()
+
+    result = analyze(status, curve)
+    if args.json:
+        print(json.dumps({'status': status, 'timing': timing, 'adev': curve, 'result': result},
+                         indent=2, ensure_ascii=False))
+    else:
+        print_report(status, timing, curve, result)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
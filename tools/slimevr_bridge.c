@@ -0,0 +1,445 @@
+/**
+ * @file slimevr_bridge.c
+ * @brief SlimeVR USB-UDP Bridge for CH592 Receiver (native)
+ *
+ * v0.6.3: tools/slimevr_bridge.py 的编译版本, 协议和报告解析与 Python 版相同:
+ * - 阻塞读取 HID 报告 (hid_read_timeout), 不轮询休眠
+ * - 一个 HID 报告内的所有 tracker 姿态合并为一个 PKT_BUNDLE 数据报
+ *   (--no-bundle 退回每 tracker 一个 PKT_ROTATION_DATA, 同 Python 版)
+ * - 心跳在读取间隙按时间发送, 不用线程
+ * - 所有缓冲区静态分配, 运行中无 malloc
+ *
+ * 支持 Report 0x02 (帧对齐), 0x03 (bundle), 其余报告按 RF Ultra 12 字节包解析;
+ * 分集模式 (Report 0x04, 双接收器) 仍使用 Python 版
+ *
+ * 编译: make bridge  (需要 hidapi, Linux 默认 hidapi-hidraw, Windows 链接 -lhidapi -lws2_32)
+ * 用法: build/host/slimevr_bridge [--host 127.0.0.1] [--port 6969] [--no-bundle] [--debug]
+ */
+
+#include <hidapi/hidapi.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET sock_t;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int sock_t;
+#endif
+
+/*============================================================================
+ * 配置 / Configuration
+ *============================================================================*/
+
+#define USB_VID             0x1209
+#define USB_PID             0x5634      // 与 slimevr_bridge.py 相同
+
+#define SLIMEVR_HOST        "127.0.0.1"
+#define SLIMEVR_PORT        6969
+
+// SlimeVR 协议
+#define PKT_HEARTBEAT       0
+#define PKT_HANDSHAKE       3
+#define PKT_BATTERY         12
+#define PKT_ROTATION_DATA   17
+#define PKT_BUNDLE          100
+
+#define MAX_TRACKERS        64          // RF Ultra 头部 6 位 ID
+#define UDP_MAX             1400        // bundle 数据报上限, 低于常见 MTU
+#define READ_TIMEOUT_MS     100
+#define HEARTBEAT_MS        1000
+#define BATTERY_MS          5000
+
+// 接收器报告
+#define REPORT_ID_FRAME     0x02
+#define FRAME_ENTRY_SIZE    12
+#define FRAME_STALE_FLAG    0x80
+#define REPORT_ID_BUNDLE    0x03
+#define BUNDLE_BLOCK        12
+#define BUNDLE_ENTRY_SIZE   5
+#define BUNDLE_Q14_MAX      11585
+#define BUNDLE_C12_MAX      2047
+
+/*============================================================================
+ * 状态
+ *============================================================================*/
+
+typedef struct {
+    bool connected;             // 已发送握手
+    int battery;                // -1 = 未知
+    uint64_t last_battery_ms;
+} bridge_tracker_t;
+
+static bridge_tracker_t trackers[MAX_TRACKERS];
+static uint64_t packet_id = 0;
+static sock_t udp_sock;
+static struct sockaddr_in server_addr;
+static bool use_bundle = true;
+static bool debug = false;
+
+static uint8_t bundle_buf[UDP_MAX];
+static size_t bundle_len = 0;
+static unsigned bundle_count = 0;
+
+static uint64_t stat_reports = 0;
+static uint64_t stat_datagrams = 0;
+static uint64_t stat_rotations = 0;
+
+/*============================================================================
+ * 工具函数
+ *============================================================================*/
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+// 字节序与 slimevr_bridge.py 的 struct.pack('<...') 一致
+static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+    return p + 4;
+}
+
+static inline uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+    return p + 8;
+}
+
+static inline uint8_t *put_f32(uint8_t *p, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return put_u32(p, v);
+}
+
+static inline int16_t get_i16(const uint8_t *p)
+{
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static void send_datagram(const uint8_t *data, size_t len)
+{
+    if (sendto(udp_sock, (const char *)data, (int)len, 0,
+               (const struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+        fprintf(stderr, "[ERROR] UDP 发送失败\n");
+        return;
+    }
+    stat_datagrams++;
+}
+
+/*============================================================================
+ * SlimeVR 协议构建 (负载不含类型和包序号, 由调用方决定单独发送还是放进 bundle)
+ *============================================================================*/
+
+static size_t build_rotation(uint8_t *p, uint8_t tracker_id, const float q[4])
+{
+    uint8_t *s = p;
+    *p++ = tracker_id;          // Sensor ID
+    *p++ = 1;                   // Data type (1 = normal rotation)
+    for (int i = 0; i < 4; i++) p = put_f32(p, q[i]);   // w, x, y, z
+    *p++ = 1;                   // Accuracy indicator
+    return (size_t)(p - s);
+}
+
+static size_t build_battery(uint8_t *p, int battery_pct)
+{
+    uint8_t *s = p;
+    p = put_f32(p, 3.3f + (battery_pct / 100.0f) * 0.9f);  // 3.3V - 4.2V 估算
+    p = put_f32(p, battery_pct / 100.0f);
+    return (size_t)(p - s);
+}
+
+static void send_packet(uint32_t type, const uint8_t *payload, size_t len)
+{
+    uint8_t buf[64];
+    uint8_t *p = put_u32(buf, type);
+    p = put_u64(p, packet_id++);
+    if (len) memcpy(p, payload, len);
+    send_datagram(buf, (size_t)(p - buf) + len);
+}
+
+static void send_handshake(uint8_t tracker_id)
+{
+    uint8_t payload[64];
+    uint8_t *p = payload;
+    p = put_u32(p, 100);        // Board type (custom)
+    p = put_u32(p, 3);          // IMU type (ICM42688)
+    p = put_u32(p, 100);        // MCU type (custom)
+    for (int i = 0; i < 3; i++) p = put_u32(p, 0);      // IMU info
+    p = put_u32(p, 1);          // Firmware major
+    p = put_u32(p, 0);          // Firmware minor
+    p = put_u32(p, 0);          // Firmware patch
+    p = put_u32(p, 1);          // Firmware build
+    const uint8_t mac[6] = {0x01, 0x02, 0x03, 0x04, 0x05, tracker_id};
+    memcpy(p, mac, sizeof(mac));
+    p += sizeof(mac);
+    send_packet(PKT_HANDSHAKE, payload, (size_t)(p - payload));
+}
+
+/*============================================================================
+ * Bundle: [PKT_BUNDLE][包序号] + 每个子包 [长度 u16][类型 u32][负载]
+ *============================================================================*/
+
+static void bundle_flush(void)
+{
+    if (bundle_count > 0) send_datagram(bundle_buf, bundle_len);
+    bundle_len = 0;
+    bundle_count = 0;
+}
+
+static void bundle_add(uint32_t type, const uint8_t *payload, size_t len)
+{
+    if (!use_bundle) {
+        send_packet(type, payload, len);
+        return;
+    }
+    if (bundle_len + 2 + 4 + len > sizeof(bundle_buf)) bundle_flush();
+    if (bundle_len == 0) {
+        uint8_t *p = put_u32(bundle_buf, PKT_BUNDLE);
+        p = put_u64(p, packet_id++);
+        bundle_len = (size_t)(p - bundle_buf);
+    }
+    uint8_t *p = put_u16(&bundle_buf[bundle_len], (uint16_t)(4 + len));
+    p = put_u32(p, type);
+    memcpy(p, payload, len);
+    bundle_len += 2 + 4 + len;
+    bundle_count++;
+}
+
+/*============================================================================
+ * 追踪器数据
+ *============================================================================*/
+
+static void handle_rotation(uint8_t tracker_id, const float q[4], int battery, uint64_t now)
+{
+    if (tracker_id >= MAX_TRACKERS) return;
+    bridge_tracker_t *t = &trackers[tracker_id];
+
+    // 新追踪器先单独发送握手 (服务端需在数据之前收到)
+    if (!t->connected) {
+        printf("[INFO] 新追踪器连接: #%u\n", tracker_id);
+        send_handshake(tracker_id);
+        t->connected = true;
+        t->last_battery_ms = 0;
+    }
+
+    uint8_t payload[32];
+    bundle_add(PKT_ROTATION_DATA, payload, build_rotation(payload, tracker_id, q));
+    stat_rotations++;
+    if (debug) {
+        printf("[DEBUG] 追踪器 #%u: q=[%.4f, %.4f, %.4f, %.4f]\n",
+               tracker_id, q[0], q[1], q[2], q[3]);
+    }
+
+    // 定期发送电池状态 (帧对齐报告不含电量, bundle 电量来自状态旁路)
+    if (battery < 0) battery = t->battery;
+    if (battery >= 0 && now - t->last_battery_ms > BATTERY_MS) {
+        bundle_add(PKT_BATTERY, payload, build_battery(payload, battery));
+        t->last_battery_ms = now;
+    }
+}
+
+/*============================================================================
+ * 报告解析 (格式见 slimevr_bridge.py)
+ *============================================================================*/
+
+static void parse_frame_report(const uint8_t *d, int len, uint64_t now)
+{
+    uint8_t count = d[1];
+    for (uint8_t i = 0; i < count; i++) {
+        int off = 4 + i * FRAME_ENTRY_SIZE;
+        if (off + FRAME_ENTRY_SIZE > len) break;
+        const uint8_t *e = &d[off];
+        if (e[0] & FRAME_STALE_FLAG) continue;
+        float q[4];
+        for (int c = 0; c < 4; c++) q[c] = get_i16(&e[2 + c * 2]) / 32768.0f;
+        handle_rotation(e[0] & 0x7F, q, -1, now);
+    }
+}
+
+static void unpack_quat40(const uint8_t *e, float q[4])
+{
+    uint64_t bits = (uint64_t)e[0] | ((uint64_t)e[1] << 8) | ((uint64_t)e[2] << 16) |
+                    ((uint64_t)e[3] << 24) | ((uint64_t)(e[4] & 0x3F) << 32);
+    unsigned dropped = (unsigned)(bits & 0x03);
+    float comps[3];
+    float sum = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        int v = (int)((bits >> (2 + 12 * i)) & 0xFFF);
+        if (v & 0x800) v -= 0x1000;
+        comps[i] = v * (float)BUNDLE_Q14_MAX / BUNDLE_C12_MAX / 16384.0f;
+        sum += comps[i] * comps[i];
+    }
+    float big = sqrtf(sum < 1.0f ? 1.0f - sum : 0.0f);
+    for (unsigned i = 0, j = 0; i < 4; i++) {
+        q[i] = (i == dropped) ? big : comps[j++];
+    }
+}
+
+static void parse_bundle_report(const uint8_t *d, int len, uint64_t now)
+{
+    uint16_t mask = (uint16_t)(d[2] | (d[3] << 8));
+    unsigned base = (mask >> 12) * BUNDLE_BLOCK;
+    int off = 4;
+
+    // 先取状态旁路里的电量, 同一报告内的姿态即可带上
+    int status_off = off;
+    for (int i = 0; i < BUNDLE_BLOCK; i++) {
+        if (mask & (1u << i)) status_off += BUNDLE_ENTRY_SIZE;
+    }
+    for (int s = status_off; s + 4 <= len && (d[s] & 0x80); s += 4) {
+        unsigned id = d[s] & 0x7F;
+        if (id < MAX_TRACKERS) trackers[id].battery = d[s + 2];
+    }
+
+    for (int i = 0; i < BUNDLE_BLOCK; i++) {
+        if (!(mask & (1u << i))) continue;
+        if (off + BUNDLE_ENTRY_SIZE > len) break;
+        const uint8_t *e = &d[off];
+        off += BUNDLE_ENTRY_SIZE;
+        if (e[4] & 0x40) continue;          // 本帧无新样本
+        float q[4];
+        unpack_quat40(e, q);
+        handle_rotation((uint8_t)(base + i), q, -1, now);
+    }
+}
+
+static void parse_rf_ultra_packet(const uint8_t *d, int len, uint64_t now)
+{
+    if (len < 12) return;
+    uint8_t type = (d[0] >> 6) & 0x03;
+    if (type != 0) return;                  // 只处理四元数数据
+
+    float q[4];
+    for (int c = 0; c < 4; c++) q[c] = get_i16(&d[1 + c * 2]) / 32768.0f;
+    uint16_t aux = (uint16_t)(d[9] | (d[10] << 8));
+    int battery = ((aux >> 12) & 0x0F) * 100 / 15;
+    handle_rotation(d[0] & 0x3F, q, battery, now);
+}
+
+static void handle_report(const uint8_t *d, int len, uint64_t now)
+{
+    stat_reports++;
+    if (d[0] == REPORT_ID_BUNDLE && len >= 4) {
+        parse_bundle_report(d, len, now);
+    } else if (d[0] == REPORT_ID_FRAME && len >= 4) {
+        parse_frame_report(d, len, now);
+    } else {
+        parse_rf_ultra_packet(d, len, now);
+    }
+    bundle_flush();                         // 每个 HID 报告最多一个数据报
+}
+
+/*============================================================================
+ * 主程序
+ *============================================================================*/
+
+static void usage(const char *prog)
+{
+    printf("用法: %s [--host ADDR] [--port N] [--no-bundle] [--debug]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *host = SLIMEVR_HOST;
+    int port = SLIMEVR_PORT;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--host") && i + 1 < argc) {
+            host = argv[++i];
+        } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--no-bundle")) {
+            use_bundle = false;
+        } else if (!strcmp(argv[i], "--debug") || !strcmp(argv[i], "-d")) {
+            debug = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+    udp_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "[ERROR] 无效地址: %s\n", host);
+        return 1;
+    }
+
+    for (int i = 0; i < MAX_TRACKERS; i++) trackers[i].battery = -1;
+
+    if (hid_init() != 0) {
+        fprintf(stderr, "[ERROR] hidapi 初始化失败\n");
+        return 1;
+    }
+    hid_device *dev = hid_open(USB_VID, USB_PID, NULL);
+    if (!dev) {
+        fprintf(stderr, "[ERROR] 未找到 SlimeVR CH592 接收器 (VID/PID %04x/%04x)\n",
+                USB_VID, USB_PID);
+        hid_exit();
+        return 1;
+    }
+
+    printf("[INFO] 桥接运行中... (服务端: %s:%d, %s)\n", host, port,
+           use_bundle ? "bundle" : "逐 tracker 数据报");
+
+    uint8_t report[64];
+    uint64_t last_heartbeat = 0;
+    for (;;) {
+        int n = hid_read_timeout(dev, report, sizeof(report), READ_TIMEOUT_MS);
+        if (n < 0) {
+            fprintf(stderr, "[ERROR] 读取错误, 退出\n");
+            break;
+        }
+        uint64_t now = now_ms();
+        if (n > 0) handle_report(report, n, now);
+
+        // 心跳: 读取超时最长 READ_TIMEOUT_MS, 误差不超过这个量
+        if (now - last_heartbeat >= HEARTBEAT_MS) {
+            send_packet(PKT_HEARTBEAT, NULL, 0);
+            last_heartbeat = now;
+            if (debug) {
+                printf("[DEBUG] 报告 %llu, 姿态 %llu, 数据报 %llu\n",
+                       (unsigned long long)stat_reports, (unsigned long long)stat_rotations,
+                       (unsigned long long)stat_datagrams);
+            }
+        }
+    }
+
+    hid_close(dev);
+    hid_exit();
+#ifdef _WIN32
+    closesocket(udp_sock);
+    WSACleanup();
+#else
+    close(udp_sock);
+#endif
+    return 0;
+}
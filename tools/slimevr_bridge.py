@@ -4,22 +4,26 @@ SlimeVR USB-UDP Bridge for CH592 Receiver
 CH592 接收器到 SlimeVR 服务端的桥接程序
 
 Usage:
-    python slimevr_bridge.py [--debug]
+    python slimevr_bridge.py [--debug] [--diversity | --roaming]
 
 Requirements:
     pip install hidapi
 
+低配主机可用编译版本 tools/slimevr_bridge.c (make bridge), 协议相同,
+姿态按 HID 报告合并为 PKT_BUNDLE; 分集/漫游模式仅本脚本支持
+
 Author: NiNi
 Version: 1.0.0
 """
 
 import argparse
+import math
 import struct
 import socket
 import time
 import sys
 import threading
-from typing import Optional, Dict, List
+from typing import Optional, Dict, List, Tuple
 
 try:
     import hid
@@ -134,6 +138,285 @@ def parse_rf_ultra_packet(data: bytes) -> Optional[Dict]:
     
     return None
 
+REPORT_ID_FRAME = 0x02         # v0.6.3: 帧对齐时间戳报告
+FRAME_ENTRY_SIZE = 12
+FRAME_STALE_FLAG = 0x80
+
+def parse_frame_report(data: bytes) -> List[Dict]:
+    """
+    解析接收器帧对齐报告 (Report 0x02, 64 bytes)
+    
+    格式:
+        [0]     0x02
+        [1]     条目数
+        [2-3]   RF 帧号 (LE)
+        [4..]   每条目 12 字节: id(bit7=重复样本), status, w,x,y,z int16, 帧内时间 int16 us
+    """
+    if len(data) < 4 or data[0] != REPORT_ID_FRAME:
+        return []
+    
+    count = data[1]
+    frame = struct.unpack('<H', bytes(data[2:4]))[0]
+    out = []
+    for i in range(count):
+        off = 4 + i * FRAME_ENTRY_SIZE
+        if off + FRAME_ENTRY_SIZE > len(data):
+            break
+        e = bytes(data[off:off + FRAME_ENTRY_SIZE])
+        qw, qx, qy, qz, t_us = struct.unpack('<hhhhh', e[2:12])
+        out.append({
+            'type': 'rotation',
+            'tracker_id': e[0] & 0x7F,
+            'stale': bool(e[0] & FRAME_STALE_FLAG),
+            'quaternion': [qw / 32768.0, qx / 32768.0, qy / 32768.0, qz / 32768.0],
+            'frame': frame,
+            'frame_offset_us': t_us,
+        })
+    return out
+
+REPORT_ID_BUNDLE = 0x03        # v0.6.3: 全 tracker bundle 报告
+BUNDLE_BLOCK = 12
+BUNDLE_ENTRY_SIZE = 5
+BUNDLE_Q14_MAX = 11585
+BUNDLE_C12_MAX = 2047
+
+def _unpack_quat40(e: bytes) -> List[float]:
+    """40-bit smallest-three -> [w, x, y, z]"""
+    bits = int.from_bytes(e[:4], 'little') | ((e[4] & 0x3F) << 32)
+    dropped = bits & 0x03
+    comps = []
+    for i in range(3):
+        v = (bits >> (2 + 12 * i)) & 0xFFF
+        if v & 0x800:
+            v -= 0x1000
+        comps.append(v * BUNDLE_Q14_MAX / BUNDLE_C12_MAX / 16384.0)
+    big = math.sqrt(max(0.0, 1.0 - sum(c * c for c in comps)))
+    comps.insert(dropped, big)
+    return comps
+
+def parse_bundle_report(data: bytes) -> List[Dict]:
+    """
+    解析接收器 bundle 报告 (Report 0x03, 64 bytes)
+    
+    格式:
+        [0]     0x03
+        [1]     帧号低 8 位
+        [2-3]   bit0-11 存在位图, bit12-15 块号 (LE)
+        [4..]   每个存在的 tracker 5 字节 40-bit smallest-three (byte4 bit6 = 重复样本)
+        [..]    状态旁路 4 字节: 0x80|id, status, battery, rssi+100 (bit7=0 结束)
+    """
+    if len(data) < 4 or data[0] != REPORT_ID_BUNDLE:
+        return []
+    
+    mask = data[2] | (data[3] << 8)
+    base = (mask >> 12) * BUNDLE_BLOCK
+    out = []
+    off = 4
+    for i in range(BUNDLE_BLOCK):
+        if not mask & (1 << i):
+            continue
+        if off + BUNDLE_ENTRY_SIZE > len(data):
+            break
+        e = bytes(data[off:off + BUNDLE_ENTRY_SIZE])
+        out.append({
+            'type': 'rotation',
+            'tracker_id': base + i,
+            'stale': bool(e[4] & 0x40),
+            'quaternion': _unpack_quat40(e),
+            'frame': data[1],
+        })
+        off += BUNDLE_ENTRY_SIZE
+    
+    while off + 4 <= len(data) and data[off] & 0x80:
+        out.append({
+            'type': 'status',
+            'tracker_id': data[off] & 0x7F,
+            'status': data[off + 1],
+            'battery': data[off + 2],
+            'rssi': data[off + 3] - 100,
+        })
+        off += 4
+    return out
+
+REPORT_ID_FORWARD = 0x04      # v0.6.3: 分集转发报告
+FORWARD_ENTRY_SIZE = 13
+FORWARD_NO_SEQ_FLAG = 0x80
+
+CMD_FORWARD_ENABLE = 0x15
+CMD_SET_ROLE = 0x16
+CMD_GET_NETWORK = 0x21
+CMD_SET_ROAM_CELL = 0x26       # v0.6.3: 漫游组 (USE_RF_ROAMING)
+CMD_GET_PAIRING = 0x27
+CMD_SET_PAIRING = 0x28
+PAIRING_MAX_ENTRIES = 64       # 读取配对表的上限 (应答 ID 0xFF 即结束)
+
+def parse_forward_report(data: bytes) -> List[Dict]:
+    """
+    解析分集转发报告 (Report 0x04, 64 bytes)
+    
+    格式:
+        [0]     0x04
+        [1]     条目数
+        [2..]   每条目 13 字节: id(bit7=无序列号), seq, rssi+128, 帧号 uint16, w,x,y,z int16
+    """
+    if len(data) < 2 or data[0] != REPORT_ID_FORWARD:
+        return []
+    
+    out = []
+    for i in range(data[1]):
+        off = 2 + i * FORWARD_ENTRY_SIZE
+        if off + FORWARD_ENTRY_SIZE > len(data):
+            break
+        e = bytes(data[off:off + FORWARD_ENTRY_SIZE])
+        frame, qw, qx, qy, qz = struct.unpack('<Hhhhh', e[3:13])
+        out.append({
+            'type': 'rotation',
+            'tracker_id': e[0] & 0x7F,
+            'has_sequence': not (e[0] & FORWARD_NO_SEQ_FLAG),
+            'sequence': e[1],
+            'rssi': e[2] - 128,
+            'frame': frame,
+            'quaternion': [qw / 32768.0, qx / 32768.0, qy / 32768.0, qz / 32768.0],
+        })
+    return out
+
+REPORT_ID_AUX = 0x05          # v0.6.3: 辅助 IMU 姿态报告
+AUX_ENTRY_SIZE = 9
+AUX_SENSOR_BASE = 0x40        # 辅助 IMU 的 SlimeVR sensor ID = tracker ID + 0x40
+
+def parse_aux_report(data: bytes) -> List[Dict]:
+    """
+    解析辅助 IMU 姿态报告 (Report 0x05, 64 bytes)
+    
+    格式:
+        [0]     0x05
+        [1]     条目数
+        [2..]   每条目 9 字节: tracker ID, w,x,y,z int16 Q15
+    """
+    if len(data) < 2 or data[0] != REPORT_ID_AUX:
+        return []
+    
+    out = []
+    for i in range(data[1]):
+        off = 2 + i * AUX_ENTRY_SIZE
+        if off + AUX_ENTRY_SIZE > len(data):
+            break
+        qw, qx, qy, qz = struct.unpack('<hhhh', bytes(data[off + 1:off + 9]))
+        out.append({
+            'type': 'aux_rotation',
+            'tracker_id': data[off],
+            'quaternion': [qw / 32768.0, qx / 32768.0, qy / 32768.0, qz / 32768.0],
+        })
+    return out
+
+class DiversityMerger:
+    """
+    合并多个接收器的转发报告
+    
+    同一个包被两个接收器收到时内容相同, 保留最先到达的副本; 序列号 (无序列号的
+    RF Ultra 包用帧号) 不新于已输出的视为重复或乱序丢弃
+    """
+    
+    RESTART_TIMEOUT = 0.5   # 超过此时间没有新包, 接受任意序列号 (tracker 重启)
+    
+    def __init__(self, receivers: int):
+        self.last: Dict[Tuple[int, bool], Tuple[int, float]] = {}
+        self.first_copy = [0] * receivers    # 每个接收器率先送达的包数
+        self.duplicates = 0
+    
+    def accept(self, entry: Dict, receiver: int) -> bool:
+        key = (entry['tracker_id'], entry['has_sequence'])
+        if entry['has_sequence']:
+            value, modulo = entry['sequence'], 256
+        else:
+            value, modulo = entry['frame'], 65536
+        
+        now = time.time()
+        prev = self.last.get(key)
+        if prev is not None and now - prev[1] < self.RESTART_TIMEOUT:
+            diff = (value - prev[0]) % modulo
+            if diff == 0 or diff >= modulo // 2:
+                self.duplicates += 1
+                return False
+        
+        self.last[key] = (value, now)
+        self.first_copy[receiver] += 1
+        return True
+
+CMD_TIME_BASE = 0x23           # v0.6.3: 接收器时间基准
+TIME_SYNC_INTERVAL = 1.0       # 查询周期 (s)
+
+class ReceiverClock:
+    """
+    v0.6.3: 接收器时钟 → 主机时钟映射
+    
+    0x23 应答: [1] 已同步, [2-3] 帧号, [4-7] 帧起点 us, [8-11] 当前 us, [12-13] 超帧 us (LE)
+    以往返中点对应应答中的当前时刻, 在最近若干次往返最短的样本上线性拟合 (含晶振偏差);
+    帧报告的 (帧号, 帧内偏移) 以最近一次的帧起点为参照换算到接收器时钟
+    """
+    
+    WINDOW = 16
+    
+    def __init__(self):
+        self.samples: List[Tuple[float, float, float]] = []   # (往返 s, 主机中点 s, 接收器 s)
+        self.t_request = None
+        self.rx_wrap = 0
+        self.rx_last = None
+        self.frame_ref = None      # (帧号, 帧起点 us, 超帧 us)
+        self.fit = None            # (主机 = a + b * 接收器)
+    
+    def request(self, device, send):
+        self.t_request = time.monotonic()
+        send(device, bytes([CMD_TIME_BASE]))
+    
+    def _unwrap(self, rx_us: int) -> float:
+        if self.rx_last is not None and rx_us < self.rx_last and self.rx_last - rx_us > 0x80000000:
+            self.rx_wrap += 1 << 32
+        self.rx_last = rx_us
+        return (self.rx_wrap + rx_us) * 1e-6
+    
+    def on_response(self, data: bytes):
+        if self.t_request is None or len(data) < 14:
+            return
+        t_recv = time.monotonic()
+        rtt = t_recv - self.t_request
+        self.t_request = None
+        frame, start_us, now_us, superframe_us = struct.unpack('<HIIH', data[2:14])
+        rx = self._unwrap(now_us)
+        if data[1]:
+            self.frame_ref = (frame, start_us, superframe_us)
+        
+        self.samples.append((rtt, t_recv - rtt / 2, rx))
+        self.samples = self.samples[-self.WINDOW:]
+        best = sorted(self.samples)[:max(2, len(self.samples) // 2)]
+        if len(best) < 2 or max(b[2] for b in best) - min(b[2] for b in best) < 0.5:
+            # 跨度不足以估计斜率, 只用往返最短的样本求偏移
+            self.fit = (best[0][1] - best[0][2], 1.0)
+            return
+        n = len(best)
+        mx = sum(b[2] for b in best) / n
+        my = sum(b[1] for b in best) / n
+        sxx = sum((b[2] - mx) ** 2 for b in best)
+        slope = sum((b[2] - mx) * (b[1] - my) for b in best) / sxx
+        self.fit = (my - slope * mx, slope)
+    
+    def receiver_to_host(self, rx_us: int) -> Optional[float]:
+        if self.fit is None or self.rx_last is None:
+            return None
+        # 样本时刻在最近一次读数附近, 按有符号差值展开
+        delta = (rx_us - self.rx_last + (1 << 31)) % (1 << 32) - (1 << 31)
+        rx = (self.rx_wrap + self.rx_last + delta) * 1e-6
+        return self.fit[0] + self.fit[1] * rx
+    
+    def frame_to_host(self, frame: int, offset_us: int = 0, bits: int = 16) -> Optional[float]:
+        """帧报告样本时刻 → 主机 time.monotonic() 时刻 (bundle 报告帧号只有 8 位)"""
+        if self.frame_ref is None:
+            return None
+        ref, start_us, superframe_us = self.frame_ref
+        mod = 1 << bits
+        frames = (frame - ref + mod // 2) % mod - mod // 2
+        return self.receiver_to_host((start_us + frames * superframe_us + offset_us) & 0xFFFFFFFF)
+
 #==============================================================================
 # SlimeVR 协议构建 / SlimeVR Protocol Builder
 #==============================================================================
@@ -251,7 +534,14 @@ class SlimeVRBridge:
         self.running = False
         self.connected_trackers = set()
         self.last_battery_time = {}
+        self.battery_level = {}         # bundle 状态旁路上报的电量
         self.server_addr = (SLIMEVR_HOST, SLIMEVR_PORT)
+        self.diversity = False
+        self.roaming = False            # 漫游组: 两台接收器都调度, 按转发报告合并
+        self.devices = []               # 分集模式: [主接收器, 副接收器]
+        self.merger = None
+        self.clock = ReceiverClock()    # 样本时刻映射到主机时钟
+        self.last_time_sync = 0.0
     
     def find_device(self) -> bool:
         """查找 USB HID 设备"""
@@ -293,8 +583,146 @@ class SlimeVRBridge:
             log_error(f"连接失败: {e}")
             return False
     
+    def send_command(self, device, payload: bytes):
+        """发送命令 (hidapi 约定首字节为报告 ID, 接收器不使用 OUT 报告 ID)"""
+        device.write(bytes([0x00]) + payload)
+    
+    def read_response(self, device, cmd: int, timeout: float = 0.5) -> Optional[bytes]:
+        """等待以 cmd 开头的应答, 期间的其他报告丢弃"""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            data = device.read(64, timeout_ms=20)
+            if data and data[0] == cmd:
+                return bytes(data)
+        return None
+    
+    def connect_diversity(self) -> bool:
+        """
+        v0.6.3: 打开两个接收器, 把第二个配置为共用主接收器网络密钥的副接收器,
+        两者都开启转发报告
+        """
+        paths = [d['path'] for d in hid.enumerate(USB_VID, USB_PID)]
+        if len(paths) < 2:
+            log_error(f"分集模式需要两个接收器, 找到 {len(paths)} 个")
+            return False
+        
+        try:
+            for path in paths[:2]:
+                dev = hid.device()
+                dev.open_path(path)
+                self.devices.append(dev)
+            
+            primary, secondary = self.devices
+            self.send_command(primary, bytes([CMD_GET_NETWORK]))
+            resp = self.read_response(primary, CMD_GET_NETWORK)
+            if resp is None or len(resp) < 6:
+                log_error("读取主接收器网络密钥失败 (固件需支持 USE_RX_DIVERSITY)")
+                return False
+            if resp[5] == 1:
+                # 第一个枚举到的是上次运行配置的副接收器, 交换角色
+                primary, secondary = secondary, primary
+                self.devices = [primary, secondary]
+                self.send_command(primary, bytes([CMD_SET_ROLE, 0]))
+                self.send_command(primary, bytes([CMD_GET_NETWORK]))
+                resp = self.read_response(primary, CMD_GET_NETWORK)
+                if resp is None or len(resp) < 6:
+                    log_error("读取主接收器网络密钥失败")
+                    return False
+            
+            key = resp[1:5]
+            self.send_command(secondary, bytes([CMD_SET_ROLE, 1]) + key)
+            for dev in self.devices:
+                self.send_command(dev, bytes([CMD_FORWARD_ENABLE, 1]))
+                dev.set_nonblocking(True)
+            
+            self.hid_device = primary
+            self.merger = DiversityMerger(len(self.devices))
+            log_info(f"分集模式: 网络密钥 {key.hex()}, 副接收器跟随主接收器信标")
+            return True
+            
+        except Exception as e:
+            log_error(f"连接失败: {e}")
+            return False
+    
+    def read_pairing(self, device) -> Optional[Dict[int, bytes]]:
+        """读取接收器配对表 {ID: MAC}"""
+        table = {}
+        for index in range(PAIRING_MAX_ENTRIES):
+            self.send_command(device, bytes([CMD_GET_PAIRING, index]))
+            resp = self.read_response(device, CMD_GET_PAIRING)
+            if resp is None:
+                return None
+            if resp[1] == 0xFF:
+                break
+            table[resp[1]] = resp[2:8]
+        return table
+    
+    def connect_roaming(self) -> bool:
+        """
+        v0.6.3: 打开两个接收器组成漫游组 - 共用第一个接收器的网络密钥, 分别作为小区 0/1
+        独立调度, 合并两者的配对表 (tracker 在哪个接收器上配对都可以迁移到另一个);
+        tracker 按信标 RSSI 选择小区, 姿态经转发报告按序列号合并
+        """
+        paths = [d['path'] for d in hid.enumerate(USB_VID, USB_PID)]
+        if len(paths) < 2:
+            log_error(f"漫游模式需要两个接收器, 找到 {len(paths)} 个")
+            return False
+        
+        try:
+            for path in paths[:2]:
+                dev = hid.device()
+                dev.open_path(path)
+                self.devices.append(dev)
+            
+            self.send_command(self.devices[0], bytes([CMD_GET_NETWORK]))
+            resp = self.read_response(self.devices[0], CMD_GET_NETWORK)
+            if resp is None or len(resp) < 6:
+                log_error("读取网络密钥失败")
+                return False
+            key = resp[1:5]
+            
+            tables = [self.read_pairing(dev) for dev in self.devices]
+            if None in tables:
+                log_error("读取配对表失败 (固件需支持 USE_RF_ROAMING)")
+                return False
+            merged = {}
+            for table in tables:
+                for tid, mac in table.items():
+                    if tid in merged and merged[tid] != mac:
+                        log_error(f"追踪器 ID {tid} 在两个接收器上对应不同的 MAC, "
+                                  f"保留 {merged[tid].hex(':')} (请在一个接收器上重新配对)")
+                        continue
+                    merged.setdefault(tid, mac)
+            for dev, table in zip(self.devices, tables):
+                for tid, mac in merged.items():
+                    if table.get(tid) != mac:
+                        self.send_command(dev, bytes([CMD_SET_PAIRING, tid]) + mac)
+            
+            for cell, dev in enumerate(self.devices):
+                self.send_command(dev, bytes([CMD_SET_ROAM_CELL, cell]) + key)
+                self.send_command(dev, bytes([CMD_FORWARD_ENABLE, 1]))
+                dev.set_nonblocking(True)
+            
+            self.hid_device = self.devices[0]
+            self.merger = DiversityMerger(len(self.devices))
+            log_info(f"漫游模式: 网络密钥 {key.hex()}, {len(merged)} 个追踪器, 小区 0/1")
+            return True
+            
+        except Exception as e:
+            log_error(f"连接失败: {e}")
+            return False
+    
     def disconnect(self):
         """断开连接"""
+        for dev in self.devices:
+            try:
+                self.send_command(dev, bytes([CMD_FORWARD_ENABLE, 0]))
+                dev.close()
+            except:
+                pass
+        if self.devices:
+            self.devices = []
+            self.hid_device = None
         if self.hid_device:
             try:
                 self.hid_device.close()
@@ -323,7 +751,16 @@ class SlimeVRBridge:
             self.connected_trackers.add(tracker_id)
             self.last_battery_time[tracker_id] = 0
         
-        if data['type'] == 'rotation':
+        if data['type'] == 'aux_rotation':
+            # v0.6.3: 辅助 IMU 作为同一追踪器的另一个传感器
+            rotation = self.protocol.build_rotation(
+                tracker_id + AUX_SENSOR_BASE,
+                data['quaternion']
+            )
+            self.send_to_slimevr(rotation)
+            log_debug(f"追踪器 #{tracker_id} 辅助 IMU: q={data['quaternion']}")
+        
+        elif data['type'] == 'rotation':
             # 发送旋转数据
             rotation = self.protocol.build_rotation(
                 tracker_id, 
@@ -332,13 +769,16 @@ class SlimeVRBridge:
             self.send_to_slimevr(rotation)
             
             log_debug(f"追踪器 #{tracker_id}: q={data['quaternion']}")
+            if data.get('sample_time') is not None:
+                log_debug(f"  样本延迟 {(time.monotonic() - data['sample_time']) * 1000:.2f} ms")
             
-            # 定期发送电池状态 (每 5 秒)
+            # 定期发送电池状态 (每 5 秒, 帧对齐报告不含电量, bundle 电量来自状态旁路)
             now = time.time()
-            if now - self.last_battery_time.get(tracker_id, 0) > 5:
+            level = data.get('battery', self.battery_level.get(tracker_id))
+            if level is not None and now - self.last_battery_time.get(tracker_id, 0) > 5:
                 battery = self.protocol.build_battery(
                     tracker_id,
-                    data['battery']
+                    level
                 )
                 self.send_to_slimevr(battery)
                 self.last_battery_time[tracker_id] = now
@@ -350,9 +790,48 @@ class SlimeVRBridge:
             self.send_to_slimevr(heartbeat)
             time.sleep(1)  # 每秒一次
     
+    def handle_report(self, data: bytes, receiver: int):
+        """处理一个 HID 报告 (receiver = 分集模式下的接收器序号)"""
+        if data[0] == CMD_TIME_BASE:
+            if receiver == 0:
+                self.clock.on_response(data)
+        elif data[0] == REPORT_ID_FORWARD:
+            if not self.merger:
+                return
+            for entry in parse_forward_report(data):
+                if self.merger.accept(entry, receiver):
+                    self.handle_tracker_data(entry)
+        elif data[0] == REPORT_ID_AUX:
+            if receiver == 0:
+                for entry in parse_aux_report(data):
+                    self.handle_tracker_data(entry)
+        elif data[0] == REPORT_ID_BUNDLE:
+            for entry in parse_bundle_report(data):
+                if entry['type'] == 'status':
+                    self.battery_level[entry['tracker_id']] = entry['battery']
+                elif not entry['stale'] and not self.diversity:
+                    entry['sample_time'] = self.clock.frame_to_host(entry['frame'], 0, bits=8)
+                    self.handle_tracker_data(entry)
+        elif data[0] == REPORT_ID_FRAME:
+            if self.diversity:
+                return      # 姿态来自转发报告
+            for entry in parse_frame_report(data):
+                if not entry['stale']:
+                    entry['sample_time'] = self.clock.frame_to_host(entry['frame'],
+                                                                    entry['frame_offset_us'])
+                    self.handle_tracker_data(entry)
+        elif not self.diversity:
+            parsed = parse_rf_ultra_packet(data)
+            if parsed:
+                self.handle_tracker_data(parsed)
+    
     def run(self):
         """主循环"""
-        if not self.connect():
+        if self.roaming:
+            connected = self.connect_roaming()
+        else:
+            connected = self.connect_diversity() if self.diversity else self.connect()
+        if not connected:
             log_error("无法连接设备，退出")
             return
         
@@ -367,18 +846,23 @@ class SlimeVRBridge:
         
         try:
             while self.running:
-                # 读取 USB HID 数据
+                # 读取 USB HID 数据 (分集模式轮询两个接收器, 读空为止)
+                devices = self.devices if self.diversity else [self.hid_device]
                 try:
-                    data = self.hid_device.read(64, timeout_ms=10)
+                    for i, dev in enumerate(devices):
+                        data = dev.read(64) if self.diversity else dev.read(64, timeout_ms=10)
+                        while data:
+                            self.handle_report(bytes(data), i)
+                            data = dev.read(64) if self.diversity else None
                 except Exception as e:
                     log_error(f"读取错误: {e}")
                     time.sleep(0.1)
                     continue
                 
-                if data:
-                    parsed = parse_rf_ultra_packet(bytes(data))
-                    if parsed:
-                        self.handle_tracker_data(parsed)
+                # v0.6.3: 定期读取接收器时间基准 (应答在上面的读取中处理)
+                if time.monotonic() - self.last_time_sync > TIME_SYNC_INTERVAL:
+                    self.last_time_sync = time.monotonic()
+                    self.clock.request(self.hid_device, self.send_command)
                 
                 # 不要占用太多 CPU
                 time.sleep(0.001)
@@ -390,6 +874,9 @@ class SlimeVRBridge:
             self.disconnect()
         
         log_info(f"会话统计: {len(self.connected_trackers)} 个追踪器连接过")
+        if self.merger:
+            log_info(f"{'漫游' if self.roaming else '分集'}统计: 率先送达 主={self.merger.first_copy[0]} "
+                     f"副={self.merger.first_copy[1]}, 重复 {self.merger.duplicates}")
 
 #==============================================================================
 # 主程序 / Main
@@ -406,6 +893,8 @@ def main():
     python slimevr_bridge.py              # 正常运行
     python slimevr_bridge.py --debug      # 调试模式
     python slimevr_bridge.py --list       # 列出 HID 设备
+    python slimevr_bridge.py --diversity  # 双接收器分集
+    python slimevr_bridge.py --roaming    # 双接收器漫游 (大场地)
         """
     )
     
@@ -417,6 +906,10 @@ def main():
                         help=f'SlimeVR 服务端地址 (默认: {SLIMEVR_HOST})')
     parser.add_argument('--port', type=int, default=SLIMEVR_PORT,
                         help=f'SlimeVR 服务端端口 (默认: {SLIMEVR_PORT})')
+    parser.add_argument('--diversity', action='store_true',
+                        help='双接收器分集: 第二个接收器旁听并转发, 按序列号合并')
+    parser.add_argument('--roaming', action='store_true',
+                        help='双接收器漫游: 两个接收器分别调度, tracker 按信号强度切换')
     
     args = parser.parse_args()
     
@@ -434,6 +927,8 @@ def main():
     # 创建并运行桥接
     bridge = SlimeVRBridge()
     bridge.server_addr = (args.host, args.port)
+    bridge.diversity = args.diversity or args.roaming
+    bridge.roaming = args.roaming
     
     if not bridge.find_device():
         log_error("未找到 SlimeVR CH592 接收器!")
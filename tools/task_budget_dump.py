@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 主循环任务耗时预算读取 v0.6.3
+Main-loop task budget dump
+
+用途:
+- 经 usb_debug 0x19 命令读取每个任务的执行次数、超预算次数、最大耗时和被卸载次数 (固件需 USE_TASK_BUDGET=1)
+- 超预算的明细 (刷新最大值时的任务 ID 和耗时) 在事件环中, 见 event_dump.py 的 TASK_OVERRUN
+- --shed on/off 切换卸载模式 (迭代迟到时跳过 LED/电池读取)
+
+依赖:
+- pip install hidapi
+
+用法:
+- python task_budget_dump.py
+- python task_budget_dump.py --interval 10
+- python task_budget_dump.py --shed on
+"""
+
+import argparse
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_TASKS = 0x19
+TASK_RESET = 0xFF
+TASK_SET_SHED = 0xFE
+TASK_INVALID = 0xFD
+
+TASK_NAMES = ['sensor', 'rf', 'usb', 'led', 'storage', 'battery']
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def command(device, payload: bytes) -> bytes:
+    send_command(device, payload)
+    data = wait_response(device, CMD_GET_TASKS)
+    if not data:
+        raise SystemExit("无响应 (固件未启用 USE_TASK_BUDGET?)")
+    return data
+
+
+def read_task(device, index: int) -> Optional[Dict]:
+    data = command(device, bytes([CMD_GET_TASKS, index]))
+    if data[1] != index or len(data) < 20:
+        return None
+    count, overruns, shed, budget, max_us = struct.unpack_from('<IIIHH', data, 4)
+    name = TASK_NAMES[index] if index < len(TASK_NAMES) else f'task{index}'
+    return {'index': index, 'tasks': data[2], 'shed_mode': bool(data[3]), 'name': name,
+            'count': count, 'overruns': overruns, 'shed': shed, 'budget_us': budget, 'max_us': max_us}
+
+
+def read_all(device) -> List[Dict]:
+    first = read_task(device, 0)
+    if not first:
+        raise SystemExit("无响应")
+    tasks = [first]
+    for i in range(1, first['tasks']):
+        t = read_task(device, i)
+        if t:
+            tasks.append(t)
+    return tasks
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def report(tasks: List[Dict]):
+    print(f"\n卸载模式: {'开' if tasks[0]['shed_mode'] else '关'}")
+    print(f"{'任务':<10} {'次数':>9} {'超预算':>8} {'比例%':>7} {'预算us':>7} {'最大us':>7} {'跳过':>7}")
+    for t in tasks:
+        ratio = 100.0 * t['overruns'] / t['count'] if t['count'] else 0.0
+        worst = f"{t['max_us']}+" if t['max_us'] == 0xFFFF else str(t['max_us'])
+        print(f"{t['name']:<10} {t['count']:>9} {t['overruns']:>8} {ratio:>7.3f} "
+              f"{t['budget_us']:>7} {worst:>7} {t['shed']:>7}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X main-loop task budget dump')
+    parser.add_argument('--reset', action='store_true', help='读取后清零')
+    parser.add_argument('--interval', type=float, help='周期读取间隔 (秒), 每次读完清零')
+    parser.add_argument('--shed', choices=['on', 'off'], help='设置卸载模式')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        if args.shed:
+            command(device, bytes([CMD_GET_TASKS, TASK_SET_SHED, 1 if args.shed == 'on' else 0]))
+        if not args.interval:
+            report(read_all(device))
+            if args.reset:
+                command(device, bytes([CMD_GET_TASKS, TASK_RESET]))
+            return 0
+
+        command(device, bytes([CMD_GET_TASKS, TASK_RESET]))
+        while True:
+            time.sleep(args.interval)
+            tasks = read_all(device)
+            command(device, bytes([CMD_GET_TASKS, TASK_RESET]))
+            report(tasks)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        device.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
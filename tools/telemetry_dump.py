@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 跨重启遥测汇总读取 v0.6.3
+Per-session telemetry history dump
+
+用途:
+- 经 usb_debug 0x18 命令读出当前会话和之前几次上电的汇总 (固件需 USE_TELEMETRY_HISTORY=1)
+- 每个会话: 启动原因, 运行时间, 丢包率, 漏收信标, 睡眠/唤醒次数, 主循环最短/最长迭代, RSSI 直方图
+- 格式见 include/telemetry_history.h (telem_session_t)
+
+依赖:
+- pip install hidapi
+
+用法:
+- python telemetry_dump.py
+- python telemetry_dump.py --json
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+from typing import Dict, List, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_TELEMETRY = 0x18
+
+HISTORY_DEPTH = 4
+RSSI_BINS = 8
+SESSION_FMT = '<HBBIIIHHHHH' + 'H' * RSSI_BINS       # 42 字节
+
+FLAG_TRACKER = 0x01
+FLAG_CLEAN = 0x02
+
+RESET_REASONS = {
+    0x00: '未知', 0x01: '上电', 0x02: '软件', 0x04: '看门狗', 0x08: 'HardFault',
+    0x10: '锁死', 0x20: '外部', 0x40: '欠压',
+}
+
+RSSI_LABELS = ['<-90', '-90', '-80', '-70', '-60', '-50', '-40', '>=-30']
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def read_session(device, index: int) -> Optional[Dict]:
+    send_command(device, bytes([CMD_GET_TELEMETRY, index]))
+    data = wait_response(device, CMD_GET_TELEMETRY)
+    if not data:
+        raise SystemExit("无响应 (固件未启用 USE_TELEMETRY_HISTORY?)")
+    if data[1] != index or not data[2]:
+        return None
+    v = struct.unpack_from(SESSION_FMT, data, 3)
+    return {
+        'index': index,
+        'session': v[0],
+        'reset_reason': v[1],
+        'flags': v[2],
+        'duration_s': v[3],
+        'packets': v[4],
+        'lost': v[5],
+        'sync_miss': v[6],
+        'sleep_count': v[7],
+        'wake_count': v[8],
+        'loop_min_us': v[9],
+        'loop_max_us': v[10],
+        'rssi_hist': list(v[11:11 + RSSI_BINS]),
+    }
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def loss_pct(s: Dict) -> float:
+    total = s['packets'] + (0 if s['flags'] & FLAG_TRACKER else s['lost'])
+    return 100.0 * s['lost'] / total if total else 0.0
+
+
+def print_session(s: Dict):
+    tag = '当前' if s['index'] == 0 else f"-{s['index']}"
+    role = 'tracker' if s['flags'] & FLAG_TRACKER else '接收器'
+    end = '' if s['index'] == 0 else ('  正常结束' if s['flags'] & FLAG_CLEAN else '  最后为周期快照')
+    reason = RESET_REASONS.get(s['reset_reason'], f"0x{s['reset_reason']:02X}")
+    print(f"[{tag}] 会话 {s['session']} ({role}, 启动: {reason}) 运行 {s['duration_s']}s{end}")
+    print(f"  包 {s['packets']}  丢失 {s['lost']} ({loss_pct(s):.2f}%)  漏信标 {s['sync_miss']}  "
+          f"睡眠/唤醒 {s['sleep_count']}/{s['wake_count']}")
+    if s['loop_min_us'] <= s['loop_max_us']:
+        print(f"  主循环 {s['loop_min_us']}-{s['loop_max_us']}us"
+              f"{'+' if s['loop_max_us'] == 0xFFFF else ''}")
+    total = sum(s['rssi_hist'])
+    if total:
+        bars = '  '.join(f"{label}:{n * 100 // total}%" for label, n in zip(RSSI_LABELS, s['rssi_hist']))
+        print(f"  RSSI {bars}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X telemetry history dump')
+    parser.add_argument('--json', action='store_true', help='输出 JSON')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        sessions: List[Dict] = []
+        for index in range(HISTORY_DEPTH + 1):
+            s = read_session(device, index)
+            if s is None:
+                break
+            sessions.append(s)
+    finally:
+        device.close()
+
+    if args.json:
+        print(json.dumps(sessions, indent=2, ensure_ascii=False))
+    else:
+        for s in sessions:
+            print_session(s)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
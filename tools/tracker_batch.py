@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 批量 tracker 命令 v0.6.3
+Batched tracker command sender
+
+用途:
+- 经接收器 0x19 命令一次下发多条 tracker 命令 (每个 HID 报告最多 15 条, 每条带序号)
+- 接收器把命令按顺序放入各 tracker 的命令队列, 一个报告应答全部结果
+- ID 写 all 时广播给全部已连接 tracker, 结果为进入的队列数
+
+依赖:
+- pip install hidapi
+
+用法:
+- python tracker_batch.py 0:tare 1:tare 2:set_power=3
+- python tracker_batch.py all:set_fec=1 all:calibrate_gyro
+"""
+
+import argparse
+import sys
+import time
+from typing import List, Optional, Tuple
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_SEQ_BATCH = 0x19
+BATCH_MAX = 15
+TRACKER_ALL = 0xFF
+
+# rf_command_t (include/rf_protocol.h)
+COMMANDS = {
+    'calibrate_gyro': 0x01, 'calibrate_accel': 0x02, 'calibrate_mag': 0x03,
+    'tare': 0x04, 'reset': 0x05, 'sleep': 0x06, 'wake': 0x07,
+    'set_power': 0x10, 'set_fec': 0x11, 'unpair': 0xFF,
+}
+
+RESULTS = {0x81: '无效 ID', 0x82: '未连接', 0x83: '队列已满'}
+
+#==============================================================================
+# 命令解析
+#==============================================================================
+
+def parse_item(text: str) -> Tuple[int, int, int]:
+    """ID:命令[=参数], 命令可写名称或数值"""
+    try:
+        tid, rest = text.split(':', 1)
+        name, _, param = rest.partition('=')
+        tracker = TRACKER_ALL if tid == 'all' else int(tid, 0)
+        cmd = COMMANDS[name] if name in COMMANDS else int(name, 0)
+        return tracker, cmd, int(param, 0) if param else 0
+    except (ValueError, KeyError):
+        raise SystemExit(f"无法解析 '{text}' (格式 ID:命令[=参数])")
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_batch(device, items: List[Tuple[int, int, int]], seq0: int) -> Optional[bytes]:
+    payload = [CMD_SEQ_BATCH]
+    for i, (tracker, cmd, param) in enumerate(items):
+        payload += [(seq0 + i) & 0xFF, tracker, cmd, param & 0xFF]
+    # hidapi 约定首字节为报告 ID, 接收器不使用 OUT 报告 ID
+    device.write([0x00] + payload)
+
+    deadline = time.time() + 0.5
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == CMD_SEQ_BATCH:
+            return bytes(data)
+    return None
+
+
+def report(items: List[Tuple[int, int, int]], resp: bytes):
+    for i in range(resp[1]):
+        seq, result = resp[2 + i * 2], resp[3 + i * 2]
+        tracker, cmd, param = items[i]
+        target = 'all' if tracker == TRACKER_ALL else str(tracker)
+        state = RESULTS.get(result, f"已入队 ({result})")
+        print(f"  #{seq:<3} {target:>3}  cmd 0x{cmd:02X} param {param:<3}  {state}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X batched tracker commands')
+    parser.add_argument('items', nargs='+', help='ID:命令[=参数], ID 可为 all')
+    args = parser.parse_args()
+
+    items = [parse_item(t) for t in args.items]
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    failed = 0
+    try:
+        for start in range(0, len(items), BATCH_MAX):
+            chunk = items[start:start + BATCH_MAX]
+            resp = send_batch(device, chunk, start)
+            if not resp:
+                print("无响应 (固件不支持 0x19?)")
+                return 1
+            report(chunk, resp)
+            failed += sum(1 for i in range(resp[1]) if resp[3 + i * 2] & 0x80)
+    finally:
+        device.close()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 接收器批量数据流读取 v0.6.3
+Receiver vendor bulk stream reader
+
+用途:
+- 经 HID 命令 0x32 选择内容 (固件需 USE_USB_BULK_STREAM=1), 从接口 1 的 EP3 IN 读取
+- 按同步字节拆帧 (格式见 include/usb_hid_slime.h), 按帧序号统计丢帧
+- 样本写 CSV, 链路统计打印, 时序记录可另存为原始报告 (供 rf_trace.py 离线解码)
+
+依赖:
+- pip install pyusb hidapi
+- Windows 需用 Zadig 给接口 1 装 WinUSB 驱动 (接口 0 保持 HID)
+
+用法:
+- python usb_bulk_stream.py --samples --duration 30 --csv samples.csv
+- python usb_bulk_stream.py --link --trace trace.bin
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+try:
+    import hid
+    import usb.core
+    import usb.util
+except ImportError:
+    print("错误: 请安装依赖: pip install pyusb hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x7690
+
+BULK_INTERFACE = 1
+BULK_EP_IN = 0x83
+
+CMD_BULK_STREAM = 0x32
+STREAM_SAMPLES = 0x01
+STREAM_TRACE = 0x02
+STREAM_LINK = 0x04
+
+SYNC = 0xA5
+HDR_SIZE = 4
+T_SAMPLE = 0x01
+T_TRACE = 0x02
+T_LINK = 0x03
+
+#==============================================================================
+# 拆帧
+#==============================================================================
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+        self.next_seq = None
+        self.frames = 0
+        self.lost = 0
+        self.resync = 0
+
+    def feed(self, data: bytes):
+        self.buf += data
+        out = []
+        while len(self.buf) >= HDR_SIZE:
+            if self.buf[0] != SYNC:
+                # 失步: 丢到下一个同步字节
+                idx = self.buf.find(bytes([SYNC]), 1)
+                self.buf = self.buf[idx:] if idx >= 0 else bytearray()
+                self.resync += 1
+                continue
+            n = self.buf[2]
+            if len(self.buf) < HDR_SIZE + n:
+                break
+            ftype, seq = self.buf[1], self.buf[3]
+            payload = bytes(self.buf[HDR_SIZE:HDR_SIZE + n])
+            del self.buf[:HDR_SIZE + n]
+            if self.next_seq is not None:
+                self.lost += (seq - self.next_seq) & 0xFF
+            self.next_seq = (seq + 1) & 0xFF
+            self.frames += 1
+            out.append((ftype, payload))
+        return out
+
+
+def decode_sample(p: bytes):
+    tid, frame, offset, t_us = struct.unpack_from('<BHhI', p, 0)
+    quat = struct.unpack_from('<4h', p, 9)
+    return [tid, frame, offset, t_us] + [q / 32767.0 for q in quat] + [struct.unpack_from('<b', p, 19)[0]]
+
+
+def decode_link(p: bytes):
+    tid, flags, loss, dup, late, rssi, batt = struct.unpack_from('<BBBBBbB', p, 0)
+    received, lost, duplicate, late_n, ring = struct.unpack_from('<5I', p, 7)
+    return (f"T{tid:02d} {'A' if flags & 1 else '-'}{'C' if flags & 2 else '-'} "
+            f"丢包 {loss}% 重复 {dup}% 迟到 {late}% RSSI {rssi} 电量 {batt}% "
+            f"收 {received} 丢 {lost} 重 {duplicate} 迟 {late_n} 环满 {ring}")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X receiver bulk stream reader')
+    parser.add_argument('--samples', action='store_true', help='输出每个解码样本')
+    parser.add_argument('--link', action='store_true', help='输出链路统计 (约 1Hz)')
+    parser.add_argument('--trace', type=str, help='输出超帧时序记录到文件 (原始 64 字节报告)')
+    parser.add_argument('--duration', type=float, default=10.0, help='读取时长 (秒, 默认 10)')
+    parser.add_argument('--csv', type=str, default='bulk_samples.csv', help='样本输出文件')
+    args = parser.parse_args()
+
+    mask = (STREAM_SAMPLES if args.samples else 0) | (STREAM_LINK if args.link else 0) | \
+           (STREAM_TRACE if args.trace else 0)
+    if not mask:
+        parser.error("至少选择 --samples / --link / --trace 之一")
+
+    dev = usb.core.find(idVendor=USB_VID, idProduct=USB_PID)
+    if dev is None:
+        print("未找到接收器")
+        return 1
+    try:
+        if dev.is_kernel_driver_active(BULK_INTERFACE):
+            dev.detach_kernel_driver(BULK_INTERFACE)
+    except (NotImplementedError, usb.core.USBError):
+        pass
+    usb.util.claim_interface(dev, BULK_INTERFACE)
+
+    ctrl = hid.device()
+    ctrl.open(USB_VID, USB_PID)
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    ctrl.write(bytes([0x00, CMD_BULK_STREAM, mask]))
+
+    fp = FrameParser()
+    csv_file = open(args.csv, 'w', newline='') if args.samples else None
+    writer = csv.writer(csv_file) if csv_file else None
+    if writer:
+        writer.writerow(['id', 'frame', 'offset_us', 't_us', 'qw', 'qx', 'qy', 'qz', 'rssi'])
+    trace_file = open(args.trace, 'wb') if args.trace else None
+
+    samples = 0
+    start = time.time()
+    try:
+        while time.time() - start < args.duration:
+            try:
+                data = dev.read(BULK_EP_IN, 4096, timeout=50)
+            except usb.core.USBTimeoutError:
+                continue
+            for ftype, payload in fp.feed(bytes(data)):
+                if ftype == T_SAMPLE and writer:
+                    writer.writerow(decode_sample(payload))
+                    samples += 1
+                elif ftype == T_LINK:
+                    print(decode_link(payload))
+                elif ftype == T_TRACE and trace_file:
+                    trace_file.write(payload.ljust(64, b'\x00'))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        ctrl.write(bytes([0x00, CMD_BULK_STREAM, 0]))
+        ctrl.close()
+        usb.util.release_interface(dev, BULK_INTERFACE)
+        if csv_file:
+            csv_file.close()
+        if trace_file:
+            trace_file.close()
+
+    elapsed = time.time() - start
+    print(f"\n帧 {fp.frames}, 丢帧 {fp.lost}, 失步 {fp.resync}, 样本 {samples}"
+          f" ({samples / elapsed:.1f}/秒)")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+SlimeVR CH59X 唤醒耗时读取 v0.6.3
+Wake-to-first-sync phase timing dump
+
+用途:
+- 经 usb_debug 0x1A 命令读取最近一次启动/唤醒的分段耗时 (固件需 USE_WAKE_PROFILE=1)
+- 起点为 hal_timer_init, 终点为首次进入 STATE_RUNNING (同步完成, 本帧开始发送)
+- 深睡眠唤醒时一并显示上次进入 Shutdown 的耗时
+- 阶段定义见 include/wake_profile.h (wake_phase_t)
+
+依赖:
+- pip install hidapi
+
+用法:
+- python wake_dump.py
+- python wake_dump.py --json
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+from typing import Dict, Optional
+
+try:
+    import hid
+except ImportError:
+    print("错误: 请安装 hidapi: pip install hidapi")
+    sys.exit(1)
+
+# USB VID/PID
+USB_VID = 0x1209
+USB_PID = 0x5711
+
+CMD_GET_WAKE = 0x1A
+
+PHASE_NAMES = ['hal', 'modules', 'gpio', 'rf', 'restore', 'imu', 'sync']
+SOURCES = {0: '冷启动', 1: '深睡眠', 2: '轻度睡眠'}
+
+#==============================================================================
+# 通信
+#==============================================================================
+
+def send_command(device, payload: bytes):
+    # hidapi 约定首字节为报告 ID, 设备不使用 OUT 报告 ID
+    device.write(bytes([0x00]) + payload)
+
+
+def wait_response(device, cmd: int, timeout_s: float = 0.5) -> Optional[bytes]:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        data = device.read(64, timeout_ms=20)
+        if data and data[0] == (cmd | 0x80):
+            return bytes(data)
+    return None
+
+
+def read_wake(device) -> Dict:
+    send_command(device, bytes([CMD_GET_WAKE]))
+    data = wait_response(device, CMD_GET_WAKE)
+    if not data or len(data) < 9 + 4 * len(PHASE_NAMES):
+        raise SystemExit("无响应 (固件未启用 USE_WAKE_PROFILE?)")
+    entry_us, total_us = struct.unpack_from('<HI', data, 3)
+    phases = struct.unpack_from('<' + 'I' * len(PHASE_NAMES), data, 9)
+    return {'source': SOURCES.get(data[1], f'0x{data[1]:02X}'), 'complete': bool(data[2]),
+            'entry_us': entry_us, 'total_us': total_us,
+            'phases_us': dict(zip(PHASE_NAMES, phases))}
+
+#==============================================================================
+# 输出
+#==============================================================================
+
+def report(w: Dict):
+    total = w['total_us'] if w['complete'] else sum(w['phases_us'].values())
+    state = '' if w['complete'] else ' (尚未同步)'
+    print(f"来源: {w['source']}  总计 {total / 1000:.2f}ms{state}")
+    if w['entry_us']:
+        print(f"上次进入 Shutdown: {w['entry_us']}us{'+' if w['entry_us'] == 0xFFFF else ''}")
+    for name, us in w['phases_us'].items():
+        pct = 100.0 * us / total if total else 0.0
+        print(f"  {name:<8} {us / 1000:>9.2f}ms {pct:>6.1f}%")
+
+#==============================================================================
+# 主程序
+#==============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description='SlimeVR CH59X wake phase timing dump')
+    parser.add_argument('--json', action='store_true', help='输出 JSON')
+    args = parser.parse_args()
+
+    try:
+        device = hid.device()
+        device.open(USB_VID, USB_PID)
+        device.set_nonblocking(True)
+    except Exception as e:
+        print(f"无法打开设备: {e}")
+        return 1
+
+    try:
+        w = read_wake(device)
+    finally:
+        device.close()
+
+    if args.json:
+        print(json.dumps(w, indent=2, ensure_ascii=False))
+    else:
+        report(w)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())